@@ -116,6 +116,7 @@
 
 #include "gst.h"
 #include "gsttrace.h"
+#include "gsttracerutils.h"
 
 #define GST_CAT_DEFAULT GST_CAT_GST_INIT
 
@@ -542,19 +543,28 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
     GError ** error)
 {
   GLogLevelFlags llf;
+#ifndef GST_DISABLE_GST_DEBUG
+  GstClockTime start, types_done;
+#endif
 
   if (gst_initialized) {
     GST_DEBUG ("already initialized");
     return TRUE;
   }
 
+#ifndef GST_DISABLE_GST_DEBUG
+  start = gst_util_get_timestamp ();
+#endif
+
   llf = G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_ERROR | G_LOG_FLAG_FATAL;
   g_log_set_handler (g_log_domain_gstreamer, llf, debug_log_handler, NULL);
 
 #ifndef GST_DISABLE_TRACE
   _priv_gst_alloc_trace_initialize ();
 #endif
+  _priv_gst_lock_stats_initialize ();
 
+  _priv_gst_slab_initialize ();
   _priv_gst_mini_object_initialize ();
   _priv_gst_quarks_initialize ();
   _priv_gst_memory_initialize ();
@@ -630,7 +640,9 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   g_type_class_ref (gst_tag_flag_get_type ());
   g_type_class_ref (gst_tag_scope_get_type ());
   g_type_class_ref (gst_task_pool_get_type ());
+  g_type_class_ref (gst_shared_task_pool_get_type ());
   g_type_class_ref (gst_task_state_get_type ());
+  g_type_class_ref (gst_task_scheduling_policy_get_type ());
   g_type_class_ref (gst_toc_entry_type_get_type ());
   g_type_class_ref (gst_type_find_probability_get_type ());
   g_type_class_ref (gst_uri_error_get_type ());
@@ -667,6 +679,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
   gst_parse_context_get_type ();
 
   _priv_gst_plugin_initialize ();
+  _priv_gst_tracer_init ();
 
   /* register core plugins */
   gst_plugin_register_static (GST_VERSION_MAJOR, GST_VERSION_MINOR,
@@ -685,9 +698,22 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
    */
   gst_initialized = TRUE;
 
+#ifndef GST_DISABLE_GST_DEBUG
+  types_done = gst_util_get_timestamp ();
+  GST_INFO ("initialized core types and plugins in %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (types_done - start));
+#endif
+
   if (!gst_update_registry ())
     return FALSE;
 
+#ifndef GST_DISABLE_GST_DEBUG
+  GST_INFO ("loaded the registry in %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (gst_util_get_timestamp () - types_done));
+#endif
+
+  _priv_gst_plugin_profile_start ();
+
   GST_INFO ("GLib runtime version: %d.%d.%d", glib_major_version,
       glib_minor_version, glib_micro_version);
   GST_INFO ("GLib headers version: %d.%d.%d", GLIB_MAJOR_VERSION,
@@ -928,7 +954,14 @@ gst_deinit (void)
   gst_object_unref (clock);
   gst_object_unref (clock);
 
+  _priv_gst_plugin_profile_stop ();
+  _priv_gst_tracer_deinit ();
+  _priv_gst_element_factory_list_cache_clear ();
   _priv_gst_registry_cleanup ();
+  _priv_gst_caps_deinit ();
+  _priv_gst_query_deinit ();
+  _priv_gst_buffer_list_deinit ();
+  _priv_gst_slab_deinit ();
 
 #ifndef GST_DISABLE_TRACE
   _priv_gst_alloc_trace_deinit ();
@@ -1001,6 +1034,8 @@ gst_deinit (void)
   g_type_class_unref (g_type_class_peek (gst_tag_flag_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_tag_scope_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_task_state_get_type ()));
+  g_type_class_unref (g_type_class_peek
+      (gst_task_scheduling_policy_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_toc_entry_type_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_toc_scope_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_type_find_probability_get_type
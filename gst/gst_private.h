@@ -59,11 +59,45 @@ extern const char             g_log_domain_gstreamer[];
 
 #include "gstdatetime.h"
 
+#include "gstlockstats.h"
+
 G_BEGIN_DECLS
 
+#ifdef GST_ENABLE_LOCK_STATS
+/* let the core account the object and stream locks, see gstlockstats.c */
+#undef GST_OBJECT_LOCK
+#undef GST_OBJECT_TRYLOCK
+#undef GST_OBJECT_UNLOCK
+#define GST_OBJECT_LOCK(obj) \
+    GST_LOCK_STATS_MUTEX_LOCK (GST_OBJECT_GET_LOCK (obj), obj, GST_LOCK_STATS_OBJECT)
+#define GST_OBJECT_TRYLOCK(obj) \
+    GST_LOCK_STATS_MUTEX_TRYLOCK (GST_OBJECT_GET_LOCK (obj), obj, GST_LOCK_STATS_OBJECT)
+#define GST_OBJECT_UNLOCK(obj) \
+    GST_LOCK_STATS_MUTEX_UNLOCK (GST_OBJECT_GET_LOCK (obj))
+
+#undef GST_PAD_STREAM_LOCK
+#undef GST_PAD_STREAM_TRYLOCK
+#undef GST_PAD_STREAM_UNLOCK
+#define GST_PAD_STREAM_LOCK(pad) \
+    GST_LOCK_STATS_REC_MUTEX_LOCK (GST_PAD_GET_STREAM_LOCK (pad), pad, GST_LOCK_STATS_STREAM)
+#define GST_PAD_STREAM_TRYLOCK(pad) \
+    GST_LOCK_STATS_REC_MUTEX_TRYLOCK (GST_PAD_GET_STREAM_LOCK (pad), pad, GST_LOCK_STATS_STREAM)
+#define GST_PAD_STREAM_UNLOCK(pad) \
+    GST_LOCK_STATS_REC_MUTEX_UNLOCK (GST_PAD_GET_STREAM_LOCK (pad))
+
+#undef GST_PAD_BLOCK_WAIT
+#undef GST_TASK_WAIT
+#define GST_PAD_BLOCK_WAIT(pad) \
+    GST_LOCK_STATS_COND_WAIT (GST_PAD_BLOCK_GET_COND (pad), GST_OBJECT_GET_LOCK (pad), pad, GST_LOCK_STATS_OBJECT)
+#define GST_TASK_WAIT(task) \
+    GST_LOCK_STATS_COND_WAIT (GST_TASK_GET_COND (task), GST_OBJECT_GET_LOCK (task), task, GST_LOCK_STATS_OBJECT)
+#endif
+
 /* used by gstparse.c and grammar.y */
 struct _GstParseContext {
   GList * missing_elements;
+  /* factory name -> GstElementFactory found in previous runs, or NULL */
+  GHashTable * factories;
 };
 
 /* used by gstplugin.c and gstregistrybinary.c */
@@ -82,6 +116,11 @@ typedef struct {
 struct _GstPluginPrivate {
   GList *deps;    /* list of GstPluginDep structures */
   GstStructure *cache_data;
+
+  /* how long opening the module and plugin_init took when the plugin was
+   * loaded in this process, GST_CLOCK_TIME_NONE otherwise */
+  GstClockTime open_time;
+  GstClockTime init_time;
 };
 
 /* FIXME: could rename all priv_gst_* functions to __gst_* now */
@@ -111,11 +150,40 @@ G_GNUC_INTERNAL  void  _priv_gst_message_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_memory_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_meta_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_plugin_initialize (void);
+
+/* preloads and records the plugins of GST_PLUGIN_PROFILE */
+G_GNUC_INTERNAL  void  _priv_gst_plugin_profile_start (void);
+G_GNUC_INTERNAL  void  _priv_gst_plugin_profile_stop (void);
 G_GNUC_INTERNAL  void  _priv_gst_query_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_sample_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_tag_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_value_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_debug_init (void);
+G_GNUC_INTERNAL  void  _priv_gst_slab_initialize (void);
+
+/* size-classed per-thread block cache for buffer and memory structures */
+G_GNUC_INTERNAL  void     _priv_gst_slab_deinit    (void);
+G_GNUC_INTERNAL  gpointer _priv_gst_slab_alloc     (gsize size);
+G_GNUC_INTERNAL  void     _priv_gst_slab_free      (gsize size, gpointer mem);
+G_GNUC_INTERNAL  void     _priv_gst_slab_get_stats (guint64 * hits, guint64 * misses);
+
+/* drops the caps operation cache */
+G_GNUC_INTERNAL  void  _priv_gst_caps_deinit (void);
+
+/* frees the queries kept for reuse */
+G_GNUC_INTERNAL  void  _priv_gst_query_deinit (void);
+
+/* adds @bytes to the allocated bytes of @allocator, called by
+ * gst_memory_init() and when the memory is freed */
+G_GNUC_INTERNAL  void  _priv_gst_allocator_account (GstAllocator * allocator,
+                                                    gssize bytes);
+
+/* frees the buffer lists kept for reuse */
+G_GNUC_INTERNAL  void  _priv_gst_buffer_list_deinit (void);
+
+/* the binary form of the caps of a pad template loaded from the registry,
+ * see gstregistrychunks.c */
+#define GST_STATIC_CAPS_BINARY(static_caps) ((static_caps)->_gst_reserved[0])
 
 /* Private registry functions */
 G_GNUC_INTERNAL
@@ -123,6 +191,20 @@ gboolean _priv_gst_registry_remove_cache_plugins (GstRegistry *registry);
 
 G_GNUC_INTERNAL  void _priv_gst_registry_cleanup (void);
 
+G_GNUC_INTERNAL
+GList * _priv_gst_registry_get_uri_factories (GstRegistry * registry,
+    GstURIType type, const gchar * protocol);
+
+/* changed whenever the rank of a plugin feature changes */
+G_GNUC_INTERNAL  extern volatile gint _priv_gst_plugin_feature_rank_cookie;
+
+/* drops the sorted factory lists of gst_element_factory_list_get_elements() */
+G_GNUC_INTERNAL  void _priv_gst_element_factory_list_cache_clear (void);
+
+/* in gstsnapshot.c */
+G_GNUC_INTERNAL  void _priv_gst_snapshot_set_tracking (GstElement * pipeline,
+    gboolean track);
+
 gboolean _gst_plugin_loader_client_run (void);
 
 /* Used in GstBin for manual state handling */
@@ -135,6 +217,11 @@ G_GNUC_INTERNAL  void _priv_gst_element_state_changed (GstElement *element,
 G_GNUC_INTERNAL
 gboolean  priv_gst_structure_append_to_gstring (const GstStructure * structure,
                                                 GString            * s);
+
+/* parses a structure from a writable string, which is modified */
+G_GNUC_INTERNAL
+GstStructure * priv_gst_structure_from_string_inplace (gchar * string,
+                                                       gchar ** end);
 /* registry cache backends */
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const char *location);
@@ -142,6 +229,19 @@ gboolean		priv_gst_registry_binary_read_cache	(GstRegistry * registry, const cha
 G_GNUC_INTERNAL
 gboolean		priv_gst_registry_binary_write_cache	(GstRegistry * registry, GList * plugins, const char *location);
 
+/* features of the binary registry that are only created when needed */
+G_GNUC_INTERNAL
+void      _priv_gst_registry_add_lazy_feature (GstRegistry * registry,
+                                               const gchar * name,
+                                               GstPlugin   * plugin,
+                                               gchar       * in,
+                                               gchar       * end);
+
+G_GNUC_INTERNAL
+void      _priv_gst_registry_take_lazy_data   (GstRegistry    * registry,
+                                               gpointer         data,
+                                               GDestroyNotify   free_func);
+
 
 G_GNUC_INTERNAL
 void      __gst_element_factory_add_static_pad_template (GstElementFactory    * elementfactory,
@@ -225,6 +325,8 @@ GST_EXPORT GstDebugCategory *GST_CAT_LOCKING;
  * libgstreamer should be done like this: */
 #define GST_CAT_POLL _priv_GST_CAT_POLL
 extern GstDebugCategory *_priv_GST_CAT_POLL;
+#define GST_CAT_TRACER _priv_GST_CAT_TRACER
+extern GstDebugCategory *_priv_GST_CAT_TRACER;
 
 #else
 
@@ -260,6 +362,7 @@ extern GstDebugCategory *_priv_GST_CAT_POLL;
 #define GST_CAT_QOS              NULL
 #define GST_CAT_TYPES            NULL
 #define GST_CAT_POLL             NULL
+#define GST_CAT_TRACER           NULL
 #define GST_CAT_META             NULL
 #define GST_CAT_LOCKING          NULL
 
@@ -36,6 +36,15 @@
  * New memory can be created with gst_memory_new_wrapped() that wraps the memory
  * allocated elsewhere.
  *
+ * The #GST_ALLOCATOR_SYSMEM_NUMA allocator allocates large blocks on the NUMA
+ * node of the thread that allocates them, allocators for a given node are
+ * created with gst_numa_allocator_new().
+ *
+ * The #GST_ALLOCATOR_FD allocator allocates memory that is backed by a file
+ * descriptor. The descriptor can be retrieved with gst_fd_memory_get_fd() and
+ * passed to another process, which can wrap it in a #GstMemory again with
+ * gst_fd_allocator_import() to access the same data without copying it.
+ *
  * Last reviewed on 2012-07-09 (0.11.3)
  */
 
@@ -46,6 +55,19 @@
 #include "gst_private.h"
 #include "gstmemory.h"
 
+#include <errno.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#if defined(HAVE_LINUX_MEMPOLICY_H) && defined(HAVE_SYS_SYSCALL_H)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
 
@@ -54,7 +76,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 
 struct _GstAllocatorPrivate
 {
-  gpointer dummy;
+  /* maxsize of the memory of this allocator that is not freed yet, shared
+   * memory is not counted again */
+  volatile gsize allocated;
 };
 
 #if defined(MEMORY_ALIGNMENT_MALLOC)
@@ -135,6 +159,32 @@ gst_allocator_init (GstAllocator * allocator)
   allocator->mem_is_span = _fallback_mem_is_span;
 }
 
+void
+_priv_gst_allocator_account (GstAllocator * allocator, gssize bytes)
+{
+  g_atomic_pointer_add (&allocator->priv->allocated, bytes);
+}
+
+/**
+ * gst_allocator_get_allocated_bytes:
+ * @allocator: a #GstAllocator
+ *
+ * Get the number of bytes of memory of @allocator that are currently in use.
+ * This is the sum of the maxsize of all the memory of @allocator that is not
+ * freed yet. Memory that shares another memory is not counted again.
+ *
+ * Returns: the number of allocated bytes.
+ *
+ * Since: 1.2
+ */
+gsize
+gst_allocator_get_allocated_bytes (GstAllocator * allocator)
+{
+  g_return_val_if_fail (GST_IS_ALLOCATOR (allocator), 0);
+
+  return (gsize) g_atomic_pointer_get (&allocator->priv->allocated);
+}
+
 G_DEFINE_BOXED_TYPE (GstAllocationParams, gst_allocation_params,
     (GBoxedCopyFunc) gst_allocation_params_copy,
     (GBoxedFreeFunc) gst_allocation_params_free);
@@ -384,7 +434,7 @@ _default_mem_new (GstMemoryFlags flags,
 
   slice_size = sizeof (GstMemoryDefault);
 
-  mem = g_slice_alloc (slice_size);
+  mem = _priv_gst_slab_alloc (slice_size);
   _default_mem_init (mem, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
@@ -407,7 +457,7 @@ _default_mem_new_block (GstMemoryFlags flags,
   /* alloc header and data in one block */
   slice_size = sizeof (GstMemoryDefault) + maxsize;
 
-  mem = g_slice_alloc (slice_size);
+  mem = _priv_gst_slab_alloc (slice_size);
   if (mem == NULL)
     return NULL;
 
@@ -530,7 +580,7 @@ default_free (GstAllocator * allocator, GstMemory * mem)
   memset (mem, 0xff, sizeof (GstMemoryDefault));
 #endif
 
-  g_slice_free1 (slice_size, mem);
+  _priv_gst_slab_free (slice_size, mem);
 }
 
 static void
@@ -569,6 +619,585 @@ gst_default_allocator_init (GstDefaultAllocator * allocator)
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _default_mem_is_span;
 }
 
+/* NUMA memory, only blocks of at least this size get their own pages,
+ * smaller blocks are allocated like the default allocator does */
+#define NUMA_MIN_SIZE (64 * 1024)
+/* blocks of at least this size may use huge pages */
+#define NUMA_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+typedef struct
+{
+  GstAllocator parent;
+
+  /* the node to allocate on, -1 for the node of the calling thread */
+  gint node;
+} GstNumaAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstNumaAllocatorClass;
+
+GType gst_numa_allocator_get_type (void);
+G_DEFINE_TYPE (GstNumaAllocator, gst_numa_allocator, GST_TYPE_ALLOCATOR);
+
+static gsize numa_page_size = 4096;
+
+#ifdef HAVE_MMAP
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* the size of the mapping for a block of @maxsize with @align */
+static inline gsize
+_numa_map_size (gsize maxsize, gsize align)
+{
+  /* mappings are page aligned, only larger alignments need more space */
+  if (align >= numa_page_size)
+    maxsize += align;
+
+  return (maxsize + numa_page_size - 1) & ~(numa_page_size - 1);
+}
+
+static void
+_numa_bind (GstNumaAllocator * allocator, gpointer data, gsize size)
+{
+#if defined(MPOL_PREFERRED) && defined(SYS_mbind)
+  unsigned long nodemask;
+  gint node = allocator->node;
+
+#ifdef SYS_getcpu
+  if (node < 0) {
+    unsigned cpu, cur_node;
+
+    if (syscall (SYS_getcpu, &cpu, &cur_node, NULL) == 0)
+      node = cur_node;
+  }
+#endif
+  /* without a node the default first touch policy places the pages */
+  if (node < 0 || (guint) node >= sizeof (nodemask) * 8)
+    return;
+
+  nodemask = 1UL << node;
+  if (syscall (SYS_mbind, data, size, MPOL_PREFERRED, &nodemask,
+          sizeof (nodemask) * 8, 0) != 0)
+    GST_CAT_DEBUG (GST_CAT_MEMORY, "could not bind %p to node %d", data, node);
+#endif
+}
+#endif
+
+static GstMemory *
+numa_alloc (GstAllocator * allocator, gsize size, GstAllocationParams * params)
+{
+  gsize maxsize = size + params->prefix + params->padding;
+#ifdef HAVE_MMAP
+  GstMemoryDefault *mem;
+  gsize align, map_size, aoffset;
+  guint8 *base, *data;
+
+  if (maxsize < NUMA_MIN_SIZE)
+    goto small;
+
+  align = params->align | gst_memory_alignment;
+  map_size = _numa_map_size (maxsize, align);
+
+  base = mmap (NULL, map_size, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    goto small;
+
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+  if (map_size >= NUMA_HUGEPAGE_SIZE)
+    madvise (base, map_size, MADV_HUGEPAGE);
+#endif
+  _numa_bind ((GstNumaAllocator *) allocator, base, map_size);
+
+  data = base;
+  if ((aoffset = ((guintptr) data & align)))
+    data += (align + 1) - aoffset;
+
+  /* the memory is zero filled, we don't need to clear the prefix and
+   * padding */
+  mem = _priv_gst_slab_alloc (sizeof (GstMemoryDefault));
+  _default_mem_init (mem, params->flags, NULL, sizeof (GstMemoryDefault),
+      data, maxsize, align, params->prefix, size, base, NULL);
+  mem->mem.allocator = allocator;
+
+  return (GstMemory *) mem;
+
+small:
+#endif
+  return (GstMemory *) _default_mem_new_block (params->flags,
+      maxsize, params->align, params->prefix, size);
+}
+
+static void
+numa_free (GstAllocator * allocator, GstMemory * mem)
+{
+#ifdef HAVE_MMAP
+  GstMemoryDefault *dmem = (GstMemoryDefault *) mem;
+
+  /* user_data is the start of the mapping */
+  munmap (dmem->user_data, _numa_map_size (mem->maxsize, mem->align));
+  _priv_gst_slab_free (dmem->slice_size, mem);
+#else
+  g_assert_not_reached ();
+#endif
+}
+
+static void
+gst_numa_allocator_class_init (GstNumaAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class;
+
+  allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = numa_alloc;
+  allocator_class->free = numa_free;
+}
+
+static void
+gst_numa_allocator_init (GstNumaAllocator * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  allocator->node = -1;
+
+  /* it is system memory that only differs in where it is allocated */
+  alloc->mem_type = GST_ALLOCATOR_SYSMEM;
+  alloc->mem_map = (GstMemoryMapFunction) _default_mem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _default_mem_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _default_mem_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _default_mem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _default_mem_is_span;
+}
+
+/**
+ * gst_numa_allocator_new:
+ * @node: the NUMA node to allocate memory on, or -1 for the node of the
+ *     thread that allocates
+ *
+ * Create a new allocator for system memory that is placed on @node. Blocks
+ * of 64 KiB or more get their own pages that are bound to the node, blocks
+ * of 2 MiB or more can be backed by huge pages. Smaller blocks are
+ * allocated like with the default system memory allocator.
+ *
+ * Where NUMA memory policies are not supported, the pages are placed by
+ * the operating system. On Linux this is usually the node of the thread
+ * that first writes to them.
+ *
+ * The allocator for the node of the allocating thread is registered as
+ * #GST_ALLOCATOR_SYSMEM_NUMA.
+ *
+ * Returns: (transfer full): a new #GstAllocator, gst_object_unref() after
+ *     usage.
+ *
+ * Since: 1.2
+ */
+GstAllocator *
+gst_numa_allocator_new (gint node)
+{
+  GstNumaAllocator *allocator;
+
+  allocator = g_object_new (gst_numa_allocator_get_type (), NULL);
+  allocator->node = MAX (node, -1);
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "new NUMA allocator %p for node %d",
+      allocator, allocator->node);
+
+  return GST_ALLOCATOR_CAST (allocator);
+}
+
+/* fd memory */
+typedef struct
+{
+  GstMemory mem;
+
+  /* the file descriptor, owned by the memory without parent */
+  gint fd;
+
+  /* the mapping of the fd, kept until the memory is freed */
+  GMutex lock;
+  gpointer data;
+  gint prot;
+  gint map_count;
+} GstFdMemory;
+
+typedef struct
+{
+  GstAllocator parent;
+} GstFdAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstFdAllocatorClass;
+
+GType gst_fd_allocator_get_type (void);
+G_DEFINE_TYPE (GstFdAllocator, gst_fd_allocator, GST_TYPE_ALLOCATOR);
+
+#define GST_IS_FD_ALLOCATOR(obj) \
+    (G_TYPE_CHECK_INSTANCE_TYPE ((obj), gst_fd_allocator_get_type ()))
+
+#ifdef HAVE_MMAP
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+/* make a new anonymous file of @size bytes */
+static gint
+_fd_create (gsize size)
+{
+  gint fd = -1;
+
+#if defined(HAVE_SYS_SYSCALL_H) && defined(SYS_memfd_create)
+  fd = syscall (SYS_memfd_create, "gst-fd-memory", MFD_CLOEXEC);
+#endif
+  if (fd < 0) {
+    gchar *path;
+
+    /* fall back to an unlinked temporary file */
+    fd = g_file_open_tmp ("gst-fd-memory-XXXXXX", &path, NULL);
+    if (fd < 0)
+      return -1;
+
+    unlink (path);
+    g_free (path);
+  }
+
+  if (ftruncate (fd, size) < 0) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "could not resize fd %d to %"
+        G_GSIZE_FORMAT " bytes: %s", fd, size, g_strerror (errno));
+    close (fd);
+    return -1;
+  }
+  return fd;
+}
+#endif
+
+static GstFdMemory *
+_fd_mem_new (GstMemoryFlags flags, GstAllocator * allocator,
+    GstMemory * parent, gint fd, gsize maxsize, gsize offset, gsize size)
+{
+  GstFdMemory *mem;
+
+  mem = g_slice_new (GstFdMemory);
+  gst_memory_init (GST_MEMORY_CAST (mem), flags, allocator, parent, maxsize,
+      0, offset, size);
+
+  mem->fd = fd;
+  g_mutex_init (&mem->lock);
+  mem->data = NULL;
+  mem->prot = 0;
+  mem->map_count = 0;
+
+  return mem;
+}
+
+static gpointer
+_fd_mem_map (GstFdMemory * mem, gsize maxsize, GstMapFlags flags)
+{
+#ifdef HAVE_MMAP
+  gpointer res = NULL;
+  gint prot;
+
+  /* shared memory uses the mapping of the parent */
+  if (mem->mem.parent)
+    return _fd_mem_map ((GstFdMemory *) mem->mem.parent, maxsize, flags);
+
+  prot = (flags & GST_MAP_READ ? PROT_READ : 0) |
+      (flags & GST_MAP_WRITE ? PROT_WRITE : 0);
+
+  g_mutex_lock (&mem->lock);
+  if (mem->data && (mem->prot & prot) != prot) {
+    /* the mapping can only be replaced when nobody uses it */
+    if (mem->map_count > 0)
+      goto done;
+
+    munmap (mem->data, mem->mem.maxsize);
+    mem->data = NULL;
+  }
+
+  if (mem->data == NULL) {
+    /* map read-write when the fd allows it so that the mapping can be reused
+     * for all later maps */
+    mem->prot = PROT_READ | PROT_WRITE;
+    mem->data = mmap (NULL, mem->mem.maxsize, mem->prot, MAP_SHARED,
+        mem->fd, 0);
+    if (mem->data == MAP_FAILED && prot != mem->prot) {
+      mem->prot = prot;
+      mem->data = mmap (NULL, mem->mem.maxsize, mem->prot, MAP_SHARED,
+          mem->fd, 0);
+    }
+    if (mem->data == MAP_FAILED) {
+      GST_CAT_WARNING (GST_CAT_MEMORY, "could not map fd %d: %s", mem->fd,
+          g_strerror (errno));
+      mem->data = NULL;
+      goto done;
+    }
+  }
+  mem->map_count++;
+  res = mem->data;
+
+done:
+  g_mutex_unlock (&mem->lock);
+
+  return res;
+#else
+  return NULL;
+#endif
+}
+
+static gboolean
+_fd_mem_unmap (GstFdMemory * mem)
+{
+  if (mem->mem.parent)
+    return _fd_mem_unmap ((GstFdMemory *) mem->mem.parent);
+
+  g_mutex_lock (&mem->lock);
+  mem->map_count--;
+  g_mutex_unlock (&mem->lock);
+
+  return TRUE;
+}
+
+static GstFdMemory *
+_fd_mem_copy (GstFdMemory * mem, gssize offset, gsize size)
+{
+#ifdef HAVE_MMAP
+  GstFdMemory *copy;
+  gpointer src, dest;
+  gint fd;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  if ((src = _fd_mem_map (mem, mem->mem.maxsize, GST_MAP_READ)) == NULL)
+    return NULL;
+
+  if ((fd = _fd_create (mem->mem.maxsize)) < 0)
+    goto no_fd;
+
+  copy = _fd_mem_new (0, mem->mem.allocator, NULL, fd, mem->mem.maxsize,
+      mem->mem.offset + offset, size);
+
+  if ((dest = _fd_mem_map (copy, copy->mem.maxsize, GST_MAP_WRITE)) == NULL)
+    goto no_map;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", mem->mem.maxsize, mem,
+      copy);
+  memcpy (dest, src, mem->mem.maxsize);
+  _fd_mem_unmap (copy);
+  _fd_mem_unmap (mem);
+
+  return copy;
+
+no_map:
+  gst_memory_unref (GST_MEMORY_CAST (copy));
+no_fd:
+  _fd_mem_unmap (mem);
+#endif
+  return NULL;
+}
+
+static GstFdMemory *
+_fd_mem_share (GstFdMemory * mem, gssize offset, gsize size)
+{
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  /* the shared memory is always readonly */
+  return _fd_mem_new (GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, mem->mem.allocator, parent,
+      mem->fd, mem->mem.maxsize, mem->mem.offset + offset, size);
+}
+
+static gboolean
+_fd_mem_is_span (GstFdMemory * mem1, GstFdMemory * mem2, gsize * offset)
+{
+  if (offset)
+    *offset = mem1->mem.offset - mem1->mem.parent->offset;
+
+  /* both are shared from the same parent, the bytes are adjacent */
+  return mem1->mem.offset + mem1->mem.size == mem2->mem.offset;
+}
+
+static GstMemory *
+fd_alloc (GstAllocator * allocator, gsize size, GstAllocationParams * params)
+{
+#ifdef HAVE_MMAP
+  gsize maxsize = size + params->prefix + params->padding;
+  gint fd;
+
+  /* the mapping is page aligned, larger alignments can't be honoured */
+  if ((params->align | gst_memory_alignment) >= numa_page_size) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "alignment %" G_GSIZE_FORMAT
+        " is not supported", params->align);
+    return NULL;
+  }
+
+  if ((fd = _fd_create (maxsize)) < 0)
+    return NULL;
+
+  /* the file is zero filled, we don't need to clear the prefix and
+   * padding */
+  return (GstMemory *) _fd_mem_new (params->flags, allocator, NULL, fd,
+      maxsize, params->prefix, size);
+#else
+  return NULL;
+#endif
+}
+
+static void
+fd_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstFdMemory *fmem = (GstFdMemory *) mem;
+
+#ifdef HAVE_MMAP
+  if (fmem->data)
+    munmap (fmem->data, mem->maxsize);
+#endif
+  if (mem->parent == NULL)
+    close (fmem->fd);
+
+  g_mutex_clear (&fmem->lock);
+  g_slice_free (GstFdMemory, fmem);
+}
+
+static void
+gst_fd_allocator_class_init (GstFdAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class;
+
+  allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = fd_alloc;
+  allocator_class->free = fd_free;
+}
+
+static void
+gst_fd_allocator_init (GstFdAllocator * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  alloc->mem_type = GST_ALLOCATOR_FD;
+  alloc->mem_map = (GstMemoryMapFunction) _fd_mem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _fd_mem_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _fd_mem_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _fd_mem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _fd_mem_is_span;
+}
+
+/**
+ * gst_fd_allocator_new:
+ *
+ * Create a new allocator for memory that is backed by a file descriptor. On
+ * Linux the memory is backed by a memfd, elsewhere by an unlinked temporary
+ * file. The memory is mapped shared, changes are visible to all processes
+ * that map the same file descriptor.
+ *
+ * An allocator is registered as #GST_ALLOCATOR_FD.
+ *
+ * Returns: (transfer full): a new #GstAllocator, gst_object_unref() after
+ *     usage.
+ *
+ * Since: 1.2
+ */
+GstAllocator *
+gst_fd_allocator_new (void)
+{
+  return g_object_new (gst_fd_allocator_get_type (), NULL);
+}
+
+/**
+ * gst_fd_allocator_import:
+ * @allocator: a #GstAllocator created with gst_fd_allocator_new()
+ * @fd: the file descriptor to import
+ * @offset: the offset of the data in @fd
+ * @size: the size of the data
+ *
+ * Wrap @size bytes at @offset of the file descriptor @fd in a new
+ * #GstMemory. This is used to access memory that was allocated by another
+ * process, for example after receiving the file descriptor over a unix
+ * socket. The memory takes ownership of @fd and closes it when it is freed.
+ *
+ * The memory can be written when @fd was opened for writing.
+ *
+ * Returns: (transfer full): a new #GstMemory or %NULL when fd memory is not
+ *     supported.
+ *
+ * Since: 1.2
+ */
+GstMemory *
+gst_fd_allocator_import (GstAllocator * allocator, gint fd, gsize offset,
+    gsize size)
+{
+  g_return_val_if_fail (GST_IS_FD_ALLOCATOR (allocator), NULL);
+  g_return_val_if_fail (fd >= 0, NULL);
+
+#ifdef HAVE_MMAP
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "import fd %d offset %" G_GSIZE_FORMAT
+      " size %" G_GSIZE_FORMAT, fd, offset, size);
+
+  return (GstMemory *) _fd_mem_new (0, allocator, NULL, fd, offset + size,
+      offset, size);
+#else
+  return NULL;
+#endif
+}
+
+/**
+ * gst_is_fd_memory:
+ * @mem: a #GstMemory
+ *
+ * Check if @mem is backed by a file descriptor.
+ *
+ * Returns: %TRUE when @mem was allocated or imported by a fd allocator.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_is_fd_memory (GstMemory * mem)
+{
+  g_return_val_if_fail (mem != NULL, FALSE);
+
+  return mem->allocator != NULL && GST_IS_FD_ALLOCATOR (mem->allocator);
+}
+
+/**
+ * gst_fd_memory_get_fd:
+ * @mem: a #GstMemory backed by a file descriptor
+ * @offset: (out) (allow-none): the offset of the data of @mem in the file
+ *
+ * Get the file descriptor of @mem and the offset of its data in the file.
+ * The file descriptor remains owned by @mem, use dup() to keep it around
+ * longer than @mem.
+ *
+ * Returns: the file descriptor or -1 when @mem is not fd memory.
+ *
+ * Since: 1.2
+ */
+gint
+gst_fd_memory_get_fd (GstMemory * mem, gsize * offset)
+{
+  g_return_val_if_fail (mem != NULL, -1);
+
+  if (!gst_is_fd_memory (mem))
+    return -1;
+
+  if (offset)
+    *offset = mem->offset;
+
+  return ((GstFdMemory *) mem)->fd;
+}
+
 void
 _priv_gst_memory_initialize (void)
 {
@@ -584,12 +1213,20 @@ _priv_gst_memory_initialize (void)
   GST_CAT_DEBUG (GST_CAT_MEMORY, "memory alignment: %" G_GSIZE_FORMAT,
       gst_memory_alignment);
 
+#ifdef HAVE_GETPAGESIZE
+  numa_page_size = getpagesize ();
+#endif
+
   _sysmem_allocator = g_object_new (gst_default_allocator_get_type (), NULL);
 
   gst_allocator_register (GST_ALLOCATOR_SYSMEM,
       gst_object_ref (_sysmem_allocator));
 
   _default_allocator = gst_object_ref (_sysmem_allocator);
+
+  gst_allocator_register (GST_ALLOCATOR_SYSMEM_NUMA,
+      gst_numa_allocator_new (-1));
+  gst_allocator_register (GST_ALLOCATOR_FD, gst_fd_allocator_new ());
 }
 
 /**
@@ -58,6 +58,27 @@ GST_EXPORT gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_SYSMEM_NUMA:
+ *
+ * The allocator name for the system memory allocator that allocates large
+ * blocks on the NUMA node of the allocating thread, see
+ * gst_numa_allocator_new().
+ *
+ * Since: 1.2
+ */
+#define GST_ALLOCATOR_SYSMEM_NUMA   "SystemMemoryNuma"
+
+/**
+ * GST_ALLOCATOR_FD:
+ *
+ * The allocator name for the allocator of memory that is backed by a file
+ * descriptor, see gst_fd_allocator_new().
+ *
+ * Since: 1.2
+ */
+#define GST_ALLOCATOR_FD   "FdMemory"
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
@@ -139,6 +160,15 @@ void           gst_allocator_register        (const gchar *name, GstAllocator *a
 GstAllocator * gst_allocator_find            (const gchar *name);
 void           gst_allocator_set_default     (GstAllocator * allocator);
 
+GstAllocator * gst_numa_allocator_new        (gint node);
+
+/* fd memory */
+GstAllocator * gst_fd_allocator_new          (void);
+GstMemory *    gst_fd_allocator_import       (GstAllocator *allocator, gint fd,
+                                              gsize offset, gsize size);
+gboolean       gst_is_fd_memory              (GstMemory *mem);
+gint           gst_fd_memory_get_fd          (GstMemory *mem, gsize *offset);
+
 /* allocation parameters */
 void           gst_allocation_params_init    (GstAllocationParams *params);
 GstAllocationParams *
@@ -150,6 +180,8 @@ GstMemory *    gst_allocator_alloc           (GstAllocator * allocator, gsize si
                                               GstAllocationParams *params);
 void           gst_allocator_free            (GstAllocator * allocator, GstMemory *memory);
 
+gsize          gst_allocator_get_allocated_bytes (GstAllocator * allocator);
+
 GstMemory *    gst_memory_new_wrapped  (GstMemoryFlags flags, gpointer data, gsize maxsize,
                                         gsize offset, gsize size, gpointer user_data,
                                         GDestroyNotify notify);
@@ -35,6 +35,14 @@
  *
  * The #GstAtomicQueue object implements a queue that can be used from multiple
  * threads without performing any blocking operations.
+ *
+ * A queue created with gst_atomic_queue_new() grows when needed. A queue
+ * created with gst_atomic_queue_new_bounded() has a fixed capacity and never
+ * allocates memory after it was created, which makes it suitable for hot
+ * paths where the maximum number of items is known in advance.
+ *
+ * gst_atomic_queue_push_many() and gst_atomic_queue_pop_many() can be used
+ * to move multiple items with a single atomic operation.
  */
 
 G_DEFINE_BOXED_TYPE (GstAtomicQueue, gst_atomic_queue,
@@ -101,6 +109,160 @@ free_queue_mem (GstAQueueMem * mem)
   g_free (mem);
 }
 
+/* the bounded queue is a ring of cells where each cell has a sequence
+ * number that tells the readers and writers if the cell is free or filled
+ * for the current round of the ring. Readers and writers only contend on
+ * their own position counter, which are kept on different cache lines. */
+#define AQUEUE_CACHE_LINE 64
+
+typedef struct
+{
+  volatile gint sequence;
+  gpointer data;
+} GstAQueueCell;
+
+typedef struct
+{
+  volatile gint pos;
+  gchar _pad[AQUEUE_CACHE_LINE - sizeof (gint)];
+} GstAQueuePos;
+
+typedef struct
+{
+  guint mask;
+  GstAQueueCell *cells;
+  gchar _pad[AQUEUE_CACHE_LINE - sizeof (guint) - sizeof (gpointer)];
+
+  GstAQueuePos enqueue;
+  GstAQueuePos dequeue;
+} GstAQueueRing;
+
+static GstAQueueRing *
+new_queue_ring (guint capacity)
+{
+  GstAQueueRing *ring;
+  guint i;
+
+  ring = g_new0 (GstAQueueRing, 1);
+  ring->mask = clp2 (MAX (capacity, 2)) - 1;
+  ring->cells = g_new (GstAQueueCell, ring->mask + 1);
+  for (i = 0; i <= ring->mask; i++) {
+    ring->cells[i].sequence = i;
+    ring->cells[i].data = NULL;
+  }
+
+  return ring;
+}
+
+static void
+free_queue_ring (GstAQueueRing * ring)
+{
+  g_free (ring->cells);
+  g_free (ring);
+}
+
+/* difference between a cell sequence and a position, positions wrap around */
+#define SEQ_DIFF(seq,pos) ((gint) ((guint) (seq) - (guint) (pos)))
+
+/* push up to @n_data items, returns the number of pushed items */
+static guint
+ring_push (GstAQueueRing * ring, gpointer * data, guint n_data)
+{
+  guint pos, i, n;
+
+  while (TRUE) {
+    pos = (guint) g_atomic_int_get (&ring->enqueue.pos);
+
+    /* count the free cells after pos */
+    for (n = 0; n < n_data && n <= ring->mask; n++) {
+      GstAQueueCell *cell = &ring->cells[(pos + n) & ring->mask];
+
+      if (SEQ_DIFF (g_atomic_int_get (&cell->sequence), pos + n) != 0)
+        break;
+    }
+
+    if (n == 0) {
+      GstAQueueCell *cell = &ring->cells[pos & ring->mask];
+
+      /* full when the cell is still filled from the previous round, else
+       * another writer moved pos and we retry */
+      if (SEQ_DIFF (g_atomic_int_get (&cell->sequence), pos) < 0)
+        return 0;
+      continue;
+    }
+
+    if (g_atomic_int_compare_and_exchange (&ring->enqueue.pos, (gint) pos,
+            (gint) (pos + n)))
+      break;
+  }
+
+  /* the cells are ours now, fill them and make them visible to readers */
+  for (i = 0; i < n; i++) {
+    GstAQueueCell *cell = &ring->cells[(pos + i) & ring->mask];
+
+    cell->data = data[i];
+    g_atomic_int_set (&cell->sequence, (gint) (pos + i + 1));
+  }
+  return n;
+}
+
+/* pop up to @n_data items, returns the number of popped items */
+static guint
+ring_pop (GstAQueueRing * ring, gpointer * data, guint n_data)
+{
+  guint pos, i, n;
+
+  while (TRUE) {
+    pos = (guint) g_atomic_int_get (&ring->dequeue.pos);
+
+    /* count the filled cells after pos */
+    for (n = 0; n < n_data && n <= ring->mask; n++) {
+      GstAQueueCell *cell = &ring->cells[(pos + n) & ring->mask];
+
+      if (SEQ_DIFF (g_atomic_int_get (&cell->sequence), pos + n + 1) != 0)
+        break;
+    }
+
+    if (n == 0) {
+      GstAQueueCell *cell = &ring->cells[pos & ring->mask];
+
+      /* empty when the cell was not filled yet, else another reader moved
+       * pos and we retry */
+      if (SEQ_DIFF (g_atomic_int_get (&cell->sequence), pos + 1) < 0)
+        return 0;
+      continue;
+    }
+
+    if (g_atomic_int_compare_and_exchange (&ring->dequeue.pos, (gint) pos,
+            (gint) (pos + n)))
+      break;
+  }
+
+  /* read the cells and mark them free for the next round */
+  for (i = 0; i < n; i++) {
+    GstAQueueCell *cell = &ring->cells[(pos + i) & ring->mask];
+
+    data[i] = cell->data;
+    g_atomic_int_set (&cell->sequence, (gint) (pos + i + ring->mask + 1));
+  }
+  return n;
+}
+
+static gpointer
+ring_peek (GstAQueueRing * ring)
+{
+  GstAQueueCell *cell;
+  guint pos;
+
+  pos = (guint) g_atomic_int_get (&ring->dequeue.pos);
+  cell = &ring->cells[pos & ring->mask];
+
+  if (SEQ_DIFF (g_atomic_int_get (&cell->sequence), pos + 1) != 0)
+    return NULL;
+
+  return cell->data;
+}
+
 struct _GstAtomicQueue
 {
   volatile gint refcount;
@@ -110,6 +272,9 @@ struct _GstAtomicQueue
   GstAQueueMem *head_mem;
   GstAQueueMem *tail_mem;
   GstAQueueMem *free_list;
+
+  /* not NULL for bounded queues */
+  GstAQueueRing *ring;
 };
 
 static void
@@ -165,6 +330,40 @@ gst_atomic_queue_new (guint initial_size)
 #endif
   queue->head_mem = queue->tail_mem = new_queue_mem (initial_size, 0);
   queue->free_list = NULL;
+  queue->ring = NULL;
+
+  return queue;
+}
+
+/**
+ * gst_atomic_queue_new_bounded:
+ * @capacity: the maximum number of items in the queue
+ *
+ * Create a new atomic queue instance with a fixed capacity. @capacity will be
+ * rounded up to the nearest power of 2. No memory is allocated when pushing
+ * or popping items from the queue.
+ *
+ * gst_atomic_queue_push() waits until there is room in the queue when the
+ * queue is full, use gst_atomic_queue_push_many() to push without waiting.
+ *
+ * Returns: a new #GstAtomicQueue
+ *
+ * Since: 1.2
+ */
+GstAtomicQueue *
+gst_atomic_queue_new_bounded (guint capacity)
+{
+  GstAtomicQueue *queue;
+
+  queue = g_new (GstAtomicQueue, 1);
+
+  queue->refcount = 1;
+#ifdef LOW_MEM
+  queue->num_readers = 0;
+#endif
+  queue->head_mem = queue->tail_mem = NULL;
+  queue->free_list = NULL;
+  queue->ring = new_queue_ring (capacity);
 
   return queue;
 }
@@ -186,6 +385,11 @@ gst_atomic_queue_ref (GstAtomicQueue * queue)
 static void
 gst_atomic_queue_free (GstAtomicQueue * queue)
 {
+  if (queue->ring) {
+    free_queue_ring (queue->ring);
+    g_free (queue);
+    return;
+  }
   free_queue_mem (queue->head_mem);
   if (queue->head_mem != queue->tail_mem)
     free_queue_mem (queue->tail_mem);
@@ -225,6 +429,9 @@ gst_atomic_queue_peek (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring)
+    return ring_peek (queue->ring);
+
   while (TRUE) {
     GstAQueueMem *next;
 
@@ -276,6 +483,12 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, NULL);
 
+  if (queue->ring) {
+    if (ring_pop (queue->ring, &ret, 1) == 0)
+      return NULL;
+    return ret;
+  }
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
@@ -327,12 +540,178 @@ gst_atomic_queue_pop (GstAtomicQueue * queue)
   return ret;
 }
 
+/**
+ * gst_atomic_queue_pop_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (out caller-allocates) (array length=n_data): location to store
+ *     the items
+ * @n_data: the maximum number of items to pop
+ *
+ * Get up to @n_data elements from the head of the queue and store them in
+ * @data. This function can return less items than there are in the queue,
+ * call it again to get more items.
+ *
+ * Returns: the number of items stored in @data, 0 when the queue is empty.
+ *
+ * Since: 1.2
+ */
+guint
+gst_atomic_queue_pop_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  GstAQueueMem *head_mem;
+  gint head, tail, size;
+  guint i, n;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  if (n_data == 0)
+    return 0;
+
+  if (queue->ring)
+    return ring_pop (queue->ring, data, n_data);
+
+#ifdef LOW_MEM
+  g_atomic_int_inc (&queue->num_readers);
+#endif
+
+  do {
+    while (TRUE) {
+      GstAQueueMem *next;
+
+      head_mem = g_atomic_pointer_get (&queue->head_mem);
+
+      head = g_atomic_int_get (&head_mem->head);
+      tail = g_atomic_int_get (&head_mem->tail_read);
+      size = head_mem->size;
+
+      /* when we are not empty, we can continue */
+      if (G_LIKELY (head != tail))
+        break;
+
+      /* else array empty, try to take next */
+      next = g_atomic_pointer_get (&head_mem->next);
+      if (next == NULL) {
+        n = 0;
+        goto done;
+      }
+
+      /* swing the head pointer like in _pop() */
+      if (G_UNLIKELY (!g_atomic_pointer_compare_and_exchange (&queue->head_mem,
+                  head_mem, next)))
+        continue;
+
+      add_to_free_list (queue, head_mem);
+    }
+
+    /* take as many items as we can from this array */
+    n = MIN (n_data, (guint) (tail - head));
+    for (i = 0; i < n; i++)
+      data[i] = head_mem->array[(head + i) & size];
+  } while (G_UNLIKELY (!g_atomic_int_compare_and_exchange (&head_mem->head,
+              head, head + n)));
+
+done:
+#ifdef LOW_MEM
+  if (g_atomic_int_dec_and_test (&queue->num_readers))
+    clear_free_list (queue);
+#endif
+
+  return n;
+}
+
+/* reserve @n consecutive slots at the tail, grow the array when needed */
+static GstAQueueMem *
+reserve_tail (GstAtomicQueue * queue, guint n, gint * tailp)
+{
+  GstAQueueMem *tail_mem;
+  gint head, tail, size;
+
+  do {
+    while (TRUE) {
+      GstAQueueMem *mem;
+
+      tail_mem = g_atomic_pointer_get (&queue->tail_mem);
+      head = g_atomic_int_get (&tail_mem->head);
+      tail = g_atomic_int_get (&tail_mem->tail_write);
+      size = tail_mem->size;
+
+      /* we have room for n items, continue */
+      if (G_LIKELY (tail - head + (gint) n - 1 <= size))
+        break;
+
+      /* else we need to grow the array, we store a mask so we have to add 1 */
+      mem = new_queue_mem (MAX ((size << 1) + 1, (gint) n), tail);
+
+      if (G_UNLIKELY (!g_atomic_pointer_compare_and_exchange (&queue->tail_mem,
+                  tail_mem, mem))) {
+        free_queue_mem (mem);
+        continue;
+      }
+      g_atomic_pointer_set (&tail_mem->next, mem);
+    }
+  } while (G_UNLIKELY (!g_atomic_int_compare_and_exchange
+          (&tail_mem->tail_write, tail, tail + n)));
+
+  *tailp = tail;
+  return tail_mem;
+}
+
+/**
+ * gst_atomic_queue_push_many:
+ * @queue: a #GstAtomicQueue
+ * @data: (array length=n_data): the items to push
+ * @n_data: the number of items in @data
+ *
+ * Append the @n_data items in @data to the tail of the queue, in order.
+ *
+ * For queues created with gst_atomic_queue_new(), all items are always
+ * pushed. Bounded queues push as many items as there is room for.
+ *
+ * Returns: the number of items that were pushed.
+ *
+ * Since: 1.2
+ */
+guint
+gst_atomic_queue_push_many (GstAtomicQueue * queue, gpointer * data,
+    guint n_data)
+{
+  GstAQueueMem *tail_mem;
+  gint tail, size;
+  guint i;
+
+  g_return_val_if_fail (queue != NULL, 0);
+  g_return_val_if_fail (data != NULL || n_data == 0, 0);
+
+  if (n_data == 0)
+    return 0;
+
+  if (queue->ring)
+    return ring_push (queue->ring, data, n_data);
+
+  tail_mem = reserve_tail (queue, n_data, &tail);
+  size = tail_mem->size;
+
+  for (i = 0; i < n_data; i++)
+    tail_mem->array[(tail + i) & size] = data[i];
+
+  /* wait for the previous writers and reveal all our items at once */
+  while (G_UNLIKELY (!g_atomic_int_compare_and_exchange (&tail_mem->tail_read,
+              tail, tail + n_data)));
+
+  return n_data;
+}
+
 /**
  * gst_atomic_queue_push:
  * @queue: a #GstAtomicQueue
  * @data: the data
  *
  * Append @data to the tail of the queue.
+ *
+ * When @queue was created with gst_atomic_queue_new_bounded() and the queue
+ * is full, this function waits until there is room for @data.
  */
 void
 gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
@@ -342,6 +721,12 @@ gst_atomic_queue_push (GstAtomicQueue * queue, gpointer data)
 
   g_return_if_fail (queue != NULL);
 
+  if (queue->ring) {
+    while (G_UNLIKELY (ring_push (queue->ring, &data, 1) == 0))
+      g_thread_yield ();
+    return;
+  }
+
   do {
     while (TRUE) {
       GstAQueueMem *mem;
@@ -404,6 +789,16 @@ gst_atomic_queue_length (GstAtomicQueue * queue)
 
   g_return_val_if_fail (queue != NULL, 0);
 
+  if (queue->ring) {
+    GstAQueueRing *ring = queue->ring;
+    guint enqueue, dequeue;
+
+    dequeue = (guint) g_atomic_int_get (&ring->dequeue.pos);
+    enqueue = (guint) g_atomic_int_get (&ring->enqueue.pos);
+
+    return SEQ_DIFF (enqueue, dequeue) > 0 ? enqueue - dequeue : 0;
+  }
+
 #ifdef LOW_MEM
   g_atomic_int_inc (&queue->num_readers);
 #endif
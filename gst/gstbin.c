@@ -166,6 +166,7 @@
 
 #include "gstutils.h"
 #include "gstchildproxy.h"
+#include "gsttaskpool.h"
 
 GST_DEBUG_CATEGORY_STATIC (bin_debug);
 #define GST_CAT_DEFAULT bin_debug
@@ -198,6 +199,29 @@ struct _GstBinPrivate
   gboolean message_forward;
 
   gboolean posted_eos;
+
+  /* a LATENCY message was posted and the latency was not recalculated yet */
+  gboolean latency_pending;
+
+  /* change the state of independent children from the pool */
+  gboolean parallel_state_changes;
+  GstTaskPool *pool;
+
+  /* the number of children from which queries and events are dispatched
+   * concurrently, 0 to disable */
+  guint parallel_dispatch_threshold;
+
+  /* the last topologically sorted order of the children, valid as long as
+   * the structure cookie and the sinks did not change. Protected by the
+   * object lock. The list does not hold refs. */
+  GList *sorted;
+  guint32 sorted_cookie;
+  gsize sorted_sinks;
+  gboolean sorted_valid;
+
+  /* the children indexed by name, protected by the object lock. Names can't
+   * change while the children are in the bin. */
+  GHashTable *children_by_name;
 };
 
 typedef struct
@@ -208,6 +232,7 @@ typedef struct
 } BinContinueData;
 
 static void gst_bin_dispose (GObject * object);
+static void gst_bin_finalize (GObject * object);
 
 static void gst_bin_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
@@ -264,12 +289,16 @@ enum
 
 #define DEFAULT_ASYNC_HANDLING	FALSE
 #define DEFAULT_MESSAGE_FORWARD	FALSE
+#define DEFAULT_PARALLEL_STATE_CHANGES	FALSE
+#define DEFAULT_PARALLEL_DISPATCH_THRESHOLD	0
 
 enum
 {
   PROP_0,
   PROP_ASYNC_HANDLING,
   PROP_MESSAGE_FORWARD,
+  PROP_PARALLEL_STATE_CHANGES,
+  PROP_PARALLEL_DISPATCH_THRESHOLD,
   PROP_LAST
 };
 
@@ -439,7 +468,53 @@ gst_bin_class_init (GstBinClass * klass)
           "Forwards all children messages",
           DEFAULT_MESSAGE_FORWARD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstBin:parallel-state-changes:
+   *
+   * Change the state of children that do not depend on each other at the
+   * same time from a pool of threads. Children are still changed from the
+   * sinks to the sources but all elements that are not linked to an element
+   * whose state is being changed are changed concurrently. This speeds up
+   * state changes of bins where many elements block in their state change,
+   * for example to open devices.
+   *
+   * The children must not assume that their state is changed from the
+   * thread that called gst_element_set_state() on the bin.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_STATE_CHANGES,
+      g_param_spec_boolean ("parallel-state-changes", "Parallel State Changes",
+          "Change the state of independent children concurrently",
+          DEFAULT_PARALLEL_STATE_CHANGES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBin:parallel-dispatch-threshold:
+   *
+   * When the bin has at least this many sink children, the position,
+   * duration and latency queries are sent to them at the same time from a
+   * pool of threads. The same is done for events with the sources or sinks
+   * they are sent to. The results are still combined in the order of the
+   * children, so the result is the same as when the children are handled one
+   * after the other. 0 disables the concurrent dispatch.
+   *
+   * The children must not assume that the queries and events are handled in
+   * the thread that sent them to the bin.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_PARALLEL_DISPATCH_THRESHOLD,
+      g_param_spec_uint ("parallel-dispatch-threshold",
+          "Parallel Dispatch Threshold",
+          "Number of children from which queries and events are sent to "
+          "the children concurrently (0 = disabled)", 0, G_MAXUINT,
+          DEFAULT_PARALLEL_DISPATCH_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_bin_dispose;
+  gobject_class->finalize = gst_bin_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class, "Generic bin",
       "Generic/Bin",
@@ -501,6 +576,9 @@ gst_bin_init (GstBin * bin)
   bin->priv->asynchandling = DEFAULT_ASYNC_HANDLING;
   bin->priv->structure_cookie = 0;
   bin->priv->message_forward = DEFAULT_MESSAGE_FORWARD;
+  bin->priv->parallel_state_changes = DEFAULT_PARALLEL_STATE_CHANGES;
+  bin->priv->parallel_dispatch_threshold = DEFAULT_PARALLEL_DISPATCH_THRESHOLD;
+  bin->priv->children_by_name = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -520,6 +598,12 @@ gst_bin_dispose (GObject * object)
   bin_remove_messages (bin, NULL, GST_MESSAGE_ANY);
   GST_OBJECT_UNLOCK (object);
 
+  if (bin->priv->pool) {
+    gst_task_pool_cleanup (bin->priv->pool);
+    gst_object_unref (bin->priv->pool);
+    bin->priv->pool = NULL;
+  }
+
   while (bin->children) {
     gst_bin_remove (bin, GST_ELEMENT_CAST (bin->children->data));
   }
@@ -528,9 +612,46 @@ gst_bin_dispose (GObject * object)
         GST_STR_NULL (GST_OBJECT_NAME (object)));
   }
 
+  GST_OBJECT_LOCK (object);
+  g_list_free (bin->priv->sorted);
+  bin->priv->sorted = NULL;
+  bin->priv->sorted_valid = FALSE;
+  GST_OBJECT_UNLOCK (object);
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+static void
+gst_bin_finalize (GObject * object)
+{
+  GstBin *bin = GST_BIN_CAST (object);
+
+  g_hash_table_destroy (bin->priv->children_by_name);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/* find a direct child of @bin by name. Should be called with the bin LOCK */
+static GstElement *
+bin_lookup_child (GstBin * bin, const gchar * name)
+{
+  GList *walk;
+
+  /* the index can only be out of sync when a subclass changed the list of
+   * children itself, fall back to checking all children then */
+  if (G_LIKELY (g_hash_table_size (bin->priv->children_by_name) ==
+          bin->numchildren))
+    return g_hash_table_lookup (bin->priv->children_by_name, name);
+
+  for (walk = bin->children; walk; walk = g_list_next (walk)) {
+    GstElement *child = GST_ELEMENT_CAST (walk->data);
+
+    if (strcmp (GST_ELEMENT_NAME (child), name) == 0)
+      return child;
+  }
+  return NULL;
+}
+
 /**
  * gst_bin_new:
  * @name: the name of the new bin
@@ -564,6 +685,16 @@ gst_bin_set_property (GObject * object, guint prop_id,
       gstbin->priv->message_forward = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_state_changes = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_PARALLEL_DISPATCH_THRESHOLD:
+      GST_OBJECT_LOCK (gstbin);
+      gstbin->priv->parallel_dispatch_threshold = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -589,6 +720,16 @@ gst_bin_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, gstbin->priv->message_forward);
       GST_OBJECT_UNLOCK (gstbin);
       break;
+    case PROP_PARALLEL_STATE_CHANGES:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_boolean (value, gstbin->priv->parallel_state_changes);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
+    case PROP_PARALLEL_DISPATCH_THRESHOLD:
+      GST_OBJECT_LOCK (gstbin);
+      g_value_set_uint (value, gstbin->priv->parallel_dispatch_threshold);
+      GST_OBJECT_UNLOCK (gstbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1093,7 +1234,7 @@ gst_bin_add_func (GstBin * bin, GstElement * element)
    * we can safely take the lock here. This check is probably bogus because
    * you can safely change the element name after this check and before setting
    * the object parent. The window is very small though... */
-  if (G_UNLIKELY (!gst_object_check_uniqueness (bin->children, elem_name)))
+  if (G_UNLIKELY (bin_lookup_child (bin, elem_name) != NULL))
     goto duplicate_name;
 
   /* set the element's parent and add the element to the bin's list of children */
@@ -1125,6 +1266,8 @@ gst_bin_add_func (GstBin * bin, GstElement * element)
 
   bin->children = g_list_prepend (bin->children, element);
   bin->numchildren++;
+  g_hash_table_insert (bin->priv->children_by_name,
+      GST_ELEMENT_NAME (element), element);
   bin->children_cookie++;
   if (!GST_BIN_IS_NO_RESYNC (bin))
     bin->priv->structure_cookie++;
@@ -1358,10 +1501,11 @@ gst_bin_remove_func (GstBin * bin, GstElement * element)
         otherprovider = TRUE;
       if (requires_clock && !otherrequirer && child_requirer)
         otherrequirer = TRUE;
-      /* check if we have NO_PREROLL children */
-      if (GST_STATE_RETURN (child) == GST_STATE_CHANGE_NO_PREROLL)
-        have_no_preroll = TRUE;
       GST_OBJECT_UNLOCK (child);
+      /* check if we have NO_PREROLL children, this does not need the lock */
+      if (gst_element_peek_state (child, NULL, NULL, NULL) ==
+          GST_STATE_CHANGE_NO_PREROLL)
+        have_no_preroll = TRUE;
     }
   }
 
@@ -1372,6 +1516,10 @@ gst_bin_remove_func (GstBin * bin, GstElement * element)
   /* we now removed the element from the list of elements, increment the cookie
    * so that others can detect a change in the children list. */
   bin->numchildren--;
+  if (g_hash_table_lookup (bin->priv->children_by_name,
+          GST_ELEMENT_NAME (element)) == element)
+    g_hash_table_remove (bin->priv->children_by_name,
+        GST_ELEMENT_NAME (element));
   bin->children_cookie++;
   if (!GST_BIN_IS_NO_RESYNC (bin))
     bin->priv->structure_cookie++;
@@ -1823,6 +1971,9 @@ gst_bin_get_state_func (GstElement * element, GstState * state,
  * on the sinkpads. When an element reaches degree 0, its state is
  * changed next.
  * When all elements are handled the algorithm stops.
+ *
+ * The resulting order is cached in the bin and reused as long as no element
+ * was added, removed, linked or unlinked.
  */
 typedef struct _GstBinSortIterator
 {
@@ -1834,6 +1985,13 @@ typedef struct _GstBinSortIterator
   gint best_deg;                /* best degree */
   GHashTable *hash;             /* hashtable with element dependencies */
   gboolean dirty;               /* we detected structure change */
+
+  GList *cached;                /* next element when using the cached order */
+  gboolean use_cache;           /* iterate the cached order */
+  GList *order;                 /* copy of the cached order or the order so
+                                 * far, reversed, to update the cache */
+  gboolean cacheable;           /* the order can be cached when done */
+  gsize sinks;                  /* the sinks when the order was calculated */
 } GstBinSortIterator;
 
 static void
@@ -1854,6 +2012,11 @@ gst_bin_sort_iterator_copy (const GstBinSortIterator * it,
   g_hash_table_iter_init (&iter, it->hash);
   while (g_hash_table_iter_next (&iter, &key, &value))
     g_hash_table_insert (copy->hash, key, value);
+
+  copy->order = g_list_copy (it->order);
+  if (it->cached)
+    copy->cached = g_list_nth (copy->order,
+        g_list_position (it->order, it->cached));
 }
 
 /* we add and subtract 1 to make sure we don't confuse NULL and 0 */
@@ -1903,6 +2066,30 @@ clear_queue (GQueue * queue)
     gst_object_unref (p);
 }
 
+/* summarize the children that are marked as a sink, the sorted order depends
+ * on them but they can change without a structure change in this bin, for
+ * example when a sink is added to a child bin. Should be called with the bin
+ * LOCK */
+static gsize
+bin_sinks_summary (GstBin * bin)
+{
+  GList *walk;
+  gsize sinks = 0;
+
+  for (walk = bin->children; walk; walk = g_list_next (walk)) {
+    GstElement *child = GST_ELEMENT_CAST (walk->data);
+    gboolean is_sink;
+
+    GST_OBJECT_LOCK (child);
+    is_sink = GST_OBJECT_FLAG_IS_SET (child, GST_ELEMENT_FLAG_SINK);
+    GST_OBJECT_UNLOCK (child);
+
+    if (is_sink)
+      sinks = (sinks * 31) + GPOINTER_TO_SIZE (child);
+  }
+  return sinks;
+}
+
 /* set all degrees to 0. Elements marked as a sink are
  * added to the queue immediately. Since we only look at the SINK flag of the
  * element, it is possible that we add non-sinks to the queue. These will be
@@ -2040,6 +2227,17 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
   GstElement *best;
   GstBin *bin = bit->bin;
 
+  if (bit->use_cache) {
+    if (bit->cached == NULL)
+      return GST_ITERATOR_DONE;
+
+    best = GST_ELEMENT_CAST (bit->cached->data);
+    bit->cached = g_list_next (bit->cached);
+    GST_DEBUG_OBJECT (bin, "cached order gives %s", GST_ELEMENT_NAME (best));
+    g_value_set_object (result, best);
+    return GST_ITERATOR_OK;
+  }
+
   /* empty queue, we have to find a next best element */
   if (g_queue_is_empty (&bit->queue)) {
     bit->best = NULL;
@@ -2048,6 +2246,8 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
     if ((best = bit->best)) {
       /* when we detected an unlink, don't warn because our degrees might be
        * screwed up. We will resync later */
+      if (bit->best_deg != 0)
+        bit->cacheable = FALSE;
       if (bit->best_deg != 0 && !bit->dirty) {
         /* we don't fail on this one yet */
         GST_WARNING_OBJECT (bin, "loop dected in graph");
@@ -2061,6 +2261,17 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
       g_value_set_object (result, best);
     } else {
       GST_DEBUG_OBJECT (bin, "queue empty, elements exhausted");
+      /* remember the order for the next time when nothing changed while we
+       * were iterating */
+      if (bit->cacheable && !bit->dirty) {
+        g_list_free (bin->priv->sorted);
+        bin->priv->sorted = g_list_reverse (bit->order);
+        bin->priv->sorted_cookie = bin->priv->structure_cookie;
+        bin->priv->sorted_sinks = bit->sinks;
+        bin->priv->sorted_valid = TRUE;
+        bit->order = NULL;
+        bit->cacheable = FALSE;
+      }
       /* no more unhandled elements, we are done */
       return GST_ITERATOR_DONE;
     }
@@ -2074,6 +2285,8 @@ gst_bin_sort_iterator_next (GstBinSortIterator * bit, GValue * result)
   GST_DEBUG_OBJECT (bin, "queue head gives %s", GST_ELEMENT_NAME (best));
   /* update degrees of linked elements */
   update_degree (best, bit);
+  if (bit->cacheable)
+    bit->order = g_list_prepend (bit->order, best);
 
   return GST_ITERATOR_OK;
 }
@@ -2087,6 +2300,27 @@ gst_bin_sort_iterator_resync (GstBinSortIterator * bit)
   GST_DEBUG_OBJECT (bin, "resync");
   bit->dirty = FALSE;
   clear_queue (&bit->queue);
+  g_list_free (bit->order);
+  bit->order = NULL;
+
+  /* reuse the previous order when nothing changed. Bins that don't resync
+   * don't track the structure changes, and while a link or unlink is busy
+   * the order is not final, calculate the order again in those cases. */
+  bit->sinks = bin_sinks_summary (bin);
+  bit->cacheable = !GST_BIN_IS_NO_RESYNC (bin) &&
+      !find_message (bin, NULL, GST_MESSAGE_STRUCTURE_CHANGE);
+  bit->use_cache = bit->cacheable && bin->priv->sorted_valid &&
+      bin->priv->sorted_cookie == bin->priv->structure_cookie &&
+      bin->priv->sorted_sinks == bit->sinks;
+  if (bit->use_cache) {
+    GST_DEBUG_OBJECT (bin, "using cached order");
+    /* take a copy, another iterator might replace the cache */
+    bit->order = g_list_copy (bin->priv->sorted);
+    bit->cached = bit->order;
+    return;
+  }
+  bit->cached = NULL;
+
   /* reset degrees */
   g_list_foreach (bin->children, (GFunc) reset_degree, bit);
   /* calc degrees, incrementing */
@@ -2104,6 +2338,7 @@ gst_bin_sort_iterator_free (GstBinSortIterator * bit)
 
   GST_DEBUG_OBJECT (bin, "free");
   clear_queue (&bit->queue);
+  g_list_free (bit->order);
   g_hash_table_destroy (bit->hash);
   gst_object_unref (bin);
 }
@@ -2128,6 +2363,7 @@ gst_bin_sort_iterator_new (GstBin * bin)
       (GstIteratorFreeFunction) gst_bin_sort_iterator_free);
   g_queue_init (&result->queue);
   result->hash = g_hash_table_new (NULL, NULL);
+  result->order = NULL;
   gst_object_ref (bin);
   result->bin = bin;
   gst_bin_sort_iterator_resync (result);
@@ -2428,6 +2664,11 @@ failed:
  * This function simply emits the 'do-latency' signal so any custom latency
  * calculations will be performed.
  *
+ * A toplevel bin only posts one #GST_MESSAGE_LATENCY on the bus until this
+ * function is called. Further LATENCY messages from its children are dropped
+ * in the meantime because the recalculation will take their changes into
+ * account as well.
+ *
  * Returns: %TRUE if the latency could be queried and reconfigured.
  */
 gboolean
@@ -2435,6 +2676,11 @@ gst_bin_recalculate_latency (GstBin * bin)
 {
   gboolean res;
 
+  /* from now on, new LATENCY messages need a new recalculation */
+  GST_OBJECT_LOCK (bin);
+  bin->priv->latency_pending = FALSE;
+  GST_OBJECT_UNLOCK (bin);
+
   g_signal_emit (bin, gst_bin_signals[DO_LATENCY], 0, &res);
   GST_DEBUG_OBJECT (bin, "latency returned %d", res);
 
@@ -2507,6 +2753,278 @@ gst_bin_state_changed (GstElement * element, GstState oldstate,
     pklass->state_changed (element, oldstate, newstate, pending);
 }
 
+/* A batch of children whose state is changed at the same time. When the bin
+ * does parallel state changes, all children in a batch are independent and are
+ * changed from the task pool, else a batch contains only one child. */
+typedef struct
+{
+  GstBin *bin;
+  GstClockTime base_time;
+  GstClockTime start_time;
+  GstState current;
+  GstState next;
+
+  GArray *changes;              /* of BinChildStateChange */
+
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} BinStateChangeBatch;
+
+typedef struct
+{
+  BinStateChangeBatch *batch;
+  GstElement *child;
+  GstStateChangeReturn ret;
+} BinChildStateChange;
+
+static void
+bin_state_change_batch_init (BinStateChangeBatch * batch, GstBin * bin,
+    GstState current, GstState next)
+{
+  batch->bin = bin;
+  batch->current = current;
+  batch->next = next;
+  batch->changes = g_array_new (FALSE, FALSE, sizeof (BinChildStateChange));
+  g_mutex_init (&batch->lock);
+  g_cond_init (&batch->cond);
+  batch->pending = 0;
+}
+
+static void
+bin_state_change_batch_clear (BinStateChangeBatch * batch)
+{
+  guint i;
+
+  for (i = 0; i < batch->changes->len; i++)
+    gst_object_unref (g_array_index (batch->changes, BinChildStateChange,
+            i).child);
+  g_array_free (batch->changes, TRUE);
+  g_mutex_clear (&batch->lock);
+  g_cond_clear (&batch->cond);
+}
+
+static void
+bin_state_change_batch_add (BinStateChangeBatch * batch, GstElement * child)
+{
+  BinChildStateChange change;
+
+  change.batch = batch;
+  change.child = gst_object_ref (child);
+  change.ret = GST_STATE_CHANGE_FAILURE;
+  g_array_append_val (batch->changes, change);
+}
+
+/* check if @element provides data for one of the children in @batch. It then
+ * has to wait until the state change of the batch completed. */
+static gboolean
+bin_state_change_batch_depends (BinStateChangeBatch * batch,
+    GstElement * element)
+{
+  GstIterator *it;
+  GValue item = { 0, };
+  gboolean depends = FALSE, done = FALSE;
+
+  it = gst_element_iterate_src_pads (element);
+  while (!done && !depends) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:
+      {
+        GstPad *peer;
+        GstElement *peer_element = NULL;
+        guint i;
+
+        if ((peer = gst_pad_get_peer (g_value_get_object (&item)))) {
+          peer_element = gst_pad_get_parent_element (peer);
+          gst_object_unref (peer);
+        }
+        if (peer_element) {
+          for (i = 0; i < batch->changes->len && !depends; i++) {
+            if (g_array_index (batch->changes, BinChildStateChange,
+                    i).child == peer_element)
+              depends = TRUE;
+          }
+          gst_object_unref (peer_element);
+        }
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        /* be safe and wait for the batch */
+        depends = TRUE;
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return depends;
+}
+
+static void
+bin_child_state_change_func (BinChildStateChange * change)
+{
+  BinStateChangeBatch *batch = change->batch;
+
+  change->ret = gst_bin_element_set_state (batch->bin, change->child,
+      batch->base_time, batch->start_time, batch->current, batch->next);
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* handle the result of a child state change. Returns FALSE when the state
+ * change of the bin has to fail. */
+static gboolean
+bin_child_state_change_done (GstBin * bin, BinChildStateChange * change,
+    gboolean * have_async, gboolean * have_no_preroll)
+{
+  GstElement *child = change->child;
+  GstState next = change->batch->next;
+
+  switch (change->ret) {
+    case GST_STATE_CHANGE_SUCCESS:
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+          "child '%s' changed state to %d(%s) successfully",
+          GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+      break;
+    case GST_STATE_CHANGE_ASYNC:
+    {
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+          "child '%s' is changing state asynchronously to %s",
+          GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
+      *have_async = TRUE;
+      break;
+    }
+    case GST_STATE_CHANGE_FAILURE:{
+      GstObject *parent;
+
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+          "child '%s' failed to go to state %d(%s)",
+          GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+
+      /* Only fail if the child is still inside
+       * this bin. It might've been removed already
+       * because of the error by the bin subclass
+       * to ignore the error.  */
+      parent = gst_object_get_parent (GST_OBJECT_CAST (child));
+      if (parent == GST_OBJECT_CAST (bin)) {
+        /* element is still in bin, really error now */
+        gst_object_unref (parent);
+        return FALSE;
+      }
+      /* child removed from bin, let the resync code redo the state
+       * change */
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+          "child '%s' was removed from the bin", GST_ELEMENT_NAME (child));
+
+      if (parent)
+        gst_object_unref (parent);
+
+      break;
+    }
+    case GST_STATE_CHANGE_NO_PREROLL:
+      GST_CAT_INFO_OBJECT (GST_CAT_STATES, bin,
+          "child '%s' changed state to %d(%s) successfully without preroll",
+          GST_ELEMENT_NAME (child), next, gst_element_state_get_name (next));
+      *have_no_preroll = TRUE;
+      break;
+    default:
+      g_assert_not_reached ();
+      break;
+  }
+  return TRUE;
+}
+
+/* makes sure the pool for the concurrent state changes and dispatches is
+ * prepared, returns FALSE when that failed */
+static gboolean
+bin_ensure_pool (GstBin * bin)
+{
+  GstTaskPool *pool;
+  GError *err = NULL;
+
+  GST_OBJECT_LOCK (bin);
+  if (bin->priv->pool != NULL) {
+    GST_OBJECT_UNLOCK (bin);
+    return TRUE;
+  }
+
+  pool = gst_task_pool_new ();
+  gst_task_pool_prepare (pool, &err);
+  if (err == NULL) {
+    bin->priv->pool = pool;
+  } else {
+    GST_WARNING_OBJECT (bin, "could not prepare pool: %s", err->message);
+    g_error_free (err);
+    gst_object_unref (pool);
+  }
+  GST_OBJECT_UNLOCK (bin);
+
+  return err == NULL;
+}
+
+/* change the state of all children in @batch and wait for the result. Returns
+ * FALSE when the state change of the bin has to fail. */
+static gboolean
+bin_state_change_batch_run (BinStateChangeBatch * batch,
+    gboolean * have_async, gboolean * have_no_preroll)
+{
+  GstBin *bin = batch->bin;
+  GArray *changes = batch->changes;
+  gboolean res = TRUE;
+  guint i;
+
+  if (changes->len == 0)
+    return TRUE;
+
+  batch->pending = changes->len;
+
+  /* all but the first child are changed from the pool, we do the first one
+   * ourselves while waiting */
+  for (i = 1; i < changes->len; i++) {
+    BinChildStateChange *change =
+        &g_array_index (changes, BinChildStateChange, i);
+    GError *err = NULL;
+
+    gst_task_pool_push (bin->priv->pool,
+        (GstTaskPoolFunction) bin_child_state_change_func, change, &err);
+    if (G_UNLIKELY (err != NULL)) {
+      GST_CAT_WARNING_OBJECT (GST_CAT_STATES, bin,
+          "could not push state change of '%s' to the pool: %s",
+          GST_ELEMENT_NAME (change->child), err->message);
+      g_error_free (err);
+      bin_child_state_change_func (change);
+    }
+  }
+  bin_child_state_change_func (&g_array_index (changes, BinChildStateChange,
+          0));
+
+  g_mutex_lock (&batch->lock);
+  while (batch->pending > 0)
+    g_cond_wait (&batch->cond, &batch->lock);
+  g_mutex_unlock (&batch->lock);
+
+  /* handle the results in state change order */
+  for (i = 0; i < changes->len; i++) {
+    BinChildStateChange *change =
+        &g_array_index (changes, BinChildStateChange, i);
+
+    if (res)
+      res = bin_child_state_change_done (bin, change, have_async,
+          have_no_preroll);
+    gst_object_unref (change->child);
+  }
+  g_array_set_size (changes, 0);
+
+  return res;
+}
+
 static GstStateChangeReturn
 gst_bin_change_state_func (GstElement * element, GstStateChange transition)
 {
@@ -2518,6 +3036,8 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
   GstClockTime base_time, start_time;
   GstIterator *it;
   gboolean done;
+  gboolean parallel;
+  BinStateChangeBatch batch;
   GValue data = { 0, };
 
   /* we don't need to take the STATE_LOCK, it is already taken */
@@ -2579,8 +3099,16 @@ gst_bin_change_state_func (GstElement * element, GstStateChange transition)
    * don't want them to interfere with this state change */
   GST_OBJECT_LOCK (bin);
   bin->polling = TRUE;
+  parallel = bin->priv->parallel_state_changes;
   GST_OBJECT_UNLOCK (bin);
 
+  if (parallel && !bin_ensure_pool (bin)) {
+    GST_CAT_WARNING_OBJECT (GST_CAT_STATES, bin,
+        "could not prepare pool, changing state serially");
+    parallel = FALSE;
+  }
+  bin_state_change_batch_init (&batch, bin, current, next);
+
   /* iterate in state change order */
   it = gst_bin_iterate_sorted (bin);
 
@@ -2594,6 +3122,8 @@ restart:
   /* take base_time */
   base_time = gst_element_get_base_time (element);
   start_time = gst_element_get_start_time (element);
+  batch.base_time = base_time;
+  batch.start_time = start_time;
 
   have_no_preroll = FALSE;
 
@@ -2606,75 +3136,45 @@ restart:
 
         child = g_value_get_object (&data);
 
-        /* set state and base_time now */
-        ret = gst_bin_element_set_state (bin, child, base_time, start_time,
-            current, next);
-
-        switch (ret) {
-          case GST_STATE_CHANGE_SUCCESS:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            break;
-          case GST_STATE_CHANGE_ASYNC:
-          {
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' is changing state asynchronously to %s",
-                GST_ELEMENT_NAME (child), gst_element_state_get_name (next));
-            have_async = TRUE;
-            break;
+        /* a child that provides data to one of the children in the batch
+         * must wait until their state is changed */
+        if (parallel && bin_state_change_batch_depends (&batch, child)) {
+          if (!bin_state_change_batch_run (&batch, &have_async,
+                  &have_no_preroll)) {
+            ret = GST_STATE_CHANGE_FAILURE;
+            goto done;
           }
-          case GST_STATE_CHANGE_FAILURE:{
-            GstObject *parent;
-
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' failed to go to state %d(%s)",
-                GST_ELEMENT_NAME (child),
-                next, gst_element_state_get_name (next));
-
-            /* Only fail if the child is still inside
-             * this bin. It might've been removed already
-             * because of the error by the bin subclass
-             * to ignore the error.  */
-            parent = gst_object_get_parent (GST_OBJECT_CAST (child));
-            if (parent == GST_OBJECT_CAST (element)) {
-              /* element is still in bin, really error now */
-              gst_object_unref (parent);
-              goto done;
-            }
-            /* child removed from bin, let the resync code redo the state
-             * change */
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' was removed from the bin",
-                GST_ELEMENT_NAME (child));
+        }
 
-            if (parent)
-              gst_object_unref (parent);
+        bin_state_change_batch_add (&batch, child);
 
-            break;
-          }
-          case GST_STATE_CHANGE_NO_PREROLL:
-            GST_CAT_INFO_OBJECT (GST_CAT_STATES, element,
-                "child '%s' changed state to %d(%s) successfully without preroll",
-                GST_ELEMENT_NAME (child), next,
-                gst_element_state_get_name (next));
-            have_no_preroll = TRUE;
-            break;
-          default:
-            g_assert_not_reached ();
-            break;
+        /* set state and base_time now */
+        if (!parallel && !bin_state_change_batch_run (&batch, &have_async,
+                &have_no_preroll)) {
+          ret = GST_STATE_CHANGE_FAILURE;
+          goto done;
         }
+
         g_value_reset (&data);
         break;
       }
       case GST_ITERATOR_RESYNC:
         GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator doing resync");
+        if (!bin_state_change_batch_run (&batch, &have_async,
+                &have_no_preroll)) {
+          ret = GST_STATE_CHANGE_FAILURE;
+          goto done;
+        }
         gst_iterator_resync (it);
         goto restart;
       default:
       case GST_ITERATOR_DONE:
         GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "iterator done");
+        if (!bin_state_change_batch_run (&batch, &have_async,
+                &have_no_preroll)) {
+          ret = GST_STATE_CHANGE_FAILURE;
+          goto done;
+        }
         done = TRUE;
         break;
     }
@@ -2699,6 +3199,7 @@ restart:
 done:
   g_value_unset (&data);
   gst_iterator_free (it);
+  bin_state_change_batch_clear (&batch);
 
   GST_OBJECT_LOCK (bin);
   bin->polling = FALSE;
@@ -2756,6 +3257,164 @@ activate_failure:
   }
 }
 
+/* a query or event that is sent to the children concurrently */
+typedef struct _BinDispatch BinDispatch;
+
+typedef struct
+{
+  BinDispatch *dispatch;
+  GstElement *child;
+  GstQuery *query;
+  gboolean res;
+} BinDispatchItem;
+
+struct _BinDispatch
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+
+  /* the event for all children, or NULL when each item has its own query */
+  GstEvent *event;
+  BinDispatchItem *items;
+  guint n_items;
+};
+
+/* collects the elements of @iter with a ref, returns NULL on error */
+static GPtrArray *
+bin_collect_children (GstIterator * iter)
+{
+  GPtrArray *children = g_ptr_array_new_with_free_func (gst_object_unref);
+  GValue data = { 0, };
+
+  while (TRUE) {
+    switch (gst_iterator_next (iter, &data)) {
+      case GST_ITERATOR_OK:
+        g_ptr_array_add (children, g_value_dup_object (&data));
+        g_value_reset (&data);
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (iter);
+        g_ptr_array_set_size (children, 0);
+        break;
+      case GST_ITERATOR_DONE:
+        g_value_unset (&data);
+        return children;
+      default:
+        g_value_unset (&data);
+        g_ptr_array_unref (children);
+        return NULL;
+    }
+  }
+}
+
+static void
+bin_dispatch_item_func (BinDispatchItem * item)
+{
+  BinDispatch *dispatch = item->dispatch;
+
+  if (dispatch->event)
+    item->res = gst_element_send_event (item->child,
+        gst_event_ref (dispatch->event));
+  else
+    item->res = gst_element_query (item->child, item->query);
+
+  g_mutex_lock (&dispatch->lock);
+  if (--dispatch->pending == 0)
+    g_cond_signal (&dispatch->cond);
+  g_mutex_unlock (&dispatch->lock);
+}
+
+/* sends the event or the queries of @dispatch to all children from the pool
+ * and waits for the results */
+static void
+bin_dispatch_run (GstBin * bin, BinDispatch * dispatch)
+{
+  guint i;
+
+  g_mutex_init (&dispatch->lock);
+  g_cond_init (&dispatch->cond);
+  dispatch->pending = dispatch->n_items;
+
+  GST_DEBUG_OBJECT (bin, "dispatching to %u children", dispatch->n_items);
+
+  /* we handle the first child ourselves while waiting */
+  for (i = 1; i < dispatch->n_items; i++) {
+    BinDispatchItem *item = &dispatch->items[i];
+    GError *err = NULL;
+
+    gst_task_pool_push (bin->priv->pool,
+        (GstTaskPoolFunction) bin_dispatch_item_func, item, &err);
+    if (G_UNLIKELY (err != NULL)) {
+      GST_WARNING_OBJECT (bin, "could not push to the pool: %s",
+          err->message);
+      g_error_free (err);
+      bin_dispatch_item_func (item);
+    }
+  }
+  bin_dispatch_item_func (&dispatch->items[0]);
+
+  g_mutex_lock (&dispatch->lock);
+  while (dispatch->pending > 0)
+    g_cond_wait (&dispatch->cond, &dispatch->lock);
+  g_mutex_unlock (&dispatch->lock);
+
+  g_mutex_clear (&dispatch->lock);
+  g_cond_clear (&dispatch->cond);
+}
+
+static guint
+bin_get_parallel_dispatch_threshold (GstBin * bin)
+{
+  guint threshold;
+
+  GST_OBJECT_LOCK (bin);
+  threshold = bin->priv->parallel_dispatch_threshold;
+  GST_OBJECT_UNLOCK (bin);
+
+  return threshold;
+}
+
+/* returns TRUE when @n_children children should be handled concurrently */
+static gboolean
+bin_use_parallel_dispatch (GstBin * bin, guint n_children)
+{
+  guint threshold = bin_get_parallel_dispatch_threshold (bin);
+
+  return threshold > 0 && n_children >= threshold && n_children > 1
+      && bin_ensure_pool (bin);
+}
+
+/* sends @event to @children concurrently and combines the results in the
+ * order of the children */
+static gboolean
+bin_send_event_parallel (GstBin * bin, GPtrArray * children,
+    GstEvent * event)
+{
+  BinDispatch dispatch;
+  gboolean res = TRUE;
+  guint i;
+
+  dispatch.event = event;
+  dispatch.n_items = children->len;
+  dispatch.items = g_new0 (BinDispatchItem, children->len);
+  for (i = 0; i < children->len; i++) {
+    dispatch.items[i].dispatch = &dispatch;
+    dispatch.items[i].child = g_ptr_array_index (children, i);
+  }
+
+  bin_dispatch_run (bin, &dispatch);
+
+  for (i = 0; i < dispatch.n_items; i++) {
+    res &= dispatch.items[i].res;
+    GST_LOG_OBJECT (dispatch.items[i].child, "After handling %s event: %d",
+        GST_EVENT_TYPE_NAME (event), res);
+  }
+  g_free (dispatch.items);
+
+  return res;
+}
+
 /*
  * This function is a utility event handler for seek events.
  * It will send the event to all sinks or sources depending on the
@@ -2784,6 +3443,24 @@ gst_bin_send_event (GstElement * element, GstEvent * event)
         GST_EVENT_TYPE_NAME (event));
   }
 
+  /* with enough children the event is sent from the pool, the loop below
+   * sends it serially otherwise */
+  if (bin_get_parallel_dispatch_threshold (bin) > 0) {
+    GPtrArray *children = bin_collect_children (iter);
+
+    if (children == NULL) {
+      res = FALSE;
+      done = TRUE;
+    } else if (bin_use_parallel_dispatch (bin, children->len)) {
+      res = bin_send_event_parallel (bin, children, event);
+      done = TRUE;
+    } else {
+      gst_iterator_resync (iter);
+    }
+    if (children)
+      g_ptr_array_unref (children);
+  }
+
   while (!done) {
     switch (gst_iterator_next (iter, &data)) {
       case GST_ITERATOR_OK:
@@ -3565,6 +4242,28 @@ gst_bin_handle_message_func (GstBin * bin, GstMessage * message)
 
       break;
     }
+    case GST_MESSAGE_LATENCY:
+    {
+      gboolean drop = FALSE;
+
+      GST_OBJECT_LOCK (bin);
+      /* coalesce LATENCY messages in the toplevel bin, when the previous one
+       * was not handled yet, the recalculation will also pick up this
+       * change */
+      if (GST_OBJECT_PARENT (bin) == NULL) {
+        drop = bin->priv->latency_pending;
+        bin->priv->latency_pending = TRUE;
+      }
+      GST_OBJECT_UNLOCK (bin);
+
+      if (drop) {
+        GST_DEBUG_OBJECT (bin, "dropping LATENCY message, previous one is "
+            "still pending");
+        gst_message_unref (message);
+        break;
+      }
+      goto forward;
+    }
     default:
       goto forward;
   }
@@ -3586,11 +4285,25 @@ typedef struct
   gint64 min;
   gint64 max;
   gboolean live;
+
+  /* the child was already queried with @answer, NULL when it failed */
+  gboolean dispatched;
+  GstQuery *answer;
 } QueryFold;
 
 typedef void (*QueryInitFunction) (GstBin * bin, QueryFold * fold);
 typedef void (*QueryDoneFunction) (GstBin * bin, QueryFold * fold);
 
+/* queries @item and returns the answered query, or NULL when it failed */
+static GstQuery *
+bin_query_child (GstElement * item, QueryFold * fold)
+{
+  if (fold->dispatched)
+    return fold->answer;
+
+  return gst_element_query (item, fold->query) ? fold->query : NULL;
+}
+
 /* for duration/position we collect all durations/positions and take
  * the MAX of all valid results */
 static void
@@ -3605,13 +4318,14 @@ static gboolean
 bin_query_duration_fold (const GValue * vitem, GValue * ret, QueryFold * fold)
 {
   GstElement *item = g_value_get_object (vitem);
+  GstQuery *query;
 
-  if (gst_element_query (item, fold->query)) {
+  if ((query = bin_query_child (item, fold))) {
     gint64 duration;
 
     g_value_set_boolean (ret, TRUE);
 
-    gst_query_parse_duration (fold->query, NULL, &duration);
+    gst_query_parse_duration (query, NULL, &duration);
 
     GST_DEBUG_OBJECT (item, "got duration %" G_GINT64_FORMAT, duration);
 
@@ -3653,13 +4367,14 @@ static gboolean
 bin_query_position_fold (const GValue * vitem, GValue * ret, QueryFold * fold)
 {
   GstElement *item = g_value_get_object (vitem);
+  GstQuery *query;
 
-  if (gst_element_query (item, fold->query)) {
+  if ((query = bin_query_child (item, fold))) {
     gint64 position;
 
     g_value_set_boolean (ret, TRUE);
 
-    gst_query_parse_position (fold->query, NULL, &position);
+    gst_query_parse_position (query, NULL, &position);
 
     GST_DEBUG_OBJECT (item, "got position %" G_GINT64_FORMAT, position);
 
@@ -3686,12 +4401,13 @@ static gboolean
 bin_query_latency_fold (const GValue * vitem, GValue * ret, QueryFold * fold)
 {
   GstElement *item = g_value_get_object (vitem);
+  GstQuery *query;
 
-  if (gst_element_query (item, fold->query)) {
+  if ((query = bin_query_child (item, fold))) {
     GstClockTime min, max;
     gboolean live;
 
-    gst_query_parse_latency (fold->query, &live, &min, &max);
+    gst_query_parse_latency (query, &live, &min, &max);
 
     GST_DEBUG_OBJECT (item,
         "got latency min %" GST_TIME_FORMAT ", max %" GST_TIME_FORMAT
@@ -3745,6 +4461,82 @@ bin_query_generic_fold (const GValue * vitem, GValue * ret, QueryFold * fold)
   return !res;
 }
 
+/* every child adds its own entries, child bins recurse */
+static gboolean
+bin_query_memory_usage (GstBin * bin, GstQuery * query)
+{
+  GList *children, *walk;
+
+  GST_OBJECT_LOCK (bin);
+  children = g_list_copy (bin->children);
+  g_list_foreach (children, (GFunc) gst_object_ref, NULL);
+  GST_OBJECT_UNLOCK (bin);
+
+  for (walk = children; walk; walk = g_list_next (walk)) {
+    GstElement *child = GST_ELEMENT_CAST (walk->data);
+
+    gst_element_query (child, query);
+    gst_object_unref (child);
+  }
+  g_list_free (children);
+
+  return TRUE;
+}
+
+/* queries @children concurrently with copies of the query and folds the
+ * answers in the order of the children */
+static gboolean
+bin_query_parallel (GstBin * bin, GPtrArray * children,
+    GstIteratorFoldFunction fold_func, QueryInitFunction fold_init,
+    QueryDoneFunction fold_done, QueryFold * fold, gboolean res)
+{
+  BinDispatch dispatch;
+  GValue ret = { 0 };
+  GValue item = { 0 };
+  guint i;
+
+  dispatch.event = NULL;
+  dispatch.n_items = children->len;
+  dispatch.items = g_new0 (BinDispatchItem, children->len);
+  for (i = 0; i < children->len; i++) {
+    dispatch.items[i].dispatch = &dispatch;
+    dispatch.items[i].child = g_ptr_array_index (children, i);
+    dispatch.items[i].query = gst_query_copy (fold->query);
+  }
+
+  bin_dispatch_run (bin, &dispatch);
+
+  g_value_init (&ret, G_TYPE_BOOLEAN);
+  g_value_set_boolean (&ret, res);
+  g_value_init (&item, GST_TYPE_ELEMENT);
+
+  fold_init (bin, fold);
+  fold->dispatched = TRUE;
+  for (i = 0; i < dispatch.n_items; i++) {
+    gboolean cont;
+
+    g_value_set_object (&item, dispatch.items[i].child);
+    fold->answer = dispatch.items[i].res ? dispatch.items[i].query : NULL;
+    cont = fold_func (&item, &ret, fold);
+    g_value_reset (&item);
+    if (!cont)
+      break;
+  }
+  fold->dispatched = FALSE;
+  fold->answer = NULL;
+
+  res = g_value_get_boolean (&ret);
+  if (fold_done != NULL && res)
+    fold_done (bin, fold);
+
+  for (i = 0; i < dispatch.n_items; i++)
+    gst_query_unref (dispatch.items[i].query);
+  g_free (dispatch.items);
+  g_value_unset (&item);
+
+  return res;
+}
+
 static gboolean
 gst_bin_query (GstElement * element, GstQuery * query)
 {
@@ -3816,12 +4608,16 @@ gst_bin_query (GstElement * element, GstQuery * query)
       res = TRUE;
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:
+      return bin_query_memory_usage (bin, query);
     default:
       fold_func = (GstIteratorFoldFunction) bin_query_generic_fold;
       break;
   }
 
   fold_data.query = query;
+  fold_data.dispatched = FALSE;
+  fold_data.answer = NULL;
 
   /* set the result of the query to FALSE initially */
   g_value_init (&ret, G_TYPE_BOOLEAN);
@@ -3831,6 +4627,22 @@ gst_bin_query (GstElement * element, GstQuery * query)
   GST_DEBUG_OBJECT (bin, "Sending query %p (type %s) to sink children",
       query, GST_QUERY_TYPE_NAME (query));
 
+  /* the queries that combine the results of all sinks can be sent to them
+   * concurrently */
+  if (fold_init && bin_get_parallel_dispatch_threshold (bin) > 0) {
+    GPtrArray *children = bin_collect_children (iter);
+
+    if (children && bin_use_parallel_dispatch (bin, children->len)) {
+      res = bin_query_parallel (bin, children, fold_func, fold_init,
+          fold_done, &fold_data, res);
+      g_ptr_array_unref (children);
+      goto done;
+    }
+    if (children)
+      g_ptr_array_unref (children);
+    gst_iterator_resync (iter);
+  }
+
   if (fold_init)
     fold_init (bin, &fold_data);
 
@@ -3865,19 +4677,6 @@ done:
   return res;
 }
 
-static gint
-compare_name (const GValue * velement, const gchar * name)
-{
-  gint eq;
-  GstElement *element = g_value_get_object (velement);
-
-  GST_OBJECT_LOCK (element);
-  eq = strcmp (GST_ELEMENT_NAME (element), name);
-  GST_OBJECT_UNLOCK (element);
-
-  return eq;
-}
-
 /**
  * gst_bin_get_by_name:
  * @bin: a #GstBin
@@ -3895,27 +4694,31 @@ compare_name (const GValue * velement, const gchar * name)
 GstElement *
 gst_bin_get_by_name (GstBin * bin, const gchar * name)
 {
-  GstIterator *children;
-  GValue result = { 0, };
   GstElement *element;
-  gboolean found;
+  GList *walk, *bins = NULL;
 
   g_return_val_if_fail (GST_IS_BIN (bin), NULL);
 
   GST_CAT_INFO (GST_CAT_PARENTAGE, "[%s]: looking up child element %s",
       GST_ELEMENT_NAME (bin), name);
 
-  children = gst_bin_iterate_recurse (bin);
-  found = gst_iterator_find_custom (children,
-      (GCompareFunc) compare_name, &result, (gpointer) name);
-  gst_iterator_free (children);
-
-  if (found) {
-    element = g_value_dup_object (&result);
-    g_value_unset (&result);
-  } else {
-    element = NULL;
+  /* look in our own children first, then in the child bins */
+  GST_OBJECT_LOCK (bin);
+  if ((element = bin_lookup_child (bin, name))) {
+    gst_object_ref (element);
+    GST_OBJECT_UNLOCK (bin);
+    return element;
+  }
+  for (walk = bin->children; walk; walk = g_list_next (walk)) {
+    if (GST_IS_BIN (walk->data))
+      bins = g_list_prepend (bins, gst_object_ref (walk->data));
   }
+  GST_OBJECT_UNLOCK (bin);
+
+  bins = g_list_reverse (bins);
+  for (walk = bins; walk && element == NULL; walk = g_list_next (walk))
+    element = gst_bin_get_by_name (GST_BIN_CAST (walk->data), name);
+  g_list_free_full (bins, (GDestroyNotify) gst_object_unref);
 
   return element;
 }
@@ -136,7 +136,9 @@ struct _GstMetaItem
 };
 #define ITEM_SIZE(info) ((info)->size + sizeof (GstMetaItem))
 
-#define GST_BUFFER_MEM_MAX         16
+/* this many memory blocks are stored in the buffer itself, more are
+ * stored in a separately allocated array */
+#define GST_BUFFER_MEM_INLINE      16
 
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
@@ -144,6 +146,12 @@ struct _GstMetaItem
 #define GST_BUFFER_MEM_PTR(b,i)    (((GstBufferImpl *)(b))->mem[i])
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
+#define GST_BUFFER_N_META(b)       (((GstBufferImpl *)(b))->n_meta)
+
+/* the api types of the metas of a buffer with at most this many metas are
+ * also stored in the buffer itself, so that gst_buffer_get_meta() does not
+ * need to walk the list */
+#define GST_BUFFER_META_INLINE     4
 
 typedef struct
 {
@@ -151,9 +159,12 @@ typedef struct
 
   gsize slice_size;
 
-  /* the memory blocks */
+  /* the memory blocks, mem points to mem_inline or to an allocated array
+   * of mem_size entries */
   guint len;
-  GstMemory *mem[GST_BUFFER_MEM_MAX];
+  guint mem_size;
+  GstMemory **mem;
+  GstMemory *mem_inline[GST_BUFFER_MEM_INLINE];
 
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
@@ -161,6 +172,12 @@ typedef struct
   /* FIXME, make metadata allocation more efficient by using part of the
    * GstBufferImpl */
   GstMetaItem *item;
+
+  /* the number of metas. When there are no more than GST_BUFFER_META_INLINE,
+   * their api types and the metas in the order in which they were added */
+  guint n_meta;
+  GType meta_api[GST_BUFFER_META_INLINE];
+  GstMeta *meta_inline[GST_BUFFER_META_INLINE];
 } GstBufferImpl;
 
 
@@ -296,16 +313,20 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem, gboolean lock)
   GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %d, mem %p, lock %d", buffer,
       idx, mem, lock);
 
-  if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
-    /* too many buffer, span them. */
-    /* FIXME, there is room for improvement here: We could only try to merge
-     * 2 buffers to make some room. If we can't efficiently merge 2 buffers we
-     * could try to only merge the two smallest buffers to avoid memcpy, etc. */
-    GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "memory array overflow in buffer %p",
-        buffer);
-    _replace_memory (buffer, len, 0, len, _get_merged_memory (buffer, 0, len));
-    /* we now have 1 single spanned buffer */
-    len = 1;
+  if (G_UNLIKELY (len >= ((GstBufferImpl *) buffer)->mem_size)) {
+    GstBufferImpl *impl = (GstBufferImpl *) buffer;
+    guint size = impl->mem_size * 2;
+
+    /* move to a larger array instead of merging the memory */
+    GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "growing memory array of buffer %p "
+        "to %u entries", buffer, size);
+    if (impl->mem == impl->mem_inline) {
+      impl->mem = g_new (GstMemory *, size);
+      memcpy (impl->mem, impl->mem_inline, len * sizeof (GstMemory *));
+    } else {
+      impl->mem = g_renew (GstMemory *, impl->mem, size);
+    }
+    impl->mem_size = size;
   }
 
   if (idx == -1)
@@ -530,13 +551,15 @@ _gst_buffer_free (GstBuffer * buffer)
     gst_memory_unlock (GST_BUFFER_MEM_PTR (buffer, i), GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (GST_BUFFER_MEM_PTR (buffer, i));
   }
+  if (GST_BUFFER_MEM_ARRAY (buffer) != ((GstBufferImpl *) buffer)->mem_inline)
+    g_free (GST_BUFFER_MEM_ARRAY (buffer));
 
   /* we set msize to 0 when the buffer is part of the memory block */
   if (msize) {
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    _priv_gst_slab_free (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -560,7 +583,10 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
   GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
+  buffer->mem_size = GST_BUFFER_MEM_INLINE;
+  buffer->mem = buffer->mem_inline;
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_N_META (buffer) = 0;
 }
 
 /**
@@ -577,7 +603,7 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_slab_alloc (sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -1488,6 +1514,88 @@ gst_buffer_unmap (GstBuffer * buffer, GstMapInfo * info)
   }
 }
 
+/**
+ * gst_buffer_map_range_vec:
+ * @buffer: a #GstBuffer.
+ * @idx: an index
+ * @length: a length
+ * @infos: (out caller-allocates) (array): room for the #GstMapInfo of
+ *     every mapped memory block
+ * @flags: flags for the mapping
+ *
+ * Maps each of the @length memory blocks starting at @idx in @buffer
+ * separately and fills @infos with one #GstMapInfo per memory block. When
+ * @length is -1, all memory blocks starting from @idx are mapped and @infos
+ * must have room for gst_buffer_n_memory() - @idx entries.
+ *
+ * Unlike gst_buffer_map_range(), the memory blocks are never merged into
+ * a new memory block, which avoids copying the data when the caller can
+ * handle the data in pieces, for example by writing it with writev().
+ * @flags and writability are handled like gst_buffer_map_range() does for
+ * every memory block.
+ *
+ * The memory in @infos should be unmapped with gst_buffer_unmap_vec() after
+ * usage.
+ *
+ * Returns: %TRUE if all memory blocks were mapped. Nothing is mapped when
+ * %FALSE is returned.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_buffer_map_range_vec (GstBuffer * buffer, guint idx, gint length,
+    GstMapInfo * infos, GstMapFlags flags)
+{
+  guint i, len;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (infos != NULL, FALSE);
+  len = GST_BUFFER_MEM_LEN (buffer);
+  g_return_val_if_fail ((len == 0 && idx == 0 && length == -1) ||
+      (length == -1 && idx < len) || (length > 0
+          && length + idx <= len), FALSE);
+
+  if (length == -1)
+    length = len - idx;
+
+  for (i = 0; i < (guint) length; i++) {
+    if (G_UNLIKELY (!gst_buffer_map_range (buffer, idx + i, 1, &infos[i],
+                flags)))
+      goto cannot_map;
+  }
+  return TRUE;
+
+  /* ERROR */
+cannot_map:
+  {
+    GST_DEBUG_OBJECT (buffer, "cannot map memory %u", idx + i);
+    gst_buffer_unmap_vec (buffer, infos, i);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_buffer_unmap_vec:
+ * @buffer: a #GstBuffer.
+ * @infos: (array length=n_infos): the #GstMapInfo of the memory blocks
+ * @n_infos: the number of entries in @infos
+ *
+ * Release the memory previously mapped with gst_buffer_map_range_vec().
+ *
+ * Since: 1.2
+ */
+void
+gst_buffer_unmap_vec (GstBuffer * buffer, GstMapInfo * infos, guint n_infos)
+{
+  guint i;
+
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+  g_return_if_fail (n_infos == 0 || infos != NULL);
+
+  for (i = 0; i < n_infos; i++)
+    gst_buffer_unmap (buffer, &infos[i]);
+}
+
 /**
  * gst_buffer_fill:
  * @buffer: a #GstBuffer.
@@ -1789,6 +1897,27 @@ gst_buffer_append_region (GstBuffer * buf1, GstBuffer * buf2, gssize offset,
   return buf1;
 }
 
+/* called after a meta was removed from the list, refills the inline api
+ * types when there are few enough metas left */
+static void
+_gst_buffer_meta_removed (GstBuffer * buffer)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+  GstMetaItem *walk;
+  guint n;
+
+  n = --impl->n_meta;
+  if (n > GST_BUFFER_META_INLINE)
+    return;
+
+  /* the list has the newest meta first */
+  for (walk = impl->item; walk; walk = walk->next) {
+    n--;
+    impl->meta_api[n] = walk->meta.info->api;
+    impl->meta_inline[n] = &walk->meta;
+  }
+}
+
 /**
  * gst_buffer_get_meta:
  * @buffer: a #GstBuffer
@@ -1804,10 +1933,24 @@ gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
   GstMetaItem *item;
   GstMeta *result = NULL;
+  guint n;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
+  n = GST_BUFFER_N_META (buffer);
+  if (G_LIKELY (n <= GST_BUFFER_META_INLINE)) {
+    GstBufferImpl *impl = (GstBufferImpl *) buffer;
+
+    /* newest first, like the list */
+    while (n > 0) {
+      n--;
+      if (impl->meta_api[n] == api)
+        return impl->meta_inline[n];
+    }
+    return NULL;
+  }
+
   /* find GstMeta of the requested API */
   for (item = GST_BUFFER_META (buffer); item; item = item->next) {
     GstMeta *meta = &item->meta;
@@ -1836,6 +1979,7 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   GstMetaItem *item;
   GstMeta *result = NULL;
   gsize size;
+  guint n;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (info != NULL, NULL);
@@ -1861,6 +2005,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
   item->next = GST_BUFFER_META (buffer);
   GST_BUFFER_META (buffer) = item;
 
+  n = GST_BUFFER_N_META (buffer);
+  if (n < GST_BUFFER_META_INLINE) {
+    ((GstBufferImpl *) buffer)->meta_api[n] = info->api;
+    ((GstBufferImpl *) buffer)->meta_inline[n] = result;
+  }
+  GST_BUFFER_N_META (buffer) = n + 1;
+
   return result;
 
 init_failed:
@@ -1903,6 +2054,7 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         GST_BUFFER_META (buffer) = walk->next;
       else
         prev->next = walk->next;
+      _gst_buffer_meta_removed (buffer);
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
@@ -2000,6 +2152,7 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         GST_BUFFER_META (buffer) = next;
       else
         prev->next = next;
+      _gst_buffer_meta_removed (buffer);
 
       /* call free_func if any */
       if (info->free_func)
@@ -2007,6 +2160,8 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
 
       /* and free the slice */
       g_slice_free1 (ITEM_SIZE (info), walk);
+    } else {
+      prev = walk;
     }
     if (!res)
       break;
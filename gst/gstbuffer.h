@@ -307,6 +307,11 @@ gboolean    gst_buffer_map                 (GstBuffer *buffer, GstMapInfo *info,
 
 void        gst_buffer_unmap               (GstBuffer *buffer, GstMapInfo *info);
 
+gboolean    gst_buffer_map_range_vec       (GstBuffer *buffer, guint idx, gint length,
+                                            GstMapInfo *infos, GstMapFlags flags);
+void        gst_buffer_unmap_vec           (GstBuffer *buffer, GstMapInfo *infos,
+                                            guint n_infos);
+
 
 /* refcounting */
 /**
@@ -59,12 +59,60 @@ GType _gst_buffer_list_type = 0;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstBufferList, gst_buffer_list);
 
+/* freed lists are kept here with their array so that a new list can be made
+ * without allocating, lists that held more buffers than
+ * BUFFER_LIST_CACHE_MAX_LEN are not kept to not waste memory */
+#define BUFFER_LIST_CACHE_N 16
+#define BUFFER_LIST_CACHE_MAX_LEN 1024
+
+static GstBufferList *buffer_list_cache[BUFFER_LIST_CACHE_N];
+
 void
 _priv_gst_buffer_list_initialize (void)
 {
   _gst_buffer_list_type = gst_buffer_list_get_type ();
 }
 
+static GstBufferList *
+gst_buffer_list_cache_take (void)
+{
+  GstBufferList *list;
+  gint i;
+
+  for (i = 0; i < BUFFER_LIST_CACHE_N; i++) {
+    list = g_atomic_pointer_get (&buffer_list_cache[i]);
+    if (list != NULL && g_atomic_pointer_compare_and_exchange
+        (&buffer_list_cache[i], list, NULL))
+      return list;
+  }
+  return NULL;
+}
+
+static gboolean
+gst_buffer_list_cache_put (GstBufferList * list)
+{
+  gint i;
+
+  for (i = 0; i < BUFFER_LIST_CACHE_N; i++) {
+    if (g_atomic_pointer_get (&buffer_list_cache[i]) == NULL &&
+        g_atomic_pointer_compare_and_exchange (&buffer_list_cache[i], NULL,
+            list))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+void
+_priv_gst_buffer_list_deinit (void)
+{
+  GstBufferList *list;
+
+  while ((list = gst_buffer_list_cache_take ())) {
+    g_array_free (list->array, TRUE);
+    g_slice_free1 (sizeof (GstBufferList), list);
+  }
+}
+
 static GstBufferList *
 _gst_buffer_list_copy (GstBufferList * list)
 {
@@ -74,12 +122,11 @@ _gst_buffer_list_copy (GstBufferList * list)
   len = list->array->len;
   copy = gst_buffer_list_new_sized (len);
 
-  /* add and ref all buffers in the array */
-  for (i = 0; i < len; i++) {
-    GstBuffer *buf = g_array_index (list->array, GstBuffer *, i);
-    buf = gst_buffer_ref (buf);
-    g_array_append_val (copy->array, buf);
-  }
+  /* copy all the pointers in one go and ref the buffers */
+  g_array_append_vals (copy->array, list->array->data, len);
+  for (i = 0; i < len; i++)
+    gst_buffer_ref (g_array_index (copy->array, GstBuffer *, i));
+
   return copy;
 }
 
@@ -93,6 +140,14 @@ _gst_buffer_list_free (GstBufferList * list)
   len = list->array->len;
   for (i = 0; i < len; i++)
     gst_buffer_unref (g_array_index (list->array, GstBuffer *, i));
+
+  if (len <= BUFFER_LIST_CACHE_MAX_LEN) {
+    g_array_set_size (list->array, 0);
+    if (gst_buffer_list_cache_put (list)) {
+      GST_LOG ("keeping %p for reuse", list);
+      return;
+    }
+  }
   g_array_free (list->array, TRUE);
 
   g_slice_free1 (sizeof (GstBufferList), list);
@@ -105,7 +160,15 @@ gst_buffer_list_init (GstBufferList * list, guint asize)
       (GstMiniObjectCopyFunction) _gst_buffer_list_copy, NULL,
       (GstMiniObjectFreeFunction) _gst_buffer_list_free);
 
-  list->array = g_array_sized_new (FALSE, FALSE, sizeof (GstBuffer *), asize);
+  if (list->array == NULL) {
+    list->array = g_array_sized_new (FALSE, FALSE, sizeof (GstBuffer *),
+        asize);
+  } else {
+    /* a reused array, growing and shrinking it again makes sure there is
+     * room for @asize buffers and does nothing when there already is */
+    g_array_set_size (list->array, asize);
+    g_array_set_size (list->array, 0);
+  }
 
   GST_LOG ("init %p", list);
 }
@@ -118,6 +181,9 @@ gst_buffer_list_init (GstBufferList * list, guint asize)
  * the returned #GstBufferList. The list will have @size space preallocated so
  * that memory reallocations can be avoided.
  *
+ * Lists that were freed are reused when possible, which avoids allocating the
+ * list and its array.
+ *
  * Free-function: gst_buffer_list_unref
  *
  * Returns: (transfer full): the new #GstBufferList. gst_buffer_list_unref()
@@ -128,7 +194,9 @@ gst_buffer_list_new_sized (guint size)
 {
   GstBufferList *list;
 
-  list = g_slice_new0 (GstBufferList);
+  list = gst_buffer_list_cache_take ();
+  if (list == NULL)
+    list = g_slice_new0 (GstBufferList);
 
   GST_LOG ("new %p", list);
 
@@ -189,39 +257,119 @@ gboolean
 gst_buffer_list_foreach (GstBufferList * list, GstBufferListFunc func,
     gpointer user_data)
 {
-  guint i, len;
+  guint i, j, len;
   gboolean ret = TRUE;
 
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
 
+  /* i is the buffer we look at and j its index in the resulting list, the
+   * buffers are moved down over removed ones as we go */
   len = list->array->len;
-  for (i = 0; i < len;) {
-    GstBuffer *buf, *buf_ret;
-
-    buf = buf_ret = g_array_index (list->array, GstBuffer *, i);
-    ret = func (&buf_ret, i, user_data);
-
-    /* Check if the function changed the buffer */
-    if (buf != buf_ret) {
-      if (buf_ret == NULL) {
-        g_array_remove_index (list->array, i);
-        len--;
-      } else {
-        g_array_index (list->array, GstBuffer *, i) = buf_ret;
-      }
-    }
+  for (i = 0, j = 0; i < len;) {
+    GstBuffer *buf;
 
-    if (!ret)
-      break;
+    buf = g_array_index (list->array, GstBuffer *, i++);
+    ret = func (&buf, j, user_data);
 
     /* If the buffer was not removed by func go to the next buffer */
-    if (buf_ret != NULL)
-      i++;
+    if (buf != NULL)
+      g_array_index (list->array, GstBuffer *, j++) = buf;
+
+    if (!ret)
+      break;
   }
+  /* close the gap left by the removed buffers */
+  if (j < i)
+    g_array_remove_range (list->array, j, i - j);
+
   return ret;
 }
 
+/* trim @buf to the clipped byte range when its size matches its offsets */
+static GstBuffer *
+gst_buffer_list_trim_bytes (GstBuffer * buf, guint64 start, guint64 stop,
+    guint64 cstart, guint64 cstop)
+{
+  if (stop - start != gst_buffer_get_size (buf))
+    return buf;
+
+  buf = gst_buffer_make_writable (buf);
+  gst_buffer_resize (buf, cstart - start, cstop - cstart);
+  GST_BUFFER_OFFSET (buf) = cstart;
+  if (GST_BUFFER_OFFSET_END_IS_VALID (buf))
+    GST_BUFFER_OFFSET_END (buf) = cstop;
+
+  return buf;
+}
+
+/**
+ * gst_buffer_list_clip:
+ * @list: a writable #GstBufferList
+ * @segment: the #GstSegment to clip against
+ *
+ * Remove the buffers of @list that are completely outside of @segment, in one
+ * pass and without reallocating the list. The buffers are checked like
+ * gst_segment_clip() does for one buffer. In %GST_FORMAT_TIME the PTS, or
+ * the DTS when there is no PTS, and the duration are used. In
+ * %GST_FORMAT_BYTES the offsets are used. Buffers without a position in
+ * the format of @segment are kept.
+ *
+ * In %GST_FORMAT_BYTES the buffers on the edges of @segment are trimmed to
+ * the part inside of it. In other formats the buffers on the edges are kept
+ * as they are because the layout of their data is not known here.
+ *
+ * Returns: the number of buffers left in @list.
+ *
+ * Since: 1.2
+ */
+guint
+gst_buffer_list_clip (GstBufferList * list, const GstSegment * segment)
+{
+  guint i, j, len;
+
+  g_return_val_if_fail (GST_IS_BUFFER_LIST (list), 0);
+  g_return_val_if_fail (gst_buffer_list_is_writable (list), 0);
+  g_return_val_if_fail (segment != NULL, 0);
+
+  len = list->array->len;
+  for (i = 0, j = 0; i < len; i++) {
+    GstBuffer *buf = g_array_index (list->array, GstBuffer *, i);
+    guint64 start = -1, stop = -1, cstart, cstop;
+
+    if (segment->format == GST_FORMAT_TIME) {
+      start = GST_BUFFER_PTS (buf);
+      if (!GST_CLOCK_TIME_IS_VALID (start))
+        start = GST_BUFFER_DTS (buf);
+      if (GST_CLOCK_TIME_IS_VALID (start) && GST_BUFFER_DURATION_IS_VALID (buf))
+        stop = start + GST_BUFFER_DURATION (buf);
+    } else if (segment->format == GST_FORMAT_BYTES) {
+      start = GST_BUFFER_OFFSET (buf);
+      stop = GST_BUFFER_OFFSET_END (buf);
+      if (start != -1 && stop == -1)
+        stop = start + gst_buffer_get_size (buf);
+    }
+
+    if (start != -1) {
+      if (!gst_segment_clip (segment, segment->format, start, stop, &cstart,
+              &cstop)) {
+        GST_LOG ("list %p, dropping buffer %p outside of the segment", list,
+            buf);
+        gst_buffer_unref (buf);
+        continue;
+      }
+      if (segment->format == GST_FORMAT_BYTES && (cstart != start
+              || cstop != stop))
+        buf = gst_buffer_list_trim_bytes (buf, start, stop, cstart, cstop);
+    }
+    g_array_index (list->array, GstBuffer *, j++) = buf;
+  }
+  /* shrinking never reallocates */
+  g_array_set_size (list->array, j);
+
+  return j;
+}
+
 /**
  * gst_buffer_list_get:
  * @list: a #GstBufferList
@@ -277,6 +425,60 @@ gst_buffer_list_insert (GstBufferList * list, gint idx, GstBuffer * buffer)
   }
 }
 
+/**
+ * gst_buffer_list_add_list:
+ * @l: a #GstBufferList
+ * @o: (transfer full): a #GstBufferList
+ *
+ * Append the buffers of @o at the end of @l.
+ *
+ * Since: 1.2
+ */
+/**
+ * gst_buffer_list_insert_list:
+ * @list: a #GstBufferList
+ * @idx: the index
+ * @other: (transfer full): a #GstBufferList
+ *
+ * Insert all the buffers of @other at @idx in @list, in their order. Other
+ * buffers are moved to make room for them, this is done once for all the
+ * buffers.
+ *
+ * When @other is writable its buffers are moved to @list without touching
+ * their refcount, else @list takes a new ref to each of them. @other is
+ * unreffed in both cases.
+ *
+ * A -1 value for @idx will append the buffers at the end.
+ *
+ * Since: 1.2
+ */
+void
+gst_buffer_list_insert_list (GstBufferList * list, gint idx,
+    GstBufferList * other)
+{
+  guint i, len;
+
+  g_return_if_fail (GST_IS_BUFFER_LIST (list));
+  g_return_if_fail (GST_IS_BUFFER_LIST (other));
+  g_return_if_fail (list != other);
+  g_return_if_fail (idx == -1 || idx < list->array->len);
+
+  if (idx == -1)
+    idx = list->array->len;
+
+  len = other->array->len;
+  g_array_insert_vals (list->array, idx, other->array->data, len);
+
+  if (gst_buffer_list_is_writable (other)) {
+    /* the buffers now belong to @list */
+    g_array_set_size (other->array, 0);
+  } else {
+    for (i = 0; i < len; i++)
+      gst_buffer_ref (g_array_index (list->array, GstBuffer *, idx + i));
+  }
+  gst_buffer_list_unref (other);
+}
+
 /**
  * gst_buffer_list_remove:
  * @list: a #GstBufferList
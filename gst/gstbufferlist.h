@@ -24,6 +24,7 @@
 #define __GST_BUFFER_LIST_H__
 
 #include <gst/gstbuffer.h>
+#include <gst/gstsegment.h>
 
 G_BEGIN_DECLS
 
@@ -153,13 +154,18 @@ guint                    gst_buffer_list_length                (GstBufferList *l
 
 GstBuffer *              gst_buffer_list_get                   (GstBufferList *list, guint idx);
 void                     gst_buffer_list_insert                (GstBufferList *list, gint idx, GstBuffer *buffer);
+void                     gst_buffer_list_insert_list           (GstBufferList *list, gint idx, GstBufferList *other);
 void                     gst_buffer_list_remove                (GstBufferList *list, guint idx, guint length);
 
 gboolean                 gst_buffer_list_foreach               (GstBufferList *list,
                                                                 GstBufferListFunc func,
 								gpointer user_data);
 
+guint                    gst_buffer_list_clip                  (GstBufferList *list,
+                                                                const GstSegment *segment);
+
 #define gst_buffer_list_add(l,b) gst_buffer_list_insert((l),-1,(b));
+#define gst_buffer_list_add_list(l,o) gst_buffer_list_insert_list((l),-1,(o));
 
 G_END_DECLS
 
@@ -73,6 +73,9 @@
 #  include <unistd.h>
 #endif
 #include <sys/types.h>
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>
+#endif
 
 #include "gstatomicqueue.h"
 #include "gstpoll.h"
@@ -91,11 +94,60 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+/* number of buffers a per-thread magazine can hold and the number of buffers
+ * that are moved between a magazine and the shared queue in one go */
+#define MAGAZINE_SIZE   16
+#define MAGAZINE_BATCH  (MAGAZINE_SIZE / 2)
+
+/* A magazine is a small per-thread cache of free buffers for one pool. It is
+ * referenced from the pool and from the thread that uses it. The lock is
+ * practically never contended, it is only taken by other threads when the
+ * pool is stopped or when an acquire would otherwise block. */
+typedef struct
+{
+  gint refcount;
+  GMutex lock;
+  /* the pool, set to NULL when the pool is finalized */
+  GstBufferPool *pool;
+  guint n_buffers;
+  GstBuffer *buffers[MAGAZINE_SIZE];
+} GstBufferPoolMagazine;
+
+static void magazine_cache_free (gpointer data);
+
+/* transparent hugepages are used for arenas of at least this size */
+#define ARENA_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/* A contiguous mapping that the preallocated buffers of a pool are carved
+ * from. It is referenced by the pool while it is started and by every memory
+ * that was carved from it, the mapping is released when the last memory is
+ * freed. */
+typedef struct
+{
+  gint refcount;
+  guint8 *data;
+  gsize size;
+  /* size of one slot in the arena */
+  gsize slot_size;
+  guint n_slots;
+  /* index of the next unused slot */
+  gint next_slot;
+} GstBufferPoolArena;
+
+/* GSList of the GstBufferPoolMagazines of the current thread */
+static GPrivate magazine_cache = G_PRIVATE_INIT (magazine_cache_free);
+
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
   GstPoll *poll;
 
+  /* per-thread magazines */
+  gboolean thread_cache;
+  GMutex magazines_lock;
+  GList *magazines;
+  gint waiting;
+
   GRecMutex rec_lock;
 
   gboolean started;
@@ -111,6 +163,18 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* preallocate from one hugepage-backed arena */
+  gboolean hugepages;
+  GstBufferPoolArena *arena;
+
+  /* number of acquires that found no free buffer */
+  gint starved;
+
+  /* preallocate the buffers in a thread when starting */
+  gboolean async_prealloc;
+  GThread *prealloc_thread;
+  gint prealloc_cancel;
 };
 
 enum
@@ -134,6 +198,8 @@ static GstFlowReturn default_acquire_buffer (GstBufferPool * pool,
 static void default_reset_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_free_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_release_buffer (GstBufferPool * pool, GstBuffer * buffer);
+static const gchar **default_get_options (GstBufferPool * pool);
+static void gst_buffer_pool_release_magazines (GstBufferPool * pool);
 
 static void
 gst_buffer_pool_class_init (GstBufferPoolClass * klass)
@@ -144,6 +210,7 @@ gst_buffer_pool_class_init (GstBufferPoolClass * klass)
 
   gobject_class->finalize = gst_buffer_pool_finalize;
 
+  klass->get_options = default_get_options;
   klass->start = default_start;
   klass->stop = default_stop;
   klass->set_config = default_set_config;
@@ -165,6 +232,7 @@ gst_buffer_pool_init (GstBufferPool * pool)
   priv = pool->priv = GST_BUFFER_POOL_GET_PRIVATE (pool);
 
   g_rec_mutex_init (&priv->rec_lock);
+  g_mutex_init (&priv->magazines_lock);
 
   priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (10);
@@ -195,6 +263,10 @@ gst_buffer_pool_finalize (GObject * object)
   GST_DEBUG_OBJECT (pool, "finalize");
 
   gst_buffer_pool_set_active (pool, FALSE);
+  if (priv->prealloc_thread)
+    g_thread_join (priv->prealloc_thread);
+  gst_buffer_pool_release_magazines (pool);
+  g_mutex_clear (&priv->magazines_lock);
   gst_atomic_queue_unref (priv->queue);
   gst_poll_free (priv->poll);
   gst_structure_free (priv->config);
@@ -223,12 +295,353 @@ gst_buffer_pool_new (void)
   return result;
 }
 
+static void
+magazine_unref (GstBufferPoolMagazine * mag)
+{
+  if (g_atomic_int_dec_and_test (&mag->refcount)) {
+    g_mutex_clear (&mag->lock);
+    g_slice_free (GstBufferPoolMagazine, mag);
+  }
+}
+
+/* move @count buffers from @mag to the shared queue of the pool. Must be
+ * called with the magazine lock */
+static void
+magazine_flush_unlocked (GstBufferPoolMagazine * mag, guint count)
+{
+  GstBufferPoolPrivate *priv = mag->pool->priv;
+  gpointer *buffers;
+  guint pushed;
+
+  count = MIN (count, mag->n_buffers);
+  if (count == 0)
+    return;
+
+  mag->n_buffers -= count;
+  buffers = (gpointer *) & mag->buffers[mag->n_buffers];
+
+  pushed = gst_atomic_queue_push_many (priv->queue, buffers, count);
+  while (pushed < count)
+    gst_atomic_queue_push (priv->queue, buffers[pushed++]);
+
+  while (count--)
+    gst_poll_write_control (priv->poll);
+}
+
+/* called when a thread exits, give the cached buffers back to their pool */
+static void
+magazine_cache_free (gpointer data)
+{
+  GSList *walk;
+
+  for (walk = data; walk; walk = g_slist_next (walk)) {
+    GstBufferPoolMagazine *mag = walk->data;
+
+    g_mutex_lock (&mag->lock);
+    if (mag->pool)
+      magazine_flush_unlocked (mag, mag->n_buffers);
+    g_mutex_unlock (&mag->lock);
+
+    magazine_unref (mag);
+  }
+  g_slist_free (data);
+}
+
+/* get the magazine of the current thread for @pool, create one when there
+ * is none yet */
+static GstBufferPoolMagazine *
+gst_buffer_pool_get_magazine (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag;
+  GSList *list, *walk, *next;
+  gboolean changed = FALSE;
+
+  list = g_private_get (&magazine_cache);
+  for (walk = list; walk; walk = next) {
+    GstBufferPool *owner;
+
+    mag = walk->data;
+    next = g_slist_next (walk);
+
+    owner = g_atomic_pointer_get (&mag->pool);
+    if (G_LIKELY (owner == pool)) {
+      if (changed)
+        g_private_set (&magazine_cache, list);
+      return mag;
+    }
+
+    if (owner == NULL) {
+      /* the pool of this magazine is gone, remove it */
+      list = g_slist_delete_link (list, walk);
+      magazine_unref (mag);
+      changed = TRUE;
+    }
+  }
+
+  mag = g_slice_new0 (GstBufferPoolMagazine);
+  /* one ref for the pool and one for the thread */
+  mag->refcount = 2;
+  g_mutex_init (&mag->lock);
+  mag->pool = pool;
+
+  g_mutex_lock (&priv->magazines_lock);
+  priv->magazines = g_list_prepend (priv->magazines, mag);
+  g_mutex_unlock (&priv->magazines_lock);
+
+  GST_DEBUG_OBJECT (pool, "created magazine %p for thread %p", mag,
+      g_thread_self ());
+
+  list = g_slist_prepend (list, mag);
+  g_private_set (&magazine_cache, list);
+
+  return mag;
+}
+
+/* take a buffer from the magazine of the current thread. When the magazine
+ * is empty, it is refilled with a batch of buffers from the shared queue. */
+static GstBuffer *
+gst_buffer_pool_magazine_pop (GstBufferPool * pool,
+    GstBufferPoolMagazine * mag)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer = NULL;
+
+  g_mutex_lock (&mag->lock);
+  if (mag->n_buffers == 0) {
+    guint i;
+
+    mag->n_buffers = gst_atomic_queue_pop_many (priv->queue,
+        (gpointer *) mag->buffers, MAGAZINE_BATCH);
+    for (i = 0; i < mag->n_buffers; i++)
+      gst_poll_read_control (priv->poll);
+  }
+  if (mag->n_buffers > 0)
+    buffer = mag->buffers[--mag->n_buffers];
+  g_mutex_unlock (&mag->lock);
+
+  return buffer;
+}
+
+/* put @buffer in the magazine of the current thread. When the magazine is
+ * full, a batch of buffers is moved to the shared queue. When another thread
+ * is waiting for a buffer, all buffers go to the shared queue so that the
+ * waiting thread can pick them up. */
+static void
+gst_buffer_pool_magazine_push (GstBufferPool * pool,
+    GstBufferPoolMagazine * mag, GstBuffer * buffer)
+{
+  g_mutex_lock (&mag->lock);
+  if (mag->n_buffers == MAGAZINE_SIZE)
+    magazine_flush_unlocked (mag, MAGAZINE_BATCH);
+  mag->buffers[mag->n_buffers++] = buffer;
+  if (G_UNLIKELY (g_atomic_int_get (&pool->priv->waiting) > 0))
+    magazine_flush_unlocked (mag, mag->n_buffers);
+  g_mutex_unlock (&mag->lock);
+}
+
+/* take a batch of buffers from one of the other magazines of @pool, return
+ * one and put the others in @mag. This is used before blocking in acquire so
+ * that buffers cached in other threads are not lost. */
+static GstBuffer *
+gst_buffer_pool_steal_buffer (GstBufferPool * pool,
+    GstBufferPoolMagazine * mag)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *stolen[MAGAZINE_BATCH];
+  guint i, n_stolen = 0;
+  GList *walk;
+
+  g_mutex_lock (&priv->magazines_lock);
+  for (walk = priv->magazines; walk && !n_stolen; walk = g_list_next (walk)) {
+    GstBufferPoolMagazine *other = walk->data;
+
+    if (other == mag)
+      continue;
+
+    g_mutex_lock (&other->lock);
+    n_stolen = MIN (other->n_buffers, MAGAZINE_BATCH);
+    other->n_buffers -= n_stolen;
+    memcpy (stolen, &other->buffers[other->n_buffers],
+        n_stolen * sizeof (GstBuffer *));
+    g_mutex_unlock (&other->lock);
+  }
+  g_mutex_unlock (&priv->magazines_lock);
+
+  if (n_stolen == 0)
+    return NULL;
+
+  /* the next acquires of this thread take the rest from its magazine */
+  g_mutex_lock (&mag->lock);
+  for (i = 1; i < n_stolen; i++) {
+    if (mag->n_buffers == MAGAZINE_SIZE)
+      magazine_flush_unlocked (mag, MAGAZINE_BATCH);
+    mag->buffers[mag->n_buffers++] = stolen[i];
+  }
+  g_mutex_unlock (&mag->lock);
+
+  return stolen[0];
+}
+
+/* move the buffers of all magazines back to the shared queue and drop the
+ * magazines of threads that have exited */
+static void
+gst_buffer_pool_flush_magazines (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GList *walk, *next;
+
+  g_mutex_lock (&priv->magazines_lock);
+  for (walk = priv->magazines; walk; walk = next) {
+    GstBufferPoolMagazine *mag = walk->data;
+
+    next = g_list_next (walk);
+
+    g_mutex_lock (&mag->lock);
+    magazine_flush_unlocked (mag, mag->n_buffers);
+    g_mutex_unlock (&mag->lock);
+
+    /* only our ref left, the thread is gone */
+    if (g_atomic_int_get (&mag->refcount) == 1) {
+      priv->magazines = g_list_delete_link (priv->magazines, walk);
+      magazine_unref (mag);
+    }
+  }
+  g_mutex_unlock (&priv->magazines_lock);
+}
+
+/* detach all magazines from @pool and free the buffers they still hold,
+ * called when the pool is finalized */
+static void
+gst_buffer_pool_release_magazines (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+  GList *walk;
+
+  g_mutex_lock (&priv->magazines_lock);
+  for (walk = priv->magazines; walk; walk = g_list_next (walk)) {
+    GstBufferPoolMagazine *mag = walk->data;
+
+    g_mutex_lock (&mag->lock);
+    /* the shared queue is about to be freed too */
+    while (mag->n_buffers > 0) {
+      GstBuffer *buffer = mag->buffers[--mag->n_buffers];
+
+      if (G_LIKELY (pclass->free_buffer))
+        pclass->free_buffer (pool, buffer);
+    }
+    g_atomic_pointer_set (&mag->pool, NULL);
+    g_mutex_unlock (&mag->lock);
+
+    magazine_unref (mag);
+  }
+  g_list_free (priv->magazines);
+  priv->magazines = NULL;
+  g_mutex_unlock (&priv->magazines_lock);
+}
+
+#ifdef HAVE_MMAP
+static void
+arena_unref (GstBufferPoolArena * arena)
+{
+  if (g_atomic_int_dec_and_test (&arena->refcount)) {
+    munmap (arena->data, arena->size);
+    g_slice_free (GstBufferPoolArena, arena);
+  }
+}
+
+static GstBufferPoolArena *
+arena_new (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolArena *arena;
+  gsize align, slot_size, size, page_size;
+  gpointer data;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  align = priv->params.align | gst_memory_alignment;
+
+  /* the slots are only aligned when the alignment divides the page size */
+  if (align >= page_size)
+    return NULL;
+
+  slot_size = priv->params.prefix + priv->size + priv->params.padding;
+  slot_size = (slot_size + align) & ~align;
+
+  size = slot_size * priv->min_buffers;
+  if (size >= ARENA_HUGEPAGE_SIZE)
+    size = (size + ARENA_HUGEPAGE_SIZE - 1) & ~(ARENA_HUGEPAGE_SIZE - 1);
+  else
+    size = (size + page_size - 1) & ~(page_size - 1);
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED) {
+    GST_WARNING_OBJECT (pool, "failed to map arena of %" G_GSIZE_FORMAT
+        " bytes: %s", size, g_strerror (errno));
+    return NULL;
+  }
+#if defined (HAVE_MADVISE) && defined (MADV_HUGEPAGE)
+  if (size >= ARENA_HUGEPAGE_SIZE)
+    madvise (data, size, MADV_HUGEPAGE);
+#endif
+
+  arena = g_slice_new (GstBufferPoolArena);
+  arena->refcount = 1;
+  arena->data = data;
+  arena->size = size;
+  arena->slot_size = slot_size;
+  arena->n_slots = priv->min_buffers;
+  arena->next_slot = 0;
+
+  GST_DEBUG_OBJECT (pool, "mapped arena %p of %" G_GSIZE_FORMAT " bytes for "
+      "%u slots of %" G_GSIZE_FORMAT " bytes", data, size, arena->n_slots,
+      slot_size);
+
+  return arena;
+}
+
+/* carve the memory for a new buffer from the arena, returns NULL when all
+ * slots were used */
+static GstMemory *
+arena_alloc_memory (GstBufferPool * pool, GstBufferPoolArena * arena)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstMemory *mem;
+  gint slot;
+
+  slot = g_atomic_int_add (&arena->next_slot, 1);
+  if (slot >= arena->n_slots)
+    return NULL;
+
+  g_atomic_int_inc (&arena->refcount);
+  mem = gst_memory_new_wrapped (priv->params.flags,
+      arena->data + slot * arena->slot_size, arena->slot_size,
+      priv->params.prefix, priv->size, arena, (GDestroyNotify) arena_unref);
+
+  return mem;
+}
+#endif
+
 static GstFlowReturn
 default_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
 {
   GstBufferPoolPrivate *priv = pool->priv;
 
+#ifdef HAVE_MMAP
+  if (priv->arena) {
+    GstMemory *mem;
+
+    if ((mem = arena_alloc_memory (pool, priv->arena))) {
+      *buffer = gst_buffer_new ();
+      gst_buffer_append_memory (*buffer, mem);
+      return GST_FLOW_OK;
+    }
+  }
+#endif
+
   *buffer =
       gst_buffer_new_allocate (priv->allocator, priv->size, &priv->params);
 
@@ -300,6 +713,38 @@ alloc_failed:
   }
 }
 
+/* preallocates the minimum number of buffers in the background. Buffers that
+ * were acquired before this thread got to them were already allocated by the
+ * acquire and count towards the minimum. */
+static gpointer
+gst_buffer_pool_prealloc_thread (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass;
+  guint i;
+
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  for (i = 0; i < priv->min_buffers; i++) {
+    GstBuffer *buffer;
+
+    if (g_atomic_int_get (&priv->prealloc_cancel))
+      break;
+    if (g_atomic_int_get (&priv->cur_buffers) >= priv->min_buffers)
+      break;
+
+    if (do_alloc_buffer (pool, &buffer, NULL) != GST_FLOW_OK) {
+      GST_WARNING_OBJECT (pool, "failed to preallocate buffer");
+      break;
+    }
+    if (G_LIKELY (pclass->release_buffer))
+      pclass->release_buffer (pool, buffer);
+  }
+  GST_DEBUG_OBJECT (pool, "preallocated %u buffers", i);
+
+  return NULL;
+}
+
 /* the default implementation for preallocating the buffers
  * in the pool */
 static gboolean
@@ -311,6 +756,24 @@ default_start (GstBufferPool * pool)
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
+#ifdef HAVE_MMAP
+  /* carve the preallocated buffers out of one contiguous mapping. This is
+   * only possible when the buffers are made by our alloc_buffer */
+  if (priv->hugepages && priv->min_buffers > 0 && priv->size > 0 &&
+      pclass->alloc_buffer == default_alloc_buffer)
+    priv->arena = arena_new (pool);
+#endif
+
+  if (priv->async_prealloc && priv->min_buffers > 0) {
+    priv->prealloc_cancel = 0;
+    priv->prealloc_thread = g_thread_try_new ("bufferpool-prealloc",
+        (GThreadFunc) gst_buffer_pool_prealloc_thread, pool, NULL);
+    if (priv->prealloc_thread)
+      return TRUE;
+    /* no thread, do it now then */
+    GST_WARNING_OBJECT (pool, "could not start preallocation thread");
+  }
+
   /* we need to prealloc buffers */
   for (i = 0; i < priv->min_buffers; i++) {
     GstBuffer *buffer;
@@ -373,6 +836,16 @@ default_stop (GstBufferPool * pool)
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
+  /* wait for the preallocation, the buffers it made are freed below */
+  if (priv->prealloc_thread) {
+    g_atomic_int_set (&priv->prealloc_cancel, 1);
+    g_thread_join (priv->prealloc_thread);
+    priv->prealloc_thread = NULL;
+  }
+
+  /* give the buffers cached in the threads back to the queue first */
+  gst_buffer_pool_flush_magazines (pool);
+
   /* clear the pool */
   while ((buffer = gst_atomic_queue_pop (priv->queue))) {
     GST_LOG_OBJECT (pool, "freeing %p", buffer);
@@ -383,6 +856,14 @@ default_stop (GstBufferPool * pool)
   }
   priv->cur_buffers = 0;
 
+#ifdef HAVE_MMAP
+  /* buffers that are still outstanding keep the arena alive */
+  if (priv->arena) {
+    arena_unref (priv->arena);
+    priv->arena = NULL;
+  }
+#endif
+
   return TRUE;
 }
 
@@ -407,6 +888,34 @@ do_stop (GstBufferPool * pool)
   return TRUE;
 }
 
+/* must be called with the lock */
+static void
+do_set_flushing (GstBufferPool * pool, gboolean flushing)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolClass *pclass;
+
+  if (!GST_BUFFER_POOL_IS_FLUSHING (pool) == !flushing)
+    return;
+
+  pclass = GST_BUFFER_POOL_GET_CLASS (pool);
+
+  if (flushing) {
+    g_atomic_int_set (&pool->flushing, 1);
+    /* wake up the acquires that wait for a buffer */
+    gst_poll_write_control (priv->poll);
+
+    if (pclass->flush_start)
+      pclass->flush_start (pool);
+  } else {
+    if (pclass->flush_stop)
+      pclass->flush_stop (pool);
+
+    gst_poll_read_control (priv->poll);
+    g_atomic_int_set (&pool->flushing, 0);
+  }
+}
+
 /**
  * gst_buffer_pool_set_active:
  * @pool: a #GstBufferPool
@@ -451,14 +960,12 @@ gst_buffer_pool_set_active (GstBufferPool * pool, gboolean active)
       goto start_failed;
 
     /* unset the flushing state now */
-    gst_poll_read_control (priv->poll);
-    g_atomic_int_set (&pool->flushing, 0);
+    do_set_flushing (pool, FALSE);
   } else {
     gint outstanding;
 
     /* set to flushing first */
-    g_atomic_int_set (&pool->flushing, 1);
-    gst_poll_write_control (priv->poll);
+    do_set_flushing (pool, TRUE);
 
     /* when all buffers are in the pool, free them. Else they will be
      * freed when they are released */
@@ -521,6 +1028,85 @@ gst_buffer_pool_is_active (GstBufferPool * pool)
   return res;
 }
 
+/**
+ * gst_buffer_pool_set_flushing:
+ * @pool: a #GstBufferPool
+ * @flushing: whether to start or stop flushing
+ *
+ * Enable or disable the flushing state of an active @pool. While flushing,
+ * gst_buffer_pool_acquire_buffer() returns #GST_FLOW_FLUSHING and blocked
+ * acquires are woken up.
+ *
+ * Unlike deactivating the pool, this keeps the allocated buffers, which makes
+ * it cheap to leave the flushing state again, for example after a flushing
+ * seek. This function has no effect on an inactive pool.
+ *
+ * Since: 1.2
+ */
+void
+gst_buffer_pool_set_flushing (GstBufferPool * pool, gboolean flushing)
+{
+  g_return_if_fail (GST_IS_BUFFER_POOL (pool));
+
+  GST_LOG_OBJECT (pool, "flushing %d", flushing);
+
+  GST_BUFFER_POOL_LOCK (pool);
+  if (pool->priv->active)
+    do_set_flushing (pool, flushing);
+  else
+    GST_DEBUG_OBJECT (pool, "pool is not active");
+  GST_BUFFER_POOL_UNLOCK (pool);
+}
+
+/**
+ * gst_buffer_pool_get_starvation_count:
+ * @pool: a #GstBufferPool
+ *
+ * Get the number of times that a buffer was acquired from @pool while all
+ * of its buffers were in use and no new buffer could be allocated. The
+ * acquire then either waited for a buffer to be released or failed when
+ * #GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT was used.
+ *
+ * A growing count means that the pool has fewer buffers than the pipeline
+ * needs, for example because an element that keeps buffers did not account
+ * for them in the ALLOCATION query.
+ *
+ * Returns: the number of starved acquires.
+ *
+ * Since: 1.2
+ */
+guint
+gst_buffer_pool_get_starvation_count (GstBufferPool * pool)
+{
+  g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), 0);
+
+  return g_atomic_int_get (&pool->priv->starved);
+}
+
+/**
+ * gst_buffer_pool_get_allocated_bytes:
+ * @pool: a #GstBufferPool
+ *
+ * Get the number of bytes that @pool allocated for its buffers, counted as
+ * the number of buffers that @pool currently manages, free or in use, times
+ * the buffer size of its configuration.
+ *
+ * Returns: the number of allocated bytes.
+ *
+ * Since: 1.2
+ */
+guint64
+gst_buffer_pool_get_allocated_bytes (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv;
+
+  g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), 0);
+
+  priv = pool->priv;
+
+  return (guint64) g_atomic_int_get (&priv->cur_buffers) * priv->size;
+}
+
 static gboolean
 default_set_config (GstBufferPool * pool, GstStructure * config)
 {
@@ -544,6 +1130,22 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   priv->min_buffers = min_buffers;
   priv->max_buffers = max_buffers;
   priv->cur_buffers = 0;
+  priv->thread_cache = gst_buffer_pool_config_has_option (config,
+      GST_BUFFER_POOL_OPTION_THREAD_CACHE);
+  priv->hugepages = gst_buffer_pool_config_has_option (config,
+      GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES);
+  priv->async_prealloc = gst_buffer_pool_config_has_option (config,
+      GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC);
+
+  /* when the number of buffers is limited, all of them fit in a fixed size
+   * queue that never needs to allocate */
+  if (gst_atomic_queue_length (priv->queue) == 0) {
+    gst_atomic_queue_unref (priv->queue);
+    if (max_buffers > 0)
+      priv->queue = gst_atomic_queue_new_bounded (max_buffers);
+    else
+      priv->queue = gst_atomic_queue_new (10);
+  }
 
   if (priv->allocator)
     gst_object_unref (priv->allocator);
@@ -668,6 +1270,17 @@ gst_buffer_pool_get_config (GstBufferPool * pool)
 }
 
 static const gchar *empty_option[] = { NULL };
+static const gchar *default_options[] = {
+  GST_BUFFER_POOL_OPTION_THREAD_CACHE,
+  GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES,
+  GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC, NULL
+};
+
+static const gchar **
+default_get_options (GstBufferPool * pool)
+{
+  return default_options;
+}
 
 /**
  * gst_buffer_pool_get_options:
@@ -977,11 +1590,23 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 {
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag = NULL;
+  gboolean starved = FALSE;
+
+  if (priv->thread_cache)
+    mag = gst_buffer_pool_get_magazine (pool);
 
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
       goto flushing;
 
+    /* try the magazine of this thread first */
+    if (mag && (*buffer = gst_buffer_pool_magazine_pop (pool, mag))) {
+      result = GST_FLOW_OK;
+      GST_LOG_OBJECT (pool, "acquired buffer %p from magazine", *buffer);
+      break;
+    }
+
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
@@ -991,6 +1616,14 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       break;
     }
 
+    /* buffers might be cached in the magazines of other threads */
+    if (mag && (*buffer = gst_buffer_pool_steal_buffer (pool, mag))) {
+      result = GST_FLOW_OK;
+      GST_LOG_OBJECT (pool, "acquired buffer %p from other magazine",
+          *buffer);
+      break;
+    }
+
     /* no buffer, try to allocate some more */
     GST_LOG_OBJECT (pool, "no buffer, trying to allocate");
     result = do_alloc_buffer (pool, buffer, NULL);
@@ -1002,15 +1635,39 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       /* something went wrong, return error */
       break;
 
+    /* all buffers are in use, the pool is too small for the pipeline */
+    if (!starved) {
+      starved = TRUE;
+      g_atomic_int_inc (&priv->starved);
+      GST_DEBUG_OBJECT (pool, "pool starved, %d times so far",
+          g_atomic_int_get (&priv->starved));
+    }
+
     /* check if we need to wait */
     if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT)) {
       GST_LOG_OBJECT (pool, "no more buffers");
       break;
     }
 
+    if (priv->thread_cache) {
+      /* announce that we are waiting so that released buffers go to the
+       * queue, then check the magazines of the other threads */
+      g_atomic_int_inc (&priv->waiting);
+      if ((*buffer = gst_buffer_pool_steal_buffer (pool, mag))) {
+        g_atomic_int_add (&priv->waiting, -1);
+        result = GST_FLOW_OK;
+        GST_LOG_OBJECT (pool, "acquired buffer %p from other magazine",
+            *buffer);
+        break;
+      }
+    }
+
     /* now wait */
     GST_LOG_OBJECT (pool, "waiting for free buffers");
     gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
+
+    if (priv->thread_cache)
+      g_atomic_int_add (&priv->waiting, -1);
   }
 
   return result;
@@ -1031,9 +1688,9 @@ dec_outstanding (GstBufferPool * pool)
     if (GST_BUFFER_POOL_IS_FLUSHING (pool)) {
       /* take the lock so that set_active is not run concurrently */
       GST_BUFFER_POOL_LOCK (pool);
-      /* recheck the flushing state in the lock, the pool could have been
-       * set to active again */
-      if (GST_BUFFER_POOL_IS_FLUSHING (pool))
+      /* recheck the state in the lock, the pool could have been set to
+       * active again or only be flushing */
+      if (!pool->priv->active)
         do_stop (pool);
 
       GST_BUFFER_POOL_UNLOCK (pool);
@@ -1115,8 +1772,18 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 static void
 default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
 {
-  /* keep it around in our queue */
   GST_LOG_OBJECT (pool, "released buffer %p", buffer);
+
+  /* keep it in the magazine of this thread. Preallocated buffers and buffers
+   * released while flushing go to the queue */
+  if (pool->priv->thread_cache && pool->priv->started &&
+      !GST_BUFFER_POOL_IS_FLUSHING (pool)) {
+    gst_buffer_pool_magazine_push (pool, gst_buffer_pool_get_magazine (pool),
+        buffer);
+    return;
+  }
+
+  /* keep it around in our queue */
   gst_atomic_queue_push (pool->priv->queue, buffer);
   gst_poll_write_control (pool->priv->poll);
 }
@@ -96,6 +96,47 @@ struct _GstBufferPoolAcquireParams {
  */
 #define GST_BUFFER_POOL_IS_FLUSHING(pool)  (g_atomic_int_get (&pool->flushing))
 
+/**
+ * GST_BUFFER_POOL_OPTION_THREAD_CACHE:
+ *
+ * An option that can be activated on the default bufferpool implementation
+ * to keep a small cache of free buffers in each thread that acquires or
+ * releases buffers. The caches are refilled from and flushed to the shared
+ * queue of the pool in batches, which reduces the contention on the pool
+ * when buffers are acquired and released from different threads.
+ */
+#define GST_BUFFER_POOL_OPTION_THREAD_CACHE "GstBufferPoolOptionThreadCache"
+
+/**
+ * GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES:
+ *
+ * An option that can be activated on the default bufferpool implementation
+ * to preallocate the minimum number of buffers from one contiguous mapping.
+ * Large mappings are backed by transparent hugepages when the system supports
+ * them, which reduces the TLB misses when the buffers are accessed. The
+ * memory of the preallocated buffers does not come from the configured
+ * allocator. Buffers that are allocated after the pool was started are
+ * allocated with the configured allocator as usual.
+ *
+ * Since: 1.2
+ */
+#define GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES "GstBufferPoolOptionContiguousHugepages"
+
+/**
+ * GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC:
+ *
+ * An option that can be activated on the default bufferpool implementation
+ * to preallocate the minimum number of buffers in a separate thread.
+ * gst_buffer_pool_set_active() then returns without waiting for the
+ * allocations and buffers that are acquired before the preallocation is done
+ * are allocated when they are acquired. A failed preallocation is not
+ * reported by gst_buffer_pool_set_active(), the acquire of the buffer fails
+ * instead.
+ *
+ * Since: 1.2
+ */
+#define GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC "GstBufferPoolOptionAsyncPrealloc"
+
 /**
  * GstBufferPool:
  * @object: the parent structure
@@ -142,6 +183,9 @@ struct _GstBufferPool {
  *        implementation will put the buffer back in the queue and notify any
  *        blocking acquire_buffer calls.
  * @free_buffer: free a buffer. The default implementation unrefs the buffer.
+ * @flush_start: enter the flushing state, subclasses should unblock any
+ *        blocking operation in @acquire_buffer or @alloc_buffer. Since: 1.2
+ * @flush_stop: leave the flushing state. Since: 1.2
  *
  * The GstBufferPool class.
  */
@@ -162,9 +206,11 @@ struct _GstBufferPoolClass {
   void           (*reset_buffer)   (GstBufferPool *pool, GstBuffer *buffer);
   void           (*release_buffer) (GstBufferPool *pool, GstBuffer *buffer);
   void           (*free_buffer)    (GstBufferPool *pool, GstBuffer *buffer);
+  void           (*flush_start)    (GstBufferPool *pool);
+  void           (*flush_stop)     (GstBufferPool *pool);
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 2];
 };
 
 GType       gst_buffer_pool_get_type (void);
@@ -175,6 +221,7 @@ GstBufferPool *  gst_buffer_pool_new  (void);
 /* state management */
 gboolean         gst_buffer_pool_set_active      (GstBufferPool *pool, gboolean active);
 gboolean         gst_buffer_pool_is_active       (GstBufferPool *pool);
+void             gst_buffer_pool_set_flushing    (GstBufferPool *pool, gboolean flushing);
 
 gboolean         gst_buffer_pool_set_config      (GstBufferPool *pool, GstStructure *config);
 GstStructure *   gst_buffer_pool_get_config      (GstBufferPool *pool);
@@ -203,6 +250,10 @@ GstFlowReturn    gst_buffer_pool_acquire_buffer  (GstBufferPool *pool, GstBuffer
                                                   GstBufferPoolAcquireParams *params);
 void             gst_buffer_pool_release_buffer  (GstBufferPool *pool, GstBuffer *buffer);
 
+/* statistics */
+guint            gst_buffer_pool_get_starvation_count (GstBufferPool *pool);
+guint64          gst_buffer_pool_get_allocated_bytes  (GstBufferPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_BUFFER_POOL_H__ */
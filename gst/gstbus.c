@@ -122,6 +122,20 @@ struct _GstBusPrivate
   gboolean enable_async;
   GstPoll *poll;
   GPollFD pollfd;
+
+  /* max number of messages handled per watch dispatch, 0 = all pending */
+  guint max_dispatch;
+  /* message types of which only the latest one per source is delivered in
+   * a batch */
+  GstMessageType coalesce_types;
+
+  /* types of messages accepted by gst_bus_post() */
+  gint message_types;           /* ATOMIC */
+
+  /* messages of ring_types are written to ring instead of being delivered,
+   * protected with the object lock */
+  GstBusRing *ring;
+  GstMessageType ring_types;
 };
 
 #define gst_bus_parent_class parent_class
@@ -224,6 +238,8 @@ gst_bus_init (GstBus * bus)
 {
   bus->priv = G_TYPE_INSTANCE_GET_PRIVATE (bus, GST_TYPE_BUS, GstBusPrivate);
   bus->priv->enable_async = DEFAULT_ENABLE_ASYNC;
+  bus->priv->max_dispatch = 1;
+  bus->priv->message_types = GST_MESSAGE_ANY;
   g_mutex_init (&bus->priv->queue_lock);
   bus->priv->queue = gst_atomic_queue_new (32);
 
@@ -257,6 +273,11 @@ gst_bus_dispose (GObject * object)
     bus->priv->poll = NULL;
   }
 
+  if (bus->priv->ring) {
+    gst_bus_ring_unref (bus->priv->ring);
+    bus->priv->ring = NULL;
+  }
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -308,10 +329,16 @@ gst_bus_post (GstBus * bus, GstMessage * message)
   GstBusSyncHandler handler;
   gboolean emit_sync_message;
   gpointer handler_data;
+  GstBusRing *ring = NULL;
 
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
   g_return_val_if_fail (GST_IS_MESSAGE (message), FALSE);
 
+  /* drop unwanted messages before doing anything else with them */
+  if (G_UNLIKELY ((GST_MESSAGE_TYPE (message) &
+              g_atomic_int_get (&bus->priv->message_types)) == 0))
+    goto filtered;
+
   GST_DEBUG_OBJECT (bus, "[msg %p] posting on bus %" GST_PTR_FORMAT, message,
       message);
 
@@ -320,11 +347,17 @@ gst_bus_post (GstBus * bus, GstMessage * message)
   if (GST_OBJECT_FLAG_IS_SET (bus, GST_BUS_FLUSHING))
     goto is_flushing;
 
+  if (G_UNLIKELY (bus->priv->ring &&
+          (GST_MESSAGE_TYPE (message) & bus->priv->ring_types)))
+    ring = gst_bus_ring_ref (bus->priv->ring);
   handler = bus->priv->sync_handler;
   handler_data = bus->priv->sync_handler_data;
   emit_sync_message = bus->priv->num_sync_message_emitters > 0;
   GST_OBJECT_UNLOCK (bus);
 
+  if (G_UNLIKELY (ring))
+    goto to_ring;
+
   /* first call the sync handler if it is installed */
   if (handler)
     reply = handler (bus, message, handler_data);
@@ -399,6 +432,132 @@ is_flushing:
 
     return FALSE;
   }
+filtered:
+  {
+    GST_LOG_OBJECT (bus, "[msg %p] type %s filtered", message,
+        GST_MESSAGE_TYPE_NAME (message));
+    gst_message_unref (message);
+
+    return TRUE;
+  }
+to_ring:
+  {
+    GST_LOG_OBJECT (bus, "[msg %p] writing to ring", message);
+    gst_bus_ring_push (ring, message);
+    gst_bus_ring_unref (ring);
+    gst_message_unref (message);
+
+    return TRUE;
+  }
+}
+
+/**
+ * gst_bus_set_message_types:
+ * @bus: a #GstBus
+ * @types: the message types to accept, #GST_MESSAGE_ANY for all messages
+ *
+ * Only accept messages of the types in @types on @bus. Messages of other
+ * types are dropped by gst_bus_post() right away: they are not passed to the
+ * sync handler, no #GstBus::sync-message signal is emitted for them and they
+ * never reach the queue of the bus.
+ *
+ * Code that posts messages can use gst_bus_accepts_message_type() to avoid
+ * creating messages that would be dropped.
+ *
+ * Note that #GstBin relies on the messages that its children post on its
+ * internal bus, this function should only be used on the bus of a
+ * top-level pipeline or on buses created by the application.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_bus_set_message_types (GstBus * bus, GstMessageType types)
+{
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  GST_DEBUG_OBJECT (bus, "accepting message types 0x%08x", (guint) types);
+  g_atomic_int_set (&bus->priv->message_types, types);
+}
+
+/**
+ * gst_bus_set_ring:
+ * @bus: a #GstBus
+ * @ring: (allow-none): a #GstBusRing, or %NULL to stop using the ring
+ * @types: the message types to write to @ring
+ *
+ * Writes the messages of the types in @types that are posted on @bus into
+ * @ring, from which another process can read them, see #GstBusRing. These
+ * messages are not passed to the sync handler and not queued on @bus, so a
+ * monitor does not add work to the main loop of the application. Messages
+ * of other types are delivered as usual.
+ *
+ * A message that does not fit in @ring is dropped.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_bus_set_ring (GstBus * bus, GstBusRing * ring, GstMessageType types)
+{
+  GstBusRing *old;
+
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  if (ring)
+    gst_bus_ring_ref (ring);
+
+  GST_OBJECT_LOCK (bus);
+  old = bus->priv->ring;
+  bus->priv->ring = ring;
+  bus->priv->ring_types = ring ? types : 0;
+  GST_OBJECT_UNLOCK (bus);
+
+  if (old)
+    gst_bus_ring_unref (old);
+}
+
+/**
+ * gst_bus_get_message_types:
+ * @bus: a #GstBus
+ *
+ * Get the message types accepted by @bus, see gst_bus_set_message_types().
+ *
+ * Returns: the message types accepted by @bus.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+GstMessageType
+gst_bus_get_message_types (GstBus * bus)
+{
+  g_return_val_if_fail (GST_IS_BUS (bus), 0);
+
+  return g_atomic_int_get (&bus->priv->message_types);
+}
+
+/**
+ * gst_bus_accepts_message_type:
+ * @bus: a #GstBus
+ * @type: a #GstMessageType
+ *
+ * Check if messages of @type would be accepted by gst_bus_post() on @bus.
+ *
+ * Returns: %TRUE if messages of @type are accepted.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_bus_accepts_message_type (GstBus * bus, GstMessageType type)
+{
+  g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
+
+  return (type & g_atomic_int_get (&bus->priv->message_types)) != 0;
 }
 
 /**
@@ -718,6 +877,50 @@ no_replace:
   }
 }
 
+/**
+ * gst_bus_set_dispatch_batch:
+ * @bus: a #GstBus
+ * @max_messages: the maximum number of messages to dispatch at once, 0 for
+ *     all pending messages
+ * @coalesce_types: the types of messages to coalesce in a batch
+ *
+ * Configure how the watch of @bus delivers messages. By default the watch
+ * handles one message per main loop iteration. With @max_messages bigger
+ * than 1, or 0, the watch calls its callback for up to @max_messages of the
+ * messages that are pending on the bus in one go, which avoids a main loop
+ * iteration per message when a lot of messages are posted at once, for
+ * example when a big bin changes state or when elements post #GST_MESSAGE_QOS
+ * or #GST_MESSAGE_BUFFERING messages at a high rate.
+ *
+ * Of the messages in one batch with a type in @coalesce_types, only the last
+ * one posted by each source is delivered, the older ones are dropped. For
+ * #GST_MESSAGE_ELEMENT messages the name of the structure also needs to
+ * match. Typical types to coalesce are #GST_MESSAGE_STATE_CHANGED,
+ * #GST_MESSAGE_BUFFERING, #GST_MESSAGE_QOS and #GST_MESSAGE_ELEMENT. Note that
+ * coalesced #GST_MESSAGE_STATE_CHANGED messages can skip intermediate
+ * states. When the callback removes the watch while a coalesced batch is
+ * being delivered, the remaining messages of the batch are dropped.
+ *
+ * This only affects the #GSource created by gst_bus_create_watch() and the
+ * functions that use it, coalescing is only done when more than one message
+ * is dispatched at once.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_bus_set_dispatch_batch (GstBus * bus, guint max_messages,
+    GstMessageType coalesce_types)
+{
+  g_return_if_fail (GST_IS_BUS (bus));
+
+  GST_OBJECT_LOCK (bus);
+  bus->priv->max_dispatch = max_messages;
+  bus->priv->coalesce_types = coalesce_types;
+  GST_OBJECT_UNLOCK (bus);
+}
+
 /* GSource for the bus
  */
 typedef struct
@@ -741,6 +944,125 @@ gst_bus_source_check (GSource * source)
   return bsrc->bus->priv->pollfd.revents & (G_IO_IN | G_IO_HUP | G_IO_ERR);
 }
 
+/* messages are coalesced when they have the same type and source and, for
+ * element messages, the same structure name */
+static GQuark
+gst_bus_coalesce_name (GstMessage * message)
+{
+  const GstStructure *s;
+
+  if (GST_MESSAGE_TYPE (message) != GST_MESSAGE_ELEMENT)
+    return 0;
+
+  s = gst_message_get_structure (message);
+
+  return s ? gst_structure_get_name_id (s) : 0;
+}
+
+static guint
+gst_bus_coalesce_hash (gconstpointer key)
+{
+  GstMessage *message = (GstMessage *) key;
+
+  return g_direct_hash (GST_MESSAGE_SRC (message)) ^
+      (guint) GST_MESSAGE_TYPE (message) ^ gst_bus_coalesce_name (message);
+}
+
+static gboolean
+gst_bus_coalesce_equal (gconstpointer a, gconstpointer b)
+{
+  GstMessage *m1 = (GstMessage *) a, *m2 = (GstMessage *) b;
+
+  return GST_MESSAGE_TYPE (m1) == GST_MESSAGE_TYPE (m2) &&
+      GST_MESSAGE_SRC (m1) == GST_MESSAGE_SRC (m2) &&
+      gst_bus_coalesce_name (m1) == gst_bus_coalesce_name (m2);
+}
+
+/* pops up to @max messages and drops the ones that are superseded by a later
+ * message in the batch */
+static GQueue *
+gst_bus_pop_coalesced (GstBus * bus, guint max, GstMessageType types)
+{
+  GQueue *batch;
+  GHashTable *seen;
+  GstMessage *message;
+  GList *l, *prev;
+
+  batch = g_queue_new ();
+  while (max-- > 0 && (message = gst_bus_pop (bus)))
+    g_queue_push_tail (batch, message);
+
+  if (batch->length < 2)
+    return batch;
+
+  /* walk back from the newest message and keep the first one we see for each
+   * key */
+  seen = g_hash_table_new (gst_bus_coalesce_hash, gst_bus_coalesce_equal);
+  for (l = batch->tail; l; l = prev) {
+    prev = l->prev;
+    message = l->data;
+
+    if ((GST_MESSAGE_TYPE (message) & types) == 0)
+      continue;
+
+    if (g_hash_table_lookup (seen, message)) {
+      GST_DEBUG_OBJECT (bus, "coalescing message %" GST_PTR_FORMAT, message);
+      g_queue_delete_link (batch, l);
+      gst_message_unref (message);
+    } else {
+      g_hash_table_insert (seen, message, message);
+    }
+  }
+  g_hash_table_destroy (seen);
+
+  return batch;
+}
+
+static gboolean
+gst_bus_source_dispatch_batch (GSource * source, GstBus * bus,
+    GstBusFunc handler, gpointer user_data, guint max,
+    GstMessageType coalesce_types)
+{
+  GstMessage *message;
+  GQueue *batch = NULL;
+  gboolean keep = TRUE;
+
+  /* only dispatch what is pending now, messages posted from the callback
+   * are handled in the next iteration */
+  max = max == 0 ? gst_atomic_queue_length (bus->priv->queue) :
+      MIN (max, gst_atomic_queue_length (bus->priv->queue));
+
+  if (coalesce_types != 0)
+    batch = gst_bus_pop_coalesced (bus, max, coalesce_types);
+
+  GST_DEBUG_OBJECT (bus, "source %p dispatching up to %u messages", source,
+      batch ? batch->length : max);
+
+  while (keep && !g_source_is_destroyed (source)) {
+    if (batch)
+      message = g_queue_pop_head (batch);
+    else if (max-- > 0)
+      message = gst_bus_pop (bus);
+    else
+      message = NULL;
+
+    if (message == NULL)
+      break;
+
+    keep = handler (bus, message, user_data);
+    gst_message_unref (message);
+  }
+
+  if (batch) {
+    g_queue_foreach (batch, (GFunc) gst_mini_object_unref, NULL);
+    g_queue_free (batch);
+  }
+
+  GST_DEBUG_OBJECT (bus, "source %p handler returns %d", source, keep);
+
+  return keep;
+}
+
 static gboolean
 gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
     gpointer user_data)
@@ -748,6 +1070,8 @@ gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
   GstBusFunc handler = (GstBusFunc) callback;
   GstBusSource *bsource = (GstBusSource *) source;
   GstMessage *message;
+  GstMessageType coalesce_types;
+  guint max_dispatch;
   gboolean keep;
   GstBus *bus;
 
@@ -757,6 +1081,15 @@ gst_bus_source_dispatch (GSource * source, GSourceFunc callback,
 
   g_return_val_if_fail (GST_IS_BUS (bus), FALSE);
 
+  GST_OBJECT_LOCK (bus);
+  max_dispatch = bus->priv->max_dispatch;
+  coalesce_types = bus->priv->coalesce_types;
+  GST_OBJECT_UNLOCK (bus);
+
+  if (max_dispatch != 1 && handler)
+    return gst_bus_source_dispatch_batch (source, bus, handler, user_data,
+        max_dispatch, coalesce_types);
+
   message = gst_bus_pop (bus);
 
   /* The message queue might be empty if some other thread or callback set
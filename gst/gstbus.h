@@ -28,6 +28,7 @@ typedef struct _GstBusClass GstBusClass;
 
 #include <gst/gstmessage.h>
 #include <gst/gstclock.h>
+#include <gst/gstbusring.h>
 
 G_BEGIN_DECLS
 
@@ -146,11 +147,22 @@ GstMessage *            gst_bus_timed_pop               (GstBus * bus, GstClockT
 GstMessage *            gst_bus_timed_pop_filtered      (GstBus * bus, GstClockTime timeout, GstMessageType types);
 void                    gst_bus_set_flushing            (GstBus * bus, gboolean flushing);
 
+/* filtering at post time */
+void                    gst_bus_set_message_types       (GstBus * bus, GstMessageType types);
+GstMessageType          gst_bus_get_message_types       (GstBus * bus);
+gboolean                gst_bus_accepts_message_type    (GstBus * bus, GstMessageType type);
+
+/* passing messages to another process */
+void                    gst_bus_set_ring                (GstBus * bus, GstBusRing * ring,
+                                                         GstMessageType types);
+
 /* synchronous dispatching */
 void                    gst_bus_set_sync_handler        (GstBus * bus, GstBusSyncHandler func,
                                                          gpointer user_data, GDestroyNotify notify);
 /* GSource based dispatching */
 GSource *               gst_bus_create_watch            (GstBus * bus);
+void                    gst_bus_set_dispatch_batch      (GstBus * bus, guint max_messages,
+                                                         GstMessageType coalesce_types);
 guint                   gst_bus_add_watch_full          (GstBus * bus,
                                                          gint priority,
                                                          GstBusFunc func,
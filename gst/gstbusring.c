@@ -0,0 +1,585 @@
+/* GStreamer
+ *
+ * gstbusring.c: shared memory ring of bus messages
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstbusring
+ * @short_description: Pass bus messages to another process
+ * @see_also: #GstBus, #GstMessage
+ *
+ * A #GstBusRing is a ring of message slots in a file that is mapped into
+ * the memory of the pipeline process and of a monitoring process. With
+ * gst_bus_set_ring() a #GstBus writes the messages of the selected types into
+ * the ring from the thread that posts them, in the binary form of
+ * gst_structure_to_binary(), instead of queueing them for the main loop of
+ * the application.
+ *
+ * The monitor opens the same file with gst_bus_ring_open() and takes the
+ * messages out with gst_bus_ring_pop(). Writing and reading do not take any
+ * lock and do not make system calls, the monitor polls the ring at its own
+ * pace. When the ring is full, or a message does not fit in a slot, the
+ * message is dropped and counted, see gst_bus_ring_get_dropped(); posting a
+ * message never waits for the monitor.
+ *
+ * Only one process may read from a ring at a time. The file is best placed
+ * on a memory backed file system like /dev/shm.
+ *
+ * Since: 1.2
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst_private.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <glib/gstdio.h>
+
+#include "gstbusring.h"
+#include "gstinfo.h"
+#include "gstutils.h"
+#include "gstvalue.h"
+
+#define RING_MAGIC 0x52425347   /* "GSBR" */
+#define RING_VERSION 1
+#define CACHE_LINE 64
+
+#define DEFAULT_SLOT_SIZE 1024
+#define MIN_SLOT_SIZE 64
+
+/* The start of the file. The producers only write write_pos and dropped,
+ * the consumer only read_pos, they are on different cache lines. */
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  guint32 n_slots;
+  guint32 slot_size;
+  gint dropped;                 /* ATOMIC */
+  guint8 _pad0[CACHE_LINE - 5 * 4];
+
+  gint write_pos;               /* ATOMIC */
+  guint8 _pad1[CACHE_LINE - 4];
+
+  gint read_pos;
+  guint8 _pad2[CACHE_LINE - 4];
+} RingHeader;
+
+/* The slots follow the header. A slot at position pos can be written when
+ * its seq is pos and read when it is pos + 1, after reading it becomes
+ * pos + n_slots for the next round. */
+typedef struct
+{
+  gint seq;                     /* ATOMIC */
+  guint32 size;
+  /* the record follows */
+} RingSlot;
+
+#define SLOT_HEADER_SIZE 8
+
+/* type, seqnum, timestamp, length of the source path with the
+ * terminating 0, length of the structure */
+#define RECORD_HEADER_SIZE (4 + 4 + 8 + 4 + 4)
+
+struct _GstBusRing
+{
+  gint refcount;
+
+  gchar *path;
+  guint8 *data;
+  gsize size;
+
+  RingHeader *header;
+  guint8 *slots;
+  guint n_slots;
+  guint slot_size;
+};
+
+#define RING_SLOT(ring,pos) \
+    ((RingSlot *) ((ring)->slots + ((pos) & ((ring)->n_slots - 1)) * \
+        (ring)->slot_size))
+
+G_DEFINE_BOXED_TYPE (GstBusRing, gst_bus_ring,
+    (GBoxedCopyFunc) gst_bus_ring_ref, (GBoxedFreeFunc) gst_bus_ring_unref);
+
+#ifdef HAVE_MMAP
+static GstBusRing *
+gst_bus_ring_map (const gchar * path, gint fd, gsize size, GError ** error)
+{
+  GstBusRing *ring;
+  gpointer data;
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    gint errsv = errno;
+
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+        "Could not map %s: %s", path, g_strerror (errsv));
+    return NULL;
+  }
+
+  ring = g_slice_new0 (GstBusRing);
+  ring->refcount = 1;
+  ring->path = g_strdup (path);
+  ring->data = data;
+  ring->size = size;
+  ring->header = data;
+  ring->slots = ring->data + sizeof (RingHeader);
+
+  return ring;
+}
+#endif
+
+static void
+set_errno_error (GError ** error, const gchar * what, const gchar * path)
+{
+  gint errsv = errno;
+
+  g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+      "Could not %s %s: %s", what, path, g_strerror (errsv));
+}
+
+/**
+ * gst_bus_ring_new:
+ * @path: the file of the ring
+ * @n_slots: the number of messages the ring can hold, rounded up to a power
+ *     of two, 0 for 256
+ * @slot_size: the size of a slot in bytes, 0 for 1024
+ * @error: location for a #GError, or %NULL
+ *
+ * Creates a new ring in the file @path. An existing file is truncated, a
+ * monitor that still has the old ring open does not see the new one.
+ *
+ * Messages that need more than @slot_size bytes, including 32 bytes for the
+ * type, timestamp, sequence number and the sizes, and the path of the source
+ * object, are dropped.
+ *
+ * Returns: (transfer full): a new #GstBusRing or %NULL on error.
+ *
+ * Since: 1.2
+ */
+GstBusRing *
+gst_bus_ring_new (const gchar * path, guint n_slots, guint slot_size,
+    GError ** error)
+{
+#ifdef HAVE_MMAP
+  GstBusRing *ring;
+  gsize size;
+  guint i;
+  gint fd;
+
+  g_return_val_if_fail (path != NULL, NULL);
+  g_return_val_if_fail (n_slots <= G_MAXINT / 2, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (n_slots == 0)
+    n_slots = 256;
+  n_slots = 1 << g_bit_storage (n_slots - 1);
+  if (slot_size == 0)
+    slot_size = DEFAULT_SLOT_SIZE;
+  slot_size = GST_ROUND_UP_8 (MAX (slot_size, MIN_SLOT_SIZE));
+  size = sizeof (RingHeader) + (gsize) n_slots * slot_size;
+
+  fd = g_open (path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    set_errno_error (error, "create", path);
+    return NULL;
+  }
+  if (ftruncate (fd, size) < 0) {
+    set_errno_error (error, "resize", path);
+    close (fd);
+    return NULL;
+  }
+  ring = gst_bus_ring_map (path, fd, size, error);
+  close (fd);
+  if (ring == NULL)
+    return NULL;
+
+  ring->n_slots = n_slots;
+  ring->slot_size = slot_size;
+  for (i = 0; i < n_slots; i++)
+    RING_SLOT (ring, i)->seq = i;
+  ring->header->version = RING_VERSION;
+  ring->header->n_slots = n_slots;
+  ring->header->slot_size = slot_size;
+  /* a monitor that opens the file too early sees no magic */
+  g_atomic_int_set ((gint *) & ring->header->magic, RING_MAGIC);
+
+  GST_DEBUG ("created ring %s with %u slots of %u bytes", path, n_slots,
+      slot_size);
+
+  return ring;
+#else
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_NOSYS,
+      "Shared memory is not supported on this platform");
+  return NULL;
+#endif
+}
+
+/**
+ * gst_bus_ring_open:
+ * @path: the file of the ring
+ * @error: location for a #GError, or %NULL
+ *
+ * Opens a ring that was created with gst_bus_ring_new(), usually in another
+ * process, to read messages from it with gst_bus_ring_pop().
+ *
+ * Returns: (transfer full): the #GstBusRing or %NULL on error.
+ *
+ * Since: 1.2
+ */
+GstBusRing *
+gst_bus_ring_open (const gchar * path, GError ** error)
+{
+#ifdef HAVE_MMAP
+  GstBusRing *ring;
+  RingHeader *header;
+  struct stat st;
+  gint fd;
+
+  g_return_val_if_fail (path != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  fd = g_open (path, O_RDWR, 0);
+  if (fd < 0) {
+    set_errno_error (error, "open", path);
+    return NULL;
+  }
+  if (fstat (fd, &st) < 0) {
+    set_errno_error (error, "stat", path);
+    close (fd);
+    return NULL;
+  }
+  if ((gsize) st.st_size < sizeof (RingHeader))
+    goto invalid;
+
+  ring = gst_bus_ring_map (path, fd, st.st_size, error);
+  close (fd);
+  if (ring == NULL)
+    return NULL;
+
+  header = ring->header;
+  if ((guint32) g_atomic_int_get ((gint *) & header->magic) != RING_MAGIC ||
+      header->version != RING_VERSION || header->n_slots == 0 ||
+      (header->n_slots & (header->n_slots - 1)) != 0 ||
+      header->slot_size < MIN_SLOT_SIZE ||
+      ring->size != sizeof (RingHeader) +
+      (gsize) header->n_slots * header->slot_size) {
+    gst_bus_ring_unref (ring);
+    fd = -1;
+    goto invalid;
+  }
+  ring->n_slots = header->n_slots;
+  ring->slot_size = header->slot_size;
+
+  return ring;
+
+invalid:
+  {
+    if (fd >= 0)
+      close (fd);
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "%s is not a bus ring", path);
+    return NULL;
+  }
+#else
+  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_NOSYS,
+      "Shared memory is not supported on this platform");
+  return NULL;
+#endif
+}
+
+/**
+ * gst_bus_ring_ref:
+ * @ring: a #GstBusRing
+ *
+ * Increases the refcount of @ring.
+ *
+ * Returns: (transfer full): @ring
+ *
+ * Since: 1.2
+ */
+GstBusRing *
+gst_bus_ring_ref (GstBusRing * ring)
+{
+  g_return_val_if_fail (ring != NULL, NULL);
+
+  g_atomic_int_inc (&ring->refcount);
+
+  return ring;
+}
+
+/**
+ * gst_bus_ring_unref:
+ * @ring: (transfer full): a #GstBusRing
+ *
+ * Decreases the refcount of @ring and unmaps it when the refcount reaches 0.
+ * The file is not removed.
+ *
+ * Since: 1.2
+ */
+void
+gst_bus_ring_unref (GstBusRing * ring)
+{
+  g_return_if_fail (ring != NULL);
+
+  if (g_atomic_int_dec_and_test (&ring->refcount)) {
+#ifdef HAVE_MMAP
+    munmap (ring->data, ring->size);
+#endif
+    g_free (ring->path);
+    g_slice_free (GstBusRing, ring);
+  }
+}
+
+/* a GError is replaced by its message, fields without serialization are
+ * left out */
+static gboolean
+copy_serializable (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  GstStructure *copy = user_data;
+  gchar *str;
+
+  if (G_VALUE_HOLDS (value, G_TYPE_ERROR)) {
+    const GError *err = g_value_get_boxed (value);
+
+    gst_structure_id_set (copy, field_id, G_TYPE_STRING,
+        err ? err->message : NULL, NULL);
+  } else if ((str = gst_value_serialize (value))) {
+    g_free (str);
+    gst_structure_id_set_value (copy, field_id, value);
+  }
+
+  return TRUE;
+}
+
+static guint8 *
+serialize_structure (const GstStructure * structure, gsize * size)
+{
+  GstStructure *copy;
+  guint8 *data;
+
+  if ((data = gst_structure_to_binary (structure, size)))
+    return data;
+
+  copy = gst_structure_new_empty (gst_structure_get_name (structure));
+  gst_structure_foreach (structure, copy_serializable, copy);
+  data = gst_structure_to_binary (copy, size);
+  gst_structure_free (copy);
+
+  return data;
+}
+
+/**
+ * gst_bus_ring_push:
+ * @ring: a #GstBusRing
+ * @message: the message to write
+ *
+ * Writes @message into a free slot of @ring. Fields of the message structure
+ * that can not be serialized are left out, a #GError is written as its
+ * message.
+ *
+ * This is done by #GstBus for the messages selected with gst_bus_set_ring(),
+ * it can be called from any thread in the process that created @ring.
+ *
+ * Returns: %FALSE if @message was dropped because @ring is full or the
+ *     message does not fit in a slot.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_bus_ring_push (GstBusRing * ring, GstMessage * message)
+{
+  const GstStructure *structure;
+  guint8 *sdata = NULL, *rec;
+  gsize ssize = 0, srclen = 0;
+  gchar *src = NULL;
+  guint32 val, total;
+  guint64 ts;
+  RingSlot *slot;
+  guint pos;
+
+  g_return_val_if_fail (ring != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_MESSAGE (message), FALSE);
+
+  if ((structure = gst_message_get_structure (message)) &&
+      !(sdata = serialize_structure (structure, &ssize)))
+    goto dropped;
+  if (GST_MESSAGE_SRC (message)) {
+    src = gst_object_get_path_string (GST_MESSAGE_SRC (message));
+    srclen = strlen (src) + 1;
+  }
+
+  total = RECORD_HEADER_SIZE + srclen + ssize;
+  if (SLOT_HEADER_SIZE + total > ring->slot_size)
+    goto dropped;
+
+  /* claim a slot */
+  while (TRUE) {
+    gint diff;
+
+    pos = (guint) g_atomic_int_get (&ring->header->write_pos);
+    slot = RING_SLOT (ring, pos);
+    diff = (gint) ((guint) g_atomic_int_get (&slot->seq) - pos);
+
+    if (diff == 0) {
+      if (g_atomic_int_compare_and_exchange (&ring->header->write_pos,
+              (gint) pos, (gint) (pos + 1)))
+        break;
+    } else if (diff < 0) {
+      /* the monitor did not read the slot of the previous round yet */
+      goto dropped;
+    }
+  }
+
+  rec = (guint8 *) slot + SLOT_HEADER_SIZE;
+  val = GST_MESSAGE_TYPE (message);
+  memcpy (rec, &val, 4);
+  val = GST_MESSAGE_SEQNUM (message);
+  memcpy (rec + 4, &val, 4);
+  ts = GST_MESSAGE_TIMESTAMP (message);
+  memcpy (rec + 8, &ts, 8);
+  val = srclen;
+  memcpy (rec + 16, &val, 4);
+  val = ssize;
+  memcpy (rec + 20, &val, 4);
+  rec += RECORD_HEADER_SIZE;
+  if (srclen)
+    memcpy (rec, src, srclen);
+  if (ssize)
+    memcpy (rec + srclen, sdata, ssize);
+  slot->size = total;
+
+  /* publish, this is a full barrier */
+  g_atomic_int_set (&slot->seq, (gint) (pos + 1));
+
+  g_free (src);
+  g_free (sdata);
+
+  return TRUE;
+
+dropped:
+  {
+    GST_LOG ("dropping %s message", GST_MESSAGE_TYPE_NAME (message));
+    g_atomic_int_inc (&ring->header->dropped);
+    g_free (src);
+    g_free (sdata);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_bus_ring_pop:
+ * @ring: a #GstBusRing
+ * @src_path: (out) (allow-none) (transfer full): location for the path of
+ *     the object that posted the message, see gst_object_get_path_string()
+ *
+ * Takes the oldest message out of @ring. The message has no source object,
+ * its type, timestamp, sequence number and structure are those of the
+ * posted message.
+ *
+ * Only one thread of one process may call this on a ring at a time.
+ *
+ * Returns: (transfer full): the next message or %NULL when @ring is empty.
+ *
+ * Since: 1.2
+ */
+GstMessage *
+gst_bus_ring_pop (GstBusRing * ring, gchar ** src_path)
+{
+  GstMessage *message;
+  GstStructure *structure = NULL;
+  guint32 type, seqnum, srclen, ssize;
+  const guint8 *rec;
+  GstClockTime ts;
+  RingSlot *slot;
+  guint pos;
+
+  g_return_val_if_fail (ring != NULL, NULL);
+
+  pos = (guint) ring->header->read_pos;
+  slot = RING_SLOT (ring, pos);
+  if ((guint) g_atomic_int_get (&slot->seq) != pos + 1)
+    return NULL;
+
+  rec = (const guint8 *) slot + SLOT_HEADER_SIZE;
+  memcpy (&type, rec, 4);
+  memcpy (&seqnum, rec + 4, 4);
+  memcpy (&ts, rec + 8, 8);
+  memcpy (&srclen, rec + 16, 4);
+  memcpy (&ssize, rec + 20, 4);
+  rec += RECORD_HEADER_SIZE;
+
+  /* don't trust the other process with the sizes */
+  if ((guint64) RECORD_HEADER_SIZE + srclen + ssize > slot->size ||
+      (guint64) SLOT_HEADER_SIZE + slot->size > ring->slot_size) {
+    srclen = ssize = 0;
+  } else if (srclen && rec[srclen - 1] != '\0') {
+    srclen = 0;
+  }
+
+  if (ssize)
+    structure = gst_structure_from_binary (rec + srclen, ssize);
+  if (src_path)
+    *src_path = srclen ? g_strdup ((const gchar *) rec) : NULL;
+
+  /* give the slot back to the producers */
+  g_atomic_int_set (&slot->seq, (gint) (pos + ring->n_slots));
+  ring->header->read_pos = (gint) (pos + 1);
+
+  message = gst_message_new_custom (type, NULL, structure);
+  GST_MESSAGE_TIMESTAMP (message) = ts;
+  gst_message_set_seqnum (message, seqnum);
+
+  return message;
+}
+
+/**
+ * gst_bus_ring_get_dropped:
+ * @ring: a #GstBusRing
+ *
+ * Gets the number of messages that were dropped since @ring was created
+ * because it was full or they did not fit in a slot.
+ *
+ * Returns: the number of dropped messages.
+ *
+ * Since: 1.2
+ */
+guint
+gst_bus_ring_get_dropped (GstBusRing * ring)
+{
+  g_return_val_if_fail (ring != NULL, 0);
+
+  return (guint) g_atomic_int_get (&ring->header->dropped);
+}
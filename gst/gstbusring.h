@@ -0,0 +1,55 @@
+/* GStreamer
+ *
+ * gstbusring.h: shared memory ring of bus messages
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BUS_RING_H__
+#define __GST_BUS_RING_H__
+
+#include <gst/gstmessage.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_BUS_RING (gst_bus_ring_get_type())
+
+/**
+ * GstBusRing:
+ *
+ * Opaque handle of a shared memory message ring.
+ *
+ * Since: 1.2
+ */
+typedef struct _GstBusRing GstBusRing;
+
+GType           gst_bus_ring_get_type           (void);
+
+GstBusRing *    gst_bus_ring_new                (const gchar * path, guint n_slots,
+                                                 guint slot_size, GError ** error);
+GstBusRing *    gst_bus_ring_open               (const gchar * path, GError ** error);
+
+GstBusRing *    gst_bus_ring_ref                (GstBusRing * ring);
+void            gst_bus_ring_unref              (GstBusRing * ring);
+
+gboolean        gst_bus_ring_push               (GstBusRing * ring, GstMessage * message);
+GstMessage *    gst_bus_ring_pop                (GstBusRing * ring, gchar ** src_path);
+
+guint           gst_bus_ring_get_dropped        (GstBusRing * ring);
+
+G_END_DECLS
+
+#endif /* __GST_BUS_RING_H__ */
@@ -68,6 +68,8 @@
 #include "gst_private.h"
 #include <gst/gst.h>
 #include <gobject/gvaluecollector.h>
+#include "gstregistrychunks.h"
+#include "gstvaluebinary.h"
 
 #define DEBUG_REFCOUNT
 
@@ -96,6 +98,37 @@ typedef struct _GstCapsImpl
 #define CAPS_IS_EMPTY_SIMPLE(caps)					\
   ((GST_CAPS_ARRAY (caps) == NULL) || (GST_CAPS_LEN (caps) == 0))
 
+/* private flag for caps created by gst_static_caps_get(). Those are never
+ * modified so the results of operations on them can be cached */
+#define CAPS_FLAG_STATIC (GST_MINI_OBJECT_FLAG_LAST << 15)
+
+#define CAPS_IS_STATIC(caps) \
+  (GST_CAPS_FLAGS (caps) & CAPS_FLAG_STATIC)
+
+/* number of entries in the cache, must be a power of 2 */
+#define CAPS_CACHE_SIZE 512
+
+/* the operations in the cache, the intersections use the
+ * GstCapsIntersectMode */
+#define CAPS_CACHE_OP_SUBSET 0x100
+
+typedef struct
+{
+  const GstCaps *caps1;
+  const GstCaps *caps2;
+  guint op;
+  /* the result of the intersection, a ref is held by the cache */
+  GstCaps *result;
+  gboolean is_subset;
+} GstCapsCacheEntry;
+
+/* a direct mapped cache, entries are replaced when their slot is needed for
+ * another operation */
+static GMutex caps_cache_lock;
+static GstCapsCacheEntry caps_cache[CAPS_CACHE_SIZE];
+static guint64 caps_cache_hits = 0;
+static guint64 caps_cache_misses = 0;
+
 /* quick way to get a caps structure at an index without doing a type or array
  * length check */
 #define gst_caps_get_structure_unchecked(caps, index) \
@@ -112,6 +145,7 @@ G_LOCK_DEFINE_STATIC (static_caps_lock);
 
 static void gst_caps_transform_to_string (const GValue * src_value,
     GValue * dest_value);
+static void gst_caps_cache_invalidate (const GstCaps * caps);
 static gboolean gst_caps_from_string_inplace (GstCaps * caps,
     const gchar * string);
 
@@ -143,7 +177,7 @@ _gst_caps_copy (const GstCaps * caps)
   g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
 
   newcaps = gst_caps_new_empty ();
-  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps);
+  GST_CAPS_FLAGS (newcaps) = GST_CAPS_FLAGS (caps) & ~CAPS_FLAG_STATIC;
   n = GST_CAPS_LEN (caps);
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_PERFORMANCE, caps, "doing copy %p -> %p",
@@ -166,6 +200,9 @@ _gst_caps_free (GstCaps * caps)
 
   /* The refcount must be 0, but since we're only called by gst_caps_unref,
    * don't bother testing. */
+  if (G_UNLIKELY (CAPS_IS_STATIC (caps)))
+    gst_caps_cache_invalidate (caps);
+
   len = GST_CAPS_LEN (caps);
   /* This can be used to get statistics about caps sizes */
   /*GST_CAT_INFO (GST_CAT_CAPS, "caps size: %d", len); */
@@ -299,6 +336,43 @@ gst_caps_new_simple (const char *media_type, const char *fieldname, ...)
   return caps;
 }
 
+/**
+ * gst_caps_new_id_simple:
+ * @media_type: the media type of the structure as a #GQuark
+ * @fieldname: the first field to set as a #GQuark
+ * @...: additional arguments
+ *
+ * Creates a new #GstCaps that contains one #GstStructure, like
+ * gst_caps_new_simple() but with the media type and field names given as
+ * quarks, for example with GST_STRUCTURE_QUARK(). The arguments have the
+ * same format as for gst_structure_new_id().
+ * Caller is responsible for unreffing the returned caps.
+ *
+ * Returns: (transfer full): the new #GstCaps
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_new_id_simple (GQuark media_type, GQuark fieldname, ...)
+{
+  GstCaps *caps;
+  GstStructure *structure;
+  va_list var_args;
+
+  g_return_val_if_fail (media_type != 0, NULL);
+
+  caps = gst_caps_new_empty ();
+  structure = gst_structure_new_id_empty (media_type);
+
+  va_start (var_args, fieldname);
+  gst_structure_id_set_valist (structure, fieldname, var_args);
+  va_end (var_args);
+
+  gst_caps_append_structure_unchecked (caps, structure);
+
+  return caps;
+}
+
 /**
  * gst_caps_new_full:
  * @struct1: the first structure to add
@@ -373,6 +447,7 @@ gst_static_caps_get (GstStaticCaps * static_caps)
   /* refcount is 0 when we need to convert */
   if (G_UNLIKELY (*caps == NULL)) {
     const char *string;
+    GstCaps *result;
 
     G_LOCK (static_caps_lock);
     /* check if other thread already updated */
@@ -384,11 +459,21 @@ gst_static_caps_get (GstStaticCaps * static_caps)
     if (G_UNLIKELY (string == NULL))
       goto no_string;
 
-    *caps = gst_caps_from_string (string);
+    /* templates from the registry can be created without parsing */
+    result = NULL;
+    if (GST_STATIC_CAPS_BINARY (static_caps))
+      result = _priv_gst_registry_chunks_caps_from_binary
+          (GST_STATIC_CAPS_BINARY (static_caps));
+    if (result == NULL)
+      result = gst_caps_from_string (string);
 
     /* convert to string */
-    if (G_UNLIKELY (*caps == NULL))
+    if (G_UNLIKELY (result == NULL))
       g_critical ("Could not convert static caps \"%s\"", string);
+    else
+      GST_CAPS_FLAG_SET (result, CAPS_FLAG_STATIC);
+
+    *caps = result;
 
     GST_CAT_TRACE (GST_CAT_CAPS, "created %p from string %s", static_caps,
         string);
@@ -420,10 +505,114 @@ void
 gst_static_caps_cleanup (GstStaticCaps * static_caps)
 {
   G_LOCK (static_caps_lock);
+  if (static_caps->caps) {
+    /* others might still have a ref and make it writable now */
+    GST_CAPS_FLAG_UNSET (static_caps->caps, CAPS_FLAG_STATIC);
+    gst_caps_cache_invalidate (static_caps->caps);
+  }
   gst_caps_replace (&static_caps->caps, NULL);
   G_UNLOCK (static_caps_lock);
 }
 
+/* cache */
+
+static inline guint
+gst_caps_cache_slot (const GstCaps * caps1, const GstCaps * caps2, guint op)
+{
+  guint hash;
+
+  hash = (GPOINTER_TO_UINT (caps1) >> 3) * 31 + (GPOINTER_TO_UINT (caps2) >> 3);
+  hash = (hash + op) * 2654435761u;
+
+  return (hash >> 16) & (CAPS_CACHE_SIZE - 1);
+}
+
+/* returns TRUE when the result of @op on @caps1 and @caps2 is in the cache
+ * and places the result in @result or @is_subset */
+static gboolean
+gst_caps_cache_lookup (const GstCaps * caps1, const GstCaps * caps2,
+    guint op, GstCaps ** result, gboolean * is_subset)
+{
+  GstCapsCacheEntry *entry;
+  gboolean found;
+
+  entry = &caps_cache[gst_caps_cache_slot (caps1, caps2, op)];
+
+  g_mutex_lock (&caps_cache_lock);
+  found = (entry->caps1 == caps1 && entry->caps2 == caps2 && entry->op == op);
+  if (found) {
+    if (result)
+      *result = gst_caps_ref (entry->result);
+    if (is_subset)
+      *is_subset = entry->is_subset;
+    caps_cache_hits++;
+  } else {
+    caps_cache_misses++;
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  return found;
+}
+
+static void
+gst_caps_cache_store (const GstCaps * caps1, const GstCaps * caps2,
+    guint op, GstCaps * result, gboolean is_subset)
+{
+  GstCapsCacheEntry *entry;
+  GstCaps *old;
+
+  entry = &caps_cache[gst_caps_cache_slot (caps1, caps2, op)];
+
+  g_mutex_lock (&caps_cache_lock);
+  old = entry->result;
+  entry->caps1 = caps1;
+  entry->caps2 = caps2;
+  entry->op = op;
+  entry->result = result ? gst_caps_ref (result) : NULL;
+  entry->is_subset = is_subset;
+  g_mutex_unlock (&caps_cache_lock);
+
+  /* might free caps, which takes the lock again */
+  if (old)
+    gst_caps_unref (old);
+}
+
+/* remove all entries with @caps as input, called when @caps is freed or
+ * stops being static caps. When @caps is NULL, the cache is cleared */
+static void
+gst_caps_cache_invalidate (const GstCaps * caps)
+{
+  GstCaps *results[CAPS_CACHE_SIZE];
+  guint i, n_results = 0;
+
+  g_mutex_lock (&caps_cache_lock);
+  for (i = 0; i < CAPS_CACHE_SIZE; i++) {
+    GstCapsCacheEntry *entry = &caps_cache[i];
+
+    if (entry->caps1 == NULL)
+      continue;
+
+    if (caps == NULL || entry->caps1 == caps || entry->caps2 == caps) {
+      if (entry->result)
+        results[n_results++] = entry->result;
+      memset (entry, 0, sizeof (GstCapsCacheEntry));
+    }
+  }
+  g_mutex_unlock (&caps_cache_lock);
+
+  for (i = 0; i < n_results; i++)
+    gst_caps_unref (results[i]);
+}
+
+void
+_priv_gst_caps_deinit (void)
+{
+  GST_CAT_INFO (GST_CAT_PERFORMANCE, "caps cache hits %" G_GUINT64_FORMAT
+      ", misses %" G_GUINT64_FORMAT, caps_cache_hits, caps_cache_misses);
+
+  gst_caps_cache_invalidate (NULL);
+}
+
 /* manipulation */
 
 static GstStructure *
@@ -927,6 +1116,80 @@ gst_caps_is_always_compatible (const GstCaps * caps1, const GstCaps * caps2)
   return gst_caps_is_subset (caps1, caps2);
 }
 
+/* caps with at least this many structures get a name index for the
+ * operations that compare structures of two caps */
+#define CAPS_INDEX_MIN_LEN 16
+
+/* groups the structures of a caps by name. Structures with a different name
+ * never intersect and are never a subset of each other, so with the index
+ * only the structures with the same name have to be compared. The index is
+ * built for one operation only because the structures of writable caps, and
+ * their names, can be changed at any time. The structures of one name are
+ * chained in the order of the caps so that the result order is preserved. */
+typedef struct
+{
+  guint len;
+  /* index of the next structure with the same name or len for the last
+   * one */
+  guint *next;
+  /* name quark -> index of the first structure with that name + 1 */
+  GHashTable *first;
+} GstCapsNameIndex;
+
+static void
+gst_caps_name_index_init (GstCapsNameIndex * index, const GstCaps * caps)
+{
+  GstStructure *structure;
+  GQuark name;
+  guint *last;
+  guint i, pos;
+
+  index->len = GST_CAPS_LEN (caps);
+  index->next = g_new (guint, index->len);
+  index->first = g_hash_table_new (NULL, NULL);
+
+  /* the last structure of each name, to append to the chains in order */
+  last = g_new (guint, index->len);
+
+  for (i = 0; i < index->len; i++) {
+    structure = gst_caps_get_structure_unchecked (caps, i);
+    name = gst_structure_get_name_id (structure);
+
+    index->next[i] = index->len;
+    pos = GPOINTER_TO_UINT (g_hash_table_lookup (index->first,
+            GUINT_TO_POINTER (name)));
+    if (pos == 0) {
+      g_hash_table_insert (index->first, GUINT_TO_POINTER (name),
+          GUINT_TO_POINTER (i + 1));
+      last[i] = i;
+    } else {
+      /* the first structure keeps track of the end of the chain */
+      index->next[last[pos - 1]] = i;
+      last[pos - 1] = i;
+    }
+  }
+  g_free (last);
+}
+
+static void
+gst_caps_name_index_clear (GstCapsNameIndex * index)
+{
+  g_free (index->next);
+  g_hash_table_destroy (index->first);
+}
+
+/* returns the index of the first structure named @name or len */
+static inline guint
+gst_caps_name_index_first (GstCapsNameIndex * index, GQuark name)
+{
+  guint pos;
+
+  pos = GPOINTER_TO_UINT (g_hash_table_lookup (index->first,
+          GUINT_TO_POINTER (name)));
+
+  return pos ? pos - 1 : index->len;
+}
+
 /**
  * gst_caps_is_subset:
  * @subset: a #GstCaps
@@ -953,24 +1216,56 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
-  for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
-    for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
+  if (CAPS_IS_STATIC (subset) && CAPS_IS_STATIC (superset)) {
+    if (gst_caps_cache_lookup (subset, superset, CAPS_CACHE_OP_SUBSET, NULL,
+            &ret))
+      return ret;
+  }
+
+  if (GST_CAPS_LEN (superset) >= CAPS_INDEX_MIN_LEN) {
+    GstCapsNameIndex index;
+    guint k;
+
+    gst_caps_name_index_init (&index, superset);
+    for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
       s1 = gst_caps_get_structure_unchecked (subset, i);
-      s2 = gst_caps_get_structure_unchecked (superset, j);
-      if (gst_structure_is_subset (s1, s2)) {
-        /* If we found a superset, continue with the next
-         * subset structure */
+      /* only the structures with the same name can be a superset */
+      for (k = gst_caps_name_index_first (&index,
+              gst_structure_get_name_id (s1)); k < index.len;
+          k = index.next[k]) {
+        s2 = gst_caps_get_structure_unchecked (superset, k);
+        if (gst_structure_is_subset (s1, s2))
+          break;
+      }
+      if (k == index.len) {
+        ret = FALSE;
         break;
       }
     }
-    /* If we found no superset for this subset structure
-     * we return FALSE immediately */
-    if (j == -1) {
-      ret = FALSE;
-      break;
+    gst_caps_name_index_clear (&index);
+  } else {
+    for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
+      for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
+        s1 = gst_caps_get_structure_unchecked (subset, i);
+        s2 = gst_caps_get_structure_unchecked (superset, j);
+        if (gst_structure_is_subset (s1, s2)) {
+          /* If we found a superset, continue with the next
+           * subset structure */
+          break;
+        }
+      }
+      /* If we found no superset for this subset structure
+       * we return FALSE immediately */
+      if (j == -1) {
+        ret = FALSE;
+        break;
+      }
     }
   }
 
+  if (CAPS_IS_STATIC (subset) && CAPS_IS_STATIC (superset))
+    gst_caps_cache_store (subset, superset, CAPS_CACHE_OP_SUBSET, NULL, ret);
+
   return ret;
 }
 
@@ -1122,6 +1417,30 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
    */
   len1 = GST_CAPS_LEN (caps1);
   len2 = GST_CAPS_LEN (caps2);
+
+  /* the order does not matter for the result, with large caps only check
+   * the structures with the same name */
+  if (len2 >= CAPS_INDEX_MIN_LEN) {
+    GstCapsNameIndex index;
+    gboolean res = FALSE;
+
+    gst_caps_name_index_init (&index, caps2);
+    for (j = 0; j < len1 && !res; j++) {
+      struct1 = gst_caps_get_structure_unchecked (caps1, j);
+      for (k = gst_caps_name_index_first (&index,
+              gst_structure_get_name_id (struct1)); k < len2;
+          k = index.next[k]) {
+        struct2 = gst_caps_get_structure_unchecked (caps2, k);
+        if (gst_structure_can_intersect (struct1, struct2)) {
+          res = TRUE;
+          break;
+        }
+      }
+    }
+    gst_caps_name_index_clear (&index);
+    return res;
+  }
+
   for (i = 0; i < len1 + len2 - 1; i++) {
     /* superset index goes from 0 to sgst_caps_structure_intersectuperset->structs->len-1 */
     j = MIN (i, len1 - 1);
@@ -1148,6 +1467,66 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   return FALSE;
 }
 
+typedef struct
+{
+  guint j, k;
+} GstCapsIntersectPair;
+
+static gint
+gst_caps_intersect_pair_compare (gconstpointer a, gconstpointer b)
+{
+  const GstCapsIntersectPair *pa = a, *pb = b;
+  guint64 da = (guint64) pa->j + pa->k, db = (guint64) pb->j + pb->k;
+
+  /* diagonals in order, on a diagonal walk down left */
+  if (da != db)
+    return da < db ? -1 : 1;
+  if (pa->j != pb->j)
+    return pa->j > pb->j ? -1 : 1;
+  return 0;
+}
+
+/* same as the zigzag loop but only intersects the structures with the same
+ * name, the pairs are visited in the zigzag order so that the result is the
+ * same */
+static GstCaps *
+gst_caps_intersect_zig_zag_indexed (GstCaps * dest, GstCaps * caps1,
+    GstCaps * caps2)
+{
+  GstCapsNameIndex index;
+  GstCapsIntersectPair pair;
+  GArray *pairs;
+  GstStructure *struct1;
+  GstStructure *istruct;
+  guint i, len1;
+
+  len1 = GST_CAPS_LEN (caps1);
+
+  gst_caps_name_index_init (&index, caps2);
+  pairs = g_array_new (FALSE, FALSE, sizeof (GstCapsIntersectPair));
+  for (pair.j = 0; pair.j < len1; pair.j++) {
+    struct1 = gst_caps_get_structure_unchecked (caps1, pair.j);
+    for (pair.k = gst_caps_name_index_first (&index,
+            gst_structure_get_name_id (struct1)); pair.k < index.len;
+        pair.k = index.next[pair.k])
+      g_array_append_val (pairs, pair);
+  }
+  gst_caps_name_index_clear (&index);
+
+  g_array_sort (pairs, gst_caps_intersect_pair_compare);
+
+  for (i = 0; i < pairs->len; i++) {
+    pair = g_array_index (pairs, GstCapsIntersectPair, i);
+    istruct =
+        gst_structure_intersect (gst_caps_get_structure_unchecked (caps1,
+            pair.j), gst_caps_get_structure_unchecked (caps2, pair.k));
+    dest = gst_caps_merge_structure (dest, istruct);
+  }
+  g_array_free (pairs, TRUE);
+
+  return dest;
+}
+
 static GstCaps *
 gst_caps_intersect_zig_zag (GstCaps * caps1, GstCaps * caps2)
 {
@@ -1193,6 +1572,10 @@ gst_caps_intersect_zig_zag (GstCaps * caps1, GstCaps * caps2)
    */
   len1 = GST_CAPS_LEN (caps1);
   len2 = GST_CAPS_LEN (caps2);
+
+  if (len2 >= CAPS_INDEX_MIN_LEN)
+    return gst_caps_intersect_zig_zag_indexed (dest, caps1, caps2);
+
   for (i = 0; i < len1 + len2 - 1; i++) {
     /* caps1 index goes from 0 to GST_CAPS_LEN (caps1)-1 */
     j = MIN (i, len1 - 1);
@@ -1261,6 +1644,29 @@ gst_caps_intersect_first (GstCaps * caps1, GstCaps * caps2)
 
   len1 = GST_CAPS_LEN (caps1);
   len2 = GST_CAPS_LEN (caps2);
+
+  if (len2 >= CAPS_INDEX_MIN_LEN) {
+    GstCapsNameIndex index;
+
+    /* only intersect with the structures with the same name, the chains
+     * are in the caps2 order */
+    gst_caps_name_index_init (&index, caps2);
+    for (i = 0; i < len1; i++) {
+      struct1 = gst_caps_get_structure_unchecked (caps1, i);
+      for (j = gst_caps_name_index_first (&index,
+              gst_structure_get_name_id (struct1)); j < len2;
+          j = index.next[j]) {
+        struct2 = gst_caps_get_structure_unchecked (caps2, j);
+        istruct = gst_structure_intersect (struct1, struct2);
+        if (istruct)
+          dest = gst_caps_merge_structure (dest, istruct);
+      }
+    }
+    gst_caps_name_index_clear (&index);
+
+    return dest;
+  }
+
   for (i = 0; i < len1; i++) {
     struct1 = gst_caps_get_structure_unchecked (caps1, i);
     for (j = 0; j < len2; j++) {
@@ -1284,6 +1690,10 @@ gst_caps_intersect_first (GstCaps * caps1, GstCaps * caps2)
  * to both @caps1 and @caps2, the order is defined by the #GstCapsIntersectMode
  * used.
  *
+ * The result of intersecting two static caps is cached, the returned caps can
+ * therefore be shared and need to be made writable with
+ * gst_caps_make_writable() before they can be modified.
+ *
  * Returns: the new #GstCaps
  */
 GstCaps *
@@ -1293,6 +1703,23 @@ gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
+  if (CAPS_IS_STATIC (caps1) && CAPS_IS_STATIC (caps2) && caps1 != caps2 &&
+      (mode == GST_CAPS_INTERSECT_ZIG_ZAG || mode == GST_CAPS_INTERSECT_FIRST)) {
+    GstCaps *result;
+
+    if (gst_caps_cache_lookup (caps1, caps2, mode, &result, NULL))
+      return result;
+
+    if (mode == GST_CAPS_INTERSECT_FIRST)
+      result = gst_caps_intersect_first (caps1, caps2);
+    else
+      result = gst_caps_intersect_zig_zag (caps1, caps2);
+
+    gst_caps_cache_store (caps1, caps2, mode, result, FALSE);
+
+    return result;
+  }
+
   switch (mode) {
     case GST_CAPS_INTERSECT_FIRST:
       return gst_caps_intersect_first (caps1, caps2);
@@ -1801,7 +2228,9 @@ static gboolean
 gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
 {
   GstStructure *structure;
+  gchar *copy;
   gchar *s;
+  gboolean ret = FALSE;
 
   if (strcmp ("ANY", string) == 0) {
     GST_CAPS_FLAGS (caps) = GST_CAPS_FLAG_ANY;
@@ -1811,9 +2240,12 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
     return TRUE;
   }
 
-  structure = gst_structure_from_string (string, &s);
+  /* copy once and parse all structures from the same buffer */
+  copy = g_strdup (string);
+
+  structure = priv_gst_structure_from_string_inplace (copy, &s);
   if (structure == NULL) {
-    return FALSE;
+    goto done;
   }
   gst_caps_append_structure_unchecked (caps, structure);
 
@@ -1824,15 +2256,19 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
     if (*s == '\0') {
       break;
     }
-    structure = gst_structure_from_string (s, &s);
+    structure = priv_gst_structure_from_string_inplace (s, &s);
     if (structure == NULL) {
-      return FALSE;
+      goto done;
     }
     gst_caps_append_structure_unchecked (caps, structure);
 
   } while (TRUE);
 
-  return TRUE;
+  ret = TRUE;
+
+done:
+  g_free (copy);
+  return ret;
 }
 
 /**
@@ -1859,6 +2295,72 @@ gst_caps_from_string (const gchar * string)
   }
 }
 
+/**
+ * gst_caps_to_binary:
+ * @caps: a #GstCaps
+ * @size: (out) (allow-none): location for the size of the result
+ *
+ * Serializes @caps into a compact binary form that can be turned back into
+ * caps with gst_caps_from_binary(). This is a lot faster than
+ * gst_caps_to_string() and gst_caps_from_string() for exchanging caps
+ * between processes. The binary form is versioned and only meant to be read
+ * by the same GStreamer version.
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size): the binary form of @caps,
+ *     or %NULL when one of the fields can not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_caps_to_binary (const GstCaps * caps, gsize * size)
+{
+  GByteArray *out;
+  gboolean ok;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+
+  out = g_byte_array_new ();
+  _priv_gst_value_binary_write_header (out, GST_VALUE_BINARY_KIND_CAPS);
+  ok = _priv_gst_value_binary_write_caps (out, caps);
+
+  return _priv_gst_value_binary_finish (out, ok, size);
+}
+
+/**
+ * gst_caps_from_binary:
+ * @data: (array length=size): data created with gst_caps_to_binary()
+ * @size: the size of @data
+ *
+ * Creates caps from their binary form as created by gst_caps_to_binary().
+ *
+ * Returns: (transfer full): a newly allocated #GstCaps or %NULL when @data
+ *     is not valid binary caps.
+ *
+ * Since: 1.2
+ */
+GstCaps *
+gst_caps_from_binary (const guint8 * data, gsize size)
+{
+  GstValueBinaryReader reader;
+  GstCaps *caps;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_value_binary_read_header (&reader, data, size,
+          GST_VALUE_BINARY_KIND_CAPS))
+    return NULL;
+
+  caps = _priv_gst_value_binary_read_caps (&reader);
+  if (caps && reader.pos != reader.size) {
+    gst_caps_unref (caps);
+    caps = NULL;
+  }
+
+  return caps;
+}
+
 static void
 gst_caps_transform_to_string (const GValue * src_value, GValue * dest_value)
 {
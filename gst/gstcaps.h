@@ -370,6 +370,9 @@ GstCaps *         gst_caps_new_empty_simple        (const char    *media_type) G
 GstCaps *         gst_caps_new_simple              (const char    *media_type,
                                                     const char    *fieldname,
                                                     ...) G_GNUC_NULL_TERMINATED G_GNUC_WARN_UNUSED_RESULT;
+GstCaps *         gst_caps_new_id_simple           (GQuark         media_type,
+                                                    GQuark         fieldname,
+                                                    ...) G_GNUC_WARN_UNUSED_RESULT;
 GstCaps *         gst_caps_new_full                (GstStructure  *struct1,
                                                     ...) G_GNUC_NULL_TERMINATED G_GNUC_WARN_UNUSED_RESULT;
 GstCaps *         gst_caps_new_full_valist         (GstStructure  *structure,
@@ -441,6 +444,10 @@ GstCaps *         gst_caps_fixate                  (GstCaps *caps) G_GNUC_WARN_U
 /* utility */
 gchar *           gst_caps_to_string               (const GstCaps *caps) G_GNUC_MALLOC;
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
+guint8 *          gst_caps_to_binary               (const GstCaps *caps,
+                                                    gsize         *size) G_GNUC_MALLOC;
+GstCaps *         gst_caps_from_binary             (const guint8  *data,
+                                                    gsize          size) G_GNUC_WARN_UNUSED_RESULT;
 
 G_END_DECLS
 
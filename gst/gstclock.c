@@ -109,6 +109,8 @@
 #include "gstclock.h"
 #include "gstinfo.h"
 #include "gstutils.h"
+#include "gsttracerutils.h"
+#include "gstatomicqueue.h"
 #include "glib-compat-private.h"
 
 #ifndef GST_DISABLE_TRACE
@@ -123,6 +125,13 @@ static GstAllocTrace *_gst_clock_entry_trace;
 #define DEFAULT_WINDOW_THRESHOLD        4
 #define DEFAULT_TIMEOUT                 GST_SECOND / 10
 
+/* freed entries are kept for reuse, up to this many */
+#define MAX_CACHED_ENTRIES              64
+
+/* the entries don't keep their clock alive, so the cache is shared by all
+ * clocks instead of being kept in the clock */
+static GstAtomicQueue *_gst_clock_entry_cache;
+
 enum
 {
   PROP_0,
@@ -175,9 +184,12 @@ read_seqretry (GstClock * clock, gint seq)
   if (G_LIKELY (seq == g_atomic_int_get (&clock->priv->pre_count)))
     return FALSE;
 
-  /* wait for the writer to finish and retry */
-  GST_OBJECT_LOCK (clock);
-  GST_OBJECT_UNLOCK (clock);
+  /* a writer is busy, it only copies a few values so let it finish without
+   * blocking on the object lock, which is also taken for longer operations */
+  while (g_atomic_int_get (&clock->priv->pre_count) !=
+      g_atomic_int_get (&clock->priv->post_count))
+    g_thread_yield ();
+
   return TRUE;
 }
 
@@ -209,7 +221,9 @@ gst_clock_entry_new (GstClock * clock, GstClockTime time,
 {
   GstClockEntry *entry;
 
-  entry = g_slice_new (GstClockEntry);
+  entry = gst_atomic_queue_pop (_gst_clock_entry_cache);
+  if (entry == NULL)
+    entry = g_slice_new (GstClockEntry);
 #ifndef GST_DISABLE_TRACE
   _gst_alloc_trace_new (_gst_clock_entry_trace, entry);
 #endif
@@ -291,6 +305,48 @@ gst_clock_periodic_id_reinit (GstClock * clock, GstClockID id,
       interval, GST_CLOCK_ENTRY_PERIODIC);
 }
 
+/**
+ * gst_clock_periodic_id_set_interval:
+ * @id: a periodic #GstClockID
+ * @interval: the new interval
+ *
+ * Changes the interval of the periodic @id. Unlike
+ * gst_clock_periodic_id_reinit() this can be done while @id is waited for,
+ * the wait for the current period is not affected and the new interval is
+ * used for the following periods. Does not modify the reference count.
+ *
+ * Returns: %TRUE if the interval of @id was changed, %FALSE if @id is not
+ * periodic.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_clock_periodic_id_set_interval (GstClockID id, GstClockTime interval)
+{
+  GstClockEntry *entry;
+  GstClock *clock;
+
+  g_return_val_if_fail (id != NULL, FALSE);
+  g_return_val_if_fail (interval != 0, FALSE);
+  g_return_val_if_fail (GST_CLOCK_TIME_IS_VALID (interval), FALSE);
+
+  entry = (GstClockEntry *) id;
+  if (entry->type != GST_CLOCK_ENTRY_PERIODIC)
+    return FALSE;
+
+  clock = entry->clock;
+
+  /* the clock reads the interval with its lock taken when it schedules the
+   * next period, in gst_clock_id_wait() and in the async thread */
+  GST_OBJECT_LOCK (clock);
+  entry->interval = interval;
+  GST_OBJECT_UNLOCK (clock);
+
+  return TRUE;
+}
+
 /**
  * gst_clock_id_ref:
  * @id: The #GstClockID to ref
@@ -325,7 +381,10 @@ _gst_clock_id_free (GstClockID id)
 #ifndef GST_DISABLE_TRACE
   _gst_alloc_trace_free (_gst_clock_entry_trace, id);
 #endif
-  g_slice_free (GstClockEntry, id);
+  if (gst_atomic_queue_length (_gst_clock_entry_cache) < MAX_CACHED_ENTRIES)
+    gst_atomic_queue_push (_gst_clock_entry_cache, entry);
+  else
+    g_slice_free (GstClockEntry, id);
 }
 
 /**
@@ -509,13 +568,20 @@ gst_clock_id_wait (GstClockID id, GstClockTimeDiff * jitter)
   if (G_UNLIKELY (cclass->wait == NULL))
     goto not_supported;
 
+  GST_TRACER_CLOCK_WAIT_PRE (clock, id);
   res = cclass->wait (clock, entry, jitter);
+  GST_TRACER_CLOCK_WAIT_POST (clock, res);
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
       "done waiting entry %p, res: %d", id, res);
 
-  if (entry->type == GST_CLOCK_ENTRY_PERIODIC)
+  /* the interval can be changed with gst_clock_periodic_id_set_interval()
+   * while we wait, read it with the lock */
+  if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
+    GST_OBJECT_LOCK (clock);
     entry->time = requested + entry->interval;
+    GST_OBJECT_UNLOCK (clock);
+  }
 
   return res;
 
@@ -631,6 +697,49 @@ gst_clock_id_unschedule (GstClockID id)
     cclass->unschedule (clock, entry);
 }
 
+/**
+ * gst_clock_unschedule_ids:
+ * @clock: a #GstClock
+ * @ids: (array length=n_ids): the ids to unschedule
+ * @n_ids: the number of ids in @ids
+ *
+ * Cancels the outstanding requests of all @ids, see
+ * gst_clock_id_unschedule(). All @ids must belong to @clock.
+ *
+ * This is cheaper than unscheduling the ids one by one, the #GstSystemClock
+ * for example wakes up the waiting threads only once for all @ids.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_clock_unschedule_ids (GstClock * clock, GstClockID * ids, guint n_ids)
+{
+  GstClockClass *cclass;
+  guint i;
+
+  g_return_if_fail (GST_IS_CLOCK (clock));
+  g_return_if_fail (ids != NULL || n_ids == 0);
+
+  for (i = 0; i < n_ids; i++) {
+    g_return_if_fail (ids[i] != NULL);
+    g_return_if_fail (((GstClockEntry *) ids[i])->clock == clock);
+  }
+
+  if (n_ids == 0)
+    return;
+
+  cclass = GST_CLOCK_GET_CLASS (clock);
+
+  if (cclass->unschedule_ids) {
+    cclass->unschedule_ids (clock, (GstClockEntry **) ids, n_ids);
+  } else if (G_LIKELY (cclass->unschedule)) {
+    for (i = 0; i < n_ids; i++)
+      cclass->unschedule (clock, (GstClockEntry *) ids[i]);
+  }
+}
+
 
 /*
  * GstClock abstract base class implementation
@@ -646,6 +755,7 @@ gst_clock_class_init (GstClockClass * klass)
 #ifndef GST_DISABLE_TRACE
   _gst_clock_entry_trace = _gst_alloc_trace_register ("GstClockEntry", -1);
 #endif
+  _gst_clock_entry_cache = gst_atomic_queue_new (MAX_CACHED_ENTRIES);
 
   gobject_class->dispose = gst_clock_dispose;
   gobject_class->finalize = gst_clock_finalize;
@@ -789,31 +899,11 @@ gst_clock_get_resolution (GstClock * clock)
   return 1;
 }
 
-/**
- * gst_clock_adjust_unlocked:
- * @clock: a #GstClock to use
- * @internal: a clock time
- *
- * Converts the given @internal clock time to the external time, adjusting for the
- * rate and reference time set with gst_clock_set_calibration() and making sure
- * that the returned time is increasing. This function should be called with the
- * clock's OBJECT_LOCK held and is mainly used by clock subclasses.
- *
- * This function is the reverse of gst_clock_unadjust_unlocked().
- *
- * Returns: the converted time of the clock.
- */
-GstClockTime
-gst_clock_adjust_unlocked (GstClock * clock, GstClockTime internal)
+static GstClockTime
+clock_adjust (GstClockTime internal, GstClockTime cinternal,
+    GstClockTime cexternal, GstClockTime cnum, GstClockTime cdenom)
 {
-  GstClockTime ret, cinternal, cexternal, cnum, cdenom;
-  GstClockPrivate *priv = clock->priv;
-
-  /* get calibration values for readability */
-  cinternal = priv->internal_calibration;
-  cexternal = priv->external_calibration;
-  cnum = priv->rate_numerator;
-  cdenom = priv->rate_denominator;
+  GstClockTime ret;
 
   /* avoid divide by 0 */
   if (G_UNLIKELY (cdenom == 0))
@@ -827,17 +917,46 @@ gst_clock_adjust_unlocked (GstClock * clock, GstClockTime internal)
    */
   if (G_LIKELY (internal >= cinternal)) {
     ret = internal - cinternal;
-    ret = gst_util_uint64_scale (ret, cnum, cdenom);
+    /* the rate is 1/1 unless the clock is slaved, skip the scaling */
+    if (G_UNLIKELY (cnum != cdenom))
+      ret = gst_util_uint64_scale (ret, cnum, cdenom);
     ret += cexternal;
   } else {
     ret = cinternal - internal;
-    ret = gst_util_uint64_scale (ret, cnum, cdenom);
+    if (G_UNLIKELY (cnum != cdenom))
+      ret = gst_util_uint64_scale (ret, cnum, cdenom);
     /* clamp to 0 */
     if (G_LIKELY (cexternal > ret))
       ret = cexternal - ret;
     else
       ret = 0;
   }
+  return ret;
+}
+
+/**
+ * gst_clock_adjust_unlocked:
+ * @clock: a #GstClock to use
+ * @internal: a clock time
+ *
+ * Converts the given @internal clock time to the external time, adjusting for the
+ * rate and reference time set with gst_clock_set_calibration() and making sure
+ * that the returned time is increasing. This function should be called with the
+ * clock's OBJECT_LOCK held and is mainly used by clock subclasses.
+ *
+ * This function is the reverse of gst_clock_unadjust_unlocked().
+ *
+ * Returns: the converted time of the clock.
+ */
+GstClockTime
+gst_clock_adjust_unlocked (GstClock * clock, GstClockTime internal)
+{
+  GstClockPrivate *priv = clock->priv;
+  GstClockTime ret;
+
+  ret = clock_adjust (internal, priv->internal_calibration,
+      priv->external_calibration, priv->rate_numerator,
+      priv->rate_denominator);
 
   /* make sure the time is increasing */
   priv->last_time = MAX (ret, priv->last_time);
@@ -878,11 +997,13 @@ gst_clock_unadjust_unlocked (GstClock * clock, GstClockTime external)
   /* The formula is (external - cexternal) * cdenom / cnum + cinternal */
   if (G_LIKELY (external >= cexternal)) {
     ret = external - cexternal;
-    ret = gst_util_uint64_scale (ret, cdenom, cnum);
+    if (G_UNLIKELY (cnum != cdenom))
+      ret = gst_util_uint64_scale (ret, cdenom, cnum);
     ret += cinternal;
   } else {
     ret = cexternal - external;
-    ret = gst_util_uint64_scale (ret, cdenom, cnum);
+    if (G_UNLIKELY (cnum != cdenom))
+      ret = gst_util_uint64_scale (ret, cdenom, cnum);
     if (G_LIKELY (cinternal > ret))
       ret = cinternal - ret;
     else
@@ -948,21 +1069,46 @@ not_supported:
 GstClockTime
 gst_clock_get_time (GstClock * clock)
 {
-  GstClockTime ret;
+  GstClockTime ret, last, cinternal, cexternal, cnum, cdenom;
+  GstClockClass *cclass;
+  GstClockPrivate *priv;
   gint seq;
 
   g_return_val_if_fail (GST_IS_CLOCK (clock), GST_CLOCK_TIME_NONE);
 
+  cclass = GST_CLOCK_GET_CLASS (clock);
+  priv = clock->priv;
+
   do {
     /* reget the internal time when we retry to get the most current
-     * timevalue */
-    ret = gst_clock_get_internal_time (clock);
+     * timevalue. This is called for every buffer by live sources, call the
+     * vmethod directly instead of doing the checks of
+     * gst_clock_get_internal_time() again */
+    if (G_LIKELY (cclass->get_internal_time))
+      ret = cclass->get_internal_time (clock);
+    else
+      ret = 0;
 
+    /* take a consistent copy of the calibration, a torn copy must never be
+     * used because it would push last_time into the future */
     seq = read_seqbegin (clock);
-    /* this will scale for rate and offset */
-    ret = gst_clock_adjust_unlocked (clock, ret);
+    cinternal = priv->internal_calibration;
+    cexternal = priv->external_calibration;
+    cnum = priv->rate_numerator;
+    cdenom = priv->rate_denominator;
   } while (read_seqretry (clock, seq));
 
+  /* this will scale for rate and offset */
+  ret = clock_adjust (ret, cinternal, cexternal, cnum, cdenom);
+
+  /* make sure the time is increasing. Concurrent callers can race here but
+   * each of them returns a time that is not smaller than what it saw */
+  last = priv->last_time;
+  if (G_LIKELY (ret > last))
+    priv->last_time = ret;
+  else
+    ret = last;
+
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "adjusted time %" GST_TIME_FORMAT,
       GST_TIME_ARGS (ret));
 
@@ -1014,13 +1160,14 @@ gst_clock_set_calibration (GstClock * clock, GstClockTime internal, GstClockTime
 
   priv = clock->priv;
 
-  write_seqlock (clock);
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
       "internal %" GST_TIME_FORMAT " external %" GST_TIME_FORMAT " %"
       G_GUINT64_FORMAT "/%" G_GUINT64_FORMAT " = %f", GST_TIME_ARGS (internal),
       GST_TIME_ARGS (external), rate_num, rate_denom,
       gst_guint64_to_gdouble (rate_num) / gst_guint64_to_gdouble (rate_denom));
 
+  /* readers spin while we hold the seqlock, keep it short */
+  write_seqlock (clock);
   priv->internal_calibration = internal;
   priv->external_calibration = external;
   priv->rate_numerator = rate_num;
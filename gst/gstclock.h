@@ -425,6 +425,9 @@ struct _GstClock {
  *               the jitter.
  * @wait_async: perform an asynchronous wait for the given #GstClockEntry.
  * @unschedule: unblock a blocking or async wait operation.
+ * @unschedule_ids: unblock the wait operations on a set of entries at once.
+ *               When not implemented @unschedule is called for each entry.
+ *               Since: 1.2
  *
  * GStreamer clock class. Override the vmethods to implement the clock
  * functionality.
@@ -446,9 +449,11 @@ struct _GstClockClass {
                                                  GstClockTimeDiff *jitter);
   GstClockReturn        (*wait_async)           (GstClock *clock, GstClockEntry *entry);
   void                  (*unschedule)           (GstClock *clock, GstClockEntry *entry);
+  void                  (*unschedule_ids)       (GstClock *clock, GstClockEntry **entries,
+                                                 guint n_entries);
 
   /*< private >*/
-  gpointer _gst_reserved[GST_PADDING];
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 GType                   gst_clock_get_type              (void);
@@ -507,6 +512,9 @@ GstClockReturn          gst_clock_id_wait_async         (GstClockID id,
                                                          gpointer user_data,
                                                          GDestroyNotify destroy_data);
 void                    gst_clock_id_unschedule         (GstClockID id);
+void                    gst_clock_unschedule_ids        (GstClock *clock,
+                                                         GstClockID *ids,
+                                                         guint n_ids);
 
 gboolean                gst_clock_single_shot_id_reinit (GstClock * clock,
                                                          GstClockID id,
@@ -515,6 +523,8 @@ gboolean                gst_clock_periodic_id_reinit    (GstClock * clock,
                                                          GstClockID id,
                                                          GstClockTime start_time,
                                                          GstClockTime interval);
+gboolean                gst_clock_periodic_id_set_interval (GstClockID id,
+                                                         GstClockTime interval);
 
 G_END_DECLS
 
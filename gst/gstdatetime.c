@@ -54,14 +54,99 @@ typedef enum
        * the compare function will need updating */
 } GstDateTimeFields;
 
+/* The date and time are stored as the wall clock time in microseconds since
+ * 1970-01-01 00:00:00 plus the offset from UTC, so that creating, comparing
+ * and serializing dates does not need a GDateTime. A GDateTime is only
+ * created when one is asked for. */
 struct _GstDateTime
 {
-  GDateTime *datetime;
+  gint64 local_usecs;
+  gint32 utc_offset;            /* in seconds */
 
   GstDateTimeFields fields;
   volatile gint ref_count;
 };
 
+#define USEC_PER_MINUTE (G_GINT64_CONSTANT (60) * G_USEC_PER_SEC)
+#define USEC_PER_HOUR   (G_GINT64_CONSTANT (3600) * G_USEC_PER_SEC)
+#define USEC_PER_DAY    (G_GINT64_CONSTANT (86400) * G_USEC_PER_SEC)
+
+static inline gint64
+floor_div (gint64 a, gint64 b)
+{
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static inline gint64
+floor_mod (gint64 a, gint64 b)
+{
+  return a - floor_div (a, b) * b;
+}
+
+/* days since 1970-01-01 of a date in the proleptic Gregorian calendar, see
+ * http://howardhinnant.github.io/date_algorithms.html */
+static gint64
+days_from_civil (gint year, gint month, gint day)
+{
+  gint64 y = year - (month <= 2);
+  gint64 era = floor_div (y, 400);
+  gint64 yoe = y - era * 400;
+  gint64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  gint64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return era * 146097 + doe - 719468;
+}
+
+static void
+civil_from_days (gint64 days, gint * year, gint * month, gint * day)
+{
+  gint64 z = days + 719468;
+  gint64 era = floor_div (z, 146097);
+  gint64 doe = z - era * 146097;
+  gint64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  gint64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  gint64 mp = (5 * doy + 2) / 153;
+  gint m = mp < 10 ? mp + 3 : mp - 9;
+
+  if (year)
+    *year = yoe + era * 400 + (m <= 2);
+  if (month)
+    *month = m;
+  if (day)
+    *day = doy - (153 * mp + 2) / 5 + 1;
+}
+
+static GstDateTime *
+gst_date_time_new_internal (gint64 local_usecs, gint32 utc_offset,
+    GstDateTimeFields fields)
+{
+  GstDateTime *datetime;
+
+  datetime = g_slice_new (GstDateTime);
+  datetime->local_usecs = local_usecs;
+  datetime->utc_offset = utc_offset;
+  datetime->fields = fields;
+  datetime->ref_count = 1;
+
+  return datetime;
+}
+
+/* the time zone with a fixed offset in seconds from UTC */
+static GTimeZone *
+gst_date_time_new_time_zone (gint32 utc_offset)
+{
+  gchar buf[6];
+  gint tzhour, tzminute;
+
+  tzhour = ABS (utc_offset) / 3600;
+  tzminute = (ABS (utc_offset) / 60) % 60;
+
+  g_snprintf (buf, 6, "%c%02d%02d", utc_offset >= 0 ? '+' : '-', tzhour,
+      tzminute);
+
+  return g_time_zone_new (buf);
+}
+
 /**
  * gst_date_time_new_from_g_date_time:
  * @dt: (transfer full): the #GDateTime. The new #GstDateTime takes ownership.
@@ -75,16 +160,24 @@ struct _GstDateTime
 GstDateTime *
 gst_date_time_new_from_g_date_time (GDateTime * dt)
 {
-  GstDateTime *gst_dt;
+  gint year, month, day;
+  gint64 local_usecs;
+  gint32 utc_offset;
 
   if (!dt)
     return NULL;
 
-  gst_dt = g_slice_new (GstDateTime);
-  gst_dt->datetime = dt;
-  gst_dt->fields = GST_DATE_TIME_FIELDS_YMD_HMS;
-  gst_dt->ref_count = 1;
-  return gst_dt;
+  g_date_time_get_ymd (dt, &year, &month, &day);
+  local_usecs = days_from_civil (year, month, day) * USEC_PER_DAY +
+      g_date_time_get_hour (dt) * USEC_PER_HOUR +
+      g_date_time_get_minute (dt) * USEC_PER_MINUTE +
+      g_date_time_get_second (dt) * G_USEC_PER_SEC +
+      g_date_time_get_microsecond (dt);
+  utc_offset = g_date_time_get_utc_offset (dt) / G_USEC_PER_SEC;
+  g_date_time_unref (dt);
+
+  return gst_date_time_new_internal (local_usecs, utc_offset,
+      GST_DATE_TIME_FIELDS_YMD_HMS);
 }
 
 /**
@@ -100,12 +193,28 @@ gst_date_time_new_from_g_date_time (GDateTime * dt)
 GDateTime *
 gst_date_time_to_g_date_time (GstDateTime * datetime)
 {
+  GDateTime *utc, *tmp, *ret;
+  GTimeZone *tz;
+  gint64 secs;
+
   g_return_val_if_fail (datetime != NULL, NULL);
 
   if (datetime->fields != GST_DATE_TIME_FIELDS_YMD_HMS)
     return NULL;
 
-  return g_date_time_add (datetime->datetime, 0);
+  /* go through the UTC time to keep the microseconds exact */
+  secs = floor_div (datetime->local_usecs, G_USEC_PER_SEC);
+  utc = g_date_time_new_from_unix_utc (secs - datetime->utc_offset);
+  tmp = g_date_time_add (utc, floor_mod (datetime->local_usecs,
+          G_USEC_PER_SEC));
+  g_date_time_unref (utc);
+
+  tz = gst_date_time_new_time_zone (datetime->utc_offset);
+  ret = g_date_time_to_timezone (tmp, tz);
+  g_time_zone_unref (tz);
+  g_date_time_unref (tmp);
+
+  return ret;
 }
 
 /**
@@ -192,9 +301,14 @@ gst_date_time_has_second (const GstDateTime * datetime)
 gint
 gst_date_time_get_year (const GstDateTime * datetime)
 {
+  gint year;
+
   g_return_val_if_fail (datetime != NULL, 0);
 
-  return g_date_time_get_year (datetime->datetime);
+  civil_from_days (floor_div (datetime->local_usecs, USEC_PER_DAY), &year,
+      NULL, NULL);
+
+  return year;
 }
 
 /**
@@ -209,10 +323,15 @@ gst_date_time_get_year (const GstDateTime * datetime)
 gint
 gst_date_time_get_month (const GstDateTime * datetime)
 {
+  gint month;
+
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_month (datetime), 0);
 
-  return g_date_time_get_month (datetime->datetime);
+  civil_from_days (floor_div (datetime->local_usecs, USEC_PER_DAY), NULL,
+      &month, NULL);
+
+  return month;
 }
 
 /**
@@ -227,10 +346,15 @@ gst_date_time_get_month (const GstDateTime * datetime)
 gint
 gst_date_time_get_day (const GstDateTime * datetime)
 {
+  gint day;
+
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_day (datetime), 0);
 
-  return g_date_time_get_day_of_month (datetime->datetime);
+  civil_from_days (floor_div (datetime->local_usecs, USEC_PER_DAY), NULL,
+      NULL, &day);
+
+  return day;
 }
 
 /**
@@ -249,7 +373,7 @@ gst_date_time_get_hour (const GstDateTime * datetime)
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_time (datetime), 0);
 
-  return g_date_time_get_hour (datetime->datetime);
+  return floor_mod (datetime->local_usecs, USEC_PER_DAY) / USEC_PER_HOUR;
 }
 
 /**
@@ -268,7 +392,7 @@ gst_date_time_get_minute (const GstDateTime * datetime)
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_time (datetime), 0);
 
-  return g_date_time_get_minute (datetime->datetime);
+  return floor_mod (datetime->local_usecs, USEC_PER_HOUR) / USEC_PER_MINUTE;
 }
 
 /**
@@ -287,7 +411,7 @@ gst_date_time_get_second (const GstDateTime * datetime)
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_second (datetime), 0);
 
-  return g_date_time_get_second (datetime->datetime);
+  return floor_mod (datetime->local_usecs, USEC_PER_MINUTE) / G_USEC_PER_SEC;
 }
 
 /**
@@ -305,7 +429,7 @@ gst_date_time_get_microsecond (const GstDateTime * datetime)
   g_return_val_if_fail (datetime != NULL, 0);
   g_return_val_if_fail (gst_date_time_has_second (datetime), 0);
 
-  return g_date_time_get_microsecond (datetime->datetime);
+  return floor_mod (datetime->local_usecs, G_USEC_PER_SEC);
 }
 
 /**
@@ -325,8 +449,7 @@ gst_date_time_get_time_zone_offset (const GstDateTime * datetime)
   g_return_val_if_fail (datetime != NULL, 0.0);
   g_return_val_if_fail (gst_date_time_has_time (datetime), 0.0);
 
-  return (g_date_time_get_utc_offset (datetime->datetime) /
-      G_USEC_PER_SEC) / 3600.0;
+  return datetime->utc_offset / 3600.0;
 }
 
 /**
@@ -508,6 +631,8 @@ gst_date_time_new_local_time (gint year, gint month, gint day, gint hour,
 
   datetime = gst_date_time_new_from_g_date_time (g_date_time_new_local (year,
           month, day, hour, minute, seconds));
+  if (datetime == NULL)
+    return NULL;
 
   datetime->fields = fields;
   return datetime;
@@ -559,8 +684,8 @@ __gst_date_time_compare (const GstDateTime * dt1, const GstDateTime * dt2)
   /* This will round down to nearest second, which is what we want. We're
    * not comparing microseconds on purpose here, since we're not
    * serialising them when doing new_utc_now() + to_string() */
-  diff =
-      g_date_time_to_unix (dt1->datetime) - g_date_time_to_unix (dt2->datetime);
+  diff = (floor_div (dt1->local_usecs, G_USEC_PER_SEC) - dt1->utc_offset) -
+      (floor_div (dt2->local_usecs, G_USEC_PER_SEC) - dt2->utc_offset);
   if (diff < 0)
     return GST_VALUE_LESS_THAN;
   else if (diff > 0)
@@ -603,10 +728,8 @@ gst_date_time_new (gfloat tzoffset, gint year, gint month, gint day, gint hour,
     gint minute, gdouble seconds)
 {
   GstDateTimeFields fields;
-  gchar buf[6];
-  GTimeZone *tz;
-  GDateTime *dt;
-  GstDateTime *datetime;
+  gint64 local_usecs;
+  gint32 utc_offset;
   gint tzhour, tzminute;
 
   g_return_val_if_fail (year > 0 && year <= 9999, NULL);
@@ -621,22 +744,22 @@ gst_date_time_new (gfloat tzoffset, gint year, gint month, gint day, gint hour,
 
   tzhour = (gint) ABS (tzoffset);
   tzminute = (gint) ((ABS (tzoffset) - tzhour) * 60);
-
-  g_snprintf (buf, 6, "%c%02d%02d", tzoffset >= 0 ? '+' : '-', tzhour,
-      tzminute);
-
-  tz = g_time_zone_new (buf);
+  utc_offset = tzhour * 3600 + tzminute * 60;
+  if (tzoffset < 0)
+    utc_offset = -utc_offset;
 
   fields = gst_date_time_check_fields (&year, &month, &day,
       &hour, &minute, &seconds);
 
-  dt = g_date_time_new (tz, year, month, day, hour, minute, seconds);
-  g_time_zone_unref (tz);
+  /* GDateTime refused dates like February 30 */
+  if (day > g_date_get_days_in_month ((GDateMonth) month, (GDateYear) year))
+    return NULL;
 
-  datetime = gst_date_time_new_from_g_date_time (dt);
-  datetime->fields = fields;
+  local_usecs = days_from_civil (year, month, day) * USEC_PER_DAY +
+      hour * USEC_PER_HOUR + minute * USEC_PER_MINUTE +
+      (gint64) floor (seconds * G_USEC_PER_SEC + 0.5);
 
-  return datetime;
+  return gst_date_time_new_internal (local_usecs, utc_offset, fields);
 }
 
 gchar *
@@ -872,7 +995,6 @@ ymd:
 static void
 gst_date_time_free (GstDateTime * datetime)
 {
-  g_date_time_unref (datetime->datetime);
   g_slice_free (GstDateTime, datetime);
 }
 
@@ -51,6 +51,7 @@
 #include "gstpad.h"
 #include "gstutils.h"
 #include "gstvalue.h"
+#include "gsttracerutils.h"
 
 /*** PIPELINE GRAPHS **********************************************************/
 
@@ -65,6 +66,19 @@ const gchar spaces[] = {
 
 extern GstClockTime _priv_gst_info_start_time;
 
+/* the caps descriptions of a link, kept on the pad for the next dump */
+typedef struct
+{
+  GstCaps *caps;
+  GstCaps *peer_caps;
+  GstDebugGraphDetails details;
+  gchar *media;
+  gchar *media_src;
+  gchar *media_sink;
+} DebugDumpCapsCache;
+
+static GQuark debug_dump_caps_quark = 0;
+
 static gchar *
 debug_dump_make_object_name (GstObject * obj)
 {
@@ -79,7 +93,7 @@ debug_dump_get_element_state (GstElement * element)
   const gchar *state_icons = "~0-=>";
   GstState state = GST_STATE_VOID_PENDING, pending = GST_STATE_VOID_PENDING;
 
-  gst_element_get_state (element, &state, &pending, 0);
+  gst_element_peek_state (element, &state, &pending, NULL);
   if (pending == GST_STATE_VOID_PENDING) {
     gboolean is_locked = gst_element_is_locked_state (element);
     state_name = g_strdup_printf ("\\n[%c]%s", state_icons[state],
@@ -137,14 +151,49 @@ debug_dump_get_element_params (GstElement * element)
   return param_name;
 }
 
+/* the values the active tracers collected for @object, one line each */
+static gchar *
+debug_dump_get_object_stats (GstObject * object)
+{
+  GString *stats, *label;
+  gsize i;
+
+  stats = g_string_new (NULL);
+  _priv_gst_tracer_describe (object, stats);
+  if (stats->len > 0 && stats->str[stats->len - 1] == '\n')
+    g_string_truncate (stats, stats->len - 1);
+  if (stats->len == 0) {
+    g_string_free (stats, TRUE);
+    return NULL;
+  }
+
+  label = g_string_sized_new (stats->len + 8);
+  g_string_append (label, "\\n");
+  for (i = 0; i < stats->len; i++) {
+    gchar c = stats->str[i];
+
+    if (c == '\n') {
+      g_string_append (label, "\\n");
+    } else {
+      if (c == '"' || c == '\\')
+        g_string_append_c (label, '\\');
+      g_string_append_c (label, c);
+    }
+  }
+  g_string_free (stats, TRUE);
+
+  return g_string_free (label, FALSE);
+}
+
 static void
 debug_dump_pad (GstPad * pad, const gchar * color_name,
-    const gchar * element_name, GstDebugGraphDetails details, FILE * out,
+    const gchar * element_name, GstDebugGraphDetails details, GString * str,
     const gint indent)
 {
   GstPadTemplate *pad_templ;
   GstPadPresence presence;
   gchar *pad_name;
+  gchar *stats_name = NULL;
   const gchar *style_name;
   const gchar *spc = &spaces[MAX (sizeof (spaces) - (1 + indent * 2), 0)];
 
@@ -160,6 +209,9 @@ debug_dump_pad (GstPad * pad, const gchar * color_name,
       style_name = "filled,dashed";
     }
   }
+  if (details & GST_DEBUG_GRAPH_SHOW_STATS) {
+    stats_name = debug_dump_get_object_stats (GST_OBJECT (pad));
+  }
   if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
     gchar pad_flags[4];
     const gchar *activation_mode = "-><";
@@ -173,23 +225,25 @@ debug_dump_pad (GstPad * pad, const gchar * color_name,
         GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_FLAG_BLOCKING) ? 'B' : 'b';
     pad_flags[3] = '\0';
 
-    fprintf (out,
-        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s\\n[%c][%s]\", height=\"0.2\", style=\"%s\"];\n",
+    g_string_append_printf (str,
+        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s\\n[%c][%s]%s\", height=\"0.2\", style=\"%s\"];\n",
         spc, element_name, pad_name, color_name, GST_OBJECT_NAME (pad),
-        activation_mode[pad->mode], pad_flags, style_name);
+        activation_mode[pad->mode], pad_flags,
+        (stats_name ? stats_name : ""), style_name);
   } else {
-    fprintf (out,
-        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s\", height=\"0.2\", style=\"%s\"];\n",
+    g_string_append_printf (str,
+        "%s  %s_%s [color=black, fillcolor=\"%s\", label=\"%s%s\", height=\"0.2\", style=\"%s\"];\n",
         spc, element_name, pad_name, color_name, GST_OBJECT_NAME (pad),
-        style_name);
+        (stats_name ? stats_name : ""), style_name);
   }
 
+  g_free (stats_name);
   g_free (pad_name);
 }
 
 static void
 debug_dump_element_pad (GstPad * pad, GstElement * element,
-    GstDebugGraphDetails details, FILE * out, const gint indent)
+    GstDebugGraphDetails details, GString * str, const gint indent)
 {
   GstElement *target_element;
   GstPad *target_pad, *tmp_pad;
@@ -217,15 +271,17 @@ debug_dump_element_pad (GstPad * pad, GstElement * element,
           target_element_name = g_strdup ("");
         }
         debug_dump_pad (target_pad, color_name, target_element_name, details,
-            out, indent);
+            str, indent);
         /* src ghostpad relationship */
         pad_name = debug_dump_make_object_name (GST_OBJECT (pad));
         target_pad_name = debug_dump_make_object_name (GST_OBJECT (target_pad));
         if (dir == GST_PAD_SRC) {
-          fprintf (out, "%s%s_%s -> %s_%s [style=dashed, minlen=0]\n", spc,
+          g_string_append_printf (str,
+              "%s%s_%s -> %s_%s [style=dashed, minlen=0]\n", spc,
               target_element_name, target_pad_name, element_name, pad_name);
         } else {
-          fprintf (out, "%s%s_%s -> %s_%s [style=dashed, minlen=0]\n", spc,
+          g_string_append_printf (str,
+              "%s%s_%s -> %s_%s [style=dashed, minlen=0]\n", spc,
               element_name, pad_name, target_element_name, target_pad_name);
         }
         g_free (target_pad_name);
@@ -243,7 +299,7 @@ debug_dump_element_pad (GstPad * pad, GstElement * element,
             GST_PAD_SINK) ? "#aaaaff" : "#cccccc");
   }
   /* pads */
-  debug_dump_pad (pad, color_name, element_name, details, out, indent);
+  debug_dump_pad (pad, color_name, element_name, details, str, indent);
   g_free (element_name);
 }
 
@@ -332,13 +388,84 @@ debug_dump_describe_caps (GstCaps * caps, GstDebugGraphDetails details)
   return media;
 }
 
+static void
+debug_dump_caps_cache_free (DebugDumpCapsCache * cache)
+{
+  gst_caps_unref (cache->caps);
+  if (cache->peer_caps)
+    gst_caps_unref (cache->peer_caps);
+  g_free (cache->media);
+  g_free (cache->media_src);
+  g_free (cache->media_sink);
+  g_slice_free (DebugDumpCapsCache, cache);
+}
+
+/*
+ * debug_dump_get_link_caps:
+ * @pad: the pad of the link
+ * @caps: (transfer full): the caps of @pad
+ * @peer_caps: (transfer full): the caps of the peer of @pad
+ *
+ * Describing the caps is the most expensive part of a dump. The descriptions
+ * of the previous dump are kept on @pad and are reused as long as the caps
+ * didn't change so that dumping a running pipeline periodically only formats
+ * the links that changed. The cache is taken from @pad so that concurrent
+ * dumps don't share it, the caller has to put it back.
+ */
+static DebugDumpCapsCache *
+debug_dump_get_link_caps (GstPad * pad, GstCaps * caps, GstCaps * peer_caps,
+    GstDebugGraphDetails details)
+{
+  DebugDumpCapsCache *cache;
+
+  details &= GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE |
+      GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS;
+
+  cache = g_object_steal_qdata (G_OBJECT (pad), debug_dump_caps_quark);
+  if (cache && cache->caps == caps && cache->peer_caps == peer_caps &&
+      cache->details == details) {
+    /* the cache holds a ref to the same caps */
+    gst_caps_unref (caps);
+    if (peer_caps)
+      gst_caps_unref (peer_caps);
+    return cache;
+  }
+
+  if (cache)
+    debug_dump_caps_cache_free (cache);
+
+  cache = g_slice_new0 (DebugDumpCapsCache);
+  cache->caps = caps;
+  cache->peer_caps = peer_caps;
+  cache->details = details;
+
+  cache->media = debug_dump_describe_caps (caps, details);
+  /* check if peer caps are different */
+  if (peer_caps && !gst_caps_is_equal (caps, peer_caps)) {
+    gchar *tmp;
+
+    tmp = debug_dump_describe_caps (peer_caps, details);
+    if (gst_pad_get_direction (pad) == GST_PAD_SRC) {
+      cache->media_src = cache->media;
+      cache->media_sink = tmp;
+    } else {
+      cache->media_src = tmp;
+      cache->media_sink = cache->media;
+    }
+    cache->media = NULL;
+  }
+
+  return cache;
+}
+
 static void
 debug_dump_element_pad_link (GstPad * pad, GstElement * element,
-    GstDebugGraphDetails details, FILE * out, const gint indent)
+    GstDebugGraphDetails details, GString * str, const gint indent)
 {
   GstElement *peer_element;
   GstPad *peer_pad;
   GstCaps *caps, *peer_caps;
+  DebugDumpCapsCache *cache;
   gchar *media = NULL;
   gchar *media_src = NULL, *media_sink = NULL;
   gchar *pad_name, *element_name;
@@ -356,23 +483,13 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
       if (!peer_caps)
         peer_caps = gst_pad_get_pad_template_caps (peer_pad);
 
-      media = debug_dump_describe_caps (caps, details);
-      /* check if peer caps are different */
-      if (peer_caps && !gst_caps_is_equal (caps, peer_caps)) {
-        gchar *tmp;
-
-        tmp = debug_dump_describe_caps (peer_caps, details);
-        if (gst_pad_get_direction (pad) == GST_PAD_SRC) {
-          media_src = media;
-          media_sink = tmp;
-        } else {
-          media_src = tmp;
-          media_sink = media;
-        }
-        media = NULL;
-      }
-      gst_caps_unref (peer_caps);
-      gst_caps_unref (caps);
+      cache = debug_dump_get_link_caps (pad, caps, peer_caps, details);
+      media = g_strdup (cache->media);
+      media_src = g_strdup (cache->media_src);
+      media_sink = g_strdup (cache->media_sink);
+      /* put it back for the next dump */
+      g_object_set_qdata_full (G_OBJECT (pad), debug_dump_caps_quark, cache,
+          (GDestroyNotify) debug_dump_caps_cache_free);
     }
 
     pad_name = debug_dump_make_object_name (GST_OBJECT (pad));
@@ -391,13 +508,14 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
 
     /* pad link */
     if (media) {
-      fprintf (out, "%s%s_%s -> %s_%s [label=\"%s\"]\n", spc,
+      g_string_append_printf (str, "%s%s_%s -> %s_%s [label=\"%s\"]\n", spc,
           element_name, pad_name, peer_element_name, peer_pad_name, media);
       g_free (media);
     } else if (media_src && media_sink) {
       /* dot has some issues with placement of head and taillabels,
        * we need an empty label to make space */
-      fprintf (out, "%s%s_%s -> %s_%s [labeldistance=\"10\", labelangle=\"0\", "
+      g_string_append_printf (str,
+          "%s%s_%s -> %s_%s [labeldistance=\"10\", labelangle=\"0\", "
           "label=\"                                                  \", "
           "headlabel=\"%s\", taillabel=\"%s\"]\n",
           spc, element_name, pad_name, peer_element_name, peer_pad_name,
@@ -405,7 +523,7 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
       g_free (media_src);
       g_free (media_sink);
     } else {
-      fprintf (out, "%s%s_%s -> %s_%s\n", spc,
+      g_string_append_printf (str, "%s%s_%s -> %s_%s\n", spc,
           element_name, pad_name, peer_element_name, peer_pad_name);
     }
 
@@ -421,7 +539,7 @@ debug_dump_element_pad_link (GstPad * pad, GstElement * element,
 
 static void
 debug_dump_element_pads (GstIterator * pad_iter, GstPad * pad,
-    GstElement * element, GstDebugGraphDetails details, FILE * out,
+    GstElement * element, GstDebugGraphDetails details, GString * str,
     const gint indent, guint * src_pads, guint * sink_pads)
 {
   GValue item = { 0, };
@@ -433,7 +551,7 @@ debug_dump_element_pads (GstIterator * pad_iter, GstPad * pad,
     switch (gst_iterator_next (pad_iter, &item)) {
       case GST_ITERATOR_OK:
         pad = g_value_get_object (&item);
-        debug_dump_element_pad (pad, element, details, out, indent);
+        debug_dump_element_pad (pad, element, details, str, indent);
         dir = gst_pad_get_direction (pad);
         if (dir == GST_PAD_SRC)
           (*src_pads)++;
@@ -455,13 +573,13 @@ debug_dump_element_pads (GstIterator * pad_iter, GstPad * pad,
 /*
  * debug_dump_element:
  * @bin: the bin that should be analyzed
- * @out: file to write to
+ * @str: string to append to
  * @indent: level of graph indentation
  *
- * Helper for gst_debug_bin_to_dot_file() to recursively dump a pipeline.
+ * Helper for gst_debug_bin_to_dot_data() to recursively dump a pipeline.
  */
 static void
-debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
+debug_dump_element (GstBin * bin, GstDebugGraphDetails details, GString * str,
     const gint indent)
 {
   GstIterator *element_iter, *pad_iter;
@@ -474,6 +592,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
   gchar *element_name;
   gchar *state_name = NULL;
   gchar *param_name = NULL;
+  gchar *stats_name = NULL;
   const gchar *spc = &spaces[MAX (sizeof (spaces) - (1 + indent * 2), 0)];
 
   element_iter = gst_bin_iterate_elements (bin);
@@ -490,15 +609,21 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
         if (details & GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS) {
           param_name = debug_dump_get_element_params (GST_ELEMENT (element));
         }
+        if (details & GST_DEBUG_GRAPH_SHOW_STATS) {
+          stats_name = debug_dump_get_object_stats (GST_OBJECT (element));
+        }
         /* elements */
-        fprintf (out, "%ssubgraph cluster_%s {\n", spc, element_name);
-        fprintf (out, "%s  fontname=\"Bitstream Vera Sans\";\n", spc);
-        fprintf (out, "%s  fontsize=\"8\";\n", spc);
-        fprintf (out, "%s  style=filled;\n", spc);
-        fprintf (out, "%s  color=black;\n\n", spc);
-        fprintf (out, "%s  label=\"%s\\n%s%s%s\";\n", spc,
+        g_string_append_printf (str, "%ssubgraph cluster_%s {\n", spc,
+            element_name);
+        g_string_append_printf (str, "%s  fontname=\"Bitstream Vera Sans\";\n",
+            spc);
+        g_string_append_printf (str, "%s  fontsize=\"8\";\n", spc);
+        g_string_append_printf (str, "%s  style=filled;\n", spc);
+        g_string_append_printf (str, "%s  color=black;\n\n", spc);
+        g_string_append_printf (str, "%s  label=\"%s\\n%s%s%s%s\";\n", spc,
             G_OBJECT_TYPE_NAME (element), GST_OBJECT_NAME (element),
-            (state_name ? state_name : ""), (param_name ? param_name : "")
+            (state_name ? state_name : ""), (param_name ? param_name : ""),
+            (stats_name ? stats_name : "")
             );
         if (state_name) {
           g_free (state_name);
@@ -508,34 +633,38 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
           g_free (param_name);
           param_name = NULL;
         }
+        if (stats_name) {
+          g_free (stats_name);
+          stats_name = NULL;
+        }
         g_free (element_name);
 
         src_pads = sink_pads = 0;
         if ((pad_iter = gst_element_iterate_sink_pads (element))) {
-          debug_dump_element_pads (pad_iter, pad, element, details, out, indent,
+          debug_dump_element_pads (pad_iter, pad, element, details, str, indent,
               &src_pads, &sink_pads);
           gst_iterator_free (pad_iter);
         }
         if ((pad_iter = gst_element_iterate_src_pads (element))) {
-          debug_dump_element_pads (pad_iter, pad, element, details, out, indent,
+          debug_dump_element_pads (pad_iter, pad, element, details, str, indent,
               &src_pads, &sink_pads);
           gst_iterator_free (pad_iter);
         }
         if (GST_IS_BIN (element)) {
-          fprintf (out, "%s  fillcolor=\"#ffffff\";\n", spc);
+          g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
           /* recurse */
-          debug_dump_element (GST_BIN (element), details, out, indent + 1);
+          debug_dump_element (GST_BIN (element), details, str, indent + 1);
         } else {
           if (src_pads && !sink_pads)
-            fprintf (out, "%s  fillcolor=\"#ffaaaa\";\n", spc);
+            g_string_append_printf (str, "%s  fillcolor=\"#ffaaaa\";\n", spc);
           else if (!src_pads && sink_pads)
-            fprintf (out, "%s  fillcolor=\"#aaaaff\";\n", spc);
+            g_string_append_printf (str, "%s  fillcolor=\"#aaaaff\";\n", spc);
           else if (src_pads && sink_pads)
-            fprintf (out, "%s  fillcolor=\"#aaffaa\";\n", spc);
+            g_string_append_printf (str, "%s  fillcolor=\"#aaffaa\";\n", spc);
           else
-            fprintf (out, "%s  fillcolor=\"#ffffff\";\n", spc);
+            g_string_append_printf (str, "%s  fillcolor=\"#ffffff\";\n", spc);
         }
-        fprintf (out, "%s}\n\n", spc);
+        g_string_append_printf (str, "%s}\n\n", spc);
         if ((pad_iter = gst_element_iterate_pads (element))) {
           pads_done = FALSE;
           while (!pads_done) {
@@ -544,7 +673,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
                 pad = g_value_get_object (&item2);
                 if (gst_pad_is_linked (pad)) {
                   if (gst_pad_get_direction (pad) == GST_PAD_SRC) {
-                    debug_dump_element_pad_link (pad, element, details, out,
+                    debug_dump_element_pad_link (pad, element, details, str,
                         indent);
                   } else {
                     GstPad *peer_pad = gst_pad_get_peer (pad);
@@ -553,7 +682,7 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
                       if (!GST_IS_GHOST_PAD (peer_pad)
                           && GST_IS_PROXY_PAD (peer_pad)) {
                         debug_dump_element_pad_link (peer_pad, NULL, details,
-                            out, indent);
+                            str, indent);
                       }
                       gst_object_unref (peer_pad);
                     }
@@ -589,6 +718,81 @@ debug_dump_element (GstBin * bin, GstDebugGraphDetails details, FILE * out,
   gst_iterator_free (element_iter);
 }
 
+/**
+ * gst_debug_bin_to_dot_data:
+ * @bin: the top-level pipeline that should be analyzed
+ * @details: details to show in the graph, e.g. #GST_DEBUG_GRAPH_SHOW_ALL or
+ *    one or more other #GstDebugGraphDetails flags.
+ *
+ * This works like gst_debug_bin_to_dot_file(), but returns the graph in a
+ * string instead of writing it to a file, independent of the
+ * GST_DEBUG_DUMP_DOT_DIR environment variable. This is useful to send the
+ * graph of a running pipeline somewhere else.
+ *
+ * The descriptions of the caps of the links are kept on the pads and are
+ * only formatted again when the caps changed, so calling this periodically
+ * on a running pipeline is cheap. With #GST_DEBUG_GRAPH_SHOW_STATS the
+ * values that the active tracers collected are added to the elements and
+ * pads.
+ *
+ * Returns: (transfer full): a string containing the pipeline in graphviz
+ * dot format, free with g_free().
+ *
+ * Since: 1.2
+ */
+gchar *
+gst_debug_bin_to_dot_data (GstBin * bin, GstDebugGraphDetails details)
+{
+  GString *str;
+  gchar *state_name = NULL;
+  gchar *param_name = NULL;
+  gchar *stats_name = NULL;
+
+  g_return_val_if_fail (GST_IS_BIN (bin), NULL);
+
+  if (G_UNLIKELY (debug_dump_caps_quark == 0))
+    debug_dump_caps_quark = g_quark_from_static_string ("GstDebugDumpCaps");
+
+  str = g_string_sized_new (8192);
+
+  if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
+    state_name = debug_dump_get_element_state (GST_ELEMENT (bin));
+  }
+  if (details & GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS) {
+    param_name = debug_dump_get_element_params (GST_ELEMENT (bin));
+  }
+  if (details & GST_DEBUG_GRAPH_SHOW_STATS) {
+    stats_name = debug_dump_get_object_stats (GST_OBJECT (bin));
+  }
+
+  /* write header */
+  g_string_append_printf (str,
+      "digraph pipeline {\n"
+      "  rankdir=LR;\n"
+      "  fontname=\"sans\";\n"
+      "  fontsize=\"10\";\n"
+      "  labelloc=t;\n"
+      "  nodesep=.1;\n"
+      "  ranksep=.2;\n"
+      "  label=\"<%s>\\n%s%s%s%s\";\n"
+      "  node [style=filled, shape=box, fontsize=\"9\", fontname=\"sans\", margin=\"0.0,0.0\"];\n"
+      "  edge [labelfontsize=\"6\", fontsize=\"9\", fontname=\"monospace\"];\n"
+      "\n", G_OBJECT_TYPE_NAME (bin), GST_OBJECT_NAME (bin),
+      (state_name ? state_name : ""), (param_name ? param_name : ""),
+      (stats_name ? stats_name : "")
+      );
+  g_free (state_name);
+  g_free (param_name);
+  g_free (stats_name);
+
+  debug_dump_element (bin, details, str, 1);
+
+  /* write footer */
+  g_string_append (str, "}\n");
+
+  return g_string_free (str, FALSE);
+}
+
 /*
  * gst_debug_bin_to_dot_file:
  * @bin: the top-level pipeline that should be analyzed
@@ -623,40 +827,12 @@ gst_debug_bin_to_dot_file (GstBin * bin, GstDebugGraphDetails details,
       priv_gst_dump_dot_dir, file_name);
 
   if ((out = fopen (full_file_name, "wb"))) {
-    gchar *state_name = NULL;
-    gchar *param_name = NULL;
+    gchar *buf;
 
-    if (details & GST_DEBUG_GRAPH_SHOW_STATES) {
-      state_name = debug_dump_get_element_state (GST_ELEMENT (bin));
-    }
-    if (details & GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS) {
-      param_name = debug_dump_get_element_params (GST_ELEMENT (bin));
-    }
+    buf = gst_debug_bin_to_dot_data (bin, details);
+    fputs (buf, out);
+    g_free (buf);
 
-    /* write header */
-    fprintf (out,
-        "digraph pipeline {\n"
-        "  rankdir=LR;\n"
-        "  fontname=\"sans\";\n"
-        "  fontsize=\"10\";\n"
-        "  labelloc=t;\n"
-        "  nodesep=.1;\n"
-        "  ranksep=.2;\n"
-        "  label=\"<%s>\\n%s%s%s\";\n"
-        "  node [style=filled, shape=box, fontsize=\"9\", fontname=\"sans\", margin=\"0.0,0.0\"];\n"
-        "  edge [labelfontsize=\"6\", fontsize=\"9\", fontname=\"monospace\"];\n"
-        "\n", G_OBJECT_TYPE_NAME (bin), GST_OBJECT_NAME (bin),
-        (state_name ? state_name : ""), (param_name ? param_name : "")
-        );
-    if (state_name)
-      g_free (state_name);
-    if (param_name)
-      g_free (param_name);
-
-    debug_dump_element (bin, details, out, 1);
-
-    /* write footer */
-    fprintf (out, "}\n");
     fclose (out);
     GST_INFO ("wrote bin graph to : '%s'", full_file_name);
   } else {
@@ -704,6 +880,12 @@ gst_debug_bin_to_dot_file_with_ts (GstBin * bin,
 }
 #else /* !GST_DISABLE_GST_DEBUG */
 #ifndef GST_REMOVE_DISABLED
+gchar *
+gst_debug_bin_to_dot_data (GstBin * bin, GstDebugGraphDetails details)
+{
+  return g_strdup ("");
+}
+
 void
 gst_debug_bin_to_dot_file (GstBin * bin, GstDebugGraphDetails details,
     const gchar * file_name)
@@ -35,22 +35,26 @@ G_BEGIN_DECLS
  * @GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS: show caps-details on edges
  * @GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS: show modified parameters on elements
  * @GST_DEBUG_GRAPH_SHOW_STATES: show element states
+ * @GST_DEBUG_GRAPH_SHOW_STATS: show the values collected by the active
+ *     tracers on elements and pads (Since: 1.2)
  * @GST_DEBUG_GRAPH_SHOW_ALL: show all details
  *
- * Available details for pipeline graphs produced by GST_DEBUG_BIN_TO_DOT_FILE()
- * and GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS().
+ * Available details for pipeline graphs produced by GST_DEBUG_BIN_TO_DOT_FILE(),
+ * GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS() and gst_debug_bin_to_dot_data().
  */
 typedef enum {
   GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE         = (1<<0),
   GST_DEBUG_GRAPH_SHOW_CAPS_DETAILS       = (1<<1),
   GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS = (1<<2),
   GST_DEBUG_GRAPH_SHOW_STATES             = (1<<3),
-  GST_DEBUG_GRAPH_SHOW_ALL                = ((1<<4)-1)
+  GST_DEBUG_GRAPH_SHOW_STATS              = (1<<4),
+  GST_DEBUG_GRAPH_SHOW_ALL                = ((1<<5)-1)
 } GstDebugGraphDetails;
 
 
 /********** pipeline graphs **********/
 
+gchar * gst_debug_bin_to_dot_data (GstBin *bin, GstDebugGraphDetails details);
 void gst_debug_bin_to_dot_file (GstBin *bin, GstDebugGraphDetails details, const gchar *file_name);
 void gst_debug_bin_to_dot_file_with_ts (GstBin *bin, GstDebugGraphDetails details, const gchar *file_name);
 
@@ -1178,6 +1178,132 @@ gst_element_iterate_sink_pads (GstElement * element)
   return gst_element_iterate_pad_list (element, &element->sinkpads);
 }
 
+/* the pads are collected in an array on the stack when there are not more
+ * than this, which covers nearly all elements */
+#define FOREACH_PAD_PREALLOC 16
+
+static gboolean
+gst_element_pad_list_foreach (GstElement * element, GList ** padlist,
+    guint16 * numpads, GstElementForeachPadFunc func, gpointer user_data)
+{
+  GstPad *stack_pads[FOREACH_PAD_PREALLOC];
+  GstPad **pads = stack_pads;
+  gboolean ret = TRUE;
+  guint i, n_pads = 0;
+  GList *walk;
+
+  /* take a snapshot of the pads so that @func can be called without the lock
+   * and can add or remove pads */
+  GST_OBJECT_LOCK (element);
+  if (G_UNLIKELY (*numpads > FOREACH_PAD_PREALLOC))
+    pads = g_new (GstPad *, *numpads);
+  for (walk = *padlist; walk; walk = walk->next)
+    pads[n_pads++] = gst_object_ref (walk->data);
+  GST_OBJECT_UNLOCK (element);
+
+  if (n_pads == 0)
+    ret = FALSE;
+
+  for (i = 0; i < n_pads; i++) {
+    if (ret)
+      ret = func (element, pads[i], user_data);
+    gst_object_unref (pads[i]);
+  }
+
+  if (G_UNLIKELY (pads != stack_pads))
+    g_free (pads);
+
+  return ret;
+}
+
+/**
+ * gst_element_foreach_pad:
+ * @element: a #GstElement to iterate pads of
+ * @func: (scope call): function to call for each pad
+ * @user_data: (closure): user data passed to @func
+ *
+ * Call @func with @user_data for each of @element's pads. @func will be
+ * called exactly once for each pad that exists at the time of this call,
+ * unless one of the calls to @func returns %FALSE in which case the other
+ * pads are skipped. Pads that are added while this function is running are
+ * not iterated.
+ *
+ * Unlike gst_element_iterate_pads() this does not allocate an iterator and
+ * does not need to handle resyncs, @func is called without the object lock
+ * of @element.
+ *
+ * Returns: %FALSE if @element had no pads or if one of the calls to @func
+ *     returned %FALSE.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_element_foreach_pad (GstElement * element, GstElementForeachPadFunc func,
+    gpointer user_data)
+{
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  return gst_element_pad_list_foreach (element, &element->pads,
+      &element->numpads, func, user_data);
+}
+
+/**
+ * gst_element_foreach_src_pad:
+ * @element: a #GstElement to iterate source pads of
+ * @func: (scope call): function to call for each pad
+ * @user_data: (closure): user data passed to @func
+ *
+ * Call @func with @user_data for each of @element's source pads, see
+ * gst_element_foreach_pad().
+ *
+ * Returns: %FALSE if @element had no source pads or if one of the calls to
+ *     @func returned %FALSE.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_element_foreach_src_pad (GstElement * element,
+    GstElementForeachPadFunc func, gpointer user_data)
+{
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  return gst_element_pad_list_foreach (element, &element->srcpads,
+      &element->numsrcpads, func, user_data);
+}
+
+/**
+ * gst_element_foreach_sink_pad:
+ * @element: a #GstElement to iterate sink pads of
+ * @func: (scope call): function to call for each pad
+ * @user_data: (closure): user data passed to @func
+ *
+ * Call @func with @user_data for each of @element's sink pads, see
+ * gst_element_foreach_pad().
+ *
+ * Returns: %FALSE if @element had no sink pads or if one of the calls to
+ *     @func returned %FALSE.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_element_foreach_sink_pad (GstElement * element,
+    GstElementForeachPadFunc func, gpointer user_data)
+{
+  g_return_val_if_fail (GST_IS_ELEMENT (element), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  return gst_element_pad_list_foreach (element, &element->sinkpads,
+      &element->numsinkpads, func, user_data);
+}
+
 /**
  * gst_element_class_add_pad_template:
  * @klass: the #GstElementClass to add the pad template to.
@@ -1614,6 +1740,14 @@ gst_element_default_query (GstElement * element, GstQuery * query)
     result = gst_pad_query (pad, query);
 
     gst_object_unref (pad);
+  } else if (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE) {
+    /* only about this element, ask its own sink pad and not the peer */
+    pad = gst_element_get_random_pad (element, FALSE, GST_PAD_SINK);
+    if (pad) {
+      result = gst_pad_query (pad, query);
+
+      gst_object_unref (pad);
+    }
   } else {
     pad = gst_element_get_random_pad (element, TRUE, GST_PAD_SINK);
     if (pad) {
@@ -2010,6 +2144,12 @@ gst_element_get_state_func (GstElement * element,
   GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "getting state, timeout %"
       GST_TIME_FORMAT, GST_TIME_ARGS (timeout));
 
+  /* without a timeout we never wait, so there is no need for the lock. This
+   * gives the same result as waiting for 0 time under the lock, except when
+   * the state changes while we read it */
+  if (timeout == 0)
+    return gst_element_peek_state (element, state, pending, NULL);
+
   GST_OBJECT_LOCK (element);
   ret = GST_STATE_RETURN (element);
   GST_CAT_DEBUG_OBJECT (GST_CAT_STATES, element, "RETURN is %s",
@@ -2158,6 +2298,85 @@ gst_element_get_state (GstElement * element,
   return result;
 }
 
+/**
+ * gst_element_peek_state:
+ * @element: a #GstElement to get the state of.
+ * @state: (out) (allow-none): a pointer to #GstState to hold the state.
+ *     Can be %NULL.
+ * @pending: (out) (allow-none): a pointer to #GstState to hold the pending
+ *     state. Can be %NULL.
+ * @target: (out) (allow-none): a pointer to #GstState to hold the target
+ *     state. Can be %NULL.
+ *
+ * Gets the current, pending and target state of the element and the return
+ * value of the last state change without taking any lock and without waiting
+ * for an ASYNC state change to complete.
+ *
+ * This is meant for code that monitors the state of many elements and that
+ * should not contend with the streaming and state change threads. The values
+ * are read atomically one by one and are read again until they are
+ * consistent, but when the element is changing state the result might already
+ * be outdated when this function returns. Use gst_element_get_state() to wait
+ * for a state change to complete.
+ *
+ * Returns: the return value of the last state change of @element, see
+ *     gst_element_get_state().
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+GstStateChangeReturn
+gst_element_peek_state (GstElement * element, GstState * state,
+    GstState * pending, GstState * target)
+{
+  GstStateChangeReturn ret;
+  GstState cur, pend, targ;
+  gint tries = 0;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), GST_STATE_CHANGE_FAILURE);
+
+  /* the fields are written under the object lock in many places, read them
+   * until two passes agree. Give up after a few tries, a state change that
+   * is still going on is not something we can wait for here */
+  ret = g_atomic_int_get ((gint *) & GST_STATE_RETURN (element));
+  cur = g_atomic_int_get ((gint *) & GST_STATE (element));
+  pend = g_atomic_int_get ((gint *) & GST_STATE_PENDING (element));
+  targ = g_atomic_int_get ((gint *) & GST_STATE_TARGET (element));
+  while (tries++ < 3) {
+    GstStateChangeReturn ret2;
+    GstState cur2, pend2, targ2;
+
+    ret2 = g_atomic_int_get ((gint *) & GST_STATE_RETURN (element));
+    cur2 = g_atomic_int_get ((gint *) & GST_STATE (element));
+    pend2 = g_atomic_int_get ((gint *) & GST_STATE_PENDING (element));
+    targ2 = g_atomic_int_get ((gint *) & GST_STATE_TARGET (element));
+
+    if (ret == ret2 && cur == cur2 && pend == pend2 && targ == targ2)
+      break;
+
+    ret = ret2;
+    cur = cur2;
+    pend = pend2;
+    targ = targ2;
+  }
+
+  if (state)
+    *state = cur;
+  if (pending)
+    *pending = pend;
+  if (target)
+    *target = targ;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_STATES, element,
+      "peeked state current: %s, pending: %s, target: %s, result: %s",
+      gst_element_state_get_name (cur), gst_element_state_get_name (pend),
+      gst_element_state_get_name (targ),
+      gst_element_state_change_return_get_name (ret));
+
+  return ret;
+}
+
 /**
  * gst_element_abort_state:
  * @element: a #GstElement to abort the state of.
@@ -752,6 +752,33 @@ GstIterator *           gst_element_iterate_pads        (GstElement * element);
 GstIterator *           gst_element_iterate_src_pads    (GstElement * element);
 GstIterator *           gst_element_iterate_sink_pads   (GstElement * element);
 
+/**
+ * GstElementForeachPadFunc:
+ * @element: the #GstElement
+ * @pad: a #GstPad
+ * @user_data: user data passed to the foreach function
+ *
+ * Function called for each pad when using gst_element_foreach_pad(),
+ * gst_element_foreach_src_pad() or gst_element_foreach_sink_pad().
+ *
+ * Returns: %FALSE to stop iterating pads, %TRUE to continue
+ *
+ * Since: 1.2
+ */
+typedef gboolean (*GstElementForeachPadFunc) (GstElement * element,
+                                              GstPad * pad,
+                                              gpointer user_data);
+
+gboolean                gst_element_foreach_pad         (GstElement * element,
+                                                         GstElementForeachPadFunc func,
+                                                         gpointer user_data);
+gboolean                gst_element_foreach_src_pad     (GstElement * element,
+                                                         GstElementForeachPadFunc func,
+                                                         gpointer user_data);
+gboolean                gst_element_foreach_sink_pad    (GstElement * element,
+                                                         GstElementForeachPadFunc func,
+                                                         gpointer user_data);
+
 /* event/query/format stuff */
 gboolean                gst_element_send_event          (GstElement *element, GstEvent *event);
 gboolean                gst_element_seek                (GstElement *element, gdouble rate,
@@ -784,6 +811,10 @@ GstStateChangeReturn    gst_element_get_state           (GstElement * element,
                                                          GstState * state,
                                                          GstState * pending,
                                                          GstClockTime timeout);
+GstStateChangeReturn    gst_element_peek_state          (GstElement * element,
+                                                         GstState * state,
+                                                         GstState * pending,
+                                                         GstState * target);
 GstStateChangeReturn    gst_element_set_state           (GstElement *element, GstState state);
 
 void                    gst_element_abort_state         (GstElement * element);
@@ -256,7 +256,7 @@ gst_element_register (GstPlugin * plugin, const gchar * name, guint rank,
     GstStaticPadTemplate *newt;
     gchar *caps_string = gst_caps_to_string (templ->caps);
 
-    newt = g_slice_new (GstStaticPadTemplate);
+    newt = g_slice_new0 (GstStaticPadTemplate);
     newt->name_template = g_intern_string (templ->name_template);
     newt->direction = templ->direction;
     newt->presence = templ->presence;
@@ -761,6 +761,241 @@ element_filter (GstPluginFeature * feature, FilterData * data)
   return res;
 }
 
+/* the sorted results of the recent gst_element_factory_list_get_elements()
+ * calls, autopluggers do the same few queries over and over */
+typedef struct
+{
+  GstElementFactoryListType type;
+  GstRank minrank;
+  guint32 cookie;
+  gint rank_cookie;
+  GList *factories;
+} GstElementFactoryListCache;
+
+#define LIST_CACHE_SIZE 16
+
+static GMutex list_cache_lock;
+static GQueue list_cache = G_QUEUE_INIT;
+
+static void
+list_cache_free (GstElementFactoryListCache * entry)
+{
+  gst_plugin_feature_list_free (entry->factories);
+  g_slice_free (GstElementFactoryListCache, entry);
+}
+
+/* maps the media types of the pad templates to the factories of the
+ * registry so that gst_element_factory_list_filter() only has to intersect
+ * with the templates of factories that can match. Once built an index is
+ * not changed, a new one replaces it when the registry changes. */
+typedef struct
+{
+  gint refcount;
+  guint32 cookie;
+  /* factory (with a ref) -> directions with ANY template caps, plus one */
+  GHashTable *factories;
+  /* media type quark -> set of factories with such a template, for the
+   * src and the sink direction */
+  GHashTable *types[2];
+} GstElementFactoryCapsIndex;
+
+/* protected by list_cache_lock */
+static GstElementFactoryCapsIndex *caps_index = NULL;
+
+#define CAPS_INDEX_DIR(direction) ((direction) == GST_PAD_SRC ? 0 : 1)
+
+static void
+caps_index_unref (GstElementFactoryCapsIndex * index)
+{
+  if (!g_atomic_int_dec_and_test (&index->refcount))
+    return;
+
+  g_hash_table_destroy (index->types[0]);
+  g_hash_table_destroy (index->types[1]);
+  g_hash_table_destroy (index->factories);
+  g_slice_free (GstElementFactoryCapsIndex, index);
+}
+
+static GstElementFactoryCapsIndex *
+caps_index_new (GstRegistry * registry, guint32 cookie)
+{
+  GstElementFactoryCapsIndex *index;
+  GList *factories, *walk;
+  const GList *templates;
+  guint i;
+
+  index = g_slice_new (GstElementFactoryCapsIndex);
+  index->refcount = 1;
+  index->cookie = cookie;
+  index->factories = g_hash_table_new_full (NULL, NULL, gst_object_unref,
+      NULL);
+  for (i = 0; i < 2; i++)
+    index->types[i] = g_hash_table_new_full (NULL, NULL, NULL,
+        (GDestroyNotify) g_hash_table_destroy);
+
+  factories = gst_registry_get_feature_list (registry,
+      GST_TYPE_ELEMENT_FACTORY);
+  for (walk = factories; walk; walk = walk->next) {
+    GstElementFactory *factory = walk->data;
+    guint any = 0;
+
+    templates = gst_element_factory_get_static_pad_templates (factory);
+    for (; templates; templates = templates->next) {
+      GstStaticPadTemplate *templ = templates->data;
+      GstCaps *tmpl_caps;
+      guint dir, n;
+
+      if (templ->direction != GST_PAD_SRC && templ->direction != GST_PAD_SINK)
+        continue;
+
+      dir = CAPS_INDEX_DIR (templ->direction);
+      tmpl_caps = gst_static_caps_get (&templ->static_caps);
+      if (gst_caps_is_any (tmpl_caps)) {
+        any |= 1 << dir;
+      } else {
+        n = gst_caps_get_size (tmpl_caps);
+        for (i = 0; i < n; i++) {
+          GQuark type;
+          GHashTable *set;
+
+          type = gst_structure_get_name_id (gst_caps_get_structure (tmpl_caps,
+                  i));
+          set = g_hash_table_lookup (index->types[dir],
+              GUINT_TO_POINTER (type));
+          if (set == NULL) {
+            set = g_hash_table_new (NULL, NULL);
+            g_hash_table_insert (index->types[dir], GUINT_TO_POINTER (type),
+                set);
+          }
+          g_hash_table_add (set, factory);
+        }
+      }
+      gst_caps_unref (tmpl_caps);
+    }
+    /* takes the ref of the list */
+    g_hash_table_insert (index->factories, factory, GUINT_TO_POINTER (any + 1));
+  }
+  g_list_free (factories);
+
+  GST_DEBUG ("indexed pad templates of %u factories",
+      g_hash_table_size (index->factories));
+
+  return index;
+}
+
+/* returns a ref to an index that is up to date with the registry */
+static GstElementFactoryCapsIndex *
+caps_index_get (void)
+{
+  GstRegistry *registry = gst_registry_get ();
+  GstElementFactoryCapsIndex *index, *old = NULL;
+  guint32 cookie;
+
+  cookie = gst_registry_get_feature_list_cookie (registry);
+
+  g_mutex_lock (&list_cache_lock);
+  index = caps_index;
+  if (index && index->cookie == cookie) {
+    g_atomic_int_inc (&index->refcount);
+    g_mutex_unlock (&list_cache_lock);
+    return index;
+  }
+  g_mutex_unlock (&list_cache_lock);
+
+  /* build without the lock, it parses the caps of all templates */
+  index = caps_index_new (registry, cookie);
+
+  g_mutex_lock (&list_cache_lock);
+  if (caps_index == NULL || caps_index->cookie != cookie) {
+    old = caps_index;
+    caps_index = index;
+    g_atomic_int_inc (&index->refcount);
+  }
+  g_mutex_unlock (&list_cache_lock);
+
+  if (old)
+    caps_index_unref (old);
+
+  return index;
+}
+
+/* FALSE when no template of the factory in @direction can match @caps. The
+ * structures of caps can only intersect, or be a subset, when their media
+ * types are the same. */
+static gboolean
+caps_index_may_match (GstElementFactoryCapsIndex * index,
+    GstElementFactory * factory, const GstCaps * caps,
+    GstPadDirection direction)
+{
+  gpointer any;
+  guint i, n, dir;
+
+  /* not from the registry the index was built from */
+  if (!g_hash_table_lookup_extended (index->factories, factory, NULL, &any))
+    return TRUE;
+
+  dir = CAPS_INDEX_DIR (direction);
+  if ((GPOINTER_TO_UINT (any) - 1) & (1 << dir))
+    return TRUE;
+
+  n = gst_caps_get_size (caps);
+  for (i = 0; i < n; i++) {
+    GHashTable *set;
+    GQuark type;
+
+    type = gst_structure_get_name_id (gst_caps_get_structure (caps, i));
+    set = g_hash_table_lookup (index->types[dir], GUINT_TO_POINTER (type));
+    if (set && g_hash_table_contains (set, factory))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+void
+_priv_gst_element_factory_list_cache_clear (void)
+{
+  GstElementFactoryListCache *entry;
+  GstElementFactoryCapsIndex *index;
+
+  g_mutex_lock (&list_cache_lock);
+  while ((entry = g_queue_pop_head (&list_cache)))
+    list_cache_free (entry);
+  index = caps_index;
+  caps_index = NULL;
+  g_mutex_unlock (&list_cache_lock);
+
+  if (index)
+    caps_index_unref (index);
+}
+
+/* called with list_cache_lock */
+static GstElementFactoryListCache *
+list_cache_find (GstElementFactoryListType type, GstRank minrank,
+    guint32 cookie, gint rank_cookie)
+{
+  GList *walk;
+
+  for (walk = list_cache.head; walk; walk = walk->next) {
+    GstElementFactoryListCache *entry = walk->data;
+
+    if (entry->type != type || entry->minrank != minrank)
+      continue;
+
+    if (entry->cookie != cookie || entry->rank_cookie != rank_cookie) {
+      g_queue_delete_link (&list_cache, walk);
+      list_cache_free (entry);
+      return NULL;
+    }
+    /* keep the used entries at the head */
+    if (walk != list_cache.head) {
+      g_queue_unlink (&list_cache, walk);
+      g_queue_push_head_link (&list_cache, walk);
+    }
+    return entry;
+  }
+  return NULL;
+}
+
 /**
  * gst_element_factory_list_get_elements:
  * @type: a #GstElementFactoryListType
@@ -778,8 +1013,24 @@ GList *
 gst_element_factory_list_get_elements (GstElementFactoryListType type,
     GstRank minrank)
 {
+  GstElementFactoryListCache *entry;
   GList *result;
   FilterData data;
+  guint32 cookie;
+  gint rank_cookie;
+
+  /* read before filtering, a change while we filter makes the entry stale */
+  cookie = gst_registry_get_feature_list_cookie (gst_registry_get ());
+  rank_cookie = g_atomic_int_get (&_priv_gst_plugin_feature_rank_cookie);
+
+  g_mutex_lock (&list_cache_lock);
+  entry = list_cache_find (type, minrank, cookie, rank_cookie);
+  if (entry) {
+    result = gst_plugin_feature_list_copy (entry->factories);
+    g_mutex_unlock (&list_cache_lock);
+    return result;
+  }
+  g_mutex_unlock (&list_cache_lock);
 
   /* prepare type */
   data.type = type;
@@ -792,6 +1043,24 @@ gst_element_factory_list_get_elements (GstElementFactoryListType type,
   /* sort on rank and name */
   result = g_list_sort (result, gst_plugin_feature_rank_compare_func);
 
+  entry = g_slice_new (GstElementFactoryListCache);
+  entry->type = type;
+  entry->minrank = minrank;
+  entry->cookie = cookie;
+  entry->rank_cookie = rank_cookie;
+  entry->factories = gst_plugin_feature_list_copy (result);
+
+  g_mutex_lock (&list_cache_lock);
+  /* another thread might have added the same query meanwhile */
+  if (list_cache_find (type, minrank, cookie, rank_cookie) == NULL) {
+    g_queue_push_head (&list_cache, entry);
+    if (list_cache.length > LIST_CACHE_SIZE)
+      list_cache_free (g_queue_pop_tail (&list_cache));
+  } else {
+    list_cache_free (entry);
+  }
+  g_mutex_unlock (&list_cache_lock);
+
   return result;
 }
 
@@ -819,9 +1088,15 @@ gst_element_factory_list_filter (GList * list,
     const GstCaps * caps, GstPadDirection direction, gboolean subsetonly)
 {
   GQueue results = G_QUEUE_INIT;
+  GstElementFactoryCapsIndex *index = NULL;
 
   GST_DEBUG ("finding factories");
 
+  /* ANY and empty caps match templates of all media types */
+  if ((direction == GST_PAD_SRC || direction == GST_PAD_SINK)
+      && !gst_caps_is_any (caps) && !gst_caps_is_empty (caps))
+    index = caps_index_get ();
+
   /* loop over all the factories */
   for (; list; list = list->next) {
     GstElementFactory *factory;
@@ -830,6 +1105,9 @@ gst_element_factory_list_filter (GList * list,
 
     factory = (GstElementFactory *) list->data;
 
+    if (index && !caps_index_may_match (index, factory, caps, direction))
+      continue;
+
     GST_DEBUG ("Trying %s",
         gst_plugin_feature_get_name ((GstPluginFeature *) factory));
 
@@ -860,5 +1138,9 @@ gst_element_factory_list_filter (GList * list,
       }
     }
   }
+
+  if (index)
+    caps_index_unref (index);
+
   return results.head;
 }
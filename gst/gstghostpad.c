@@ -39,7 +39,10 @@
  * to create the ghost-pad and use gst_ghost_pad_set_target() to establish the
  * association later on.
  *
- * Note that GhostPads add overhead to the data processing of a pipeline.
+ * Note that GhostPads add overhead to the data processing of a pipeline. When
+ * buffers are pushed, ghost pads that use the default chain functions and
+ * have no probes installed are skipped and the data goes directly to the
+ * target pad.
  *
  * Last reviewed on 2005-11-18 (0.9.5)
  */
@@ -172,6 +172,7 @@ GstDebugCategory *GST_CAT_PROBE = NULL;
 GstDebugCategory *GST_CAT_REGISTRY = NULL;
 GstDebugCategory *GST_CAT_QOS = NULL;
 GstDebugCategory *_priv_GST_CAT_POLL = NULL;
+GstDebugCategory *_priv_GST_CAT_TRACER = NULL;
 GstDebugCategory *GST_CAT_META = NULL;
 GstDebugCategory *GST_CAT_LOCKING = NULL;
 
@@ -242,16 +243,54 @@ struct _GstDebugMessage
   va_list arguments;
 };
 
-/* list of all name/level pairs from --gst-debug and GST_DEBUG */
+/* list of all name/level pairs from --gst-debug and GST_DEBUG, the newest
+ * first */
 static GMutex __level_name_mutex;
 static GSList *__level_name = NULL;
+
+typedef enum
+{
+  PATTERN_EXACT,                /* no wildcards */
+  PATTERN_PREFIX,               /* a single '*' at the end */
+  PATTERN_GLOB                  /* everything else */
+} PatternKind;
+
 typedef struct
 {
   GPatternSpec *pat;
   GstDebugLevel level;
+
+  PatternKind kind;
+  /* the name, or the prefix without the '*' */
+  gchar *str;
+  /* newer entries have a higher priority */
+  guint priority;
 }
 LevelNameEntry;
 
+/* The entries compiled into a trie of the exact names and prefixes, the
+ * glob patterns are tried after it on the names. Rebuilt when the
+ * generation changed, all with __level_name_mutex. */
+typedef struct _LevelNameNode LevelNameNode;
+struct _LevelNameNode
+{
+  gchar c;
+  LevelNameNode *child;
+  LevelNameNode *next;
+
+  /* the newest entry for the names that end here */
+  LevelNameEntry *exact;
+  /* the newest entry for the names that start with the path to here */
+  LevelNameEntry *prefix;
+};
+
+static LevelNameNode *__level_name_trie = NULL;
+/* the glob entries, the newest first */
+static GSList *__level_name_globs = NULL;
+static guint __level_name_priority = 0;
+static guint __level_name_generation = 1;
+static guint __level_name_compiled = 0;
+
 /* list of all categories */
 static GMutex __cat_mutex;
 static GSList *__categories = NULL;
@@ -264,8 +303,14 @@ typedef struct
   GDestroyNotify notify;
 }
 LogFuncEntry;
+/* the list is never modified once it is published, writers replace it with
+ * a modified copy while holding the mutex. The old lists and the removed
+ * entries are freed by a writer that sees no thread in a log function. */
 static GMutex __log_func_mutex;
 static GSList *__log_functions = NULL;
+static volatile gint __log_func_readers = 0;
+static GSList *__log_func_retired_lists = NULL;
+static GSList *__log_func_retired_entries = NULL;
 
 #define PRETTY_TAGS_DEFAULT  TRUE
 static gboolean pretty_tags = PRETTY_TAGS_DEFAULT;
@@ -411,6 +456,8 @@ _priv_gst_debug_init (void)
   GST_CAT_REGISTRY = _gst_debug_category_new ("GST_REGISTRY", 0, "registry");
   GST_CAT_QOS = _gst_debug_category_new ("GST_QOS", 0, "QoS");
   _priv_GST_CAT_POLL = _gst_debug_category_new ("GST_POLL", 0, "poll");
+  _priv_GST_CAT_TRACER = _gst_debug_category_new ("GST_TRACER", 0,
+      "tracer reports");
   GST_CAT_META = _gst_debug_category_new ("GST_META", 0, "meta");
   GST_CAT_LOCKING = _gst_debug_category_new ("GST_LOCKING", 0, "locking");
 
@@ -521,13 +568,15 @@ gst_debug_log_valist (GstDebugCategory * category, GstDebugLevel level,
   message.format = format;
   G_VA_COPY (message.arguments, args);
 
-  handler = __log_functions;
+  g_atomic_int_inc (&__log_func_readers);
+  handler = g_atomic_pointer_get (&__log_functions);
   while (handler) {
     entry = handler->data;
     handler = g_slist_next (handler);
     entry->func (category, level, file, function, line, object, &message,
         entry->user_data);
   }
+  g_atomic_int_add (&__log_func_readers, -1);
   g_free (message.message);
   va_end (message.arguments);
 }
@@ -1072,6 +1121,60 @@ gst_debug_level_get_name (GstDebugLevel level)
   }
 }
 
+/* frees the old log function lists when no thread is walking a list and
+ * returns the removed entries that can be freed then, must be called with
+ * the log function mutex */
+static GSList *
+gst_debug_take_retired_log_functions (void)
+{
+  GSList *entries;
+
+  /* a thread that enters gst_debug_log_valist after this check is guaranteed
+   * to see the list that was published before it */
+  if (g_atomic_int_get (&__log_func_readers) != 0)
+    return NULL;
+
+  while (__log_func_retired_lists) {
+    g_slist_free (__log_func_retired_lists->data);
+    __log_func_retired_lists =
+        g_slist_delete_link (__log_func_retired_lists,
+        __log_func_retired_lists);
+  }
+  entries = __log_func_retired_entries;
+  __log_func_retired_entries = NULL;
+
+  return entries;
+}
+
+/* calls the notify of the removed entries and frees them, must be called
+ * without the log function mutex because the notify might log or change the
+ * log functions */
+static void
+gst_debug_free_log_func_entries (GSList * entries)
+{
+  while (entries) {
+    LogFuncEntry *entry = entries->data;
+
+    if (entry->notify)
+      entry->notify (entry->user_data);
+    g_slice_free (LogFuncEntry, entry);
+
+    entries = g_slist_delete_link (entries, entries);
+  }
+}
+
+/* replaces the list of log functions, must be called with the log function
+ * mutex */
+static void
+gst_debug_publish_log_functions (GSList * list)
+{
+  GSList *old = __log_functions;
+
+  g_atomic_pointer_set (&__log_functions, list);
+  if (old)
+    __log_func_retired_lists = g_slist_prepend (__log_func_retired_lists, old);
+}
+
 /**
  * gst_debug_add_log_function:
  * @func: the function to use
@@ -1086,7 +1189,7 @@ gst_debug_add_log_function (GstLogFunction func, gpointer user_data,
     GDestroyNotify notify)
 {
   LogFuncEntry *entry;
-  GSList *list;
+  GSList *list, *retired;
 
   if (func == NULL)
     func = gst_debug_log_default;
@@ -1095,17 +1198,17 @@ gst_debug_add_log_function (GstLogFunction func, gpointer user_data,
   entry->func = func;
   entry->user_data = user_data;
   entry->notify = notify;
-  /* FIXME: we leak the old list here - other threads might access it right now
-   * in gst_debug_logv. Another solution is to lock the mutex in gst_debug_logv,
-   * but that is waaay costly.
-   * It'd probably be clever to use some kind of RCU here, but I don't know
-   * anything about that.
-   */
+
+  /* other threads might walk the old list right now in gst_debug_log_valist,
+   * so it is only freed when they are done */
   g_mutex_lock (&__log_func_mutex);
   list = g_slist_copy (__log_functions);
-  __log_functions = g_slist_prepend (list, entry);
+  gst_debug_publish_log_functions (g_slist_prepend (list, entry));
+  retired = gst_debug_take_retired_log_functions ();
   g_mutex_unlock (&__log_func_mutex);
 
+  gst_debug_free_log_func_entries (retired);
+
   if (gst_is_initialized ())
     GST_DEBUG ("prepended log function %p (user data %p) to log functions",
         func, user_data);
@@ -1131,12 +1234,11 @@ static guint
 gst_debug_remove_with_compare_func (GCompareFunc func, gpointer data)
 {
   GSList *found;
-  GSList *new, *cleanup = NULL;
+  GSList *new, *retired;
   guint removals = 0;
 
   g_mutex_lock (&__log_func_mutex);
   new = __log_functions;
-  cleanup = NULL;
   while ((found = g_slist_find_custom (new, data, func))) {
     if (new == __log_functions) {
       /* make a copy when we have the first hit, so that we modify the copy and
@@ -1144,23 +1246,21 @@ gst_debug_remove_with_compare_func (GCompareFunc func, gpointer data)
       new = g_slist_copy (new);
       continue;
     }
-    cleanup = g_slist_prepend (cleanup, found->data);
+    /* the entry itself might still be used by a thread in
+     * gst_debug_log_valist, it is freed and its notify called together with
+     * the old list */
+    __log_func_retired_entries =
+        g_slist_prepend (__log_func_retired_entries, found->data);
     new = g_slist_delete_link (new, found);
     removals++;
   }
-  /* FIXME: We leak the old list here. See _add_log_function for why. */
-  __log_functions = new;
+  if (new != __log_functions)
+    gst_debug_publish_log_functions (new);
+  retired = gst_debug_take_retired_log_functions ();
   g_mutex_unlock (&__log_func_mutex);
 
-  while (cleanup) {
-    LogFuncEntry *entry = cleanup->data;
-
-    if (entry->notify)
-      entry->notify (entry->user_data);
+  gst_debug_free_log_func_entries (retired);
 
-    g_slice_free (LogFuncEntry, entry);
-    cleanup = g_slist_delete_link (cleanup, cleanup);
-  }
   return removals;
 }
 
@@ -1215,6 +1315,329 @@ gst_debug_remove_log_function_by_data (gpointer data)
   return removals;
 }
 
+/* the ring buffer logger keeps the last messages of every thread in memory.
+ * A record is a GstDebugRingRecord directly followed by the message without
+ * the terminating nul, records wrap around at the end of the buffer. */
+typedef struct
+{
+  GstClockTime timestamp;
+  GstDebugCategory *category;
+  const gchar *file;
+  const gchar *function;
+  gconstpointer object;
+  gint line;
+  guint16 level;
+  guint16 length;
+} GstDebugRingRecord;
+
+typedef struct
+{
+  volatile gint refcount;
+  /* only contended while the logs are retrieved */
+  GMutex lock;
+  /* FALSE when the logger no longer uses this ring buffer */
+  gboolean attached;
+  gpointer thread;
+  GstClockTime last_use;
+  guint8 *data;
+  gsize size;
+  gsize head;
+  gsize tail;
+  gsize used;
+} GstDebugRingBuffer;
+
+static void gst_debug_ring_buffer_unref (GstDebugRingBuffer * ring);
+
+static GMutex ring_buffer_logger_lock;
+static gboolean ring_buffer_logger_active = FALSE;
+static guint ring_buffer_max_size;
+static guint ring_buffer_thread_timeout;
+static GList *ring_buffers = NULL;
+static GPrivate ring_buffer_key =
+G_PRIVATE_INIT ((GDestroyNotify) gst_debug_ring_buffer_unref);
+
+static void
+gst_debug_ring_buffer_unref (GstDebugRingBuffer * ring)
+{
+  if (g_atomic_int_dec_and_test (&ring->refcount)) {
+    g_mutex_clear (&ring->lock);
+    g_free (ring->data);
+    g_slice_free (GstDebugRingBuffer, ring);
+  }
+}
+
+/* must be called with the ring buffer logger lock */
+static void
+gst_debug_ring_buffer_detach (GstDebugRingBuffer * ring)
+{
+  g_mutex_lock (&ring->lock);
+  ring->attached = FALSE;
+  g_mutex_unlock (&ring->lock);
+  gst_debug_ring_buffer_unref (ring);
+}
+
+/* creates the ring buffer of the current thread, returns NULL when the
+ * logger was removed meanwhile */
+static GstDebugRingBuffer *
+gst_debug_ring_buffer_new (GstClockTime now)
+{
+  GstDebugRingBuffer *ring = NULL;
+  GList *walk, *next;
+
+  g_mutex_lock (&ring_buffer_logger_lock);
+  if (!ring_buffer_logger_active)
+    goto done;
+
+  /* drop the logs of threads that did not log for too long */
+  if (ring_buffer_thread_timeout > 0) {
+    for (walk = ring_buffers; walk; walk = next) {
+      GstDebugRingBuffer *old = walk->data;
+      gboolean expired;
+
+      next = walk->next;
+      g_mutex_lock (&old->lock);
+      expired = GST_CLOCK_DIFF (old->last_use, now) >
+          (GstClockTimeDiff) ring_buffer_thread_timeout * GST_SECOND;
+      g_mutex_unlock (&old->lock);
+      if (expired) {
+        ring_buffers = g_list_delete_link (ring_buffers, walk);
+        gst_debug_ring_buffer_detach (old);
+      }
+    }
+  }
+
+  ring = g_slice_new0 (GstDebugRingBuffer);
+  /* one for the logger and one for the thread */
+  ring->refcount = 2;
+  g_mutex_init (&ring->lock);
+  ring->attached = TRUE;
+  ring->thread = g_thread_self ();
+  ring->last_use = now;
+  ring->size = ring_buffer_max_size;
+  ring->data = g_malloc (ring->size);
+  ring_buffers = g_list_prepend (ring_buffers, ring);
+
+done:
+  g_mutex_unlock (&ring_buffer_logger_lock);
+
+  return ring;
+}
+
+static void
+gst_debug_ring_buffer_write (GstDebugRingBuffer * ring, gconstpointer src,
+    gsize len)
+{
+  gsize first = MIN (len, ring->size - ring->head);
+
+  memcpy (ring->data + ring->head, src, first);
+  memcpy (ring->data, (const guint8 *) src + first, len - first);
+  ring->head = (ring->head + len) % ring->size;
+}
+
+static void
+gst_debug_ring_buffer_read (GstDebugRingBuffer * ring, gsize offset,
+    gpointer dest, gsize len)
+{
+  gsize first = MIN (len, ring->size - offset);
+
+  memcpy (dest, ring->data + offset, first);
+  memcpy ((guint8 *) dest + first, ring->data, len - first);
+}
+
+static void
+gst_debug_log_ring_buffer (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer unused) G_GNUC_NO_INSTRUMENT;
+
+static void
+gst_debug_log_ring_buffer (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer unused)
+{
+  GstDebugRingBuffer *ring;
+  GstDebugRingRecord record;
+  const gchar *msg;
+  GstClockTime now;
+  gsize len, needed;
+
+  now = gst_util_get_timestamp ();
+  msg = gst_debug_message_get (message);
+  len = msg ? strlen (msg) : 0;
+
+  ring = g_private_get (&ring_buffer_key);
+  if (ring) {
+    g_mutex_lock (&ring->lock);
+    if (!ring->attached) {
+      g_mutex_unlock (&ring->lock);
+      ring = NULL;
+    }
+  }
+  if (ring == NULL) {
+    if (!(ring = gst_debug_ring_buffer_new (now)))
+      return;
+    g_private_replace (&ring_buffer_key, ring);
+    g_mutex_lock (&ring->lock);
+  }
+
+  len = MIN (len, G_MAXUINT16);
+  len = MIN (len, ring->size - sizeof (GstDebugRingRecord));
+  needed = sizeof (GstDebugRingRecord) + len;
+
+  /* drop the oldest records until the new one fits */
+  while (ring->size - ring->used < needed) {
+    GstDebugRingRecord old;
+    gsize old_size;
+
+    gst_debug_ring_buffer_read (ring, ring->tail, &old, sizeof (old));
+    old_size = sizeof (old) + old.length;
+    ring->tail = (ring->tail + old_size) % ring->size;
+    ring->used -= old_size;
+  }
+
+  record.timestamp = GST_CLOCK_DIFF (_priv_gst_info_start_time, now);
+  record.category = category;
+  record.file = file;
+  record.function = function;
+  record.object = object;
+  record.line = line;
+  record.level = level;
+  record.length = len;
+  gst_debug_ring_buffer_write (ring, &record, sizeof (record));
+  gst_debug_ring_buffer_write (ring, msg, len);
+  ring->used += needed;
+  ring->last_use = now;
+
+  g_mutex_unlock (&ring->lock);
+}
+
+/* decodes the records of @ring, must be called with the ring lock */
+static gchar *
+gst_debug_ring_buffer_decode (GstDebugRingBuffer * ring)
+{
+  GString *str;
+  gsize offset, done;
+
+  str = g_string_sized_new (ring->used * 2);
+
+  for (offset = ring->tail, done = 0; done < ring->used;) {
+    GstDebugRingRecord record;
+    gchar *msg;
+
+    gst_debug_ring_buffer_read (ring, offset, &record, sizeof (record));
+    offset = (offset + sizeof (record)) % ring->size;
+    msg = g_malloc (record.length + 1);
+    gst_debug_ring_buffer_read (ring, offset, msg, record.length);
+    msg[record.length] = '\0';
+    offset = (offset + record.length) % ring->size;
+    done += sizeof (record) + record.length;
+
+    /* the objects might be gone, only their address is printed */
+    g_string_append_printf (str, "%" GST_TIME_FORMAT " %p %s %20s %s:%d:%s:",
+        GST_TIME_ARGS (record.timestamp), ring->thread,
+        gst_debug_level_get_name (record.level),
+        gst_debug_category_get_name (record.category), record.file,
+        record.line, record.function);
+    if (record.object)
+      g_string_append_printf (str, "<%p>", record.object);
+    g_string_append_printf (str, " %s\n", msg);
+    g_free (msg);
+  }
+
+  return g_string_free (str, FALSE);
+}
+
+/**
+ * gst_debug_add_ring_buffer_logger:
+ * @max_size_per_thread: the maximum size of the logs of one thread in bytes
+ * @thread_timeout: forget the logs of a thread that did not log for this many
+ *     seconds, 0 to keep them until the logger is removed
+ *
+ * Adds a log function that keeps the last debug messages of every thread
+ * in memory instead of printing them, until they are retrieved with
+ * gst_debug_ring_buffer_logger_get_logs(). The messages are stored as
+ * compact records without printing the objects, which makes it much
+ * cheaper than gst_debug_log_default() and useful as a flight recorder.
+ *
+ * A previously added ring buffer logger is replaced together with its
+ * logs.
+ *
+ * Since: 1.2
+ */
+void
+gst_debug_add_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+  g_return_if_fail (max_size_per_thread > sizeof (GstDebugRingRecord));
+
+  gst_debug_remove_ring_buffer_logger ();
+
+  g_mutex_lock (&ring_buffer_logger_lock);
+  ring_buffer_max_size = max_size_per_thread;
+  ring_buffer_thread_timeout = thread_timeout;
+  ring_buffer_logger_active = TRUE;
+  g_mutex_unlock (&ring_buffer_logger_lock);
+
+  gst_debug_add_log_function (gst_debug_log_ring_buffer, NULL, NULL);
+}
+
+/**
+ * gst_debug_remove_ring_buffer_logger:
+ *
+ * Removes the ring buffer logger added with
+ * gst_debug_add_ring_buffer_logger() and frees its logs.
+ *
+ * Since: 1.2
+ */
+void
+gst_debug_remove_ring_buffer_logger (void)
+{
+  gst_debug_remove_log_function (gst_debug_log_ring_buffer);
+
+  g_mutex_lock (&ring_buffer_logger_lock);
+  ring_buffer_logger_active = FALSE;
+  while (ring_buffers) {
+    gst_debug_ring_buffer_detach (ring_buffers->data);
+    ring_buffers = g_list_delete_link (ring_buffers, ring_buffers);
+  }
+  g_mutex_unlock (&ring_buffer_logger_lock);
+}
+
+/**
+ * gst_debug_ring_buffer_logger_get_logs:
+ *
+ * Decodes the messages kept by the ring buffer logger, one string with all
+ * messages for every thread that logged, in the format of
+ * gst_debug_log_default() without colors. The objects are only printed by
+ * their address because they might not exist anymore.
+ *
+ * Returns: (transfer full): a %NULL terminated array of strings, free with
+ *     g_strfreev()
+ *
+ * Since: 1.2
+ */
+gchar **
+gst_debug_ring_buffer_logger_get_logs (void)
+{
+  GPtrArray *logs;
+  GList *walk;
+
+  logs = g_ptr_array_new ();
+
+  g_mutex_lock (&ring_buffer_logger_lock);
+  for (walk = ring_buffers; walk; walk = walk->next) {
+    GstDebugRingBuffer *ring = walk->data;
+
+    g_mutex_lock (&ring->lock);
+    g_ptr_array_add (logs, gst_debug_ring_buffer_decode (ring));
+    g_mutex_unlock (&ring->lock);
+  }
+  g_mutex_unlock (&ring_buffer_logger_lock);
+
+  g_ptr_array_add (logs, NULL);
+
+  return (gchar **) g_ptr_array_free (logs, FALSE);
+}
+
 /**
  * gst_debug_set_colored:
  * @colored: Whether to use colored output or not
@@ -1304,37 +1727,193 @@ gst_debug_get_default_threshold (void)
   return (GstDebugLevel) g_atomic_int_get (&__default_level);
 }
 
+static LevelNameEntry *
+level_name_entry_new (const gchar * name, GstDebugLevel level)
+{
+  LevelNameEntry *entry;
+  const gchar *star;
+
+  entry = g_slice_new (LevelNameEntry);
+  entry->pat = g_pattern_spec_new (name);
+  entry->level = level;
+  entry->priority = ++__level_name_priority;
+
+  star = strchr (name, '*');
+  if (strchr (name, '?') == NULL && star == NULL) {
+    entry->kind = PATTERN_EXACT;
+    entry->str = g_strdup (name);
+  } else if (strchr (name, '?') == NULL && star[1] == '\0') {
+    entry->kind = PATTERN_PREFIX;
+    entry->str = g_strndup (name, star - name);
+  } else {
+    entry->kind = PATTERN_GLOB;
+    entry->str = NULL;
+  }
+
+  return entry;
+}
+
 static void
-gst_debug_reset_threshold (gpointer category, gpointer unused)
+level_name_entry_free (LevelNameEntry * entry)
+{
+  g_pattern_spec_free (entry->pat);
+  g_free (entry->str);
+  g_slice_free (LevelNameEntry, entry);
+}
+
+static gboolean
+level_name_entry_matches (LevelNameEntry * entry, const gchar * name)
+{
+  switch (entry->kind) {
+    case PATTERN_EXACT:
+      return strcmp (entry->str, name) == 0;
+    case PATTERN_PREFIX:
+      return g_str_has_prefix (name, entry->str);
+    default:
+      return g_pattern_match_string (entry->pat, name);
+  }
+}
+
+static void
+level_name_node_free (LevelNameNode * node)
+{
+  while (node) {
+    LevelNameNode *next = node->next;
+
+    level_name_node_free (node->child);
+    g_slice_free (LevelNameNode, node);
+    node = next;
+  }
+}
+
+static LevelNameNode *
+level_name_node_child (LevelNameNode * node, gchar c, gboolean create)
+{
+  LevelNameNode *child;
+
+  for (child = node->child; child; child = child->next)
+    if (child->c == c)
+      return child;
+
+  if (!create)
+    return NULL;
+
+  child = g_slice_new0 (LevelNameNode);
+  child->c = c;
+  child->next = node->child;
+  node->child = child;
+
+  return child;
+}
+
+/* with __level_name_mutex */
+static void
+level_name_compile (void)
 {
-  GstDebugCategory *cat = (GstDebugCategory *) category;
   GSList *walk;
 
-  g_mutex_lock (&__level_name_mutex);
-  walk = __level_name;
-  while (walk) {
+  if (__level_name_compiled == __level_name_generation)
+    return;
+
+  level_name_node_free (__level_name_trie);
+  g_slist_free (__level_name_globs);
+  __level_name_trie = g_slice_new0 (LevelNameNode);
+  __level_name_globs = NULL;
+
+  /* newest first, older entries for the same name are hidden */
+  for (walk = __level_name; walk; walk = g_slist_next (walk)) {
     LevelNameEntry *entry = walk->data;
+    LevelNameNode *node = __level_name_trie;
+    const gchar *c;
 
-    walk = g_slist_next (walk);
-    if (g_pattern_match_string (entry->pat, cat->name)) {
-      if (gst_is_initialized ())
-        GST_LOG ("category %s matches pattern %p - gets set to level %d",
-            cat->name, entry->pat, entry->level);
-      gst_debug_category_set_threshold (cat, entry->level);
-      goto exit;
+    if (entry->kind == PATTERN_GLOB) {
+      __level_name_globs = g_slist_prepend (__level_name_globs, entry);
+      continue;
+    }
+
+    for (c = entry->str; *c; c++)
+      node = level_name_node_child (node, *c, TRUE);
+
+    if (entry->kind == PATTERN_EXACT && node->exact == NULL)
+      node->exact = entry;
+    else if (entry->kind == PATTERN_PREFIX && node->prefix == NULL)
+      node->prefix = entry;
+  }
+  __level_name_globs = g_slist_reverse (__level_name_globs);
+
+  __level_name_compiled = __level_name_generation;
+}
+
+/* the newest entry matching @name, with __level_name_mutex */
+static LevelNameEntry *
+level_name_lookup (const gchar * name)
+{
+  LevelNameEntry *best;
+  LevelNameNode *node;
+  GSList *walk;
+  const gchar *c;
+
+  level_name_compile ();
+
+  node = __level_name_trie;
+  best = node->prefix;
+  for (c = name; *c; c++) {
+    if (!(node = level_name_node_child (node, *c, FALSE)))
+      break;
+    if (node->prefix && (!best || node->prefix->priority > best->priority))
+      best = node->prefix;
+  }
+  if (node && node->exact && (!best || node->exact->priority > best->priority))
+    best = node->exact;
+
+  for (walk = __level_name_globs; walk; walk = g_slist_next (walk)) {
+    LevelNameEntry *entry = walk->data;
+
+    if (best && entry->priority < best->priority)
+      break;
+    if (g_pattern_match_string (entry->pat, name)) {
+      best = entry;
+      break;
     }
   }
-  gst_debug_category_set_threshold (cat, gst_debug_get_default_threshold ());
 
-exit:
+  return best;
+}
+
+/* with __level_name_mutex */
+static void
+gst_debug_reset_threshold_unlocked (GstDebugCategory * cat)
+{
+  LevelNameEntry *entry;
+
+  if ((entry = level_name_lookup (cat->name))) {
+    if (gst_is_initialized ())
+      GST_LOG ("category %s matches pattern %p - gets set to level %d",
+          cat->name, entry->pat, entry->level);
+    gst_debug_category_set_threshold (cat, entry->level);
+  } else {
+    gst_debug_category_set_threshold (cat, gst_debug_get_default_threshold ());
+  }
+}
+
+static void
+gst_debug_reset_threshold (gpointer category, gpointer unused)
+{
+  g_mutex_lock (&__level_name_mutex);
+  gst_debug_reset_threshold_unlocked ((GstDebugCategory *) category);
   g_mutex_unlock (&__level_name_mutex);
 }
 
 static void
 gst_debug_reset_all_thresholds (void)
 {
+  GSList *walk;
+
   g_mutex_lock (&__cat_mutex);
-  g_slist_foreach (__categories, gst_debug_reset_threshold, NULL);
+  g_mutex_lock (&__level_name_mutex);
+  for (walk = __categories; walk; walk = g_slist_next (walk))
+    gst_debug_reset_threshold_unlocked (walk->data);
+  g_mutex_unlock (&__level_name_mutex);
   g_mutex_unlock (&__cat_mutex);
 }
 
@@ -1344,7 +1923,7 @@ for_each_threshold_by_entry (gpointer data, gpointer user_data)
   GstDebugCategory *cat = (GstDebugCategory *) data;
   LevelNameEntry *entry = (LevelNameEntry *) user_data;
 
-  if (g_pattern_match_string (entry->pat, cat->name)) {
+  if (level_name_entry_matches (entry, cat->name)) {
     if (gst_is_initialized ())
       GST_LOG ("category %s matches pattern %p - gets set to level %d",
           cat->name, entry->pat, entry->level);
@@ -1363,18 +1942,16 @@ for_each_threshold_by_entry (gpointer data, gpointer user_data)
 void
 gst_debug_set_threshold_for_name (const gchar * name, GstDebugLevel level)
 {
-  GPatternSpec *pat;
   LevelNameEntry *entry;
 
   g_return_if_fail (name != NULL);
 
-  pat = g_pattern_spec_new (name);
-  entry = g_slice_new (LevelNameEntry);
-  entry->pat = pat;
-  entry->level = level;
   g_mutex_lock (&__level_name_mutex);
+  entry = level_name_entry_new (name, level);
   __level_name = g_slist_prepend (__level_name, entry);
+  __level_name_generation++;
   g_mutex_unlock (&__level_name_mutex);
+  /* the new entry has the highest priority, only its categories change */
   g_mutex_lock (&__cat_mutex);
   g_slist_foreach (__categories, for_each_threshold_by_entry, entry);
   g_mutex_unlock (&__cat_mutex);
@@ -1397,17 +1974,16 @@ gst_debug_unset_threshold_for_name (const gchar * name)
   pat = g_pattern_spec_new (name);
   g_mutex_lock (&__level_name_mutex);
   walk = __level_name;
-  /* improve this if you want, it's mighty slow */
   while (walk) {
     LevelNameEntry *entry = walk->data;
+    GSList *next = g_slist_next (walk);
 
     if (g_pattern_spec_equal (entry->pat, pat)) {
-      __level_name = g_slist_remove_link (__level_name, walk);
-      g_pattern_spec_free (entry->pat);
-      g_slice_free (LevelNameEntry, entry);
-      g_slist_free_1 (walk);
-      walk = __level_name;
+      __level_name = g_slist_delete_link (__level_name, walk);
+      level_name_entry_free (entry);
+      __level_name_generation++;
     }
+    walk = next;
   }
   g_mutex_unlock (&__level_name_mutex);
   g_pattern_spec_free (pat);
@@ -1955,6 +2531,23 @@ gst_debug_remove_log_function_by_data (gpointer data)
   return 0;
 }
 
+void
+gst_debug_add_ring_buffer_logger (guint max_size_per_thread,
+    guint thread_timeout)
+{
+}
+
+void
+gst_debug_remove_ring_buffer_logger (void)
+{
+}
+
+gchar **
+gst_debug_ring_buffer_logger_get_logs (void)
+{
+  return NULL;
+}
+
 void
 gst_debug_set_active (gboolean active)
 {
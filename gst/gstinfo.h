@@ -256,6 +256,23 @@ typedef void (*GstLogFunction)  (GstDebugCategory * category,
                                  GstDebugMessage  * message,
                                  gpointer           user_data);
 
+/**
+ * GST_DEBUG_COLD:
+ *
+ * Marks a function as unlikely to be called. The compiler then keeps the
+ * calls to it, and the code that prepares their arguments, out of the hot
+ * paths of the callers and can place them in a separate text section. The
+ * logging functions are marked with it so that disabled log statements cost
+ * as little instruction cache as possible.
+ *
+ * Since: 1.2
+ */
+#if defined (__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+#define GST_DEBUG_COLD __attribute__ ((cold))
+#else
+#define GST_DEBUG_COLD
+#endif
+
 #ifdef GST_USING_PRINTF_EXTENSION
 
 /* not using G_GNUC_PRINTF, since gcc will choke on GST_PTR_FORMAT being %P */
@@ -266,7 +283,7 @@ void		    gst_debug_log            (GstDebugCategory * category,
                                           gint               line,
                                           GObject          * object,
                                           const gchar      * format,
-                                          ...) G_GNUC_NO_INSTRUMENT;
+                                          ...) G_GNUC_NO_INSTRUMENT GST_DEBUG_COLD;
 
 #else /* GST_USING_PRINTF_EXTENSION */
 
@@ -277,7 +294,7 @@ void		    gst_debug_log            (GstDebugCategory * category,
                                           gint               line,
                                           GObject          * object,
                                           const gchar      * format,
-                                          ...) G_GNUC_PRINTF (7, 8) G_GNUC_NO_INSTRUMENT;
+                                          ...) G_GNUC_PRINTF (7, 8) G_GNUC_NO_INSTRUMENT GST_DEBUG_COLD;
 
 #endif /* GST_USING_PRINTF_EXTENSION */
 
@@ -288,7 +305,7 @@ void            gst_debug_log_valist     (GstDebugCategory * category,
                                           gint	              line,
                                           GObject          * object,
                                           const gchar      * format,
-                                          va_list            args) G_GNUC_NO_INSTRUMENT;
+                                          va_list            args) G_GNUC_NO_INSTRUMENT GST_DEBUG_COLD;
 
 /* do not use this function, use the GST_DEBUG_CATEGORY_INIT macro */
 GstDebugCategory *_gst_debug_category_new (const gchar * name,
@@ -301,7 +318,7 @@ GstDebugCategory *_gst_debug_get_category (const gchar *name);
 /* do not use this function, use the GST_CAT_MEMDUMP_* macros */
 void _gst_debug_dump_mem (GstDebugCategory * cat, const gchar * file,
     const gchar * func, gint line, GObject * obj, const gchar * msg,
-    const guint8 * data, guint length);
+    const guint8 * data, guint length) GST_DEBUG_COLD;
 
 /* we define this to avoid a compiler warning regarding a cast from a function
  * pointer to a void pointer
@@ -336,6 +353,11 @@ void            gst_debug_add_log_function            (GstLogFunction func,
 guint           gst_debug_remove_log_function         (GstLogFunction func);
 guint           gst_debug_remove_log_function_by_data (gpointer       data);
 
+void            gst_debug_add_ring_buffer_logger      (guint max_size_per_thread,
+                                                       guint thread_timeout);
+void            gst_debug_remove_ring_buffer_logger   (void);
+gchar **        gst_debug_ring_buffer_logger_get_logs (void);
+
 void            gst_debug_set_active  (gboolean active);
 gboolean        gst_debug_is_active   (void);
 
@@ -491,6 +513,23 @@ GST_EXPORT gboolean			_gst_debug_enabled;
  * messages that fall under the threshold. */
 GST_EXPORT GstDebugLevel            _gst_debug_min;
 
+/**
+ * GST_DEBUG_MAX_LEVEL:
+ *
+ * The highest level of the debug messages that are compiled in. The log
+ * statements of higher levels are removed by the compiler together with
+ * their format strings, whatever the thresholds are at runtime.
+ *
+ * The default is set with the <option>--with-max-debug-level</option>
+ * option of configure, it can be overridden for a single file by defining
+ * GST_DEBUG_MAX_LEVEL before including the GStreamer headers.
+ *
+ * Since: 1.2
+ */
+#ifndef GST_DEBUG_MAX_LEVEL
+#define GST_DEBUG_MAX_LEVEL GST_LEVEL_COUNT
+#endif
+
 /**
  * GST_CAT_LEVEL_LOG:
  * @cat: category to use
@@ -504,7 +543,8 @@ GST_EXPORT GstDebugLevel            _gst_debug_min;
  */
 #ifdef G_HAVE_ISO_VARARGS
 #define GST_CAT_LEVEL_LOG(cat,level,object,...) G_STMT_START{		\
-  if (G_UNLIKELY (level <= _gst_debug_min)) {						\
+  if (G_UNLIKELY ((level) <= GST_DEBUG_MAX_LEVEL &&			\
+          (level) <= _gst_debug_min)) {					\
     gst_debug_log ((cat), (level), __FILE__, GST_FUNCTION, __LINE__,	\
         (GObject *) (object), __VA_ARGS__);				\
   }									\
@@ -512,7 +552,8 @@ GST_EXPORT GstDebugLevel            _gst_debug_min;
 #else /* G_HAVE_GNUC_VARARGS */
 #ifdef G_HAVE_GNUC_VARARGS
 #define GST_CAT_LEVEL_LOG(cat,level,object,args...) G_STMT_START{	\
-  if (G_UNLIKELY (level <= _gst_debug_min)) {						\
+  if (G_UNLIKELY ((level) <= GST_DEBUG_MAX_LEVEL &&			\
+          (level) <= _gst_debug_min)) {					\
     gst_debug_log ((cat), (level), __FILE__, GST_FUNCTION, __LINE__,	\
         (GObject *) (object), ##args );					\
   }									\
@@ -522,7 +563,7 @@ static inline void
 GST_CAT_LEVEL_LOG_valist (GstDebugCategory * cat,
     GstDebugLevel level, gpointer object, const char *format, va_list varargs)
 {
-  if (G_UNLIKELY (level <= _gst_debug_min)) {
+  if (G_UNLIKELY (level <= GST_DEBUG_MAX_LEVEL && level <= _gst_debug_min)) {
     gst_debug_log_valist (cat, level, "", "", 0, (GObject *) object, format,
         varargs);
   }
@@ -545,7 +586,8 @@ GST_CAT_LEVEL_LOG (GstDebugCategory * cat, GstDebugLevel level,
  * other macros and hence in a separate block right here. Docs chunks are
  * with the other doc chunks below though. */
 #define __GST_CAT_MEMDUMP_LOG(cat,object,msg,data,length) G_STMT_START{       \
-  if (G_UNLIKELY (GST_LEVEL_MEMDUMP <= _gst_debug_min)) {                    \
+  if (G_UNLIKELY (GST_LEVEL_MEMDUMP <= GST_DEBUG_MAX_LEVEL &&                 \
+          GST_LEVEL_MEMDUMP <= _gst_debug_min)) {                             \
     _gst_debug_dump_mem ((cat), __FILE__, GST_FUNCTION, __LINE__,             \
         (GObject *) (object), (msg), (data), (length));                       \
   }                                                                           \
@@ -1237,6 +1279,9 @@ GST_TRACE (const char *format, ...)
 #define gst_debug_level_get_name(level)				("NONE")
 #define gst_debug_message_get(message)  			("")
 #define gst_debug_add_log_function(func,data,notify)    G_STMT_START{ }G_STMT_END
+#define gst_debug_add_ring_buffer_logger(size,timeout)  G_STMT_START{ }G_STMT_END
+#define gst_debug_remove_ring_buffer_logger()		G_STMT_START{ }G_STMT_END
+#define gst_debug_ring_buffer_logger_get_logs()		(NULL)
 #define gst_debug_set_active(active)			G_STMT_START{ }G_STMT_END
 #define gst_debug_is_active()				(FALSE)
 #define gst_debug_set_colored(colored)			G_STMT_START{ }G_STMT_END
@@ -0,0 +1,330 @@
+/* GStreamer
+ *
+ * gstlockstats.c: wait and hold time statistics of locks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* When GStreamer is configured with --enable-lock-stats, the object lock and
+ * the stream lock of pads in the core and the locks of queue and multiqueue
+ * go through the functions below. With GST_LOCK_STATS set in the
+ * environment they record, for each lock, how often it was taken, how often
+ * it was contended and how long the threads waited for it and held it. The
+ * statistics are printed when the process exits, or with
+ * _gst_lock_stats_dump() from a debugger.
+ *
+ * The time a thread spends in a g_cond_wait() on the lock is not counted as
+ * hold time when the wait goes through GST_LOCK_STATS_COND_WAIT. */
+
+#include "gst_private.h"
+
+#include "gstutils.h"
+#include "gstlockstats.h"
+
+typedef struct
+{
+  gpointer lock;
+  gpointer object;
+  GstLockStatsKind kind;
+  gchar *name;
+
+  guint64 acquired;
+  guint64 contended;
+  GstClockTime wait_total;
+  GstClockTime wait_max;
+  GstClockTime hold_total;
+  GstClockTime hold_max;
+} GstLockStatsEntry;
+
+/* a lock held by the current thread */
+typedef struct
+{
+  gpointer lock;
+  GstLockStatsEntry *entry;
+  GstClockTime acquired;
+  guint depth;
+} GstLockStatsHeld;
+
+gboolean _gst_lock_stats_enabled = FALSE;
+
+/* protects the tables, the entries are never freed so that the threads can
+ * keep pointers to them */
+static GMutex stats_lock;
+static GHashTable *stats_entries = NULL;
+static GList *stats_retired = NULL;
+
+static void
+lock_stats_held_free (gpointer data)
+{
+  g_array_free (data, TRUE);
+}
+
+static GPrivate stats_held = G_PRIVATE_INIT (lock_stats_held_free);
+
+static const gchar *kind_names[] = { "object", "stream", "queue" };
+
+static void
+lock_stats_at_exit (void)
+{
+  _gst_lock_stats_dump ();
+}
+
+void
+_priv_gst_lock_stats_initialize (void)
+{
+#ifdef GST_ENABLE_LOCK_STATS
+  if (g_getenv ("GST_LOCK_STATS") == NULL)
+    return;
+
+  stats_entries = g_hash_table_new (NULL, NULL);
+  atexit (lock_stats_at_exit);
+  _gst_lock_stats_enabled = TRUE;
+#endif
+}
+
+static void
+lock_stats_update_name (GstLockStatsEntry * entry)
+{
+  if (entry->name == NULL && entry->object && GST_IS_OBJECT (entry->object)
+      && GST_OBJECT_NAME (entry->object))
+    entry->name = g_strdup_printf ("%s %s", G_OBJECT_TYPE_NAME (entry->object),
+        GST_OBJECT_NAME (entry->object));
+}
+
+/* called with stats_lock */
+static GstLockStatsEntry *
+lock_stats_lookup (gpointer lock, gpointer object, GstLockStatsKind kind)
+{
+  GstLockStatsEntry *entry;
+
+  entry = g_hash_table_lookup (stats_entries, lock);
+  if (G_UNLIKELY (entry && entry->object != object)) {
+    /* the object was freed and its memory reused, keep the old values */
+    stats_retired = g_list_prepend (stats_retired, entry);
+    entry = NULL;
+  }
+  if (G_UNLIKELY (entry == NULL)) {
+    entry = g_slice_new0 (GstLockStatsEntry);
+    entry->lock = lock;
+    entry->object = object;
+    entry->kind = kind;
+    g_hash_table_insert (stats_entries, lock, entry);
+  }
+  lock_stats_update_name (entry);
+
+  return entry;
+}
+
+static void
+lock_stats_acquired (gpointer lock, gpointer object, GstLockStatsKind kind,
+    gboolean contended, GstClockTime wait)
+{
+  GArray *held;
+  GstLockStatsHeld h;
+  guint i;
+
+  held = g_private_get (&stats_held);
+  if (G_UNLIKELY (held == NULL)) {
+    held = g_array_new (FALSE, FALSE, sizeof (GstLockStatsHeld));
+    g_private_set (&stats_held, held);
+  }
+
+  /* a recursive lock that we already hold, only the outer hold counts */
+  for (i = held->len; i > 0; i--) {
+    GstLockStatsHeld *prev = &g_array_index (held, GstLockStatsHeld, i - 1);
+
+    if (prev->lock == lock) {
+      prev->depth++;
+      return;
+    }
+  }
+
+  g_mutex_lock (&stats_lock);
+  h.entry = lock_stats_lookup (lock, object, kind);
+  h.entry->acquired++;
+  if (contended) {
+    h.entry->contended++;
+    h.entry->wait_total += wait;
+    h.entry->wait_max = MAX (h.entry->wait_max, wait);
+  }
+  g_mutex_unlock (&stats_lock);
+
+  h.lock = lock;
+  h.depth = 1;
+  h.acquired = gst_util_get_timestamp ();
+  g_array_append_val (held, h);
+}
+
+static void
+lock_stats_released (gpointer lock)
+{
+  GArray *held;
+  GstLockStatsHeld *h;
+  GstClockTime hold;
+  guint i;
+
+  held = g_private_get (&stats_held);
+  if (G_UNLIKELY (held == NULL))
+    return;
+
+  for (i = held->len; i > 0; i--) {
+    h = &g_array_index (held, GstLockStatsHeld, i - 1);
+    if (h->lock != lock)
+      continue;
+
+    if (--h->depth > 0)
+      return;
+
+    hold = gst_util_get_timestamp () - h->acquired;
+
+    g_mutex_lock (&stats_lock);
+    h->entry->hold_total += hold;
+    h->entry->hold_max = MAX (h->entry->hold_max, hold);
+    g_mutex_unlock (&stats_lock);
+
+    /* locks are not always released in the reverse order */
+    g_array_remove_index (held, i - 1);
+    return;
+  }
+}
+
+void
+_gst_lock_stats_mutex_lock (GMutex * mutex, gpointer object,
+    GstLockStatsKind kind)
+{
+  GstClockTime start;
+
+  if (G_LIKELY (g_mutex_trylock (mutex))) {
+    lock_stats_acquired (mutex, object, kind, FALSE, 0);
+    return;
+  }
+
+  start = gst_util_get_timestamp ();
+  g_mutex_lock (mutex);
+  lock_stats_acquired (mutex, object, kind, TRUE,
+      gst_util_get_timestamp () - start);
+}
+
+gboolean
+_gst_lock_stats_mutex_trylock (GMutex * mutex, gpointer object,
+    GstLockStatsKind kind)
+{
+  if (!g_mutex_trylock (mutex))
+    return FALSE;
+
+  lock_stats_acquired (mutex, object, kind, FALSE, 0);
+  return TRUE;
+}
+
+void
+_gst_lock_stats_mutex_unlock (GMutex * mutex)
+{
+  lock_stats_released (mutex);
+  g_mutex_unlock (mutex);
+}
+
+void
+_gst_lock_stats_rec_mutex_lock (GRecMutex * mutex, gpointer object,
+    GstLockStatsKind kind)
+{
+  GstClockTime start;
+
+  if (G_LIKELY (g_rec_mutex_trylock (mutex))) {
+    lock_stats_acquired (mutex, object, kind, FALSE, 0);
+    return;
+  }
+
+  start = gst_util_get_timestamp ();
+  g_rec_mutex_lock (mutex);
+  lock_stats_acquired (mutex, object, kind, TRUE,
+      gst_util_get_timestamp () - start);
+}
+
+gboolean
+_gst_lock_stats_rec_mutex_trylock (GRecMutex * mutex, gpointer object,
+    GstLockStatsKind kind)
+{
+  if (!g_rec_mutex_trylock (mutex))
+    return FALSE;
+
+  lock_stats_acquired (mutex, object, kind, FALSE, 0);
+  return TRUE;
+}
+
+void
+_gst_lock_stats_rec_mutex_unlock (GRecMutex * mutex)
+{
+  lock_stats_released (mutex);
+  g_rec_mutex_unlock (mutex);
+}
+
+void
+_gst_lock_stats_cond_wait (GCond * cond, GMutex * mutex, gpointer object,
+    GstLockStatsKind kind)
+{
+  lock_stats_released (mutex);
+  g_cond_wait (cond, mutex);
+  lock_stats_acquired (mutex, object, kind, FALSE, 0);
+}
+
+static gint
+lock_stats_compare (const GstLockStatsEntry * a, const GstLockStatsEntry * b)
+{
+  if (a->wait_total != b->wait_total)
+    return a->wait_total > b->wait_total ? -1 : 1;
+  if (a->hold_total != b->hold_total)
+    return a->hold_total > b->hold_total ? -1 : 1;
+  return 0;
+}
+
+/**
+ * _gst_lock_stats_dump:
+ *
+ * Print the statistics of all locks that were taken, the locks that were
+ * waited for the longest first.
+ */
+void
+_gst_lock_stats_dump (void)
+{
+  GList *list, *walk;
+
+  if (!_gst_lock_stats_enabled)
+    return;
+
+  g_mutex_lock (&stats_lock);
+  list = g_list_concat (g_hash_table_get_values (stats_entries),
+      g_list_copy (stats_retired));
+  list = g_list_sort (list, (GCompareFunc) lock_stats_compare);
+
+  g_print ("%-40.40s %-6s %10s %10s %14s %14s %14s %14s\n", "lock", "kind",
+      "acquired", "contended", "wait total ns", "wait max ns",
+      "hold total ns", "hold max ns");
+  for (walk = list; walk; walk = walk->next) {
+    GstLockStatsEntry *e = walk->data;
+    gchar *name;
+
+    name = e->name ? g_strdup (e->name) : g_strdup_printf ("%p", e->lock);
+    g_print ("%-40.40s %-6s %10" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT
+        " %14" G_GUINT64_FORMAT " %14" G_GUINT64_FORMAT " %14"
+        G_GUINT64_FORMAT " %14" G_GUINT64_FORMAT "\n", name,
+        kind_names[e->kind], e->acquired, e->contended, e->wait_total,
+        e->wait_max, e->hold_total, e->hold_max);
+    g_free (name);
+  }
+  g_mutex_unlock (&stats_lock);
+
+  g_list_free (list);
+}
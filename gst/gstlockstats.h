@@ -0,0 +1,113 @@
+/* GStreamer
+ *
+ * gstlockstats.h: wait and hold time statistics of locks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_LOCK_STATS_H__
+#define __GST_LOCK_STATS_H__
+
+#include <glib.h>
+#include <gst/gstconfig.h>
+
+G_BEGIN_DECLS
+
+/* The statistics are only compiled in with --enable-lock-stats, they are
+ * then recorded when the GST_LOCK_STATS environment variable is set and
+ * printed when the process exits. Without the configure option the macros
+ * below map directly to the GLib functions. */
+
+typedef enum {
+  GST_LOCK_STATS_OBJECT,
+  GST_LOCK_STATS_STREAM,
+  GST_LOCK_STATS_QUEUE
+} GstLockStatsKind;
+
+GST_EXPORT gboolean _gst_lock_stats_enabled;
+
+G_GNUC_INTERNAL void _priv_gst_lock_stats_initialize (void);
+
+void     _gst_lock_stats_mutex_lock        (GMutex * mutex, gpointer object,
+                                            GstLockStatsKind kind);
+gboolean _gst_lock_stats_mutex_trylock     (GMutex * mutex, gpointer object,
+                                            GstLockStatsKind kind);
+void     _gst_lock_stats_mutex_unlock      (GMutex * mutex);
+void     _gst_lock_stats_rec_mutex_lock    (GRecMutex * mutex, gpointer object,
+                                            GstLockStatsKind kind);
+gboolean _gst_lock_stats_rec_mutex_trylock (GRecMutex * mutex, gpointer object,
+                                            GstLockStatsKind kind);
+void     _gst_lock_stats_rec_mutex_unlock  (GRecMutex * mutex);
+void     _gst_lock_stats_cond_wait         (GCond * cond, GMutex * mutex,
+                                            gpointer object,
+                                            GstLockStatsKind kind);
+void     _gst_lock_stats_dump              (void);
+
+#ifdef GST_ENABLE_LOCK_STATS
+
+#define GST_LOCK_STATS_MUTEX_LOCK(m,obj,kind) G_STMT_START {            \
+  if (G_UNLIKELY (_gst_lock_stats_enabled))                             \
+    _gst_lock_stats_mutex_lock (m, obj, kind);                          \
+  else                                                                  \
+    g_mutex_lock (m);                                                   \
+} G_STMT_END
+#define GST_LOCK_STATS_MUTEX_TRYLOCK(m,obj,kind)                        \
+  (G_UNLIKELY (_gst_lock_stats_enabled) ?                               \
+      _gst_lock_stats_mutex_trylock (m, obj, kind) : g_mutex_trylock (m))
+#define GST_LOCK_STATS_MUTEX_UNLOCK(m) G_STMT_START {                   \
+  if (G_UNLIKELY (_gst_lock_stats_enabled))                             \
+    _gst_lock_stats_mutex_unlock (m);                                   \
+  else                                                                  \
+    g_mutex_unlock (m);                                                 \
+} G_STMT_END
+#define GST_LOCK_STATS_REC_MUTEX_LOCK(m,obj,kind) G_STMT_START {        \
+  if (G_UNLIKELY (_gst_lock_stats_enabled))                             \
+    _gst_lock_stats_rec_mutex_lock (m, obj, kind);                      \
+  else                                                                  \
+    g_rec_mutex_lock (m);                                               \
+} G_STMT_END
+#define GST_LOCK_STATS_REC_MUTEX_TRYLOCK(m,obj,kind)                    \
+  (G_UNLIKELY (_gst_lock_stats_enabled) ?                               \
+      _gst_lock_stats_rec_mutex_trylock (m, obj, kind) :                \
+      g_rec_mutex_trylock (m))
+#define GST_LOCK_STATS_REC_MUTEX_UNLOCK(m) G_STMT_START {               \
+  if (G_UNLIKELY (_gst_lock_stats_enabled))                             \
+    _gst_lock_stats_rec_mutex_unlock (m);                               \
+  else                                                                  \
+    g_rec_mutex_unlock (m);                                             \
+} G_STMT_END
+#define GST_LOCK_STATS_COND_WAIT(c,m,obj,kind) G_STMT_START {           \
+  if (G_UNLIKELY (_gst_lock_stats_enabled))                             \
+    _gst_lock_stats_cond_wait (c, m, obj, kind);                        \
+  else                                                                  \
+    g_cond_wait (c, m);                                                 \
+} G_STMT_END
+
+#else /* GST_ENABLE_LOCK_STATS */
+
+#define GST_LOCK_STATS_MUTEX_LOCK(m,obj,kind)        g_mutex_lock (m)
+#define GST_LOCK_STATS_MUTEX_TRYLOCK(m,obj,kind)     g_mutex_trylock (m)
+#define GST_LOCK_STATS_MUTEX_UNLOCK(m)               g_mutex_unlock (m)
+#define GST_LOCK_STATS_REC_MUTEX_LOCK(m,obj,kind)    g_rec_mutex_lock (m)
+#define GST_LOCK_STATS_REC_MUTEX_TRYLOCK(m,obj,kind) g_rec_mutex_trylock (m)
+#define GST_LOCK_STATS_REC_MUTEX_UNLOCK(m)           g_rec_mutex_unlock (m)
+#define GST_LOCK_STATS_COND_WAIT(c,m,obj,kind)       g_cond_wait (c, m)
+
+#endif /* GST_ENABLE_LOCK_STATS */
+
+G_END_DECLS
+
+#endif /* __GST_LOCK_STATS_H__ */
@@ -88,6 +88,8 @@ _gst_memory_free (GstMemory * mem)
   if (mem->parent) {
     gst_memory_unlock (mem->parent, GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (mem->parent);
+  } else if (mem->allocator) {
+    _priv_gst_allocator_account (mem->allocator, -(gssize) mem->maxsize);
   }
 
   gst_allocator_free (mem->allocator, mem);
@@ -121,6 +123,9 @@ gst_memory_init (GstMemory * mem, GstMemoryFlags flags,
   if (parent) {
     gst_memory_lock (parent, GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_ref (parent);
+  } else if (allocator) {
+    /* only the memory that owns the data is counted */
+    _priv_gst_allocator_account (allocator, maxsize);
   }
   mem->parent = parent;
   mem->maxsize = maxsize;
@@ -971,6 +971,72 @@ gst_message_has_name (GstMessage * message, const gchar * name)
   return gst_structure_has_name (structure, name);
 }
 
+/**
+ * gst_message_writable_structure:
+ * @message: a writable #GstMessage.
+ *
+ * Get a writable version of the structure of @message, for example to
+ * update the fields of a message that is reused with gst_message_reuse().
+ *
+ * Returns: (transfer none): The structure of the message. The structure is
+ * still owned by the message, which means that you should not free it and
+ * that the pointer becomes invalid when you free the message. This function
+ * checks if @message is writable.
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_message_writable_structure (GstMessage * message)
+{
+  g_return_val_if_fail (GST_IS_MESSAGE (message), NULL);
+  g_return_val_if_fail (gst_message_is_writable (message), NULL);
+
+  return GST_MESSAGE_STRUCTURE (message);
+}
+
+/**
+ * gst_message_reuse:
+ * @message: a #GstMessage
+ *
+ * Prepares @message to be posted again.  Elements that post the same kind of
+ * message many times per second can keep a ref to the message they posted
+ * and reuse it once the bus released it, instead of creating a new message
+ * and structure every time:
+ * |[
+ * if (self->msg == NULL || !gst_message_reuse (self->msg)) {
+ *   if (self->msg)
+ *     gst_message_unref (self->msg);
+ *   self->msg = gst_message_new_element (GST_OBJECT (self),
+ *       gst_structure_new ("level", "peak", G_TYPE_DOUBLE, peak, NULL));
+ * } else {
+ *   gst_structure_id_set_double (gst_message_writable_structure (self->msg),
+ *       peak_quark, peak);
+ * }
+ * gst_element_post_message (GST_ELEMENT (self), gst_message_ref (self->msg));
+ * ]|
+ *
+ * The message gets a new sequence number and its timestamp is cleared. The
+ * fields of the structure keep their values.
+ *
+ * Returns: %TRUE when @message can be posted again, %FALSE when it is still
+ * in use elsewhere and a new message has to be created.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_message_reuse (GstMessage * message)
+{
+  g_return_val_if_fail (GST_IS_MESSAGE (message), FALSE);
+
+  if (!gst_message_is_writable (message))
+    return FALSE;
+
+  GST_MESSAGE_TIMESTAMP (message) = GST_CLOCK_TIME_NONE;
+  GST_MESSAGE_SEQNUM (message) = gst_util_seqnum_next ();
+
+  return TRUE;
+}
+
 /**
  * gst_message_parse_tag:
  * @message: A valid #GstMessage of type GST_MESSAGE_TAG.
@@ -1046,13 +1112,17 @@ void
 gst_message_set_buffering_stats (GstMessage * message, GstBufferingMode mode,
     gint avg_in, gint avg_out, gint64 buffering_left)
 {
+  GstStructure *structure;
+
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_BUFFERING);
 
-  gst_structure_id_set (GST_MESSAGE_STRUCTURE (message),
-      GST_QUARK (BUFFERING_MODE), GST_TYPE_BUFFERING_MODE, mode,
-      GST_QUARK (AVG_IN_RATE), G_TYPE_INT, avg_in,
-      GST_QUARK (AVG_OUT_RATE), G_TYPE_INT, avg_out,
-      GST_QUARK (BUFFERING_LEFT), G_TYPE_INT64, buffering_left, NULL);
+  structure = GST_MESSAGE_STRUCTURE (message);
+  gst_structure_id_set_enum (structure, GST_QUARK (BUFFERING_MODE),
+      GST_TYPE_BUFFERING_MODE, mode);
+  gst_structure_id_set_int (structure, GST_QUARK (AVG_IN_RATE), avg_in);
+  gst_structure_id_set_int (structure, GST_QUARK (AVG_OUT_RATE), avg_out);
+  gst_structure_id_set_int64 (structure, GST_QUARK (BUFFERING_LEFT),
+      buffering_left);
 }
 
 /**
@@ -1864,10 +1934,9 @@ gst_message_set_qos_values (GstMessage * message, gint64 jitter,
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
   structure = GST_MESSAGE_STRUCTURE (message);
-  gst_structure_id_set (structure,
-      GST_QUARK (JITTER), G_TYPE_INT64, jitter,
-      GST_QUARK (PROPORTION), G_TYPE_DOUBLE, proportion,
-      GST_QUARK (QUALITY), G_TYPE_INT, quality, NULL);
+  gst_structure_id_set_int64 (structure, GST_QUARK (JITTER), jitter);
+  gst_structure_id_set_double (structure, GST_QUARK (PROPORTION), proportion);
+  gst_structure_id_set_int (structure, GST_QUARK (QUALITY), quality);
 }
 
 /**
@@ -1899,10 +1968,10 @@ gst_message_set_qos_stats (GstMessage * message, GstFormat format,
   g_return_if_fail (GST_MESSAGE_TYPE (message) == GST_MESSAGE_QOS);
 
   structure = GST_MESSAGE_STRUCTURE (message);
-  gst_structure_id_set (structure,
-      GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
-      GST_QUARK (PROCESSED), G_TYPE_UINT64, processed,
-      GST_QUARK (DROPPED), G_TYPE_UINT64, dropped, NULL);
+  gst_structure_id_set_enum (structure, GST_QUARK (FORMAT), GST_TYPE_FORMAT,
+      format);
+  gst_structure_id_set_uint64 (structure, GST_QUARK (PROCESSED), processed);
+  gst_structure_id_set_uint64 (structure, GST_QUARK (DROPPED), dropped);
 }
 
 /**
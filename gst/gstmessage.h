@@ -407,8 +407,12 @@ GstMessage *    gst_message_new_custom          (GstMessageType type,
 const GstStructure *
                 gst_message_get_structure       (GstMessage *message);
 
+GstStructure *  gst_message_writable_structure  (GstMessage *message);
+
 gboolean        gst_message_has_name            (GstMessage *message, const gchar *name);
 
+gboolean        gst_message_reuse               (GstMessage *message);
+
 /* identifiers for events and messages */
 guint32         gst_message_get_seqnum          (GstMessage *message);
 void            gst_message_set_seqnum          (GstMessage *message, guint32 seqnum);
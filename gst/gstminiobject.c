@@ -57,8 +57,13 @@
 #include "gst/gst_private.h"
 #include "gst/gstminiobject.h"
 #include "gst/gstinfo.h"
+#include "gst/gsttracerutils.h"
 #include <gobject/gvaluecollector.h>
 
+/* the inline fast paths of the header call these */
+#undef gst_mini_object_ref
+#undef gst_mini_object_unref
+
 #ifndef GST_DISABLE_TRACE
 #include "gsttrace.h"
 static GstAllocTrace *_gst_mini_object_trace;
@@ -134,6 +139,8 @@ gst_mini_object_init (GstMiniObject * mini_object, guint flags, GType type,
 #ifndef GST_DISABLE_TRACE
   _gst_alloc_trace_new (_gst_mini_object_trace, mini_object);
 #endif
+
+  GST_TRACER_MINI_OBJECT_CREATED (mini_object);
 }
 
 /**
@@ -463,6 +470,8 @@ gst_mini_object_unref (GstMiniObject * mini_object)
 #ifndef GST_DISABLE_TRACE
       _gst_alloc_trace_free (_gst_mini_object_trace, mini_object);
 #endif
+      GST_TRACER_MINI_OBJECT_DESTROYED (mini_object);
+
       if (mini_object->free)
         mini_object->free (mini_object);
     }
@@ -24,6 +24,7 @@
 #define __GST_MINI_OBJECT_H__
 
 #include <gst/gstconfig.h>
+#include <gst/gstinfo.h>
 
 #include <glib-object.h>
 
@@ -229,6 +230,40 @@ void            gst_mini_object_init (GstMiniObject *mini_object,
 GstMiniObject * gst_mini_object_ref		(GstMiniObject *mini_object);
 void            gst_mini_object_unref		(GstMiniObject *mini_object);
 
+/* The ref and the unrefs that do not drop the last reference are done
+ * inline. The functions are still called for the last unref and when the
+ * debug log could trace the refcount. */
+static inline GstMiniObject *
+_gst_mini_object_ref_inline (GstMiniObject * mini_object)
+{
+  if (G_UNLIKELY (mini_object == NULL || GST_LEVEL_TRACE <= _gst_debug_min))
+    return (gst_mini_object_ref) (mini_object);
+
+  g_atomic_int_inc (&mini_object->refcount);
+  return mini_object;
+}
+
+static inline void
+_gst_mini_object_unref_inline (GstMiniObject * mini_object)
+{
+  if (G_LIKELY (mini_object != NULL && GST_LEVEL_TRACE > _gst_debug_min)) {
+    gint old = g_atomic_int_get (&mini_object->refcount);
+
+    if (G_LIKELY (old > 1) &&
+        g_atomic_int_compare_and_exchange (&mini_object->refcount, old,
+            old - 1))
+      return;
+  }
+  (gst_mini_object_unref) (mini_object);
+}
+
+#ifndef GST_MINI_OBJECT_DISABLE_INLINES
+#define gst_mini_object_ref(mini_object) \
+    _gst_mini_object_ref_inline (mini_object)
+#define gst_mini_object_unref(mini_object) \
+    _gst_mini_object_unref_inline (mini_object)
+#endif
+
 void            gst_mini_object_weak_ref        (GstMiniObject *object,
 					         GstMiniObjectNotify notify,
 					         gpointer data);
@@ -421,6 +421,11 @@ gst_object_finalize (GObject * object)
  * top-level bin to catch property-change notifications for all contained
  * elements.
  *
+ * Properties flagged with GST_PARAM_HIGH_FREQUENCY stop propagating at the
+ * first parent with GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY, usually the
+ * pipeline. Properties that are changed together while the notifications
+ * are frozen with g_object_freeze_notify() are dispatched in one go.
+ *
  * MT safe.
  */
 static void
@@ -428,6 +433,7 @@ gst_object_dispatch_properties_changed (GObject * object,
     guint n_pspecs, GParamSpec ** pspecs)
 {
   GstObject *gst_object, *parent, *old_parent;
+  gboolean blocked = FALSE;
   guint i;
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *name = NULL;
@@ -451,7 +457,14 @@ gst_object_dispatch_properties_changed (GObject * object,
   /* now let the parent dispatch those, too */
   parent = gst_object_get_parent (gst_object);
   while (parent) {
+    if (G_UNLIKELY (GST_OBJECT_FLAG_IS_SET (parent,
+                GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY)))
+      blocked = TRUE;
+
     for (i = 0; i < n_pspecs; i++) {
+      if (blocked && (pspecs[i]->flags & GST_PARAM_HIGH_FREQUENCY))
+        continue;
+
       GST_CAT_LOG_OBJECT (GST_CAT_PROPERTIES, parent,
           "deep notification from %s (%s)", debug_name, pspecs[i]->name);
 
@@ -41,12 +41,16 @@ G_BEGIN_DECLS
 
 /**
  * GstObjectFlags:
+ * @GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY: don't emit the deep-notify
+ *     signal on this object and its parents for properties of the children
+ *     that have the #GST_PARAM_HIGH_FREQUENCY flag. Since 1.2.
  * @GST_OBJECT_FLAG_LAST: subclasses can add additional flags starting from this flag
  *
  * The standard flags that an gstobject may have.
  */
 typedef enum
 {
+  GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY = (1<<0),
   /* padding */
   GST_OBJECT_FLAG_LAST = (1<<4)
 } GstObjectFlags;
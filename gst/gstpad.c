@@ -92,11 +92,13 @@
 
 #include "gstpad.h"
 #include "gstpadtemplate.h"
+#include "gstghostpad.h"
 #include "gstenumtypes.h"
 #include "gstutils.h"
 #include "gstinfo.h"
 #include "gsterror.h"
 #include "gstvalue.h"
+#include "gsttracerutils.h"
 #include "glib-compat-private.h"
 
 GST_DEBUG_CATEGORY_STATIC (debug_dataflow);
@@ -140,6 +142,16 @@ struct _GstPadPrivate
   gint using;
   guint probe_list_cookie;
   guint probe_cookie;
+
+  /* the types of all installed probes, with LOCK */
+  GstPadProbeType probe_mask;
+
+  /* the last filtered result of the default caps query, with LOCK. The
+   * filter and the unfiltered caps are reffed so that their pointers are not
+   * reused by other caps while the result is cached. */
+  GstCaps *query_caps_filter;
+  GstCaps *query_caps_source;
+  GstCaps *query_caps_result;
 };
 
 typedef struct
@@ -485,9 +497,11 @@ schedule_events (GstPad * srcpad, GstPad * sinkpad)
 typedef gboolean (*PadEventFunction) (GstPad * pad, PadEvent * ev,
     gpointer user_data);
 
-/* should be called with pad LOCK */
+/* should be called with pad LOCK. When @pending_only is set, events that
+ * were already received by the peer are skipped without calling @func */
 static void
-events_foreach (GstPad * pad, PadEventFunction func, gpointer user_data)
+events_foreach (GstPad * pad, gboolean pending_only, PadEventFunction func,
+    gpointer user_data)
 {
   guint i, len;
   GArray *events;
@@ -507,6 +521,11 @@ restart:
     if (G_UNLIKELY (ev->event == NULL))
       goto next;
 
+    /* only the events that changed since the last push need to be looked at,
+     * this avoids the ref/unref and callback for all the others */
+    if (pending_only && ev->received)
+      goto next;
+
     /* take aditional ref, func might release the lock */
     ev_ret.event = gst_event_ref (ev->event);
     ev_ret.received = ev->received;
@@ -623,6 +642,10 @@ gst_pad_finalize (GObject * object)
     gst_object_unref (task);
   }
 
+  gst_caps_replace (&pad->priv->query_caps_filter, NULL);
+  gst_caps_replace (&pad->priv->query_caps_source, NULL);
+  gst_caps_replace (&pad->priv->query_caps_result, NULL);
+
   if (pad->activatenotify)
     pad->activatenotify (pad->activatedata);
   if (pad->activatemodenotify)
@@ -1208,7 +1231,9 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* add the probe */
   g_hook_prepend (&pad->probes, hook);
-  pad->num_probes++;
+  pad->priv->probe_mask |= mask;
+  /* atomic, gst_pad_push_data() checks for probes without the lock */
+  g_atomic_int_inc (&pad->num_probes);
   /* incremenent cookie so that the new hook get's called */
   pad->priv->probe_list_cookie++;
 
@@ -1228,7 +1253,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* call the callback if we need to be called for idle callbacks */
   if ((mask & GST_PAD_PROBE_TYPE_IDLE) && (callback != NULL)) {
-    if (pad->priv->using > 0) {
+    if (g_atomic_int_get (&pad->priv->using) > 0) {
       /* the pad is in use, we can't signal the idle callback yet. Since we set the
        * flag above, the last thread to leave the push will do the callback. New
        * threads going into the push will block. */
@@ -1255,6 +1280,7 @@ static void
 cleanup_hook (GstPad * pad, GHook * hook)
 {
   GstPadProbeType type;
+  GHook *h;
 
   if (!G_HOOK_IS_VALID (hook))
     return;
@@ -1273,7 +1299,14 @@ cleanup_hook (GstPad * pad, GHook * hook)
     }
   }
   g_hook_destroy_link (&pad->probes, hook);
-  pad->num_probes--;
+  g_atomic_int_add (&pad->num_probes, -1);
+
+  /* collect the types of the remaining probes */
+  pad->priv->probe_mask = 0;
+  for (h = pad->probes.hooks; h; h = h->next) {
+    if (G_HOOK_IS_VALID (h))
+      pad->priv->probe_mask |= (h->flags >> G_HOOK_FLAG_USER_SHIFT);
+  }
 }
 
 /**
@@ -2626,6 +2659,68 @@ no_parent:
   }
 }
 
+typedef struct
+{
+  GstPad *pad;
+  GstPadForwardFunction forward;
+  gpointer user_data;
+  gboolean result;
+} ForwardData;
+
+static gboolean
+pad_forward_foreach_func (GstElement * element, GstPad * intpad,
+    ForwardData * data)
+{
+  GST_LOG_OBJECT (data->pad, "calling forward function on pad %s:%s",
+      GST_DEBUG_PAD_NAME (intpad));
+  data->result = data->forward (intpad, data->user_data);
+
+  /* stop when the forward function returned TRUE */
+  return !data->result;
+}
+
+/* the pads of the default internal links can be walked without creating an
+ * iterator, returns FALSE when @pad uses another internal links function */
+static gboolean
+pad_forward_default (GstPad * pad, GstPadForwardFunction forward,
+    gpointer user_data, gboolean * result)
+{
+  GstObject *parent;
+  ForwardData data;
+
+  GST_OBJECT_LOCK (pad);
+  if (GST_PAD_ITERINTLINKFUNC (pad) != gst_pad_iterate_internal_links_default)
+    goto not_default;
+  parent = GST_OBJECT_PARENT (pad);
+  if (parent == NULL || !GST_IS_ELEMENT (parent))
+    goto not_default;
+  gst_object_ref (parent);
+  GST_OBJECT_UNLOCK (pad);
+
+  data.pad = pad;
+  data.forward = forward;
+  data.user_data = user_data;
+  data.result = FALSE;
+
+  if (GST_PAD_IS_SRC (pad))
+    gst_element_foreach_sink_pad (GST_ELEMENT_CAST (parent),
+        (GstElementForeachPadFunc) pad_forward_foreach_func, &data);
+  else
+    gst_element_foreach_src_pad (GST_ELEMENT_CAST (parent),
+        (GstElementForeachPadFunc) pad_forward_foreach_func, &data);
+
+  gst_object_unref (parent);
+  *result = data.result;
+
+  return TRUE;
+
+not_default:
+  {
+    GST_OBJECT_UNLOCK (pad);
+    return FALSE;
+  }
+}
+
 /**
  * gst_pad_forward:
  * @pad: a #GstPad
@@ -2650,6 +2745,9 @@ gst_pad_forward (GstPad * pad, GstPadForwardFunction forward,
   GValue item = { 0, };
   GList *pushed_pads = NULL;
 
+  if (pad_forward_default (pad, forward, user_data, &result))
+    return result;
+
   iter = gst_pad_iterate_internal_links (pad);
 
   if (!iter)
@@ -2872,21 +2970,43 @@ gst_pad_query_caps_default (GstPad * pad, GstQuery * query)
   result = GST_CAPS_ANY;
 
 filter_done_unlock:
+  /* the same filter on the same caps gives the same result, the caps are
+   * immutable while they are reffed by the cache */
+  if (filter && filter == pad->priv->query_caps_filter &&
+      result == pad->priv->query_caps_source) {
+    result = gst_caps_ref (pad->priv->query_caps_result);
+    GST_OBJECT_UNLOCK (pad);
+    GST_CAT_DEBUG_OBJECT (GST_CAT_CAPS, pad, "cached result %p %"
+        GST_PTR_FORMAT, result, result);
+    goto have_result;
+  }
+  /* keep the caps while we don't have the lock */
+  result = gst_caps_ref (result);
   GST_OBJECT_UNLOCK (pad);
 
   /* run the filter on the result */
   if (filter) {
+    GstCaps *source = result;
+
     GST_CAT_DEBUG_OBJECT (GST_CAT_CAPS, pad,
         "using caps %p %" GST_PTR_FORMAT " with filter %p %"
-        GST_PTR_FORMAT, result, result, filter, filter);
-    result = gst_caps_intersect_full (filter, result, GST_CAPS_INTERSECT_FIRST);
+        GST_PTR_FORMAT, source, source, filter, filter);
+    result = gst_caps_intersect_full (filter, source, GST_CAPS_INTERSECT_FIRST);
     GST_CAT_DEBUG_OBJECT (GST_CAT_CAPS, pad, "result %p %" GST_PTR_FORMAT,
         result, result);
+
+    GST_OBJECT_LOCK (pad);
+    gst_caps_replace (&pad->priv->query_caps_filter, filter);
+    gst_caps_replace (&pad->priv->query_caps_source, source);
+    gst_caps_replace (&pad->priv->query_caps_result, result);
+    GST_OBJECT_UNLOCK (pad);
+    gst_caps_unref (source);
   } else {
     GST_CAT_DEBUG_OBJECT (GST_CAT_CAPS, pad,
         "using caps %p %" GST_PTR_FORMAT, result, result);
-    result = gst_caps_ref (result);
   }
+
+have_result:
   gst_query_set_caps_result (query, result);
   gst_caps_unref (result);
 
@@ -2949,6 +3069,11 @@ gst_pad_query_default (GstPad * pad, GstObject * parent, GstQuery * query)
       ret = gst_pad_query_caps_default (pad, query);
       forward = FALSE;
       break;
+    case GST_QUERY_MEMORY_USAGE:
+      /* every element is asked by its bin, forwarding would count the
+       * peers twice */
+      forward = FALSE;
+      break;
     case GST_QUERY_POSITION:
     case GST_QUERY_SEEKING:
     case GST_QUERY_FORMATS:
@@ -3074,10 +3199,18 @@ no_match:
   }
 }
 
+/* a quick check if any of the installed probes can match @type, it needs
+ * both one of the data types and one of the scheduling types. When it fails,
+ * calling the probes would not call any callback and let the item pass */
+#define PROBE_MAY_MATCH(pad,type)                               \
+  (G_UNLIKELY (pad->num_probes) &&                              \
+   (pad->priv->probe_mask & (type) & GST_PAD_PROBE_TYPE_ALL_BOTH) && \
+   (pad->priv->probe_mask & (type) & GST_PAD_PROBE_TYPE_SCHEDULING))
+
 /* a probe that does not take or return any data */
 #define PROBE_NO_DATA(pad,mask,label,defaultval)                \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (PROBE_MAY_MATCH (pad, mask)) {				\
       /* pass NULL as the data item */                          \
       GstPadProbeInfo info = { mask, 0, NULL, 0, 0 };           \
       ret = do_probe_callbacks (pad, &info, defaultval);	\
@@ -3088,7 +3221,7 @@ no_match:
 
 #define PROBE_FULL(pad,mask,data,offs,size,label)               \
   G_STMT_START {						\
-    if (G_UNLIKELY (pad->num_probes)) {				\
+    if (PROBE_MAY_MATCH (pad, mask)) {				\
       /* pass the data item */                                  \
       GstPadProbeInfo info = { mask, 0, data, offs, size };     \
       ret = do_probe_callbacks (pad, &info, GST_FLOW_OK);	\
@@ -3331,7 +3464,7 @@ check_sticky (GstPad * pad)
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
     GST_DEBUG_OBJECT (pad, "pushing all sticky events");
-    events_foreach (pad, push_sticky, &data);
+    events_foreach (pad, TRUE, push_sticky, &data);
 
     /* If there's an EOS event we must push it downstream
      * even if sending a previous sticky event failed.
@@ -3416,7 +3549,9 @@ gst_pad_query (GstPad * pad, GstQuery * query)
   if ((func = GST_PAD_QUERYFUNC (pad)) == NULL)
     goto no_func;
 
+  GST_TRACER_PAD_QUERY_PRE (pad, query);
   res = func (pad, parent, query);
+  GST_TRACER_PAD_QUERY_POST (pad, query, res);
 
   RELEASE_PARENT (parent);
 
@@ -3652,7 +3787,9 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
         "calling chainfunction &%s with buffer %" GST_PTR_FORMAT,
         GST_DEBUG_FUNCPTR_NAME (chainfunc), GST_BUFFER (data));
 
+    GST_TRACER_PAD_CHAIN_PRE (pad, GST_BUFFER_CAST (data));
     ret = chainfunc (pad, parent, GST_BUFFER_CAST (data));
+    GST_TRACER_PAD_CHAIN_POST (pad, ret);
 
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainfunction &%s with buffer %p, returned %s",
@@ -3667,7 +3804,9 @@ gst_pad_chain_data_unchecked (GstPad * pad, GstPadProbeType type, void *data)
         "calling chainlistfunction &%s",
         GST_DEBUG_FUNCPTR_NAME (chainlistfunc));
 
+    GST_TRACER_PAD_CHAIN_LIST_PRE (pad, GST_BUFFER_LIST_CAST (data));
     ret = chainlistfunc (pad, parent, GST_BUFFER_LIST_CAST (data));
+    GST_TRACER_PAD_CHAIN_POST (pad, ret);
 
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "called chainlistfunction &%s, returned %s",
@@ -3832,18 +3971,143 @@ gst_pad_chain_list (GstPad * pad, GstBufferList * list)
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
 
+/* leave a push on @pad. We only need the lock again when we are the last
+ * thread to leave the push and there might be idle probes to call. This pairs
+ * with the atomic operations in gst_pad_add_probe() so that either we see the
+ * new probe or it sees that the pad is idle. */
+static void
+pad_leave_push (GstPad * pad, GstFlowReturn ret)
+{
+  if (G_LIKELY (!g_atomic_int_dec_and_test (&pad->priv->using)) ||
+      G_LIKELY (g_atomic_int_get (&pad->num_probes) == 0))
+    return;
+
+  GST_OBJECT_LOCK (pad);
+  if (g_atomic_int_get (&pad->priv->using) == 0) {
+    /* pad is not active anymore, trigger idle callbacks */
+    PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
+        probe_stopped, ret);
+  }
+probe_stopped:
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/* the maximum number of ghost pads that are skipped in one push */
+#define MAX_TRANSPARENT_PROXIES 16
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+#define TRACERS_ENABLED G_UNLIKELY (_priv_tracer_enabled)
+#else
+#define TRACERS_ENABLED FALSE
+#endif
+
+/* A ghost pad, or the internal pad of a source ghost pad, that uses the
+ * default proxy chain function and has no probes installed only forwards
+ * the data to its internal pad, which pushes it to its peer again. Skip
+ * these pads and return the pad that will really handle the data so that
+ * crossing a bin boundary does not cost two extra pushes.
+ *
+ * Takes ownership of @peer and returns a new ref. The skipped pads keep
+ * their ref and STREAM_LOCK, like the chain function would, so that flushing
+ * or deactivating them waits for the data; they are returned in
+ * @skipped_peers to be released with release_transparent_proxies(). The
+ * internal pads that were skipped are marked as used, like a regular push
+ * would do, and are returned in @skipped. Must be called without locks. */
+static GstPad *
+skip_transparent_proxies (GstPad * peer, GstPadProbeType type,
+    GstPad ** skipped_peers, GstPad ** skipped, guint * n_skipped)
+{
+  GstPad *internal, *target;
+  gboolean transparent;
+
+  while (*n_skipped < MAX_TRANSPARENT_PROXIES) {
+    if (type & GST_PAD_PROBE_TYPE_BUFFER) {
+      if (GST_PAD_CHAINFUNC (peer) != gst_proxy_pad_chain_default)
+        break;
+    } else if (GST_PAD_CHAINLISTFUNC (peer) != gst_proxy_pad_chain_list_default)
+      break;
+
+    /* checked with the stream lock held, a flush or deactivation that
+     * starts later waits for us */
+    GST_PAD_STREAM_LOCK (peer);
+    GST_OBJECT_LOCK (peer);
+    transparent = !(GST_OBJECT_FLAGS (peer) & (GST_PAD_FLAG_FLUSHING |
+            GST_PAD_FLAG_EOS)) && GST_PAD_MODE (peer) == GST_PAD_MODE_PUSH &&
+        peer->num_probes == 0;
+    GST_OBJECT_UNLOCK (peer);
+    if (!transparent) {
+      GST_PAD_STREAM_UNLOCK (peer);
+      break;
+    }
+
+    internal = GST_PAD_CAST (gst_proxy_pad_get_internal (GST_PROXY_PAD (peer)));
+    if (internal == NULL) {
+      GST_PAD_STREAM_UNLOCK (peer);
+      break;
+    }
+
+    /* the internal pad must not have anything to do before pushing */
+    GST_OBJECT_LOCK (internal);
+    if (G_UNLIKELY (GST_OBJECT_FLAGS (internal) & (GST_PAD_FLAG_FLUSHING |
+                GST_PAD_FLAG_EOS | GST_PAD_FLAG_PENDING_EVENTS)) ||
+        GST_PAD_MODE (internal) != GST_PAD_MODE_PUSH ||
+        internal->num_probes != 0 ||
+        (target = GST_PAD_PEER (internal)) == NULL) {
+      GST_OBJECT_UNLOCK (internal);
+      gst_object_unref (internal);
+      GST_PAD_STREAM_UNLOCK (peer);
+      break;
+    }
+    gst_object_ref (target);
+    g_atomic_int_inc (&internal->priv->using);
+    GST_OBJECT_UNLOCK (internal);
+
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, peer,
+        "skipping transparent proxy pad, pushing to %s:%s",
+        GST_DEBUG_PAD_NAME (target));
+
+    skipped_peers[*n_skipped] = peer;
+    skipped[(*n_skipped)++] = internal;
+    peer = target;
+  }
+  return peer;
+}
+
+/* release the pads of skip_transparent_proxies() after the data was
+ * handled, in the reverse order */
+static void
+release_transparent_proxies (GstPad ** skipped_peers, GstPad ** skipped,
+    guint n_skipped, GstFlowReturn ret)
+{
+  while (n_skipped > 0) {
+    GstPad *internal = skipped[--n_skipped];
+    GstPad *peer = skipped_peers[n_skipped];
+
+    pad_leave_push (internal, ret);
+    gst_object_unref (internal);
+    GST_PAD_STREAM_UNLOCK (peer);
+    gst_object_unref (peer);
+  }
+}
+
 static GstFlowReturn
 gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 {
   GstPad *peer;
   GstFlowReturn ret;
+  GstPad *skipped_peers[MAX_TRANSPARENT_PROXIES];
+  GstPad *skipped[MAX_TRANSPARENT_PROXIES];
+  guint n_skipped = 0;
 
   GST_OBJECT_LOCK (pad);
-  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
-    goto flushing;
+  /* in the steady state none of these flags is set, check them all at once */
+  if (G_UNLIKELY (GST_OBJECT_FLAGS (pad) & (GST_PAD_FLAG_FLUSHING |
+              GST_PAD_FLAG_EOS))) {
+    if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+      goto flushing;
 
-  if (G_UNLIKELY (GST_PAD_IS_EOS (pad)))
     goto eos;
+  }
 
   if (G_UNLIKELY (GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH))
     goto wrong_mode;
@@ -3851,36 +4115,39 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   if (G_UNLIKELY ((ret = check_sticky (pad))) != GST_FLOW_OK)
     goto events_error;
 
-  /* do block probes */
-  PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_BLOCK, data, probe_stopped);
+  if (PROBE_MAY_MATCH (pad, type)) {
+    /* do block probes */
+    PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_BLOCK, data, probe_stopped);
 
-  /* recheck sticky events because the probe might have cause a relink */
-  if (G_UNLIKELY ((ret = check_sticky (pad))) != GST_FLOW_OK)
-    goto events_error;
+    /* recheck sticky events because the probe might have cause a relink */
+    if (G_UNLIKELY ((ret = check_sticky (pad))) != GST_FLOW_OK)
+      goto events_error;
 
-  /* do post-blocking probes */
-  PROBE_PUSH (pad, type, data, probe_stopped);
+    /* do post-blocking probes */
+    PROBE_PUSH (pad, type, data, probe_stopped);
+  }
 
   if (G_UNLIKELY ((peer = GST_PAD_PEER (pad)) == NULL))
     goto not_linked;
 
   /* take ref to peer pad before releasing the lock */
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
+  /* the tracers expect to see the pushes on the skipped pads */
+  if (G_UNLIKELY (GST_PAD_CHAINFUNC (peer) == gst_proxy_pad_chain_default ||
+          GST_PAD_CHAINLISTFUNC (peer) == gst_proxy_pad_chain_list_default)
+      && !TRACERS_ENABLED)
+    peer = skip_transparent_proxies (peer, type, skipped_peers, skipped,
+        &n_skipped);
+
   ret = gst_pad_chain_data_unchecked (peer, type, data);
 
   gst_object_unref (peer);
 
-  GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
-    /* pad is not active anymore, trigger idle callbacks */
-    PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
-        probe_stopped, ret);
-  }
-  GST_OBJECT_UNLOCK (pad);
+  release_transparent_proxies (skipped_peers, skipped, n_skipped, ret);
+  pad_leave_push (pad, ret);
 
   return ret;
 
@@ -3968,12 +4235,18 @@ not_linked:
 GstFlowReturn
 gst_pad_push (GstPad * pad, GstBuffer * buffer)
 {
+  GstFlowReturn res;
+
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
-  return gst_pad_push_data (pad,
+  GST_TRACER_PAD_PUSH_PRE (pad, buffer);
+  res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+  GST_TRACER_PAD_PUSH_POST (pad, res);
+
+  return res;
 }
 
 /**
@@ -4003,12 +4276,18 @@ gst_pad_push (GstPad * pad, GstBuffer * buffer)
 GstFlowReturn
 gst_pad_push_list (GstPad * pad, GstBufferList * list)
 {
+  GstFlowReturn res;
+
   g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
-  return gst_pad_push_data (pad,
+  GST_TRACER_PAD_PUSH_LIST_PRE (pad, list);
+  res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+  GST_TRACER_PAD_PUSH_POST (pad, res);
+
+  return res;
 }
 
 static GstFlowReturn
@@ -4282,16 +4561,17 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
     goto not_linked;
 
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
+  GST_TRACER_PAD_PULL_RANGE_PRE (pad, offset, size);
   ret = gst_pad_get_range_unchecked (peer, offset, size, &res_buf);
+  GST_TRACER_PAD_PULL_RANGE_POST (pad, res_buf, ret);
 
   gst_object_unref (peer);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PULL | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped_unref, ret);
@@ -4506,7 +4786,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
     goto not_linked;
 
   gst_object_ref (peerpad);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   GST_LOG_OBJECT (pad, "sending event %p (%s) to peerpad %" GST_PTR_FORMAT,
@@ -4522,8 +4802,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   gst_object_unref (peerpad);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         idle_probe_stopped, ret);
@@ -4597,6 +4876,8 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
   g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
   g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
 
+  GST_TRACER_PAD_PUSH_EVENT_PRE (pad, event);
+
   if (GST_PAD_IS_SRC (pad)) {
     if (G_UNLIKELY (!GST_EVENT_IS_DOWNSTREAM (event)))
       goto wrong_direction;
@@ -4654,6 +4935,9 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
   }
   GST_OBJECT_UNLOCK (pad);
 
+done:
+  GST_TRACER_PAD_PUSH_EVENT_POST (pad, res);
+
   return res;
 
   /* ERROR handling */
@@ -4662,27 +4946,27 @@ wrong_direction:
     g_warning ("pad %s:%s pushing %s event in wrong direction",
         GST_DEBUG_PAD_NAME (pad), GST_EVENT_TYPE_NAME (event));
     gst_event_unref (event);
-    return FALSE;
+    goto done;
   }
 unknown_direction:
   {
     g_warning ("pad %s:%s has invalid direction", GST_DEBUG_PAD_NAME (pad));
     gst_event_unref (event);
-    return FALSE;
+    goto done;
   }
 flushed:
   {
     GST_DEBUG_OBJECT (pad, "We're flushing");
     GST_OBJECT_UNLOCK (pad);
     gst_event_unref (event);
-    return FALSE;
+    goto done;
   }
 eos:
   {
     GST_DEBUG_OBJECT (pad, "We're EOS");
     GST_OBJECT_UNLOCK (pad);
     gst_event_unref (event);
-    return FALSE;
+    goto done;
   }
 }
 
@@ -5108,7 +5392,7 @@ gst_pad_sticky_events_foreach (GstPad * pad,
   data.user_data = user_data;
 
   GST_OBJECT_LOCK (pad);
-  events_foreach (pad, foreach_dispatch_function, &data);
+  events_foreach (pad, FALSE, foreach_dispatch_function, &data);
   GST_OBJECT_UNLOCK (pad);
 }
 
@@ -60,6 +60,18 @@ G_BEGIN_DECLS
  */
 #define GST_PARAM_MUTABLE_PLAYING  (1 << (G_PARAM_USER_SHIFT + 4))
 
+/**
+ * GST_PARAM_HIGH_FREQUENCY:
+ *
+ * Use this flag on GObject properties of GstObjects to indicate that they
+ * are notified very often, for example for each buffer. The deep-notify
+ * signal for these properties is not emitted on objects that have the
+ * #GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY flag set, nor on their parents.
+ *
+ * Since: 1.2
+ */
+#define GST_PARAM_HIGH_FREQUENCY  (1 << (G_PARAM_USER_SHIFT + 5))
+
 /**
  * GST_PARAM_USER_SHIFT:
  *
@@ -59,6 +59,18 @@ gst_parse_context_copy (const GstParseContext * context)
       g_queue_push_tail (&missing_copy, g_strdup ((const gchar *) l->data));
 
     ret->missing_elements = missing_copy.head;
+
+    if (context->factories) {
+      GHashTableIter iter;
+      gpointer key, value;
+
+      ret->factories = g_hash_table_new_full (g_str_hash, g_str_equal,
+          g_free, gst_object_unref);
+      g_hash_table_iter_init (&iter, context->factories);
+      while (g_hash_table_iter_next (&iter, &key, &value))
+        g_hash_table_insert (ret->factories, g_strdup (key),
+            gst_object_ref (value));
+    }
   }
 #endif
   return ret;
@@ -92,6 +104,11 @@ gst_parse_error_quark (void)
  * Allocates a parse context for use with gst_parse_launch_full() or
  * gst_parse_launchv_full().
  *
+ * A context can be reused to launch the same or similar descriptions
+ * several times. The element factories that were looked up are then kept in
+ * the context and later launches create the elements from them without
+ * searching the registry again.
+ *
  * Free-function: gst_parse_context_free
  *
  * Returns: (transfer full): a newly-allocated parse context. Free with
@@ -105,6 +122,7 @@ gst_parse_context_new (void)
 
   ctx = g_slice_new (GstParseContext);
   ctx->missing_elements = NULL;
+  ctx->factories = NULL;
 
   return ctx;
 #else
@@ -125,6 +143,8 @@ gst_parse_context_free (GstParseContext * context)
   if (context) {
     g_list_foreach (context->missing_elements, (GFunc) g_free, NULL);
     g_list_free (context->missing_elements);
+    if (context->factories)
+      g_hash_table_unref (context->factories);
     g_slice_free (GstParseContext, context);
   }
 #endif
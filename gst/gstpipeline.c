@@ -96,12 +96,16 @@ enum
 
 #define DEFAULT_DELAY           0
 #define DEFAULT_AUTO_FLUSH_BUS  TRUE
+#define DEFAULT_POSITION_CACHE_TIME 0
+#define DEFAULT_SNAPSHOT_TRACKING FALSE
 
 enum
 {
   PROP_0,
   PROP_DELAY,
-  PROP_AUTO_FLUSH_BUS
+  PROP_AUTO_FLUSH_BUS,
+  PROP_POSITION_CACHE_TIME,
+  PROP_SNAPSHOT_TRACKING
 };
 
 #define GST_PIPELINE_GET_PRIVATE(obj)  \
@@ -116,6 +120,22 @@ struct _GstPipelinePrivate
    * PLAYING*/
   GstClockTime last_start_time;
   gboolean update_clock;
+
+  /* answering TIME position queries without asking the sinks, with LOCK */
+  GstClockTime position_cache_time;
+  gint64 cached_position;
+  /* clock time of the cached position, NONE when invalid */
+  GstClockTime cached_at;
+  gboolean cached_playing;
+  /* incremented when the cache is invalidated, a position that was queried
+   * across an invalidation is not stored */
+  guint cache_cookie;
+  /* rate of the last seek */
+  gdouble seek_rate;
+
+  /* recording the allocation answers for gst_pipeline_snapshot(), with
+   * LOCK */
+  gboolean snapshot_tracking;
 };
 
 
@@ -130,6 +150,9 @@ static GstStateChangeReturn gst_pipeline_change_state (GstElement * element,
     GstStateChange transition);
 
 static void gst_pipeline_handle_message (GstBin * bin, GstMessage * message);
+static gboolean gst_pipeline_query (GstElement * element, GstQuery * query);
+static gboolean gst_pipeline_send_event (GstElement * element,
+    GstEvent * event);
 
 /* static guint gst_pipeline_signals[LAST_SIGNAL] = { 0 }; */
 
@@ -180,6 +203,39 @@ gst_pipeline_class_init (GstPipelineClass * klass)
           "from READY into NULL state", DEFAULT_AUTO_FLUSH_BUS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPipeline:position-cache-time:
+   *
+   * The maximum age of a cached position, see
+   * gst_pipeline_set_position_cache_time() for more information on this
+   * option.
+   *
+   * Since: 1.2
+   **/
+  g_object_class_install_property (gobject_class, PROP_POSITION_CACHE_TIME,
+      g_param_spec_uint64 ("position-cache-time", "Position cache time",
+          "Answer TIME position queries from a position that is at most "
+          "this old in nanoseconds (0 = disabled)", 0, G_MAXUINT64,
+          DEFAULT_POSITION_CACHE_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstPipeline:snapshot-tracking:
+   *
+   * Whether to record the answer of the allocation query on the links
+   * between the children of the pipeline, so that gst_pipeline_snapshot()
+   * can save it. Set it before the pipeline goes to PAUSED. Recording puts
+   * a probe on the source pads of the children, leave it disabled when no
+   * snapshot is taken.
+   *
+   * Since: 1.2
+   **/
+  g_object_class_install_property (gobject_class, PROP_SNAPSHOT_TRACKING,
+      g_param_spec_boolean ("snapshot-tracking", "Snapshot tracking",
+          "Record the allocation of the links for gst_pipeline_snapshot()",
+          DEFAULT_SNAPSHOT_TRACKING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->dispose = gst_pipeline_dispose;
 
   gst_element_class_set_static_metadata (gstelement_class, "Pipeline object",
@@ -191,6 +247,8 @@ gst_pipeline_class_init (GstPipelineClass * klass)
       GST_DEBUG_FUNCPTR (gst_pipeline_change_state);
   gstelement_class->provide_clock =
       GST_DEBUG_FUNCPTR (gst_pipeline_provide_clock_func);
+  gstelement_class->query = GST_DEBUG_FUNCPTR (gst_pipeline_query);
+  gstelement_class->send_event = GST_DEBUG_FUNCPTR (gst_pipeline_send_event);
   gstbin_class->handle_message =
       GST_DEBUG_FUNCPTR (gst_pipeline_handle_message);
 }
@@ -205,6 +263,9 @@ gst_pipeline_init (GstPipeline * pipeline)
   /* set default property values */
   pipeline->priv->auto_flush_bus = DEFAULT_AUTO_FLUSH_BUS;
   pipeline->delay = DEFAULT_DELAY;
+  pipeline->priv->position_cache_time = DEFAULT_POSITION_CACHE_TIME;
+  pipeline->priv->cached_at = GST_CLOCK_TIME_NONE;
+  pipeline->priv->seek_rate = 1.0;
 
   /* create and set a default bus */
   bus = gst_bus_new ();
@@ -247,6 +308,24 @@ gst_pipeline_set_property (GObject * object, guint prop_id,
     case PROP_AUTO_FLUSH_BUS:
       gst_pipeline_set_auto_flush_bus (pipeline, g_value_get_boolean (value));
       break;
+    case PROP_POSITION_CACHE_TIME:
+      gst_pipeline_set_position_cache_time (pipeline,
+          g_value_get_uint64 (value));
+      break;
+    case PROP_SNAPSHOT_TRACKING:
+    {
+      gboolean track = g_value_get_boolean (value);
+      gboolean changed;
+
+      GST_OBJECT_LOCK (pipeline);
+      changed = pipeline->priv->snapshot_tracking != track;
+      pipeline->priv->snapshot_tracking = track;
+      GST_OBJECT_UNLOCK (pipeline);
+
+      if (changed)
+        _priv_gst_snapshot_set_tracking (GST_ELEMENT_CAST (pipeline), track);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -266,12 +345,29 @@ gst_pipeline_get_property (GObject * object, guint prop_id,
     case PROP_AUTO_FLUSH_BUS:
       g_value_set_boolean (value, gst_pipeline_get_auto_flush_bus (pipeline));
       break;
+    case PROP_POSITION_CACHE_TIME:
+      g_value_set_uint64 (value,
+          gst_pipeline_get_position_cache_time (pipeline));
+      break;
+    case PROP_SNAPSHOT_TRACKING:
+      GST_OBJECT_LOCK (pipeline);
+      g_value_set_boolean (value, pipeline->priv->snapshot_tracking);
+      GST_OBJECT_UNLOCK (pipeline);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+/* with LOCK */
+static void
+invalidate_position_cache (GstPipeline * pipeline)
+{
+  pipeline->priv->cached_at = GST_CLOCK_TIME_NONE;
+  pipeline->priv->cache_cookie++;
+}
+
 /* set the start_time to 0, this will cause us to select a new base_time and
  * make the running_time start from 0 again. */
 static void
@@ -356,6 +452,12 @@ gst_pipeline_change_state (GstElement * element, GstStateChange transition)
   GstPipeline *pipeline = GST_PIPELINE_CAST (element);
   GstClock *clock;
 
+  GST_OBJECT_LOCK (element);
+  invalidate_position_cache (pipeline);
+  if (transition == GST_STATE_CHANGE_PAUSED_TO_READY)
+    pipeline->priv->seek_rate = 1.0;
+  GST_OBJECT_UNLOCK (element);
+
   switch (transition) {
     case GST_STATE_CHANGE_NULL_TO_READY:
       GST_OBJECT_LOCK (element);
@@ -540,6 +642,21 @@ gst_pipeline_handle_message (GstBin * bin, GstMessage * message)
 {
   GstPipeline *pipeline = GST_PIPELINE_CAST (bin);
 
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_ASYNC_DONE:
+    case GST_MESSAGE_EOS:
+    case GST_MESSAGE_SEGMENT_DONE:
+    case GST_MESSAGE_CLOCK_LOST:
+    case GST_MESSAGE_RESET_TIME:
+      /* the position jumps or stops advancing */
+      GST_OBJECT_LOCK (bin);
+      invalidate_position_cache (pipeline);
+      GST_OBJECT_UNLOCK (bin);
+      break;
+    default:
+      break;
+  }
+
   switch (GST_MESSAGE_TYPE (message)) {
     case GST_MESSAGE_RESET_TIME:
     {
@@ -572,6 +689,108 @@ gst_pipeline_handle_message (GstBin * bin, GstMessage * message)
   GST_BIN_CLASS (parent_class)->handle_message (bin, message);
 }
 
+static gboolean
+gst_pipeline_send_event (GstElement * element, GstEvent * event)
+{
+  GstPipeline *pipeline = GST_PIPELINE_CAST (element);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEEK) {
+    gdouble rate;
+
+    gst_event_parse_seek (event, &rate, NULL, NULL, NULL, NULL, NULL, NULL);
+
+    GST_OBJECT_LOCK (pipeline);
+    invalidate_position_cache (pipeline);
+    pipeline->priv->seek_rate = rate;
+    GST_OBJECT_UNLOCK (pipeline);
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->send_event (element, event);
+}
+
+/* answers a TIME position query from the cache when it is recent enough,
+ * extrapolating it with the clock in PLAYING */
+static gboolean
+gst_pipeline_query_cached_position (GstPipeline * pipeline, GstQuery * query)
+{
+  GstPipelinePrivate *priv = pipeline->priv;
+  GstElement *element = GST_ELEMENT_CAST (pipeline);
+  GstClock *clock;
+  GstClockTime now, cache_time, cached_at;
+  gboolean playing, cached_playing;
+  gint64 position;
+  gdouble rate;
+  guint cookie;
+  gboolean res;
+
+  GST_OBJECT_LOCK (pipeline);
+  cache_time = priv->position_cache_time;
+  if (cache_time == 0 || (clock = element->clock) == NULL) {
+    GST_OBJECT_UNLOCK (pipeline);
+    return GST_ELEMENT_CLASS (parent_class)->query (element, query);
+  }
+  gst_object_ref (clock);
+  playing = GST_STATE (pipeline) == GST_STATE_PLAYING &&
+      GST_STATE_PENDING (pipeline) == GST_STATE_VOID_PENDING;
+  GST_OBJECT_UNLOCK (pipeline);
+
+  now = gst_clock_get_time (clock);
+  gst_object_unref (clock);
+
+  GST_OBJECT_LOCK (pipeline);
+  cached_at = priv->cached_at;
+  cached_playing = priv->cached_playing;
+  position = priv->cached_position;
+  rate = priv->seek_rate;
+  cookie = priv->cache_cookie;
+  GST_OBJECT_UNLOCK (pipeline);
+
+  if (GST_CLOCK_TIME_IS_VALID (cached_at) && playing == cached_playing &&
+      now >= cached_at && now - cached_at < cache_time) {
+    if (playing) {
+      position += (gint64) ((now - cached_at) * rate);
+      if (position < 0)
+        position = 0;
+    }
+    GST_LOG_OBJECT (pipeline, "cached position %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (position));
+    gst_query_set_position (query, GST_FORMAT_TIME, position);
+    return TRUE;
+  }
+
+  res = GST_ELEMENT_CLASS (parent_class)->query (element, query);
+  if (res) {
+    gst_query_parse_position (query, NULL, &position);
+
+    GST_OBJECT_LOCK (pipeline);
+    /* a seek or state change while the sinks answered makes the position
+     * stale */
+    if (position >= 0 && cookie == priv->cache_cookie) {
+      priv->cached_position = position;
+      priv->cached_at = now;
+      priv->cached_playing = playing;
+    }
+    GST_OBJECT_UNLOCK (pipeline);
+  }
+
+  return res;
+}
+
+static gboolean
+gst_pipeline_query (GstElement * element, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_POSITION) {
+    GstFormat format;
+
+    gst_query_parse_position (query, &format, NULL);
+    if (format == GST_FORMAT_TIME)
+      return gst_pipeline_query_cached_position (GST_PIPELINE_CAST (element),
+          query);
+  }
+
+  return GST_ELEMENT_CLASS (parent_class)->query (element, query);
+}
+
 /**
  * gst_pipeline_get_bus:
  * @pipeline: a #GstPipeline
@@ -836,3 +1055,66 @@ gst_pipeline_get_auto_flush_bus (GstPipeline * pipeline)
 
   return res;
 }
+
+/**
+ * gst_pipeline_set_position_cache_time:
+ * @pipeline: a #GstPipeline
+ * @cache_time: the maximum age of a cached position, 0 to disable
+ *
+ * Answering a position query on a pipeline means querying all the sinks in
+ * the pipeline, which is a lot of work for big pipelines that are polled
+ * frequently. With a @cache_time bigger than 0, @pipeline remembers the
+ * result of a #GST_FORMAT_TIME position query together with the clock time
+ * at which it was made. Position queries that follow within @cache_time are
+ * answered from that result without querying the elements, in the PLAYING
+ * state the clock time that passed since the result was obtained is added
+ * using the rate of the last seek.
+ *
+ * The cached position is dropped on state changes, on seeks sent to the
+ * pipeline and when the pipeline gets an ASYNC_DONE, EOS or SEGMENT_DONE
+ * message. Changes to the position that bypass the pipeline, such as a seek
+ * sent directly to an element, can make the answer wrong by up to
+ * @cache_time.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_pipeline_set_position_cache_time (GstPipeline * pipeline,
+    GstClockTime cache_time)
+{
+  g_return_if_fail (GST_IS_PIPELINE (pipeline));
+
+  GST_OBJECT_LOCK (pipeline);
+  pipeline->priv->position_cache_time = cache_time;
+  invalidate_position_cache (pipeline);
+  GST_OBJECT_UNLOCK (pipeline);
+}
+
+/**
+ * gst_pipeline_get_position_cache_time:
+ * @pipeline: a #GstPipeline
+ *
+ * Get the maximum age of a cached position, see
+ * gst_pipeline_set_position_cache_time().
+ *
+ * Returns: the maximum age of a cached position of @pipeline.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_pipeline_get_position_cache_time (GstPipeline * pipeline)
+{
+  GstClockTime res;
+
+  g_return_val_if_fail (GST_IS_PIPELINE (pipeline), 0);
+
+  GST_OBJECT_LOCK (pipeline);
+  res = pipeline->priv->position_cache_time;
+  GST_OBJECT_UNLOCK (pipeline);
+
+  return res;
+}
@@ -104,6 +104,9 @@ GstClockTime    gst_pipeline_get_delay          (GstPipeline *pipeline);
 void            gst_pipeline_set_auto_flush_bus (GstPipeline *pipeline, gboolean auto_flush);
 gboolean        gst_pipeline_get_auto_flush_bus (GstPipeline *pipeline);
 
+void            gst_pipeline_set_position_cache_time (GstPipeline *pipeline, GstClockTime cache_time);
+GstClockTime    gst_pipeline_get_position_cache_time (GstPipeline *pipeline);
+
 G_END_DECLS
 
 #endif /* __GST_PIPELINE_H__ */
@@ -65,6 +65,7 @@
 #include <string.h>
 
 #include "glib-compat-private.h"
+#include "gstregistrychunks.h"
 
 #include <gst/gst.h>
 
@@ -75,6 +76,13 @@ static GstPluginDesc *_static_plugins;  /* NULL */
 static gboolean _gst_plugin_inited;
 static gchar **_plugin_loading_whitelist;       /* NULL */
 
+/* startup profile, see GST_PLUGIN_PROFILE. The names of the plugins loaded
+ * by this process are protected by gst_plugin_loading_mutex. */
+static gchar *_plugin_profile_location;        /* NULL */
+static GQueue _plugin_profile_loaded = G_QUEUE_INIT;
+static GThread *_plugin_profile_thread;        /* NULL */
+static volatile gint _plugin_profile_stop;
+
 /* static variables for segfault handling of plugin loading */
 static char *_gst_plugin_fault_handler_filename = NULL;
 
@@ -116,6 +124,8 @@ gst_plugin_init (GstPlugin * plugin)
 {
   plugin->priv =
       G_TYPE_INSTANCE_GET_PRIVATE (plugin, GST_TYPE_PLUGIN, GstPluginPrivate);
+  plugin->priv->open_time = GST_CLOCK_TIME_NONE;
+  plugin->priv->init_time = GST_CLOCK_TIME_NONE;
 }
 
 static void
@@ -478,6 +488,8 @@ static GstPlugin *
 gst_plugin_register_func (GstPlugin * plugin, const GstPluginDesc * desc,
     gpointer user_data)
 {
+  GstClockTime start;
+
   if (!gst_plugin_check_version (desc->major_version, desc->minor_version)) {
     if (GST_CAT_DEFAULT)
       GST_WARNING ("plugin \"%s\" has incompatible version, not loading",
@@ -511,6 +523,7 @@ gst_plugin_register_func (GstPlugin * plugin, const GstPluginDesc * desc,
   if (plugin->module)
     g_module_make_resident (plugin->module);
 
+  start = gst_util_get_timestamp ();
   if (user_data) {
     if (!(((GstPluginInitFullFunc) (desc->plugin_init)) (plugin, user_data))) {
       if (GST_CAT_DEFAULT)
@@ -527,6 +540,8 @@ gst_plugin_register_func (GstPlugin * plugin, const GstPluginDesc * desc,
     }
   }
 
+  plugin->priv->init_time = gst_util_get_timestamp () - start;
+
   if (GST_CAT_DEFAULT)
     GST_LOG ("plugin \"%s\" initialised", GST_STR_NULL (plugin->filename));
 
@@ -682,6 +697,7 @@ gst_plugin_load_file (const gchar * filename, GError ** error)
   GstRegistry *registry;
   gboolean new_plugin = TRUE;
   GModuleFlags flags;
+  GstClockTime open_start, open_time;
 
   g_return_val_if_fail (filename != NULL, NULL);
 
@@ -730,7 +746,9 @@ gst_plugin_load_file (const gchar * filename, GError ** error)
   if (strstr (filename, "libgstpython"))
     flags |= G_MODULE_BIND_LAZY;
 
+  open_start = gst_util_get_timestamp ();
   module = g_module_open (filename, flags);
+  open_time = gst_util_get_timestamp () - open_start;
   if (module == NULL) {
     GST_CAT_WARNING (GST_CAT_PLUGIN_LOADING, "module_open failed: %s",
         g_module_error ());
@@ -777,6 +795,7 @@ gst_plugin_load_file (const gchar * filename, GError ** error)
 
   plugin->module = module;
   plugin->orig_desc = desc;
+  plugin->priv->open_time = open_time;
 
   if (new_plugin) {
     /* check plugin description: complain about bad values and fail */
@@ -829,6 +848,10 @@ gst_plugin_load_file (const gchar * filename, GError ** error)
   _gst_plugin_fault_handler_filename = NULL;
   GST_INFO ("plugin \"%s\" loaded", plugin->filename);
 
+  if (_plugin_profile_location)
+    g_queue_push_tail (&_plugin_profile_loaded,
+        (gpointer) g_intern_string (plugin->desc.name));
+
   if (new_plugin) {
     gst_object_ref (plugin);
     gst_registry_add_plugin (gst_registry_get (), plugin);
@@ -846,6 +869,97 @@ return_error:
   }
 }
 
+static void
+plugin_profile_save (void)
+{
+  GString *str;
+  GList *walk;
+  GError *err = NULL;
+
+  str = g_string_new (NULL);
+  g_mutex_lock (&gst_plugin_loading_mutex);
+  for (walk = _plugin_profile_loaded.head; walk; walk = walk->next)
+    g_string_append_printf (str, "%s\n", (const gchar *) walk->data);
+  g_mutex_unlock (&gst_plugin_loading_mutex);
+
+  if (!g_file_set_contents (_plugin_profile_location, str->str, str->len,
+          &err)) {
+    GST_WARNING ("could not write plugin profile %s: %s",
+        _plugin_profile_location, err->message);
+    g_error_free (err);
+  }
+  g_string_free (str, TRUE);
+}
+
+static gpointer
+plugin_profile_preload (gchar ** names)
+{
+  GstRegistry *registry = gst_registry_get ();
+  GstPlugin *plugin, *loaded;
+  guint i;
+
+  for (i = 0; names[i] && !g_atomic_int_get (&_plugin_profile_stop); i++) {
+    if (*names[i] == '\0')
+      continue;
+
+    /* might have been removed since the profile was written */
+    plugin = gst_registry_find_plugin (registry, names[i]);
+    if (plugin == NULL)
+      continue;
+
+    if (!gst_plugin_is_loaded (plugin)) {
+      GST_DEBUG ("preloading plugin %s", names[i]);
+      if ((loaded = gst_plugin_load (plugin)))
+        gst_object_unref (loaded);
+    }
+    gst_object_unref (plugin);
+  }
+  g_strfreev (names);
+
+  return NULL;
+}
+
+/* Called when the registry is ready. When GST_PLUGIN_PROFILE names a file,
+ * the plugins listed in it are loaded in the background and the plugins this
+ * process loads are written to it when the process exits. */
+void
+_priv_gst_plugin_profile_start (void)
+{
+  const gchar *location;
+  gchar *contents;
+  gchar **names;
+
+  location = g_getenv ("GST_PLUGIN_PROFILE");
+  if (location == NULL || *location == '\0' || _plugin_profile_location)
+    return;
+
+  _plugin_profile_location = g_strdup (location);
+  atexit (plugin_profile_save);
+
+  if (!g_file_get_contents (location, &contents, NULL, NULL))
+    return;
+
+  names = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  GST_INFO ("preloading the plugins of profile %s", location);
+  _plugin_profile_thread = g_thread_try_new ("gstpreload",
+      (GThreadFunc) plugin_profile_preload, names, NULL);
+  if (_plugin_profile_thread == NULL)
+    g_strfreev (names);
+}
+
+void
+_priv_gst_plugin_profile_stop (void)
+{
+  if (_plugin_profile_thread == NULL)
+    return;
+
+  g_atomic_int_set (&_plugin_profile_stop, 1);
+  g_thread_join (_plugin_profile_thread);
+  _plugin_profile_thread = NULL;
+}
+
 static void
 gst_plugin_desc_copy (GstPluginDesc * dest, const GstPluginDesc * src)
 {
@@ -1029,6 +1143,67 @@ gst_plugin_is_loaded (GstPlugin * plugin)
   return (plugin->module != NULL || plugin->filename == NULL);
 }
 
+/**
+ * gst_plugin_get_load_stats:
+ * @plugin: a plugin
+ * @open_time: (out) (allow-none): location for the time it took to open the
+ *     module of the plugin
+ * @init_time: (out) (allow-none): location for the time the plugin_init
+ *     function of the plugin took
+ * @registry_size: (out) (allow-none): location for the number of bytes the
+ *     plugin and its features take in the binary registry, without the
+ *     alignment padding
+ *
+ * Gets what @plugin costs to load. The times are only known when @plugin
+ * was loaded in this process, they are #GST_CLOCK_TIME_NONE otherwise.
+ * Static plugins have an @open_time of 0.
+ *
+ * This can be used to find the plugins that slow down the startup of an
+ * application the most.
+ *
+ * Returns: %TRUE when @plugin was loaded in this process.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_plugin_get_load_stats (GstPlugin * plugin, GstClockTime * open_time,
+    GstClockTime * init_time, gsize * registry_size)
+{
+  g_return_val_if_fail (GST_IS_PLUGIN (plugin), FALSE);
+
+  GST_OBJECT_LOCK (plugin);
+  if (open_time) {
+    /* static plugins have no module of their own */
+    if (plugin->filename == NULL && GST_CLOCK_TIME_IS_VALID
+        (plugin->priv->init_time))
+      *open_time = 0;
+    else
+      *open_time = plugin->priv->open_time;
+  }
+  if (init_time)
+    *init_time = plugin->priv->init_time;
+  GST_OBJECT_UNLOCK (plugin);
+
+  if (registry_size) {
+    GList *chunks = NULL, *walk;
+
+    /* static plugins are not saved in the registry */
+    *registry_size = 0;
+    if (plugin->filename)
+      _priv_gst_registry_chunks_save_plugin (&chunks, gst_registry_get (),
+          plugin);
+    for (walk = chunks; walk; walk = walk->next) {
+      GstRegistryChunk *chunk = walk->data;
+
+      *registry_size += chunk->size;
+      _priv_gst_registry_chunk_free (chunk);
+    }
+    g_list_free (chunks);
+  }
+
+  return GST_CLOCK_TIME_IS_VALID (plugin->priv->init_time);
+}
+
 /**
  * gst_plugin_get_cache_data:
  * @plugin: a plugin
@@ -291,6 +291,10 @@ const GstStructure*	gst_plugin_get_cache_data	(GstPlugin * plugin);
 void			gst_plugin_set_cache_data	(GstPlugin * plugin, GstStructure *cache_data);
 
 gboolean		gst_plugin_is_loaded		(GstPlugin *plugin);
+gboolean		gst_plugin_get_load_stats	(GstPlugin *plugin,
+							 GstClockTime *open_time,
+							 GstClockTime *init_time,
+							 gsize *registry_size);
 
 GstPlugin *		gst_plugin_load_file		(const gchar *filename, GError** error);
 
@@ -44,6 +44,9 @@ static void gst_plugin_feature_finalize (GObject * object);
 
 /* static guint gst_plugin_feature_signals[LAST_SIGNAL] = { 0 }; */
 
+/* changed whenever the rank of a feature changes */
+volatile gint _priv_gst_plugin_feature_rank_cookie = 0;
+
 G_DEFINE_ABSTRACT_TYPE (GstPluginFeature, gst_plugin_feature, GST_TYPE_OBJECT);
 
 static void
@@ -161,6 +164,7 @@ gst_plugin_feature_set_rank (GstPluginFeature * feature, guint rank)
   g_return_if_fail (GST_IS_PLUGIN_FEATURE (feature));
 
   feature->rank = rank;
+  g_atomic_int_inc (&_priv_gst_plugin_feature_rank_cookie);
 }
 
 /**
@@ -50,6 +50,11 @@
  * descriptor, and gst_poll_fd_can_write() to see if it is possible to
  * write to it.
  *
+ * On Linux, non-timer sets use epoll so that the cost of a wait depends on
+ * the number of descriptors with activity rather than on the number of
+ * descriptors in the set. The set transparently falls back to poll() when
+ * a descriptor that epoll can't handle, such as a regular file, is added.
+ *
  */
 
 #ifdef HAVE_CONFIG_H
@@ -82,6 +87,9 @@
 #endif
 #include <sys/time.h>
 #include <sys/socket.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 #endif
 
 /* OS/X needs this because of bad headers */
@@ -117,6 +125,7 @@ typedef enum
   GST_POLL_MODE_PSELECT,
   GST_POLL_MODE_POLL,
   GST_POLL_MODE_PPOLL,
+  GST_POLL_MODE_EPOLL,
   GST_POLL_MODE_WINDOWS
 } GstPollMode;
 
@@ -136,6 +145,13 @@ struct _GstPoll
   gchar buf[1];
   GstPollFD control_read_fd;
   GstPollFD control_write_fd;
+#ifdef HAVE_SYS_EPOLL_H
+  gint epoll_fd;
+  /* result buffer for epoll_wait(), only used by the waiting thread */
+  GArray *epoll_events;
+  /* indexes in active_fds with revents set by the last wait */
+  GArray *epoll_ready;
+#endif
 #else
   GArray *active_fds_ignored;
   GArray *events;
@@ -268,6 +284,141 @@ find_index (GArray * array, GstPollFD * fd)
   return fd->idx;
 }
 
+#ifndef G_OS_WIN32
+/* copy the registered fds to the array that is used for waiting, with the
+ * lock */
+static void
+rebuild_active_fds_unlocked (GstPoll * set)
+{
+  g_array_set_size (set->active_fds, set->fds->len);
+  memcpy (set->active_fds->data, set->fds->data,
+      set->fds->len * sizeof (struct pollfd));
+#ifdef HAVE_SYS_EPOLL_H
+  /* the copy has no revents set */
+  g_array_set_size (set->epoll_ready, 0);
+  g_array_set_size (set->epoll_events, MAX (set->fds->len, 1));
+#endif
+}
+#endif
+
+#ifdef HAVE_SYS_EPOLL_H
+/* the epoll data of an fd contains its index in the fds array so that the
+ * results can be stored without a lookup, and the fd to validate the index */
+#define EPOLL_DATA(idx,fd)      (((guint64) (idx) << 32) | (guint32) (fd))
+#define EPOLL_DATA_IDX(data)    ((gint) ((data) >> 32))
+#define EPOLL_DATA_FD(data)     ((gint) (guint32) (data))
+
+/* switch to the poll() based implementation, with the lock */
+static void
+gst_poll_epoll_disable (GstPoll * set)
+{
+  GST_DEBUG ("%p: falling back to poll", set);
+  /* the epoll fd is kept until the set is freed because a waiting thread
+   * might still be using it */
+  set->mode = GST_POLL_MODE_AUTO;
+  MARK_REBUILD (set);
+}
+
+/* update the kernel registration of the fd at @idx, with the lock */
+static void
+gst_poll_epoll_ctl (GstPoll * set, gint op, gint idx)
+{
+  struct pollfd *pfd;
+  struct epoll_event ev;
+
+  if (set->mode != GST_POLL_MODE_EPOLL)
+    return;
+
+  pfd = &g_array_index (set->fds, struct pollfd, idx);
+
+  ev.events = 0;
+  if (pfd->events & POLLIN)
+    ev.events |= EPOLLIN;
+  if (pfd->events & POLLPRI)
+    ev.events |= EPOLLPRI;
+  if (pfd->events & POLLOUT)
+    ev.events |= EPOLLOUT;
+  ev.data.u64 = EPOLL_DATA (idx, pfd->fd);
+
+  if (G_UNLIKELY (epoll_ctl (set->epoll_fd, op, pfd->fd, &ev) < 0)) {
+    if (op == EPOLL_CTL_DEL) {
+      /* the fd was probably closed already, which removed it */
+      GST_LOG ("%p: could not remove fd %d: %s", set, pfd->fd,
+          g_strerror (errno));
+      return;
+    }
+    /* epoll refuses regular files and some devices */
+    GST_DEBUG ("%p: epoll_ctl failed for fd %d: %s", set, pfd->fd,
+        g_strerror (errno));
+    gst_poll_epoll_disable (set);
+  }
+}
+
+/* clear the results of the previous wait, with the lock */
+static void
+gst_poll_epoll_clear_ready_unlocked (GstPoll * set)
+{
+  guint i;
+
+  for (i = 0; i < set->epoll_ready->len; i++) {
+    guint idx = g_array_index (set->epoll_ready, guint, i);
+
+    if (idx < set->active_fds->len)
+      g_array_index (set->active_fds, struct pollfd, idx).revents = 0;
+  }
+  g_array_set_size (set->epoll_ready, 0);
+}
+
+/* store the @n_events results of epoll_wait() in active_fds, with the lock.
+ * Returns the number of fds with activity */
+static gint
+gst_poll_epoll_collect_unlocked (GstPoll * set, gint n_events)
+{
+  struct epoll_event *events;
+  gint i, res = 0;
+
+  /* fds were added or removed while we waited, the indexes in the events
+   * refer to the new layout */
+  if (TEST_REBUILD (set))
+    rebuild_active_fds_unlocked (set);
+
+  events = (struct epoll_event *) set->epoll_events->data;
+
+  for (i = 0; i < n_events; i++) {
+    struct epoll_event *ev = &events[i];
+    gint idx = EPOLL_DATA_IDX (ev->data.u64);
+    gint fd = EPOLL_DATA_FD (ev->data.u64);
+    struct pollfd *pfd;
+
+    if (G_UNLIKELY (idx >= set->active_fds->len ||
+            g_array_index (set->active_fds, struct pollfd, idx).fd != fd)) {
+      GstPollFD pollfd = GST_POLL_FD_INIT;
+
+      pollfd.fd = fd;
+      if ((idx = find_index (set->active_fds, &pollfd)) < 0)
+        continue;
+    }
+    pfd = &g_array_index (set->active_fds, struct pollfd, idx);
+
+    pfd->revents = 0;
+    if (ev->events & EPOLLIN)
+      pfd->revents |= POLLIN;
+    if (ev->events & EPOLLPRI)
+      pfd->revents |= POLLPRI;
+    if (ev->events & EPOLLOUT)
+      pfd->revents |= POLLOUT;
+    if (ev->events & EPOLLERR)
+      pfd->revents |= POLLERR;
+    if (ev->events & EPOLLHUP)
+      pfd->revents |= POLLHUP;
+
+    g_array_append_val (set->epoll_ready, idx);
+    res++;
+  }
+  return res;
+}
+#endif
+
 #if !defined(HAVE_PPOLL) && defined(HAVE_POLL)
 /* check if all file descriptors will fit in an fd_set */
 static gboolean
@@ -535,25 +686,12 @@ gst_poll_collect_winsock_events (GstPoll * set)
 }
 #endif
 
-/**
- * gst_poll_new: (skip)
- * @controllable: whether it should be possible to control a wait.
- *
- * Create a new file descriptor set. If @controllable, it
- * is possible to restart or flush a call to gst_poll_wait() with
- * gst_poll_restart() and gst_poll_set_flushing() respectively.
- *
- * Free-function: gst_poll_free
- *
- * Returns: (transfer full): a new #GstPoll, or %NULL in case of an error.
- *     Free with gst_poll_free().
- */
-GstPoll *
-gst_poll_new (gboolean controllable)
+static GstPoll *
+gst_poll_new_internal (gboolean controllable, gboolean timer)
 {
   GstPoll *nset;
 
-  GST_DEBUG ("controllable : %d", controllable);
+  GST_DEBUG ("controllable : %d, timer : %d", controllable, timer);
 
   nset = g_slice_new0 (GstPoll);
   g_mutex_init (&nset->lock);
@@ -563,6 +701,22 @@ gst_poll_new (gboolean controllable)
   nset->active_fds = g_array_new (FALSE, FALSE, sizeof (struct pollfd));
   nset->control_read_fd.fd = -1;
   nset->control_write_fd.fd = -1;
+#ifdef HAVE_SYS_EPOLL_H
+  nset->epoll_events = g_array_new (FALSE, TRUE, sizeof (struct epoll_event));
+  nset->epoll_ready = g_array_new (FALSE, FALSE, sizeof (guint));
+  nset->epoll_fd = -1;
+  /* timers only wait on the control socket and can have multiple threads
+   * waiting, they don't benefit from epoll */
+  if (!timer) {
+    nset->epoll_fd = epoll_create (1);
+    if (nset->epoll_fd >= 0) {
+      fcntl (nset->epoll_fd, F_SETFD, FD_CLOEXEC);
+      nset->mode = GST_POLL_MODE_EPOLL;
+    } else {
+      GST_DEBUG ("%p: can't create epoll fd: %s", nset, g_strerror (errno));
+    }
+  }
+#endif
   {
     gint control_sock[2];
 
@@ -593,6 +747,7 @@ gst_poll_new (gboolean controllable)
   MARK_REBUILD (nset);
 
   nset->controllable = controllable;
+  nset->timer = timer;
 
   return nset;
 
@@ -607,6 +762,25 @@ no_socket_pair:
 #endif
 }
 
+/**
+ * gst_poll_new: (skip)
+ * @controllable: whether it should be possible to control a wait.
+ *
+ * Create a new file descriptor set. If @controllable, it
+ * is possible to restart or flush a call to gst_poll_wait() with
+ * gst_poll_restart() and gst_poll_set_flushing() respectively.
+ *
+ * Free-function: gst_poll_free
+ *
+ * Returns: (transfer full): a new #GstPoll, or %NULL in case of an error.
+ *     Free with gst_poll_free().
+ */
+GstPoll *
+gst_poll_new (gboolean controllable)
+{
+  return gst_poll_new_internal (controllable, FALSE);
+}
+
 /**
  * gst_poll_new_timer: (skip)
  *
@@ -624,17 +798,8 @@ no_socket_pair:
 GstPoll *
 gst_poll_new_timer (void)
 {
-  GstPoll *poll;
-
-  /* make a new controllable poll set */
-  if (!(poll = gst_poll_new (TRUE)))
-    goto done;
-
-  /* we are a timer */
-  poll->timer = TRUE;
-
-done:
-  return poll;
+  /* make a new controllable poll set, we are a timer */
+  return gst_poll_new_internal (TRUE, TRUE);
 }
 
 /**
@@ -655,6 +820,12 @@ gst_poll_free (GstPoll * set)
     close (set->control_write_fd.fd);
   if (set->control_read_fd.fd >= 0)
     close (set->control_read_fd.fd);
+#ifdef HAVE_SYS_EPOLL_H
+  if (set->epoll_fd >= 0)
+    close (set->epoll_fd);
+  g_array_free (set->epoll_ready, TRUE);
+  g_array_free (set->epoll_events, TRUE);
+#endif
 #else
   CloseHandle (set->wakeup_event);
 
@@ -738,6 +909,9 @@ gst_poll_add_fd_unlocked (GstPoll * set, GstPollFD * fd)
     g_array_append_val (set->fds, nfd);
 
     fd->idx = set->fds->len - 1;
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_ADD, fd->idx);
+#endif
 #else
     WinsockFd wfd;
     HANDLE event;
@@ -818,11 +992,20 @@ gst_poll_remove_fd (GstPoll * set, GstPollFD * fd)
     gst_poll_free_winsock_event (set, idx);
     g_array_remove_index_fast (set->events, idx);
 #endif
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_DEL, idx);
+#endif
 
     /* remove the fd at index, we use _remove_index_fast, which copies the last
      * element of the array to the freed index */
     g_array_remove_index_fast (set->fds, idx);
 
+#ifdef HAVE_SYS_EPOLL_H
+    /* the last fd moved to the freed index, update its epoll data */
+    if (idx < set->fds->len)
+      gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
+
     /* mark fd as removed by setting the index to -1 */
     fd->idx = -1;
     MARK_REBUILD (set);
@@ -871,11 +1054,16 @@ gst_poll_fd_ctl_write (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events &= ~POLLOUT;
 
     GST_LOG ("pfd->events now %d (POLLOUT:%d)", pfd->events, POLLOUT);
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_WRITE | FD_CONNECT,
         active);
 #endif
-    MARK_REBUILD (set);
+    /* with epoll the kernel has the new events already */
+    if (set->mode != GST_POLL_MODE_EPOLL)
+      MARK_REBUILD (set);
   } else {
     GST_WARNING ("%p: couldn't find fd !", set);
   }
@@ -903,10 +1091,15 @@ gst_poll_fd_ctl_read_unlocked (GstPoll * set, GstPollFD * fd, gboolean active)
       pfd->events |= (POLLIN | POLLPRI);
     else
       pfd->events &= ~(POLLIN | POLLPRI);
+#ifdef HAVE_SYS_EPOLL_H
+    gst_poll_epoll_ctl (set, EPOLL_CTL_MOD, idx);
+#endif
 #else
     gst_poll_update_winsock_event_mask (set, idx, FD_READ | FD_ACCEPT, active);
 #endif
-    MARK_REBUILD (set);
+    /* with epoll the kernel has the new events already */
+    if (set->mode != GST_POLL_MODE_EPOLL)
+      MARK_REBUILD (set);
   } else {
     GST_WARNING ("%p: couldn't find fd !", set);
   }
@@ -1223,9 +1416,7 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
     if (TEST_REBUILD (set)) {
       g_mutex_lock (&set->lock);
 #ifndef G_OS_WIN32
-      g_array_set_size (set->active_fds, set->fds->len);
-      memcpy (set->active_fds->data, set->fds->data,
-          set->fds->len * sizeof (struct pollfd));
+      rebuild_active_fds_unlocked (set);
 #else
       if (!gst_poll_prepare_winsock_active_sets (set))
         goto winsock_error;
@@ -1336,6 +1527,39 @@ gst_poll_wait (GstPoll * set, GstClockTime timeout)
 #else /* G_OS_WIN32 */
         g_assert_not_reached ();
         errno = ENOSYS;
+#endif
+        break;
+      }
+      case GST_POLL_MODE_EPOLL:
+      {
+#ifdef HAVE_SYS_EPOLL_H
+        gint t;
+
+        if (timeout != GST_CLOCK_TIME_NONE) {
+          /* round up, returning before the timeout expired makes callers
+           * spin */
+          t = (gint) MIN ((timeout + GST_MSECOND - 1) / GST_MSECOND,
+              G_MAXINT);
+        } else {
+          t = -1;
+        }
+
+        g_mutex_lock (&set->lock);
+        gst_poll_epoll_clear_ready_unlocked (set);
+        g_mutex_unlock (&set->lock);
+
+        res = epoll_wait (set->epoll_fd,
+            (struct epoll_event *) set->epoll_events->data,
+            set->epoll_events->len, t);
+
+        if (res > 0) {
+          g_mutex_lock (&set->lock);
+          res = gst_poll_epoll_collect_unlocked (set, res);
+          g_mutex_unlock (&set->lock);
+        }
+#else
+        g_assert_not_reached ();
+        errno = ENOSYS;
 #endif
         break;
       }
@@ -27,7 +27,8 @@
  * The name of a preset serves as key for subsequent method calls to manipulate
  * single presets.
  * All instances of one type will share the list of presets. The list is created
- * on demand, if presets are not used, the list is not created.
+ * on demand, if presets are not used, the list is not created. It is read
+ * again when one of the preset files changed on disk.
  *
  * The interface comes with a default implementation that serves most plugins.
  * Wrapper plugins will override most methods to implement support for the
@@ -94,6 +95,38 @@ static GQuark preset_app_path_quark = 0;
 static GQuark preset_system_path_quark = 0;
 static GQuark preset_quark = 0;
 
+/* the stat info of a preset file when it was loaded, a file that does not
+ * exist has all fields 0 */
+typedef struct
+{
+  time_t mtime;
+  goffset size;
+} PresetFileStat;
+
+/* the parsed values of one preset for elements that are not a child proxy.
+ * The properties of those can't change, so the values only have to be
+ * deserialized once */
+typedef struct
+{
+  guint n_params;
+  GParameter *params;
+} PresetParams;
+
+/* the presets of a type, attached to the type with preset_quark. The keyfile
+ * is loaded again when one of the files changed on disk, the compiled presets
+ * are dropped whenever the keyfile changes */
+typedef struct
+{
+  GKeyFile *keyfile;
+
+  PresetFileStat user_stat;
+  PresetFileStat app_stat;
+  PresetFileStat system_stat;
+
+  /* preset name -> PresetParams */
+  GHashTable *compiled;
+} PresetCache;
+
 /*static GQuark property_list_quark = 0;*/
 
 /* the application can set a custom path that is checked in addition to standard
@@ -330,17 +363,92 @@ preset_merge (GKeyFile * system, GKeyFile * user)
   g_strfreev (groups);
 }
 
+static void
+preset_file_stat (const gchar * preset_path, PresetFileStat * file_stat)
+{
+  GStatBuf buf;
+
+  if (preset_path && g_stat (preset_path, &buf) == 0) {
+    file_stat->mtime = buf.st_mtime;
+    file_stat->size = buf.st_size;
+  } else {
+    file_stat->mtime = 0;
+    file_stat->size = 0;
+  }
+}
+
+static gboolean
+preset_file_changed (const gchar * preset_path, const PresetFileStat * old)
+{
+  PresetFileStat file_stat;
+
+  preset_file_stat (preset_path, &file_stat);
+
+  return file_stat.mtime != old->mtime || file_stat.size != old->size;
+}
+
+static void
+preset_params_free (PresetParams * params)
+{
+  guint i;
+
+  for (i = 0; i < params->n_params; i++) {
+    g_free ((gchar *) params->params[i].name);
+    g_value_unset (&params->params[i].value);
+  }
+  g_free (params->params);
+  g_slice_free (PresetParams, params);
+}
+
+static PresetCache *
+preset_get_cache (GstPreset * preset)
+{
+  GType type = G_TYPE_FROM_INSTANCE (preset);
+  PresetCache *cache;
+
+  if (!(cache = g_type_get_qdata (type, preset_quark))) {
+    cache = g_slice_new0 (PresetCache);
+    cache->compiled = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) preset_params_free);
+    g_type_set_qdata (type, preset_quark, cache);
+  }
+  return cache;
+}
+
+/* drops the compiled presets, called whenever the keyfile changes */
+static void
+preset_cache_changed (PresetCache * cache)
+{
+  g_hash_table_remove_all (cache->compiled);
+}
+
 /* reads the user and system presets files and merges them together. This
- * function caches the GKeyFile on the element type. If there is no existing
- * preset file, a new in-memory GKeyFile will be created. */
+ * function caches the GKeyFile on the element type and reads the files again
+ * when one of them changed on disk. If there is no existing preset file, a new
+ * in-memory GKeyFile will be created. */
 static GKeyFile *
 preset_get_keyfile (GstPreset * preset)
 {
   GKeyFile *presets;
-  GType type = G_TYPE_FROM_INSTANCE (preset);
+  PresetCache *cache = preset_get_cache (preset);
 
-  /* first see if the have a cached version for the type */
-  if (!(presets = g_type_get_qdata (type, preset_quark))) {
+  if ((presets = cache->keyfile)) {
+    const gchar *preset_user_path, *preset_app_path, *preset_system_path;
+
+    preset_get_paths (preset, &preset_user_path, &preset_app_path,
+        &preset_system_path);
+
+    if (preset_file_changed (preset_user_path, &cache->user_stat) ||
+        preset_file_changed (preset_app_path, &cache->app_stat) ||
+        preset_file_changed (preset_system_path, &cache->system_stat)) {
+      GST_INFO_OBJECT (preset, "preset files changed, reloading");
+      g_key_file_free (presets);
+      cache->keyfile = presets = NULL;
+      preset_cache_changed (cache);
+    }
+  }
+
+  if (!presets) {
     const gchar *preset_user_path, *preset_app_path, *preset_system_path;
     guint64 version_system = G_GUINT64_CONSTANT (0);
     guint64 version_app = G_GUINT64_CONSTANT (0);
@@ -352,6 +460,11 @@ preset_get_keyfile (GstPreset * preset)
     preset_get_paths (preset, &preset_user_path, &preset_app_path,
         &preset_system_path);
 
+    /* remember the files as they were before loading them */
+    preset_file_stat (preset_user_path, &cache->user_stat);
+    preset_file_stat (preset_app_path, &cache->app_stat);
+    preset_file_stat (preset_system_path, &cache->system_stat);
+
     /* try to load the user, app and system presets, we do this to get the
      * versions of all files. */
     in_user = preset_open_and_parse_header (preset, preset_user_path,
@@ -401,7 +514,7 @@ preset_get_keyfile (GstPreset * preset)
     }
 
     /* attach the preset to the type */
-    g_type_set_qdata (type, preset_quark, (gpointer) presets);
+    cache->keyfile = presets;
 
     if (merged) {
       gst_preset_default_save_presets_file (preset);
@@ -524,6 +637,56 @@ gst_preset_default_get_property_names (GstPreset * preset)
   return result;
 }
 
+/* deserializes the values of the preset @name for all the properties of
+ * @preset that are in the preset */
+static PresetParams *
+preset_compile (GstPreset * preset, GKeyFile * presets, const gchar * name)
+{
+  PresetParams *params;
+  GObjectClass *gclass;
+  gchar **props;
+  guint i;
+
+  if (!(props = gst_preset_get_property_names (preset)))
+    return NULL;
+
+  gclass = G_OBJECT_CLASS (GST_ELEMENT_GET_CLASS (preset));
+
+  params = g_slice_new0 (PresetParams);
+  params->params = g_new0 (GParameter, g_strv_length (props));
+
+  for (i = 0; props[i]; i++) {
+    GParameter *param = &params->params[params->n_params];
+    GParamSpec *property;
+    gchar *str;
+
+    if (!(str = g_key_file_get_value (presets, name, props[i], NULL))) {
+      GST_WARNING_OBJECT (preset, "parameter '%s' not in preset", props[i]);
+      continue;
+    }
+    if (!(property = g_object_class_find_property (gclass, props[i]))) {
+      GST_WARNING_OBJECT (preset, "property '%s' not in object", props[i]);
+      g_free (str);
+      continue;
+    }
+
+    g_value_init (&param->value, property->value_type);
+    if (gst_value_deserialize (&param->value, str)) {
+      param->name = g_strdup (props[i]);
+      params->n_params++;
+    } else {
+      GST_WARNING_OBJECT (preset,
+          "deserialization of value '%s' for property '%s' failed", str,
+          props[i]);
+      g_value_unset (&param->value);
+    }
+    g_free (str);
+  }
+  g_strfreev (props);
+
+  return params;
+}
+
 /* load the presets of @name for the instance @preset. Returns %FALSE if something
  * failed. */
 static gboolean
@@ -534,6 +697,7 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
   guint i;
   GObjectClass *gclass;
   gboolean is_child_proxy;
+  GstPresetInterface *iface;
 
   /* get the presets from the type */
   if (!(presets = preset_get_keyfile (preset)))
@@ -545,12 +709,37 @@ gst_preset_default_load_preset (GstPreset * preset, const gchar * name)
 
   GST_DEBUG_OBJECT (preset, "loading preset : '%s'", name);
 
+  is_child_proxy = GST_IS_CHILD_PROXY (preset);
+  iface = GST_PRESET_GET_INTERFACE (preset);
+
+  /* the properties of child proxies depend on the children and an overridden
+   * get_property_names() could depend on the instance, use the compiled
+   * values for all other elements */
+  if (!is_child_proxy &&
+      iface->get_property_names == gst_preset_default_get_property_names) {
+    PresetCache *cache = preset_get_cache (preset);
+    PresetParams *params;
+
+    if (!(params = g_hash_table_lookup (cache->compiled, name))) {
+      if (!(params = preset_compile (preset, presets, name)))
+        goto no_properties;
+      g_hash_table_insert (cache->compiled, g_strdup (name), params);
+    }
+
+    for (i = 0; i < params->n_params; i++) {
+      GST_DEBUG_OBJECT (preset, "setting property '%s'",
+          params->params[i].name);
+      g_object_set_property ((GObject *) preset, params->params[i].name,
+          &params->params[i].value);
+    }
+    return TRUE;
+  }
+
   /* get the properties that we can configure in this element */
   if (!(props = gst_preset_get_property_names (preset)))
     goto no_properties;
 
   gclass = G_OBJECT_CLASS (GST_ELEMENT_GET_CLASS (preset));
-  is_child_proxy = GST_IS_CHILD_PROXY (preset);
 
   /* for each of the property names, find the preset parameter and try to
    * configure the property with its value */
@@ -629,6 +818,7 @@ static gboolean
 gst_preset_default_save_presets_file (GstPreset * preset)
 {
   GKeyFile *presets;
+  PresetCache *cache;
   const gchar *preset_path;
   GError *error = NULL;
   gchar *bak_file_name;
@@ -638,10 +828,14 @@ gst_preset_default_save_presets_file (GstPreset * preset)
 
   preset_get_paths (preset, &preset_path, NULL, NULL);
 
-  /* get the presets from the type */
-  if (!(presets = preset_get_keyfile (preset)))
+  /* get the presets from the type, this is called after changing the cached
+   * keyfile so it must not be loaded again */
+  cache = preset_get_cache (preset);
+  if (!(presets = cache->keyfile))
     goto no_presets;
 
+  preset_cache_changed (cache);
+
   GST_DEBUG_OBJECT (preset, "saving preset file: '%s'", preset_path);
 
   /* create backup if possible */
@@ -673,6 +867,9 @@ gst_preset_default_save_presets_file (GstPreset * preset)
   if (!g_file_set_contents (preset_path, data, data_size, &error))
     goto write_failed;
 
+  /* we don't need to load our own changes again */
+  preset_file_stat (preset_path, &cache->user_stat);
+
   g_free (data);
 
   return TRUE;
@@ -66,7 +66,7 @@ static const gchar *_quark_strings[] = {
   "GstMessageResetTime",
   "GstMessageToc", "GstEventTocGlobal", "GstEventTocCurrent",
   "GstEventSegmentDone",
-  "GstEventStreamStart", "stream-id"
+  "GstEventStreamStart", "stream-id", "GstQueryMemoryUsage", "memory-usage"
 };
 
 GQuark _priv_gst_quark_table[GST_QUARK_MAX];
@@ -188,7 +188,9 @@ typedef enum _GstQuarkId
   GST_QUARK_EVENT_SEGMENT_DONE = 159,
   GST_QUARK_EVENT_STREAM_START = 160,
   GST_QUARK_STREAM_ID = 161,
-  GST_QUARK_MAX = 162
+  GST_QUARK_QUERY_MEMORY_USAGE = 162,
+  GST_QUARK_MEMORY_USAGE = 163,
+  GST_QUARK_MAX = 164
 } GstQuarkId;
 
 extern GQuark _priv_gst_quark_table[GST_QUARK_MAX];
@@ -83,6 +83,21 @@ typedef struct
 
 #define GST_QUERY_STRUCTURE(q)  (((GstQueryImpl *)(q))->structure)
 
+/* Position, duration and latency queries are made at a high rate by
+ * applications and elements. When such a query is freed, it is kept together
+ * with its structure in a slot for its type so that the next query of that
+ * type can reuse both instead of allocating a new structure and field
+ * array. */
+enum
+{
+  QUERY_CACHE_POSITION,
+  QUERY_CACHE_DURATION,
+  QUERY_CACHE_LATENCY,
+  QUERY_CACHE_N
+};
+
+static GstQueryImpl *query_cache[QUERY_CACHE_N];
+
 
 typedef struct
 {
@@ -110,6 +125,7 @@ static GstQueryQuarks query_quarks[] = {
   {GST_QUERY_ACCEPT_CAPS, "accept-caps", 0},
   {GST_QUERY_CAPS, "caps", 0},
   {GST_QUERY_DRAIN, "drain", 0},
+  {GST_QUERY_MEMORY_USAGE, "memory-usage", 0},
 
   {0, NULL, 0}
 };
@@ -188,6 +204,103 @@ gst_query_type_get_flags (GstQueryType type)
   return ret;
 }
 
+static gint
+gst_query_cache_index (GstQueryType type, guint * n_fields, GQuark * name)
+{
+  switch (type) {
+    case GST_QUERY_POSITION:
+      *n_fields = 2;
+      *name = GST_QUARK (QUERY_POSITION);
+      return QUERY_CACHE_POSITION;
+    case GST_QUERY_DURATION:
+      *n_fields = 2;
+      *name = GST_QUARK (QUERY_DURATION);
+      return QUERY_CACHE_DURATION;
+    case GST_QUERY_LATENCY:
+      *n_fields = 3;
+      *name = GST_QUARK (QUERY_LATENCY);
+      return QUERY_CACHE_LATENCY;
+    default:
+      return -1;
+  }
+}
+
+static void _gst_query_free (GstQuery * query);
+static GstQuery *_gst_query_copy (GstQuery * query);
+
+/* takes a cached query of @type, the values in its structure still need to
+ * be set */
+static GstQuery *
+gst_query_cache_take (GstQueryType type)
+{
+  GstQueryImpl *query;
+  guint n_fields;
+  GQuark name;
+  gint idx;
+
+  idx = gst_query_cache_index (type, &n_fields, &name);
+  g_assert (idx >= 0);
+
+  do {
+    query = g_atomic_pointer_get (&query_cache[idx]);
+    if (query == NULL)
+      return NULL;
+  } while (!g_atomic_pointer_compare_and_exchange (&query_cache[idx], query,
+          NULL));
+
+  GST_DEBUG ("reusing query %p %s", query, gst_query_type_get_name (type));
+
+  /* the structure keeps pointing to the refcount of the query */
+  gst_mini_object_init (GST_MINI_OBJECT_CAST (query), 0, _gst_query_type,
+      (GstMiniObjectCopyFunction) _gst_query_copy, NULL,
+      (GstMiniObjectFreeFunction) _gst_query_free);
+  GST_QUERY_TYPE (query) = type;
+
+  return GST_QUERY_CAST (query);
+}
+
+/* tries to keep @query for reuse, only when its structure still has the
+ * layout of a new query */
+static gboolean
+gst_query_cache_put (GstQuery * query)
+{
+  GstStructure *s = GST_QUERY_STRUCTURE (query);
+  guint n_fields;
+  GQuark name;
+  gint idx;
+
+  idx = gst_query_cache_index (GST_QUERY_TYPE (query), &n_fields, &name);
+  if (idx < 0 || s == NULL)
+    return FALSE;
+
+  if (gst_structure_get_name_id (s) != name ||
+      gst_structure_n_fields (s) != n_fields)
+    return FALSE;
+
+  return g_atomic_pointer_compare_and_exchange (&query_cache[idx], NULL,
+      query);
+}
+
+void
+_priv_gst_query_deinit (void)
+{
+  GstQueryImpl *query;
+  gint i;
+
+  for (i = 0; i < QUERY_CACHE_N; i++) {
+    do {
+      query = g_atomic_pointer_get (&query_cache[i]);
+    } while (!g_atomic_pointer_compare_and_exchange (&query_cache[i], query,
+            NULL));
+
+    if (query) {
+      gst_structure_set_parent_refcount (query->structure, NULL);
+      gst_structure_free (query->structure);
+      g_slice_free1 (sizeof (GstQueryImpl), query);
+    }
+  }
+}
+
 static void
 _gst_query_free (GstQuery * query)
 {
@@ -195,6 +308,9 @@ _gst_query_free (GstQuery * query)
 
   g_return_if_fail (query != NULL);
 
+  if (gst_query_cache_put (query))
+    return;
+
   s = GST_QUERY_STRUCTURE (query);
   if (s) {
     gst_structure_set_parent_refcount (s, NULL);
@@ -237,6 +353,13 @@ gst_query_new_position (GstFormat format)
   GstQuery *query;
   GstStructure *structure;
 
+  if ((query = gst_query_cache_take (GST_QUERY_POSITION))) {
+    gst_structure_id_set (GST_QUERY_STRUCTURE (query),
+        GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
+        GST_QUARK (CURRENT), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
+    return query;
+  }
+
   structure = gst_structure_new_id (GST_QUARK (QUERY_POSITION),
       GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
       GST_QUARK (CURRENT), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
@@ -316,6 +439,13 @@ gst_query_new_duration (GstFormat format)
   GstQuery *query;
   GstStructure *structure;
 
+  if ((query = gst_query_cache_take (GST_QUERY_DURATION))) {
+    gst_structure_id_set (GST_QUERY_STRUCTURE (query),
+        GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
+        GST_QUARK (DURATION), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
+    return query;
+  }
+
   structure = gst_structure_new_id (GST_QUARK (QUERY_DURATION),
       GST_QUARK (FORMAT), GST_TYPE_FORMAT, format,
       GST_QUARK (DURATION), G_TYPE_INT64, G_GINT64_CONSTANT (-1), NULL);
@@ -393,6 +523,14 @@ gst_query_new_latency (void)
   GstQuery *query;
   GstStructure *structure;
 
+  if ((query = gst_query_cache_take (GST_QUERY_LATENCY))) {
+    gst_structure_id_set (GST_QUERY_STRUCTURE (query),
+        GST_QUARK (LIVE), G_TYPE_BOOLEAN, FALSE,
+        GST_QUARK (MIN_LATENCY), G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+        GST_QUARK (MAX_LATENCY), G_TYPE_UINT64, G_GUINT64_CONSTANT (-1), NULL);
+    return query;
+  }
+
   structure = gst_structure_new_id (GST_QUARK (QUERY_LATENCY),
       GST_QUARK (LIVE), G_TYPE_BOOLEAN, FALSE,
       GST_QUARK (MIN_LATENCY), G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
@@ -2378,3 +2516,179 @@ gst_query_new_drain (void)
 
   return query;
 }
+
+/**
+ * gst_query_new_memory_usage:
+ *
+ * Constructs a new query object for collecting the memory that elements hold.
+ * Elements that allocate or queue buffers add an entry for themselves with
+ * gst_query_add_memory_usage(). #GstBin sends the query to all of its
+ * children, so a query on a pipeline collects the usage of every element in
+ * it. The query is not forwarded to peer pads.
+ *
+ * Free-function: gst_query_unref
+ *
+ * Returns: (transfer full): a new #GstQuery
+ *
+ * Since: 1.2
+ */
+GstQuery *
+gst_query_new_memory_usage (void)
+{
+  GstQuery *query;
+  GstStructure *structure;
+
+  structure = gst_structure_new_id_empty (GST_QUARK (QUERY_MEMORY_USAGE));
+  query = gst_query_new_custom (GST_QUERY_MEMORY_USAGE, structure);
+
+  return query;
+}
+
+typedef struct
+{
+  gchar *owner;
+  guint64 allocated;
+  guint64 queued;
+} MemoryUsage;
+
+static void
+memory_usage_free (MemoryUsage * usage)
+{
+  g_free (usage->owner);
+}
+
+/**
+ * gst_query_add_memory_usage:
+ * @query: a GST_QUERY_MEMORY_USAGE type query #GstQuery
+ * @owner: the #GstObject that holds the memory
+ * @allocated: the bytes allocated by @owner, for example in its buffer pool
+ * @queued: the bytes of the buffers that @owner keeps queued
+ *
+ * Add the memory that @owner holds to @query. @owner is stored as its path
+ * string.
+ *
+ * Since: 1.2
+ */
+void
+gst_query_add_memory_usage (GstQuery * query, GstObject * owner,
+    guint64 allocated, guint64 queued)
+{
+  GArray *array;
+  GstStructure *structure;
+  MemoryUsage usage;
+
+  g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE);
+  g_return_if_fail (gst_query_is_writable (query));
+  g_return_if_fail (GST_IS_OBJECT (owner));
+
+  structure = GST_QUERY_STRUCTURE (query);
+  array = ensure_array (structure, GST_QUARK (MEMORY_USAGE),
+      sizeof (MemoryUsage), (GDestroyNotify) memory_usage_free);
+
+  usage.owner = gst_object_get_path_string (owner);
+  usage.allocated = allocated;
+  usage.queued = queued;
+
+  g_array_append_val (array, usage);
+}
+
+/**
+ * gst_query_get_n_memory_usages:
+ * @query: a GST_QUERY_MEMORY_USAGE type query #GstQuery
+ *
+ * Retrieve the number of entries in @query.
+ *
+ * Returns: the number of entries.
+ *
+ * Since: 1.2
+ */
+guint
+gst_query_get_n_memory_usages (GstQuery * query)
+{
+  GArray *array;
+  GstStructure *structure;
+
+  g_return_val_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE, 0);
+
+  structure = GST_QUERY_STRUCTURE (query);
+  array = ensure_array (structure, GST_QUARK (MEMORY_USAGE),
+      sizeof (MemoryUsage), (GDestroyNotify) memory_usage_free);
+
+  return array->len;
+}
+
+/**
+ * gst_query_parse_nth_memory_usage:
+ * @query: a GST_QUERY_MEMORY_USAGE type query #GstQuery
+ * @index: index of the entry
+ * @owner: (out) (allow-none) (transfer full): the path string of the owner
+ * @allocated: (out) (allow-none): the allocated bytes
+ * @queued: (out) (allow-none): the queued bytes
+ *
+ * Get the entry at @index in @query. Free @owner with g_free() when it's not
+ * needed any more.
+ *
+ * Since: 1.2
+ */
+void
+gst_query_parse_nth_memory_usage (GstQuery * query, guint index,
+    gchar ** owner, guint64 * allocated, guint64 * queued)
+{
+  GArray *array;
+  GstStructure *structure;
+  MemoryUsage *usage;
+
+  g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE);
+
+  structure = GST_QUERY_STRUCTURE (query);
+  array = ensure_array (structure, GST_QUARK (MEMORY_USAGE),
+      sizeof (MemoryUsage), (GDestroyNotify) memory_usage_free);
+  g_return_if_fail (index < array->len);
+
+  usage = &g_array_index (array, MemoryUsage, index);
+
+  if (owner)
+    *owner = g_strdup (usage->owner);
+  if (allocated)
+    *allocated = usage->allocated;
+  if (queued)
+    *queued = usage->queued;
+}
+
+/**
+ * gst_query_parse_memory_usage:
+ * @query: a GST_QUERY_MEMORY_USAGE type query #GstQuery
+ * @allocated: (out) (allow-none): the total allocated bytes
+ * @queued: (out) (allow-none): the total queued bytes
+ *
+ * Get the sum of all the entries in @query.
+ *
+ * Since: 1.2
+ */
+void
+gst_query_parse_memory_usage (GstQuery * query, guint64 * allocated,
+    guint64 * queued)
+{
+  GArray *array;
+  GstStructure *structure;
+  guint64 total_allocated = 0, total_queued = 0;
+  guint i;
+
+  g_return_if_fail (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE);
+
+  structure = GST_QUERY_STRUCTURE (query);
+  array = ensure_array (structure, GST_QUARK (MEMORY_USAGE),
+      sizeof (MemoryUsage), (GDestroyNotify) memory_usage_free);
+
+  for (i = 0; i < array->len; i++) {
+    MemoryUsage *usage = &g_array_index (array, MemoryUsage, i);
+
+    total_allocated += usage->allocated;
+    total_queued += usage->queued;
+  }
+
+  if (allocated)
+    *allocated = total_allocated;
+  if (queued)
+    *queued = total_queued;
+}
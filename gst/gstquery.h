@@ -101,6 +101,7 @@ typedef enum {
  * @GST_QUERY_ACCEPT_CAPS: the accept caps query
  * @GST_QUERY_CAPS: the caps query
  * @GST_QUERY_DRAIN: wait till all serialized data is consumed downstream
+ * @GST_QUERY_MEMORY_USAGE: the memory held by elements. Since: 1.2
  *
  * Standard predefined Query types
  */
@@ -124,7 +125,8 @@ typedef enum {
   GST_QUERY_SCHEDULING   = GST_QUERY_MAKE_TYPE (150, FLAG(UPSTREAM)),
   GST_QUERY_ACCEPT_CAPS  = GST_QUERY_MAKE_TYPE (160, FLAG(BOTH)),
   GST_QUERY_CAPS         = GST_QUERY_MAKE_TYPE (170, FLAG(BOTH)),
-  GST_QUERY_DRAIN        = GST_QUERY_MAKE_TYPE (180, FLAG(DOWNSTREAM) | FLAG(SERIALIZED))
+  GST_QUERY_DRAIN        = GST_QUERY_MAKE_TYPE (180, FLAG(DOWNSTREAM) | FLAG(SERIALIZED)),
+  GST_QUERY_MEMORY_USAGE = GST_QUERY_MAKE_TYPE (190, FLAG(BOTH))
 } GstQueryType;
 #undef FLAG
 
@@ -475,6 +477,18 @@ void            gst_query_parse_caps_result        (GstQuery *query, GstCaps **c
 /* drain query */
 GstQuery *      gst_query_new_drain                (void) G_GNUC_MALLOC;
 
+/* memory usage query */
+GstQuery *      gst_query_new_memory_usage         (void) G_GNUC_MALLOC;
+
+void            gst_query_add_memory_usage         (GstQuery *query, GstObject *owner,
+                                                    guint64 allocated, guint64 queued);
+guint           gst_query_get_n_memory_usages      (GstQuery *query);
+void            gst_query_parse_nth_memory_usage   (GstQuery *query, guint index,
+                                                    gchar **owner, guint64 *allocated,
+                                                    guint64 *queued);
+void            gst_query_parse_memory_usage       (GstQuery *query, guint64 *allocated,
+                                                    guint64 *queued);
+
 G_END_DECLS
 
 #endif /* __GST_QUERY_H__ */
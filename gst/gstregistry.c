@@ -138,8 +138,21 @@ extern HMODULE _priv_gst_dll_handle;
 
 #define GST_CAT_DEFAULT GST_CAT_REGISTRY
 
+/* the plugins, the features and their hash tables are protected by the
+ * registry lock. Lookups take it for reading so that they don't block each
+ * other, it is only taken for writing when plugins and features are added or
+ * removed. The caches of the feature lists and the URI index are updated
+ * while reading, they are protected by the object lock, which is taken after
+ * the registry lock. */
+#define GST_REGISTRY_READ_LOCK(r)     g_rw_lock_reader_lock (&(r)->priv->lock)
+#define GST_REGISTRY_READ_UNLOCK(r)   g_rw_lock_reader_unlock (&(r)->priv->lock)
+#define GST_REGISTRY_WRITE_LOCK(r)    g_rw_lock_writer_lock (&(r)->priv->lock)
+#define GST_REGISTRY_WRITE_UNLOCK(r)  g_rw_lock_writer_unlock (&(r)->priv->lock)
+
 struct _GstRegistryPrivate
 {
+  GRWLock lock;
+
   GList *plugins;
   GList *features;
 
@@ -161,8 +174,40 @@ struct _GstRegistryPrivate
   guint32 efl_cookie;
   GList *typefind_factory_list;
   guint32 tfl_cookie;
+
+  /* URI handler factories for gst_element_make_from_uri(), lower case
+   * protocol -> GList of factories sorted by rank. Rebuilt when the feature
+   * list or a rank changed. */
+  GHashTable *uri_src_index;
+  GHashTable *uri_sink_index;
+  guint32 uri_cookie;
+  gint uri_rank_cookie;
+
+  /* features of the binary registry that are created when they are first
+   * looked up, name -> GstRegistryLazyFeature. The entries point into the
+   * registry data in lazy_data. Protected by lazy_lock, which is taken before
+   * the registry lock. */
+  GRecMutex lazy_lock;
+  GHashTable *lazy_features;
+  GSList *lazy_data;
+  /* features being created, the data must stay valid meanwhile */
+  guint lazy_creating;
 };
 
+typedef struct
+{
+  /* weak pointer, the feature is dropped when the plugin goes away */
+  GstPlugin *plugin;
+  gchar *in;
+  gchar *end;
+} GstRegistryLazyFeature;
+
+typedef struct
+{
+  gpointer data;
+  GDestroyNotify free_func;
+} GstRegistryLazyData;
+
 /* the one instance of the default registry and the mutex protecting the
  * variable. */
 static GMutex _gst_registry_mutex;
@@ -170,6 +215,10 @@ static GstRegistry *_gst_registry_default = NULL;
 
 /* defaults */
 #define DEFAULT_FORK TRUE
+/* maximum number of plugin scanner processes used at the same time, the
+ * default is the number of processors up to this value */
+#define MAX_SCAN_HELPERS 16
+#define DEFAULT_SCAN_HELPERS 4
 
 /* control the behaviour of registry rebuild */
 static gboolean _gst_enable_registry_fork = DEFAULT_FORK;
@@ -253,8 +302,13 @@ gst_registry_init (GstRegistry * registry)
       GstRegistryPrivate);
   registry->priv->feature_hash = g_hash_table_new (g_str_hash, g_str_equal);
   registry->priv->basename_hash = g_hash_table_new (g_str_hash, g_str_equal);
+  g_rec_mutex_init (&registry->priv->lazy_lock);
+  g_rw_lock_init (&registry->priv->lock);
 }
 
+static void gst_registry_release_lazy_data_locked (GstRegistry * registry);
+static void uri_index_free (GHashTable * index);
+
 static void
 gst_registry_finalize (GObject * object)
 {
@@ -266,6 +320,16 @@ gst_registry_finalize (GObject * object)
   registry->priv->plugins = NULL;
 
   GST_DEBUG_OBJECT (registry, "registry finalize");
+
+  /* drop the features that were never created */
+  if (registry->priv->lazy_features) {
+    g_hash_table_destroy (registry->priv->lazy_features);
+    registry->priv->lazy_features = NULL;
+  }
+  gst_registry_release_lazy_data_locked (registry);
+  g_rec_mutex_clear (&registry->priv->lazy_lock);
+  g_rw_lock_clear (&registry->priv->lock);
+
   p = plugins;
   while (p) {
     GstPlugin *plugin = p->data;
@@ -310,6 +374,11 @@ gst_registry_finalize (GObject * object)
     gst_plugin_feature_list_free (registry->priv->typefind_factory_list);
   }
 
+  if (registry->priv->uri_src_index) {
+    uri_index_free (registry->priv->uri_src_index);
+    uri_index_free (registry->priv->uri_sink_index);
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -429,7 +498,7 @@ gst_registry_add_plugin (GstRegistry * registry, GstPlugin * plugin)
   g_return_val_if_fail (GST_IS_REGISTRY (registry), FALSE);
   g_return_val_if_fail (GST_IS_PLUGIN (plugin), FALSE);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_WRITE_LOCK (registry);
   if (G_LIKELY (plugin->basename)) {
     /* we have a basename, see if we find the plugin */
     existing_plugin =
@@ -447,7 +516,7 @@ gst_registry_add_plugin (GstRegistry * registry, GstPlugin * plugin)
             "Not replacing plugin because new one (%s) is blacklisted but for a different location than existing one (%s)",
             plugin->filename, existing_plugin->filename);
         gst_object_unref (plugin);
-        GST_OBJECT_UNLOCK (registry);
+        GST_REGISTRY_WRITE_UNLOCK (registry);
         return FALSE;
       }
       registry->priv->plugins =
@@ -468,7 +537,7 @@ gst_registry_add_plugin (GstRegistry * registry, GstPlugin * plugin)
         plugin);
 
   gst_object_ref_sink (plugin);
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_WRITE_UNLOCK (registry);
 
   GST_LOG_OBJECT (registry, "emitting plugin-added for filename \"%s\"",
       GST_STR_NULL (plugin->filename));
@@ -508,6 +577,204 @@ gst_registry_remove_features_for_plugin_unlocked (GstRegistry * registry,
   registry->priv->cookie++;
 }
 
+static void
+gst_registry_lazy_feature_free (GstRegistryLazyFeature * lazy)
+{
+  if (lazy->plugin)
+    g_object_remove_weak_pointer ((GObject *) lazy->plugin,
+        (gpointer *) & lazy->plugin);
+  g_slice_free (GstRegistryLazyFeature, lazy);
+}
+
+/* frees the registry data when no feature needs it anymore, must be called
+ * with the lazy lock */
+static void
+gst_registry_release_lazy_data_locked (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+
+  if (priv->lazy_creating > 0)
+    return;
+
+  if (priv->lazy_features) {
+    if (g_hash_table_size (priv->lazy_features) > 0)
+      return;
+    g_hash_table_destroy (priv->lazy_features);
+    priv->lazy_features = NULL;
+  }
+
+  while (priv->lazy_data) {
+    GstRegistryLazyData *data = priv->lazy_data->data;
+
+    GST_DEBUG_OBJECT (registry, "releasing registry data %p", data->data);
+    data->free_func (data->data);
+    g_slice_free (GstRegistryLazyData, data);
+    priv->lazy_data = g_slist_delete_link (priv->lazy_data, priv->lazy_data);
+  }
+}
+
+/*
+ * _priv_gst_registry_add_lazy_feature:
+ * @registry: a #GstRegistry
+ * @name: the name of the feature, must stay valid as long as the data
+ * @plugin: the plugin of the feature
+ * @in: the start of the serialized feature
+ * @end: the end of the registry data
+ *
+ * Remembers a feature of the binary registry that is created by
+ * gst_registry_lookup_feature() or when all features of the registry are
+ * needed. The data must be given to the registry with
+ * _priv_gst_registry_take_lazy_data().
+ */
+void
+_priv_gst_registry_add_lazy_feature (GstRegistry * registry,
+    const gchar * name, GstPlugin * plugin, gchar * in, gchar * end)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GstRegistryLazyFeature *lazy;
+
+  lazy = g_slice_new (GstRegistryLazyFeature);
+  lazy->plugin = plugin;
+  lazy->in = in;
+  lazy->end = end;
+  g_object_add_weak_pointer ((GObject *) plugin, (gpointer *) & lazy->plugin);
+
+  g_rec_mutex_lock (&priv->lazy_lock);
+  if (priv->lazy_features == NULL)
+    priv->lazy_features = g_hash_table_new_full (g_str_hash, g_str_equal,
+        NULL, (GDestroyNotify) gst_registry_lazy_feature_free);
+  g_hash_table_replace (priv->lazy_features, (gpointer) name, lazy);
+  g_rec_mutex_unlock (&priv->lazy_lock);
+}
+
+/*
+ * _priv_gst_registry_take_lazy_data:
+ * @registry: a #GstRegistry
+ * @data: the registry data
+ * @free_func: function to free @data
+ *
+ * Keeps the registry data that the features added with
+ * _priv_gst_registry_add_lazy_feature() point to until all of them are
+ * created or removed.
+ */
+void
+_priv_gst_registry_take_lazy_data (GstRegistry * registry, gpointer data,
+    GDestroyNotify free_func)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GstRegistryLazyData *lazy_data;
+
+  lazy_data = g_slice_new (GstRegistryLazyData);
+  lazy_data->data = data;
+  lazy_data->free_func = free_func;
+
+  g_rec_mutex_lock (&priv->lazy_lock);
+  priv->lazy_data = g_slist_prepend (priv->lazy_data, lazy_data);
+  gst_registry_release_lazy_data_locked (registry);
+  g_rec_mutex_unlock (&priv->lazy_lock);
+}
+
+/* creates the feature @name from the registry data, must be called with the
+ * lazy lock */
+static void
+gst_registry_create_lazy_feature_locked (GstRegistry * registry,
+    const gchar * name, GstRegistryLazyFeature * lazy)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GstPluginFeature *existing;
+  gchar *in = lazy->in;
+
+  if (lazy->plugin == NULL) {
+    GST_DEBUG_OBJECT (registry, "plugin of feature %s is gone", name);
+    return;
+  }
+
+  /* a feature that was added after the registry was read wins */
+  GST_REGISTRY_READ_LOCK (registry);
+  existing = gst_registry_lookup_feature_locked (registry, name);
+  GST_REGISTRY_READ_UNLOCK (registry);
+  if (existing)
+    return;
+
+  GST_LOG_OBJECT (registry, "creating feature %s", name);
+  priv->lazy_creating++;
+  if (!_priv_gst_registry_chunks_load_feature (registry, &in, lazy->end,
+          lazy->plugin))
+    GST_WARNING_OBJECT (registry, "could not create feature %s", name);
+  priv->lazy_creating--;
+}
+
+/* creates the feature @name if it was not created yet */
+static void
+gst_registry_create_lazy_feature (GstRegistry * registry, const gchar * name)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GstRegistryLazyFeature *lazy;
+
+  g_rec_mutex_lock (&priv->lazy_lock);
+  if (priv->lazy_features &&
+      (lazy = g_hash_table_lookup (priv->lazy_features, name))) {
+    g_hash_table_steal (priv->lazy_features, name);
+    gst_registry_create_lazy_feature_locked (registry, name, lazy);
+    gst_registry_lazy_feature_free (lazy);
+    gst_registry_release_lazy_data_locked (registry);
+  }
+  g_rec_mutex_unlock (&priv->lazy_lock);
+}
+
+/* creates all features that were not created yet, for the functions that
+ * return all features */
+static void
+gst_registry_create_lazy_features (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_rec_mutex_lock (&priv->lazy_lock);
+  if (priv->lazy_features) {
+    GST_DEBUG_OBJECT (registry, "creating all %u remaining features",
+        g_hash_table_size (priv->lazy_features));
+
+    /* signal handlers can look up features while we create them, so take
+     * the entries out of the hash table one by one */
+    while (priv->lazy_features) {
+      g_hash_table_iter_init (&iter, priv->lazy_features);
+      if (!g_hash_table_iter_next (&iter, &key, &value))
+        break;
+      g_hash_table_iter_steal (&iter);
+      gst_registry_create_lazy_feature_locked (registry, key, value);
+      gst_registry_lazy_feature_free (value);
+    }
+    gst_registry_release_lazy_data_locked (registry);
+  }
+  g_rec_mutex_unlock (&priv->lazy_lock);
+}
+
+static gboolean
+gst_registry_lazy_feature_is_for_plugin (gpointer key, gpointer value,
+    gpointer plugin)
+{
+  GstRegistryLazyFeature *lazy = value;
+
+  return lazy->plugin == plugin;
+}
+
+static void
+gst_registry_remove_lazy_features_for_plugin (GstRegistry * registry,
+    GstPlugin * plugin)
+{
+  GstRegistryPrivate *priv = registry->priv;
+
+  g_rec_mutex_lock (&priv->lazy_lock);
+  if (priv->lazy_features) {
+    g_hash_table_foreach_remove (priv->lazy_features,
+        gst_registry_lazy_feature_is_for_plugin, plugin);
+    gst_registry_release_lazy_data_locked (registry);
+  }
+  g_rec_mutex_unlock (&priv->lazy_lock);
+}
+
 /**
  * gst_registry_remove_plugin:
  * @registry: the registry to remove the plugin from
@@ -526,12 +793,14 @@ gst_registry_remove_plugin (GstRegistry * registry, GstPlugin * plugin)
   GST_DEBUG_OBJECT (registry, "removing plugin %p (%s)",
       plugin, gst_plugin_get_name (plugin));
 
-  GST_OBJECT_LOCK (registry);
+  gst_registry_remove_lazy_features_for_plugin (registry, plugin);
+
+  GST_REGISTRY_WRITE_LOCK (registry);
   registry->priv->plugins = g_list_remove (registry->priv->plugins, plugin);
   if (G_LIKELY (plugin->basename))
     g_hash_table_remove (registry->priv->basename_hash, plugin->basename);
   gst_registry_remove_features_for_plugin_unlocked (registry, plugin);
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_WRITE_UNLOCK (registry);
   gst_object_unref (plugin);
 }
 
@@ -557,7 +826,7 @@ gst_registry_add_feature (GstRegistry * registry, GstPluginFeature * feature)
   g_return_val_if_fail (GST_OBJECT_NAME (feature) != NULL, FALSE);
   g_return_val_if_fail (feature->plugin_name != NULL, FALSE);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_WRITE_LOCK (registry);
   existing_feature = gst_registry_lookup_feature_locked (registry,
       GST_OBJECT_NAME (feature));
   if (G_UNLIKELY (existing_feature)) {
@@ -586,7 +855,7 @@ gst_registry_add_feature (GstRegistry * registry, GstPluginFeature * feature)
   gst_object_set_parent (GST_OBJECT_CAST (feature), GST_OBJECT_CAST (registry));
 
   registry->priv->cookie++;
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_WRITE_UNLOCK (registry);
 
   GST_LOG_OBJECT (registry, "emitting feature-added for %s",
       GST_OBJECT_NAME (feature));
@@ -613,11 +882,11 @@ gst_registry_remove_feature (GstRegistry * registry, GstPluginFeature * feature)
   GST_DEBUG_OBJECT (registry, "removing feature %p (%s)",
       feature, gst_plugin_feature_get_name (feature));
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_WRITE_LOCK (registry);
   registry->priv->features = g_list_remove (registry->priv->features, feature);
   g_hash_table_remove (registry->priv->feature_hash, GST_OBJECT_NAME (feature));
   registry->priv->cookie++;
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_WRITE_UNLOCK (registry);
 
   gst_object_unparent ((GstObject *) feature);
 }
@@ -648,7 +917,7 @@ gst_registry_plugin_filter (GstRegistry * registry,
 
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_READ_LOCK (registry);
   {
     const GList *walk;
 
@@ -663,7 +932,7 @@ gst_registry_plugin_filter (GstRegistry * registry,
       }
     }
   }
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
 
   return list;
 }
@@ -686,7 +955,7 @@ gst_plugin_feature_type_name_filter (GstPluginFeature * feature,
 
 /* returns TRUE if the list was changed
  *
- * Must be called with the object lock taken */
+ * Must be called with the registry lock and the object lock taken */
 static gboolean
 gst_registry_get_feature_list_or_create (GstRegistry * registry,
     GList ** previous, guint32 * cookie, GType type)
@@ -738,6 +1007,9 @@ gst_registry_get_element_factory_list (GstRegistry * registry)
 {
   GList *list;
 
+  gst_registry_create_lazy_features (registry);
+
+  GST_REGISTRY_READ_LOCK (registry);
   GST_OBJECT_LOCK (registry);
 
   gst_registry_get_feature_list_or_create (registry,
@@ -748,6 +1020,7 @@ gst_registry_get_element_factory_list (GstRegistry * registry)
   list = gst_plugin_feature_list_copy (registry->priv->element_factory_list);
 
   GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
 
   return list;
 }
@@ -757,6 +1030,9 @@ gst_registry_get_typefind_factory_list (GstRegistry * registry)
 {
   GList *list;
 
+  gst_registry_create_lazy_features (registry);
+
+  GST_REGISTRY_READ_LOCK (registry);
   GST_OBJECT_LOCK (registry);
 
   if (G_UNLIKELY (gst_registry_get_feature_list_or_create (registry,
@@ -770,6 +1046,149 @@ gst_registry_get_typefind_factory_list (GstRegistry * registry)
   list = gst_plugin_feature_list_copy (registry->priv->typefind_factory_list);
 
   GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
+
+  return list;
+}
+
+static gint
+uri_factory_rank_cmp (GstPluginFeature * first, GstPluginFeature * second)
+{
+  return gst_plugin_feature_get_rank (second) -
+      gst_plugin_feature_get_rank (first);
+}
+
+/* the lists are not owned by the hash table because they change when
+ * prepending and sorting */
+static void
+uri_index_free (GHashTable * index)
+{
+  GHashTableIter iter;
+  gpointer factories;
+
+  g_hash_table_iter_init (&iter, index);
+  while (g_hash_table_iter_next (&iter, NULL, &factories))
+    gst_plugin_feature_list_free (factories);
+  g_hash_table_destroy (index);
+}
+
+static void
+uri_index_sort (GHashTable * index)
+{
+  GHashTableIter iter;
+  gpointer factories;
+
+  g_hash_table_iter_init (&iter, index);
+  while (g_hash_table_iter_next (&iter, NULL, &factories))
+    g_hash_table_iter_replace (&iter, g_list_sort (factories,
+            (GCompareFunc) uri_factory_rank_cmp));
+}
+
+/* Must be called with the registry lock and the object lock taken */
+static void
+gst_registry_update_uri_index (GstRegistry * registry)
+{
+  GstRegistryPrivate *priv = registry->priv;
+  gint rank_cookie;
+  const GList *walk;
+
+  rank_cookie = g_atomic_int_get (&_priv_gst_plugin_feature_rank_cookie);
+  if (G_LIKELY (priv->uri_src_index && priv->uri_cookie == priv->cookie &&
+          priv->uri_rank_cookie == rank_cookie))
+    return;
+
+  GST_DEBUG_OBJECT (registry, "building URI handler index");
+
+  if (priv->uri_src_index) {
+    uri_index_free (priv->uri_src_index);
+    uri_index_free (priv->uri_sink_index);
+  }
+  priv->uri_src_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, NULL);
+  priv->uri_sink_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, NULL);
+
+  /* prepend in the order of the features, that is the order in which
+   * gst_registry_feature_filter() returned them before */
+  for (walk = priv->features; walk != NULL; walk = walk->next) {
+    GstPluginFeature *feature = walk->data;
+    GstElementFactory *factory;
+    const gchar *const *protocols;
+    GHashTable *index;
+
+    if (!GST_IS_ELEMENT_FACTORY (feature))
+      continue;
+    factory = GST_ELEMENT_FACTORY_CAST (feature);
+
+    if (factory->uri_type == GST_URI_SRC)
+      index = priv->uri_src_index;
+    else if (factory->uri_type == GST_URI_SINK)
+      index = priv->uri_sink_index;
+    else
+      continue;
+
+    protocols = gst_element_factory_get_uri_protocols (factory);
+    if (protocols == NULL) {
+      g_warning ("Factory '%s' implements GstUriHandler interface but returned "
+          "no supported protocols!", gst_plugin_feature_get_name (feature));
+      continue;
+    }
+
+    for (; *protocols != NULL; protocols++) {
+      gchar *protocol = g_ascii_strdown (*protocols, -1);
+      GList *factories = g_hash_table_lookup (index, protocol);
+
+      /* a protocol can be listed twice in a different case */
+      if (factories != NULL && factories->data == factory) {
+        g_free (protocol);
+        continue;
+      }
+      factories = g_list_prepend (factories, gst_object_ref (factory));
+      g_hash_table_insert (index, protocol, factories);
+    }
+  }
+
+  uri_index_sort (priv->uri_src_index);
+  uri_index_sort (priv->uri_sink_index);
+
+  priv->uri_cookie = priv->cookie;
+  priv->uri_rank_cookie = rank_cookie;
+}
+
+/*
+ * _priv_gst_registry_get_uri_factories:
+ * @registry: the registry
+ * @type: %GST_URI_SRC or %GST_URI_SINK
+ * @protocol: the URI protocol
+ *
+ * Gets the element factories that handle @protocol for @type, sorted by
+ * rank, from an index that is kept up to date with the registry.
+ *
+ * Returns: a #GList of #GstElementFactory, use gst_plugin_feature_list_free()
+ *     after usage.
+ */
+GList *
+_priv_gst_registry_get_uri_factories (GstRegistry * registry, GstURIType type,
+    const gchar * protocol)
+{
+  GHashTable *index;
+  gchar *key;
+  GList *list;
+
+  gst_registry_create_lazy_features (registry);
+
+  key = g_ascii_strdown (protocol, -1);
+
+  GST_REGISTRY_READ_LOCK (registry);
+  GST_OBJECT_LOCK (registry);
+  gst_registry_update_uri_index (registry);
+  index = (type == GST_URI_SRC) ? registry->priv->uri_src_index :
+      registry->priv->uri_sink_index;
+  list = gst_plugin_feature_list_copy (g_hash_table_lookup (index, key));
+  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
+
+  g_free (key);
 
   return list;
 }
@@ -799,7 +1218,9 @@ gst_registry_feature_filter (GstRegistry * registry,
 
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
 
-  GST_OBJECT_LOCK (registry);
+  gst_registry_create_lazy_features (registry);
+
+  GST_REGISTRY_READ_LOCK (registry);
   {
     const GList *walk;
 
@@ -814,7 +1235,7 @@ gst_registry_feature_filter (GstRegistry * registry,
       }
     }
   }
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
 
   return list;
 }
@@ -945,12 +1366,12 @@ gst_registry_get_plugin_list (GstRegistry * registry)
 
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_READ_LOCK (registry);
   list = g_list_copy (registry->priv->plugins);
   for (g = list; g; g = g->next) {
     gst_object_ref (GST_PLUGIN_CAST (g->data));
   }
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
 
   return list;
 }
@@ -981,11 +1402,22 @@ gst_registry_lookup_feature (GstRegistry * registry, const char *name)
   g_return_val_if_fail (GST_IS_REGISTRY (registry), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_READ_LOCK (registry);
   feature = gst_registry_lookup_feature_locked (registry, name);
   if (feature)
     gst_object_ref (feature);
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
+
+  if (G_UNLIKELY (feature == NULL)) {
+    /* it might not be created yet */
+    gst_registry_create_lazy_feature (registry, name);
+
+    GST_REGISTRY_READ_LOCK (registry);
+    feature = gst_registry_lookup_feature_locked (registry, name);
+    if (feature)
+      gst_object_ref (feature);
+    GST_REGISTRY_READ_UNLOCK (registry);
+  }
 
   return feature;
 }
@@ -1001,11 +1433,11 @@ gst_registry_lookup_bn (GstRegistry * registry, const char *basename)
 {
   GstPlugin *plugin;
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_READ_LOCK (registry);
   plugin = gst_registry_lookup_bn_locked (registry, basename);
   if (plugin)
     gst_object_ref (plugin);
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_READ_UNLOCK (registry);
 
   return plugin;
 }
@@ -1052,10 +1484,33 @@ typedef struct
 {
   GstRegistry *registry;
   GstRegistryScanHelperState helper_state;
-  GstPluginLoader *helper;
+  /* the plugin files are handed out to the helpers round robin, each helper
+   * loads its files in its own scanner process */
+  GstPluginLoader *helpers[MAX_SCAN_HELPERS];
+  guint n_helpers;
+  guint next_helper;
   gboolean changed;
 } GstRegistryScanContext;
 
+static guint
+get_n_scan_helpers (void)
+{
+  const gchar *env;
+  guint n;
+
+  if ((env = g_getenv ("GST_REGISTRY_SCANNERS"))) {
+    n = (guint) g_ascii_strtoull (env, NULL, 10);
+  } else {
+#if GLIB_CHECK_VERSION(2,36,0)
+    n = MIN (g_get_num_processors (), DEFAULT_SCAN_HELPERS);
+#else
+    n = 1;
+#endif
+  }
+
+  return CLAMP (n, 1, MAX_SCAN_HELPERS);
+}
+
 static void
 init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
 {
@@ -1080,17 +1535,26 @@ init_scan_context (GstRegistryScanContext * context, GstRegistry * registry)
   else
     context->helper_state = REGISTRY_SCAN_HELPER_DISABLED;
 
-  context->helper = NULL;
+  memset (context->helpers, 0, sizeof (context->helpers));
+  context->n_helpers = get_n_scan_helpers ();
+  context->next_helper = 0;
   context->changed = FALSE;
 }
 
 static void
 clear_scan_context (GstRegistryScanContext * context)
 {
-  if (context->helper) {
-    context->changed |= _priv_gst_plugin_loader_funcs.destroy (context->helper);
-    context->helper = NULL;
+  guint i;
+
+  /* this waits for the remaining results of each scanner */
+  for (i = 0; i < MAX_SCAN_HELPERS; i++) {
+    if (context->helpers[i]) {
+      context->changed |=
+          _priv_gst_plugin_loader_funcs.destroy (context->helpers[i]);
+      context->helpers[i] = NULL;
+    }
   }
+  context->next_helper = 0;
 }
 
 static gboolean
@@ -1109,18 +1573,36 @@ gst_registry_scan_plugin_file (GstRegistryScanContext * context,
   /* Have a plugin to load - see if the scan-helper needs starting */
   if (context->helper_state == REGISTRY_SCAN_HELPER_NOT_STARTED) {
     GST_DEBUG ("Starting plugin scanner for file %s", filename);
-    context->helper = _priv_gst_plugin_loader_funcs.create (context->registry);
-    if (context->helper != NULL)
+    context->helpers[0] =
+        _priv_gst_plugin_loader_funcs.create (context->registry);
+    if (context->helpers[0] != NULL) {
       context->helper_state = REGISTRY_SCAN_HELPER_RUNNING;
-    else {
+      context->next_helper = 0;
+    } else {
       GST_WARNING ("Failed starting plugin scanner. Scanning in-process");
       context->helper_state = REGISTRY_SCAN_HELPER_DISABLED;
     }
   }
 
   if (context->helper_state == REGISTRY_SCAN_HELPER_RUNNING) {
-    GST_DEBUG ("Using scan-helper to load plugin %s", filename);
-    if (!_priv_gst_plugin_loader_funcs.load (context->helper,
+    guint idx = context->next_helper;
+
+    /* the other scanners are started when they get their first file */
+    if (context->helpers[idx] == NULL) {
+      GST_DEBUG ("Starting plugin scanner %u for file %s", idx, filename);
+      context->helpers[idx] =
+          _priv_gst_plugin_loader_funcs.create (context->registry);
+      if (context->helpers[idx] == NULL) {
+        GST_WARNING ("Failed starting plugin scanner %u, using %u scanners",
+            idx, idx);
+        context->n_helpers = idx;
+        idx = 0;
+      }
+    }
+    context->next_helper = (idx + 1) % context->n_helpers;
+
+    GST_DEBUG ("Using scan-helper %u to load plugin %s", idx, filename);
+    if (!_priv_gst_plugin_loader_funcs.load (context->helpers[idx],
             filename, file_size, file_mtime)) {
       g_warning ("External plugin loader failed. This most likely means that "
           "the plugin loader helper binary was not found or could not be run. "
@@ -1387,11 +1869,19 @@ gst_registry_get_feature_list_by_plugin (GstRegistry * registry,
 }
 
 /* Unref and delete the default registry */
+#ifndef GST_DISABLE_REGISTRY
+static void registry_update_thread_join (void);
+#endif
+
 void
 _priv_gst_registry_cleanup (void)
 {
   GstRegistry *registry;
 
+#ifndef GST_DISABLE_REGISTRY
+  registry_update_thread_join ();
+#endif
+
   g_mutex_lock (&_gst_registry_mutex);
   if ((registry = _gst_registry_default) != NULL) {
     _gst_registry_default = NULL;
@@ -1482,7 +1972,7 @@ gst_registry_remove_cache_plugins (GstRegistry * registry)
 
   g_return_val_if_fail (GST_IS_REGISTRY (registry), FALSE);
 
-  GST_OBJECT_LOCK (registry);
+  GST_REGISTRY_WRITE_LOCK (registry);
 
   GST_DEBUG_OBJECT (registry, "removing cached plugins");
   g = registry->priv->plugins;
@@ -1502,7 +1992,7 @@ gst_registry_remove_cache_plugins (GstRegistry * registry)
     g = g_next;
   }
 
-  GST_OBJECT_UNLOCK (registry);
+  GST_REGISTRY_WRITE_UNLOCK (registry);
 
   return changed;
 }
@@ -1657,6 +2147,29 @@ scan_and_update_registry (GstRegistry * default_registry,
   return REGISTRY_SCAN_AND_UPDATE_SUCCESS_UPDATED;
 }
 
+/* the thread that checks the plugins after the cache was read, when
+ * GST_REGISTRY_UPDATE is "background" */
+static GThread *_gst_registry_update_thread = NULL;
+
+static gpointer
+registry_update_thread (gchar * registry_file)
+{
+  scan_and_update_registry (gst_registry_get (), registry_file, TRUE, NULL);
+  GST_INFO ("background registry update done");
+  g_free (registry_file);
+
+  return NULL;
+}
+
+static void
+registry_update_thread_join (void)
+{
+  if (_gst_registry_update_thread) {
+    g_thread_join (_gst_registry_update_thread);
+    _gst_registry_update_thread = NULL;
+  }
+}
+
 static gboolean
 ensure_current_registry (GError ** error)
 {
@@ -1664,8 +2177,12 @@ ensure_current_registry (GError ** error)
   GstRegistry *default_registry;
   gboolean ret = TRUE;
   gboolean do_update = TRUE;
+  gboolean do_background = FALSE;
   gboolean have_cache = TRUE;
 
+  /* a previous background update must be complete */
+  registry_update_thread_join ();
+
   default_registry = gst_registry_get ();
 
   registry_file = g_strdup (g_getenv ("GST_REGISTRY_1_0"));
@@ -1693,6 +2210,8 @@ ensure_current_registry (GError ** error)
       if ((update_env = g_getenv ("GST_REGISTRY_UPDATE"))) {
         /* do update for any value different from "no" */
         do_update = (strcmp (update_env, "no") != 0);
+        /* the cache is used until the plugins are checked */
+        do_background = (strcmp (update_env, "background") == 0);
       }
     }
   }
@@ -1705,6 +2224,15 @@ ensure_current_registry (GError ** error)
       __registry_reuse_plugin_scanner = (strcmp (reuse_env, "no") != 0);
     }
     /* now check registry */
+    if (do_background) {
+      GST_DEBUG ("Updating registry cache in the background");
+      _gst_registry_update_thread = g_thread_try_new ("gstregistryupdate",
+          (GThreadFunc) registry_update_thread, registry_file, NULL);
+      if (_gst_registry_update_thread) {
+        GST_INFO ("registry read, updating in the background");
+        return ret;
+      }
+    }
     GST_DEBUG ("Updating registry cache");
     scan_and_update_registry (default_registry, registry_file, TRUE, error);
   } else {
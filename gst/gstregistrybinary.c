@@ -517,6 +517,8 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   gboolean res = FALSE;
   guint32 filter_env_hash = 0;
   gint check_magic_result;
+  const gchar *lazy_env;
+  gboolean lazy;
 #ifndef GST_DISABLE_GST_DEBUG
   GTimer *timer = NULL;
   gdouble seconds;
@@ -526,6 +528,11 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
   GST_TYPE_ELEMENT_FACTORY;
   GST_TYPE_TYPE_FIND_FACTORY;
 
+  /* only create the features when they are used, for any value different
+   * from "no" */
+  lazy = (lazy_env = g_getenv ("GST_REGISTRY_LAZY")) != NULL &&
+      strcmp (lazy_env, "no") != 0;
+
 #ifndef GST_DISABLE_GST_DEBUG
   timer = g_timer_new ();
 #endif
@@ -600,7 +607,8 @@ priv_gst_registry_binary_read_cache (GstRegistry * registry,
       GST_DEBUG ("reading binary registry %" G_GSIZE_FORMAT "(%x)/%"
           G_GSIZE_FORMAT, (gsize) in - (gsize) contents,
           (guint) ((gsize) in - (gsize) contents), size);
-      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, NULL)) {
+      if (!_priv_gst_registry_chunks_load_plugin (registry, &in, end, lazy,
+              NULL)) {
         GST_ERROR ("Problem while reading binary registry %s", location);
         goto Error;
       }
@@ -623,7 +631,15 @@ Error:
 #ifndef GST_DISABLE_GST_DEBUG
   g_timer_destroy (timer);
 #endif
-  if (mapped) {
+  if (lazy) {
+    /* the features that were not created yet point into the data, the
+     * registry frees it when they are all created or removed */
+    if (mapped)
+      _priv_gst_registry_take_lazy_data (registry, mapped,
+          (GDestroyNotify) g_mapped_file_unref);
+    else
+      _priv_gst_registry_take_lazy_data (registry, contents, g_free);
+  } else if (mapped) {
     g_mapped_file_unref (mapped);
   } else {
     g_free (contents);
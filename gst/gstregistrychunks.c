@@ -92,6 +92,19 @@ _strnlen (const gchar * str, gint maxlen)
   inptr += _len + 1; \
 }G_STMT_END
 
+#define skip_element(inptr, element, endptr, error_label) G_STMT_START{ \
+  if (inptr + sizeof(element) > endptr) \
+    goto error_label; \
+  inptr += sizeof (element); \
+}G_STMT_END
+
+#define skip_string(inptr, endptr, error_label)  G_STMT_START{\
+  gint _len = _strnlen (inptr, (endptr-inptr)); \
+  if (_len == -1) \
+    goto error_label; \
+  inptr += _len + 1; \
+}G_STMT_END
+
 #define ALIGNMENT            (sizeof (void *))
 #define alignment(_address)  (gsize)_address%ALIGNMENT
 #define align(_ptr)          _ptr += (( alignment(_ptr) == 0) ? 0 : ALIGNMENT-alignment(_ptr))
@@ -176,6 +189,423 @@ gst_registry_chunks_make_data (gpointer data, gulong size)
 }
 
 
+/* Caps are stored in a binary form next to their string so that they can be
+ * created without parsing the string. The data starts with its size as a
+ * guint32 and a byte that is 1 for ANY caps, followed by the number of
+ * structures. Each structure is stored as its name, the number of fields
+ * and for each field its name and value. A value is a type byte followed by
+ * its contents, numbers are stored in host byte order like all registry
+ * data. Caps with values of other types are only stored as a string. */
+enum
+{
+  CAPS_VALUE_INT = 1,
+  CAPS_VALUE_INT_RANGE,
+  CAPS_VALUE_DOUBLE,
+  CAPS_VALUE_DOUBLE_RANGE,
+  CAPS_VALUE_FRACTION,
+  CAPS_VALUE_FRACTION_RANGE,
+  CAPS_VALUE_BOOLEAN,
+  CAPS_VALUE_STRING,
+  CAPS_VALUE_LIST,
+  CAPS_VALUE_ARRAY
+};
+
+/* nested lists deeper than this are not decoded */
+#define CAPS_VALUE_MAX_DEPTH 8
+
+#define caps_binary_put(ba, v) \
+  g_byte_array_append (ba, (const guint8 *) &(v), sizeof (v))
+
+static void
+caps_binary_put_string (GByteArray * ba, const gchar * str)
+{
+  g_byte_array_append (ba, (const guint8 *) str, strlen (str) + 1);
+}
+
+static gboolean
+caps_binary_put_value (GByteArray * ba, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint8 tag;
+  gint32 i[4];
+  gdouble d[2];
+  guint32 n, idx;
+
+  if (type == G_TYPE_INT) {
+    tag = CAPS_VALUE_INT;
+    i[0] = g_value_get_int (value);
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, i[0]);
+  } else if (type == GST_TYPE_INT_RANGE) {
+    tag = CAPS_VALUE_INT_RANGE;
+    i[0] = gst_value_get_int_range_min (value);
+    i[1] = gst_value_get_int_range_max (value);
+    i[2] = gst_value_get_int_range_step (value);
+    caps_binary_put (ba, tag);
+    g_byte_array_append (ba, (const guint8 *) i, 3 * sizeof (gint32));
+  } else if (type == G_TYPE_DOUBLE) {
+    tag = CAPS_VALUE_DOUBLE;
+    d[0] = g_value_get_double (value);
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, d[0]);
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    tag = CAPS_VALUE_DOUBLE_RANGE;
+    d[0] = gst_value_get_double_range_min (value);
+    d[1] = gst_value_get_double_range_max (value);
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, d);
+  } else if (type == GST_TYPE_FRACTION) {
+    tag = CAPS_VALUE_FRACTION;
+    i[0] = gst_value_get_fraction_numerator (value);
+    i[1] = gst_value_get_fraction_denominator (value);
+    caps_binary_put (ba, tag);
+    g_byte_array_append (ba, (const guint8 *) i, 2 * sizeof (gint32));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    tag = CAPS_VALUE_FRACTION_RANGE;
+    i[0] = gst_value_get_fraction_numerator (min);
+    i[1] = gst_value_get_fraction_denominator (min);
+    i[2] = gst_value_get_fraction_numerator (max);
+    i[3] = gst_value_get_fraction_denominator (max);
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, i);
+  } else if (type == G_TYPE_BOOLEAN) {
+    guint8 b = g_value_get_boolean (value) ? 1 : 0;
+
+    tag = CAPS_VALUE_BOOLEAN;
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, b);
+  } else if (type == G_TYPE_STRING) {
+    const gchar *str = g_value_get_string (value);
+
+    if (str == NULL)
+      return FALSE;
+    tag = CAPS_VALUE_STRING;
+    caps_binary_put (ba, tag);
+    caps_binary_put_string (ba, str);
+  } else if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    gboolean list = (type == GST_TYPE_LIST);
+
+    tag = list ? CAPS_VALUE_LIST : CAPS_VALUE_ARRAY;
+    n = list ? gst_value_list_get_size (value) :
+        gst_value_array_get_size (value);
+    caps_binary_put (ba, tag);
+    caps_binary_put (ba, n);
+    for (idx = 0; idx < n; idx++) {
+      if (!caps_binary_put_value (ba, list ?
+              gst_value_list_get_value (value, idx) :
+              gst_value_array_get_value (value, idx)))
+        return FALSE;
+    }
+  } else {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static gboolean
+caps_binary_put_field (GQuark field_id, const GValue * value, gpointer ba)
+{
+  caps_binary_put_string (ba, g_quark_to_string (field_id));
+  return caps_binary_put_value (ba, value);
+}
+
+/* Returns: the binary form of @caps or %NULL when it contains values that
+ * can't be stored */
+static GByteArray *
+gst_registry_chunks_caps_to_binary (const GstCaps * caps)
+{
+  GByteArray *ba;
+  guint32 size = 0, n, i;
+  guint8 any;
+
+  ba = g_byte_array_new ();
+  caps_binary_put (ba, size);
+  any = gst_caps_is_any (caps) ? 1 : 0;
+  caps_binary_put (ba, any);
+
+  if (!any) {
+    n = gst_caps_get_size (caps);
+    caps_binary_put (ba, n);
+    for (i = 0; i < n; i++) {
+      GstStructure *structure = gst_caps_get_structure (caps, i);
+      guint32 n_fields = gst_structure_n_fields (structure);
+
+      caps_binary_put_string (ba, gst_structure_get_name (structure));
+      caps_binary_put (ba, n_fields);
+      if (!gst_structure_foreach (structure, caps_binary_put_field, ba)) {
+        g_byte_array_free (ba, TRUE);
+        return NULL;
+      }
+    }
+  }
+
+  size = ba->len;
+  memcpy (ba->data, &size, sizeof (size));
+
+  return ba;
+}
+
+typedef struct
+{
+  const guint8 *in;
+  const guint8 *end;
+} GstRegistryCapsReader;
+
+static gboolean
+caps_binary_get (GstRegistryCapsReader * reader, gpointer out, gsize size)
+{
+  if ((gsize) (reader->end - reader->in) < size)
+    return FALSE;
+  memcpy (out, reader->in, size);
+  reader->in += size;
+  return TRUE;
+}
+
+static const gchar *
+caps_binary_get_string (GstRegistryCapsReader * reader)
+{
+  const gchar *str = (const gchar *) reader->in;
+  gint len;
+
+  len = _strnlen (str, reader->end - reader->in);
+  if (len == -1)
+    return NULL;
+  reader->in += len + 1;
+  return str;
+}
+
+static gboolean
+caps_binary_get_value (GstRegistryCapsReader * reader, GValue * value,
+    guint depth)
+{
+  guint8 tag, b;
+  gint32 i[4];
+  gdouble d[2];
+  guint32 n, idx;
+  const gchar *str;
+
+  if (!caps_binary_get (reader, &tag, sizeof (tag)))
+    return FALSE;
+
+  switch (tag) {
+    case CAPS_VALUE_INT:
+      if (!caps_binary_get (reader, i, sizeof (gint32)))
+        return FALSE;
+      g_value_init (value, G_TYPE_INT);
+      g_value_set_int (value, i[0]);
+      break;
+    case CAPS_VALUE_INT_RANGE:
+      if (!caps_binary_get (reader, i, 3 * sizeof (gint32))
+          || i[2] <= 0 || i[0] >= i[1])
+        return FALSE;
+      g_value_init (value, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (value, i[0], i[1], i[2]);
+      break;
+    case CAPS_VALUE_DOUBLE:
+      if (!caps_binary_get (reader, d, sizeof (gdouble)))
+        return FALSE;
+      g_value_init (value, G_TYPE_DOUBLE);
+      g_value_set_double (value, d[0]);
+      break;
+    case CAPS_VALUE_DOUBLE_RANGE:
+      if (!caps_binary_get (reader, d, 2 * sizeof (gdouble)) || d[0] >= d[1])
+        return FALSE;
+      g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (value, d[0], d[1]);
+      break;
+    case CAPS_VALUE_FRACTION:
+      if (!caps_binary_get (reader, i, 2 * sizeof (gint32)) || i[1] == 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION);
+      gst_value_set_fraction (value, i[0], i[1]);
+      break;
+    case CAPS_VALUE_FRACTION_RANGE:
+      if (!caps_binary_get (reader, i, 4 * sizeof (gint32))
+          || i[1] == 0 || i[3] == 0)
+        return FALSE;
+      g_value_init (value, GST_TYPE_FRACTION_RANGE);
+      gst_value_set_fraction_range_full (value, i[0], i[1], i[2], i[3]);
+      break;
+    case CAPS_VALUE_BOOLEAN:
+      if (!caps_binary_get (reader, &b, sizeof (b)))
+        return FALSE;
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, b != 0);
+      break;
+    case CAPS_VALUE_STRING:
+      if ((str = caps_binary_get_string (reader)) == NULL)
+        return FALSE;
+      g_value_init (value, G_TYPE_STRING);
+      g_value_set_string (value, str);
+      break;
+    case CAPS_VALUE_LIST:
+    case CAPS_VALUE_ARRAY:
+      if (depth >= CAPS_VALUE_MAX_DEPTH
+          || !caps_binary_get (reader, &n, sizeof (n)))
+        return FALSE;
+      g_value_init (value, tag == CAPS_VALUE_LIST ? GST_TYPE_LIST :
+          GST_TYPE_ARRAY);
+      for (idx = 0; idx < n; idx++) {
+        GValue item = G_VALUE_INIT;
+
+        if (!caps_binary_get_value (reader, &item, depth + 1)) {
+          g_value_unset (value);
+          return FALSE;
+        }
+        if (tag == CAPS_VALUE_LIST)
+          gst_value_list_append_value (value, &item);
+        else
+          gst_value_array_append_value (value, &item);
+        g_value_unset (&item);
+      }
+      break;
+    default:
+      return FALSE;
+  }
+  return TRUE;
+}
+
+/*
+ * _priv_gst_registry_chunks_caps_from_binary:
+ * @data: caps stored by gst_registry_chunks_save_caps()
+ *
+ * Returns: the caps, or %NULL if @data is not valid
+ */
+GstCaps *
+_priv_gst_registry_chunks_caps_from_binary (gconstpointer data)
+{
+  GstRegistryCapsReader reader;
+  GstCaps *caps = NULL;
+  guint32 size, n, n_fields, i, j;
+  guint8 any;
+
+  memcpy (&size, data, sizeof (size));
+  reader.in = (const guint8 *) data + sizeof (size);
+  reader.end = (const guint8 *) data + size;
+
+  if (!caps_binary_get (&reader, &any, sizeof (any)))
+    goto fail;
+  if (any)
+    return gst_caps_new_any ();
+
+  if (!caps_binary_get (&reader, &n, sizeof (n)))
+    goto fail;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < n; i++) {
+    GstStructure *structure;
+    const gchar *name;
+
+    if ((name = caps_binary_get_string (&reader)) == NULL
+        || !caps_binary_get (&reader, &n_fields, sizeof (n_fields)))
+      goto fail;
+
+    structure = gst_structure_new_empty (name);
+    for (j = 0; j < n_fields; j++) {
+      GValue value = G_VALUE_INIT;
+      const gchar *field;
+
+      if ((field = caps_binary_get_string (&reader)) == NULL
+          || !caps_binary_get_value (&reader, &value, 0)) {
+        gst_structure_free (structure);
+        goto fail;
+      }
+      gst_structure_id_take_value (structure, g_quark_from_string (field),
+          &value);
+    }
+    gst_caps_append_structure (caps, structure);
+  }
+  return caps;
+
+fail:
+  GST_WARNING ("invalid binary caps in the registry");
+  if (caps)
+    gst_caps_unref (caps);
+  return NULL;
+}
+
+/* the binary caps of the pad templates are kept for as long as the process
+ * runs, like the interned template strings. Equal caps share the data. */
+static GMutex caps_binary_lock;
+static GHashTable *caps_binary_table = NULL;
+
+static gconstpointer
+gst_registry_chunks_intern_caps_binary (gconstpointer data)
+{
+  GBytes *bytes, *interned;
+  guint32 size;
+
+  memcpy (&size, data, sizeof (size));
+  bytes = g_bytes_new (data, size);
+
+  g_mutex_lock (&caps_binary_lock);
+  if (G_UNLIKELY (caps_binary_table == NULL))
+    caps_binary_table = g_hash_table_new (g_bytes_hash, g_bytes_equal);
+
+  interned = g_hash_table_lookup (caps_binary_table, bytes);
+  if (interned == NULL) {
+    interned = bytes;
+    g_hash_table_add (caps_binary_table, interned);
+  } else {
+    g_bytes_unref (bytes);
+  }
+  g_mutex_unlock (&caps_binary_lock);
+
+  return g_bytes_get_data (interned, NULL);
+}
+
+/*
+ * gst_registry_chunks_save_caps:
+ *
+ * Store the binary form of caps in a binary chunk, stores only the size
+ * when the caps can't be stored as binary.
+ *
+ * Returns: %TRUE for success
+ */
+static gboolean
+gst_registry_chunks_save_caps (GList ** list, const GstCaps * caps)
+{
+  GstRegistryChunk *chunk;
+  GByteArray *ba = NULL;
+  guint32 *empty;
+
+  if (caps)
+    ba = gst_registry_chunks_caps_to_binary (caps);
+
+  chunk = g_slice_new (GstRegistryChunk);
+  if (ba) {
+    chunk->size = ba->len;
+    chunk->data = g_byte_array_free (ba, FALSE);
+  } else {
+    empty = g_new0 (guint32, 1);
+    chunk->size = sizeof (guint32);
+    chunk->data = empty;
+  }
+  chunk->flags = GST_REGISTRY_CHUNK_FLAG_MALLOC;
+  chunk->align = FALSE;
+  *list = g_list_prepend (*list, chunk);
+  return TRUE;
+}
+
+#define unpack_caps_binary(inptr, outptr, endptr, error_label) G_STMT_START{ \
+  guint32 _size; \
+  if (inptr + sizeof (_size) > endptr) \
+    goto error_label; \
+  memcpy (&_size, inptr, sizeof (_size)); \
+  if (_size == 0) { \
+    outptr = NULL; \
+    inptr += sizeof (_size); \
+  } else { \
+    if (_size < sizeof (_size) || _size > (gsize) (endptr - inptr)) \
+      goto error_label; \
+    outptr = inptr; \
+    inptr += _size; \
+  } \
+}G_STMT_END
+
 /*
  * gst_registry_chunks_save_pad_template:
  *
@@ -189,6 +619,7 @@ gst_registry_chunks_save_pad_template (GList ** list,
 {
   GstRegistryChunkPadTemplate *pt;
   GstRegistryChunk *chk;
+  GstCaps *caps;
 
   pt = g_slice_new (GstRegistryChunkPadTemplate);
   chk =
@@ -197,6 +628,12 @@ gst_registry_chunks_save_pad_template (GList ** list,
   pt->presence = template->presence;
   pt->direction = template->direction;
 
+  /* pack pad template caps, the chunks are read in the reverse order */
+  caps = gst_static_caps_get (&template->static_caps);
+  gst_registry_chunks_save_caps (list, caps);
+  if (caps)
+    gst_caps_unref (caps);
+
   /* pack pad template strings */
   gst_registry_chunks_save_const_string (list,
       (gchar *) (template->static_caps.string));
@@ -325,11 +762,13 @@ gst_registry_chunks_save_feature (GList ** list, GstPluginFeature * feature)
       /* we simplify the caps before saving. This is a lot faster
        * when loading them later on */
       fcaps = gst_caps_simplify (fcaps);
+      gst_registry_chunks_save_caps (list, fcaps);
       str = gst_caps_to_string (fcaps);
       gst_caps_unref (fcaps);
 
       gst_registry_chunks_save_string (list, str);
     } else {
+      gst_registry_chunks_save_caps (list, NULL);
       gst_registry_chunks_save_const_string (list, "");
     }
   } else {
@@ -484,13 +923,14 @@ gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
 {
   GstRegistryChunkPadTemplate *pt;
   GstStaticPadTemplate *template = NULL;
+  const gchar *caps_data;
 
   align (*in);
   GST_DEBUG ("Reading/casting for GstRegistryChunkPadTemplate at address %p",
       *in);
   unpack_element (*in, pt, GstRegistryChunkPadTemplate, end, fail);
 
-  template = g_slice_new (GstStaticPadTemplate);
+  template = g_slice_new0 (GstStaticPadTemplate);
   template->presence = pt->presence;
   template->direction = (GstPadDirection) pt->direction;
   template->static_caps.caps = NULL;
@@ -499,6 +939,12 @@ gst_registry_chunks_load_pad_template (GstElementFactory * factory, gchar ** in,
   unpack_const_string (*in, template->name_template, end, fail);
   unpack_const_string (*in, template->static_caps.string, end, fail);
 
+  /* gst_static_caps_get() creates the caps from it */
+  unpack_caps_binary (*in, caps_data, end, fail);
+  if (caps_data)
+    GST_STATIC_CAPS_BINARY (&template->static_caps) =
+        (gpointer) gst_registry_chunks_intern_caps_binary (caps_data);
+
   __gst_element_factory_add_static_pad_template (factory, template);
   GST_DEBUG ("Added pad_template %s", template->name_template);
 
@@ -511,19 +957,19 @@ fail:
 }
 
 /*
- * gst_registry_chunks_load_feature:
+ * _priv_gst_registry_chunks_load_feature:
  *
  * Make a new GstPluginFeature from current binary plugin feature structure
  *
  * Returns: new GstPluginFeature
  */
-static gboolean
-gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
+gboolean
+_priv_gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     gchar * end, GstPlugin * plugin)
 {
   GstRegistryChunkPluginFeature *pf = NULL;
   GstPluginFeature *feature = NULL;
-  const gchar *const_str, *type_name;
+  const gchar *const_str, *type_name, *caps_data;
   const gchar *feature_name;
   const gchar *plugin_name;
   gchar *str;
@@ -632,12 +1078,14 @@ gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
     unpack_element (*in, tff, GstRegistryChunkTypeFindFactory, end, fail);
     pf = (GstRegistryChunkPluginFeature *) tff;
 
-    /* load typefinder caps */
+    /* load typefinder caps, from the binary form when there is one */
     unpack_string_nocopy (*in, const_str, end, fail);
-    if (const_str != NULL && *const_str != '\0')
+    unpack_caps_binary (*in, caps_data, end, fail);
+    factory->caps = NULL;
+    if (caps_data)
+      factory->caps = _priv_gst_registry_chunks_caps_from_binary (caps_data);
+    if (factory->caps == NULL && const_str != NULL && *const_str != '\0')
       factory->caps = gst_caps_from_string (const_str);
-    else
-      factory->caps = NULL;
 
     /* load extensions */
     if (tff->nextensions) {
@@ -680,6 +1128,75 @@ fail:
   return FALSE;
 }
 
+/*
+ * gst_registry_chunks_skip_feature:
+ *
+ * Move @in past the binary plugin feature structure without creating the
+ * feature. This must consume exactly what
+ * _priv_gst_registry_chunks_load_feature() reads. The name of the feature is
+ * returned in @name and points into the registry data.
+ */
+static gboolean
+gst_registry_chunks_skip_feature (gchar ** in, gchar * end,
+    const gchar ** name)
+{
+  const gchar *type_name;
+  GType type;
+  guint i;
+
+  unpack_string_nocopy (*in, type_name, end, fail);
+  unpack_string_nocopy (*in, *name, end, fail);
+
+  if (G_UNLIKELY (!type_name || !(type = g_type_from_name (type_name)))) {
+    GST_ERROR ("Unknown type from typename '%s'", GST_STR_NULL (type_name));
+    return FALSE;
+  }
+
+  if (g_type_is_a (type, GST_TYPE_ELEMENT_FACTORY)) {
+    GstRegistryChunkElementFactory *ef;
+
+    align (*in);
+    unpack_element (*in, ef, GstRegistryChunkElementFactory, end, fail);
+
+    /* metadata */
+    skip_string (*in, end, fail);
+    for (i = 0; i < ef->npadtemplates; i++) {
+      align (*in);
+      skip_element (*in, GstRegistryChunkPadTemplate, end, fail);
+      skip_string (*in, end, fail);
+      skip_string (*in, end, fail);
+    }
+    if (ef->nuriprotocols) {
+      align (*in);
+      skip_element (*in, guint, end, fail);
+      for (i = 0; i < ef->nuriprotocols; i++)
+        skip_string (*in, end, fail);
+    }
+    for (i = 0; i < ef->ninterfaces; i++)
+      skip_string (*in, end, fail);
+  } else if (g_type_is_a (type, GST_TYPE_TYPE_FIND_FACTORY)) {
+    GstRegistryChunkTypeFindFactory *tff;
+
+    align (*in);
+    unpack_element (*in, tff, GstRegistryChunkTypeFindFactory, end, fail);
+
+    /* caps */
+    skip_string (*in, end, fail);
+    for (i = 0; i < tff->nextensions; i++)
+      skip_string (*in, end, fail);
+  } else {
+    GST_WARNING ("unhandled factory type : %s", type_name);
+    return FALSE;
+  }
+
+  return TRUE;
+
+  /* Errors */
+fail:
+  GST_INFO ("Skipping plugin feature failed");
+  return FALSE;
+}
+
 static gchar **
 gst_registry_chunks_load_plugin_dep_strv (gchar ** in, gchar * end, guint n)
 {
@@ -747,10 +1264,14 @@ fail:
  * Make a new GstPlugin from current GstRegistryChunkPluginElement structure
  * and add it to the GstRegistry. Return an offset to the next
  * GstRegistryChunkPluginElement structure.
+ *
+ * With @lazy the features are not created but only registered by name with
+ * _priv_gst_registry_add_lazy_feature(), the data at @in must then stay valid
+ * until it is released by the registry.
  */
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar * end, GstPlugin ** out_plugin)
+    gchar * end, gboolean lazy, GstPlugin ** out_plugin)
 {
 #ifndef GST_DISABLE_GST_DEBUG
   gchar *start = *in;
@@ -816,8 +1337,23 @@ _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
 
   /* Load plugin features */
   for (i = 0; i < n; i++) {
-    if (G_UNLIKELY (!gst_registry_chunks_load_feature (registry, in, end,
-                plugin))) {
+    if (lazy) {
+      gchar *feature_start = *in;
+      const gchar *feature_name;
+
+      if (G_LIKELY (gst_registry_chunks_skip_feature (in, end,
+                  &feature_name))) {
+        _priv_gst_registry_add_lazy_feature (registry, feature_name, plugin,
+            feature_start, end);
+        continue;
+      }
+      GST_ERROR ("Error while skipping binary feature for plugin '%s'",
+          GST_STR_NULL (plugin->desc.name));
+      gst_registry_remove_plugin (registry, plugin);
+      goto fail;
+    }
+    if (G_UNLIKELY (!_priv_gst_registry_chunks_load_feature (registry, in,
+                end, plugin))) {
       GST_ERROR ("Error while loading binary feature for plugin '%s'",
           GST_STR_NULL (plugin->desc.name));
       gst_registry_remove_plugin (registry, plugin);
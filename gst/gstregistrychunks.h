@@ -150,7 +150,11 @@ _priv_gst_registry_chunks_save_plugin (GList ** list, GstRegistry * registry,
 
 gboolean
 _priv_gst_registry_chunks_load_plugin (GstRegistry * registry, gchar ** in,
-    gchar *end, GstPlugin **out_plugin);
+    gchar *end, gboolean lazy, GstPlugin **out_plugin);
+
+gboolean
+_priv_gst_registry_chunks_load_feature (GstRegistry * registry, gchar ** in,
+    gchar *end, GstPlugin * plugin);
 
 void
 _priv_gst_registry_chunks_save_global_header (GList ** list,
@@ -163,6 +167,9 @@ _priv_gst_registry_chunks_load_global_header (GstRegistry * registry,
 void
 _priv_gst_registry_chunk_free (GstRegistryChunk *chunk);
 
+GstCaps *
+_priv_gst_registry_chunks_caps_from_binary (gconstpointer data);
+
 G_END_DECLS
 
 #endif /* __GST_REGISTRYCHUNKS_H__ */
@@ -0,0 +1,293 @@
+/* GStreamer
+ *
+ * gstslab.c: size-classed per-thread cache for small structures
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The slab cache keeps freed blocks of a small number of size classes in a
+ * free list per thread so that the buffer and memory structures that are
+ * allocated and freed at a high rate don't need to go through g_slice for
+ * each packet.
+ *
+ * Blocks are often allocated in one thread and freed in another one, think
+ * of a source allocating buffers that are freed in a sink thread. To avoid
+ * one thread hoarding all the blocks, a thread moves a batch of blocks to a
+ * global depot when its list grows too large and a thread with an empty list
+ * takes a batch from the depot before falling back to g_slice.
+ *
+ * The underlying blocks are always allocated from g_slice with the size of
+ * their size class so that they can be given back to g_slice at any time.
+ * The cache is disabled when running in valgrind or when g_slice is
+ * configured to use plain malloc so that memory debugging keeps working.
+ */
+
+#include "gst_private.h"
+
+#include <string.h>
+
+#include "gstinfo.h"
+
+/* size classes are the powers of 2 from 64 to 4096 bytes */
+#define SLAB_MIN_SHIFT     6
+#define SLAB_N_CLASSES     7
+#define SLAB_MAX_SIZE      (1 << (SLAB_MIN_SHIFT + SLAB_N_CLASSES - 1))
+#define SLAB_CLASS_SIZE(c) (1 << (SLAB_MIN_SHIFT + (c)))
+
+/* blocks moved between a thread and the depot in one go */
+#define SLAB_BATCH         32
+/* max number of batches kept in the depot for each class */
+#define SLAB_DEPOT_MAX     64
+
+typedef struct _GstSlabChunk GstSlabChunk;
+
+struct _GstSlabChunk
+{
+  GstSlabChunk *next;
+};
+
+typedef struct
+{
+  GstSlabChunk *chunks;
+  guint n_chunks;
+} GstSlabList;
+
+typedef struct
+{
+  GstSlabList lists[SLAB_N_CLASSES];
+
+  guint64 hits;
+  guint64 misses;
+} GstSlabThreadCache;
+
+static gboolean slab_enabled = FALSE;
+
+/* protects the depot, the list of thread caches and the totals */
+static GMutex slab_lock;
+static GstSlabChunk *slab_depot[SLAB_N_CLASSES][SLAB_DEPOT_MAX];
+static guint slab_depot_len[SLAB_N_CLASSES];
+static GList *slab_caches = NULL;
+static guint64 slab_hits = 0;
+static guint64 slab_misses = 0;
+
+static void slab_thread_cache_free (gpointer data);
+
+static GPrivate slab_thread_cache = G_PRIVATE_INIT (slab_thread_cache_free);
+
+static inline guint
+slab_size_class (gsize size)
+{
+  if (size <= (1 << SLAB_MIN_SHIFT))
+    return 0;
+
+  return g_bit_storage (size - 1) - SLAB_MIN_SHIFT;
+}
+
+static void
+slab_thread_cache_free (gpointer data)
+{
+  GstSlabThreadCache *cache = data;
+  guint i;
+
+  /* give all blocks back to g_slice */
+  for (i = 0; i < SLAB_N_CLASSES; i++) {
+    GstSlabChunk *chunk, *next;
+
+    for (chunk = cache->lists[i].chunks; chunk; chunk = next) {
+      next = chunk->next;
+      g_slice_free1 (SLAB_CLASS_SIZE (i), chunk);
+    }
+  }
+
+  g_mutex_lock (&slab_lock);
+  slab_hits += cache->hits;
+  slab_misses += cache->misses;
+  slab_caches = g_list_remove (slab_caches, cache);
+  g_mutex_unlock (&slab_lock);
+
+  g_free (cache);
+}
+
+static GstSlabThreadCache *
+slab_get_thread_cache (void)
+{
+  GstSlabThreadCache *cache;
+
+  cache = g_private_get (&slab_thread_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (GstSlabThreadCache, 1);
+    g_private_set (&slab_thread_cache, cache);
+
+    g_mutex_lock (&slab_lock);
+    slab_caches = g_list_prepend (slab_caches, cache);
+    g_mutex_unlock (&slab_lock);
+  }
+  return cache;
+}
+
+/* refill the empty @list with a batch from the depot */
+static void
+slab_depot_take (guint cls, GstSlabList * list)
+{
+  g_mutex_lock (&slab_lock);
+  if (slab_depot_len[cls] > 0) {
+    list->chunks = slab_depot[cls][--slab_depot_len[cls]];
+    list->n_chunks = SLAB_BATCH;
+  }
+  g_mutex_unlock (&slab_lock);
+}
+
+/* move a batch of blocks from @list to the depot */
+static void
+slab_depot_give (guint cls, GstSlabList * list)
+{
+  GstSlabChunk *batch, *last;
+  guint i;
+
+  batch = last = list->chunks;
+  for (i = 1; i < SLAB_BATCH; i++)
+    last = last->next;
+  list->chunks = last->next;
+  list->n_chunks -= SLAB_BATCH;
+  last->next = NULL;
+
+  g_mutex_lock (&slab_lock);
+  if (slab_depot_len[cls] < SLAB_DEPOT_MAX) {
+    slab_depot[cls][slab_depot_len[cls]++] = batch;
+    batch = NULL;
+  }
+  g_mutex_unlock (&slab_lock);
+
+  /* depot is full, free the batch */
+  while (batch) {
+    GstSlabChunk *next = batch->next;
+
+    g_slice_free1 (SLAB_CLASS_SIZE (cls), batch);
+    batch = next;
+  }
+}
+
+/* allocate a block of @size bytes. The block must be freed with
+ * _priv_gst_slab_free() with the same @size. */
+gpointer
+_priv_gst_slab_alloc (gsize size)
+{
+  GstSlabThreadCache *cache;
+  GstSlabList *list;
+  GstSlabChunk *chunk;
+  guint cls;
+
+  if (G_UNLIKELY (!slab_enabled || size > SLAB_MAX_SIZE))
+    return g_slice_alloc (size);
+
+  cls = slab_size_class (size);
+  cache = slab_get_thread_cache ();
+  list = &cache->lists[cls];
+
+  if (G_UNLIKELY (list->chunks == NULL))
+    slab_depot_take (cls, list);
+
+  if (G_LIKELY ((chunk = list->chunks))) {
+    list->chunks = chunk->next;
+    list->n_chunks--;
+    cache->hits++;
+    return chunk;
+  }
+
+  cache->misses++;
+  return g_slice_alloc (SLAB_CLASS_SIZE (cls));
+}
+
+/* free a block allocated with _priv_gst_slab_alloc() */
+void
+_priv_gst_slab_free (gsize size, gpointer mem)
+{
+  GstSlabThreadCache *cache;
+  GstSlabList *list;
+  GstSlabChunk *chunk;
+  guint cls;
+
+  if (G_UNLIKELY (!slab_enabled || size > SLAB_MAX_SIZE)) {
+    g_slice_free1 (size, mem);
+    return;
+  }
+
+  cls = slab_size_class (size);
+  cache = slab_get_thread_cache ();
+  list = &cache->lists[cls];
+
+  if (G_UNLIKELY (list->n_chunks >= 2 * SLAB_BATCH))
+    slab_depot_give (cls, list);
+
+  chunk = mem;
+  chunk->next = list->chunks;
+  list->chunks = chunk;
+  list->n_chunks++;
+}
+
+/* get the number of allocations that were served from the cache (@hits) and
+ * the number that went to g_slice (@misses) for all threads. The values of
+ * threads that are running are only approximate. */
+void
+_priv_gst_slab_get_stats (guint64 * hits, guint64 * misses)
+{
+  GList *walk;
+  guint64 h, m;
+
+  g_mutex_lock (&slab_lock);
+  h = slab_hits;
+  m = slab_misses;
+  for (walk = slab_caches; walk; walk = g_list_next (walk)) {
+    GstSlabThreadCache *cache = walk->data;
+
+    h += cache->hits;
+    m += cache->misses;
+  }
+  g_mutex_unlock (&slab_lock);
+
+  if (hits)
+    *hits = h;
+  if (misses)
+    *misses = m;
+}
+
+void
+_priv_gst_slab_initialize (void)
+{
+  const gchar *env;
+
+  slab_enabled = TRUE;
+
+  env = g_getenv ("G_SLICE");
+  if (env && strstr (env, "always-malloc"))
+    slab_enabled = FALSE;
+  if (_priv_gst_in_valgrind ())
+    slab_enabled = FALSE;
+
+  GST_CAT_DEBUG (GST_CAT_GST_INIT, "slab cache %s",
+      slab_enabled ? "enabled" : "disabled");
+}
+
+void
+_priv_gst_slab_deinit (void)
+{
+  guint64 hits, misses;
+
+  _priv_gst_slab_get_stats (&hits, &misses);
+
+  GST_CAT_INFO (GST_CAT_PERFORMANCE, "slab cache hits %" G_GUINT64_FORMAT
+      ", misses %" G_GUINT64_FORMAT, hits, misses);
+}
@@ -0,0 +1,936 @@
+/* GStreamer
+ *
+ * gstsnapshot.c: snapshots of negotiated pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstsnapshot
+ * @short_description: Recreate a negotiated pipeline without negotiating
+ * @see_also: #GstPipeline, gst_parse_launch()
+ *
+ * gst_pipeline_snapshot() describes a pipeline that was negotiated, usually
+ * after it prerolled, in a #GstStructure: the elements with their factory
+ * and the properties that don't have their default value, the links with
+ * the caps that were negotiated on them and the answer of the allocation
+ * query, and the latency of the pipeline. The structure can be stored with
+ * gst_structure_to_string() and read back with gst_structure_from_string().
+ * The allocation answers are only recorded when the
+ * #GstPipeline:snapshot-tracking property was enabled before the pipeline
+ * negotiated.
+ *
+ * gst_pipeline_new_from_snapshot() builds a new pipeline from the snapshot.
+ * Until the first buffer flows over a link, the caps and accept-caps queries
+ * on the link are answered with the caps of the snapshot, and the allocation
+ * query with the saved answer, so that the elements don't have to query the
+ * rest of the pipeline again. The latency of a live pipeline is configured
+ * with the saved latency instead of querying the sinks. After that the
+ * pipeline behaves like any other pipeline and renegotiates normally.
+ *
+ * Only the direct children of the pipeline are saved. Bins that populate
+ * themselves, like decoding bins, are recreated by their factory; the
+ * elements that the application added to them are not. Links on pads that
+ * don't exist after the element is created, like sometimes pads, can't be
+ * restored. A buffer pool that was provided by downstream can't be restored
+ * either, such allocation queries are still sent downstream.
+ *
+ * Since: 1.2
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst_private.h"
+
+#include <string.h>
+
+#include "gstsnapshot.h"
+#include "gstbin.h"
+#include "gstelementfactory.h"
+#include "gstinfo.h"
+#include "gstparse.h"
+#include "gstquery.h"
+#include "gstutils.h"
+#include "gstvalue.h"
+
+#define SNAPSHOT_NAME "pipeline-snapshot"
+#define SNAPSHOT_VERSION 1
+
+/* the caps and allocation of a restored link, until the first buffer. Both
+ * probes of the link hold a ref, a query probe can still run in another
+ * thread when the buffer probe removes it. */
+typedef struct
+{
+  gint refcount;
+
+  GstCaps *caps;
+
+  /* the answer of downstream to the allocation query */
+  gboolean have_allocation;
+  guint size, min, max;
+  GArray *metas;
+
+  gulong query_probe;
+} SnapshotLink;
+
+static void
+snapshot_value_array_append (GValue * array, GType type, gpointer boxed)
+{
+  GValue value = { 0, };
+
+  g_value_init (&value, type);
+  g_value_take_boxed (&value, boxed);
+  gst_value_array_append_value (array, &value);
+  g_value_unset (&value);
+}
+
+/* the properties that don't have their default value as strings, so that
+ * they can be read back before the types of the values are registered */
+static GstStructure *
+snapshot_element (GstElement * element)
+{
+  GstElementFactory *factory;
+  GstStructure *s;
+  GParamSpec **properties;
+  guint i, n_properties;
+
+  factory = gst_element_get_factory (element);
+  if (factory == NULL) {
+    GST_WARNING_OBJECT (element, "element has no factory");
+    return NULL;
+  }
+
+  s = gst_structure_new (GST_OBJECT_NAME (factory), "name", G_TYPE_STRING,
+      GST_ELEMENT_NAME (element), NULL);
+
+  properties =
+      g_object_class_list_properties (G_OBJECT_GET_CLASS (element),
+      &n_properties);
+  for (i = 0; i < n_properties; i++) {
+    GParamSpec *pspec = properties[i];
+    GValue value = { 0, };
+    gchar *str;
+
+    if ((pspec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+      continue;
+    if (pspec->flags & G_PARAM_CONSTRUCT_ONLY)
+      continue;
+    if (!strcmp (pspec->name, "name") || !strcmp (pspec->name, "parent"))
+      continue;
+    /* objects and pointers can't be saved */
+    if (G_TYPE_IS_OBJECT (pspec->value_type) ||
+        G_TYPE_IS_INTERFACE (pspec->value_type) ||
+        G_TYPE_FUNDAMENTAL (pspec->value_type) == G_TYPE_POINTER)
+      continue;
+
+    g_value_init (&value, pspec->value_type);
+    g_object_get_property (G_OBJECT (element), pspec->name, &value);
+    if (!g_param_value_defaults (pspec, &value)) {
+      if ((str = gst_value_serialize (&value))) {
+        gst_structure_set (s, pspec->name, G_TYPE_STRING, str, NULL);
+        g_free (str);
+      } else {
+        GST_DEBUG_OBJECT (element, "can't save property %s", pspec->name);
+      }
+    }
+    g_value_unset (&value);
+  }
+  g_free (properties);
+
+  return s;
+}
+
+/* the last answer to the allocation query on a source pad, with the object
+ * lock of the pad */
+#define SNAPSHOT_ALLOCATION_QUARK \
+    (g_quark_from_static_string ("GstSnapshotAllocation"))
+#define SNAPSHOT_TRACKED_QUARK \
+    (g_quark_from_static_string ("GstSnapshotTracked"))
+
+/* records the answer of downstream in the streaming thread, so that taking a
+ * snapshot doesn't have to send a serialized query */
+static GstPadProbeReturn
+snapshot_record_allocation (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstQuery *query = GST_PAD_PROBE_INFO_QUERY (info);
+  GstStructure *s;
+  GstCaps *caps;
+  GValue metas = { 0, };
+  GstBufferPool *pool = NULL;
+  gboolean need_pool;
+  guint i, size = 0, min = 0, max = 0;
+
+  if (!(GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_PULL) ||
+      GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return GST_PAD_PROBE_OK;
+
+  gst_query_parse_allocation (query, &caps, &need_pool);
+  if (caps == NULL)
+    return GST_PAD_PROBE_OK;
+
+  if (gst_query_get_n_allocation_pools (query) > 0)
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+
+  /* the caps are only used to check that the answer is still current */
+  s = gst_structure_new ("allocation", "caps", GST_TYPE_CAPS, caps,
+      "pool", G_TYPE_BOOLEAN, pool != NULL,
+      "size", G_TYPE_UINT, size, "min", G_TYPE_UINT, min,
+      "max", G_TYPE_UINT, max, NULL);
+  if (pool)
+    gst_object_unref (pool);
+
+  g_value_init (&metas, GST_TYPE_ARRAY);
+  for (i = 0; i < gst_query_get_n_allocation_metas (query); i++) {
+    GType api = gst_query_parse_nth_allocation_meta (query, i, NULL);
+    GValue value = { 0, };
+
+    g_value_init (&value, G_TYPE_STRING);
+    g_value_set_string (&value, g_type_name (api));
+    gst_value_array_append_value (&metas, &value);
+    g_value_unset (&value);
+  }
+  gst_structure_take_value (s, "metas", &metas);
+
+  GST_OBJECT_LOCK (pad);
+  g_object_set_qdata_full (G_OBJECT (pad), SNAPSHOT_ALLOCATION_QUARK, s,
+      (GDestroyNotify) gst_structure_free);
+  GST_OBJECT_UNLOCK (pad);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+snapshot_track_pad (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  gulong id, tracked;
+
+  if (!GST_PAD_IS_SRC (pad))
+    return;
+
+  GST_OBJECT_LOCK (pad);
+  tracked =
+      GPOINTER_TO_SIZE (g_object_get_qdata (G_OBJECT (pad),
+          SNAPSHOT_TRACKED_QUARK));
+  GST_OBJECT_UNLOCK (pad);
+  if (tracked)
+    return;
+
+  id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM,
+      snapshot_record_allocation, NULL, NULL);
+
+  /* the pad can be tracked from element-added and pad-added at once */
+  GST_OBJECT_LOCK (pad);
+  tracked =
+      GPOINTER_TO_SIZE (g_object_get_qdata (G_OBJECT (pad),
+          SNAPSHOT_TRACKED_QUARK));
+  if (!tracked)
+    g_object_set_qdata (G_OBJECT (pad), SNAPSHOT_TRACKED_QUARK,
+        GSIZE_TO_POINTER (id));
+  GST_OBJECT_UNLOCK (pad);
+
+  if (tracked)
+    gst_pad_remove_probe (pad, id);
+}
+
+static void
+snapshot_untrack_pad (GstPad * pad)
+{
+  gulong id;
+
+  GST_OBJECT_LOCK (pad);
+  id = GPOINTER_TO_SIZE (g_object_steal_qdata (G_OBJECT (pad),
+          SNAPSHOT_TRACKED_QUARK));
+  g_object_set_qdata (G_OBJECT (pad), SNAPSHOT_ALLOCATION_QUARK, NULL);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (id)
+    gst_pad_remove_probe (pad, id);
+}
+
+static void
+snapshot_track_src_pads (GstElement * element, gboolean track)
+{
+  GstIterator *iter;
+  GValue item = { 0, };
+  gboolean done = FALSE;
+
+  iter = gst_element_iterate_src_pads (element);
+  while (!done) {
+    switch (gst_iterator_next (iter, &item)) {
+      case GST_ITERATOR_OK:
+        if (track)
+          snapshot_track_pad (element, g_value_get_object (&item), NULL);
+        else
+          snapshot_untrack_pad (g_value_get_object (&item));
+        g_value_reset (&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        /* tracking or untracking a pad twice does nothing */
+        gst_iterator_resync (iter);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (iter);
+}
+
+static void
+snapshot_track_element (GstBin * bin, GstElement * element,
+    gpointer user_data)
+{
+  /* connected before looking at the pads so that no pad is missed */
+  if (!g_signal_handler_find (element, G_SIGNAL_MATCH_FUNC, 0, 0, NULL,
+          snapshot_track_pad, NULL))
+    g_signal_connect (element, "pad-added", G_CALLBACK (snapshot_track_pad),
+        NULL);
+
+  snapshot_track_src_pads (element, TRUE);
+}
+
+/* an element that leaves the pipeline doesn't record anything anymore */
+static void
+snapshot_untrack_element (GstBin * bin, GstElement * element,
+    gpointer user_data)
+{
+  g_signal_handlers_disconnect_by_func (element, snapshot_track_pad, NULL);
+
+  snapshot_track_src_pads (element, FALSE);
+}
+
+/* starts or stops recording the allocation answers on the links between the
+ * children of @pipeline, for the snapshot-tracking property */
+void
+_priv_gst_snapshot_set_tracking (GstElement * pipeline, gboolean track)
+{
+  GstIterator *iter;
+  GValue item = { 0, };
+  gboolean done = FALSE;
+
+  if (track) {
+    g_signal_connect (pipeline, "element-added",
+        G_CALLBACK (snapshot_track_element), NULL);
+    g_signal_connect (pipeline, "element-removed",
+        G_CALLBACK (snapshot_untrack_element), NULL);
+  } else {
+    g_signal_handlers_disconnect_by_func (pipeline, snapshot_track_element,
+        NULL);
+    g_signal_handlers_disconnect_by_func (pipeline, snapshot_untrack_element,
+        NULL);
+  }
+
+  iter = gst_bin_iterate_elements (GST_BIN_CAST (pipeline));
+  while (!done) {
+    switch (gst_iterator_next (iter, &item)) {
+      case GST_ITERATOR_OK:
+        if (track)
+          snapshot_track_element (GST_BIN_CAST (pipeline),
+              g_value_get_object (&item), NULL);
+        else
+          snapshot_untrack_element (GST_BIN_CAST (pipeline),
+              g_value_get_object (&item), NULL);
+        g_value_reset (&item);
+        break;
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (iter);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (iter);
+}
+
+/* the recorded allocation answer for @caps on @pad */
+static GstStructure *
+snapshot_allocation (GstPad * pad, GstCaps * caps)
+{
+  GstStructure *s;
+  const GValue *value;
+
+  GST_OBJECT_LOCK (pad);
+  s = g_object_get_qdata (G_OBJECT (pad), SNAPSHOT_ALLOCATION_QUARK);
+  value = s ? gst_structure_get_value (s, "caps") : NULL;
+  if (value && gst_caps_is_equal (gst_value_get_caps (value), caps))
+    s = gst_structure_copy (s);
+  else
+    s = NULL;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (s)
+    gst_structure_remove_field (s, "caps");
+
+  return s;
+}
+
+static void
+snapshot_pad_links (GstBin * bin, GstElement * element, GValue * links)
+{
+  GstIterator *iter;
+  GValue item = { 0, };
+  GValue element_links = { 0, };
+  gboolean done = FALSE;
+  guint i;
+
+  g_value_init (&element_links, GST_TYPE_ARRAY);
+  iter = gst_element_iterate_src_pads (element);
+  while (!done) {
+    switch (gst_iterator_next (iter, &item)) {
+      case GST_ITERATOR_OK:
+      {
+        GstPad *pad = g_value_get_object (&item);
+        GstPad *peer = gst_pad_get_peer (pad);
+        GstObject *peer_parent = NULL;
+
+        if (peer)
+          peer_parent = gst_pad_get_parent (peer);
+
+        /* only links between children of the pipeline */
+        if (peer_parent && GST_IS_ELEMENT (peer_parent) &&
+            GST_OBJECT_PARENT (peer_parent) == GST_OBJECT_CAST (bin)) {
+          GstStructure *link, *allocation;
+          GstCaps *caps;
+
+          link = gst_structure_new ("link",
+              "src", G_TYPE_STRING, GST_ELEMENT_NAME (element),
+              "src-pad", G_TYPE_STRING, GST_PAD_NAME (pad),
+              "sink", G_TYPE_STRING, GST_ELEMENT_NAME (peer_parent),
+              "sink-pad", G_TYPE_STRING, GST_PAD_NAME (peer), NULL);
+
+          caps = gst_pad_get_current_caps (pad);
+          if (caps && gst_caps_is_fixed (caps)) {
+            gchar *str = gst_caps_to_string (caps);
+
+            /* gst_structure_to_string() doesn't quote caps fields */
+            gst_structure_set (link, "caps", G_TYPE_STRING, str, NULL);
+            g_free (str);
+            if ((allocation = snapshot_allocation (pad, caps))) {
+              gst_structure_set (link, "allocation", GST_TYPE_STRUCTURE,
+                  allocation, NULL);
+              gst_structure_free (allocation);
+            }
+          }
+          if (caps)
+            gst_caps_unref (caps);
+
+          snapshot_value_array_append (&element_links, GST_TYPE_STRUCTURE,
+              link);
+        }
+        if (peer_parent)
+          gst_object_unref (peer_parent);
+        if (peer)
+          gst_object_unref (peer);
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (iter);
+        g_value_unset (&element_links);
+        g_value_init (&element_links, GST_TYPE_ARRAY);
+        break;
+      default:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (iter);
+
+  for (i = 0; i < gst_value_array_get_size (&element_links); i++)
+    gst_value_array_append_value (links,
+        gst_value_array_get_value (&element_links, i));
+  g_value_unset (&element_links);
+}
+
+/**
+ * gst_pipeline_snapshot:
+ * @pipeline: a #GstPipeline
+ *
+ * Describes @pipeline, its elements, their properties, the caps and the
+ * allocation on the links between them and the latency, so that it can be
+ * recreated with gst_pipeline_new_from_snapshot() without negotiating
+ * again. The pipeline should be at least in the PAUSED state so that the
+ * links are negotiated.
+ *
+ * No serialized query is sent, the allocation of a link is the last answer
+ * to the allocation query that went over it while the pipeline negotiated.
+ * It is only saved when #GstPipeline:snapshot-tracking is enabled.
+ *
+ * Returns: (transfer full): a new #GstStructure describing @pipeline, or
+ *     %NULL when one of its elements can't be recreated. Free with
+ *     gst_structure_free().
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_pipeline_snapshot (GstPipeline * pipeline)
+{
+  GstBin *bin;
+  GstStructure *snapshot;
+  GstIterator *iter;
+  GstQuery *query;
+  GValue elements = { 0, };
+  GValue links = { 0, };
+  GValue item = { 0, };
+  gboolean done = FALSE, res = TRUE;
+  gboolean live = FALSE;
+  GstClockTime min = 0, max = GST_CLOCK_TIME_NONE;
+
+  g_return_val_if_fail (GST_IS_PIPELINE (pipeline), NULL);
+
+  bin = GST_BIN_CAST (pipeline);
+
+  g_value_init (&elements, GST_TYPE_ARRAY);
+  g_value_init (&links, GST_TYPE_ARRAY);
+
+  iter = gst_bin_iterate_elements (bin);
+  while (!done) {
+    switch (gst_iterator_next (iter, &item)) {
+      case GST_ITERATOR_OK:
+      {
+        GstElement *element = g_value_get_object (&item);
+        GstStructure *s;
+
+        if ((s = snapshot_element (element))) {
+          snapshot_value_array_append (&elements, GST_TYPE_STRUCTURE, s);
+          snapshot_pad_links (bin, element, &links);
+        } else {
+          res = FALSE;
+          done = TRUE;
+        }
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (iter);
+        g_value_unset (&elements);
+        g_value_unset (&links);
+        g_value_init (&elements, GST_TYPE_ARRAY);
+        g_value_init (&links, GST_TYPE_ARRAY);
+        break;
+      case GST_ITERATOR_ERROR:
+        res = FALSE;
+        done = TRUE;
+        break;
+      case GST_ITERATOR_DONE:
+        done = TRUE;
+        break;
+    }
+  }
+  g_value_unset (&item);
+  gst_iterator_free (iter);
+
+  if (!res) {
+    g_value_unset (&elements);
+    g_value_unset (&links);
+    return NULL;
+  }
+
+  query = gst_query_new_latency ();
+  if (gst_element_query (GST_ELEMENT_CAST (pipeline), query))
+    gst_query_parse_latency (query, &live, &min, &max);
+  gst_query_unref (query);
+
+  snapshot = gst_structure_new (SNAPSHOT_NAME,
+      "version", G_TYPE_INT, SNAPSHOT_VERSION,
+      "name", G_TYPE_STRING, GST_ELEMENT_NAME (pipeline),
+      "live", G_TYPE_BOOLEAN, live,
+      "min-latency", G_TYPE_UINT64, min,
+      "max-latency", G_TYPE_UINT64, max, NULL);
+  gst_structure_take_value (snapshot, "elements", &elements);
+  gst_structure_take_value (snapshot, "links", &links);
+
+  GST_DEBUG_OBJECT (pipeline, "snapshot %" GST_PTR_FORMAT, snapshot);
+
+  return snapshot;
+}
+
+static SnapshotLink *
+snapshot_link_ref (SnapshotLink * link)
+{
+  g_atomic_int_inc (&link->refcount);
+  return link;
+}
+
+static void
+snapshot_link_unref (SnapshotLink * link)
+{
+  if (!g_atomic_int_dec_and_test (&link->refcount))
+    return;
+
+  gst_caps_unref (link->caps);
+  if (link->metas)
+    g_array_free (link->metas, TRUE);
+  g_slice_free (SnapshotLink, link);
+}
+
+static GstPadProbeReturn
+snapshot_link_query_probe (GstPad * pad, GstPadProbeInfo * info,
+    SnapshotLink * link)
+{
+  GstQuery *query = GST_PAD_PROBE_INFO_QUERY (info);
+  GstCaps *caps;
+
+  /* answer before the query is handled */
+  if (!(GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_PUSH))
+    return GST_PAD_PROBE_OK;
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_CAPS:
+    {
+      GstCaps *filter;
+
+      gst_query_parse_caps (query, &filter);
+      if (filter) {
+        if (!gst_caps_can_intersect (filter, link->caps))
+          break;
+        caps = gst_caps_intersect_full (filter, link->caps,
+            GST_CAPS_INTERSECT_FIRST);
+      } else {
+        caps = gst_caps_ref (link->caps);
+      }
+
+      GST_DEBUG_OBJECT (pad, "answering caps query with %" GST_PTR_FORMAT,
+          caps);
+      gst_query_set_caps_result (query, caps);
+      gst_caps_unref (caps);
+      return GST_PAD_PROBE_DROP;
+    }
+    case GST_QUERY_ACCEPT_CAPS:
+      gst_query_parse_accept_caps (query, &caps);
+      if (!gst_caps_is_equal (caps, link->caps))
+        break;
+
+      gst_query_set_accept_caps_result (query, TRUE);
+      return GST_PAD_PROBE_DROP;
+    case GST_QUERY_ALLOCATION:
+    {
+      gboolean need_pool;
+      guint i;
+
+      if (!link->have_allocation || !(GST_PAD_PROBE_INFO_TYPE (info) &
+              GST_PAD_PROBE_TYPE_QUERY_DOWNSTREAM))
+        break;
+
+      gst_query_parse_allocation (query, &caps, &need_pool);
+      if (caps == NULL || !gst_caps_is_equal (caps, link->caps))
+        break;
+
+      GST_DEBUG_OBJECT (pad, "answering allocation query");
+      if (link->size > 0)
+        gst_query_add_allocation_pool (query, NULL, link->size, link->min,
+            link->max);
+      for (i = 0; i < link->metas->len; i++)
+        gst_query_add_allocation_meta (query,
+            g_array_index (link->metas, GType, i), NULL);
+      return GST_PAD_PROBE_DROP;
+    }
+    default:
+      break;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* the link is negotiated, answer the queries normally from now on */
+static GstPadProbeReturn
+snapshot_link_buffer_probe (GstPad * pad, GstPadProbeInfo * info,
+    SnapshotLink * link)
+{
+  GST_DEBUG_OBJECT (pad, "first buffer, removing snapshot answers");
+  gst_pad_remove_probe (pad, link->query_probe);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+static void
+snapshot_link_setup (GstPad * sinkpad, const GstStructure * s)
+{
+  const GValue *value;
+  const GstStructure *allocation;
+  const gchar *str;
+  SnapshotLink *link;
+  GstCaps *caps;
+
+  if (!(str = gst_structure_get_string (s, "caps")) ||
+      !(caps = gst_caps_from_string (str)))
+    return;
+
+  link = g_slice_new0 (SnapshotLink);
+  link->refcount = 1;
+  link->caps = caps;
+
+  value = gst_structure_get_value (s, "allocation");
+  if (value && GST_VALUE_HOLDS_STRUCTURE (value)) {
+    gboolean pool = FALSE;
+
+    allocation = gst_value_get_structure (value);
+    gst_structure_get_boolean (allocation, "pool", &pool);
+
+    /* the pool of downstream can't be recreated, let downstream answer */
+    if (!pool) {
+      const GValue *metas;
+      guint i;
+
+      link->have_allocation = TRUE;
+      gst_structure_get_uint (allocation, "size", &link->size);
+      gst_structure_get_uint (allocation, "min", &link->min);
+      gst_structure_get_uint (allocation, "max", &link->max);
+
+      link->metas = g_array_new (FALSE, FALSE, sizeof (GType));
+      metas = gst_structure_get_value (allocation, "metas");
+      for (i = 0; metas && i < gst_value_array_get_size (metas); i++) {
+        const GValue *meta = gst_value_array_get_value (metas, i);
+        GType api = 0;
+
+        if (G_VALUE_HOLDS_STRING (meta))
+          api = g_type_from_name (g_value_get_string (meta));
+        if (api != 0) {
+          g_array_append_val (link->metas, api);
+        } else {
+          /* the meta API is not known yet, let downstream answer */
+          link->have_allocation = FALSE;
+          break;
+        }
+      }
+    }
+  }
+
+  link->query_probe = gst_pad_add_probe (sinkpad,
+      GST_PAD_PROBE_TYPE_QUERY_BOTH,
+      (GstPadProbeCallback) snapshot_link_query_probe, snapshot_link_ref (link),
+      (GDestroyNotify) snapshot_link_unref);
+  gst_pad_add_probe (sinkpad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) snapshot_link_buffer_probe, link,
+      (GDestroyNotify) snapshot_link_unref);
+}
+
+typedef struct
+{
+  GstElement *element;
+  GError **error;
+} SnapshotSetData;
+
+static gboolean
+snapshot_set_property (GQuark field_id, const GValue * value,
+    SnapshotSetData * data)
+{
+  const gchar *name = g_quark_to_string (field_id);
+
+  if (!strcmp (name, "name"))
+    return TRUE;
+
+  if (!G_VALUE_HOLDS_STRING (value) ||
+      !g_object_class_find_property (G_OBJECT_GET_CLASS (data->element),
+          name)) {
+    g_set_error (data->error, GST_PARSE_ERROR,
+        GST_PARSE_ERROR_NO_SUCH_PROPERTY,
+        "no property \"%s\" in element \"%s\"", name,
+        GST_ELEMENT_NAME (data->element));
+    return FALSE;
+  }
+
+  gst_util_set_object_arg (G_OBJECT (data->element), name,
+      g_value_get_string (value));
+
+  return TRUE;
+}
+
+static GstPad *
+snapshot_get_pad (GstElement * element, const gchar * name)
+{
+  GstPad *pad;
+
+  if (!(pad = gst_element_get_static_pad (element, name)))
+    pad = gst_element_get_request_pad (element, name);
+
+  return pad;
+}
+
+static gboolean
+snapshot_restore_link (GstBin * bin, const GstStructure * s, GError ** error)
+{
+  const gchar *src_name, *src_pad_name, *sink_name, *sink_pad_name;
+  GstElement *src = NULL, *sink = NULL;
+  GstPad *srcpad = NULL, *sinkpad = NULL;
+  gboolean res = FALSE;
+
+  src_name = gst_structure_get_string (s, "src");
+  src_pad_name = gst_structure_get_string (s, "src-pad");
+  sink_name = gst_structure_get_string (s, "sink");
+  sink_pad_name = gst_structure_get_string (s, "sink-pad");
+  if (!src_name || !src_pad_name || !sink_name || !sink_pad_name) {
+    g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_SYNTAX,
+        "invalid link in snapshot");
+    return FALSE;
+  }
+
+  if ((src = gst_bin_get_by_name (bin, src_name)) &&
+      (sink = gst_bin_get_by_name (bin, sink_name)) &&
+      (srcpad = snapshot_get_pad (src, src_pad_name)) &&
+      (sinkpad = snapshot_get_pad (sink, sink_pad_name)) &&
+      GST_PAD_LINK_SUCCESSFUL (gst_pad_link (srcpad, sinkpad))) {
+    snapshot_link_setup (sinkpad, s);
+    res = TRUE;
+  } else {
+    g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_LINK,
+        "could not link %s:%s to %s:%s", src_name, src_pad_name, sink_name,
+        sink_pad_name);
+  }
+
+  if (srcpad)
+    gst_object_unref (srcpad);
+  if (sinkpad)
+    gst_object_unref (sinkpad);
+  if (src)
+    gst_object_unref (src);
+  if (sink)
+    gst_object_unref (sink);
+
+  return res;
+}
+
+/* configures the saved latency instead of querying the sinks, once */
+static gboolean
+snapshot_do_latency (GstBin * bin, GstClockTime * latency)
+{
+  GstEvent *event = gst_event_new_latency (*latency);
+
+  GST_DEBUG_OBJECT (bin, "configuring latency %" GST_TIME_FORMAT
+      " from snapshot", GST_TIME_ARGS (*latency));
+  g_signal_handlers_disconnect_by_func (bin, snapshot_do_latency, latency);
+
+  return gst_element_send_event (GST_ELEMENT_CAST (bin), event);
+}
+
+/**
+ * gst_pipeline_new_from_snapshot:
+ * @snapshot: a snapshot made with gst_pipeline_snapshot()
+ * @error: (allow-none): return location for a #GError, or %NULL
+ *
+ * Creates a new pipeline with the elements, properties and links of
+ * @snapshot. Until data flows, the caps and allocation queries on the links
+ * are answered with the values of the snapshot, and the latency of the
+ * snapshot is configured, so that the pipeline doesn't negotiate again.
+ *
+ * The errors are in the #GST_PARSE_ERROR domain.
+ *
+ * Returns: (transfer floating): a new pipeline, or %NULL when @snapshot
+ *     couldn't be restored
+ *
+ * Since: 1.2
+ */
+GstElement *
+gst_pipeline_new_from_snapshot (const GstStructure * snapshot, GError ** error)
+{
+  GstElement *pipeline;
+  const GValue *elements, *links;
+  gint version = 0;
+  const GValue *min_latency;
+  gboolean live = FALSE;
+  guint i;
+
+  g_return_val_if_fail (snapshot != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  elements = gst_structure_get_value (snapshot, "elements");
+  links = gst_structure_get_value (snapshot, "links");
+  if (!gst_structure_has_name (snapshot, SNAPSHOT_NAME) ||
+      !gst_structure_get_int (snapshot, "version", &version) ||
+      version != SNAPSHOT_VERSION || elements == NULL || links == NULL ||
+      !GST_VALUE_HOLDS_ARRAY (elements) || !GST_VALUE_HOLDS_ARRAY (links)) {
+    g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_SYNTAX,
+        "not a pipeline snapshot");
+    return NULL;
+  }
+
+  pipeline = gst_pipeline_new (gst_structure_get_string (snapshot, "name"));
+
+  for (i = 0; i < gst_value_array_get_size (elements); i++) {
+    const GValue *value = gst_value_array_get_value (elements, i);
+    const GstStructure *s;
+    SnapshotSetData data;
+    GstElement *element;
+
+    if (!GST_VALUE_HOLDS_STRUCTURE (value)) {
+      g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_SYNTAX,
+          "invalid element in snapshot");
+      goto failed;
+    }
+    s = gst_value_get_structure (value);
+
+    element = gst_element_factory_make (gst_structure_get_name (s),
+        gst_structure_get_string (s, "name"));
+    if (element == NULL) {
+      g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_NO_SUCH_ELEMENT,
+          "no element \"%s\"", gst_structure_get_name (s));
+      goto failed;
+    }
+
+    data.element = element;
+    data.error = error;
+    if (!gst_structure_foreach (s,
+            (GstStructureForeachFunc) snapshot_set_property, &data)) {
+      gst_object_unref (gst_object_ref_sink (element));
+      goto failed;
+    }
+
+    if (!gst_bin_add (GST_BIN_CAST (pipeline), element)) {
+      g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_SYNTAX,
+          "duplicate element \"%s\" in snapshot", GST_ELEMENT_NAME (element));
+      goto failed;
+    }
+  }
+
+  for (i = 0; i < gst_value_array_get_size (links); i++) {
+    const GValue *value = gst_value_array_get_value (links, i);
+
+    if (!GST_VALUE_HOLDS_STRUCTURE (value)) {
+      g_set_error (error, GST_PARSE_ERROR, GST_PARSE_ERROR_SYNTAX,
+          "invalid link in snapshot");
+      goto failed;
+    }
+    if (!snapshot_restore_link (GST_BIN_CAST (pipeline),
+            gst_value_get_structure (value), error))
+      goto failed;
+  }
+
+  gst_structure_get_boolean (snapshot, "live", &live);
+  min_latency = gst_structure_get_value (snapshot, "min-latency");
+  if (live && min_latency && G_VALUE_HOLDS_UINT64 (min_latency)) {
+    GstClockTime *latency = g_new (GstClockTime, 1);
+
+    *latency = g_value_get_uint64 (min_latency);
+    g_signal_connect_data (pipeline, "do-latency",
+        G_CALLBACK (snapshot_do_latency), latency, (GClosureNotify) g_free, 0);
+  }
+
+  return pipeline;
+
+failed:
+  {
+    gst_object_unref (gst_object_ref_sink (pipeline));
+    return NULL;
+  }
+}
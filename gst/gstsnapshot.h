@@ -0,0 +1,36 @@
+/* GStreamer
+ *
+ * gstsnapshot.h: snapshots of negotiated pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SNAPSHOT_H__
+#define __GST_SNAPSHOT_H__
+
+#include <gst/gstpipeline.h>
+#include <gst/gststructure.h>
+
+G_BEGIN_DECLS
+
+GstStructure *  gst_pipeline_snapshot           (GstPipeline * pipeline);
+
+GstElement *    gst_pipeline_new_from_snapshot  (const GstStructure * snapshot,
+                                                 GError ** error);
+
+G_END_DECLS
+
+#endif /* __GST_SNAPSHOT_H__ */
@@ -64,6 +64,7 @@
 
 #include "gst_private.h"
 #include "gstquark.h"
+#include "gstvaluebinary.h"
 #include <gst/gst.h>
 #include <gobject/gvaluecollector.h>
 
@@ -78,6 +79,23 @@ struct _GstStructureField
   GValue value;
 };
 
+/* open addressing hash table with the position + 1 of the fields, 0 marks a
+ * free slot. The number of slots is a power of 2 and at least twice the
+ * number of fields so that there always is a free slot. */
+typedef struct
+{
+  guint mask;
+  guint n_fields;
+  guint16 slots[1];
+} GstStructureIndex;
+
+/* structures with less fields are searched linearly */
+#define INDEX_MIN_FIELDS 8
+/* larger structures don't fit the slots */
+#define INDEX_MAX_FIELDS G_MAXUINT16
+
+#define INDEX_HASH(quark) ((guint) (quark) * 2654435761u)
+
 typedef struct
 {
   GstStructure s;
@@ -86,10 +104,14 @@ typedef struct
   gint *parent_refcount;
 
   GArray *fields;
+
+  /* quark index of the fields, only built for large structures */
+  GstStructureIndex *index;
 } GstStructureImpl;
 
 #define GST_STRUCTURE_REFCOUNT(s) (((GstStructureImpl*)(s))->parent_refcount)
 #define GST_STRUCTURE_FIELDS(s) (((GstStructureImpl*)(s))->fields)
+#define GST_STRUCTURE_INDEX(s) (((GstStructureImpl*)(s))->index)
 
 #define GST_STRUCTURE_FIELD(structure, index) \
     &g_array_index(GST_STRUCTURE_FIELDS(structure), GstStructureField, (index))
@@ -107,6 +129,8 @@ static GstStructureField *gst_structure_get_field (const GstStructure *
     structure, const gchar * fieldname);
 static GstStructureField *gst_structure_id_get_field (const GstStructure *
     structure, GQuark field);
+static inline void gst_structure_index_add (GstStructure * structure,
+    guint pos);
 static void gst_structure_transform_to_string (const GValue * src_value,
     GValue * dest_value);
 static GstStructure *gst_structure_copy_conditional (const GstStructure *
@@ -121,11 +145,34 @@ GType _gst_structure_type = 0;
 G_DEFINE_BOXED_TYPE (GstStructure, gst_structure,
     gst_structure_copy_conditional, gst_structure_free);
 
+/* must match the order and number of the GstStructureQuark enum */
+static const gchar *_structure_quark_strings[] = {
+  "video/x-raw", "audio/x-raw", "video/x-h264", "video/mpeg", "audio/mpeg",
+  "image/jpeg", "application/x-rtp", "format", "width", "height", "framerate",
+  "pixel-aspect-ratio", "interlace-mode", "colorimetry", "chroma-site",
+  "rate", "channels", "channel-mask", "layout", "stream-format", "alignment",
+  "profile", "level", "parsed", "framed", "mpegversion", "codec_data",
+  "streamheader", "media", "encoding-name", "payload", "clock-rate"
+};
+
+GQuark _gst_structure_quarks[GST_STRUCTURE_QUARK_LAST] = { 0, };
+
 void
 _priv_gst_structure_initialize (void)
 {
+  guint i;
+
   _gst_structure_type = gst_structure_get_type ();
 
+  if (G_N_ELEMENTS (_structure_quark_strings) != GST_STRUCTURE_QUARK_LAST)
+    g_warning ("the structure quark table is not consistent! %d != %d",
+        (gint) G_N_ELEMENTS (_structure_quark_strings),
+        GST_STRUCTURE_QUARK_LAST);
+
+  for (i = 0; i < GST_STRUCTURE_QUARK_LAST; i++)
+    _gst_structure_quarks[i] =
+        g_quark_from_static_string (_structure_quark_strings[i]);
+
   g_value_register_transform_func (_gst_structure_type, G_TYPE_STRING,
       gst_structure_transform_to_string);
 
@@ -144,6 +191,7 @@ gst_structure_new_id_empty_with_size (GQuark quark, guint prealloc)
   GST_STRUCTURE_REFCOUNT (structure) = NULL;
   GST_STRUCTURE_FIELDS (structure) =
       g_array_sized_new (FALSE, FALSE, sizeof (GstStructureField), prealloc);
+  GST_STRUCTURE_INDEX (structure) = NULL;
 
   GST_TRACE ("created structure %p", structure);
 
@@ -380,6 +428,7 @@ gst_structure_free (GstStructure * structure)
     }
   }
   g_array_free (GST_STRUCTURE_FIELDS (structure), TRUE);
+  g_free (GST_STRUCTURE_INDEX (structure));
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
 #endif
@@ -722,6 +771,196 @@ gst_structure_id_set_valist (GstStructure * structure,
   gst_structure_id_set_valist_internal (structure, fieldname, varargs);
 }
 
+/* the value of @field, created when it doesn't exist or has another type.
+ * Existing values of the same type are updated in place so that setting the
+ * fields of a structure that is reused doesn't allocate */
+static GValue *
+gst_structure_id_get_typed_value (GstStructure * structure, GQuark field,
+    GType type)
+{
+  GstStructureField *f;
+
+  f = gst_structure_id_get_field (structure, field);
+  if (G_LIKELY (f != NULL && G_VALUE_TYPE (&f->value) == type))
+    return &f->value;
+
+  {
+    GstStructureField gsfield = { 0, {0,} };
+
+    gsfield.name = field;
+    g_value_init (&gsfield.value, type);
+    gst_structure_set_field (structure, &gsfield);
+  }
+
+  return &gst_structure_id_get_field (structure, field)->value;
+}
+
+/**
+ * gst_structure_id_set_boolean:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to a boolean. This is a faster
+ * version of gst_structure_id_set() for one field that doesn't collect the
+ * value in a #GValue. When the field already holds a value of the same type, it
+ * is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_boolean (GstStructure * structure, GQuark field,
+    gboolean value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_boolean (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_BOOLEAN), value);
+}
+
+/**
+ * gst_structure_id_set_int:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to an integer. This is a faster
+ * version of gst_structure_id_set() for one field that doesn't collect the
+ * value in a #GValue. When the field already holds a value of the same type, it
+ * is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_int (GstStructure * structure, GQuark field, gint value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_int (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_INT), value);
+}
+
+/**
+ * gst_structure_id_set_uint:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to an unsigned integer. This is a
+ * faster version of gst_structure_id_set() for one field that doesn't collect
+ * the value in a #GValue. When the field already holds a value of the same
+ * type, it is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_uint (GstStructure * structure, GQuark field, guint value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_uint (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_UINT), value);
+}
+
+/**
+ * gst_structure_id_set_int64:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to a 64-bit integer. This is a
+ * faster version of gst_structure_id_set() for one field that doesn't collect
+ * the value in a #GValue. When the field already holds a value of the same
+ * type, it is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_int64 (GstStructure * structure, GQuark field,
+    gint64 value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_int64 (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_INT64), value);
+}
+
+/**
+ * gst_structure_id_set_uint64:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to an unsigned 64-bit integer.
+ * This is a faster version of gst_structure_id_set() for one field that doesn't
+ * collect the value in a #GValue. When the field already holds a value of the
+ * same type, it is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_uint64 (GstStructure * structure, GQuark field,
+    guint64 value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_uint64 (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_UINT64), value);
+}
+
+/**
+ * gst_structure_id_set_double:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to a double. This is a faster
+ * version of gst_structure_id_set() for one field that doesn't collect the
+ * value in a #GValue. When the field already holds a value of the same type, it
+ * is updated in place.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_double (GstStructure * structure, GQuark field,
+    gdouble value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+
+  g_value_set_double (gst_structure_id_get_typed_value (structure, field,
+          G_TYPE_DOUBLE), value);
+}
+
+/**
+ * gst_structure_id_set_enum:
+ * @structure: a #GstStructure
+ * @field: a #GQuark representing a field
+ * @enum_type: the enum #GType of the field
+ * @value: the new value of the field
+ *
+ * Sets the field with the given GQuark @field to @value of @enum_type, like
+ * gst_structure_id_set_int() does for integers.
+ *
+ * Since: 1.2
+ */
+void
+gst_structure_id_set_enum (GstStructure * structure, GQuark field,
+    GType enum_type, gint value)
+{
+  g_return_if_fail (structure != NULL);
+  g_return_if_fail (IS_MUTABLE (structure));
+  g_return_if_fail (G_TYPE_IS_ENUM (enum_type));
+
+  g_value_set_enum (gst_structure_id_get_typed_value (structure, field,
+          enum_type), value);
+}
+
 /**
  * gst_structure_new_id:
  * @name_quark: name of new structure
@@ -771,7 +1010,7 @@ static void
 gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
-  guint i, len = GST_STRUCTURE_FIELDS (structure)->len;
+  guint len = GST_STRUCTURE_FIELDS (structure)->len;
 
   if (G_UNLIKELY (G_VALUE_HOLDS_STRING (&field->value))) {
     const gchar *s;
@@ -821,17 +1060,73 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (G_UNLIKELY (f != NULL)) {
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
   g_array_append_val (GST_STRUCTURE_FIELDS (structure), *field);
+  gst_structure_index_add (structure, len);
+}
+
+static inline void
+gst_structure_index_insert (GstStructureIndex * index, GQuark name, guint pos)
+{
+  guint i = INDEX_HASH (name) & index->mask;
+
+  while (index->slots[i])
+    i = (i + 1) & index->mask;
+
+  index->slots[i] = pos + 1;
+  index->n_fields++;
+}
+
+static GstStructureIndex *
+gst_structure_index_build (const GstStructure * structure)
+{
+  GstStructureIndex *index;
+  guint i, len, n_slots;
+
+  len = GST_STRUCTURE_FIELDS (structure)->len;
+  n_slots = 1 << g_bit_storage (2 * len);
+
+  index = g_malloc0 (sizeof (GstStructureIndex) +
+      (n_slots - 1) * sizeof (guint16));
+  index->mask = n_slots - 1;
+
+  for (i = 0; i < len; i++)
+    gst_structure_index_insert (index, GST_STRUCTURE_FIELD (structure,
+            i)->name, i);
+
+  return index;
+}
+
+/* drop the index, called when fields are removed. This is only done on
+ * writable structures so nobody else can be using the index */
+static inline void
+gst_structure_index_invalidate (GstStructure * structure)
+{
+  g_free (GST_STRUCTURE_INDEX (structure));
+  GST_STRUCTURE_INDEX (structure) = NULL;
+}
+
+/* the field at @pos was appended, add it to the index when there is room or
+ * drop the index so that it is rebuilt with a bigger size */
+static inline void
+gst_structure_index_add (GstStructure * structure, guint pos)
+{
+  GstStructureIndex *index = GST_STRUCTURE_INDEX (structure);
+
+  if (index == NULL)
+    return;
+
+  if (pos < INDEX_MAX_FIELDS && (index->n_fields + 1) * 2 <= index->mask + 1)
+    gst_structure_index_insert (index, GST_STRUCTURE_FIELD (structure,
+            pos)->name, pos);
+  else
+    gst_structure_index_invalidate (structure);
 }
 
 /* If there is no field with the given ID, NULL is returned.
@@ -840,14 +1135,41 @@ static GstStructureField *
 gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
 {
   GstStructureField *field;
-  guint i, len;
+  GstStructureIndex *index;
+  guint i, len, pos;
 
   len = GST_STRUCTURE_FIELDS (structure)->len;
 
-  for (i = 0; i < len; i++) {
-    field = GST_STRUCTURE_FIELD (structure, i);
+  if (G_LIKELY (len < INDEX_MIN_FIELDS || len > INDEX_MAX_FIELDS)) {
+    for (i = 0; i < len; i++) {
+      field = GST_STRUCTURE_FIELD (structure, i);
+
+      if (G_UNLIKELY (field->name == field_id))
+        return field;
+    }
+    return NULL;
+  }
+
+  /* the index is only freed when the structure is writable, concurrent
+   * readers race to install a new one */
+  index = g_atomic_pointer_get (&GST_STRUCTURE_INDEX (structure));
+  if (G_UNLIKELY (index == NULL)) {
+    GstStructureIndex *new_index = gst_structure_index_build (structure);
 
-    if (G_UNLIKELY (field->name == field_id))
+    if (g_atomic_pointer_compare_and_exchange (&GST_STRUCTURE_INDEX
+            (structure), NULL, new_index)) {
+      index = new_index;
+    } else {
+      g_free (new_index);
+      index = g_atomic_pointer_get (&GST_STRUCTURE_INDEX (structure));
+    }
+  }
+
+  for (i = INDEX_HASH (field_id) & index->mask; (pos = index->slots[i]);
+      i = (i + 1) & index->mask) {
+    field = GST_STRUCTURE_FIELD (structure, pos - 1);
+
+    if (field->name == field_id)
       return field;
   }
 
@@ -947,6 +1269,7 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
       }
       GST_STRUCTURE_FIELDS (structure) =
           g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
+      gst_structure_index_invalidate (structure);
       return;
     }
   }
@@ -1024,6 +1347,7 @@ gst_structure_remove_all_fields (GstStructure * structure)
     GST_STRUCTURE_FIELDS (structure) =
         g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
   }
+  gst_structure_index_invalidate (structure);
 }
 
 /**
@@ -1708,20 +2032,32 @@ gst_structure_get_abbrs (gint * n_abbrs)
 static GType
 gst_structure_gtype_from_abbr (const char *type_name)
 {
-  int i;
-  GstStructureAbbreviation *abbrs;
-  gint n_abbrs;
+  static GHashTable *abbrs_table = NULL;
+  gpointer type;
 
   g_return_val_if_fail (type_name != NULL, G_TYPE_INVALID);
 
-  abbrs = gst_structure_get_abbrs (&n_abbrs);
-
-  for (i = 0; i < n_abbrs; i++) {
-    if (strcmp (type_name, abbrs[i].type_name) == 0) {
-      return abbrs[i].type;
+  /* the abbreviations are looked up for every typed value when parsing, keep
+   * them in a hash table */
+  if (g_once_init_enter (&abbrs_table)) {
+    GstStructureAbbreviation *abbrs;
+    GHashTable *table;
+    gint i, n_abbrs;
+
+    abbrs = gst_structure_get_abbrs (&n_abbrs);
+    table = g_hash_table_new (g_str_hash, g_str_equal);
+    for (i = 0; i < n_abbrs; i++) {
+      if (!g_hash_table_contains (table, abbrs[i].type_name))
+        g_hash_table_insert (table, (gpointer) abbrs[i].type_name,
+            GSIZE_TO_POINTER (abbrs[i].type));
     }
+    g_once_init_leave (&abbrs_table, table);
   }
 
+  type = g_hash_table_lookup (abbrs_table, type_name);
+  if (type != NULL)
+    return (GType) GPOINTER_TO_SIZE (type);
+
   /* this is the fallback */
   return g_type_from_name (type_name);
 }
@@ -1843,6 +2179,75 @@ gst_structure_to_string (const GstStructure * structure)
   return g_string_free (s, FALSE);
 }
 
+/**
+ * gst_structure_to_binary:
+ * @structure: a #GstStructure
+ * @size: (out) (allow-none): location for the size of the result
+ *
+ * Serializes @structure into a compact binary form that can be turned back
+ * into a structure with gst_structure_from_binary(). This is a lot faster
+ * than the string form for exchanging structures between processes, like
+ * the payload of events, messages and queries. The binary form is versioned
+ * and only meant to be read by the same GStreamer version.
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size): the binary form of
+ *     @structure, or %NULL when one of the fields can not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_structure_to_binary (const GstStructure * structure, gsize * size)
+{
+  GByteArray *out;
+  gboolean ok;
+
+  g_return_val_if_fail (structure != NULL, NULL);
+
+  out = g_byte_array_sized_new (16 + 8 * GST_STRUCTURE_FIELDS (structure)->len);
+  _priv_gst_value_binary_write_header (out, GST_VALUE_BINARY_KIND_STRUCTURE);
+  ok = _priv_gst_value_binary_write_structure (out, structure);
+
+  return _priv_gst_value_binary_finish (out, ok, size);
+}
+
+/**
+ * gst_structure_from_binary:
+ * @data: (array length=size): data created with gst_structure_to_binary()
+ * @size: the size of @data
+ *
+ * Creates a #GstStructure from its binary form as created by
+ * gst_structure_to_binary().
+ *
+ * Free-function: gst_structure_free
+ *
+ * Returns: (transfer full): a new #GstStructure or %NULL when @data is not
+ *     a valid binary structure.
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_structure_from_binary (const guint8 * data, gsize size)
+{
+  GstValueBinaryReader reader;
+  GstStructure *structure;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_value_binary_read_header (&reader, data, size,
+          GST_VALUE_BINARY_KIND_STRUCTURE))
+    return NULL;
+
+  structure = _priv_gst_value_binary_read_structure (&reader);
+  if (structure && reader.pos != reader.size) {
+    gst_structure_free (structure);
+    structure = NULL;
+  }
+
+  return structure;
+}
+
 /*
  * r will still point to the string. if end == next, the string will not be
  * null-terminated. In all other cases it will be.
@@ -2136,6 +2541,20 @@ gst_structure_parse_field (gchar * str,
   return TRUE;
 }
 
+/* the number deserializers also accept some names, only values that start
+ * with a letter and could be one of them need to be tried as numbers */
+static gboolean
+gst_structure_is_number_name (const gchar * s)
+{
+  return g_ascii_strncasecmp (s, "inf", 3) == 0 ||
+      g_ascii_strncasecmp (s, "nan", 3) == 0 ||
+      g_ascii_strcasecmp (s, "min") == 0 ||
+      g_ascii_strcasecmp (s, "max") == 0 ||
+      g_ascii_strcasecmp (s, "little_endian") == 0 ||
+      g_ascii_strcasecmp (s, "big_endian") == 0 ||
+      g_ascii_strcasecmp (s, "byte_order") == 0;
+}
+
 static gboolean
 gst_structure_parse_value (gchar * str,
     gchar ** after, GValue * value, GType default_type)
@@ -2199,7 +2618,7 @@ gst_structure_parse_value (gchar * str,
           { G_TYPE_INT, G_TYPE_DOUBLE, GST_TYPE_FRACTION, G_TYPE_BOOLEAN,
         G_TYPE_STRING
       };
-      int i;
+      int i = 0;
 
       if (G_UNLIKELY (!gst_structure_parse_string (s, &value_end, &s, TRUE)))
         return FALSE;
@@ -2207,7 +2626,11 @@ gst_structure_parse_value (gchar * str,
       c = *value_end;
       *value_end = '\0';
 
-      for (i = 0; i < G_N_ELEMENTS (try_types); i++) {
+      /* skip the number types for words like format names */
+      if (g_ascii_isalpha (*value_s) && !gst_structure_is_number_name (value_s))
+        i = 3;
+
+      for (; i < G_N_ELEMENTS (try_types); i++) {
         g_value_init (value, try_types[i]);
         ret = gst_value_deserialize (value, value_s);
         if (ret)
@@ -2252,19 +2675,41 @@ gst_structure_parse_value (gchar * str,
  */
 GstStructure *
 gst_structure_from_string (const gchar * string, gchar ** end)
+{
+  GstStructure *structure;
+  gchar *copy;
+  gchar *r;
+
+  g_return_val_if_fail (string != NULL, NULL);
+
+  copy = g_strdup (string);
+  structure = priv_gst_structure_from_string_inplace (copy, &r);
+
+  if (structure) {
+    if (end)
+      *end = (char *) string + (r - copy);
+    else if (*r)
+      g_warning ("gst_structure_from_string did not consume whole string,"
+          " but caller did not provide end pointer (\"%s\")", string);
+  }
+
+  g_free (copy);
+  return structure;
+}
+
+/* parses the structure at @string, unescaping strings in place, and stores
+ * the position after it in @end */
+GstStructure *
+priv_gst_structure_from_string_inplace (gchar * string, gchar ** end)
 {
   char *name;
-  char *copy;
   char *w;
   char *r;
   char save;
   GstStructure *structure = NULL;
   GstStructureField field;
 
-  g_return_val_if_fail (string != NULL, NULL);
-
-  copy = g_strdup (string);
-  r = copy;
+  r = string;
 
   /* skip spaces (FIXME: _isspace treats tabs and newlines as space!) */
   while (*r && (g_ascii_isspace (*r) || (r[0] == '\\'
@@ -2315,19 +2760,12 @@ gst_structure_from_string (const gchar * string, gchar ** end)
     gst_structure_set_field (structure, &field);
   } while (TRUE);
 
-  if (end)
-    *end = (char *) string + (r - copy);
-  else if (*r)
-    g_warning ("gst_structure_from_string did not consume whole string,"
-        " but caller did not provide end pointer (\"%s\")", string);
-
-  g_free (copy);
+  *end = r;
   return structure;
 
 error:
   if (structure)
     gst_structure_free (structure);
-  g_free (copy);
   return NULL;
 }
 
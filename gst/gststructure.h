@@ -83,6 +83,100 @@ struct _GstStructure {
   GQuark name;
 };
 
+/**
+ * GstStructureQuark:
+ * @GST_STRUCTURE_QUARK_VIDEO_X_RAW: "video/x-raw"
+ * @GST_STRUCTURE_QUARK_AUDIO_X_RAW: "audio/x-raw"
+ * @GST_STRUCTURE_QUARK_VIDEO_X_H264: "video/x-h264"
+ * @GST_STRUCTURE_QUARK_VIDEO_MPEG: "video/mpeg"
+ * @GST_STRUCTURE_QUARK_AUDIO_MPEG: "audio/mpeg"
+ * @GST_STRUCTURE_QUARK_IMAGE_JPEG: "image/jpeg"
+ * @GST_STRUCTURE_QUARK_APPLICATION_X_RTP: "application/x-rtp"
+ * @GST_STRUCTURE_QUARK_FORMAT: "format"
+ * @GST_STRUCTURE_QUARK_WIDTH: "width"
+ * @GST_STRUCTURE_QUARK_HEIGHT: "height"
+ * @GST_STRUCTURE_QUARK_FRAMERATE: "framerate"
+ * @GST_STRUCTURE_QUARK_PIXEL_ASPECT_RATIO: "pixel-aspect-ratio"
+ * @GST_STRUCTURE_QUARK_INTERLACE_MODE: "interlace-mode"
+ * @GST_STRUCTURE_QUARK_COLORIMETRY: "colorimetry"
+ * @GST_STRUCTURE_QUARK_CHROMA_SITE: "chroma-site"
+ * @GST_STRUCTURE_QUARK_RATE: "rate"
+ * @GST_STRUCTURE_QUARK_CHANNELS: "channels"
+ * @GST_STRUCTURE_QUARK_CHANNEL_MASK: "channel-mask"
+ * @GST_STRUCTURE_QUARK_LAYOUT: "layout"
+ * @GST_STRUCTURE_QUARK_STREAM_FORMAT: "stream-format"
+ * @GST_STRUCTURE_QUARK_ALIGNMENT: "alignment"
+ * @GST_STRUCTURE_QUARK_PROFILE: "profile"
+ * @GST_STRUCTURE_QUARK_LEVEL: "level"
+ * @GST_STRUCTURE_QUARK_PARSED: "parsed"
+ * @GST_STRUCTURE_QUARK_FRAMED: "framed"
+ * @GST_STRUCTURE_QUARK_MPEGVERSION: "mpegversion"
+ * @GST_STRUCTURE_QUARK_CODEC_DATA: "codec_data"
+ * @GST_STRUCTURE_QUARK_STREAMHEADER: "streamheader"
+ * @GST_STRUCTURE_QUARK_MEDIA: "media"
+ * @GST_STRUCTURE_QUARK_ENCODING_NAME: "encoding-name"
+ * @GST_STRUCTURE_QUARK_PAYLOAD: "payload"
+ * @GST_STRUCTURE_QUARK_CLOCK_RATE: "clock-rate"
+ * @GST_STRUCTURE_QUARK_LAST: the number of quarks
+ *
+ * Media types and field names that are often used in caps. Their quarks are
+ * created by gst_init() and can be retrieved with GST_STRUCTURE_QUARK()
+ * without hashing the string.
+ *
+ * Since: 1.2
+ */
+typedef enum {
+  GST_STRUCTURE_QUARK_VIDEO_X_RAW = 0,
+  GST_STRUCTURE_QUARK_AUDIO_X_RAW,
+  GST_STRUCTURE_QUARK_VIDEO_X_H264,
+  GST_STRUCTURE_QUARK_VIDEO_MPEG,
+  GST_STRUCTURE_QUARK_AUDIO_MPEG,
+  GST_STRUCTURE_QUARK_IMAGE_JPEG,
+  GST_STRUCTURE_QUARK_APPLICATION_X_RTP,
+  GST_STRUCTURE_QUARK_FORMAT,
+  GST_STRUCTURE_QUARK_WIDTH,
+  GST_STRUCTURE_QUARK_HEIGHT,
+  GST_STRUCTURE_QUARK_FRAMERATE,
+  GST_STRUCTURE_QUARK_PIXEL_ASPECT_RATIO,
+  GST_STRUCTURE_QUARK_INTERLACE_MODE,
+  GST_STRUCTURE_QUARK_COLORIMETRY,
+  GST_STRUCTURE_QUARK_CHROMA_SITE,
+  GST_STRUCTURE_QUARK_RATE,
+  GST_STRUCTURE_QUARK_CHANNELS,
+  GST_STRUCTURE_QUARK_CHANNEL_MASK,
+  GST_STRUCTURE_QUARK_LAYOUT,
+  GST_STRUCTURE_QUARK_STREAM_FORMAT,
+  GST_STRUCTURE_QUARK_ALIGNMENT,
+  GST_STRUCTURE_QUARK_PROFILE,
+  GST_STRUCTURE_QUARK_LEVEL,
+  GST_STRUCTURE_QUARK_PARSED,
+  GST_STRUCTURE_QUARK_FRAMED,
+  GST_STRUCTURE_QUARK_MPEGVERSION,
+  GST_STRUCTURE_QUARK_CODEC_DATA,
+  GST_STRUCTURE_QUARK_STREAMHEADER,
+  GST_STRUCTURE_QUARK_MEDIA,
+  GST_STRUCTURE_QUARK_ENCODING_NAME,
+  GST_STRUCTURE_QUARK_PAYLOAD,
+  GST_STRUCTURE_QUARK_CLOCK_RATE,
+  GST_STRUCTURE_QUARK_LAST
+} GstStructureQuark;
+
+GST_EXPORT GQuark _gst_structure_quarks[GST_STRUCTURE_QUARK_LAST];
+
+/**
+ * GST_STRUCTURE_QUARK:
+ * @q: the name of a #GstStructureQuark without the GST_STRUCTURE_QUARK_
+ *     prefix, for example WIDTH
+ *
+ * Gets the #GQuark of a common media type or field name. Use it with the
+ * functions that take quarks, like gst_structure_id_get() or
+ * gst_caps_new_id_simple(), to avoid the string lookup of their string
+ * counterparts.
+ *
+ * Since: 1.2
+ */
+#define GST_STRUCTURE_QUARK(q) (_gst_structure_quarks[GST_STRUCTURE_QUARK_##q])
+
 GType                 gst_structure_get_type             (void);
 
 GstStructure *        gst_structure_new_empty            (const gchar * name) G_GNUC_MALLOC;
@@ -150,6 +244,35 @@ void                  gst_structure_id_set_valist        (GstStructure        *
                                                           GQuark                fieldname,
                                                           va_list varargs);
 
+void                  gst_structure_id_set_boolean       (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          gboolean              value);
+
+void                  gst_structure_id_set_int           (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          gint                  value);
+
+void                  gst_structure_id_set_uint          (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          guint                 value);
+
+void                  gst_structure_id_set_int64         (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          gint64                value);
+
+void                  gst_structure_id_set_uint64        (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          guint64               value);
+
+void                  gst_structure_id_set_double        (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          gdouble               value);
+
+void                  gst_structure_id_set_enum          (GstStructure        * structure,
+                                                          GQuark                field,
+                                                          GType                 enum_type,
+                                                          gint                  value);
+
 gboolean              gst_structure_get_valist           (const GstStructure  * structure,
                                                           const char          * first_fieldname,
                                                           va_list              args);
@@ -259,6 +382,10 @@ gboolean              gst_structure_get_fraction         (const GstStructure  *
 
 gchar *               gst_structure_to_string    (const GstStructure * structure) G_GNUC_MALLOC;
 
+guint8 *              gst_structure_to_binary    (const GstStructure * structure,
+                                                  gsize              * size) G_GNUC_MALLOC;
+GstStructure *        gst_structure_from_binary  (const guint8       * data,
+                                                  gsize                size);
 GstStructure *        gst_structure_from_string  (const gchar * string,
                                                   gchar      ** end) G_GNUC_MALLOC;
 
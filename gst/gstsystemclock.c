@@ -75,7 +75,7 @@ struct _GstSystemClockPrivate
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  GPtrArray *entries;           /* binary min-heap of pending async entries */
   GCond entries_changed;
 
   GstClockType clock_type;
@@ -130,6 +130,8 @@ static GstClockReturn gst_system_clock_id_wait_async (GstClock * clock,
     GstClockEntry * entry);
 static void gst_system_clock_id_unschedule (GstClock * clock,
     GstClockEntry * entry);
+static void gst_system_clock_unschedule_ids (GstClock * clock,
+    GstClockEntry ** entries, guint n_entries);
 static void gst_system_clock_async_thread (GstClock * clock);
 static gboolean gst_system_clock_start_async (GstSystemClock * clock);
 static void gst_system_clock_add_wakeup (GstSystemClock * sysclock);
@@ -167,6 +169,7 @@ gst_system_clock_class_init (GstSystemClockClass * klass)
   gstclock_class->wait = gst_system_clock_id_wait_jitter;
   gstclock_class->wait_async = gst_system_clock_id_wait_async;
   gstclock_class->unschedule = gst_system_clock_id_unschedule;
+  gstclock_class->unschedule_ids = gst_system_clock_unschedule_ids;
 }
 
 static void
@@ -185,7 +188,7 @@ gst_system_clock_init (GstSystemClock * clock)
   priv->clock_type = DEFAULT_CLOCK_TYPE;
   priv->timer = gst_poll_new_timer ();
 
-  priv->entries = NULL;
+  priv->entries = g_ptr_array_new ();
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -210,14 +213,14 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
 
   /* else we have to stop the thread */
   GST_OBJECT_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntry *entry = (GstClockEntry *) entries->data;
+  for (i = 0; priv->entries && i < priv->entries->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (priv->entries, i);
 
     GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", entry);
     SET_ENTRY_STATUS (entry, GST_CLOCK_UNSCHEDULED);
@@ -231,9 +234,11 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG (GST_CAT_CLOCK, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
-  priv->entries = NULL;
+  if (priv->entries) {
+    g_ptr_array_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
+    g_ptr_array_free (priv->entries, TRUE);
+    priv->entries = NULL;
+  }
 
   gst_poll_free (priv->timer);
   g_cond_clear (&priv->entries_changed);
@@ -368,6 +373,121 @@ gst_system_clock_wait_wakeup (GstSystemClock * sysclock)
   }
 }
 
+/* The pending async entries are kept in a binary min-heap ordered on the
+ * entry time. This makes adding an entry and rescheduling a periodic entry
+ * O(log n) instead of walking (or resorting) a sorted list, which matters
+ * when many periodic ids are active on the same clock.
+ *
+ * All functions below must be called with the object lock held. */
+#define ENTRY_HEAP_GET(h,i)   ((GstClockEntry *) g_ptr_array_index ((h), (i)))
+
+static void
+gst_system_clock_heap_swap (GPtrArray * heap, guint a, guint b)
+{
+  gpointer tmp = heap->pdata[a];
+
+  heap->pdata[a] = heap->pdata[b];
+  heap->pdata[b] = tmp;
+}
+
+static void
+gst_system_clock_heap_sift_up (GPtrArray * heap, guint idx)
+{
+  while (idx > 0) {
+    guint parent = (idx - 1) / 2;
+
+    if (gst_clock_id_compare_func (ENTRY_HEAP_GET (heap, idx),
+            ENTRY_HEAP_GET (heap, parent)) >= 0)
+      break;
+
+    gst_system_clock_heap_swap (heap, idx, parent);
+    idx = parent;
+  }
+}
+
+static void
+gst_system_clock_heap_sift_down (GPtrArray * heap, guint idx)
+{
+  guint len = heap->len;
+
+  while (TRUE) {
+    guint left = 2 * idx + 1;
+    guint right = left + 1;
+    guint smallest = idx;
+
+    if (left < len && gst_clock_id_compare_func (ENTRY_HEAP_GET (heap, left),
+            ENTRY_HEAP_GET (heap, smallest)) < 0)
+      smallest = left;
+    if (right < len && gst_clock_id_compare_func (ENTRY_HEAP_GET (heap, right),
+            ENTRY_HEAP_GET (heap, smallest)) < 0)
+      smallest = right;
+
+    if (smallest == idx)
+      break;
+
+    gst_system_clock_heap_swap (heap, idx, smallest);
+    idx = smallest;
+  }
+}
+
+static void
+gst_system_clock_heap_push (GPtrArray * heap, GstClockEntry * entry)
+{
+  g_ptr_array_add (heap, entry);
+  gst_system_clock_heap_sift_up (heap, heap->len - 1);
+}
+
+/* remove @entry from the heap. The entry is almost always the head so we
+ * check that first before searching the heap. Returns FALSE when the entry
+ * was not found. */
+static gboolean
+gst_system_clock_heap_remove (GPtrArray * heap, GstClockEntry * entry)
+{
+  guint idx, last;
+
+  if (G_LIKELY (heap->len > 0 && ENTRY_HEAP_GET (heap, 0) == entry)) {
+    idx = 0;
+  } else {
+    for (idx = 1; idx < heap->len; idx++)
+      if (ENTRY_HEAP_GET (heap, idx) == entry)
+        break;
+    if (idx >= heap->len)
+      return FALSE;
+  }
+
+  last = heap->len - 1;
+  if (idx != last) {
+    heap->pdata[idx] = heap->pdata[last];
+    g_ptr_array_set_size (heap, last);
+    gst_system_clock_heap_sift_down (heap, idx);
+    gst_system_clock_heap_sift_up (heap, idx);
+  } else {
+    g_ptr_array_set_size (heap, last);
+  }
+  return TRUE;
+}
+
+/* move @entry to its place in the heap after its time was increased, without
+ * removing and adding it again. Returns FALSE when the entry was not found. */
+static gboolean
+gst_system_clock_heap_reschedule (GPtrArray * heap, GstClockEntry * entry)
+{
+  guint idx;
+
+  if (G_LIKELY (heap->len > 0 && ENTRY_HEAP_GET (heap, 0) == entry)) {
+    idx = 0;
+  } else {
+    for (idx = 1; idx < heap->len; idx++)
+      if (ENTRY_HEAP_GET (heap, idx) == entry)
+        break;
+    if (idx >= heap->len)
+      return FALSE;
+  }
+
+  gst_system_clock_heap_sift_down (heap, idx);
+  return TRUE;
+}
+
 /* this thread reads the sorted clock entries from the queue.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
@@ -397,7 +517,7 @@ gst_system_clock_async_thread (GstClock * clock)
     GstClockReturn res;
 
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->entries->len == 0) {
       GST_CAT_DEBUG (GST_CAT_CLOCK, "no clock entries, waiting..");
       /* wait for work to do */
       GST_SYSTEM_CLOCK_WAIT (clock);
@@ -416,7 +536,7 @@ gst_system_clock_async_thread (GstClock * clock)
     }
 
     /* pick the next entry */
-    entry = priv->entries->data;
+    entry = ENTRY_HEAP_GET (priv->entries, 0);
     GST_OBJECT_UNLOCK (clock);
 
     requested = entry->time;
@@ -448,11 +568,12 @@ gst_system_clock_async_thread (GstClock * clock)
         }
         if (entry->type == GST_CLOCK_ENTRY_PERIODIC) {
           GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
-          /* adjust time now */
+          /* adjust time now and move the entry down to its new place in
+           * the heap. Other entries might have been added while we were
+           * firing the callback so it is not necessarily the head
+           * anymore. */
           entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
+          gst_system_clock_heap_reschedule (priv->entries, entry);
           /* and restart */
           continue;
         } else {
@@ -481,8 +602,8 @@ gst_system_clock_async_thread (GstClock * clock)
     }
   next_entry:
     /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
-    gst_clock_id_unref ((GstClockID) entry);
+    if (gst_system_clock_heap_remove (priv->entries, entry))
+      gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
   /* signal exit */
@@ -773,9 +894,9 @@ no_thread:
 }
 
 /* Add an entry to the list of pending async waits. The entry is inserted
- * in sorted order. If we inserted the entry at the head of the list, we
- * need to signal the thread as it might either be waiting on it or waiting
- * for a new entry.
+ * in the heap of pending entries. If we inserted the entry at the head of
+ * the heap, we need to signal the thread as it might either be waiting on
+ * it or waiting for a new entry.
  *
  * MT safe.
  */
@@ -799,21 +920,20 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
   if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
     goto was_unscheduled;
 
-  if (priv->entries)
-    head = priv->entries->data;
+  if (priv->entries->len > 0)
+    head = ENTRY_HEAP_GET (priv->entries, 0);
   else
     head = NULL;
 
   /* need to take a ref */
   gst_clock_id_ref ((GstClockID) entry);
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
+  /* insert the entry in the heap */
+  gst_system_clock_heap_push (priv->entries, entry);
 
   /* only need to send the signal if the entry was added to the
    * front, else the thread is just waiting for another entry and
    * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
+  if (ENTRY_HEAP_GET (priv->entries, 0) == entry) {
     GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry added to head %p", head);
     if (head == NULL) {
       /* the list was empty before, signal the cond so that the async thread can
@@ -861,19 +981,16 @@ was_unscheduled:
  * We cannot really decide if the signal is needed or not because the entry
  * could be waited on in async or sync mode.
  *
- * MT safe.
+ * Must be called with the clock lock.
  */
 static void
-gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
+gst_system_clock_id_unschedule_unlocked (GstSystemClock * sysclock,
+    GstClockEntry * entry)
 {
-  GstSystemClock *sysclock;
   GstClockReturn status;
 
-  sysclock = GST_SYSTEM_CLOCK_CAST (clock);
-
   GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", entry);
 
-  GST_OBJECT_LOCK (clock);
   /* change the entry status to unscheduled */
   do {
     status = GET_ENTRY_STATUS (entry);
@@ -891,5 +1008,28 @@ gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
       entry->woken_up = TRUE;
     }
   }
+}
+
+static void
+gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
+{
+  GST_OBJECT_LOCK (clock);
+  gst_system_clock_id_unschedule_unlocked (GST_SYSTEM_CLOCK_CAST (clock),
+      entry);
+  GST_OBJECT_UNLOCK (clock);
+}
+
+/* only the first wakeup writes to the control socket, doing them all with
+ * the lock held wakes up the waiting threads once */
+static void
+gst_system_clock_unschedule_ids (GstClock * clock, GstClockEntry ** entries,
+    guint n_entries)
+{
+  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+  guint i;
+
+  GST_OBJECT_LOCK (clock);
+  for (i = 0; i < n_entries; i++)
+    gst_system_clock_id_unschedule_unlocked (sysclock, entries[i]);
   GST_OBJECT_UNLOCK (clock);
 }
@@ -43,6 +43,7 @@
 #include "gstbuffer.h"
 #include "gstquark.h"
 #include "gststructure.h"
+#include "gstvaluebinary.h"
 
 #include <gobject/gvaluecollector.h>
 #include <string.h>
@@ -78,12 +79,20 @@ GstTagInfo;
 
 #define g_value_get_char g_value_get_schar
 
+/* serializes registrations, lookups don't take it */
 static GMutex __tag_mutex;
 #define TAG_LOCK g_mutex_lock (&__tag_mutex)
 #define TAG_UNLOCK g_mutex_unlock (&__tag_mutex)
 
-/* tags hash table: maps tag name string => GstTagInfo */
+/* tags hash table: maps tag name string => GstTagInfo
+ *
+ * The table is never modified once it is published, registering a tag
+ * publishes a copy with the new tag. Lookups therefore only need to read the
+ * pointer. Replaced tables are kept because other threads might still be
+ * reading them; like the tag infos they are never freed. */
 static GHashTable *__tags;
+static GSList *__retired_tags = NULL;
+static gboolean __tags_published = FALSE;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstTagList, gst_tag_list);
 
@@ -387,6 +396,9 @@ _priv_gst_tag_initialize (void)
   gst_tag_register_static (GST_TAG_IMAGE_ORIENTATION, GST_TAG_FLAG_META,
       G_TYPE_STRING, _("image orientation"),
       _("How the image should be rotated or flipped before display"), NULL);
+
+  /* from now on registrations replace the table */
+  __tags_published = TRUE;
 }
 
 /**
@@ -438,13 +450,9 @@ gst_tag_merge_strings_with_comma (GValue * dest, const GValue * src)
 static GstTagInfo *
 gst_tag_lookup (const gchar * tag_name)
 {
-  GstTagInfo *ret;
-
-  TAG_LOCK;
-  ret = g_hash_table_lookup (__tags, (gpointer) tag_name);
-  TAG_UNLOCK;
+  GHashTable *tags = g_atomic_pointer_get (&__tags);
 
-  return ret;
+  return g_hash_table_lookup (tags, (gpointer) tag_name);
 }
 
 /**
@@ -518,9 +526,11 @@ gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
   g_return_if_fail (blurb != NULL);
   g_return_if_fail (type != 0 && type != GST_TYPE_LIST);
 
-  info = gst_tag_lookup (name);
+  TAG_LOCK;
+  info = g_hash_table_lookup (__tags, (gpointer) name);
 
   if (info) {
+    TAG_UNLOCK;
     g_return_if_fail (info->type == type);
     return;
   }
@@ -533,8 +543,23 @@ gst_tag_register_static (const gchar * name, GstTagFlag flag, GType type,
   info->blurb = blurb;
   info->merge_func = func;
 
-  TAG_LOCK;
-  g_hash_table_insert (__tags, (gpointer) name, info);
+  if (G_LIKELY (__tags_published)) {
+    GHashTable *tags;
+    GHashTableIter iter;
+    gpointer key, value;
+
+    tags = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_iter_init (&iter, __tags);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+      g_hash_table_insert (tags, key, value);
+    g_hash_table_insert (tags, (gpointer) name, info);
+
+    __retired_tags = g_slist_prepend (__retired_tags, __tags);
+    g_atomic_pointer_set (&__tags, tags);
+  } else {
+    /* still in _priv_gst_tag_initialize(), nobody else can see the table */
+    g_hash_table_insert (__tags, (gpointer) name, info);
+  }
   TAG_UNLOCK;
 }
 
@@ -861,6 +886,82 @@ gst_tag_list_new_from_string (const gchar * str)
   return tag_list;
 }
 
+/**
+ * gst_tag_list_to_binary:
+ * @list: a #GstTagList
+ * @size: (out) (allow-none): location for the size of the result
+ *
+ * Serializes a tag list and its scope into a compact binary form, see
+ * gst_structure_to_binary().
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size): the binary form of @list,
+ *     or %NULL when one of the tags can not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_tag_list_to_binary (const GstTagList * list, gsize * size)
+{
+  GByteArray *out;
+  gboolean ok;
+
+  g_return_val_if_fail (GST_IS_TAG_LIST (list), NULL);
+
+  out = g_byte_array_new ();
+  _priv_gst_value_binary_write_header (out, GST_VALUE_BINARY_KIND_TAG_LIST);
+  _priv_gst_value_binary_write_uint (out, GST_TAG_LIST_SCOPE (list));
+  ok = _priv_gst_value_binary_write_structure (out,
+      GST_TAG_LIST_STRUCTURE (list));
+
+  return _priv_gst_value_binary_finish (out, ok, size);
+}
+
+/**
+ * gst_tag_list_new_from_binary:
+ * @data: (array length=size): data created with gst_tag_list_to_binary()
+ * @size: the size of @data
+ *
+ * Deserializes a tag list that was serialized with gst_tag_list_to_binary().
+ *
+ * Returns: a new #GstTagList, or NULL in case of an error.
+ *
+ * Since: 1.2
+ */
+GstTagList *
+gst_tag_list_new_from_binary (const guint8 * data, gsize size)
+{
+  GstValueBinaryReader reader;
+  GstStructure *s;
+  GstTagList *tag_list;
+  guint64 scope;
+
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  if (!_priv_gst_value_binary_read_header (&reader, data, size,
+          GST_VALUE_BINARY_KIND_TAG_LIST))
+    return NULL;
+
+  if (!_priv_gst_value_binary_read_uint (&reader, &scope)
+      || scope > GST_TAG_SCOPE_GLOBAL)
+    return NULL;
+
+  s = _priv_gst_value_binary_read_structure (&reader);
+  if (s == NULL)
+    return NULL;
+
+  if (reader.pos != reader.size || !gst_structure_has_name (s, "taglist")) {
+    gst_structure_free (s);
+    return NULL;
+  }
+
+  tag_list = gst_tag_list_new_internal (s);
+  GST_TAG_LIST_SCOPE (tag_list) = scope;
+
+  return tag_list;
+}
+
 /**
  * gst_tag_list_n_tags:
  * @list: A #GstTagList.
@@ -1073,6 +1174,17 @@ gst_tag_list_copy_foreach (GQuark tag_quark, const GValue * value,
   return TRUE;
 }
 
+/* the values of a tag list were checked when they were added, so they can be
+ * set on an empty list as they are */
+static gboolean
+gst_tag_list_set_foreach (GQuark tag_quark, const GValue * value,
+    gpointer user_data)
+{
+  gst_structure_id_set_value ((GstStructure *) user_data, tag_quark, value);
+
+  return TRUE;
+}
+
 /**
  * gst_tag_list_insert:
  * @into: list to merge into
@@ -1097,6 +1209,16 @@ gst_tag_list_insert (GstTagList * into, const GstTagList * from,
   if (mode == GST_TAG_MERGE_REPLACE_ALL) {
     gst_structure_remove_all_fields (GST_TAG_LIST_STRUCTURE (into));
   }
+
+  /* nothing to merge with, all modes but KEEP_ALL take the values of from,
+   * no need to look up the tags */
+  if (gst_tag_list_is_empty (into)) {
+    if (mode != GST_TAG_MERGE_KEEP_ALL)
+      gst_structure_foreach (GST_TAG_LIST_STRUCTURE (from),
+          gst_tag_list_set_foreach, GST_TAG_LIST_STRUCTURE (into));
+    return;
+  }
+
   gst_structure_foreach (GST_TAG_LIST_STRUCTURE (from),
       gst_tag_list_copy_foreach, &data);
 }
@@ -1119,7 +1241,6 @@ gst_tag_list_merge (const GstTagList * list1, const GstTagList * list2,
     GstTagMergeMode mode)
 {
   GstTagList *list1_cp;
-  const GstTagList *list2_cp;
 
   g_return_val_if_fail (list1 == NULL || GST_IS_TAG_LIST (list1), NULL);
   g_return_val_if_fail (list2 == NULL || GST_IS_TAG_LIST (list2), NULL);
@@ -1132,12 +1253,16 @@ gst_tag_list_merge (const GstTagList * list1, const GstTagList * list2,
 
   /* create empty list, we need to do this to correctly handling merge modes */
   list1_cp = (list1) ? gst_tag_list_copy (list1) : gst_tag_list_new_empty ();
-  list2_cp = (list2) ? list2 : gst_tag_list_new_empty ();
 
-  gst_tag_list_insert (list1_cp, list2_cp, mode);
+  /* merging with an empty list only clears the first one in REPLACE_ALL
+   * mode */
+  if (!list2) {
+    if (mode == GST_TAG_MERGE_REPLACE_ALL)
+      gst_structure_remove_all_fields (GST_TAG_LIST_STRUCTURE (list1_cp));
+    return list1_cp;
+  }
 
-  if (!list2)
-    gst_tag_list_unref ((GstTagList *) list2_cp);
+  gst_tag_list_insert (list1_cp, list2, mode);
 
   return list1_cp;
 }
@@ -234,6 +234,10 @@ GstTagScope  gst_tag_list_get_scope         (const GstTagList * list);
 
 gchar      * gst_tag_list_to_string         (const GstTagList * list) G_GNUC_MALLOC;
 GstTagList * gst_tag_list_new_from_string   (const gchar      * str) G_GNUC_MALLOC;
+guint8     * gst_tag_list_to_binary         (const GstTagList * list,
+                                             gsize            * size) G_GNUC_MALLOC;
+GstTagList * gst_tag_list_new_from_binary   (const guint8     * data,
+                                             gsize              size) G_GNUC_MALLOC;
 
 gint         gst_tag_list_n_tags            (const GstTagList * list);
 const gchar* gst_tag_list_nth_tag_name      (const GstTagList * list, guint index);
@@ -60,6 +60,17 @@
  * application. The application can receive messages from the #GstBus in its
  * mainloop.
  *
+ * A task that runs on a #GstSharedTaskPool can give its worker thread back
+ * instead of blocking when its function has to wait for something, for
+ * example for data in a queue. The function then calls gst_task_yield() and
+ * returns. The task is not called again until gst_task_resume() is called,
+ * typically by the thread that makes the awaited data available.
+ *
+ * The thread of a task can be bound to a set of processors with
+ * gst_task_set_affinity() and given a real-time scheduling policy with
+ * gst_task_set_scheduling(). This is typically done when handling the
+ * #GST_STREAM_STATUS_TYPE_CREATE stream status message for the task.
+ *
  * For debugging purposes, the task will configure its object name as the thread
  * name on Linux. Please note that the object name should be configured before the
  * task is started; changing the object name after the task has been started, has
@@ -72,6 +83,7 @@
 
 #include "gstinfo.h"
 #include "gsttask.h"
+#include "gsttracerutils.h"
 #include "glib-compat-private.h"
 
 #include <stdio.h>
@@ -80,6 +92,11 @@
 #include <sys/prctl.h>
 #endif
 
+#if defined(HAVE_SCHED_SETAFFINITY) || defined(HAVE_SCHED_SETSCHEDULER)
+#include <sched.h>
+#include <errno.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (task_debug);
 #define GST_CAT_DEFAULT (task_debug)
 
@@ -106,6 +123,34 @@ struct _GstTaskPrivate
   /* remember the pool and id that is currently running. */
   gpointer id;
   GstTaskPool *pool_id;
+
+  /* running on a shared pool, every iteration is pushed on the pool */
+  gboolean cooperative;
+  /* the enter_func was called */
+  gboolean entered;
+  /* returned the worker while paused or after yielding, with LOCK */
+  gboolean parked;
+  /* the function called gst_task_yield() and the task parks when it returns,
+   * unless gst_task_resume() was called in the meantime, with LOCK */
+  gboolean yielding;
+  gboolean resumed;
+
+  /* placement of the thread, with LOCK */
+  guint *cpus;
+  guint n_cpus;
+  GstTaskSchedulingPolicy policy;
+  gint priority;
+
+  /* what to restore when the thread is returned to the pool */
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET)
+  cpu_set_t old_cpus;
+  gboolean restore_cpus;
+#endif
+#ifdef HAVE_SCHED_SETSCHEDULER
+  int old_policy;
+  struct sched_param old_param;
+  gboolean restore_sched;
+#endif
 };
 
 #ifdef _MSC_VER
@@ -217,6 +262,7 @@ gst_task_finalize (GObject * object)
     task->notify (task->user_data);
 
   gst_object_unref (priv->pool);
+  g_free (priv->cpus);
 
   /* task thread cannot be running here since it holds a ref
    * to the task so that the finalize could not have happened */
@@ -256,12 +302,138 @@ gst_task_configure_name (GstTask * task)
 #endif
 }
 
+/* apply the affinity and scheduling policy of @task to the current thread
+ * and remember what to restore in gst_task_restore_thread().
+ * This function must be called with the task LOCK. */
+static void
+gst_task_place_thread (GstTask * task)
+{
+  GstTaskPrivate *priv = task->priv;
+
+  if (priv->n_cpus > 0) {
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET)
+    cpu_set_t set;
+    guint i;
+
+    CPU_ZERO (&set);
+    for (i = 0; i < priv->n_cpus; i++) {
+      if (priv->cpus[i] < CPU_SETSIZE)
+        CPU_SET (priv->cpus[i], &set);
+    }
+    if (sched_getaffinity (0, sizeof (priv->old_cpus), &priv->old_cpus) == 0
+        && sched_setaffinity (0, sizeof (set), &set) == 0)
+      priv->restore_cpus = TRUE;
+    else
+      GST_WARNING_OBJECT (task, "could not set affinity: %s",
+          g_strerror (errno));
+#else
+    GST_WARNING_OBJECT (task, "thread affinity is not supported");
+#endif
+  }
+
+  if (priv->policy != GST_TASK_SCHEDULING_DEFAULT) {
+#ifdef HAVE_SCHED_SETSCHEDULER
+    struct sched_param param = { 0, };
+    int policy;
+
+    policy = priv->policy == GST_TASK_SCHEDULING_FIFO ? SCHED_FIFO : SCHED_RR;
+    param.sched_priority = CLAMP (priv->priority,
+        sched_get_priority_min (policy), sched_get_priority_max (policy));
+
+    priv->old_policy = sched_getscheduler (0);
+    if (priv->old_policy != -1 && sched_getparam (0, &priv->old_param) == 0
+        && sched_setscheduler (0, policy, &param) == 0)
+      priv->restore_sched = TRUE;
+    else
+      GST_WARNING_OBJECT (task, "could not set scheduling policy: %s",
+          g_strerror (errno));
+#else
+    GST_WARNING_OBJECT (task, "scheduling policies are not supported");
+#endif
+  }
+}
+
+/* undo gst_task_place_thread() before the thread goes back to the pool.
+ * This function must be called with the task LOCK. */
+static void
+gst_task_restore_thread (GstTask * task)
+{
+  GstTaskPrivate *priv = task->priv;
+
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET)
+  if (priv->restore_cpus) {
+    sched_setaffinity (0, sizeof (priv->old_cpus), &priv->old_cpus);
+    priv->restore_cpus = FALSE;
+  }
+#endif
+#ifdef HAVE_SCHED_SETSCHEDULER
+  if (priv->restore_sched) {
+    sched_setscheduler (0, priv->old_policy, &priv->old_param);
+    priv->restore_sched = FALSE;
+  }
+#endif
+}
+
+/* push the next iteration of a cooperative task on its pool and release
+ * @lock. Returns %FALSE when that failed and the current thread has to
+ * continue. */
+static gboolean
+gst_task_reschedule (GstTask * task, GRecMutex * lock)
+{
+  GstTaskPrivate *priv = task->priv;
+  GError *error = NULL;
+
+  GST_OBJECT_LOCK (task);
+  task->thread = NULL;
+  g_rec_mutex_unlock (lock);
+  gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
+      task, &error);
+  if (G_UNLIKELY (error != NULL)) {
+    GST_WARNING_OBJECT (task, "failed to reschedule: %s", error->message);
+    g_error_free (error);
+    /* continue in this thread */
+    task->thread = g_thread_self ();
+    GST_OBJECT_UNLOCK (task);
+    g_rec_mutex_lock (lock);
+    return FALSE;
+  }
+  GST_OBJECT_UNLOCK (task);
+
+  return TRUE;
+}
+
+/* schedule a task again that parked while paused.
+ * This function must be called with the task LOCK. */
+static void
+gst_task_unpark (GstTask * task)
+{
+  GstTaskPrivate *priv = task->priv;
+  GError *error = NULL;
+
+  if (!priv->parked)
+    return;
+
+  priv->parked = FALSE;
+  gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
+      task, &error);
+  if (G_UNLIKELY (error != NULL)) {
+    g_warning ("failed to schedule task: %s", error->message);
+    g_error_free (error);
+    /* nothing runs the task anymore, release the join */
+    priv->entered = FALSE;
+    task->running = FALSE;
+    GST_TASK_SIGNAL (task);
+    gst_object_unref (task);
+  }
+}
+
 static void
 gst_task_func (GstTask * task)
 {
   GRecMutex *lock;
   GThread *tself;
   GstTaskPrivate *priv;
+  gboolean entered;
 
   priv = task->priv;
 
@@ -279,20 +451,41 @@ gst_task_func (GstTask * task)
   if (G_UNLIKELY (lock == NULL))
     goto no_lock;
   task->thread = tself;
+  /* a cooperative task comes back here for every iteration */
+  entered = priv->entered;
+  priv->entered = TRUE;
+  /* threads of a shared pool are not ours to place */
+  if (!entered && !priv->cooperative)
+    gst_task_place_thread (task);
   GST_OBJECT_UNLOCK (task);
 
   /* fire the enter_func callback when we need to */
-  if (priv->enter_func)
+  if (!entered && priv->enter_func)
     priv->enter_func (task, tself, priv->enter_user_data);
 
   /* locking order is TASK_LOCK, LOCK */
   g_rec_mutex_lock (lock);
-  /* configure the thread name now */
-  gst_task_configure_name (task);
+  /* configure the thread name now, the threads of a shared pool keep their
+   * own name */
+  if (!priv->cooperative)
+    gst_task_configure_name (task);
+
+  if (!entered)
+    GST_TRACER_TASK_START (task);
 
   while (G_LIKELY (GET_TASK_STATE (task) != GST_TASK_STOPPED)) {
     if (G_UNLIKELY (GET_TASK_STATE (task) == GST_TASK_PAUSED)) {
       GST_OBJECT_LOCK (task);
+      if (priv->cooperative && GST_TASK_STATE (task) == GST_TASK_PAUSED) {
+        /* give the worker back, gst_task_set_state() schedules us again */
+        GST_INFO_OBJECT (task, "Task going to paused, parking");
+        priv->parked = TRUE;
+        task->thread = NULL;
+        g_rec_mutex_unlock (lock);
+        GST_TASK_SIGNAL (task);
+        GST_OBJECT_UNLOCK (task);
+        return;
+      }
       while (G_UNLIKELY (GST_TASK_STATE (task) == GST_TASK_PAUSED)) {
         g_rec_mutex_unlock (lock);
 
@@ -313,15 +506,42 @@ gst_task_func (GstTask * task)
       GST_OBJECT_UNLOCK (task);
     }
 
+    GST_TRACER_TASK_ITERATION_PRE (task);
     task->func (task->user_data);
+    GST_TRACER_TASK_ITERATION_POST (task);
+
+    if (priv->cooperative) {
+      gboolean yielded;
+
+      GST_OBJECT_LOCK (task);
+      yielded = priv->yielding && !priv->resumed;
+      priv->yielding = priv->resumed = FALSE;
+      if (yielded && GST_TASK_STATE (task) == GST_TASK_STARTED) {
+        /* give the worker back, gst_task_resume() schedules us again */
+        GST_LOG_OBJECT (task, "Task yielded, parking");
+        priv->parked = TRUE;
+        task->thread = NULL;
+        g_rec_mutex_unlock (lock);
+        GST_OBJECT_UNLOCK (task);
+        return;
+      }
+      GST_OBJECT_UNLOCK (task);
+
+      if (GET_TASK_STATE (task) == GST_TASK_STARTED
+          && gst_task_reschedule (task, lock))
+        return;
+    }
   }
 done:
+  GST_TRACER_TASK_STOP (task);
   g_rec_mutex_unlock (lock);
 
   GST_OBJECT_LOCK (task);
   task->thread = NULL;
 
 exit:
+  priv->entered = FALSE;
+  gst_task_restore_thread (task);
   if (priv->leave_func) {
     /* fire the leave_func callback when we need to. We need to do this before
      * we signal the task and with the task lock released. */
@@ -580,6 +800,76 @@ gst_task_set_leave_callback (GstTask * task, GstTaskThreadFunc leave_func,
   GST_OBJECT_UNLOCK (task);
 }
 
+/**
+ * gst_task_set_affinity:
+ * @task: a #GstTask
+ * @cpus: (array length=n_cpus) (allow-none): the processors to run on
+ * @n_cpus: the number of processors in @cpus
+ *
+ * Bind the thread of @task to the processors in @cpus, for example the
+ * processors of one NUMA node. Pass %NULL to let the thread run on any
+ * processor.
+ *
+ * The affinity is applied when the task enters its thread and the previous
+ * affinity of the thread is restored when the task leaves it. It has no
+ * effect on tasks running on a #GstSharedTaskPool and is ignored on
+ * platforms that do not support it.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_task_set_affinity (GstTask * task, const guint * cpus, guint n_cpus)
+{
+  GstTaskPrivate *priv;
+
+  g_return_if_fail (GST_IS_TASK (task));
+  g_return_if_fail (cpus != NULL || n_cpus == 0);
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  g_free (priv->cpus);
+  priv->cpus = n_cpus > 0 ? g_memdup (cpus, n_cpus * sizeof (guint)) : NULL;
+  priv->n_cpus = n_cpus;
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_set_scheduling:
+ * @task: a #GstTask
+ * @policy: the scheduling policy
+ * @priority: the real-time priority for @policy, clamped to the range the
+ *     platform supports
+ *
+ * Run the thread of @task with the scheduling policy @policy. The real-time
+ * policies usually require special privileges, a warning is logged when
+ * the policy could not be set.
+ *
+ * Like gst_task_set_affinity(), the policy is applied when the task enters
+ * its thread and is restored when the task leaves it.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_task_set_scheduling (GstTask * task, GstTaskSchedulingPolicy policy,
+    gint priority)
+{
+  GstTaskPrivate *priv;
+
+  g_return_if_fail (GST_IS_TASK (task));
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  priv->policy = policy;
+  priv->priority = priority;
+  GST_OBJECT_UNLOCK (task);
+}
+
 /**
  * gst_task_get_state:
  * @task: The #GstTask to query
@@ -623,6 +913,7 @@ start_task (GstTask * task)
   /* push on the thread pool, we remember the original pool because the user
    * could change it later on and then we join to the wrong pool. */
   priv->pool_id = gst_object_ref (priv->pool);
+  priv->cooperative = GST_IS_SHARED_TASK_POOL (priv->pool_id);
   priv->id =
       gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
       task, &error);
@@ -680,10 +971,12 @@ gst_task_set_state (GstTask * task, GstTaskState state)
       case GST_TASK_PAUSED:
         /* when we are paused, signal to go to the new state */
         GST_TASK_SIGNAL (task);
+        gst_task_unpark (task);
         break;
       case GST_TASK_STARTED:
         /* if we were started, we'll go to the new state after the next
-         * iteration. */
+         * iteration. A task that yielded has to run to notice. */
+        gst_task_unpark (task);
         break;
     }
   }
@@ -755,6 +1048,77 @@ gst_task_pause (GstTask * task)
   return gst_task_set_state (task, GST_TASK_PAUSED);
 }
 
+/**
+ * gst_task_yield:
+ * @task: The #GstTask to yield
+ *
+ * Called from the function of @task when it has nothing to do until some
+ * other thread makes progress. When @task runs on a #GstSharedTaskPool, it
+ * gives its worker back after the function returns and the function is not
+ * called again until gst_task_resume() is called. The caller should then
+ * return from the function instead of blocking.
+ *
+ * When @task does not run on a shared pool, or when this function is not
+ * called from the function of @task, %FALSE is returned and the caller has
+ * to wait as usual.
+ *
+ * Returns: %TRUE if @task yields and the caller should return.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_task_yield (GstTask * task)
+{
+  GstTaskPrivate *priv;
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  res = priv->cooperative && task->thread == g_thread_self ();
+  if (res) {
+    priv->yielding = TRUE;
+    priv->resumed = FALSE;
+  }
+  GST_OBJECT_UNLOCK (task);
+
+  return res;
+}
+
+/**
+ * gst_task_resume:
+ * @task: The #GstTask to resume
+ *
+ * Schedules the function of @task again after it yielded with
+ * gst_task_yield(). This can be called before the function returned, in
+ * which case @task does not give its worker back. Nothing happens when
+ * @task did not yield.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_task_resume (GstTask * task)
+{
+  GstTaskPrivate *priv;
+
+  g_return_if_fail (GST_IS_TASK (task));
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  if (priv->yielding)
+    priv->resumed = TRUE;
+  else if (GST_TASK_STATE (task) == GST_TASK_STARTED)
+    gst_task_unpark (task);
+  GST_OBJECT_UNLOCK (task);
+}
+
 /**
  * gst_task_join:
  * @task: The #GstTask to join
@@ -796,6 +1160,8 @@ gst_task_join (GstTask * task)
   SET_TASK_STATE (task, GST_TASK_STOPPED);
   /* signal the state change for when it was blocked in PAUSED. */
   GST_TASK_SIGNAL (task);
+  /* a parked task needs to run to notice */
+  gst_task_unpark (task);
   /* we set the running flag when pushing the task on the thread pool.
    * This means that the task function might not be called when we try
    * to join it here. */
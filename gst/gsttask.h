@@ -64,6 +64,23 @@ typedef enum {
   GST_TASK_PAUSED
 } GstTaskState;
 
+/**
+ * GstTaskSchedulingPolicy:
+ * @GST_TASK_SCHEDULING_DEFAULT: the default policy of the thread
+ * @GST_TASK_SCHEDULING_FIFO: real-time first in, first out policy
+ * @GST_TASK_SCHEDULING_RR: real-time round robin policy
+ *
+ * The scheduling policy of the thread of a task, see
+ * gst_task_set_scheduling().
+ *
+ * Since: 1.2
+ */
+typedef enum {
+  GST_TASK_SCHEDULING_DEFAULT,
+  GST_TASK_SCHEDULING_FIFO,
+  GST_TASK_SCHEDULING_RR
+} GstTaskSchedulingPolicy;
+
 /**
  * GST_TASK_STATE:
  * @task: Task to get the state of
@@ -185,6 +202,12 @@ void            gst_task_set_leave_callback  (GstTask *task,
                                               gpointer user_data,
                                               GDestroyNotify notify);
 
+void            gst_task_set_affinity   (GstTask *task, const guint *cpus,
+                                         guint n_cpus);
+void            gst_task_set_scheduling (GstTask *task,
+                                         GstTaskSchedulingPolicy policy,
+                                         gint priority);
+
 GstTaskState    gst_task_get_state      (GstTask *task);
 gboolean        gst_task_set_state      (GstTask *task, GstTaskState state);
 
@@ -192,6 +215,9 @@ gboolean        gst_task_start          (GstTask *task);
 gboolean        gst_task_stop           (GstTask *task);
 gboolean        gst_task_pause          (GstTask *task);
 
+gboolean        gst_task_yield          (GstTask *task);
+void            gst_task_resume         (GstTask *task);
+
 gboolean        gst_task_join           (GstTask *task);
 
 G_END_DECLS
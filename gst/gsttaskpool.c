@@ -29,11 +29,19 @@
  *
  * Subclasses can be made to create custom threads.
  *
+ * #GstSharedTaskPool runs the pushed functions on a fixed number of worker
+ * threads that each keep their own queue and steal work from each other
+ * when they run out. It is meant to be shared between many tasks and
+ * elements to limit the number of threads of a process. A #GstTask that is
+ * started on a #GstSharedTaskPool returns its worker to the pool after
+ * every call of its function and while it is paused.
+ *
  * Last reviewed on 2009-04-23 (0.10.24)
  */
 
 #include "gst_private.h"
 
+#include "gsterror.h"
 #include "gstinfo.h"
 #include "gsttaskpool.h"
 
@@ -270,3 +278,325 @@ gst_task_pool_join (GstTaskPool * pool, gpointer id)
   if (klass->join)
     klass->join (pool, id);
 }
+
+/* shared pool */
+#define GST_SHARED_TASK_POOL_GET_PRIVATE(obj)  \
+   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GST_TYPE_SHARED_TASK_POOL, GstSharedTaskPoolPrivate))
+
+typedef struct
+{
+  GstSharedTaskPool *pool;
+  GThread *thread;
+
+  /* own jobs are taken from the head, other workers steal from the tail */
+  GMutex lock;
+  GQueue queue;
+} GstSharedTaskWorker;
+
+struct _GstSharedTaskPoolPrivate
+{
+  guint n_threads;
+  GstSharedTaskWorker *workers;
+  guint n_workers;
+  /* workers are being joined, with the object lock */
+  gboolean stopping;
+
+  /* for idle workers, with lock */
+  GMutex lock;
+  GCond cond;
+  gboolean quit;
+
+  volatile gint n_queued;
+  volatile gint next;
+};
+
+/* the worker of the current thread */
+static GPrivate current_worker;
+
+G_DEFINE_TYPE (GstSharedTaskPool, gst_shared_task_pool, GST_TYPE_TASK_POOL);
+
+static TaskData *
+shared_pop (GstSharedTaskWorker * worker, gboolean steal)
+{
+  TaskData *tdata;
+
+  g_mutex_lock (&worker->lock);
+  if (steal)
+    tdata = g_queue_pop_tail (&worker->queue);
+  else
+    tdata = g_queue_pop_head (&worker->queue);
+  g_mutex_unlock (&worker->lock);
+
+  return tdata;
+}
+
+static gpointer
+shared_worker_func (GstSharedTaskWorker * worker)
+{
+  GstSharedTaskPoolPrivate *priv = worker->pool->priv;
+  /* stays valid until shared_cleanup() joined all workers */
+  GstSharedTaskWorker *workers = priv->workers;
+  guint idx = worker - workers;
+
+  g_private_set (&current_worker, worker);
+
+  while (TRUE) {
+    TaskData *tdata;
+    guint i;
+
+    tdata = shared_pop (worker, FALSE);
+    for (i = 1; tdata == NULL && i < priv->n_workers; i++)
+      tdata = shared_pop (&workers[(idx + i) % priv->n_workers], TRUE);
+
+    if (tdata) {
+      g_atomic_int_add (&priv->n_queued, -1);
+      default_func (tdata, GST_TASK_POOL_CAST (worker->pool));
+      continue;
+    }
+
+    g_mutex_lock (&priv->lock);
+    while (!priv->quit && g_atomic_int_get (&priv->n_queued) == 0)
+      g_cond_wait (&priv->cond, &priv->lock);
+    if (priv->quit && g_atomic_int_get (&priv->n_queued) == 0) {
+      g_mutex_unlock (&priv->lock);
+      break;
+    }
+    g_mutex_unlock (&priv->lock);
+  }
+
+  g_private_set (&current_worker, NULL);
+
+  return NULL;
+}
+
+static void
+shared_prepare (GstTaskPool * pool, GError ** error)
+{
+  GstSharedTaskPoolPrivate *priv = GST_SHARED_TASK_POOL (pool)->priv;
+  guint i;
+
+  GST_OBJECT_LOCK (pool);
+  if (priv->workers)
+    goto done;
+
+  priv->quit = FALSE;
+  priv->workers = g_new0 (GstSharedTaskWorker, priv->n_threads);
+  for (i = 0; i < priv->n_threads; i++) {
+    GstSharedTaskWorker *worker = &priv->workers[i];
+
+    worker->pool = GST_SHARED_TASK_POOL (pool);
+    g_mutex_init (&worker->lock);
+    g_queue_init (&worker->queue);
+  }
+  /* workers only look at the workers that were created */
+  priv->n_workers = priv->n_threads;
+  for (i = 0; i < priv->n_threads; i++) {
+    GstSharedTaskWorker *worker = &priv->workers[i];
+
+    worker->thread = g_thread_try_new ("sharedtaskpool",
+        (GThreadFunc) shared_worker_func, worker, error);
+    if (worker->thread == NULL)
+      break;
+  }
+  if (i < priv->n_threads) {
+    GST_WARNING_OBJECT (pool, "could only start %u of %u threads", i,
+        priv->n_threads);
+    /* the threads that are running do not look at the others yet */
+    priv->n_workers = i;
+  }
+  GST_DEBUG_OBJECT (pool, "started %u workers", priv->n_workers);
+
+done:
+  GST_OBJECT_UNLOCK (pool);
+}
+
+static void
+shared_cleanup (GstTaskPool * pool)
+{
+  GstSharedTaskPoolPrivate *priv = GST_SHARED_TASK_POOL (pool)->priv;
+  GstSharedTaskWorker *workers;
+  guint i, n_threads;
+
+  GST_OBJECT_LOCK (pool);
+  workers = priv->workers;
+  n_threads = priv->n_threads;
+  if (workers == NULL || priv->stopping) {
+    GST_OBJECT_UNLOCK (pool);
+    return;
+  }
+  /* refuse new functions, the workers keep using the array until joined */
+  priv->stopping = TRUE;
+  GST_OBJECT_UNLOCK (pool);
+
+  /* the workers run all scheduled functions before they exit */
+  g_mutex_lock (&priv->lock);
+  priv->quit = TRUE;
+  g_cond_broadcast (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+
+  for (i = 0; i < n_threads; i++) {
+    if (workers[i].thread)
+      g_thread_join (workers[i].thread);
+  }
+
+  GST_OBJECT_LOCK (pool);
+  priv->workers = NULL;
+  priv->n_workers = 0;
+  priv->stopping = FALSE;
+  GST_OBJECT_UNLOCK (pool);
+
+  for (i = 0; i < n_threads; i++)
+    g_mutex_clear (&workers[i].lock);
+  g_free (workers);
+}
+
+static gpointer
+shared_push (GstTaskPool * pool, GstTaskPoolFunction func,
+    gpointer user_data, GError ** error)
+{
+  GstSharedTaskPoolPrivate *priv = GST_SHARED_TASK_POOL (pool)->priv;
+  GstSharedTaskWorker *worker;
+  TaskData *tdata;
+
+  tdata = g_slice_new (TaskData);
+  tdata->func = func;
+  tdata->user_data = user_data;
+
+  GST_OBJECT_LOCK (pool);
+  if (priv->workers == NULL || priv->n_workers == 0 || priv->stopping)
+    goto not_prepared;
+
+  /* counted before the object lock is released, so that a cleanup that
+   * follows waits for this function */
+  g_atomic_int_inc (&priv->n_queued);
+
+  worker = g_private_get (&current_worker);
+  if (worker != NULL && worker->pool == GST_SHARED_TASK_POOL (pool)) {
+    /* pushed from one of our workers, keep it on the same core */
+    g_mutex_lock (&worker->lock);
+    g_queue_push_head (&worker->queue, tdata);
+    g_mutex_unlock (&worker->lock);
+  } else {
+    worker = &priv->workers[(guint) g_atomic_int_add (&priv->next, 1) %
+        priv->n_workers];
+    g_mutex_lock (&worker->lock);
+    g_queue_push_tail (&worker->queue, tdata);
+    g_mutex_unlock (&worker->lock);
+  }
+  GST_OBJECT_UNLOCK (pool);
+
+  g_mutex_lock (&priv->lock);
+  g_cond_signal (&priv->cond);
+  g_mutex_unlock (&priv->lock);
+
+  return NULL;
+
+  /* ERRORS */
+not_prepared:
+  {
+    GST_OBJECT_UNLOCK (pool);
+    g_slice_free (TaskData, tdata);
+    g_set_error (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "task pool %p is not prepared", pool);
+    return NULL;
+  }
+}
+
+static void
+gst_shared_task_pool_finalize (GObject * object)
+{
+  GstSharedTaskPoolPrivate *priv = GST_SHARED_TASK_POOL (object)->priv;
+
+  shared_cleanup (GST_TASK_POOL_CAST (object));
+
+  g_mutex_clear (&priv->lock);
+  g_cond_clear (&priv->cond);
+
+  G_OBJECT_CLASS (gst_shared_task_pool_parent_class)->finalize (object);
+}
+
+static void
+gst_shared_task_pool_class_init (GstSharedTaskPoolClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstTaskPoolClass *gsttaskpool_class;
+
+  gobject_class = (GObjectClass *) klass;
+  gsttaskpool_class = (GstTaskPoolClass *) klass;
+
+  g_type_class_add_private (klass, sizeof (GstSharedTaskPoolPrivate));
+
+  gobject_class->finalize = gst_shared_task_pool_finalize;
+
+  gsttaskpool_class->prepare = shared_prepare;
+  gsttaskpool_class->cleanup = shared_cleanup;
+  gsttaskpool_class->push = shared_push;
+  gsttaskpool_class->join = default_join;
+}
+
+static void
+gst_shared_task_pool_init (GstSharedTaskPool * pool)
+{
+  pool->priv = GST_SHARED_TASK_POOL_GET_PRIVATE (pool);
+
+  g_mutex_init (&pool->priv->lock);
+  g_cond_init (&pool->priv->cond);
+}
+
+/**
+ * gst_shared_task_pool_new:
+ * @n_threads: the number of worker threads, or 0 for one per processor
+ *
+ * Create a new task pool that runs all functions pushed on it with
+ * @n_threads worker threads. Every worker has its own queue, functions
+ * pushed from a worker go to the queue of that worker and idle workers
+ * steal functions from the others.
+ *
+ * The functions share the workers, they should return after a short time
+ * and not block. A #GstTask on this pool returns its worker after every call
+ * of the task function, so only tasks with a task function that does not
+ * block should use it. Use gst_task_set_pool(), for example when handling
+ * the #GST_STREAM_STATUS_TYPE_CREATE stream status message, to let a task
+ * use the pool.
+ *
+ * Returns: (transfer full): a new #GstSharedTaskPool. gst_object_unref()
+ * after usage.
+ *
+ * Since: 1.2
+ */
+GstTaskPool *
+gst_shared_task_pool_new (guint n_threads)
+{
+  GstSharedTaskPool *pool;
+
+  if (n_threads == 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+    n_threads = g_get_num_processors ();
+#else
+    n_threads = 1;
+#endif
+  }
+
+  pool = g_object_newv (GST_TYPE_SHARED_TASK_POOL, 0, NULL);
+  pool->priv->n_threads = n_threads;
+
+  return GST_TASK_POOL_CAST (pool);
+}
+
+/**
+ * gst_shared_task_pool_get_n_threads:
+ * @pool: a #GstSharedTaskPool
+ *
+ * Get the number of worker threads of @pool.
+ *
+ * Returns: the number of worker threads.
+ *
+ * Since: 1.2
+ */
+guint
+gst_shared_task_pool_get_n_threads (GstSharedTaskPool * pool)
+{
+  g_return_val_if_fail (GST_IS_SHARED_TASK_POOL (pool), 0);
+
+  return pool->priv->n_threads;
+}
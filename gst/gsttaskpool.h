@@ -96,6 +96,54 @@ void            gst_task_pool_join        (GstTaskPool *pool, gpointer id);
 
 void		gst_task_pool_cleanup     (GstTaskPool *pool);
 
+/* shared pool */
+#define GST_TYPE_SHARED_TASK_POOL             (gst_shared_task_pool_get_type ())
+#define GST_SHARED_TASK_POOL(pool)            (G_TYPE_CHECK_INSTANCE_CAST ((pool), GST_TYPE_SHARED_TASK_POOL, GstSharedTaskPool))
+#define GST_IS_SHARED_TASK_POOL(pool)         (G_TYPE_CHECK_INSTANCE_TYPE ((pool), GST_TYPE_SHARED_TASK_POOL))
+#define GST_SHARED_TASK_POOL_CLASS(pclass)    (G_TYPE_CHECK_CLASS_CAST ((pclass), GST_TYPE_SHARED_TASK_POOL, GstSharedTaskPoolClass))
+#define GST_IS_SHARED_TASK_POOL_CLASS(pclass) (G_TYPE_CHECK_CLASS_TYPE ((pclass), GST_TYPE_SHARED_TASK_POOL))
+#define GST_SHARED_TASK_POOL_GET_CLASS(pool)  (G_TYPE_INSTANCE_GET_CLASS ((pool), GST_TYPE_SHARED_TASK_POOL, GstSharedTaskPoolClass))
+
+typedef struct _GstSharedTaskPool GstSharedTaskPool;
+typedef struct _GstSharedTaskPoolClass GstSharedTaskPoolClass;
+typedef struct _GstSharedTaskPoolPrivate GstSharedTaskPoolPrivate;
+
+/**
+ * GstSharedTaskPool:
+ *
+ * The #GstSharedTaskPool object.
+ *
+ * Since: 1.2
+ */
+struct _GstSharedTaskPool {
+  GstTaskPool    parent;
+
+  /*< private >*/
+  GstSharedTaskPoolPrivate *priv;
+
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstSharedTaskPoolClass:
+ * @parent_class: the parent class structure
+ *
+ * The #GstSharedTaskPoolClass object.
+ *
+ * Since: 1.2
+ */
+struct _GstSharedTaskPoolClass {
+  GstTaskPoolClass parent_class;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType           gst_shared_task_pool_get_type      (void);
+
+GstTaskPool *   gst_shared_task_pool_new           (guint n_threads);
+guint           gst_shared_task_pool_get_n_threads (GstSharedTaskPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_TASK_POOL_H__ */
@@ -96,6 +96,10 @@ struct _GstToc
   GstTocScope scope;
   GList *entries;
   GstTagList *tags;
+
+  /* uid -> entry for all entries in the tree, the keys are owned by the
+   * entries */
+  GHashTable *index;
 };
 
 #undef gst_toc_copy
@@ -133,10 +137,27 @@ gst_toc_new (GstTocScope scope)
 
   toc->scope = scope;
   toc->tags = gst_tag_list_new_empty ();
+  toc->index = g_hash_table_new (g_str_hash, g_str_equal);
 
   return toc;
 }
 
+/* makes @entry and all its subentries part of @toc. Keeps the first entry in
+ * the index when an uid is not unique so that the result of
+ * gst_toc_find_entry() does not depend on the order of the appends. */
+static void
+gst_toc_entry_attach (GstTocEntry * entry, GstToc * toc)
+{
+  GList *cur;
+
+  entry->toc = toc;
+  if (toc != NULL && !g_hash_table_contains (toc->index, entry->uid))
+    g_hash_table_insert (toc->index, entry->uid, entry);
+
+  for (cur = entry->subentries; cur != NULL; cur = cur->next)
+    gst_toc_entry_attach (cur->data, toc);
+}
+
 /**
  * gst_toc_get_scope:
  * @toc: a #GstToc instance
@@ -225,7 +246,7 @@ gst_toc_append_entry (GstToc * toc, GstTocEntry * entry)
   g_return_if_fail (entry->parent == NULL);
 
   toc->entries = g_list_append (toc->entries, entry);
-  entry->toc = toc;
+  gst_toc_entry_attach (entry, toc);
 
   GST_LOG ("appended %s entry with uid %s to toc %p",
       gst_toc_entry_type_get_nick (entry->type), entry->uid, toc);
@@ -294,6 +315,8 @@ gst_toc_free (GstToc * toc)
   if (toc->tags != NULL)
     gst_tag_list_unref (toc->tags);
 
+  g_hash_table_destroy (toc->index);
+
   g_slice_free (GstToc, toc);
 }
 
@@ -313,32 +336,6 @@ gst_toc_entry_free (GstTocEntry * entry)
   g_slice_free (GstTocEntry, entry);
 }
 
-static GstTocEntry *
-gst_toc_entry_find_sub_entry (const GstTocEntry * entry, const gchar * uid)
-{
-  GList *cur;
-  GstTocEntry *subentry, *subsubentry;
-
-  g_return_val_if_fail (entry != NULL, NULL);
-  g_return_val_if_fail (uid != NULL, NULL);
-
-  cur = entry->subentries;
-  while (cur != NULL) {
-    subentry = cur->data;
-
-    if (g_strcmp0 (subentry->uid, uid) == 0)
-      return subentry;
-
-    subsubentry = gst_toc_entry_find_sub_entry (subentry, uid);
-    if (subsubentry != NULL)
-      return subsubentry;
-
-    cur = cur->next;
-  }
-
-  return NULL;
-}
-
 /**
  * gst_toc_find_entry:
  * @toc: #GstToc to search in.
@@ -351,33 +348,18 @@ gst_toc_entry_find_sub_entry (const GstTocEntry * entry, const gchar * uid)
 GstTocEntry *
 gst_toc_find_entry (const GstToc * toc, const gchar * uid)
 {
-  GList *cur;
-  GstTocEntry *entry, *subentry;
-
   g_return_val_if_fail (toc != NULL, NULL);
   g_return_val_if_fail (uid != NULL, NULL);
 
-  cur = toc->entries;
-  while (cur != NULL) {
-    entry = cur->data;
-
-    if (g_strcmp0 (entry->uid, uid) == 0)
-      return entry;
-
-    subentry = gst_toc_entry_find_sub_entry (entry, uid);
-    if (subentry != NULL)
-      return subentry;
-    cur = cur->next;
-  }
-
-  return NULL;
+  return g_hash_table_lookup (toc->index, uid);
 }
 
 /**
  * gst_toc_entry_copy:
  * @entry: #GstTocEntry to copy.
  *
- * Copy #GstTocEntry with all subentries (deep copy).
+ * Copy #GstTocEntry with all subentries (deep copy). The tags are shared
+ * with @entry, they are copied when they are modified.
  *
  * Returns: newly allocated #GstTocEntry in case of success, NULL otherwise;
  * free it when done with gst_toc_entry_unref().
@@ -397,7 +379,7 @@ gst_toc_entry_copy (const GstTocEntry * entry)
   ret->stop = entry->stop;
 
   if (GST_IS_TAG_LIST (entry->tags)) {
-    list = gst_tag_list_copy (entry->tags);
+    list = gst_tag_list_ref (entry->tags);
     if (ret->tags)
       gst_tag_list_unref (ret->tags);
     ret->tags = list;
@@ -407,8 +389,10 @@ gst_toc_entry_copy (const GstTocEntry * entry)
   while (cur != NULL) {
     sub = gst_toc_entry_copy (cur->data);
 
-    if (sub != NULL)
+    if (sub != NULL) {
+      sub->parent = ret;
       ret->subentries = g_list_prepend (ret->subentries, sub);
+    }
 
     cur = cur->next;
   }
@@ -421,7 +405,8 @@ gst_toc_entry_copy (const GstTocEntry * entry)
  * gst_toc_copy:
  * @toc: #GstToc to copy.
  *
- * Copy #GstToc with all subentries (deep copy).
+ * Copy #GstToc with all subentries (deep copy). The tags of the TOC and the
+ * entries are shared with @toc, they are copied when they are modified.
  *
  * Returns: newly allocated #GstToc in case of success, NULL otherwise;
  * free it when done with gst_toc_unref().
@@ -439,7 +424,7 @@ gst_toc_copy (const GstToc * toc)
   ret = gst_toc_new (toc->scope);
 
   if (GST_IS_TAG_LIST (toc->tags)) {
-    list = gst_tag_list_copy (toc->tags);
+    list = gst_tag_list_ref (toc->tags);
     gst_tag_list_unref (ret->tags);
     ret->tags = list;
   }
@@ -448,8 +433,10 @@ gst_toc_copy (const GstToc * toc)
   while (cur != NULL) {
     entry = gst_toc_entry_copy (cur->data);
 
-    if (entry != NULL)
+    if (entry != NULL) {
+      gst_toc_entry_attach (entry, ret);
       ret->entries = g_list_prepend (ret->entries, entry);
+    }
 
     cur = cur->next;
   }
@@ -611,8 +598,8 @@ gst_toc_entry_append_sub_entry (GstTocEntry * entry, GstTocEntry * subentry)
   g_return_if_fail (subentry->parent == NULL);
 
   entry->subentries = g_list_append (entry->subentries, subentry);
-  subentry->toc = entry->toc;
   subentry->parent = entry;
+  gst_toc_entry_attach (subentry, entry->toc);
 
   GST_LOG ("appended %s subentry with uid %s to entry %s",
       gst_toc_entry_type_get_nick (subentry->type), subentry->uid, entry->uid);
@@ -752,6 +739,10 @@ void
 gst_toc_dump (GstToc * toc)
 {
 #ifndef GST_DISABLE_GST_DEBUG
+  /* don't walk the whole tree for nothing on every append */
+  if (G_LIKELY (_gst_debug_min < GST_LEVEL_TRACE))
+    return;
+
   GST_TRACE ("        Toc %p, scope: %s, tags: %" GST_PTR_FORMAT, toc,
       (toc->scope == GST_TOC_SCOPE_GLOBAL) ? "global" : "current", toc->tags);
   gst_toc_dump_entries (toc->entries, 2);
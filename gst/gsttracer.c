@@ -0,0 +1,486 @@
+/* GStreamer
+ *
+ * gsttracer.c: tracing hooks for measuring the dataflow
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gsttracer
+ * @short_description: Measure the dataflow in pipelines
+ *
+ * Tracers are objects that get notified by the core when data, events and
+ * queries pass through pads. They are used to measure the behaviour of a
+ * running pipeline, like the time spent in each element or the rate at which
+ * buffers flow through a pad.
+ *
+ * Tracers are enabled by setting the GST_TRACERS environment variable to a
+ * list of tracer names separated by ';' or ',' before gst_init() is called,
+ * for example GST_TRACERS="proctime;rate". The core provides the following
+ * tracers:
+ * <itemizedlist>
+ *   <listitem><para>"proctime": the time each element spends in its chain
+ *   and getrange functions, not including the time spent downstream in the
+ *   same thread</para></listitem>
+ *   <listitem><para>"latency": the time it takes for a push or a pull on a
+ *   pad to return</para></listitem>
+ *   <listitem><para>"rate": the number of buffers and bytes pushed on each
+ *   pad per second</para></listitem>
+ *   <listitem><para>"queuelevel": the fill level of queue elements
+ *   </para></listitem>
+ *   <listitem><para>"timeline": the chain and getrange calls, events, queries
+ *   and clock waits of every thread, written as a Chrome trace event file to
+ *   the file named by GST_TIMELINE_FILE or "gst-timeline.json". The file is
+ *   written when EOS reaches a sink, when a custom event with a structure
+ *   named "GstTimelineDump" is pushed and when GStreamer is deinitialized.
+ *   </para></listitem>
+ *   <listitem><para>"leaks": the mini objects that are still alive, grouped
+ *   by the call stack that allocated them. Only one in GST_LEAKS_SAMPLE
+ *   objects is tracked and GST_LEAKS_TYPES can limit the tracking to a list
+ *   of type names. The objects are logged when a custom event with a
+ *   structure named "GstLeaksDump" is pushed and when GStreamer is
+ *   deinitialized.</para></listitem>
+ *   <listitem><para>"watchdog": posts a warning message on the bus when a
+ *   chain, push or getrange call or an iteration of a #GstTask takes longer
+ *   than GST_WATCHDOG_THRESHOLD milliseconds, 1000 by default. The warning
+ *   is posted by a separate thread while the call is still blocked. When
+ *   GST_WATCHDOG_STACK is set, the stacks of all threads are printed with
+ *   gdb as well.</para></listitem>
+ * </itemizedlist>
+ *
+ * The tracers output their values periodically and when GStreamer is
+ * deinitialized in the GST_TRACER debug category at the INFO level. The
+ * threshold of that category is raised to INFO when a tracer is enabled.
+ *
+ * Applications and plugins can implement new tracers by subclassing
+ * #GstTracer and registering the new type with gst_tracer_register(). The
+ * tracer is then enabled when its name is part of GST_TRACERS.
+ *
+ * When no tracer is enabled, the hooks only check a global flag. They can be
+ * compiled out completely with the --disable-gst-tracer-hooks configure
+ * option.
+ */
+
+#include "gst_private.h"
+
+#include "gstutils.h"
+#include "gsttracer.h"
+#include "gsttracerutils.h"
+
+/* how often the tracers are asked to output their values */
+#define TRACER_REPORT_INTERVAL (GST_SECOND)
+
+G_DEFINE_ABSTRACT_TYPE (GstTracer, gst_tracer, GST_TYPE_OBJECT);
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+gboolean _priv_tracer_enabled = FALSE;
+#endif
+
+/* protects the registered types and the list of tracers */
+static GMutex tracer_lock;
+static GHashTable *tracer_types = NULL;
+/* the names in GST_TRACERS */
+static gchar **tracer_names = NULL;
+/* the active tracers, new tracers are only ever prepended so that the hooks
+ * can walk the list without taking the lock */
+static GList *tracers = NULL;
+
+static GMutex report_lock;
+static GstClockTime next_report = 0;
+
+static void
+gst_tracer_class_init (GstTracerClass * klass)
+{
+}
+
+static void
+gst_tracer_init (GstTracer * tracer)
+{
+}
+
+static gboolean
+tracer_is_wanted (const gchar * name)
+{
+  gchar **walk;
+
+  if (tracer_names == NULL)
+    return FALSE;
+
+  for (walk = tracer_names; *walk; walk++) {
+    if (strcmp (*walk, name) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+tracer_activate (const gchar * name, GType type)
+{
+  GstTracer *tracer;
+
+  tracer = g_object_new (type, "name", name, NULL);
+  gst_object_ref_sink (tracer);
+
+  GST_CAT_INFO (GST_CAT_TRACER, "enabling tracer %s", name);
+
+  g_mutex_lock (&report_lock);
+  if (next_report == 0)
+    next_report = gst_util_get_timestamp () + TRACER_REPORT_INTERVAL;
+  g_mutex_unlock (&report_lock);
+
+  g_mutex_lock (&tracer_lock);
+  g_atomic_pointer_set (&tracers, g_list_prepend (tracers, tracer));
+  g_mutex_unlock (&tracer_lock);
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  g_atomic_int_set (&_priv_tracer_enabled, TRUE);
+#endif
+}
+
+/**
+ * gst_tracer_register:
+ * @name: the name of the tracer
+ * @type: the #GType of the tracer, a subclass of #GstTracer
+ *
+ * Registers a new tracer with @name. When @name is part of the GST_TRACERS
+ * environment variable, an instance of @type is created and starts receiving
+ * the tracing hooks.
+ *
+ * Returns: %TRUE when the tracer was registered, %FALSE when a tracer with
+ * @name already exists.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_tracer_register (const gchar * name, GType type)
+{
+  gboolean wanted;
+
+  g_return_val_if_fail (name != NULL, FALSE);
+  g_return_val_if_fail (g_type_is_a (type, GST_TYPE_TRACER), FALSE);
+
+  g_mutex_lock (&tracer_lock);
+  if (tracer_types == NULL)
+    tracer_types = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        NULL);
+
+  if (g_hash_table_lookup (tracer_types, name))
+    goto exists;
+
+  g_hash_table_insert (tracer_types, g_strdup (name), (gpointer) type);
+  wanted = tracer_is_wanted (name);
+  g_mutex_unlock (&tracer_lock);
+
+  GST_CAT_DEBUG (GST_CAT_TRACER, "registered tracer %s", name);
+
+  if (wanted)
+    tracer_activate (name, type);
+
+  return TRUE;
+
+  /* ERRORS */
+exists:
+  {
+    g_mutex_unlock (&tracer_lock);
+    GST_CAT_WARNING (GST_CAT_TRACER, "tracer %s was already registered",
+        name);
+    return FALSE;
+  }
+}
+
+static void
+tracers_report (void)
+{
+  GList *walk;
+
+  for (walk = g_atomic_pointer_get (&tracers); walk; walk = g_list_next (walk)) {
+    GstTracer *tracer = walk->data;
+    GstTracerClass *klass = GST_TRACER_GET_CLASS (tracer);
+
+    if (klass->report)
+      klass->report (tracer);
+  }
+}
+
+void
+_priv_gst_tracer_init (void)
+{
+  const gchar *env;
+
+  env = g_getenv ("GST_TRACERS");
+  if (env != NULL && *env != '\0') {
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+    gchar **walk;
+
+    tracer_names = g_strsplit_set (env, ",;", -1);
+    for (walk = tracer_names; *walk; walk++)
+      g_strstrip (*walk);
+
+#ifndef GST_DISABLE_GST_DEBUG
+    /* make sure the reports are visible */
+    if (gst_debug_category_get_threshold (GST_CAT_TRACER) < GST_LEVEL_INFO)
+      gst_debug_category_set_threshold (GST_CAT_TRACER, GST_LEVEL_INFO);
+#endif
+#else
+    g_warning ("GStreamer was compiled without tracer hooks, "
+        "ignoring GST_TRACERS");
+#endif
+  }
+
+  _priv_gst_tracers_register_core ();
+}
+
+void
+_priv_gst_tracer_deinit (void)
+{
+  GList *list;
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  g_atomic_int_set (&_priv_tracer_enabled, FALSE);
+#endif
+
+  g_mutex_lock (&report_lock);
+  tracers_report ();
+  g_mutex_unlock (&report_lock);
+
+  g_mutex_lock (&tracer_lock);
+  list = tracers;
+  tracers = NULL;
+  if (tracer_types) {
+    g_hash_table_unref (tracer_types);
+    tracer_types = NULL;
+  }
+  g_strfreev (tracer_names);
+  tracer_names = NULL;
+  g_mutex_unlock (&tracer_lock);
+
+  g_list_free_full (list, (GDestroyNotify) gst_object_unref);
+}
+
+void
+_priv_gst_tracer_describe (GstObject * object, GString * str)
+{
+  GList *walk;
+
+  for (walk = g_atomic_pointer_get (&tracers); walk; walk = g_list_next (walk)) {
+    GstTracer *tracer = walk->data;
+    GstTracerClass *klass = GST_TRACER_GET_CLASS (tracer);
+
+    if (klass->describe)
+      klass->describe (tracer, object, str);
+  }
+}
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+
+/* called from all the post hooks, one of the streaming threads takes care of
+ * the periodic reports */
+static inline void
+tracer_maybe_report (GstClockTime ts)
+{
+  if (G_LIKELY (ts < next_report))
+    return;
+
+  if (!g_mutex_trylock (&report_lock))
+    return;
+
+  if (ts >= next_report) {
+    next_report = ts + TRACER_REPORT_INTERVAL;
+    tracers_report ();
+  }
+  g_mutex_unlock (&report_lock);
+}
+
+#define TRACER_DISPATCH(hook,args) G_STMT_START {                       \
+  GList *walk;                                                          \
+                                                                        \
+  for (walk = g_atomic_pointer_get (&tracers); walk; walk = walk->next) { \
+    GstTracer *tracer = walk->data;                                     \
+    GstTracerClass *klass = GST_TRACER_GET_CLASS (tracer);              \
+                                                                        \
+    if (klass->hook)                                                    \
+      klass->hook args;                                                 \
+  }                                                                     \
+} G_STMT_END
+
+void
+_priv_gst_tracer_pad_push_pre (GstPad * pad, GstBuffer * buffer)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_push_pre, (tracer, ts, pad, buffer));
+}
+
+void
+_priv_gst_tracer_pad_push_list_pre (GstPad * pad, GstBufferList * list)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_push_list_pre, (tracer, ts, pad, list));
+}
+
+void
+_priv_gst_tracer_pad_push_post (GstPad * pad, GstFlowReturn res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_push_post, (tracer, ts, pad, res));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_pad_chain_pre (GstPad * pad, GstBuffer * buffer)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_chain_pre, (tracer, ts, pad, buffer));
+}
+
+void
+_priv_gst_tracer_pad_chain_list_pre (GstPad * pad, GstBufferList * list)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_chain_list_pre, (tracer, ts, pad, list));
+}
+
+void
+_priv_gst_tracer_pad_chain_post (GstPad * pad, GstFlowReturn res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_chain_post, (tracer, ts, pad, res));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_pad_pull_range_pre (GstPad * pad, guint64 offset, guint size)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_pull_range_pre, (tracer, ts, pad, offset, size));
+}
+
+void
+_priv_gst_tracer_pad_pull_range_post (GstPad * pad, GstBuffer * buffer,
+    GstFlowReturn res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_pull_range_post, (tracer, ts, pad, buffer, res));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_pad_push_event_pre (GstPad * pad, GstEvent * event)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_push_event_pre, (tracer, ts, pad, event));
+}
+
+void
+_priv_gst_tracer_pad_push_event_post (GstPad * pad, gboolean res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_push_event_post, (tracer, ts, pad, res));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_pad_query_pre (GstPad * pad, GstQuery * query)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_query_pre, (tracer, ts, pad, query));
+}
+
+void
+_priv_gst_tracer_pad_query_post (GstPad * pad, GstQuery * query, gboolean res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (pad_query_post, (tracer, ts, pad, query, res));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_task_start (GstTask * task)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (task_start, (tracer, ts, task));
+}
+
+void
+_priv_gst_tracer_task_stop (GstTask * task)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (task_stop, (tracer, ts, task));
+}
+
+void
+_priv_gst_tracer_task_iteration_pre (GstTask * task)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (task_iteration_pre, (tracer, ts, task));
+}
+
+void
+_priv_gst_tracer_task_iteration_post (GstTask * task)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (task_iteration_post, (tracer, ts, task));
+  tracer_maybe_report (ts);
+}
+
+void
+_priv_gst_tracer_clock_wait_pre (GstClock * clock, GstClockID id)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (clock_wait_pre, (tracer, ts, clock, id));
+}
+
+void
+_priv_gst_tracer_clock_wait_post (GstClock * clock, GstClockReturn res)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (clock_wait_post, (tracer, ts, clock, res));
+}
+
+void
+_priv_gst_tracer_mini_object_created (GstMiniObject * object)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (mini_object_created, (tracer, ts, object));
+}
+
+void
+_priv_gst_tracer_mini_object_destroyed (GstMiniObject * object)
+{
+  GstClockTime ts = gst_util_get_timestamp ();
+
+  TRACER_DISPATCH (mini_object_destroyed, (tracer, ts, object));
+}
+
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
@@ -0,0 +1,164 @@
+/* GStreamer
+ *
+ * gsttracer.h: tracing hooks for measuring the dataflow
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_TRACER_H__
+#define __GST_TRACER_H__
+
+#include <gst/gstobject.h>
+#include <gst/gstpad.h>
+#include <gst/gsttask.h>
+#include <gst/gstclock.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_TRACER                 (gst_tracer_get_type())
+#define GST_TRACER(obj)                 (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_TRACER,GstTracer))
+#define GST_TRACER_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_TRACER,GstTracerClass))
+#define GST_IS_TRACER(obj)              (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_TRACER))
+#define GST_IS_TRACER_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_TRACER))
+#define GST_TRACER_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS((obj),GST_TYPE_TRACER,GstTracerClass))
+#define GST_TRACER_CAST(obj)            ((GstTracer *)(obj))
+
+typedef struct _GstTracer GstTracer;
+typedef struct _GstTracerClass GstTracerClass;
+
+/**
+ * GstTracer:
+ *
+ * The opaque #GstTracer instance structure
+ */
+struct _GstTracer {
+  GstObject        object;
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+/**
+ * GstTracerClass:
+ * @parent_class: the parent class structure
+ * @pad_push_pre: called before a buffer is pushed on a srcpad
+ * @pad_push_list_pre: called before a buffer list is pushed on a srcpad
+ * @pad_push_post: called after a buffer or buffer list was pushed on a
+ *     srcpad
+ * @pad_chain_pre: called before the chain function of a sinkpad is called
+ *     with a buffer
+ * @pad_chain_list_pre: called before the chain function of a sinkpad is
+ *     called with a buffer list
+ * @pad_chain_post: called after the chain function of a sinkpad returned
+ * @pad_pull_range_pre: called before a buffer is pulled on a sinkpad
+ * @pad_pull_range_post: called after a buffer was pulled on a sinkpad,
+ *     @buffer is only valid when @res is #GST_FLOW_OK
+ * @pad_push_event_pre: called before an event is pushed on a pad
+ * @pad_push_event_post: called after an event was pushed on a pad
+ * @pad_query_pre: called before a query is performed on a pad
+ * @pad_query_post: called after a query was performed on a pad
+ * @task_start: called from the thread of a #GstTask before the task function
+ *     is called for the first time
+ * @task_stop: called from the thread of a #GstTask after the task function
+ *     was called for the last time
+ * @task_iteration_pre: called before each call of the task function
+ * @task_iteration_post: called after each call of the task function
+ * @clock_wait_pre: called before a thread blocks on a #GstClockID
+ * @clock_wait_post: called when the wait on a #GstClockID returned
+ * @mini_object_created: called when a #GstMiniObject was initialized
+ * @mini_object_destroyed: called before a #GstMiniObject is freed
+ * @report: called periodically and before the tracer is destroyed to
+ *     output the collected values
+ * @describe: append a short summary of the values collected for @object to
+ *     @str, one line per value, each terminated by a newline. Used by
+ *     gst_debug_bin_to_dot_data() to annotate the pipeline graph.
+ *
+ * The hook functions receive a timestamp as returned by
+ * gst_util_get_timestamp() that was taken when the hook was called. All
+ * hooks are called from the streaming threads and must therefore be
+ * thread safe and as fast as possible. Hooks that are not needed can be left
+ * %NULL.
+ *
+ * Since: 1.2
+ */
+struct _GstTracerClass {
+  GstObjectClass parent_class;
+
+  /*< public >*/
+  void (*pad_push_pre)        (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstBuffer *buffer);
+  void (*pad_push_list_pre)   (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstBufferList *list);
+  void (*pad_push_post)       (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstFlowReturn res);
+
+  void (*pad_chain_pre)       (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstBuffer *buffer);
+  void (*pad_chain_list_pre)  (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstBufferList *list);
+  void (*pad_chain_post)      (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstFlowReturn res);
+
+  void (*pad_pull_range_pre)  (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, guint64 offset, guint size);
+  void (*pad_pull_range_post) (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstBuffer *buffer,
+                               GstFlowReturn res);
+
+  void (*pad_push_event_pre)  (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstEvent *event);
+  void (*pad_push_event_post) (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, gboolean res);
+
+  void (*pad_query_pre)       (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstQuery *query);
+  void (*pad_query_post)      (GstTracer *tracer, GstClockTime ts,
+                               GstPad *pad, GstQuery *query, gboolean res);
+
+  void (*task_start)          (GstTracer *tracer, GstClockTime ts,
+                               GstTask *task);
+  void (*task_stop)           (GstTracer *tracer, GstClockTime ts,
+                               GstTask *task);
+  void (*task_iteration_pre)  (GstTracer *tracer, GstClockTime ts,
+                               GstTask *task);
+  void (*task_iteration_post) (GstTracer *tracer, GstClockTime ts,
+                               GstTask *task);
+
+  void (*clock_wait_pre)      (GstTracer *tracer, GstClockTime ts,
+                               GstClock *clock, GstClockID id);
+  void (*clock_wait_post)     (GstTracer *tracer, GstClockTime ts,
+                               GstClock *clock, GstClockReturn res);
+
+  void (*mini_object_created)   (GstTracer *tracer, GstClockTime ts,
+                                 GstMiniObject *object);
+  void (*mini_object_destroyed) (GstTracer *tracer, GstClockTime ts,
+                                 GstMiniObject *object);
+
+  void (*report)              (GstTracer *tracer);
+  void (*describe)            (GstTracer *tracer, GstObject *object,
+                               GString *str);
+
+  /*< private >*/
+  gpointer _gst_reserved[GST_PADDING];
+};
+
+GType           gst_tracer_get_type          (void);
+
+gboolean        gst_tracer_register          (const gchar *name, GType type);
+
+G_END_DECLS
+
+#endif /* __GST_TRACER_H__ */
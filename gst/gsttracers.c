@@ -0,0 +1,2092 @@
+/* GStreamer
+ *
+ * gsttracers.c: tracers provided by the core
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The core tracers keep their values in a table with an entry for each pad
+ * or element they have seen. The entries are logged when the tracer reports
+ * and a last time when the pad or element is finalized. */
+
+#include "gst_private.h"
+
+#include "gstbufferlist.h"
+#include "gstutils.h"
+#include "gstelement.h"
+#include "gstevent.h"
+#include "gstquery.h"
+#include "gsttracer.h"
+#include "gsttracerutils.h"
+
+#include <string.h>
+#if defined (HAVE_EXECINFO_H) && defined (HAVE_BACKTRACE)
+#include <execinfo.h>
+#include <stdlib.h>
+#define LEAKS_HAVE_BACKTRACE 1
+#endif
+
+typedef struct _GstTracerTable GstTracerTable;
+typedef struct _GstTracerEntry GstTracerEntry;
+
+typedef void (*GstTracerEntryLogFunc) (GstTracer * tracer,
+    GstTracerEntry * entry);
+typedef void (*GstTracerEntryDescribeFunc) (GstTracer * tracer,
+    GstTracerEntry * entry, GString * str);
+
+struct _GstTracerTable
+{
+  GMutex lock;
+  GHashTable *entries;
+  gsize entry_size;
+  GstTracerEntryLogFunc log;
+  GstTracer *tracer;
+};
+
+/* must be the first field of the entries of the tracers */
+struct _GstTracerEntry
+{
+  GstTracerTable *table;
+  GstObject *object;
+  gchar *name;
+};
+
+static void
+tracer_table_init (GstTracerTable * table, GstTracer * tracer,
+    gsize entry_size, GstTracerEntryLogFunc log)
+{
+  g_mutex_init (&table->lock);
+  table->entries = g_hash_table_new (NULL, NULL);
+  table->entry_size = entry_size;
+  table->log = log;
+  table->tracer = tracer;
+}
+
+static void
+tracer_entry_free (GstTracerEntry * entry)
+{
+  g_free (entry->name);
+  g_slice_free1 (entry->table->entry_size, entry);
+}
+
+/* the object of the entry went away, log the final values */
+static void
+tracer_entry_gone (gpointer data, GObject * where_the_object_was)
+{
+  GstTracerEntry *entry = data;
+  GstTracerTable *table = entry->table;
+
+  g_mutex_lock (&table->lock);
+  table->log (table->tracer, entry);
+  g_hash_table_remove (table->entries, where_the_object_was);
+  g_mutex_unlock (&table->lock);
+
+  tracer_entry_free (entry);
+}
+
+/* call with the table lock */
+static gpointer
+tracer_table_lookup (GstTracerTable * table, GstObject * object)
+{
+  GstTracerEntry *entry;
+
+  entry = g_hash_table_lookup (table->entries, object);
+  if (G_UNLIKELY (entry == NULL)) {
+    entry = g_slice_alloc0 (table->entry_size);
+    entry->table = table;
+    entry->object = object;
+    if (GST_IS_PAD (object))
+      entry->name = g_strdup_printf ("%s:%s", GST_DEBUG_PAD_NAME (object));
+    else
+      entry->name = g_strdup (GST_OBJECT_NAME (object));
+
+    g_object_weak_ref (G_OBJECT (object), tracer_entry_gone, entry);
+    g_hash_table_insert (table->entries, object, entry);
+  }
+  return entry;
+}
+
+static void
+tracer_table_log (GstTracerTable * table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_mutex_lock (&table->lock);
+  g_hash_table_iter_init (&iter, table->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    table->log (table->tracer, value);
+  g_mutex_unlock (&table->lock);
+}
+
+/* unlike the hooks this doesn't create an entry for @object */
+static void
+tracer_table_describe (GstTracerTable * table, GstObject * object,
+    GString * str, GstTracerEntryDescribeFunc describe)
+{
+  GstTracerEntry *entry;
+
+  g_mutex_lock (&table->lock);
+  entry = g_hash_table_lookup (table->entries, object);
+  if (entry)
+    describe (table->tracer, entry, str);
+  g_mutex_unlock (&table->lock);
+}
+
+static void
+tracer_table_clear (GstTracerTable * table)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_mutex_lock (&table->lock);
+  g_hash_table_iter_init (&iter, table->entries);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstTracerEntry *entry = value;
+
+    g_object_weak_unref (G_OBJECT (entry->object), tracer_entry_gone, entry);
+    tracer_entry_free (entry);
+  }
+  g_hash_table_unref (table->entries);
+  g_mutex_unlock (&table->lock);
+  g_mutex_clear (&table->lock);
+}
+
+/* a stack of timestamps per thread, used to match the pre and post hooks of
+ * nested calls */
+typedef struct
+{
+  GstObject *object;
+  GstClockTime start;
+  GstClockTime children;
+} GstTracerFrame;
+
+static void
+tracer_frame_push (GPrivate * key, GstObject * object, GstClockTime ts)
+{
+  GArray *stack;
+  GstTracerFrame frame = { object, ts, 0 };
+
+  stack = g_private_get (key);
+  if (G_UNLIKELY (stack == NULL)) {
+    stack = g_array_new (FALSE, FALSE, sizeof (GstTracerFrame));
+    g_private_set (key, stack);
+  }
+  g_array_append_val (stack, frame);
+}
+
+static gboolean
+tracer_frame_pop (GPrivate * key, GstTracerFrame * frame)
+{
+  GArray *stack;
+
+  stack = g_private_get (key);
+  /* the tracer was enabled while the call was in progress */
+  if (G_UNLIKELY (stack == NULL || stack->len == 0))
+    return FALSE;
+
+  *frame = g_array_index (stack, GstTracerFrame, stack->len - 1);
+  g_array_set_size (stack, stack->len - 1);
+
+  return TRUE;
+}
+
+static GstTracerFrame *
+tracer_frame_peek (GPrivate * key)
+{
+  GArray *stack;
+
+  stack = g_private_get (key);
+  if (stack == NULL || stack->len == 0)
+    return NULL;
+
+  return &g_array_index (stack, GstTracerFrame, stack->len - 1);
+}
+
+static void
+tracer_frame_stack_free (gpointer data)
+{
+  g_array_free (data, TRUE);
+}
+
+/* proctime: the time spent in the chain and getrange functions of each
+ * element, minus the time spent in the elements that were called from
+ * there in the same thread */
+
+typedef struct
+{
+  GstTracer parent;
+
+  GstTracerTable table;
+} GstProcTimeTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstProcTimeTracerClass;
+
+typedef struct
+{
+  GstTracerEntry entry;
+
+  guint64 calls;
+  GstClockTime total;
+  GstClockTime max;
+} GstProcTimeEntry;
+
+static GPrivate proctime_stack = G_PRIVATE_INIT (tracer_frame_stack_free);
+
+G_GNUC_INTERNAL GType gst_proc_time_tracer_get_type (void);
+G_DEFINE_TYPE (GstProcTimeTracer, gst_proc_time_tracer, GST_TYPE_TRACER);
+
+static void
+proctime_log (GstTracer * tracer, GstTracerEntry * entry)
+{
+  GstProcTimeEntry *e = (GstProcTimeEntry *) entry;
+
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, tracer, "element %s: calls %"
+      G_GUINT64_FORMAT ", total %" GST_TIME_FORMAT ", avg %" GST_TIME_FORMAT
+      ", max %" GST_TIME_FORMAT, entry->name, e->calls,
+      GST_TIME_ARGS (e->total),
+      GST_TIME_ARGS (e->calls ? e->total / e->calls : 0),
+      GST_TIME_ARGS (e->max));
+}
+
+static void
+proctime_describe_entry (GstTracer * tracer, GstTracerEntry * entry,
+    GString * str)
+{
+  GstProcTimeEntry *e = (GstProcTimeEntry *) entry;
+
+  if (e->calls == 0)
+    return;
+
+  g_string_append_printf (str, "proctime avg %" G_GUINT64_FORMAT " us, max %"
+      G_GUINT64_FORMAT " us\n", e->total / e->calls / GST_USECOND,
+      e->max / GST_USECOND);
+}
+
+static void
+proctime_enter (GstProcTimeTracer * self, GstClockTime ts, GstPad * pad)
+{
+  tracer_frame_push (&proctime_stack, pad ? GST_OBJECT_PARENT (pad) : NULL,
+      ts);
+}
+
+static void
+proctime_leave (GstProcTimeTracer * self, GstClockTime ts)
+{
+  GstTracerFrame frame, *parent;
+  GstClockTime duration, own;
+
+  if (!tracer_frame_pop (&proctime_stack, &frame))
+    return;
+
+  duration = ts - frame.start;
+  own = duration > frame.children ? duration - frame.children : 0;
+
+  /* the calling element should not be charged for our time */
+  if ((parent = tracer_frame_peek (&proctime_stack)))
+    parent->children += duration;
+
+  if (frame.object == NULL || !GST_IS_ELEMENT (frame.object))
+    return;
+
+  g_mutex_lock (&self->table.lock);
+  {
+    GstProcTimeEntry *e = tracer_table_lookup (&self->table, frame.object);
+
+    e->calls++;
+    e->total += own;
+    if (own > e->max)
+      e->max = own;
+  }
+  g_mutex_unlock (&self->table.lock);
+}
+
+static void
+proctime_chain_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  proctime_enter ((GstProcTimeTracer *) tracer, ts, pad);
+}
+
+static void
+proctime_chain_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  proctime_enter ((GstProcTimeTracer *) tracer, ts, pad);
+}
+
+static void
+proctime_chain_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  proctime_leave ((GstProcTimeTracer *) tracer, ts);
+}
+
+static void
+proctime_pull_range_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  /* the work is done by the element of the peer pad */
+  proctime_enter ((GstProcTimeTracer *) tracer, ts, GST_PAD_PEER (pad));
+}
+
+static void
+proctime_pull_range_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  proctime_leave ((GstProcTimeTracer *) tracer, ts);
+}
+
+static void
+proctime_report (GstTracer * tracer)
+{
+  tracer_table_log (&((GstProcTimeTracer *) tracer)->table);
+}
+
+static void
+proctime_describe (GstTracer * tracer, GstObject * object, GString * str)
+{
+  tracer_table_describe (&((GstProcTimeTracer *) tracer)->table, object, str,
+      proctime_describe_entry);
+}
+
+static void
+gst_proc_time_tracer_finalize (GObject * object)
+{
+  tracer_table_clear (&((GstProcTimeTracer *) object)->table);
+
+  G_OBJECT_CLASS (gst_proc_time_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_proc_time_tracer_class_init (GstProcTimeTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_proc_time_tracer_finalize;
+
+  tracer_class->pad_chain_pre = proctime_chain_pre;
+  tracer_class->pad_chain_list_pre = proctime_chain_list_pre;
+  tracer_class->pad_chain_post = proctime_chain_post;
+  tracer_class->pad_pull_range_pre = proctime_pull_range_pre;
+  tracer_class->pad_pull_range_post = proctime_pull_range_post;
+  tracer_class->report = proctime_report;
+  tracer_class->describe = proctime_describe;
+}
+
+static void
+gst_proc_time_tracer_init (GstProcTimeTracer * self)
+{
+  tracer_table_init (&self->table, GST_TRACER_CAST (self),
+      sizeof (GstProcTimeEntry), proctime_log);
+}
+
+/* latency: the time it takes for a push or pull on a pad to return */
+
+typedef struct
+{
+  GstTracer parent;
+
+  GstTracerTable table;
+} GstLatencyTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstLatencyTracerClass;
+
+typedef struct
+{
+  GstTracerEntry entry;
+
+  guint64 count;
+  GstClockTime total;
+  GstClockTime min;
+  GstClockTime max;
+} GstLatencyEntry;
+
+static GPrivate latency_stack = G_PRIVATE_INIT (tracer_frame_stack_free);
+
+G_GNUC_INTERNAL GType gst_latency_tracer_get_type (void);
+G_DEFINE_TYPE (GstLatencyTracer, gst_latency_tracer, GST_TYPE_TRACER);
+
+static void
+latency_log (GstTracer * tracer, GstTracerEntry * entry)
+{
+  GstLatencyEntry *e = (GstLatencyEntry *) entry;
+
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, tracer, "pad %s: count %"
+      G_GUINT64_FORMAT ", min %" GST_TIME_FORMAT ", avg %" GST_TIME_FORMAT
+      ", max %" GST_TIME_FORMAT, entry->name, e->count,
+      GST_TIME_ARGS (e->min),
+      GST_TIME_ARGS (e->count ? e->total / e->count : 0),
+      GST_TIME_ARGS (e->max));
+}
+
+static void
+latency_describe_entry (GstTracer * tracer, GstTracerEntry * entry,
+    GString * str)
+{
+  GstLatencyEntry *e = (GstLatencyEntry *) entry;
+
+  if (e->count == 0)
+    return;
+
+  g_string_append_printf (str, "latency avg %" G_GUINT64_FORMAT " us, max %"
+      G_GUINT64_FORMAT " us\n", e->total / e->count / GST_USECOND,
+      e->max / GST_USECOND);
+}
+
+static void
+latency_enter (GstTracer * tracer, GstClockTime ts, GstPad * pad)
+{
+  tracer_frame_push (&latency_stack, GST_OBJECT_CAST (pad), ts);
+}
+
+static void
+latency_leave (GstTracer * tracer, GstClockTime ts)
+{
+  GstLatencyTracer *self = (GstLatencyTracer *) tracer;
+  GstTracerFrame frame;
+  GstClockTime duration;
+
+  if (!tracer_frame_pop (&latency_stack, &frame))
+    return;
+
+  duration = ts - frame.start;
+
+  g_mutex_lock (&self->table.lock);
+  {
+    GstLatencyEntry *e = tracer_table_lookup (&self->table, frame.object);
+
+    if (e->count == 0 || duration < e->min)
+      e->min = duration;
+    if (duration > e->max)
+      e->max = duration;
+    e->total += duration;
+    e->count++;
+  }
+  g_mutex_unlock (&self->table.lock);
+}
+
+static void
+latency_push_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  latency_enter (tracer, ts, pad);
+}
+
+static void
+latency_push_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  latency_enter (tracer, ts, pad);
+}
+
+static void
+latency_push_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  latency_leave (tracer, ts);
+}
+
+static void
+latency_pull_range_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  latency_enter (tracer, ts, pad);
+}
+
+static void
+latency_pull_range_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  latency_leave (tracer, ts);
+}
+
+static void
+latency_report (GstTracer * tracer)
+{
+  tracer_table_log (&((GstLatencyTracer *) tracer)->table);
+}
+
+static void
+latency_describe (GstTracer * tracer, GstObject * object, GString * str)
+{
+  tracer_table_describe (&((GstLatencyTracer *) tracer)->table, object, str,
+      latency_describe_entry);
+}
+
+static void
+gst_latency_tracer_finalize (GObject * object)
+{
+  tracer_table_clear (&((GstLatencyTracer *) object)->table);
+
+  G_OBJECT_CLASS (gst_latency_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_latency_tracer_class_init (GstLatencyTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_latency_tracer_finalize;
+
+  tracer_class->pad_push_pre = latency_push_pre;
+  tracer_class->pad_push_list_pre = latency_push_list_pre;
+  tracer_class->pad_push_post = latency_push_post;
+  tracer_class->pad_pull_range_pre = latency_pull_range_pre;
+  tracer_class->pad_pull_range_post = latency_pull_range_post;
+  tracer_class->report = latency_report;
+  tracer_class->describe = latency_describe;
+}
+
+static void
+gst_latency_tracer_init (GstLatencyTracer * self)
+{
+  tracer_table_init (&self->table, GST_TRACER_CAST (self),
+      sizeof (GstLatencyEntry), latency_log);
+}
+
+/* rate: buffers and bytes per second pushed on each pad */
+
+typedef struct
+{
+  GstTracer parent;
+
+  GstTracerTable table;
+  /* time of the last report, protected by the table lock */
+  GstClockTime last_report;
+  GstClockTime interval;
+} GstRateTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstRateTracerClass;
+
+typedef struct
+{
+  GstTracerEntry entry;
+
+  guint64 buffers;
+  guint64 bytes;
+  /* since the last report */
+  guint64 window_buffers;
+  guint64 window_bytes;
+} GstRateEntry;
+
+G_GNUC_INTERNAL GType gst_rate_tracer_get_type (void);
+G_DEFINE_TYPE (GstRateTracer, gst_rate_tracer, GST_TYPE_TRACER);
+
+static void
+rate_log (GstTracer * tracer, GstTracerEntry * entry)
+{
+  GstRateTracer *self = (GstRateTracer *) tracer;
+  GstRateEntry *e = (GstRateEntry *) entry;
+  guint64 bps = 0, Bps = 0;
+
+  if (self->interval > 0) {
+    bps = gst_util_uint64_scale (e->window_buffers, GST_SECOND,
+        self->interval);
+    Bps = gst_util_uint64_scale (e->window_bytes, GST_SECOND, self->interval);
+  }
+
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, tracer, "pad %s: %" G_GUINT64_FORMAT
+      " buffers/s, %" G_GUINT64_FORMAT " bytes/s, total %" G_GUINT64_FORMAT
+      " buffers, %" G_GUINT64_FORMAT " bytes", entry->name, bps, Bps,
+      e->buffers, e->bytes);
+
+  e->window_buffers = 0;
+  e->window_bytes = 0;
+}
+
+/* the rate since the last report, called with the table lock */
+static void
+rate_describe_entry (GstTracer * tracer, GstTracerEntry * entry,
+    GString * str)
+{
+  GstRateTracer *self = (GstRateTracer *) tracer;
+  GstRateEntry *e = (GstRateEntry *) entry;
+  GstClockTime interval;
+  guint64 bps = 0, Bps = 0;
+
+  interval = gst_util_get_timestamp () - self->last_report;
+  if (interval > 0) {
+    bps = gst_util_uint64_scale (e->window_buffers, GST_SECOND, interval);
+    Bps = gst_util_uint64_scale (e->window_bytes, GST_SECOND, interval);
+  }
+
+  g_string_append_printf (str, "%" G_GUINT64_FORMAT " buffers/s, %"
+      G_GUINT64_FORMAT " bytes/s\n", bps, Bps);
+}
+
+static void
+rate_account (GstRateTracer * self, GstPad * pad, guint buffers, gsize bytes)
+{
+  GstRateEntry *e;
+
+  g_mutex_lock (&self->table.lock);
+  e = tracer_table_lookup (&self->table, GST_OBJECT_CAST (pad));
+  e->buffers += buffers;
+  e->bytes += bytes;
+  e->window_buffers += buffers;
+  e->window_bytes += bytes;
+  g_mutex_unlock (&self->table.lock);
+}
+
+static void
+rate_push_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  rate_account ((GstRateTracer *) tracer, pad, 1,
+      gst_buffer_get_size (buffer));
+}
+
+static void
+rate_push_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  guint i, len;
+  gsize bytes = 0;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++)
+    bytes += gst_buffer_get_size (gst_buffer_list_get (list, i));
+
+  rate_account ((GstRateTracer *) tracer, pad, len, bytes);
+}
+
+static void
+rate_pull_range_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  if (res == GST_FLOW_OK)
+    rate_account ((GstRateTracer *) tracer, pad, 1,
+        gst_buffer_get_size (buffer));
+}
+
+static void
+rate_report (GstTracer * tracer)
+{
+  GstRateTracer *self = (GstRateTracer *) tracer;
+  GstClockTime now = gst_util_get_timestamp ();
+
+  g_mutex_lock (&self->table.lock);
+  self->interval = now - self->last_report;
+  self->last_report = now;
+  g_mutex_unlock (&self->table.lock);
+
+  tracer_table_log (&self->table);
+}
+
+static void
+rate_describe (GstTracer * tracer, GstObject * object, GString * str)
+{
+  tracer_table_describe (&((GstRateTracer *) tracer)->table, object, str,
+      rate_describe_entry);
+}
+
+static void
+gst_rate_tracer_finalize (GObject * object)
+{
+  tracer_table_clear (&((GstRateTracer *) object)->table);
+
+  G_OBJECT_CLASS (gst_rate_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_rate_tracer_class_init (GstRateTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_rate_tracer_finalize;
+
+  tracer_class->pad_push_pre = rate_push_pre;
+  tracer_class->pad_push_list_pre = rate_push_list_pre;
+  tracer_class->pad_pull_range_post = rate_pull_range_post;
+  tracer_class->report = rate_report;
+  tracer_class->describe = rate_describe;
+}
+
+static void
+gst_rate_tracer_init (GstRateTracer * self)
+{
+  tracer_table_init (&self->table, GST_TRACER_CAST (self),
+      sizeof (GstRateEntry), rate_log);
+  self->last_report = gst_util_get_timestamp ();
+}
+
+/* queuelevel: the fill level of elements with the current-level-* properties
+ * of queue and queue2, sampled when data enters and leaves the element */
+
+typedef struct
+{
+  GstTracer parent;
+
+  GstTracerTable table;
+} GstQueueLevelTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstQueueLevelTracerClass;
+
+typedef struct
+{
+  GstTracerEntry entry;
+
+  gboolean checked;
+  gboolean is_queue;
+  guint64 samples;
+  guint buffers;
+  guint bytes;
+  guint64 time;
+  guint max_buffers;
+  guint max_bytes;
+  guint64 max_time;
+  guint64 total_buffers;
+} GstQueueLevelEntry;
+
+G_GNUC_INTERNAL GType gst_queue_level_tracer_get_type (void);
+G_DEFINE_TYPE (GstQueueLevelTracer, gst_queue_level_tracer, GST_TYPE_TRACER);
+
+static void
+queuelevel_log (GstTracer * tracer, GstTracerEntry * entry)
+{
+  GstQueueLevelEntry *e = (GstQueueLevelEntry *) entry;
+
+  if (!e->is_queue || e->samples == 0)
+    return;
+
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, tracer, "queue %s: buffers %u "
+      "(avg %" G_GUINT64_FORMAT ", max %u), bytes %u (max %u), time %"
+      GST_TIME_FORMAT " (max %" GST_TIME_FORMAT ")", entry->name, e->buffers,
+      e->total_buffers / e->samples, e->max_buffers, e->bytes, e->max_bytes,
+      GST_TIME_ARGS (e->time), GST_TIME_ARGS (e->max_time));
+}
+
+static void
+queuelevel_describe_entry (GstTracer * tracer, GstTracerEntry * entry,
+    GString * str)
+{
+  GstQueueLevelEntry *e = (GstQueueLevelEntry *) entry;
+
+  if (!e->is_queue || e->samples == 0)
+    return;
+
+  g_string_append_printf (str, "level %u buffers, %u bytes, %"
+      G_GUINT64_FORMAT " ms\n", e->buffers, e->bytes, e->time / GST_MSECOND);
+}
+
+static void
+queuelevel_sample (GstQueueLevelTracer * self, GstPad * pad)
+{
+  GstObject *element;
+  GstQueueLevelEntry *e;
+  guint buffers, bytes;
+  guint64 time;
+
+  element = GST_OBJECT_PARENT (pad);
+  if (element == NULL || !GST_IS_ELEMENT (element))
+    return;
+
+  g_mutex_lock (&self->table.lock);
+  e = tracer_table_lookup (&self->table, element);
+  if (G_UNLIKELY (!e->checked)) {
+    e->is_queue =
+        g_object_class_find_property (G_OBJECT_GET_CLASS (element),
+        "current-level-buffers") != NULL;
+    e->checked = TRUE;
+  }
+  if (!e->is_queue) {
+    g_mutex_unlock (&self->table.lock);
+    return;
+  }
+  g_mutex_unlock (&self->table.lock);
+
+  /* the queue takes its own lock, don't hold ours */
+  g_object_get (element, "current-level-buffers", &buffers,
+      "current-level-bytes", &bytes, "current-level-time", &time, NULL);
+
+  g_mutex_lock (&self->table.lock);
+  e = tracer_table_lookup (&self->table, element);
+  e->samples++;
+  e->buffers = buffers;
+  e->bytes = bytes;
+  e->time = time;
+  e->total_buffers += buffers;
+  e->max_buffers = MAX (e->max_buffers, buffers);
+  e->max_bytes = MAX (e->max_bytes, bytes);
+  e->max_time = MAX (e->max_time, time);
+  g_mutex_unlock (&self->table.lock);
+}
+
+static void
+queuelevel_push_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  queuelevel_sample ((GstQueueLevelTracer *) tracer, pad);
+}
+
+static void
+queuelevel_chain_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  queuelevel_sample ((GstQueueLevelTracer *) tracer, pad);
+}
+
+static void
+queuelevel_report (GstTracer * tracer)
+{
+  tracer_table_log (&((GstQueueLevelTracer *) tracer)->table);
+}
+
+static void
+queuelevel_describe (GstTracer * tracer, GstObject * object, GString * str)
+{
+  tracer_table_describe (&((GstQueueLevelTracer *) tracer)->table, object,
+      str, queuelevel_describe_entry);
+}
+
+static void
+gst_queue_level_tracer_finalize (GObject * object)
+{
+  tracer_table_clear (&((GstQueueLevelTracer *) object)->table);
+
+  G_OBJECT_CLASS (gst_queue_level_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_queue_level_tracer_class_init (GstQueueLevelTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_queue_level_tracer_finalize;
+
+  tracer_class->pad_push_pre = queuelevel_push_pre;
+  tracer_class->pad_chain_post = queuelevel_chain_post;
+  tracer_class->report = queuelevel_report;
+  tracer_class->describe = queuelevel_describe;
+}
+
+static void
+gst_queue_level_tracer_init (GstQueueLevelTracer * self)
+{
+  tracer_table_init (&self->table, GST_TRACER_CAST (self),
+      sizeof (GstQueueLevelEntry), queuelevel_log);
+}
+
+/* timeline: the spans of the chain and getrange functions, events, queries
+ * and clock waits of every thread, written as a Chrome trace event file that
+ * can be loaded in chrome://tracing or Perfetto. The file is written when an
+ * EOS event reaches a sink, when a custom event with a structure named
+ * "GstTimelineDump" is pushed and when the tracer is destroyed. */
+
+#define TIMELINE_DEFAULT_FILE "gst-timeline.json"
+#define TIMELINE_DUMP_EVENT "GstTimelineDump"
+/* spans beyond this per thread are only counted */
+#define TIMELINE_MAX_SPANS (256 * 1024)
+
+typedef struct
+{
+  const gchar *name;
+  const gchar *cat;
+  GstClockTime start;
+  GstClockTime duration;
+} GstTimelineSpan;
+
+typedef struct
+{
+  GMutex lock;
+  guint tid;
+  gchar *name;
+  GArray *spans;
+  /* the spans that were started but not finished yet, only touched by the
+   * thread itself */
+  GArray *open;
+  guint64 dropped;
+  gboolean dump_pending;
+} GstTimelineThread;
+
+typedef struct
+{
+  GstTracer parent;
+
+  GMutex lock;
+  guint id;
+  GstClockTime start;
+  gchar *filename;
+  GList *threads;
+  guint n_threads;
+} GstTimelineTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstTimelineTracerClass;
+
+/* the thread state of a tracer instance, the id protects against a tracer
+ * that was destroyed and replaced */
+typedef struct
+{
+  guint id;
+  GstTimelineThread *thread;
+} GstTimelineKey;
+
+static GPrivate timeline_key = G_PRIVATE_INIT (g_free);
+static gint timeline_ids = 0;
+
+G_GNUC_INTERNAL GType gst_timeline_tracer_get_type (void);
+G_DEFINE_TYPE (GstTimelineTracer, gst_timeline_tracer, GST_TYPE_TRACER);
+
+static GstTimelineThread *
+timeline_get_thread (GstTimelineTracer * self)
+{
+  GstTimelineKey *key;
+  GstTimelineThread *thread;
+
+  key = g_private_get (&timeline_key);
+  if (G_LIKELY (key != NULL && key->id == self->id))
+    return key->thread;
+
+  if (key == NULL) {
+    key = g_new0 (GstTimelineKey, 1);
+    g_private_set (&timeline_key, key);
+  }
+
+  thread = g_slice_new0 (GstTimelineThread);
+  g_mutex_init (&thread->lock);
+  thread->spans = g_array_new (FALSE, FALSE, sizeof (GstTimelineSpan));
+  thread->open = g_array_new (FALSE, FALSE, sizeof (GstTimelineSpan));
+
+  g_mutex_lock (&self->lock);
+  thread->tid = ++self->n_threads;
+  self->threads = g_list_prepend (self->threads, thread);
+  g_mutex_unlock (&self->lock);
+
+  key->id = self->id;
+  key->thread = thread;
+
+  return thread;
+}
+
+static void
+timeline_thread_free (GstTimelineThread * thread)
+{
+  g_mutex_clear (&thread->lock);
+  g_array_free (thread->spans, TRUE);
+  g_array_free (thread->open, TRUE);
+  g_free (thread->name);
+  g_slice_free (GstTimelineThread, thread);
+}
+
+static void
+timeline_begin (GstTimelineTracer * self, GstClockTime ts, const gchar * cat,
+    const gchar * name)
+{
+  GstTimelineThread *thread = timeline_get_thread (self);
+  GstTimelineSpan span = { name, cat, ts, 0 };
+
+  g_array_append_val (thread->open, span);
+}
+
+static GstTimelineThread *
+timeline_end (GstTimelineTracer * self, GstClockTime ts)
+{
+  GstTimelineThread *thread = timeline_get_thread (self);
+  GstTimelineSpan span;
+
+  /* the tracer was enabled while the call was in progress */
+  if (G_UNLIKELY (thread->open->len == 0))
+    return thread;
+
+  span = g_array_index (thread->open, GstTimelineSpan, thread->open->len - 1);
+  g_array_set_size (thread->open, thread->open->len - 1);
+  span.duration = ts - span.start;
+
+  g_mutex_lock (&thread->lock);
+  if (G_LIKELY (thread->spans->len < TIMELINE_MAX_SPANS))
+    g_array_append_val (thread->spans, span);
+  else
+    thread->dropped++;
+  g_mutex_unlock (&thread->lock);
+
+  return thread;
+}
+
+static const gchar *
+timeline_element_name (GstPad * pad)
+{
+  GstObject *parent;
+
+  if (pad == NULL || (parent = GST_OBJECT_PARENT (pad)) == NULL)
+    return "unknown";
+
+  /* the names of the spans outlive the elements */
+  return g_intern_string (GST_OBJECT_NAME (parent));
+}
+
+static void
+timeline_append_escaped (GString * str, const gchar * s)
+{
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      g_string_append_c (str, '\\');
+    if ((guchar) * s < 0x20)
+      g_string_append_printf (str, "\\u%04x", (guchar) * s);
+    else
+      g_string_append_c (str, *s);
+  }
+}
+
+static void
+timeline_dump (GstTimelineTracer * self)
+{
+  GString *str;
+  GList *walk;
+  gboolean first = TRUE;
+  GError *err = NULL;
+
+  str = g_string_sized_new (4096);
+  g_string_append (str, "{\"traceEvents\":[");
+
+  g_mutex_lock (&self->lock);
+  for (walk = self->threads; walk; walk = walk->next) {
+    GstTimelineThread *thread = walk->data;
+    guint i;
+
+    g_mutex_lock (&thread->lock);
+    g_string_append_printf (str, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\","
+        "\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", first ? "" : ",",
+        thread->tid);
+    if (thread->name)
+      timeline_append_escaped (str, thread->name);
+    else
+      g_string_append_printf (str, "thread-%u", thread->tid);
+    g_string_append (str, "\"}}");
+    first = FALSE;
+
+    for (i = 0; i < thread->spans->len; i++) {
+      GstTimelineSpan *span = &g_array_index (thread->spans, GstTimelineSpan,
+          i);
+      GstClockTime start = span->start > self->start ?
+          span->start - self->start : 0;
+
+      g_string_append (str, ",\n{\"name\":\"");
+      timeline_append_escaped (str, span->name);
+      g_string_append_printf (str, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,"
+          "\"tid\":%u,\"ts\":%" G_GUINT64_FORMAT ".%03u,\"dur\":%"
+          G_GUINT64_FORMAT ".%03u}", span->cat, thread->tid,
+          start / 1000, (guint) (start % 1000), span->duration / 1000,
+          (guint) (span->duration % 1000));
+    }
+    if (thread->dropped)
+      GST_CAT_WARNING_OBJECT (GST_CAT_TRACER, self, "thread %u: dropped %"
+          G_GUINT64_FORMAT " spans", thread->tid, thread->dropped);
+    g_mutex_unlock (&thread->lock);
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_string_append (str, "\n]}\n");
+
+  if (!g_file_set_contents (self->filename, str->str, str->len, &err)) {
+    GST_CAT_WARNING_OBJECT (GST_CAT_TRACER, self, "could not write %s: %s",
+        self->filename, err->message);
+    g_error_free (err);
+  } else {
+    GST_CAT_INFO_OBJECT (GST_CAT_TRACER, self, "wrote timeline to %s",
+        self->filename);
+  }
+  g_string_free (str, TRUE);
+}
+
+static void
+timeline_chain_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "chain",
+      timeline_element_name (pad));
+}
+
+static void
+timeline_chain_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "chain",
+      timeline_element_name (pad));
+}
+
+static void
+timeline_chain_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  timeline_end ((GstTimelineTracer *) tracer, ts);
+}
+
+static void
+timeline_pull_range_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  /* the work is done by the element of the peer pad */
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "pull",
+      timeline_element_name (GST_PAD_PEER (pad)));
+}
+
+static void
+timeline_pull_range_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  timeline_end ((GstTimelineTracer *) tracer, ts);
+}
+
+static gboolean
+timeline_event_triggers_dump (GstPad * pad, GstEvent * event)
+{
+  GstPad *peer;
+  GstObject *parent;
+  const GstStructure *s;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      /* only when it reaches a sink, the whole pipeline is done then */
+      if ((peer = GST_PAD_PEER (pad)) == NULL ||
+          (parent = GST_OBJECT_PARENT (peer)) == NULL ||
+          !GST_IS_ELEMENT (parent))
+        return FALSE;
+      return GST_OBJECT_FLAG_IS_SET (parent, GST_ELEMENT_FLAG_SINK);
+    case GST_EVENT_CUSTOM_UPSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_STICKY:
+    case GST_EVENT_CUSTOM_BOTH:
+    case GST_EVENT_CUSTOM_BOTH_OOB:
+      s = gst_event_get_structure (event);
+      return s && gst_structure_has_name (s, TIMELINE_DUMP_EVENT);
+    default:
+      return FALSE;
+  }
+}
+
+static void
+timeline_push_event_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstEvent * event)
+{
+  GstTimelineTracer *self = (GstTimelineTracer *) tracer;
+
+  timeline_begin (self, ts, "event", GST_EVENT_TYPE_NAME (event));
+
+  if (G_UNLIKELY (timeline_event_triggers_dump (pad, event)))
+    timeline_get_thread (self)->dump_pending = TRUE;
+}
+
+static void
+timeline_push_event_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    gboolean res)
+{
+  GstTimelineTracer *self = (GstTimelineTracer *) tracer;
+  GstTimelineThread *thread;
+
+  thread = timeline_end (self, ts);
+
+  /* dump when the event was handled so that its span is included */
+  if (G_UNLIKELY (thread->dump_pending)) {
+    thread->dump_pending = FALSE;
+    timeline_dump (self);
+  }
+}
+
+static void
+timeline_query_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstQuery * query)
+{
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "query",
+      GST_QUERY_TYPE_NAME (query));
+}
+
+static void
+timeline_query_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstQuery * query, gboolean res)
+{
+  timeline_end ((GstTimelineTracer *) tracer, ts);
+}
+
+static void
+timeline_task_start (GstTracer * tracer, GstClockTime ts, GstTask * task)
+{
+  GstTimelineThread *thread;
+  gchar *name;
+
+  thread = timeline_get_thread ((GstTimelineTracer *) tracer);
+
+  name = gst_object_get_name (GST_OBJECT_CAST (task));
+  g_mutex_lock (&thread->lock);
+  g_free (thread->name);
+  thread->name = name;
+  g_mutex_unlock (&thread->lock);
+
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "task",
+      g_intern_string (name));
+}
+
+static void
+timeline_task_stop (GstTracer * tracer, GstClockTime ts, GstTask * task)
+{
+  timeline_end ((GstTimelineTracer *) tracer, ts);
+}
+
+static void
+timeline_clock_wait_pre (GstTracer * tracer, GstClockTime ts,
+    GstClock * clock, GstClockID id)
+{
+  timeline_begin ((GstTimelineTracer *) tracer, ts, "clock", "wait");
+}
+
+static void
+timeline_clock_wait_post (GstTracer * tracer, GstClockTime ts,
+    GstClock * clock, GstClockReturn res)
+{
+  timeline_end ((GstTimelineTracer *) tracer, ts);
+}
+
+static void
+gst_timeline_tracer_finalize (GObject * object)
+{
+  GstTimelineTracer *self = (GstTimelineTracer *) object;
+
+  timeline_dump (self);
+
+  g_list_free_full (self->threads, (GDestroyNotify) timeline_thread_free);
+  g_free (self->filename);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_timeline_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_timeline_tracer_class_init (GstTimelineTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_timeline_tracer_finalize;
+
+  tracer_class->pad_chain_pre = timeline_chain_pre;
+  tracer_class->pad_chain_list_pre = timeline_chain_list_pre;
+  tracer_class->pad_chain_post = timeline_chain_post;
+  tracer_class->pad_pull_range_pre = timeline_pull_range_pre;
+  tracer_class->pad_pull_range_post = timeline_pull_range_post;
+  tracer_class->pad_push_event_pre = timeline_push_event_pre;
+  tracer_class->pad_push_event_post = timeline_push_event_post;
+  tracer_class->pad_query_pre = timeline_query_pre;
+  tracer_class->pad_query_post = timeline_query_post;
+  tracer_class->task_start = timeline_task_start;
+  tracer_class->task_stop = timeline_task_stop;
+  tracer_class->clock_wait_pre = timeline_clock_wait_pre;
+  tracer_class->clock_wait_post = timeline_clock_wait_post;
+}
+
+static void
+gst_timeline_tracer_init (GstTimelineTracer * self)
+{
+  const gchar *env;
+
+  g_mutex_init (&self->lock);
+  self->id = g_atomic_int_add (&timeline_ids, 1) + 1;
+  self->start = gst_util_get_timestamp ();
+
+  env = g_getenv ("GST_TIMELINE_FILE");
+  self->filename = g_strdup (env && *env ? env : TIMELINE_DEFAULT_FILE);
+}
+
+/* leaks: the mini objects that are still alive, grouped by the call stack
+ * that allocated them. Only one in GST_LEAKS_SAMPLE objects is tracked so
+ * that the tracer can stay enabled in production, the stacks are only
+ * symbolized when they are logged. The live objects are logged when a custom
+ * event with a structure named "GstLeaksDump" is pushed and when the tracer
+ * is destroyed. */
+
+#define LEAKS_DUMP_EVENT "GstLeaksDump"
+#define LEAKS_MAX_FRAMES 16
+/* the frames of the hook, the dispatcher and gst_mini_object_init() */
+#define LEAKS_SKIP_FRAMES 3
+
+typedef struct
+{
+  GType type;
+  guint hash;
+  gint n_frames;
+  gpointer frames[LEAKS_MAX_FRAMES];
+
+  /* the tracked objects of this site that are alive and in total */
+  guint live;
+  guint64 total;
+} GstLeaksSite;
+
+typedef struct
+{
+  GstTracer parent;
+
+  guint sample;
+  gint counter;
+  gchar **types;
+
+  GMutex lock;
+  /* GstLeaksSite -> itself */
+  GHashTable *sites;
+  /* GstMiniObject -> GstLeaksSite */
+  GHashTable *objects;
+} GstLeaksTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstLeaksTracerClass;
+
+G_GNUC_INTERNAL GType gst_leaks_tracer_get_type (void);
+G_DEFINE_TYPE (GstLeaksTracer, gst_leaks_tracer, GST_TYPE_TRACER);
+
+static guint
+leaks_site_hash (const GstLeaksSite * site)
+{
+  return site->hash;
+}
+
+static gboolean
+leaks_site_equal (const GstLeaksSite * a, const GstLeaksSite * b)
+{
+  return a->type == b->type && a->n_frames == b->n_frames &&
+      memcmp (a->frames, b->frames, a->n_frames * sizeof (gpointer)) == 0;
+}
+
+static void
+leaks_site_free (GstLeaksSite * site)
+{
+  g_slice_free (GstLeaksSite, site);
+}
+
+static gboolean
+leaks_type_is_tracked (GstLeaksTracer * self, GType type)
+{
+  const gchar *name;
+  gint i;
+
+  if (self->types == NULL)
+    return TRUE;
+
+  name = g_type_name (type);
+  for (i = 0; self->types[i]; i++) {
+    if (strcmp (self->types[i], name) == 0)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+leaks_object_created (GstTracer * tracer, GstClockTime ts,
+    GstMiniObject * object)
+{
+  GstLeaksTracer *self = (GstLeaksTracer *) tracer;
+  GstLeaksSite key, *site, *old;
+  gint i;
+
+  if (!leaks_type_is_tracked (self, object->type))
+    return;
+
+  if (self->sample > 1 &&
+      (guint) g_atomic_int_add (&self->counter, 1) % self->sample != 0)
+    return;
+
+  key.type = object->type;
+  key.n_frames = 0;
+#ifdef LEAKS_HAVE_BACKTRACE
+  {
+    gpointer frames[LEAKS_MAX_FRAMES + LEAKS_SKIP_FRAMES];
+    gint n;
+
+    n = backtrace (frames, G_N_ELEMENTS (frames));
+    if (n > LEAKS_SKIP_FRAMES) {
+      key.n_frames = n - LEAKS_SKIP_FRAMES;
+      memcpy (key.frames, frames + LEAKS_SKIP_FRAMES,
+          key.n_frames * sizeof (gpointer));
+    }
+  }
+#endif
+
+  key.hash = (guint) key.type;
+  for (i = 0; i < key.n_frames; i++)
+    key.hash = key.hash * 31 + GPOINTER_TO_UINT (key.frames[i]);
+
+  g_mutex_lock (&self->lock);
+  site = g_hash_table_lookup (self->sites, &key);
+  if (site == NULL) {
+    site = g_slice_dup (GstLeaksSite, &key);
+    site->live = 0;
+    site->total = 0;
+    g_hash_table_insert (self->sites, site, site);
+  }
+  site->live++;
+  site->total++;
+
+  /* an object that was freed without its free function */
+  old = g_hash_table_lookup (self->objects, object);
+  if (G_UNLIKELY (old != NULL))
+    old->live--;
+  g_hash_table_insert (self->objects, object, site);
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+leaks_object_destroyed (GstTracer * tracer, GstClockTime ts,
+    GstMiniObject * object)
+{
+  GstLeaksTracer *self = (GstLeaksTracer *) tracer;
+  GstLeaksSite *site;
+
+  if (!leaks_type_is_tracked (self, object->type))
+    return;
+
+  g_mutex_lock (&self->lock);
+  site = g_hash_table_lookup (self->objects, object);
+  if (site != NULL) {
+    site->live--;
+    g_hash_table_remove (self->objects, object);
+  }
+  g_mutex_unlock (&self->lock);
+}
+
+static gint
+leaks_site_compare (gconstpointer a, gconstpointer b)
+{
+  const GstLeaksSite *sa = *(const GstLeaksSite **) a;
+  const GstLeaksSite *sb = *(const GstLeaksSite **) b;
+
+  if (sa->live != sb->live)
+    return sa->live > sb->live ? -1 : 1;
+  return 0;
+}
+
+static void
+leaks_dump (GstLeaksTracer * self)
+{
+  GHashTableIter iter;
+  GPtrArray *sites;
+  GstLeaksSite *site;
+  GString *str;
+  guint i, live = 0;
+
+  sites = g_ptr_array_new ();
+  str = g_string_sized_new (1024);
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_iter_init (&iter, self->sites);
+  while (g_hash_table_iter_next (&iter, (gpointer *) & site, NULL)) {
+    if (site->live > 0) {
+      g_ptr_array_add (sites, site);
+      live += site->live;
+    }
+  }
+  g_ptr_array_sort (sites, leaks_site_compare);
+
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, self, "%u tracked objects alive in "
+      "%u allocation sites", live, sites->len);
+
+  for (i = 0; i < sites->len; i++) {
+#ifdef LEAKS_HAVE_BACKTRACE
+    gchar **symbols;
+#endif
+    gint j;
+
+    site = g_ptr_array_index (sites, i);
+    g_string_printf (str, "%u %s alive of %" G_GUINT64_FORMAT " allocated",
+        site->live, g_type_name (site->type), site->total);
+#ifdef LEAKS_HAVE_BACKTRACE
+    symbols = backtrace_symbols (site->frames, site->n_frames);
+    for (j = 0; symbols && j < site->n_frames; j++)
+      g_string_append_printf (str, "\n  #%d %s", j, symbols[j]);
+    free (symbols);
+#else
+    for (j = 0; j < site->n_frames; j++)
+      g_string_append_printf (str, "\n  #%d %p", j, site->frames[j]);
+#endif
+    GST_CAT_INFO_OBJECT (GST_CAT_TRACER, self, "%s", str->str);
+  }
+  g_mutex_unlock (&self->lock);
+
+  g_string_free (str, TRUE);
+  g_ptr_array_free (sites, TRUE);
+}
+
+static void
+leaks_push_event_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstEvent * event)
+{
+  const GstStructure *s;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CUSTOM_UPSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_OOB:
+    case GST_EVENT_CUSTOM_DOWNSTREAM_STICKY:
+    case GST_EVENT_CUSTOM_BOTH:
+    case GST_EVENT_CUSTOM_BOTH_OOB:
+      s = gst_event_get_structure (event);
+      if (s && gst_structure_has_name (s, LEAKS_DUMP_EVENT))
+        leaks_dump ((GstLeaksTracer *) tracer);
+      break;
+    default:
+      break;
+  }
+}
+
+static void
+leaks_report (GstTracer * tracer)
+{
+  GstLeaksTracer *self = (GstLeaksTracer *) tracer;
+
+  g_mutex_lock (&self->lock);
+  GST_CAT_INFO_OBJECT (GST_CAT_TRACER, self, "%u tracked objects alive in "
+      "%u allocation sites", g_hash_table_size (self->objects),
+      g_hash_table_size (self->sites));
+  g_mutex_unlock (&self->lock);
+}
+
+static void
+gst_leaks_tracer_finalize (GObject * object)
+{
+  GstLeaksTracer *self = (GstLeaksTracer *) object;
+
+  leaks_dump (self);
+
+  g_hash_table_unref (self->objects);
+  g_hash_table_unref (self->sites);
+  g_strfreev (self->types);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_leaks_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_leaks_tracer_class_init (GstLeaksTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_leaks_tracer_finalize;
+
+  tracer_class->pad_push_event_pre = leaks_push_event_pre;
+  tracer_class->mini_object_created = leaks_object_created;
+  tracer_class->mini_object_destroyed = leaks_object_destroyed;
+  tracer_class->report = leaks_report;
+}
+
+static void
+gst_leaks_tracer_init (GstLeaksTracer * self)
+{
+  const gchar *env;
+
+  g_mutex_init (&self->lock);
+  self->sites = g_hash_table_new_full ((GHashFunc) leaks_site_hash,
+      (GEqualFunc) leaks_site_equal, (GDestroyNotify) leaks_site_free, NULL);
+  self->objects = g_hash_table_new (NULL, NULL);
+
+  env = g_getenv ("GST_LEAKS_SAMPLE");
+  self->sample = env ? MAX (1, (guint) g_ascii_strtoull (env, NULL, 10)) : 1;
+
+  env = g_getenv ("GST_LEAKS_TYPES");
+  if (env && *env)
+    self->types = g_strsplit_set (env, ",;", -1);
+}
+
+/* watchdog: warns about chain, push and getrange calls and task iterations
+ * that take longer than GST_WATCHDOG_THRESHOLD milliseconds. Every thread
+ * keeps its calls in progress, a separate thread checks them and posts a
+ * warning message on the bus of the element of the slowest call while it is
+ * still blocked. When GST_WATCHDOG_STACK is set the stacks of all threads
+ * are also printed with gdb.
+ *
+ * The time that a thread waits on the clock, or that a sink waits in PAUSED
+ * after it prerolled, is not counted: the thread is blocked because it
+ * should be. */
+
+#define WATCHDOG_DEFAULT_THRESHOLD 1000
+
+typedef struct
+{
+  /* a pad, a task or the clock that is waited on */
+  GstObject *object;
+  GstClockTime start;
+  gboolean reported;
+} GstWatchdogFrame;
+
+/* the calls in progress of one thread */
+typedef struct
+{
+  GMutex lock;
+  GThread *thread;
+  GArray *frames;
+  /* the element that pushes from the current task, owns a ref */
+  GstElement *task_element;
+} GstWatchdogThread;
+
+typedef struct
+{
+  GstTracer parent;
+
+  GstClockTime threshold;
+  gboolean dump_stack;
+
+  GMutex lock;
+  GCond cond;
+  gboolean running;
+  GThread *monitor;
+} GstWatchdogTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstWatchdogTracerClass;
+
+/* all GstWatchdogThread, they stay around until their thread exits */
+static GMutex watchdog_lock;
+static GList *watchdog_threads = NULL;
+
+static void watchdog_thread_free (GstWatchdogThread * wt);
+static GPrivate watchdog_key = G_PRIVATE_INIT ((GDestroyNotify)
+    watchdog_thread_free);
+
+G_GNUC_INTERNAL GType gst_watchdog_tracer_get_type (void);
+G_DEFINE_TYPE (GstWatchdogTracer, gst_watchdog_tracer, GST_TYPE_TRACER);
+
+static void
+watchdog_thread_free (GstWatchdogThread * wt)
+{
+  g_mutex_lock (&watchdog_lock);
+  watchdog_threads = g_list_remove (watchdog_threads, wt);
+  g_mutex_unlock (&watchdog_lock);
+
+  if (wt->task_element)
+    gst_object_unref (wt->task_element);
+  g_array_free (wt->frames, TRUE);
+  g_mutex_clear (&wt->lock);
+  g_slice_free (GstWatchdogThread, wt);
+}
+
+static GstWatchdogThread *
+watchdog_thread_get (void)
+{
+  GstWatchdogThread *wt;
+
+  wt = g_private_get (&watchdog_key);
+  if (G_UNLIKELY (wt == NULL)) {
+    wt = g_slice_new0 (GstWatchdogThread);
+    g_mutex_init (&wt->lock);
+    wt->thread = g_thread_self ();
+    wt->frames = g_array_new (FALSE, FALSE, sizeof (GstWatchdogFrame));
+    g_private_set (&watchdog_key, wt);
+
+    g_mutex_lock (&watchdog_lock);
+    watchdog_threads = g_list_prepend (watchdog_threads, wt);
+    g_mutex_unlock (&watchdog_lock);
+  }
+  return wt;
+}
+
+static void
+watchdog_enter (GstObject * object, GstClockTime ts)
+{
+  GstWatchdogThread *wt = watchdog_thread_get ();
+  GstWatchdogFrame frame = { object, ts, FALSE };
+
+  g_mutex_lock (&wt->lock);
+  g_array_append_val (wt->frames, frame);
+  g_mutex_unlock (&wt->lock);
+}
+
+/* called with the lock of @wt, the time until @start doesn't count for the
+ * calls in progress */
+static void
+watchdog_restart_frames (GstWatchdogThread * wt, GstClockTime start)
+{
+  guint i;
+
+  for (i = 0; i < wt->frames->len; i++) {
+    GstWatchdogFrame *frame = &g_array_index (wt->frames, GstWatchdogFrame, i);
+
+    frame->start = MAX (frame->start, start);
+  }
+}
+
+static void
+watchdog_leave (GstTracer * tracer, GstClockTime ts)
+{
+  GstWatchdogThread *wt = watchdog_thread_get ();
+  GstWatchdogFrame frame;
+
+  g_mutex_lock (&wt->lock);
+  /* the tracer was enabled while the call was in progress */
+  if (G_UNLIKELY (wt->frames->len == 0)) {
+    g_mutex_unlock (&wt->lock);
+    return;
+  }
+  frame = g_array_index (wt->frames, GstWatchdogFrame, wt->frames->len - 1);
+  g_array_set_size (wt->frames, wt->frames->len - 1);
+  /* the calls that waited on the clock start over when the wait ended */
+  if (GST_IS_CLOCK (frame.object))
+    watchdog_restart_frames (wt, ts);
+  g_mutex_unlock (&wt->lock);
+
+  if (GST_IS_CLOCK (frame.object))
+    return;
+
+  if (G_UNLIKELY (frame.reported))
+    GST_CAT_INFO_OBJECT (GST_CAT_TRACER, tracer, "thread %p: call of %s "
+        "returned after %" GST_TIME_FORMAT, wt->thread,
+        GST_OBJECT_NAME (frame.object), GST_TIME_ARGS (ts - frame.start));
+}
+
+static void
+watchdog_enter_pad (GstPad * pad, GstClockTime ts)
+{
+  GstWatchdogThread *wt = watchdog_thread_get ();
+
+  /* remember who pushes from the task for when the task function blocks
+   * before it reaches a pad */
+  if (G_UNLIKELY (wt->task_element == NULL && wt->frames->len == 1 &&
+          GST_IS_TASK (g_array_index (wt->frames, GstWatchdogFrame,
+                  0).object))) {
+    GstElement *element = gst_pad_get_parent_element (pad);
+
+    g_mutex_lock (&wt->lock);
+    wt->task_element = element;
+    g_mutex_unlock (&wt->lock);
+  }
+
+  watchdog_enter (GST_OBJECT_CAST (pad), ts);
+}
+
+static void
+watchdog_push_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  watchdog_enter_pad (pad, ts);
+}
+
+static void
+watchdog_push_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  watchdog_enter_pad (pad, ts);
+}
+
+static void
+watchdog_chain_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  watchdog_enter_pad (pad, ts);
+}
+
+static void
+watchdog_chain_list_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBufferList * list)
+{
+  watchdog_enter_pad (pad, ts);
+}
+
+static void
+watchdog_pull_range_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    guint64 offset, guint size)
+{
+  watchdog_enter_pad (pad, ts);
+}
+
+static void
+watchdog_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  watchdog_leave (tracer, ts);
+}
+
+static void
+watchdog_pull_range_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer, GstFlowReturn res)
+{
+  watchdog_leave (tracer, ts);
+}
+
+static void
+watchdog_iteration_pre (GstTracer * tracer, GstClockTime ts, GstTask * task)
+{
+  watchdog_enter (GST_OBJECT_CAST (task), ts);
+}
+
+static void
+watchdog_iteration_post (GstTracer * tracer, GstClockTime ts, GstTask * task)
+{
+  watchdog_leave (tracer, ts);
+}
+
+static void
+watchdog_clock_wait_pre (GstTracer * tracer, GstClockTime ts,
+    GstClock * clock, GstClockID id)
+{
+  watchdog_enter (GST_OBJECT_CAST (clock), ts);
+}
+
+static void
+watchdog_clock_wait_post (GstTracer * tracer, GstClockTime ts,
+    GstClock * clock, GstClockReturn res)
+{
+  watchdog_leave (tracer, ts);
+}
+
+static void
+watchdog_task_stop (GstTracer * tracer, GstClockTime ts, GstTask * task)
+{
+  GstWatchdogThread *wt = watchdog_thread_get ();
+  GstElement *element;
+
+  g_mutex_lock (&wt->lock);
+  element = wt->task_element;
+  wt->task_element = NULL;
+  g_mutex_unlock (&wt->lock);
+
+  if (element)
+    gst_object_unref (element);
+}
+
+/* a slow call found by the monitor, reported without holding any lock */
+typedef struct
+{
+  GThread *thread;
+  GstElement *element;
+  gchar *name;
+  GstClockTime blocked;
+} GstWatchdogStall;
+
+/* called with the lock of @wt, returns the innermost call when it is slow
+ * and wasn't reported yet */
+static GstWatchdogStall *
+watchdog_check_thread (GstWatchdogTracer * self, GstWatchdogThread * wt,
+    GstClockTime now)
+{
+  GstWatchdogFrame *frame;
+  GstWatchdogStall *stall;
+  guint i;
+
+  if (wt->frames->len == 0)
+    return NULL;
+
+  /* the innermost call is the one that blocks, the others wait for it */
+  frame = &g_array_index (wt->frames, GstWatchdogFrame, wt->frames->len - 1);
+  if (frame->reported || now - frame->start < self->threshold)
+    return NULL;
+
+  /* waiting on the clock is not a stall */
+  if (GST_IS_CLOCK (frame->object))
+    return NULL;
+
+  /* neither is a prerolled sink that waits for PLAYING, the time spent
+   * waiting is not counted when the thread continues. The state is read
+   * without the lock of the element, the streaming thread can hold it. */
+  if (GST_IS_PAD (frame->object) && GST_PAD_IS_SINK (frame->object)) {
+    GstObject *parent = GST_OBJECT_PARENT (frame->object);
+
+    if (parent && GST_IS_ELEMENT (parent) &&
+        GST_OBJECT_FLAG_IS_SET (parent, GST_ELEMENT_FLAG_SINK) &&
+        GST_STATE (parent) == GST_STATE_PAUSED) {
+      watchdog_restart_frames (wt, now);
+      return NULL;
+    }
+  }
+
+  for (i = 0; i < wt->frames->len; i++)
+    g_array_index (wt->frames, GstWatchdogFrame, i).reported = TRUE;
+
+  stall = g_slice_new0 (GstWatchdogStall);
+  stall->thread = wt->thread;
+  stall->blocked = now - frame->start;
+  if (GST_IS_PAD (frame->object)) {
+    stall->name = g_strdup_printf ("%s:%s",
+        GST_DEBUG_PAD_NAME (frame->object));
+    stall->element =
+        gst_pad_get_parent_element (GST_PAD_CAST (frame->object));
+  } else {
+    stall->name = g_strdup_printf ("task %s", GST_OBJECT_NAME (frame->object));
+    if (wt->task_element)
+      stall->element = gst_object_ref (wt->task_element);
+  }
+
+  return stall;
+}
+
+static void
+watchdog_report_stall (GstWatchdogTracer * self, GstWatchdogStall * stall)
+{
+  GST_CAT_WARNING_OBJECT (GST_CAT_TRACER, self, "thread %p blocked in %s "
+      "for %" GST_TIME_FORMAT, stall->thread, stall->name,
+      GST_TIME_ARGS (stall->blocked));
+
+  if (stall->element) {
+    GError *error;
+    gchar *debug;
+
+    error = g_error_new (GST_CORE_ERROR, GST_CORE_ERROR_THREAD,
+        "Streaming thread blocked for %" G_GUINT64_FORMAT " ms",
+        stall->blocked / GST_MSECOND);
+    debug = g_strdup_printf ("%s, thread %p, threshold %" G_GUINT64_FORMAT
+        " ms", stall->name, stall->thread, self->threshold / GST_MSECOND);
+    gst_element_post_message (stall->element,
+        gst_message_new_warning (GST_OBJECT_CAST (stall->element), error,
+            debug));
+    g_error_free (error);
+    g_free (debug);
+    gst_object_unref (stall->element);
+  }
+  g_free (stall->name);
+  g_slice_free (GstWatchdogStall, stall);
+}
+
+static gpointer
+watchdog_monitor (GstWatchdogTracer * self)
+{
+  GstClockTime interval;
+
+  /* a stall is noticed at most a quarter of the threshold too late */
+  interval = MAX (self->threshold / 4, 10 * GST_MSECOND);
+
+  g_mutex_lock (&self->lock);
+  while (self->running) {
+    GstClockTime now;
+    GList *walk, *stalls = NULL;
+
+    g_cond_wait_until (&self->cond, &self->lock,
+        g_get_monotonic_time () + interval / GST_USECOND);
+    if (!self->running)
+      break;
+    g_mutex_unlock (&self->lock);
+
+    now = gst_util_get_timestamp ();
+    g_mutex_lock (&watchdog_lock);
+    for (walk = watchdog_threads; walk; walk = g_list_next (walk)) {
+      GstWatchdogThread *wt = walk->data;
+      GstWatchdogStall *stall;
+
+      g_mutex_lock (&wt->lock);
+      stall = watchdog_check_thread (self, wt, now);
+      g_mutex_unlock (&wt->lock);
+
+      if (stall)
+        stalls = g_list_prepend (stalls, stall);
+    }
+    g_mutex_unlock (&watchdog_lock);
+
+    /* the bus handlers can do anything, post without our locks */
+    for (walk = stalls; walk; walk = g_list_next (walk))
+      watchdog_report_stall (self, walk->data);
+
+#ifdef G_OS_UNIX
+    if (stalls && self->dump_stack && g_get_prgname ())
+      g_on_error_stack_trace (g_get_prgname ());
+#endif
+    g_list_free (stalls);
+
+    g_mutex_lock (&self->lock);
+  }
+  g_mutex_unlock (&self->lock);
+
+  return NULL;
+}
+
+static void
+gst_watchdog_tracer_finalize (GObject * object)
+{
+  GstWatchdogTracer *self = (GstWatchdogTracer *) object;
+
+  g_mutex_lock (&self->lock);
+  self->running = FALSE;
+  g_cond_signal (&self->cond);
+  g_mutex_unlock (&self->lock);
+  g_thread_join (self->monitor);
+
+  g_cond_clear (&self->cond);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (gst_watchdog_tracer_parent_class)->finalize (object);
+}
+
+static void
+gst_watchdog_tracer_class_init (GstWatchdogTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  gobject_class->finalize = gst_watchdog_tracer_finalize;
+
+  tracer_class->pad_push_pre = watchdog_push_pre;
+  tracer_class->pad_push_list_pre = watchdog_push_list_pre;
+  tracer_class->pad_push_post = watchdog_post;
+  tracer_class->pad_chain_pre = watchdog_chain_pre;
+  tracer_class->pad_chain_list_pre = watchdog_chain_list_pre;
+  tracer_class->pad_chain_post = watchdog_post;
+  tracer_class->pad_pull_range_pre = watchdog_pull_range_pre;
+  tracer_class->pad_pull_range_post = watchdog_pull_range_post;
+  tracer_class->task_stop = watchdog_task_stop;
+  tracer_class->task_iteration_pre = watchdog_iteration_pre;
+  tracer_class->task_iteration_post = watchdog_iteration_post;
+  tracer_class->clock_wait_pre = watchdog_clock_wait_pre;
+  tracer_class->clock_wait_post = watchdog_clock_wait_post;
+}
+
+static void
+gst_watchdog_tracer_init (GstWatchdogTracer * self)
+{
+  const gchar *env;
+  guint threshold = WATCHDOG_DEFAULT_THRESHOLD;
+
+  env = g_getenv ("GST_WATCHDOG_THRESHOLD");
+  if (env && *env)
+    threshold = MAX (1, (guint) g_ascii_strtoull (env, NULL, 10));
+  self->threshold = threshold * GST_MSECOND;
+
+  env = g_getenv ("GST_WATCHDOG_STACK");
+  self->dump_stack = env != NULL && *env != '\0' && strcmp (env, "0") != 0;
+
+  g_mutex_init (&self->lock);
+  g_cond_init (&self->cond);
+  self->running = TRUE;
+  self->monitor = g_thread_new ("GstWatchdog",
+      (GThreadFunc) watchdog_monitor, self);
+}
+
+void
+_priv_gst_tracers_register_core (void)
+{
+  gst_tracer_register ("proctime", gst_proc_time_tracer_get_type ());
+  gst_tracer_register ("latency", gst_latency_tracer_get_type ());
+  gst_tracer_register ("rate", gst_rate_tracer_get_type ());
+  gst_tracer_register ("queuelevel", gst_queue_level_tracer_get_type ());
+  gst_tracer_register ("timeline", gst_timeline_tracer_get_type ());
+  gst_tracer_register ("leaks", gst_leaks_tracer_get_type ());
+  gst_tracer_register ("watchdog", gst_watchdog_tracer_get_type ());
+}
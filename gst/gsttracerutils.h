@@ -0,0 +1,119 @@
+/* GStreamer
+ *
+ * gsttracerutils.h: tracing hooks for the core
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_TRACER_UTILS_H__
+#define __GST_TRACER_UTILS_H__
+
+#include <glib.h>
+#include <gst/gstconfig.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL void _priv_gst_tracer_init (void);
+G_GNUC_INTERNAL void _priv_gst_tracer_deinit (void);
+
+/* lets the active tracers append what they know about @object to @str */
+G_GNUC_INTERNAL void _priv_gst_tracer_describe (GstObject * object, GString * str);
+
+/* registers the tracers that are part of the core, see gsttracers.c */
+G_GNUC_INTERNAL void _priv_gst_tracers_register_core (void);
+
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+
+/* the hooks only cost a check of this flag when no tracer is active */
+extern gboolean _priv_tracer_enabled;
+
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_push_pre (GstPad * pad, GstBuffer * buffer);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_push_list_pre (GstPad * pad, GstBufferList * list);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_push_post (GstPad * pad, GstFlowReturn res);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_chain_pre (GstPad * pad, GstBuffer * buffer);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_chain_list_pre (GstPad * pad, GstBufferList * list);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_chain_post (GstPad * pad, GstFlowReturn res);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_pull_range_pre (GstPad * pad, guint64 offset, guint size);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_pull_range_post (GstPad * pad, GstBuffer * buffer, GstFlowReturn res);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_push_event_pre (GstPad * pad, GstEvent * event);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_push_event_post (GstPad * pad, gboolean res);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_query_pre (GstPad * pad, GstQuery * query);
+G_GNUC_INTERNAL void _priv_gst_tracer_pad_query_post (GstPad * pad, GstQuery * query, gboolean res);
+G_GNUC_INTERNAL void _priv_gst_tracer_task_start (GstTask * task);
+G_GNUC_INTERNAL void _priv_gst_tracer_task_stop (GstTask * task);
+G_GNUC_INTERNAL void _priv_gst_tracer_task_iteration_pre (GstTask * task);
+G_GNUC_INTERNAL void _priv_gst_tracer_task_iteration_post (GstTask * task);
+G_GNUC_INTERNAL void _priv_gst_tracer_clock_wait_pre (GstClock * clock, GstClockID id);
+G_GNUC_INTERNAL void _priv_gst_tracer_clock_wait_post (GstClock * clock, GstClockReturn res);
+G_GNUC_INTERNAL void _priv_gst_tracer_mini_object_created (GstMiniObject * object);
+G_GNUC_INTERNAL void _priv_gst_tracer_mini_object_destroyed (GstMiniObject * object);
+
+#define GST_TRACER_HOOK(hook,args) G_STMT_START {       \
+  if (G_UNLIKELY (_priv_tracer_enabled))                \
+    _priv_gst_tracer_ ## hook args;                     \
+} G_STMT_END
+
+#else /* GST_DISABLE_GST_TRACER_HOOKS */
+
+#define GST_TRACER_HOOK(hook,args) G_STMT_START { } G_STMT_END
+
+#endif /* GST_DISABLE_GST_TRACER_HOOKS */
+
+#define GST_TRACER_PAD_PUSH_PRE(pad,buffer) \
+    GST_TRACER_HOOK (pad_push_pre, (pad, buffer))
+#define GST_TRACER_PAD_PUSH_LIST_PRE(pad,list) \
+    GST_TRACER_HOOK (pad_push_list_pre, (pad, list))
+#define GST_TRACER_PAD_PUSH_POST(pad,res) \
+    GST_TRACER_HOOK (pad_push_post, (pad, res))
+#define GST_TRACER_PAD_CHAIN_PRE(pad,buffer) \
+    GST_TRACER_HOOK (pad_chain_pre, (pad, buffer))
+#define GST_TRACER_PAD_CHAIN_LIST_PRE(pad,list) \
+    GST_TRACER_HOOK (pad_chain_list_pre, (pad, list))
+#define GST_TRACER_PAD_CHAIN_POST(pad,res) \
+    GST_TRACER_HOOK (pad_chain_post, (pad, res))
+#define GST_TRACER_PAD_PULL_RANGE_PRE(pad,offset,size) \
+    GST_TRACER_HOOK (pad_pull_range_pre, (pad, offset, size))
+#define GST_TRACER_PAD_PULL_RANGE_POST(pad,buffer,res) \
+    GST_TRACER_HOOK (pad_pull_range_post, (pad, buffer, res))
+#define GST_TRACER_PAD_PUSH_EVENT_PRE(pad,event) \
+    GST_TRACER_HOOK (pad_push_event_pre, (pad, event))
+#define GST_TRACER_PAD_PUSH_EVENT_POST(pad,res) \
+    GST_TRACER_HOOK (pad_push_event_post, (pad, res))
+#define GST_TRACER_PAD_QUERY_PRE(pad,query) \
+    GST_TRACER_HOOK (pad_query_pre, (pad, query))
+#define GST_TRACER_PAD_QUERY_POST(pad,query,res) \
+    GST_TRACER_HOOK (pad_query_post, (pad, query, res))
+#define GST_TRACER_TASK_START(task) \
+    GST_TRACER_HOOK (task_start, (task))
+#define GST_TRACER_TASK_STOP(task) \
+    GST_TRACER_HOOK (task_stop, (task))
+#define GST_TRACER_TASK_ITERATION_PRE(task) \
+    GST_TRACER_HOOK (task_iteration_pre, (task))
+#define GST_TRACER_TASK_ITERATION_POST(task) \
+    GST_TRACER_HOOK (task_iteration_post, (task))
+#define GST_TRACER_CLOCK_WAIT_PRE(clock,id) \
+    GST_TRACER_HOOK (clock_wait_pre, (clock, id))
+#define GST_TRACER_CLOCK_WAIT_POST(clock,res) \
+    GST_TRACER_HOOK (clock_wait_post, (clock, res))
+#define GST_TRACER_MINI_OBJECT_CREATED(object) \
+    GST_TRACER_HOOK (mini_object_created, (object))
+#define GST_TRACER_MINI_OBJECT_DESTROYED(object) \
+    GST_TRACER_HOOK (mini_object_destroyed, (object))
+
+G_END_DECLS
+
+#endif /* __GST_TRACER_UTILS_H__ */
@@ -413,6 +413,10 @@ gst_util_uint64_scale_uint64_unchecked (guint64 val, guint64 num,
   /* perform rounding correction */
   tmp += correct;
 
+  /* the 64-bit division is a lot cheaper than the 128-bit one */
+  if (G_LIKELY ((tmp >> 64) == 0))
+    return ((guint64) tmp) / denom;
+
   /* Divide by denom */
   tmp /= denom;
 
@@ -484,6 +488,10 @@ _gst_util_uint64_scale (guint64 val, guint64 num, guint64 denom,
   if (G_UNLIKELY (num == denom))
     return val;
 
+  /* everything is low --> the product and the correction fit in 64 bits */
+  if (G_LIKELY ((val | num | denom) <= G_MAXUINT32))
+    return (val * num + correct) / denom;
+
   /* on 64bits we always use a full 128bits multiply/division */
 #if !defined (__x86_64__) && !defined (HAVE_UINT128_T)
   /* denom is low --> try to use 96 bit muldiv */
@@ -684,6 +692,84 @@ gst_util_uint64_scale_int_ceil (guint64 val, gint num, gint denom)
   return _gst_util_uint64_scale_int (val, num, denom, denom - 1);
 }
 
+/* the guts of the gst_util_uint64_scale_array() variants */
+static void
+_gst_util_uint64_scale_array (guint64 * vals, guint n_vals, guint64 num,
+    guint64 denom, guint64 correct)
+{
+  guint i;
+
+  g_return_if_fail (vals != NULL || n_vals == 0);
+  g_return_if_fail (denom != 0);
+
+  if (G_UNLIKELY (num == denom))
+    return;
+
+  /* decide on the 64-bit path once for the whole array */
+  if ((num | denom) <= G_MAXUINT32) {
+    for (i = 0; i < n_vals; i++) {
+      guint64 val = vals[i];
+
+      if (G_UNLIKELY (val == G_MAXUINT64))
+        continue;
+      if (G_LIKELY (val <= G_MAXUINT32))
+        vals[i] = (val * num + correct) / denom;
+      else
+        vals[i] = _gst_util_uint64_scale (val, num, denom, correct);
+    }
+  } else {
+    for (i = 0; i < n_vals; i++) {
+      if (G_UNLIKELY (vals[i] == G_MAXUINT64))
+        continue;
+      vals[i] = _gst_util_uint64_scale (vals[i], num, denom, correct);
+    }
+  }
+}
+
+/**
+ * gst_util_uint64_scale_array:
+ * @vals: (array length=n_vals): the numbers to scale
+ * @n_vals: the number of values in @vals
+ * @num: the numerator of the scale ratio
+ * @denom: the denominator of the scale ratio
+ *
+ * Scale all values of @vals in place by the rational number @num / @denom,
+ * like gst_util_uint64_scale() does for one value. This is faster than
+ * scaling the values one by one, for example for the timestamps of the
+ * buffers in a #GstBufferList.
+ *
+ * Values that are G_MAXUINT64, such as #GST_CLOCK_TIME_NONE, are left
+ * untouched so that invalid timestamps stay invalid.
+ *
+ * Since: 1.2
+ */
+void
+gst_util_uint64_scale_array (guint64 * vals, guint n_vals, guint64 num,
+    guint64 denom)
+{
+  _gst_util_uint64_scale_array (vals, n_vals, num, denom, 0);
+}
+
+/**
+ * gst_util_uint64_scale_array_round:
+ * @vals: (array length=n_vals): the numbers to scale
+ * @n_vals: the number of values in @vals
+ * @num: the numerator of the scale ratio
+ * @denom: the denominator of the scale ratio
+ *
+ * Scale all values of @vals in place by the rational number @num / @denom,
+ * like gst_util_uint64_scale_round() does for one value. See also
+ * gst_util_uint64_scale_array().
+ *
+ * Since: 1.2
+ */
+void
+gst_util_uint64_scale_array_round (guint64 * vals, guint n_vals, guint64 num,
+    guint64 denom)
+{
+  _gst_util_uint64_scale_array (vals, n_vals, num, denom, denom >> 1);
+}
+
 /**
  * gst_util_seqnum_next:
  *
@@ -2512,7 +2598,7 @@ gst_pad_proxy_query_caps (GstPad * pad, GstQuery * query)
 
   /* value to hold the return, by default it holds the filter or ANY */
   gst_query_parse_caps (query, &filter);
-  data.ret = filter ? gst_caps_ref (filter) : gst_caps_new_any ();
+  data.ret = gst_caps_ref (filter ? filter : GST_CAPS_ANY);
 
   gst_pad_forward (pad, (GstPadForwardFunction) query_caps_func, &data);
 
@@ -2756,7 +2842,7 @@ gst_pad_query_caps (GstPad * pad, GstCaps * filter)
   } else if (filter) {
     result = gst_caps_ref (filter);
   } else {
-    result = gst_caps_new_any ();
+    result = gst_caps_ref (GST_CAPS_ANY);
   }
   gst_query_unref (query);
 
@@ -2802,7 +2888,7 @@ gst_pad_peer_query_caps (GstPad * pad, GstCaps * filter)
   } else if (filter) {
     result = gst_caps_ref (filter);
   } else {
-    result = gst_caps_new_any ();
+    result = gst_caps_ref (GST_CAPS_ANY);
   }
   gst_query_unref (query);
 
@@ -2982,6 +3068,241 @@ gst_bin_find_unlinked_pad (GstBin * bin, GstPadDirection direction)
   return pad;
 }
 
+/* returns a list with a ref to each child, in the order they were added */
+static GList *
+bin_get_children (GstBin * bin)
+{
+  GList *children = NULL, *walk;
+
+  GST_OBJECT_LOCK (bin);
+  for (walk = bin->children; walk; walk = walk->next)
+    children = g_list_prepend (children, gst_object_ref (walk->data));
+  GST_OBJECT_UNLOCK (bin);
+
+  return children;
+}
+
+static GList *
+element_get_pads (GstElement * element, GstPadDirection direction)
+{
+  GList *pads = NULL, *walk;
+
+  GST_OBJECT_LOCK (element);
+  walk = direction == GST_PAD_SRC ? element->srcpads : element->pads;
+  for (; walk; walk = walk->next) {
+    if (direction == GST_PAD_UNKNOWN
+        || GST_PAD_DIRECTION (walk->data) == direction)
+      pads = g_list_prepend (pads, gst_object_ref (walk->data));
+  }
+  GST_OBJECT_UNLOCK (element);
+
+  return pads;
+}
+
+static GstElement *element_clone (GstElement * element, const gchar * name);
+
+/* links the clones the same way as the originals are linked inside the bin
+ * and ghosts the same pads of the clones */
+static gboolean
+bin_clone_links (GstBin * bin, GstBin * clone, GHashTable * clones)
+{
+  GList *children, *pads, *walk, *pwalk;
+  gboolean res = TRUE;
+
+  children = bin_get_children (bin);
+  for (walk = children; walk && res; walk = walk->next) {
+    GstElement *child = walk->data;
+
+    pads = element_get_pads (child, GST_PAD_SRC);
+    for (pwalk = pads; pwalk && res; pwalk = pwalk->next) {
+      GstPad *pad = pwalk->data, *peer;
+      GstElement *peer_element, *src, *sink;
+
+      if ((peer = gst_pad_get_peer (pad)) == NULL)
+        continue;
+
+      /* pads linked to the outside of the bin or to a ghostpad are not
+       * linked here */
+      peer_element = gst_pad_get_parent_element (peer);
+      if (peer_element) {
+        src = g_hash_table_lookup (clones, child);
+        sink = g_hash_table_lookup (clones, peer_element);
+        if (sink)
+          res = gst_element_link_pads_full (src, GST_PAD_NAME (pad), sink,
+              GST_PAD_NAME (peer), GST_PAD_LINK_CHECK_NOTHING);
+        gst_object_unref (peer_element);
+      }
+      gst_object_unref (peer);
+    }
+    g_list_free_full (pads, (GDestroyNotify) gst_object_unref);
+  }
+  g_list_free_full (children, (GDestroyNotify) gst_object_unref);
+
+  pads = element_get_pads (GST_ELEMENT_CAST (bin), GST_PAD_UNKNOWN);
+  for (pwalk = pads; pwalk && res; pwalk = pwalk->next) {
+    GstPad *pad = pwalk->data, *target, *clone_target = NULL, *ghost;
+    GstElement *target_element, *target_clone;
+
+    if (!GST_IS_GHOST_PAD (pad))
+      continue;
+
+    target = gst_ghost_pad_get_target (GST_GHOST_PAD_CAST (pad));
+    if (target == NULL) {
+      ghost = gst_ghost_pad_new_no_target (GST_PAD_NAME (pad),
+          GST_PAD_DIRECTION (pad));
+    } else {
+      target_element = gst_pad_get_parent_element (target);
+      target_clone = target_element ?
+          g_hash_table_lookup (clones, target_element) : NULL;
+      if (target_clone)
+        clone_target = gst_element_get_static_pad (target_clone,
+            GST_PAD_NAME (target));
+      if (target_clone && clone_target == NULL)
+        clone_target = gst_element_get_request_pad (target_clone,
+            GST_PAD_NAME (target));
+      ghost = clone_target ?
+          gst_ghost_pad_new (GST_PAD_NAME (pad), clone_target) : NULL;
+
+      if (clone_target)
+        gst_object_unref (clone_target);
+      if (target_element)
+        gst_object_unref (target_element);
+      gst_object_unref (target);
+    }
+
+    if (ghost == NULL
+        || !gst_element_add_pad (GST_ELEMENT_CAST (clone), ghost)) {
+      GST_CAT_WARNING_OBJECT (GST_CAT_ELEMENT_PADS, bin,
+          "could not clone ghostpad %s", GST_PAD_NAME (pad));
+      res = FALSE;
+    }
+  }
+  g_list_free_full (pads, (GDestroyNotify) gst_object_unref);
+
+  return res;
+}
+
+static gboolean
+bin_clone_children (GstBin * bin, GstBin * clone)
+{
+  GHashTable *clones;
+  GList *children, *walk;
+  gboolean res = TRUE;
+
+  clones = g_hash_table_new (NULL, NULL);
+
+  children = bin_get_children (bin);
+  for (walk = children; walk && res; walk = walk->next) {
+    GstElement *child = walk->data, *child_clone;
+
+    child_clone = element_clone (child, GST_OBJECT_NAME (child));
+    if (child_clone == NULL || !gst_bin_add (clone, child_clone)) {
+      res = FALSE;
+      break;
+    }
+    g_hash_table_insert (clones, child, child_clone);
+  }
+  g_list_free_full (children, (GDestroyNotify) gst_object_unref);
+
+  if (res)
+    res = bin_clone_links (bin, clone, clones);
+
+  g_hash_table_destroy (clones);
+
+  return res;
+}
+
+static GstElement *
+element_clone (GstElement * element, const gchar * name)
+{
+  GObjectClass *klass = G_OBJECT_GET_CLASS (element);
+  GParamSpec **specs;
+  GArray *params;
+  GstElement *clone;
+  guint i, n_specs;
+
+  /* only the properties that are not at their default value are passed, the
+   * others would be set to the same value by the construction anyway */
+  params = g_array_new (FALSE, TRUE, sizeof (GParameter));
+  specs = g_object_class_list_properties (klass, &n_specs);
+  for (i = 0; i < n_specs; i++) {
+    GParamSpec *spec = specs[i];
+    GParameter param = { NULL, G_VALUE_INIT };
+
+    if ((spec->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE)
+      continue;
+    if (spec->owner_type == GST_TYPE_OBJECT)
+      continue;
+
+    g_value_init (&param.value, G_PARAM_SPEC_VALUE_TYPE (spec));
+    g_object_get_property (G_OBJECT (element), spec->name, &param.value);
+    if (g_param_value_defaults (spec, &param.value)) {
+      g_value_unset (&param.value);
+      continue;
+    }
+    param.name = spec->name;
+    g_array_append_val (params, param);
+  }
+  g_free (specs);
+
+  if (name) {
+    GParameter param = { "name", G_VALUE_INIT };
+
+    g_value_init (&param.value, G_TYPE_STRING);
+    g_value_set_string (&param.value, name);
+    g_array_append_val (params, param);
+  }
+
+  clone = g_object_newv (G_OBJECT_TYPE (element), params->len,
+      (GParameter *) params->data);
+
+  for (i = 0; i < params->len; i++)
+    g_value_unset (&g_array_index (params, GParameter, i).value);
+  g_array_free (params, TRUE);
+
+  if (clone && GST_IS_BIN (element)
+      && !bin_clone_children (GST_BIN_CAST (element), GST_BIN_CAST (clone))) {
+    GST_CAT_WARNING_OBJECT (GST_CAT_PARENTAGE, element,
+        "could not clone the children");
+    gst_object_unref (clone);
+    clone = NULL;
+  }
+
+  return clone;
+}
+
+/**
+ * gst_element_clone:
+ * @element: a #GstElement
+ * @name: (allow-none): the name of the clone, or %NULL for a unique name
+ *
+ * Creates a new element of the same type as @element, with the same
+ * values for all its readable and writable properties. This avoids looking
+ * up the factory and parsing the properties again when many identical
+ * elements are needed.
+ *
+ * When @element is a #GstBin, its children are cloned recursively, keeping
+ * their names. The clones are linked in the same way as the children are
+ * linked inside the bin and the ghostpads of the bin are recreated on the
+ * clone. Pads that the elements only create when they are running are not
+ * cloned, the elements create them again when the clone is started.
+ *
+ * The clone is in the %GST_STATE_NULL state, the properties it shares with
+ * @element, such as caps, are shared by reference.
+ *
+ * Returns: (transfer floating): a new #GstElement or %NULL if @element or
+ *     one of its children could not be cloned.
+ *
+ * Since: 1.2
+ */
+GstElement *
+gst_element_clone (GstElement * element, const gchar * name)
+{
+  g_return_val_if_fail (GST_IS_ELEMENT (element), NULL);
+
+  return element_clone (element, name);
+}
+
 /**
  * gst_parse_bin_from_description:
  * @bin_description: command line describing the bin
@@ -72,6 +72,11 @@ guint64         gst_util_uint64_scale_int       (guint64 val, gint num, gint den
 guint64         gst_util_uint64_scale_int_round (guint64 val, gint num, gint denom);
 guint64         gst_util_uint64_scale_int_ceil  (guint64 val, gint num, gint denom);
 
+void            gst_util_uint64_scale_array       (guint64 *vals, guint n_vals,
+                                                   guint64 num, guint64 denom);
+void            gst_util_uint64_scale_array_round (guint64 *vals, guint n_vals,
+                                                   guint64 num, guint64 denom);
+
 guint32         gst_util_seqnum_next            (void);
 gint32          gst_util_seqnum_compare         (guint32 s1, guint32 s2);
 
@@ -826,6 +831,8 @@ GstPadTemplate*         gst_element_get_compatible_pad_template (GstElement *ele
 const gchar*            gst_element_state_get_name      (GstState state);
 const gchar *           gst_element_state_change_return_get_name (GstStateChangeReturn state_ret);
 
+GstElement *            gst_element_clone               (GstElement *element, const gchar *name);
+
 gboolean                gst_element_link                (GstElement *src, GstElement *dest);
 gboolean                gst_element_link_many           (GstElement *element_1,
                                                          GstElement *element_2, ...) G_GNUC_NULL_TERMINATED;
@@ -44,6 +44,7 @@
 #include <gst/gst.h>
 #include <gobject/gvaluecollector.h>
 #include "gstutils.h"
+#include "gstvaluebinary.h"
 
 /* GstValueUnionFunc:
  * @dest: a #GValue for the result
@@ -133,8 +134,31 @@ static GArray *gst_value_union_funcs;
 static GArray *gst_value_intersect_funcs;
 static GArray *gst_value_subtract_funcs;
 
+/* caches the position of the union, intersect and subtract functions for a
+ * pair of fundamental types so that the arrays only have to be searched once
+ * for each pair. An entry is 0 when the pair was not looked up yet,
+ * DISPATCH_NONE when there is no function for the pair and otherwise the
+ * index of the function + 1. DISPATCH_SWAPPED is set when the function takes
+ * the values in the reverse order. Types with a higher fundamental id than
+ * DISPATCH_TYPES are always searched. */
+#define DISPATCH_TYPES 64
+#define DISPATCH_NONE -1
+#define DISPATCH_SWAPPED (1 << 16)
+#define DISPATCH_INDEX(res) (((res) & (DISPATCH_SWAPPED - 1)) - 1)
+
+typedef gint GstValueDispatchTable[DISPATCH_TYPES][DISPATCH_TYPES];
+
+static GstValueDispatchTable gst_value_union_dispatch;
+static GstValueDispatchTable gst_value_intersect_dispatch;
+static GstValueDispatchTable gst_value_subtract_dispatch;
+
+/* for the fast paths */
+static GType gst_value_fraction_type;
+
 /* Forward declarations */
 static gchar *gst_value_serialize_fraction (const GValue * value);
+static gint gst_value_compare_fraction (const GValue * value1,
+    const GValue * value2);
 
 static GstValueCompareFunc gst_value_get_compare_func (const GValue * value1);
 static gint gst_value_compare_with_func (const GValue * value1,
@@ -4189,6 +4213,118 @@ gst_value_subtract_fraction_range_fraction_range (GValue * dest,
  * comparison *
  **************/
 
+/*
+ * dispatch
+ */
+
+static gint
+gst_value_find_union (GType type1, GType type2)
+{
+  GstValueUnionInfo *union_info;
+  guint i, len;
+
+  len = gst_value_union_funcs->len;
+  for (i = 0; i < len; i++) {
+    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+    if (union_info->type1 == type1 && union_info->type2 == type2)
+      return i + 1;
+    if (union_info->type1 == type2 && union_info->type2 == type1)
+      return (i + 1) | DISPATCH_SWAPPED;
+  }
+  return DISPATCH_NONE;
+}
+
+static gint
+gst_value_find_intersect (GType type1, GType type2)
+{
+  GstValueIntersectInfo *intersect_info;
+  guint i, len;
+
+  len = gst_value_intersect_funcs->len;
+  for (i = 0; i < len; i++) {
+    intersect_info = &g_array_index (gst_value_intersect_funcs,
+        GstValueIntersectInfo, i);
+    if (intersect_info->type1 == type1 && intersect_info->type2 == type2)
+      return i + 1;
+    if (intersect_info->type1 == type2 && intersect_info->type2 == type1)
+      return (i + 1) | DISPATCH_SWAPPED;
+  }
+  return DISPATCH_NONE;
+}
+
+static gint
+gst_value_find_subtract (GType mtype, GType stype)
+{
+  GstValueSubtractInfo *info;
+  guint i, len;
+
+  len = gst_value_subtract_funcs->len;
+  for (i = 0; i < len; i++) {
+    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+    if (info->minuend == mtype && info->subtrahend == stype)
+      return i + 1;
+  }
+  return DISPATCH_NONE;
+}
+
+/* looks up the function for @type1 and @type2 in @table and fills in the
+ * entry with @find on the first use */
+static inline gint
+gst_value_dispatch (GstValueDispatchTable table,
+    gint (*find) (GType type1, GType type2), GType type1, GType type2)
+{
+  gint *entry = NULL;
+  gint res;
+
+  if (G_LIKELY (G_TYPE_IS_FUNDAMENTAL (type1)
+          && G_TYPE_IS_FUNDAMENTAL (type2)
+          && FUNDAMENTAL_TYPE_ID (type1) < DISPATCH_TYPES
+          && FUNDAMENTAL_TYPE_ID (type2) < DISPATCH_TYPES)) {
+    entry = &table[FUNDAMENTAL_TYPE_ID (type1)][FUNDAMENTAL_TYPE_ID (type2)];
+    res = g_atomic_int_get (entry);
+    if (G_LIKELY (res != 0))
+      return res;
+  }
+
+  /* all threads find the same value, no need to protect the update */
+  res = find (type1, type2);
+  if (entry)
+    g_atomic_int_set (entry, res);
+
+  return res;
+}
+
+/* compares values of the most common types without looking up the compare
+ * function, returns FALSE when there is no fast path for the values */
+static inline gboolean
+gst_value_compare_fast (const GValue * value1, const GValue * value2,
+    gint * res)
+{
+  GType type = G_VALUE_TYPE (value1);
+
+  if (type != G_VALUE_TYPE (value2))
+    return FALSE;
+
+  if (type == G_TYPE_INT) {
+    gint i1 = value1->data[0].v_int;
+    gint i2 = value2->data[0].v_int;
+
+    if (i1 > i2)
+      *res = GST_VALUE_GREATER_THAN;
+    else if (i1 < i2)
+      *res = GST_VALUE_LESS_THAN;
+    else
+      *res = GST_VALUE_EQUAL;
+  } else if (type == G_TYPE_STRING) {
+    *res = gst_value_compare_string (value1, value2);
+  } else if (type == gst_value_fraction_type) {
+    *res = gst_value_compare_fraction (value1, value2);
+  } else {
+    return FALSE;
+  }
+  return TRUE;
+}
+
 /*
  * gst_value_get_compare_func:
  * @value1: a value to get the compare function for
@@ -4323,10 +4459,14 @@ gst_value_compare (const GValue * value1, const GValue * value2)
 {
   GstValueCompareFunc compare;
   GType ltype;
+  gint res;
 
   g_return_val_if_fail (G_IS_VALUE (value1), GST_VALUE_LESS_THAN);
   g_return_val_if_fail (G_IS_VALUE (value2), GST_VALUE_GREATER_THAN);
 
+  if (gst_value_compare_fast (value1, value2, &res))
+    return res;
+
   /* Special cases: lists and scalar values ("{ 1 }" and "1" are equal),
      as well as lists and ranges ("{ 1, 2 }" and "[ 1, 2 ]" are equal) */
   ltype = gst_value_list_get_type ();
@@ -4409,25 +4549,11 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 gboolean
 gst_value_can_union (const GValue * value1, const GValue * value2)
 {
-  GstValueUnionInfo *union_info;
-  guint i, len;
-
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
-  len = gst_value_union_funcs->len;
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == G_VALUE_TYPE (value1) &&
-        union_info->type2 == G_VALUE_TYPE (value2))
-      return TRUE;
-    if (union_info->type1 == G_VALUE_TYPE (value2) &&
-        union_info->type2 == G_VALUE_TYPE (value1))
-      return TRUE;
-  }
-
-  return FALSE;
+  return gst_value_dispatch (gst_value_union_dispatch, gst_value_find_union,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2)) != DISPATCH_NONE;
 }
 
 /**
@@ -4444,8 +4570,7 @@ gboolean
 gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 {
   const GstValueUnionInfo *union_info;
-  guint i, len;
-  GType type1, type2;
+  gint res;
 
   g_return_val_if_fail (dest != NULL, FALSE);
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4453,18 +4578,14 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
   g_return_val_if_fail (gst_value_list_or_array_are_compatible (value1, value2),
       FALSE);
 
-  len = gst_value_union_funcs->len;
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == type1 && union_info->type2 == type2) {
-      return union_info->func (dest, value1, value2);
-    }
-    if (union_info->type1 == type2 && union_info->type2 == type1) {
+  res = gst_value_dispatch (gst_value_union_dispatch, gst_value_find_union,
+      G_VALUE_TYPE (value1), G_VALUE_TYPE (value2));
+  if (res != DISPATCH_NONE) {
+    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo,
+        DISPATCH_INDEX (res));
+    if (res & DISPATCH_SWAPPED)
       return union_info->func (dest, value2, value1);
-    }
+    return union_info->func (dest, value1, value2);
   }
 
   gst_value_list_concat (dest, value1, value2);
@@ -4493,6 +4614,7 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
   union_info.func = func;
 
   g_array_append_val (gst_value_union_funcs, union_info);
+  memset (gst_value_union_dispatch, 0, sizeof (gst_value_union_dispatch));
 }
 
 /* intersection */
@@ -4512,8 +4634,6 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 gboolean
 gst_value_can_intersect (const GValue * value1, const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
   GType ltype, type1, type2;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -4534,14 +4654,9 @@ gst_value_can_intersect (const GValue * value1, const GValue * value2)
     return TRUE;
 
   /* check registered intersect functions */
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if ((intersect_info->type1 == type1 && intersect_info->type2 == type2) ||
-        (intersect_info->type1 == type2 && intersect_info->type2 == type1))
-      return TRUE;
-  }
+  if (gst_value_dispatch (gst_value_intersect_dispatch,
+          gst_value_find_intersect, type1, type2) != DISPATCH_NONE)
+    return TRUE;
 
   return gst_value_can_compare (value1, value2);
 }
@@ -4565,12 +4680,21 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     const GValue * value2)
 {
   GstValueIntersectInfo *intersect_info;
-  guint i, len;
-  GType ltype, type1, type2;
+  GType ltype;
+  gint res;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
+  /* fixed values of the same type only intersect when they are equal */
+  if (gst_value_compare_fast (value1, value2, &res)) {
+    if (res != GST_VALUE_EQUAL)
+      return FALSE;
+    if (dest)
+      gst_value_init_and_copy (dest, value1);
+    return TRUE;
+  }
+
   ltype = gst_value_list_get_type ();
 
   /* special cases first */
@@ -4585,19 +4709,14 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     return TRUE;
   }
 
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
-
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
+  res = gst_value_dispatch (gst_value_intersect_dispatch,
+      gst_value_find_intersect, G_VALUE_TYPE (value1), G_VALUE_TYPE (value2));
+  if (res != DISPATCH_NONE) {
     intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
-      return intersect_info->func (dest, value1, value2);
-    }
-    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
+        GstValueIntersectInfo, DISPATCH_INDEX (res));
+    if (res & DISPATCH_SWAPPED)
       return intersect_info->func (dest, value2, value1);
-    }
+    return intersect_info->func (dest, value1, value2);
   }
   return FALSE;
 }
@@ -4628,6 +4747,8 @@ gst_value_register_intersect_func (GType type1, GType type2,
   intersect_info.func = func;
 
   g_array_append_val (gst_value_intersect_funcs, intersect_info);
+  memset (gst_value_intersect_dispatch, 0,
+      sizeof (gst_value_intersect_dispatch));
 }
 
 
@@ -4651,12 +4772,21 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
     const GValue * subtrahend)
 {
   GstValueSubtractInfo *info;
-  guint i, len;
-  GType ltype, mtype, stype;
+  GType ltype;
+  gint res;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
   g_return_val_if_fail (G_IS_VALUE (subtrahend), FALSE);
 
+  /* fixed values of the same type are removed when they are equal */
+  if (gst_value_compare_fast (minuend, subtrahend, &res)) {
+    if (res == GST_VALUE_EQUAL)
+      return FALSE;
+    if (dest)
+      gst_value_init_and_copy (dest, minuend);
+    return TRUE;
+  }
+
   ltype = gst_value_list_get_type ();
 
   /* special cases first */
@@ -4665,15 +4795,13 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
   if (G_VALUE_HOLDS (subtrahend, ltype))
     return gst_value_subtract_list (dest, minuend, subtrahend);
 
-  mtype = G_VALUE_TYPE (minuend);
-  stype = G_VALUE_TYPE (subtrahend);
-
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype) {
-      return info->func (dest, minuend, subtrahend);
-    }
+  res = gst_value_dispatch (gst_value_subtract_dispatch,
+      gst_value_find_subtract, G_VALUE_TYPE (minuend),
+      G_VALUE_TYPE (subtrahend));
+  if (res != DISPATCH_NONE) {
+    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo,
+        DISPATCH_INDEX (res));
+    return info->func (dest, minuend, subtrahend);
   }
 
   if (gst_value_compare (minuend, subtrahend) != GST_VALUE_EQUAL) {
@@ -4711,9 +4839,7 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
 gboolean
 gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
-  GType ltype, mtype, stype;
+  GType ltype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
   g_return_val_if_fail (G_IS_VALUE (subtrahend), FALSE);
@@ -4724,15 +4850,10 @@ gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
   if (G_VALUE_HOLDS (minuend, ltype) || G_VALUE_HOLDS (subtrahend, ltype))
     return TRUE;
 
-  mtype = G_VALUE_TYPE (minuend);
-  stype = G_VALUE_TYPE (subtrahend);
-
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype)
-      return TRUE;
-  }
+  if (gst_value_dispatch (gst_value_subtract_dispatch,
+          gst_value_find_subtract, G_VALUE_TYPE (minuend),
+          G_VALUE_TYPE (subtrahend)) != DISPATCH_NONE)
+    return TRUE;
 
   return gst_value_can_compare (minuend, subtrahend);
 }
@@ -4766,6 +4887,8 @@ gst_value_register_subtract_func (GType minuend_type, GType subtrahend_type,
   info.func = func;
 
   g_array_append_val (gst_value_subtract_funcs, info);
+  memset (gst_value_subtract_dispatch, 0,
+      sizeof (gst_value_subtract_dispatch));
 }
 
 /**
@@ -4914,6 +5037,80 @@ gst_value_deserialize (GValue * dest, const gchar * src)
   return FALSE;
 }
 
+/**
+ * gst_value_serialize_binary:
+ * @value: a #GValue to serialize
+ * @size: (out) (allow-none): location for the size of the result
+ *
+ * Serializes @value into a compact binary form that can be turned back into
+ * a #GValue with gst_value_deserialize_binary(). This is a lot faster than
+ * gst_value_serialize() and gst_value_deserialize() for exchanging values
+ * between processes. The binary form is versioned and only meant to be
+ * read by the same GStreamer version. Values of types without a native
+ * binary form are stored with their string serialization.
+ *
+ * Free-function: g_free
+ *
+ * Returns: (transfer full) (array length=size): the binary form of @value,
+ *     or %NULL when @value can not be serialized.
+ *
+ * Since: 1.2
+ */
+guint8 *
+gst_value_serialize_binary (const GValue * value, gsize * size)
+{
+  GByteArray *out;
+  gboolean ok;
+
+  g_return_val_if_fail (G_IS_VALUE (value), NULL);
+
+  out = g_byte_array_new ();
+  _priv_gst_value_binary_write_header (out, GST_VALUE_BINARY_KIND_VALUE);
+  ok = _priv_gst_value_binary_write_value (out, value);
+
+  return _priv_gst_value_binary_finish (out, ok, size);
+}
+
+/**
+ * gst_value_deserialize_binary:
+ * @dest: (out caller-allocates): an uninitialized #GValue to fill
+ * @data: (array length=size): data created with gst_value_serialize_binary()
+ * @size: the size of @data
+ *
+ * Initializes @dest with the type and the contents of the value that was
+ * serialized into @data with gst_value_serialize_binary(). Enum, flags and
+ * other types referenced by the data need to be registered already.
+ *
+ * Returns: %TRUE on success, @dest is untouched otherwise.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_value_deserialize_binary (GValue * dest, const guint8 * data, gsize size)
+{
+  GstValueBinaryReader reader;
+  GValue value = { 0, };
+
+  g_return_val_if_fail (dest != NULL, FALSE);
+  g_return_val_if_fail (!G_IS_VALUE (dest), FALSE);
+  g_return_val_if_fail (data != NULL || size == 0, FALSE);
+
+  if (!_priv_gst_value_binary_read_header (&reader, data, size,
+          GST_VALUE_BINARY_KIND_VALUE))
+    return FALSE;
+
+  if (!_priv_gst_value_binary_read_value (&reader, &value))
+    return FALSE;
+
+  if (reader.pos != reader.size) {
+    g_value_unset (&value);
+    return FALSE;
+  }
+
+  *dest = value;
+  return TRUE;
+}
+
 /**
  * gst_value_is_fixed:
  * @value: the #GValue to check
@@ -5906,6 +6103,8 @@ _priv_gst_value_initialize (void)
   gst_value_subtract_funcs = g_array_new (FALSE, FALSE,
       sizeof (GstValueSubtractInfo));
 
+  gst_value_fraction_type = gst_fraction_get_type ();
+
   {
     static GstValueTable gst_value = {
       0,
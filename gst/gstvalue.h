@@ -406,6 +406,12 @@ gchar *         gst_value_serialize             (const GValue          *value) G
 gboolean        gst_value_deserialize           (GValue                *dest,
                                                  const gchar           *src);
 
+guint8 *        gst_value_serialize_binary      (const GValue          *value,
+                                                 gsize                 *size) G_GNUC_MALLOC;
+gboolean        gst_value_deserialize_binary    (GValue                *dest,
+                                                 const guint8          *data,
+                                                 gsize                  size);
+
 /* list */
 void            gst_value_list_append_value     (GValue         *value,
                                                  const GValue   *append_value);
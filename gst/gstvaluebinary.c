@@ -0,0 +1,948 @@
+/* GStreamer
+ *
+ * gstvaluebinary.c: binary serialization of values, structures and caps
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * The binary format is a compact alternative to the string serialization for
+ * exchanging values between processes running the same GStreamer version.
+ *
+ * Every top level object starts with the 5 byte header "GST", the format
+ * version and the kind of the object. Counts, lengths and unsigned integers
+ * are stored as LEB128 varints and signed integers are zigzag encoded before
+ * that, floating point numbers are stored as little endian IEEE values.
+ * Strings are stored as their length plus one followed by the bytes without
+ * the terminating NUL, a length of 0 means NULL.
+ *
+ * A value is a tag byte followed by the payload of its type. Enums and
+ * flags carry their type name, values of types without a native encoding
+ * carry their type name and the string serialization of the value.
+ * A structure is its name, the number of fields and the name and the value
+ * of every field. Caps are a flags varint, where bit 0 is ANY, followed by
+ * the number of structures and the structures.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gst_private.h"
+#include "gstvalue.h"
+#include "gstbuffer.h"
+#include "gstvaluebinary.h"
+
+/* nesting of lists, arrays, structures and caps that is accepted when
+ * reading, protects the stack against bad data */
+#define MAX_DEPTH 64
+
+enum
+{
+  TAG_BOOLEAN = 1,
+  TAG_CHAR,
+  TAG_UCHAR,
+  TAG_INT,
+  TAG_UINT,
+  TAG_LONG,
+  TAG_ULONG,
+  TAG_INT64,
+  TAG_UINT64,
+  TAG_FLOAT,
+  TAG_DOUBLE,
+  TAG_STRING,
+  TAG_ENUM,
+  TAG_FLAGS,
+  TAG_FRACTION,
+  TAG_INT_RANGE,
+  TAG_INT64_RANGE,
+  TAG_DOUBLE_RANGE,
+  TAG_FRACTION_RANGE,
+  TAG_BITMASK,
+  TAG_LIST,
+  TAG_ARRAY,
+  TAG_STRUCTURE,
+  TAG_CAPS,
+  TAG_BUFFER,
+  TAG_OTHER
+};
+
+static inline void
+write_byte (GByteArray * out, guint8 val)
+{
+  g_byte_array_append (out, &val, 1);
+}
+
+void
+_priv_gst_value_binary_write_uint (GByteArray * out, guint64 val)
+{
+  guint8 buf[10];
+  guint len = 0;
+
+  do {
+    buf[len] = val & 0x7f;
+    val >>= 7;
+    if (val)
+      buf[len] |= 0x80;
+    len++;
+  } while (val);
+
+  g_byte_array_append (out, buf, len);
+}
+
+static inline void
+write_int (GByteArray * out, gint64 val)
+{
+  _priv_gst_value_binary_write_uint (out,
+      ((guint64) val << 1) ^ (guint64) (val >> 63));
+}
+
+static void
+write_double (GByteArray * out, gdouble val)
+{
+  union
+  {
+    gdouble d;
+    guint64 i;
+  } u;
+
+  u.d = val;
+  u.i = GUINT64_TO_LE (u.i);
+  g_byte_array_append (out, (const guint8 *) &u.i, 8);
+}
+
+static void
+write_float (GByteArray * out, gfloat val)
+{
+  union
+  {
+    gfloat f;
+    guint32 i;
+  } u;
+
+  u.f = val;
+  u.i = GUINT32_TO_LE (u.i);
+  g_byte_array_append (out, (const guint8 *) &u.i, 4);
+}
+
+static void
+write_string (GByteArray * out, const gchar * str)
+{
+  gsize len;
+
+  if (str == NULL) {
+    _priv_gst_value_binary_write_uint (out, 0);
+    return;
+  }
+
+  len = strlen (str);
+  _priv_gst_value_binary_write_uint (out, len + 1);
+  g_byte_array_append (out, (const guint8 *) str, len);
+}
+
+void
+_priv_gst_value_binary_write_header (GByteArray * out, guint8 kind)
+{
+  g_byte_array_append (out, (const guint8 *) "GST", 3);
+  write_byte (out, GST_VALUE_BINARY_VERSION);
+  write_byte (out, kind);
+}
+
+static gboolean
+write_fraction (GByteArray * out, const GValue * value)
+{
+  write_int (out, gst_value_get_fraction_numerator (value));
+  write_int (out, gst_value_get_fraction_denominator (value));
+
+  return TRUE;
+}
+
+static gboolean
+write_array (GByteArray * out, const GValue * value, guint8 tag)
+{
+  guint i, size;
+
+  write_byte (out, tag);
+
+  if (tag == TAG_LIST)
+    size = gst_value_list_get_size (value);
+  else
+    size = gst_value_array_get_size (value);
+
+  _priv_gst_value_binary_write_uint (out, size);
+  for (i = 0; i < size; i++) {
+    const GValue *v;
+
+    if (tag == TAG_LIST)
+      v = gst_value_list_get_value (value, i);
+    else
+      v = gst_value_array_get_value (value, i);
+
+    if (!_priv_gst_value_binary_write_value (out, v))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+_priv_gst_value_binary_write_value (GByteArray * out, const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+
+  switch (G_TYPE_FUNDAMENTAL (type)) {
+    case G_TYPE_BOOLEAN:
+      write_byte (out, TAG_BOOLEAN);
+      write_byte (out, g_value_get_boolean (value) ? 1 : 0);
+      return TRUE;
+    case G_TYPE_CHAR:
+      write_byte (out, TAG_CHAR);
+      write_byte (out, (guint8) g_value_get_schar (value));
+      return TRUE;
+    case G_TYPE_UCHAR:
+      write_byte (out, TAG_UCHAR);
+      write_byte (out, g_value_get_uchar (value));
+      return TRUE;
+    case G_TYPE_INT:
+      write_byte (out, TAG_INT);
+      write_int (out, g_value_get_int (value));
+      return TRUE;
+    case G_TYPE_UINT:
+      write_byte (out, TAG_UINT);
+      _priv_gst_value_binary_write_uint (out, g_value_get_uint (value));
+      return TRUE;
+    case G_TYPE_LONG:
+      write_byte (out, TAG_LONG);
+      write_int (out, g_value_get_long (value));
+      return TRUE;
+    case G_TYPE_ULONG:
+      write_byte (out, TAG_ULONG);
+      _priv_gst_value_binary_write_uint (out, g_value_get_ulong (value));
+      return TRUE;
+    case G_TYPE_INT64:
+      write_byte (out, TAG_INT64);
+      write_int (out, g_value_get_int64 (value));
+      return TRUE;
+    case G_TYPE_UINT64:
+      write_byte (out, TAG_UINT64);
+      _priv_gst_value_binary_write_uint (out, g_value_get_uint64 (value));
+      return TRUE;
+    case G_TYPE_FLOAT:
+      write_byte (out, TAG_FLOAT);
+      write_float (out, g_value_get_float (value));
+      return TRUE;
+    case G_TYPE_DOUBLE:
+      write_byte (out, TAG_DOUBLE);
+      write_double (out, g_value_get_double (value));
+      return TRUE;
+    case G_TYPE_STRING:
+      write_byte (out, TAG_STRING);
+      write_string (out, g_value_get_string (value));
+      return TRUE;
+    case G_TYPE_ENUM:
+      write_byte (out, TAG_ENUM);
+      write_string (out, g_type_name (type));
+      write_int (out, g_value_get_enum (value));
+      return TRUE;
+    case G_TYPE_FLAGS:
+      write_byte (out, TAG_FLAGS);
+      write_string (out, g_type_name (type));
+      _priv_gst_value_binary_write_uint (out, g_value_get_flags (value));
+      return TRUE;
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_FRACTION) {
+    write_byte (out, TAG_FRACTION);
+    return write_fraction (out, value);
+  } else if (type == GST_TYPE_INT_RANGE) {
+    write_byte (out, TAG_INT_RANGE);
+    write_int (out, gst_value_get_int_range_min (value));
+    write_int (out, gst_value_get_int_range_max (value));
+    write_int (out, gst_value_get_int_range_step (value));
+    return TRUE;
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    write_byte (out, TAG_INT64_RANGE);
+    write_int (out, gst_value_get_int64_range_min (value));
+    write_int (out, gst_value_get_int64_range_max (value));
+    write_int (out, gst_value_get_int64_range_step (value));
+    return TRUE;
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    write_byte (out, TAG_DOUBLE_RANGE);
+    write_double (out, gst_value_get_double_range_min (value));
+    write_double (out, gst_value_get_double_range_max (value));
+    return TRUE;
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    write_byte (out, TAG_FRACTION_RANGE);
+    write_fraction (out, gst_value_get_fraction_range_min (value));
+    return write_fraction (out, gst_value_get_fraction_range_max (value));
+  } else if (type == GST_TYPE_BITMASK) {
+    write_byte (out, TAG_BITMASK);
+    _priv_gst_value_binary_write_uint (out, gst_value_get_bitmask (value));
+    return TRUE;
+  } else if (type == GST_TYPE_LIST) {
+    return write_array (out, value, TAG_LIST);
+  } else if (type == GST_TYPE_ARRAY) {
+    return write_array (out, value, TAG_ARRAY);
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    /* a NULL structure has no string form either */
+    if (s == NULL)
+      return FALSE;
+    write_byte (out, TAG_STRUCTURE);
+    return _priv_gst_value_binary_write_structure (out, s);
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    if (caps == NULL)
+      return FALSE;
+    write_byte (out, TAG_CAPS);
+    return _priv_gst_value_binary_write_caps (out, caps);
+  } else if (type == GST_TYPE_BUFFER) {
+    GstBuffer *buffer = gst_value_get_buffer (value);
+    GstMapInfo info;
+
+    if (buffer == NULL || !gst_buffer_map (buffer, &info, GST_MAP_READ))
+      return FALSE;
+    write_byte (out, TAG_BUFFER);
+    _priv_gst_value_binary_write_uint (out, info.size);
+    g_byte_array_append (out, info.data, info.size);
+    gst_buffer_unmap (buffer, &info);
+    return TRUE;
+  } else {
+    gchar *str;
+
+    /* everything else uses the string serialization */
+    str = gst_value_serialize (value);
+    if (str == NULL)
+      return FALSE;
+    write_byte (out, TAG_OTHER);
+    write_string (out, g_type_name (type));
+    write_string (out, str);
+    g_free (str);
+    return TRUE;
+  }
+}
+
+static gboolean
+write_field (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  GByteArray *out = user_data;
+
+  write_string (out, g_quark_to_string (field_id));
+  return _priv_gst_value_binary_write_value (out, value);
+}
+
+gboolean
+_priv_gst_value_binary_write_structure (GByteArray * out,
+    const GstStructure * structure)
+{
+  write_string (out, gst_structure_get_name (structure));
+  _priv_gst_value_binary_write_uint (out, gst_structure_n_fields (structure));
+
+  return gst_structure_foreach (structure, write_field, out);
+}
+
+gboolean
+_priv_gst_value_binary_write_caps (GByteArray * out, const GstCaps * caps)
+{
+  guint i, size;
+
+  if (gst_caps_is_any (caps)) {
+    _priv_gst_value_binary_write_uint (out, 1);
+    _priv_gst_value_binary_write_uint (out, 0);
+    return TRUE;
+  }
+
+  size = gst_caps_get_size (caps);
+  _priv_gst_value_binary_write_uint (out, 0);
+  _priv_gst_value_binary_write_uint (out, size);
+  for (i = 0; i < size; i++) {
+    if (!_priv_gst_value_binary_write_structure (out,
+            gst_caps_get_structure (caps, i)))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* frees @out and returns its data when @ok */
+guint8 *
+_priv_gst_value_binary_finish (GByteArray * out, gboolean ok, gsize * size)
+{
+  if (!ok) {
+    g_byte_array_free (out, TRUE);
+    return NULL;
+  }
+
+  if (size)
+    *size = out->len;
+
+  return g_byte_array_free (out, FALSE);
+}
+
+static inline gboolean
+read_byte (GstValueBinaryReader * reader, guint8 * val)
+{
+  if (reader->pos >= reader->size)
+    return FALSE;
+
+  *val = reader->data[reader->pos++];
+  return TRUE;
+}
+
+gboolean
+_priv_gst_value_binary_read_uint (GstValueBinaryReader * reader,
+    guint64 * val)
+{
+  guint64 res = 0;
+  guint shift = 0;
+  guint8 b;
+
+  do {
+    if (shift > 63 || !read_byte (reader, &b))
+      return FALSE;
+    res |= (guint64) (b & 0x7f) << shift;
+    shift += 7;
+  } while (b & 0x80);
+
+  *val = res;
+  return TRUE;
+}
+
+static gboolean
+read_int (GstValueBinaryReader * reader, gint64 * val)
+{
+  guint64 u;
+
+  if (!_priv_gst_value_binary_read_uint (reader, &u))
+    return FALSE;
+
+  *val = (gint64) (u >> 1) ^ -(gint64) (u & 1);
+  return TRUE;
+}
+
+/* reads a varint that has to fit in a gint */
+static gboolean
+read_int32 (GstValueBinaryReader * reader, gint * val)
+{
+  gint64 v;
+
+  if (!read_int (reader, &v) || v < G_MININT || v > G_MAXINT)
+    return FALSE;
+
+  *val = v;
+  return TRUE;
+}
+
+static gboolean
+read_uint32 (GstValueBinaryReader * reader, guint * val)
+{
+  guint64 v;
+
+  if (!_priv_gst_value_binary_read_uint (reader, &v) || v > G_MAXUINT)
+    return FALSE;
+
+  *val = v;
+  return TRUE;
+}
+
+static gboolean
+read_double (GstValueBinaryReader * reader, gdouble * val)
+{
+  if (reader->size - reader->pos < 8)
+    return FALSE;
+
+  *val = GST_READ_DOUBLE_LE (reader->data + reader->pos);
+  reader->pos += 8;
+  return TRUE;
+}
+
+static gboolean
+read_float (GstValueBinaryReader * reader, gfloat * val)
+{
+  if (reader->size - reader->pos < 4)
+    return FALSE;
+
+  *val = GST_READ_FLOAT_LE (reader->data + reader->pos);
+  reader->pos += 4;
+  return TRUE;
+}
+
+/* reads the length of a block of bytes and checks that they are there */
+static gboolean
+read_length (GstValueBinaryReader * reader, gsize * len)
+{
+  guint64 v;
+
+  if (!_priv_gst_value_binary_read_uint (reader, &v)
+      || v > reader->size - reader->pos)
+    return FALSE;
+
+  *len = v;
+  return TRUE;
+}
+
+/* returns a newly allocated string in @str, which can be NULL */
+static gboolean
+read_string (GstValueBinaryReader * reader, gchar ** str)
+{
+  guint64 v;
+  gsize len;
+
+  if (!_priv_gst_value_binary_read_uint (reader, &v))
+    return FALSE;
+
+  if (v == 0) {
+    *str = NULL;
+    return TRUE;
+  }
+
+  len = v - 1;
+  if (v - 1 > reader->size - reader->pos)
+    return FALSE;
+
+  /* no embedded NULs */
+  if (memchr (reader->data + reader->pos, '\0', len))
+    return FALSE;
+
+  *str = g_strndup ((const gchar *) reader->data + reader->pos, len);
+  reader->pos += len;
+  return TRUE;
+}
+
+/* reads a type name, the type has to be registered already */
+static GType
+read_type (GstValueBinaryReader * reader)
+{
+  gchar *name;
+  GType type;
+
+  if (!read_string (reader, &name) || name == NULL)
+    return G_TYPE_INVALID;
+
+  type = g_type_from_name (name);
+  g_free (name);
+
+  return type;
+}
+
+gboolean
+_priv_gst_value_binary_read_header (GstValueBinaryReader * reader,
+    const guint8 * data, gsize size, guint8 kind)
+{
+  reader->data = data;
+  reader->size = size;
+  reader->pos = 5;
+  reader->depth = 0;
+
+  if (size < 5 || memcmp (data, "GST", 3) != 0)
+    return FALSE;
+
+  return data[3] == GST_VALUE_BINARY_VERSION && data[4] == kind;
+}
+
+static gboolean
+read_fraction (GstValueBinaryReader * reader, GValue * dest)
+{
+  gint num, denom;
+
+  if (!read_int32 (reader, &num) || !read_int32 (reader, &denom)
+      || denom == 0)
+    return FALSE;
+
+  g_value_init (dest, GST_TYPE_FRACTION);
+  gst_value_set_fraction (dest, num, denom);
+
+  return TRUE;
+}
+
+static gboolean
+read_array (GstValueBinaryReader * reader, GValue * dest, GType type)
+{
+  guint64 i, size;
+
+  /* every value takes at least 2 bytes */
+  if (!_priv_gst_value_binary_read_uint (reader, &size)
+      || size > (reader->size - reader->pos) / 2)
+    return FALSE;
+
+  g_value_init (dest, type);
+  for (i = 0; i < size; i++) {
+    GValue v = { 0, };
+
+    if (!_priv_gst_value_binary_read_value (reader, &v)) {
+      g_value_unset (dest);
+      return FALSE;
+    }
+
+    if (type == GST_TYPE_LIST)
+      gst_value_list_append_and_take_value (dest, &v);
+    else
+      gst_value_array_append_and_take_value (dest, &v);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+read_tagged_value (GstValueBinaryReader * reader, GValue * dest, guint8 tag)
+{
+  gint64 i64;
+  guint64 u64;
+  gint i;
+  guint u;
+
+  switch (tag) {
+    case TAG_BOOLEAN:
+    {
+      guint8 b;
+
+      if (!read_byte (reader, &b) || b > 1)
+        return FALSE;
+      g_value_init (dest, G_TYPE_BOOLEAN);
+      g_value_set_boolean (dest, b);
+      return TRUE;
+    }
+    case TAG_CHAR:
+    case TAG_UCHAR:
+    {
+      guint8 b;
+
+      if (!read_byte (reader, &b))
+        return FALSE;
+      if (tag == TAG_CHAR) {
+        g_value_init (dest, G_TYPE_CHAR);
+        g_value_set_schar (dest, (gint8) b);
+      } else {
+        g_value_init (dest, G_TYPE_UCHAR);
+        g_value_set_uchar (dest, b);
+      }
+      return TRUE;
+    }
+    case TAG_INT:
+      if (!read_int32 (reader, &i))
+        return FALSE;
+      g_value_init (dest, G_TYPE_INT);
+      g_value_set_int (dest, i);
+      return TRUE;
+    case TAG_UINT:
+      if (!read_uint32 (reader, &u))
+        return FALSE;
+      g_value_init (dest, G_TYPE_UINT);
+      g_value_set_uint (dest, u);
+      return TRUE;
+    case TAG_LONG:
+      if (!read_int (reader, &i64) || i64 < G_MINLONG || i64 > G_MAXLONG)
+        return FALSE;
+      g_value_init (dest, G_TYPE_LONG);
+      g_value_set_long (dest, i64);
+      return TRUE;
+    case TAG_ULONG:
+      if (!_priv_gst_value_binary_read_uint (reader, &u64) || u64 > G_MAXULONG)
+        return FALSE;
+      g_value_init (dest, G_TYPE_ULONG);
+      g_value_set_ulong (dest, u64);
+      return TRUE;
+    case TAG_INT64:
+      if (!read_int (reader, &i64))
+        return FALSE;
+      g_value_init (dest, G_TYPE_INT64);
+      g_value_set_int64 (dest, i64);
+      return TRUE;
+    case TAG_UINT64:
+      if (!_priv_gst_value_binary_read_uint (reader, &u64))
+        return FALSE;
+      g_value_init (dest, G_TYPE_UINT64);
+      g_value_set_uint64 (dest, u64);
+      return TRUE;
+    case TAG_FLOAT:
+    {
+      gfloat f;
+
+      if (!read_float (reader, &f))
+        return FALSE;
+      g_value_init (dest, G_TYPE_FLOAT);
+      g_value_set_float (dest, f);
+      return TRUE;
+    }
+    case TAG_DOUBLE:
+    {
+      gdouble d;
+
+      if (!read_double (reader, &d))
+        return FALSE;
+      g_value_init (dest, G_TYPE_DOUBLE);
+      g_value_set_double (dest, d);
+      return TRUE;
+    }
+    case TAG_STRING:
+    {
+      gchar *str;
+
+      if (!read_string (reader, &str))
+        return FALSE;
+      g_value_init (dest, G_TYPE_STRING);
+      g_value_take_string (dest, str);
+      return TRUE;
+    }
+    case TAG_ENUM:
+    {
+      GType type = read_type (reader);
+
+      if (!G_TYPE_IS_ENUM (type) || !read_int32 (reader, &i))
+        return FALSE;
+      g_value_init (dest, type);
+      g_value_set_enum (dest, i);
+      return TRUE;
+    }
+    case TAG_FLAGS:
+    {
+      GType type = read_type (reader);
+
+      if (!G_TYPE_IS_FLAGS (type) || !read_uint32 (reader, &u))
+        return FALSE;
+      g_value_init (dest, type);
+      g_value_set_flags (dest, u);
+      return TRUE;
+    }
+    case TAG_FRACTION:
+      return read_fraction (reader, dest);
+    case TAG_INT_RANGE:
+    {
+      gint min, max, step;
+
+      if (!read_int32 (reader, &min) || !read_int32 (reader, &max)
+          || !read_int32 (reader, &step))
+        return FALSE;
+      if (min >= max || step <= 0 || min % step != 0 || max % step != 0)
+        return FALSE;
+      g_value_init (dest, GST_TYPE_INT_RANGE);
+      gst_value_set_int_range_step (dest, min, max, step);
+      return TRUE;
+    }
+    case TAG_INT64_RANGE:
+    {
+      gint64 min, max, step;
+
+      if (!read_int (reader, &min) || !read_int (reader, &max)
+          || !read_int (reader, &step))
+        return FALSE;
+      if (min >= max || step <= 0 || min % step != 0 || max % step != 0)
+        return FALSE;
+      g_value_init (dest, GST_TYPE_INT64_RANGE);
+      gst_value_set_int64_range_step (dest, min, max, step);
+      return TRUE;
+    }
+    case TAG_DOUBLE_RANGE:
+    {
+      gdouble min, max;
+
+      if (!read_double (reader, &min) || !read_double (reader, &max)
+          || !(min < max))
+        return FALSE;
+      g_value_init (dest, GST_TYPE_DOUBLE_RANGE);
+      gst_value_set_double_range (dest, min, max);
+      return TRUE;
+    }
+    case TAG_FRACTION_RANGE:
+    {
+      GValue min = { 0, }, max = {
+      0,};
+      gboolean res = FALSE;
+
+      if (read_fraction (reader, &min) && read_fraction (reader, &max)
+          && gst_value_compare (&min, &max) == GST_VALUE_LESS_THAN) {
+        g_value_init (dest, GST_TYPE_FRACTION_RANGE);
+        gst_value_set_fraction_range (dest, &min, &max);
+        res = TRUE;
+      }
+      if (G_IS_VALUE (&min))
+        g_value_unset (&min);
+      if (G_IS_VALUE (&max))
+        g_value_unset (&max);
+      return res;
+    }
+    case TAG_BITMASK:
+      if (!_priv_gst_value_binary_read_uint (reader, &u64))
+        return FALSE;
+      g_value_init (dest, GST_TYPE_BITMASK);
+      gst_value_set_bitmask (dest, u64);
+      return TRUE;
+    case TAG_LIST:
+      return read_array (reader, dest, GST_TYPE_LIST);
+    case TAG_ARRAY:
+      return read_array (reader, dest, GST_TYPE_ARRAY);
+    case TAG_STRUCTURE:
+    {
+      GstStructure *s = _priv_gst_value_binary_read_structure (reader);
+
+      if (s == NULL)
+        return FALSE;
+      g_value_init (dest, GST_TYPE_STRUCTURE);
+      g_value_take_boxed (dest, s);
+      return TRUE;
+    }
+    case TAG_CAPS:
+    {
+      GstCaps *caps = _priv_gst_value_binary_read_caps (reader);
+
+      if (caps == NULL)
+        return FALSE;
+      g_value_init (dest, GST_TYPE_CAPS);
+      g_value_take_boxed (dest, caps);
+      return TRUE;
+    }
+    case TAG_BUFFER:
+    {
+      GstBuffer *buffer;
+      gsize len;
+
+      if (!read_length (reader, &len))
+        return FALSE;
+      buffer = gst_buffer_new_allocate (NULL, len, NULL);
+      gst_buffer_fill (buffer, 0, reader->data + reader->pos, len);
+      reader->pos += len;
+      g_value_init (dest, GST_TYPE_BUFFER);
+      gst_value_take_buffer (dest, buffer);
+      return TRUE;
+    }
+    case TAG_OTHER:
+    {
+      GType type = read_type (reader);
+      gchar *str;
+      gboolean res;
+
+      if (type == G_TYPE_INVALID || !G_TYPE_IS_VALUE_TYPE (type)
+          || G_TYPE_IS_ABSTRACT (type))
+        return FALSE;
+      if (!read_string (reader, &str) || str == NULL)
+        return FALSE;
+      g_value_init (dest, type);
+      res = gst_value_deserialize (dest, str);
+      g_free (str);
+      if (!res)
+        g_value_unset (dest);
+      return res;
+    }
+    default:
+      return FALSE;
+  }
+}
+
+gboolean
+_priv_gst_value_binary_read_value (GstValueBinaryReader * reader,
+    GValue * dest)
+{
+  gboolean res;
+  guint8 tag;
+
+  if (!read_byte (reader, &tag) || reader->depth >= MAX_DEPTH)
+    return FALSE;
+
+  reader->depth++;
+  res = read_tagged_value (reader, dest, tag);
+  reader->depth--;
+
+  return res;
+}
+
+GstStructure *
+_priv_gst_value_binary_read_structure (GstValueBinaryReader * reader)
+{
+  GstStructure *structure;
+  guint64 i, n_fields;
+  gchar *name;
+
+  if (!read_string (reader, &name) || name == NULL)
+    return NULL;
+
+  /* the rest of the name is checked by gst_structure_new_empty() */
+  if (!g_ascii_isalpha (name[0]) ||
+      !_priv_gst_value_binary_read_uint (reader, &n_fields) ||
+      n_fields > (reader->size - reader->pos) / 3) {
+    g_free (name);
+    return NULL;
+  }
+
+  structure = gst_structure_new_empty (name);
+  g_free (name);
+  if (structure == NULL)
+    return NULL;
+
+  for (i = 0; i < n_fields; i++) {
+    GValue value = { 0, };
+
+    if (!read_string (reader, &name) || name == NULL)
+      goto error;
+
+    if (!_priv_gst_value_binary_read_value (reader, &value)) {
+      g_free (name);
+      goto error;
+    }
+
+    gst_structure_id_take_value (structure, g_quark_from_string (name),
+        &value);
+    g_free (name);
+  }
+
+  return structure;
+
+error:
+  gst_structure_free (structure);
+  return NULL;
+}
+
+GstCaps *
+_priv_gst_value_binary_read_caps (GstValueBinaryReader * reader)
+{
+  GstCaps *caps;
+  guint64 i, flags, size;
+
+  if (!_priv_gst_value_binary_read_uint (reader, &flags) || flags > 1 ||
+      !_priv_gst_value_binary_read_uint (reader, &size) ||
+      size > (reader->size - reader->pos) / 2)
+    return NULL;
+
+  if (flags & 1) {
+    if (size != 0)
+      return NULL;
+    return gst_caps_new_any ();
+  }
+
+  if (reader->depth >= MAX_DEPTH)
+    return NULL;
+  reader->depth++;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < size; i++) {
+    GstStructure *s = _priv_gst_value_binary_read_structure (reader);
+
+    if (s == NULL) {
+      gst_caps_unref (caps);
+      caps = NULL;
+      break;
+    }
+    gst_caps_append_structure (caps, s);
+  }
+  reader->depth--;
+
+  return caps;
+}
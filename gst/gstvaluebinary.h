@@ -0,0 +1,95 @@
+/* GStreamer
+ *
+ * gstvaluebinary.h: binary serialization of values, structures and caps
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef __GST_VALUE_BINARY_H__
+#define __GST_VALUE_BINARY_H__
+
+#include <gst/gstcaps.h>
+#include <gst/gststructure.h>
+
+G_BEGIN_DECLS
+
+/*
+ * The version of the binary format, data written with another version is
+ * rejected by the readers.
+ */
+#define GST_VALUE_BINARY_VERSION 1
+
+/*
+ * The kind of the top level object, stored in the header after the magic and
+ * the version.
+ */
+enum {
+  GST_VALUE_BINARY_KIND_VALUE = 'v',
+  GST_VALUE_BINARY_KIND_STRUCTURE = 's',
+  GST_VALUE_BINARY_KIND_CAPS = 'c',
+  GST_VALUE_BINARY_KIND_TAG_LIST = 't'
+};
+
+/*
+ * GstValueBinaryReader:
+ *
+ * Position in the data that is being deserialized
+ */
+typedef struct _GstValueBinaryReader
+{
+  const guint8 *data;
+  gsize size;
+  gsize pos;
+  guint depth;
+} GstValueBinaryReader;
+
+G_GNUC_INTERNAL
+void            _priv_gst_value_binary_write_header     (GByteArray * out, guint8 kind);
+
+G_GNUC_INTERNAL
+void            _priv_gst_value_binary_write_uint       (GByteArray * out, guint64 val);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_write_value      (GByteArray * out, const GValue * value);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_write_structure  (GByteArray * out, const GstStructure * structure);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_write_caps       (GByteArray * out, const GstCaps * caps);
+
+G_GNUC_INTERNAL
+guint8 *        _priv_gst_value_binary_finish           (GByteArray * out, gboolean ok, gsize * size);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_read_header      (GstValueBinaryReader * reader,
+                                                         const guint8 * data, gsize size,
+                                                         guint8 kind);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_read_uint        (GstValueBinaryReader * reader, guint64 * val);
+
+G_GNUC_INTERNAL
+gboolean        _priv_gst_value_binary_read_value       (GstValueBinaryReader * reader, GValue * dest);
+
+G_GNUC_INTERNAL
+GstStructure *  _priv_gst_value_binary_read_structure   (GstValueBinaryReader * reader);
+
+G_GNUC_INTERNAL
+GstCaps *       _priv_gst_value_binary_read_caps        (GstValueBinaryReader * reader);
+
+G_END_DECLS
+
+#endif /* __GST_VALUE_BINARY_H__ */
@@ -213,6 +213,42 @@ YYPRINTF(const char *format, ...)
           g_list_append ((graph)->ctx->missing_elements, g_strdup (name));  \
     } } G_STMT_END
 
+/* creates an element from the factory with the given name, the factories
+ * that were found are kept in the context so that launching the same
+ * description again with the context does not look them up in the
+ * registry again */
+static GstElement *
+gst_parse_element_make (graph_t *graph, const gchar *factory_name)
+{
+  GstElementFactory *factory = NULL;
+  GstElement *element;
+
+  if (graph->ctx && graph->ctx->factories)
+    factory = g_hash_table_lookup (graph->ctx->factories, factory_name);
+
+  if (factory)
+    return gst_element_factory_create (factory, NULL);
+
+  factory = gst_element_factory_find (factory_name);
+  if (factory == NULL)
+    return NULL;
+
+  element = gst_element_factory_create (factory, NULL);
+
+  if (graph->ctx) {
+    if (graph->ctx->factories == NULL)
+      graph->ctx->factories = g_hash_table_new_full (g_str_hash, g_str_equal,
+          g_free, gst_object_unref);
+    /* takes the ref */
+    g_hash_table_insert (graph->ctx->factories, g_strdup (factory_name),
+        factory);
+  } else {
+    gst_object_unref (factory);
+  }
+
+  return element;
+}
+
 static void
 no_free (gconstpointer foo)
 {
@@ -223,7 +259,7 @@ no_free (gconstpointer foo)
 G_STMT_START { \
   chain_t *chain = chainval; \
   GSList *walk; \
-  GstBin *bin = (GstBin *) gst_element_factory_make (type, NULL); \
+  GstBin *bin = (GstBin *) gst_parse_element_make (graph, type); \
   if (!chain) { \
     SET_ERROR (graph->error, GST_PARSE_ERROR_EMPTY_BIN, \
         _("specified empty bin \"%s\", not allowed"), type); \
@@ -664,7 +700,7 @@ static int yyerror (void *scanner, graph_t *graph, const char *s);
 %start graph
 %%
 
-element:	IDENTIFIER     		      { $$ = gst_element_factory_make ($1, NULL);
+element:	IDENTIFIER     		      { $$ = gst_parse_element_make (graph, $1);
 						if ($$ == NULL) {
 						  ADD_MISSING_ELEMENT (graph, $1);
 						  SET_ERROR (graph->error, GST_PARSE_ERROR_NO_SUCH_ELEMENT, _("no element \"%s\""), $1);
@@ -922,6 +958,13 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
   g.ctx = ctx;
   g.flags = flags;
 
+  /* a reused context only reports the elements missing in this run */
+  if (ctx && ctx->missing_elements) {
+    g_list_foreach (ctx->missing_elements, (GFunc) g_free, NULL);
+    g_list_free (ctx->missing_elements);
+    ctx->missing_elements = NULL;
+  }
+
 #ifdef __GST_PARSE_TRACE
   GST_CAT_DEBUG (GST_CAT_PIPELINE, "TRACE: tracing enabled");
   __strings = __chains = __links = 0;
@@ -962,7 +1005,7 @@ priv_gst_parse_launch (const gchar *str, GError **error, GstParseContext *ctx,
     gst_parse_chain_free (g.chain);
   } else {
     /* put all elements in our bin */
-    bin = GST_BIN (gst_element_factory_make ("pipeline", NULL));
+    bin = GST_BIN (gst_parse_element_make (&g, "pipeline"));
     g_assert (bin);
 
     for (walk = g.chain->elements; walk; walk = walk->next) {
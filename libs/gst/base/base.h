@@ -34,6 +34,7 @@
 #include <gst/base/gstdataqueue.h>
 #include <gst/base/gstpushsrc.h>
 #include <gst/base/gstqueuearray.h>
+#include <gst/base/gstslicepool.h>
 #include <gst/base/gsttypefindhelper.h>
 
 #endif /* __GST_BASE_H__ */
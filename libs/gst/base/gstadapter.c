@@ -113,23 +113,44 @@
 
 #include <gst/gst_private.h>
 #include "gstadapter.h"
+#include "gstqueuearray.h"
+#include "gstbase_private.h"
 #include <string.h>
 
 /* default size for the assembled data buffer */
 #define DEFAULT_SIZE 4096
 
+/* initial number of buffers the queue can hold without growing */
+#define DEFAULT_QUEUE_SIZE 16
+
+/* scan_entry_idx when there is no scan position */
+#define NO_SCAN_ENTRY G_MAXUINT
+
 static void gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush);
 
 GST_DEBUG_CATEGORY_STATIC (gst_adapter_debug);
 #define GST_CAT_DEFAULT gst_adapter_debug
 
+typedef struct
+{
+  GstBuffer *buffer;
+  GstMapInfo info;
+} GstAdapterRegionMap;
+
+/* a timestamp of a pushed buffer that is not the head buffer yet, @offset is
+ * the number of bytes that were pushed before the buffer */
+typedef struct
+{
+  guint64 offset;
+  GstClockTime timestamp;
+} GstAdapterTimestamp;
+
 struct _GstAdapter
 {
   GObject object;
 
   /*< private > */
-  GSList *buflist;
-  GSList *buflist_end;
+  GstQueueArray *bufqueue;
   gsize size;
   gsize skip;
 
@@ -144,9 +165,24 @@ struct _GstAdapter
   guint64 dts_distance;
 
   gsize scan_offset;
-  GSList *scan_entry;
+  guint scan_entry_idx;
 
   GstMapInfo info;
+
+  /* the buffers mapped by gst_adapter_map_regions() and the regions of them
+   * that are returned */
+  GstAdapterRegionMap *region_maps;
+  GstMapInfo *regions;
+  guint n_regions;
+  guint regions_size;
+
+  /* the number of bytes that were flushed since the adapter was created or
+   * cleared, and the timestamps of the buffers after the head buffer ordered
+   * by offset. The timestamps at or before the head buffer are in pts and
+   * dts. */
+  guint64 offset;
+  GArray *pts_index;
+  GArray *dts_index;
 };
 
 struct _GstAdapterClass
@@ -176,10 +212,14 @@ gst_adapter_init (GstAdapter * adapter)
 {
   adapter->assembled_data = g_malloc (DEFAULT_SIZE);
   adapter->assembled_size = DEFAULT_SIZE;
+  adapter->bufqueue = gst_queue_array_new (DEFAULT_QUEUE_SIZE);
+  adapter->scan_entry_idx = NO_SCAN_ENTRY;
   adapter->pts = GST_CLOCK_TIME_NONE;
   adapter->pts_distance = 0;
   adapter->dts = GST_CLOCK_TIME_NONE;
   adapter->dts_distance = 0;
+  adapter->pts_index = g_array_new (FALSE, FALSE, sizeof (GstAdapterTimestamp));
+  adapter->dts_index = g_array_new (FALSE, FALSE, sizeof (GstAdapterTimestamp));
 }
 
 static void
@@ -198,6 +238,11 @@ gst_adapter_finalize (GObject * object)
   GstAdapter *adapter = GST_ADAPTER (object);
 
   g_free (adapter->assembled_data);
+  gst_queue_array_free (adapter->bufqueue);
+  g_free (adapter->region_maps);
+  g_free (adapter->regions);
+  g_array_free (adapter->pts_index, TRUE);
+  g_array_free (adapter->dts_index, TRUE);
 
   GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
 }
@@ -224,15 +269,17 @@ gst_adapter_new (void)
 void
 gst_adapter_clear (GstAdapter * adapter)
 {
+  GstBuffer *buf;
+
   g_return_if_fail (GST_IS_ADAPTER (adapter));
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  if (adapter->n_regions)
+    gst_adapter_unmap_regions (adapter);
 
-  g_slist_foreach (adapter->buflist, (GFunc) gst_mini_object_unref, NULL);
-  g_slist_free (adapter->buflist);
-  adapter->buflist = NULL;
-  adapter->buflist_end = NULL;
+  while ((buf = gst_queue_array_pop_head (adapter->bufqueue)))
+    gst_buffer_unref (buf);
   adapter->size = 0;
   adapter->skip = 0;
   adapter->assembled_len = 0;
@@ -241,7 +288,10 @@ gst_adapter_clear (GstAdapter * adapter)
   adapter->dts = GST_CLOCK_TIME_NONE;
   adapter->dts_distance = 0;
   adapter->scan_offset = 0;
-  adapter->scan_entry = NULL;
+  adapter->scan_entry_idx = NO_SCAN_ENTRY;
+  adapter->offset = 0;
+  g_array_set_size (adapter->pts_index, 0);
+  g_array_set_size (adapter->dts_index, 0);
 }
 
 static inline void
@@ -263,29 +313,88 @@ update_timestamps (GstAdapter * adapter, GstBuffer * buf)
   }
 }
 
+static inline void
+index_timestamp (GArray * index, guint64 offset, GstClockTime timestamp)
+{
+  GstAdapterTimestamp entry;
+
+  if (GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    entry.offset = offset;
+    entry.timestamp = timestamp;
+    g_array_append_val (index, entry);
+  }
+}
+
+/* removes the timestamps of the buffers up to the current position, they
+ * were applied with update_timestamps() */
+static void
+prune_index (GArray * index, guint64 offset)
+{
+  guint n;
+
+  for (n = 0; n < index->len; n++) {
+    if (g_array_index (index, GstAdapterTimestamp, n).offset > offset)
+      break;
+  }
+  if (n > 0)
+    g_array_remove_range (index, 0, n);
+}
+
+/* finds the last timestamp at or before @offset bytes after the current
+ * position, falls back to @timestamp and @distance of the head buffer */
+static GstClockTime
+lookup_index (GArray * index, guint64 position, gsize offset,
+    GstClockTime timestamp, guint64 distance, guint64 * ret_distance)
+{
+  GstAdapterTimestamp *entry;
+  guint64 target = position + offset;
+  guint lo = 0, hi = index->len;
+
+  /* find the first entry after the target */
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (index, GstAdapterTimestamp, mid).offset <= target)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0) {
+    if (ret_distance)
+      *ret_distance = distance + offset;
+    return timestamp;
+  }
+
+  entry = &g_array_index (index, GstAdapterTimestamp, lo - 1);
+  if (ret_distance)
+    *ret_distance = target - entry->offset;
+  return entry->timestamp;
+}
+
 /* copy data into @dest, skipping @skip bytes from the head buffers */
 static void
 copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
     gsize size)
 {
-  GSList *g;
+  guint idx;
   GstBuffer *buf;
   gsize bsize, csize;
 
   /* first step, do skipping */
   /* we might well be copying where we were scanning */
-  if (adapter->scan_entry && (adapter->scan_offset <= skip)) {
-    g = adapter->scan_entry;
+  if (adapter->scan_entry_idx != NO_SCAN_ENTRY &&
+      (adapter->scan_offset <= skip)) {
+    idx = adapter->scan_entry_idx;
     skip -= adapter->scan_offset;
   } else {
-    g = adapter->buflist;
+    idx = 0;
   }
-  buf = g->data;
+  buf = gst_queue_array_peek_nth (adapter->bufqueue, idx);
   bsize = gst_buffer_get_size (buf);
   while (G_UNLIKELY (skip >= bsize)) {
     skip -= bsize;
-    g = g_slist_next (g);
-    buf = g->data;
+    buf = gst_queue_array_peek_nth (adapter->bufqueue, ++idx);
     bsize = gst_buffer_get_size (buf);
   }
   /* copy partial buffer */
@@ -300,8 +409,7 @@ copy_into_unchecked (GstAdapter * adapter, guint8 * dest, gsize skip,
 
   /* second step, copy remainder */
   while (size > 0) {
-    g = g_slist_next (g);
-    buf = g->data;
+    buf = gst_queue_array_peek_nth (adapter->bufqueue, ++idx);
     bsize = gst_buffer_get_size (buf);
     if (G_LIKELY (bsize > 0)) {
       csize = MIN (bsize, size);
@@ -331,80 +439,25 @@ gst_adapter_push (GstAdapter * adapter, GstBuffer * buf)
   g_return_if_fail (GST_IS_BUFFER (buf));
 
   size = gst_buffer_get_size (buf);
-  adapter->size += size;
 
   /* Note: merging buffers at this point is premature. */
-  if (G_UNLIKELY (adapter->buflist == NULL)) {
+  if (G_UNLIKELY (gst_queue_array_is_empty (adapter->bufqueue))) {
     GST_LOG_OBJECT (adapter, "pushing %p first %" G_GSIZE_FORMAT " bytes",
         buf, size);
-    adapter->buflist = adapter->buflist_end = g_slist_append (NULL, buf);
+    gst_queue_array_push_tail (adapter->bufqueue, buf);
     update_timestamps (adapter, buf);
   } else {
-    /* Otherwise append to the end, and advance our end pointer */
+    /* Otherwise append to the end */
     GST_LOG_OBJECT (adapter, "pushing %p %" G_GSIZE_FORMAT " bytes at end, "
-        "size now %" G_GSIZE_FORMAT, buf, size, adapter->size);
-    adapter->buflist_end = g_slist_append (adapter->buflist_end, buf);
-    adapter->buflist_end = g_slist_next (adapter->buflist_end);
-  }
-}
-
-#if 0
-/* Internal method only. Tries to merge buffers at the head of the queue
- * to form a single larger buffer of size 'size'.
- *
- * Returns TRUE if it managed to merge anything.
- */
-static gboolean
-gst_adapter_try_to_merge_up (GstAdapter * adapter, gsize size)
-{
-  GstBuffer *cur, *head;
-  GSList *g;
-  gboolean ret = FALSE;
-  gsize hsize;
-
-  g = adapter->buflist;
-  if (g == NULL)
-    return FALSE;
-
-  head = g->data;
-
-  hsize = gst_buffer_get_size (head);
-
-  /* Remove skipped part from the buffer (otherwise the buffer might grow indefinitely) */
-  head = gst_buffer_make_writable (head);
-  gst_buffer_resize (head, adapter->skip, hsize - adapter->skip);
-  hsize -= adapter->skip;
-  adapter->skip = 0;
-  g->data = head;
-
-  g = g_slist_next (g);
-
-  while (g != NULL && hsize < size) {
-    cur = g->data;
-    /* Merge the head buffer and the next in line */
-    GST_LOG_OBJECT (adapter, "Merging buffers of size %" G_GSIZE_FORMAT " & %"
-        G_GSIZE_FORMAT " in search of target %" G_GSIZE_FORMAT,
-        hsize, gst_buffer_get_size (cur), size);
-
-    head = gst_buffer_append (head, cur);
-    hsize = gst_buffer_get_size (head);
-    ret = TRUE;
-
-    /* Delete the front list item, and store our new buffer in the 2nd list
-     * item */
-    adapter->buflist = g_slist_delete_link (adapter->buflist, adapter->buflist);
-    g->data = head;
-
-    /* invalidate scan position */
-    adapter->scan_offset = 0;
-    adapter->scan_entry = NULL;
-
-    g = g_slist_next (g);
+        "size now %" G_GSIZE_FORMAT, buf, size, adapter->size + size);
+    gst_queue_array_push_tail (adapter->bufqueue, buf);
+    index_timestamp (adapter->pts_index, adapter->offset + adapter->size,
+        GST_BUFFER_PTS (buf));
+    index_timestamp (adapter->dts_index, adapter->offset + adapter->size,
+        GST_BUFFER_DTS (buf));
   }
-
-  return ret;
+  adapter->size += size;
 }
-#endif
 
 /**
  * gst_adapter_map:
@@ -441,6 +494,8 @@ gst_adapter_map (GstAdapter * adapter, gsize size)
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  if (adapter->n_regions)
+    gst_adapter_unmap_regions (adapter);
 
   /* we don't have enough data, return NULL. This is unlikely
    * as one usually does an _available() first instead of peeking a
@@ -452,24 +507,16 @@ gst_adapter_map (GstAdapter * adapter, gsize size)
   if (adapter->assembled_len >= size)
     return adapter->assembled_data;
 
-#if 0
-  do {
-#endif
-    cur = adapter->buflist->data;
-    skip = adapter->skip;
+  cur = gst_queue_array_peek_head (adapter->bufqueue);
+  skip = adapter->skip;
 
-    csize = gst_buffer_get_size (cur);
-    if (csize >= size + skip) {
-      if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
-        return FALSE;
+  csize = gst_buffer_get_size (cur);
+  if (csize >= size + skip) {
+    if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
+      return FALSE;
 
-      return (guint8 *) adapter->info.data + skip;
-    }
-    /* We may be able to efficiently merge buffers in our pool to
-     * gather a big enough chunk to return it from the head buffer directly */
-#if 0
-  } while (gst_adapter_try_to_merge_up (adapter, size));
-#endif
+    return (guint8 *) adapter->info.data + skip;
+  }
 
   /* see how much data we can reuse from the assembled memory and how much
    * we need to copy */
@@ -516,13 +563,128 @@ gst_adapter_unmap (GstAdapter * adapter)
   g_return_if_fail (GST_IS_ADAPTER (adapter));
 
   if (adapter->info.memory) {
-    GstBuffer *cur = adapter->buflist->data;
+    GstBuffer *cur = gst_queue_array_peek_head (adapter->bufqueue);
     GST_LOG_OBJECT (adapter, "unmap memory buffer %p", cur);
     gst_buffer_unmap (cur, &adapter->info);
     adapter->info.memory = NULL;
   }
 }
 
+/**
+ * gst_adapter_map_regions:
+ * @adapter: a #GstAdapter
+ * @size: the number of bytes to map
+ * @n_regions: (out): the number of returned regions
+ *
+ * Maps the first @size bytes stored in the @adapter without copying them
+ * into one block of memory like gst_adapter_map() does when the data is
+ * spread over several buffers or memory blocks. The data and size of every
+ * returned #GstMapInfo describe the next part of the adapter data, in the
+ * memory block of the buffer it was pushed in.
+ *
+ * The regions are valid until gst_adapter_unmap_regions() is called or the
+ * data is flushed from the adapter.
+ *
+ * Returns #NULL if @size bytes are not available.
+ *
+ * Returns: (transfer none) (array length=n_regions): the regions of the
+ *     first @size bytes, or %NULL
+ *
+ * Since: 1.2
+ */
+const GstMapInfo *
+gst_adapter_map_regions (GstAdapter * adapter, gsize size, guint * n_regions)
+{
+  GstAdapterRegionMap *map;
+  GstMapInfo *region;
+  GstBuffer *buf;
+  gsize skip, msize;
+  guint idx, i, n, n_mem;
+
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
+  g_return_val_if_fail (size > 0, NULL);
+  g_return_val_if_fail (n_regions != NULL, NULL);
+
+  if (adapter->info.memory)
+    gst_adapter_unmap (adapter);
+  if (adapter->n_regions)
+    gst_adapter_unmap_regions (adapter);
+
+  if (G_UNLIKELY (size > adapter->size))
+    return NULL;
+
+  skip = adapter->skip;
+  n = 0;
+  for (idx = 0; size > 0; idx++) {
+    buf = gst_queue_array_peek_nth (adapter->bufqueue, idx);
+    n_mem = gst_buffer_n_memory (buf);
+
+    /* every memory block is mapped by itself so that nothing is merged */
+    for (i = 0; i < n_mem && size > 0; i++) {
+      msize = gst_memory_get_sizes (gst_buffer_peek_memory (buf, i), NULL,
+          NULL);
+      /* the flushed part of the head buffer and empty memory */
+      if (msize <= skip) {
+        skip -= msize;
+        continue;
+      }
+
+      if (G_UNLIKELY (n == adapter->regions_size)) {
+        adapter->regions_size = MAX (8, 2 * adapter->regions_size);
+        adapter->region_maps = g_renew (GstAdapterRegionMap,
+            adapter->region_maps, adapter->regions_size);
+        adapter->regions = g_renew (GstMapInfo, adapter->regions,
+            adapter->regions_size);
+      }
+
+      map = &adapter->region_maps[n];
+      if (!gst_buffer_map_range (buf, i, 1, &map->info, GST_MAP_READ)) {
+        adapter->n_regions = n;
+        gst_adapter_unmap_regions (adapter);
+        return NULL;
+      }
+      map->buffer = buf;
+
+      region = &adapter->regions[n];
+      *region = map->info;
+      region->data += skip;
+      region->size = MIN (msize - skip, size);
+      size -= region->size;
+      skip = 0;
+      n++;
+    }
+  }
+  GST_LOG_OBJECT (adapter, "mapped %u regions", n);
+
+  adapter->n_regions = n;
+  *n_regions = n;
+
+  return adapter->regions;
+}
+
+/**
+ * gst_adapter_unmap_regions:
+ * @adapter: a #GstAdapter
+ *
+ * Releases the regions obtained with the last gst_adapter_map_regions().
+ *
+ * Since: 1.2
+ */
+void
+gst_adapter_unmap_regions (GstAdapter * adapter)
+{
+  guint i;
+
+  g_return_if_fail (GST_IS_ADAPTER (adapter));
+
+  for (i = 0; i < adapter->n_regions; i++) {
+    GstAdapterRegionMap *map = &adapter->region_maps[i];
+
+    gst_buffer_unmap (map->buffer, &map->info);
+  }
+  adapter->n_regions = 0;
+}
+
 /**
  * gst_adapter_copy:
  * @adapter: a #GstAdapter
@@ -554,16 +716,18 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
 {
   GstBuffer *cur;
   gsize size;
-  GSList *g;
 
   GST_LOG_OBJECT (adapter, "flushing %" G_GSIZE_FORMAT " bytes", flush);
 
   if (adapter->info.memory)
     gst_adapter_unmap (adapter);
+  if (adapter->n_regions)
+    gst_adapter_unmap_regions (adapter);
 
   /* clear state */
   adapter->size -= flush;
   adapter->assembled_len = 0;
+  adapter->offset += flush;
 
   /* take skip into account */
   flush += adapter->skip;
@@ -571,8 +735,7 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
   adapter->pts_distance -= adapter->skip;
   adapter->dts_distance -= adapter->skip;
 
-  g = adapter->buflist;
-  cur = g->data;
+  cur = gst_queue_array_peek_head (adapter->bufqueue);
   size = gst_buffer_get_size (cur);
   while (flush >= size) {
     /* can skip whole buffer */
@@ -581,27 +744,27 @@ gst_adapter_flush_unchecked (GstAdapter * adapter, gsize flush)
     adapter->dts_distance += size;
     flush -= size;
 
-    gst_buffer_unref (cur);
-    g = g_slist_delete_link (g, g);
+    gst_buffer_unref (gst_queue_array_pop_head (adapter->bufqueue));
 
-    if (G_UNLIKELY (g == NULL)) {
+    cur = gst_queue_array_peek_head (adapter->bufqueue);
+    if (G_UNLIKELY (cur == NULL)) {
       GST_LOG_OBJECT (adapter, "adapter empty now");
-      adapter->buflist_end = NULL;
       break;
     }
     /* there is a new head buffer, update the timestamps */
-    cur = g->data;
     update_timestamps (adapter, cur);
     size = gst_buffer_get_size (cur);
   }
-  adapter->buflist = g;
   /* account for the remaining bytes */
   adapter->skip = flush;
   adapter->pts_distance += flush;
   adapter->dts_distance += flush;
   /* invalidate scan position */
   adapter->scan_offset = 0;
-  adapter->scan_entry = NULL;
+  adapter->scan_entry_idx = NO_SCAN_ENTRY;
+
+  prune_index (adapter->pts_index, adapter->offset);
+  prune_index (adapter->dts_index, adapter->offset);
 }
 
 /**
@@ -751,7 +914,7 @@ gst_adapter_take_buffer (GstAdapter * adapter, gsize nbytes)
   if (G_UNLIKELY (nbytes > adapter->size))
     return NULL;
 
-  cur = adapter->buflist->data;
+  cur = gst_queue_array_peek_head (adapter->bufqueue);
   skip = adapter->skip;
   hsize = gst_buffer_get_size (cur);
 
@@ -767,20 +930,6 @@ gst_adapter_take_buffer (GstAdapter * adapter, gsize nbytes)
     buffer = gst_buffer_copy_region (cur, GST_BUFFER_COPY_ALL, skip, nbytes);
     goto done;
   }
-#if 0
-  if (gst_adapter_try_to_merge_up (adapter, nbytes)) {
-    /* Merged something, let's try again for sub-buffering */
-    cur = adapter->buflist->data;
-    skip = adapter->skip;
-    if (gst_buffer_get_size (cur) >= nbytes + skip) {
-      GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
-          " via sub-buffer", nbytes);
-      buffer = gst_buffer_copy_region (cur, GST_BUFFER_COPY_ALL, skip, nbytes);
-      goto done;
-    }
-  }
-#endif
-
   data = gst_adapter_take_internal (adapter, nbytes);
 
   buffer = gst_buffer_new_wrapped (data, nbytes);
@@ -791,6 +940,112 @@ done:
   return buffer;
 }
 
+/**
+ * gst_adapter_take_buffer_fast:
+ * @adapter: a #GstAdapter
+ * @nbytes: the number of bytes to take
+ *
+ * Returns a #GstBuffer containing the first @nbytes bytes of the
+ * @adapter. The returned bytes will be flushed from the adapter.
+ *
+ * Unlike gst_adapter_take_buffer(), the data is never merged into a new
+ * allocation. When the data spans several of the pushed buffers, the returned
+ * buffer is made of shared #GstMemory blocks of those buffers, so no payload
+ * is copied unless a memory block can't be shared. Callers that need the
+ * data in one contiguous block should use gst_adapter_take_buffer().
+ *
+ * Only the flags and the timestamps of the first buffer are copied to the
+ * returned buffer, no assumptions should be made about them and about the
+ * metadata.
+ *
+ * Caller owns a reference to the returned buffer. gst_buffer_unref() after
+ * usage.
+ *
+ * Free-function: gst_buffer_unref
+ *
+ * Returns: (transfer full): a #GstBuffer containing the first @nbytes of
+ *     the adapter, or #NULL if @nbytes bytes are not available.
+ *     gst_buffer_unref() when no longer needed.
+ *
+ * Since: 1.2
+ */
+GstBuffer *
+gst_adapter_take_buffer_fast (GstAdapter * adapter, gsize nbytes)
+{
+  GstBuffer *buffer;
+  GstBuffer *cur;
+  GstMemory *mem;
+  gsize hsize, skip, left, msize, size;
+  guint idx, i, n_mem;
+
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), NULL);
+  g_return_val_if_fail (nbytes > 0, NULL);
+
+  GST_LOG_OBJECT (adapter, "taking buffer of %" G_GSIZE_FORMAT " bytes",
+      nbytes);
+
+  if (G_UNLIKELY (nbytes > adapter->size))
+    return NULL;
+
+  cur = gst_queue_array_peek_head (adapter->bufqueue);
+  skip = adapter->skip;
+  hsize = gst_buffer_get_size (cur);
+
+  if (skip == 0 && hsize == nbytes) {
+    GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
+        " as head buffer", nbytes);
+    buffer = gst_buffer_ref (cur);
+    goto done;
+  } else if (hsize >= nbytes + skip) {
+    GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
+        " via region copy", nbytes);
+    buffer = gst_buffer_copy_region (cur, GST_BUFFER_COPY_FLAGS |
+        GST_BUFFER_COPY_TIMESTAMPS | GST_BUFFER_COPY_MEMORY, skip, nbytes);
+    goto done;
+  }
+
+  GST_LOG_OBJECT (adapter, "providing buffer of %" G_GSIZE_FORMAT " bytes"
+      " via shared memory", nbytes);
+  buffer = gst_buffer_new ();
+  gst_buffer_copy_into (buffer, cur, GST_BUFFER_COPY_FLAGS |
+      GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  left = nbytes;
+  for (idx = 0; left > 0; idx++) {
+    cur = gst_queue_array_peek_nth (adapter->bufqueue, idx);
+    n_mem = gst_buffer_n_memory (cur);
+
+    for (i = 0; i < n_mem && left > 0; i++) {
+      mem = gst_buffer_peek_memory (cur, i);
+      msize = gst_memory_get_sizes (mem, NULL, NULL);
+      /* the flushed part of the head buffer and empty memory */
+      if (msize <= skip) {
+        skip -= msize;
+        continue;
+      }
+
+      size = MIN (msize - skip, left);
+      if (GST_MEMORY_IS_NO_SHARE (mem)) {
+        GST_CAT_LOG_OBJECT (GST_CAT_PERFORMANCE, adapter,
+            "memcpy %" G_GSIZE_FORMAT " bytes of unshareable memory", size);
+        mem = gst_memory_copy (mem, skip, size);
+      } else if (size < msize) {
+        mem = gst_memory_share (mem, skip, size);
+      } else {
+        mem = gst_memory_ref (mem);
+      }
+      gst_buffer_append_memory (buffer, mem);
+      left -= size;
+      skip = 0;
+    }
+  }
+
+done:
+  gst_adapter_flush_unchecked (adapter, nbytes);
+
+  return buffer;
+}
+
 /**
  * gst_adapter_take_list:
  * @adapter: a #GstAdapter
@@ -821,7 +1076,7 @@ gst_adapter_take_list (GstAdapter * adapter, gsize nbytes)
   GST_LOG_OBJECT (adapter, "taking %" G_GSIZE_FORMAT " bytes", nbytes);
 
   while (nbytes > 0) {
-    cur = adapter->buflist->data;
+    cur = gst_queue_array_peek_head (adapter->bufqueue);
     skip = adapter->skip;
     hsize = MIN (nbytes, gst_buffer_get_size (cur) - skip);
 
@@ -868,7 +1123,7 @@ gst_adapter_available_fast (GstAdapter * adapter)
 {
   GstBuffer *cur;
   gsize size;
-  GSList *g;
+  guint idx;
 
   g_return_val_if_fail (GST_IS_ADAPTER (adapter), 0);
 
@@ -881,13 +1136,12 @@ gst_adapter_available_fast (GstAdapter * adapter)
     return adapter->assembled_len;
 
   /* take the first non-zero buffer */
-  g = adapter->buflist;
+  idx = 0;
   while (TRUE) {
-    cur = g->data;
+    cur = gst_queue_array_peek_nth (adapter->bufqueue, idx++);
     size = gst_buffer_get_size (cur);
     if (size != 0)
       break;
-    g = g_slist_next (g);
   }
 
   /* we can quickly get the (remaining) data of the first buffer */
@@ -948,6 +1202,62 @@ gst_adapter_prev_dts (GstAdapter * adapter, guint64 * distance)
   return adapter->dts;
 }
 
+/**
+ * gst_adapter_prev_pts_at_offset:
+ * @adapter: a #GstAdapter
+ * @offset: the offset in the adapter at which to get the pts
+ * @distance: (out) (allow-none): pointer to location for distance, or NULL
+ *
+ * Get the pts that was before the byte at @offset in the adapter. When
+ * @distance is given, the amount of bytes between the pts and @offset is
+ * returned.
+ *
+ * This is the same as gst_adapter_prev_pts() after flushing @offset bytes,
+ * without flushing them. The adapter keeps an index of the timestamps of the
+ * buffers it holds, the lookup doesn't walk the buffers.
+ *
+ * Returns: The previously seen pts at @offset.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_adapter_prev_pts_at_offset (GstAdapter * adapter, gsize offset,
+    guint64 * distance)
+{
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), GST_CLOCK_TIME_NONE);
+
+  return lookup_index (adapter->pts_index, adapter->offset, offset,
+      adapter->pts, adapter->pts_distance, distance);
+}
+
+/**
+ * gst_adapter_prev_dts_at_offset:
+ * @adapter: a #GstAdapter
+ * @offset: the offset in the adapter at which to get the dts
+ * @distance: (out) (allow-none): pointer to location for distance, or NULL
+ *
+ * Get the dts that was before the byte at @offset in the adapter. When
+ * @distance is given, the amount of bytes between the dts and @offset is
+ * returned.
+ *
+ * This is the same as gst_adapter_prev_dts() after flushing @offset bytes,
+ * without flushing them. The adapter keeps an index of the timestamps of the
+ * buffers it holds, the lookup doesn't walk the buffers.
+ *
+ * Returns: The previously seen dts at @offset.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_adapter_prev_dts_at_offset (GstAdapter * adapter, gsize offset,
+    guint64 * distance)
+{
+  g_return_val_if_fail (GST_IS_ADAPTER (adapter), GST_CLOCK_TIME_NONE);
+
+  return lookup_index (adapter->dts_index, adapter->offset, offset,
+      adapter->dts, adapter->dts_distance, distance);
+}
+
 /**
  * gst_adapter_masked_scan_uint32_peek:
  * @adapter: a #GstAdapter
@@ -975,8 +1285,9 @@ gssize
 gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
     guint32 pattern, gsize offset, gsize size, guint32 * value)
 {
-  GSList *g;
-  gsize skip, bsize, i;
+  guint idx;
+  gsize skip, bsize;
+  gssize i;
   guint32 state;
   GstMapInfo info;
   guint8 *bdata;
@@ -994,22 +1305,23 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
 
   /* first step, do skipping and position on the first buffer */
   /* optimistically assume scanning continues sequentially */
-  if (adapter->scan_entry && (adapter->scan_offset <= skip)) {
-    g = adapter->scan_entry;
+  if (adapter->scan_entry_idx != NO_SCAN_ENTRY &&
+      (adapter->scan_offset <= skip)) {
+    idx = adapter->scan_entry_idx;
     skip -= adapter->scan_offset;
   } else {
-    g = adapter->buflist;
+    idx = 0;
     adapter->scan_offset = 0;
-    adapter->scan_entry = NULL;
+    adapter->scan_entry_idx = NO_SCAN_ENTRY;
   }
-  buf = g->data;
+  buf = gst_queue_array_peek_nth (adapter->bufqueue, idx);
   bsize = gst_buffer_get_size (buf);
   while (G_UNLIKELY (skip >= bsize)) {
     skip -= bsize;
-    g = g_slist_next (g);
+    idx++;
     adapter->scan_offset += bsize;
-    adapter->scan_entry = g;
-    buf = g->data;
+    adapter->scan_entry_idx = idx;
+    buf = gst_queue_array_peek_nth (adapter->bufqueue, idx);
     bsize = gst_buffer_get_size (buf);
   }
   /* get the data now */
@@ -1026,18 +1338,12 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
   /* now find data */
   do {
     bsize = MIN (bsize, size);
-    for (i = 0; i < bsize; i++) {
-      state = ((state << 8) | bdata[i]);
-      if (G_UNLIKELY ((state & mask) == pattern)) {
-        /* we have a match but we need to have skipped at
-         * least 4 bytes to fill the state. */
-        if (G_LIKELY (skip + i >= 3)) {
-          if (G_LIKELY (value))
-            *value = state;
-          gst_buffer_unmap (buf, &info);
-          return offset + skip + i - 3;
-        }
-      }
+    i = _gst_masked_scan_uint32 (bdata, bsize, mask, pattern, skip, &state);
+    if (i >= 0) {
+      if (G_LIKELY (value))
+        *value = state;
+      gst_buffer_unmap (buf, &info);
+      return offset + skip + i - 3;
     }
     size -= bsize;
     if (size == 0)
@@ -1045,11 +1351,11 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
 
     /* nothing found yet, go to next buffer */
     skip += bsize;
-    g = g_slist_next (g);
+    idx++;
     adapter->scan_offset += info.size;
-    adapter->scan_entry = g;
+    adapter->scan_entry_idx = idx;
     gst_buffer_unmap (buf, &info);
-    buf = g->data;
+    buf = gst_queue_array_peek_nth (adapter->bufqueue, idx);
 
     if (!gst_buffer_map (buf, &info, GST_MAP_READ))
       return -1;
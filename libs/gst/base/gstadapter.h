@@ -54,17 +54,25 @@ void                    gst_adapter_clear               (GstAdapter *adapter);
 void                    gst_adapter_push                (GstAdapter *adapter, GstBuffer* buf);
 gconstpointer           gst_adapter_map                 (GstAdapter *adapter, gsize size);
 void                    gst_adapter_unmap               (GstAdapter *adapter);
+const GstMapInfo *      gst_adapter_map_regions         (GstAdapter *adapter, gsize size,
+                                                         guint *n_regions);
+void                    gst_adapter_unmap_regions       (GstAdapter *adapter);
 void                    gst_adapter_copy                (GstAdapter *adapter, gpointer dest,
                                                          gsize offset, gsize size);
 void                    gst_adapter_flush               (GstAdapter *adapter, gsize flush);
 gpointer                gst_adapter_take                (GstAdapter *adapter, gsize nbytes);
 GstBuffer*              gst_adapter_take_buffer         (GstAdapter *adapter, gsize nbytes);
+GstBuffer*              gst_adapter_take_buffer_fast    (GstAdapter *adapter, gsize nbytes);
 GList*                  gst_adapter_take_list           (GstAdapter *adapter, gsize nbytes);
 gsize                   gst_adapter_available           (GstAdapter *adapter);
 gsize                   gst_adapter_available_fast      (GstAdapter *adapter);
 
 GstClockTime            gst_adapter_prev_pts            (GstAdapter *adapter, guint64 *distance);
 GstClockTime            gst_adapter_prev_dts            (GstAdapter *adapter, guint64 *distance);
+GstClockTime            gst_adapter_prev_pts_at_offset  (GstAdapter *adapter, gsize offset,
+                                                         guint64 *distance);
+GstClockTime            gst_adapter_prev_dts_at_offset  (GstAdapter *adapter, gsize offset,
+                                                         guint64 *distance);
 
 gssize                  gst_adapter_masked_scan_uint32  (GstAdapter * adapter, guint32 mask,
                                                          guint32 pattern, gsize offset, gsize size);
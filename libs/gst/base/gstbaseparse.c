@@ -206,6 +206,9 @@
 #include <string.h>
 
 #include <gst/base/gstadapter.h>
+#include <gst/base/gstbytereader.h>
+#include <gst/base/gstbytewriter.h>
+#include <gst/base/gstqueuearray.h>
 
 #include "gstbaseparse.h"
 
@@ -219,6 +222,28 @@
 #define MIN_FRAMES_TO_POST_BITRATE 10
 #define TARGET_DIFFERENCE          (20 * GST_SECOND)
 #define MAX_INDEX_ENTRIES          4096
+/* minimum rate of a SKIP segment that only pushes keyframes */
+#define TRICKMODE_MIN_RATE         2.0
+
+/* index file layout, all values big endian:
+ *  header: "GSTI", version (32 bits), upstream size (64 bits),
+ *          number of entries (32 bits)
+ *  entry:  time (64 bits), byte offset (64 bits), flags (32 bits)
+ * the entries are sorted by time and offset */
+#define INDEX_FILE_MAGIC           GST_MAKE_FOURCC ('G','S','T','I')
+#define INDEX_FILE_VERSION         1
+#define INDEX_FILE_HEADER_SIZE     20
+#define INDEX_FILE_ENTRY_SIZE      20
+
+#define DEFAULT_INDEX_LOCATION     NULL
+#define DEFAULT_REVERSE_WINDOW_SIZE (1024 * 1024)
+
+enum
+{
+  PROP_0,
+  PROP_INDEX_LOCATION,
+  PROP_REVERSE_WINDOW_SIZE
+};
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_parse_debug);
 #define GST_CAT_DEFAULT gst_base_parse_debug
@@ -291,6 +316,13 @@ struct _GstBaseParsePrivate
   /* frames/buffers that are queued and ready to go on OK */
   GQueue queued_frames;
 
+  /* frame batching, buffers are collected in batch_list and pushed together
+   * once there are batch_max_frames or batch_max_duration of them */
+  guint batch_max_frames;
+  GstClockTime batch_max_duration;
+  GstBufferList *batch_list;
+  GstClockTime batch_duration;
+
   GstBuffer *cache;
 
   /* index entry storage, either ours or provided */
@@ -298,6 +330,10 @@ struct _GstBaseParsePrivate
   gint index_id;
   gboolean own_index;
   GMutex index_lock;
+  /* file to load the index from and save it to, with LOCK */
+  gchar *index_location;
+  /* upstream size recorded in the loaded index file or -1 */
+  gint64 index_file_size;
 
   /* seek table entries only maintained if upstream is BYTE seekable */
   gboolean upstream_seekable;
@@ -316,11 +352,15 @@ struct _GstBaseParsePrivate
   /* seek events are temporarily kept to match them with newsegments */
   GSList *pending_seeks;
 
-  /* reverse playback */
-  GSList *buffers_pending;
-  GSList *buffers_head;
-  GSList *buffers_queued;
-  GSList *buffers_send;
+  /* reverse playback. head and pending are in stream order, queued is in
+   * parsing order and send is in reverse order so that the next buffer to
+   * push is its tail */
+  GstQueueArray *buffers_pending;
+  GstQueueArray *buffers_head;
+  GstQueueArray *buffers_queued;
+  GstQueueArray *buffers_send;
+  /* maximum number of bytes of a fragment, with LOCK */
+  guint reverse_window_size;
   GstClockTime last_pts;
   GstClockTime last_dts;
   gint64 last_offset;
@@ -347,6 +387,10 @@ struct _GstBaseParsePrivate
 
   /* if TRUE, a STREAM_START event needs to be pushed */
   gboolean push_stream_start;
+
+  /* pts of the last keyframe pushed in trick mode, in pull mode the next
+   * keyframe after it is looked up in the index */
+  GstClockTime trickmode_last_pts;
 };
 
 typedef struct _GstBaseParseSeek
@@ -395,10 +439,15 @@ gst_base_parse_get_type (void)
 }
 
 static void gst_base_parse_finalize (GObject * object);
+static void gst_base_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_base_parse_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
 
 static GstStateChangeReturn gst_base_parse_change_state (GstElement * element,
     GstStateChange transition);
 static void gst_base_parse_reset (GstBaseParse * parse);
+static void gst_base_parse_reset_own_index (GstBaseParse * parse);
 
 #if 0
 static void gst_base_parse_set_index (GstElement * element, GstIndex * index);
@@ -458,23 +507,24 @@ static GstFlowReturn gst_base_parse_finish_fragment (GstBaseParse * parse,
 static inline GstFlowReturn gst_base_parse_check_sync (GstBaseParse * parse);
 
 static gboolean gst_base_parse_is_seekable (GstBaseParse * parse);
+static GstFlowReturn gst_base_parse_push_batch (GstBaseParse * parse);
+
+static void
+gst_base_parse_clear_buffers (GstQueueArray * buffers)
+{
+  GstBuffer *buf;
+
+  while ((buf = gst_queue_array_pop_head (buffers)))
+    gst_buffer_unref (buf);
+}
 
 static void
 gst_base_parse_clear_queues (GstBaseParse * parse)
 {
-  g_slist_foreach (parse->priv->buffers_queued, (GFunc) gst_buffer_unref, NULL);
-  g_slist_free (parse->priv->buffers_queued);
-  parse->priv->buffers_queued = NULL;
-  g_slist_foreach (parse->priv->buffers_pending, (GFunc) gst_buffer_unref,
-      NULL);
-  g_slist_free (parse->priv->buffers_pending);
-  parse->priv->buffers_pending = NULL;
-  g_slist_foreach (parse->priv->buffers_head, (GFunc) gst_buffer_unref, NULL);
-  g_slist_free (parse->priv->buffers_head);
-  parse->priv->buffers_head = NULL;
-  g_slist_foreach (parse->priv->buffers_send, (GFunc) gst_buffer_unref, NULL);
-  g_slist_free (parse->priv->buffers_send);
-  parse->priv->buffers_send = NULL;
+  gst_base_parse_clear_buffers (parse->priv->buffers_queued);
+  gst_base_parse_clear_buffers (parse->priv->buffers_pending);
+  gst_base_parse_clear_buffers (parse->priv->buffers_head);
+  gst_base_parse_clear_buffers (parse->priv->buffers_send);
 
   g_list_foreach (parse->priv->detect_buffers, (GFunc) gst_buffer_unref, NULL);
   g_list_free (parse->priv->detect_buffers);
@@ -487,6 +537,12 @@ gst_base_parse_clear_queues (GstBaseParse * parse)
 
   gst_buffer_replace (&parse->priv->cache, NULL);
 
+  if (parse->priv->batch_list) {
+    gst_buffer_list_unref (parse->priv->batch_list);
+    parse->priv->batch_list = NULL;
+  }
+  parse->priv->batch_duration = 0;
+
   g_list_foreach (parse->priv->pending_events, (GFunc) gst_event_unref, NULL);
   g_list_free (parse->priv->pending_events);
   parse->priv->pending_events = NULL;
@@ -516,12 +572,64 @@ gst_base_parse_finalize (GObject * object)
     parse->priv->index = NULL;
   }
   g_mutex_clear (&parse->priv->index_lock);
+  g_free (parse->priv->index_location);
 
   gst_base_parse_clear_queues (parse);
+  gst_queue_array_free (parse->priv->buffers_queued);
+  gst_queue_array_free (parse->priv->buffers_pending);
+  gst_queue_array_free (parse->priv->buffers_head);
+  gst_queue_array_free (parse->priv->buffers_send);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+static void
+gst_base_parse_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstBaseParse *parse = GST_BASE_PARSE (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (parse);
+      g_free (parse->priv->index_location);
+      parse->priv->index_location = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_REVERSE_WINDOW_SIZE:
+      GST_OBJECT_LOCK (parse);
+      parse->priv->reverse_window_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_base_parse_get_property (GObject * object, guint prop_id, GValue * value,
+    GParamSpec * pspec)
+{
+  GstBaseParse *parse = GST_BASE_PARSE (object);
+
+  switch (prop_id) {
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (parse);
+      g_value_set_string (value, parse->priv->index_location);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    case PROP_REVERSE_WINDOW_SIZE:
+      GST_OBJECT_LOCK (parse);
+      g_value_set_uint (value, parse->priv->reverse_window_size);
+      GST_OBJECT_UNLOCK (parse);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 gst_base_parse_class_init (GstBaseParseClass * klass)
 {
@@ -532,6 +640,41 @@ gst_base_parse_class_init (GstBaseParseClass * klass)
   g_type_class_add_private (klass, sizeof (GstBaseParsePrivate));
   parent_class = g_type_class_peek_parent (klass);
   gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_base_parse_finalize);
+  gobject_class->set_property = gst_base_parse_set_property;
+  gobject_class->get_property = gst_base_parse_get_property;
+
+  /**
+   * GstBaseParse:index-location:
+   *
+   * Location of a file that holds the seek index of the stream. When set,
+   * the index is loaded from the file when going to PAUSED and written back
+   * with the entries collected while parsing when going to READY, so later
+   * seeks in the same stream don't need to scan for a sync point. The
+   * loaded index is ignored when the upstream size does not match the size
+   * recorded in the file.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index Location",
+          "Location of the file to load and save the seek index",
+          DEFAULT_INDEX_LOCATION, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstBaseParse:reverse-window-size:
+   *
+   * Maximum number of bytes that are read and parsed at once in reverse
+   * playback. The data between two keyframes is collected in windows of at
+   * most this size, which bounds the memory that is used for queueing the
+   * frames of a window before they are pushed in reverse order.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_REVERSE_WINDOW_SIZE,
+      g_param_spec_uint ("reverse-window-size", "Reverse Window Size",
+          "Maximum number of bytes parsed at once in reverse playback",
+          2048, G_MAXUINT, DEFAULT_REVERSE_WINDOW_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class = (GstElementClass *) klass;
   gstelement_class->change_state =
@@ -594,12 +737,19 @@ gst_base_parse_init (GstBaseParse * parse, GstBaseParseClass * bclass)
   GST_DEBUG_OBJECT (parse, "src created");
 
   g_queue_init (&parse->priv->queued_frames);
+  parse->priv->buffers_pending = gst_queue_array_new (16);
+  parse->priv->buffers_head = gst_queue_array_new (16);
+  parse->priv->buffers_queued = gst_queue_array_new (64);
+  parse->priv->buffers_send = gst_queue_array_new (64);
+  parse->priv->reverse_window_size = DEFAULT_REVERSE_WINDOW_SIZE;
 
   parse->priv->adapter = gst_adapter_new ();
 
   parse->priv->pad_mode = GST_PAD_MODE_NONE;
 
   g_mutex_init (&parse->priv->index_lock);
+  parse->priv->index_location = DEFAULT_INDEX_LOCATION;
+  parse->priv->index_file_size = -1;
 
   /* init state */
   gst_base_parse_reset (parse);
@@ -759,6 +909,7 @@ gst_base_parse_reset (GstBaseParse * parse)
   parse->priv->last_dts = GST_CLOCK_TIME_NONE;
   parse->priv->last_pts = GST_CLOCK_TIME_NONE;
   parse->priv->last_offset = 0;
+  parse->priv->trickmode_last_pts = GST_CLOCK_TIME_NONE;
 
   g_list_foreach (parse->priv->pending_events, (GFunc) gst_mini_object_unref,
       NULL);
@@ -1072,6 +1223,8 @@ gst_base_parse_sink_event_default (GstBaseParse * parse, GstEvent * event)
         GST_ELEMENT_ERROR (parse, STREAM, WRONG_TYPE,
             ("No valid frames found before end of stream"), (NULL));
       }
+      gst_base_parse_push_batch (parse);
+
       /* newsegment and other serialized events before eos */
       if (G_UNLIKELY (parse->priv->pending_events)) {
         GList *l;
@@ -1150,6 +1303,9 @@ gst_base_parse_sink_event_default (GstBaseParse * parse, GstEvent * event)
    */
   if (event) {
     if (!GST_EVENT_IS_SERIALIZED (event) || forward_immediate) {
+      /* batched frames go out before serialized events */
+      if (GST_EVENT_IS_SERIALIZED (event))
+        gst_base_parse_push_batch (parse);
       ret = gst_pad_push_event (parse->srcpad, event);
     } else {
       // GST_VIDEO_DECODER_STREAM_LOCK (decoder);
@@ -1742,6 +1898,13 @@ done:
   parse->priv->upstream_seekable = seekable;
   parse->priv->upstream_size = seekable ? stop : 0;
 
+  /* an index loaded from a file is only valid for the same stream */
+  if (parse->priv->index_file_size != -1 &&
+      (!seekable || parse->priv->index_file_size != stop)) {
+    GST_INFO_OBJECT (parse, "upstream size changed, discarding loaded index");
+    gst_base_parse_reset_own_index (parse);
+  }
+
   GST_DEBUG_OBJECT (parse, "idx_interval: %ums", idx_interval);
   parse->priv->idx_interval = idx_interval * GST_MSECOND;
   parse->priv->idx_byte_interval = idx_byte_interval;
@@ -1896,7 +2059,8 @@ gst_base_parse_handle_buffer (GstBaseParse * parse, GstBuffer * buffer,
     GstBuffer *outbuf;
 
     GST_LOG_OBJECT (parse, "finding sync, skipping %d bytes", *skip);
-    if (parse->segment.rate < 0.0 && !parse->priv->buffers_queued) {
+    if (parse->segment.rate < 0.0 &&
+        gst_queue_array_is_empty (parse->priv->buffers_queued)) {
       /* reverse playback, and no frames found yet, so we are skipping
        * the leading part of a fragment, which may form the tail of
        * fragment coming later, hopefully subclass skips efficiently ... */
@@ -1906,8 +2070,7 @@ gst_base_parse_handle_buffer (GstBaseParse * parse, GstBuffer * buffer,
       outbuf = gst_buffer_make_writable (outbuf);
       GST_BUFFER_PTS (outbuf) = pts;
       GST_BUFFER_DTS (outbuf) = dts;
-      parse->priv->buffers_head =
-          g_slist_prepend (parse->priv->buffers_head, outbuf);
+      gst_queue_array_push_tail (parse->priv->buffers_head, outbuf);
       outbuf = NULL;
     } else {
       gst_adapter_flush (parse->priv->adapter, *skip);
@@ -2023,6 +2186,58 @@ gst_base_parse_handle_and_push_frame (GstBaseParse * parse,
   return gst_base_parse_push_frame (parse, frame);
 }
 
+/* in forward trick mode, video delta units are dropped and only keyframes
+ * are pushed */
+static inline gboolean
+gst_base_parse_is_trickmode (GstBaseParse * parse)
+{
+  return parse->priv->is_video &&
+      (parse->segment.flags & GST_SEGMENT_FLAG_SKIP) &&
+      parse->segment.rate > TRICKMODE_MIN_RATE;
+}
+
+/* pushes the frames collected for batching downstream */
+static GstFlowReturn
+gst_base_parse_push_batch (GstBaseParse * parse)
+{
+  GstBufferList *list = parse->priv->batch_list;
+
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  parse->priv->batch_list = NULL;
+  parse->priv->batch_duration = 0;
+
+  GST_LOG_OBJECT (parse, "pushing %u batched frames",
+      gst_buffer_list_length (list));
+
+  return gst_pad_push_list (parse->srcpad, list);
+}
+
+static GstFlowReturn
+gst_base_parse_batch_buffer (GstBaseParse * parse, GstBuffer * buffer)
+{
+  GstBaseParsePrivate *priv = parse->priv;
+
+  if (priv->batch_list == NULL)
+    priv->batch_list =
+        gst_buffer_list_new_sized (MIN (priv->batch_max_frames, 64));
+
+  if (GST_BUFFER_DURATION_IS_VALID (buffer))
+    priv->batch_duration += GST_BUFFER_DURATION (buffer);
+
+  GST_LOG_OBJECT (parse, "batching frame (%" G_GSIZE_FORMAT " bytes)",
+      gst_buffer_get_size (buffer));
+  gst_buffer_list_add (priv->batch_list, buffer);
+
+  if (gst_buffer_list_length (priv->batch_list) >= priv->batch_max_frames ||
+      (GST_CLOCK_TIME_IS_VALID (priv->batch_max_duration) &&
+          priv->batch_duration >= priv->batch_max_duration))
+    return gst_base_parse_push_batch (parse);
+
+  return GST_FLOW_OK;
+}
+
 /**
  * gst_base_parse_push_frame:
  * @parse: #GstBaseParse.
@@ -2093,9 +2308,15 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
 
   /* Push pending events, including SEGMENT events */
   if (G_UNLIKELY (parse->priv->pending_events)) {
-    GList *r = g_list_reverse (parse->priv->pending_events);
+    GList *r;
     GList *l;
 
+    /* batched frames go before the events */
+    ret = gst_base_parse_push_batch (parse);
+    if (ret != GST_FLOW_OK)
+      goto batch_failed;
+
+    r = g_list_reverse (parse->priv->pending_events);
     parse->priv->pending_events = NULL;
     for (l = r; l != NULL; l = l->next) {
       gst_pad_push_event (parse->srcpad, GST_EVENT (l->data));
@@ -2104,8 +2325,10 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
     parse->priv->pending_segment = FALSE;
   }
 
-  /* segment adjustment magic; only if we are running the whole show */
+  /* segment adjustment magic; only if we are running the whole show. Gaps
+   * between keyframes are expected in trick mode */
   if (!parse->priv->passthrough && parse->segment.rate > 0.0 &&
+      !gst_base_parse_is_trickmode (parse) &&
       (parse->priv->pad_mode == GST_PAD_MODE_PULL ||
           parse->priv->upstream_seekable)) {
     /* handle gaps */
@@ -2129,6 +2352,10 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
             GST_TIME_ARGS (parse->segment.position),
             GST_TIME_ARGS (last_start));
 
+        ret = gst_base_parse_push_batch (parse);
+        if (ret != GST_FLOW_OK)
+          goto batch_failed;
+
         /* skip gap FIXME */
         gst_pad_push_event (parse->srcpad,
             gst_event_new_segment (&parse->segment));
@@ -2166,7 +2393,11 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
   parse->priv->seen_keyframe |= parse->priv->is_video &&
       !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
 
-  if (frame->flags & GST_BASE_PARSE_FRAME_FLAG_CLIP) {
+  if (G_UNLIKELY (gst_base_parse_is_trickmode (parse)) &&
+      GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    GST_LOG_OBJECT (parse, "Dropped delta unit in trick mode");
+    ret = GST_BASE_PARSE_FLOW_DROPPED;
+  } else if (frame->flags & GST_BASE_PARSE_FRAME_FLAG_CLIP) {
     if (GST_BUFFER_TIMESTAMP_IS_VALID (buffer) &&
         GST_CLOCK_TIME_IS_VALID (parse->segment.stop) &&
         GST_BUFFER_TIMESTAMP (buffer) >
@@ -2196,15 +2427,19 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
     ret = GST_FLOW_OK;
   } else if (ret == GST_FLOW_OK) {
     if (parse->segment.rate > 0.0) {
-      GST_LOG_OBJECT (parse, "pushing frame (%" G_GSIZE_FORMAT " bytes) now..",
-          size);
-      ret = gst_pad_push (parse->srcpad, buffer);
-      GST_LOG_OBJECT (parse, "frame pushed, flow %s", gst_flow_get_name (ret));
+      if (parse->priv->batch_max_frames > 0 && !parse->priv->passthrough) {
+        ret = gst_base_parse_batch_buffer (parse, buffer);
+      } else {
+        GST_LOG_OBJECT (parse,
+            "pushing frame (%" G_GSIZE_FORMAT " bytes) now..", size);
+        ret = gst_pad_push (parse->srcpad, buffer);
+        GST_LOG_OBJECT (parse, "frame pushed, flow %s",
+            gst_flow_get_name (ret));
+      }
     } else {
       GST_LOG_OBJECT (parse, "frame (%" G_GSIZE_FORMAT " bytes) queued for now",
           size);
-      parse->priv->buffers_queued =
-          g_slist_prepend (parse->priv->buffers_queued, buffer);
+      gst_queue_array_push_tail (parse->priv->buffers_queued, buffer);
       ret = GST_FLOW_OK;
     }
   } else {
@@ -2224,6 +2459,10 @@ gst_base_parse_push_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
       parse->segment.position < last_stop)
     parse->segment.position = last_stop;
 
+  if (ret == GST_FLOW_OK && parse->priv->pad_mode == GST_PAD_MODE_PULL &&
+      gst_base_parse_is_trickmode (parse) && last_start != GST_CLOCK_TIME_NONE)
+    parse->priv->trickmode_last_pts = last_start;
+
   return ret;
 
   /* ERRORS */
@@ -2232,6 +2471,14 @@ no_caps:
     GST_ELEMENT_ERROR (parse, STREAM, DECODE, ("No caps set"), (NULL));
     return GST_FLOW_ERROR;
   }
+batch_failed:
+  {
+    GST_LOG_OBJECT (parse, "pushing batched frames failed: %s",
+        gst_flow_get_name (ret));
+    gst_buffer_replace (&frame->out_buffer, NULL);
+    gst_buffer_replace (&frame->buffer, NULL);
+    return ret;
+  }
 }
 
 /**
@@ -2372,15 +2619,12 @@ gst_base_parse_drain (GstBaseParse * parse)
 static GstFlowReturn
 gst_base_parse_send_buffers (GstBaseParse * parse)
 {
-  GSList *send = NULL;
+  GstQueueArray *send = parse->priv->buffers_send;
   GstBuffer *buf;
   GstFlowReturn ret = GST_FLOW_OK;
 
-  send = parse->priv->buffers_send;
-
   /* send buffers */
-  while (send) {
-    buf = GST_BUFFER_CAST (send->data);
+  while ((buf = gst_queue_array_pop_tail (send))) {
     GST_LOG_OBJECT (parse, "pushing buffer %p, dts %"
         GST_TIME_FORMAT ", pts %" GST_TIME_FORMAT ", duration %" GST_TIME_FORMAT
         ", offset %" G_GINT64_FORMAT, buf,
@@ -2390,20 +2634,12 @@ gst_base_parse_send_buffers (GstBaseParse * parse)
 
     /* iterate output queue an push downstream */
     ret = gst_pad_push (parse->srcpad, buf);
-    send = g_slist_delete_link (send, send);
 
     /* clear any leftover if error */
-    if (G_UNLIKELY (ret != GST_FLOW_OK)) {
-      while (send) {
-        buf = GST_BUFFER_CAST (send->data);
-        gst_buffer_unref (buf);
-        send = g_slist_delete_link (send, send);
-      }
-    }
+    if (G_UNLIKELY (ret != GST_FLOW_OK))
+      gst_base_parse_clear_buffers (send);
   }
 
-  parse->priv->buffers_send = send;
-
   return ret;
 }
 
@@ -2415,6 +2651,8 @@ gst_base_parse_send_buffers (GstBaseParse * parse)
 static GstFlowReturn
 gst_base_parse_start_fragment (GstBaseParse * parse)
 {
+  GstQueueArray *tmp;
+
   GST_LOG_OBJECT (parse, "starting fragment");
 
   /* invalidate so no fall-back timestamping is performed;
@@ -2429,8 +2667,10 @@ gst_base_parse_start_fragment (GstBaseParse * parse)
   parse->priv->discont = TRUE;
 
   /* head of previous fragment is now pending tail of current fragment */
+  tmp = parse->priv->buffers_pending;
+  gst_base_parse_clear_buffers (tmp);
   parse->priv->buffers_pending = parse->priv->buffers_head;
-  parse->priv->buffers_head = NULL;
+  parse->priv->buffers_head = tmp;
 
   return GST_FLOW_OK;
 }
@@ -2453,10 +2693,7 @@ gst_base_parse_finish_fragment (GstBaseParse * parse, gboolean prev_head)
 
   GST_LOG_OBJECT (parse, "finishing fragment");
 
-  /* restore order */
-  parse->priv->buffers_pending = g_slist_reverse (parse->priv->buffers_pending);
-  while (parse->priv->buffers_pending) {
-    buf = GST_BUFFER_CAST (parse->priv->buffers_pending->data);
+  while ((buf = gst_queue_array_pop_head (parse->priv->buffers_pending))) {
     if (prev_head) {
       GST_LOG_OBJECT (parse, "adding pending buffer (size %" G_GSIZE_FORMAT ")",
           gst_buffer_get_size (buf));
@@ -2465,25 +2702,20 @@ gst_base_parse_finish_fragment (GstBaseParse * parse, gboolean prev_head)
       GST_LOG_OBJECT (parse, "discarding head buffer");
       gst_buffer_unref (buf);
     }
-    parse->priv->buffers_pending =
-        g_slist_delete_link (parse->priv->buffers_pending,
-        parse->priv->buffers_pending);
   }
 
   /* chain looks for frames and queues resulting ones (in stead of pushing) */
   /* initial skipped data is added to buffers_pending */
   gst_base_parse_drain (parse);
 
-  if (parse->priv->buffers_send) {
-    buf = GST_BUFFER_CAST (parse->priv->buffers_send->data);
+  if ((buf = gst_queue_array_peek_tail (parse->priv->buffers_send)))
     seen_key |= !GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
-  }
 
   /* add metadata (if needed to queued buffers */
   GST_LOG_OBJECT (parse, "last timestamp: %" GST_TIME_FORMAT,
       GST_TIME_ARGS (parse->priv->last_pts));
-  while (parse->priv->buffers_queued) {
-    buf = GST_BUFFER_CAST (parse->priv->buffers_queued->data);
+  /* walk the queued buffers from the last parsed one backwards */
+  while ((buf = gst_queue_array_peek_tail (parse->priv->buffers_queued))) {
 
     /* no touching if upstream or parsing provided time */
     if (GST_BUFFER_PTS_IS_VALID (buf)) {
@@ -2524,9 +2756,8 @@ gst_base_parse_finish_fragment (GstBaseParse * parse, gboolean prev_head)
         ret = gst_base_parse_send_buffers (parse);
         /* if a problem, throw all to sending */
         if (ret != GST_FLOW_OK) {
-          parse->priv->buffers_send =
-              g_slist_reverse (parse->priv->buffers_queued);
-          parse->priv->buffers_queued = NULL;
+          while ((buf = gst_queue_array_pop_tail (parse->priv->buffers_queued)))
+            gst_queue_array_push_tail (parse->priv->buffers_send, buf);
           break;
         }
         seen_key = FALSE;
@@ -2536,11 +2767,8 @@ gst_base_parse_finish_fragment (GstBaseParse * parse, gboolean prev_head)
       seen_key = TRUE;
     }
 
-    parse->priv->buffers_send =
-        g_slist_prepend (parse->priv->buffers_send, buf);
-    parse->priv->buffers_queued =
-        g_slist_delete_link (parse->priv->buffers_queued,
-        parse->priv->buffers_queued);
+    gst_queue_array_pop_tail (parse->priv->buffers_queued);
+    gst_queue_array_push_tail (parse->priv->buffers_send, buf);
   }
 
   /* audio may have all marked as keyframe, so arrange to send here */
@@ -2750,6 +2978,14 @@ gst_base_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   }
 
 done:
+  /* don't hold back batched frames until the next buffer */
+  if (parse->priv->batch_list) {
+    GstFlowReturn bret = gst_base_parse_push_batch (parse);
+
+    if (ret == GST_FLOW_OK)
+      ret = bret;
+  }
+
   GST_LOG_OBJECT (parse, "chain leaving");
   return ret;
 }
@@ -2838,6 +3074,7 @@ gst_base_parse_handle_previous_fragment (GstBaseParse * parse)
   GstClockTime ts = 0;
   GstBuffer *buffer;
   GstFlowReturn ret;
+  guint window;
 
   GST_DEBUG_OBJECT (parse, "fragment ended; last_ts = %" GST_TIME_FORMAT
       ", last_offset = %" G_GINT64_FORMAT,
@@ -2851,8 +3088,12 @@ gst_base_parse_handle_previous_fragment (GstBaseParse * parse)
     goto exit;
   }
 
+  GST_OBJECT_LOCK (parse);
+  window = parse->priv->reverse_window_size;
+  GST_OBJECT_UNLOCK (parse);
+
   /* last fragment started at last_offset / last_ts;
-   * seek back 10s capped at 1MB */
+   * seek back 10s capped at the window size */
   if (parse->priv->last_pts >= 10 * GST_SECOND)
     ts = parse->priv->last_pts - 10 * GST_SECOND;
   /* if we are exact now, we will be more so going backwards */
@@ -2864,7 +3105,7 @@ gst_base_parse_handle_previous_fragment (GstBaseParse * parse)
       GST_DEBUG_OBJECT (parse, "conversion failed, only BYTE based");
     }
   }
-  offset = CLAMP (offset, parse->priv->last_offset - 1024 * 1024,
+  offset = CLAMP (offset, parse->priv->last_offset - window,
       parse->priv->last_offset - 1024);
   offset = MAX (0, offset);
 
@@ -2985,6 +3226,37 @@ done:
   return ret;
 }
 
+/* in pull mode trick mode, continue reading at the next keyframe of the
+ * index after the last pushed one */
+static void
+gst_base_parse_trickmode_skip (GstBaseParse * parse)
+{
+  GstClockTime last_pts = parse->priv->trickmode_last_pts;
+  GstClockTime ts;
+  gint64 offset;
+
+  parse->priv->trickmode_last_pts = GST_CLOCK_TIME_NONE;
+
+  if (!gst_base_parse_is_trickmode (parse))
+    return;
+
+  offset = gst_base_parse_find_offset (parse, last_pts + 1, FALSE, &ts);
+  if (offset <= parse->priv->offset || !GST_CLOCK_TIME_IS_VALID (ts))
+    return;
+
+  GST_DEBUG_OBJECT (parse, "trick mode, skipping to keyframe at %"
+      GST_TIME_FORMAT ", offset %" G_GINT64_FORMAT, GST_TIME_ARGS (ts),
+      offset);
+
+  parse->priv->offset = offset;
+  parse->priv->last_offset = offset;
+  parse->priv->sync_offset = offset;
+  parse->priv->discont = TRUE;
+  parse->priv->next_dts = ts;
+  if (parse->priv->pts_interpolate)
+    parse->priv->next_pts = ts;
+}
+
 /* Loop that is used in pull mode to retrieve data from upstream */
 static void
 gst_base_parse_loop (GstPad * pad)
@@ -3027,6 +3299,11 @@ gst_base_parse_loop (GstPad * pad)
   if (ret != GST_FLOW_OK)
     goto done;
 
+  /* after a keyframe in trick mode, don't read the delta units that would be
+   * dropped when the index knows where the next keyframe is */
+  if (G_UNLIKELY (parse->priv->trickmode_last_pts != GST_CLOCK_TIME_NONE))
+    gst_base_parse_trickmode_skip (parse);
+
   /* eat expected eos signalling past segment in reverse playback */
   if (parse->segment.rate < 0.0 && ret == GST_FLOW_EOS &&
       parse->segment.position >= parse->segment.stop) {
@@ -3062,6 +3339,11 @@ pause:
         gst_flow_get_name (ret));
     gst_pad_pause_task (parse->sinkpad);
 
+    /* push out what was collected, unless we are flushing */
+    if (ret == GST_FLOW_EOS || ret == GST_FLOW_NOT_LINKED ||
+        ret < GST_FLOW_EOS)
+      gst_base_parse_push_batch (parse);
+
     if (ret == GST_FLOW_EOS) {
       /* handle end-of-stream/segment */
       if (parse->segment.flags & GST_SEGMENT_FLAG_SEGMENT) {
@@ -3321,6 +3603,37 @@ gst_base_parse_set_min_frame_size (GstBaseParse * parse, guint min_size)
   GST_LOG_OBJECT (parse, "set frame_min_size: %d", min_size);
 }
 
+/**
+ * gst_base_parse_set_frame_batching:
+ * @parse: #GstBaseParse.
+ * @max_frames: maximum number of frames to push at once, 0 to disable
+ *     batching
+ * @max_duration: maximum duration of the batched frames or
+ *     #GST_CLOCK_TIME_NONE
+ *
+ * Subclass can use this function to have the base class collect the
+ * parsed frames and push them together in a #GstBufferList once there are
+ * @max_frames of them or their duration reaches @max_duration. This is
+ * useful for parsers that produce many small frames, like audio parsers.
+ * Batched frames are always pushed before any serialized event and when
+ * all data of an input buffer was parsed, so they are never held back
+ * waiting for more data. Batching is not used in reverse playback or in
+ * passthrough mode.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_parse_set_frame_batching (GstBaseParse * parse, guint max_frames,
+    GstClockTime max_duration)
+{
+  g_return_if_fail (parse != NULL);
+
+  parse->priv->batch_max_frames = max_frames;
+  parse->priv->batch_max_duration = max_duration;
+  GST_LOG_OBJECT (parse, "set frame batching: %u frames, duration %"
+      GST_TIME_FORMAT, max_frames, GST_TIME_ARGS (max_duration));
+}
+
 /**
  * gst_base_parse_set_frame_rate:
  * @parse: the #GstBaseParse to set
@@ -3638,6 +3951,15 @@ gst_base_parse_src_query_default (GstBaseParse * parse, GstQuery * query)
       }
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:
+    {
+      /* the adapter is only used by the streaming thread, its size is read
+       * without a lock and can be slightly off */
+      gst_query_add_memory_usage (query, GST_OBJECT_CAST (parse), 0,
+          gst_adapter_available (parse->priv->adapter));
+      res = TRUE;
+      break;
+    }
     default:
       res = gst_pad_query_default (pad, GST_OBJECT_CAST (parse), query);
       break;
@@ -3701,6 +4023,16 @@ gst_base_parse_find_frame (GstBaseParse * parse, gint64 * pos,
       "frame with time %" GST_TIME_FORMAT " at offset %" G_GINT64_FORMAT,
       GST_TIME_ARGS (*time), *pos);
 
+  /* remember the sync points we come across, later seeks can use them */
+  if (parse->priv->upstream_seekable && GST_CLOCK_TIME_IS_VALID (*time) &&
+      !GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    gst_base_parse_add_index_entry (parse, *pos, *time, TRUE, TRUE);
+    /* the index now consists of several intervals */
+    parse->priv->index_last_valid = FALSE;
+    parse->priv->index_last_offset = 0;
+    parse->priv->index_last_ts = 0;
+  }
+
 done:
   if (sframe)
     gst_base_parse_frame_free (sframe);
@@ -3715,13 +4047,16 @@ done:
 
 /* bisect and scan through file for frame starting before @time,
  * returns OK and @time/@offset if found, NONE and/or error otherwise
- * If @time == G_MAXINT64, scan for duration ( == last frame) */
+ * If @time == G_MAXINT64, scan for duration ( == last frame)
+ * The search starts from the closest index entries around @time and
+ * interpolates the next position, falling back to plain bisection when
+ * that doesn't halve the range so the number of probes stays logarithmic */
 static GstFlowReturn
 gst_base_parse_locate_time (GstBaseParse * parse, GstClockTime * _time,
     gint64 * _offset)
 {
   GstFlowReturn ret = GST_FLOW_OK;
-  gint64 lpos, hpos, newpos;
+  gint64 lpos, hpos, newpos, span = G_MAXINT64;
   GstClockTime time, ltime, htime, newtime, dur;
   gboolean cont = TRUE;
   const GstClockTime tolerance = TARGET_DIFFERENCE;
@@ -3775,6 +4110,29 @@ gst_base_parse_locate_time (GstBaseParse * parse, GstClockTime * _time,
     return GST_FLOW_OK;
   }
 
+  /* narrow the bounds with the sync points we already know about */
+  if (time != G_MAXINT64) {
+    GstClockTime its;
+    gint64 ipos;
+
+    ipos = gst_base_parse_find_offset (parse, time, TRUE, &its);
+    if (ipos > lpos && ipos < hpos && GST_CLOCK_TIME_IS_VALID (its) &&
+        its > ltime && its <= time) {
+      lpos = ipos;
+      ltime = its;
+    }
+    ipos = gst_base_parse_find_offset (parse, time, FALSE, &its);
+    if (ipos > lpos && ipos < hpos && GST_CLOCK_TIME_IS_VALID (its) &&
+        its > time && its < htime) {
+      hpos = ipos;
+      htime = its;
+    }
+    GST_DEBUG_OBJECT (parse,
+        "Bounds from index: bytes %" G_GINT64_FORMAT " %" G_GINT64_FORMAT
+        ", times %" GST_TIME_FORMAT " %" GST_TIME_FORMAT, lpos, hpos,
+        GST_TIME_ARGS (ltime), GST_TIME_ARGS (htime));
+  }
+
   /* shortcut cases */
   if (time < ltime) {
     goto exit;
@@ -3798,9 +4156,15 @@ gst_base_parse_locate_time (GstBaseParse * parse, GstClockTime * _time,
     if (G_UNLIKELY (time == G_MAXINT64)) {
       newpos = hpos;
     } else if (G_LIKELY (hpos > lpos)) {
-      newpos =
-          gst_util_uint64_scale (hpos - lpos, time - ltime, htime - ltime) +
-          lpos - chunk;
+      if (hpos - lpos > span / 2) {
+        /* the last probe did not halve the range, bisect */
+        newpos = lpos + (hpos - lpos) / 2;
+      } else {
+        newpos =
+            gst_util_uint64_scale (hpos - lpos, time - ltime, htime - ltime) +
+            lpos - chunk;
+      }
+      span = hpos - lpos;
     } else {
       /* should mean lpos == hpos, since lpos <= hpos is invariant */
       newpos = lpos;
@@ -4101,6 +4465,7 @@ gst_base_parse_handle_seek (GstBaseParse * parse, GstEvent * event)
       parse->priv->sync_offset = seekpos;
       parse->priv->exact_position = accurate;
     }
+    parse->priv->trickmode_last_pts = GST_CLOCK_TIME_NONE;
 
     /* Start streaming thread if paused */
     gst_pad_start_task (parse->sinkpad,
@@ -4252,11 +4617,166 @@ gst_base_parse_get_index (GstElement * element)
 }
 #endif
 
+/* with INDEX_LOCK */
+static void
+gst_base_parse_create_own_index (GstBaseParse * parse)
+{
+  parse->priv->index = g_object_new (gst_mem_index_get_type (), NULL);
+  gst_index_get_writer_id (parse->priv->index, GST_OBJECT (parse),
+      &parse->priv->index_id);
+  parse->priv->own_index = TRUE;
+  parse->priv->index_file_size = -1;
+}
+
+static void
+gst_base_parse_reset_own_index (GstBaseParse * parse)
+{
+  GST_BASE_PARSE_INDEX_LOCK (parse);
+  if (parse->priv->own_index) {
+    gst_object_unref (parse->priv->index);
+    gst_base_parse_create_own_index (parse);
+  }
+  GST_BASE_PARSE_INDEX_UNLOCK (parse);
+
+  parse->priv->index_last_ts = GST_CLOCK_TIME_NONE;
+  parse->priv->index_last_offset = -1;
+  parse->priv->index_last_valid = TRUE;
+}
+
+/* with INDEX_LOCK, fills our own index with the entries of the index file */
+static void
+gst_base_parse_load_index (GstBaseParse * parse, const gchar * location)
+{
+  GError *err = NULL;
+  GstByteReader reader;
+  guint8 *data;
+  gsize size;
+  guint32 magic, version, n_entries, i;
+  guint64 upstream_size;
+
+  if (!g_file_get_contents (location, (gchar **) & data, &size, &err)) {
+    GST_DEBUG_OBJECT (parse, "no index loaded: %s", err->message);
+    g_error_free (err);
+    return;
+  }
+
+  gst_byte_reader_init (&reader, data, size);
+  if (!gst_byte_reader_get_uint32_be (&reader, &magic) ||
+      !gst_byte_reader_get_uint32_be (&reader, &version) ||
+      !gst_byte_reader_get_uint64_be (&reader, &upstream_size) ||
+      !gst_byte_reader_get_uint32_be (&reader, &n_entries))
+    goto invalid_file;
+
+  if (magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION ||
+      upstream_size > G_MAXINT64 ||
+      gst_byte_reader_get_remaining (&reader) / INDEX_FILE_ENTRY_SIZE <
+      n_entries)
+    goto invalid_file;
+
+  for (i = 0; i < n_entries; i++) {
+    GstIndexAssociation associations[2];
+    guint64 ts, offset;
+    guint32 flags;
+
+    gst_byte_reader_get_uint64_be (&reader, &ts);
+    gst_byte_reader_get_uint64_be (&reader, &offset);
+    gst_byte_reader_get_uint32_be (&reader, &flags);
+
+    if (!GST_CLOCK_TIME_IS_VALID (ts) || offset >= upstream_size)
+      continue;
+
+    associations[0].format = GST_FORMAT_TIME;
+    associations[0].value = ts;
+    associations[1].format = GST_FORMAT_BYTES;
+    associations[1].value = offset;
+
+    gst_index_add_associationv (parse->priv->index, parse->priv->index_id,
+        flags & (GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT |
+            GST_INDEX_ASSOCIATION_FLAG_DELTA_UNIT), 2,
+        (const GstIndexAssociation *) &associations);
+  }
+
+  GST_INFO_OBJECT (parse, "loaded %u index entries from %s", n_entries,
+      location);
+  parse->priv->index_file_size = upstream_size;
+
+  /* the index now consists of several intervals, new entries are checked
+   * against the existing ones */
+  parse->priv->index_last_valid = FALSE;
+  parse->priv->index_last_offset = 0;
+  parse->priv->index_last_ts = 0;
+
+  g_free (data);
+  return;
+
+  /* ERRORS */
+invalid_file:
+  {
+    GST_WARNING_OBJECT (parse, "ignoring invalid index file %s", location);
+    g_free (data);
+    return;
+  }
+}
+
+/* with INDEX_LOCK, writes the entries of our own index to a file */
+static void
+gst_base_parse_save_index (GstBaseParse * parse, const gchar * location)
+{
+  GError *err = NULL;
+  GstByteWriter writer;
+  GArray *entries;
+  guint i, n_entries;
+  gsize size;
+  guint8 *data;
+
+  if (!parse->priv->own_index || !parse->priv->upstream_seekable)
+    return;
+
+  entries = gst_mem_index_get_entries (GST_MEM_INDEX (parse->priv->index),
+      parse->priv->index_id, GST_FORMAT_TIME);
+  if (entries == NULL || entries->len == 0)
+    return;
+
+  n_entries = entries->len;
+  gst_byte_writer_init_with_size (&writer,
+      INDEX_FILE_HEADER_SIZE + n_entries * INDEX_FILE_ENTRY_SIZE, FALSE);
+  gst_byte_writer_put_uint32_be (&writer, INDEX_FILE_MAGIC);
+  gst_byte_writer_put_uint32_be (&writer, INDEX_FILE_VERSION);
+  gst_byte_writer_put_uint64_be (&writer, parse->priv->upstream_size);
+  gst_byte_writer_put_uint32_be (&writer, n_entries);
+
+  for (i = 0; i < n_entries; i++) {
+    GstIndexEntry *entry = g_array_index (entries, GstIndexEntry *, i);
+    gint64 ts = -1, offset = -1;
+
+    gst_index_entry_assoc_map (entry, GST_FORMAT_TIME, &ts);
+    gst_index_entry_assoc_map (entry, GST_FORMAT_BYTES, &offset);
+
+    gst_byte_writer_put_uint64_be (&writer, ts);
+    gst_byte_writer_put_uint64_be (&writer, offset);
+    gst_byte_writer_put_uint32_be (&writer, GST_INDEX_ASSOC_FLAGS (entry));
+  }
+
+  size = gst_byte_writer_get_size (&writer);
+  data = gst_byte_writer_reset_and_get_data (&writer);
+
+  if (!g_file_set_contents (location, (gchar *) data, size, &err)) {
+    GST_WARNING_OBJECT (parse, "could not save index to %s: %s", location,
+        err->message);
+    g_error_free (err);
+  } else {
+    GST_INFO_OBJECT (parse, "saved %u index entries to %s", n_entries,
+        location);
+  }
+  g_free (data);
+}
+
 static GstStateChangeReturn
 gst_base_parse_change_state (GstElement * element, GstStateChange transition)
 {
   GstBaseParse *parse;
   GstStateChangeReturn result;
+  gchar *location = NULL;
 
   parse = GST_BASE_PARSE (element);
 
@@ -4274,12 +4794,14 @@ gst_base_parse_change_state (GstElement * element, GstStateChange transition)
       /* If no index was created, generate one */
       if (G_UNLIKELY (!parse->priv->index)) {
         GST_DEBUG_OBJECT (parse, "no index provided creating our own");
-
-        parse->priv->index = g_object_new (gst_mem_index_get_type (), NULL);
-        gst_index_get_writer_id (parse->priv->index, GST_OBJECT (parse),
-            &parse->priv->index_id);
-        parse->priv->own_index = TRUE;
+        gst_base_parse_create_own_index (parse);
       }
+
+      GST_OBJECT_LOCK (parse);
+      location = g_strdup (parse->priv->index_location);
+      GST_OBJECT_UNLOCK (parse);
+      if (location && parse->priv->own_index)
+        gst_base_parse_load_index (parse, location);
       GST_BASE_PARSE_INDEX_UNLOCK (parse);
       break;
     default:
@@ -4290,11 +4812,21 @@ gst_base_parse_change_state (GstElement * element, GstStateChange transition)
 
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_OBJECT_LOCK (parse);
+      location = g_strdup (parse->priv->index_location);
+      GST_OBJECT_UNLOCK (parse);
+      if (location) {
+        GST_BASE_PARSE_INDEX_LOCK (parse);
+        gst_base_parse_save_index (parse, location);
+        GST_BASE_PARSE_INDEX_UNLOCK (parse);
+      }
       gst_base_parse_reset (parse);
       break;
     default:
       break;
   }
 
+  g_free (location);
+
   return result;
 }
@@ -303,6 +303,10 @@ void            gst_base_parse_set_average_bitrate (GstBaseParse   * parse,
 void            gst_base_parse_set_min_frame_size (GstBaseParse    * parse,
                                                    guint             min_size);
 
+void            gst_base_parse_set_frame_batching (GstBaseParse    * parse,
+                                                   guint             max_frames,
+                                                   GstClockTime      max_duration);
+
 void            gst_base_parse_set_has_timing_info (GstBaseParse   * parse,
                                                     gboolean         has_timing);
 
@@ -149,6 +149,7 @@
 #include <gst/gst_private.h>
 
 #include "gstbasesink.h"
+#include "gstqueuearray.h"
 #include <gst/gst-i18n-lib.h>
 
 GST_DEBUG_CATEGORY_STATIC (gst_base_sink_debug);
@@ -159,6 +160,9 @@ GST_DEBUG_CATEGORY_STATIC (gst_base_sink_debug);
 
 #define GST_FLOW_STEP GST_FLOW_CUSTOM_ERROR
 
+/* number of log2 microsecond buckets of the lateness histogram */
+#define LATENESS_BUCKETS 32
+
 typedef struct
 {
   gboolean valid;               /* if this info is valid */
@@ -271,6 +275,43 @@ struct _GstBaseSinkPrivate
   GstClockTime rc_time;
   GstClockTime rc_next;
   gsize rc_accumulated;
+
+  /* handle buffer lists as one unit */
+  gint batch_lists;             /* ATOMIC */
+  /* stop time of the last buffer of the list being synced */
+  GstClockTime list_stop;
+
+  /* don't wait for the clock when this close to the render time */
+  GstClockTime sync_window;
+
+  /* go to PLAYING without prerolling when upstream is live */
+  gint fast_start;              /* ATOMIC */
+  /* the current start from READY skips the preroll */
+  gboolean fast_starting;
+
+  /* number of buffers queued for the render thread, 0 to render in the
+   * streaming thread, with LOCK */
+  guint render_queue_size;
+  /* the render thread, only while activated in push mode */
+  GstTask *render_task;
+  GRecMutex render_task_lock;
+  /* protects the fields below */
+  GMutex render_lock;
+  GCond render_cond;
+  /* buffers, lists and serialized events for the render thread */
+  GstQueueArray *render_queue;
+  /* the number of buffers and lists in render_queue and its maximum */
+  guint render_queued;
+  guint render_queue_max;
+  gboolean render_flushing;
+  /* result of the last render, returned upstream */
+  GstFlowReturn render_result;
+
+  /* for the stats property, protected with the OBJECT_LOCK */
+  GstClockTime max_render;
+  GstClockTimeDiff stats_avg_jitter;
+  guint64 n_jitter;
+  guint64 lateness[LATENESS_BUCKETS];
 };
 
 #define DO_RUNNING_AVG(avg,val,size) (((val) + ((size)-1) * (avg)) / (size))
@@ -299,6 +340,10 @@ struct _GstBaseSinkPrivate
 #define DEFAULT_ENABLE_LAST_SAMPLE  TRUE
 #define DEFAULT_THROTTLE_TIME       0
 #define DEFAULT_MAX_BITRATE         0
+#define DEFAULT_BATCH_LISTS         FALSE
+#define DEFAULT_SYNC_WINDOW         0
+#define DEFAULT_FAST_START          FALSE
+#define DEFAULT_RENDER_QUEUE_SIZE   0
 
 enum
 {
@@ -314,6 +359,11 @@ enum
   PROP_RENDER_DELAY,
   PROP_THROTTLE_TIME,
   PROP_MAX_BITRATE,
+  PROP_BATCH_LISTS,
+  PROP_SYNC_WINDOW,
+  PROP_FAST_START,
+  PROP_RENDER_QUEUE_SIZE,
+  PROP_STATS,
   PROP_LAST
 };
 
@@ -382,6 +432,8 @@ static GstFlowReturn gst_base_sink_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
 static GstFlowReturn gst_base_sink_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * list);
+static GstFlowReturn gst_base_sink_render_list_buffers (GstBaseSink * basesink,
+    GstBufferList * list);
 
 static void gst_base_sink_loop (GstPad * pad);
 static gboolean gst_base_sink_pad_activate (GstPad * pad, GstObject * parent);
@@ -398,11 +450,18 @@ static gboolean gst_base_sink_default_query (GstBaseSink * sink,
     GstQuery * query);
 
 static gboolean gst_base_sink_negotiate_pull (GstBaseSink * basesink);
+static void gst_base_sink_reset_qos (GstBaseSink * sink);
 static GstCaps *gst_base_sink_default_fixate (GstBaseSink * bsink,
     GstCaps * caps);
 static GstCaps *gst_base_sink_fixate (GstBaseSink * bsink, GstCaps * caps);
 
 /* check if an object was too late */
+static GstFlowReturn gst_base_sink_render_queue_push (GstBaseSink * basesink,
+    GstMiniObject * obj, gboolean is_data);
+static void gst_base_sink_render_set_flushing (GstBaseSink * basesink,
+    gboolean flushing);
+static gboolean gst_base_sink_serialized_event (GstBaseSink * basesink,
+    GstEvent * event);
 static gboolean gst_base_sink_is_too_late (GstBaseSink * basesink,
     GstMiniObject * obj, GstClockTime rstart, GstClockTime rstop,
     GstClockReturn status, GstClockTimeDiff jitter);
@@ -536,6 +595,82 @@ gst_base_sink_class_init (GstBaseSinkClass * klass)
           "The maximum bits per second to render (0 = disabled)", 0,
           G_MAXUINT64, DEFAULT_MAX_BITRATE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:batch-lists:
+   *
+   * Handle buffer lists as one unit. The list is synchronized once on the
+   * timestamp of its first buffer, its duration spans up to the end of its
+   * last buffer and QoS is done once for the whole list. When the subclass
+   * does not implement render_list, the buffers of the list are rendered one
+   * after the other without waiting for the clock in between.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BATCH_LISTS,
+      g_param_spec_boolean ("batch-lists", "Batch lists",
+          "Synchronize and render buffer lists as one unit",
+          DEFAULT_BATCH_LISTS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:sync-window:
+   *
+   * When synchronizing, buffers with a render time less than this amount
+   * of time ahead of the clock are rendered immediately instead of waiting
+   * for the clock. With a high rate of small buffers this avoids a wakeup
+   * for each buffer at the cost of rendering them up to this much early.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_SYNC_WINDOW,
+      g_param_spec_uint64 ("sync-window", "Sync window",
+          "Render buffers that are this close to their render time without "
+          "waiting for the clock (0 = disabled)", 0, G_MAXUINT64,
+          DEFAULT_SYNC_WINDOW, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:fast-start:
+   *
+   * When the pipeline is set to PLAYING from READY or lower and upstream is
+   * live, go through PAUSED without waiting for preroll, as if
+   * #GstBaseSink:async was disabled for this state change. No ASYNC_START
+   * and ASYNC_DONE messages are posted and the sink does not hold up the
+   * state change of the pipeline. Live sources don't produce data in PAUSED
+   * so there is nothing to preroll on anyway.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_FAST_START,
+      g_param_spec_boolean ("fast-start", "Fast start",
+          "Don't preroll when going to PLAYING with a live upstream",
+          DEFAULT_FAST_START, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:render-queue-size:
+   *
+   * When not 0, buffers are synchronized and rendered in a separate thread
+   * of the sink. Up to this number of buffers are queued for it before the
+   * upstream streaming thread blocks, so that a slow #GstBaseSinkClass.render()
+   * or waiting for the clock does not hold up upstream. Serialized events
+   * are queued with the buffers. The new value is used when the sink is
+   * activated the next time.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_RENDER_QUEUE_SIZE,
+      g_param_spec_uint ("render-queue-size", "Render queue size",
+          "Number of buffers queued for a separate render thread "
+          "(0 = render in the streaming thread)", 0, G_MAXUINT,
+          DEFAULT_RENDER_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSink:stats:
+   *
+   * Various #GstBaseSink statistics. See gst_base_sink_get_stats() for the
+   * fields of the structure.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Sink statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_sink_change_state);
@@ -667,6 +802,16 @@ gst_base_sink_init (GstBaseSink * basesink, gpointer g_class)
   g_atomic_int_set (&priv->enable_last_sample, DEFAULT_ENABLE_LAST_SAMPLE);
   priv->throttle_time = DEFAULT_THROTTLE_TIME;
   priv->max_bitrate = DEFAULT_MAX_BITRATE;
+  g_atomic_int_set (&priv->batch_lists, DEFAULT_BATCH_LISTS);
+  priv->list_stop = GST_CLOCK_TIME_NONE;
+  priv->sync_window = DEFAULT_SYNC_WINDOW;
+  g_atomic_int_set (&priv->fast_start, DEFAULT_FAST_START);
+  priv->render_queue_size = DEFAULT_RENDER_QUEUE_SIZE;
+  g_rec_mutex_init (&priv->render_task_lock);
+  g_mutex_init (&priv->render_lock);
+  g_cond_init (&priv->render_cond);
+  priv->render_queue = gst_queue_array_new (16);
+  gst_base_sink_reset_qos (basesink);
 
   GST_OBJECT_FLAG_SET (basesink, GST_ELEMENT_FLAG_SINK);
 }
@@ -681,6 +826,11 @@ gst_base_sink_finalize (GObject * object)
   g_mutex_clear (&basesink->preroll_lock);
   g_cond_clear (&basesink->preroll_cond);
 
+  gst_queue_array_free (basesink->priv->render_queue);
+  g_rec_mutex_clear (&basesink->priv->render_task_lock);
+  g_mutex_clear (&basesink->priv->render_lock);
+  g_cond_clear (&basesink->priv->render_cond);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -1317,6 +1467,254 @@ gst_base_sink_get_max_bitrate (GstBaseSink * sink)
   return res;
 }
 
+/**
+ * gst_base_sink_set_batch_lists:
+ * @sink: a #GstBaseSink
+ * @batch: %TRUE to handle buffer lists as one unit
+ *
+ * Configures @sink to synchronize, render and do QoS on buffer lists as a
+ * whole instead of for each buffer of the list. See #GstBaseSink:batch-lists.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_sink_set_batch_lists (GstBaseSink * sink, gboolean batch)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  g_atomic_int_set (&sink->priv->batch_lists, batch);
+}
+
+/**
+ * gst_base_sink_get_batch_lists:
+ * @sink: a #GstBaseSink
+ *
+ * Checks if @sink handles buffer lists as one unit.
+ *
+ * Returns: %TRUE if buffer lists are handled as one unit.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_base_sink_get_batch_lists (GstBaseSink * sink)
+{
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), FALSE);
+
+  return g_atomic_int_get (&sink->priv->batch_lists);
+}
+
+/**
+ * gst_base_sink_set_fast_start:
+ * @sink: a #GstBaseSink
+ * @enabled: %TRUE to go to PLAYING without preroll when upstream is live
+ *
+ * Configures @sink to skip the preroll when it is started to PLAYING with a
+ * live upstream. See #GstBaseSink:fast-start.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_sink_set_fast_start (GstBaseSink * sink, gboolean enabled)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  g_atomic_int_set (&sink->priv->fast_start, enabled);
+}
+
+/**
+ * gst_base_sink_get_fast_start:
+ * @sink: a #GstBaseSink
+ *
+ * Checks if @sink skips the preroll when started to PLAYING with a live
+ * upstream.
+ *
+ * Returns: %TRUE if fast start is enabled.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_base_sink_get_fast_start (GstBaseSink * sink)
+{
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), FALSE);
+
+  return g_atomic_int_get (&sink->priv->fast_start);
+}
+
+/**
+ * gst_base_sink_set_render_queue_size:
+ * @sink: a #GstBaseSink
+ * @size: the number of buffers to queue
+ *
+ * Set the number of buffers that are queued for a separate render thread,
+ * 0 renders in the streaming thread. See #GstBaseSink:render-queue-size.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_sink_set_render_queue_size (GstBaseSink * sink, guint size)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  GST_OBJECT_LOCK (sink);
+  sink->priv->render_queue_size = size;
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/**
+ * gst_base_sink_get_render_queue_size:
+ * @sink: a #GstBaseSink
+ *
+ * Get the number of buffers that are queued for a separate render thread,
+ * see gst_base_sink_set_render_queue_size().
+ *
+ * Returns: the render queue size of @sink.
+ *
+ * Since: 1.2
+ */
+guint
+gst_base_sink_get_render_queue_size (GstBaseSink * sink)
+{
+  guint res;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), 0);
+
+  GST_OBJECT_LOCK (sink);
+  res = sink->priv->render_queue_size;
+  GST_OBJECT_UNLOCK (sink);
+
+  return res;
+}
+
+/**
+ * gst_base_sink_set_sync_window:
+ * @sink: a #GstBaseSink
+ * @window: the sync window
+ *
+ * Set the time before the render time of a buffer in which @sink renders it
+ * right away instead of waiting for the clock. See #GstBaseSink:sync-window.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_sink_set_sync_window (GstBaseSink * sink, GstClockTime window)
+{
+  g_return_if_fail (GST_IS_BASE_SINK (sink));
+
+  GST_OBJECT_LOCK (sink);
+  sink->priv->sync_window = window;
+  GST_OBJECT_UNLOCK (sink);
+}
+
+/**
+ * gst_base_sink_get_sync_window:
+ * @sink: a #GstBaseSink
+ *
+ * Get the sync window of @sink, see gst_base_sink_set_sync_window().
+ *
+ * Returns: the sync window of @sink.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_base_sink_get_sync_window (GstBaseSink * sink)
+{
+  GstClockTime res;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), 0);
+
+  GST_OBJECT_LOCK (sink);
+  res = sink->priv->sync_window;
+  GST_OBJECT_UNLOCK (sink);
+
+  return res;
+}
+
+/* with OBJECT_LOCK */
+static GstClockTime
+gst_base_sink_lateness_percentile (GstBaseSinkPrivate * priv, guint percent)
+{
+  guint64 count, needed;
+  guint i;
+
+  if (priv->n_jitter == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  needed = (priv->n_jitter * percent + 99) / 100;
+  count = 0;
+  for (i = 0; i < LATENESS_BUCKETS - 1; i++) {
+    count += priv->lateness[i];
+    if (count >= needed)
+      break;
+  }
+  /* the first bucket holds the objects that were not late, the others the
+   * ones below the upper bound of the bucket */
+  if (i == 0)
+    return 0;
+
+  return ((guint64) 1 << i) * GST_USECOND;
+}
+
+/**
+ * gst_base_sink_get_stats:
+ * @sink: #GstBaseSink
+ *
+ * Return various #GstBaseSink statistics. This function returns a
+ * #GstStructure with name "GstBaseSinkStats" with the following fields:
+ *
+ * <itemizedlist>
+ * <listitem>"rendered"  G_TYPE_UINT64    the number of rendered objects</listitem>
+ * <listitem>"dropped"   G_TYPE_UINT64    the number of objects dropped
+ *     because they were too late</listitem>
+ * <listitem>"average-rate"  G_TYPE_DOUBLE   the average processing rate
+ *     as sent in QoS events, -1.0 when unknown</listitem>
+ * <listitem>"average-jitter"  G_TYPE_INT64   the average jitter of the
+ *     synchronized objects</listitem>
+ * <listitem>"average-render-time"  G_TYPE_UINT64   the average time spent
+ *     in the render function</listitem>
+ * <listitem>"max-render-time"  G_TYPE_UINT64   the maximum time spent
+ *     in the render function</listitem>
+ * <listitem>"lateness-p50", "lateness-p90", "lateness-p99"  G_TYPE_UINT64
+ *     upper bounds of the lateness percentiles of the synchronized
+ *     objects, rounded up to a power of two microseconds</listitem>
+ * </itemizedlist>
+ *
+ * Render times are only measured when #GstBaseSink:qos is enabled. Values
+ * that are not known are #GST_CLOCK_TIME_NONE. The statistics are reset
+ * when the sink is flushed and when it goes to READY.
+ *
+ * Returns: (transfer full): pointer to #GstStructure
+ *
+ * Since: 1.2
+ */
+GstStructure *
+gst_base_sink_get_stats (GstBaseSink * sink)
+{
+  GstBaseSinkPrivate *priv;
+  GstStructure *s;
+
+  g_return_val_if_fail (GST_IS_BASE_SINK (sink), NULL);
+
+  priv = sink->priv;
+
+  GST_OBJECT_LOCK (sink);
+  s = gst_structure_new ("GstBaseSinkStats",
+      "rendered", G_TYPE_UINT64, priv->rendered,
+      "dropped", G_TYPE_UINT64, priv->dropped,
+      "average-rate", G_TYPE_DOUBLE, priv->avg_rate,
+      "average-jitter", G_TYPE_INT64, priv->stats_avg_jitter,
+      "average-render-time", G_TYPE_UINT64, priv->avg_render,
+      "max-render-time", G_TYPE_UINT64, priv->max_render,
+      "lateness-p50", G_TYPE_UINT64,
+      gst_base_sink_lateness_percentile (priv, 50),
+      "lateness-p90", G_TYPE_UINT64,
+      gst_base_sink_lateness_percentile (priv, 90),
+      "lateness-p99", G_TYPE_UINT64,
+      gst_base_sink_lateness_percentile (priv, 99), NULL);
+  GST_OBJECT_UNLOCK (sink);
+
+  return s;
+}
+
 static void
 gst_base_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -1354,6 +1752,18 @@ gst_base_sink_set_property (GObject * object, guint prop_id,
     case PROP_MAX_BITRATE:
       gst_base_sink_set_max_bitrate (sink, g_value_get_uint64 (value));
       break;
+    case PROP_BATCH_LISTS:
+      gst_base_sink_set_batch_lists (sink, g_value_get_boolean (value));
+      break;
+    case PROP_SYNC_WINDOW:
+      gst_base_sink_set_sync_window (sink, g_value_get_uint64 (value));
+      break;
+    case PROP_FAST_START:
+      gst_base_sink_set_fast_start (sink, g_value_get_boolean (value));
+      break;
+    case PROP_RENDER_QUEUE_SIZE:
+      gst_base_sink_set_render_queue_size (sink, g_value_get_uint (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1400,6 +1810,21 @@ gst_base_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_MAX_BITRATE:
       g_value_set_uint64 (value, gst_base_sink_get_max_bitrate (sink));
       break;
+    case PROP_BATCH_LISTS:
+      g_value_set_boolean (value, gst_base_sink_get_batch_lists (sink));
+      break;
+    case PROP_SYNC_WINDOW:
+      g_value_set_uint64 (value, gst_base_sink_get_sync_window (sink));
+      break;
+    case PROP_FAST_START:
+      g_value_set_boolean (value, gst_base_sink_get_fast_start (sink));
+      break;
+    case PROP_RENDER_QUEUE_SIZE:
+      g_value_set_uint (value, gst_base_sink_get_render_queue_size (sink));
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, gst_base_sink_get_stats (sink));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1869,6 +2294,12 @@ again:
     } else {
       *do_sync = TRUE;
     }
+
+    /* this is the first buffer of a batched list, it lasts until the end of
+     * the last buffer */
+    if (G_UNLIKELY (GST_CLOCK_TIME_IS_VALID (priv->list_stop)) &&
+        GST_CLOCK_TIME_IS_VALID (start) && priv->list_stop > start)
+      stop = priv->list_stop;
   }
 
   GST_DEBUG_OBJECT (basesink, "got times start: %" GST_TIME_FORMAT
@@ -2023,7 +2454,7 @@ gst_base_sink_wait_clock (GstBaseSink * sink, GstClockTime time,
 {
   GstClockReturn ret;
   GstClock *clock;
-  GstClockTime base_time;
+  GstClockTime base_time, now;
 
   if (G_UNLIKELY (!GST_CLOCK_TIME_IS_VALID (time)))
     goto invalid_time;
@@ -2043,6 +2474,15 @@ gst_base_sink_wait_clock (GstBaseSink * sink, GstClockTime time,
   /* add base_time to running_time to get the time against the clock */
   time += base_time;
 
+  if (sink->priv->sync_window > 0) {
+    now = gst_clock_get_time (clock);
+
+    /* close enough, don't wait. Report the same result and jitter as the
+     * clock would have. */
+    if (time <= now + sink->priv->sync_window)
+      goto in_window;
+  }
+
   /* Re-use existing clockid if available */
   /* FIXME: Casting to GstClockEntry only works because the types
    * are the same */
@@ -2094,6 +2534,16 @@ no_clock:
     GST_OBJECT_UNLOCK (sink);
     return GST_CLOCK_BADTIME;
   }
+in_window:
+  {
+    GST_OBJECT_UNLOCK (sink);
+    GST_LOG_OBJECT (sink, "time %" GST_TIME_FORMAT " within sync window of %"
+        GST_TIME_FORMAT, GST_TIME_ARGS (time), GST_TIME_ARGS (now));
+    if (jitter)
+      *jitter = GST_CLOCK_DIFF (time, now);
+
+    return time <= now ? GST_CLOCK_EARLY : GST_CLOCK_OK;
+  }
 }
 
 /**
@@ -2341,6 +2791,34 @@ flushing:
  *
  * does not take ownership of obj.
  */
+/* with PREROLL_LOCK
+ *
+ * Updates the jitter average and the lateness histogram of the stats
+ * property with the jitter of a synchronized object. */
+static void
+gst_base_sink_record_lateness (GstBaseSink * basesink, GstClockTimeDiff jitter)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+  guint64 usecs;
+  guint bucket;
+
+  usecs = jitter > 0 ? jitter / GST_USECOND : 0;
+  if (usecs >= G_MAXUINT32)
+    bucket = LATENESS_BUCKETS - 1;
+  else
+    bucket = MIN (g_bit_storage ((gulong) usecs), LATENESS_BUCKETS - 1);
+
+  GST_OBJECT_LOCK (basesink);
+  if (priv->n_jitter == 0)
+    priv->stats_avg_jitter = jitter;
+  else
+    priv->stats_avg_jitter = UPDATE_RUNNING_AVG (priv->stats_avg_jitter,
+        jitter);
+  priv->n_jitter++;
+  priv->lateness[bucket]++;
+  GST_OBJECT_UNLOCK (basesink);
+}
+
 static GstFlowReturn
 gst_base_sink_do_sync (GstBaseSink * basesink,
     GstMiniObject * obj, gboolean * late, gboolean * step_end)
@@ -2478,6 +2956,7 @@ again:
 
   /* successful syncing done, record observation */
   priv->current_jitter = jitter;
+  gst_base_sink_record_lateness (basesink, jitter);
 
   /* check if the object should be dropped */
   *late = gst_base_sink_is_too_late (basesink, obj, rstart, rstop,
@@ -2626,6 +3105,7 @@ gst_base_sink_perform_qos (GstBaseSink * sink, gboolean dropped)
     rate = 1.0;
 
   if (GST_CLOCK_TIME_IS_VALID (priv->last_left)) {
+    GST_OBJECT_LOCK (sink);
     if (dropped || priv->avg_rate < 0.0) {
       priv->avg_rate = rate;
     } else {
@@ -2634,6 +3114,7 @@ gst_base_sink_perform_qos (GstBaseSink * sink, gboolean dropped)
       else
         priv->avg_rate = UPDATE_RUNNING_AVG_P (priv->avg_rate, rate);
     }
+    GST_OBJECT_UNLOCK (sink);
   }
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_QOS, sink,
@@ -2687,12 +3168,18 @@ gst_base_sink_reset_qos (GstBaseSink * sink)
   priv->last_left = GST_CLOCK_TIME_NONE;
   priv->avg_duration = GST_CLOCK_TIME_NONE;
   priv->avg_pt = GST_CLOCK_TIME_NONE;
+  priv->avg_in_diff = GST_CLOCK_TIME_NONE;
+
+  GST_OBJECT_LOCK (sink);
   priv->avg_rate = -1.0;
   priv->avg_render = GST_CLOCK_TIME_NONE;
-  priv->avg_in_diff = GST_CLOCK_TIME_NONE;
+  priv->max_render = GST_CLOCK_TIME_NONE;
   priv->rendered = 0;
   priv->dropped = 0;
-
+  priv->stats_avg_jitter = 0;
+  priv->n_jitter = 0;
+  memset (priv->lateness, 0, sizeof (priv->lateness));
+  GST_OBJECT_UNLOCK (sink);
 }
 
 /* Checks if the object was scheduled too late.
@@ -2816,11 +3303,17 @@ gst_base_sink_do_render_stats (GstBaseSink * basesink, gboolean start)
 
     elapsed = GST_CLOCK_DIFF (priv->start, priv->stop);
 
+    GST_OBJECT_LOCK (basesink);
     if (!GST_CLOCK_TIME_IS_VALID (priv->avg_render))
       priv->avg_render = elapsed;
     else
       priv->avg_render = UPDATE_RUNNING_AVG (priv->avg_render, elapsed);
 
+    if (!GST_CLOCK_TIME_IS_VALID (priv->max_render)
+        || elapsed > priv->max_render)
+      priv->max_render = elapsed;
+    GST_OBJECT_UNLOCK (basesink);
+
     GST_CAT_DEBUG_OBJECT (GST_CAT_QOS, basesink,
         "avg_render: %" GST_TIME_FORMAT, GST_TIME_ARGS (priv->avg_render));
   }
@@ -2832,6 +3325,8 @@ gst_base_sink_flush_start (GstBaseSink * basesink, GstPad * pad)
   /* make sure we are not blocked on the clock also clear any pending
    * eos state. */
   gst_base_sink_set_flushing (basesink, pad, TRUE);
+  /* and wait for the render thread to let go of the data */
+  gst_base_sink_render_set_flushing (basesink, TRUE);
 
   /* we grab the stream lock but that is not needed since setting the
    * sink to flushing would make sure no state commit is being done
@@ -2884,6 +3379,8 @@ gst_base_sink_flush_stop (GstBaseSink * basesink, GstPad * pad,
     gst_element_post_message (GST_ELEMENT_CAST (basesink),
         gst_message_new_reset_time (GST_OBJECT_CAST (basesink), 0));
   }
+
+  gst_base_sink_render_set_flushing (basesink, FALSE);
 }
 
 static GstFlowReturn
@@ -3067,6 +3564,46 @@ done:
   return result;
 }
 
+/* with STREAM_LOCK or from the render thread */
+static gboolean
+gst_base_sink_serialized_event (GstBaseSink * basesink, GstEvent * event)
+{
+  GstBaseSinkClass *bclass;
+  gboolean result = TRUE;
+
+  bclass = GST_BASE_SINK_GET_CLASS (basesink);
+
+  GST_BASE_SINK_PREROLL_LOCK (basesink);
+  if (G_UNLIKELY (basesink->flushing))
+    goto flushing;
+
+  if (G_UNLIKELY (basesink->priv->received_eos))
+    goto after_eos;
+
+  if (bclass->event)
+    result = bclass->event (basesink, event);
+
+  GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+
+  return result;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (basesink, "we are flushing");
+    GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+    gst_event_unref (event);
+    return FALSE;
+  }
+after_eos:
+  {
+    GST_DEBUG_OBJECT (basesink, "Event received after EOS, dropping");
+    GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+    gst_event_unref (event);
+    return FALSE;
+  }
+}
+
 static gboolean
 gst_base_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -3089,44 +3626,19 @@ gst_base_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       break;
     default:
       if (GST_EVENT_IS_SERIALIZED (event)) {
-        GST_BASE_SINK_PREROLL_LOCK (basesink);
-        if (G_UNLIKELY (basesink->flushing))
-          goto flushing;
-
-        if (G_UNLIKELY (basesink->priv->received_eos))
-          goto after_eos;
-
-        if (bclass->event)
-          result = bclass->event (basesink, event);
-
-        GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+        /* keep the event in order with the buffers of the render thread */
+        if (basesink->priv->render_task)
+          result = gst_base_sink_render_queue_push (basesink,
+              GST_MINI_OBJECT_CAST (event), FALSE) == GST_FLOW_OK;
+        else
+          result = gst_base_sink_serialized_event (basesink, event);
       } else {
         if (bclass->event)
           result = bclass->event (basesink, event);
       }
       break;
   }
-done:
   return result;
-
-  /* ERRORS */
-flushing:
-  {
-    GST_DEBUG_OBJECT (basesink, "we are flushing");
-    GST_BASE_SINK_PREROLL_UNLOCK (basesink);
-    gst_event_unref (event);
-    result = FALSE;
-    goto done;
-  }
-
-after_eos:
-  {
-    GST_DEBUG_OBJECT (basesink, "Event received after EOS, dropping");
-    GST_BASE_SINK_PREROLL_UNLOCK (basesink);
-    gst_event_unref (event);
-    result = FALSE;
-    goto done;
-  }
 }
 
 /* default implementation to calculate the start and end
@@ -3200,19 +3712,14 @@ gst_base_sink_chain_unlocked (GstBaseSink * basesink, GstPad * pad,
   gint do_qos;
   gboolean late, step_end;
 
+  priv->list_stop = GST_CLOCK_TIME_NONE;
+
   if (G_UNLIKELY (basesink->flushing))
     goto flushing;
 
   if (G_UNLIKELY (priv->received_eos))
     goto was_eos;
 
-  if (is_list) {
-    sync_buf = gst_buffer_list_get (GST_BUFFER_LIST_CAST (obj), 0);
-    g_assert (NULL != sync_buf);
-  } else {
-    sync_buf = GST_BUFFER_CAST (obj);
-  }
-
   /* for code clarity */
   segment = &basesink->segment;
 
@@ -3236,6 +3743,21 @@ gst_base_sink_chain_unlocked (GstBaseSink * basesink, GstPad * pad,
     GST_OBJECT_UNLOCK (basesink);
   }
 
+  if (is_list) {
+    /* drop the buffers of the list that are outside of the segment in one
+     * go, the list is then handled as a whole */
+    if (segment->format == GST_FORMAT_TIME) {
+      obj = gst_buffer_list_make_writable (GST_BUFFER_LIST_CAST (obj));
+      if (G_UNLIKELY (gst_buffer_list_clip (GST_BUFFER_LIST_CAST (obj),
+                  segment) == 0))
+        goto out_of_segment;
+    }
+    sync_buf = gst_buffer_list_get (GST_BUFFER_LIST_CAST (obj), 0);
+    g_assert (NULL != sync_buf);
+  } else {
+    sync_buf = GST_BUFFER_CAST (obj);
+  }
+
   bclass = GST_BASE_SINK_GET_CLASS (basesink);
 
   /* check if the buffer needs to be dropped, we first ask the subclass for the
@@ -3249,6 +3771,26 @@ gst_base_sink_chain_unlocked (GstBaseSink * basesink, GstPad * pad,
     gst_base_sink_default_get_times (basesink, sync_buf, &start, &end);
   }
 
+  if (is_list && g_atomic_int_get (&priv->batch_lists)) {
+    GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+    GstBuffer *last_buf;
+    GstClockTime lstart = GST_CLOCK_TIME_NONE, lstop = GST_CLOCK_TIME_NONE;
+
+    last_buf = gst_buffer_list_get (list, gst_buffer_list_length (list) - 1);
+    if (bclass->get_times)
+      bclass->get_times (basesink, last_buf, &lstart, &lstop);
+    if (!GST_CLOCK_TIME_IS_VALID (lstart))
+      gst_base_sink_default_get_times (basesink, last_buf, &lstart, &lstop);
+    if (!GST_CLOCK_TIME_IS_VALID (lstop))
+      lstop = lstart;
+
+    if (GST_CLOCK_TIME_IS_VALID (start) && GST_CLOCK_TIME_IS_VALID (lstop) &&
+        lstop > start) {
+      end = lstop;
+      priv->list_stop = lstop;
+    }
+  }
+
   GST_DEBUG_OBJECT (basesink, "got times start: %" GST_TIME_FORMAT
       ", end: %" GST_TIME_FORMAT, GST_TIME_ARGS (start), GST_TIME_ARGS (end));
 
@@ -3267,13 +3809,14 @@ gst_base_sink_chain_unlocked (GstBaseSink * basesink, GstPad * pad,
 
     current = &priv->current_step;
     syncable =
-        gst_base_sink_get_sync_times (basesink, obj, &sstart, &sstop, &rstart,
-        &rstop, &do_sync, &stepped, current, &step_end);
+        gst_base_sink_get_sync_times (basesink,
+        GST_MINI_OBJECT_CAST (sync_buf), &sstart, &sstop, &rstart, &rstop,
+        &do_sync, &stepped, current, &step_end);
 
     if (!stepped && syncable && do_sync)
       late =
-          gst_base_sink_is_too_late (basesink, obj, rstart, rstop,
-          GST_CLOCK_EARLY, 0);
+          gst_base_sink_is_too_late (basesink,
+          GST_MINI_OBJECT_CAST (sync_buf), rstart, rstop, GST_CLOCK_EARLY, 0);
     if (late)
       goto dropped;
 
@@ -3336,6 +3879,9 @@ again:
   } else {
     if (bclass->render_list)
       ret = bclass->render_list (basesink, GST_BUFFER_LIST_CAST (obj));
+    else
+      ret = gst_base_sink_render_list_buffers (basesink,
+          GST_BUFFER_LIST_CAST (obj));
   }
 
   if (do_qos)
@@ -3347,7 +3893,9 @@ again:
   if (G_UNLIKELY (basesink->flushing))
     goto flushing;
 
+  GST_OBJECT_LOCK (basesink);
   priv->rendered++;
+  GST_OBJECT_UNLOCK (basesink);
 
 done:
   if (step_end) {
@@ -3398,7 +3946,9 @@ sync_failed:
   }
 dropped:
   {
+    GST_OBJECT_LOCK (basesink);
     priv->dropped++;
+    GST_OBJECT_UNLOCK (basesink);
     GST_DEBUG_OBJECT (basesink, "buffer late, dropping");
 
     if (g_atomic_int_get (&priv->qos_enabled)) {
@@ -3431,6 +3981,34 @@ dropped:
   }
 }
 
+/* with STREAM_LOCK, PREROLL_LOCK
+ *
+ * Renders the buffers of a batched list with the render function of a
+ * subclass that has no render_list.
+ */
+static GstFlowReturn
+gst_base_sink_render_list_buffers (GstBaseSink * basesink, GstBufferList * list)
+{
+  GstBaseSinkClass *bclass = GST_BASE_SINK_GET_CLASS (basesink);
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstBuffer *buffer = NULL;
+  guint i, len;
+
+  if (bclass->render == NULL)
+    return GST_FLOW_OK;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++) {
+    buffer = gst_buffer_list_get (list, i);
+    ret = bclass->render (basesink, buffer);
+  }
+
+  if (buffer)
+    gst_base_sink_set_last_buffer (basesink, buffer);
+
+  return ret;
+}
+
 /* with STREAM_LOCK
  */
 static GstFlowReturn
@@ -3442,6 +4020,10 @@ gst_base_sink_chain_main (GstBaseSink * basesink, GstPad * pad, gpointer obj,
   if (G_UNLIKELY (basesink->pad_mode != GST_PAD_MODE_PUSH))
     goto wrong_mode;
 
+  if (basesink->priv->render_task)
+    return gst_base_sink_render_queue_push (basesink,
+        GST_MINI_OBJECT_CAST (obj), TRUE);
+
   GST_BASE_SINK_PREROLL_LOCK (basesink);
   result = gst_base_sink_chain_unlocked (basesink, pad, obj, is_list);
   GST_BASE_SINK_PREROLL_UNLOCK (basesink);
@@ -3486,7 +4068,9 @@ gst_base_sink_chain_list (GstPad * pad, GstObject * parent,
   basesink = GST_BASE_SINK (parent);
   bclass = GST_BASE_SINK_GET_CLASS (basesink);
 
-  if (G_LIKELY (bclass->render_list)) {
+  if (G_LIKELY (bclass->render_list) ||
+      (g_atomic_int_get (&basesink->priv->batch_lists) &&
+          gst_buffer_list_length (list) > 0)) {
     result = gst_base_sink_chain_main (basesink, pad, list, TRUE);
   } else {
     guint i, len;
@@ -3894,6 +4478,214 @@ no_buffer:
   }
 }
 
+/* queue @obj for the render thread, buffers and lists wait until there is
+ * space in the queue. Returns the result of the last render. */
+static GstFlowReturn
+gst_base_sink_render_queue_push (GstBaseSink * basesink, GstMiniObject * obj,
+    gboolean is_data)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+  GstFlowReturn ret;
+
+  g_mutex_lock (&priv->render_lock);
+  if (is_data) {
+    while (!priv->render_flushing && priv->render_result == GST_FLOW_OK &&
+        priv->render_queued >= priv->render_queue_max) {
+      GST_LOG_OBJECT (basesink, "render queue full, waiting");
+      g_cond_wait (&priv->render_cond, &priv->render_lock);
+    }
+  }
+  if (G_UNLIKELY (priv->render_flushing))
+    goto flushing;
+
+  ret = priv->render_result;
+  if (G_UNLIKELY (ret != GST_FLOW_OK))
+    goto render_failed;
+
+  gst_queue_array_push_tail (priv->render_queue, obj);
+  if (is_data)
+    priv->render_queued++;
+  g_cond_broadcast (&priv->render_cond);
+  g_mutex_unlock (&priv->render_lock);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+flushing:
+  {
+    GST_DEBUG_OBJECT (basesink, "render queue is flushing");
+    g_mutex_unlock (&priv->render_lock);
+    gst_mini_object_unref (obj);
+    return GST_FLOW_FLUSHING;
+  }
+render_failed:
+  {
+    GST_DEBUG_OBJECT (basesink, "render thread returned %s, dropping %"
+        GST_PTR_FORMAT, gst_flow_get_name (ret), obj);
+    g_mutex_unlock (&priv->render_lock);
+    gst_mini_object_unref (obj);
+    return ret;
+  }
+}
+
+/* with the render task lock */
+static void
+gst_base_sink_render_loop (GstBaseSink * basesink)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+  GstMiniObject *obj;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  g_mutex_lock (&priv->render_lock);
+  while (!priv->render_flushing &&
+      gst_queue_array_is_empty (priv->render_queue))
+    g_cond_wait (&priv->render_cond, &priv->render_lock);
+  if (G_UNLIKELY (priv->render_flushing))
+    goto flushing;
+
+  obj = gst_queue_array_pop_head (priv->render_queue);
+  if (!GST_IS_EVENT (obj)) {
+    priv->render_queued--;
+    g_cond_broadcast (&priv->render_cond);
+  }
+  /* after a failure, the data is dropped until the next flush */
+  if (G_UNLIKELY (priv->render_result != GST_FLOW_OK)) {
+    g_mutex_unlock (&priv->render_lock);
+    gst_mini_object_unref (obj);
+    return;
+  }
+  g_mutex_unlock (&priv->render_lock);
+
+  if (GST_IS_EVENT (obj)) {
+    GstEventType type = GST_EVENT_TYPE (obj);
+
+    /* upstream was already told that the event was handled, make the next
+     * push fail instead so that no data is rendered with refused caps */
+    if (!gst_base_sink_serialized_event (basesink, GST_EVENT_CAST (obj))) {
+      GST_DEBUG_OBJECT (basesink, "serialized %s event was not handled",
+          gst_event_type_get_name (type));
+      ret = type == GST_EVENT_CAPS ? GST_FLOW_NOT_NEGOTIATED : GST_FLOW_ERROR;
+    }
+  } else {
+    GST_BASE_SINK_PREROLL_LOCK (basesink);
+    ret = gst_base_sink_chain_unlocked (basesink, basesink->sinkpad, obj,
+        GST_IS_BUFFER_LIST (obj));
+    GST_BASE_SINK_PREROLL_UNLOCK (basesink);
+  }
+
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    GST_DEBUG_OBJECT (basesink, "render returned %s", gst_flow_get_name (ret));
+    g_mutex_lock (&priv->render_lock);
+    if (!priv->render_flushing)
+      priv->render_result = ret;
+    /* wake up upstream when it is waiting for space */
+    g_cond_broadcast (&priv->render_cond);
+    g_mutex_unlock (&priv->render_lock);
+  }
+  return;
+
+flushing:
+  {
+    GST_DEBUG_OBJECT (basesink, "render queue flushing, pausing");
+    g_mutex_unlock (&priv->render_lock);
+    gst_task_pause (priv->render_task);
+    return;
+  }
+}
+
+/* with render_lock */
+static void
+gst_base_sink_render_queue_clear (GstBaseSink * basesink)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+
+  while (!gst_queue_array_is_empty (priv->render_queue))
+    gst_mini_object_unref (gst_queue_array_pop_head (priv->render_queue));
+  priv->render_queued = 0;
+}
+
+/* when activated in push mode, start the render thread if it is enabled */
+static void
+gst_base_sink_render_start (GstBaseSink * basesink)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+  gchar *name;
+  guint size;
+
+  GST_OBJECT_LOCK (basesink);
+  size = priv->render_queue_size;
+  GST_OBJECT_UNLOCK (basesink);
+
+  if (size == 0)
+    return;
+
+  GST_DEBUG_OBJECT (basesink, "starting render thread, queue size %u", size);
+
+  g_mutex_lock (&priv->render_lock);
+  priv->render_queue_max = size;
+  priv->render_flushing = FALSE;
+  priv->render_result = GST_FLOW_OK;
+  g_mutex_unlock (&priv->render_lock);
+
+  priv->render_task = gst_task_new ((GstTaskFunction) gst_base_sink_render_loop,
+      basesink, NULL);
+  name = g_strdup_printf ("%s:render", GST_OBJECT_NAME (basesink));
+  gst_object_set_name (GST_OBJECT_CAST (priv->render_task), name);
+  g_free (name);
+  gst_task_set_lock (priv->render_task, &priv->render_task_lock);
+  gst_task_start (priv->render_task);
+}
+
+/* with the sink flushing, stop the render thread and drop the queue */
+static void
+gst_base_sink_render_stop (GstBaseSink * basesink)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+
+  if (priv->render_task == NULL)
+    return;
+
+  g_mutex_lock (&priv->render_lock);
+  priv->render_flushing = TRUE;
+  gst_base_sink_render_queue_clear (basesink);
+  g_cond_broadcast (&priv->render_cond);
+  g_mutex_unlock (&priv->render_lock);
+
+  gst_task_stop (priv->render_task);
+  gst_task_join (priv->render_task);
+  gst_object_unref (priv->render_task);
+  priv->render_task = NULL;
+}
+
+/* flush the render queue and wait until the render thread paused, or start
+ * it again */
+static void
+gst_base_sink_render_set_flushing (GstBaseSink * basesink, gboolean flushing)
+{
+  GstBaseSinkPrivate *priv = basesink->priv;
+
+  if (priv->render_task == NULL)
+    return;
+
+  g_mutex_lock (&priv->render_lock);
+  priv->render_flushing = flushing;
+  if (flushing)
+    gst_base_sink_render_queue_clear (basesink);
+  else
+    priv->render_result = GST_FLOW_OK;
+  g_cond_broadcast (&priv->render_cond);
+  g_mutex_unlock (&priv->render_lock);
+
+  if (flushing) {
+    gst_task_pause (priv->render_task);
+    /* the loop function is done when we get the lock */
+    g_rec_mutex_lock (&priv->render_task_lock);
+    g_rec_mutex_unlock (&priv->render_task_lock);
+  } else {
+    gst_task_start (priv->render_task);
+  }
+}
+
 static gboolean
 gst_base_sink_set_flushing (GstBaseSink * basesink, GstPad * pad,
     gboolean flushing)
@@ -4062,6 +4854,7 @@ gst_base_sink_pad_activate_push (GstPad * pad, GstObject * parent,
     } else {
       result = TRUE;
       basesink->pad_mode = GST_PAD_MODE_PUSH;
+      gst_base_sink_render_start (basesink);
     }
   } else {
     if (G_UNLIKELY (basesink->pad_mode != GST_PAD_MODE_PUSH)) {
@@ -4069,6 +4862,7 @@ gst_base_sink_pad_activate_push (GstPad * pad, GstObject * parent,
       result = FALSE;
     } else {
       gst_base_sink_set_flushing (basesink, pad, TRUE);
+      gst_base_sink_render_stop (basesink);
       result = TRUE;
       basesink->pad_mode = GST_PAD_MODE_NONE;
     }
@@ -4764,6 +5558,39 @@ gst_base_sink_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
   return res;
 }
 
+/* check if the toplevel element is going to PLAYING and upstream is live,
+ * the preroll can be skipped then */
+static gboolean
+gst_base_sink_can_fast_start (GstBaseSink * basesink)
+{
+  GstObject *top, *parent;
+  GstState target;
+  GstQuery *query;
+  gboolean live = FALSE;
+
+  top = gst_object_ref (basesink);
+  while ((parent = gst_object_get_parent (top))) {
+    gst_object_unref (top);
+    top = parent;
+  }
+  GST_OBJECT_LOCK (top);
+  target = GST_STATE_TARGET (top);
+  GST_OBJECT_UNLOCK (top);
+  gst_object_unref (top);
+
+  if (target != GST_STATE_PLAYING)
+    return FALSE;
+
+  query = gst_query_new_latency ();
+  if (gst_pad_peer_query (basesink->sinkpad, query))
+    gst_query_parse_latency (query, &live, NULL, NULL);
+  gst_query_unref (query);
+
+  GST_DEBUG_OBJECT (basesink, "going to PLAYING, upstream live: %d", live);
+
+  return live;
+}
+
 static GstStateChangeReturn
 gst_base_sink_change_state (GstElement * element, GstStateChange transition)
 {
@@ -4806,7 +5633,13 @@ gst_base_sink_change_state (GstElement * element, GstStateChange transition)
       priv->call_preroll = TRUE;
       priv->current_step.valid = FALSE;
       priv->pending_step.valid = FALSE;
-      if (priv->async_enabled) {
+      priv->fast_starting = priv->async_enabled
+          && g_atomic_int_get (&priv->fast_start)
+          && gst_base_sink_can_fast_start (basesink);
+      if (priv->fast_starting) {
+        GST_DEBUG_OBJECT (basesink, "fast start, not prerolling");
+        priv->have_latency = TRUE;
+      } else if (priv->async_enabled) {
         GST_DEBUG_OBJECT (basesink, "doing async state change");
         /* when async enabled, post async-start message and return ASYNC from
          * the state change function */
@@ -4844,13 +5677,15 @@ gst_base_sink_change_state (GstElement * element, GstStateChange transition)
         basesink->playing_async = TRUE;
         priv->call_preroll = TRUE;
         priv->commited = FALSE;
-        if (priv->async_enabled) {
+        if (priv->async_enabled && !priv->fast_starting) {
           GST_DEBUG_OBJECT (basesink, "doing async state change");
           ret = GST_STATE_CHANGE_ASYNC;
           gst_element_post_message (GST_ELEMENT_CAST (basesink),
               gst_message_new_async_start (GST_OBJECT_CAST (basesink)));
         }
       }
+      /* from now on async state changes work as usual */
+      priv->fast_starting = FALSE;
       GST_BASE_SINK_PREROLL_UNLOCK (basesink);
       break;
     default:
@@ -4948,7 +5783,7 @@ gst_base_sink_change_state (GstElement * element, GstStateChange transition)
       priv->call_preroll = FALSE;
 
       if (!priv->commited) {
-        if (priv->async_enabled) {
+        if (priv->async_enabled && !priv->fast_starting) {
           GST_DEBUG_OBJECT (basesink, "PAUSED to READY, posting async-done");
 
           gst_element_post_message (GST_ELEMENT_CAST (basesink),
@@ -4963,6 +5798,7 @@ gst_base_sink_change_state (GstElement * element, GstStateChange transition)
       } else {
         GST_DEBUG_OBJECT (basesink, "PAUSED to READY, don't need_preroll");
       }
+      priv->fast_starting = FALSE;
       GST_BASE_SINK_PREROLL_UNLOCK (basesink);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
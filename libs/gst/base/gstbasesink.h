@@ -249,6 +249,25 @@ guint64         gst_base_sink_get_throttle_time (GstBaseSink *sink);
 void            gst_base_sink_set_max_bitrate   (GstBaseSink *sink, guint64 max_bitrate);
 guint64         gst_base_sink_get_max_bitrate   (GstBaseSink *sink);
 
+/* batch-lists */
+void            gst_base_sink_set_batch_lists   (GstBaseSink *sink, gboolean batch);
+gboolean        gst_base_sink_get_batch_lists   (GstBaseSink *sink);
+
+/* sync-window */
+void            gst_base_sink_set_sync_window   (GstBaseSink *sink, GstClockTime window);
+GstClockTime    gst_base_sink_get_sync_window   (GstBaseSink *sink);
+
+/* fast-start */
+void            gst_base_sink_set_fast_start    (GstBaseSink *sink, gboolean enabled);
+gboolean        gst_base_sink_get_fast_start    (GstBaseSink *sink);
+
+/* render-queue-size */
+void            gst_base_sink_set_render_queue_size (GstBaseSink *sink, guint size);
+guint           gst_base_sink_get_render_queue_size (GstBaseSink *sink);
+
+/* stats */
+GstStructure *  gst_base_sink_get_stats         (GstBaseSink *sink);
+
 GstClockReturn  gst_base_sink_wait_clock        (GstBaseSink *sink, GstClockTime time,
                                                  GstClockTimeDiff * jitter);
 GstFlowReturn   gst_base_sink_wait              (GstBaseSink *sink, GstClockTime time,
@@ -200,6 +200,18 @@ enum
 #define DEFAULT_NUM_BUFFERS     -1
 #define DEFAULT_TYPEFIND        FALSE
 #define DEFAULT_DO_TIMESTAMP    FALSE
+#define DEFAULT_READAHEAD       0
+#define DEFAULT_ADAPTIVE_BLOCKSIZE FALSE
+#define DEFAULT_MIN_BLOCKSIZE   4096
+#define DEFAULT_MAX_BLOCKSIZE   (1024 * 1024)
+#define DEFAULT_LOOP            FALSE
+
+/* with adaptive-blocksize, the blocksize is doubled after this many full
+ * blocks in a row were read and pushed within ADAPTIVE_BLOCK_TIME. It is
+ * halved again when a block took longer than that or came back less than
+ * half full. */
+#define ADAPTIVE_GROW_BLOCKS    4
+#define ADAPTIVE_BLOCK_TIME     (10 * GST_MSECOND)
 
 enum
 {
@@ -207,7 +219,12 @@ enum
   PROP_BLOCKSIZE,
   PROP_NUM_BUFFERS,
   PROP_TYPEFIND,
-  PROP_DO_TIMESTAMP
+  PROP_DO_TIMESTAMP,
+  PROP_READAHEAD,
+  PROP_ADAPTIVE_BLOCKSIZE,
+  PROP_MIN_BLOCKSIZE,
+  PROP_MAX_BLOCKSIZE,
+  PROP_LOOP
 };
 
 #define GST_BASE_SRC_GET_PRIVATE(obj)  \
@@ -259,8 +276,52 @@ struct _GstBaseSrcPrivate
   GstAllocationParams params;
 
   GCond async_cond;
+
+  /* buffer list submitted from the create function */
+  GstBufferList *pending_bufferlist;
+
+  /* pull mode readahead, the queue of prefetched blocks and the worker state
+   * are protected with readahead_lock. create_lock serializes all calls to
+   * the create function between the worker and the streaming thread */
+  guint readahead;
+  GMutex readahead_lock;
+  GCond readahead_cond;
+  GMutex create_lock;
+  GQueue readahead_queue;
+  GstTaskPool *readahead_pool;
+  gpointer readahead_id;
+  gboolean readahead_running;
+  gboolean readahead_stopping;
+  guint readahead_cookie;
+  guint64 readahead_next;
+  guint readahead_length;
+  guint64 prefetch_offset;
+  gboolean prefetch_busy;
+  guint64 prefetch_busy_offset;
+  guint prefetch_busy_length;
+
+  /* adaptive blocksize, protected with the OBJECT_LOCK. blocksize is the
+   * configured size the adaptation starts from */
+  gboolean adaptive_blocksize;
+  guint min_blocksize;
+  guint max_blocksize;
+  guint blocksize;
+  guint adaptive_full;
+
+  /* looping, loop is protected with the OBJECT_LOCK, loop_data with the
+   * STREAM_LOCK */
+  gboolean loop;
+  gboolean loop_data;
 };
 
+typedef struct
+{
+  guint64 offset;
+  guint length;
+  GstBuffer *buffer;
+  GstFlowReturn ret;
+} GstBaseSrcReadahead;
+
 static GstElementClass *parent_class = NULL;
 
 static void gst_base_src_class_init (GstBaseSrcClass * klass);
@@ -314,8 +375,8 @@ static gboolean gst_base_src_default_event (GstBaseSrc * src, GstEvent * event);
 static gboolean gst_base_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
 
-static gboolean gst_base_src_activate_pool (GstBaseSrc * basesrc,
-    gboolean active);
+static void gst_base_src_set_pool_flushing (GstBaseSrc * basesrc,
+    gboolean flushing);
 static gboolean gst_base_src_default_negotiate (GstBaseSrc * basesrc);
 static gboolean gst_base_src_default_do_seek (GstBaseSrc * src,
     GstSegment * segment);
@@ -329,6 +390,7 @@ static GstFlowReturn gst_base_src_default_alloc (GstBaseSrc * basesrc,
 static gboolean gst_base_src_decide_allocation_default (GstBaseSrc * basesrc,
     GstQuery * query);
 
+static void gst_base_src_readahead_flush (GstBaseSrc * src);
 static gboolean gst_base_src_set_flushing (GstBaseSrc * basesrc,
     gboolean flushing, gboolean live_play, gboolean * playing);
 
@@ -384,6 +446,88 @@ gst_base_src_class_init (GstBaseSrcClass * klass)
       g_param_spec_boolean ("do-timestamp", "Do timestamp",
           "Apply current stream time to buffers", DEFAULT_DO_TIMESTAMP,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:readahead:
+   *
+   * The number of blocks to read ahead from a separate thread when the
+   * source operates in pull mode and downstream reads sequentially. The
+   * prefetched blocks have the size of the last request. 0 disables
+   * readahead.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_READAHEAD,
+      g_param_spec_uint ("readahead", "Readahead",
+          "Number of blocks to prefetch in pull mode when reading "
+          "sequentially (0 = disabled)", 0, G_MAXUINT, DEFAULT_READAHEAD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:adaptive-blocksize:
+   *
+   * Adapt the blocksize to the dataflow when operating in push mode in
+   * #GST_FORMAT_BYTES. The blocksize grows while the source fills the blocks
+   * and downstream consumes them quickly, and shrinks when the source
+   * returns short blocks or when reading and pushing a block takes too long
+   * for low latency. The size stays between #GstBaseSrc:min-blocksize and
+   * #GstBaseSrc:max-blocksize and #GstBaseSrc:blocksize reports the current
+   * size. The adaptation starts from the configured blocksize every time the
+   * element is started.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_ADAPTIVE_BLOCKSIZE,
+      g_param_spec_boolean ("adaptive-blocksize", "Adaptive blocksize",
+          "Adapt the blocksize to the dataflow in push mode",
+          DEFAULT_ADAPTIVE_BLOCKSIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:min-blocksize:
+   *
+   * The smallest blocksize in bytes to use with
+   * #GstBaseSrc:adaptive-blocksize.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MIN_BLOCKSIZE,
+      g_param_spec_uint ("min-blocksize", "Minimum block size",
+          "Minimum size in bytes to read per buffer with adaptive-blocksize",
+          1, G_MAXUINT, DEFAULT_MIN_BLOCKSIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:max-blocksize:
+   *
+   * The largest blocksize in bytes to use with
+   * #GstBaseSrc:adaptive-blocksize. When it is smaller than
+   * #GstBaseSrc:min-blocksize, it takes precedence.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BLOCKSIZE,
+      g_param_spec_uint ("max-blocksize", "Maximum block size",
+          "Maximum size in bytes to read per buffer with adaptive-blocksize",
+          1, G_MAXUINT, DEFAULT_MAX_BLOCKSIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstBaseSrc:loop:
+   *
+   * Play the configured segment in a loop when operating in push mode.
+   * When the end of the segment is reached, the source starts over at the
+   * other end without flushing, seeking or pausing the streaming thread. It
+   * only pushes an updated segment event whose base continues the running
+   * time and marks the next buffer as DISCONT, so that downstream doesn't
+   * need to preroll again and the loop is seamless. This replaces looping
+   * with non-flushing #GST_SEEK_FLAG_SEGMENT seeks.
+   *
+   * The #GstBaseSrcClass.do_seek() function is called to reposition the
+   * source. When it fails, or when a round produced no data, the source goes
+   * EOS as usual.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_LOOP,
+      g_param_spec_boolean ("loop", "Loop",
+          "Play the segment in a loop without flushing in push mode",
+          DEFAULT_LOOP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_base_src_change_state);
@@ -445,6 +589,11 @@ gst_base_src_init (GstBaseSrc * basesrc, gpointer g_class)
   gst_element_add_pad (GST_ELEMENT (basesrc), pad);
 
   basesrc->blocksize = DEFAULT_BLOCKSIZE;
+  basesrc->priv->blocksize = DEFAULT_BLOCKSIZE;
+  basesrc->priv->adaptive_blocksize = DEFAULT_ADAPTIVE_BLOCKSIZE;
+  basesrc->priv->min_blocksize = DEFAULT_MIN_BLOCKSIZE;
+  basesrc->priv->max_blocksize = DEFAULT_MAX_BLOCKSIZE;
+  basesrc->priv->loop = DEFAULT_LOOP;
   basesrc->clock_id = NULL;
   /* we operate in BYTES by default */
   gst_base_src_set_format (basesrc, GST_FORMAT_BYTES);
@@ -453,6 +602,12 @@ gst_base_src_init (GstBaseSrc * basesrc, gpointer g_class)
   g_atomic_int_set (&basesrc->priv->have_events, FALSE);
 
   g_cond_init (&basesrc->priv->async_cond);
+  basesrc->priv->readahead = DEFAULT_READAHEAD;
+  g_mutex_init (&basesrc->priv->readahead_lock);
+  g_cond_init (&basesrc->priv->readahead_cond);
+  g_mutex_init (&basesrc->priv->create_lock);
+  g_queue_init (&basesrc->priv->readahead_queue);
+  basesrc->priv->readahead_next = -1;
   basesrc->priv->start_result = GST_FLOW_FLUSHING;
   GST_OBJECT_FLAG_UNSET (basesrc, GST_BASE_SRC_FLAG_STARTED);
   GST_OBJECT_FLAG_UNSET (basesrc, GST_BASE_SRC_FLAG_STARTING);
@@ -472,6 +627,9 @@ gst_base_src_finalize (GObject * object)
   g_mutex_clear (&basesrc->live_lock);
   g_cond_clear (&basesrc->live_cond);
   g_cond_clear (&basesrc->priv->async_cond);
+  g_mutex_clear (&basesrc->priv->readahead_lock);
+  g_cond_clear (&basesrc->priv->readahead_cond);
+  g_mutex_clear (&basesrc->priv->create_lock);
 
   event_p = &basesrc->pending_seek;
   gst_event_replace (event_p, NULL);
@@ -719,6 +877,8 @@ gst_base_src_set_blocksize (GstBaseSrc * src, guint blocksize)
 
   GST_OBJECT_LOCK (src);
   src->blocksize = blocksize;
+  src->priv->blocksize = blocksize;
+  src->priv->adaptive_full = 0;
   GST_OBJECT_UNLOCK (src);
 }
 
@@ -868,6 +1028,7 @@ gboolean
 gst_base_src_set_caps (GstBaseSrc * src, GstCaps * caps)
 {
   GstBaseSrcClass *bclass;
+  GstCaps *current_caps;
   gboolean res = TRUE;
 
   bclass = GST_BASE_SRC_GET_CLASS (src);
@@ -877,8 +1038,19 @@ gst_base_src_set_caps (GstBaseSrc * src, GstCaps * caps)
   if (bclass->set_caps)
     res = bclass->set_caps (src, caps);
 
-  if (res)
-    res = gst_pad_set_caps (src->srcpad, caps);
+  if (res) {
+    /* a renegotiation that ends up with the caps downstream already has
+     * doesn't need to reconfigure everything downstream again */
+    current_caps = gst_pad_get_current_caps (src->srcpad);
+    if (current_caps && !GST_PAD_HAS_PENDING_EVENTS (src->srcpad)
+        && gst_caps_is_equal (current_caps, caps)) {
+      GST_DEBUG_OBJECT (src, "caps did not change, not sending caps event");
+    } else {
+      res = gst_pad_set_caps (src->srcpad, caps);
+    }
+    if (current_caps)
+      gst_caps_unref (current_caps);
+  }
 
   return res;
 }
@@ -1235,6 +1407,38 @@ gst_base_src_default_query (GstBaseSrc * src, GstQuery * query)
       }
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:
+    {
+      GstBaseSrcPrivate *priv = src->priv;
+      GstBufferPool *pool;
+      guint64 allocated = 0, queued = 0;
+      GList *walk;
+
+      GST_OBJECT_LOCK (src);
+      if ((pool = priv->pool))
+        gst_object_ref (pool);
+      GST_OBJECT_UNLOCK (src);
+
+      if (pool) {
+        allocated = gst_buffer_pool_get_allocated_bytes (pool);
+        gst_object_unref (pool);
+      }
+
+      /* the prefetched blocks are held until they are pulled */
+      g_mutex_lock (&priv->readahead_lock);
+      for (walk = priv->readahead_queue.head; walk; walk = g_list_next (walk)) {
+        GstBaseSrcReadahead *block = walk->data;
+
+        if (block->buffer)
+          queued += gst_buffer_get_size (block->buffer);
+      }
+      g_mutex_unlock (&priv->readahead_lock);
+
+      gst_query_add_memory_usage (query, GST_OBJECT_CAST (src), allocated,
+          queued);
+      res = TRUE;
+      break;
+    }
     default:
       res = FALSE;
       break;
@@ -1620,6 +1824,7 @@ gst_base_src_perform_seek (GstBaseSrc * src, GstEvent * event, gboolean unlock)
 
     /* do the seek, segment.position contains the new position. */
     res = gst_base_src_do_seek (src, &seeksegment);
+    gst_base_src_readahead_flush (src);
   }
 
   /* and prepare to continue streaming */
@@ -1743,7 +1948,7 @@ gst_base_src_send_event (GstElement * element, GstEvent * event)
        * and we can do EOS. This will eventually release the LIVE_LOCK again so
        * that we can grab it and stop the unlock again. We don't take the stream
        * lock so that this operation is guaranteed to never block. */
-      gst_base_src_activate_pool (src, FALSE);
+      gst_base_src_set_pool_flushing (src, TRUE);
       if (bclass->unlock)
         bclass->unlock (src);
 
@@ -1755,7 +1960,7 @@ gst_base_src_send_event (GstElement * element, GstEvent * event)
        * lock is enough because that protects the create function. */
       if (bclass->unlock_stop)
         bclass->unlock_stop (src);
-      gst_base_src_activate_pool (src, TRUE);
+      gst_base_src_set_pool_flushing (src, FALSE);
       GST_LIVE_UNLOCK (src);
 
       result = TRUE;
@@ -1983,6 +2188,32 @@ gst_base_src_set_property (GObject * object, guint prop_id,
     case PROP_DO_TIMESTAMP:
       gst_base_src_set_do_timestamp (src, g_value_get_boolean (value));
       break;
+    case PROP_READAHEAD:
+      g_mutex_lock (&src->priv->readahead_lock);
+      src->priv->readahead = g_value_get_uint (value);
+      g_mutex_unlock (&src->priv->readahead_lock);
+      break;
+    case PROP_ADAPTIVE_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      src->priv->adaptive_blocksize = g_value_get_boolean (value);
+      src->priv->adaptive_full = 0;
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MIN_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      src->priv->min_blocksize = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MAX_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      src->priv->max_blocksize = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_LOOP:
+      GST_OBJECT_LOCK (src);
+      src->priv->loop = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2010,6 +2241,31 @@ gst_base_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_DO_TIMESTAMP:
       g_value_set_boolean (value, gst_base_src_get_do_timestamp (src));
       break;
+    case PROP_READAHEAD:
+      g_mutex_lock (&src->priv->readahead_lock);
+      g_value_set_uint (value, src->priv->readahead);
+      g_mutex_unlock (&src->priv->readahead_lock);
+      break;
+    case PROP_ADAPTIVE_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      g_value_set_boolean (value, src->priv->adaptive_blocksize);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MIN_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->priv->min_blocksize);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_MAX_BLOCKSIZE:
+      GST_OBJECT_LOCK (src);
+      g_value_set_uint (value, src->priv->max_blocksize);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    case PROP_LOOP:
+      GST_OBJECT_LOCK (src);
+      g_value_set_boolean (value, src->priv->loop);
+      GST_OBJECT_UNLOCK (src);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2295,6 +2551,237 @@ unexpected_length:
   }
 }
 
+static void
+gst_base_src_readahead_free (GstBaseSrcReadahead * block)
+{
+  if (block->buffer)
+    gst_buffer_unref (block->buffer);
+  g_slice_free (GstBaseSrcReadahead, block);
+}
+
+/* with readahead_lock */
+static void
+gst_base_src_readahead_clear (GstBaseSrc * src)
+{
+  GstBaseSrcReadahead *block;
+  GstBaseSrcPrivate *priv = src->priv;
+
+  while ((block = g_queue_pop_head (&priv->readahead_queue)))
+    gst_base_src_readahead_free (block);
+
+  /* a block that the worker is still reading is dropped when it completes */
+  priv->readahead_cookie++;
+}
+
+static void
+gst_base_src_readahead_func (GstBaseSrc * src)
+{
+  GstBaseSrcClass *bclass = GST_BASE_SRC_GET_CLASS (src);
+  GstBaseSrcPrivate *priv = src->priv;
+
+  g_mutex_lock (&priv->readahead_lock);
+  while (!priv->readahead_stopping &&
+      priv->readahead_queue.length < priv->readahead) {
+    GstBaseSrcReadahead *block;
+    GstBuffer *buffer = NULL;
+    GstFlowReturn ret;
+    guint64 offset, duration;
+    guint length, cookie;
+
+    offset = priv->prefetch_offset;
+    length = priv->readahead_length;
+    cookie = priv->readahead_cookie;
+
+    /* clip against the known size, we don't go and ask the subclass for a
+     * new size from here */
+    GST_OBJECT_LOCK (src);
+    duration = src->segment.duration;
+    GST_OBJECT_UNLOCK (src);
+    if (duration != -1) {
+      if (offset >= duration)
+        break;
+      if (offset + length > duration)
+        length = duration - offset;
+    }
+
+    priv->prefetch_busy = TRUE;
+    priv->prefetch_busy_offset = offset;
+    priv->prefetch_busy_length = length;
+    g_mutex_unlock (&priv->readahead_lock);
+
+    GST_LOG_OBJECT (src, "prefetching offset %" G_GUINT64_FORMAT
+        " length %u", offset, length);
+
+    g_mutex_lock (&priv->create_lock);
+    ret = bclass->create (src, offset, length, &buffer);
+    g_mutex_unlock (&priv->create_lock);
+
+    g_mutex_lock (&priv->readahead_lock);
+    priv->prefetch_busy = FALSE;
+    /* only data is cached, an error or a FLUSHING from an unlock is
+     * returned again by create when the block is requested */
+    if (ret == GST_FLOW_OK && cookie == priv->readahead_cookie &&
+        !priv->readahead_stopping) {
+      block = g_slice_new (GstBaseSrcReadahead);
+      block->offset = offset;
+      block->length = length;
+      block->buffer = buffer;
+      block->ret = ret;
+      g_queue_push_tail (&priv->readahead_queue, block);
+      priv->prefetch_offset = offset + length;
+    } else if (buffer) {
+      gst_buffer_unref (buffer);
+    }
+    g_cond_broadcast (&priv->readahead_cond);
+
+    /* don't read past errors */
+    if (ret != GST_FLOW_OK)
+      break;
+  }
+  priv->readahead_running = FALSE;
+  g_cond_broadcast (&priv->readahead_cond);
+  g_mutex_unlock (&priv->readahead_lock);
+}
+
+/* with readahead_lock */
+static void
+gst_base_src_readahead_schedule (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  GError *err = NULL;
+
+  if (priv->readahead_running || priv->readahead_stopping)
+    return;
+
+  if (priv->readahead_pool == NULL) {
+    priv->readahead_pool = gst_task_pool_new ();
+    gst_task_pool_prepare (priv->readahead_pool, &err);
+    if (err)
+      goto pool_failed;
+  }
+
+  /* join the previous worker, it has finished already */
+  if (priv->readahead_id) {
+    gst_task_pool_join (priv->readahead_pool, priv->readahead_id);
+    priv->readahead_id = NULL;
+  }
+
+  priv->readahead_running = TRUE;
+  priv->readahead_id = gst_task_pool_push (priv->readahead_pool,
+      (GstTaskPoolFunction) gst_base_src_readahead_func, src, &err);
+  if (err) {
+    priv->readahead_running = FALSE;
+    goto push_failed;
+  }
+  return;
+
+  /* ERRORS */
+pool_failed:
+push_failed:
+  {
+    GST_WARNING_OBJECT (src, "could not start readahead: %s", err->message);
+    g_clear_error (&err);
+    priv->readahead = 0;
+    return;
+  }
+}
+
+/* drop the prefetched blocks and the blocks that are being read, on flush
+ * and seek */
+static void
+gst_base_src_readahead_flush (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+
+  g_mutex_lock (&priv->readahead_lock);
+  gst_base_src_readahead_clear (src);
+  priv->readahead_next = -1;
+  g_mutex_unlock (&priv->readahead_lock);
+}
+
+/* stop the readahead worker and drop all prefetched blocks */
+static void
+gst_base_src_readahead_stop (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+
+  g_mutex_lock (&priv->readahead_lock);
+  priv->readahead_stopping = TRUE;
+  while (priv->readahead_running)
+    g_cond_wait (&priv->readahead_cond, &priv->readahead_lock);
+  gst_base_src_readahead_clear (src);
+  priv->readahead_next = -1;
+  priv->readahead_stopping = FALSE;
+  g_mutex_unlock (&priv->readahead_lock);
+
+  if (priv->readahead_pool) {
+    if (priv->readahead_id)
+      gst_task_pool_join (priv->readahead_pool, priv->readahead_id);
+    priv->readahead_id = NULL;
+    gst_task_pool_cleanup (priv->readahead_pool);
+    gst_object_unref (priv->readahead_pool);
+    priv->readahead_pool = NULL;
+  }
+}
+
+/* Called with STREAM_LOCK and LIVE_LOCK in pull mode. Takes the requested
+ * block from the readahead queue or calls the create function and schedules
+ * the next blocks when the access is sequential. */
+static GstFlowReturn
+gst_base_src_readahead_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buf)
+{
+  GstBaseSrcClass *bclass = GST_BASE_SRC_GET_CLASS (src);
+  GstBaseSrcPrivate *priv = src->priv;
+  GstBaseSrcReadahead *block = NULL;
+  GstFlowReturn ret;
+  gboolean sequential;
+
+  g_mutex_lock (&priv->readahead_lock);
+  sequential = (offset == priv->readahead_next &&
+      length == priv->readahead_length);
+
+  if (sequential) {
+    /* wait for the worker when it is reading the block we need */
+    while (priv->prefetch_busy && priv->prefetch_busy_offset == offset &&
+        priv->prefetch_busy_length == length)
+      g_cond_wait (&priv->readahead_cond, &priv->readahead_lock);
+
+    block = g_queue_peek_head (&priv->readahead_queue);
+    if (block && block->offset == offset && block->length == length)
+      g_queue_pop_head (&priv->readahead_queue);
+    else
+      block = NULL;
+  }
+  if (block == NULL) {
+    /* random access or a different block size, start over */
+    gst_base_src_readahead_clear (src);
+    priv->prefetch_offset = offset + length;
+  }
+
+  priv->readahead_next = offset + length;
+  priv->readahead_length = length;
+  if (sequential && priv->readahead > 0)
+    gst_base_src_readahead_schedule (src);
+  g_mutex_unlock (&priv->readahead_lock);
+
+  if (block) {
+    GST_LOG_OBJECT (src, "using prefetched block at offset %" G_GUINT64_FORMAT,
+        offset);
+    ret = block->ret;
+    if (ret == GST_FLOW_OK)
+      *buf = block->buffer;
+    else if (block->buffer)
+      gst_buffer_unref (block->buffer);
+    g_slice_free (GstBaseSrcReadahead, block);
+  } else {
+    g_mutex_lock (&priv->create_lock);
+    ret = bclass->create (src, offset, length, buf);
+    g_mutex_unlock (&priv->create_lock);
+  }
+  return ret;
+}
+
 /* must be called with LIVE_LOCK */
 static GstFlowReturn
 gst_base_src_get_range (GstBaseSrc * src, guint64 offset, guint length,
@@ -2352,14 +2839,19 @@ again:
 
   res_buf = in_buf = *buf;
 
-  ret = bclass->create (src, offset, length, &res_buf);
+  if (src->priv->readahead > 0 && !src->is_live &&
+      GST_PAD_MODE (src->srcpad) == GST_PAD_MODE_PULL)
+    ret = gst_base_src_readahead_create (src, offset, length, &res_buf);
+  else
+    ret = bclass->create (src, offset, length, &res_buf);
 
   /* The create function could be unlocked because we have a pending EOS. It's
    * possible that we have a valid buffer from create that we need to
    * discard when the create function returned _OK. */
   if (G_UNLIKELY (g_atomic_int_get (&src->priv->pending_eos))) {
     if (ret == GST_FLOW_OK) {
-      if (*buf == NULL)
+      /* a submitted list is dropped by the caller */
+      if (*buf == NULL && res_buf != NULL)
         gst_buffer_unref (res_buf);
     }
     goto eos;
@@ -2368,6 +2860,16 @@ again:
   if (G_UNLIKELY (ret != GST_FLOW_OK))
     goto not_ok;
 
+  /* the subclass submitted a buffer list, we sync on its first buffer and the
+   * loop function pushes the list */
+  if (res_buf == NULL && src->priv->pending_bufferlist != NULL) {
+    if (G_UNLIKELY (in_buf != NULL
+            || gst_buffer_list_length (src->priv->pending_bufferlist) == 0))
+      goto invalid_list;
+    res_buf =
+        gst_buffer_ref (gst_buffer_list_get (src->priv->pending_bufferlist, 0));
+  }
+
   /* fallback in case the create function didn't fill a provided buffer */
   if (in_buf != NULL && res_buf != in_buf) {
     GstMapInfo info;
@@ -2391,7 +2893,8 @@ again:
 
   /* no timestamp set and we are at offset 0, we can timestamp with 0 */
   if (offset == 0 && src->segment.time == 0
-      && GST_BUFFER_DTS (res_buf) == -1 && !src->is_live) {
+      && GST_BUFFER_DTS (res_buf) == -1 && !src->is_live
+      && src->priv->pending_bufferlist == NULL) {
     GST_DEBUG_OBJECT (src, "setting first timestamp to 0");
     res_buf = gst_buffer_make_writable (res_buf);
     GST_BUFFER_DTS (res_buf) = 0;
@@ -2431,6 +2934,10 @@ again:
          * pause and playing. We try to produce a new buffer */
         GST_DEBUG_OBJECT (src,
             "clock was unscheduled (%d), but we are running", status);
+        if (src->priv->pending_bufferlist) {
+          gst_buffer_list_unref (src->priv->pending_bufferlist);
+          src->priv->pending_bufferlist = NULL;
+        }
         goto again;
       }
       break;
@@ -2462,6 +2969,14 @@ not_ok:
         gst_flow_get_name (ret));
     return ret;
   }
+invalid_list:
+  {
+    GST_ELEMENT_ERROR (src, STREAM, FAILED,
+        (_("Internal data flow error.")),
+        ("element submitted an empty buffer list or a list for a provided "
+            "buffer"));
+    return GST_FLOW_ERROR;
+  }
 map_failed:
   {
     GST_ELEMENT_ERROR (src, RESOURCE, BUSY,
@@ -2521,6 +3036,20 @@ gst_base_src_getrange (GstPad * pad, GstObject * parent, guint64 offset,
 
   res = gst_base_src_get_range (src, offset, length, buf);
 
+  /* buffer lists can't be pulled */
+  if (G_UNLIKELY (src->priv->pending_bufferlist != NULL)) {
+    gst_buffer_list_unref (src->priv->pending_bufferlist);
+    src->priv->pending_bufferlist = NULL;
+    if (res == GST_FLOW_OK) {
+      gst_buffer_unref (*buf);
+      *buf = NULL;
+      GST_ELEMENT_ERROR (src, STREAM, FAILED,
+          (_("Internal data flow error.")),
+          ("element submitted a buffer list in pull mode"));
+      res = GST_FLOW_ERROR;
+    }
+  }
+
 done:
   GST_LIVE_UNLOCK (src);
 
@@ -2558,15 +3087,118 @@ start_failed:
   }
 }
 
+/* with OBJECT_LOCK, keeps the blocksize within the adaptive bounds */
+static void
+gst_base_src_clamp_blocksize (GstBaseSrc * src)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+
+  src->blocksize = CLAMP (src->blocksize, priv->min_blocksize,
+      priv->max_blocksize);
+}
+
+/* called after a block of @requested bytes was read and pushed in @elapsed
+ * time, @size is the number of bytes the source returned */
+static void
+gst_base_src_adapt_blocksize (GstBaseSrc * src, guint requested, guint size,
+    GstClockTime elapsed)
+{
+  GstBaseSrcPrivate *priv = src->priv;
+  guint blocksize;
+
+  GST_OBJECT_LOCK (src);
+  /* the property or blocksize was changed meanwhile, or this was the
+   * partial last block of a reverse segment */
+  if (!priv->adaptive_blocksize || src->blocksize != requested)
+    goto done;
+
+  blocksize = requested;
+  if (size < requested / 2 || elapsed > ADAPTIVE_BLOCK_TIME) {
+    /* the source can't fill the blocks or a block is too much data for
+     * the latency downstream has, go smaller */
+    priv->adaptive_full = 0;
+    blocksize = requested / 2;
+  } else if (size >= requested
+      && ++priv->adaptive_full >= ADAPTIVE_GROW_BLOCKS) {
+    /* the source fills the blocks and downstream keeps up, read more at
+     * once */
+    priv->adaptive_full = 0;
+    blocksize = requested > G_MAXUINT / 2 ? G_MAXUINT : requested * 2;
+  }
+
+  if (blocksize != requested) {
+    src->blocksize = blocksize;
+    gst_base_src_clamp_blocksize (src);
+    GST_DEBUG_OBJECT (src, "blocksize %u -> %u, got %u bytes in %"
+        GST_TIME_FORMAT, requested, src->blocksize, size,
+        GST_TIME_ARGS (elapsed));
+  }
+done:
+  GST_OBJECT_UNLOCK (src);
+}
+
+/* with STREAM_LOCK, called when the end of the segment was reached. Starts
+ * the segment over with a base that continues the running time and returns
+ * FALSE when the source should go EOS instead. */
+static gboolean
+gst_base_src_loop_segment (GstBaseSrc * src)
+{
+  GstBaseSrcClass *bclass;
+  GstSegment seg;
+  guint64 base;
+  gboolean loop;
+
+  GST_OBJECT_LOCK (src);
+  loop = src->priv->loop;
+  seg = src->segment;
+  GST_OBJECT_UNLOCK (src);
+
+  /* reaching num-buffers and an EOS event sent to the element also end up
+   * here */
+  if (!loop || !src->priv->loop_data || src->num_buffers_left == 0 ||
+      g_atomic_int_get (&src->priv->pending_eos))
+    return FALSE;
+
+  base = gst_segment_to_running_time (&seg, seg.format, seg.position);
+  if (base == -1)
+    return FALSE;
+
+  if (seg.rate >= 0.0) {
+    seg.position = seg.start;
+  } else {
+    if (seg.stop == -1)
+      return FALSE;
+    seg.position = seg.stop;
+  }
+  seg.base = base;
+
+  bclass = GST_BASE_SRC_GET_CLASS (src);
+  if (bclass->do_seek && !bclass->do_seek (src, &seg))
+    return FALSE;
+
+  GST_DEBUG_OBJECT (src, "looping, new base %" G_GUINT64_FORMAT, base);
+
+  GST_OBJECT_LOCK (src);
+  src->segment = seg;
+  GST_OBJECT_UNLOCK (src);
+  src->priv->segment_pending = TRUE;
+  src->priv->discont = TRUE;
+  src->priv->loop_data = FALSE;
+
+  return TRUE;
+}
+
 static void
 gst_base_src_loop (GstPad * pad)
 {
   GstBaseSrc *src;
   GstBuffer *buf = NULL;
+  GstBufferList *list;
   GstFlowReturn ret;
   gint64 position;
   gboolean eos;
-  guint blocksize;
+  guint blocksize, bufsize = 0;
+  GstClockTime start = 0;
   GList *pending_events = NULL, *tmp;
 
   eos = FALSE;
@@ -2588,6 +3220,12 @@ gst_base_src_loop (GstPad * pad)
   if (G_UNLIKELY (src->priv->flushing))
     goto flushing;
 
+  if (G_UNLIKELY (src->priv->adaptive_blocksize)) {
+    GST_OBJECT_LOCK (src);
+    gst_base_src_clamp_blocksize (src);
+    GST_OBJECT_UNLOCK (src);
+    start = gst_util_get_timestamp ();
+  }
   blocksize = src->blocksize;
 
   /* if we operate in bytes, we can calculate an offset */
@@ -2611,9 +3249,15 @@ gst_base_src_loop (GstPad * pad)
       GST_TIME_ARGS (position), blocksize);
 
   ret = gst_base_src_get_range (src, position, blocksize, &buf);
+
+  list = src->priv->pending_bufferlist;
+  src->priv->pending_bufferlist = NULL;
+
   if (G_UNLIKELY (ret != GST_FLOW_OK)) {
     GST_INFO_OBJECT (src, "pausing after gst_base_src_get_range() = %s",
         gst_flow_get_name (ret));
+    if (list)
+      gst_buffer_list_unref (list);
     GST_LIVE_UNLOCK (src);
     goto pause;
   }
@@ -2645,11 +3289,28 @@ gst_base_src_loop (GstPad * pad)
     g_list_free (pending_events);
   }
 
+  /* for a list, the position is after its last buffer, buf is its first */
+  if (G_UNLIKELY (list != NULL)) {
+    gst_buffer_unref (buf);
+    if (src->segment.rate >= 0.0)
+      buf = gst_buffer_list_get (list, gst_buffer_list_length (list) - 1);
+    else
+      buf = gst_buffer_list_get (list, 0);
+  }
+
   /* figure out the new position */
   switch (src->segment.format) {
     case GST_FORMAT_BYTES:
     {
-      guint bufsize = gst_buffer_get_size (buf);
+      if (G_UNLIKELY (list != NULL)) {
+        guint i, len = gst_buffer_list_length (list);
+
+        bufsize = 0;
+        for (i = 0; i < len; i++)
+          bufsize += gst_buffer_get_size (gst_buffer_list_get (list, i));
+      } else {
+        bufsize = gst_buffer_get_size (buf);
+      }
 
       /* we subtracted above for negative rates */
       if (src->segment.rate >= 0.0)
@@ -2714,13 +3375,27 @@ gst_base_src_loop (GstPad * pad)
 
   if (G_UNLIKELY (src->priv->discont)) {
     GST_INFO_OBJECT (src, "marking pending DISCONT");
-    buf = gst_buffer_make_writable (buf);
-    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    if (G_UNLIKELY (list != NULL)) {
+      GstBuffer *first;
+
+      list = gst_buffer_list_make_writable (list);
+      first = gst_buffer_ref (gst_buffer_list_get (list, 0));
+      gst_buffer_list_remove (list, 0, 1);
+      first = gst_buffer_make_writable (first);
+      GST_BUFFER_FLAG_SET (first, GST_BUFFER_FLAG_DISCONT);
+      gst_buffer_list_insert (list, 0, first);
+    } else {
+      buf = gst_buffer_make_writable (buf);
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    }
     src->priv->discont = FALSE;
   }
   GST_LIVE_UNLOCK (src);
 
-  ret = gst_pad_push (pad, buf);
+  if (G_UNLIKELY (list != NULL))
+    ret = gst_pad_push_list (pad, list);
+  else
+    ret = gst_pad_push (pad, buf);
   if (G_UNLIKELY (ret != GST_FLOW_OK)) {
     if (ret == GST_FLOW_NOT_NEGOTIATED) {
       goto not_negotiated;
@@ -2729,6 +3404,12 @@ gst_base_src_loop (GstPad * pad)
         gst_flow_get_name (ret));
     goto pause;
   }
+  src->priv->loop_data = TRUE;
+
+  if (G_UNLIKELY (src->priv->adaptive_blocksize)
+      && src->segment.format == GST_FORMAT_BYTES)
+    gst_base_src_adapt_blocksize (src, blocksize, bufsize,
+        gst_util_get_timestamp () - start);
 
   if (G_UNLIKELY (eos)) {
     GST_INFO_OBJECT (src, "pausing after end of segment");
@@ -2767,6 +3448,9 @@ pause:
     const gchar *reason = gst_flow_get_name (ret);
     GstEvent *event;
 
+    if (ret == GST_FLOW_EOS && gst_base_src_loop_segment (src))
+      goto done;
+
     GST_DEBUG_OBJECT (src, "pausing task, reason %s", reason);
     src->running = FALSE;
     gst_pad_pause_task (pad);
@@ -2868,12 +3552,14 @@ activate_failed:
   }
 }
 
-static gboolean
-gst_base_src_activate_pool (GstBaseSrc * basesrc, gboolean active)
+/* unblock or unflush the acquire of buffers from the pool. The pool stays
+ * active so that its buffers don't need to be allocated again when the flush
+ * is done. */
+static void
+gst_base_src_set_pool_flushing (GstBaseSrc * basesrc, gboolean flushing)
 {
   GstBaseSrcPrivate *priv = basesrc->priv;
   GstBufferPool *pool;
-  gboolean res = TRUE;
 
   GST_OBJECT_LOCK (basesrc);
   if ((pool = priv->pool))
@@ -2881,10 +3567,9 @@ gst_base_src_activate_pool (GstBaseSrc * basesrc, gboolean active)
   GST_OBJECT_UNLOCK (basesrc);
 
   if (pool) {
-    res = gst_buffer_pool_set_active (pool, active);
+    gst_buffer_pool_set_flushing (pool, flushing);
     gst_object_unref (pool);
   }
-  return res;
 }
 
 
@@ -2897,7 +3582,7 @@ gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
   GstAllocator *allocator;
   GstAllocationParams params;
   GstStructure *config;
-  gboolean update_allocator;
+  gboolean update_allocator, own_pool = FALSE;
 
   gst_query_parse_allocation (query, &outcaps, NULL);
 
@@ -2920,6 +3605,7 @@ gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
       /* no pool, we can make our own */
       GST_DEBUG_OBJECT (basesrc, "no pool, making new pool");
       pool = gst_buffer_pool_new ();
+      own_pool = TRUE;
     }
   } else {
     pool = NULL;
@@ -2931,6 +3617,10 @@ gst_base_src_decide_allocation_default (GstBaseSrc * basesrc, GstQuery * query)
     config = gst_buffer_pool_get_config (pool);
     gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
     gst_buffer_pool_config_set_allocator (config, allocator, &params);
+    /* don't make the first buffer wait for the preallocation */
+    if (own_pool)
+      gst_buffer_pool_config_add_option (config,
+          GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC);
     gst_buffer_pool_set_config (pool, config);
   }
 
@@ -3129,6 +3819,10 @@ gst_base_src_start (GstBaseSrc * basesrc)
   basesrc->priv->start_result = GST_FLOW_FLUSHING;
   GST_OBJECT_FLAG_SET (basesrc, GST_BASE_SRC_FLAG_STARTING);
   gst_segment_init (&basesrc->segment, basesrc->segment.format);
+  if (basesrc->priv->adaptive_blocksize) {
+    basesrc->blocksize = basesrc->priv->blocksize;
+    basesrc->priv->adaptive_full = 0;
+  }
   GST_OBJECT_UNLOCK (basesrc);
 
   basesrc->num_buffers_left = basesrc->num_buffers;
@@ -3356,6 +4050,9 @@ gst_base_src_stop (GstBaseSrc * basesrc)
   GST_ASYNC_SIGNAL (basesrc);
   GST_OBJECT_UNLOCK (basesrc);
 
+  /* the readahead worker calls create, stop it before the subclass */
+  gst_base_src_readahead_stop (basesrc);
+
   bclass = GST_BASE_SRC_GET_CLASS (basesrc);
   if (bclass->stop)
     result = bclass->stop (basesrc);
@@ -3385,7 +4082,7 @@ gst_base_src_set_flushing (GstBaseSrc * basesrc,
   GST_DEBUG_OBJECT (basesrc, "flushing %d, live_play %d", flushing, live_play);
 
   if (flushing) {
-    gst_base_src_activate_pool (basesrc, FALSE);
+    gst_base_src_set_pool_flushing (basesrc, TRUE);
     /* unlock any subclasses, we need to do this before grabbing the
      * LIVE_LOCK since we hold this lock before going into ::create. We pass an
      * unlock to the params because of backwards compat (see seek handler)*/
@@ -3393,6 +4090,9 @@ gst_base_src_set_flushing (GstBaseSrc * basesrc,
       bclass->unlock (basesrc);
   }
 
+  /* the blocks that are read now can be interrupted by the unlock */
+  gst_base_src_readahead_flush (basesrc);
+
   /* the live lock is released when we are blocked, waiting for playing or
    * when we sync to the clock. */
   GST_LIVE_LOCK (basesrc);
@@ -3417,7 +4117,7 @@ gst_base_src_set_flushing (GstBaseSrc * basesrc,
     /* signal the live source that it can start playing */
     basesrc->live_running = live_play;
 
-    gst_base_src_activate_pool (basesrc, TRUE);
+    gst_base_src_set_pool_flushing (basesrc, FALSE);
 
     /* Drop all delayed events */
     GST_OBJECT_LOCK (basesrc);
@@ -3677,6 +4377,38 @@ gst_base_src_get_buffer_pool (GstBaseSrc * src)
   return NULL;
 }
 
+/**
+ * gst_base_src_submit_buffer_list:
+ * @src: a #GstBaseSrc
+ * @buffer_list: (transfer full): a #GstBufferList
+ *
+ * Subclasses can call this from their create virtual method implementation
+ * to submit a buffer list to be pushed out later. This is useful in
+ * cases where the create function wants to produce multiple buffers to be
+ * pushed out in one go in form of a #GstBufferList, which can reduce overhead
+ * drastically, especially for packetised inputs.
+ *
+ * The create function must then return %GST_FLOW_OK and set the buffer
+ * return location to %NULL. The list must not be empty. Synchronisation
+ * against the clock uses the first buffer of the list.
+ *
+ * Buffer lists can only be submitted in push mode.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_src_submit_buffer_list (GstBaseSrc * src, GstBufferList * buffer_list)
+{
+  g_return_if_fail (GST_IS_BASE_SRC (src));
+  g_return_if_fail (GST_IS_BUFFER_LIST (buffer_list));
+  g_return_if_fail (src->priv->pending_bufferlist == NULL);
+
+  src->priv->pending_bufferlist = buffer_list;
+
+  GST_LOG_OBJECT (src, "%u buffers submitted in buffer list",
+      gst_buffer_list_length (buffer_list));
+}
+
 /**
  * gst_base_src_get_allocator:
  * @src: a #GstBaseSrc
@@ -268,6 +268,10 @@ struct _GstBaseTransformPrivate
   GstAllocator *allocator;
   GstAllocationParams params;
   GstQuery *query;
+
+  /* parallel transform of buffer lists, with LOCK */
+  guint n_threads;
+  GstTaskPool *task_pool;
 };
 
 
@@ -331,6 +335,8 @@ static GstFlowReturn gst_base_transform_getrange (GstPad * pad,
     GstObject * parent, guint64 offset, guint length, GstBuffer ** buffer);
 static GstFlowReturn gst_base_transform_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_base_transform_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstCaps *gst_base_transform_default_transform_caps (GstBaseTransform *
     trans, GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static GstCaps *gst_base_transform_default_fixate_caps (GstBaseTransform *
@@ -358,12 +364,33 @@ static GstFlowReturn default_prepare_output_buffer (GstBaseTransform * trans,
 static gboolean default_copy_metadata (GstBaseTransform * trans,
     GstBuffer * inbuf, GstBuffer * outbuf);
 
+/* a transform that is postponed so that it can run in a worker thread, see
+ * gst_base_transform_chain_list_parallel() */
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstClockTime position;
+  GstBuffer *inbuf;
+  GstBuffer *outbuf;
+  gboolean deferred;
+  gboolean in_place;
+  gboolean discont;
+  GstFlowReturn ret;
+} GstBaseTransformJob;
+
 /* static guint gst_base_transform_signals[LAST_SIGNAL] = { 0 }; */
 
 
 static void
 gst_base_transform_finalize (GObject * object)
 {
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (object);
+
+  if (trans->priv->task_pool) {
+    gst_task_pool_cleanup (trans->priv->task_pool);
+    gst_object_unref (trans->priv->task_pool);
+  }
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -435,6 +462,8 @@ gst_base_transform_init (GstBaseTransform * trans,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_event));
   gst_pad_set_chain_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_chain));
+  gst_pad_set_chain_list_function (trans->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_base_transform_chain_list));
   gst_pad_set_activatemode_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_activate_mode));
   gst_pad_set_query_function (trans->sinkpad,
@@ -771,7 +800,9 @@ gst_base_transform_set_allocation (GstBaseTransform * trans,
   GST_OBJECT_LOCK (trans);
   oldpool = priv->pool;
   priv->pool = pool;
-  priv->pool_active = FALSE;
+  /* downstream answered with the pool we already use, keep it active */
+  if (oldpool != pool)
+    priv->pool_active = FALSE;
 
   oldalloc = priv->allocator;
   priv->allocator = allocator;
@@ -786,8 +817,10 @@ gst_base_transform_set_allocation (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 
   if (oldpool) {
-    GST_DEBUG_OBJECT (trans, "deactivating old pool %p", oldpool);
-    gst_buffer_pool_set_active (oldpool, FALSE);
+    if (oldpool != pool) {
+      GST_DEBUG_OBJECT (trans, "deactivating old pool %p", oldpool);
+      gst_buffer_pool_set_active (oldpool, FALSE);
+    }
     gst_object_unref (oldpool);
   }
   if (oldalloc) {
@@ -811,7 +844,7 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
   GstAllocator *allocator;
   GstAllocationParams params;
   GstStructure *config;
-  gboolean update_allocator;
+  gboolean update_allocator, own_pool = FALSE;
 
   klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
 
@@ -869,6 +902,7 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
       /* no pool, we can make our own */
       GST_DEBUG_OBJECT (trans, "no pool, making new pool");
       pool = gst_buffer_pool_new ();
+      own_pool = TRUE;
     }
   } else {
     pool = NULL;
@@ -880,6 +914,10 @@ gst_base_transform_default_decide_allocation (GstBaseTransform * trans,
     config = gst_buffer_pool_get_config (pool);
     gst_buffer_pool_config_set_params (config, outcaps, size, min, max);
     gst_buffer_pool_config_set_allocator (config, allocator, &params);
+    /* don't make the first buffer wait for the preallocation */
+    if (own_pool)
+      gst_buffer_pool_config_add_option (config,
+          GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC);
     gst_buffer_pool_set_config (pool, config);
   }
 
@@ -1299,7 +1337,7 @@ gst_base_transform_setcaps (GstBaseTransform * trans, GstPad * pad,
     GstCaps * incaps)
 {
   GstBaseTransformPrivate *priv = trans->priv;
-  GstCaps *outcaps;
+  GstCaps *outcaps, *current_caps;
   gboolean ret = TRUE;
 
   GST_DEBUG_OBJECT (pad, "have new caps %p %" GST_PTR_FORMAT, incaps, incaps);
@@ -1322,8 +1360,17 @@ gst_base_transform_setcaps (GstBaseTransform * trans, GstPad * pad,
   if (!(ret = gst_base_transform_configure_caps (trans, incaps, outcaps)))
     goto failed_configure;
 
-  /* let downstream know about our caps */
-  ret = gst_pad_set_caps (trans->srcpad, outcaps);
+  /* let downstream know about our caps, unless a renegotiation ended up with
+   * the caps downstream already has */
+  current_caps = gst_pad_get_current_caps (trans->srcpad);
+  if (current_caps && !GST_PAD_HAS_PENDING_EVENTS (trans->srcpad)
+      && gst_caps_is_equal (current_caps, outcaps)) {
+    GST_DEBUG_OBJECT (trans, "output caps did not change");
+  } else {
+    ret = gst_pad_set_caps (trans->srcpad, outcaps);
+  }
+  if (current_caps)
+    gst_caps_unref (current_caps);
 
   if (ret) {
     /* try to get a pool when needed */
@@ -1490,6 +1537,26 @@ gst_base_transform_default_query (GstBaseTransform * trans,
       ret = TRUE;
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:
+    {
+      GstBufferPool *pool;
+      guint64 allocated = 0;
+
+      /* only about this element, the peers are asked by their bin */
+      GST_OBJECT_LOCK (trans);
+      if ((pool = priv->pool))
+        gst_object_ref (pool);
+      GST_OBJECT_UNLOCK (trans);
+
+      if (pool) {
+        allocated = gst_buffer_pool_get_allocated_bytes (pool);
+        gst_object_unref (pool);
+      }
+      gst_query_add_memory_usage (query, GST_OBJECT_CAST (trans), allocated,
+          0);
+      ret = TRUE;
+      break;
+    }
     default:
       ret = gst_pad_peer_query (otherpad, query);
       break;
@@ -1903,10 +1970,15 @@ gst_base_transform_src_eventfunc (GstBaseTransform * trans, GstEvent * event)
  *
  * This function is common to the push and pull-based operations.
  *
+ * When @job is not %NULL, the transform itself is not performed. @job is
+ * filled with everything needed to do it later with
+ * gst_base_transform_run_job() and @outbuf contains the prepared output
+ * buffer.
+ *
  * This function takes ownership of @inbuf */
 static GstFlowReturn
 gst_base_transform_handle_buffer (GstBaseTransform * trans, GstBuffer * inbuf,
-    GstBuffer ** outbuf)
+    GstBuffer ** outbuf, GstBaseTransformJob * job)
 {
   GstBaseTransformClass *bclass;
   GstBaseTransformPrivate *priv = trans->priv;
@@ -2036,6 +2108,15 @@ no_qos:
   GST_DEBUG_OBJECT (trans, "using allocated buffer in %p, out %p", inbuf,
       *outbuf);
 
+  if (job && !priv->passthrough) {
+    GST_DEBUG_OBJECT (trans, "postponing transform");
+    job->inbuf = inbuf;
+    job->outbuf = *outbuf;
+    job->in_place = (bclass->transform_ip != NULL) && priv->always_in_place;
+    job->deferred = TRUE;
+    return GST_FLOW_OK;
+  }
+
   /* now perform the needed transform */
   if (priv->passthrough) {
     /* In passthrough mode, give transform_ip a look at the
@@ -2120,7 +2201,7 @@ gst_base_transform_getrange (GstPad * pad, GstObject * parent, guint64 offset,
   if (klass->before_transform)
     klass->before_transform (trans, inbuf);
 
-  ret = gst_base_transform_handle_buffer (trans, inbuf, buffer);
+  ret = gst_base_transform_handle_buffer (trans, inbuf, buffer, NULL);
 
 done:
   return ret;
@@ -2134,19 +2215,12 @@ pull_error:
   }
 }
 
-static GstFlowReturn
-gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+/* the end position of @buffer, or GST_CLOCK_TIME_NONE */
+static GstClockTime
+gst_base_transform_buffer_position (GstBuffer * buffer)
 {
-  GstBaseTransform *trans;
-  GstBaseTransformClass *klass;
-  GstBaseTransformPrivate *priv;
-  GstFlowReturn ret;
   GstClockTime position = GST_CLOCK_TIME_NONE;
   GstClockTime timestamp, duration;
-  GstBuffer *outbuf = NULL;
-
-  trans = GST_BASE_TRANSFORM (parent);
-  priv = trans->priv;
 
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   duration = GST_BUFFER_DURATION (buffer);
@@ -2158,13 +2232,20 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     else
       position = timestamp;
   }
+  return position;
+}
 
-  klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
-  if (klass->before_transform)
-    klass->before_transform (trans, buffer);
+/* updates the segment and flags after @outbuf was produced with @ret from an
+ * input buffer ending at @position. Takes ownership of @outbuf and returns
+ * the buffer to push in @out, which is %NULL when nothing needs to be
+ * pushed */
+static GstFlowReturn
+gst_base_transform_finish_buffer (GstBaseTransform * trans, GstFlowReturn ret,
+    GstClockTime position, GstBuffer * outbuf, GstBuffer ** out)
+{
+  GstBaseTransformPrivate *priv = trans->priv;
 
-  /* protect transform method and concurrent buffer alloc */
-  ret = gst_base_transform_handle_buffer (trans, buffer, &outbuf);
+  *out = NULL;
 
   /* outbuf can be NULL, this means a dropped buffer, if we have a buffer but
    * GST_BASE_TRANSFORM_FLOW_DROPPED we will not push either. */
@@ -2200,7 +2281,7 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       }
       priv->processed++;
 
-      ret = gst_pad_push (trans->srcpad, outbuf);
+      *out = outbuf;
     } else {
       GST_DEBUG_OBJECT (trans, "we got return %s", gst_flow_get_name (ret));
       gst_buffer_unref (outbuf);
@@ -2217,6 +2298,325 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   return ret;
 }
 
+/* transforms @buffer and returns the buffer to push in @outbuf, which is
+ * %NULL when nothing needs to be pushed */
+static GstFlowReturn
+gst_base_transform_process_buffer (GstBaseTransform * trans,
+    GstBuffer * buffer, GstBuffer ** out)
+{
+  GstBaseTransformClass *klass;
+  GstFlowReturn ret;
+  GstClockTime position;
+  GstBuffer *outbuf = NULL;
+
+  position = gst_base_transform_buffer_position (buffer);
+
+  klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  if (klass->before_transform)
+    klass->before_transform (trans, buffer);
+
+  /* protect transform method and concurrent buffer alloc */
+  ret = gst_base_transform_handle_buffer (trans, buffer, &outbuf, NULL);
+
+  return gst_base_transform_finish_buffer (trans, ret, position, outbuf, out);
+}
+
+static GstFlowReturn
+gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstBaseTransform *trans;
+  GstFlowReturn ret;
+  GstBuffer *outbuf;
+
+  trans = GST_BASE_TRANSFORM (parent);
+
+  ret = gst_base_transform_process_buffer (trans, buffer, &outbuf);
+  if (outbuf != NULL)
+    ret = gst_pad_push (trans->srcpad, outbuf);
+
+  return ret;
+}
+
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstFlowReturn ret;
+  guint n_out;
+} GstBaseTransformListData;
+
+static gboolean
+gst_base_transform_process_list_func (GstBuffer ** buffer, guint idx,
+    gpointer user_data)
+{
+  GstBaseTransformListData *data = user_data;
+  GstBuffer *outbuf;
+
+  /* we take the reference of the list, the output buffer replaces it or
+   * is removed from the list when there is none */
+  data->ret = gst_base_transform_process_buffer (data->trans, *buffer, &outbuf);
+  *buffer = outbuf;
+  if (outbuf)
+    data->n_out++;
+
+  return data->ret == GST_FLOW_OK;
+}
+
+/* performs the transform that was postponed in @job */
+static void
+gst_base_transform_run_job (GstBaseTransformJob * job)
+{
+  GstBaseTransform *trans = job->trans;
+  GstBaseTransformClass *bclass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+
+  if (job->in_place) {
+    GST_DEBUG_OBJECT (trans, "doing inplace transform");
+    job->ret = bclass->transform_ip (trans, job->outbuf);
+  } else {
+    GST_DEBUG_OBJECT (trans, "doing non-inplace transform");
+
+    if (bclass->transform)
+      job->ret = bclass->transform (trans, job->inbuf, job->outbuf);
+    else
+      job->ret = GST_FLOW_NOT_SUPPORTED;
+  }
+
+  if (job->inbuf != job->outbuf)
+    gst_buffer_unref (job->inbuf);
+  job->inbuf = NULL;
+}
+
+typedef struct
+{
+  GstBaseTransformJob *jobs;
+  guint n_jobs;
+  volatile gint next;
+
+  GMutex lock;
+  GCond cond;
+  guint running;
+} GstBaseTransformBatch;
+
+/* runs the postponed jobs of @batch until there are none left, every thread
+ * takes the next one that is not yet taken */
+static void
+gst_base_transform_batch_run (GstBaseTransformBatch * batch)
+{
+  gint i;
+
+  while ((i = g_atomic_int_add (&batch->next, 1)) < (gint) batch->n_jobs) {
+    if (batch->jobs[i].deferred)
+      gst_base_transform_run_job (&batch->jobs[i]);
+  }
+}
+
+static void
+gst_base_transform_batch_worker (gpointer user_data)
+{
+  GstBaseTransformBatch *batch = user_data;
+
+  gst_base_transform_batch_run (batch);
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->running == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* like gst_base_transform_chain_list() but performs the transforms of the
+ * list with @n_threads threads. Everything else is still done in order from
+ * the streaming thread, only the transform and transform_ip calls run
+ * concurrently, output buffers are pushed in the order of the input. */
+static GstFlowReturn
+gst_base_transform_chain_list_parallel (GstBaseTransform * trans,
+    GstBufferList * list, guint n_threads)
+{
+  GstBaseTransformClass *klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
+  GstBaseTransformPrivate *priv = trans->priv;
+  GstBaseTransformBatch batch;
+  GstBaseTransformJob *jobs;
+  GstBuffer **bufs;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstTaskPool *pool = NULL;
+  guint i, len, n_prepared, n_deferred;
+
+  list = gst_buffer_list_make_writable (list);
+  len = gst_buffer_list_length (list);
+
+  /* take the buffers out of the list so that we hold the only reference and
+   * in place transforms don't need to copy, the list is reused for the
+   * output */
+  bufs = g_new (GstBuffer *, len);
+  for (i = 0; i < len; i++)
+    bufs[i] = gst_buffer_ref (gst_buffer_list_get (list, i));
+  gst_buffer_list_remove (list, 0, len);
+
+  jobs = g_new0 (GstBaseTransformJob, len);
+
+  /* everything up to the transform is done in order */
+  n_prepared = 0;
+  n_deferred = 0;
+  while (n_prepared < len) {
+    GstBaseTransformJob *job = &jobs[n_prepared];
+    GstBuffer *buffer = bufs[n_prepared++];
+
+    job->trans = trans;
+    job->position = gst_base_transform_buffer_position (buffer);
+
+    if (klass->before_transform)
+      klass->before_transform (trans, buffer);
+
+    job->ret = gst_base_transform_handle_buffer (trans, buffer, &job->outbuf,
+        job);
+    /* the pending discont belongs to this buffer, it is applied again when
+     * the output is collected */
+    job->discont = priv->discont;
+    priv->discont = FALSE;
+    if (job->deferred)
+      n_deferred++;
+    if (job->ret != GST_FLOW_OK && job->ret != GST_BASE_TRANSFORM_FLOW_DROPPED)
+      break;
+  }
+  for (i = n_prepared; i < len; i++)
+    gst_buffer_unref (bufs[i]);
+  g_free (bufs);
+
+  batch.jobs = jobs;
+  batch.n_jobs = n_prepared;
+  batch.next = 0;
+  batch.running = 0;
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+
+  if (n_deferred > 1) {
+    GST_OBJECT_LOCK (trans);
+    if (priv->task_pool == NULL) {
+      GError *error = NULL;
+
+      priv->task_pool = gst_task_pool_new ();
+      gst_task_pool_prepare (priv->task_pool, &error);
+      if (error) {
+        GST_WARNING_OBJECT (trans, "could not prepare task pool: %s",
+            error->message);
+        g_error_free (error);
+      }
+    }
+    pool = gst_object_ref (priv->task_pool);
+    GST_OBJECT_UNLOCK (trans);
+
+    /* the streaming thread is one of the threads */
+    for (i = 1; i < MIN (n_threads, n_deferred); i++) {
+      GError *error = NULL;
+
+      g_mutex_lock (&batch.lock);
+      batch.running++;
+      g_mutex_unlock (&batch.lock);
+
+      gst_task_pool_push (pool, gst_base_transform_batch_worker, &batch,
+          &error);
+      if (error) {
+        GST_WARNING_OBJECT (trans, "could not start worker: %s",
+            error->message);
+        g_error_free (error);
+        g_mutex_lock (&batch.lock);
+        batch.running--;
+        g_mutex_unlock (&batch.lock);
+        break;
+      }
+    }
+  }
+
+  gst_base_transform_batch_run (&batch);
+
+  g_mutex_lock (&batch.lock);
+  while (batch.running > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+  if (pool)
+    gst_object_unref (pool);
+
+  /* collect the output in order, everything after the first error is
+   * dropped */
+  for (i = 0; i < n_prepared; i++) {
+    GstBuffer *outbuf;
+
+    if (ret != GST_FLOW_OK) {
+      if (jobs[i].outbuf)
+        gst_buffer_unref (jobs[i].outbuf);
+      continue;
+    }
+    if (jobs[i].discont)
+      priv->discont = TRUE;
+    ret = gst_base_transform_finish_buffer (trans, jobs[i].ret,
+        jobs[i].position, jobs[i].outbuf, &outbuf);
+    if (outbuf)
+      gst_buffer_list_add (list, outbuf);
+  }
+  g_free (jobs);
+
+  GST_LOG_OBJECT (trans, "processed list with %u threads, %u buffers out, "
+      "flow %s", n_threads, gst_buffer_list_length (list),
+      gst_flow_get_name (ret));
+
+  if (gst_buffer_list_length (list) > 0) {
+    GstFlowReturn push_ret;
+
+    push_ret = gst_pad_push_list (trans->srcpad, list);
+    if (ret == GST_FLOW_OK)
+      ret = push_ret;
+  } else {
+    gst_buffer_list_unref (list);
+  }
+
+  return ret;
+}
+
+/* transforms the buffers of the list in place and pushes the result as one
+ * list, so that upstream batching is kept */
+static GstFlowReturn
+gst_base_transform_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstBaseTransformListData data;
+  GstFlowReturn ret;
+  guint len, n_threads;
+
+  data.trans = GST_BASE_TRANSFORM (parent);
+
+  GST_OBJECT_LOCK (data.trans);
+  n_threads = data.trans->priv->n_threads;
+  GST_OBJECT_UNLOCK (data.trans);
+
+  if (n_threads > 1 && gst_buffer_list_length (list) > 1)
+    return gst_base_transform_chain_list_parallel (data.trans, list,
+        n_threads);
+  data.ret = GST_FLOW_OK;
+  data.n_out = 0;
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, gst_base_transform_process_list_func, &data);
+
+  /* drop the buffers we did not get to after an error */
+  len = gst_buffer_list_length (list);
+  if (len > data.n_out)
+    gst_buffer_list_remove (list, data.n_out, len - data.n_out);
+
+  GST_LOG_OBJECT (data.trans, "processed list, %u buffers out, flow %s",
+      data.n_out, gst_flow_get_name (data.ret));
+
+  if (data.n_out > 0) {
+    ret = gst_pad_push_list (data.trans->srcpad, list);
+    if (data.ret == GST_FLOW_OK)
+      data.ret = ret;
+  } else {
+    gst_buffer_list_unref (list);
+  }
+
+  return data.ret;
+}
+
 static void
 gst_base_transform_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -2528,6 +2928,64 @@ gst_base_transform_update_qos (GstBaseTransform * trans,
   GST_OBJECT_UNLOCK (trans);
 }
 
+/**
+ * gst_base_transform_set_parallel:
+ * @trans: a #GstBaseTransform
+ * @n_threads: the number of threads to use, 0 or 1 to disable
+ *
+ * Let the transform of the buffers of a buffer list run in @n_threads
+ * threads at the same time. Only the transform and transform_ip calls are
+ * done concurrently, all other processing and the pushing of the output
+ * buffers still happens in order from the streaming thread.
+ *
+ * This is only allowed for subclasses of which the transform and
+ * transform_ip functions do not depend on or change state that is shared
+ * between buffers. Buffers that are not part of a buffer list are always
+ * transformed from the streaming thread.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+void
+gst_base_transform_set_parallel (GstBaseTransform * trans, guint n_threads)
+{
+  g_return_if_fail (GST_IS_BASE_TRANSFORM (trans));
+
+  GST_DEBUG_OBJECT (trans, "parallel transform with %u threads", n_threads);
+
+  GST_OBJECT_LOCK (trans);
+  trans->priv->n_threads = n_threads;
+  GST_OBJECT_UNLOCK (trans);
+}
+
+/**
+ * gst_base_transform_get_parallel:
+ * @trans: a #GstBaseTransform
+ *
+ * Get the number of threads used for the transform of buffer lists, see
+ * gst_base_transform_set_parallel().
+ *
+ * Returns: the number of threads, 0 or 1 when disabled.
+ *
+ * MT safe.
+ *
+ * Since: 1.2
+ */
+guint
+gst_base_transform_get_parallel (GstBaseTransform * trans)
+{
+  guint result;
+
+  g_return_val_if_fail (GST_IS_BASE_TRANSFORM (trans), 0);
+
+  GST_OBJECT_LOCK (trans);
+  result = trans->priv->n_threads;
+  GST_OBJECT_UNLOCK (trans);
+
+  return result;
+}
+
 /**
  * gst_base_transform_set_qos_enabled:
  * @trans: a #GstBaseTransform
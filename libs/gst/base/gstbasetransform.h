@@ -280,6 +280,10 @@ void		gst_base_transform_set_qos_enabled  (GstBaseTransform *trans,
 		                                     gboolean enabled);
 gboolean	gst_base_transform_is_qos_enabled   (GstBaseTransform *trans);
 
+void            gst_base_transform_set_parallel     (GstBaseTransform *trans,
+                                                     guint n_threads);
+guint           gst_base_transform_get_parallel     (GstBaseTransform *trans);
+
 void            gst_base_transform_set_gap_aware    (GstBaseTransform *trans,
                                                      gboolean gap_aware);
 
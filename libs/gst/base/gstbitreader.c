@@ -293,3 +293,125 @@ GST_BIT_READER_READ_BITS (8);
 GST_BIT_READER_READ_BITS (16);
 GST_BIT_READER_READ_BITS (32);
 GST_BIT_READER_READ_BITS (64);
+
+/* loads the next (up to) 64 bits at the current position into the most
+ * significant bits of the return value, *avail is set to the number of
+ * valid bits, the bits after those are 0 */
+static inline guint64
+gst_bit_reader_load_cache (const GstBitReader * reader, guint * avail)
+{
+  const guint8 *data = reader->data + reader->byte;
+  guint n = MIN (reader->size - reader->byte, 8);
+  guint64 cache;
+  guint i;
+
+  if (G_LIKELY (n == 8)) {
+    cache = GST_READ_UINT64_BE (data);
+  } else {
+    cache = 0;
+    for (i = 0; i < n; i++)
+      cache |= ((guint64) data[i]) << (56 - 8 * i);
+  }
+
+  *avail = n * 8 - reader->bit;
+  return cache << reader->bit;
+}
+
+static inline guint
+gst_bit_reader_clz64 (guint64 v)
+{
+#if defined(__GNUC__) && (__GNUC__ > 3 || (__GNUC__ == 3 && __GNUC_MINOR__ >= 4))
+  return __builtin_clzll (v);
+#else
+  guint n = 0;
+
+  while (!(v & G_GUINT64_CONSTANT (0x8000000000000000))) {
+    v <<= 1;
+    n++;
+  }
+  return n;
+#endif
+}
+
+/**
+ * gst_bit_reader_get_exp_golomb_uint32:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #guint32 to store the result
+ *
+ * Read an unsigned Exp-Golomb code, as used by the ue(v) syntax elements of
+ * H.264 and H.265, into @val and update the current position.
+ *
+ * The leading zero bits are counted on a 64 bit cache of the data, which
+ * also holds the whole code for all but the longest codes, so no loop over
+ * the single bits is needed.
+ *
+ * Returns: %TRUE if successful, %FALSE if there are not enough bits left or
+ * the value does not fit into 32 bits.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_bit_reader_get_exp_golomb_uint32 (GstBitReader * reader, guint32 * val)
+{
+  guint64 cache;
+  guint avail, zeros, len;
+
+  g_return_val_if_fail (reader != NULL, FALSE);
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  if (G_UNLIKELY (reader->byte >= reader->size))
+    return FALSE;
+
+  cache = gst_bit_reader_load_cache (reader, &avail);
+  if (G_UNLIKELY (cache == 0))
+    return FALSE;
+
+  zeros = gst_bit_reader_clz64 (cache);
+  if (G_UNLIKELY (zeros > 31))
+    return FALSE;
+
+  len = 2 * zeros + 1;
+  if (G_UNLIKELY (_gst_bit_reader_get_remaining_unchecked (reader) < len))
+    return FALSE;
+
+  if (G_LIKELY (len <= avail)) {
+    *val = (guint32) ((cache >> (64 - len)) - 1);
+    gst_bit_reader_skip_unchecked (reader, len);
+  } else {
+    gst_bit_reader_skip_unchecked (reader, zeros + 1);
+    *val = ((1U << zeros) |
+        gst_bit_reader_get_bits_uint32_unchecked (reader, zeros)) - 1;
+  }
+
+  return TRUE;
+}
+
+/**
+ * gst_bit_reader_get_exp_golomb_int32:
+ * @reader: a #GstBitReader instance
+ * @val: (out): Pointer to a #gint32 to store the result
+ *
+ * Read a signed Exp-Golomb code, as used by the se(v) syntax elements of
+ * H.264 and H.265, into @val and update the current position.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_bit_reader_get_exp_golomb_int32 (GstBitReader * reader, gint32 * val)
+{
+  guint32 v;
+
+  g_return_val_if_fail (val != NULL, FALSE);
+
+  if (!gst_bit_reader_get_exp_golomb_uint32 (reader, &v))
+    return FALSE;
+
+  if (v & 1)
+    *val = (gint32) ((v >> 1) + 1);
+  else
+    *val = -(gint32) (v >> 1);
+
+  return TRUE;
+}
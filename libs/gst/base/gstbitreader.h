@@ -75,6 +75,9 @@ gboolean        gst_bit_reader_peek_bits_uint16 (const GstBitReader *reader, gui
 gboolean        gst_bit_reader_peek_bits_uint32 (const GstBitReader *reader, guint32 *val, guint nbits);
 gboolean        gst_bit_reader_peek_bits_uint64 (const GstBitReader *reader, guint64 *val, guint nbits);
 
+gboolean        gst_bit_reader_get_exp_golomb_uint32 (GstBitReader *reader, guint32 *val);
+gboolean        gst_bit_reader_get_exp_golomb_int32  (GstBitReader *reader, gint32 *val);
+
 /**
  * GST_BIT_READER_INIT:
  * @data: Data from which the #GstBitReader should read
@@ -25,6 +25,7 @@
 
 #define GST_BYTE_READER_DISABLE_INLINES
 #include "gstbytereader.h"
+#include "gstbase_private.h"
 
 #include <string.h>
 
@@ -39,6 +40,12 @@
  * and functions for reading little/big endian floating points numbers of
  * 32 and 64 bits. It also provides functions to read NUL-terminated strings
  * in various character encodings.
+ *
+ * Arrays of 16 and 32 bit integers can be read in one go with
+ * gst_byte_reader_get_uint16_array_le() and the related functions. When a
+ * parser reads a header of known size field by field, it can check
+ * gst_byte_reader_get_remaining() once and then use the _unchecked variants
+ * of the getters, which do no bounds checks of their own.
  */
 
 /**
@@ -771,6 +778,190 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
   return _gst_byte_reader_dup_data_inline (reader, size, val);
 }
 
+/**
+ * gst_byte_reader_get_uint16_array_le:
+ * @reader: a #GstByteReader instance
+ * @val: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint16 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 16 bit little endian integers into @val and update the
+ * current position. Nothing is read if less than @n values are left.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.2
+ */
+
+/**
+ * gst_byte_reader_get_uint16_array_be:
+ * @reader: a #GstByteReader instance
+ * @val: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint16 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 16 bit big endian integers into @val and update the
+ * current position. Nothing is read if less than @n values are left.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.2
+ */
+
+/**
+ * gst_byte_reader_get_uint32_array_le:
+ * @reader: a #GstByteReader instance
+ * @val: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint32 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 32 bit little endian integers into @val and update the
+ * current position. Nothing is read if less than @n values are left.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.2
+ */
+
+/**
+ * gst_byte_reader_get_uint32_array_be:
+ * @reader: a #GstByteReader instance
+ * @val: (out caller-allocates) (array length=n): array of at least @n
+ *     #guint32 to store the result
+ * @n: number of values to read
+ *
+ * Read @n unsigned 32 bit big endian integers into @val and update the
+ * current position. Nothing is read if less than @n values are left.
+ *
+ * Returns: %TRUE if successful, %FALSE otherwise.
+ *
+ * Since: 1.2
+ */
+
+/* The data is copied to the aligned destination first and then swapped in
+ * place. That loop has no bounds checks and no unaligned loads, so the
+ * compiler turns it into vector byte shuffles. If the byte order of the
+ * data is the native one the copy is all there is to do. */
+#define GST_BYTE_READER_GET_ARRAY(bits,endian,swap) \
+gboolean \
+gst_byte_reader_get_uint##bits##_array_##endian (GstByteReader * reader, \
+    guint##bits * val, guint n) \
+{ \
+  guint i; \
+  \
+  g_return_val_if_fail (reader != NULL, FALSE); \
+  g_return_val_if_fail (val != NULL || n == 0, FALSE); \
+  \
+  if (G_UNLIKELY (n > _gst_byte_reader_get_remaining_unchecked (reader) / \
+              (bits / 8))) \
+    return FALSE; \
+  \
+  memcpy (val, reader->data + reader->byte, n * (bits / 8)); \
+  reader->byte += n * (bits / 8); \
+  \
+  if (swap) { \
+    for (i = 0; i < n; i++) \
+      val[i] = GUINT##bits##_SWAP_LE_BE (val[i]); \
+  } \
+  return TRUE; \
+}
+
+/* *INDENT-OFF* */
+
+GST_BYTE_READER_GET_ARRAY (16, le, G_BYTE_ORDER == G_BIG_ENDIAN)
+GST_BYTE_READER_GET_ARRAY (16, be, G_BYTE_ORDER == G_LITTLE_ENDIAN)
+GST_BYTE_READER_GET_ARRAY (32, le, G_BYTE_ORDER == G_BIG_ENDIAN)
+GST_BYTE_READER_GET_ARRAY (32, be, G_BYTE_ORDER == G_LITTLE_ENDIAN)
+
+/* *INDENT-ON* */
+
+/*
+ * _gst_masked_scan_uint32:
+ * @data: the data to scan
+ * @size: the size of @data
+ * @mask: mask to apply to the data before matching against @pattern
+ * @pattern: pattern to match
+ * @scanned: the number of bytes that were scanned before @data
+ * @state: the last 4 bytes before @data, updated with the last 4 bytes that
+ *     were scanned
+ *
+ * Scans @data for @pattern, continuing a scan of the @scanned bytes before
+ * it. A match needs 4 bytes of scanned data.
+ *
+ * When the mask has a byte with all bits set, only the positions where
+ * that byte of the pattern occurs can match. Those are found with memchr(),
+ * which the C library implements with vector instructions where the CPU
+ * has them, instead of looking at every byte. This is what makes scanning
+ * for the 00 00 01 start codes of MPEG streams fast.
+ *
+ * Returns: the index in @data of the last byte of the match, or -1
+ */
+gssize
+_gst_masked_scan_uint32 (const guint8 * data, gsize size, guint32 mask,
+    guint32 pattern, gsize scanned, guint32 * state)
+{
+  guint32 s = *state;
+  gsize i, head, dist = 0;
+  gint p, anchor = -1;
+  guint8 value = 0;
+
+  /* the first bytes complete the bytes that were scanned before */
+  head = MIN (size, 3);
+  for (i = 0; i < head; i++) {
+    s = (s << 8) | data[i];
+    if (G_UNLIKELY ((s & mask) == pattern) && scanned + i >= 3) {
+      *state = s;
+      return i;
+    }
+  }
+  if (size == head) {
+    *state = s;
+    return -1;
+  }
+
+  /* look for the last byte that is fully matched, preferably one that is not
+   * 0 because that is common in most data */
+  for (p = 3; p >= 0; p--) {
+    guint8 m = mask >> ((3 - p) * 8);
+    guint8 v = pattern >> ((3 - p) * 8);
+
+    if (m == 0xff && (anchor == -1 || (value == 0 && v != 0))) {
+      anchor = p;
+      value = v;
+    }
+  }
+
+  if (anchor == -1) {
+    for (; i < size; i++) {
+      /* throw away one byte and move in the next byte */
+      s = (s << 8) | data[i];
+      if (G_UNLIKELY ((s & mask) == pattern)) {
+        *state = s;
+        return i;
+      }
+    }
+  } else {
+    /* a match ending at i has @value at i - dist */
+    dist = 3 - anchor;
+    while (i < size) {
+      const guint8 *hit;
+
+      hit = memchr (data + i - dist, value, size - i);
+      if (hit == NULL)
+        break;
+      i = hit - data + dist;
+      if (G_UNLIKELY ((GST_READ_UINT32_BE (data + i - 3) & mask) == pattern)) {
+        *state = GST_READ_UINT32_BE (data + i - 3);
+        return i;
+      }
+      i++;
+    }
+  }
+  *state = GST_READ_UINT32_BE (data + size - 4);
+
+  return -1;
+}
+
 /**
  * gst_byte_reader_masked_scan_uint32:
  * @reader: a #GstByteReader
@@ -819,7 +1010,7 @@ gst_byte_reader_masked_scan_uint32 (const GstByteReader * reader, guint32 mask,
 {
   const guint8 *data;
   guint32 state;
-  guint i;
+  gssize i;
 
   g_return_val_if_fail (size > 0, -1);
   g_return_val_if_fail ((guint64) offset + size <= reader->size - reader->byte,
@@ -835,16 +1026,9 @@ gst_byte_reader_masked_scan_uint32 (const GstByteReader * reader, guint32 mask,
   state = ~pattern;
 
   /* now find data */
-  for (i = 0; i < size; i++) {
-    /* throw away one byte and move in the next byte */
-    state = ((state << 8) | data[i]);
-    if (G_UNLIKELY ((state & mask) == pattern)) {
-      /* we have a match but we need to have skipped at
-       * least 4 bytes to fill the state. */
-      if (G_LIKELY (i >= 3))
-        return offset + i - 3;
-    }
-  }
+  i = _gst_masked_scan_uint32 (data, size, mask, pattern, 0, &state);
+  if (i >= 0)
+    return offset + i - 3;
 
   /* nothing found */
   return -1;
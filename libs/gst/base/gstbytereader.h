@@ -109,6 +109,11 @@ gboolean        gst_byte_reader_peek_float32_be (const GstByteReader *reader, gf
 gboolean        gst_byte_reader_peek_float64_le (const GstByteReader *reader, gdouble *val);
 gboolean        gst_byte_reader_peek_float64_be (const GstByteReader *reader, gdouble *val);
 
+gboolean        gst_byte_reader_get_uint16_array_le (GstByteReader *reader, guint16 *val, guint n);
+gboolean        gst_byte_reader_get_uint16_array_be (GstByteReader *reader, guint16 *val, guint n);
+gboolean        gst_byte_reader_get_uint32_array_le (GstByteReader *reader, guint32 *val, guint n);
+gboolean        gst_byte_reader_get_uint32_array_be (GstByteReader *reader, guint32 *val, guint n);
+
 gboolean        gst_byte_reader_dup_data        (GstByteReader * reader, guint size, guint8       ** val);
 gboolean        gst_byte_reader_get_data        (GstByteReader * reader, guint size, const guint8 ** val);
 gboolean        gst_byte_reader_peek_data       (const GstByteReader * reader, guint size, const guint8 ** val);
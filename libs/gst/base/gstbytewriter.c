@@ -36,8 +36,23 @@
  * 32 and 64 bits and functions for reading little/big endian floating points numbers of
  * 32 and 64 bits. It also provides functions to write/read NUL-terminated strings
  * in various character encodings.
+ *
+ * A writer that is created with gst_byte_writer_new_chunked() never
+ * reallocates and copies the data that was written so far. When a chunk is
+ * full the writer continues in a new one and gst_byte_writer_reset_and_get_buffer()
+ * returns a #GstBuffer with one memory per chunk. The data of the
+ * completed chunks can not be read or overwritten anymore.
  */
 
+#define DEFAULT_CHUNK_SIZE 4096
+
+struct _GstByteWriterChunks
+{
+  GstBuffer *buffer;            /* the completed chunks */
+  guint chunk_size;
+  guint offset;                 /* the size of the completed chunks */
+};
+
 /**
  * gst_byte_writer_new:
  *
@@ -109,6 +124,29 @@ gst_byte_writer_new_with_data (guint8 * data, guint size, gboolean initialized)
   return ret;
 }
 
+/**
+ * gst_byte_writer_new_chunked:
+ * @chunk_size: Size of the chunks, or 0 for a default size
+ *
+ * Creates a new #GstByteWriter instance in chunked mode, see
+ * gst_byte_writer_init_chunked().
+ *
+ * Free-function: gst_byte_writer_free
+ *
+ * Returns: (transfer full): a new #GstByteWriter instance
+ *
+ * Since: 1.2
+ */
+GstByteWriter *
+gst_byte_writer_new_chunked (guint chunk_size)
+{
+  GstByteWriter *ret = g_slice_new0 (GstByteWriter);
+
+  gst_byte_writer_init_chunked (ret, chunk_size);
+
+  return ret;
+}
+
 /**
  * gst_byte_writer_init:
  * @writer: #GstByteWriter instance
@@ -173,6 +211,108 @@ gst_byte_writer_init_with_data (GstByteWriter * writer, guint8 * data,
   writer->owned = FALSE;
 }
 
+/**
+ * gst_byte_writer_init_chunked:
+ * @writer: #GstByteWriter instance
+ * @chunk_size: Size of the chunks, or 0 for a default size
+ *
+ * Initializes @writer to an empty instance that writes into a chain of
+ * chunks of at least @chunk_size bytes instead of reallocating a single
+ * memory area. A single write that is larger than @chunk_size gets a chunk
+ * of its own size.
+ *
+ * The data of a chunk stays where it was written, the current position can
+ * only be moved inside of the chunk that is currently written and only this
+ * chunk can be read with the #GstByteReader functions.
+ * gst_byte_writer_reset_and_get_buffer() returns the chunks as the memories
+ * of a buffer without copying them.
+ *
+ * Since: 1.2
+ */
+void
+gst_byte_writer_init_chunked (GstByteWriter * writer, guint chunk_size)
+{
+  g_return_if_fail (writer != NULL);
+
+  gst_byte_writer_init (writer);
+
+  writer->chunks = g_slice_new0 (GstByteWriterChunks);
+  writer->chunks->buffer = gst_buffer_new ();
+  writer->chunks->chunk_size = chunk_size ? chunk_size : DEFAULT_CHUNK_SIZE;
+}
+
+guint
+_gst_byte_writer_get_chunks_offset (const GstByteWriter * writer)
+{
+  return writer->chunks->offset;
+}
+
+/* appends the current chunk to the completed chunks, takes ownership of the
+ * data */
+static void
+gst_byte_writer_complete_chunk (GstByteWriter * writer, guint size)
+{
+  GstByteWriterChunks *chunks = writer->chunks;
+  guint8 *data = (guint8 *) writer->parent.data;
+
+  if (size > 0) {
+    gst_buffer_append_memory (chunks->buffer,
+        gst_memory_new_wrapped (0, data, writer->alloc_size, 0, size, data,
+            g_free));
+    chunks->offset += size;
+  } else {
+    g_free (data);
+  }
+  writer->parent.data = NULL;
+}
+
+/* called when there are less than @size bytes left in the current chunk.
+ * The data after the current position is moved to the new chunk, so the
+ * write can overwrite it as in a single memory area. */
+gboolean
+_gst_byte_writer_next_chunk (GstByteWriter * writer, guint size)
+{
+  GstByteWriterChunks *chunks = writer->chunks;
+  guint pos = writer->parent.byte;
+  guint tail = writer->parent.size - pos;
+  guint alloc;
+  guint8 *data;
+
+  if (G_UNLIKELY (chunks->offset + pos > G_MAXUINT - MAX (size, tail)))
+    return FALSE;
+
+  alloc = MAX (chunks->chunk_size, MAX (size, tail));
+  data = g_try_malloc (alloc);
+  if (G_UNLIKELY (data == NULL))
+    return FALSE;
+
+  if (tail > 0)
+    memcpy (data, writer->parent.data + pos, tail);
+
+  gst_byte_writer_complete_chunk (writer, pos);
+
+  writer->parent.data = data;
+  writer->parent.byte = 0;
+  writer->parent.size = tail;
+  writer->alloc_size = alloc;
+
+  return TRUE;
+}
+
+static GstBuffer *
+gst_byte_writer_reset_and_get_chunks (GstByteWriter * writer)
+{
+  GstBuffer *buffer;
+
+  gst_byte_writer_complete_chunk (writer, writer->parent.size);
+
+  buffer = writer->chunks->buffer;
+  writer->chunks->buffer = NULL;
+  gst_byte_writer_reset (writer);
+
+  return buffer;
+}
+
 /**
  * gst_byte_writer_reset:
  * @writer: #GstByteWriter instance
@@ -185,6 +325,11 @@ gst_byte_writer_reset (GstByteWriter * writer)
 {
   g_return_if_fail (writer != NULL);
 
+  if (writer->chunks) {
+    if (writer->chunks->buffer)
+      gst_buffer_unref (writer->chunks->buffer);
+    g_slice_free (GstByteWriterChunks, writer->chunks);
+  }
   if (writer->owned)
     g_free ((guint8 *) writer->parent.data);
   memset (writer, 0, sizeof (GstByteWriter));
@@ -196,6 +341,9 @@ gst_byte_writer_reset (GstByteWriter * writer)
  *
  * Resets @writer and returns the current data.
  *
+ * For a writer in chunked mode the chunks are copied into a single memory
+ * area, use gst_byte_writer_reset_and_get_buffer() to avoid that.
+ *
  * Free-function: g_free
  *
  * Returns: (array) (transfer full): the current data. g_free() after
@@ -208,6 +356,22 @@ gst_byte_writer_reset_and_get_data (GstByteWriter * writer)
 
   g_return_val_if_fail (writer != NULL, NULL);
 
+  if (writer->chunks) {
+    GstBuffer *buffer;
+    gsize size;
+
+    buffer = gst_byte_writer_reset_and_get_chunks (writer);
+    size = gst_buffer_get_size (buffer);
+    data = NULL;
+    if (size > 0) {
+      data = g_malloc (size);
+      gst_buffer_extract (buffer, 0, data, size);
+    }
+    gst_buffer_unref (buffer);
+
+    return data;
+  }
+
   data = (guint8 *) writer->parent.data;
   if (!writer->owned)
     data = g_memdup (data, writer->parent.size);
@@ -223,6 +387,9 @@ gst_byte_writer_reset_and_get_data (GstByteWriter * writer)
  *
  * Resets @writer and returns the current data as buffer.
  *
+ * For a writer in chunked mode the buffer contains one memory for each
+ * chunk.
+ *
  * Free-function: gst_buffer_unref
  *
  * Returns: (transfer full): the current data as buffer. gst_buffer_unref()
@@ -237,6 +404,9 @@ gst_byte_writer_reset_and_get_buffer (GstByteWriter * writer)
 
   g_return_val_if_fail (writer != NULL, NULL);
 
+  if (writer->chunks)
+    return gst_byte_writer_reset_and_get_chunks (writer);
+
   size = writer->parent.size;
   data = gst_byte_writer_reset_and_get_data (writer);
 
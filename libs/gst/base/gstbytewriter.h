@@ -30,6 +30,8 @@ G_BEGIN_DECLS
 
 #define GST_BYTE_WRITER(writer) ((GstByteWriter *) (writer))
 
+typedef struct _GstByteWriterChunks GstByteWriterChunks;
+
 /**
  * GstByteWriter:
  * @parent: #GstByteReader parent
@@ -48,17 +50,21 @@ typedef struct {
   gboolean owned;
 
   /* < private > */
-  gpointer _gst_reserved[GST_PADDING];
+  GstByteWriterChunks *chunks;
+
+  gpointer _gst_reserved[GST_PADDING - 1];
 } GstByteWriter;
 
 GstByteWriter * gst_byte_writer_new             (void) G_GNUC_MALLOC;
 GstByteWriter * gst_byte_writer_new_with_size   (guint size, gboolean fixed) G_GNUC_MALLOC;
 GstByteWriter * gst_byte_writer_new_with_data   (guint8 *data, guint size, gboolean initialized) G_GNUC_MALLOC;
+GstByteWriter * gst_byte_writer_new_chunked     (guint chunk_size) G_GNUC_MALLOC;
 
 void            gst_byte_writer_init            (GstByteWriter *writer);
 void            gst_byte_writer_init_with_size  (GstByteWriter *writer, guint size, gboolean fixed);
 void            gst_byte_writer_init_with_data  (GstByteWriter *writer, guint8 *data,
                                                  guint size, gboolean initialized);
+void            gst_byte_writer_init_chunked    (GstByteWriter *writer, guint chunk_size);
 
 void            gst_byte_writer_free                    (GstByteWriter *writer);
 guint8 *        gst_byte_writer_free_and_get_data       (GstByteWriter *writer);
@@ -68,6 +74,10 @@ void            gst_byte_writer_reset                   (GstByteWriter *writer);
 guint8 *        gst_byte_writer_reset_and_get_data      (GstByteWriter *writer);
 GstBuffer *     gst_byte_writer_reset_and_get_buffer    (GstByteWriter *writer) G_GNUC_MALLOC;
 
+/* used by the inline functions for the chunked mode, do not use */
+guint           _gst_byte_writer_get_chunks_offset      (const GstByteWriter *writer);
+gboolean        _gst_byte_writer_next_chunk             (GstByteWriter *writer, guint size);
+
 /**
  * gst_byte_writer_get_pos:
  * @writer: #GstByteWriter instance
@@ -80,7 +90,8 @@ GstBuffer *     gst_byte_writer_reset_and_get_buffer    (GstByteWriter *writer)
  * @pos: new position
  *
  * Sets the current read/write cursor of @writer. The new position
- * can only be between 0 and the current size.
+ * can only be between 0 and the current size. For a writer in chunked mode
+ * it can not be before the start of the chunk that is currently written.
  *
  * Returns: %TRUE if the new position could be set
  */
@@ -98,19 +109,45 @@ G_INLINE_FUNC guint     gst_byte_writer_get_size (const GstByteWriter *writer);
 static inline guint
 gst_byte_writer_get_pos (const GstByteWriter *writer)
 {
-  return gst_byte_reader_get_pos ((const GstByteReader *) writer);
+  guint pos;
+
+  g_return_val_if_fail (writer != NULL, 0);
+
+  pos = gst_byte_reader_get_pos ((const GstByteReader *) writer);
+  if (G_UNLIKELY (writer->chunks))
+    pos += _gst_byte_writer_get_chunks_offset (writer);
+
+  return pos;
 }
 
 static inline gboolean
 gst_byte_writer_set_pos (GstByteWriter *writer, guint pos)
 {
+  g_return_val_if_fail (writer != NULL, FALSE);
+
+  if (G_UNLIKELY (writer->chunks)) {
+    guint offset = _gst_byte_writer_get_chunks_offset (writer);
+
+    if (pos < offset)
+      return FALSE;
+    pos -= offset;
+  }
+
   return gst_byte_reader_set_pos (GST_BYTE_READER (writer), pos);
 }
 
 static inline guint
 gst_byte_writer_get_size (const GstByteWriter *writer)
 {
-  return gst_byte_reader_get_size ((const GstByteReader *) writer);
+  guint size;
+
+  g_return_val_if_fail (writer != NULL, 0);
+
+  size = gst_byte_reader_get_size ((const GstByteReader *) writer);
+  if (G_UNLIKELY (writer->chunks))
+    size += _gst_byte_writer_get_chunks_offset (writer);
+
+  return size;
 }
 #endif
 
@@ -182,6 +219,8 @@ _gst_byte_writer_ensure_free_space_inline (GstByteWriter * writer, guint size)
 
   if (G_LIKELY (size <= writer->alloc_size - writer->parent.byte))
     return TRUE;
+  if (G_UNLIKELY (writer->chunks))
+    return _gst_byte_writer_next_chunk (writer, size);
   if (G_UNLIKELY (writer->fixed || !writer->owned))
     return FALSE;
   if (G_UNLIKELY (writer->parent.byte > G_MAXUINT - size))
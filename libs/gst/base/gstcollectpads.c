@@ -101,8 +101,25 @@ struct _GstCollectDataPrivate
   /* refcounting for struct, and destroy callback */
   GstCollectDataDestroyNotify destroy_notify;
   gint refcount;
+
+  /* with STREAM_LOCK of the collectpads */
+  guint index;                  /* order in which the pads were added */
+  guint buffer_seq;             /* changes with every queued buffer */
+  GQueue queue;                 /* buffers waiting behind the queued buffer */
+
+  /* with evt_lock of the collectpads */
+  GCond evt_cond;
+  guint32 evt_cookie;
 };
 
+/* an entry of the heap of queued buffers, see gst_collect_pads_heap_push() */
+typedef struct
+{
+  GstCollectData *data;
+  GstClockTime timestamp;
+  guint buffer_seq;
+} GstCollectPadsHeapEntry;
+
 struct _GstCollectPadsPrivate
 {
   /* with LOCK and/or STREAM_LOCK */
@@ -113,12 +130,22 @@ struct _GstCollectPadsPrivate
   guint numpads;                /* number of pads in @data */
   guint queuedpads;             /* number of pads with a buffer */
   guint eospads;                /* number of pads that are EOS */
+  guint queue_depth;            /* buffers a pad can queue, ATOMIC */
+
+  GstClockTime latency;         /* live deadline, with LOCK */
+  GstClockID timeout_id;        /* pending deadline, with STREAM_LOCK */
+  GstClockTime timeout_time;
+  gint timed_out;               /* deadline passed, ATOMIC */
+
   GstClockTime earliest_time;   /* Current earliest time */
   GstCollectData *earliest_data;        /* Pad data for current earliest time */
+  GArray *heap;                 /* queued buffers, best first */
+  gboolean heap_dirty;          /* rebuild the heap before using it */
 
   /* with LOCK */
   GSList *pad_list;             /* updated pad list */
   guint32 pad_cookie;           /* updated cookie */
+  guint pad_index;              /* index of the next added pad */
 
   GstCollectPadsFunction func;  /* function and user_data for callback */
   gpointer user_data;
@@ -135,8 +162,8 @@ struct _GstCollectPadsPrivate
 
   /* no other lock needed */
   GMutex evt_lock;              /* these make up sort of poor man's event signaling */
-  GCond evt_cond;
   guint32 evt_cookie;
+  GSList *evt_waiters;          /* GstCollectData waiting on their evt_cond */
 };
 
 static void gst_collect_pads_clear (GstCollectPads * pads,
@@ -156,6 +183,11 @@ static gint gst_collect_pads_default_compare_func (GstCollectPads * pads,
 static gboolean gst_collect_pads_recalculate_full (GstCollectPads * pads);
 static void ref_data (GstCollectData * data);
 static void unref_data (GstCollectData * data);
+static void gst_collect_pads_heap_clear (GstCollectPads * pads);
+static void gst_collect_pads_heap_rebuild (GstCollectPads * pads);
+static void gst_collect_pads_queue_buffer (GstCollectPads * pads,
+    GstCollectData * data, GstBuffer * buffer);
+static void gst_collect_pads_clear_timeout (GstCollectPads * pads);
 
 static gboolean gst_collect_pads_event_default_internal (GstCollectPads *
     pads, GstCollectData * data, GstEvent * event, gpointer user_data);
@@ -169,42 +201,48 @@ static gboolean gst_collect_pads_query_default_internal (GstCollectPads *
  * Alternative implementations are possible, e.g. some low-level re-implementing
  * of the 2 above locks to drop both of them atomically when going into _WAIT.
  */
-#define GST_COLLECT_PADS_GET_EVT_COND(pads) (&((GstCollectPads *)pads)->priv->evt_cond)
 #define GST_COLLECT_PADS_GET_EVT_LOCK(pads) (&((GstCollectPads *)pads)->priv->evt_lock)
-#define GST_COLLECT_PADS_EVT_WAIT(pads, cookie) G_STMT_START {    \
-  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));            \
-  /* should work unless a lot of event'ing and thread starvation */\
-  while (cookie == ((GstCollectPads *) pads)->priv->evt_cookie)         \
-    g_cond_wait (GST_COLLECT_PADS_GET_EVT_COND (pads),            \
-        GST_COLLECT_PADS_GET_EVT_LOCK (pads));                    \
-  cookie = ((GstCollectPads *) pads)->priv->evt_cookie;                 \
-  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));          \
+/* Every waiting pad waits on its own condition so that popping a buffer only
+ * wakes up the thread of that pad. The cookie is the sum of the cookie of the
+ * collectpads, changed by a broadcast, and the cookie of the pad, changed with
+ * a signal of the pad, and thus changes with either of them. */
+#define GST_COLLECT_PADS_EVT_COOKIE(pads, data) \
+  (((GstCollectPads *) pads)->priv->evt_cookie + (data)->priv->evt_cookie)
+#define GST_COLLECT_PADS_EVT_WAIT(pads, data, cookie) G_STMT_START {    \
+  GstCollectPadsPrivate *__priv = ((GstCollectPads *) pads)->priv;      \
+                                                                        \
+  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                  \
+  __priv->evt_waiters = g_slist_prepend (__priv->evt_waiters, data);    \
+  /* should work unless a lot of event'ing and thread starvation */     \
+  while (cookie == GST_COLLECT_PADS_EVT_COOKIE (pads, data))            \
+    g_cond_wait (&(data)->priv->evt_cond,                               \
+        GST_COLLECT_PADS_GET_EVT_LOCK (pads));                          \
+  __priv->evt_waiters = g_slist_remove (__priv->evt_waiters, data);     \
+  cookie = GST_COLLECT_PADS_EVT_COOKIE (pads, data);                    \
+  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                \
 } G_STMT_END
-#define GST_COLLECT_PADS_EVT_WAIT_TIMED(pads, cookie, timeout) G_STMT_START { \
-  GTimeVal __tv; \
-  \
-  g_get_current_time (&tv); \
-  g_time_val_add (&tv, timeout); \
-  \
-  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));            \
-  /* should work unless a lot of event'ing and thread starvation */\
-  while (cookie == ((GstCollectPads *) pads)->priv->evt_cookie)         \
-    g_cond_timed_wait (GST_COLLECT_PADS_GET_EVT_COND (pads),            \
-        GST_COLLECT_PADS_GET_EVT_LOCK (pads), &tv);                    \
-  cookie = ((GstCollectPads *) pads)->priv->evt_cookie;                 \
-  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));          \
+#define GST_COLLECT_PADS_EVT_SIGNAL(pads, data) G_STMT_START {          \
+  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                  \
+  /* never mind wrap-around */                                          \
+  ++((data)->priv->evt_cookie);                                         \
+  g_cond_signal (&(data)->priv->evt_cond);                              \
+  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                \
 } G_STMT_END
-#define GST_COLLECT_PADS_EVT_BROADCAST(pads) G_STMT_START {       \
-  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));            \
-  /* never mind wrap-around */                                     \
+#define GST_COLLECT_PADS_EVT_BROADCAST(pads) G_STMT_START {             \
+  GSList *__walk;                                                       \
+                                                                        \
+  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                  \
+  /* never mind wrap-around */                                          \
   ++(((GstCollectPads *) pads)->priv->evt_cookie);                      \
-  g_cond_broadcast (GST_COLLECT_PADS_GET_EVT_COND (pads));        \
-  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));          \
+  for (__walk = ((GstCollectPads *) pads)->priv->evt_waiters; __walk;   \
+      __walk = __walk->next)                                            \
+    g_cond_signal (&((GstCollectData *) __walk->data)->priv->evt_cond); \
+  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                \
 } G_STMT_END
-#define GST_COLLECT_PADS_EVT_INIT(cookie) G_STMT_START {          \
-  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));            \
-  cookie = ((GstCollectPads *) pads)->priv->evt_cookie;                 \
-  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));          \
+#define GST_COLLECT_PADS_EVT_INIT(pads, data, cookie) G_STMT_START {    \
+  g_mutex_lock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                  \
+  cookie = GST_COLLECT_PADS_EVT_COOKIE (pads, data);                    \
+  g_mutex_unlock (GST_COLLECT_PADS_GET_EVT_LOCK (pads));                \
 } G_STMT_END
 
 static void
@@ -248,6 +286,9 @@ gst_collect_pads_init (GstCollectPads * pads)
   pads->priv->compare_user_data = NULL;
   pads->priv->earliest_data = NULL;
   pads->priv->earliest_time = GST_CLOCK_TIME_NONE;
+  pads->priv->heap = g_array_new (FALSE, FALSE,
+      sizeof (GstCollectPadsHeapEntry));
+  pads->priv->heap_dirty = FALSE;
 
   pads->priv->event_func = gst_collect_pads_event_default_internal;
   pads->priv->query_func = gst_collect_pads_query_default_internal;
@@ -258,8 +299,13 @@ gst_collect_pads_init (GstCollectPads * pads)
 
   /* members for event */
   g_mutex_init (&pads->priv->evt_lock);
-  g_cond_init (&pads->priv->evt_cond);
   pads->priv->evt_cookie = 0;
+  pads->priv->evt_waiters = NULL;
+  pads->priv->queue_depth = 1;
+  pads->priv->latency = GST_CLOCK_TIME_NONE;
+  pads->priv->timeout_id = NULL;
+  pads->priv->timeout_time = GST_CLOCK_TIME_NONE;
+  pads->priv->timed_out = 0;
 }
 
 static void
@@ -271,9 +317,11 @@ gst_collect_pads_finalize (GObject * object)
 
   g_rec_mutex_clear (&pads->stream_lock);
 
-  g_cond_clear (&pads->priv->evt_cond);
   g_mutex_clear (&pads->priv->evt_lock);
 
+  gst_collect_pads_heap_clear (pads);
+  g_array_free (pads->priv->heap, TRUE);
+
   /* Remove pads and free pads list */
   g_slist_foreach (pads->priv->pad_list, (GFunc) unref_data, NULL);
   g_slist_foreach (pads->data, (GFunc) unref_data, NULL);
@@ -360,6 +408,8 @@ gst_collect_pads_set_compare_function (GstCollectPads * pads,
   GST_OBJECT_LOCK (pads);
   pads->priv->compare_func = func;
   pads->priv->compare_user_data = user_data;
+  /* the order of the heap depends on the compare function */
+  pads->priv->heap_dirty = TRUE;
   GST_OBJECT_UNLOCK (pads);
 }
 
@@ -395,6 +445,16 @@ gst_collect_pads_set_function (GstCollectPads * pads,
   GST_OBJECT_UNLOCK (pads);
 }
 
+/* drop the buffers waiting behind the queued buffer of @data */
+static void
+gst_collect_pads_drop_queue (GstCollectData * data)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&data->priv->queue)))
+    gst_buffer_unref (buffer);
+}
+
 static void
 ref_data (GstCollectData * data)
 {
@@ -419,6 +479,8 @@ unref_data (GstCollectData * data)
   if (data->buffer) {
     gst_buffer_unref (data->buffer);
   }
+  gst_collect_pads_drop_queue (data);
+  g_cond_clear (&data->priv->evt_cond);
   g_free (data->priv);
   g_free (data);
 }
@@ -539,6 +601,61 @@ gst_collect_pads_set_clip_function (GstCollectPads * pads,
   pads->priv->clip_user_data = user_data;
 }
 
+/**
+ * gst_collect_pads_set_queue_depth:
+ * @pads: the collectpads to use
+ * @depth: the number of buffers a pad can queue, at least 1
+ *
+ * Set how many buffers every pad managed by @pads can queue before its
+ * streaming thread blocks. With the default of 1 the chain function of a pad
+ * only returns once its buffer was collected. With a larger @depth upstream
+ * can run ahead and the next buffer of a pad becomes available with
+ * gst_collect_pads_peek() as soon as the previous one was popped.
+ *
+ * Serialized events wait until all buffers of the pad were collected.
+ *
+ * Since: 1.2
+ */
+void
+gst_collect_pads_set_queue_depth (GstCollectPads * pads, guint depth)
+{
+  g_return_if_fail (pads != NULL);
+  g_return_if_fail (GST_IS_COLLECT_PADS (pads));
+  g_return_if_fail (depth > 0);
+
+  g_atomic_int_set (&pads->priv->queue_depth, depth);
+}
+
+/**
+ * gst_collect_pads_set_latency:
+ * @pads: the collectpads to use
+ * @latency: the latency of the live inputs or #GST_CLOCK_TIME_NONE
+ *
+ * Collect live inputs at a deadline instead of waiting for data on all
+ * pads. When some pads have no data, the collected function is called anyway
+ * once the clock of the element passes the running time of the earliest
+ * queued buffer plus @latency. The pads without data then have the
+ * #GST_COLLECT_PADS_STATE_GAP flag set until they queue a buffer again.
+ *
+ * The deadline wakes up the streaming threads that wait for their buffer to
+ * be collected, with a queue depth larger than 1 it is handled when the next
+ * buffer arrives if no thread waits.
+ *
+ * The default of #GST_CLOCK_TIME_NONE waits for all pads.
+ *
+ * Since: 1.2
+ */
+void
+gst_collect_pads_set_latency (GstCollectPads * pads, GstClockTime latency)
+{
+  g_return_if_fail (pads != NULL);
+  g_return_if_fail (GST_IS_COLLECT_PADS (pads));
+
+  GST_OBJECT_LOCK (pads);
+  pads->priv->latency = latency;
+  GST_OBJECT_UNLOCK (pads);
+}
+
 /**
  * gst_collect_pads_add_pad:
  * @pads: the collectpads to use
@@ -602,11 +719,13 @@ gst_collect_pads_add_pad (GstCollectPads * pads, GstPad * pad, guint size,
   data->state |= lock ? GST_COLLECT_PADS_STATE_LOCKED : 0;
   data->priv->refcount = 1;
   data->priv->destroy_notify = destroy_notify;
+  g_cond_init (&data->priv->evt_cond);
 
   GST_OBJECT_LOCK (pads);
   GST_OBJECT_LOCK (pad);
   gst_pad_set_element_private (pad, data);
   GST_OBJECT_UNLOCK (pad);
+  data->priv->index = pads->priv->pad_index++;
   pads->priv->pad_list = g_slist_append (pads->priv->pad_list, data);
   gst_pad_set_chain_function (pad, GST_DEBUG_FUNCPTR (gst_collect_pads_chain));
   gst_pad_set_event_function (pad, GST_DEBUG_FUNCPTR (gst_collect_pads_event));
@@ -618,6 +737,7 @@ gst_collect_pads_add_pad (GstCollectPads * pads, GstPad * pad, guint size,
   if (!pads->priv->started) {
     pads->data = g_slist_append (pads->data, data);
     ref_data (data);
+    pads->priv->heap_dirty = TRUE;
   }
   /* activate the pad when needed */
   if (pads->priv->started)
@@ -694,6 +814,7 @@ gst_collect_pads_remove_pad (GstCollectPads * pads, GstPad * pad)
 
       pads->data = g_slist_delete_link (pads->data, dlist);
       unref_data (pdata);
+      pads->priv->heap_dirty = TRUE;
     }
   }
   /* remove from the pad list */
@@ -746,6 +867,7 @@ gst_collect_pads_set_flushing_unlocked (GstCollectPads * pads,
         GST_COLLECT_PADS_STATE_SET (cdata, GST_COLLECT_PADS_STATE_FLUSHING);
       else
         GST_COLLECT_PADS_STATE_UNSET (cdata, GST_COLLECT_PADS_STATE_FLUSHING);
+      gst_collect_pads_drop_queue (cdata);
       gst_collect_pads_clear (pads, cdata);
       GST_OBJECT_UNLOCK (cdata->pad);
     }
@@ -859,19 +981,26 @@ gst_collect_pads_stop (GstCollectPads * pads)
     GstBuffer **buffer_p;
 
     data = collected->data;
+    gst_collect_pads_drop_queue (data);
     if (data->buffer) {
       buffer_p = &data->buffer;
       gst_buffer_replace (buffer_p, NULL);
       data->pos = 0;
     }
     GST_COLLECT_PADS_STATE_UNSET (data, GST_COLLECT_PADS_STATE_EOS);
+    GST_COLLECT_PADS_STATE_UNSET (data, GST_COLLECT_PADS_STATE_GAP);
   }
 
+  gst_collect_pads_clear_timeout (pads);
+
   if (pads->priv->earliest_data)
     unref_data (pads->priv->earliest_data);
   pads->priv->earliest_data = NULL;
   pads->priv->earliest_time = GST_CLOCK_TIME_NONE;
 
+  gst_collect_pads_heap_clear (pads);
+  pads->priv->heap_dirty = TRUE;
+
   GST_OBJECT_UNLOCK (pads);
   /* Wake them up so they can end the chain functions. */
   GST_COLLECT_PADS_EVT_BROADCAST (pads);
@@ -935,14 +1064,23 @@ gst_collect_pads_pop (GstCollectPads * pads, GstCollectData * data)
   g_return_val_if_fail (data != NULL, NULL);
 
   if ((result = data->buffer)) {
+    GstBuffer *next;
+
     data->buffer = NULL;
     data->pos = 0;
     /* one less pad with queued data now */
     if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_WAITING))
       pads->priv->queuedpads--;
+
+    /* the next buffer the pad ran ahead with takes its place */
+    if ((next = g_queue_pop_head (&data->priv->queue))) {
+      gst_collect_pads_queue_buffer (pads, data, next);
+      gst_buffer_unref (next);
+    }
   }
 
-  GST_COLLECT_PADS_EVT_BROADCAST (pads);
+  /* only the streaming thread of this pad waits for its buffer */
+  GST_COLLECT_PADS_EVT_SIGNAL (pads, data);
 
   GST_DEBUG_OBJECT (pads, "Pop buffer on pad %s:%s: buffer=%p",
       GST_DEBUG_PAD_NAME (data->pad), result);
@@ -1245,10 +1383,131 @@ gst_collect_pads_check_pads (GstCollectPads * pads)
     }
     /* and update the cookie */
     pads->priv->cookie = pads->priv->pad_cookie;
+    pads->priv->heap_dirty = TRUE;
   }
   GST_OBJECT_UNLOCK (pads);
 }
 
+/* called when the latency deadline passed */
+static gboolean
+gst_collect_pads_timeout_cb (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  GstCollectPads *pads = GST_COLLECT_PADS (user_data);
+
+  GST_DEBUG_OBJECT (pads, "latency deadline %" GST_TIME_FORMAT " passed",
+      GST_TIME_ARGS (time));
+
+  /* the waiting streaming threads do the collecting, this is the clock
+   * thread */
+  g_atomic_int_set (&pads->priv->timed_out, 1);
+  GST_COLLECT_PADS_EVT_BROADCAST (pads);
+
+  return TRUE;
+}
+
+/* with STREAM_LOCK */
+static void
+gst_collect_pads_clear_timeout (GstCollectPads * pads)
+{
+  if (pads->priv->timeout_id) {
+    gst_clock_id_unschedule (pads->priv->timeout_id);
+    gst_clock_id_unref (pads->priv->timeout_id);
+    pads->priv->timeout_id = NULL;
+  }
+  g_atomic_int_set (&pads->priv->timed_out, 0);
+}
+
+/* flag the pads that are lagging behind the deadline, returns TRUE when
+ * there is a pad, with STREAM_LOCK */
+static gboolean
+gst_collect_pads_mark_gaps (GstCollectPads * pads)
+{
+  GSList *collected;
+  gboolean res = FALSE;
+
+  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
+    GstCollectData *data = (GstCollectData *) collected->data;
+
+    if (data->buffer == NULL
+        && !GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_EOS)) {
+      GST_DEBUG_OBJECT (pads, "pad %s:%s missed the deadline",
+          GST_DEBUG_PAD_NAME (data->pad));
+      GST_COLLECT_PADS_STATE_SET (data, GST_COLLECT_PADS_STATE_GAP);
+      res = TRUE;
+    }
+  }
+  return res;
+}
+
+/* schedule the deadline of the earliest queued buffer when not all pads have
+ * data, with STREAM_LOCK */
+static void
+gst_collect_pads_update_timeout (GstCollectPads * pads)
+{
+  GstClockTime latency, deadline = GST_CLOCK_TIME_NONE;
+  GstElement *element = NULL;
+  GstClock *clock = NULL;
+  GSList *collected;
+
+  GST_OBJECT_LOCK (pads);
+  latency = pads->priv->latency;
+  GST_OBJECT_UNLOCK (pads);
+
+  if (GST_CLOCK_TIME_IS_VALID (latency) && pads->priv->started &&
+      (pads->priv->queuedpads + pads->priv->eospads) < pads->priv->numpads) {
+    for (collected = pads->data; collected;
+        collected = g_slist_next (collected)) {
+      GstCollectData *data = (GstCollectData *) collected->data;
+      GstClockTime running_time;
+
+      if (data->buffer == NULL || data->segment.format != GST_FORMAT_TIME)
+        continue;
+
+      running_time = gst_segment_to_running_time (&data->segment,
+          GST_FORMAT_TIME, GST_BUFFER_TIMESTAMP (data->buffer));
+      if (!GST_CLOCK_TIME_IS_VALID (running_time))
+        continue;
+
+      if (!GST_CLOCK_TIME_IS_VALID (deadline) || running_time < deadline)
+        deadline = running_time;
+      if (element == NULL)
+        element = gst_pad_get_parent_element (data->pad);
+    }
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (deadline) && element != NULL
+      && (clock = gst_element_get_clock (element)) != NULL)
+    deadline += gst_element_get_base_time (element) + latency;
+  else
+    deadline = GST_CLOCK_TIME_NONE;
+
+  /* a deadline that passed is not scheduled again */
+  if (pads->priv->timeout_id) {
+    if (deadline == pads->priv->timeout_time)
+      goto done;
+
+    gst_collect_pads_clear_timeout (pads);
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (deadline)) {
+    GST_DEBUG_OBJECT (pads, "scheduling deadline at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (deadline));
+
+    pads->priv->timeout_id = gst_clock_new_single_shot_id (clock, deadline);
+    pads->priv->timeout_time = deadline;
+    gst_clock_id_wait_async (pads->priv->timeout_id,
+        gst_collect_pads_timeout_cb, gst_object_ref (pads),
+        (GDestroyNotify) gst_object_unref);
+  }
+
+done:
+  if (clock)
+    gst_object_unref (clock);
+  if (element)
+    gst_object_unref (element);
+}
+
 /* checks if all the pads are collected and call the collectfunction
  *
  * Should be called with STREAM_LOCK.
@@ -1283,10 +1542,18 @@ gst_collect_pads_check_collected (GstCollectPads * pads)
     flow_ret = func (pads, user_data);
   } else {
     gboolean collected = FALSE;
+    gboolean timed_out = FALSE;
+
+    /* the latency deadline passed, collect what we have */
+    if (pads->priv->queuedpads > 0
+        && g_atomic_int_compare_and_exchange (&pads->priv->timed_out, 1, 0))
+      timed_out = gst_collect_pads_mark_gaps (pads);
 
     /* We call the collected function as long as our condition matches. */
-    while (((pads->priv->queuedpads + pads->priv->eospads) >=
+    while (timed_out || ((pads->priv->queuedpads + pads->priv->eospads) >=
             pads->priv->numpads)) {
+      timed_out = FALSE;
+
       GST_DEBUG_OBJECT (pads,
           "All active pads (%d + %d >= %d) have data, " "calling %s",
           pads->priv->queuedpads, pads->priv->eospads, pads->priv->numpads,
@@ -1305,6 +1572,8 @@ gst_collect_pads_check_collected (GstCollectPads * pads)
     if (!collected)
       GST_DEBUG_OBJECT (pads, "Not all active pads (%d) have data, continuing",
           pads->priv->numpads);
+
+    gst_collect_pads_update_timeout (pads);
   }
   return flow_ret;
 }
@@ -1374,6 +1643,181 @@ gst_collect_pads_recalculate_waiting (GstCollectPads * pads)
   return result;
 }
 
+/* The pads with a queued buffer are kept in a binary heap ordered with the
+ * compare function, so that the best pad can be found without comparing the
+ * buffers of all pads. Entries are added when a buffer is queued and become
+ * stale when that buffer is popped, they are dropped lazily when they reach
+ * the top. Pads that compare equal are ordered like in the pad list, which
+ * gives the same result as scanning the list.
+ *
+ * Only the buffer function mode pops the heap for every buffer. Without a
+ * buffer function the heap is only used on SEGMENT and GAP events, it is not
+ * maintained and is rebuilt from the pad list when needed. The heap is also
+ * rebuilt when it holds twice as many entries as there are pads, so that the
+ * stale entries don't pile up.
+ *
+ * All heap functions must be called with STREAM_LOCK. */
+static inline gboolean
+gst_collect_pads_heap_less (GstCollectPads * pads,
+    GstCollectPadsHeapEntry * a, GstCollectPadsHeapEntry * b)
+{
+  gint res;
+
+  res = pads->priv->compare_func (pads, a->data, a->timestamp, b->data,
+      b->timestamp, pads->priv->compare_user_data);
+  if (res != 0)
+    return res < 0;
+
+  return a->data->priv->index < b->data->priv->index;
+}
+
+static inline gboolean
+gst_collect_pads_heap_entry_valid (GstCollectPadsHeapEntry * entry)
+{
+  return entry->data->buffer != NULL
+      && entry->buffer_seq == entry->data->priv->buffer_seq;
+}
+
+static void
+gst_collect_pads_heap_clear (GstCollectPads * pads)
+{
+  GArray *heap = pads->priv->heap;
+  guint i;
+
+  for (i = 0; i < heap->len; i++)
+    unref_data (g_array_index (heap, GstCollectPadsHeapEntry, i).data);
+  g_array_set_size (heap, 0);
+}
+
+static void
+gst_collect_pads_heap_insert (GstCollectPads * pads, GstCollectData * data)
+{
+  GArray *heap = pads->priv->heap;
+  GstCollectPadsHeapEntry entry, *entries;
+  guint i;
+
+  entry.data = data;
+  entry.timestamp = GST_BUFFER_TIMESTAMP (data->buffer);
+  entry.buffer_seq = data->priv->buffer_seq;
+  ref_data (data);
+
+  g_array_append_val (heap, entry);
+  entries = (GstCollectPadsHeapEntry *) heap->data;
+
+  /* sift up */
+  for (i = heap->len - 1; i > 0;) {
+    guint parent = (i - 1) / 2;
+
+    if (!gst_collect_pads_heap_less (pads, &entries[i], &entries[parent]))
+      break;
+
+    entry = entries[i];
+    entries[i] = entries[parent];
+    entries[parent] = entry;
+    i = parent;
+  }
+}
+
+static void
+gst_collect_pads_heap_push (GstCollectPads * pads, GstCollectData * data)
+{
+  /* rebuilt from the pad list before the next use anyway */
+  if (pads->priv->heap_dirty)
+    return;
+
+  if (G_UNLIKELY (pads->priv->buffer_func == NULL)) {
+    gst_collect_pads_heap_clear (pads);
+    pads->priv->heap_dirty = TRUE;
+    return;
+  }
+
+  /* drop the stale entries, the rebuilt heap has one entry per queued pad */
+  if (G_UNLIKELY (pads->priv->heap->len >= 2 * MAX (pads->priv->numpads, 1))) {
+    gst_collect_pads_heap_rebuild (pads);
+    return;
+  }
+
+  gst_collect_pads_heap_insert (pads, data);
+}
+
+static void
+gst_collect_pads_heap_pop (GstCollectPads * pads)
+{
+  GArray *heap = pads->priv->heap;
+  GstCollectPadsHeapEntry entry, *entries;
+  guint i, len;
+
+  entries = (GstCollectPadsHeapEntry *) heap->data;
+  unref_data (entries[0].data);
+
+  len = heap->len - 1;
+  entries[0] = entries[len];
+  g_array_set_size (heap, len);
+
+  /* sift down */
+  for (i = 0;;) {
+    guint child = 2 * i + 1;
+
+    if (child >= len)
+      break;
+    if (child + 1 < len
+        && gst_collect_pads_heap_less (pads, &entries[child + 1],
+            &entries[child]))
+      child++;
+    if (!gst_collect_pads_heap_less (pads, &entries[child], &entries[i]))
+      break;
+
+    entry = entries[i];
+    entries[i] = entries[child];
+    entries[child] = entry;
+    i = child;
+  }
+}
+
+static void
+gst_collect_pads_heap_rebuild (GstCollectPads * pads)
+{
+  GSList *collected;
+
+  gst_collect_pads_heap_clear (pads);
+  pads->priv->heap_dirty = FALSE;
+
+  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
+    GstCollectData *data = (GstCollectData *) collected->data;
+
+    if (data->buffer != NULL)
+      gst_collect_pads_heap_insert (pads, data);
+  }
+}
+
+/* make @buffer the queued buffer of @data, with STREAM_LOCK */
+static void
+gst_collect_pads_queue_buffer (GstCollectPads * pads, GstCollectData * data,
+    GstBuffer * buffer)
+{
+  GstBuffer **buffer_p;
+
+  GST_DEBUG_OBJECT (pads, "Queuing buffer %p for pad %s:%s", buffer,
+      GST_DEBUG_PAD_NAME (data->pad));
+
+  /* One more pad has data queued */
+  if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_WAITING))
+    pads->priv->queuedpads++;
+  GST_COLLECT_PADS_STATE_UNSET (data, GST_COLLECT_PADS_STATE_GAP);
+  buffer_p = &data->buffer;
+  gst_buffer_replace (buffer_p, buffer);
+  data->priv->buffer_seq++;
+  gst_collect_pads_heap_push (pads, data);
+
+  /* update segment last position if in TIME */
+  if (G_LIKELY (data->segment.format == GST_FORMAT_TIME)) {
+    GstClockTime timestamp = GST_BUFFER_TIMESTAMP (buffer);
+
+    if (GST_CLOCK_TIME_IS_VALID (timestamp))
+      data->segment.position = timestamp;
+  }
+}
+
 /**
  * gst_collect_pads_find_best_pad:
  * @pads: the collectpads to use
@@ -1390,29 +1834,27 @@ static void
 gst_collect_pads_find_best_pad (GstCollectPads * pads,
     GstCollectData ** data, GstClockTime * time)
 {
-  GSList *collected;
   GstCollectData *best = NULL;
   GstClockTime best_time = GST_CLOCK_TIME_NONE;
+  GArray *heap = pads->priv->heap;
 
   g_return_if_fail (data != NULL);
   g_return_if_fail (time != NULL);
 
-  for (collected = pads->data; collected; collected = g_slist_next (collected)) {
-    GstBuffer *buffer;
-    GstCollectData *data = (GstCollectData *) collected->data;
-    GstClockTime timestamp;
-
-    buffer = gst_collect_pads_peek (pads, data);
-    /* if we have a buffer check if it is better then the current best one */
-    if (buffer != NULL) {
-      timestamp = GST_BUFFER_TIMESTAMP (buffer);
-      gst_buffer_unref (buffer);
-      if (best == NULL || pads->priv->compare_func (pads, data, timestamp,
-              best, best_time, pads->priv->compare_user_data) < 0) {
-        best = data;
-        best_time = timestamp;
-      }
+  if (G_UNLIKELY (pads->priv->heap_dirty))
+    gst_collect_pads_heap_rebuild (pads);
+
+  /* drop the entries of buffers that were popped since */
+  while (heap->len > 0) {
+    GstCollectPadsHeapEntry *top;
+
+    top = &g_array_index (heap, GstCollectPadsHeapEntry, 0);
+    if (gst_collect_pads_heap_entry_valid (top)) {
+      best = top->data;
+      best_time = top->timestamp;
+      break;
     }
+    gst_collect_pads_heap_pop (pads);
   }
 
   /* set earliest time */
@@ -1619,11 +2061,10 @@ gst_collect_pads_event_default (GstCollectPads * pads, GstCollectData * data,
       res = gst_pad_event_default (pad, parent, event);
       event = NULL;
 
-      /* now unblock the chain function.
-       * no cond per pad, so they all unblock,
-       * non-flushing block again */
+      /* now unblock the chain function of this pad */
       GST_COLLECT_PADS_STREAM_LOCK (pads);
       GST_COLLECT_PADS_STATE_SET (data, GST_COLLECT_PADS_STATE_FLUSHING);
+      gst_collect_pads_drop_queue (data);
       gst_collect_pads_clear (pads, data);
 
       /* cater for possible default muxing functionality */
@@ -1644,9 +2085,10 @@ gst_collect_pads_event_default (GstCollectPads * pads, GstCollectData * data,
     }
     case GST_EVENT_FLUSH_STOP:
     {
-      /* flush the 1 buffer queue */
+      /* flush the buffer queue */
       GST_COLLECT_PADS_STREAM_LOCK (pads);
       GST_COLLECT_PADS_STATE_UNSET (data, GST_COLLECT_PADS_STATE_FLUSHING);
+      gst_collect_pads_drop_queue (data);
       gst_collect_pads_clear (pads, data);
       /* we need new segment info after the flush */
       gst_segment_init (&data->segment, GST_FORMAT_UNDEFINED);
@@ -1771,6 +2213,28 @@ gst_collect_pads_event_default_internal (GstCollectPads * pads,
   return gst_collect_pads_event_default (pads, data, event, FALSE);
 }
 
+/* wait until the buffers that the pad ran ahead with were collected, so that
+ * serialized events are handled after them, with STREAM_LOCK */
+static void
+gst_collect_pads_drain (GstCollectPads * pads, GstCollectData * data)
+{
+  guint32 cookie;
+
+  if (g_atomic_int_get (&pads->priv->queue_depth) == 1)
+    return;
+
+  while (data->buffer != NULL && pads->priv->started &&
+      !GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_FLUSHING)) {
+    GST_DEBUG_OBJECT (pads, "Pad %s:%s has buffers queued, waiting",
+        GST_DEBUG_PAD_NAME (data->pad));
+
+    GST_COLLECT_PADS_EVT_INIT (pads, data, cookie);
+    GST_COLLECT_PADS_STREAM_UNLOCK (pads);
+    GST_COLLECT_PADS_EVT_WAIT (pads, data, cookie);
+    GST_COLLECT_PADS_STREAM_LOCK (pads);
+  }
+}
+
 static gboolean
 gst_collect_pads_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -1803,6 +2267,9 @@ gst_collect_pads_event (GstPad * pad, GstObject * parent, GstEvent * event)
   if (GST_EVENT_IS_SERIALIZED (event)) {
     GST_COLLECT_PADS_STREAM_LOCK (pads);
     need_unlock = TRUE;
+
+    if (GST_EVENT_TYPE (event) != GST_EVENT_FLUSH_STOP)
+      gst_collect_pads_drain (pads, data);
   }
 
   if (G_LIKELY (event_func)) {
@@ -1940,8 +2407,8 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstCollectData *data;
   GstCollectPads *pads;
   GstFlowReturn ret;
-  GstBuffer **buffer_p;
   guint32 cookie;
+  guint depth;
 
   GST_DEBUG ("Got buffer for pad %s:%s", GST_DEBUG_PAD_NAME (pad));
 
@@ -1985,23 +2452,45 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       goto error;
   }
 
-  GST_DEBUG_OBJECT (pads, "Queuing buffer %p for pad %s:%s", buffer,
-      GST_DEBUG_PAD_NAME (pad));
+  depth = g_atomic_int_get (&pads->priv->queue_depth);
+
+  /* with a queue depth larger than 1 the buffer waits behind the buffer that
+   * is still queued, as long as there is room for it */
+  while (G_UNLIKELY (depth > 1 && data->buffer != NULL)) {
+    if (data->priv->queue.length + 1 < depth) {
+      GST_DEBUG_OBJECT (pads, "Queuing buffer %p for pad %s:%s behind %u",
+          buffer, GST_DEBUG_PAD_NAME (pad), data->priv->queue.length + 1);
+      g_queue_push_tail (&data->priv->queue, buffer);
+      buffer = NULL;
+      ret = GST_FLOW_OK;
+      goto unlock_done;
+    }
 
-  /* One more pad has data queued */
-  if (GST_COLLECT_PADS_STATE_IS_SET (data, GST_COLLECT_PADS_STATE_WAITING))
-    pads->priv->queuedpads++;
-  buffer_p = &data->buffer;
-  gst_buffer_replace (buffer_p, buffer);
+    GST_COLLECT_PADS_EVT_INIT (pads, data, cookie);
 
-  /* update segment last position if in TIME */
-  if (G_LIKELY (data->segment.format == GST_FORMAT_TIME)) {
-    GstClockTime timestamp = GST_BUFFER_TIMESTAMP (buffer);
+    /* pad could be removed and re-added */
+    unref_data (data);
+    GST_OBJECT_LOCK (pad);
+    if (G_UNLIKELY ((data = gst_pad_get_element_private (pad)) == NULL))
+      goto pad_removed;
+    ref_data (data);
+    GST_OBJECT_UNLOCK (pad);
 
-    if (GST_CLOCK_TIME_IS_VALID (timestamp))
-      data->segment.position = timestamp;
+    GST_DEBUG_OBJECT (pads, "Pad %s:%s queue is full, waiting",
+        GST_DEBUG_PAD_NAME (pad));
+    GST_COLLECT_PADS_STREAM_UNLOCK (pads);
+    GST_COLLECT_PADS_EVT_WAIT (pads, data, cookie);
+    GST_COLLECT_PADS_STREAM_LOCK (pads);
+
+    if (G_UNLIKELY (!pads->priv->started))
+      goto not_started;
+    if (G_UNLIKELY (GST_COLLECT_PADS_STATE_IS_SET (data,
+                GST_COLLECT_PADS_STATE_FLUSHING)))
+      goto flushing;
   }
 
+  gst_collect_pads_queue_buffer (pads, data, buffer);
+
   /* While we have data queued on this pad try to collect stuff */
   do {
     /* Check if our collected condition is matched and call the collected
@@ -2016,13 +2505,17 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     if (data->buffer == NULL)
       break;
 
+    /* or there is room to run ahead */
+    if (data->priv->queue.length + 1 < depth)
+      break;
+
     /* Having the _INIT here means we don't care about any broadcast up to here
      * (most of which occur with STREAM_LOCK held, so could not have happened
      * anyway).  We do care about e.g. a remove initiated broadcast as of this
      * point.  Putting it here also makes this thread ignores any evt it raised
      * itself (as is a usual WAIT semantic).
      */
-    GST_COLLECT_PADS_EVT_INIT (cookie);
+    GST_COLLECT_PADS_EVT_INIT (pads, data, cookie);
 
     /* pad could be removed and re-added */
     unref_data (data);
@@ -2041,7 +2534,7 @@ gst_collect_pads_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
      * because we still hold the STREAM_LOCK.
      */
     GST_COLLECT_PADS_STREAM_UNLOCK (pads);
-    GST_COLLECT_PADS_EVT_WAIT (pads, cookie);
+    GST_COLLECT_PADS_EVT_WAIT (pads, data, cookie);
     GST_COLLECT_PADS_STREAM_LOCK (pads);
 
     GST_DEBUG_OBJECT (pads, "Pad %s:%s resuming", GST_DEBUG_PAD_NAME (pad));
@@ -2081,6 +2574,7 @@ no_data:
 not_started:
   {
     GST_DEBUG ("not started");
+    gst_collect_pads_drop_queue (data);
     gst_collect_pads_clear (pads, data);
     ret = GST_FLOW_FLUSHING;
     goto unlock_done;
@@ -2088,6 +2582,7 @@ not_started:
 flushing:
   {
     GST_DEBUG ("pad %s:%s is flushing", GST_DEBUG_PAD_NAME (pad));
+    gst_collect_pads_drop_queue (data);
     gst_collect_pads_clear (pads, data);
     ret = GST_FLOW_FLUSHING;
     goto unlock_done;
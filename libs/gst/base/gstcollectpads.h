@@ -60,6 +60,10 @@ typedef void (*GstCollectDataDestroyNotify) (GstCollectData *data);
  *                                      for when collecting.
  * @GST_COLLECT_PADS_STATE_LOCKED:      Set collectdata's pad WAITING state must
  *                                      not be changed.
+ * @GST_COLLECT_PADS_STATE_GAP:         Set if collectdata's pad had no data
+ *                                      when the latency deadline passed, see
+ *                                      gst_collect_pads_set_latency(). Since:
+ *                                      1.2
  * #GstCollectPadsStateFlags indicate private state of a collectdata('s pad).
  */
 typedef enum {
@@ -67,7 +71,8 @@ typedef enum {
   GST_COLLECT_PADS_STATE_FLUSHING = 1 << 1,
   GST_COLLECT_PADS_STATE_NEW_SEGMENT = 1 << 2,
   GST_COLLECT_PADS_STATE_WAITING = 1 << 3,
-  GST_COLLECT_PADS_STATE_LOCKED = 1 << 4
+  GST_COLLECT_PADS_STATE_LOCKED = 1 << 4,
+  GST_COLLECT_PADS_STATE_GAP = 1 << 5
 } GstCollectPadsStateFlags;
 
 /**
@@ -312,6 +317,9 @@ void            gst_collect_pads_set_clip_function    (GstCollectPads *pads,
                                                        GstCollectPadsClipFunction clipfunc,
                                                        gpointer user_data);
 
+void            gst_collect_pads_set_queue_depth      (GstCollectPads *pads, guint depth);
+void            gst_collect_pads_set_latency          (GstCollectPads *pads, GstClockTime latency);
+
 /* pad management */
 GstCollectData* gst_collect_pads_add_pad       (GstCollectPads *pads, GstPad *pad, guint size,
                                                 GstCollectDataDestroyNotify destroy_notify,
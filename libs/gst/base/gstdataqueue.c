@@ -26,6 +26,10 @@
  * #GstDataQueue is an object that handles threadsafe queueing of objects. It
  * also provides size-related functionality. This object should be used for
  * any #GstElement that wishes to provide some sort of queueing functionality.
+ *
+ * When only one thread pushes and one thread pops items, the queue can be
+ * switched to a mode where push and pop don't share a lock with
+ * gst_data_queue_set_single_producer_consumer().
  */
 
 #include <gst/gst.h>
@@ -56,6 +60,22 @@ enum
       /* FILL ME */
 };
 
+/* a node of the list that is used in single producer/consumer mode */
+typedef struct _GstDataQueueNode GstDataQueueNode;
+struct _GstDataQueueNode
+{
+  GstDataQueueNode *next;
+  GstDataQueueItem *item;       /* NULL when dropped */
+};
+
+/* a 64 bits counter that is written by one thread only and can be read
+ * consistently from other threads, also on 32 bits platforms */
+typedef struct
+{
+  volatile gint seq;
+  guint64 value;
+} GstDataQueueCounter;
+
 struct _GstDataQueuePrivate
 {
   /* the array of data we're keeping our grubby hands on */
@@ -74,6 +94,19 @@ struct _GstDataQueuePrivate
                                  * of external flushing */
   GstDataQueueFullCallback fullcallback;
   GstDataQueueEmptyCallback emptycallback;
+
+  /* single producer/consumer mode. The producer appends nodes at the tail
+   * and the consumer removes them from the head, behind a dummy node. The
+   * qlock is only taken to wait and to wake up a waiting thread. */
+  gboolean spsc;
+  GstDataQueueNode *head;       /* with pop_lock */
+  GstDataQueueNode *tail;       /* producer only */
+  GMutex pop_lock;              /* serializes pop, flush and drop_head */
+  volatile gint length;         /* ATOMIC */
+  volatile gint visible;        /* ATOMIC */
+  volatile gint bytes;          /* ATOMIC */
+  GstDataQueueCounter time_in;  /* written by the producer */
+  GstDataQueueCounter time_out; /* written by the consumer */
 };
 
 #define GST_DATA_QUEUE_MUTEX_LOCK(q) G_STMT_START {                     \
@@ -110,6 +143,28 @@ struct _GstDataQueuePrivate
                q->priv->cur_level.time,                                 \
                gst_queue_array_get_length (q->priv->queue))
 
+static inline void
+gst_data_queue_counter_add (GstDataQueueCounter * counter, guint64 value)
+{
+  g_atomic_int_inc (&counter->seq);
+  counter->value += value;
+  g_atomic_int_inc (&counter->seq);
+}
+
+static inline guint64
+gst_data_queue_counter_get (GstDataQueueCounter * counter)
+{
+  guint64 value;
+  gint seq;
+
+  do {
+    while ((seq = g_atomic_int_get (&counter->seq)) & 1);
+    value = counter->value;
+  } while (seq != g_atomic_int_get (&counter->seq));
+
+  return value;
+}
+
 static void gst_data_queue_finalize (GObject * object);
 
 static void gst_data_queue_set_property (GObject * object,
@@ -205,6 +260,10 @@ gst_data_queue_init (GstDataQueue * queue)
   g_cond_init (&queue->priv->item_del);
   queue->priv->queue = gst_queue_array_new (50);
 
+  g_mutex_init (&queue->priv->pop_lock);
+  queue->priv->spsc = FALSE;
+  queue->priv->head = queue->priv->tail = g_slice_new0 (GstDataQueueNode);
+
   GST_DEBUG ("initialized queue's not_empty & not_full conditions");
 }
 
@@ -242,11 +301,51 @@ gst_data_queue_new (GstDataQueueCheckFullFunction checkfull,
   return ret;
 }
 
+/* removes the first item in single producer/consumer mode, with pop_lock */
+static GstDataQueueItem *
+gst_data_queue_spsc_take (GstDataQueue * queue)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  GstDataQueueNode *next;
+  GstDataQueueItem *item = NULL;
+
+  /* skip the nodes of dropped items */
+  while (item == NULL) {
+    next = g_atomic_pointer_get (&priv->head->next);
+    if (next == NULL)
+      return NULL;
+
+    /* the next node becomes the dummy node */
+    g_slice_free (GstDataQueueNode, priv->head);
+    priv->head = next;
+    item = next->item;
+    next->item = NULL;
+  }
+
+  if (item->visible)
+    g_atomic_int_add (&priv->visible, -1);
+  g_atomic_int_add (&priv->bytes, -(gint) item->size);
+  gst_data_queue_counter_add (&priv->time_out, item->duration);
+  g_atomic_int_add (&priv->length, -1);
+
+  return item;
+}
+
 static void
 gst_data_queue_cleanup (GstDataQueue * queue)
 {
   GstDataQueuePrivate *priv = queue->priv;
 
+  if (priv->spsc) {
+    GstDataQueueItem *item;
+
+    g_mutex_lock (&priv->pop_lock);
+    while ((item = gst_data_queue_spsc_take (queue)))
+      item->destroy (item);
+    g_mutex_unlock (&priv->pop_lock);
+    return;
+  }
+
   while (!gst_queue_array_is_empty (priv->queue)) {
     GstDataQueueItem *item = gst_queue_array_pop_head (priv->queue);
 
@@ -269,6 +368,8 @@ gst_data_queue_finalize (GObject * object)
 
   gst_data_queue_cleanup (queue);
   gst_queue_array_free (priv->queue);
+  g_slice_free (GstDataQueueNode, priv->head);
+  g_mutex_clear (&priv->pop_lock);
 
   GST_DEBUG ("free mutex");
   g_mutex_clear (&priv->qlock);
@@ -293,11 +394,33 @@ gst_data_queue_locked_flush (GstDataQueue * queue)
     g_cond_signal (&priv->item_del);
 }
 
+static void
+gst_data_queue_locked_get_level (GstDataQueue * queue,
+    GstDataQueueSize * level)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+
+  if (priv->spsc) {
+    guint64 time_out;
+
+    /* read the consumer side first so that the level can't go negative */
+    time_out = gst_data_queue_counter_get (&priv->time_out);
+    level->visible = g_atomic_int_get (&priv->visible);
+    level->bytes = g_atomic_int_get (&priv->bytes);
+    level->time = gst_data_queue_counter_get (&priv->time_in) - time_out;
+  } else {
+    *level = priv->cur_level;
+  }
+}
+
 static inline gboolean
 gst_data_queue_locked_is_empty (GstDataQueue * queue)
 {
   GstDataQueuePrivate *priv = queue->priv;
 
+  if (priv->spsc)
+    return g_atomic_int_get (&priv->length) == 0;
+
   return (gst_queue_array_get_length (priv->queue) == 0);
 }
 
@@ -305,6 +428,13 @@ static inline gboolean
 gst_data_queue_locked_is_full (GstDataQueue * queue)
 {
   GstDataQueuePrivate *priv = queue->priv;
+  GstDataQueueSize level;
+
+  if (priv->spsc) {
+    gst_data_queue_locked_get_level (queue, &level);
+    return priv->checkfull (queue, level.visible, level.bytes, level.time,
+        priv->checkdata);
+  }
 
   return priv->checkfull (queue, priv->cur_level.visible,
       priv->cur_level.bytes, priv->cur_level.time, priv->checkdata);
@@ -399,7 +529,7 @@ gst_data_queue_set_flushing (GstDataQueue * queue, gboolean flushing)
   GST_DEBUG ("queue:%p , flushing:%d", queue, flushing);
 
   GST_DATA_QUEUE_MUTEX_LOCK (queue);
-  priv->flushing = flushing;
+  g_atomic_int_set (&priv->flushing, flushing);
   if (flushing) {
     /* release push/pop functions */
     if (priv->waiting_add)
@@ -410,6 +540,162 @@ gst_data_queue_set_flushing (GstDataQueue * queue, gboolean flushing)
   GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
 }
 
+/**
+ * gst_data_queue_set_single_producer_consumer:
+ * @queue: an empty #GstDataQueue.
+ * @spsc: %TRUE when only one thread pushes and one thread pops items
+ *
+ * Switches @queue to a mode where gst_data_queue_push() and
+ * gst_data_queue_pop() don't take a common lock unless they have to wait
+ * for each other. The levels are kept with atomic counters, so the
+ * #GstDataQueueCheckFullFunction is then called without any lock held.
+ *
+ * In this mode gst_data_queue_push() must only be called from one thread at
+ * a time. gst_data_queue_pop(), gst_data_queue_flush() and
+ * gst_data_queue_drop_head() are serialized among each other. All other
+ * functions can be called from any thread.
+ *
+ * Since: 1.2
+ */
+void
+gst_data_queue_set_single_producer_consumer (GstDataQueue * queue,
+    gboolean spsc)
+{
+  g_return_if_fail (GST_IS_DATA_QUEUE (queue));
+
+  GST_DATA_QUEUE_MUTEX_LOCK (queue);
+  if (gst_data_queue_locked_is_empty (queue))
+    queue->priv->spsc = spsc;
+  else
+    g_critical ("the mode of a non-empty GstDataQueue can't be changed");
+  GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+}
+
+static gboolean
+gst_data_queue_spsc_push (GstDataQueue * queue, GstDataQueueItem * item)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  GstDataQueueNode *node;
+
+  if (g_atomic_int_get (&priv->flushing))
+    goto flushing;
+
+  if (gst_data_queue_locked_is_full (queue)) {
+    if (G_LIKELY (priv->fullcallback))
+      priv->fullcallback (queue, priv->checkdata);
+    else
+      g_signal_emit (queue, gst_data_queue_signals[SIGNAL_FULL], 0);
+
+    /* signal might have removed some items */
+    GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing_unlock);
+    g_atomic_int_set (&priv->waiting_del, TRUE);
+    while (gst_data_queue_locked_is_full (queue)) {
+      g_cond_wait (&priv->item_del, &priv->qlock);
+      if (priv->flushing) {
+        g_atomic_int_set (&priv->waiting_del, FALSE);
+        goto flushing_unlock;
+      }
+    }
+    g_atomic_int_set (&priv->waiting_del, FALSE);
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  /* account for the item before the consumer can see it */
+  if (item->visible)
+    g_atomic_int_inc (&priv->visible);
+  g_atomic_int_add (&priv->bytes, item->size);
+  gst_data_queue_counter_add (&priv->time_in, item->duration);
+  g_atomic_int_inc (&priv->length);
+
+  node = g_slice_new (GstDataQueueNode);
+  node->next = NULL;
+  node->item = item;
+  g_atomic_pointer_set (&priv->tail->next, node);
+  priv->tail = node;
+
+  GST_CAT_LOG (data_queue_dataflow, "queue:%p pushed item %p", queue, item);
+
+  if (g_atomic_int_get (&priv->waiting_add)) {
+    GST_DATA_QUEUE_MUTEX_LOCK (queue);
+    g_cond_signal (&priv->item_add);
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+flushing_unlock:
+  {
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  }
+flushing:
+  {
+    GST_DEBUG ("queue:%p, we are flushing", queue);
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_data_queue_spsc_pop (GstDataQueue * queue, GstDataQueueItem ** item)
+{
+  GstDataQueuePrivate *priv = queue->priv;
+  gboolean notified = FALSE;
+
+  if (g_atomic_int_get (&priv->flushing))
+    goto flushing;
+
+  g_mutex_lock (&priv->pop_lock);
+  while (!(*item = gst_data_queue_spsc_take (queue))) {
+    g_mutex_unlock (&priv->pop_lock);
+
+    if (!notified) {
+      if (G_LIKELY (priv->emptycallback))
+        priv->emptycallback (queue, priv->checkdata);
+      else
+        g_signal_emit (queue, gst_data_queue_signals[SIGNAL_EMPTY], 0);
+      notified = TRUE;
+    }
+
+    GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing_unlock);
+    g_atomic_int_set (&priv->waiting_add, TRUE);
+    /* the length is counted before the item is visible, the wait ends and
+     * the take is retried for as long as the producer needs to link it */
+    while (gst_data_queue_locked_is_empty (queue)) {
+      g_cond_wait (&priv->item_add, &priv->qlock);
+      if (priv->flushing) {
+        g_atomic_int_set (&priv->waiting_add, FALSE);
+        goto flushing_unlock;
+      }
+    }
+    g_atomic_int_set (&priv->waiting_add, FALSE);
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+
+    g_mutex_lock (&priv->pop_lock);
+  }
+  g_mutex_unlock (&priv->pop_lock);
+
+  GST_CAT_LOG (data_queue_dataflow, "queue:%p popped item %p", queue, *item);
+
+  if (g_atomic_int_get (&priv->waiting_del)) {
+    GST_DATA_QUEUE_MUTEX_LOCK (queue);
+    g_cond_signal (&priv->item_del);
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+flushing_unlock:
+  {
+    GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+  }
+flushing:
+  {
+    GST_DEBUG ("queue:%p, we are flushing", queue);
+    return FALSE;
+  }
+}
+
 /**
  * gst_data_queue_push:
  * @queue: a #GstDataQueue.
@@ -437,6 +723,9 @@ gst_data_queue_push (GstDataQueue * queue, GstDataQueueItem * item)
   g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
 
+  if (priv->spsc)
+    return gst_data_queue_spsc_push (queue, item);
+
   GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
 
   STATUS (queue, "before pushing");
@@ -506,6 +795,9 @@ gst_data_queue_pop (GstDataQueue * queue, GstDataQueueItem ** item)
   g_return_val_if_fail (GST_IS_DATA_QUEUE (queue), FALSE);
   g_return_val_if_fail (item != NULL, FALSE);
 
+  if (priv->spsc)
+    return gst_data_queue_spsc_pop (queue, item);
+
   GST_DATA_QUEUE_MUTEX_LOCK_CHECK (queue, flushing);
 
   STATUS (queue, "before popping");
@@ -582,6 +874,42 @@ gst_data_queue_drop_head (GstDataQueue * queue, GType type)
 
   GST_DEBUG ("queue:%p", queue);
 
+  if (priv->spsc) {
+    GstDataQueueNode *node;
+
+    /* the item is only marked as dropped, the producer might be linking a
+     * new node behind it */
+    g_mutex_lock (&priv->pop_lock);
+    for (node = g_atomic_pointer_get (&priv->head->next); node;
+        node = g_atomic_pointer_get (&node->next)) {
+      if (node->item && !is_of_type (node->item, GSIZE_TO_POINTER (type))) {
+        leak = node->item;
+        node->item = NULL;
+        break;
+      }
+    }
+    g_mutex_unlock (&priv->pop_lock);
+
+    if (leak == NULL)
+      goto spsc_done;
+
+    if (leak->visible)
+      g_atomic_int_add (&priv->visible, -1);
+    g_atomic_int_add (&priv->bytes, -(gint) leak->size);
+    gst_data_queue_counter_add (&priv->time_out, leak->duration);
+    g_atomic_int_add (&priv->length, -1);
+
+    leak->destroy (leak);
+    res = TRUE;
+
+    if (g_atomic_int_get (&priv->waiting_del)) {
+      GST_DATA_QUEUE_MUTEX_LOCK (queue);
+      g_cond_signal (&priv->item_del);
+      GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
+    }
+    goto spsc_done;
+  }
+
   GST_DATA_QUEUE_MUTEX_LOCK (queue);
   idx = gst_queue_array_find (priv->queue, is_of_type, GSIZE_TO_POINTER (type));
 
@@ -602,6 +930,7 @@ gst_data_queue_drop_head (GstDataQueue * queue, GType type)
 done:
   GST_DATA_QUEUE_MUTEX_UNLOCK (queue);
 
+spsc_done:
   GST_DEBUG ("queue:%p , res:%d", queue, res);
 
   return res;
@@ -643,9 +972,7 @@ gst_data_queue_limits_changed (GstDataQueue * queue)
 void
 gst_data_queue_get_level (GstDataQueue * queue, GstDataQueueSize * level)
 {
-  GstDataQueuePrivate *priv = queue->priv;
-
-  memcpy (level, (&priv->cur_level), sizeof (GstDataQueueSize));
+  gst_data_queue_locked_get_level (queue, level);
 }
 
 static void
@@ -664,19 +991,21 @@ gst_data_queue_get_property (GObject * object,
     guint prop_id, GValue * value, GParamSpec * pspec)
 {
   GstDataQueue *queue = GST_DATA_QUEUE (object);
-  GstDataQueuePrivate *priv = queue->priv;
+  GstDataQueueSize level;
 
   GST_DATA_QUEUE_MUTEX_LOCK (queue);
 
+  gst_data_queue_locked_get_level (queue, &level);
+
   switch (prop_id) {
     case PROP_CUR_LEVEL_BYTES:
-      g_value_set_uint (value, priv->cur_level.bytes);
+      g_value_set_uint (value, level.bytes);
       break;
     case PROP_CUR_LEVEL_VISIBLE:
-      g_value_set_uint (value, priv->cur_level.visible);
+      g_value_set_uint (value, level.visible);
       break;
     case PROP_CUR_LEVEL_TIME:
-      g_value_set_uint64 (value, priv->cur_level.time);
+      g_value_set_uint64 (value, level.time);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -156,6 +156,9 @@ void           gst_data_queue_get_level      (GstDataQueue * queue, GstDataQueue
 
 void           gst_data_queue_limits_changed (GstDataQueue * queue);
 
+void           gst_data_queue_set_single_producer_consumer (GstDataQueue * queue,
+                                                            gboolean spsc);
+
 G_END_DECLS
 
 #endif /* __GST_DATA_QUEUE_H__ */
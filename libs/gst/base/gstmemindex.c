@@ -45,7 +45,7 @@
  *    !          !
  *   format1  format2
  *    !          !
- *   GTree      GTree
+ *  GArray     GArray
  *
  *
  * The memindex creates a MemIndexId object for each writer id, a
@@ -54,18 +54,21 @@
  * The MemIndexId keeps a MemIndexFormatIndex for each format the
  * specific writer wants indexed.
  *
- * The MemIndexFormatIndex keeps all the values of the particular
- * format in a GTree, The values of the GTree point back to the entry.
+ * The MemIndexFormatIndex keeps the entries of the particular format
+ * in a GArray sorted by their value. Entries are mostly added in
+ * increasing order, in which case they are simply appended.
  *
- * Finding a value for an id/format requires locating the correct GTree,
- * then do a lookup in the Tree to get the required value.
+ * Finding a value for an id/format requires locating the correct GArray,
+ * then do a binary search in the array to get the required value. Entries
+ * that don't have the requested flags are skipped by walking the array
+ * from there.
  */
 
 typedef struct
 {
   GstFormat format;
   gint offset;
-  GTree *tree;
+  GArray *entries;
 }
 GstMemIndexFormatIndex;
 
@@ -136,8 +139,8 @@ gst_mem_index_free_format (gpointer key, gpointer value, gpointer user_data)
 {
   GstMemIndexFormatIndex *index = (GstMemIndexFormatIndex *) value;
 
-  if (index->tree) {
-    g_tree_destroy (index->tree);
+  if (index->entries) {
+    g_array_free (index->entries, TRUE);
   }
 
   g_slice_free (GstMemIndexFormatIndex, index);
@@ -197,19 +200,26 @@ gst_mem_index_add_id (GstIndex * index, GstIndexEntry * entry)
   }
 }
 
-static gint
-mem_index_compare (gconstpointer a, gconstpointer b, gpointer user_data)
-{
-  GstMemIndexFormatIndex *index = user_data;
-  gint64 val1, val2;
-  gint64 diff;
+#define MEM_INDEX_ENTRY(index,i) \
+  g_array_index ((index)->entries, GstIndexEntry *, (i))
+#define MEM_INDEX_VALUE(index,i) \
+  GST_INDEX_ASSOC_VALUE (MEM_INDEX_ENTRY (index, i), (index)->offset)
 
-  val1 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) a), index->offset);
-  val2 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) b), index->offset);
+/* returns the position of the first entry with a value >= @value */
+static guint
+mem_index_lower_bound (GstMemIndexFormatIndex * index, gint64 value)
+{
+  guint lo = 0, hi = index->entries->len;
 
-  diff = (val2 - val1);
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
 
-  return (diff == 0 ? 0 : (diff > 0 ? 1 : -1));
+    if (MEM_INDEX_VALUE (index, mid) < value)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
 }
 
 static void
@@ -218,6 +228,8 @@ gst_mem_index_index_format (GstMemIndexId * id_index, GstIndexEntry * entry,
 {
   GstMemIndexFormatIndex *index;
   GstFormat *format;
+  gint64 value;
+  guint len, pos;
 
   format = &GST_INDEX_ASSOC_FORMAT (entry, assoc);
 
@@ -228,12 +240,25 @@ gst_mem_index_index_format (GstMemIndexId * id_index, GstIndexEntry * entry,
 
     index->format = *format;
     index->offset = assoc;
-    index->tree = g_tree_new_with_data (mem_index_compare, index);
+    index->entries = g_array_new (FALSE, FALSE, sizeof (GstIndexEntry *));
 
     g_hash_table_insert (id_index->format_index, &index->format, index);
   }
 
-  g_tree_insert (index->tree, entry, entry);
+  value = GST_INDEX_ASSOC_VALUE (entry, assoc);
+  len = index->entries->len;
+
+  /* common case, entries are added in increasing order */
+  if (len == 0 || MEM_INDEX_VALUE (index, len - 1) < value) {
+    g_array_append_val (index->entries, entry);
+    return;
+  }
+
+  pos = mem_index_lower_bound (index, value);
+  if (pos < len && MEM_INDEX_VALUE (index, pos) == value)
+    MEM_INDEX_ENTRY (index, pos) = entry;
+  else
+    g_array_insert_val (index->entries, pos, entry);
 }
 
 static void
@@ -287,54 +312,6 @@ gst_mem_index_add_entry (GstIndex * index, GstIndexEntry * entry)
   }
 }
 
-typedef struct
-{
-  gint64 value;
-  GstMemIndexFormatIndex *index;
-  gboolean exact;
-  GstIndexEntry *lower;
-  gint64 low_diff;
-  GstIndexEntry *higher;
-  gint64 high_diff;
-}
-GstMemIndexSearchData;
-
-static gint
-mem_index_search (gconstpointer a, gconstpointer b)
-{
-  GstMemIndexSearchData *data = (GstMemIndexSearchData *) b;
-  GstMemIndexFormatIndex *index = data->index;
-  gint64 val1, val2;
-  gint64 diff;
-
-  val1 = GST_INDEX_ASSOC_VALUE (((GstIndexEntry *) a), index->offset);
-  val2 = data->value;
-
-  diff = (val1 - val2);
-  if (diff == 0)
-    return 0;
-
-  /* exact matching, don't update low/high */
-  if (data->exact)
-    return (diff > 0 ? 1 : -1);
-
-  if (diff < 0) {
-    if (diff > data->low_diff) {
-      data->low_diff = diff;
-      data->lower = (GstIndexEntry *) a;
-    }
-    diff = -1;
-  } else {
-    if (diff < data->high_diff) {
-      data->high_diff = diff;
-      data->higher = (GstIndexEntry *) a;
-    }
-    diff = 1;
-  }
-
-  return diff;
-}
-
 static GstIndexEntry *
 gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
     GstIndexLookupMethod method,
@@ -345,7 +322,7 @@ gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
   GstMemIndexId *id_index;
   GstMemIndexFormatIndex *format_index;
   GstIndexEntry *entry;
-  GstMemIndexSearchData data;
+  guint len, pos;
 
   id_index = g_hash_table_lookup (memindex->id_index, &id);
   if (!id_index)
@@ -355,54 +332,62 @@ gst_mem_index_get_assoc_entry (GstIndex * index, gint id,
   if (!format_index)
     return NULL;
 
-  data.value = value;
-  data.index = format_index;
-  data.exact = (method == GST_INDEX_LOOKUP_EXACT);
-
-  /* setup data for low/high checks if we are not looking
-   * for an exact match */
-  if (!data.exact) {
-    data.low_diff = G_MININT64;
-    data.lower = NULL;
-    data.high_diff = G_MAXINT64;
-    data.higher = NULL;
-  }
-
-  entry = g_tree_search (format_index->tree, mem_index_search, &data);
-
-  /* get the low/high values if we're not exact */
-  if (entry == NULL && !data.exact) {
-    if (method == GST_INDEX_LOOKUP_BEFORE)
-      entry = data.lower;
-    else if (method == GST_INDEX_LOOKUP_AFTER) {
-      entry = data.higher;
-    }
+  len = format_index->entries->len;
+  pos = mem_index_lower_bound (format_index, value);
+
+  switch (method) {
+    case GST_INDEX_LOOKUP_EXACT:
+      if (pos == len || MEM_INDEX_VALUE (format_index, pos) != value)
+        return NULL;
+      entry = MEM_INDEX_ENTRY (format_index, pos);
+      if ((GST_INDEX_ASSOC_FLAGS (entry) & flags) != flags)
+        return NULL;
+      return entry;
+    case GST_INDEX_LOOKUP_BEFORE:
+      /* last entry <= value with the flags */
+      if (pos == len || MEM_INDEX_VALUE (format_index, pos) != value) {
+        if (pos == 0)
+          return NULL;
+        pos--;
+      }
+      while (TRUE) {
+        entry = MEM_INDEX_ENTRY (format_index, pos);
+        if ((GST_INDEX_ASSOC_FLAGS (entry) & flags) == flags)
+          return entry;
+        if (pos == 0)
+          return NULL;
+        pos--;
+      }
+    case GST_INDEX_LOOKUP_AFTER:
+      /* first entry >= value with the flags */
+      for (; pos < len; pos++) {
+        entry = MEM_INDEX_ENTRY (format_index, pos);
+        if ((GST_INDEX_ASSOC_FLAGS (entry) & flags) == flags)
+          return entry;
+      }
+      return NULL;
+    default:
+      return NULL;
   }
+}
 
-  if (entry && ((GST_INDEX_ASSOC_FLAGS (entry) & flags) != flags)) {
-    if (method != GST_INDEX_LOOKUP_EXACT) {
-      GList *l_entry = g_list_find (memindex->associations, entry);
-
-      entry = NULL;
-
-      while (l_entry) {
-        entry = (GstIndexEntry *) l_entry->data;
+/* returns the entries of writer @id sorted by their value in @format, or
+ * %NULL when there are none */
+static GArray *
+gst_mem_index_get_entries (GstMemIndex * memindex, gint id, GstFormat format)
+{
+  GstMemIndexId *id_index;
+  GstMemIndexFormatIndex *format_index;
 
-        if (entry->id == id && (GST_INDEX_ASSOC_FLAGS (entry) & flags) == flags)
-          break;
+  id_index = g_hash_table_lookup (memindex->id_index, &id);
+  if (!id_index)
+    return NULL;
 
-        if (method == GST_INDEX_LOOKUP_BEFORE)
-          l_entry = g_list_next (l_entry);
-        else if (method == GST_INDEX_LOOKUP_AFTER) {
-          l_entry = g_list_previous (l_entry);
-        }
-      }
-    } else {
-      entry = NULL;
-    }
-  }
+  format_index = g_hash_table_lookup (id_index->format_index, &format);
+  if (!format_index)
+    return NULL;
 
-  return entry;
+  return format_index->entries;
 }
 
 #if 0
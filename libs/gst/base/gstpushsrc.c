@@ -42,6 +42,12 @@
  * The subclass should extend the methods from the baseclass in
  * addition to the ::create method.
  *
+ * Sources that produce bursts of buffers, like packets read from a socket
+ * in one system call, can implement the ::create_list method instead. In
+ * push mode, the list it returns is pushed downstream in one go, with one
+ * sync against the clock on its first buffer. In pull mode, or when no
+ * ::create_list method is given, ::create is used.
+ *
  * Seeking, flushing, scheduling and sync is all handled by this
  * base class.
  *
@@ -125,16 +131,36 @@ gst_push_src_create (GstBaseSrc * bsrc, guint64 offset, guint length,
   GstFlowReturn fret;
   GstPushSrc *src;
   GstPushSrcClass *pclass;
+  GstBufferList *list = NULL;
 
   src = GST_PUSH_SRC (bsrc);
   pclass = GST_PUSH_SRC_GET_CLASS (src);
-  if (pclass->create)
+  if (pclass->create_list && *ret == NULL
+      && GST_PAD_MODE (GST_BASE_SRC_PAD (bsrc)) == GST_PAD_MODE_PUSH) {
+    fret = pclass->create_list (src, &list);
+    if (fret == GST_FLOW_OK) {
+      if (G_UNLIKELY (list == NULL || gst_buffer_list_length (list) == 0))
+        goto empty_list;
+      /* the base class pushes the list for us */
+      gst_base_src_submit_buffer_list (bsrc, list);
+    }
+  } else if (pclass->create)
     fret = pclass->create (src, ret);
   else
     fret =
         GST_BASE_SRC_CLASS (parent_class)->create (bsrc, offset, length, ret);
 
   return fret;
+
+  /* ERRORS */
+empty_list:
+  {
+    GST_ELEMENT_ERROR (src, STREAM, FAILED, (NULL),
+        ("create_list returned no buffers"));
+    if (list)
+      gst_buffer_list_unref (list);
+    return GST_FLOW_ERROR;
+  }
 }
 
 static GstFlowReturn
@@ -26,6 +26,13 @@
  * #GstQueueArray is an object that provides standard queue functionality
  * based on an array instead of linked lists. This reduces the overhead
  * caused by memory managment by a large factor.
+ *
+ * A queue created with gst_queue_array_new_for_struct() stores structures of
+ * a fixed size in the array itself instead of pointers, so that the elements
+ * don't need to be allocated separately.
+ *
+ * The array grows when needed and shrinks back to its initial size when an
+ * element is pushed to the empty queue after it had grown a lot.
  */
 
 
@@ -36,13 +43,95 @@
 struct _GstQueueArray
 {
   /* < private > */
-  gpointer *array;
+  guint8 *array;
   guint size;
   guint head;
   guint tail;
   guint length;
+  gsize elt_size;
+  gboolean struct_array;
+  guint initial_size;
 };
 
+/* shrink the array when it is empty and this many times its initial size */
+#define SHRINK_FACTOR 8
+
+#define ELEMENT(a,i)  ((a)->array + (gsize) (i) * (a)->elt_size)
+#define POINTER(a,i)  (((gpointer *) (a)->array)[i])
+
+static GstQueueArray *
+gst_queue_array_new_internal (gsize elt_size, guint initial_size)
+{
+  GstQueueArray *array;
+
+  array = g_slice_new (GstQueueArray);
+  array->elt_size = elt_size;
+  array->size = initial_size;
+  array->initial_size = initial_size;
+  array->array = g_malloc0 (elt_size * initial_size);
+  array->head = 0;
+  array->tail = 0;
+  array->length = 0;
+  array->struct_array = FALSE;
+  return array;
+}
+
+/* reallocate the array to @newsize elements, the elements end up at the
+ * start of the array */
+static void
+gst_queue_array_resize (GstQueueArray * array, guint newsize)
+{
+  gsize elt_size = array->elt_size;
+
+  g_assert (newsize >= array->length);
+
+  if (array->head + array->length <= array->size && array->head == 0) {
+    /* Fast path, the elements are at the start already */
+    array->array = g_realloc (array->array, elt_size * newsize);
+  } else {
+    guint8 *array2 = g_malloc (elt_size * newsize);
+    guint t1 = MIN (array->length, array->size - array->head);
+
+    /* [0-----TAIL][HEAD------SIZE]
+     *
+     * We want to end up with
+     * [HEAD------------------TAIL][----FREEDATA------NEWSIZE]
+     *
+     * 1) move [HEAD-----SIZE] part to beginning of new array
+     * 2) move [0-------TAIL] part new array, after previous part
+     */
+    memcpy (array2, ELEMENT (array, array->head), t1 * elt_size);
+    memcpy (array2 + t1 * elt_size, array->array,
+        (array->length - t1) * elt_size);
+
+    g_free (array->array);
+    array->array = array2;
+    array->head = 0;
+  }
+  array->size = newsize;
+  array->tail = array->length < newsize ? array->length : 0;
+}
+
+/* make room for @n more elements */
+static inline void
+gst_queue_array_reserve (GstQueueArray * array, guint n)
+{
+  if (G_UNLIKELY (array->length == 0 && array->size > array->initial_size
+          && array->size / SHRINK_FACTOR >= MAX (array->initial_size, 1)
+          && n <= array->initial_size)) {
+    /* the queue was idle after it had grown a lot */
+    array->head = array->tail = 0;
+    gst_queue_array_resize (array, array->initial_size);
+  }
+
+  if (G_UNLIKELY (array->length + n > array->size)) {
+    /* newsize is 50% bigger */
+    guint newsize = MAX ((3 * array->size) / 2, array->length + n);
+
+    gst_queue_array_resize (array, newsize);
+  }
+}
+
 /**
  * gst_queue_array_new:
  * @initial_size: Initial size of the new queue
@@ -56,15 +145,33 @@ struct _GstQueueArray
  */
 GstQueueArray *
 gst_queue_array_new (guint initial_size)
+{
+  return gst_queue_array_new_internal (sizeof (gpointer), initial_size);
+}
+
+/**
+ * gst_queue_array_new_for_struct:
+ * @struct_size: Size of each element (e.g. structure) in the array
+ * @initial_size: Initial size of the new queue
+ *
+ * Allocates a new #GstQueueArray object for elements (e.g. structures)
+ * of size @struct_size, with an initial queue size of @initial_size. The
+ * elements are copied into the array. Use the *_struct() functions and
+ * gst_queue_array_push_tail_n() / gst_queue_array_pop_head_n() with it.
+ *
+ * Returns: a new #GstQueueArray object
+ *
+ * Since: 1.2
+ */
+GstQueueArray *
+gst_queue_array_new_for_struct (gsize struct_size, guint initial_size)
 {
   GstQueueArray *array;
 
-  array = g_slice_new (GstQueueArray);
-  array->size = initial_size;
-  array->array = g_new0 (gpointer, initial_size);
-  array->head = 0;
-  array->tail = 0;
-  array->length = 0;
+  g_return_val_if_fail (struct_size > 0, NULL);
+
+  array = gst_queue_array_new_internal (struct_size, initial_size);
+  array->struct_array = TRUE;
   return array;
 }
 
@@ -103,13 +210,78 @@ gst_queue_array_pop_head (GstQueueArray * array)
   /* empty array */
   if (G_UNLIKELY (array->length == 0))
     return NULL;
-  ret = array->array[array->head];
+  ret = POINTER (array, array->head);
+  array->head++;
+  if (array->head == array->size)
+    array->head = 0;
+  array->length--;
+  return ret;
+}
+
+/**
+ * gst_queue_array_pop_head_struct:
+ * @array: a #GstQueueArray object created with
+ *     gst_queue_array_new_for_struct()
+ *
+ * Removes the head of the queue @array and returns a pointer to it. The
+ * pointer points into the array and is valid until the next element is
+ * pushed.
+ *
+ * Returns: pointer to the head of the queue, or %NULL if it is empty
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_pop_head_struct (GstQueueArray * array)
+{
+  gpointer ret;
+
+  /* empty array */
+  if (G_UNLIKELY (array->length == 0))
+    return NULL;
+  ret = ELEMENT (array, array->head);
   array->head++;
-  array->head %= array->size;
+  if (array->head == array->size)
+    array->head = 0;
   array->length--;
   return ret;
 }
 
+/**
+ * gst_queue_array_pop_head_n:
+ * @array: a #GstQueueArray object
+ * @data: (out): memory for @n elements
+ * @n: the maximum number of elements to pop
+ *
+ * Removes up to @n elements from the head of the queue @array and copies
+ * them to @data, the head first. For arrays created with
+ * gst_queue_array_new() @data is an array of pointers, otherwise an array
+ * of the structures.
+ *
+ * Returns: the number of elements copied to @data
+ *
+ * Since: 1.2
+ */
+guint
+gst_queue_array_pop_head_n (GstQueueArray * array, gpointer data, guint n)
+{
+  gsize elt_size = array->elt_size;
+  guint t1;
+
+  n = MIN (n, array->length);
+  if (n == 0)
+    return 0;
+
+  /* up to the end of the array, then from the start */
+  t1 = MIN (n, array->size - array->head);
+  memcpy (data, ELEMENT (array, array->head), t1 * elt_size);
+  memcpy ((guint8 *) data + t1 * elt_size, array->array, (n - t1) * elt_size);
+
+  array->head = (array->head + n) % array->size;
+  array->length -= n;
+  return n;
+}
+
 /**
  * gst_queue_array_pop_head:
  * @array: a #GstQueueArray object
@@ -127,7 +299,115 @@ gst_queue_array_peek_head (GstQueueArray * array)
   /* empty array */
   if (G_UNLIKELY (array->length == 0))
     return NULL;
-  return array->array[array->head];
+  return POINTER (array, array->head);
+}
+
+/**
+ * gst_queue_array_pop_tail:
+ * @array: a #GstQueueArray object
+ *
+ * Returns the tail of the queue @array and removes it from the queue. This
+ * makes it possible to use @array as a stack.
+ *
+ * Returns: The tail of the queue
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_pop_tail (GstQueueArray * array)
+{
+  /* empty array */
+  if (G_UNLIKELY (array->length == 0))
+    return NULL;
+  if (array->tail == 0)
+    array->tail = array->size;
+  array->tail--;
+  array->length--;
+  return POINTER (array, array->tail);
+}
+
+/**
+ * gst_queue_array_peek_tail:
+ * @array: a #GstQueueArray object
+ *
+ * Returns the tail of the queue @array and does not remove it from the queue.
+ *
+ * Returns: The tail of the queue
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_peek_tail (GstQueueArray * array)
+{
+  /* empty array */
+  if (G_UNLIKELY (array->length == 0))
+    return NULL;
+  return POINTER (array, array->tail == 0 ? array->size - 1 : array->tail - 1);
+}
+
+/**
+ * gst_queue_array_peek_head_struct:
+ * @array: a #GstQueueArray object created with
+ *     gst_queue_array_new_for_struct()
+ *
+ * Returns a pointer to the head of the queue @array without removing it.
+ * The pointer is valid until the queue is modified.
+ *
+ * Returns: pointer to the head of the queue, or %NULL if it is empty
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_peek_head_struct (GstQueueArray * array)
+{
+  /* empty array */
+  if (G_UNLIKELY (array->length == 0))
+    return NULL;
+  return ELEMENT (array, array->head);
+}
+
+/**
+ * gst_queue_array_peek_nth:
+ * @array: a #GstQueueArray object
+ * @idx: the position counted from the head of the queue
+ *
+ * Returns the element at position @idx of the queue @array without
+ * removing it, 0 being the head of the queue.
+ *
+ * Returns: The element at position @idx, or %NULL if @idx is not smaller
+ *     than the length of the queue
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_peek_nth (GstQueueArray * array, guint idx)
+{
+  if (G_UNLIKELY (idx >= array->length))
+    return NULL;
+  return POINTER (array, (array->head + idx) % array->size);
+}
+
+/**
+ * gst_queue_array_peek_nth_struct:
+ * @array: a #GstQueueArray object created with
+ *     gst_queue_array_new_for_struct()
+ * @idx: the position counted from the head of the queue
+ *
+ * Returns a pointer to the element at position @idx of the queue @array
+ * without removing it, 0 being the head of the queue. The pointer is valid
+ * until the queue is modified.
+ *
+ * Returns: pointer to the element at position @idx, or %NULL if @idx is not
+ *     smaller than the length of the queue
+ *
+ * Since: 1.2
+ */
+gpointer
+gst_queue_array_peek_nth_struct (GstQueueArray * array, guint idx)
+{
+  if (G_UNLIKELY (idx >= array->length))
+    return NULL;
+  return ELEMENT (array, (array->head + idx) % array->size);
 }
 
 /**
@@ -143,45 +423,73 @@ void
 gst_queue_array_push_tail (GstQueueArray * array, gpointer data)
 {
   /* Check if we need to make room */
-  if (G_UNLIKELY (array->length == array->size)) {
-    /* newsize is 50% bigger */
-    guint newsize = (3 * array->size) / 2;
-
-    /* copy over data */
-    if (array->tail != 0) {
-      gpointer *array2 = g_new0 (gpointer, newsize);
-      guint t1 = array->head;
-      guint t2 = array->size - array->head;
-
-      /* [0-----TAIL][HEAD------SIZE]
-       *
-       * We want to end up with
-       * [HEAD------------------TAIL][----FREEDATA------NEWSIZE]
-       *
-       * 1) move [HEAD-----SIZE] part to beginning of new array
-       * 2) move [0-------TAIL] part new array, after previous part
-       */
-
-      memcpy (array2, &array->array[array->head], t2 * sizeof (gpointer));
-      memcpy (&array2[t2], array->array, t1 * sizeof (gpointer));
-
-      g_free (array->array);
-      array->array = array2;
-      array->head = 0;
-    } else {
-      /* Fast path, we just need to grow the array */
-      array->array = g_renew (gpointer, array->array, newsize);
-    }
-    array->tail = array->size;
-    array->size = newsize;
-  }
+  gst_queue_array_reserve (array, 1);
 
-  array->array[array->tail] = data;
+  POINTER (array, array->tail) = data;
   array->tail++;
-  array->tail %= array->size;
+  if (array->tail == array->size)
+    array->tail = 0;
   array->length++;
 }
 
+/**
+ * gst_queue_array_push_tail_struct:
+ * @array: a #GstQueueArray object created with
+ *     gst_queue_array_new_for_struct()
+ * @p_struct: address of the element to copy
+ *
+ * Copies the element at @p_struct to the tail of the queue @array.
+ *
+ * Since: 1.2
+ */
+void
+gst_queue_array_push_tail_struct (GstQueueArray * array, gpointer p_struct)
+{
+  /* Check if we need to make room */
+  gst_queue_array_reserve (array, 1);
+
+  memcpy (ELEMENT (array, array->tail), p_struct, array->elt_size);
+  array->tail++;
+  if (array->tail == array->size)
+    array->tail = 0;
+  array->length++;
+}
+
+/**
+ * gst_queue_array_push_tail_n:
+ * @array: a #GstQueueArray object
+ * @data: @n elements
+ * @n: the number of elements in @data
+ *
+ * Pushes the @n elements in @data to the tail of the queue @array, making
+ * room for all of them at once. For arrays created with
+ * gst_queue_array_new() @data is an array of pointers, otherwise an array
+ * of the structures.
+ *
+ * Since: 1.2
+ */
+void
+gst_queue_array_push_tail_n (GstQueueArray * array, gconstpointer data,
+    guint n)
+{
+  gsize elt_size = array->elt_size;
+  guint t1;
+
+  if (n == 0)
+    return;
+
+  gst_queue_array_reserve (array, n);
+
+  /* up to the end of the array, then from the start */
+  t1 = MIN (n, array->size - array->tail);
+  memcpy (ELEMENT (array, array->tail), data, t1 * elt_size);
+  memcpy (array->array, (const guint8 *) data + t1 * elt_size,
+      (n - t1) * elt_size);
+
+  array->tail = (array->tail + n) % array->size;
+  array->length += n;
+}
+
 /**
  * gst_queue_array_is_empty:
  * @array: a #GstQueueArray object
@@ -198,32 +506,23 @@ gst_queue_array_is_empty (GstQueueArray * array)
   return (array->length == 0);
 }
 
-/**
- * gst_queue_array_drop_element:
- * @array: a #GstQueueArray object
- * @idx: index to drop
- *
- * Drops the queue element at position @idx from queue @array.
- *
- * Returns: the dropped element
- *
- * Since: 1.2.0
- */
-gpointer
-gst_queue_array_drop_element (GstQueueArray * array, guint idx)
+static gboolean
+gst_queue_array_drop_internal (GstQueueArray * array, guint idx,
+    gpointer p_element)
 {
   int first_item_index, last_item_index;
-  gpointer element;
+  gsize elt_size = array->elt_size;
 
-  g_return_val_if_fail (array->length > 0, NULL);
-  g_return_val_if_fail (idx < array->size, NULL);
+  g_return_val_if_fail (array->length > 0, FALSE);
+  g_return_val_if_fail (idx < array->size, FALSE);
 
   first_item_index = array->head;
 
   /* tail points to the first free spot */
   last_item_index = (array->tail - 1 + array->size) % array->size;
 
-  element = array->array[idx];
+  if (p_element != NULL)
+    memcpy (p_element, ELEMENT (array, idx), elt_size);
 
   /* simple case idx == first item */
   if (idx == first_item_index) {
@@ -231,7 +530,7 @@ gst_queue_array_drop_element (GstQueueArray * array, guint idx)
     array->head++;
     array->head %= array->size;
     array->length--;
-    return element;
+    return TRUE;
   }
 
   /* simple case idx == last item */
@@ -239,19 +538,19 @@ gst_queue_array_drop_element (GstQueueArray * array, guint idx)
     /* move tail minus one, potentially wrapping */
     array->tail = (array->tail - 1 + array->size) % array->size;
     array->length--;
-    return element;
+    return TRUE;
   }
 
   /* non-wrapped case */
   if (first_item_index < last_item_index) {
     g_assert (first_item_index < idx && idx < last_item_index);
     /* move everything beyond idx one step towards zero in array */
-    memmove (&array->array[idx],
-        &array->array[idx + 1], (last_item_index - idx) * sizeof (gpointer));
+    memmove (ELEMENT (array, idx),
+        ELEMENT (array, idx + 1), (last_item_index - idx) * elt_size);
     /* tail might wrap, ie if tail == 0 (and last_item_index == size) */
     array->tail = (array->tail - 1 + array->size) % array->size;
     array->length--;
-    return element;
+    return TRUE;
   }
 
   /* only wrapped cases left */
@@ -259,29 +558,72 @@ gst_queue_array_drop_element (GstQueueArray * array, guint idx)
 
   if (idx < last_item_index) {
     /* idx is before last_item_index, move data towards zero */
-    memmove (&array->array[idx],
-        &array->array[idx + 1], (last_item_index - idx) * sizeof (gpointer));
+    memmove (ELEMENT (array, idx),
+        ELEMENT (array, idx + 1), (last_item_index - idx) * elt_size);
     /* tail should not wrap in this case! */
     g_assert (array->tail > 0);
     array->tail--;
     array->length--;
-    return element;
+    return TRUE;
   }
 
   if (idx > first_item_index) {
-    element = array->array[idx];
     /* idx is after first_item_index, move data to higher indices */
-    memmove (&array->array[first_item_index + 1],
-        &array->array[first_item_index],
-        (idx - first_item_index) * sizeof (gpointer));
+    memmove (ELEMENT (array, first_item_index + 1),
+        ELEMENT (array, first_item_index),
+        (idx - first_item_index) * elt_size);
     array->head++;
     /* head should not wrap in this case! */
     g_assert (array->head < array->size);
     array->length--;
-    return element;
+    return TRUE;
   }
 
-  g_return_val_if_reached (NULL);
+  g_return_val_if_reached (FALSE);
+}
+
+/**
+ * gst_queue_array_drop_element:
+ * @array: a #GstQueueArray object
+ * @idx: index to drop
+ *
+ * Drops the queue element at position @idx from queue @array.
+ *
+ * Returns: the dropped element
+ *
+ * Since: 1.2.0
+ */
+gpointer
+gst_queue_array_drop_element (GstQueueArray * array, guint idx)
+{
+  gpointer element;
+
+  if (!gst_queue_array_drop_internal (array, idx, &element))
+    return NULL;
+
+  return element;
+}
+
+/**
+ * gst_queue_array_drop_struct:
+ * @array: a #GstQueueArray object created with
+ *     gst_queue_array_new_for_struct()
+ * @idx: index to drop
+ * @p_struct: (allow-none): address into which to store the data of the
+ *     dropped element, or %NULL
+ *
+ * Drops the queue element at position @idx from queue @array and copies the
+ * data of the element to @p_struct.
+ *
+ * Returns: %TRUE on success, or %FALSE on error
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_queue_array_drop_struct (GstQueueArray * array, guint idx,
+    gpointer p_struct)
+{
+  return gst_queue_array_drop_internal (array, idx, p_struct);
 }
 
 /**
@@ -292,7 +634,9 @@ gst_queue_array_drop_element (GstQueueArray * array, guint idx)
  *
  * Finds an element in the queue @array, either by comparing every element
  * with @func or by looking up @data if no compare function @func is provided,
- * and returning the index of the found element.
+ * and returning the index of the found element. For arrays created with
+ * gst_queue_array_new_for_struct() @func gets the address of the elements
+ * and must not be %NULL.
  *
  * Note that the index is not 0-based, but an internal index number with a
  * random offset. The index can be used in connection with
@@ -308,15 +652,23 @@ gst_queue_array_find (GstQueueArray * array, GCompareFunc func, gpointer data)
 {
   guint i;
 
-  if (func != NULL) {
+  if (func != NULL && array->struct_array) {
+    /* the compare function gets the address of the elements */
+    for (i = 0; i < array->length; i++) {
+      if (func (ELEMENT (array, (i + array->head) % array->size), data) == 0)
+        return (i + array->head) % array->size;
+    }
+  } else if (func != NULL) {
     /* Scan from head to tail */
     for (i = 0; i < array->length; i++) {
-      if (func (array->array[(i + array->head) % array->size], data) == 0)
+      if (func (POINTER (array, (i + array->head) % array->size), data) == 0)
         return (i + array->head) % array->size;
     }
   } else {
+    g_return_val_if_fail (!array->struct_array, -1);
+
     for (i = 0; i < array->length; i++) {
-      if (array->array[(i + array->head) % array->size] == data)
+      if (POINTER (array, (i + array->head) % array->size) == data)
         return (i + array->head) % array->size;
     }
   }
@@ -27,19 +27,43 @@
 typedef struct _GstQueueArray GstQueueArray;
 
 GstQueueArray * gst_queue_array_new       (guint initial_size);
+GstQueueArray * gst_queue_array_new_for_struct (gsize struct_size,
+                                                guint initial_size);
 
 void            gst_queue_array_free      (GstQueueArray * array);
 
 gpointer        gst_queue_array_pop_head  (GstQueueArray * array);
 gpointer        gst_queue_array_peek_head (GstQueueArray * array);
+gpointer        gst_queue_array_peek_nth  (GstQueueArray * array,
+                                           guint           idx);
+
+gpointer        gst_queue_array_pop_tail  (GstQueueArray * array);
+gpointer        gst_queue_array_peek_tail (GstQueueArray * array);
+
+gpointer        gst_queue_array_pop_head_struct  (GstQueueArray * array);
+gpointer        gst_queue_array_peek_head_struct (GstQueueArray * array);
+gpointer        gst_queue_array_peek_nth_struct  (GstQueueArray * array,
+                                                  guint           idx);
 
 void            gst_queue_array_push_tail (GstQueueArray * array,
                                            gpointer        data);
+void            gst_queue_array_push_tail_struct (GstQueueArray * array,
+                                                  gpointer        p_struct);
+
+void            gst_queue_array_push_tail_n (GstQueueArray * array,
+                                             gconstpointer   data,
+                                             guint           n);
+guint           gst_queue_array_pop_head_n  (GstQueueArray * array,
+                                             gpointer        data,
+                                             guint           n);
 
 gboolean        gst_queue_array_is_empty  (GstQueueArray * array);
 
 gpointer        gst_queue_array_drop_element (GstQueueArray * array,
                                               guint           idx);
+gboolean        gst_queue_array_drop_struct  (GstQueueArray * array,
+                                              guint           idx,
+                                              gpointer        p_struct);
 
 guint           gst_queue_array_find (GstQueueArray * array,
                                       GCompareFunc    func,
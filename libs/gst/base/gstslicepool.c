@@ -0,0 +1,410 @@
+/* GStreamer
+ *
+ * gstslicepool.c: run a function on slices of data in parallel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstslicepool
+ * @short_description: Process slices of data with several threads
+ *
+ * #GstSlicePool keeps a number of worker threads around to process data
+ * that can be split into independent slices, like the lines of a video
+ * frame or the bytes of a buffer.
+ *
+ * gst_slice_pool_run() splits a range of units into one slice per thread,
+ * runs the callback for every slice at the same time and returns when all
+ * slices are done. The calling thread processes the first slice itself.
+ * gst_slice_pool_run_buffer() does the same on the mapped memory of a
+ * #GstBuffer.
+ *
+ * The threads are created once in gst_slice_pool_new() and are reused for
+ * every run, so a pool is typically created when an element starts and
+ * freed when it stops.
+ *
+ * A #GstSlicePool can be used from one thread at a time, runs from
+ * different threads are serialized.
+ *
+ * Since: 1.2
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_SCHED_SETAFFINITY
+#include <sched.h>
+#endif
+
+#include "gstslicepool.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_slice_pool_debug);
+#define GST_CAT_DEFAULT gst_slice_pool_debug
+
+typedef struct
+{
+  GstSlicePool *pool;
+  guint idx;
+  GThread *thread;
+} GstSliceWorker;
+
+struct _GstSlicePool
+{
+  guint n_threads;
+  gboolean pin_threads;
+  GstSliceWorker *workers;
+
+  /* serializes runs */
+  GMutex run_lock;
+
+  GMutex lock;
+  GCond work_cond;
+  GCond done_cond;
+  guint generation;
+  guint pending;
+  gboolean quit;
+
+  /* the current run, with lock */
+  GstSliceFunc func;
+  gpointer user_data;
+  guint total;
+  guint chunk;
+};
+
+static void
+gst_slice_pool_do_slice (GstSlicePool * pool, guint idx)
+{
+  guint start, end;
+
+  start = idx * pool->chunk;
+  if (start >= pool->total)
+    return;
+  end = MIN (start + pool->chunk, pool->total);
+
+  pool->func (start, end, pool->user_data);
+}
+
+static void
+gst_slice_pool_pin (GstSliceWorker * worker)
+{
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET)
+  cpu_set_t set;
+  guint n_cpus = worker->pool->n_threads;
+
+#if GLIB_CHECK_VERSION(2,36,0)
+  n_cpus = g_get_num_processors ();
+#endif
+
+  CPU_ZERO (&set);
+  CPU_SET (worker->idx % n_cpus, &set);
+  if (sched_setaffinity (0, sizeof (set), &set) != 0)
+    GST_DEBUG ("could not pin worker %u", worker->idx);
+#endif
+}
+
+static gpointer
+gst_slice_pool_worker_func (GstSliceWorker * worker)
+{
+  GstSlicePool *pool = worker->pool;
+  guint generation = 0;
+
+  if (pool->pin_threads)
+    gst_slice_pool_pin (worker);
+
+  g_mutex_lock (&pool->lock);
+  while (TRUE) {
+    while (!pool->quit && pool->generation == generation)
+      g_cond_wait (&pool->work_cond, &pool->lock);
+    if (pool->quit)
+      break;
+    generation = pool->generation;
+
+    g_mutex_unlock (&pool->lock);
+    gst_slice_pool_do_slice (pool, worker->idx);
+    g_mutex_lock (&pool->lock);
+
+    if (--pool->pending == 0)
+      g_cond_signal (&pool->done_cond);
+  }
+  g_mutex_unlock (&pool->lock);
+
+  return NULL;
+}
+
+/**
+ * gst_slice_pool_new:
+ * @n_threads: the number of threads to split the work over, including the
+ *     thread calling gst_slice_pool_run(), or 0 to use one per processor
+ * @pin_threads: hint to bind every worker thread to its own processor
+ *
+ * Create a new #GstSlicePool and start its worker threads. Binding the
+ * threads to processors is only done on platforms that support it.
+ *
+ * Returns: (transfer full): a new #GstSlicePool, free with
+ *     gst_slice_pool_free().
+ *
+ * Since: 1.2
+ */
+GstSlicePool *
+gst_slice_pool_new (guint n_threads, gboolean pin_threads)
+{
+  GstSlicePool *pool;
+  guint i;
+
+  GST_DEBUG_CATEGORY_INIT (gst_slice_pool_debug, "slicepool", 0,
+      "slice pool");
+
+  if (n_threads == 0) {
+#if GLIB_CHECK_VERSION(2,36,0)
+    n_threads = g_get_num_processors ();
+#else
+    n_threads = 1;
+#endif
+  }
+
+  pool = g_slice_new0 (GstSlicePool);
+  pool->n_threads = n_threads;
+  pool->pin_threads = pin_threads;
+  g_mutex_init (&pool->run_lock);
+  g_mutex_init (&pool->lock);
+  g_cond_init (&pool->work_cond);
+  g_cond_init (&pool->done_cond);
+
+  /* worker 0 is the calling thread */
+  pool->workers = g_new0 (GstSliceWorker, n_threads);
+  for (i = 1; i < n_threads; i++) {
+    GstSliceWorker *worker = &pool->workers[i];
+    GError *error = NULL;
+
+    worker->pool = pool;
+    worker->idx = i;
+    worker->thread = g_thread_try_new ("slicepool",
+        (GThreadFunc) gst_slice_pool_worker_func, worker, &error);
+    if (worker->thread == NULL) {
+      GST_WARNING ("could not create worker %u: %s", i, error->message);
+      g_error_free (error);
+      /* continue with the threads we have */
+      pool->n_threads = i;
+      break;
+    }
+  }
+
+  GST_DEBUG ("created pool %p with %u threads", pool, pool->n_threads);
+
+  return pool;
+}
+
+/**
+ * gst_slice_pool_free:
+ * @pool: a #GstSlicePool
+ *
+ * Stop the worker threads of @pool and free it.
+ *
+ * Since: 1.2
+ */
+void
+gst_slice_pool_free (GstSlicePool * pool)
+{
+  guint i;
+
+  g_return_if_fail (pool != NULL);
+
+  g_mutex_lock (&pool->lock);
+  pool->quit = TRUE;
+  g_cond_broadcast (&pool->work_cond);
+  g_mutex_unlock (&pool->lock);
+
+  for (i = 1; i < pool->n_threads; i++)
+    g_thread_join (pool->workers[i].thread);
+  g_free (pool->workers);
+
+  g_mutex_clear (&pool->run_lock);
+  g_mutex_clear (&pool->lock);
+  g_cond_clear (&pool->work_cond);
+  g_cond_clear (&pool->done_cond);
+  g_slice_free (GstSlicePool, pool);
+}
+
+/**
+ * gst_slice_pool_get_n_threads:
+ * @pool: a #GstSlicePool
+ *
+ * Get the number of threads that process slices in @pool, including the
+ * calling thread. This can be less than requested in gst_slice_pool_new()
+ * when not all threads could be created.
+ *
+ * Returns: the number of threads.
+ *
+ * Since: 1.2
+ */
+guint
+gst_slice_pool_get_n_threads (GstSlicePool * pool)
+{
+  g_return_val_if_fail (pool != NULL, 0);
+
+  return pool->n_threads;
+}
+
+/**
+ * gst_slice_pool_run:
+ * @pool: a #GstSlicePool
+ * @total: the number of units to process
+ * @align: slices start at a multiple of @align units, or 0 or 1 for no
+ *     alignment
+ * @func: (scope call): the function that processes a slice
+ * @user_data: user data for @func
+ *
+ * Split the units from 0 up to @total into slices of about the same size,
+ * one per thread of @pool, and call @func for every slice. The slices are
+ * processed at the same time and this function returns when they are all
+ * done.
+ *
+ * To process a video frame in horizontal slices, @total is the height of
+ * the frame. @align can be used to keep slices on the lines of subsampled
+ * planes.
+ *
+ * Since: 1.2
+ */
+void
+gst_slice_pool_run (GstSlicePool * pool, guint total, guint align,
+    GstSliceFunc func, gpointer user_data)
+{
+  guint chunk, n_slices;
+
+  g_return_if_fail (pool != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (total == 0)
+    return;
+
+  if (align < 1)
+    align = 1;
+
+  /* round the slices up to @align units */
+  chunk = (total + pool->n_threads - 1) / pool->n_threads;
+  chunk = ((chunk + align - 1) / align) * align;
+  n_slices = (total + chunk - 1) / chunk;
+
+  if (n_slices <= 1) {
+    func (0, total, user_data);
+    return;
+  }
+
+  g_mutex_lock (&pool->run_lock);
+
+  g_mutex_lock (&pool->lock);
+  pool->func = func;
+  pool->user_data = user_data;
+  pool->total = total;
+  pool->chunk = chunk;
+  /* all workers take part, the ones without a slice only report back */
+  pool->pending = pool->n_threads - 1;
+  pool->generation++;
+  g_cond_broadcast (&pool->work_cond);
+  g_mutex_unlock (&pool->lock);
+
+  gst_slice_pool_do_slice (pool, 0);
+
+  /* join barrier */
+  g_mutex_lock (&pool->lock);
+  while (pool->pending > 0)
+    g_cond_wait (&pool->done_cond, &pool->lock);
+  g_mutex_unlock (&pool->lock);
+
+  g_mutex_unlock (&pool->run_lock);
+}
+
+typedef struct
+{
+  GstMapInfo map;
+  gsize unit_size;
+  GstSliceMapFunc func;
+  gpointer user_data;
+} GstSliceMapData;
+
+static void
+gst_slice_pool_map_func (guint start, guint end, gpointer user_data)
+{
+  GstSliceMapData *data = user_data;
+  gsize offset, size;
+
+  offset = start * data->unit_size;
+  size = MIN (end * data->unit_size, data->map.size) - offset;
+
+  data->func (data->map.data + offset, size, offset, data->user_data);
+}
+
+/**
+ * gst_slice_pool_run_buffer:
+ * @pool: a #GstSlicePool
+ * @buffer: a #GstBuffer
+ * @flags: the flags to map @buffer with
+ * @unit_size: the size in bytes of the units that are not split, like the
+ *     stride of a line, or 0 or 1 to split anywhere
+ * @func: (scope call): the function that processes a slice
+ * @user_data: user data for @func
+ *
+ * Map @buffer with @flags and call @func on slices of the mapped memory
+ * like gst_slice_pool_run(). Slices are made of whole units of @unit_size
+ * bytes, except for the last slice when the size of @buffer is not a
+ * multiple of @unit_size.
+ *
+ * Returns: %TRUE when @buffer could be mapped and @func was called.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_slice_pool_run_buffer (GstSlicePool * pool, GstBuffer * buffer,
+    GstMapFlags flags, gsize unit_size, GstSliceMapFunc func,
+    gpointer user_data)
+{
+  GstSliceMapData data;
+  gsize n_units;
+
+  g_return_val_if_fail (pool != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  if (!gst_buffer_map (buffer, &data.map, flags))
+    return FALSE;
+
+  if (unit_size < 1)
+    unit_size = 1;
+
+  data.unit_size = unit_size;
+  data.func = func;
+  data.user_data = user_data;
+
+  n_units = (data.map.size + unit_size - 1) / unit_size;
+  if (n_units > G_MAXUINT)
+    goto too_big;
+
+  gst_slice_pool_run (pool, n_units, 1, gst_slice_pool_map_func, &data);
+
+  gst_buffer_unmap (buffer, &data.map);
+
+  return TRUE;
+
+  /* ERRORS */
+too_big:
+  {
+    GST_WARNING ("buffer of %" G_GSIZE_FORMAT " bytes has too many units",
+        data.map.size);
+    gst_buffer_unmap (buffer, &data.map);
+    return FALSE;
+  }
+}
@@ -0,0 +1,76 @@
+/* GStreamer
+ *
+ * gstslicepool.h: run a function on slices of data in parallel
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SLICE_POOL_H__
+#define __GST_SLICE_POOL_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstSlicePool GstSlicePool;
+
+/**
+ * GstSliceFunc:
+ * @start: the first unit of the slice
+ * @end: the unit after the last unit of the slice
+ * @user_data: user data passed to gst_slice_pool_run()
+ *
+ * Function that processes the units from @start up to @end.
+ *
+ * Since: 1.2
+ */
+typedef void (*GstSliceFunc) (guint start, guint end, gpointer user_data);
+
+/**
+ * GstSliceMapFunc:
+ * @data: the start of the slice in the mapped memory
+ * @size: the size of the slice in bytes
+ * @offset: the offset of @data in the buffer
+ * @user_data: user data passed to gst_slice_pool_run_buffer()
+ *
+ * Function that processes a slice of a mapped buffer.
+ *
+ * Since: 1.2
+ */
+typedef void (*GstSliceMapFunc) (guint8 *data, gsize size, gsize offset,
+                                 gpointer user_data);
+
+GstSlicePool *  gst_slice_pool_new             (guint n_threads,
+                                                gboolean pin_threads);
+void            gst_slice_pool_free            (GstSlicePool *pool);
+
+guint           gst_slice_pool_get_n_threads   (GstSlicePool *pool);
+
+void            gst_slice_pool_run             (GstSlicePool *pool,
+                                                guint total, guint align,
+                                                GstSliceFunc func,
+                                                gpointer user_data);
+
+gboolean        gst_slice_pool_run_buffer      (GstSlicePool *pool,
+                                                GstBuffer *buffer,
+                                                GstMapFlags flags,
+                                                gsize unit_size,
+                                                GstSliceMapFunc func,
+                                                gpointer user_data);
+
+G_END_DECLS
+
+#endif /* __GST_SLICE_POOL_H__ */
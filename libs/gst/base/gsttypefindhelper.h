@@ -34,6 +34,11 @@ GstCaps * gst_type_find_helper_for_data   (GstObject              *obj,
                                            const guint8           *data,
                                            gsize                   size,
                                            GstTypeFindProbability *prob);
+GstCaps * gst_type_find_helper_for_data_parallel (GstObject              *obj,
+                                                  const guint8           *data,
+                                                  gsize                   size,
+                                                  guint                   n_threads,
+                                                  GstTypeFindProbability *prob);
 GstCaps * gst_type_find_helper_for_buffer (GstObject              *obj,
                                            GstBuffer              *buf,
                                            GstTypeFindProbability *prob);
@@ -41,6 +46,8 @@ GstCaps * gst_type_find_helper_for_buffer (GstObject              *obj,
 GstCaps * gst_type_find_helper_for_extension (GstObject * obj,
                                               const gchar * extension);
 
+void      gst_type_find_helper_set_cache_size (guint max_entries);
+
 /**
  * GstTypeFindHelperGetRangeFunction:
  * @obj: a #GstObject that will handle the getrange request
@@ -72,6 +79,14 @@ GstCaps * gst_type_find_helper_get_range (GstObject                         *obj
                                           const gchar                       *extension,
                                           GstTypeFindProbability            *prob);
 
+GstCaps * gst_type_find_helper_get_range_full (GstObject                         *obj,
+                                               GstObject                         *parent,
+                                               GstTypeFindHelperGetRangeFunction  func,
+                                               guint64                            size,
+                                               const gchar                       *extension,
+                                               guint64                            max_bytes,
+                                               GstTypeFindProbability            *prob);
+
 G_END_DECLS
 
 #endif /* __GST_TYPEFINDHELPER_H__ */
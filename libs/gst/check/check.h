@@ -25,6 +25,8 @@
 #include <gst/check/gstbufferstraw.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
+#include <gst/check/gstperfchecker.h>
 #include <gst/check/gsttestclock.h>
+#include <gst/check/gsttestclockbench.h>
 
 #endif /* __GST_CHECK__H__ */
@@ -0,0 +1,444 @@
+/* GStreamer
+ *
+ * gstperfchecker.c: per buffer processing time checks for unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gstcheckperfchecker
+ * @short_description: Processing time regression checks for unit tests
+ * @see_also: #GstTestClock, #GstStreamConsistency
+ *
+ * A #GstPerfChecker records how long an element needs to process each
+ * buffer and compares the median with a baseline that was stored by an
+ * earlier run.
+ *
+ * The element is given a #GstTestClock. gst_perf_checker_push_buffer()
+ * advances that clock to the end of the buffer before pushing it, so that a
+ * sink that synchronises to the clock does not wait and only the processing
+ * is measured. For elements in a running pipeline, for example one that is
+ * read with a #GstBufferStraw, gst_perf_checker_add_pads() measures the time
+ * between a buffer entering the sink pad and leaving the source pad.
+ *
+ * The baselines are kept in the key file named by the
+ * <envar>GST_CHECK_PERF_BASELINES</envar> environment variable, in a group
+ * with the name of the checker. When <envar>GST_CHECK_PERF_RECORD</envar> is
+ * set, gst_perf_checker_check() stores the current median as the new baseline
+ * instead of comparing. Without a baseline every check passes.
+ *
+ * <example>
+ * <title>Checking the processing time of a transform element</title>
+ *   <programlisting language="c">
+ *   checker = gst_perf_checker_new ("myfilter-passthrough", element);
+ *   for (i = 0; i < 1000; i++)
+ *     fail_unless_equals_int (gst_perf_checker_push_buffer (checker, srcpad,
+ *             create_buffer (i)), GST_FLOW_OK);
+ *   fail_unless_perf_within_baseline (checker, 20.0);
+ *   gst_perf_checker_free (checker);
+ *   </programlisting>
+ * </example>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstperfchecker.h"
+
+#define BASELINE_KEY "median"
+
+struct _GstPerfChecker
+{
+  gchar *name;
+  GstElement *element;
+  GstClock *clock;
+
+  GMutex lock;
+  /* GstClockTime, the processing time per buffer */
+  GArray *samples;
+
+  /* for the pads added with gst_perf_checker_add_pads() */
+  GstPad *sinkpad, *srcpad;
+  gulong sink_probe, src_probe;
+  GstClockTime in_time;
+};
+
+/**
+ * gst_perf_checker_new:
+ * @name: the name of the baseline
+ * @element: (allow-none): the element to measure
+ *
+ * Creates a new performance checker. When @element is not %NULL, it is given
+ * a new #GstTestClock. This must be called before @element goes to PLAYING.
+ *
+ * Returns: (transfer full): a new #GstPerfChecker, free with
+ * gst_perf_checker_free().
+ *
+ * Since: 1.2
+ */
+GstPerfChecker *
+gst_perf_checker_new (const gchar * name, GstElement * element)
+{
+  GstPerfChecker *checker;
+
+  g_return_val_if_fail (name != NULL, NULL);
+  g_return_val_if_fail (element == NULL || GST_IS_ELEMENT (element), NULL);
+
+  checker = g_slice_new0 (GstPerfChecker);
+  checker->name = g_strdup (name);
+  checker->clock = gst_test_clock_new ();
+  checker->samples = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  checker->in_time = GST_CLOCK_TIME_NONE;
+  g_mutex_init (&checker->lock);
+
+  if (element) {
+    checker->element = gst_object_ref (element);
+    if (GST_IS_PIPELINE (element))
+      gst_pipeline_use_clock (GST_PIPELINE (element), checker->clock);
+    else
+      gst_element_set_clock (element, checker->clock);
+  }
+
+  return checker;
+}
+
+/**
+ * gst_perf_checker_get_clock:
+ * @checker: a #GstPerfChecker
+ *
+ * Returns: (transfer none): the #GstTestClock of @checker.
+ *
+ * Since: 1.2
+ */
+GstTestClock *
+gst_perf_checker_get_clock (GstPerfChecker * checker)
+{
+  g_return_val_if_fail (checker != NULL, NULL);
+
+  return GST_TEST_CLOCK (checker->clock);
+}
+
+/* moves the test clock to the end of @buffer so that a sink does not have to
+ * wait for it */
+static void
+advance_clock (GstPerfChecker * checker, GstPad * pad, GstBuffer * buffer)
+{
+  GstClockTime ts, running_time, now;
+  const GstSegment *segment;
+  GstEvent *event;
+
+  ts = GST_BUFFER_PTS (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_DTS (buffer);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    return;
+  if (GST_BUFFER_DURATION_IS_VALID (buffer))
+    ts += GST_BUFFER_DURATION (buffer);
+
+  if (!(event = gst_pad_get_sticky_event (pad, GST_EVENT_SEGMENT, 0)))
+    return;
+  gst_event_parse_segment (event, &segment);
+  running_time = segment->format == GST_FORMAT_TIME ?
+      gst_segment_to_running_time (segment, GST_FORMAT_TIME, ts) :
+      GST_CLOCK_TIME_NONE;
+  gst_event_unref (event);
+
+  if (!GST_CLOCK_TIME_IS_VALID (running_time))
+    return;
+
+  now = running_time + gst_element_get_base_time (checker->element);
+  if (now > gst_clock_get_time (checker->clock))
+    gst_test_clock_set_time (GST_TEST_CLOCK (checker->clock), now);
+}
+
+/**
+ * gst_perf_checker_push_buffer:
+ * @checker: a #GstPerfChecker
+ * @pad: the source pad that is linked to the element of @checker
+ * @buffer: (transfer full): the buffer to push
+ *
+ * Advances the clock of @checker to the end of @buffer, pushes @buffer on
+ * @pad and records how long the push took. The element of @checker must
+ * process the buffer in the pushing thread.
+ *
+ * Returns: the result of gst_pad_push().
+ *
+ * Since: 1.2
+ */
+GstFlowReturn
+gst_perf_checker_push_buffer (GstPerfChecker * checker, GstPad * pad,
+    GstBuffer * buffer)
+{
+  GstClockTime start;
+  GstFlowReturn ret;
+
+  g_return_val_if_fail (checker != NULL, GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_IS_PAD (pad), GST_FLOW_ERROR);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
+
+  if (checker->element)
+    advance_clock (checker, pad, buffer);
+
+  start = gst_util_get_timestamp ();
+  ret = gst_pad_push (pad, buffer);
+  gst_perf_checker_add_sample (checker, gst_util_get_timestamp () - start);
+
+  return ret;
+}
+
+static GstPadProbeReturn
+sink_buffer_cb (GstPad * pad, GstPadProbeInfo * info, GstPerfChecker * checker)
+{
+  checker->in_time = gst_util_get_timestamp ();
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+src_buffer_cb (GstPad * pad, GstPadProbeInfo * info, GstPerfChecker * checker)
+{
+  if (GST_CLOCK_TIME_IS_VALID (checker->in_time)) {
+    gst_perf_checker_add_sample (checker,
+        gst_util_get_timestamp () - checker->in_time);
+    checker->in_time = GST_CLOCK_TIME_NONE;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/**
+ * gst_perf_checker_add_pads:
+ * @checker: a #GstPerfChecker
+ * @sinkpad: the sink pad of an element
+ * @srcpad: the source pad of the same element
+ *
+ * Records the time between a buffer arriving on @sinkpad and a buffer
+ * leaving on @srcpad as a sample of @checker. This is meant for elements
+ * that push one buffer for every buffer they get in the same thread, like
+ * most #GstBaseTransform based elements.
+ *
+ * Only one pair of pads can be added.
+ *
+ * Returns: %TRUE if the pads were added.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_perf_checker_add_pads (GstPerfChecker * checker, GstPad * sinkpad,
+    GstPad * srcpad)
+{
+  g_return_val_if_fail (checker != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_PAD (sinkpad), FALSE);
+  g_return_val_if_fail (GST_IS_PAD (srcpad), FALSE);
+  g_return_val_if_fail (checker->sinkpad == NULL, FALSE);
+
+  checker->sinkpad = gst_object_ref (sinkpad);
+  checker->srcpad = gst_object_ref (srcpad);
+  checker->sink_probe = gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) sink_buffer_cb, checker, NULL);
+  checker->src_probe = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) src_buffer_cb, checker, NULL);
+
+  return TRUE;
+}
+
+/**
+ * gst_perf_checker_add_sample:
+ * @checker: a #GstPerfChecker
+ * @time: the processing time of one buffer
+ *
+ * Adds a processing time that was measured by the test itself.
+ *
+ * Since: 1.2
+ */
+void
+gst_perf_checker_add_sample (GstPerfChecker * checker, GstClockTime time)
+{
+  g_return_if_fail (checker != NULL);
+  g_return_if_fail (GST_CLOCK_TIME_IS_VALID (time));
+
+  g_mutex_lock (&checker->lock);
+  g_array_append_val (checker->samples, time);
+  g_mutex_unlock (&checker->lock);
+}
+
+/**
+ * gst_perf_checker_get_n_samples:
+ * @checker: a #GstPerfChecker
+ *
+ * Returns: the number of processing times @checker recorded.
+ *
+ * Since: 1.2
+ */
+guint
+gst_perf_checker_get_n_samples (GstPerfChecker * checker)
+{
+  guint n;
+
+  g_return_val_if_fail (checker != NULL, 0);
+
+  g_mutex_lock (&checker->lock);
+  n = checker->samples->len;
+  g_mutex_unlock (&checker->lock);
+
+  return n;
+}
+
+static gint
+compare_times (const GstClockTime * a, const GstClockTime * b)
+{
+  return (*a > *b) - (*a < *b);
+}
+
+/**
+ * gst_perf_checker_get_median:
+ * @checker: a #GstPerfChecker
+ *
+ * Gets the median of the recorded processing times. Unlike the mean, it is
+ * not affected by the few buffers that were delayed by the scheduler.
+ *
+ * Returns: the median processing time or #GST_CLOCK_TIME_NONE when there are
+ * no samples.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_perf_checker_get_median (GstPerfChecker * checker)
+{
+  GstClockTime median = GST_CLOCK_TIME_NONE;
+
+  g_return_val_if_fail (checker != NULL, GST_CLOCK_TIME_NONE);
+
+  g_mutex_lock (&checker->lock);
+  if (checker->samples->len > 0) {
+    g_array_sort (checker->samples, (GCompareFunc) compare_times);
+    median = g_array_index (checker->samples, GstClockTime,
+        checker->samples->len / 2);
+  }
+  g_mutex_unlock (&checker->lock);
+
+  return median;
+}
+
+/**
+ * gst_perf_checker_check:
+ * @checker: a #GstPerfChecker
+ * @max_increase: how many percent the median may exceed the baseline
+ *
+ * Compares the median processing time of @checker with the baseline of the
+ * same name, see the description of #GstPerfChecker for where the baselines
+ * are stored. When recording, the median is stored as the new baseline.
+ *
+ * Returns: %FALSE if there are no samples, or the median is more than
+ *     @max_increase percent above the baseline.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_perf_checker_check (GstPerfChecker * checker, gdouble max_increase)
+{
+  const gchar *path;
+  GstClockTime median, baseline, limit;
+  GKeyFile *keyfile;
+  gchar *str;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (checker != NULL, FALSE);
+  g_return_val_if_fail (max_increase >= 0.0, FALSE);
+
+  median = gst_perf_checker_get_median (checker);
+  if (!GST_CLOCK_TIME_IS_VALID (median)) {
+    GST_WARNING ("%s: no samples", checker->name);
+    return FALSE;
+  }
+
+  GST_INFO ("%s: median %" GST_TIME_FORMAT " of %u buffers", checker->name,
+      GST_TIME_ARGS (median), gst_perf_checker_get_n_samples (checker));
+
+  path = g_getenv ("GST_CHECK_PERF_BASELINES");
+  if (path == NULL || *path == '\0') {
+    GST_INFO ("%s: no baselines file", checker->name);
+    return TRUE;
+  }
+
+  keyfile = g_key_file_new ();
+  g_key_file_load_from_file (keyfile, path, G_KEY_FILE_KEEP_COMMENTS, NULL);
+
+  if (g_getenv ("GST_CHECK_PERF_RECORD")) {
+    GError *err = NULL;
+    gchar *data;
+    gsize size;
+
+    str = g_strdup_printf ("%" G_GUINT64_FORMAT, median);
+    g_key_file_set_value (keyfile, checker->name, BASELINE_KEY, str);
+    g_free (str);
+
+    data = g_key_file_to_data (keyfile, &size, NULL);
+    if (!g_file_set_contents (path, data, size, &err)) {
+      GST_WARNING ("could not write %s: %s", path, err->message);
+      g_error_free (err);
+    } else {
+      GST_INFO ("%s: recorded baseline", checker->name);
+    }
+    g_free (data);
+  } else if ((str = g_key_file_get_value (keyfile, checker->name,
+              BASELINE_KEY, NULL))) {
+    baseline = g_ascii_strtoull (str, NULL, 10);
+    g_free (str);
+
+    limit = baseline + baseline * max_increase / 100.0;
+    ret = median <= limit;
+    GST_INFO ("%s: baseline %" GST_TIME_FORMAT ", limit %" GST_TIME_FORMAT
+        ", %s", checker->name, GST_TIME_ARGS (baseline), GST_TIME_ARGS (limit),
+        ret ? "ok" : "too slow");
+  } else {
+    GST_INFO ("%s: no baseline", checker->name);
+  }
+
+  g_key_file_free (keyfile);
+
+  return ret;
+}
+
+/**
+ * gst_perf_checker_free:
+ * @checker: a #GstPerfChecker
+ *
+ * Removes the probes of @checker and frees it. The element keeps its
+ * #GstTestClock until it is given another clock.
+ *
+ * Since: 1.2
+ */
+void
+gst_perf_checker_free (GstPerfChecker * checker)
+{
+  g_return_if_fail (checker != NULL);
+
+  if (checker->sinkpad) {
+    gst_pad_remove_probe (checker->sinkpad, checker->sink_probe);
+    gst_pad_remove_probe (checker->srcpad, checker->src_probe);
+    gst_object_unref (checker->sinkpad);
+    gst_object_unref (checker->srcpad);
+  }
+  if (checker->element)
+    gst_object_unref (checker->element);
+  gst_object_unref (checker->clock);
+  g_array_free (checker->samples, TRUE);
+  g_mutex_clear (&checker->lock);
+  g_free (checker->name);
+  g_slice_free (GstPerfChecker, checker);
+}
@@ -0,0 +1,83 @@
+/* GStreamer
+ *
+ * gstperfchecker.h: per buffer processing time checks for unit tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_PERF_CHECKER_H__
+#define __GST_PERF_CHECKER_H__
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstPerfChecker:
+ *
+ * Opaque performance checker handle.
+ *
+ * Since: 1.2
+ */
+typedef struct _GstPerfChecker GstPerfChecker;
+
+GstPerfChecker * gst_perf_checker_new            (const gchar * name,
+                                                  GstElement * element);
+
+GstTestClock *   gst_perf_checker_get_clock      (GstPerfChecker * checker);
+
+GstFlowReturn    gst_perf_checker_push_buffer    (GstPerfChecker * checker,
+                                                  GstPad * pad,
+                                                  GstBuffer * buffer);
+
+gboolean         gst_perf_checker_add_pads       (GstPerfChecker * checker,
+                                                  GstPad * sinkpad,
+                                                  GstPad * srcpad);
+
+void             gst_perf_checker_add_sample     (GstPerfChecker * checker,
+                                                  GstClockTime time);
+
+guint            gst_perf_checker_get_n_samples  (GstPerfChecker * checker);
+
+GstClockTime     gst_perf_checker_get_median     (GstPerfChecker * checker);
+
+gboolean         gst_perf_checker_check          (GstPerfChecker * checker,
+                                                  gdouble max_increase);
+
+void             gst_perf_checker_free           (GstPerfChecker * checker);
+
+/**
+ * fail_unless_perf_within_baseline:
+ * @checker: a #GstPerfChecker
+ * @max_increase: how many percent the median may exceed the baseline
+ *
+ * Fails the test when the median processing time of @checker is more than
+ * @max_increase percent above the stored baseline, see
+ * gst_perf_checker_check().
+ *
+ * Since: 1.2
+ */
+#define fail_unless_perf_within_baseline(checker, max_increase)          \
+  fail_unless (gst_perf_checker_check (checker, max_increase),           \
+      "median processing time %" GST_TIME_FORMAT " is more than %.1f%% " \
+      "above the baseline",                                              \
+      GST_TIME_ARGS (gst_perf_checker_get_median (checker)),             \
+      (gdouble) (max_increase))
+
+G_END_DECLS
+
+#endif /* __GST_PERF_CHECKER_H__ */
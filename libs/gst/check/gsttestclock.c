@@ -791,6 +791,55 @@ gst_test_clock_wait_for_next_pending_id (GstTestClock * test_clock,
   GST_OBJECT_UNLOCK (test_clock);
 }
 
+/**
+ * gst_test_clock_timed_wait_for_next_pending_id:
+ * @test_clock: #GstTestClock for which to get the pending clock notification
+ * @pending_id: (allow-none) (out) (transfer full): #GstClockID
+ * with information about the pending clock notification
+ * @timeout: the maximum time to wait, in real time
+ *
+ * Waits like gst_test_clock_wait_for_next_pending_id() but gives up after
+ * @timeout has passed without a clock notification being requested. If
+ * @timeout is #GST_CLOCK_TIME_NONE this waits forever.
+ *
+ * MT safe.
+ *
+ * Returns: %TRUE if a clock notification was requested and @pending_id was
+ * set, %FALSE if the wait timed out.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_test_clock_timed_wait_for_next_pending_id (GstTestClock * test_clock,
+    GstClockID * pending_id, GstClockTime timeout)
+{
+  GstTestClockPrivate *priv = GST_TEST_CLOCK_GET_PRIVATE (test_clock);
+  gint64 end_time = 0;
+  gboolean result;
+
+  g_assert (GST_IS_TEST_CLOCK (test_clock));
+
+  if (GST_CLOCK_TIME_IS_VALID (timeout))
+    end_time = g_get_monotonic_time () + timeout / GST_USECOND;
+
+  GST_OBJECT_LOCK (test_clock);
+
+  while (priv->entry_contexts == NULL) {
+    if (!GST_CLOCK_TIME_IS_VALID (timeout))
+      g_cond_wait (&priv->entry_added_cond, GST_OBJECT_GET_LOCK (test_clock));
+    else if (!g_cond_wait_until (&priv->entry_added_cond,
+            GST_OBJECT_GET_LOCK (test_clock), end_time))
+      break;
+  }
+
+  result = gst_test_clock_peek_next_pending_id_unlocked (test_clock,
+      pending_id);
+
+  GST_OBJECT_UNLOCK (test_clock);
+
+  return result;
+}
+
 /**
  * gst_test_clock_wait_for_pending_id_count:
  * @test_clock: #GstTestClock for which to await having enough pending clock
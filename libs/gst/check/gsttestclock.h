@@ -94,6 +94,10 @@ gboolean      gst_test_clock_peek_next_pending_id (GstTestClock * test_clock,
 void          gst_test_clock_wait_for_next_pending_id  (GstTestClock * test_clock,
                                                         GstClockID   * pending_id);
 
+gboolean      gst_test_clock_timed_wait_for_next_pending_id (GstTestClock * test_clock,
+                                                             GstClockID   * pending_id,
+                                                             GstClockTime   timeout);
+
 void          gst_test_clock_wait_for_pending_id_count (GstTestClock * test_clock,
                                                         guint          count);
 
@@ -0,0 +1,312 @@
+/* GStreamer
+ *
+ * gsttestclockbench.c: run elements on a GstTestClock at maximum speed
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:gsttestclockbench
+ * @short_description: Benchmark elements that synchronise to the clock
+ * @see_also: #GstTestClock
+ *
+ * A #GstTestClockBench gives an element or a pipeline a #GstTestClock and
+ * releases every clock wait as soon as it is requested, after advancing the
+ * clock to the time of the wait. Elements that synchronise to the clock, like
+ * a sink with #GstBaseSink:sync enabled or #GstCollectPads in live mode, then
+ * run as fast as the CPU allows while seeing the same sequence of clock times
+ * as in real time, which makes their processing cost measurable without
+ * waiting for the wall clock.
+ *
+ * The result is the real time that was needed per simulated second, see
+ * gst_test_clock_bench_get_time_per_second().
+ *
+ * <example>
+ * <title>Measuring a pipeline with a synchronising sink</title>
+ *   <programlisting language="c">
+ *   pipeline = gst_parse_launch ("fakesrc format=time datarate=1000 "
+ *       "sizetype=fixed sizemax=10 ! fakesink sync=true", NULL);
+ *   bench = gst_test_clock_bench_new (pipeline);
+ *   gst_element_set_state (pipeline, GST_STATE_PLAYING);
+ *   fail_unless (gst_test_clock_bench_run (bench, 10 * GST_SECOND));
+ *   GST_INFO ("%" GST_TIME_FORMAT " per second",
+ *       GST_TIME_ARGS (gst_test_clock_bench_get_time_per_second (bench)));
+ *   gst_element_set_state (pipeline, GST_STATE_NULL);
+ *   gst_test_clock_bench_free (bench);
+ *   </programlisting>
+ * </example>
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gsttestclockbench.h"
+
+/* how long to wait for a clock wait before looking at the bus */
+#define POLL_TIMEOUT (10 * GST_MSECOND)
+
+struct _GstTestClockBench
+{
+  GstElement *element;
+  GstClock *clock;
+  GstBus *bus;
+
+  gboolean eos;
+  guint n_waits;
+  GstClockTime simulated_time;
+  GstClockTime processing_time;
+};
+
+/**
+ * gst_test_clock_bench_new:
+ * @element: the element or pipeline to run
+ *
+ * Creates a benchmark that makes @element use a new #GstTestClock. This must
+ * be called before @element goes to PLAYING.
+ *
+ * Returns: (transfer full): a new #GstTestClockBench, free with
+ * gst_test_clock_bench_free().
+ *
+ * Since: 1.2
+ */
+GstTestClockBench *
+gst_test_clock_bench_new (GstElement * element)
+{
+  GstTestClockBench *bench;
+
+  g_return_val_if_fail (GST_IS_ELEMENT (element), NULL);
+
+  bench = g_slice_new0 (GstTestClockBench);
+  bench->element = gst_object_ref (element);
+  bench->clock = gst_test_clock_new ();
+  bench->bus = gst_element_get_bus (element);
+
+  if (GST_IS_PIPELINE (element))
+    gst_pipeline_use_clock (GST_PIPELINE (element), bench->clock);
+  else
+    gst_element_set_clock (element, bench->clock);
+
+  return bench;
+}
+
+/**
+ * gst_test_clock_bench_get_clock:
+ * @bench: a #GstTestClockBench
+ *
+ * Returns: (transfer none): the #GstTestClock of @bench.
+ *
+ * Since: 1.2
+ */
+GstTestClock *
+gst_test_clock_bench_get_clock (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, NULL);
+
+  return GST_TEST_CLOCK (bench->clock);
+}
+
+/**
+ * gst_test_clock_bench_run:
+ * @bench: a #GstTestClockBench
+ * @duration: how far to advance the clock, or #GST_CLOCK_TIME_NONE to run
+ *     until EOS
+ *
+ * Releases the clock waits of the element of @bench until its clock has
+ * advanced by @duration or the element posted EOS. The data must be produced
+ * by another thread than the calling one, by a source in the pipeline or by a
+ * test thread pushing buffers.
+ *
+ * The messages on the bus of the element are popped and dropped while this
+ * runs.
+ *
+ * This can be called repeatedly, the times add up.
+ *
+ * Returns: %FALSE if an error was posted on the bus.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_test_clock_bench_run (GstTestClockBench * bench, GstClockTime duration)
+{
+  GstTestClock *test_clock;
+  GstClockTime start, end, real_start, now;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail (bench != NULL, FALSE);
+
+  test_clock = GST_TEST_CLOCK (bench->clock);
+  start = gst_clock_get_time (bench->clock);
+  end = GST_CLOCK_TIME_IS_VALID (duration) ? start + duration :
+      GST_CLOCK_TIME_NONE;
+  real_start = gst_util_get_timestamp ();
+
+  while (!bench->eos) {
+    GstClockID pending_id, processed_id;
+    GstClockTime time;
+
+    if (gst_test_clock_timed_wait_for_next_pending_id (test_clock,
+            &pending_id, POLL_TIMEOUT)) {
+      time = GST_CLOCK_ENTRY_TIME (pending_id);
+      gst_clock_id_unref (pending_id);
+
+      /* leave the waits after the end for the next run */
+      if (GST_CLOCK_TIME_IS_VALID (end) && time > end)
+        break;
+
+      if (time > gst_clock_get_time (bench->clock))
+        gst_test_clock_set_time (test_clock, time);
+
+      processed_id = gst_test_clock_process_next_clock_id (test_clock);
+      if (processed_id != NULL) {
+        bench->n_waits++;
+        gst_clock_id_unref (processed_id);
+      }
+      continue;
+    }
+
+    if (bench->bus) {
+      GstMessage *msg;
+
+      while ((msg = gst_bus_pop_filtered (bench->bus,
+                  GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) {
+        if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+          ret = FALSE;
+        bench->eos = TRUE;
+        gst_message_unref (msg);
+      }
+    }
+  }
+
+  bench->processing_time += gst_util_get_timestamp () - real_start;
+
+  if (!bench->eos && GST_CLOCK_TIME_IS_VALID (end))
+    gst_test_clock_set_time (test_clock, end);
+  now = gst_clock_get_time (bench->clock);
+  bench->simulated_time += now - start;
+
+  return ret;
+}
+
+/**
+ * gst_test_clock_bench_is_eos:
+ * @bench: a #GstTestClockBench
+ *
+ * Returns: %TRUE when the element of @bench posted EOS or an error.
+ *
+ * Since: 1.2
+ */
+gboolean
+gst_test_clock_bench_is_eos (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, FALSE);
+
+  return bench->eos;
+}
+
+/**
+ * gst_test_clock_bench_get_n_waits:
+ * @bench: a #GstTestClockBench
+ *
+ * Returns: the number of clock waits @bench released.
+ *
+ * Since: 1.2
+ */
+guint
+gst_test_clock_bench_get_n_waits (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, 0);
+
+  return bench->n_waits;
+}
+
+/**
+ * gst_test_clock_bench_get_simulated_time:
+ * @bench: a #GstTestClockBench
+ *
+ * Returns: how far the clock of @bench advanced in all runs.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_test_clock_bench_get_simulated_time (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, 0);
+
+  return bench->simulated_time;
+}
+
+/**
+ * gst_test_clock_bench_get_processing_time:
+ * @bench: a #GstTestClockBench
+ *
+ * Returns: the real time all runs of @bench took.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_test_clock_bench_get_processing_time (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, 0);
+
+  return bench->processing_time;
+}
+
+/**
+ * gst_test_clock_bench_get_time_per_second:
+ * @bench: a #GstTestClockBench
+ *
+ * Gets the real time that was needed per second of clock time. A value below
+ * one second means that the element would keep up in real time with that much
+ * CPU time to spare.
+ *
+ * Returns: the processing time per simulated second or #GST_CLOCK_TIME_NONE
+ * if the clock did not advance.
+ *
+ * Since: 1.2
+ */
+GstClockTime
+gst_test_clock_bench_get_time_per_second (GstTestClockBench * bench)
+{
+  g_return_val_if_fail (bench != NULL, GST_CLOCK_TIME_NONE);
+
+  if (bench->simulated_time == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  return gst_util_uint64_scale (bench->processing_time, GST_SECOND,
+      bench->simulated_time);
+}
+
+/**
+ * gst_test_clock_bench_free:
+ * @bench: a #GstTestClockBench
+ *
+ * Frees @bench. The element keeps its #GstTestClock until it is given
+ * another clock.
+ *
+ * Since: 1.2
+ */
+void
+gst_test_clock_bench_free (GstTestClockBench * bench)
+{
+  g_return_if_fail (bench != NULL);
+
+  if (bench->bus)
+    gst_object_unref (bench->bus);
+  gst_object_unref (bench->clock);
+  gst_object_unref (bench->element);
+  g_slice_free (GstTestClockBench, bench);
+}
@@ -0,0 +1,59 @@
+/* GStreamer
+ *
+ * gsttestclockbench.h: run elements on a GstTestClock at maximum speed
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_TEST_CLOCK_BENCH_H__
+#define __GST_TEST_CLOCK_BENCH_H__
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gsttestclock.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GstTestClockBench:
+ *
+ * Opaque handle of a virtual time benchmark.
+ *
+ * Since: 1.2
+ */
+typedef struct _GstTestClockBench GstTestClockBench;
+
+GstTestClockBench * gst_test_clock_bench_new          (GstElement * element);
+
+GstTestClock *      gst_test_clock_bench_get_clock    (GstTestClockBench * bench);
+
+gboolean            gst_test_clock_bench_run          (GstTestClockBench * bench,
+                                                       GstClockTime duration);
+
+gboolean            gst_test_clock_bench_is_eos       (GstTestClockBench * bench);
+
+guint               gst_test_clock_bench_get_n_waits  (GstTestClockBench * bench);
+
+GstClockTime        gst_test_clock_bench_get_simulated_time  (GstTestClockBench * bench);
+
+GstClockTime        gst_test_clock_bench_get_processing_time (GstTestClockBench * bench);
+
+GstClockTime        gst_test_clock_bench_get_time_per_second (GstTestClockBench * bench);
+
+void                gst_test_clock_bench_free         (GstTestClockBench * bench);
+
+G_END_DECLS
+
+#endif /* __GST_TEST_CLOCK_BENCH_H__ */
@@ -31,6 +31,7 @@
 #include <gst/gst.h>
 
 #include "gstdirectcontrolbinding.h"
+#include "gsttimedvaluecontrolsource.h"
 
 #include <gst/math-compat.h>
 
@@ -74,6 +75,19 @@ enum
 
 static GParamSpec *properties[PROP_LAST];
 
+struct _GstDirectControlBindingPrivate
+{
+  /* the last value set on the property, as written by convert_value */
+  guint64 last_mapped;
+  gboolean have_mapped;
+
+  /* state of the last sync, to skip syncing the same timestamp again when
+   * the control source did not change */
+  gboolean synced;
+  gboolean synced_ret;
+  gint synced_cookie;
+};
+
 /* mapping functions */
 
 #define DEFINE_CONVERT(type,Type,TYPE,ROUNDING_OP) \
@@ -160,6 +174,8 @@ gst_direct_control_binding_class_init (GstDirectControlBindingClass * klass)
   GstControlBindingClass *control_binding_class =
       GST_CONTROL_BINDING_CLASS (klass);
 
+  g_type_class_add_private (klass, sizeof (GstDirectControlBindingPrivate));
+
   gobject_class->constructor = gst_direct_control_binding_constructor;
   gobject_class->set_property = gst_direct_control_binding_set_property;
   gobject_class->get_property = gst_direct_control_binding_get_property;
@@ -185,6 +201,8 @@ gst_direct_control_binding_class_init (GstDirectControlBindingClass * klass)
 static void
 gst_direct_control_binding_init (GstDirectControlBinding * self)
 {
+  self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
+      GST_TYPE_DIRECT_CONTROL_BINDING, GstDirectControlBindingPrivate);
 }
 
 static GObject *
@@ -327,8 +345,10 @@ gst_direct_control_binding_sync_values (GstControlBinding * _self,
     GstObject * object, GstClockTime timestamp, GstClockTime last_sync)
 {
   GstDirectControlBinding *self = GST_DIRECT_CONTROL_BINDING (_self);
+  GstDirectControlBindingPrivate *priv = self->priv;
   gdouble src_val;
   gboolean ret;
+  gint cookie = 0;
 
   g_return_val_if_fail (GST_IS_DIRECT_CONTROL_BINDING (self), FALSE);
   g_return_val_if_fail (GST_CONTROL_BINDING_PSPEC (self), FALSE);
@@ -336,6 +356,18 @@ gst_direct_control_binding_sync_values (GstControlBinding * _self,
   GST_LOG_OBJECT (object, "property '%s' at ts=%" GST_TIME_FORMAT,
       _self->name, GST_TIME_ARGS (timestamp));
 
+  /* the values of timed value control sources only change with the control
+   * points, so syncing the same timestamp again can be skipped */
+  if (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self->cs)) {
+    cookie = g_atomic_int_get (&((GstTimedValueControlSource *) self->cs)->
+        cookie);
+    if (priv->synced && timestamp == last_sync
+        && cookie == priv->synced_cookie) {
+      GST_LOG_OBJECT (object, "  control source unchanged");
+      return priv->synced_ret;
+    }
+  }
+
   ret = gst_control_source_get_value (self->cs, timestamp, &src_val);
   if (G_LIKELY (ret)) {
     GST_LOG_OBJECT (object, "  new value %lf", src_val);
@@ -344,21 +376,37 @@ gst_direct_control_binding_sync_values (GstControlBinding * _self,
      * FIXME: can we detect negative playback rates?
      */
     if ((timestamp < last_sync) || (src_val != self->last_value)) {
-      GValue *dst_val = &self->cur_value;
-
-      GST_LOG_OBJECT (object, "  mapping %s to value of type %s", _self->name,
-          G_VALUE_TYPE_NAME (dst_val));
-      /* run mapping function to convert gdouble to GValue */
-      self->convert_g_value (self, src_val, dst_val);
-      /* we can make this faster
-       * http://bugzilla.gnome.org/show_bug.cgi?id=536939
-       */
-      g_object_set_property ((GObject *) object, _self->name, dst_val);
+      guint64 mapped = 0;
+
       self->last_value = src_val;
+
+      /* many control values map to the same integer, only set the property
+       * when the mapped value differs from the one we set last */
+      self->convert_value (self, src_val, &mapped);
+      if ((timestamp < last_sync) || !priv->have_mapped
+          || mapped != priv->last_mapped) {
+        GValue *dst_val = &self->cur_value;
+
+        GST_LOG_OBJECT (object, "  mapping %s to value of type %s",
+            _self->name, G_VALUE_TYPE_NAME (dst_val));
+        /* run mapping function to convert gdouble to GValue */
+        self->convert_g_value (self, src_val, dst_val);
+        /* we can make this faster
+         * http://bugzilla.gnome.org/show_bug.cgi?id=536939
+         */
+        g_object_set_property ((GObject *) object, _self->name, dst_val);
+        priv->last_mapped = mapped;
+        priv->have_mapped = TRUE;
+      }
     }
   } else {
     GST_DEBUG_OBJECT (object, "no control value for param %s", _self->name);
   }
+
+  priv->synced = TRUE;
+  priv->synced_ret = ret;
+  priv->synced_cookie = cookie;
+
   return (ret);
 }
 
@@ -46,6 +46,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstDirectControlBinding GstDirectControlBinding;
 typedef struct _GstDirectControlBindingClass GstDirectControlBindingClass;
+typedef struct _GstDirectControlBindingPrivate GstDirectControlBindingPrivate;
 
 /**
  * GstDirectControlBindingConvertValue:
@@ -85,7 +86,8 @@ struct _GstDirectControlBinding {
   GstDirectControlBindingConvertValue convert_value;
   GstDirectControlBindingConvertGValue convert_g_value;
 
-  gpointer _gst_reserved[GST_PADDING];
+  GstDirectControlBindingPrivate *priv;
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 /**
@@ -46,6 +46,110 @@
 #define GST_CAT_DEFAULT controller_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
+/* Helpers for get_value_array(): the values are computed one segment
+ * between two control points at a time. The segment is looked up by
+ * stepping forward from the previous one, the sequence is only searched
+ * when the timestamps skip control points. */
+
+typedef void (*FillSegmentFunc) (GstTimedValueControlSource * self,
+    GstControlPoint * cp1, GstControlPoint * cp2, GstClockTime ts,
+    GstClockTime interval, guint n, gdouble * values);
+
+/* makes cp1 the last control point at or before @ts and cp2 the next one,
+ * *iter2 is the position of cp2 or %NULL */
+static void
+_segment_seek (GstTimedValueControlSource * self, GstClockTime ts,
+    GSequenceIter ** iter2, GstControlPoint ** cp1, GstControlPoint ** cp2)
+{
+  GSequenceIter *iter1 = NULL, *next;
+
+  if (*iter2 && !g_sequence_iter_is_end (*iter2)) {
+    /* usually the timestamp just moved into the following segment */
+    next = g_sequence_iter_next (*iter2);
+    if (g_sequence_iter_is_end (next)
+        || ((GstControlPoint *) g_sequence_get (next))->timestamp > ts)
+      iter1 = *iter2;
+  }
+  if (!iter1)
+    iter1 = gst_timed_value_control_source_find_control_point_iter (self, ts);
+
+  if (iter1) {
+    *cp1 = g_sequence_get (iter1);
+    next = g_sequence_iter_next (iter1);
+  } else {
+    *cp1 = NULL;
+    next = self->values ? g_sequence_get_begin_iter (self->values) : NULL;
+  }
+
+  if (next && !g_sequence_iter_is_end (next)) {
+    *cp2 = g_sequence_get (next);
+    *iter2 = next;
+  } else {
+    *cp2 = NULL;
+    *iter2 = NULL;
+  }
+}
+
+/* number of the @n_values timestamps starting at @ts that come before
+ * @next_ts */
+static inline guint
+_segment_length (GstClockTime ts, GstClockTime interval, GstClockTime next_ts,
+    guint n_values)
+{
+  guint64 n;
+
+  if (!GST_CLOCK_TIME_IS_VALID (next_ts) || interval == 0)
+    return n_values;
+
+  n = (next_ts - ts + interval - 1) / interval;
+
+  return MIN (n, n_values);
+}
+
+static gboolean
+_get_value_array (GstTimedValueControlSource * self, GstClockTime timestamp,
+    GstClockTime interval, guint n_values, gdouble * values,
+    FillSegmentFunc fill)
+{
+  gboolean ret = FALSE;
+  GstClockTime ts = timestamp;
+  GSequenceIter *iter2 = NULL;
+  GstControlPoint *cp1 = NULL, *cp2 = NULL;
+  guint i = 0, n;
+
+  g_mutex_lock (&self->lock);
+
+  _segment_seek (self, ts, &iter2, &cp1, &cp2);
+
+  while (i < n_values) {
+    if (cp2 && ts >= cp2->timestamp)
+      _segment_seek (self, ts, &iter2, &cp1, &cp2);
+
+    n = _segment_length (ts, interval,
+        cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE, n_values - i);
+
+    GST_LOG ("values[%3d..%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%"
+        GST_TIME_FORMAT, i, i + n - 1, GST_TIME_ARGS (ts),
+        GST_TIME_ARGS (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE));
+
+    if (cp1) {
+      fill (self, cp1, cp2, ts, interval, n, values + i);
+      ret = TRUE;
+    } else {
+      guint j;
+
+      for (j = 0; j < n; j++)
+        values[i + j] = NAN;
+    }
+
+    i += n;
+    ts += n * interval;
+  }
+
+  g_mutex_unlock (&self->lock);
+  return ret;
+}
+
 /*  steps-like (no-)interpolation, default */
 /*  just returns the value for the most recent key-frame */
 static inline gdouble
@@ -75,57 +179,25 @@ interpolate_none_get (GstTimedValueControlSource * self, GstClockTime timestamp,
   return ret;
 }
 
-static gboolean
-interpolate_none_get_value_array (GstTimedValueControlSource * self,
-    GstClockTime timestamp, GstClockTime interval, guint n_values,
+static void
+_fill_none (GstTimedValueControlSource * self, GstControlPoint * cp1,
+    GstControlPoint * cp2, GstClockTime ts, GstClockTime interval, guint n,
     gdouble * values)
 {
-  gboolean ret = FALSE;
+  gdouble value = cp1->value;
   guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  gdouble val;
-  GSequenceIter *iter1 = NULL, *iter2 = NULL;
 
-  g_mutex_lock (&self->lock);
+  for (i = 0; i < n; i++)
+    values[i] = value;
+}
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    val = NAN;
-    if (ts >= next_ts) {
-      iter1 = gst_timed_value_control_source_find_control_point_iter (self, ts);
-      if (!iter1) {
-        if (G_LIKELY (self->values))
-          iter2 = g_sequence_get_begin_iter (self->values);
-        else
-          iter2 = NULL;
-      } else {
-        iter2 = g_sequence_iter_next (iter1);
-      }
-
-      if (iter2 && !g_sequence_iter_is_end (iter2)) {
-        GstControlPoint *cp;
-
-        cp = g_sequence_get (iter2);
-        next_ts = cp->timestamp;
-      } else {
-        next_ts = GST_CLOCK_TIME_NONE;
-      }
-    }
-    if (iter1) {
-      val = _interpolate_none (self, iter1);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, val);
-    } else {
-      GST_LOG ("values[%3d]=-", i);
-    }
-    *values = val;
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+static gboolean
+interpolate_none_get_value_array (GstTimedValueControlSource * self,
+    GstClockTime timestamp, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _fill_none);
 }
 
 
@@ -177,60 +249,41 @@ interpolate_linear_get (GstTimedValueControlSource * self,
   return ret;
 }
 
-static gboolean
-interpolate_linear_get_value_array (GstTimedValueControlSource * self,
-    GstClockTime timestamp, GstClockTime interval, guint n_values,
+static void
+_fill_linear (GstTimedValueControlSource * self, GstControlPoint * cp1,
+    GstControlPoint * cp2, GstClockTime ts, GstClockTime interval, guint n,
     gdouble * values)
 {
-  gboolean ret = FALSE;
+  GstClockTime offset;
+  gdouble value1, slope;
   guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  gdouble val;
-  GSequenceIter *iter1, *iter2 = NULL;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
 
-  g_mutex_lock (&self->lock);
+  value1 = cp1->value;
 
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    val = NAN;
-    if (ts >= next_ts) {
-      cp1 = cp2 = NULL;
-      iter1 = gst_timed_value_control_source_find_control_point_iter (self, ts);
-      if (!iter1) {
-        if (G_LIKELY (self->values))
-          iter2 = g_sequence_get_begin_iter (self->values);
-        else
-          iter2 = NULL;
-      } else {
-        cp1 = g_sequence_get (iter1);
-        iter2 = g_sequence_iter_next (iter1);
-      }
-
-      if (iter2 && !g_sequence_iter_is_end (iter2)) {
-        cp2 = g_sequence_get (iter2);
-        next_ts = cp2->timestamp;
-      } else {
-        next_ts = GST_CLOCK_TIME_NONE;
-      }
-    }
-    if (cp1) {
-      val = _interpolate_linear (cp1->timestamp, cp1->value,
-          (cp2 ? cp2->timestamp : GST_CLOCK_TIME_NONE),
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, val);
-    } else {
-      GST_LOG ("values[%3d]=-", i);
-    }
-    *values = val;
-    ts += interval;
-    values++;
+  if (!cp2) {
+    for (i = 0; i < n; i++)
+      values[i] = value1;
+    return;
   }
-  g_mutex_unlock (&self->lock);
-  return ret;
+
+  /* same as _interpolate_linear(), with the slope taken out of the loop */
+  slope = (cp2->value - value1) /
+      gst_guint64_to_gdouble (cp2->timestamp - cp1->timestamp);
+  offset = ts - cp1->timestamp;
+
+  for (i = 0; i < n; i++) {
+    values[i] = value1 + gst_guint64_to_gdouble (offset) * slope;
+    offset += interval;
+  }
+}
+
+static gboolean
+interpolate_linear_get_value_array (GstTimedValueControlSource * self,
+    GstClockTime timestamp, GstClockTime interval, guint n_values,
+    gdouble * values)
+{
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _fill_linear);
 }
 
 
@@ -392,63 +445,58 @@ interpolate_cubic_get (GstTimedValueControlSource * self,
   return ret;
 }
 
+static void
+_fill_cubic (GstTimedValueControlSource * self, GstControlPoint * cp1,
+    GstControlPoint * cp2, GstClockTime ts, GstClockTime interval, guint n,
+    gdouble * values)
+{
+  gdouble h, z1, z2, c1, c2;
+  guint i;
+
+  if (!self->valid_cache) {
+    _interpolate_cubic_update_cache (self);
+    self->valid_cache = TRUE;
+  }
+
+  if (!cp2) {
+    for (i = 0; i < n; i++)
+      values[i] = cp1->value;
+    return;
+  }
+
+  /* same as _interpolate_cubic(), with the per segment terms taken out of
+   * the loop */
+  h = cp1->cache.cubic.h;
+  z1 = cp1->cache.cubic.z;
+  z2 = cp2->cache.cubic.z;
+  c1 = cp2->value / h - h * z2;
+  c2 = cp1->value / h - h * z1;
+
+  for (i = 0; i < n; i++) {
+    gdouble diff1, diff2, out;
+
+    diff1 = gst_guint64_to_gdouble (ts - cp1->timestamp);
+    diff2 = gst_guint64_to_gdouble (cp2->timestamp - ts);
+
+    out = (z2 * diff1 * diff1 * diff1 + z1 * diff2 * diff2 * diff2) / h;
+    out += c1 * diff1;
+    out += c2 * diff2;
+    values[i] = out;
+    ts += interval;
+  }
+}
+
 static gboolean
 interpolate_cubic_get_value_array (GstTimedValueControlSource * self,
     GstClockTime timestamp, GstClockTime interval, guint n_values,
     gdouble * values)
 {
-  gboolean ret = FALSE;
-  guint i;
-  GstClockTime ts = timestamp;
-  GstClockTime next_ts = 0;
-  gdouble val;
-  GSequenceIter *iter1, *iter2 = NULL;
-  GstControlPoint *cp1 = NULL, *cp2 = NULL;
-
   if (self->nvalues <= 2)
     return interpolate_linear_get_value_array (self, timestamp, interval,
         n_values, values);
 
-  g_mutex_lock (&self->lock);
-
-  for (i = 0; i < n_values; i++) {
-    GST_LOG ("values[%3d] : ts=%" GST_TIME_FORMAT ", next_ts=%" GST_TIME_FORMAT,
-        i, GST_TIME_ARGS (ts), GST_TIME_ARGS (next_ts));
-    val = NAN;
-    if (ts >= next_ts) {
-      cp1 = cp2 = NULL;
-      iter1 = gst_timed_value_control_source_find_control_point_iter (self, ts);
-      if (!iter1) {
-        if (G_LIKELY (self->values))
-          iter2 = g_sequence_get_begin_iter (self->values);
-        else
-          iter2 = NULL;
-      } else {
-        cp1 = g_sequence_get (iter1);
-        iter2 = g_sequence_iter_next (iter1);
-      }
-
-      if (iter2 && !g_sequence_iter_is_end (iter2)) {
-        cp2 = g_sequence_get (iter2);
-        next_ts = cp2->timestamp;
-      } else {
-        next_ts = GST_CLOCK_TIME_NONE;
-      }
-    }
-    if (cp1) {
-      val = _interpolate_cubic (self, cp1, cp1->value, cp2,
-          (cp2 ? cp2->value : 0.0), ts);
-      ret = TRUE;
-      GST_LOG ("values[%3d]=%lf", i, val);
-    } else {
-      GST_LOG ("values[%3d]=-", i);
-    }
-    *values = val;
-    ts += interval;
-    values++;
-  }
-  g_mutex_unlock (&self->lock);
-  return ret;
+  return _get_value_array (self, timestamp, interval, n_values, values,
+      _fill_cubic);
 }
 
 static struct
@@ -82,6 +82,7 @@ gst_timed_value_control_source_reset (GstTimedValueControlSource * self)
 
   self->nvalues = 0;
   self->valid_cache = FALSE;
+  g_atomic_int_inc (&self->cookie);
 }
 
 /*
@@ -138,6 +139,20 @@ gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
 {
   GSequenceIter *iter;
 
+  /* appending after the last control point is the common case when curves
+   * are imported, it needs no search */
+  if (G_LIKELY (self->values) && self->nvalues > 0) {
+    GstControlPoint *last;
+
+    last = g_sequence_get (g_sequence_iter_prev (g_sequence_get_end_iter
+            (self->values)));
+    if (timestamp > last->timestamp) {
+      g_sequence_append (self->values, _make_new_cp (self, timestamp, value));
+      self->nvalues++;
+      goto done;
+    }
+  }
+
   /* check if a control point for the timestamp already exists */
 
   /* iter contains the iter right *after* timestamp */
@@ -168,6 +183,7 @@ gst_timed_value_control_source_set_internal (GstTimedValueControlSource *
 
 done:
   self->valid_cache = FALSE;
+  g_atomic_int_inc (&self->cookie);
 }
 
 /**
@@ -236,7 +252,8 @@ gst_timed_value_control_source_set (GstTimedValueControlSource * self,
  * @timedvalues: (transfer none) (element-type GstController.TimedValue): a list
  * with #GstTimedValue items
  *
- * Sets multiple timed values at once.
+ * Sets multiple timed values at once. Setting the values in increasing
+ * timestamp order is the fastest.
  *
  * Returns: FALSE if the values couldn't be set, TRUE otherwise.
  */
@@ -250,22 +267,108 @@ gst_timed_value_control_source_set_from_list (GstTimedValueControlSource *
 
   g_return_val_if_fail (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self), FALSE);
 
+  g_mutex_lock (&self->lock);
   for (node = timedvalues; node; node = g_slist_next (node)) {
     tv = node->data;
     if (!GST_CLOCK_TIME_IS_VALID (tv->timestamp)) {
       GST_WARNING ("GstTimedValued with invalid timestamp passed to %s",
           GST_FUNCTION);
     } else {
-      g_mutex_lock (&self->lock);
       gst_timed_value_control_source_set_internal (self, tv->timestamp,
           tv->value);
-      g_mutex_unlock (&self->lock);
       res = TRUE;
     }
   }
+  g_mutex_unlock (&self->lock);
+
   return res;
 }
 
+/**
+ * gst_timed_value_control_source_simplify:
+ * @self: the #GstTimedValueControlSource object
+ * @epsilon: the maximum deviation, in control values
+ *
+ * Removes the control points that are not needed to describe the curve,
+ * when it is interpolated linearly, within @epsilon. After this, the curve
+ * between the remaining control points differs by at most @epsilon from
+ * each removed control point. The first and the last control point are
+ * always kept.
+ *
+ * This is useful to reduce the size of densely sampled automation curves.
+ *
+ * Returns: the number of control points that were removed.
+ *
+ * Since: 1.2
+ */
+guint
+gst_timed_value_control_source_simplify (GstTimedValueControlSource * self,
+    gdouble epsilon)
+{
+  GSequenceIter *iter, *next;
+  GstControlPoint *prev, *cp, *ncp;
+  gdouble lo, hi, lo_cp, hi_cp, dt, slope;
+  guint removed = 0;
+
+  g_return_val_if_fail (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self), 0);
+  g_return_val_if_fail (epsilon >= 0.0, 0);
+
+  g_mutex_lock (&self->lock);
+  if (!self->values || self->nvalues < 3)
+    goto done;
+
+  /* Walk the points keeping the range of slopes a line from the last kept
+   * point can have and still pass within epsilon of all points removed since.
+   * A point is removed when the line to the point after it is in that range
+   * (and within epsilon of the point itself). */
+  iter = g_sequence_get_begin_iter (self->values);
+  prev = g_sequence_get (iter);
+  lo = -G_MAXDOUBLE;
+  hi = G_MAXDOUBLE;
+
+  iter = g_sequence_iter_next (iter);
+  next = g_sequence_iter_next (iter);
+  while (!g_sequence_iter_is_end (next)) {
+    cp = g_sequence_get (iter);
+    ncp = g_sequence_get (next);
+
+    dt = gst_guint64_to_gdouble (cp->timestamp - prev->timestamp);
+    lo_cp = MAX (lo, (cp->value - epsilon - prev->value) / dt);
+    hi_cp = MIN (hi, (cp->value + epsilon - prev->value) / dt);
+
+    dt = gst_guint64_to_gdouble (ncp->timestamp - prev->timestamp);
+    slope = (ncp->value - prev->value) / dt;
+
+    if (slope >= lo_cp && slope <= hi_cp) {
+      g_sequence_remove (iter);
+      self->nvalues--;
+      removed++;
+      lo = lo_cp;
+      hi = hi_cp;
+    } else {
+      prev = cp;
+      lo = -G_MAXDOUBLE;
+      hi = G_MAXDOUBLE;
+    }
+
+    iter = next;
+    next = g_sequence_iter_next (iter);
+  }
+
+  if (removed > 0) {
+    self->valid_cache = FALSE;
+    g_atomic_int_inc (&self->cookie);
+  }
+
+  GST_DEBUG ("removed %u of %d control points", removed,
+      self->nvalues + removed);
+
+done:
+  g_mutex_unlock (&self->lock);
+
+  return removed;
+}
+
 /**
  * gst_timed_value_control_source_unset:
  * @self: the #GstTimedValueControlSource object
@@ -302,6 +405,7 @@ gst_timed_value_control_source_unset (GstTimedValueControlSource * self,
       g_sequence_remove (iter);
       self->nvalues--;
       self->valid_cache = FALSE;
+      g_atomic_int_inc (&self->cookie);
       res = TRUE;
     }
   }
@@ -330,6 +434,7 @@ gst_timed_value_control_source_unset_all (GstTimedValueControlSource * self)
   }
   self->nvalues = 0;
   self->valid_cache = FALSE;
+  g_atomic_int_inc (&self->cookie);
 
   g_mutex_unlock (&self->lock);
 }
@@ -391,6 +496,7 @@ gst_timed_value_control_invalidate_cache (GstTimedValueControlSource * self)
 {
   g_return_if_fail (GST_IS_TIMED_VALUE_CONTROL_SOURCE (self));
   self->valid_cache = FALSE;
+  g_atomic_int_inc (&self->cookie);
 }
 
 static void
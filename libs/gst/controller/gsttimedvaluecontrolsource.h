@@ -93,7 +93,8 @@ struct _GstTimedValueControlSource {
 
   /*< private >*/
   GstTimedValueControlSourcePrivate *priv;
-  gpointer _gst_reserved[GST_PADDING];
+  gint cookie;                  /* ATOMIC, changes with the control points */
+  gpointer _gst_reserved[GST_PADDING - 1];
 };
 
 struct _GstTimedValueControlSourceClass {
@@ -124,6 +125,8 @@ gboolean        gst_timed_value_control_source_set_from_list  (GstTimedValueCont
 gboolean        gst_timed_value_control_source_unset          (GstTimedValueControlSource * self,
                                                                GstClockTime timestamp);
 void            gst_timed_value_control_source_unset_all      (GstTimedValueControlSource *self);
+guint           gst_timed_value_control_source_simplify       (GstTimedValueControlSource * self,
+                                                               gdouble epsilon);
 GList *         gst_timed_value_control_source_get_all        (GstTimedValueControlSource * self);
 gint            gst_timed_value_control_source_get_count      (GstTimedValueControlSource * self);
 void            gst_timed_value_control_invalidate_cache      (GstTimedValueControlSource * self);
@@ -214,6 +214,8 @@ gst_trigger_control_source_set_property (GObject * object, guint prop_id,
     case PROP_TOLERANCE:
       GST_TIMED_VALUE_CONTROL_SOURCE_LOCK (self);
       self->priv->tolerance = g_value_get_int64 (value);
+      gst_timed_value_control_invalidate_cache ((GstTimedValueControlSource *)
+          self);
       GST_TIMED_VALUE_CONTROL_SOURCE_UNLOCK (self);
       break;
     default:
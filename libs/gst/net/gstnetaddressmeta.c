@@ -25,6 +25,11 @@
  * be used to store a network address in a #GstBuffer so that it network
  * elements can track the to and from address of the buffer.
  *
+ * Sources that receive many packets can add the address with
+ * gst_buffer_add_net_address_meta_from_native(). The meta then only copies
+ * the native socket address and the #GSocketAddress is only created when
+ * gst_net_address_meta_get_address() is called.
+ *
  * Last reviewed on 2011-11-03 (0.11.2)
  */
 
@@ -38,6 +43,7 @@ net_address_meta_init (GstMeta * meta, gpointer params, GstBuffer * buffer)
   GstNetAddressMeta *nmeta = (GstNetAddressMeta *) meta;
 
   nmeta->addr = NULL;
+  nmeta->native_len = 0;
 
   return TRUE;
 }
@@ -48,8 +54,13 @@ net_address_meta_transform (GstBuffer * transbuf, GstMeta * meta,
 {
   GstNetAddressMeta *nmeta = (GstNetAddressMeta *) meta;
 
-  /* we always copy no matter what transform */
-  gst_buffer_add_net_address_meta (transbuf, nmeta->addr);
+  /* we always copy no matter what transform, without creating the
+   * GSocketAddress when it was not needed so far */
+  if (nmeta->native_len > 0)
+    gst_buffer_add_net_address_meta_from_native (transbuf, nmeta->native,
+        nmeta->native_len);
+  else
+    gst_buffer_add_net_address_meta (transbuf, nmeta->addr);
 
   return TRUE;
 }
@@ -109,3 +120,89 @@ gst_buffer_add_net_address_meta (GstBuffer * buffer, GSocketAddress * addr)
 
   return meta;
 }
+
+/**
+ * gst_buffer_add_net_address_meta_from_native:
+ * @buffer: a #GstBuffer
+ * @native: (array length=len): a native socket address, a struct sockaddr
+ * @len: the size of @native
+ *
+ * Attaches the network address in @native to @buffer, see
+ * gst_buffer_add_net_address_meta(). Addresses of up to 32 bytes, which
+ * includes IPv4 and IPv6 addresses, are copied into the meta and no
+ * #GSocketAddress is created until gst_net_address_meta_get_address() is
+ * called.
+ *
+ * Returns: (transfer none): a #GstNetAddressMeta connected to @buffer, or
+ *     %NULL if @native is not a valid socket address
+ *
+ * Since: 1.2
+ */
+GstNetAddressMeta *
+gst_buffer_add_net_address_meta_from_native (GstBuffer * buffer,
+    gconstpointer native, gsize len)
+{
+  GstNetAddressMeta *meta;
+  GSocketAddress *addr;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (native != NULL, NULL);
+  g_return_val_if_fail (len > 0, NULL);
+
+  if (G_UNLIKELY (len > sizeof (meta->native))) {
+    addr = g_socket_address_new_from_native ((gpointer) native, len);
+    if (addr == NULL)
+      return NULL;
+
+    meta = gst_buffer_add_net_address_meta (buffer, addr);
+    g_object_unref (addr);
+
+    return meta;
+  }
+
+  meta =
+      (GstNetAddressMeta *) gst_buffer_add_meta (buffer,
+      GST_NET_ADDRESS_META_INFO, NULL);
+
+  memcpy (meta->native, native, len);
+  meta->native_len = len;
+
+  return meta;
+}
+
+/**
+ * gst_net_address_meta_get_address:
+ * @meta: a #GstNetAddressMeta
+ *
+ * Get the network address of @meta, creating the #GSocketAddress for a meta
+ * that was added with gst_buffer_add_net_address_meta_from_native(). This
+ * can be called on the meta of a buffer that is not writable.
+ *
+ * Returns: (transfer none): the #GSocketAddress of @meta, or %NULL if the
+ *     native address is not supported
+ *
+ * Since: 1.2
+ */
+GSocketAddress *
+gst_net_address_meta_get_address (GstNetAddressMeta * meta)
+{
+  GSocketAddress *addr;
+
+  g_return_val_if_fail (meta != NULL, NULL);
+
+  addr = g_atomic_pointer_get (&meta->addr);
+  if (addr != NULL || meta->native_len == 0)
+    return addr;
+
+  addr = g_socket_address_new_from_native (meta->native, meta->native_len);
+  if (addr == NULL)
+    return NULL;
+
+  /* another thread may have created it at the same time */
+  if (!g_atomic_pointer_compare_and_exchange (&meta->addr, NULL, addr)) {
+    g_object_unref (addr);
+    addr = g_atomic_pointer_get (&meta->addr);
+  }
+
+  return addr;
+}
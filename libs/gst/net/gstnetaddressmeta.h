@@ -29,6 +29,10 @@ typedef struct _GstNetAddressMeta GstNetAddressMeta;
 
 /**
  * GstNetAddressMeta:
+ * @meta: the parent type
+ * @addr: a #GSocketAddress stored as metadata. For a meta that was added
+ *     with gst_buffer_add_net_address_meta_from_native() this is %NULL until
+ *     gst_net_address_meta_get_address() is called
  *
  * Buffer metadata for network addresses.
  */
@@ -36,6 +40,10 @@ struct _GstNetAddressMeta {
   GstMeta       meta;
 
   GSocketAddress *addr;
+
+  /*< private >*/
+  gsize         native_len;
+  guint64       native[4];
 };
 
 GType gst_net_address_meta_api_get_type (void);
@@ -50,6 +58,11 @@ const GstMetaInfo *gst_net_address_meta_get_info (void);
 
 GstNetAddressMeta * gst_buffer_add_net_address_meta (GstBuffer      *buffer,
                                                      GSocketAddress *addr);
+GstNetAddressMeta * gst_buffer_add_net_address_meta_from_native (GstBuffer *buffer,
+                                                     gconstpointer   native,
+                                                     gsize           len);
+
+GSocketAddress *    gst_net_address_meta_get_address (GstNetAddressMeta *meta);
 
 G_END_DECLS
 
@@ -41,6 +41,18 @@
  * Various parameters of the clock can be configured with the parent #GstClock
  * "timeout", "window-size" and "window-threshold" object properties.
  *
+ * To reduce the effect of network jitter, the clock can send a burst of
+ * requests per poll with the #GstNetClientClock:burst-size property and only
+ * uses the reply with the shortest round trip of each burst. Replies with a
+ * round trip longer than #GstNetClientClock:round-trip-limit or much longer
+ * than the average round trip are discarded. The time between two polls is
+ * derived from the quality of the observations and bounded by
+ * #GstNetClientClock:minimum-update-interval and the "timeout" property.
+ *
+ * Additional time providers can be configured with
+ * #GstNetClientClock:fallback-servers. The clock switches to the next
+ * provider when the current one did not reply to several polls in a row.
+ *
  * A #GstNetClientClock is typically set on a #GstPipeline with 
  * gst_pipeline_use_clock().
  *
@@ -56,18 +68,31 @@
 
 #include <gio/gio.h>
 
+#include <string.h>
+
 GST_DEBUG_CATEGORY_STATIC (ncc_debug);
 #define GST_CAT_DEFAULT (ncc_debug)
 
 #define DEFAULT_ADDRESS         "127.0.0.1"
 #define DEFAULT_PORT            5637
 #define DEFAULT_TIMEOUT         GST_SECOND
+#define DEFAULT_ROUNDTRIP_LIMIT GST_SECOND
+#define DEFAULT_MINIMUM_UPDATE_INTERVAL 0
+#define DEFAULT_BURST_SIZE      1
+#define DEFAULT_FALLBACK_SERVERS NULL
+
+/* polls without reply before switching to the next time provider */
+#define MAX_MISSED_POLLS        3
 
 enum
 {
   PROP_0,
   PROP_ADDRESS,
-  PROP_PORT
+  PROP_PORT,
+  PROP_ROUNDTRIP_LIMIT,
+  PROP_MINIMUM_UPDATE_INTERVAL,
+  PROP_BURST_SIZE,
+  PROP_FALLBACK_SERVERS
 };
 
 #define GST_NET_CLIENT_CLOCK_GET_PRIVATE(obj)  \
@@ -85,6 +110,25 @@ struct _GstNetClientClockPrivate
 
   gchar *address;
   gint port;
+
+  /* with LOCK */
+  GstClockTime roundtrip_limit;
+  GstClockTime minimum_update_interval;
+  guint burst_size;
+  gchar *fallback_servers;
+  gboolean servers_changed;
+
+  /* only used by the thread, the first server is servaddr */
+  GPtrArray *servers;
+  guint current_server;
+  guint missed_polls;
+  guint burst_sent;
+  guint burst_received;
+  GstClockTime best_rtt;
+  GstClockTime best_local_1;
+  GstClockTime best_remote;
+  GstClockTime best_local_2;
+  GstClockTime avg_rtt;
 };
 
 #define _do_init \
@@ -122,6 +166,62 @@ gst_net_client_clock_class_init (GstNetClientClockClass * klass)
       g_param_spec_int ("port", "port",
           "The port on which the remote server is listening", 0, G_MAXUINT16,
           DEFAULT_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetClientClock:round-trip-limit:
+   *
+   * Replies that took longer than this to come back are discarded.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_ROUNDTRIP_LIMIT,
+      g_param_spec_uint64 ("round-trip-limit", "Round trip limit",
+          "Maximum tolerable round trip time of a reply in nanoseconds",
+          1, G_MAXUINT64, DEFAULT_ROUNDTRIP_LIMIT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetClientClock:minimum-update-interval:
+   *
+   * The minimum time between two polls of the time provider. The maximum is
+   * the "timeout" property of the clock.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MINIMUM_UPDATE_INTERVAL,
+      g_param_spec_uint64 ("minimum-update-interval",
+          "Minimum update interval",
+          "Minimum time between two polls in nanoseconds", 0, G_MAXUINT64,
+          DEFAULT_MINIMUM_UPDATE_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetClientClock:burst-size:
+   *
+   * The number of requests sent for each poll. Only the reply with the
+   * shortest round trip of a burst is used to calibrate the clock.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_SIZE,
+      g_param_spec_uint ("burst-size", "Burst size",
+          "Number of requests sent per poll", 1, 64, DEFAULT_BURST_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetClientClock:fallback-servers:
+   *
+   * A comma separated list of "address:port" pairs of time providers that
+   * are used when the provider at #GstNetClientClock:address stops
+   * replying.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_FALLBACK_SERVERS,
+      g_param_spec_string ("fallback-servers", "Fallback servers",
+          "Comma separated list of address:port of other time providers",
+          DEFAULT_FALLBACK_SERVERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -140,6 +240,13 @@ gst_net_client_clock_init (GstNetClientClock * self)
   priv->thread = NULL;
 
   priv->servaddr = NULL;
+
+  priv->roundtrip_limit = DEFAULT_ROUNDTRIP_LIMIT;
+  priv->minimum_update_interval = DEFAULT_MINIMUM_UPDATE_INTERVAL;
+  priv->burst_size = DEFAULT_BURST_SIZE;
+  priv->fallback_servers = g_strdup (DEFAULT_FALLBACK_SERVERS);
+  priv->best_rtt = GST_CLOCK_TIME_NONE;
+  priv->avg_rtt = GST_CLOCK_TIME_NONE;
 }
 
 static void
@@ -154,6 +261,9 @@ gst_net_client_clock_finalize (GObject * object)
   g_free (self->priv->address);
   self->priv->address = NULL;
 
+  g_free (self->priv->fallback_servers);
+  self->priv->fallback_servers = NULL;
+
   if (self->priv->servaddr != NULL) {
     g_object_unref (self->priv->servaddr);
     self->priv->servaddr = NULL;
@@ -184,6 +294,28 @@ gst_net_client_clock_set_property (GObject * object, guint prop_id,
     case PROP_PORT:
       self->priv->port = g_value_get_int (value);
       break;
+    case PROP_ROUNDTRIP_LIMIT:
+      GST_OBJECT_LOCK (self);
+      self->priv->roundtrip_limit = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MINIMUM_UPDATE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      self->priv->minimum_update_interval = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BURST_SIZE:
+      GST_OBJECT_LOCK (self);
+      self->priv->burst_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FALLBACK_SERVERS:
+      GST_OBJECT_LOCK (self);
+      g_free (self->priv->fallback_servers);
+      self->priv->fallback_servers = g_value_dup_string (value);
+      self->priv->servers_changed = TRUE;
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -203,6 +335,26 @@ gst_net_client_clock_get_property (GObject * object, guint prop_id,
     case PROP_PORT:
       g_value_set_int (value, self->priv->port);
       break;
+    case PROP_ROUNDTRIP_LIMIT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->priv->roundtrip_limit);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_MINIMUM_UPDATE_INTERVAL:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, self->priv->minimum_update_interval);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_BURST_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->priv->burst_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_FALLBACK_SERVERS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_string (value, self->priv->fallback_servers);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -234,6 +386,10 @@ gst_net_client_clock_observe_times (GstNetClientClock * self,
     current_timeout = 0;
   }
 
+  GST_OBJECT_LOCK (self);
+  current_timeout = MAX (current_timeout, self->priv->minimum_update_interval);
+  GST_OBJECT_UNLOCK (self);
+
   GST_INFO ("next timeout: %" GST_TIME_FORMAT, GST_TIME_ARGS (current_timeout));
   self->priv->timeout_expiration = gst_util_get_timestamp () + current_timeout;
 
@@ -248,6 +404,200 @@ bogus_observation:
   }
 }
 
+/* parses the fallback servers into priv->servers, after the primary one */
+static void
+gst_net_client_clock_update_servers (GstNetClientClock * self)
+{
+  GstNetClientClockPrivate *priv = self->priv;
+  gchar **list, **walk;
+
+  GST_OBJECT_LOCK (self);
+  list = g_strsplit (priv->fallback_servers ? priv->fallback_servers : "",
+      ",", -1);
+  priv->servers_changed = FALSE;
+  GST_OBJECT_UNLOCK (self);
+
+  g_ptr_array_set_size (priv->servers, 1);
+  priv->current_server = 0;
+  priv->missed_polls = 0;
+
+  for (walk = list; *walk; walk++) {
+    GInetAddress *inetaddr;
+    gchar *colon;
+    gint64 port;
+
+    g_strstrip (*walk);
+    if (**walk == '\0')
+      continue;
+
+    colon = strrchr (*walk, ':');
+    port = colon ? g_ascii_strtoll (colon + 1, NULL, 10) : DEFAULT_PORT;
+    if (colon)
+      *colon = '\0';
+
+    inetaddr = g_inet_address_new_from_string (*walk);
+    if (inetaddr == NULL || port <= 0 || port > G_MAXUINT16) {
+      GST_WARNING_OBJECT (self, "invalid fallback server '%s'", *walk);
+      if (inetaddr)
+        g_object_unref (inetaddr);
+      continue;
+    }
+
+    GST_DEBUG_OBJECT (self, "fallback server %s:%d", *walk, (gint) port);
+    g_ptr_array_add (priv->servers, g_inet_socket_address_new (inetaddr,
+            port));
+    g_object_unref (inetaddr);
+  }
+  g_strfreev (list);
+}
+
+static gboolean
+gst_net_client_clock_is_current_server (GstNetClientClock * self,
+    GSocketAddress * addr)
+{
+  GInetSocketAddress *current, *other;
+
+  if (addr == NULL || !G_IS_INET_SOCKET_ADDRESS (addr))
+    return FALSE;
+
+  current = g_ptr_array_index (self->priv->servers,
+      self->priv->current_server);
+  other = G_INET_SOCKET_ADDRESS (addr);
+
+  return g_inet_socket_address_get_port (current) ==
+      g_inet_socket_address_get_port (other) &&
+      g_inet_address_equal (g_inet_socket_address_get_address (current),
+      g_inet_socket_address_get_address (other));
+}
+
+/* keeps the reply with the shortest round trip of the current burst */
+static void
+gst_net_client_clock_add_sample (GstNetClientClock * self,
+    GstClockTime local_1, GstClockTime remote, GstClockTime local_2)
+{
+  GstNetClientClockPrivate *priv = self->priv;
+  GstClockTime rtt, limit, avg;
+
+  priv->burst_received++;
+
+  if (local_2 < local_1) {
+    GST_WARNING_OBJECT (self, "time packet receive time < send time (%"
+        GST_TIME_FORMAT " < %" GST_TIME_FORMAT ")", GST_TIME_ARGS (local_1),
+        GST_TIME_ARGS (local_2));
+    return;
+  }
+
+  rtt = local_2 - local_1;
+
+  /* the average follows all replies so that it adapts when the network
+   * conditions change */
+  avg = priv->avg_rtt;
+  if (avg == GST_CLOCK_TIME_NONE)
+    priv->avg_rtt = rtt;
+  else
+    priv->avg_rtt = (7 * avg + rtt) / 8;
+
+  GST_OBJECT_LOCK (self);
+  limit = priv->roundtrip_limit;
+  GST_OBJECT_UNLOCK (self);
+
+  if (rtt > limit) {
+    GST_DEBUG_OBJECT (self, "discarding reply, round trip %" GST_TIME_FORMAT
+        " > limit %" GST_TIME_FORMAT, GST_TIME_ARGS (rtt),
+        GST_TIME_ARGS (limit));
+    return;
+  }
+
+  if (avg != GST_CLOCK_TIME_NONE && rtt > 2 * avg + GST_MSECOND) {
+    GST_DEBUG_OBJECT (self, "discarding reply, round trip %" GST_TIME_FORMAT
+        " >> average %" GST_TIME_FORMAT, GST_TIME_ARGS (rtt),
+        GST_TIME_ARGS (avg));
+    return;
+  }
+
+  if (priv->best_rtt == GST_CLOCK_TIME_NONE || rtt < priv->best_rtt) {
+    priv->best_rtt = rtt;
+    priv->best_local_1 = local_1;
+    priv->best_remote = remote;
+    priv->best_local_2 = local_2;
+  }
+}
+
+/* ends the current burst, returns TRUE when an observation was made */
+static gboolean
+gst_net_client_clock_finish_burst (GstNetClientClock * self)
+{
+  GstNetClientClockPrivate *priv = self->priv;
+  gboolean observed = FALSE;
+
+  if (priv->burst_sent > 0 && priv->burst_received == 0) {
+    if (++priv->missed_polls >= MAX_MISSED_POLLS && priv->servers->len > 1) {
+      priv->current_server = (priv->current_server + 1) % priv->servers->len;
+      priv->missed_polls = 0;
+      priv->avg_rtt = GST_CLOCK_TIME_NONE;
+      GST_INFO_OBJECT (self, "no reply from the time provider, switching to "
+          "server %u", priv->current_server);
+    }
+  } else {
+    priv->missed_polls = 0;
+  }
+
+  if (priv->best_rtt != GST_CLOCK_TIME_NONE) {
+    GST_LOG_OBJECT (self, "using reply with round trip %" GST_TIME_FORMAT
+        " (%u of %u replies)", GST_TIME_ARGS (priv->best_rtt),
+        priv->burst_received, priv->burst_sent);
+    /* observe_times will reset the timeout */
+    gst_net_client_clock_observe_times (self, priv->best_local_1,
+        priv->best_remote, priv->best_local_2);
+    observed = TRUE;
+  }
+
+  priv->burst_sent = 0;
+  priv->burst_received = 0;
+  priv->best_rtt = GST_CLOCK_TIME_NONE;
+
+  return observed;
+}
+
+static void
+gst_net_client_clock_send_burst (GstNetClientClock * self)
+{
+  GstNetClientClockPrivate *priv = self->priv;
+  GstNetTimePacket *packet;
+  GSocketAddress *servaddr;
+  gboolean changed;
+  guint i, burst_size;
+
+  GST_OBJECT_LOCK (self);
+  changed = priv->servers_changed;
+  burst_size = priv->burst_size;
+  GST_OBJECT_UNLOCK (self);
+
+  if (changed)
+    gst_net_client_clock_update_servers (self);
+
+  servaddr = g_ptr_array_index (priv->servers, priv->current_server);
+
+  packet = gst_net_time_packet_new (NULL);
+
+  for (i = 0; i < burst_size; i++) {
+    packet->local_time = gst_clock_get_internal_time (GST_CLOCK (self));
+
+    GST_DEBUG_OBJECT (self,
+        "sending packet, local time = %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (packet->local_time));
+
+    if (gst_net_time_packet_send (packet, priv->socket, servaddr, NULL))
+      priv->burst_sent++;
+  }
+
+  g_free (packet);
+
+  /* reset timeout (but are expecting a response sooner anyway) */
+  priv->timeout_expiration =
+      gst_util_get_timestamp () + gst_clock_get_timeout (GST_CLOCK (self));
+}
+
 static gpointer
 gst_net_client_clock_thread (gpointer data)
 {
@@ -255,10 +605,14 @@ gst_net_client_clock_thread (gpointer data)
   GstNetTimePacket *packet;
   GSocket *socket = self->priv->socket;
   GError *err = NULL;
-  GstClock *clock = data;
+  GSocketAddress *srcaddr = NULL;
 
   GST_INFO_OBJECT (self, "net client clock thread running, socket=%p", socket);
 
+  self->priv->servers = g_ptr_array_new_with_free_func (g_object_unref);
+  g_ptr_array_add (self->priv->servers, g_object_ref (self->priv->servaddr));
+  gst_net_client_clock_update_servers (self);
+
   g_socket_set_blocking (socket, TRUE);
   g_socket_set_timeout (socket, 0);
 
@@ -283,25 +637,12 @@ gst_net_client_clock_thread (gpointer data)
         g_clear_error (&err);
         break;
       } else if (err->code == G_IO_ERROR_TIMED_OUT) {
-        /* timed out, let's send another packet */
+        /* timed out, use what we got from the last burst or send another
+         * one */
         GST_DEBUG_OBJECT (self, "timed out");
 
-        packet = gst_net_time_packet_new (NULL);
-
-        packet->local_time = gst_clock_get_internal_time (GST_CLOCK (self));
-
-        GST_DEBUG_OBJECT (self,
-            "sending packet, local time = %" GST_TIME_FORMAT,
-            GST_TIME_ARGS (packet->local_time));
-
-        gst_net_time_packet_send (packet, self->priv->socket,
-            self->priv->servaddr, NULL);
-
-        g_free (packet);
-
-        /* reset timeout (but are expecting a response sooner anyway) */
-        self->priv->timeout_expiration =
-            gst_util_get_timestamp () + gst_clock_get_timeout (clock);
+        if (!gst_net_client_clock_finish_burst (self))
+          gst_net_client_clock_send_burst (self);
       } else {
         GST_DEBUG_OBJECT (self, "socket error: %s", err->message);
         g_usleep (G_USEC_PER_SEC / 10); /* throttle */
@@ -314,9 +655,14 @@ gst_net_client_clock_thread (gpointer data)
 
       new_local = gst_clock_get_internal_time (GST_CLOCK (self));
 
-      packet = gst_net_time_packet_receive (socket, NULL, &err);
+      packet = gst_net_time_packet_receive (socket, &srcaddr, &err);
 
-      if (packet != NULL) {
+      if (packet != NULL && !gst_net_client_clock_is_current_server (self,
+              srcaddr)) {
+        /* a late reply of a provider we switched away from */
+        GST_DEBUG_OBJECT (self, "ignoring packet from another server");
+        g_free (packet);
+      } else if (packet != NULL) {
         GST_LOG_OBJECT (self, "got packet back");
         GST_LOG_OBJECT (self, "local_1 = %" GST_TIME_FORMAT,
             GST_TIME_ARGS (packet->local_time));
@@ -325,18 +671,28 @@ gst_net_client_clock_thread (gpointer data)
         GST_LOG_OBJECT (self, "local_2 = %" GST_TIME_FORMAT,
             GST_TIME_ARGS (new_local));
 
-        /* observe_times will reset the timeout */
-        gst_net_client_clock_observe_times (self, packet->local_time,
+        gst_net_client_clock_add_sample (self, packet->local_time,
             packet->remote_time, new_local);
 
+        /* all replies of the burst are in */
+        if (self->priv->burst_received >= self->priv->burst_sent)
+          gst_net_client_clock_finish_burst (self);
+
         g_free (packet);
       } else if (err != NULL) {
         GST_WARNING_OBJECT (self, "receive error: %s", err->message);
         g_clear_error (&err);
       }
+      if (srcaddr) {
+        g_object_unref (srcaddr);
+        srcaddr = NULL;
+      }
     }
   }
 
+  g_ptr_array_free (self->priv->servers, TRUE);
+  self->priv->servers = NULL;
+
   GST_INFO_OBJECT (self, "shutting down net client clock thread");
   return NULL;
 }
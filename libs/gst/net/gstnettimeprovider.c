@@ -32,6 +32,10 @@
  *
  * The #GstNetTimeProvider typically wraps the clock used by a #GstPipeline.
  *
+ * On systems with recvmmsg() the provider answers all pending requests with
+ * one system call and, when the kernel supports it, uses the time at which
+ * the kernel received a request as the time of the reply.
+ *
  * Last reviewed on 2005-11-23 (0.9.5)
  */
 
@@ -42,6 +46,14 @@
 #include "gstnettimeprovider.h"
 #include "gstnettimepacket.h"
 
+#ifdef HAVE_RECVMMSG
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#endif
+
 GST_DEBUG_CATEGORY_STATIC (ntp_debug);
 #define GST_CAT_DEFAULT (ntp_debug)
 
@@ -50,6 +62,9 @@ GST_DEBUG_CATEGORY_STATIC (ntp_debug);
 
 #define IS_ACTIVE(self) (g_atomic_int_get (&((self)->priv->active)))
 
+/* number of requests handled per recvmmsg() call */
+#define BATCH_SIZE              64
+
 enum
 {
   PROP_0,
@@ -75,6 +90,9 @@ struct _GstNetTimeProviderPrivate
 
   GSocket *socket;
   GCancellable *cancel;
+
+  /* the socket reports kernel receive times */
+  gboolean kernel_timestamps;
 };
 
 static gboolean gst_net_time_provider_start (GstNetTimeProvider * bself);
@@ -159,6 +177,131 @@ gst_net_time_provider_finalize (GObject * object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+#ifdef HAVE_RECVMMSG
+/* the receive time of a request in the time of our clock, when the kernel
+ * gave us one. @now is the clock time taken after the batch was received */
+static GstClockTime
+gst_net_time_provider_kernel_time (GstNetTimeProvider * self,
+    struct msghdr *msg, GstClockTime now, GstClockTime realtime)
+{
+#ifdef SO_TIMESTAMPNS
+  struct cmsghdr *cmsg;
+
+  if (!self->priv->kernel_timestamps)
+    return now;
+
+  for (cmsg = CMSG_FIRSTHDR (msg); cmsg; cmsg = CMSG_NXTHDR (msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      struct timespec ts;
+      GstClockTime received, age;
+
+      memcpy (&ts, CMSG_DATA (cmsg), sizeof (ts));
+      received = GST_TIMESPEC_TO_TIME (ts);
+
+      /* the kernel timestamps are in realtime, only use the time that
+       * passed since the packet arrived */
+      if (received > realtime)
+        return now;
+      age = realtime - received;
+      if (age > now || age > GST_SECOND)
+        return now;
+
+      return now - age;
+    }
+  }
+#endif
+
+  return now;
+}
+
+/* answers all pending requests, returns FALSE when recvmmsg() can't be used
+ * on this socket */
+static gboolean
+gst_net_time_provider_serve_batch (GstNetTimeProvider * self, GSocket * socket)
+{
+  struct mmsghdr msgs[BATCH_SIZE];
+  struct iovec iovs[BATCH_SIZE];
+  struct sockaddr_storage addrs[BATCH_SIZE];
+  guint8 buffers[BATCH_SIZE][GST_NET_TIME_PACKET_SIZE];
+  gchar control[BATCH_SIZE][CMSG_SPACE (sizeof (struct timespec))];
+  struct timespec rt;
+  GstClockTime now, realtime;
+  gint fd, n, i, count;
+
+  fd = g_socket_get_fd (socket);
+
+  memset (msgs, 0, sizeof (msgs));
+  for (i = 0; i < BATCH_SIZE; i++) {
+    iovs[i].iov_base = buffers[i];
+    iovs[i].iov_len = GST_NET_TIME_PACKET_SIZE;
+    msgs[i].msg_hdr.msg_iov = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+    msgs[i].msg_hdr.msg_name = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof (addrs[i]);
+    msgs[i].msg_hdr.msg_control = control[i];
+    msgs[i].msg_hdr.msg_controllen = sizeof (control[i]);
+  }
+
+  n = recvmmsg (fd, msgs, BATCH_SIZE, MSG_DONTWAIT, NULL);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+      return TRUE;
+    GST_DEBUG_OBJECT (self, "recvmmsg failed: %s", g_strerror (errno));
+    if (errno == ENOSYS)
+      return FALSE;
+    g_usleep (G_USEC_PER_SEC / 10);
+    return TRUE;
+  }
+
+  now = gst_clock_get_time (self->priv->clock);
+  clock_gettime (CLOCK_REALTIME, &rt);
+  realtime = GST_TIMESPEC_TO_TIME (rt);
+
+  GST_LOG_OBJECT (self, "received %d requests", n);
+
+  if (!IS_ACTIVE (self))
+    return TRUE;
+
+  /* answer in place, dropping short packets */
+  for (i = 0, count = 0; i < n; i++) {
+    GstClockTime remote;
+
+    if (msgs[i].msg_len < GST_NET_TIME_PACKET_SIZE) {
+      GST_DEBUG_OBJECT (self, "someone sent us a short packet (%u < %d)",
+          msgs[i].msg_len, GST_NET_TIME_PACKET_SIZE);
+      continue;
+    }
+
+    remote = gst_net_time_provider_kernel_time (self, &msgs[i].msg_hdr, now,
+        realtime);
+    GST_WRITE_UINT64_BE (buffers[i] + sizeof (GstClockTime), remote);
+
+    if (count != i) {
+      msgs[count] = msgs[i];
+      iovs[count] = iovs[i];
+      msgs[count].msg_hdr.msg_iov = &iovs[count];
+    }
+    msgs[count].msg_hdr.msg_control = NULL;
+    msgs[count].msg_hdr.msg_controllen = 0;
+    msgs[count].msg_hdr.msg_flags = 0;
+    count++;
+  }
+
+#ifdef HAVE_SENDMMSG
+  /* ignore errors, the clients will ask again */
+  if (count > 0 && sendmmsg (fd, msgs, count, MSG_DONTWAIT) < 0)
+    GST_DEBUG_OBJECT (self, "sendmmsg failed: %s", g_strerror (errno));
+#else
+  for (i = 0; i < count; i++) {
+    if (sendmsg (fd, &msgs[i].msg_hdr, MSG_DONTWAIT) < 0)
+      GST_DEBUG_OBJECT (self, "sendmsg failed: %s", g_strerror (errno));
+  }
+#endif
+
+  return TRUE;
+}
+#endif
+
 static gpointer
 gst_net_time_provider_thread (gpointer data)
 {
@@ -167,6 +310,9 @@ gst_net_time_provider_thread (gpointer data)
   GSocket *socket = self->priv->socket;
   GstNetTimePacket *packet;
   GError *err = NULL;
+#ifdef HAVE_RECVMMSG
+  gboolean batch = TRUE;
+#endif
 
   GST_INFO_OBJECT (self, "time provider thread is running");
 
@@ -187,6 +333,16 @@ gst_net_time_provider_thread (gpointer data)
       continue;
     }
 
+#ifdef HAVE_RECVMMSG
+    if (batch) {
+      if (gst_net_time_provider_serve_batch (self, socket))
+        continue;
+
+      GST_INFO_OBJECT (self, "recvmmsg unusable, receiving one by one");
+      batch = FALSE;
+    }
+#endif
+
     /* got data in */
     packet = gst_net_time_packet_receive (socket, &sender_addr, &err);
 
@@ -204,9 +360,9 @@ gst_net_time_provider_thread (gpointer data)
 
       /* ignore errors */
       gst_net_time_packet_send (packet, socket, sender_addr, NULL);
-      g_object_unref (sender_addr);
-      g_free (packet);
     }
+    g_object_unref (sender_addr);
+    g_free (packet);
   }
 
   if (err != NULL)
@@ -310,6 +466,18 @@ gst_net_time_provider_start (GstNetTimeProvider * self)
   GST_DEBUG_OBJECT (self, "bound on UDP port %d", port);
   g_object_unref (bound_addr);
 
+#if defined (HAVE_RECVMMSG) && defined (SO_TIMESTAMPNS)
+  {
+    gint on = 1;
+
+    self->priv->kernel_timestamps =
+        setsockopt (g_socket_get_fd (socket), SOL_SOCKET, SO_TIMESTAMPNS, &on,
+        sizeof (on)) == 0;
+    GST_DEBUG_OBJECT (self, "kernel timestamps %s",
+        self->priv->kernel_timestamps ? "enabled" : "not supported");
+  }
+#endif
+
   if (port != self->priv->port) {
     self->priv->port = port;
     GST_DEBUG_OBJECT (self, "notifying port %d", port);
@@ -74,6 +74,7 @@ static void gst_capsfilter_set_property (GObject * object, guint prop_id,
 static void gst_capsfilter_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
 static void gst_capsfilter_dispose (GObject * object);
+static void gst_capsfilter_clear_cache (GstCapsFilter * capsfilter);
 
 static GstCaps *gst_capsfilter_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter);
@@ -83,6 +84,8 @@ static GstFlowReturn gst_capsfilter_transform_ip (GstBaseTransform * base,
     GstBuffer * buf);
 static GstFlowReturn gst_capsfilter_prepare_buf (GstBaseTransform * trans,
     GstBuffer * input, GstBuffer ** buf);
+static gboolean gst_capsfilter_src_event (GstBaseTransform * trans,
+    GstEvent * event);
 
 static void
 gst_capsfilter_class_init (GstCapsFilterClass * klass)
@@ -121,6 +124,7 @@ gst_capsfilter_class_init (GstCapsFilterClass * klass)
   trans_class->accept_caps = GST_DEBUG_FUNCPTR (gst_capsfilter_accept_caps);
   trans_class->prepare_output_buffer =
       GST_DEBUG_FUNCPTR (gst_capsfilter_prepare_buf);
+  trans_class->src_event = GST_DEBUG_FUNCPTR (gst_capsfilter_src_event);
 }
 
 static void
@@ -154,6 +158,7 @@ gst_capsfilter_set_property (GObject * object, guint prop_id,
       GST_OBJECT_LOCK (capsfilter);
       old_caps = capsfilter->filter_caps;
       capsfilter->filter_caps = new_caps;
+      gst_capsfilter_clear_cache (capsfilter);
       GST_OBJECT_UNLOCK (capsfilter);
 
       gst_caps_unref (old_caps);
@@ -193,10 +198,30 @@ gst_capsfilter_dispose (GObject * object)
   GstCapsFilter *filter = GST_CAPSFILTER (object);
 
   gst_caps_replace (&filter->filter_caps, NULL);
+  gst_capsfilter_clear_cache (filter);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
+/* call with the object lock */
+static void
+gst_capsfilter_clear_cache (GstCapsFilter * capsfilter)
+{
+  gst_caps_replace (&capsfilter->cached_caps, NULL);
+  gst_caps_replace (&capsfilter->cached_filter, NULL);
+  gst_caps_replace (&capsfilter->cached_result, NULL);
+}
+
+static gboolean
+gst_capsfilter_caps_equal (GstCaps * caps1, GstCaps * caps2)
+{
+  if (caps1 == caps2)
+    return TRUE;
+  if (caps1 == NULL || caps2 == NULL)
+    return FALSE;
+  return gst_caps_is_strictly_equal (caps1, caps2);
+}
+
 static GstCaps *
 gst_capsfilter_transform_caps (GstBaseTransform * base,
     GstPadDirection direction, GstCaps * caps, GstCaps * filter)
@@ -205,6 +230,16 @@ gst_capsfilter_transform_caps (GstBaseTransform * base,
   GstCaps *ret, *filter_caps, *tmp;
 
   GST_OBJECT_LOCK (capsfilter);
+  /* the same caps are queried again and again during negotiation */
+  if (capsfilter->cached_result && capsfilter->cached_direction == direction
+      && gst_capsfilter_caps_equal (capsfilter->cached_caps, caps)
+      && gst_capsfilter_caps_equal (capsfilter->cached_filter, filter)) {
+    ret = gst_caps_ref (capsfilter->cached_result);
+    GST_OBJECT_UNLOCK (capsfilter);
+
+    GST_LOG_OBJECT (capsfilter, "using cached result %" GST_PTR_FORMAT, ret);
+    return ret;
+  }
   filter_caps = gst_caps_ref (capsfilter->filter_caps);
   GST_OBJECT_UNLOCK (capsfilter);
 
@@ -215,7 +250,17 @@ gst_capsfilter_transform_caps (GstBaseTransform * base,
     filter_caps = tmp;
   }
 
-  ret = gst_caps_intersect_full (filter_caps, caps, GST_CAPS_INTERSECT_FIRST);
+  /* with fixed filter caps the result is the filter caps when they are a
+   * subset of the input caps and empty when they don't intersect at all */
+  if (gst_caps_is_fixed (filter_caps)
+      && gst_caps_is_subset (filter_caps, caps)) {
+    ret = gst_caps_ref (filter_caps);
+  } else if (gst_caps_is_fixed (filter_caps)
+      && !gst_caps_can_intersect (filter_caps, caps)) {
+    ret = gst_caps_new_empty ();
+  } else {
+    ret = gst_caps_intersect_full (filter_caps, caps, GST_CAPS_INTERSECT_FIRST);
+  }
 
   GST_DEBUG_OBJECT (capsfilter, "input:     %" GST_PTR_FORMAT, caps);
   GST_DEBUG_OBJECT (capsfilter, "filter:    %" GST_PTR_FORMAT, filter);
@@ -225,6 +270,14 @@ gst_capsfilter_transform_caps (GstBaseTransform * base,
 
   gst_caps_unref (filter_caps);
 
+  GST_OBJECT_LOCK (capsfilter);
+  gst_capsfilter_clear_cache (capsfilter);
+  capsfilter->cached_direction = direction;
+  capsfilter->cached_caps = gst_caps_ref (caps);
+  capsfilter->cached_filter = filter ? gst_caps_ref (filter) : NULL;
+  capsfilter->cached_result = gst_caps_ref (ret);
+  GST_OBJECT_UNLOCK (capsfilter);
+
   return ret;
 }
 
@@ -260,6 +313,21 @@ gst_capsfilter_accept_caps (GstBaseTransform * base,
   return ret;
 }
 
+static gboolean
+gst_capsfilter_src_event (GstBaseTransform * trans, GstEvent * event)
+{
+  GstCapsFilter *capsfilter = GST_CAPSFILTER (trans);
+
+  /* don't keep the caps of the old configuration alive when renegotiating */
+  if (GST_EVENT_TYPE (event) == GST_EVENT_RECONFIGURE) {
+    GST_OBJECT_LOCK (capsfilter);
+    gst_capsfilter_clear_cache (capsfilter);
+    GST_OBJECT_UNLOCK (capsfilter);
+  }
+
+  return GST_BASE_TRANSFORM_CLASS (parent_class)->src_event (trans, event);
+}
+
 static GstFlowReturn
 gst_capsfilter_transform_ip (GstBaseTransform * base, GstBuffer * buf)
 {
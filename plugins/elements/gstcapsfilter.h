@@ -53,6 +53,12 @@ struct _GstCapsFilter {
   GstBaseTransform trans;
 
   GstCaps *filter_caps;
+
+  /* last result of transform_caps, protected with the object lock */
+  GstPadDirection cached_direction;
+  GstCaps *cached_caps;
+  GstCaps *cached_filter;
+  GstCaps *cached_result;
 };
 
 struct _GstCapsFilterClass {
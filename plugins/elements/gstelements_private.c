@@ -0,0 +1,352 @@
+/* GStreamer
+ *
+ * gstelements_private.c: shared helpers for the core elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#ifdef HAVE_UNISTD_H
+#  include <unistd.h>
+#endif
+#ifdef HAVE_SYS_UIO_H
+#  include <sys/uio.h>
+#endif
+#ifdef G_OS_WIN32
+#  include <io.h>               /* write */
+#endif
+#include <limits.h>
+
+#include "gstelements_private.h"
+
+#ifndef HAVE_SYS_UIO_H
+struct iovec
+{
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+/* up to this many memory blocks the vectors are kept on the stack */
+#define GST_WRITEV_STACK_VECS 64
+
+/* write out @vecs, retrying on interruption, waiting for the fd to become
+ * writable when it would block and continuing after partial writes. Returns
+ * the number of bytes written or -1 on error, in which case errno is set */
+static gssize
+gst_writev (gint fd, struct iovec *vecs, guint n_vecs)
+{
+  GstPoll *fdset = NULL;
+  GstPollFD pollfd = GST_POLL_FD_INIT;
+  gssize written = 0;
+
+  while (n_vecs > 0) {
+    gssize ret;
+
+#ifdef HAVE_SYS_UIO_H
+    ret = writev (fd, vecs, MIN (n_vecs, IOV_MAX));
+#else
+    ret = write (fd, vecs->iov_base, vecs->iov_len);
+#endif
+    if (G_UNLIKELY (ret < 0)) {
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN)
+        goto error;
+
+      /* the fd is non-blocking, wait until it can take more data */
+      if (fdset == NULL) {
+        fdset = gst_poll_new (FALSE);
+        pollfd.fd = fd;
+        gst_poll_add_fd (fdset, &pollfd);
+        gst_poll_fd_ctl_write (fdset, &pollfd, TRUE);
+      }
+      if (gst_poll_wait (fdset, GST_CLOCK_TIME_NONE) < 0 && errno != EINTR &&
+          errno != EAGAIN)
+        goto error;
+      continue;
+    }
+
+    written += ret;
+
+    /* skip all vectors that were written completely and move into the one
+     * that was partially written, if any */
+    while (n_vecs > 0 && (gsize) ret >= vecs->iov_len) {
+      ret -= vecs->iov_len;
+      vecs++;
+      n_vecs--;
+    }
+    if (ret > 0) {
+      vecs->iov_base = (guint8 *) vecs->iov_base + ret;
+      vecs->iov_len -= ret;
+    }
+  }
+
+  if (fdset)
+    gst_poll_free (fdset);
+
+  return written;
+
+error:
+  {
+    gint save_errno = errno;
+
+    if (fdset)
+      gst_poll_free (fdset);
+    errno = save_errno;
+    return -1;
+  }
+}
+
+/* map the memory blocks of @buffers, skipping the first @offset bytes, into
+ * @vecs and @maps which must have room for all of them. The number of
+ * vectors is stored in @n_vecs_out. Returns FALSE with errno set and nothing
+ * mapped when a memory block can't be mapped */
+static gboolean
+gst_writev_map_buffers (GstObject * sink, GstBuffer ** buffers,
+    guint num_buffers, gsize offset, struct iovec *vecs, GstMapInfo * maps,
+    guint * n_vecs_out)
+{
+  guint i, j, n_vecs = 0;
+
+  for (i = 0; i < num_buffers; i++) {
+    for (j = 0; j < gst_buffer_n_memory (buffers[i]); j++) {
+      GstMemory *mem = gst_buffer_peek_memory (buffers[i], j);
+
+      if (G_UNLIKELY (!gst_memory_map (mem, &maps[n_vecs], GST_MAP_READ)))
+        goto map_failed;
+
+      if (maps[n_vecs].size <= offset) {
+        offset -= maps[n_vecs].size;
+        gst_memory_unmap (mem, &maps[n_vecs]);
+        continue;
+      }
+      vecs[n_vecs].iov_base = maps[n_vecs].data + offset;
+      vecs[n_vecs].iov_len = maps[n_vecs].size - offset;
+      offset = 0;
+      n_vecs++;
+    }
+  }
+  *n_vecs_out = n_vecs;
+
+  return TRUE;
+
+  /* ERRORS */
+map_failed:
+  {
+    GST_WARNING_OBJECT (sink, "could not map memory %u of buffer %p", j,
+        buffers[i]);
+    for (i = 0; i < n_vecs; i++)
+      gst_memory_unmap (maps[i].memory, &maps[i]);
+    errno = EFAULT;
+    return FALSE;
+  }
+}
+
+static guint
+gst_writev_count_memory (GstBuffer ** buffers, guint num_buffers)
+{
+  guint i, n_mem = 0;
+
+  for (i = 0; i < num_buffers; i++)
+    n_mem += gst_buffer_n_memory (buffers[i]);
+
+  return n_mem;
+}
+
+/**
+ * gst_writev_buffers:
+ * @sink: the object writing, for debugging
+ * @fd: the file descriptor to write to
+ * @buffers: the buffers to write
+ * @num_buffers: the number of buffers in @buffers
+ * @bytes_written: (out): location for the amount of bytes written
+ *
+ * Write all the memory blocks of @buffers to @fd in as few syscalls as
+ * possible. Partial writes are completed before returning.
+ *
+ * Returns: #GST_FLOW_OK on success or #GST_FLOW_ERROR with errno set when
+ * a memory block can't be mapped or writing failed.
+ */
+GstFlowReturn
+gst_writev_buffers (GstObject * sink, gint fd, GstBuffer ** buffers,
+    guint num_buffers, guint64 * bytes_written)
+{
+  struct iovec *vecs;
+  GstMapInfo *maps;
+  guint i, n_vecs, n_mem;
+  gssize ret;
+  gint save_errno = 0;
+
+  n_mem = gst_writev_count_memory (buffers, num_buffers);
+  if (n_mem <= GST_WRITEV_STACK_VECS) {
+    vecs = g_newa (struct iovec, n_mem);
+    maps = g_newa (GstMapInfo, n_mem);
+  } else {
+    vecs = g_new (struct iovec, n_mem);
+    maps = g_new (GstMapInfo, n_mem);
+  }
+
+  if (G_UNLIKELY (!gst_writev_map_buffers (sink, buffers, num_buffers, 0,
+              vecs, maps, &n_vecs))) {
+    save_errno = errno;
+    ret = -1;
+    goto done;
+  }
+
+  GST_LOG_OBJECT (sink, "writing %u buffers in %u vectors to fd %d",
+      num_buffers, n_vecs, fd);
+
+  ret = gst_writev (fd, vecs, n_vecs);
+  if (ret < 0)
+    save_errno = errno;
+
+  for (i = 0; i < n_vecs; i++)
+    gst_memory_unmap (maps[i].memory, &maps[i]);
+
+done:
+  if (n_mem > GST_WRITEV_STACK_VECS) {
+    g_free (vecs);
+    g_free (maps);
+  }
+
+  if (G_UNLIKELY (ret < 0)) {
+    GST_DEBUG_OBJECT (sink, "writev failed: %s", g_strerror (save_errno));
+    errno = save_errno;
+    return GST_FLOW_ERROR;
+  }
+
+  if (bytes_written)
+    *bytes_written = ret;
+
+  return GST_FLOW_OK;
+}
+
+/**
+ * gst_writev_buffers_once:
+ * @sink: the object writing, for debugging
+ * @fd: the file descriptor to write to
+ * @buffers: the buffers to write
+ * @num_buffers: the number of buffers in @buffers
+ * @offset: the number of bytes of @buffers that were already written
+ *
+ * Write the memory blocks of @buffers after @offset to @fd with a single
+ * writev() call. Unlike gst_writev_buffers() this returns after a partial
+ * write, which is what callers writing to non-blocking file descriptors or
+ * waiting for the fd themselves need.
+ *
+ * Returns: the number of bytes written or -1 with errno set, also when a
+ * memory block can't be mapped.
+ */
+gssize
+gst_writev_buffers_once (GstObject * sink, gint fd, GstBuffer ** buffers,
+    guint num_buffers, gsize offset)
+{
+  struct iovec *vecs;
+  GstMapInfo *maps;
+  guint i, n_vecs, n_mem;
+  gssize ret;
+  gint save_errno = 0;
+
+  n_mem = gst_writev_count_memory (buffers, num_buffers);
+  if (n_mem <= GST_WRITEV_STACK_VECS) {
+    vecs = g_newa (struct iovec, n_mem);
+    maps = g_newa (GstMapInfo, n_mem);
+  } else {
+    vecs = g_new (struct iovec, n_mem);
+    maps = g_new (GstMapInfo, n_mem);
+  }
+
+  if (G_UNLIKELY (!gst_writev_map_buffers (sink, buffers, num_buffers, offset,
+              vecs, maps, &n_vecs))) {
+    save_errno = errno;
+    ret = -1;
+    goto done;
+  }
+
+  GST_LOG_OBJECT (sink, "writing %u buffers in %u vectors to fd %d",
+      num_buffers, n_vecs, fd);
+
+  if (n_vecs == 0) {
+    ret = 0;
+  } else {
+#ifdef HAVE_SYS_UIO_H
+    ret = writev (fd, vecs, MIN (n_vecs, IOV_MAX));
+#else
+    ret = write (fd, vecs->iov_base, vecs->iov_len);
+#endif
+    if (ret < 0)
+      save_errno = errno;
+  }
+
+  for (i = 0; i < n_vecs; i++)
+    gst_memory_unmap (maps[i].memory, &maps[i]);
+
+done:
+  if (n_mem > GST_WRITEV_STACK_VECS) {
+    g_free (vecs);
+    g_free (maps);
+  }
+
+  if (G_UNLIKELY (ret < 0))
+    errno = save_errno;
+
+  return ret;
+}
+
+/* Add @n_buffers to the minimum and maximum of all pools in the
+ * ALLOCATION @query. Elements that keep buffers, like the queues, use this so
+ * that the pools upstream are large enough for their downstream peer and for
+ * the buffers that are held by @element. */
+void
+gst_allocation_pools_add_buffers (GstObject * element, GstQuery * query,
+    guint n_buffers)
+{
+  guint i, n_pools;
+
+  if (n_buffers == 0)
+    return;
+
+  n_pools = gst_query_get_n_allocation_pools (query);
+  for (i = 0; i < n_pools; i++) {
+    GstBufferPool *pool;
+    guint size, min, max;
+
+    gst_query_parse_nth_allocation_pool (query, i, &pool, &size, &min, &max);
+
+    min += n_buffers;
+    /* a maximum of 0 means unlimited */
+    if (max != 0)
+      max = MAX (max + n_buffers, min);
+
+    GST_DEBUG_OBJECT (element, "pool %u: min %u max %u after adding %u "
+        "buffers", i, min, max, n_buffers);
+
+    gst_query_set_nth_allocation_pool (query, i, pool, size, min, max);
+    if (pool)
+      gst_object_unref (pool);
+  }
+}
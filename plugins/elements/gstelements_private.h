@@ -0,0 +1,45 @@
+/* GStreamer
+ *
+ * gstelements_private.h: shared helpers for the core elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_ELEMENTS_PRIVATE_H__
+#define __GST_ELEMENTS_PRIVATE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL
+GstFlowReturn   gst_writev_buffers (GstObject * sink, gint fd,
+                                    GstBuffer ** buffers, guint num_buffers,
+                                    guint64 * bytes_written);
+
+G_GNUC_INTERNAL
+gssize          gst_writev_buffers_once (GstObject * sink, gint fd,
+                                         GstBuffer ** buffers,
+                                         guint num_buffers, gsize offset);
+
+G_GNUC_INTERNAL
+void            gst_allocation_pools_add_buffers (GstObject * element,
+                                                  GstQuery * query,
+                                                  guint n_buffers);
+
+G_END_DECLS
+
+#endif /* __GST_ELEMENTS_PRIVATE_H__ */
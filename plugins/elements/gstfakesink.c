@@ -67,6 +67,8 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_CAN_ACTIVATE_PULL FALSE
 #define DEFAULT_NUM_BUFFERS -1
+#define DEFAULT_ENABLE_STATS FALSE
+#define DEFAULT_STATS_INTERVAL 0
 
 enum
 {
@@ -78,7 +80,10 @@ enum
   PROP_LAST_MESSAGE,
   PROP_CAN_ACTIVATE_PUSH,
   PROP_CAN_ACTIVATE_PULL,
-  PROP_NUM_BUFFERS
+  PROP_NUM_BUFFERS,
+  PROP_ENABLE_STATS,
+  PROP_STATS_INTERVAL,
+  PROP_STATS
 };
 
 #define GST_TYPE_FAKE_SINK_STATE_ERROR (gst_fake_sink_state_error_get_type())
@@ -136,6 +141,8 @@ static guint gst_fake_sink_signals[LAST_SIGNAL] = { 0 };
 
 static GParamSpec *pspec_last_message = NULL;
 
+static GstStructure *gst_fake_sink_create_stats (GstFakeSink * sink);
+
 static void
 gst_fake_sink_class_init (GstFakeSinkClass * klass)
 {
@@ -157,7 +164,7 @@ gst_fake_sink_class_init (GstFakeSinkClass * klass)
           DEFAULT_STATE_ERROR, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   pspec_last_message = g_param_spec_string ("last-message", "Last Message",
       "The message describing current status", DEFAULT_LAST_MESSAGE,
-      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READABLE | GST_PARAM_HIGH_FREQUENCY | G_PARAM_STATIC_STRINGS);
   g_object_class_install_property (gobject_class, PROP_LAST_MESSAGE,
       pspec_last_message);
   g_object_class_install_property (gobject_class, PROP_SIGNAL_HANDOFFS,
@@ -185,6 +192,51 @@ gst_fake_sink_class_init (GstFakeSinkClass * klass)
       g_param_spec_int ("num-buffers", "num-buffers",
           "Number of buffers to accept going EOS", -1, G_MAXINT,
           DEFAULT_NUM_BUFFERS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:enable-stats
+   *
+   * Count the rendered buffers and bytes and measure their latency, the
+   * difference between the running time of a buffer and the running time of
+   * the clock when it is rendered. The results are available in
+   * #GstFakeSink:stats.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_ENABLE_STATS,
+      g_param_spec_boolean ("enable-stats", "Enable Statistics",
+          "Collect throughput and latency statistics", DEFAULT_ENABLE_STATS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:stats-interval
+   *
+   * Post the statistics as an element message with the same structure as
+   * #GstFakeSink:stats at this interval, and once more on EOS. 0 disables
+   * the messages.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS_INTERVAL,
+      g_param_spec_uint64 ("stats-interval", "Statistics Interval",
+          "Interval for posting statistics messages in ns (0 = disabled)", 0,
+          G_MAXUINT64, DEFAULT_STATS_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSink:stats
+   *
+   * A "GstFakeSinkStats" structure with the statistics collected since
+   * going to PAUSED when #GstFakeSink:enable-stats is set:
+   * "buffers" and "bytes" (#guint64) rendered, "rate" and "byte-rate"
+   * (#gdouble) per second since the first buffer, and "latency-min",
+   * "latency-max", "latency-average", "latency-p50", "latency-p90" and
+   * "latency-p99" (#guint64, in ns, #GST_CLOCK_TIME_NONE when unknown). The
+   * percentiles are upper bounds with a power of 2 resolution.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Throughput and latency statistics", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstFakeSink::handoff:
@@ -242,6 +294,8 @@ gst_fake_sink_init (GstFakeSink * fakesink)
   fakesink->state_error = DEFAULT_STATE_ERROR;
   fakesink->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
   fakesink->num_buffers = DEFAULT_NUM_BUFFERS;
+  fakesink->enable_stats = DEFAULT_ENABLE_STATS;
+  fakesink->stats_interval = DEFAULT_STATS_INTERVAL;
 
   gst_base_sink_set_sync (GST_BASE_SINK (fakesink), DEFAULT_SYNC);
 }
@@ -252,6 +306,151 @@ gst_fake_sink_finalize (GObject * obj)
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
+/* with OBJECT_LOCK */
+static void
+gst_fake_sink_reset_stats (GstFakeSink * sink)
+{
+  sink->stats_start = GST_CLOCK_TIME_NONE;
+  sink->stats_last_post = GST_CLOCK_TIME_NONE;
+  sink->stats_buffers = 0;
+  sink->stats_bytes = 0;
+  sink->latency_count = 0;
+  sink->latency_sum = 0;
+  sink->latency_min = GST_CLOCK_TIME_NONE;
+  sink->latency_max = GST_CLOCK_TIME_NONE;
+  memset (sink->latency_hist, 0, sizeof (sink->latency_hist));
+}
+
+/* with OBJECT_LOCK */
+static GstClockTime
+gst_fake_sink_latency_percentile (GstFakeSink * sink, guint percent)
+{
+  guint64 target, count = 0;
+  guint i;
+
+  if (sink->latency_count == 0)
+    return GST_CLOCK_TIME_NONE;
+
+  target = (sink->latency_count * percent + 99) / 100;
+  for (i = 0; i < GST_FAKE_SINK_LATENCY_BUCKETS; i++) {
+    count += sink->latency_hist[i];
+    if (count >= target)
+      return MIN ((G_GUINT64_CONSTANT (1) << (i + 1)) * GST_USECOND,
+          sink->latency_max);
+  }
+  return sink->latency_max;
+}
+
+/* with OBJECT_LOCK */
+static GstStructure *
+gst_fake_sink_create_stats (GstFakeSink * sink)
+{
+  GstClockTime elapsed = 0, average = GST_CLOCK_TIME_NONE;
+  gdouble rate = 0.0, byte_rate = 0.0;
+
+  if (GST_CLOCK_TIME_IS_VALID (sink->stats_start))
+    elapsed = gst_util_get_timestamp () - sink->stats_start;
+  if (elapsed > 0) {
+    rate = (gdouble) sink->stats_buffers * GST_SECOND / elapsed;
+    byte_rate = (gdouble) sink->stats_bytes * GST_SECOND / elapsed;
+  }
+  if (sink->latency_count > 0)
+    average = sink->latency_sum / sink->latency_count;
+
+  return gst_structure_new ("GstFakeSinkStats",
+      "buffers", G_TYPE_UINT64, sink->stats_buffers,
+      "bytes", G_TYPE_UINT64, sink->stats_bytes,
+      "rate", G_TYPE_DOUBLE, rate,
+      "byte-rate", G_TYPE_DOUBLE, byte_rate,
+      "latency-min", G_TYPE_UINT64, sink->latency_min,
+      "latency-max", G_TYPE_UINT64, sink->latency_max,
+      "latency-average", G_TYPE_UINT64, average,
+      "latency-p50", G_TYPE_UINT64,
+      gst_fake_sink_latency_percentile (sink, 50),
+      "latency-p90", G_TYPE_UINT64,
+      gst_fake_sink_latency_percentile (sink, 90),
+      "latency-p99", G_TYPE_UINT64,
+      gst_fake_sink_latency_percentile (sink, 99), NULL);
+}
+
+static void
+gst_fake_sink_post_stats (GstFakeSink * sink, GstStructure * stats)
+{
+  gst_element_post_message (GST_ELEMENT_CAST (sink),
+      gst_message_new_element (GST_OBJECT_CAST (sink), stats));
+}
+
+static void
+gst_fake_sink_update_stats (GstFakeSink * sink, GstBuffer * buf)
+{
+  GstBaseSink *bsink = GST_BASE_SINK_CAST (sink);
+  GstStructure *stats = NULL;
+  GstClockTime now, ts, running_time, latency;
+  GstClockTime render_delay;
+  GstClock *clock;
+
+  now = gst_util_get_timestamp ();
+  render_delay = gst_base_sink_get_render_delay (bsink);
+
+  GST_OBJECT_LOCK (sink);
+  if (!sink->enable_stats) {
+    GST_OBJECT_UNLOCK (sink);
+    return;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID (sink->stats_start)) {
+    sink->stats_start = now;
+    sink->stats_last_post = now;
+  }
+  sink->stats_buffers++;
+  sink->stats_bytes += gst_buffer_get_size (buf);
+
+  /* latency of the buffer against the clock */
+  ts = GST_BUFFER_DTS (buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ts))
+    ts = GST_BUFFER_PTS (buf);
+  clock = GST_ELEMENT_CLOCK (sink);
+  if (clock && GST_CLOCK_TIME_IS_VALID (ts) &&
+      bsink->segment.format == GST_FORMAT_TIME &&
+      GST_CLOCK_TIME_IS_VALID (running_time =
+          gst_segment_to_running_time (&bsink->segment, GST_FORMAT_TIME,
+              ts))) {
+    GstClockTime clock_time = gst_clock_get_time (clock);
+    GstClockTime base_time = GST_ELEMENT_CAST (sink)->base_time;
+    guint64 usecs;
+    guint bucket;
+
+    running_time += render_delay;
+    if (clock_time > base_time + running_time)
+      latency = clock_time - base_time - running_time;
+    else
+      latency = 0;
+
+    sink->latency_count++;
+    sink->latency_sum += latency;
+    if (!GST_CLOCK_TIME_IS_VALID (sink->latency_min)
+        || latency < sink->latency_min)
+      sink->latency_min = latency;
+    if (!GST_CLOCK_TIME_IS_VALID (sink->latency_max)
+        || latency > sink->latency_max)
+      sink->latency_max = latency;
+
+    usecs = latency / GST_USECOND;
+    bucket = usecs > 0 ? g_bit_storage (usecs) - 1 : 0;
+    sink->latency_hist[MIN (bucket, GST_FAKE_SINK_LATENCY_BUCKETS - 1)]++;
+  }
+
+  if (sink->stats_interval > 0 &&
+      now - sink->stats_last_post >= sink->stats_interval) {
+    sink->stats_last_post = now;
+    stats = gst_fake_sink_create_stats (sink);
+  }
+  GST_OBJECT_UNLOCK (sink);
+
+  if (stats)
+    gst_fake_sink_post_stats (sink, stats);
+}
+
 static void
 gst_fake_sink_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -282,6 +481,16 @@ gst_fake_sink_set_property (GObject * object, guint prop_id,
     case PROP_NUM_BUFFERS:
       sink->num_buffers = g_value_get_int (value);
       break;
+    case PROP_ENABLE_STATS:
+      GST_OBJECT_LOCK (sink);
+      sink->enable_stats = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_STATS_INTERVAL:
+      GST_OBJECT_LOCK (sink);
+      sink->stats_interval = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -323,6 +532,21 @@ gst_fake_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_NUM_BUFFERS:
       g_value_set_int (value, sink->num_buffers);
       break;
+    case PROP_ENABLE_STATS:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_boolean (value, sink->enable_stats);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_STATS_INTERVAL:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_uint64 (value, sink->stats_interval);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_STATS:
+      GST_OBJECT_LOCK (sink);
+      g_value_take_boxed (value, gst_fake_sink_create_stats (sink));
+      GST_OBJECT_UNLOCK (sink);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -380,6 +604,18 @@ gst_fake_sink_event (GstBaseSink * bsink, GstEvent * event)
     gst_fake_sink_notify_last_message (sink);
   }
 
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    GstStructure *stats = NULL;
+
+    GST_OBJECT_LOCK (sink);
+    if (sink->enable_stats && sink->stats_interval > 0)
+      stats = gst_fake_sink_create_stats (sink);
+    GST_OBJECT_UNLOCK (sink);
+
+    if (stats)
+      gst_fake_sink_post_stats (sink, stats);
+  }
+
   return GST_BASE_SINK_CLASS (parent_class)->event (bsink, event);
 }
 
@@ -426,6 +662,9 @@ gst_fake_sink_render (GstBaseSink * bsink, GstBuffer * buf)
   if (sink->num_buffers_left != -1)
     sink->num_buffers_left--;
 
+  if (G_UNLIKELY (sink->enable_stats))
+    gst_fake_sink_update_stats (sink, buf);
+
   if (!sink->silent) {
     gchar dts_str[64], pts_str[64], dur_str[64];
     gchar flag_str[100];
@@ -547,6 +786,9 @@ gst_fake_sink_change_state (GstElement * element, GstStateChange transition)
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_READY_PAUSED)
         goto error;
       fakesink->num_buffers_left = fakesink->num_buffers;
+      GST_OBJECT_LOCK (fakesink);
+      gst_fake_sink_reset_stats (fakesink);
+      GST_OBJECT_UNLOCK (fakesink);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
       if (fakesink->state_error == FAKE_SINK_STATE_ERROR_PAUSED_PLAYING)
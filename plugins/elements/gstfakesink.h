@@ -67,6 +67,8 @@ typedef enum {
 typedef struct _GstFakeSink GstFakeSink;
 typedef struct _GstFakeSinkClass GstFakeSinkClass;
 
+#define GST_FAKE_SINK_LATENCY_BUCKETS 32
+
 /**
  * GstFakeSink:
  *
@@ -82,6 +84,20 @@ struct _GstFakeSink {
   gchar			*last_message;
   gint                  num_buffers;
   gint                  num_buffers_left;
+
+  /* statistics, protected by the OBJECT_LOCK */
+  gboolean              enable_stats;
+  GstClockTime          stats_interval;
+  GstClockTime          stats_start;
+  GstClockTime          stats_last_post;
+  guint64               stats_buffers;
+  guint64               stats_bytes;
+  guint64               latency_count;
+  GstClockTime          latency_sum;
+  GstClockTime          latency_min;
+  GstClockTime          latency_max;
+  /* bucket i counts latencies of [2^i, 2^(i+1)) microseconds */
+  guint64               latency_hist[GST_FAKE_SINK_LATENCY_BUCKETS];
 };
 
 struct _GstFakeSinkClass {
@@ -86,6 +86,11 @@ enum
 #define DEFAULT_CAN_ACTIVATE_PULL TRUE
 #define DEFAULT_CAN_ACTIVATE_PUSH TRUE
 #define DEFAULT_FORMAT          GST_FORMAT_BYTES
+#define DEFAULT_GENERATE_LISTS  0
+#define DEFAULT_USE_POOL        FALSE
+#define DEFAULT_RATE            0.0
+#define DEFAULT_BURST           1
+#define DEFAULT_JITTER          0
 
 enum
 {
@@ -109,6 +114,11 @@ enum
   PROP_CAN_ACTIVATE_PUSH,
   PROP_IS_LIVE,
   PROP_FORMAT,
+  PROP_GENERATE_LISTS,
+  PROP_USE_POOL,
+  PROP_RATE,
+  PROP_BURST,
+  PROP_JITTER,
   PROP_LAST,
 };
 
@@ -285,7 +295,7 @@ gst_fake_src_class_init (GstFakeSrcClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   pspec_last_message = g_param_spec_string ("last-message", "last-message",
       "The last status message", NULL,
-      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READABLE | GST_PARAM_HIGH_FREQUENCY | G_PARAM_STATIC_STRINGS);
   g_object_class_install_property (gobject_class, PROP_LAST_MESSAGE,
       pspec_last_message);
   g_object_class_install_property (gobject_class, PROP_SILENT,
@@ -320,6 +330,74 @@ gst_fake_src_class_init (GstFakeSrcClass * klass)
       g_param_spec_enum ("format", "Format",
           "The format of the segment events", GST_TYPE_FORMAT,
           DEFAULT_FORMAT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSrc:generate-lists
+   *
+   * Push buffer lists with this many buffers instead of single buffers. Each
+   * list counts as one buffer for #GstBaseSrc:num-buffers. Only used in push
+   * mode.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_GENERATE_LISTS,
+      g_param_spec_uint ("generate-lists", "Generate lists",
+          "Push buffer lists with this many buffers (0 = push buffers)", 0,
+          G_MAXUINT, DEFAULT_GENERATE_LISTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSrc:use-pool
+   *
+   * Take the buffers from a #GstBufferPool with buffers of sizemax bytes
+   * instead of allocating new memory for each buffer. Only used for the
+   * allocate data method.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_POOL,
+      g_param_spec_boolean ("use-pool", "Use pool",
+          "Allocate buffers from a buffer pool", DEFAULT_USE_POOL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+  /**
+   * GstFakeSrc:rate
+   *
+   * Timestamp the buffers for this many buffers per second, together with
+   * #GstFakeSrc:sync this produces buffers at the given rate. Takes
+   * precedence over #GstFakeSrc:datarate.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_RATE,
+      g_param_spec_double ("rate", "Rate",
+          "Timestamps buffers with number of buffers per second (0 = none)",
+          0.0, G_MAXDOUBLE, DEFAULT_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSrc:burst
+   *
+   * Number of buffers that get the same timestamp when #GstFakeSrc:rate is
+   * used, so that they are produced in bursts while the average rate stays
+   * the same.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST,
+      g_param_spec_uint ("burst", "Burst",
+          "Number of buffers produced at once with rate", 1, G_MAXUINT,
+          DEFAULT_BURST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFakeSrc:jitter
+   *
+   * Maximum random delay in nanoseconds that is added to the timestamps when
+   * #GstFakeSrc:rate is used. Timestamps never go backwards.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_JITTER,
+      g_param_spec_uint64 ("jitter", "Jitter",
+          "Maximum random delay added to the timestamps with rate (in ns)", 0,
+          G_MAXUINT64, DEFAULT_JITTER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   /**
    * GstFakeSrc::handoff:
@@ -370,6 +448,12 @@ gst_fake_src_init (GstFakeSrc * fakesrc)
   fakesrc->datarate = DEFAULT_DATARATE;
   fakesrc->sync = DEFAULT_SYNC;
   fakesrc->format = DEFAULT_FORMAT;
+  fakesrc->generate_lists = DEFAULT_GENERATE_LISTS;
+  fakesrc->use_pool = DEFAULT_USE_POOL;
+  fakesrc->pool = NULL;
+  fakesrc->rate = DEFAULT_RATE;
+  fakesrc->burst = DEFAULT_BURST;
+  fakesrc->jitter = DEFAULT_JITTER;
 }
 
 static void
@@ -509,6 +593,21 @@ gst_fake_src_set_property (GObject * object, guint prop_id,
     case PROP_FORMAT:
       src->format = (GstFormat) g_value_get_enum (value);
       break;
+    case PROP_GENERATE_LISTS:
+      src->generate_lists = g_value_get_uint (value);
+      break;
+    case PROP_USE_POOL:
+      src->use_pool = g_value_get_boolean (value);
+      break;
+    case PROP_RATE:
+      src->rate = g_value_get_double (value);
+      break;
+    case PROP_BURST:
+      src->burst = g_value_get_uint (value);
+      break;
+    case PROP_JITTER:
+      src->jitter = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -584,6 +683,21 @@ gst_fake_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_FORMAT:
       g_value_set_enum (value, src->format);
       break;
+    case PROP_GENERATE_LISTS:
+      g_value_set_uint (value, src->generate_lists);
+      break;
+    case PROP_USE_POOL:
+      g_value_set_boolean (value, src->use_pool);
+      break;
+    case PROP_RATE:
+      g_value_set_double (value, src->rate);
+      break;
+    case PROP_BURST:
+      g_value_set_uint (value, src->burst);
+      break;
+    case PROP_JITTER:
+      g_value_set_uint64 (value, src->jitter);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -628,6 +742,26 @@ gst_fake_src_prepare_buffer (GstFakeSrc * src, guint8 * data, gsize size)
   }
 }
 
+static GstBuffer *
+gst_fake_src_alloc_pool_buffer (GstFakeSrc * src, guint size)
+{
+  GstBuffer *buf = NULL;
+  GstMapInfo info;
+
+  if (gst_buffer_pool_acquire_buffer (src->pool, &buf, NULL) != GST_FLOW_OK)
+    return NULL;
+
+  gst_buffer_set_size (buf, size);
+
+  if (size != 0 && src->filltype != FAKE_SRC_FILLTYPE_NOTHING) {
+    gst_buffer_map (buf, &info, GST_MAP_WRITE);
+    gst_fake_src_prepare_buffer (src, info.data, info.size);
+    gst_buffer_unmap (buf, &info);
+  }
+
+  return buf;
+}
+
 static GstBuffer *
 gst_fake_src_alloc_buffer (GstFakeSrc * src, guint size)
 {
@@ -635,6 +769,12 @@ gst_fake_src_alloc_buffer (GstFakeSrc * src, guint size)
   gpointer data;
   gboolean do_prepare = FALSE;
 
+  /* the pool buffers can't grow beyond the size they were made with */
+  if (src->pool && size <= src->pool_size) {
+    if ((buf = gst_fake_src_alloc_pool_buffer (src, size)))
+      return buf;
+  }
+
   buf = gst_buffer_new ();
 
   if (size != 0) {
@@ -766,21 +906,30 @@ gst_fake_src_get_times (GstBaseSrc * basesrc, GstBuffer * buffer,
   }
 }
 
-static GstFlowReturn
-gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
-    GstBuffer ** ret)
+static GstBuffer *
+gst_fake_src_create_one (GstFakeSrc * src, guint64 offset, gsize * bufsize)
 {
-  GstFakeSrc *src;
+  GstBaseSrc *basesrc = GST_BASE_SRC_CAST (src);
   GstBuffer *buf;
   GstClockTime time;
   gsize size;
 
-  src = GST_FAKE_SRC (basesrc);
-
   buf = gst_fake_src_create_buffer (src, &size);
   GST_BUFFER_OFFSET (buf) = offset;
 
-  if (src->datarate > 0) {
+  if (src->rate > 0.0) {
+    guint64 slot = (src->buffers_sent / src->burst) * src->burst;
+
+    time = (GstClockTime) (slot * (GST_SECOND / src->rate));
+    if (src->jitter > 0)
+      time += (GstClockTime) (g_random_double () * src->jitter);
+    /* don't let the jitter make timestamps go backwards */
+    if (GST_CLOCK_TIME_IS_VALID (src->last_ts) && time < src->last_ts)
+      time = src->last_ts;
+    src->last_ts = time;
+
+    GST_BUFFER_DURATION (buf) = (GstClockTime) (GST_SECOND / src->rate);
+  } else if (src->datarate > 0) {
     time = (src->bytes_sent * GST_SECOND) / src->datarate;
 
     GST_BUFFER_DURATION (buf) = size * GST_SECOND / src->datarate;
@@ -870,8 +1019,39 @@ gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
   }
 
   src->bytes_sent += size;
+  src->buffers_sent++;
+
+  *bufsize = size;
+  return buf;
+}
 
-  *ret = buf;
+static GstFlowReturn
+gst_fake_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** ret)
+{
+  GstFakeSrc *src;
+  gsize size;
+
+  src = GST_FAKE_SRC (basesrc);
+
+  if (src->generate_lists > 0 &&
+      GST_PAD_MODE (basesrc->srcpad) == GST_PAD_MODE_PUSH) {
+    GstBufferList *list;
+    guint i;
+
+    list = gst_buffer_list_new_sized (src->generate_lists);
+    for (i = 0; i < src->generate_lists; i++) {
+      gst_buffer_list_add (list, gst_fake_src_create_one (src, offset, &size));
+      if (offset != -1)
+        offset += size;
+    }
+    gst_base_src_submit_buffer_list (basesrc, list);
+
+    *ret = NULL;
+    return GST_FLOW_OK;
+  }
+
+  *ret = gst_fake_src_create_one (src, offset, &size);
   return GST_FLOW_OK;
 }
 
@@ -884,9 +1064,26 @@ gst_fake_src_start (GstBaseSrc * basesrc)
 
   src->pattern_byte = 0x00;
   src->bytes_sent = 0;
+  src->buffers_sent = 0;
+  src->last_ts = GST_CLOCK_TIME_NONE;
 
   gst_base_src_set_format (basesrc, src->format);
 
+  if (src->use_pool && src->data == FAKE_SRC_DATA_ALLOCATE) {
+    GstStructure *config;
+
+    src->pool = gst_buffer_pool_new ();
+    src->pool_size = src->sizemax;
+    config = gst_buffer_pool_get_config (src->pool);
+    gst_buffer_pool_config_set_params (config, NULL, src->pool_size, 0, 0);
+    if (!gst_buffer_pool_set_config (src->pool, config) ||
+        !gst_buffer_pool_set_active (src->pool, TRUE)) {
+      GST_WARNING_OBJECT (src, "could not activate pool, not using it");
+      gst_object_unref (src->pool);
+      src->pool = NULL;
+    }
+  }
+
   return TRUE;
 }
 
@@ -906,6 +1103,12 @@ gst_fake_src_stop (GstBaseSrc * basesrc)
   src->last_message = NULL;
   GST_OBJECT_UNLOCK (src);
 
+  if (src->pool) {
+    gst_buffer_pool_set_active (src->pool, FALSE);
+    gst_object_unref (src->pool);
+    src->pool = NULL;
+  }
+
   return TRUE;
 }
 
@@ -148,6 +148,17 @@ struct _GstFakeSrc {
 
   guint64        bytes_sent;
 
+  /* load generation */
+  guint          generate_lists;
+  gboolean       use_pool;
+  GstBufferPool *pool;
+  guint          pool_size;
+  gdouble        rate;
+  guint          burst;
+  guint64        jitter;
+  guint64        buffers_sent;
+  GstClockTime   last_ts;
+
   gchar		*last_message;
 };
 
@@ -30,6 +30,18 @@
  * socket. For file descriptors where this does not make sense (files, ...) the
  * #GstBaseSink:sync property can be used to disable synchronisation.
  *
+ * fdsink proposes file descriptor backed memory in the ALLOCATION query.
+ * Buffers with such memory, as produced by fdsrc when reading from a pipe or
+ * a socket, are written with sendfile() so that their data is not copied
+ * through userspace.
+ *
+ * With #GstFdSink:non-blocking, fdsink sets the file descriptor to
+ * non-blocking mode and keeps the data the file descriptor does not take
+ * right away in a backlog of up to #GstFdSink:max-backlog bytes, instead of
+ * stalling the streaming thread on a slow reader. The backlog is written
+ * when the next buffers arrive and before EOS is handled. What happens when
+ * the backlog is full is selected with #GstFdSink:leaky.
+ *
  * Last reviewed on 2006-04-28 (0.10.6)
  */
 
@@ -58,8 +70,12 @@
 #endif
 #include <errno.h>
 #include <string.h>
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #include "gstfdsink.h"
+#include "gstelements_private.h"
 
 #ifdef G_OS_WIN32
 #include <io.h>                 /* lseek, open, close, read */
@@ -85,12 +101,43 @@ enum
   LAST_SIGNAL
 };
 
+#define DEFAULT_NON_BLOCKING    FALSE
+#define DEFAULT_MAX_BACKLOG     (4 * 1024 * 1024)
+#define DEFAULT_LEAKY           GST_FD_SINK_NO_LEAK
+
+/* at most this many buffers of the backlog are written in one go */
+#define FD_SINK_BACKLOG_BUFFERS 64
+
 enum
 {
   ARG_0,
-  ARG_FD
+  ARG_FD,
+  ARG_NON_BLOCKING,
+  ARG_MAX_BACKLOG,
+  ARG_LEAKY,
+  ARG_DROPPED
 };
 
+#define GST_TYPE_FD_SINK_LEAKY (fd_sink_leaky_get_type ())
+static GType
+fd_sink_leaky_get_type (void)
+{
+  static GType fd_sink_leaky_type = 0;
+  static const GEnumValue fd_sink_leaky[] = {
+    {GST_FD_SINK_NO_LEAK, "Not Leaky", "no"},
+    {GST_FD_SINK_LEAK_UPSTREAM, "Leaky on upstream (new buffers)", "upstream"},
+    {GST_FD_SINK_LEAK_DOWNSTREAM, "Leaky on downstream (old buffers)",
+        "downstream"},
+    {0, NULL, NULL},
+  };
+
+  if (!fd_sink_leaky_type) {
+    fd_sink_leaky_type =
+        g_enum_register_static ("GstFdSinkLeaky", fd_sink_leaky);
+  }
+  return fd_sink_leaky_type;
+}
+
 static void gst_fd_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
 
@@ -109,11 +156,15 @@ static void gst_fd_sink_dispose (GObject * obj);
 static gboolean gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query);
 static GstFlowReturn gst_fd_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
+static GstFlowReturn gst_fd_sink_render_list (GstBaseSink * sink,
+    GstBufferList * list);
 static gboolean gst_fd_sink_start (GstBaseSink * basesink);
 static gboolean gst_fd_sink_stop (GstBaseSink * basesink);
 static gboolean gst_fd_sink_unlock (GstBaseSink * basesink);
 static gboolean gst_fd_sink_unlock_stop (GstBaseSink * basesink);
 static gboolean gst_fd_sink_event (GstBaseSink * sink, GstEvent * event);
+static gboolean gst_fd_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
 
 static gboolean gst_fd_sink_do_seek (GstFdSink * fdsink, guint64 new_offset);
 
@@ -140,16 +191,67 @@ gst_fd_sink_class_init (GstFdSinkClass * klass)
       gst_static_pad_template_get (&sinktemplate));
 
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_fd_sink_render);
+  gstbasesink_class->render_list = GST_DEBUG_FUNCPTR (gst_fd_sink_render_list);
   gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_fd_sink_start);
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_fd_sink_stop);
   gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_fd_sink_unlock);
   gstbasesink_class->unlock_stop = GST_DEBUG_FUNCPTR (gst_fd_sink_unlock_stop);
   gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_fd_sink_event);
   gstbasesink_class->query = GST_DEBUG_FUNCPTR (gst_fd_sink_query);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_fd_sink_propose_allocation);
 
   g_object_class_install_property (gobject_class, ARG_FD,
       g_param_spec_int ("fd", "fd", "An open file descriptor to write to",
           0, G_MAXINT, 1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSink:non-blocking
+   *
+   * Set the file descriptor to non-blocking mode and keep the data that
+   * can't be written right away in a backlog. Changes take effect when the
+   * element starts.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, ARG_NON_BLOCKING,
+      g_param_spec_boolean ("non-blocking", "Non-blocking",
+          "Don't block the streaming thread when the fd is full",
+          DEFAULT_NON_BLOCKING, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSink:max-backlog
+   *
+   * The maximum number of bytes kept in the backlog in non-blocking mode.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, ARG_MAX_BACKLOG,
+      g_param_spec_uint64 ("max-backlog", "Max backlog",
+          "Maximum number of bytes kept in non-blocking mode (0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_MAX_BACKLOG,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSink:leaky
+   *
+   * What to do when the backlog is full in non-blocking mode.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, ARG_LEAKY,
+      g_param_spec_enum ("leaky", "Leaky",
+          "Where to drop buffers when the backlog is full",
+          GST_TYPE_FD_SINK_LEAKY, DEFAULT_LEAKY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstFdSink:dropped
+   *
+   * The number of buffers dropped because the backlog was full.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, ARG_DROPPED,
+      g_param_spec_uint64 ("dropped", "Dropped",
+          "Number of buffers dropped because the backlog was full", 0,
+          G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -159,6 +261,11 @@ gst_fd_sink_init (GstFdSink * fdsink)
   fdsink->uri = g_strdup_printf ("fd://%d", fdsink->fd);
   fdsink->bytes_written = 0;
   fdsink->current_pos = 0;
+  fdsink->non_blocking = DEFAULT_NON_BLOCKING;
+  fdsink->max_backlog = DEFAULT_MAX_BACKLOG;
+  fdsink->leaky = DEFAULT_LEAKY;
+  g_queue_init (&fdsink->backlog);
+  fdsink->fd_flags = -1;
 
   gst_base_sink_set_sync (GST_BASE_SINK (fdsink), FALSE);
 }
@@ -229,33 +336,35 @@ gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query)
   return res;
 }
 
-static GstFlowReturn
-gst_fd_sink_render (GstBaseSink * sink, GstBuffer * buffer)
+static gboolean
+gst_fd_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
 {
-  GstFdSink *fdsink;
-  GstMapInfo info;
-  guint8 *ptr;
-  gsize left;
-  gint written;
+#ifdef HAVE_SENDFILE
+  GstAllocator *allocator;
+  GstAllocationParams params;
+
+  /* the default allocator stays first so that only elements that look for
+   * fd memory, like fdsrc, use it */
+  if ((allocator = gst_allocator_find (GST_ALLOCATOR_FD))) {
+    gst_allocation_params_init (&params);
+    if (gst_query_get_n_allocation_params (query) == 0)
+      gst_query_add_allocation_param (query, NULL, &params);
+    gst_query_add_allocation_param (query, allocator, &params);
+    gst_object_unref (allocator);
+  }
+#endif
+  return TRUE;
+}
 
+/* wait until the fd can take data */
+static GstFlowReturn
+gst_fd_sink_wait (GstFdSink * fdsink)
+{
 #ifndef HAVE_WIN32
   gint retval;
-#endif
-
-  fdsink = GST_FD_SINK (sink);
-
-  g_return_val_if_fail (fdsink->fd >= 0, GST_FLOW_ERROR);
 
-  gst_buffer_map (buffer, &info, GST_MAP_READ);
-
-  ptr = info.data;
-  left = info.size;
-
-again:
-#ifndef HAVE_WIN32
   do {
-    GST_DEBUG_OBJECT (fdsink, "going into select, have %" G_GSIZE_FORMAT
-        " bytes to write", info.size);
+    GST_DEBUG_OBJECT (fdsink, "going into select");
     retval = gst_poll_wait (fdsink->fdset, GST_CLOCK_TIME_NONE);
   } while (retval == -1 && (errno == EINTR || errno == EAGAIN));
 
@@ -266,37 +375,6 @@ again:
       goto select_error;
   }
 #endif
-
-  GST_DEBUG_OBJECT (fdsink, "writing %" G_GSIZE_FORMAT " bytes to"
-      " file descriptor %d", info.size, fdsink->fd);
-
-  written = write (fdsink->fd, ptr, left);
-
-  /* check for errors */
-  if (G_UNLIKELY (written < 0)) {
-    /* try to write again on non-fatal errors */
-    if (errno == EAGAIN || errno == EINTR)
-      goto again;
-
-    /* else go to our error handler */
-    goto write_error;
-  }
-
-  /* all is fine when we get here */
-  left -= written;
-  ptr += written;
-  fdsink->bytes_written += written;
-  fdsink->current_pos += written;
-
-  GST_DEBUG_OBJECT (fdsink, "wrote %d bytes, %" G_GSIZE_FORMAT " left", written,
-      left);
-
-  /* short write, select and try to write the remainder */
-  if (G_UNLIKELY (left > 0))
-    goto again;
-
-  gst_buffer_unmap (buffer, &info);
-
   return GST_FLOW_OK;
 
 #ifndef HAVE_WIN32
@@ -305,34 +383,350 @@ select_error:
     GST_ELEMENT_ERROR (fdsink, RESOURCE, READ, (NULL),
         ("select on file descriptor: %s.", g_strerror (errno)));
     GST_DEBUG_OBJECT (fdsink, "Error during select");
-    gst_buffer_unmap (buffer, &info);
     return GST_FLOW_ERROR;
   }
 stopped:
   {
     GST_DEBUG_OBJECT (fdsink, "Select stopped");
-    gst_buffer_unmap (buffer, &info);
     return GST_FLOW_FLUSHING;
   }
 #endif
+}
+
+static GstFlowReturn
+gst_fd_sink_post_write_error (GstFdSink * fdsink)
+{
+  switch (errno) {
+    case ENOSPC:
+      GST_ELEMENT_ERROR (fdsink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+      break;
+    default:{
+      GST_ELEMENT_ERROR (fdsink, RESOURCE, WRITE, (NULL),
+          ("Error while writing to file descriptor %d: %s",
+              fdsink->fd, g_strerror (errno)));
+    }
+  }
+  return GST_FLOW_ERROR;
+}
+
+#ifdef HAVE_SENDFILE
+static gboolean
+gst_fd_sink_is_fd_buffer (GstBuffer * buffer)
+{
+  guint i, n_mem;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  for (i = 0; i < n_mem; i++) {
+    if (!gst_is_fd_memory (gst_buffer_peek_memory (buffer, i)))
+      return FALSE;
+  }
+  return n_mem > 0;
+}
+
+/* write the fd memory of @buffer with sendfile(), the data stays in the
+ * kernel. Returns GST_FLOW_NOT_SUPPORTED when the fd does not support
+ * sendfile() and nothing was written yet */
+static GstFlowReturn
+gst_fd_sink_render_sendfile (GstFdSink * fdsink, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+  guint i, n_mem;
+  gboolean sent = FALSE;
+  gssize written;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  for (i = 0; i < n_mem; i++) {
+    GstMemory *mem = gst_buffer_peek_memory (buffer, i);
+    gsize offset, left;
+    off_t pos;
+    gint mem_fd;
+
+    mem_fd = gst_fd_memory_get_fd (mem, &offset);
+    pos = offset;
+    left = mem->size;
+
+    while (left > 0) {
+      if ((ret = gst_fd_sink_wait (fdsink)) != GST_FLOW_OK)
+        return ret;
+
+      written = sendfile (fdsink->fd, mem_fd, &pos, left);
+      if (G_UNLIKELY (written < 0)) {
+        if (errno == EAGAIN || errno == EINTR)
+          continue;
+
+        if (!sent && (errno == EINVAL || errno == ENOSYS))
+          return GST_FLOW_NOT_SUPPORTED;
+
+        return gst_fd_sink_post_write_error (fdsink);
+      }
+
+      sent = TRUE;
+      left -= written;
+      fdsink->bytes_written += written;
+      fdsink->current_pos += written;
+
+      GST_DEBUG_OBJECT (fdsink, "sent %" G_GSSIZE_FORMAT " bytes, %"
+          G_GSIZE_FORMAT " left", written, left);
+    }
+  }
+
+  return GST_FLOW_OK;
+}
+#endif
+
+/* write all of @buffers with as few writev() calls as possible, waiting for
+ * the fd after partial writes */
+static GstFlowReturn
+gst_fd_sink_write_buffers (GstFdSink * fdsink, GstBuffer ** buffers,
+    guint num_buffers)
+{
+  GstFlowReturn ret;
+  gsize offset = 0;
+  gssize written;
+
+  while (num_buffers > 0) {
+    if ((ret = gst_fd_sink_wait (fdsink)) != GST_FLOW_OK)
+      return ret;
+
+    written = gst_writev_buffers_once (GST_OBJECT_CAST (fdsink), fdsink->fd,
+        buffers, num_buffers, offset);
+    if (G_UNLIKELY (written < 0)) {
+      /* try to write again on non-fatal errors */
+      if (errno == EAGAIN || errno == EINTR)
+        continue;
+
+      return gst_fd_sink_post_write_error (fdsink);
+    }
+
+    fdsink->bytes_written += written;
+    fdsink->current_pos += written;
+
+    /* skip the buffers that were written completely */
+    offset += written;
+    while (num_buffers > 0 && offset >= gst_buffer_get_size (buffers[0])) {
+      offset -= gst_buffer_get_size (buffers[0]);
+      buffers++;
+      num_buffers--;
+    }
+
+    if (G_UNLIKELY (written == 0 && num_buffers > 0))
+      goto map_error;
 
-write_error:
+    GST_DEBUG_OBJECT (fdsink, "wrote %" G_GSSIZE_FORMAT " bytes, %u buffers "
+        "left", written, num_buffers);
+  }
+
+  return GST_FLOW_OK;
+
+map_error:
   {
-    switch (errno) {
-      case ENOSPC:
-        GST_ELEMENT_ERROR (fdsink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+    GST_ELEMENT_ERROR (fdsink, RESOURCE, WRITE, (NULL),
+        ("Could not map buffer"));
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* write the backlog until at most @limit bytes are left, without @block
+ * this stops as soon as the fd is full */
+static GstFlowReturn
+gst_fd_sink_flush_backlog (GstFdSink * fdsink, guint64 limit, gboolean block)
+{
+  GstBuffer *buffers[FD_SINK_BACKLOG_BUFFERS];
+  GstFlowReturn ret;
+  gssize written;
+
+  while (fdsink->backlog_size > limit) {
+    GList *walk;
+    guint n = 0;
+
+    for (walk = fdsink->backlog.head; walk && n < FD_SINK_BACKLOG_BUFFERS;
+        walk = walk->next)
+      buffers[n++] = walk->data;
+
+    if (block && (ret = gst_fd_sink_wait (fdsink)) != GST_FLOW_OK)
+      return ret;
+
+    written = gst_writev_buffers_once (GST_OBJECT_CAST (fdsink), fdsink->fd,
+        buffers, n, fdsink->backlog_offset);
+    if (G_UNLIKELY (written < 0)) {
+      if (errno == EINTR || (block && errno == EAGAIN))
+        continue;
+      if (errno == EAGAIN)
         break;
-      default:{
-        GST_ELEMENT_ERROR (fdsink, RESOURCE, WRITE, (NULL),
-            ("Error while writing to file descriptor %d: %s",
-                fdsink->fd, g_strerror (errno)));
-      }
+
+      return gst_fd_sink_post_write_error (fdsink);
     }
-    gst_buffer_unmap (buffer, &info);
+    if (G_UNLIKELY (written == 0))
+      goto map_error;
+
+    fdsink->bytes_written += written;
+    fdsink->current_pos += written;
+    fdsink->backlog_size -= written;
+
+    fdsink->backlog_offset += written;
+    while (!g_queue_is_empty (&fdsink->backlog)) {
+      GstBuffer *head = g_queue_peek_head (&fdsink->backlog);
+      gsize size = gst_buffer_get_size (head);
+
+      if (fdsink->backlog_offset < size)
+        break;
+
+      fdsink->backlog_offset -= size;
+      gst_buffer_unref (g_queue_pop_head (&fdsink->backlog));
+    }
+
+    GST_LOG_OBJECT (fdsink, "wrote %" G_GSSIZE_FORMAT " bytes of the "
+        "backlog, %" G_GUINT64_FORMAT " left", written, fdsink->backlog_size);
+  }
+
+  return GST_FLOW_OK;
+
+map_error:
+  {
+    GST_ELEMENT_ERROR (fdsink, RESOURCE, WRITE, (NULL),
+        ("Could not map buffer"));
     return GST_FLOW_ERROR;
   }
 }
 
+static void
+gst_fd_sink_clear_backlog (GstFdSink * fdsink)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&fdsink->backlog)))
+    gst_buffer_unref (buffer);
+  fdsink->backlog_offset = 0;
+  fdsink->backlog_size = 0;
+}
+
+/* add @buffer to the backlog, making room according to the leaky mode when
+ * the backlog would become too large */
+static GstFlowReturn
+gst_fd_sink_queue_buffer (GstFdSink * fdsink, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+  gsize size;
+
+  size = gst_buffer_get_size (buffer);
+  if (size == 0)
+    return GST_FLOW_OK;
+
+  if (fdsink->max_backlog > 0 &&
+      fdsink->backlog_size + size > fdsink->max_backlog) {
+    /* first write what the fd takes now */
+    if ((ret = gst_fd_sink_flush_backlog (fdsink, 0, FALSE)) != GST_FLOW_OK)
+      return ret;
+  }
+
+  if (fdsink->max_backlog > 0 &&
+      fdsink->backlog_size + size > fdsink->max_backlog) {
+    switch (fdsink->leaky) {
+      case GST_FD_SINK_LEAK_UPSTREAM:
+        GST_DEBUG_OBJECT (fdsink, "backlog full, dropping new buffer %p",
+            buffer);
+        fdsink->dropped++;
+        return GST_FLOW_OK;
+      case GST_FD_SINK_LEAK_DOWNSTREAM:
+        /* a partially written buffer has to be completed */
+        while (fdsink->backlog_size + size > fdsink->max_backlog) {
+          GList *link = fdsink->backlog.head;
+          GstBuffer *old;
+
+          if (link && fdsink->backlog_offset > 0)
+            link = link->next;
+          if (link == NULL)
+            break;
+
+          old = link->data;
+          GST_DEBUG_OBJECT (fdsink, "backlog full, dropping old buffer %p",
+              old);
+          fdsink->backlog_size -= gst_buffer_get_size (old);
+          g_queue_delete_link (&fdsink->backlog, link);
+          gst_buffer_unref (old);
+          fdsink->dropped++;
+        }
+        break;
+      default:
+        ret = gst_fd_sink_flush_backlog (fdsink,
+            fdsink->max_backlog > size ? fdsink->max_backlog - size : 0, TRUE);
+        if (ret != GST_FLOW_OK)
+          return ret;
+        break;
+    }
+  }
+
+  g_queue_push_tail (&fdsink->backlog, gst_buffer_ref (buffer));
+  fdsink->backlog_size += size;
+
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_fd_sink_render_buffers (GstFdSink * fdsink, GstBuffer ** buffers,
+    guint num_buffers)
+{
+  GstFlowReturn ret;
+  guint i;
+
+  g_return_val_if_fail (fdsink->fd >= 0, GST_FLOW_ERROR);
+
+  if (!fdsink->non_blocking)
+    return gst_fd_sink_write_buffers (fdsink, buffers, num_buffers);
+
+  for (i = 0; i < num_buffers; i++) {
+    if ((ret = gst_fd_sink_queue_buffer (fdsink, buffers[i])) != GST_FLOW_OK)
+      return ret;
+  }
+  return gst_fd_sink_flush_backlog (fdsink, 0, FALSE);
+}
+
+static GstFlowReturn
+gst_fd_sink_render (GstBaseSink * sink, GstBuffer * buffer)
+{
+  GstFdSink *fdsink;
+
+  fdsink = GST_FD_SINK (sink);
+
+  g_return_val_if_fail (fdsink->fd >= 0, GST_FLOW_ERROR);
+
+#ifdef HAVE_SENDFILE
+  if (fdsink->use_sendfile && !fdsink->non_blocking &&
+      gst_fd_sink_is_fd_buffer (buffer)) {
+    GstFlowReturn ret;
+
+    ret = gst_fd_sink_render_sendfile (fdsink, buffer);
+    if (ret != GST_FLOW_NOT_SUPPORTED)
+      return ret;
+
+    GST_INFO_OBJECT (fdsink, "sendfile not supported, writing");
+    fdsink->use_sendfile = FALSE;
+  }
+#endif
+
+  return gst_fd_sink_render_buffers (fdsink, &buffer, 1);
+}
+
+static GstFlowReturn
+gst_fd_sink_render_list (GstBaseSink * sink, GstBufferList * list)
+{
+  GstFdSink *fdsink;
+  GstBuffer **buffers;
+  guint i, num_buffers;
+
+  fdsink = GST_FD_SINK (sink);
+
+  num_buffers = gst_buffer_list_length (list);
+  if (num_buffers == 0)
+    return GST_FLOW_OK;
+
+  buffers = g_newa (GstBuffer *, num_buffers);
+  for (i = 0; i < num_buffers; i++)
+    buffers[i] = gst_buffer_list_get (list, i);
+
+  return gst_fd_sink_render_buffers (fdsink, buffers, num_buffers);
+}
+
 static gboolean
 gst_fd_sink_check_fd (GstFdSink * fdsink, int fd, GError ** error)
 {
@@ -377,6 +771,36 @@ not_seekable:
   }
 }
 
+/* set @fd to non-blocking mode and remember how to restore it */
+static void
+gst_fd_sink_set_non_blocking (GstFdSink * fdsink, gint fd)
+{
+#ifndef HAVE_WIN32
+  gint flags;
+
+  fdsink->fd_flags = -1;
+  if ((flags = fcntl (fd, F_GETFL)) < 0 || (flags & O_NONBLOCK))
+    return;
+
+  if (fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    GST_WARNING_OBJECT (fdsink, "could not make fd %d non-blocking: %s", fd,
+        g_strerror (errno));
+    return;
+  }
+  fdsink->fd_flags = flags;
+#endif
+}
+
+static void
+gst_fd_sink_restore_blocking (GstFdSink * fdsink, gint fd)
+{
+#ifndef HAVE_WIN32
+  if (fdsink->fd_flags >= 0)
+    fcntl (fd, F_SETFL, fdsink->fd_flags);
+  fdsink->fd_flags = -1;
+#endif
+}
+
 static gboolean
 gst_fd_sink_start (GstBaseSink * basesink)
 {
@@ -400,6 +824,12 @@ gst_fd_sink_start (GstBaseSink * basesink)
   fdsink->seekable = gst_fd_sink_do_seek (fdsink, 0);
   GST_INFO_OBJECT (fdsink, "seeking supported: %d", fdsink->seekable);
 
+  fdsink->use_sendfile = TRUE;
+
+  fdsink->dropped = 0;
+  if (fdsink->non_blocking)
+    gst_fd_sink_set_non_blocking (fdsink, fdsink->fd);
+
   return TRUE;
 
   /* ERRORS */
@@ -416,6 +846,9 @@ gst_fd_sink_stop (GstBaseSink * basesink)
 {
   GstFdSink *fdsink = GST_FD_SINK (basesink);
 
+  gst_fd_sink_clear_backlog (fdsink);
+  gst_fd_sink_restore_blocking (fdsink, fdsink->fd);
+
   if (fdsink->fdset) {
     gst_poll_free (fdsink->fdset);
     fdsink->fdset = NULL;
@@ -473,8 +906,15 @@ gst_fd_sink_update_fd (GstFdSink * fdsink, int new_fd, GError ** error)
     fd.fd = new_fd;
     gst_poll_add_fd (fdsink->fdset, &fd);
     gst_poll_fd_ctl_write (fdsink->fdset, &fd, TRUE);
+
+    /* the fdset only exists while running */
+    if (fdsink->non_blocking) {
+      gst_fd_sink_restore_blocking (fdsink, fdsink->fd);
+      gst_fd_sink_set_non_blocking (fdsink, new_fd);
+    }
   }
   fdsink->fd = new_fd;
+  fdsink->use_sendfile = TRUE;
   g_free (fdsink->uri);
   fdsink->uri = g_strdup_printf ("fd://%d", fdsink->fd);
 
@@ -504,6 +944,15 @@ gst_fd_sink_set_property (GObject * object, guint prop_id,
       gst_fd_sink_update_fd (fdsink, fd, NULL);
       break;
     }
+    case ARG_NON_BLOCKING:
+      fdsink->non_blocking = g_value_get_boolean (value);
+      break;
+    case ARG_MAX_BACKLOG:
+      fdsink->max_backlog = g_value_get_uint64 (value);
+      break;
+    case ARG_LEAKY:
+      fdsink->leaky = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -522,6 +971,18 @@ gst_fd_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case ARG_FD:
       g_value_set_int (value, fdsink->fd);
       break;
+    case ARG_NON_BLOCKING:
+      g_value_set_boolean (value, fdsink->non_blocking);
+      break;
+    case ARG_MAX_BACKLOG:
+      g_value_set_uint64 (value, fdsink->max_backlog);
+      break;
+    case ARG_LEAKY:
+      g_value_set_enum (value, fdsink->leaky);
+      break;
+    case ARG_DROPPED:
+      g_value_set_uint64 (value, fdsink->dropped);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -572,6 +1033,10 @@ gst_fd_sink_event (GstBaseSink * sink, GstEvent * event)
       gst_event_parse_segment (event, &segment);
 
       if (segment->format == GST_FORMAT_BYTES) {
+        /* the pending data belongs before the new position */
+        if (gst_fd_sink_flush_backlog (fdsink, 0, TRUE) != GST_FLOW_OK)
+          goto flush_failed;
+
         /* only try to seek and fail when we are going to a different
          * position */
         if (fdsink->current_pos != segment->start) {
@@ -589,12 +1054,27 @@ gst_fd_sink_event (GstBaseSink * sink, GstEvent * event)
       }
       break;
     }
+    case GST_EVENT_EOS:
+      /* everything has to be written before EOS is posted */
+      if (gst_fd_sink_flush_backlog (fdsink, 0, TRUE) != GST_FLOW_OK)
+        goto flush_failed;
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_fd_sink_clear_backlog (fdsink);
+      break;
     default:
       break;
   }
 
   return GST_BASE_SINK_CLASS (parent_class)->event (sink, event);
 
+flush_failed:
+  {
+    GST_DEBUG_OBJECT (fdsink, "could not write the backlog");
+    gst_event_unref (event);
+    return FALSE;
+  }
+
 seek_failed:
   {
     GST_ELEMENT_ERROR (fdsink, RESOURCE, SEEK, (NULL),
@@ -41,6 +41,20 @@ G_BEGIN_DECLS
 #define GST_IS_FD_SINK_CLASS(klass) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_FD_SINK))
 
+/**
+ * GstFdSinkLeaky:
+ * @GST_FD_SINK_NO_LEAK: block when the backlog is full
+ * @GST_FD_SINK_LEAK_UPSTREAM: drop new buffers when the backlog is full
+ * @GST_FD_SINK_LEAK_DOWNSTREAM: drop the oldest buffers of the backlog
+ *
+ * What a non-blocking #GstFdSink does when its backlog is full.
+ */
+typedef enum {
+  GST_FD_SINK_NO_LEAK           = 0,
+  GST_FD_SINK_LEAK_UPSTREAM     = 1,
+  GST_FD_SINK_LEAK_DOWNSTREAM   = 2
+} GstFdSinkLeaky;
+
 typedef struct _GstFdSink GstFdSink;
 typedef struct _GstFdSinkClass GstFdSinkClass;
 
@@ -61,6 +75,21 @@ struct _GstFdSink {
   guint64 current_pos;
 
   gboolean seekable;
+
+  /* cleared when the fd does not support sendfile() */
+  gboolean use_sendfile;
+
+  /* non-blocking mode, the buffers the fd did not take yet are kept in the
+   * backlog, @backlog_offset bytes of the first one were written */
+  gboolean non_blocking;
+  guint64 max_backlog;
+  GstFdSinkLeaky leaky;
+  GQueue backlog;
+  gsize backlog_offset;
+  guint64 backlog_size;
+  guint64 dropped;
+  /* the flags of the fd before O_NONBLOCK was set, -1 if we didn't */
+  gint fd_flags;
 };
 
 struct _GstFdSinkClass {
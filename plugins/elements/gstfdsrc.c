@@ -44,6 +44,10 @@
  * </listitem>
  * </itemizedlist>
  * 
+ * When the input is a pipe or a socket and downstream proposes file descriptor
+ * backed memory in the ALLOCATION query, as fdsink does, the data is moved
+ * into that memory with splice() and never copied through userspace.
+ * 
  * <refsect2>
  * <title>Example launch line</title>
  * |[
@@ -87,6 +91,7 @@
 #endif
 #include <stdlib.h>
 #include <errno.h>
+#include <string.h>
 
 #include "gstfdsrc.h"
 
@@ -133,6 +138,8 @@ static gboolean gst_fd_src_is_seekable (GstBaseSrc * bsrc);
 static gboolean gst_fd_src_get_size (GstBaseSrc * src, guint64 * size);
 static gboolean gst_fd_src_do_seek (GstBaseSrc * src, GstSegment * segment);
 static gboolean gst_fd_src_query (GstBaseSrc * src, GstQuery * query);
+static gboolean gst_fd_src_decide_allocation (GstBaseSrc * bsrc,
+    GstQuery * query);
 
 static GstFlowReturn gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf);
 
@@ -182,6 +189,8 @@ gst_fd_src_class_init (GstFdSrcClass * klass)
   gstbasesrc_class->get_size = GST_DEBUG_FUNCPTR (gst_fd_src_get_size);
   gstbasesrc_class->do_seek = GST_DEBUG_FUNCPTR (gst_fd_src_do_seek);
   gstbasesrc_class->query = GST_DEBUG_FUNCPTR (gst_fd_src_query);
+  gstbasesrc_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_fd_src_decide_allocation);
 
   gstpush_src_class->create = GST_DEBUG_FUNCPTR (gst_fd_src_create);
 }
@@ -196,6 +205,9 @@ gst_fd_src_init (GstFdSrc * fdsrc)
   fdsrc->timeout = DEFAULT_TIMEOUT;
   fdsrc->uri = g_strdup_printf ("fd://0");
   fdsrc->curoffset = 0;
+  fdsrc->use_splice = FALSE;
+  fdsrc->allocator = NULL;
+  fdsrc->splice_pipe[0] = fdsrc->splice_pipe[1] = -1;
 }
 
 static void
@@ -293,11 +305,28 @@ socket_pair:
   }
 }
 
+static void
+gst_fd_src_clear_splice (GstFdSrc * src)
+{
+  src->use_splice = FALSE;
+  if (src->allocator) {
+    gst_object_unref (src->allocator);
+    src->allocator = NULL;
+  }
+  if (src->splice_pipe[0] >= 0) {
+    close (src->splice_pipe[0]);
+    close (src->splice_pipe[1]);
+    src->splice_pipe[0] = src->splice_pipe[1] = -1;
+  }
+}
+
 static gboolean
 gst_fd_src_stop (GstBaseSrc * bsrc)
 {
   GstFdSrc *src = GST_FD_SRC (bsrc);
 
+  gst_fd_src_clear_splice (src);
+
   if (src->fdset) {
     gst_poll_free (src->fdset);
     src->fdset = NULL;
@@ -383,6 +412,117 @@ gst_fd_src_get_property (GObject * object, guint prop_id, GValue * value,
   }
 }
 
+#ifdef HAVE_SPLICE
+/* splice() needs a pipe on one side, pipes are spliced directly into the
+ * memory, sockets go through a pipe of our own */
+static gboolean
+gst_fd_src_setup_splice (GstFdSrc * src)
+{
+  struct stat stat_results;
+
+  if (fstat (src->fd, &stat_results) < 0)
+    return FALSE;
+
+  if (S_ISFIFO (stat_results.st_mode))
+    return TRUE;
+
+  if (!S_ISSOCK (stat_results.st_mode))
+    return FALSE;
+
+  if (pipe (src->splice_pipe) < 0) {
+    GST_WARNING_OBJECT (src, "could not create pipe: %s", g_strerror (errno));
+    src->splice_pipe[0] = src->splice_pipe[1] = -1;
+    return FALSE;
+  }
+  return TRUE;
+}
+#endif
+
+static gboolean
+gst_fd_src_decide_allocation (GstBaseSrc * bsrc, GstQuery * query)
+{
+  GstFdSrc *src = GST_FD_SRC (bsrc);
+  guint i, n_params;
+
+  if (!GST_BASE_SRC_CLASS (parent_class)->decide_allocation (bsrc, query))
+    return FALSE;
+
+  gst_fd_src_clear_splice (src);
+
+  /* look for fd memory anywhere in the list, sinks propose it after the
+   * default allocator so that other elements keep using system memory */
+  n_params = gst_query_get_n_allocation_params (query);
+  for (i = 0; i < n_params && src->allocator == NULL; i++) {
+    GstAllocator *allocator;
+    GstAllocationParams params;
+
+    gst_query_parse_nth_allocation_param (query, i, &allocator, &params);
+    if (allocator == NULL)
+      continue;
+
+    if (g_strcmp0 (allocator->mem_type, GST_ALLOCATOR_FD) == 0) {
+      src->allocator = allocator;
+      src->params = params;
+    } else {
+      gst_object_unref (allocator);
+    }
+  }
+
+#ifdef HAVE_SPLICE
+  if (src->allocator)
+    src->use_splice = gst_fd_src_setup_splice (src);
+#endif
+  GST_DEBUG_OBJECT (src, "splice into fd memory: %d", src->use_splice);
+
+  return TRUE;
+}
+
+#ifdef HAVE_SPLICE
+/* move up to @size bytes from the fd into @mem without copying them to
+ * userspace, returns the number of bytes or -1 with errno set */
+static gssize
+gst_fd_src_splice (GstFdSrc * src, GstMemory * mem, gsize size)
+{
+  gssize res, moved;
+  gsize offset, left;
+  loff_t pos;
+  gint mem_fd;
+
+  mem_fd = gst_fd_memory_get_fd (mem, &offset);
+  pos = offset;
+
+  if (src->splice_pipe[1] < 0) {
+    do {
+      res = splice (src->fd, NULL, mem_fd, &pos, size, SPLICE_F_MOVE);
+    } while (res < 0 && errno == EINTR);
+
+    return res;
+  }
+
+  do {
+    res = splice (src->fd, NULL, src->splice_pipe[1], NULL, size,
+        SPLICE_F_MOVE);
+  } while (res < 0 && errno == EINTR);
+
+  /* the data is in our pipe now, it has to go out completely */
+  for (left = MAX (res, 0); left > 0; left -= moved) {
+    moved = splice (src->splice_pipe[0], NULL, mem_fd, &pos, left,
+        SPLICE_F_MOVE);
+    if (moved < 0) {
+      if (errno == EINTR) {
+        moved = 0;
+        continue;
+      }
+      /* not a fallback case anymore, the data was consumed */
+      if (errno == EINVAL || errno == ENOSYS)
+        errno = EIO;
+      return -1;
+    }
+  }
+  return res;
+}
+#endif
+
 static GstFlowReturn
 gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
@@ -438,6 +578,38 @@ gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 
   blocksize = GST_BASE_SRC (src)->blocksize;
 
+#ifdef HAVE_SPLICE
+  if (src->use_splice) {
+    GstMemory *mem;
+    gint err = ENOMEM;
+
+    mem = gst_allocator_alloc (src->allocator, blocksize, &src->params);
+    if (G_LIKELY (mem != NULL)) {
+      readbytes = gst_fd_src_splice (src, mem, blocksize);
+      GST_LOG_OBJECT (src, "spliced %" G_GSSIZE_FORMAT, readbytes);
+
+      if (readbytes >= 0) {
+        buf = gst_buffer_new ();
+        gst_buffer_append_memory (buf, mem);
+        gst_buffer_resize (buf, 0, readbytes);
+        goto have_buffer;
+      }
+
+      err = errno;
+      gst_memory_unref (mem);
+      if (err != EINVAL && err != ENOSYS) {
+        errno = err;
+        goto splice_error;
+      }
+    }
+
+    /* nothing was consumed yet, read from now on */
+    GST_INFO_OBJECT (src, "can't splice into fd memory: %s",
+        g_strerror (err));
+    src->use_splice = FALSE;
+  }
+#endif
+
   /* create the buffer */
   buf = gst_buffer_new_allocate (NULL, blocksize, NULL);
   if (G_UNLIKELY (buf == NULL))
@@ -456,6 +628,10 @@ gst_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
   gst_buffer_unmap (buf, &info);
   gst_buffer_resize (buf, 0, readbytes);
 
+#ifdef HAVE_SPLICE
+have_buffer:
+#endif
+
   if (readbytes == 0)
     goto eos;
 
@@ -505,6 +681,15 @@ read_error:
     gst_buffer_unref (buf);
     return GST_FLOW_ERROR;
   }
+#ifdef HAVE_SPLICE
+splice_error:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("splice from file descriptor: %s.", g_strerror (errno)));
+    GST_DEBUG_OBJECT (psrc, "Error splicing from fd");
+    return GST_FLOW_ERROR;
+  }
+#endif
 }
 
 static gboolean
@@ -71,6 +71,13 @@ struct _GstFdSrc {
   GstPoll *fdset;
 
   gulong curoffset; /* current offset in file */
+
+  /* zero-copy mode, used when downstream proposed fd memory */
+  gboolean use_splice;
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  /* sockets are spliced into fd memory through this pipe */
+  gint splice_pipe[2];
 };
 
 struct _GstFdSrcClass {
@@ -31,6 +31,10 @@
  * |[
  * gst-launch v4l2src num-buffers=1 ! jpegenc ! filesink location=capture1.jpeg
  * ]| Capture one frame from a v4l2 camera and save as jpeg image.
+ * |[
+ * gst-launch videotestsrc ! x264enc ! matroskamux ! filesink location=rec.mkv direct-io=true preallocate-size=67108864
+ * ]| Record without going through the page cache, growing the file in chunks
+ * of 64MB.
  * </refsect2>
  */
 
@@ -38,6 +42,11 @@
 #  include "config.h"
 #endif
 
+/* for O_DIRECT and fallocate() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE 1
+#endif
+
 #include "../../gst/gst-i18n-lib.h"
 
 #include <gst/gst.h>
@@ -47,6 +56,7 @@
 #endif
 #include <errno.h>
 #include "gstfilesink.h"
+#include "gstelements_private.h"
 #include <string.h>
 #include <sys/types.h>
 
@@ -62,10 +72,15 @@
 #endif
 
 #include <sys/stat.h>
+#include <fcntl.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 
+#ifndef O_BINARY
+#define O_BINARY (0)
+#endif
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -98,6 +113,11 @@ GST_DEBUG_CATEGORY_STATIC (gst_file_sink_debug);
 #define DEFAULT_BUFFER_MODE 	-1
 #define DEFAULT_BUFFER_SIZE 	64 * 1024
 #define DEFAULT_APPEND		FALSE
+#define DEFAULT_DIRECT_IO	FALSE
+#define DEFAULT_PREALLOCATE_SIZE 0
+
+/* used when the filesystem doesn't tell us its block size */
+#define DEFAULT_DIRECT_ALIGN	4096
 
 enum
 {
@@ -106,6 +126,8 @@ enum
   PROP_BUFFER_MODE,
   PROP_BUFFER_SIZE,
   PROP_APPEND,
+  PROP_DIRECT_IO,
+  PROP_PREALLOCATE_SIZE,
   PROP_LAST
 };
 
@@ -162,6 +184,8 @@ static gboolean gst_file_sink_stop (GstBaseSink * sink);
 static gboolean gst_file_sink_event (GstBaseSink * sink, GstEvent * event);
 static GstFlowReturn gst_file_sink_render (GstBaseSink * sink,
     GstBuffer * buffer);
+static GstFlowReturn gst_file_sink_render_list (GstBaseSink * sink,
+    GstBufferList * list);
 
 static gboolean gst_file_sink_do_seek (GstFileSink * filesink,
     guint64 new_offset);
@@ -169,6 +193,10 @@ static gboolean gst_file_sink_get_current_offset (GstFileSink * filesink,
     guint64 * p_pos);
 
 static gboolean gst_file_sink_query (GstBaseSink * bsink, GstQuery * query);
+static gboolean gst_file_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
+
+static gboolean gst_file_sink_direct_flush (GstFileSink * sink);
 
 static void gst_file_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -218,6 +246,38 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
           "Append to an already existing file", DEFAULT_APPEND,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstFileSink:direct-io
+   *
+   * Open the file with O_DIRECT so that the written data bypasses the page
+   * cache. Data is staged in an aligned buffer of buffer-size bytes and
+   * written out in blocks that match the alignment requirements of the
+   * filesystem. Upstream is asked to allocate suitably aligned memory, so
+   * that aligned buffers can be written without being copied.
+   *
+   * Only supported on platforms that have O_DIRECT.
+   */
+  g_object_class_install_property (gobject_class, PROP_DIRECT_IO,
+      g_param_spec_boolean ("direct-io", "Direct I/O",
+          "Bypass the page cache when writing (O_DIRECT)", DEFAULT_DIRECT_IO,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstFileSink:preallocate-size
+   *
+   * When not 0, reserve disk space for the file ahead of the write position
+   * in chunks of this many bytes. This reduces fragmentation of files that
+   * are written slowly over a long time. The reported file size is not
+   * affected.
+   *
+   * Only supported on platforms that have fallocate().
+   */
+  g_object_class_install_property (gobject_class, PROP_PREALLOCATE_SIZE,
+      g_param_spec_uint64 ("preallocate-size", "Preallocate size",
+          "Reserve disk space in chunks of this many bytes (0 = disabled)",
+          0, G_MAXUINT64, DEFAULT_PREALLOCATE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_set_static_metadata (gstelement_class,
       "File Sink",
       "Sink/File", "Write stream to a file",
@@ -229,7 +289,11 @@ gst_file_sink_class_init (GstFileSinkClass * klass)
   gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_file_sink_stop);
   gstbasesink_class->query = GST_DEBUG_FUNCPTR (gst_file_sink_query);
   gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_file_sink_render);
+  gstbasesink_class->render_list =
+      GST_DEBUG_FUNCPTR (gst_file_sink_render_list);
   gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_file_sink_event);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_file_sink_propose_allocation);
 
   if (sizeof (off_t) < 8) {
     GST_LOG ("No large file support, sizeof (off_t) = %" G_GSIZE_FORMAT "!",
@@ -246,6 +310,8 @@ gst_file_sink_init (GstFileSink * filesink)
   filesink->buffer_size = DEFAULT_BUFFER_SIZE;
   filesink->buffer = NULL;
   filesink->append = FALSE;
+  filesink->direct_io = DEFAULT_DIRECT_IO;
+  filesink->preallocate_size = DEFAULT_PREALLOCATE_SIZE;
 
   gst_base_sink_set_sync (GST_BASE_SINK (filesink), FALSE);
 }
@@ -320,6 +386,12 @@ gst_file_sink_set_property (GObject * object, guint prop_id,
     case PROP_APPEND:
       sink->append = g_value_get_boolean (value);
       break;
+    case PROP_DIRECT_IO:
+      sink->direct_io = g_value_get_boolean (value);
+      break;
+    case PROP_PREALLOCATE_SIZE:
+      sink->preallocate_size = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -345,12 +417,66 @@ gst_file_sink_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_APPEND:
       g_value_set_boolean (value, sink->append);
       break;
+    case PROP_DIRECT_IO:
+      g_value_set_boolean (value, sink->direct_io);
+      break;
+    case PROP_PREALLOCATE_SIZE:
+      g_value_set_uint64 (value, sink->preallocate_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+#ifdef O_DIRECT
+/* open the file with O_DIRECT and set up the aligned staging area. stdio is
+ * only used for seeking and position reporting, never for writing */
+static FILE *
+gst_file_sink_open_direct (GstFileSink * sink)
+{
+  struct stat st;
+  FILE *file;
+  gint fd, flags;
+  gsize align;
+
+  flags = O_WRONLY | O_CREAT | O_BINARY | O_DIRECT;
+  flags |= sink->append ? O_APPEND : O_TRUNC;
+
+  fd = open (sink->filename, flags, 0666);
+  if (fd < 0)
+    return NULL;
+
+  file = fdopen (fd, sink->append ? "ab" : "wb");
+  if (file == NULL) {
+    close (fd);
+    return NULL;
+  }
+  setvbuf (file, NULL, _IONBF, 0);
+
+  /* use the block size of the filesystem as alignment */
+  align = DEFAULT_DIRECT_ALIGN;
+  if (fstat (fd, &st) == 0 && st.st_blksize > 0 &&
+      (st.st_blksize & (st.st_blksize - 1)) == 0)
+    align = st.st_blksize;
+  sink->direct_align = align - 1;
+
+  /* the staging area is a multiple of the alignment */
+  sink->direct_size = MAX (sink->buffer_size, align);
+  sink->direct_size = (sink->direct_size + sink->direct_align) &
+      ~sink->direct_align;
+  sink->direct_mem = g_malloc (sink->direct_size + sink->direct_align);
+  sink->direct_data = (guint8 *) (((guintptr) sink->direct_mem +
+          sink->direct_align) & ~((guintptr) sink->direct_align));
+  sink->direct_fill = 0;
+
+  GST_DEBUG_OBJECT (sink, "opened with O_DIRECT, alignment %" G_GSIZE_FORMAT
+      ", staging %" G_GSIZE_FORMAT " bytes", align, sink->direct_size);
+
+  return file;
+}
+#endif
+
 static gboolean
 gst_file_sink_open_file (GstFileSink * sink)
 {
@@ -360,15 +486,29 @@ gst_file_sink_open_file (GstFileSink * sink)
   if (sink->filename == NULL || sink->filename[0] == '\0')
     goto no_filename;
 
-  if (sink->append)
-    sink->file = gst_fopen (sink->filename, "ab");
-  else
-    sink->file = gst_fopen (sink->filename, "wb");
+  sink->file = NULL;
+  if (sink->direct_io) {
+#ifdef O_DIRECT
+    sink->file = gst_file_sink_open_direct (sink);
+    if (sink->file == NULL)
+      GST_WARNING_OBJECT (sink, "could not open with O_DIRECT: %s",
+          g_strerror (errno));
+#else
+    GST_WARNING_OBJECT (sink, "direct I/O is not supported on this platform");
+#endif
+  }
+
+  if (sink->file == NULL) {
+    if (sink->append)
+      sink->file = gst_fopen (sink->filename, "ab");
+    else
+      sink->file = gst_fopen (sink->filename, "wb");
+  }
   if (sink->file == NULL)
     goto open_failed;
 
   /* see if we are asked to perform a specific kind of buffering */
-  if ((mode = sink->buffer_mode) != -1) {
+  if (sink->direct_data == NULL && (mode = sink->buffer_mode) != -1) {
     guint buffer_size;
 
     /* free previous buffer if any */
@@ -398,6 +538,7 @@ gst_file_sink_open_file (GstFileSink * sink)
   }
 
   sink->current_pos = 0;
+  sink->preallocated = 0;
   /* try to seek in the file to figure out if it is seekable */
   sink->seekable = gst_file_sink_do_seek (sink, 0);
 
@@ -426,7 +567,16 @@ static void
 gst_file_sink_close_file (GstFileSink * sink)
 {
   if (sink->file) {
-    if (fclose (sink->file) != 0)
+    gboolean flushed;
+
+    flushed = gst_file_sink_direct_flush (sink);
+
+    g_free (sink->direct_mem);
+    sink->direct_mem = NULL;
+    sink->direct_data = NULL;
+    sink->direct_fill = 0;
+
+    if (fclose (sink->file) != 0 || !flushed)
       goto close_failed;
 
     GST_DEBUG_OBJECT (sink, "closed file");
@@ -440,6 +590,7 @@ gst_file_sink_close_file (GstFileSink * sink)
   /* ERRORS */
 close_failed:
   {
+    sink->file = NULL;
     GST_ELEMENT_ERROR (sink, RESOURCE, CLOSE,
         (_("Error closing file \"%s\"."), sink->filename), GST_ERROR_SYSTEM);
     return;
@@ -512,6 +663,9 @@ gst_file_sink_do_seek (GstFileSink * filesink, guint64 new_offset)
   GST_DEBUG_OBJECT (filesink, "Seeking to offset %" G_GUINT64_FORMAT
       " using " __GST_STDIO_SEEK_FUNCTION, new_offset);
 
+  if (!gst_file_sink_direct_flush (filesink))
+    goto flush_failed;
+
   if (fflush (filesink->file))
     goto flush_failed;
 
@@ -585,6 +739,8 @@ gst_file_sink_event (GstBaseSink * sink, GstEvent * event)
       break;
     }
     case GST_EVENT_EOS:
+      if (!gst_file_sink_direct_flush (filesink))
+        goto flush_failed;
       if (fflush (filesink->file))
         goto flush_failed;
       break;
@@ -636,6 +792,300 @@ gst_file_sink_get_current_offset (GstFileSink * filesink, guint64 * p_pos)
   return (ret != (off_t) - 1);
 }
 
+static gboolean
+gst_file_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  GstFileSink *filesink = GST_FILE_SINK (bsink);
+  GstAllocationParams params;
+
+  if (filesink->direct_data == NULL)
+    return TRUE;
+
+  /* aligned memory can be written with O_DIRECT without copying it into the
+   * staging area first */
+  gst_allocation_params_init (&params);
+  params.align = filesink->direct_align;
+  gst_query_add_allocation_param (query, NULL, &params);
+
+  return TRUE;
+}
+
+#ifdef HAVE_FALLOCATE
+/* reserve disk space up to at least @end, in chunks of preallocate-size */
+static void
+gst_file_sink_preallocate (GstFileSink * sink, guint64 end)
+{
+  guint64 chunk = sink->preallocate_size;
+  guint64 start, new_end;
+
+  if (G_LIKELY (end <= sink->preallocated))
+    return;
+
+  start = MAX (sink->preallocated, sink->current_pos);
+  new_end = ((end + chunk - 1) / chunk) * chunk;
+
+  GST_LOG_OBJECT (sink, "preallocating %" G_GUINT64_FORMAT " - %"
+      G_GUINT64_FORMAT, start, new_end);
+
+  if (fallocate (fileno (sink->file), FALLOC_FL_KEEP_SIZE, (off_t) start,
+          (off_t) (new_end - start)) < 0) {
+    GST_WARNING_OBJECT (sink, "preallocation failed, disabling: %s",
+        g_strerror (errno));
+    sink->preallocate_size = 0;
+    return;
+  }
+  sink->preallocated = new_end;
+}
+#endif
+
+#ifdef O_DIRECT
+/* write @size bytes of @data to the file descriptor, completing partial
+ * writes. The amount of bytes written is stored in @written, also when
+ * FALSE is returned with errno set on error */
+static gboolean
+gst_file_sink_write_fd (GstFileSink * sink, const guint8 * data, gsize size,
+    gsize * written)
+{
+  gint fd = fileno (sink->file);
+
+  *written = 0;
+  while (size > 0) {
+    gssize ret;
+
+    ret = write (fd, data, size);
+    if (G_UNLIKELY (ret < 0)) {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+      return FALSE;
+    }
+    data += ret;
+    size -= ret;
+    *written += ret;
+  }
+  return TRUE;
+}
+
+/* write @size bytes at file position @pos in direct I/O mode. Both the file
+ * position and the amount of data need to be aligned for O_DIRECT, so when
+ * they are not, or when the filesystem refuses the write, O_DIRECT is
+ * temporarily disabled for this write */
+static gboolean
+gst_file_sink_write_direct_fd (GstFileSink * sink, const guint8 * data,
+    gsize size, guint64 pos)
+{
+  gboolean aligned, res;
+  gint fd, flags, save_errno;
+  gsize written;
+
+  aligned = ((size | pos | (guintptr) data) & sink->direct_align) == 0;
+
+  if (aligned) {
+    if (gst_file_sink_write_fd (sink, data, size, &written))
+      return TRUE;
+    if (errno != EINVAL)
+      return FALSE;
+    /* the filesystem doesn't like the alignment, continue after what was
+     * written so far */
+    GST_DEBUG_OBJECT (sink, "aligned write refused after %" G_GSIZE_FORMAT
+        " bytes, retrying without O_DIRECT", written);
+    data += written;
+    size -= written;
+  }
+
+  GST_LOG_OBJECT (sink, "writing %" G_GSIZE_FORMAT " unaligned bytes", size);
+
+  fd = fileno (sink->file);
+  flags = fcntl (fd, F_GETFL);
+  fcntl (fd, F_SETFL, flags & ~O_DIRECT);
+
+  res = gst_file_sink_write_fd (sink, data, size, &written);
+  save_errno = errno;
+
+  fcntl (fd, F_SETFL, flags);
+  errno = save_errno;
+
+  return res;
+}
+
+/* write the staging area, which holds the data ending at @end */
+static gboolean
+gst_file_sink_direct_write_staged (GstFileSink * sink, guint64 end)
+{
+  gsize fill = sink->direct_fill;
+
+  if (fill == 0)
+    return TRUE;
+
+  sink->direct_fill = 0;
+
+  return gst_file_sink_write_direct_fd (sink, sink->direct_data, fill,
+      end - fill);
+}
+
+/* write everything that is still pending in the staging area */
+static gboolean
+gst_file_sink_direct_flush (GstFileSink * sink)
+{
+  if (sink->direct_data == NULL)
+    return TRUE;
+
+  return gst_file_sink_direct_write_staged (sink, sink->current_pos);
+}
+
+/* write @data, which starts at file position @pos, in direct I/O mode.
+ * Aligned blocks are written directly from @data when possible, everything
+ * else goes through the staging area. current_pos is advanced by the
+ * caller */
+static gboolean
+gst_file_sink_direct_write (GstFileSink * sink, const guint8 * data,
+    gsize size, guint64 pos)
+{
+  gsize align = sink->direct_align;
+
+  while (size > 0) {
+    gsize n;
+
+    if (sink->direct_fill == 0 && ((guintptr) data & align) == 0 &&
+        (pos & align) == 0 && size > align) {
+      /* zero-copy path for the aligned part of the data */
+      n = size & ~align;
+      if (!gst_file_sink_write_direct_fd (sink, data, n, pos))
+        return FALSE;
+    } else {
+      n = MIN (size, sink->direct_size - sink->direct_fill);
+      memcpy (sink->direct_data + sink->direct_fill, data, n);
+      sink->direct_fill += n;
+
+      if (sink->direct_fill == sink->direct_size &&
+          !gst_file_sink_direct_write_staged (sink, pos + n))
+        return FALSE;
+    }
+    data += n;
+    size -= n;
+    pos += n;
+  }
+  return TRUE;
+}
+
+#else
+static gboolean
+gst_file_sink_direct_flush (GstFileSink * sink)
+{
+  return TRUE;
+}
+#endif
+
+static void
+gst_file_sink_post_write_error (GstFileSink * filesink)
+{
+  switch (errno) {
+    case ENOSPC:{
+      GST_ELEMENT_ERROR (filesink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
+      break;
+    }
+    default:{
+      GST_ELEMENT_ERROR (filesink, RESOURCE, WRITE,
+          (_("Error while writing to file \"%s\"."), filesink->filename),
+          ("%s", g_strerror (errno)));
+    }
+  }
+}
+
+/* write all memory of @buffers with one writev() on the file descriptor,
+ * bypassing the stdio buffer. Anything still pending in the stdio buffer
+ * is flushed first so that the data ends up in the right order. */
+static GstFlowReturn
+gst_file_sink_render_buffers (GstFileSink * filesink, GstBuffer ** buffers,
+    guint num_buffers)
+{
+  GstFlowReturn flow;
+  guint64 written = 0;
+
+  GST_DEBUG_OBJECT (filesink, "writing %u buffers at %" G_GUINT64_FORMAT,
+      num_buffers, filesink->current_pos);
+
+#ifdef HAVE_FALLOCATE
+  if (filesink->preallocate_size > 0) {
+    guint i;
+    gsize size = 0;
+
+    for (i = 0; i < num_buffers; i++)
+      size += gst_buffer_get_size (buffers[i]);
+    gst_file_sink_preallocate (filesink, filesink->current_pos + size);
+  }
+#endif
+
+#ifdef O_DIRECT
+  if (filesink->direct_data) {
+    guint i, j;
+
+    for (i = 0; i < num_buffers; i++) {
+      for (j = 0; j < gst_buffer_n_memory (buffers[i]); j++) {
+        GstMemory *mem = gst_buffer_peek_memory (buffers[i], j);
+        GstMapInfo info;
+        gboolean res;
+
+        if (!gst_memory_map (mem, &info, GST_MAP_READ))
+          goto map_error;
+        res = gst_file_sink_direct_write (filesink, info.data, info.size,
+            filesink->current_pos);
+        gst_memory_unmap (mem, &info);
+        if (!res)
+          goto write_error;
+        filesink->current_pos += info.size;
+      }
+    }
+    return GST_FLOW_OK;
+  }
+#endif
+
+  if (fflush (filesink->file))
+    goto write_error;
+
+  flow = gst_writev_buffers (GST_OBJECT_CAST (filesink),
+      fileno (filesink->file), buffers, num_buffers, &written);
+  if (flow != GST_FLOW_OK)
+    goto write_error;
+
+  filesink->current_pos += written;
+
+  return GST_FLOW_OK;
+
+write_error:
+  {
+    gst_file_sink_post_write_error (filesink);
+    return GST_FLOW_ERROR;
+  }
+#ifdef O_DIRECT
+map_error:
+  {
+    GST_ELEMENT_ERROR (filesink, RESOURCE, WRITE, (NULL),
+        ("Could not map buffer"));
+    return GST_FLOW_ERROR;
+  }
+#endif
+}
+
+static GstFlowReturn
+gst_file_sink_render_list (GstBaseSink * sink, GstBufferList * list)
+{
+  GstFileSink *filesink;
+  GstBuffer **buffers;
+  guint i, num_buffers;
+
+  filesink = GST_FILE_SINK (sink);
+
+  num_buffers = gst_buffer_list_length (list);
+  if (num_buffers == 0)
+    return GST_FLOW_OK;
+
+  buffers = g_newa (GstBuffer *, num_buffers);
+  for (i = 0; i < num_buffers; i++)
+    buffers[i] = gst_buffer_list_get (list, i);
+
+  return gst_file_sink_render_buffers (filesink, buffers, num_buffers);
+}
+
 static GstFlowReturn
 gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
@@ -644,6 +1094,11 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
   filesink = GST_FILE_SINK (sink);
 
+  /* buffers made of several memory blocks are written without merging
+   * them first, direct I/O never goes through stdio */
+  if (gst_buffer_n_memory (buffer) > 1 || filesink->direct_data != NULL)
+    return gst_file_sink_render_buffers (filesink, &buffer, 1);
+
   gst_buffer_map (buffer, &info, GST_MAP_READ);
 
   GST_DEBUG_OBJECT (filesink,
@@ -651,6 +1106,10 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
       info.size, filesink->current_pos);
 
   if (info.size > 0 && info.data != NULL) {
+#ifdef HAVE_FALLOCATE
+    if (filesink->preallocate_size > 0)
+      gst_file_sink_preallocate (filesink, filesink->current_pos + info.size);
+#endif
     if (fwrite (info.data, info.size, 1, filesink->file) != 1)
       goto handle_error;
 
@@ -662,17 +1121,7 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 
 handle_error:
   {
-    switch (errno) {
-      case ENOSPC:{
-        GST_ELEMENT_ERROR (filesink, RESOURCE, NO_SPACE_LEFT, (NULL), (NULL));
-        break;
-      }
-      default:{
-        GST_ELEMENT_ERROR (filesink, RESOURCE, WRITE,
-            (_("Error while writing to file \"%s\"."), filesink->filename),
-            ("%s", g_strerror (errno)));
-      }
-    }
+    gst_file_sink_post_write_error (filesink);
     gst_buffer_unmap (buffer, &info);
     return GST_FLOW_ERROR;
   }
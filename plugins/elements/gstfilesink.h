@@ -66,6 +66,17 @@ struct _GstFileSink {
   gchar  *buffer;
   
   gboolean append;
+
+  gboolean direct_io;
+  guint64  preallocate_size;
+  guint64  preallocated;     /* end of the preallocated region */
+
+  /* staging area for O_DIRECT writes */
+  guint8  *direct_mem;       /* allocated memory */
+  guint8  *direct_data;      /* aligned start of the staging area */
+  gsize    direct_size;      /* size of the staging area */
+  gsize    direct_fill;      /* bytes pending in the staging area */
+  gsize    direct_align;     /* required alignment - 1 */
 };
 
 struct _GstFileSinkClass {
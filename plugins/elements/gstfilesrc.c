@@ -30,6 +30,13 @@
  * |[
  * gst-launch filesrc location=song.ogg ! decodebin2 ! autoaudiosink
  * ]| Play a song.ogg from local dir.
+ * |[
+ * gst-launch filesrc location=movie.mkv use-mmap=true ! matroskademux ! fakesink
+ * ]| Demux a local file from memory mapped regions, without copying the
+ * data out of the page cache.
+ * |[
+ * gst-launch filesrc location=movie.mkv readahead=8 ! matroskademux ! fakesink
+ * ]| Keep up to 8 blocks read ahead of the demuxer when it pulls sequentially.
  * </refsect2>
  */
 
@@ -61,6 +68,10 @@
 #endif
 #include <fcntl.h>
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
@@ -128,13 +139,187 @@ enum
 };
 
 #define DEFAULT_BLOCKSIZE       4*1024
+#define DEFAULT_USE_MMAP        FALSE
 
 enum
 {
   PROP_0,
-  PROP_LOCATION
+  PROP_LOCATION,
+  PROP_USE_MMAP
 };
 
+#ifdef HAVE_MMAP
+/* Memory wrapping a read-only mapping of the file. The memory that owns the
+ * mapping has no parent, all the memory handed out downstream is created with
+ * gst_memory_share() from it and keeps it alive until the last buffer is
+ * released. */
+typedef struct
+{
+  GstMemory mem;
+
+  guint8 *data;
+} GstFileSrcMmapMemory;
+
+typedef struct
+{
+  GstAllocator parent;
+} GstFileSrcMmapAllocator;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstFileSrcMmapAllocatorClass;
+
+#define GST_FILE_SRC_MMAP_MEMORY_TYPE "FileSrcMmap"
+
+static GType gst_file_src_mmap_allocator_get_type (void);
+G_DEFINE_TYPE (GstFileSrcMmapAllocator, gst_file_src_mmap_allocator,
+    GST_TYPE_ALLOCATOR);
+
+static GstMemory *
+gst_file_src_mmap_mem_new (GstAllocator * allocator, GstMemory * parent,
+    guint8 * data, gsize maxsize, gsize offset, gsize size)
+{
+  GstFileSrcMmapMemory *mem;
+
+  mem = g_slice_new (GstFileSrcMmapMemory);
+  gst_memory_init (GST_MEMORY_CAST (mem), GST_MEMORY_FLAG_READONLY,
+      allocator, parent, maxsize, 0, offset, size);
+  mem->data = data;
+
+  return GST_MEMORY_CAST (mem);
+}
+
+static gpointer
+gst_file_src_mmap_mem_map (GstFileSrcMmapMemory * mem, gsize maxsize,
+    GstMapFlags flags)
+{
+  /* the mapping is read-only */
+  if (flags & GST_MAP_WRITE)
+    return NULL;
+
+  return mem->data;
+}
+
+static void
+gst_file_src_mmap_mem_unmap (GstFileSrcMmapMemory * mem)
+{
+}
+
+static GstMemory *
+gst_file_src_mmap_mem_share (GstFileSrcMmapMemory * mem, gssize offset,
+    gssize size)
+{
+  GstMemory *parent;
+
+  /* find the real parent */
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  return gst_file_src_mmap_mem_new (mem->mem.allocator, parent, mem->data,
+      mem->mem.maxsize, mem->mem.offset + offset, size);
+}
+
+static GstMemory *
+gst_file_src_mmap_mem_copy (GstFileSrcMmapMemory * mem, gssize offset,
+    gssize size)
+{
+  GstMemory *copy;
+  GstMapInfo info;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  /* copies are writable, so they go into system memory */
+  copy = gst_allocator_alloc (NULL, size, NULL);
+  if (!gst_memory_map (copy, &info, GST_MAP_WRITE)) {
+    gst_memory_unref (copy);
+    return NULL;
+  }
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSSIZE_FORMAT " mapped memory %p -> %p", size, mem, copy);
+  memcpy (info.data, mem->data + mem->mem.offset + offset, size);
+  gst_memory_unmap (copy, &info);
+
+  return copy;
+}
+
+static gboolean
+gst_file_src_mmap_mem_is_span (GstFileSrcMmapMemory * mem1,
+    GstFileSrcMmapMemory * mem2, gsize * offset)
+{
+  if (offset) {
+    GstMemory *parent;
+
+    parent = mem1->mem.parent;
+
+    *offset = mem1->mem.offset - parent->offset;
+  }
+
+  /* and memory is contiguous */
+  return mem1->data + mem1->mem.offset + mem1->mem.size ==
+      mem2->data + mem2->mem.offset;
+}
+
+static void
+gst_file_src_mmap_allocator_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstFileSrcMmapMemory *mmem = (GstFileSrcMmapMemory *) mem;
+
+  /* only the memory that owns the mapping unmaps it */
+  if (mem->parent == NULL) {
+    GST_LOG ("unmapping region of size %" G_GSIZE_FORMAT, mem->maxsize);
+    munmap ((void *) mmem->data, mem->maxsize);
+  }
+
+  g_slice_free (GstFileSrcMmapMemory, mmem);
+}
+
+static void
+gst_file_src_mmap_allocator_class_init (GstFileSrcMmapAllocatorClass * klass)
+{
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  /* no alloc function, memory can only be created by mapping a file */
+  allocator_class->alloc = NULL;
+  allocator_class->free = gst_file_src_mmap_allocator_free;
+}
+
+static void
+gst_file_src_mmap_allocator_init (GstFileSrcMmapAllocator * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  alloc->mem_type = GST_FILE_SRC_MMAP_MEMORY_TYPE;
+  alloc->mem_map = (GstMemoryMapFunction) gst_file_src_mmap_mem_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) gst_file_src_mmap_mem_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) gst_file_src_mmap_mem_copy;
+  alloc->mem_share = (GstMemoryShareFunction) gst_file_src_mmap_mem_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) gst_file_src_mmap_mem_is_span;
+}
+
+/* memory does not keep a ref on its allocator, so the allocator needs to
+ * outlive all filesrc instances and their buffers */
+static GstAllocator *
+gst_file_src_mmap_allocator_get (void)
+{
+  static GstAllocator *allocator = NULL;
+
+  if (g_once_init_enter (&allocator)) {
+    GstAllocator *alloc;
+
+    alloc = g_object_new (gst_file_src_mmap_allocator_get_type (), NULL);
+    gst_allocator_register (GST_FILE_SRC_MMAP_MEMORY_TYPE,
+        gst_object_ref (alloc));
+    g_once_init_leave (&allocator, alloc);
+  }
+  return allocator;
+}
+#endif
+
 static void gst_file_src_finalize (GObject * object);
 
 static void gst_file_src_set_property (GObject * object, guint prop_id,
@@ -149,6 +334,8 @@ static gboolean gst_file_src_is_seekable (GstBaseSrc * src);
 static gboolean gst_file_src_get_size (GstBaseSrc * src, guint64 * size);
 static GstFlowReturn gst_file_src_fill (GstBaseSrc * src, guint64 offset,
     guint length, GstBuffer * buf);
+static GstFlowReturn gst_file_src_create (GstBaseSrc * src, guint64 offset,
+    guint length, GstBuffer ** buf);
 
 static void gst_file_src_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
@@ -178,6 +365,19 @@ gst_file_src_class_init (GstFileSrcClass * klass)
           "Location of the file to read", NULL,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
+  /**
+   * GstFileSrc:use-mmap
+   *
+   * Map the file into memory and push read-only buffers that wrap regions of
+   * the mapping instead of reading the data into newly allocated buffers.
+   * This avoids copying the data out of the page cache. When the file can't
+   * be mapped, or on platforms without mmap(), regular reads are used.
+   */
+  g_object_class_install_property (gobject_class, PROP_USE_MMAP,
+      g_param_spec_boolean ("use-mmap", "Use mmap",
+          "Push read-only buffers wrapping a memory mapping of the file",
+          DEFAULT_USE_MMAP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
 
   gobject_class->finalize = gst_file_src_finalize;
 
@@ -194,6 +394,7 @@ gst_file_src_class_init (GstFileSrcClass * klass)
   gstbasesrc_class->is_seekable = GST_DEBUG_FUNCPTR (gst_file_src_is_seekable);
   gstbasesrc_class->get_size = GST_DEBUG_FUNCPTR (gst_file_src_get_size);
   gstbasesrc_class->fill = GST_DEBUG_FUNCPTR (gst_file_src_fill);
+  gstbasesrc_class->create = GST_DEBUG_FUNCPTR (gst_file_src_create);
 
   if (sizeof (off_t) < 8) {
     GST_LOG ("No large file support, sizeof (off_t) = %" G_GSIZE_FORMAT "!",
@@ -210,6 +411,10 @@ gst_file_src_init (GstFileSrc * src)
 
   src->is_regular = FALSE;
 
+  src->use_mmap = DEFAULT_USE_MMAP;
+  src->mapping = NULL;
+  src->mapsize = 0;
+
   gst_base_src_set_blocksize (GST_BASE_SRC (src), DEFAULT_BLOCKSIZE);
 }
 
@@ -282,6 +487,9 @@ gst_file_src_set_property (GObject * object, guint prop_id,
     case PROP_LOCATION:
       gst_file_src_set_location (src, g_value_get_string (value));
       break;
+    case PROP_USE_MMAP:
+      src->use_mmap = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -302,6 +510,9 @@ gst_file_src_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_LOCATION:
       g_value_set_string (value, src->filename);
       break;
+    case PROP_USE_MMAP:
+      g_value_set_boolean (value, src->use_mmap);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -401,6 +612,40 @@ eos:
   }
 }
 
+static GstFlowReturn
+gst_file_src_create (GstBaseSrc * basesrc, guint64 offset, guint length,
+    GstBuffer ** buffer)
+{
+  GstFileSrc *src = GST_FILE_SRC_CAST (basesrc);
+  GstBuffer *buf;
+
+  /* when downstream provides a buffer we need to fill it anyway, also read
+   * anything that lies beyond the mapping, like data appended to the file
+   * after we mapped it */
+  if (src->mapping == NULL || *buffer != NULL || offset >= src->mapsize)
+    return GST_BASE_SRC_CLASS (parent_class)->create (basesrc, offset, length,
+        buffer);
+
+  /* short read at the end of the mapping */
+  if (offset + length > src->mapsize)
+    length = src->mapsize - offset;
+
+  GST_LOG_OBJECT (src, "sharing %u bytes at offset 0x%" G_GINT64_MODIFIER
+      "x from mapping", length, offset);
+
+  buf = gst_buffer_new ();
+  if (length > 0)
+    gst_buffer_append_memory (buf, gst_memory_share (src->mapping, offset,
+            length));
+
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = offset + length;
+
+  *buffer = buf;
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_file_src_is_seekable (GstBaseSrc * basesrc)
 {
@@ -491,6 +736,36 @@ gst_file_src_start (GstBaseSrc * basesrc)
 
   gst_base_src_set_dynamic_size (basesrc, src->seekable);
 
+#ifdef HAVE_POSIX_FADVISE
+  /* we mostly read front to back, let the kernel keep a larger readahead
+   * window in flight for us */
+  if (src->is_regular && posix_fadvise (src->fd, 0, 0,
+          POSIX_FADV_SEQUENTIAL) != 0)
+    GST_DEBUG_OBJECT (src, "could not set sequential access hint");
+#endif
+
+#ifdef HAVE_MMAP
+  /* only regular files can be mapped, the mapped region is fixed to the size
+   * the file had when it was opened */
+  if (src->use_mmap && src->is_regular && stat_results.st_size > 0) {
+    guint64 size = stat_results.st_size;
+    void *data = MAP_FAILED;
+
+    if (size == (gsize) size)
+      data = mmap (NULL, size, PROT_READ, MAP_SHARED, src->fd, 0);
+
+    if (data != MAP_FAILED) {
+      GST_INFO_OBJECT (src, "mapped %" G_GUINT64_FORMAT " bytes", size);
+      src->mapping = gst_file_src_mmap_mem_new
+          (gst_file_src_mmap_allocator_get (), NULL, data, size, 0, size);
+      src->mapsize = size;
+    } else {
+      GST_WARNING_OBJECT (src, "could not map file, falling back to read: %s",
+          g_strerror (errno));
+    }
+  }
+#endif
+
   return TRUE;
 
   /* ERROR */
@@ -545,6 +820,13 @@ gst_file_src_stop (GstBaseSrc * basesrc)
 {
   GstFileSrc *src = GST_FILE_SRC (basesrc);
 
+  /* buffers that are still in use keep the mapping alive */
+  if (src->mapping) {
+    gst_memory_unref (src->mapping);
+    src->mapping = NULL;
+    src->mapsize = 0;
+  }
+
   /* close the file */
   close (src->fd);
 
@@ -63,6 +63,10 @@ struct _GstFileSrc {
   gboolean seekable;                    /* whether the file is seekable */
   gboolean is_regular;                  /* whether it's a (symlink to a)
                                            regular file */
+
+  gboolean use_mmap;                    /* whether to hand out mapped memory */
+  GstMemory *mapping;                   /* memory wrapping the mapped file */
+  guint64 mapsize;                      /* size of the mapped region */
 };
 
 struct _GstFileSrcClass {
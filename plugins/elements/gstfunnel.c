@@ -266,10 +266,10 @@ gst_funnel_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
   GST_DEBUG_OBJECT (funnel, "received buffer %p", buffer);
 
-  GST_OBJECT_LOCK (funnel);
-
+  /* the segment and EOS state of the pad are only changed from serialized
+   * events, which are handled with the same STREAM_LOCK as we have now, so
+   * we don't need the OBJECT_LOCK for them here */
   if (fpad->got_eos) {
-    GST_OBJECT_UNLOCK (funnel);
     GST_WARNING_OBJECT (funnel, "Got buffer on pad that received EOS");
     res = GST_FLOW_EOS;
     gst_buffer_unref (buffer);
@@ -292,14 +292,14 @@ gst_funnel_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     GST_BUFFER_TIMESTAMP (buffer) = newts;
   }
 
-  if (!funnel->has_segment) {
+  /* only the first buffer after start or a flush sends the segment */
+  if (G_UNLIKELY (!g_atomic_int_get (&funnel->has_segment)) &&
+      g_atomic_int_compare_and_exchange (&funnel->has_segment, FALSE, TRUE)) {
     GstSegment segment;
 
     gst_segment_init (&segment, GST_FORMAT_TIME);
     event = gst_event_new_segment (&segment);
-    funnel->has_segment = TRUE;
   }
-  GST_OBJECT_UNLOCK (funnel);
 
   if (event) {
     if (!gst_pad_push_event (funnel->srcpad, event))
@@ -350,7 +350,7 @@ gst_funnel_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
     {
       GST_OBJECT_LOCK (funnel);
       gst_segment_init (&fpad->segment, GST_FORMAT_UNDEFINED);
-      funnel->has_segment = FALSE;
+      g_atomic_int_set (&funnel->has_segment, FALSE);
       fpad->got_eos = FALSE;
       GST_OBJECT_UNLOCK (funnel);
     }
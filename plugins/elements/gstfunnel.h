@@ -55,6 +55,7 @@ struct _GstFunnel {
   /*< private >*/
   GstPad         *srcpad;
 
+  /* accessed with atomic operations from the streaming threads */
   gboolean has_segment;
 };
 
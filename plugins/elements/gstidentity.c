@@ -70,6 +70,7 @@ enum
 #define DEFAULT_CHECK_IMPERFECT_TIMESTAMP FALSE
 #define DEFAULT_CHECK_IMPERFECT_OFFSET    FALSE
 #define DEFAULT_SIGNAL_HANDOFFS           TRUE
+#define DEFAULT_SAMPLE_INTERVAL           1
 
 enum
 {
@@ -85,7 +86,9 @@ enum
   PROP_SYNC,
   PROP_CHECK_IMPERFECT_TIMESTAMP,
   PROP_CHECK_IMPERFECT_OFFSET,
-  PROP_SIGNAL_HANDOFFS
+  PROP_SIGNAL_HANDOFFS,
+  PROP_SAMPLE_INTERVAL,
+  PROP_STATS
 };
 
 
@@ -166,7 +169,8 @@ gst_identity_class_init (GstIdentityClass * klass)
           "Timestamp buffers and eat segments so as to appear as one segment",
           DEFAULT_SINGLE_SEGMENT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   pspec_last_message = g_param_spec_string ("last-message", "last-message",
-      "last-message", NULL, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+      "last-message", NULL,
+      G_PARAM_READABLE | GST_PARAM_HIGH_FREQUENCY | G_PARAM_STATIC_STRINGS);
   g_object_class_install_property (gobject_class, PROP_LAST_MESSAGE,
       pspec_last_message);
   g_object_class_install_property (gobject_class, PROP_DUMP,
@@ -201,6 +205,38 @@ gst_identity_class_init (GstIdentityClass * klass)
           "Signal handoffs", "Send a signal before pushing the buffer",
           DEFAULT_SIGNAL_HANDOFFS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstIdentity:sample-interval
+   *
+   * When not silent, only update #GstIdentity:last-message for every Nth
+   * buffer. Formatting the message and notifying it is expensive, so a
+   * larger interval makes it possible to keep a non-silent identity in a
+   * pipeline with a high buffer rate.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_SAMPLE_INTERVAL,
+      g_param_spec_uint ("sample-interval", "Sample Interval",
+          "Only update last-message for every Nth buffer", 1, G_MAXUINT,
+          DEFAULT_SAMPLE_INTERVAL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstIdentity:stats
+   *
+   * A "GstIdentityStats" structure with the number of buffers
+   * ("num-buffers") and bytes ("num-bytes") that were handled since the
+   * element was started, both as #guint64. The counters are maintained
+   * regardless of #GstIdentity:silent and the structure is only created
+   * when the property is read, so this is a cheap way to monitor the
+   * dataflow.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Statistics",
+          "Statistics of the handled buffers", GST_TYPE_STRUCTURE,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstIdentity::handoff:
    * @identity: the identity instance
@@ -251,6 +287,7 @@ gst_identity_init (GstIdentity * identity)
   identity->dump = DEFAULT_DUMP;
   identity->last_message = NULL;
   identity->signal_handoffs = DEFAULT_SIGNAL_HANDOFFS;
+  identity->sample_interval = DEFAULT_SAMPLE_INTERVAL;
 
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM_CAST (identity), TRUE);
 }
@@ -506,6 +543,20 @@ gst_identity_update_last_message_for_buffer (GstIdentity * identity,
   gst_identity_notify_last_message (identity);
 }
 
+/* returns TRUE when the last-message should be updated for this buffer */
+static inline gboolean
+gst_identity_sample_buffer (GstIdentity * identity)
+{
+  if (identity->silent)
+    return FALSE;
+
+  if (++identity->sample_count < identity->sample_interval)
+    return FALSE;
+
+  identity->sample_count = 0;
+  return TRUE;
+}
+
 static GstFlowReturn
 gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
@@ -516,6 +567,11 @@ gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 
   size = gst_buffer_get_size (buf);
 
+  GST_OBJECT_LOCK (identity);
+  identity->num_buffers++;
+  identity->num_bytes += size;
+  GST_OBJECT_UNLOCK (identity);
+
   if (identity->check_imperfect_timestamp)
     gst_identity_check_imperfect_timestamp (identity, buf);
   if (identity->check_imperfect_offset)
@@ -546,7 +602,7 @@ gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
     gst_buffer_unmap (buf, &info);
   }
 
-  if (!identity->silent) {
+  if (gst_identity_sample_buffer (identity)) {
     gst_identity_update_last_message_for_buffer (identity, "chain", buf, size);
   }
 
@@ -615,7 +671,7 @@ error_after:
   }
 dropped:
   {
-    if (!identity->silent) {
+    if (gst_identity_sample_buffer (identity)) {
       gst_identity_update_last_message_for_buffer (identity, "dropping", buf,
           size);
     }
@@ -666,6 +722,9 @@ gst_identity_set_property (GObject * object, guint prop_id,
     case PROP_SIGNAL_HANDOFFS:
       identity->signal_handoffs = g_value_get_boolean (value);
       break;
+    case PROP_SAMPLE_INTERVAL:
+      identity->sample_interval = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -723,6 +782,16 @@ gst_identity_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_SIGNAL_HANDOFFS:
       g_value_set_boolean (value, identity->signal_handoffs);
       break;
+    case PROP_SAMPLE_INTERVAL:
+      g_value_set_uint (value, identity->sample_interval);
+      break;
+    case PROP_STATS:
+      GST_OBJECT_LOCK (identity);
+      g_value_take_boxed (value, gst_structure_new ("GstIdentityStats",
+              "num-buffers", G_TYPE_UINT64, identity->num_buffers,
+              "num-bytes", G_TYPE_UINT64, identity->num_bytes, NULL));
+      GST_OBJECT_UNLOCK (identity);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -737,6 +806,11 @@ gst_identity_start (GstBaseTransform * trans)
   identity = GST_IDENTITY (trans);
 
   identity->offset = 0;
+  identity->sample_count = 0;
+  GST_OBJECT_LOCK (identity);
+  identity->num_buffers = 0;
+  identity->num_bytes = 0;
+  GST_OBJECT_UNLOCK (identity);
   identity->prev_timestamp = GST_CLOCK_TIME_NONE;
   identity->prev_duration = GST_CLOCK_TIME_NONE;
   identity->prev_offset_end = GST_BUFFER_OFFSET_NONE;
@@ -72,6 +72,10 @@ struct _GstIdentity {
   gchar 	*last_message;
   guint64        offset;
   gboolean       signal_handoffs;
+  guint          sample_interval;
+  guint          sample_count;
+  guint64        num_buffers;
+  guint64        num_bytes;
 };
 
 struct _GstIdentityClass {
@@ -108,12 +108,14 @@ enum
   PROP_ACTIVE_PAD,
   PROP_SYNC_STREAMS,
   PROP_SYNC_MODE,
-  PROP_CACHE_BUFFERS
+  PROP_CACHE_BUFFERS,
+  PROP_KEYFRAME_CACHE
 };
 
 #define DEFAULT_SYNC_STREAMS TRUE
 #define DEFAULT_SYNC_MODE GST_INPUT_SELECTOR_SYNC_MODE_ACTIVE_SEGMENT
 #define DEFAULT_CACHE_BUFFERS FALSE
+#define DEFAULT_KEYFRAME_CACHE FALSE
 #define DEFAULT_PAD_ALWAYS_OK TRUE
 
 enum
@@ -181,6 +183,9 @@ struct _GstSelectorPad
 
   gboolean sending_cached_buffers;
   GQueue *cached_buffers;
+
+  /* buffers since the last keyframe while the pad is inactive */
+  GQueue keyframe_buffers;
 };
 
 struct _GstSelectorPadCachedBuffer
@@ -214,6 +219,7 @@ static GstFlowReturn gst_selector_pad_chain (GstPad * pad, GstObject * parent,
 static void gst_selector_pad_cache_buffer (GstSelectorPad * selpad,
     GstBuffer * buffer);
 static void gst_selector_pad_free_cached_buffers (GstSelectorPad * selpad);
+static void gst_selector_pad_free_keyframe_buffers (GstSelectorPad * selpad);
 
 G_DEFINE_TYPE (GstSelectorPad, gst_selector_pad, GST_TYPE_PAD);
 
@@ -252,6 +258,7 @@ static void
 gst_selector_pad_init (GstSelectorPad * pad)
 {
   pad->always_ok = DEFAULT_PAD_ALWAYS_OK;
+  g_queue_init (&pad->keyframe_buffers);
   gst_selector_pad_reset (pad);
 }
 
@@ -265,6 +272,7 @@ gst_selector_pad_finalize (GObject * object)
   if (pad->tags)
     gst_tag_list_unref (pad->tags);
   gst_selector_pad_free_cached_buffers (pad);
+  gst_selector_pad_free_keyframe_buffers (pad);
 
   G_OBJECT_CLASS (gst_selector_pad_parent_class)->finalize (object);
 }
@@ -359,6 +367,7 @@ gst_selector_pad_reset (GstSelectorPad * pad)
   gst_segment_init (&pad->segment, GST_FORMAT_UNDEFINED);
   pad->sending_cached_buffers = FALSE;
   gst_selector_pad_free_cached_buffers (pad);
+  gst_selector_pad_free_keyframe_buffers (pad);
   GST_OBJECT_UNLOCK (pad);
 }
 
@@ -412,6 +421,36 @@ gst_selector_pad_free_cached_buffers (GstSelectorPad * selpad)
   selpad->cached_buffers = NULL;
 }
 
+/* must be called with the SELECTOR_LOCK */
+static void
+gst_selector_pad_free_keyframe_buffers (GstSelectorPad * selpad)
+{
+  GstBuffer *buffer;
+
+  while ((buffer = g_queue_pop_head (&selpad->keyframe_buffers)))
+    gst_buffer_unref (buffer);
+}
+
+/* keep the buffers of an inactive pad starting at the last keyframe so that
+ * they can be sent when the pad is activated. Takes ownership of @buffer and
+ * returns %FALSE when it was not cached.
+ * must be called with the SELECTOR_LOCK */
+static gboolean
+gst_selector_pad_keyframe_cache_buffer (GstSelectorPad * selpad,
+    GstBuffer * buffer)
+{
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    /* everything before can't be decoded anymore */
+    gst_selector_pad_free_keyframe_buffers (selpad);
+  } else if (g_queue_is_empty (&selpad->keyframe_buffers)) {
+    /* no keyframe yet */
+    return FALSE;
+  }
+
+  g_queue_push_tail (&selpad->keyframe_buffers, buffer);
+  return TRUE;
+}
+
 /* strictly get the linked pad from the sinkpad. If the pad is active we return
  * the srcpad else we return NULL */
 static GstIterator *
@@ -477,6 +516,8 @@ gst_selector_pad_event (GstPad * pad, GstObject * parent, GstEvent * event)
       break;
     case GST_EVENT_SEGMENT:
     {
+      /* cached buffers were in the previous segment */
+      gst_selector_pad_free_keyframe_buffers (selpad);
       gst_event_copy_segment (event, &selpad->segment);
       selpad->segment_seqnum = gst_event_get_seqnum (event);
 
@@ -921,6 +962,7 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   GstPad *prev_active_sinkpad;
   GstSelectorPad *selpad;
   GstClockTime start_time;
+  GQueue keyframe_buffers = G_QUEUE_INIT;
 
   sel = GST_INPUT_SELECTOR (parent);
   selpad = GST_SELECTOR_PAD_CAST (pad);
@@ -929,6 +971,28 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       "entering chain for buf %p with timestamp %" GST_TIME_FORMAT, buf,
       GST_TIME_ARGS (GST_BUFFER_TIMESTAMP (buf)));
 
+  /* fast path for the active pad when the streams don't need to be synced:
+   * after the first buffer was forwarded, nothing but the position is updated
+   * until the active pad changes, which resets pushed and sets
+   * events_pending before publishing the new pad. The flags are written
+   * atomically under the selector lock, so they can be read here without
+   * it. */
+  if (!g_atomic_int_get (&sel->sync_streams)
+      && !g_atomic_int_get (&sel->blocked)
+      && g_atomic_pointer_get (&sel->active_sinkpad) == pad
+      && selpad->pushed && !selpad->events_pending && !selpad->discont) {
+    start_time = GST_BUFFER_TIMESTAMP (buf);
+    if (GST_CLOCK_TIME_IS_VALID (start_time)) {
+      GST_OBJECT_LOCK (pad);
+      selpad->position = start_time;
+      selpad->segment.position = start_time;
+      GST_OBJECT_UNLOCK (pad);
+    }
+
+    GST_LOG_OBJECT (pad, "Forwarding buffer %p on fast path", buf);
+    return gst_pad_push (sel->srcpad, buf);
+  }
+
   GST_INPUT_SELECTOR_LOCK (sel);
   /* wait or check for flushing */
   if (gst_input_selector_wait (sel, selpad)) {
@@ -1018,6 +1082,17 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   if (sel->sync_streams)
     GST_INPUT_SELECTOR_BROADCAST (sel);
 
+  /* the pad was just activated, take the buffers since the last keyframe
+   * unless this buffer is a keyframe itself */
+  if (!selpad->pushed && !g_queue_is_empty (&selpad->keyframe_buffers)) {
+    if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+      keyframe_buffers = selpad->keyframe_buffers;
+      g_queue_init (&selpad->keyframe_buffers);
+    } else {
+      gst_selector_pad_free_keyframe_buffers (selpad);
+    }
+  }
+
   GST_INPUT_SELECTOR_UNLOCK (sel);
 
   if (prev_active_sinkpad != active_sinkpad && pad == active_sinkpad) {
@@ -1032,6 +1107,24 @@ gst_selector_pad_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
     selpad->events_pending = FALSE;
   }
 
+  if (!g_queue_is_empty (&keyframe_buffers)) {
+    GstBuffer *cached;
+
+    GST_DEBUG_OBJECT (pad, "Forwarding %u buffers since the last keyframe",
+        keyframe_buffers.length);
+
+    cached = g_queue_pop_head (&keyframe_buffers);
+    cached = gst_buffer_make_writable (cached);
+    GST_BUFFER_FLAG_SET (cached, GST_BUFFER_FLAG_DISCONT);
+    selpad->discont = FALSE;
+
+    do {
+      res = gst_pad_push (sel->srcpad, cached);
+      if (res != GST_FLOW_OK)
+        GST_DEBUG_OBJECT (pad, "cached buffer forwarded result=%d", res);
+    } while ((cached = g_queue_pop_head (&keyframe_buffers)));
+  }
+
   if (selpad->discont) {
     buf = gst_buffer_make_writable (buf);
 
@@ -1076,8 +1169,13 @@ ignore:
     GST_DEBUG_OBJECT (pad, "Pad not active, discard buffer %p", buf);
     /* when we drop a buffer, we're creating a discont on this pad */
     selpad->discont = TRUE;
+    /* the replay cache of sync mode takes care of reactivation */
+    if (sel->keyframe_cache && !(sel->sync_streams && sel->cache_buffers)
+        && gst_selector_pad_keyframe_cache_buffer (selpad, buf))
+      buf = NULL;
     GST_INPUT_SELECTOR_UNLOCK (sel);
-    gst_buffer_unref (buf);
+    if (buf)
+      gst_buffer_unref (buf);
 
     /* figure out what to return upstream */
     GST_OBJECT_LOCK (selpad);
@@ -1202,6 +1300,27 @@ gst_input_selector_class_init (GstInputSelectorClass * klass)
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
           GST_PARAM_MUTABLE_READY));
 
+  /**
+   * GstInputSelector:keyframe-cache
+   *
+   * If set to %TRUE, inactive pads keep the buffers they receive since their
+   * most recent keyframe, a buffer without the %GST_BUFFER_FLAG_DELTA_UNIT
+   * flag. When such a pad becomes active, these buffers are forwarded first
+   * so that downstream gets decodable data immediately instead of waiting for
+   * the next keyframe.
+   *
+   * This has no effect on pads while GstInputSelector:cache-buffers is used
+   * with GstInputSelector:sync-streams.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_KEYFRAME_CACHE,
+      g_param_spec_boolean ("keyframe-cache", "Keyframe Cache",
+          "Keep the buffers since the last keyframe on inactive pads",
+          DEFAULT_KEYFRAME_CACHE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_PLAYING));
+
   /**
    * GstInputSelector::block:
    * @inputselector: the #GstInputSelector
@@ -1249,6 +1368,7 @@ gst_input_selector_init (GstInputSelector * sel)
   sel->active_sinkpad = NULL;
   sel->padcount = 0;
   sel->sync_streams = DEFAULT_SYNC_STREAMS;
+  sel->keyframe_cache = DEFAULT_KEYFRAME_CACHE;
 
   g_mutex_init (&sel->lock);
   g_cond_init (&sel->cond);
@@ -1354,7 +1474,7 @@ gst_input_selector_set_property (GObject * object, guint prop_id,
     }
     case PROP_SYNC_STREAMS:
       GST_INPUT_SELECTOR_LOCK (sel);
-      sel->sync_streams = g_value_get_boolean (value);
+      g_atomic_int_set (&sel->sync_streams, g_value_get_boolean (value));
       GST_INPUT_SELECTOR_UNLOCK (sel);
       break;
     case PROP_SYNC_MODE:
@@ -1367,6 +1487,21 @@ gst_input_selector_set_property (GObject * object, guint prop_id,
       sel->cache_buffers = g_value_get_boolean (value);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_KEYFRAME_CACHE:
+    {
+      GList *walk;
+
+      GST_INPUT_SELECTOR_LOCK (object);
+      sel->keyframe_cache = g_value_get_boolean (value);
+      if (!sel->keyframe_cache) {
+        GST_OBJECT_LOCK (sel);
+        for (walk = GST_ELEMENT_CAST (sel)->sinkpads; walk; walk = walk->next)
+          gst_selector_pad_free_keyframe_buffers (walk->data);
+        GST_OBJECT_UNLOCK (sel);
+      }
+      GST_INPUT_SELECTOR_UNLOCK (object);
+      break;
+    }
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1415,6 +1550,11 @@ gst_input_selector_get_property (GObject * object, guint prop_id,
       g_value_set_boolean (value, sel->cache_buffers);
       GST_INPUT_SELECTOR_UNLOCK (object);
       break;
+    case PROP_KEYFRAME_CACHE:
+      GST_INPUT_SELECTOR_LOCK (object);
+      g_value_set_boolean (value, sel->keyframe_cache);
+      GST_INPUT_SELECTOR_UNLOCK (object);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1714,7 +1854,7 @@ gst_input_selector_change_state (GstElement * element,
   switch (transition) {
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       GST_INPUT_SELECTOR_LOCK (self);
-      self->blocked = FALSE;
+      g_atomic_int_set (&self->blocked, FALSE);
       self->flushing = FALSE;
       GST_INPUT_SELECTOR_UNLOCK (self);
       break;
@@ -1722,7 +1862,7 @@ gst_input_selector_change_state (GstElement * element,
       /* first unlock before we call the parent state change function, which
        * tries to acquire the stream lock when going to ready. */
       GST_INPUT_SELECTOR_LOCK (self);
-      self->blocked = FALSE;
+      g_atomic_int_set (&self->blocked, FALSE);
       self->flushing = TRUE;
       GST_INPUT_SELECTOR_BROADCAST (self);
       GST_INPUT_SELECTOR_UNLOCK (self);
@@ -1755,7 +1895,7 @@ gst_input_selector_block (GstInputSelector * self)
   if (self->blocked)
     GST_WARNING_OBJECT (self, "switch already blocked");
 
-  self->blocked = TRUE;
+  g_atomic_int_set (&self->blocked, TRUE);
   spad = GST_SELECTOR_PAD_CAST (self->active_sinkpad);
 
   if (spad)
@@ -71,6 +71,7 @@ struct _GstInputSelector {
   gboolean sync_streams;
   GstInputSelectorSyncMode sync_mode;
   gboolean cache_buffers;
+  gboolean keyframe_cache;
 
   GMutex lock;
   GCond cond;
@@ -55,6 +55,11 @@
  *   </para><para>
  *     If an EOS event comes through a srcpad, the associated queue will be
  *     considered as 'not-empty' in the queue-size-growing algorithm.
+ *   </para><para>
+ *     A stream that receives GAP events, like a subtitle stream, is
+ *     considered sparse. Its queue being empty doesn't make the other queues
+ *     grow and its time level advances with the GAP events, so that the
+ *     other streams are not buffered up to the time limit.
  *   </para></listitem>
  *   </itemizedlist>
  * </listitem>
@@ -100,6 +105,13 @@
  *   queues is filled.
  *   Both signals are emitted from the context of the streaming thread.
  * </para>
+ * <para>
+ *   If #GstMultiQueue:temp-template is set, the data of the queued buffers is
+ *   written to a temporary file per queue and read back when the buffer is
+ *   pushed, so that only the buffer metadata is kept in memory. With
+ *   #GstMultiQueue:ring-buffer-max-size the size of each of these files can
+ *   be bounded, buffers that don't fit are kept in memory.
+ * </para>
  * </refsect2>
  *
  * Last reviewed on 2008-01-25 (0.10.17)
@@ -113,6 +125,16 @@
 #include <stdio.h>
 #include "gstmultiqueue.h"
 #include <gst/glib-compat-private.h>
+#include "gst/gst-i18n-lib.h"
+#include "gst/gstlockstats.h"
+
+#ifdef G_OS_WIN32
+#include <io.h>                 /* lseek, close */
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 /**
  * GstSingleQueue:
@@ -158,6 +180,9 @@ struct _GstSingleQueue
   GstClockTime cur_time;
   gboolean is_eos;
   gboolean flushing;
+  /* set when a GAP event was received, the stream only has data now and
+   * then, like subtitles */
+  gboolean is_sparse;
 
   /* Protected by global lock */
   guint32 nextid;               /* ID of the next object waiting to be pushed */
@@ -170,6 +195,22 @@ struct _GstSingleQueue
   /* for serialized queries */
   GCond query_handled;
   gboolean last_query;
+
+  /* max observed lead of the incoming running time over the queue that is
+   * furthest behind, protected by global lock */
+  GstClockTime interleave;
+
+  /* file with the data of the spilled buffers, used as a ring when
+   * ring-buffer-max-size is set. The spilled data is between rpos and wpos,
+   * protected by spill_lock */
+  GMutex spill_lock;
+  FILE *spill_file;
+  gchar *spill_location;
+  guint64 spill_rpos, spill_wpos;
+  guint spill_items;
+  /* bytes of the queued buffers that are only in the file */
+  guint64 spill_bytes;
+  gboolean spill_failed;
 };
 
 
@@ -185,6 +226,10 @@ struct _GstMultiQueueItem
 
   GDestroyNotify destroy;
   guint32 posid;
+
+  /* set when the data of the buffer was written to the spill file */
+  GstSingleQueue *spill_queue;
+  guint64 spill_offset;
 };
 
 static GstSingleQueue *gst_single_queue_new (GstMultiQueue * mqueue, guint id);
@@ -239,6 +284,11 @@ enum
 #define DEFAULT_LOW_PERCENT   10
 #define DEFAULT_HIGH_PERCENT  99
 #define DEFAULT_SYNC_BY_RUNNING_TIME FALSE
+#define DEFAULT_ADAPTIVE_SIZE FALSE
+#define DEFAULT_RING_BUFFER_MAX_SIZE 0
+
+/* time that an adaptive queue can hold on top of the interleave */
+#define ADAPTIVE_MIN_TIME (100 * GST_MSECOND)
 
 enum
 {
@@ -253,15 +303,18 @@ enum
   PROP_LOW_PERCENT,
   PROP_HIGH_PERCENT,
   PROP_SYNC_BY_RUNNING_TIME,
+  PROP_ADAPTIVE_SIZE,
+  PROP_TEMP_TEMPLATE,
+  PROP_RING_BUFFER_MAX_SIZE,
   PROP_LAST
 };
 
 #define GST_MULTI_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
-  g_mutex_lock (&q->qlock);                                              \
+  GST_LOCK_STATS_MUTEX_LOCK (&q->qlock, q, GST_LOCK_STATS_QUEUE);       \
 } G_STMT_END
 
 #define GST_MULTI_QUEUE_MUTEX_UNLOCK(q) G_STMT_START {                        \
-  g_mutex_unlock (&q->qlock);                                            \
+  GST_LOCK_STATS_MUTEX_UNLOCK (&q->qlock);                              \
 } G_STMT_END
 
 static void gst_multi_queue_finalize (GObject * object);
@@ -275,6 +328,7 @@ static GstPad *gst_multi_queue_request_new_pad (GstElement * element,
 static void gst_multi_queue_release_pad (GstElement * element, GstPad * pad);
 static GstStateChangeReturn gst_multi_queue_change_state (GstElement *
     element, GstStateChange transition);
+static gboolean gst_multi_queue_query (GstElement * element, GstQuery * query);
 
 static void gst_multi_queue_loop (GstPad * pad);
 
@@ -407,6 +461,62 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
           DEFAULT_SYNC_BY_RUNNING_TIME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstMultiQueue:adaptive-size
+   *
+   * If enabled, the time limit of each queue is sized to the observed
+   * interleave of the streams instead of #GstMultiQueue:max-size-time. For
+   * every queue, multiqueue measures how far the running time of its incoming
+   * data is ahead of the stream that is furthest behind and lets it hold just
+   * that amount of time plus a small margin. #GstMultiQueue:max-size-time
+   * is the upper bound of the adaptive limit.
+   *
+   * This keeps the queues small for well interleaved streams and makes it
+   * possible to use a large #GstMultiQueue:max-size-time for badly
+   * interleaved ones. The buffers and bytes limits still apply, set them to
+   * 0 to only limit by time. The property has no effect when
+   * #GstMultiQueue:use-buffering is enabled.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_ADAPTIVE_SIZE,
+      g_param_spec_boolean ("adaptive-size", "Adaptive Size",
+          "Size the time limit of the queues to the observed interleave",
+          DEFAULT_ADAPTIVE_SIZE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:temp-template
+   *
+   * If set, the data of the queued buffers is stored in a temporary file per
+   * queue instead of in memory. The template should contain a directory and
+   * XXXXXX, for example /tmp/gstreamer-XXXXXX. The files are removed when the
+   * queues are released. The queue limits still apply to the amount of data.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_TEMP_TEMPLATE,
+      g_param_spec_string ("temp-template", "Temporary File Template",
+          "File template to store temporary files in, should contain directory "
+          "and XXXXXX. (NULL == disabled)",
+          NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstMultiQueue:ring-buffer-max-size
+   *
+   * The maximum size in bytes of the temporary file of each queue when
+   * #GstMultiQueue:temp-template is set. The file is used as a ring buffer,
+   * buffers that don't fit are kept in memory. If set to 0, the files grow
+   * as needed.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_RING_BUFFER_MAX_SIZE,
+      g_param_spec_uint64 ("ring-buffer-max-size",
+          "Max. ring buffer size (bytes)",
+          "Max. size of the temporary file of each queue (bytes, 0 = unlimited)",
+          0, G_MAXUINT64, DEFAULT_RING_BUFFER_MAX_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_multi_queue_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -423,6 +533,7 @@ gst_multi_queue_class_init (GstMultiQueueClass * klass)
       GST_DEBUG_FUNCPTR (gst_multi_queue_release_pad);
   gstelement_class->change_state =
       GST_DEBUG_FUNCPTR (gst_multi_queue_change_state);
+  gstelement_class->query = GST_DEBUG_FUNCPTR (gst_multi_queue_query);
 }
 
 static void
@@ -444,6 +555,9 @@ gst_multi_queue_init (GstMultiQueue * mqueue)
   mqueue->high_percent = DEFAULT_HIGH_PERCENT;
 
   mqueue->sync_by_running_time = DEFAULT_SYNC_BY_RUNNING_TIME;
+  mqueue->adaptive_size = DEFAULT_ADAPTIVE_SIZE;
+  mqueue->temp_template = NULL;
+  mqueue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
 
   mqueue->counter = 1;
   mqueue->highid = -1;
@@ -463,6 +577,7 @@ gst_multi_queue_finalize (GObject * object)
   mqueue->queues_cookie++;
 
   /* free/unref instance data */
+  g_free (mqueue->temp_template);
   g_mutex_clear (&mqueue->qlock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -523,6 +638,25 @@ gst_multi_queue_set_property (GObject * object, guint prop_id,
     case PROP_SYNC_BY_RUNNING_TIME:
       mq->sync_by_running_time = g_value_get_boolean (value);
       break;
+    case PROP_TEMP_TEMPLATE:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      g_free (mq->temp_template);
+      mq->temp_template = g_value_dup_string (value);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
+    case PROP_RING_BUFFER_MAX_SIZE:
+      GST_OBJECT_LOCK (mq);
+      mq->ring_buffer_max_size = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (mq);
+      break;
+    case PROP_ADAPTIVE_SIZE:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      mq->adaptive_size = g_value_get_boolean (value);
+      /* go back to the configured limit */
+      if (!mq->adaptive_size)
+        SET_CHILD_PROPERTY (mq, time);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -568,6 +702,19 @@ gst_multi_queue_get_property (GObject * object, guint prop_id,
     case PROP_SYNC_BY_RUNNING_TIME:
       g_value_set_boolean (value, mq->sync_by_running_time);
       break;
+    case PROP_ADAPTIVE_SIZE:
+      g_value_set_boolean (value, mq->adaptive_size);
+      break;
+    case PROP_TEMP_TEMPLATE:
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      g_value_set_string (value, mq->temp_template);
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      break;
+    case PROP_RING_BUFFER_MAX_SIZE:
+      GST_OBJECT_LOCK (mq);
+      g_value_set_uint64 (value, mq->ring_buffer_max_size);
+      GST_OBJECT_UNLOCK (mq);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -733,6 +880,38 @@ gst_multi_queue_change_state (GstElement * element, GstStateChange transition)
 
 }
 
+static gboolean
+gst_multi_queue_query (GstElement * element, GstQuery * query)
+{
+  GstMultiQueue *mqueue = GST_MULTI_QUEUE (element);
+  GList *tmp;
+  guint64 queued = 0;
+
+  if (GST_QUERY_TYPE (query) != GST_QUERY_MEMORY_USAGE)
+    return GST_ELEMENT_CLASS (parent_class)->query (element, query);
+
+  GST_MULTI_QUEUE_MUTEX_LOCK (mqueue);
+  for (tmp = mqueue->queues; tmp; tmp = g_list_next (tmp)) {
+    GstSingleQueue *sq = (GstSingleQueue *) tmp->data;
+    GstDataQueueSize size;
+    guint64 spilled;
+
+    gst_data_queue_get_level (sq->queue, &size);
+    /* the data of spilled buffers is in the file */
+    g_mutex_lock (&sq->spill_lock);
+    spilled = sq->spill_bytes;
+    g_mutex_unlock (&sq->spill_lock);
+
+    if (size.bytes > spilled)
+      queued += size.bytes - spilled;
+  }
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mqueue);
+
+  gst_query_add_memory_usage (query, GST_OBJECT_CAST (mqueue), 0, queued);
+
+  return TRUE;
+}
+
 static gboolean
 gst_single_queue_flush (GstMultiQueue * mq, GstSingleQueue * sq, gboolean flush)
 {
@@ -909,6 +1088,57 @@ update_time_level (GstMultiQueue * mq, GstSingleQueue * sq)
   return;
 }
 
+/* size the time limit of @sq to the lead of its incoming data over the queue
+ * that is furthest behind.
+ * WITH LOCK TAKEN */
+static void
+update_adaptive_size (GstMultiQueue * mq, GstSingleQueue * sq)
+{
+  GstClockTime min_time = GST_CLOCK_TIME_NONE, lead, max_time;
+  GList *tmp;
+
+  if (!GST_CLOCK_TIME_IS_VALID (sq->sinktime))
+    return;
+
+  for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
+    GstSingleQueue *oq = (GstSingleQueue *) tmp->data;
+
+    /* streams that ended don't hold back the others, sparse streams only
+     * advance with their next buffer or GAP */
+    if (oq->is_eos || oq->is_sparse ||
+        !GST_CLOCK_TIME_IS_VALID (oq->sinktime))
+      continue;
+    if (!GST_CLOCK_TIME_IS_VALID (min_time) || oq->sinktime < min_time)
+      min_time = oq->sinktime;
+  }
+  lead = sq->sinktime > min_time ? sq->sinktime - min_time : 0;
+
+  /* follow a larger interleave immediately, a smaller one slowly so that
+   * the limit doesn't toggle */
+  if (lead >= sq->interleave)
+    sq->interleave = lead;
+  else
+    sq->interleave -= (sq->interleave - lead) / 64;
+
+  max_time = sq->interleave + sq->interleave / 4 + ADAPTIVE_MIN_TIME;
+  if (mq->max_size.time > 0)
+    max_time = MIN (max_time, mq->max_size.time);
+
+  if (max_time != sq->max_size.time) {
+    gboolean grow = sq->max_size.time != 0 && max_time > sq->max_size.time;
+
+    GST_LOG_OBJECT (mq, "queue %d: lead %" GST_TIME_FORMAT ", interleave %"
+        GST_TIME_FORMAT ", max time %" GST_TIME_FORMAT, sq->id,
+        GST_TIME_ARGS (lead), GST_TIME_ARGS (sq->interleave),
+        GST_TIME_ARGS (max_time));
+
+    sq->max_size.time = max_time;
+    /* wake up the pusher if it is waiting for space */
+    if (grow)
+      gst_data_queue_limits_changed (sq->queue);
+  }
+}
+
 /* take a SEGMENT event and apply the values to segment, updating the time
  * level of queue. */
 static void
@@ -971,9 +1201,26 @@ apply_buffer (GstMultiQueue * mq, GstSingleQueue * sq, GstClockTime timestamp,
 
   /* calc diff with other end */
   update_time_level (mq, sq);
+
+  if (mq->adaptive_size && !mq->use_buffering && segment == &sq->sink_segment)
+    update_adaptive_size (mq, sq);
   GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
 }
 
+/* take a GAP event and update segment like a buffer without data, this lets
+ * the time of sparse streams advance, updating the time level of the
+ * queue. */
+static void
+apply_gap (GstMultiQueue * mq, GstSingleQueue * sq, GstEvent * event,
+    GstSegment * segment)
+{
+  GstClockTime timestamp, duration;
+
+  gst_event_parse_gap (event, &timestamp, &duration);
+  if (GST_CLOCK_TIME_IS_VALID (timestamp))
+    apply_buffer (mq, sq, timestamp, duration, segment);
+}
+
 static GstClockTime
 get_running_time (GstSegment * segment, GstMiniObject * object, gboolean end)
 {
@@ -1024,6 +1271,18 @@ get_running_time (GstSegment * segment, GstMiniObject * object, gboolean end)
             gst_segment_to_running_time (new_segment, GST_FORMAT_TIME,
             new_segment->start);
       }
+    } else if (GST_EVENT_TYPE (event) == GST_EVENT_GAP) {
+      GstClockTime duration;
+
+      /* a GAP covers its duration like a buffer */
+      gst_event_parse_gap (event, &time, &duration);
+      if (GST_CLOCK_TIME_IS_VALID (time)) {
+        if (end && GST_CLOCK_TIME_IS_VALID (duration))
+          time += duration;
+        if (time > segment->stop)
+          time = segment->stop;
+        time = gst_segment_to_running_time (segment, GST_FORMAT_TIME, time);
+      }
     }
   }
 
@@ -1069,6 +1328,10 @@ gst_single_queue_push_one (GstMultiQueue * mq, GstSingleQueue * sq,
         /* Applying the segment may have made the queue non-full again, unblock it if needed */
         gst_data_queue_limits_changed (sq->queue);
         break;
+      case GST_EVENT_GAP:
+        apply_gap (mq, sq, event, &sq->src_segment);
+        gst_data_queue_limits_changed (sq->queue);
+        break;
       default:
         break;
     }
@@ -1110,9 +1373,15 @@ gst_multi_queue_item_steal_object (GstMultiQueueItem * item)
   return res;
 }
 
+static void gst_single_queue_spill_release (GstSingleQueue * sq,
+    guint64 offset, guint size);
+
 static void
 gst_multi_queue_item_destroy (GstMultiQueueItem * item)
 {
+  if (item->spill_queue)
+    gst_single_queue_spill_release (item->spill_queue, item->spill_offset,
+        item->size);
   if (item->object)
     gst_mini_object_unref (item->object);
   g_slice_free (GstMultiQueueItem, item);
@@ -1134,6 +1403,8 @@ gst_multi_queue_buffer_item_new (GstMiniObject * object, guint32 curid)
   if (item->duration == GST_CLOCK_TIME_NONE)
     item->duration = 0;
   item->visible = TRUE;
+  item->spill_queue = NULL;
+  item->spill_offset = 0;
   return item;
 }
 
@@ -1150,9 +1421,224 @@ gst_multi_queue_mo_item_new (GstMiniObject * object, guint32 curid)
   item->size = 0;
   item->duration = 0;
   item->visible = FALSE;
+  item->spill_queue = NULL;
+  item->spill_offset = 0;
   return item;
 }
 
+#ifdef HAVE_FSEEKO
+#define FSEEK_FILE(file,offset)  (fseeko (file, (off_t) offset, SEEK_SET) != 0)
+#elif defined (G_OS_UNIX) || defined (G_OS_WIN32)
+/* the stdio buffers must be flushed before the file offset is moved */
+#define FSEEK_FILE(file,offset)  (fflush (file) != 0 || \
+    lseek (fileno (file), (off_t) offset, SEEK_SET) == (off_t) -1)
+#else
+#define FSEEK_FILE(file,offset)  (fseek (file, offset, SEEK_SET) != 0)
+#endif
+
+/* must be called with the spill lock */
+static gboolean
+gst_single_queue_open_spill_file (GstSingleQueue * sq,
+    const gchar * temp_template)
+{
+  GstMultiQueue *mq = sq->mqueue;
+  gchar *name;
+  gint fd;
+
+  name = g_strdup (temp_template);
+  fd = g_mkstemp (name);
+  if (fd == -1)
+    goto mkstemp_failed;
+
+  sq->spill_file = fdopen (fd, "wb+");
+  if (sq->spill_file == NULL)
+    goto open_failed;
+
+  sq->spill_location = name;
+  GST_DEBUG_OBJECT (mq, "SingleQueue %d : spilling to %s", sq->id, name);
+
+  return TRUE;
+
+  /* ERRORS */
+mkstemp_failed:
+  {
+    GST_ELEMENT_WARNING (mq, RESOURCE, OPEN_WRITE,
+        (_("Could not create temp file \"%s\"."), name), GST_ERROR_SYSTEM);
+    g_free (name);
+    return FALSE;
+  }
+open_failed:
+  {
+    GST_ELEMENT_WARNING (mq, RESOURCE, OPEN_WRITE,
+        (_("Could not open file \"%s\" for writing."), name),
+        GST_ERROR_SYSTEM);
+    close (fd);
+    remove (name);
+    g_free (name);
+    return FALSE;
+  }
+}
+
+static void
+gst_single_queue_close_spill_file (GstSingleQueue * sq)
+{
+  if (sq->spill_file == NULL)
+    return;
+
+  fclose (sq->spill_file);
+  remove (sq->spill_location);
+  g_free (sq->spill_location);
+  sq->spill_file = NULL;
+  sq->spill_location = NULL;
+}
+
+/* write the data of the buffer in @item to the spill file and replace the
+ * buffer with one that only has its metadata. Buffers that can't be spilled
+ * stay in memory. @temp_template is used to create the file the first
+ * time. */
+static void
+gst_single_queue_spill (GstSingleQueue * sq, GstMultiQueueItem * item,
+    const gchar * temp_template)
+{
+  GstMultiQueue *mq = sq->mqueue;
+  GstBuffer *buffer = GST_BUFFER_CAST (item->object), *meta;
+  GstMapInfo map;
+  guint64 offset, max_size;
+  gsize size = item->size;
+
+  if (size == 0)
+    return;
+
+  GST_OBJECT_LOCK (mq);
+  max_size = mq->ring_buffer_max_size;
+  GST_OBJECT_UNLOCK (mq);
+
+  g_mutex_lock (&sq->spill_lock);
+  if (sq->spill_failed)
+    goto done;
+
+  if (sq->spill_file == NULL &&
+      !gst_single_queue_open_spill_file (sq, temp_template)) {
+    sq->spill_failed = TRUE;
+    goto done;
+  }
+
+  if (sq->spill_items == 0)
+    sq->spill_rpos = sq->spill_wpos = 0;
+
+  offset = sq->spill_wpos;
+  if (max_size > 0) {
+    if (size > max_size)
+      goto done;
+    if (sq->spill_items > 0 && sq->spill_wpos <= sq->spill_rpos) {
+      /* wrapped around, the free space is between wpos and rpos */
+      if (offset + size > sq->spill_rpos)
+        goto done;
+    } else if (offset + size > max_size) {
+      /* wrap around if the oldest data left enough room at the start */
+      if (size > sq->spill_rpos)
+        goto done;
+      offset = 0;
+    }
+  }
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ))
+    goto done;
+
+  if (FSEEK_FILE (sq->spill_file, offset)
+      || fwrite (map.data, size, 1, sq->spill_file) != 1) {
+    gst_buffer_unmap (buffer, &map);
+    goto write_failed;
+  }
+  gst_buffer_unmap (buffer, &map);
+
+  sq->spill_wpos = offset + size;
+  sq->spill_items++;
+  sq->spill_bytes += size;
+  g_mutex_unlock (&sq->spill_lock);
+
+  /* keep everything but the memory */
+  meta = gst_buffer_new ();
+  gst_buffer_copy_into (meta, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
+  gst_buffer_unref (buffer);
+
+  item->object = GST_MINI_OBJECT_CAST (meta);
+  item->spill_queue = sq;
+  item->spill_offset = offset;
+
+  GST_LOG_OBJECT (mq, "SingleQueue %d : spilled %" G_GSIZE_FORMAT
+      " bytes at offset %" G_GUINT64_FORMAT, sq->id, size, offset);
+  return;
+
+done:
+  g_mutex_unlock (&sq->spill_lock);
+  return;
+
+  /* ERRORS */
+write_failed:
+  {
+    GST_ELEMENT_WARNING (mq, RESOURCE, WRITE,
+        (_("Error while writing to file \"%s\"."), sq->spill_location),
+        GST_ERROR_SYSTEM);
+    sq->spill_failed = TRUE;
+    g_mutex_unlock (&sq->spill_lock);
+    return;
+  }
+}
+
+/* read back the data of a spilled buffer, returns the complete buffer or
+ * NULL on error. */
+static GstBuffer *
+gst_single_queue_unspill (GstSingleQueue * sq, GstMultiQueueItem * item)
+{
+  GstBuffer *buffer;
+  GstMemory *mem;
+  GstMapInfo map;
+  gboolean res;
+
+  mem = gst_allocator_alloc (NULL, item->size, NULL);
+  gst_memory_map (mem, &map, GST_MAP_WRITE);
+
+  /* the region can't be overwritten until the item is destroyed */
+  g_mutex_lock (&sq->spill_lock);
+  res = !FSEEK_FILE (sq->spill_file, item->spill_offset)
+      && fread (map.data, item->size, 1, sq->spill_file) == 1;
+  g_mutex_unlock (&sq->spill_lock);
+
+  gst_memory_unmap (mem, &map);
+
+  if (!res)
+    goto read_failed;
+
+  buffer = GST_BUFFER_CAST (gst_multi_queue_item_steal_object (item));
+  buffer = gst_buffer_make_writable (buffer);
+  gst_buffer_append_memory (buffer, mem);
+
+  return buffer;
+
+  /* ERRORS */
+read_failed:
+  {
+    GST_ELEMENT_ERROR (sq->mqueue, RESOURCE, READ, (NULL), GST_ERROR_SYSTEM);
+    gst_memory_unref (mem);
+    return NULL;
+  }
+}
+
+/* release the file region of a spilled buffer, items are released in the
+ * order they were spilled, both when pushed and when flushed. */
+static void
+gst_single_queue_spill_release (GstSingleQueue * sq, guint64 offset,
+    guint size)
+{
+  g_mutex_lock (&sq->spill_lock);
+  sq->spill_rpos = offset + size;
+  sq->spill_bytes -= size;
+  if (--sq->spill_items == 0)
+    sq->spill_rpos = sq->spill_wpos = sq->spill_bytes = 0;
+  g_mutex_unlock (&sq->spill_lock);
+}
+
 /* Each main loop attempts to push buffers until the return value
  * is not-linked. not-linked pads are not allowed to push data beyond
  * any linked pads, so they don't 'rush ahead of the pack'.
@@ -1187,7 +1673,18 @@ gst_multi_queue_loop (GstPad * pad)
   newid = item->posid;
 
   /* steal the object and destroy the item */
-  object = gst_multi_queue_item_steal_object (item);
+  if (item->spill_queue) {
+    object = (GstMiniObject *) gst_single_queue_unspill (sq, item);
+    if (object == NULL) {
+      gst_multi_queue_item_destroy (item);
+      GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+      sq->srcresult = GST_FLOW_ERROR;
+      GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+      goto out_flushing;
+    }
+  } else {
+    object = gst_multi_queue_item_steal_object (item);
+  }
   gst_multi_queue_item_destroy (item);
 
   is_buffer = GST_IS_BUFFER (object);
@@ -1249,7 +1746,8 @@ gst_multi_queue_loop (GstPad * pad)
         wake_up_next_non_linked (mq);
 
         mq->numwaiting++;
-        g_cond_wait (&sq->turn, &mq->qlock);
+        GST_LOCK_STATS_COND_WAIT (&sq->turn, &mq->qlock, mq,
+            GST_LOCK_STATS_QUEUE);
         mq->numwaiting--;
 
         if (sq->flushing) {
@@ -1395,6 +1893,7 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GstMultiQueueItem *item;
   guint32 curid;
   GstClockTime timestamp, duration;
+  gchar *temp_template;
 
   sq = gst_pad_get_element_private (pad);
   mq = sq->mqueue;
@@ -1409,11 +1908,22 @@ gst_multi_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   GST_LOG_OBJECT (mq, "SingleQueue %d : about to enqueue buffer %p with id %d",
       sq->id, buffer, curid);
 
-  item = gst_multi_queue_buffer_item_new (GST_MINI_OBJECT_CAST (buffer), curid);
-
   timestamp = GST_BUFFER_TIMESTAMP (buffer);
   duration = GST_BUFFER_DURATION (buffer);
 
+  item = gst_multi_queue_buffer_item_new (GST_MINI_OBJECT_CAST (buffer), curid);
+
+  /* the spill lock can't be taken with the multiqueue lock, so the spill
+   * functions get a copy of the template */
+  GST_MULTI_QUEUE_MUTEX_LOCK (mq);
+  temp_template = g_strdup (mq->temp_template);
+  GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
+
+  if (temp_template) {
+    gst_single_queue_spill (sq, item, temp_template);
+    g_free (temp_template);
+  }
+
   if (!(gst_data_queue_push (sq->queue, (GstDataQueueItem *) item)))
     goto flushing;
 
@@ -1516,6 +2026,7 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       gst_single_queue_flush (mq, sq, FALSE);
       goto done;
     case GST_EVENT_SEGMENT:
+    case GST_EVENT_GAP:
       /* take ref because the queue will take ownership and we need the event
        * afterwards to update the segment */
       sref = gst_event_ref (event);
@@ -1560,6 +2071,11 @@ gst_multi_queue_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       apply_segment (mq, sq, sref, &sq->sink_segment);
       gst_event_unref (sref);
       break;
+    case GST_EVENT_GAP:
+      sq->is_sparse = TRUE;
+      apply_gap (mq, sq, sref, &sq->sink_segment);
+      gst_event_unref (sref);
+      break;
     default:
       break;
   }
@@ -1611,7 +2127,8 @@ gst_multi_queue_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
 
         GST_MULTI_QUEUE_MUTEX_LOCK (mq);
         res = gst_data_queue_push (sq->queue, (GstDataQueueItem *) item);
-        g_cond_wait (&sq->query_handled, &mq->qlock);
+        GST_LOCK_STATS_COND_WAIT (&sq->query_handled, &mq->qlock, mq,
+            GST_LOCK_STATS_QUEUE);
         res = sq->last_query;
         GST_MULTI_QUEUE_MUTEX_UNLOCK (mq);
       } else {
@@ -1832,6 +2349,11 @@ single_queue_overrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
 
     GST_LOG_OBJECT (mq, "Checking Queue %d", oq->id);
 
+    /* sparse queues are empty most of the time, growing for them would
+     * buffer the other queues up to the time limit */
+    if (oq->is_sparse)
+      continue;
+
     if (gst_data_queue_is_empty (oq->queue)) {
       GST_LOG_OBJECT (mq, "Queue %d is empty", oq->id);
       if (IS_FILLED (sq, visible, size.visible)) {
@@ -1869,7 +2391,8 @@ single_queue_underrun_cb (GstDataQueue * dq, GstSingleQueue * sq)
   for (tmp = mq->queues; tmp; tmp = g_list_next (tmp)) {
     GstSingleQueue *oq = (GstSingleQueue *) tmp->data;
 
-    if (gst_data_queue_is_full (oq->queue)) {
+    /* an empty sparse queue doesn't need the other queues to grow */
+    if (!sq->is_sparse && gst_data_queue_is_full (oq->queue)) {
       GstDataQueueSize size;
 
       gst_data_queue_get_level (oq->queue, &size);
@@ -1924,6 +2447,8 @@ gst_single_queue_free (GstSingleQueue * sq)
   /* DRAIN QUEUE */
   gst_data_queue_flush (sq->queue);
   g_object_unref (sq->queue);
+  gst_single_queue_close_spill_file (sq);
+  g_mutex_clear (&sq->spill_lock);
   g_cond_clear (&sq->turn);
   g_cond_clear (&sq->query_handled);
   g_free (sq);
@@ -1981,6 +2506,9 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
       single_queue_check_full,
       (GstDataQueueFullCallback) single_queue_overrun_cb,
       (GstDataQueueEmptyCallback) single_queue_underrun_cb, sq);
+  /* only the streaming thread of the sinkpad pushes and only the task of
+   * the srcpad pops */
+  gst_data_queue_set_single_producer_consumer (sq->queue, TRUE);
   sq->is_eos = FALSE;
   sq->flushing = FALSE;
   gst_segment_init (&sq->sink_segment, GST_FORMAT_TIME);
@@ -1992,6 +2520,7 @@ gst_single_queue_new (GstMultiQueue * mqueue, guint id)
   sq->last_time = GST_CLOCK_TIME_NONE;
   g_cond_init (&sq->turn);
   g_cond_init (&sq->query_handled);
+  g_mutex_init (&sq->spill_lock);
 
   sq->sinktime = GST_CLOCK_TIME_NONE;
   sq->srctime = GST_CLOCK_TIME_NONE;
@@ -51,6 +51,7 @@ struct _GstMultiQueue {
   GstElement element;
 
   gboolean sync_by_running_time;
+  gboolean adaptive_size;
 
   /* number of queues */
   guint	nbqueues;
@@ -74,6 +75,11 @@ struct _GstMultiQueue {
 			/* GstMultiQueueSize, counter and highid */
 
   gint numwaiting;	/* number of not-linked pads waiting */
+
+  /* spilling to disk, the template is protected by qlock and the maximum
+   * size by the object lock */
+  gchar *temp_template;
+  guint64 ring_buffer_max_size;
 };
 
 struct _GstMultiQueueClass {
@@ -47,7 +47,9 @@
  * As said earlier, the queue blocks by default when one of the specified
  * maximums (bytes, time, buffers) has been reached. You can set the
  * #GstQueue:leaky property to specify that instead of blocking it should
- * leak (drop) new or old buffers.
+ * leak (drop) new or old buffers. The #GstQueue:leak-policy property selects
+ * whether single buffers are dropped or whole groups of pictures, so that
+ * the data that gets through stays decodable.
  *
  * The #GstQueue::underrun signal is emitted when the queue has less data than
  * the specified minimum thresholds require (by default: when the queue is
@@ -56,9 +58,11 @@
  */
 
 #include "gst/gst_private.h"
+#include "gst/gstlockstats.h"
 
 #include <gst/gst.h>
 #include "gstqueue.h"
+#include "gstelements_private.h"
 
 #include "../../gst/gst-i18n-lib.h"
 #include "../../gst/glib-compat-private.h"
@@ -119,8 +123,11 @@ enum
   PROP_MIN_THRESHOLD_BYTES,
   PROP_MIN_THRESHOLD_TIME,
   PROP_LEAKY,
+  PROP_LEAK_POLICY,
   PROP_SILENT,
-  PROP_FLUSH_ON_EOS
+  PROP_FLUSH_ON_EOS,
+  PROP_MAX_LIST_SIZE,
+  PROP_MAX_LIST_TIME
 };
 
 /* default property values */
@@ -128,8 +135,16 @@ enum
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
 
+#define DEFAULT_LEAK_POLICY       GST_QUEUE_LEAK_POLICY_BUFFER
+
+#define DEFAULT_MAX_LIST_SIZE     1
+#define DEFAULT_MAX_LIST_TIME     0
+
+/* max number of items pushed in one iteration of the streaming task */
+#define MAX_PUSH_BATCH  64
+
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
-  g_mutex_lock (&q->qlock);                                              \
+  GST_LOCK_STATS_MUTEX_LOCK (&q->qlock, q, GST_LOCK_STATS_QUEUE);       \
 } G_STMT_END
 
 #define GST_QUEUE_MUTEX_LOCK_CHECK(q,label) G_STMT_START {              \
@@ -139,13 +154,14 @@ enum
 } G_STMT_END
 
 #define GST_QUEUE_MUTEX_UNLOCK(q) G_STMT_START {                        \
-  g_mutex_unlock (&q->qlock);                                            \
+  GST_LOCK_STATS_MUTEX_UNLOCK (&q->qlock);                              \
 } G_STMT_END
 
 #define GST_QUEUE_WAIT_DEL_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->sinkpad, "wait for DEL");                               \
   q->waiting_del = TRUE;                                                \
-  g_cond_wait (&q->item_del, &q->qlock);                                  \
+  GST_LOCK_STATS_COND_WAIT (&q->item_del, &q->qlock, q,                 \
+      GST_LOCK_STATS_QUEUE);                                            \
   q->waiting_del = FALSE;                                               \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received DEL wakeup");                       \
@@ -157,7 +173,8 @@ enum
 #define GST_QUEUE_WAIT_ADD_CHECK(q, label) G_STMT_START {               \
   STATUS (q, q->srcpad, "wait for ADD");                                \
   q->waiting_add = TRUE;                                                \
-  g_cond_wait (&q->item_add, &q->qlock);                                  \
+  GST_LOCK_STATS_COND_WAIT (&q->item_add, &q->qlock, q,                 \
+      GST_LOCK_STATS_QUEUE);                                            \
   q->waiting_add = FALSE;                                               \
   if (q->srcresult != GST_FLOW_OK) {                                    \
     STATUS (q, q->srcpad, "received ADD wakeup");                       \
@@ -178,6 +195,12 @@ enum
     STATUS (q, q->sinkpad, "signal ADD");                               \
     g_cond_signal (&q->item_add);                                        \
   }                                                                     \
+  if (q->yield_task) {                                                  \
+    STATUS (q, q->sinkpad, "resume ADD");                               \
+    gst_task_resume (q->yield_task);                                    \
+    gst_object_unref (q->yield_task);                                   \
+    q->yield_task = NULL;                                               \
+  }                                                                     \
 } G_STMT_END
 
 #define _do_init \
@@ -239,6 +262,27 @@ queue_leaky_get_type (void)
   return queue_leaky_type;
 }
 
+#define GST_TYPE_QUEUE_LEAK_POLICY (queue_leak_policy_get_type ())
+
+static GType
+queue_leak_policy_get_type (void)
+{
+  static GType queue_leak_policy_type = 0;
+  static const GEnumValue queue_leak_policy[] = {
+    {GST_QUEUE_LEAK_POLICY_BUFFER, "Leak single buffers and events", "buffer"},
+    {GST_QUEUE_LEAK_POLICY_DROPPABLE,
+        "Leak droppable buffers first, then groups of pictures", "droppable"},
+    {GST_QUEUE_LEAK_POLICY_GOP, "Leak whole groups of pictures", "gop"},
+    {0, NULL, NULL},
+  };
+
+  if (!queue_leak_policy_type) {
+    queue_leak_policy_type =
+        g_enum_register_static ("GstQueueLeakPolicy", queue_leak_policy);
+  }
+  return queue_leak_policy_type;
+}
+
 static guint gst_queue_signals[LAST_SIGNAL] = { 0 };
 
 static void
@@ -349,6 +393,24 @@ gst_queue_class_init (GstQueueClass * klass)
           GST_TYPE_QUEUE_LEAKY, GST_QUEUE_NO_LEAK,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue:leak-policy
+   *
+   * What the queue drops when it leaks. "droppable" drops the queued buffers
+   * with the %GST_BUFFER_FLAG_DROPPABLE flag first, "gop" and "droppable"
+   * drop the buffers from a key unit up to the next key unit, using the
+   * %GST_BUFFER_FLAG_DELTA_UNIT flag, and the incoming delta units until the
+   * next key unit when the rest of a group of pictures can't be decoded
+   * anymore. Events are not leaked with these policies.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_LEAK_POLICY,
+      g_param_spec_enum ("leak-policy", "Leak policy",
+          "What the queue drops when it leaks",
+          GST_TYPE_QUEUE_LEAK_POLICY, DEFAULT_LEAK_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /**
    * GstQueue:silent
    *
@@ -380,6 +442,39 @@ gst_queue_class_init (GstQueueClass * klass)
           "Discard all data in the queue when an EOS event is received", FALSE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue:max-list-size
+   *
+   * Push up to this many queued buffers downstream in one #GstBufferList.
+   * Only buffers that are already queued are combined, the queue never waits
+   * for more buffers to fill a list. This reduces the per buffer overhead at
+   * high packet rates when downstream handles buffer lists efficiently.
+   * 1 pushes every buffer on its own.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_LIST_SIZE,
+      g_param_spec_uint ("max-list-size", "Max. list size",
+          "Max. number of queued buffers to push downstream in one buffer list "
+          "(1 = push single buffers)", 1, G_MAXUINT, DEFAULT_MAX_LIST_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue:max-list-time
+   *
+   * The maximum difference between the timestamps of the first and the last
+   * buffer in a buffer list pushed because of #GstQueue:max-list-size. This
+   * bounds the latency that is added for the first buffer of a list when
+   * downstream only handles the list as a whole.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_LIST_TIME,
+      g_param_spec_uint64 ("max-list-time", "Max. list time",
+          "Max. time between the first and last buffer of a buffer list in ns "
+          "(0 = unlimited)", 0, G_MAXUINT64, DEFAULT_MAX_LIST_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
   gst_element_class_set_static_metadata (gstelement_class,
@@ -425,6 +520,8 @@ gst_queue_init (GstQueue * queue)
   queue->max_size.buffers = DEFAULT_MAX_SIZE_BUFFERS;
   queue->max_size.bytes = DEFAULT_MAX_SIZE_BYTES;
   queue->max_size.time = DEFAULT_MAX_SIZE_TIME;
+  queue->max_list_size = DEFAULT_MAX_LIST_SIZE;
+  queue->max_list_time = DEFAULT_MAX_LIST_TIME;
   GST_QUEUE_CLEAR_LEVEL (queue->min_threshold);
   GST_QUEUE_CLEAR_LEVEL (queue->orig_min_threshold);
   gst_segment_init (&queue->sink_segment, GST_FORMAT_TIME);
@@ -432,6 +529,8 @@ gst_queue_init (GstQueue * queue)
   queue->head_needs_discont = queue->tail_needs_discont = FALSE;
 
   queue->leaky = GST_QUEUE_NO_LEAK;
+  queue->leak_policy = DEFAULT_LEAK_POLICY;
+  queue->drop_delta = FALSE;
   queue->srcresult = GST_FLOW_FLUSHING;
 
   g_mutex_init (&queue->qlock);
@@ -469,6 +568,9 @@ gst_queue_finalize (GObject * object)
   }
   gst_queue_array_free (queue->queue);
 
+  if (queue->yield_task)
+    gst_object_unref (queue->yield_task);
+
   g_mutex_clear (&queue->qlock);
   g_cond_clear (&queue->item_add);
   g_cond_clear (&queue->item_del);
@@ -591,6 +693,7 @@ gst_queue_locked_flush (GstQueue * queue)
   gst_segment_init (&queue->sink_segment, GST_FORMAT_TIME);
   gst_segment_init (&queue->src_segment, GST_FORMAT_TIME);
   queue->head_needs_discont = queue->tail_needs_discont = FALSE;
+  queue->drop_delta = FALSE;
 
   queue->sinktime = queue->srctime = GST_CLOCK_TIME_NONE;
   queue->sink_tainted = queue->src_tainted = TRUE;
@@ -742,6 +845,9 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* unblock the loop and chain functions */
       GST_QUEUE_SIGNAL_ADD (queue);
       GST_QUEUE_SIGNAL_DEL (queue);
+      /* the loop starts over after the flush and signals the underrun
+       * again */
+      queue->yielded = FALSE;
       GST_QUEUE_MUTEX_UNLOCK (queue);
 
       /* make sure it pauses, this should happen since we sent
@@ -835,6 +941,10 @@ gst_queue_handle_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
           GST_QUEUE_WAIT_DEL_CHECK (queue, out_flushing);
         }
         res = queue->last_query;
+        /* upstream pools also need to fill the queue */
+        if (res && GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION)
+          gst_allocation_pools_add_buffers (GST_OBJECT_CAST (queue), query,
+              queue->max_size.buffers);
         GST_QUEUE_MUTEX_UNLOCK (queue);
       } else {
         res = gst_pad_query_default (pad, parent, query);
@@ -899,9 +1009,117 @@ gst_queue_is_filled (GstQueue * queue)
               queue->cur_level.time >= queue->max_size.time)));
 }
 
+/* remove the buffer at @idx without pushing it, @oldest is TRUE when there
+ * is no buffer before it. With QUEUE_LOCK */
+static void
+gst_queue_locked_drop_buffer (GstQueue * queue, guint idx, gboolean oldest)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_queue_array_drop_element (queue->queue, idx);
+
+  GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+      "queue is full, leaking buffer %p", buffer);
+
+  queue->cur_level.buffers--;
+  queue->cur_level.bytes -= gst_buffer_get_size (buffer);
+  /* the time level only shrinks when the oldest buffer goes */
+  if (oldest)
+    apply_buffer (queue, buffer, &queue->src_segment, TRUE, FALSE);
+  if (queue->cur_level.buffers == 0)
+    queue->cur_level.time = 0;
+
+  gst_buffer_unref (buffer);
+  GST_QUEUE_SIGNAL_DEL (queue);
+}
+
+/* drop the droppable buffers, oldest first, until the queue is not filled
+ * anymore. With QUEUE_LOCK */
+static void
+gst_queue_leak_droppable (GstQueue * queue)
+{
+  gboolean oldest = TRUE;
+  guint i = 0;
+
+  while (i < gst_queue_array_get_length (queue->queue) &&
+      gst_queue_is_filled (queue)) {
+    GstMiniObject *item = gst_queue_array_peek_nth (queue->queue, i);
+
+    if (GST_IS_BUFFER (item) &&
+        GST_BUFFER_FLAG_IS_SET (item, GST_BUFFER_FLAG_DROPPABLE)) {
+      gst_queue_locked_drop_buffer (queue, i, oldest);
+    } else {
+      if (GST_IS_BUFFER (item))
+        oldest = FALSE;
+      i++;
+    }
+  }
+}
+
+/* drop the buffers from the oldest one up to the next key unit, the events in
+ * between are kept. Returns FALSE when there was no buffer to drop. With
+ * QUEUE_LOCK */
+static gboolean
+gst_queue_leak_gop (GstQueue * queue)
+{
+  gboolean dropped = FALSE;
+  guint i = 0;
+
+  while (i < gst_queue_array_get_length (queue->queue)) {
+    GstMiniObject *item = gst_queue_array_peek_nth (queue->queue, i);
+
+    if (!GST_IS_BUFFER (item)) {
+      i++;
+      continue;
+    }
+    /* the next group of pictures starts here */
+    if (dropped && !GST_BUFFER_FLAG_IS_SET (item, GST_BUFFER_FLAG_DELTA_UNIT))
+      break;
+
+    gst_queue_locked_drop_buffer (queue, i, TRUE);
+    dropped = TRUE;
+  }
+
+  if (!dropped)
+    return FALSE;
+
+  /* the rest of the group is still to come */
+  if (i == gst_queue_array_get_length (queue->queue))
+    queue->drop_delta = TRUE;
+  /* the next buffer needs to get a DISCONT flag */
+  queue->head_needs_discont = TRUE;
+
+  return TRUE;
+}
+
+/* check if @buffer needs to be dropped because the key unit it depends on
+ * was leaked, the dropping stops at the next key unit. With QUEUE_LOCK */
+static gboolean
+gst_queue_drop_delta (GstQueue * queue, GstBuffer * buffer)
+{
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
+        "leaking delta unit %p until the next key unit", buffer);
+    return TRUE;
+  }
+  queue->drop_delta = FALSE;
+
+  return FALSE;
+}
+
 static void
 gst_queue_leak_downstream (GstQueue * queue)
 {
+  if (queue->leak_policy == GST_QUEUE_LEAK_POLICY_DROPPABLE)
+    gst_queue_leak_droppable (queue);
+
+  if (queue->leak_policy != GST_QUEUE_LEAK_POLICY_BUFFER) {
+    while (gst_queue_is_filled (queue)) {
+      if (!gst_queue_leak_gop (queue))
+        break;
+    }
+  }
+
   /* for as long as the queue is filled, dequeue an item and discard it */
   while (gst_queue_is_filled (queue)) {
     GstMiniObject *leak;
@@ -945,6 +1163,9 @@ gst_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       GST_TIME_FORMAT, buffer, gst_buffer_get_size (buffer),
       GST_TIME_ARGS (timestamp), GST_TIME_ARGS (duration));
 
+  if (G_UNLIKELY (queue->drop_delta) && gst_queue_drop_delta (queue, buffer))
+    goto out_unref;
+
   /* We make space available if we're "full" according to whatever
    * the user defined as "full". Note that this only applies to buffers.
    * We always handle events and they don't count in our statistics. */
@@ -963,6 +1184,10 @@ gst_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       case GST_QUEUE_LEAK_UPSTREAM:
         /* next buffer needs to get a DISCONT flag */
         queue->tail_needs_discont = TRUE;
+        /* the delta units that depend on this buffer can't be decoded */
+        if (queue->leak_policy != GST_QUEUE_LEAK_POLICY_BUFFER &&
+            !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DROPPABLE))
+          queue->drop_delta = TRUE;
         /* leak current buffer */
         GST_CAT_DEBUG_OBJECT (queue_dataflow, queue,
             "queue is full, leaking buffer on upstream end");
@@ -997,6 +1222,10 @@ gst_queue_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     }
   }
 
+  /* leaking downstream may have dropped the key unit of this buffer */
+  if (G_UNLIKELY (queue->drop_delta) && gst_queue_drop_delta (queue, buffer))
+    goto out_unref;
+
   if (queue->tail_needs_discont) {
     GstBuffer *subbuffer = gst_buffer_make_writable (buffer);
 
@@ -1055,6 +1284,57 @@ out_unexpected:
   }
 }
 
+static inline GstClockTime
+gst_queue_buffer_time (GstBuffer * buffer)
+{
+  if (GST_BUFFER_DTS_IS_VALID (buffer))
+    return GST_BUFFER_DTS (buffer);
+  return GST_BUFFER_PTS (buffer);
+}
+
+/* dequeue the buffers that are queued right after @buffer and put them in a
+ * list together with @buffer, with QUEUE_LOCK. Returns NULL when no buffer
+ * could be added to @buffer. */
+static GstBufferList *
+gst_queue_locked_dequeue_list (GstQueue * queue, GstBuffer * buffer)
+{
+  GstBufferList *list = NULL;
+  GstClockTime first;
+  guint n_buffers = 1;
+
+  first = gst_queue_buffer_time (buffer);
+
+  while (n_buffers < queue->max_list_size && !gst_queue_is_empty (queue)) {
+    GstMiniObject *head = gst_queue_array_peek_head (queue->queue);
+    GstClockTime time;
+
+    /* events and queries end the list, they are pushed in order */
+    if (!GST_IS_BUFFER (head))
+      break;
+
+    if (queue->max_list_time > 0) {
+      time = gst_queue_buffer_time (GST_BUFFER_CAST (head));
+      if (GST_CLOCK_TIME_IS_VALID (first) && GST_CLOCK_TIME_IS_VALID (time)
+          && time > first && time - first > queue->max_list_time)
+        break;
+    }
+
+    if (list == NULL) {
+      list = gst_buffer_list_new_sized (MIN (queue->max_list_size, 64));
+      gst_buffer_list_add (list, buffer);
+    }
+    gst_buffer_list_add (list, GST_BUFFER_CAST (gst_queue_locked_dequeue
+            (queue)));
+    n_buffers++;
+  }
+
+  if (list)
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue, "pushing %u buffers in list %p",
+        n_buffers, list);
+
+  return list;
+}
+
 /* dequeue an item from the queue an push it downstream. This functions returns
  * the result of the push. */
 static GstFlowReturn
@@ -1070,6 +1350,7 @@ gst_queue_push_one (GstQueue * queue)
 next:
   if (GST_IS_BUFFER (data)) {
     GstBuffer *buffer;
+    GstBufferList *list;
 
     buffer = GST_BUFFER_CAST (data);
 
@@ -1085,8 +1366,14 @@ next:
       queue->head_needs_discont = FALSE;
     }
 
-    GST_QUEUE_MUTEX_UNLOCK (queue);
-    result = gst_pad_push (queue->srcpad, buffer);
+    if (queue->max_list_size > 1
+        && (list = gst_queue_locked_dequeue_list (queue, buffer))) {
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+      result = gst_pad_push_list (queue->srcpad, list);
+    } else {
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+      result = gst_pad_push (queue->srcpad, buffer);
+    }
 
     /* need to check for srcresult here as well */
     GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
@@ -1174,22 +1461,40 @@ gst_queue_loop (GstPad * pad)
 {
   GstQueue *queue;
   GstFlowReturn ret;
+  guint n_pushed = 0;
+  gboolean resumed;
 
   queue = (GstQueue *) GST_PAD_PARENT (pad);
 
   /* have to lock for thread-safety */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
-  while (gst_queue_is_empty (queue)) {
-    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
-    if (!queue->silent) {
-      GST_QUEUE_MUTEX_UNLOCK (queue);
-      g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
-      GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+  /* when we yielded, the underrun was already signalled */
+  resumed = queue->yielded;
+  queue->yielded = FALSE;
+
+  while (resumed || gst_queue_is_empty (queue)) {
+    if (!resumed) {
+      GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
+      if (!queue->silent) {
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
+        GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+      }
     }
+    resumed = FALSE;
 
     /* we recheck, the signal could have changed the thresholds */
     while (gst_queue_is_empty (queue)) {
+      /* on a shared task pool, give the thread back instead of waiting, the
+       * next ADD resumes the task */
+      if (queue->yield_task == NULL && gst_task_yield (GST_PAD_TASK (pad))) {
+        STATUS (queue, queue->srcpad, "yield for ADD");
+        queue->yield_task = gst_object_ref (GST_PAD_TASK (pad));
+        queue->yielded = TRUE;
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        return;
+      }
       GST_QUEUE_WAIT_ADD_CHECK (queue, out_flushing);
     }
 
@@ -1202,10 +1507,16 @@ gst_queue_loop (GstPad * pad)
     }
   }
 
-  ret = gst_queue_push_one (queue);
-  queue->srcresult = ret;
-  if (ret != GST_FLOW_OK)
-    goto out_flushing;
+  /* push what is queued without leaving the loop function, this way the lock
+   * is only released around the push of each item. We return when the queue
+   * is empty, which is then handled above in the next iteration, and after a
+   * batch of items so that the task can be paused. */
+  do {
+    ret = gst_queue_push_one (queue);
+    queue->srcresult = ret;
+    if (ret != GST_FLOW_OK)
+      goto out_flushing;
+  } while (++n_pushed < MAX_PUSH_BATCH && !gst_queue_is_empty (queue));
 
   GST_QUEUE_MUTEX_UNLOCK (queue);
 
@@ -1266,6 +1577,17 @@ gst_queue_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       res = TRUE;
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:{
+      guint bytes;
+
+      GST_QUEUE_MUTEX_LOCK (queue);
+      bytes = queue->cur_level.bytes;
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+
+      gst_query_add_memory_usage (query, parent, 0, bytes);
+      res = TRUE;
+      break;
+    }
     default:
       res = gst_pad_query_default (pad, parent, query);
       break;
@@ -1389,8 +1711,14 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
         /* step 1, unblock loop function */
         GST_QUEUE_MUTEX_LOCK (queue);
         queue->srcresult = GST_FLOW_FLUSHING;
-        /* the item add signal will unblock */
+        /* the item add signal will unblock, stopping the task below also
+         * wakes it up when it yielded */
         g_cond_signal (&queue->item_add);
+        if (queue->yield_task) {
+          gst_object_unref (queue->yield_task);
+          queue->yield_task = NULL;
+        }
+        queue->yielded = FALSE;
         GST_QUEUE_MUTEX_UNLOCK (queue);
 
         /* step 2, make sure streaming finishes */
@@ -1465,12 +1793,21 @@ gst_queue_set_property (GObject * object,
     case PROP_LEAKY:
       queue->leaky = g_value_get_enum (value);
       break;
+    case PROP_LEAK_POLICY:
+      queue->leak_policy = g_value_get_enum (value);
+      break;
     case PROP_SILENT:
       queue->silent = g_value_get_boolean (value);
       break;
     case PROP_FLUSH_ON_EOS:
       queue->flush_on_eos = g_value_get_boolean (value);
       break;
+    case PROP_MAX_LIST_SIZE:
+      queue->max_list_size = g_value_get_uint (value);
+      break;
+    case PROP_MAX_LIST_TIME:
+      queue->max_list_time = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1518,12 +1855,21 @@ gst_queue_get_property (GObject * object,
     case PROP_LEAKY:
       g_value_set_enum (value, queue->leaky);
       break;
+    case PROP_LEAK_POLICY:
+      g_value_set_enum (value, queue->leak_policy);
+      break;
     case PROP_SILENT:
       g_value_set_boolean (value, queue->silent);
       break;
     case PROP_FLUSH_ON_EOS:
       g_value_set_boolean (value, queue->flush_on_eos);
       break;
+    case PROP_MAX_LIST_SIZE:
+      g_value_set_uint (value, queue->max_list_size);
+      break;
+    case PROP_MAX_LIST_TIME:
+      g_value_set_uint64 (value, queue->max_list_time);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
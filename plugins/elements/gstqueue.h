@@ -45,6 +45,7 @@ G_BEGIN_DECLS
 typedef struct _GstQueue GstQueue;
 typedef struct _GstQueueSize GstQueueSize;
 typedef enum _GstQueueLeaky GstQueueLeaky;
+typedef enum _GstQueueLeakPolicy GstQueueLeakPolicy;
 typedef struct _GstQueueClass GstQueueClass;
 
 /**
@@ -61,6 +62,26 @@ enum _GstQueueLeaky {
   GST_QUEUE_LEAK_DOWNSTREAM     = 2
 };
 
+/**
+ * GstQueueLeakPolicy:
+ * @GST_QUEUE_LEAK_POLICY_BUFFER: Leak single buffers and events
+ * @GST_QUEUE_LEAK_POLICY_DROPPABLE: Leak the droppable buffers first, then
+ *     whole groups of pictures
+ * @GST_QUEUE_LEAK_POLICY_GOP: Leak whole groups of pictures, from a key
+ *     unit up to the next one
+ *
+ * What a leaky queue drops to make room. The policies other than
+ * @GST_QUEUE_LEAK_POLICY_BUFFER only drop buffers and keep the data that
+ * remains decodable.
+ *
+ * Since: 1.2
+ */
+enum _GstQueueLeakPolicy {
+  GST_QUEUE_LEAK_POLICY_BUFFER    = 0,
+  GST_QUEUE_LEAK_POLICY_DROPPABLE = 1,
+  GST_QUEUE_LEAK_POLICY_GOP       = 2
+};
+
 /*
  * GstQueueSize:
  * @buffers: number of buffers
@@ -118,10 +139,16 @@ struct _GstQueue {
 
   /* whether we leak data, and at which end */
   gint leaky;
+  /* what we leak, and whether the incoming delta units are dropped until the
+   * next key unit because their group of pictures was leaked */
+  gint leak_policy;
+  gboolean drop_delta;
 
   GMutex qlock;        /* lock for queue (vs object lock) */
   gboolean waiting_add;
   GCond item_add;      /* signals buffers now available for reading */
+  GstTask *yield_task; /* the srcpad task when it yielded waiting for ADD */
+  gboolean yielded;     /* the srcpad task returned waiting for ADD */
   gboolean waiting_del;
   GCond item_del;      /* signals space now available for writing */
 
@@ -136,6 +163,10 @@ struct _GstQueue {
   gboolean last_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  /* push queued buffers in lists */
+  guint max_list_size;
+  guint64 max_list_time;
 };
 
 struct _GstQueueClass {
@@ -57,6 +57,7 @@
 #endif
 
 #include "gstqueue2.h"
+#include "gstelements_private.h"
 
 #include <glib/gstdio.h>
 
@@ -75,6 +76,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
 static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
     GST_PAD_SINK,
     GST_PAD_ALWAYS,
@@ -99,6 +104,8 @@ enum
 #define QUEUE_IS_USING_TEMP_FILE(queue) ((queue)->temp_template != NULL)
 #define QUEUE_IS_USING_RING_BUFFER(queue) ((queue)->ring_buffer_max_size != 0)  /* for consistency with the above macro */
 #define QUEUE_IS_USING_QUEUE(queue) (!QUEUE_IS_USING_TEMP_FILE(queue) && !QUEUE_IS_USING_RING_BUFFER (queue))
+/* a ring buffer in a temp file is accessed through its mapping if possible */
+#define QUEUE_IS_USING_FILE_IO(queue) (QUEUE_IS_USING_TEMP_FILE(queue) && (queue)->ring_buffer == NULL)
 
 #define QUEUE_MAX_BYTES(queue) MIN((queue)->max_level.bytes, (queue)->ring_buffer_max_size)
 
@@ -112,6 +119,9 @@ enum
 #define DEFAULT_HIGH_PERCENT       99
 #define DEFAULT_TEMP_REMOVE        TRUE
 #define DEFAULT_RING_BUFFER_MAX_SIZE 0
+#define DEFAULT_RATE_SMOOTHING     0.0
+#define DEFAULT_BUFFERING_STEP     1
+#define DEFAULT_PREFETCH_TIME      0
 
 enum
 {
@@ -130,6 +140,9 @@ enum
   PROP_TEMP_LOCATION,
   PROP_TEMP_REMOVE,
   PROP_RING_BUFFER_MAX_SIZE,
+  PROP_RATE_SMOOTHING,
+  PROP_BUFFERING_STEP,
+  PROP_PREFETCH_TIME,
   PROP_LAST
 };
 
@@ -194,6 +207,20 @@ enum
   STATUS (queue, q->srcpad, "received ADD");                            \
 } G_STMT_END
 
+/* the ring memory release can't take the lock so it only signals when the
+ * lock is free, poll for the release */
+#define GST_QUEUE2_WAIT_DEL_TIMED_CHECK(q, res, label) G_STMT_START {   \
+  STATUS (queue, q->sinkpad, "wait for ring release");                  \
+  q->waiting_del = TRUE;                                                \
+  g_cond_wait_until (&q->item_del, &queue->qlock,                       \
+      g_get_monotonic_time () + 10 * G_TIME_SPAN_MILLISECOND);          \
+  q->waiting_del = FALSE;                                               \
+  if (res != GST_FLOW_OK) {                                             \
+    STATUS (queue, q->srcpad, "received DEL wakeup");                   \
+    goto label;                                                         \
+  }                                                                     \
+} G_STMT_END
+
 #define GST_QUEUE2_SIGNAL_DEL(q) G_STMT_START {                          \
   if (q->waiting_del) {                                                 \
     STATUS (q, q->srcpad, "signal DEL");                                \
@@ -261,7 +288,8 @@ typedef enum
   GST_QUEUE2_ITEM_TYPE_UNKNOWN = 0,
   GST_QUEUE2_ITEM_TYPE_BUFFER,
   GST_QUEUE2_ITEM_TYPE_BUFFER_LIST,
-  GST_QUEUE2_ITEM_TYPE_EVENT
+  GST_QUEUE2_ITEM_TYPE_EVENT,
+  GST_QUEUE2_ITEM_TYPE_QUERY
 } GstQueue2ItemType;
 
 /* static guint gst_queue2_signals[LAST_SIGNAL] = { 0 }; */
@@ -359,6 +387,53 @@ gst_queue2_class_init (GstQueue2Class * klass)
           0, G_MAXUINT64, DEFAULT_RING_BUFFER_MAX_SIZE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstQueue2:rate-smoothing
+   *
+   * The weight of a new measurement in the exponentially weighted moving
+   * average of the input and output rates, measured every 200ms. Smaller
+   * values give a more stable estimate that adapts more slowly. If set to 0,
+   * the default averaging is used, which adapts faster for the output rate.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_RATE_SMOOTHING,
+      g_param_spec_double ("rate-smoothing", "Rate smoothing",
+          "Weight of new measurements in the rate estimate (0 = default)",
+          0.0, 1.0, DEFAULT_RATE_SMOOTHING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue2:buffering-step
+   *
+   * The minimum change of the buffering percentage before a new buffering
+   * message is posted while buffering. The messages when buffering starts
+   * and when it completes are always posted.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BUFFERING_STEP,
+      g_param_spec_int ("buffering-step", "Buffering step",
+          "Min. change of the percentage between buffering messages",
+          1, 100, DEFAULT_BUFFERING_STEP,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstQueue2:prefetch-time
+   *
+   * If non zero, buffering also completes when the queue holds this amount
+   * of data at the estimated output rate, even when the configured limits are
+   * not reached yet. The output rate is only known after data was consumed,
+   * before that only the limits are used.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_PREFETCH_TIME,
+      g_param_spec_uint64 ("prefetch-time", "Prefetch time (ns)",
+          "Amount of data at the output rate to buffer (in ns, 0=disable)",
+          0, G_MAXUINT64, DEFAULT_PREFETCH_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* set several parent class virtual functions */
   gobject_class->finalize = gst_queue2_finalize;
 
@@ -439,6 +514,7 @@ gst_queue2_init (GstQueue2 * queue)
   queue->waiting_del = FALSE;
   g_cond_init (&queue->item_del);
   g_queue_init (&queue->queue);
+  queue->range_seq = g_sequence_new (NULL);
 
   queue->buffering_percent = 100;
 
@@ -448,7 +524,11 @@ gst_queue2_init (GstQueue2 * queue)
   queue->temp_remove = DEFAULT_TEMP_REMOVE;
 
   queue->ring_buffer = NULL;
+  queue->ring = NULL;
   queue->ring_buffer_max_size = DEFAULT_RING_BUFFER_MAX_SIZE;
+  queue->rate_smoothing = DEFAULT_RATE_SMOOTHING;
+  queue->buffering_step = DEFAULT_BUFFERING_STEP;
+  queue->prefetch_time = DEFAULT_PREFETCH_TIME;
 
   GST_DEBUG_OBJECT (queue,
       "initialized queue's not_empty & not_full conditions");
@@ -475,6 +555,12 @@ gst_queue2_finalize (GObject * object)
   g_timer_destroy (queue->in_timer);
   g_timer_destroy (queue->out_timer);
 
+  if (queue->ring)
+    gst_queue2_ring_unref (queue->ring);
+
+  g_slice_free_chain (GstQueue2Range, queue->ranges, next);
+  g_sequence_free (queue->range_seq);
+
   /* temp_file path cleanup  */
   g_free (queue->temp_template);
   g_free (queue->temp_location);
@@ -504,10 +590,51 @@ clean_ranges (GstQueue2 * queue)
   GST_DEBUG_OBJECT (queue, "clean queue ranges");
 
   g_slice_free_chain (GstQueue2Range, queue->ranges, next);
+  g_sequence_remove_range (g_sequence_get_begin_iter (queue->range_seq),
+      g_sequence_get_end_iter (queue->range_seq));
   queue->ranges = NULL;
   queue->current = NULL;
 }
 
+/* free a range that was already unlinked from the list */
+static void
+free_range (GstQueue2 * queue, GstQueue2Range * range)
+{
+  g_sequence_remove (range->iter);
+  g_slice_free (GstQueue2Range, range);
+}
+
+static gint
+compare_range_offset (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstQueue2Range *ra = a, *rb = b;
+
+  if (ra->offset < rb->offset)
+    return -1;
+  if (ra->offset > rb->offset)
+    return 1;
+  return 0;
+}
+
+/* find the range with the highest offset <= @offset. Only valid when the
+ * ranges don't overlap, which is the case when not using a ring buffer
+ * because ranges are merged as soon as they touch. */
+static GstQueue2Range *
+lookup_range (GstQueue2 * queue, guint64 offset)
+{
+  GstQueue2Range key;
+  GSequenceIter *iter;
+
+  key.offset = offset;
+  /* points after all ranges with an offset <= @offset */
+  iter = g_sequence_search (queue->range_seq, &key, compare_range_offset,
+      NULL);
+  if (g_sequence_iter_is_begin (iter))
+    return NULL;
+
+  return g_sequence_get (g_sequence_iter_prev (iter));
+}
+
 /* find a range that contains @offset or NULL when nothing does */
 static GstQueue2Range *
 find_range (GstQueue2 * queue, guint64 offset)
@@ -515,12 +642,19 @@ find_range (GstQueue2 * queue, guint64 offset)
   GstQueue2Range *range = NULL;
   GstQueue2Range *walk;
 
-  /* first do a quick check for the current range */
-  for (walk = queue->ranges; walk; walk = walk->next) {
-    if (offset >= walk->offset && offset <= walk->writing_pos) {
-      /* we can reuse an existing range */
+  if (!QUEUE_IS_USING_RING_BUFFER (queue)) {
+    walk = lookup_range (queue, offset);
+    if (walk && offset <= walk->writing_pos)
       range = walk;
-      break;
+  } else {
+    /* ranges in the ring buffer can overlap, few of them exist at any time
+     * because they are overwritten */
+    for (walk = queue->ranges; walk; walk = walk->next) {
+      if (offset >= walk->offset && offset <= walk->writing_pos) {
+        /* we can reuse an existing range */
+        range = walk;
+        break;
+      }
     }
   }
   if (range) {
@@ -578,20 +712,27 @@ add_range (GstQueue2 * queue, guint64 offset, gboolean update_existing)
     range->max_reading_pos = offset;
 
     /* insert sorted */
-    prev = NULL;
-    next = queue->ranges;
-    while (next) {
-      if (next->offset > offset) {
-        /* insert before next */
-        GST_DEBUG_OBJECT (queue,
-            "insert before range %p, offset %" G_GUINT64_FORMAT, next,
-            next->offset);
-        break;
+    if (!QUEUE_IS_USING_RING_BUFFER (queue)) {
+      prev = lookup_range (queue, offset);
+      next = prev ? prev->next : queue->ranges;
+    } else {
+      prev = NULL;
+      next = queue->ranges;
+      while (next) {
+        if (next->offset > offset) {
+          /* insert before next */
+          GST_DEBUG_OBJECT (queue,
+              "insert before range %p, offset %" G_GUINT64_FORMAT, next,
+              next->offset);
+          break;
+        }
+        /* try next */
+        prev = next;
+        next = next->next;
       }
-      /* try next */
-      prev = next;
-      next = next->next;
     }
+    range->iter = g_sequence_insert_sorted (queue->range_seq, range,
+        compare_range_offset, NULL);
     range->next = next;
     if (prev)
       prev->next = range;
@@ -769,7 +910,7 @@ static gboolean
 get_buffering_percent (GstQueue2 * queue, gboolean * is_buffering,
     gint * percent)
 {
-  gboolean post = FALSE;
+  gboolean post = FALSE, changed = FALSE;
   gint perc;
 
   if (queue->high_percent <= 0) {
@@ -800,14 +941,26 @@ get_buffering_percent (GstQueue2 * queue, gboolean * is_buffering,
     /* also apply the rate estimate when we need to */
     if (queue->use_rate_estimate)
       perc = MAX (perc, GET_PERCENT (rate_time, 0));
+
+    /* the prefetch amount is reached at the high watermark */
+    if (queue->prefetch_time > 0 && queue->byte_out_rate > 0.0) {
+      gdouble prefetch_bytes;
+
+      prefetch_bytes = queue->byte_out_rate * queue->prefetch_time / GST_SECOND;
+      if (prefetch_bytes >= 1.0)
+        perc = MAX (perc, MIN (100, (gdouble) queue->cur_level.bytes *
+                queue->high_percent / prefetch_bytes));
+    }
   }
 #undef GET_PERCENT
 
   if (queue->is_buffering) {
     post = TRUE;
     /* if we were buffering see if we reached the high watermark */
-    if (perc >= queue->high_percent)
+    if (perc >= queue->high_percent) {
       queue->is_buffering = FALSE;
+      changed = TRUE;
+    }
   } else {
     /* we were not buffering, check if we need to start buffering if we drop
      * below the low threshold */
@@ -815,6 +968,7 @@ get_buffering_percent (GstQueue2 * queue, gboolean * is_buffering,
       queue->is_buffering = TRUE;
       queue->buffering_iteration++;
       post = TRUE;
+      changed = TRUE;
     }
   }
 
@@ -830,6 +984,10 @@ get_buffering_percent (GstQueue2 * queue, gboolean * is_buffering,
   if (post) {
     if (perc == queue->buffering_percent)
       post = FALSE;
+    else if (!changed && ABS (perc - queue->buffering_percent) <
+        queue->buffering_step)
+      /* don't flood the bus with small changes */
+      post = FALSE;
     else
       queue->buffering_percent = perc;
   }
@@ -928,6 +1086,8 @@ reset_rate_timer (GstQueue2 * queue)
  * weight to previous values. */
 #define AVG_IN(avg,val,w1,w2)  ((avg) * (w1) + (val) * (w2)) / ((w1) + (w2))
 #define AVG_OUT(avg,val) ((avg) * 3.0 + (val)) / 4.0
+/* configured exponentially weighted moving average */
+#define AVG_EWMA(avg,val,alpha) ((avg) * (1.0 - (alpha)) + (val) * (alpha))
 
 static void
 update_in_rates (GstQueue2 * queue)
@@ -955,6 +1115,9 @@ update_in_rates (GstQueue2 * queue)
 
     if (queue->byte_in_rate == 0.0)
       queue->byte_in_rate = byte_in_rate;
+    else if (queue->rate_smoothing > 0.0)
+      queue->byte_in_rate = AVG_EWMA (queue->byte_in_rate, byte_in_rate,
+          queue->rate_smoothing);
     else
       queue->byte_in_rate = AVG_IN (queue->byte_in_rate, byte_in_rate,
           (double) queue->byte_in_period, period);
@@ -1001,6 +1164,9 @@ update_out_rates (GstQueue2 * queue)
 
     if (queue->byte_out_rate == 0.0)
       queue->byte_out_rate = byte_out_rate;
+    else if (queue->rate_smoothing > 0.0)
+      queue->byte_out_rate = AVG_EWMA (queue->byte_out_rate, byte_out_rate,
+          queue->rate_smoothing);
     else
       queue->byte_out_rate = AVG_OUT (queue->byte_out_rate, byte_out_rate);
 
@@ -1153,13 +1319,13 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
 
   ring_buffer = queue->ring_buffer;
 
-  if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, offset))
+  if (QUEUE_IS_USING_FILE_IO (queue) && FSEEK_FILE (queue->temp_file, offset))
     goto seek_failed;
 
   /* this should not block */
   GST_LOG_OBJECT (queue, "Reading %d bytes from offset %" G_GUINT64_FORMAT,
       length, offset);
-  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+  if (QUEUE_IS_USING_FILE_IO (queue)) {
     res = fread (dst, 1, length, queue->temp_file);
   } else {
     memcpy (dst, ring_buffer + offset, length);
@@ -1169,7 +1335,7 @@ gst_queue2_read_data_at_offset (GstQueue2 * queue, guint64 offset, guint length,
   GST_LOG_OBJECT (queue, "read %" G_GSIZE_FORMAT " bytes", res);
 
   if (G_UNLIKELY (res < length)) {
-    if (!QUEUE_IS_USING_TEMP_FILE (queue))
+    if (!QUEUE_IS_USING_FILE_IO (queue))
       goto could_not_read;
     /* check for errors or EOF */
     if (ferror (queue->temp_file))
@@ -1199,11 +1365,231 @@ eos:
   }
 }
 
+/* The storage of the ring buffer. Memory that is handed out downstream
+ * without a copy keeps a ref to the ring and pins its region so that the
+ * writer doesn't overwrite it. */
+struct _GstQueue2Ring
+{
+  gint refcount;
+
+  guint8 *data;
+  gsize size;
+  gboolean mapped;
+
+  /* protects pins and pinned */
+  GMutex lock;
+  GList *pins;
+  gsize pinned;
+};
+
+/* at most this part of the ring is handed out without a copy, so that the
+ * writer can't be stalled by buffers that downstream keeps */
+#define RING_MAX_PINNED(ring) ((ring)->size / 2)
+
+typedef struct
+{
+  GstQueue2 *queue;
+  GstQueue2Ring *ring;
+  gsize offset;
+  gsize size;
+} GstQueue2RingPin;
+
+/* maps the temp file when it is used as the ring buffer, the data is then
+ * read and written directly in the mapping */
+static GstQueue2Ring *
+gst_queue2_ring_new (GstQueue2 * queue)
+{
+  GstQueue2Ring *ring;
+  gsize size = queue->ring_buffer_max_size;
+  gpointer data = NULL;
+  gboolean mapped = FALSE;
+
+#ifdef HAVE_MMAP
+  if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+    gint fd = fileno (queue->temp_file);
+
+    if (ftruncate (fd, size) == 0)
+      data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  } else {
+    data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (data == MAP_FAILED)
+    data = NULL;
+  mapped = data != NULL;
+#endif
+
+  if (data == NULL) {
+    /* temp files are then accessed with stdio */
+    if (QUEUE_IS_USING_TEMP_FILE (queue))
+      return NULL;
+
+    data = g_try_malloc (size);
+    if (data == NULL)
+      return NULL;
+  }
+
+  GST_DEBUG_OBJECT (queue, "allocated ring buffer of %" G_GSIZE_FORMAT
+      " bytes, mapped %d", size, mapped);
+
+  ring = g_slice_new0 (GstQueue2Ring);
+  ring->refcount = 1;
+  ring->data = data;
+  ring->size = size;
+  ring->mapped = mapped;
+  g_mutex_init (&ring->lock);
+
+  return ring;
+}
+
+static GstQueue2Ring *
+gst_queue2_ring_ref (GstQueue2Ring * ring)
+{
+  g_atomic_int_inc (&ring->refcount);
+  return ring;
+}
+
+static void
+gst_queue2_ring_unref (GstQueue2Ring * ring)
+{
+  if (!g_atomic_int_dec_and_test (&ring->refcount))
+    return;
+
+#ifdef HAVE_MMAP
+  if (ring->mapped)
+    munmap (ring->data, ring->size);
+  else
+#endif
+    g_free (ring->data);
+  g_mutex_clear (&ring->lock);
+  g_slice_free (GstQueue2Ring, ring);
+}
+
+/* must be called with MUTEX_LOCK */
+static gboolean
+gst_queue2_alloc_ring_buffer (GstQueue2 * queue)
+{
+  if (queue->ring) {
+    gst_queue2_ring_unref (queue->ring);
+    queue->ring = NULL;
+    queue->ring_buffer = NULL;
+  }
+
+  queue->ring = gst_queue2_ring_new (queue);
+  if (queue->ring)
+    queue->ring_buffer = queue->ring->data;
+
+  /* a temp file works without being mapped */
+  return queue->ring != NULL || QUEUE_IS_USING_TEMP_FILE (queue);
+}
+
+/* must be called with MUTEX_LOCK */
+static void
+gst_queue2_free_ring_buffer (GstQueue2 * queue)
+{
+  if (queue->ring) {
+    gst_queue2_ring_unref (queue->ring);
+    queue->ring = NULL;
+  }
+  queue->ring_buffer = NULL;
+}
+
+/* check if any data handed out downstream is in the @size bytes at @offset
+ * in the ring */
+static gboolean
+gst_queue2_ring_is_pinned (GstQueue2Ring * ring, gsize offset, gsize size)
+{
+  gsize start[2], end[2];
+  gint i, n;
+  gboolean res = FALSE;
+  GList *l;
+
+  if (ring == NULL || size == 0)
+    return FALSE;
+
+  /* the region can wrap around */
+  start[0] = offset;
+  if (offset + size > ring->size) {
+    end[0] = ring->size;
+    start[1] = 0;
+    end[1] = offset + size - ring->size;
+    n = 2;
+  } else {
+    end[0] = offset + size;
+    n = 1;
+  }
+
+  g_mutex_lock (&ring->lock);
+  for (l = ring->pins; l && !res; l = l->next) {
+    GstQueue2RingPin *pin = l->data;
+
+    for (i = 0; i < n; i++) {
+      if (pin->offset < end[i] && start[i] < pin->offset + pin->size)
+        res = TRUE;
+    }
+  }
+  g_mutex_unlock (&ring->lock);
+
+  return res;
+}
+
+static void
+gst_queue2_ring_pin_free (GstQueue2RingPin * pin)
+{
+  GstQueue2 *queue = pin->queue;
+  GstQueue2Ring *ring = pin->ring;
+
+  g_mutex_lock (&ring->lock);
+  ring->pins = g_list_remove (ring->pins, pin);
+  ring->pinned -= pin->size;
+  g_mutex_unlock (&ring->lock);
+
+  /* the memory can be freed with the lock held, the writer polls in that
+   * case */
+  if (g_mutex_trylock (&queue->qlock)) {
+    GST_QUEUE2_SIGNAL_DEL (queue);
+    g_mutex_unlock (&queue->qlock);
+  }
+
+  gst_object_unref (queue);
+  gst_queue2_ring_unref (ring);
+  g_slice_free (GstQueue2RingPin, pin);
+}
+
+/* wrap @size bytes at @offset of the ring in a memory, the region stays
+ * pinned until the memory is freed. Returns %NULL when too much of the ring
+ * is pinned already, the data must be copied then. */
+static GstMemory *
+gst_queue2_ring_wrap (GstQueue2 * queue, gsize offset, gsize size)
+{
+  GstQueue2Ring *ring = queue->ring;
+  GstQueue2RingPin *pin;
+
+  g_mutex_lock (&ring->lock);
+  if (ring->pinned + size > RING_MAX_PINNED (ring)) {
+    g_mutex_unlock (&ring->lock);
+    return NULL;
+  }
+  pin = g_slice_new (GstQueue2RingPin);
+  pin->queue = gst_object_ref (queue);
+  pin->ring = gst_queue2_ring_ref (ring);
+  pin->offset = offset;
+  pin->size = size;
+  ring->pins = g_list_prepend (ring->pins, pin);
+  ring->pinned += size;
+  g_mutex_unlock (&ring->lock);
+
+  return gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+      ring->data + offset, size, 0, size, pin,
+      (GDestroyNotify) gst_queue2_ring_pin_free);
+}
+
 static GstFlowReturn
 gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
     GstBuffer ** buffer)
 {
   GstBuffer *buf;
+  GstMemory *mem;
   GstMapInfo info;
   guint8 *data;
   guint64 file_offset;
@@ -1213,6 +1599,36 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
   guint64 rpos;
   GstFlowReturn ret = GST_FLOW_OK;
 
+  rb_size = queue->ring_buffer_max_size;
+
+  /* when the data is available and contiguous in the ring, hand it out
+   * without a copy */
+  if (*buffer == NULL && queue->ring && length > 0
+      && gst_queue2_have_data (queue, offset, length)) {
+    file_offset =
+        (queue->current->rb_offset + (offset -
+            queue->current->offset)) % rb_size;
+
+    if (file_offset + length <= rb_size
+        && (mem = gst_queue2_ring_wrap (queue, file_offset, length))) {
+      GST_DEBUG_OBJECT (queue, "Sharing %u bytes from %" G_GUINT64_FORMAT
+          " at ring offset %" G_GUINT64_FORMAT, length, offset, file_offset);
+
+      buf = gst_buffer_new ();
+      gst_buffer_append_memory (buf, mem);
+
+      queue->current->reading_pos = offset + length;
+      update_cur_pos (queue, queue->current, queue->current->reading_pos);
+      GST_QUEUE2_SIGNAL_DEL (queue);
+
+      GST_BUFFER_OFFSET (buf) = offset;
+      GST_BUFFER_OFFSET_END (buf) = offset + length;
+      *buffer = buf;
+
+      return GST_FLOW_OK;
+    }
+  }
+
   /* allocate the output buffer of the requested size */
   if (*buffer == NULL)
     buf = gst_buffer_new_allocate (NULL, length, NULL);
@@ -1226,7 +1642,6 @@ gst_queue2_create_read (GstQueue2 * queue, guint64 offset, guint length,
       offset);
 
   rpos = offset;
-  rb_size = queue->ring_buffer_max_size;
   max_size = QUEUE_MAX_BYTES (queue);
 
   remaining = length;
@@ -1516,7 +1931,9 @@ static void
 gst_queue2_locked_flush (GstQueue2 * queue)
 {
   if (!QUEUE_IS_USING_QUEUE (queue)) {
-    if (QUEUE_IS_USING_TEMP_FILE (queue))
+    /* a mapped ring buffer file can't be truncated, its data is
+     * overwritten anyway */
+    if (QUEUE_IS_USING_FILE_IO (queue))
       gst_queue2_flush_temp_file (queue);
     init_ranges (queue);
   } else {
@@ -1525,7 +1942,8 @@ gst_queue2_locked_flush (GstQueue2 * queue)
 
       /* Then lose another reference because we are supposed to destroy that
          data when flushing */
-      gst_mini_object_unref (data);
+      if (!GST_IS_QUERY (data))
+        gst_mini_object_unref (data);
     }
   }
   GST_QUEUE2_CLEAR_LEVEL (queue->cur_level);
@@ -1616,18 +2034,28 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
     if (QUEUE_IS_USING_RING_BUFFER (queue)) {
       gint64 space;
 
-      /* calculate the space in the ring buffer not used by data from
-       * the current range */
-      while (QUEUE_MAX_BYTES (queue) <= queue->cur_level.bytes) {
-        /* wait until there is some free space */
-        GST_QUEUE2_WAIT_DEL_CHECK (queue, queue->sinkresult, out_flushing);
-      }
-      /* get the amount of space we have */
-      space = QUEUE_MAX_BYTES (queue) - queue->cur_level.bytes;
+      while (TRUE) {
+        /* calculate the space in the ring buffer not used by data from
+         * the current range */
+        while (QUEUE_MAX_BYTES (queue) <= queue->cur_level.bytes) {
+          /* wait until there is some free space */
+          GST_QUEUE2_WAIT_DEL_CHECK (queue, queue->sinkresult, out_flushing);
+        }
+        /* get the amount of space we have */
+        space = QUEUE_MAX_BYTES (queue) - queue->cur_level.bytes;
+
+        /* calculate if we need to split or if we can write the entire
+         * buffer now */
+        to_write = MIN (size, space);
 
-      /* calculate if we need to split or if we can write the entire
-       * buffer now */
-      to_write = MIN (size, space);
+        /* data that was handed out without a copy can't be overwritten
+         * until downstream releases it */
+        if (!gst_queue2_ring_is_pinned (queue->ring, writing_pos, to_write))
+          break;
+
+        GST_QUEUE2_WAIT_DEL_TIMED_CHECK (queue, queue->sinkresult,
+            out_flushing);
+      }
 
       /* the writing position in the ring buffer after writing (part
        * or all of) the buffer */
@@ -1721,7 +2149,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
         if (range_to_destroy) {
           if (range_to_destroy == queue->ranges)
             queue->ranges = range;
-          g_slice_free (GstQueue2Range, range_to_destroy);
+          free_range (queue, range_to_destroy);
           range_to_destroy = NULL;
         }
       }
@@ -1730,7 +2158,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       new_writing_pos = writing_pos + to_write;
     }
 
-    if (QUEUE_IS_USING_TEMP_FILE (queue)
+    if (QUEUE_IS_USING_FILE_IO (queue)
         && FSEEK_FILE (queue->temp_file, writing_pos))
       goto seek_failed;
 
@@ -1740,7 +2168,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
           "] (rb wpos %" G_GUINT64_FORMAT ")", to_write, queue->current->offset,
           queue->current->writing_pos, queue->current->rb_writing_pos);
       /* either not using ring buffer or no wrapping, just write */
-      if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+      if (QUEUE_IS_USING_FILE_IO (queue)) {
         if (fwrite (data, to_write, 1, queue->temp_file) != 1)
           goto handle_error;
       } else {
@@ -1765,7 +2193,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
            * is a lot of data in the range we merged with to avoid reading it all
            * again. */
           queue->current->next = next->next;
-          g_slice_free (GstQueue2Range, next);
+          free_range (queue, next);
 
           debug_ranges (queue);
         }
@@ -1781,7 +2209,7 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
       if (block_one > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_one);
         /* write data to end of ring buffer */
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_FILE_IO (queue)) {
           if (fwrite (data, block_one, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -1789,12 +2217,12 @@ gst_queue2_create_write (GstQueue2 * queue, GstBuffer * buffer)
         }
       }
 
-      if (QUEUE_IS_USING_TEMP_FILE (queue) && FSEEK_FILE (queue->temp_file, 0))
+      if (QUEUE_IS_USING_FILE_IO (queue) && FSEEK_FILE (queue->temp_file, 0))
         goto seek_failed;
 
       if (block_two > 0) {
         GST_INFO_OBJECT (queue, "writing %u bytes", block_two);
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        if (QUEUE_IS_USING_FILE_IO (queue)) {
           if (fwrite (data + block_one, block_two, 1, queue->temp_file) != 1)
             goto handle_error;
         } else {
@@ -2001,6 +2429,9 @@ gst_queue2_locked_enqueue (GstQueue2 * queue, gpointer item,
           goto unexpected_event;
         break;
     }
+  } else if (item_type == GST_QUEUE2_ITEM_TYPE_QUERY) {
+    /* queries are only queued in the in-memory queue, they are not counted in
+     * the levels */
   } else {
     g_warning ("Unexpected item %p added in queue %s (refcounting problem?)",
         item, GST_OBJECT_NAME (queue));
@@ -2117,6 +2548,11 @@ gst_queue2_locked_dequeue (GstQueue2 * queue, GstQueue2ItemType * item_type)
     if (queue->use_buffering)
       update_buffering (queue);
 
+  } else if (GST_IS_QUERY (item)) {
+    *item_type = GST_QUEUE2_ITEM_TYPE_QUERY;
+
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "retrieved query %p from queue", item);
   } else {
     g_warning
         ("Unexpected item %p dequeued from queue %s (refcounting problem?)",
@@ -2248,19 +2684,51 @@ static gboolean
 gst_queue2_handle_sink_query (GstPad * pad, GstObject * parent,
     GstQuery * query)
 {
+  GstQueue2 *queue = GST_QUEUE2_CAST (parent);
   gboolean res;
 
   switch (GST_QUERY_TYPE (query)) {
     default:
-      if (GST_QUERY_IS_SERIALIZED (query)) {
-        GST_WARNING_OBJECT (pad, "unhandled serialized query");
-        res = FALSE;
+      if (G_UNLIKELY (GST_QUERY_IS_SERIALIZED (query))) {
+        /* serialized queries can only be kept in the in-memory queue */
+        if (!QUEUE_IS_USING_QUEUE (queue)) {
+          GST_WARNING_OBJECT (pad, "unhandled serialized query");
+          res = FALSE;
+          break;
+        }
+
+        GST_QUEUE2_MUTEX_LOCK_CHECK (queue, queue->sinkresult, out_flushing);
+        GST_LOG_OBJECT (queue, "queuing query %p (%s)", query,
+            GST_QUERY_TYPE_NAME (query));
+        gst_queue2_locked_enqueue (queue, query, GST_QUEUE2_ITEM_TYPE_QUERY);
+        while (!g_queue_is_empty (&queue->queue)) {
+          /* for as long as the queue has items, we know the query is
+           * not handled yet */
+          GST_QUEUE2_WAIT_DEL_CHECK (queue, queue->sinkresult, out_flushing);
+        }
+        res = queue->last_query;
+        /* upstream pools also need to fill the queue */
+        if (res && GST_QUERY_TYPE (query) == GST_QUERY_ALLOCATION)
+          gst_allocation_pools_add_buffers (GST_OBJECT_CAST (queue), query,
+              queue->max_level.buffers);
+        GST_QUEUE2_MUTEX_UNLOCK (queue);
       } else {
         res = gst_pad_query_default (pad, parent, query);
       }
       break;
   }
   return res;
+
+  /* ERRORS */
+out_flushing:
+  {
+    GST_DEBUG_OBJECT (queue, "we are flushing");
+
+    /* remove the query from the queue if still there, we hold no ref to it */
+    g_queue_remove (&queue->queue, query);
+    GST_QUEUE2_MUTEX_UNLOCK (queue);
+    return FALSE;
+  }
 }
 
 static gboolean
@@ -2454,6 +2922,10 @@ gst_queue2_dequeue_on_eos (GstQueue2 * queue, GstQueue2ItemType * item_type)
       GST_CAT_LOG_OBJECT (queue_dataflow, queue,
           "dropping EOS buffer list %p", data);
       gst_buffer_list_unref (GST_BUFFER_LIST_CAST (data));
+    } else if (*item_type == GST_QUEUE2_ITEM_TYPE_QUERY) {
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+          "dropping EOS query %p", data);
+      queue->last_query = FALSE;
     }
   }
   /* no more items in the queue. Set the unexpected flag so that upstream
@@ -2478,6 +2950,17 @@ gst_queue2_push_one (GstQueue2 * queue)
     goto no_item;
 
 next:
+  if (item_type == GST_QUEUE2_ITEM_TYPE_QUERY) {
+    GstQuery *query = GST_QUERY_CAST (data);
+
+    /* the query is done with the lock held, the sinkpad waits for the queue
+     * to be empty and then picks up the result */
+    queue->last_query = gst_pad_peer_query (queue->srcpad, query);
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "did query %p, return %d", query, queue->last_query);
+    return result;
+  }
+
   GST_QUEUE2_MUTEX_UNLOCK (queue);
 
   if (item_type == GST_QUEUE2_ITEM_TYPE_BUFFER) {
@@ -2709,6 +3192,21 @@ gst_queue2_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
       GST_DEBUG_OBJECT (queue, "peer query success");
       break;
     }
+    case GST_QUERY_MEMORY_USAGE:
+    {
+      guint64 allocated = 0, queued = 0;
+
+      GST_QUEUE2_MUTEX_LOCK (queue);
+      /* data in the ring or the temp file is not held in buffers */
+      if (queue->ring_buffer != NULL)
+        allocated = queue->ring_buffer_max_size;
+      else if (!QUEUE_IS_USING_TEMP_FILE (queue))
+        queued = queue->cur_level.bytes;
+      GST_QUEUE2_MUTEX_UNLOCK (queue);
+
+      gst_query_add_memory_usage (query, parent, allocated, queued);
+      break;
+    }
     case GST_QUERY_BUFFERING:
     {
       gint percent;
@@ -3036,9 +3534,10 @@ gst_queue2_src_activate_pull (GstPad * pad, GstObject * parent, gboolean active)
       if (QUEUE_IS_USING_TEMP_FILE (queue)) {
         /* open the temp file now */
         result = gst_queue2_open_temp_location_file (queue);
-      } else if (!queue->ring_buffer) {
-        queue->ring_buffer = g_malloc (queue->ring_buffer_max_size);
-        result = ! !queue->ring_buffer;
+        if (result && QUEUE_IS_USING_RING_BUFFER (queue) && !queue->ring)
+          result = gst_queue2_alloc_ring_buffer (queue);
+      } else if (!queue->ring) {
+        result = gst_queue2_alloc_ring_buffer (queue);
       } else {
         result = TRUE;
       }
@@ -3111,12 +3610,10 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
         if (QUEUE_IS_USING_TEMP_FILE (queue)) {
           if (!gst_queue2_open_temp_location_file (queue))
             ret = GST_STATE_CHANGE_FAILURE;
+          else if (QUEUE_IS_USING_RING_BUFFER (queue))
+            gst_queue2_alloc_ring_buffer (queue);
         } else {
-          if (queue->ring_buffer) {
-            g_free (queue->ring_buffer);
-            queue->ring_buffer = NULL;
-          }
-          if (!(queue->ring_buffer = g_malloc (queue->ring_buffer_max_size)))
+          if (!gst_queue2_alloc_ring_buffer (queue))
             ret = GST_STATE_CHANGE_FAILURE;
         }
         init_ranges (queue);
@@ -3146,12 +3643,9 @@ gst_queue2_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       GST_QUEUE2_MUTEX_LOCK (queue);
       if (!QUEUE_IS_USING_QUEUE (queue)) {
-        if (QUEUE_IS_USING_TEMP_FILE (queue)) {
+        gst_queue2_free_ring_buffer (queue);
+        if (QUEUE_IS_USING_TEMP_FILE (queue))
           gst_queue2_close_temp_location_file (queue);
-        } else if (queue->ring_buffer) {
-          g_free (queue->ring_buffer);
-          queue->ring_buffer = NULL;
-        }
         clean_ranges (queue);
       }
       if (queue->starting_segment != NULL) {
@@ -3256,6 +3750,15 @@ gst_queue2_set_property (GObject * object,
     case PROP_RING_BUFFER_MAX_SIZE:
       queue->ring_buffer_max_size = g_value_get_uint64 (value);
       break;
+    case PROP_RATE_SMOOTHING:
+      queue->rate_smoothing = g_value_get_double (value);
+      break;
+    case PROP_BUFFERING_STEP:
+      queue->buffering_step = g_value_get_int (value);
+      break;
+    case PROP_PREFETCH_TIME:
+      queue->prefetch_time = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3315,6 +3818,15 @@ gst_queue2_get_property (GObject * object,
     case PROP_RING_BUFFER_MAX_SIZE:
       g_value_set_uint64 (value, queue->ring_buffer_max_size);
       break;
+    case PROP_RATE_SMOOTHING:
+      g_value_set_double (value, queue->rate_smoothing);
+      break;
+    case PROP_BUFFERING_STEP:
+      g_value_set_int (value, queue->buffering_step);
+      break;
+    case PROP_PREFETCH_TIME:
+      g_value_set_uint64 (value, queue->prefetch_time);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -46,6 +46,7 @@ typedef struct _GstQueue2 GstQueue2;
 typedef struct _GstQueue2Size GstQueue2Size;
 typedef struct _GstQueue2Class GstQueue2Class;
 typedef struct _GstQueue2Range GstQueue2Range;
+typedef struct _GstQueue2Ring GstQueue2Ring;
 
 /* used to keep track of sizes (current and max) */
 struct _GstQueue2Size
@@ -59,6 +60,7 @@ struct _GstQueue2Size
 struct _GstQueue2Range
 {
   GstQueue2Range *next;
+  GSequenceIter *iter;     /* position in the range lookup sequence */
 
   guint64 offset;          /* offset of range start in source */
   guint64 rb_offset;       /* offset of range start in ring buffer */
@@ -104,6 +106,9 @@ struct _GstQueue2
   GstClockTime buffering_interval;
   gint low_percent;             /* low/high watermarks for buffering */
   gint high_percent;
+  gint buffering_step;          /* min. percent change between messages */
+  GstClockTime prefetch_time;   /* amount of data at the out rate to buffer */
+  gdouble rate_smoothing;       /* EWMA weight of new rate measurements */
 
   /* current buffering state */
   gboolean is_buffering;
@@ -139,6 +144,8 @@ struct _GstQueue2
   /* list of downloaded areas and the current area */
   GstQueue2Range *ranges;
   GstQueue2Range *current;
+  /* the ranges sorted by offset for lookups */
+  GSequence *range_seq;
   /* we need this to send the first new segment event of the stream
    * because we can't save it on the file */
   gboolean segment_event_received;
@@ -147,8 +154,12 @@ struct _GstQueue2
 
   GstEvent *stream_start_event;
 
+  /* result of the last serialized query */
+  gboolean last_query;
+
   guint64 ring_buffer_max_size;
   guint8 * ring_buffer;
+  GstQueue2Ring *ring;
 };
 
 struct _GstQueue2Class
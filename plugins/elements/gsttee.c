@@ -32,7 +32,9 @@
  *
  * One needs to use separate queue elements (or a multiqueue) in each branch to
  * provide separate threads for each branch. Otherwise a blocked dataflow in one
- * branch would stall the other branches.
+ * branch would stall the other branches. Alternatively #GstTee:branch-queue
+ * can be enabled, tee then queues the data for each branch itself and pushes
+ * it from a separate thread per src pad.
  *
  * <refsect2>
  * <title>Example launch line</title>
@@ -49,6 +51,7 @@
 
 #include "gsttee.h"
 #include "gst/glib-compat-private.h"
+#include "../../gst/gst-i18n-lib.h"
 
 #include <string.h>
 
@@ -78,6 +81,26 @@ gst_tee_pull_mode_get_type (void)
   return type;
 }
 
+#define GST_TYPE_TEE_BRANCH_LEAKY (gst_tee_branch_leaky_get_type())
+static GType
+gst_tee_branch_leaky_get_type (void)
+{
+  static GType type = 0;
+  static const GEnumValue data[] = {
+    {GST_TEE_BRANCH_NO_LEAK, "Not Leaky", "no"},
+    {GST_TEE_BRANCH_LEAK_UPSTREAM, "Leaky on upstream (new buffers)",
+        "upstream"},
+    {GST_TEE_BRANCH_LEAK_DOWNSTREAM, "Leaky on downstream (old buffers)",
+        "downstream"},
+    {0, NULL, NULL},
+  };
+
+  if (!type) {
+    type = g_enum_register_static ("GstTeeBranchLeaky", data);
+  }
+  return type;
+}
+
 /* lock to protect request pads from being removed while downstream */
 #define GST_TEE_DYN_LOCK(tee) g_mutex_lock (&(tee)->dyn_lock)
 #define GST_TEE_DYN_UNLOCK(tee) g_mutex_unlock (&(tee)->dyn_lock)
@@ -87,6 +110,12 @@ gst_tee_pull_mode_get_type (void)
 #define DEFAULT_PROP_SILENT		TRUE
 #define DEFAULT_PROP_LAST_MESSAGE	NULL
 #define DEFAULT_PULL_MODE		GST_TEE_PULL_MODE_NEVER
+#define DEFAULT_PROP_PARALLEL_PUSH	FALSE
+#define DEFAULT_PROP_BRANCH_QUEUE	FALSE
+#define DEFAULT_PROP_BRANCH_MAX_SIZE_BUFFERS	200
+#define DEFAULT_PROP_BRANCH_MAX_SIZE_BYTES	(10 * 1024 * 1024)
+#define DEFAULT_PROP_BRANCH_MAX_SIZE_TIME	GST_SECOND
+#define DEFAULT_PROP_BRANCH_LEAKY	GST_TEE_BRANCH_NO_LEAK
 
 enum
 {
@@ -97,6 +126,12 @@ enum
   PROP_LAST_MESSAGE,
   PROP_PULL_MODE,
   PROP_ALLOC_PAD,
+  PROP_PARALLEL_PUSH,
+  PROP_BRANCH_QUEUE,
+  PROP_BRANCH_MAX_SIZE_BUFFERS,
+  PROP_BRANCH_MAX_SIZE_BYTES,
+  PROP_BRANCH_MAX_SIZE_TIME,
+  PROP_BRANCH_LEAKY,
 };
 
 static GstStaticPadTemplate tee_src_template =
@@ -138,6 +173,21 @@ struct _GstTeePad
   gboolean pushed;
   GstFlowReturn result;
   gboolean removed;
+
+  /* branch queue, all protected by qlock */
+  GMutex qlock;
+  GCond item_add;
+  GCond item_del;
+  gboolean queued;
+  GQueue queue;
+  guint cur_buffers;
+  guint cur_bytes;
+  GstClockTime sink_ts;
+  GstClockTime src_ts;
+  GstFlowReturn srcresult;
+  gboolean eos;
+  /* the task is pushing an item it took from the queue */
+  gboolean pushing;
 };
 
 struct _GstTeePadClass
@@ -147,9 +197,27 @@ struct _GstTeePadClass
 
 G_DEFINE_TYPE (GstTeePad, gst_tee_pad, GST_TYPE_PAD);
 
+static void gst_tee_pad_flush_queue (GstTeePad * pad);
+
+static void
+gst_tee_pad_finalize (GObject * object)
+{
+  GstTeePad *pad = GST_TEE_PAD_CAST (object);
+
+  gst_tee_pad_flush_queue (pad);
+  g_mutex_clear (&pad->qlock);
+  g_cond_clear (&pad->item_add);
+  g_cond_clear (&pad->item_del);
+
+  G_OBJECT_CLASS (gst_tee_pad_parent_class)->finalize (object);
+}
+
 static void
 gst_tee_pad_class_init (GstTeePadClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = gst_tee_pad_finalize;
 }
 
 static void
@@ -163,6 +231,17 @@ gst_tee_pad_reset (GstTeePad * pad)
 static void
 gst_tee_pad_init (GstTeePad * pad)
 {
+  g_mutex_init (&pad->qlock);
+  g_cond_init (&pad->item_add);
+  g_cond_init (&pad->item_del);
+  g_queue_init (&pad->queue);
+  pad->queued = FALSE;
+  pad->cur_buffers = 0;
+  pad->cur_bytes = 0;
+  pad->sink_ts = GST_CLOCK_TIME_NONE;
+  pad->src_ts = GST_CLOCK_TIME_NONE;
+  pad->srcresult = GST_FLOW_FLUSHING;
+  pad->eos = FALSE;
   gst_tee_pad_reset (pad);
 }
 
@@ -189,6 +268,7 @@ static gboolean gst_tee_sink_activate_mode (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active);
 static gboolean gst_tee_src_query (GstPad * pad, GstObject * parent,
     GstQuery * query);
+static void gst_tee_pad_loop (GstTeePad * pad);
 static gboolean gst_tee_src_activate_mode (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active);
 static GstFlowReturn gst_tee_src_get_range (GstPad * pad, GstObject * parent,
@@ -220,6 +300,10 @@ gst_tee_finalize (GObject * object)
 
   g_free (tee->last_message);
 
+  if (tee->task_pool_prepared)
+    gst_task_pool_cleanup (tee->task_pool);
+  gst_object_unref (tee->task_pool);
+
   g_mutex_clear (&tee->dyn_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -253,7 +337,7 @@ gst_tee_class_init (GstTeeClass * klass)
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   pspec_last_message = g_param_spec_string ("last-message", "Last Message",
       "The message describing current status", DEFAULT_PROP_LAST_MESSAGE,
-      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+      G_PARAM_READABLE | GST_PARAM_HIGH_FREQUENCY | G_PARAM_STATIC_STRINGS);
   g_object_class_install_property (gobject_class, PROP_LAST_MESSAGE,
       pspec_last_message);
   g_object_class_install_property (gobject_class, PROP_PULL_MODE,
@@ -266,6 +350,83 @@ gst_tee_class_init (GstTeeClass * klass)
       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
   g_object_class_install_property (gobject_class, PROP_ALLOC_PAD,
       pspec_alloc_pad);
+  /**
+   * GstTee:parallel-push:
+   *
+   * Push buffer lists to all src pads at the same time from a pool of
+   * threads instead of pushing to one src pad after the other. The list is
+   * shared between the src pads, the call only returns when all pads have
+   * been pushed on.
+   */
+  g_object_class_install_property (gobject_class, PROP_PARALLEL_PUSH,
+      g_param_spec_boolean ("parallel-push", "Parallel push",
+          "Push buffer lists to all src pads in parallel",
+          DEFAULT_PROP_PARALLEL_PUSH,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTee:branch-queue:
+   *
+   * Queue the data for each src pad inside tee and push it downstream from a
+   * separate thread per src pad, like a queue element after each src pad
+   * would do. The queues are limited with the branch-max-size-* properties.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BRANCH_QUEUE,
+      g_param_spec_boolean ("branch-queue", "Branch queue",
+          "Queue data for each src pad and push it from a thread per pad",
+          DEFAULT_PROP_BRANCH_QUEUE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+  /**
+   * GstTee:branch-max-size-buffers:
+   *
+   * Max. number of buffers in the queue of each src pad (0=disable).
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BRANCH_MAX_SIZE_BUFFERS,
+      g_param_spec_uint ("branch-max-size-buffers",
+          "Branch max. size (buffers)",
+          "Max. number of buffers in the queue of each src pad (0=disable)",
+          0, G_MAXUINT, DEFAULT_PROP_BRANCH_MAX_SIZE_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTee:branch-max-size-bytes:
+   *
+   * Max. amount of data in the queue of each src pad (bytes, 0=disable).
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BRANCH_MAX_SIZE_BYTES,
+      g_param_spec_uint ("branch-max-size-bytes", "Branch max. size (kB)",
+          "Max. amount of data in the queue of each src pad (bytes, 0=disable)",
+          0, G_MAXUINT, DEFAULT_PROP_BRANCH_MAX_SIZE_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTee:branch-max-size-time:
+   *
+   * Max. amount of data in the queue of each src pad (in ns, 0=disable).
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BRANCH_MAX_SIZE_TIME,
+      g_param_spec_uint64 ("branch-max-size-time", "Branch max. size (ns)",
+          "Max. amount of data in the queue of each src pad (in ns, 0=disable)",
+          0, G_MAXUINT64, DEFAULT_PROP_BRANCH_MAX_SIZE_TIME,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTee:branch-leaky:
+   *
+   * Where the queue of a src pad leaks when it is full, if at all.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_BRANCH_LEAKY,
+      g_param_spec_enum ("branch-leaky", "Branch leaky",
+          "Where the queue of a src pad leaks, if at all",
+          GST_TYPE_TEE_BRANCH_LEAKY, DEFAULT_PROP_BRANCH_LEAKY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_set_static_metadata (gstelement_class,
       "Tee pipe fitting",
@@ -303,6 +464,16 @@ gst_tee_init (GstTee * tee)
   gst_element_add_pad (GST_ELEMENT (tee), tee->sinkpad);
 
   tee->last_message = NULL;
+
+  tee->parallel_push = DEFAULT_PROP_PARALLEL_PUSH;
+  tee->task_pool = gst_task_pool_new ();
+  tee->task_pool_prepared = FALSE;
+
+  tee->branch_queue = DEFAULT_PROP_BRANCH_QUEUE;
+  tee->branch_max_size_buffers = DEFAULT_PROP_BRANCH_MAX_SIZE_BUFFERS;
+  tee->branch_max_size_bytes = DEFAULT_PROP_BRANCH_MAX_SIZE_BYTES;
+  tee->branch_max_size_time = DEFAULT_PROP_BRANCH_MAX_SIZE_TIME;
+  tee->branch_leaky = DEFAULT_PROP_BRANCH_LEAKY;
 }
 
 static void
@@ -347,6 +518,9 @@ gst_tee_request_new_pad (GstElement * element, GstPadTemplate * templ,
 
   GST_OBJECT_UNLOCK (tee);
 
+  gst_pad_set_activatemode_function (srcpad,
+      GST_DEBUG_FUNCPTR (gst_tee_src_activate_mode));
+
   switch (mode) {
     case GST_PAD_MODE_PULL:
       /* we already have a src pad in pull mode, and our pull mode can only be
@@ -362,8 +536,6 @@ gst_tee_request_new_pad (GstElement * element, GstPadTemplate * templ,
   if (!res)
     goto activate_failed;
 
-  gst_pad_set_activatemode_function (srcpad,
-      GST_DEBUG_FUNCPTR (gst_tee_src_activate_mode));
   gst_pad_set_query_function (srcpad, GST_DEBUG_FUNCPTR (gst_tee_src_query));
   gst_pad_set_getrange_function (srcpad,
       GST_DEBUG_FUNCPTR (gst_tee_src_get_range));
@@ -428,6 +600,278 @@ gst_tee_release_pad (GstElement * element, GstPad * pad)
   }
 }
 
+/* must be called with the OBJECT_LOCK, wakes up the streaming thread when
+ * it is waiting for space in a branch queue */
+static void
+gst_tee_branch_capacity_change (GstTee * tee)
+{
+  GList *pads;
+
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = g_list_next (pads)) {
+    GstTeePad *pad = GST_TEE_PAD_CAST (pads->data);
+
+    g_mutex_lock (&pad->qlock);
+    g_cond_signal (&pad->item_del);
+    g_mutex_unlock (&pad->qlock);
+  }
+}
+
+/* must be called with the qlock */
+static void
+gst_tee_pad_update_level (GstTeePad * pad, GstMiniObject * item, gboolean add)
+{
+  GstBuffer *buffer;
+  GstClockTime ts;
+  guint buffers, bytes;
+
+  if (GST_IS_BUFFER (item)) {
+    buffer = GST_BUFFER_CAST (item);
+    buffers = 1;
+    bytes = gst_buffer_get_size (buffer);
+  } else if (GST_IS_BUFFER_LIST (item)) {
+    GstBufferList *list = GST_BUFFER_LIST_CAST (item);
+    guint i;
+
+    buffers = gst_buffer_list_length (list);
+    bytes = 0;
+    for (i = 0; i < buffers; i++)
+      bytes += gst_buffer_get_size (gst_buffer_list_get (list, i));
+    buffer = buffers > 0 ? gst_buffer_list_get (list, 0) : NULL;
+  } else {
+    return;
+  }
+
+  ts = GST_CLOCK_TIME_NONE;
+  if (buffer) {
+    ts = GST_BUFFER_DTS (buffer);
+    if (!GST_CLOCK_TIME_IS_VALID (ts))
+      ts = GST_BUFFER_PTS (buffer);
+  }
+
+  if (add) {
+    pad->cur_buffers += buffers;
+    pad->cur_bytes += bytes;
+    if (GST_CLOCK_TIME_IS_VALID (ts)) {
+      pad->sink_ts = ts;
+      if (!GST_CLOCK_TIME_IS_VALID (pad->src_ts))
+        pad->src_ts = ts;
+    }
+  } else {
+    pad->cur_buffers -= buffers;
+    pad->cur_bytes -= bytes;
+    if (GST_CLOCK_TIME_IS_VALID (ts))
+      pad->src_ts = ts;
+  }
+}
+
+/* must be called with the qlock */
+static gboolean
+gst_tee_pad_is_filled (GstTee * tee, GstTeePad * pad)
+{
+  GstClockTime cur_time = 0;
+
+  if (GST_CLOCK_TIME_IS_VALID (pad->sink_ts) &&
+      GST_CLOCK_TIME_IS_VALID (pad->src_ts) && pad->sink_ts > pad->src_ts)
+    cur_time = pad->sink_ts - pad->src_ts;
+
+  return (tee->branch_max_size_buffers > 0 &&
+      pad->cur_buffers >= tee->branch_max_size_buffers) ||
+      (tee->branch_max_size_bytes > 0 &&
+      pad->cur_bytes >= tee->branch_max_size_bytes) ||
+      (tee->branch_max_size_time > 0 &&
+      cur_time >= tee->branch_max_size_time);
+}
+
+/* must be called with the qlock, drops the oldest buffer or list in the
+ * queue. Returns FALSE when there was none. */
+static gboolean
+gst_tee_pad_leak_downstream (GstTeePad * pad)
+{
+  GList *walk;
+
+  for (walk = pad->queue.head; walk; walk = g_list_next (walk)) {
+    GstMiniObject *item = walk->data;
+
+    if (GST_IS_BUFFER (item) || GST_IS_BUFFER_LIST (item)) {
+      GST_LOG_OBJECT (pad, "queue is full, leaking item %p on downstream end",
+          item);
+      g_queue_delete_link (&pad->queue, walk);
+      gst_tee_pad_update_level (pad, item, FALSE);
+      gst_mini_object_unref (item);
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+static void
+gst_tee_pad_flush_queue (GstTeePad * pad)
+{
+  GstMiniObject *item;
+
+  while ((item = g_queue_pop_head (&pad->queue)))
+    gst_mini_object_unref (item);
+
+  pad->cur_buffers = 0;
+  pad->cur_bytes = 0;
+  pad->sink_ts = GST_CLOCK_TIME_NONE;
+  pad->src_ts = GST_CLOCK_TIME_NONE;
+  pad->eos = FALSE;
+}
+
+/* queue @item on @pad or push it directly when the pad has no queue. Buffers
+ * and lists wait for space when the queue is full and it does not leak,
+ * events are always queued. Takes ownership of @item. */
+static GstFlowReturn
+gst_tee_pad_enqueue (GstTee * tee, GstTeePad * pad, GstMiniObject * item)
+{
+  GstFlowReturn ret;
+
+  g_mutex_lock (&pad->qlock);
+  if (G_UNLIKELY (!pad->queued)) {
+    g_mutex_unlock (&pad->qlock);
+
+    if (GST_IS_BUFFER (item))
+      return gst_pad_push (GST_PAD_CAST (pad), GST_BUFFER_CAST (item));
+    if (GST_IS_BUFFER_LIST (item))
+      return gst_pad_push_list (GST_PAD_CAST (pad),
+          GST_BUFFER_LIST_CAST (item));
+    gst_pad_push_event (GST_PAD_CAST (pad), GST_EVENT_CAST (item));
+    return GST_FLOW_OK;
+  }
+
+  if (pad->srcresult != GST_FLOW_OK && pad->srcresult != GST_FLOW_NOT_LINKED)
+    goto out_flushing;
+
+  if (GST_IS_BUFFER (item) || GST_IS_BUFFER_LIST (item)) {
+    while (gst_tee_pad_is_filled (tee, pad)) {
+      if (tee->branch_leaky == GST_TEE_BRANCH_LEAK_UPSTREAM) {
+        GST_LOG_OBJECT (pad, "queue is full, leaking item %p on upstream end",
+            item);
+        ret = pad->srcresult;
+        g_mutex_unlock (&pad->qlock);
+        gst_mini_object_unref (item);
+        return ret;
+      } else if (tee->branch_leaky == GST_TEE_BRANCH_LEAK_DOWNSTREAM) {
+        if (!gst_tee_pad_leak_downstream (pad))
+          break;
+      } else {
+        GST_LOG_OBJECT (pad, "queue is full, waiting for free space");
+        g_cond_wait (&pad->item_del, &pad->qlock);
+        if (pad->srcresult != GST_FLOW_OK &&
+            pad->srcresult != GST_FLOW_NOT_LINKED)
+          goto out_flushing;
+      }
+    }
+  } else if (GST_EVENT_TYPE (item) == GST_EVENT_EOS) {
+    pad->eos = TRUE;
+  }
+
+  g_queue_push_tail (&pad->queue, item);
+  gst_tee_pad_update_level (pad, item, TRUE);
+  g_cond_signal (&pad->item_add);
+  ret = pad->srcresult;
+  g_mutex_unlock (&pad->qlock);
+
+  return ret;
+
+  /* ERRORS */
+out_flushing:
+  {
+    ret = pad->srcresult;
+    GST_LOG_OBJECT (pad, "not queueing item %p, reason: %s", item,
+        gst_flow_get_name (ret));
+    g_mutex_unlock (&pad->qlock);
+    gst_mini_object_unref (item);
+    return ret;
+  }
+}
+
+static void
+gst_tee_pad_loop (GstTeePad * pad)
+{
+  GstElement *tee;
+  GstMiniObject *item;
+  GstFlowReturn ret;
+  gboolean eos;
+
+  g_mutex_lock (&pad->qlock);
+  while (g_queue_is_empty (&pad->queue) &&
+      pad->srcresult != GST_FLOW_FLUSHING)
+    g_cond_wait (&pad->item_add, &pad->qlock);
+
+  if (pad->srcresult == GST_FLOW_FLUSHING)
+    goto out_flushing;
+
+  item = g_queue_pop_head (&pad->queue);
+  gst_tee_pad_update_level (pad, item, FALSE);
+  pad->pushing = TRUE;
+  g_cond_signal (&pad->item_del);
+  g_mutex_unlock (&pad->qlock);
+
+  if (GST_IS_BUFFER (item)) {
+    ret = gst_pad_push (GST_PAD_CAST (pad), GST_BUFFER_CAST (item));
+  } else if (GST_IS_BUFFER_LIST (item)) {
+    ret = gst_pad_push_list (GST_PAD_CAST (pad), GST_BUFFER_LIST_CAST (item));
+  } else {
+    eos = GST_EVENT_TYPE (item) == GST_EVENT_EOS;
+
+    gst_pad_push_event (GST_PAD_CAST (pad), GST_EVENT_CAST (item));
+    /* keep the result of the last buffer for other events */
+    if (!eos) {
+      g_mutex_lock (&pad->qlock);
+      pad->pushing = FALSE;
+      g_cond_signal (&pad->item_del);
+      g_mutex_unlock (&pad->qlock);
+      return;
+    }
+    ret = GST_FLOW_EOS;
+  }
+
+  g_mutex_lock (&pad->qlock);
+  pad->pushing = FALSE;
+  g_cond_signal (&pad->item_del);
+  /* flushing while we were pushing, keep the flushing result */
+  if (pad->srcresult == GST_FLOW_FLUSHING)
+    goto out_flushing;
+
+  /* not-linked branches are simply skipped, like tee does without queues */
+  pad->srcresult = ret;
+  if (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED)
+    goto out_paused;
+  g_mutex_unlock (&pad->qlock);
+
+  return;
+
+out_flushing:
+  {
+    GST_LOG_OBJECT (pad, "pausing task, we are flushing");
+    g_mutex_unlock (&pad->qlock);
+    gst_pad_pause_task (GST_PAD_CAST (pad));
+    return;
+  }
+out_paused:
+  {
+    eos = pad->eos;
+    GST_LOG_OBJECT (pad, "pausing task, reason %s", gst_flow_get_name (ret));
+    /* the error would be returned upstream on the next buffer, but there is
+     * none after EOS so we post it ourselves */
+    g_cond_signal (&pad->item_del);
+    g_mutex_unlock (&pad->qlock);
+    gst_pad_pause_task (GST_PAD_CAST (pad));
+
+    if (eos && ret < GST_FLOW_EOS &&
+        (tee = gst_pad_get_parent_element (GST_PAD_CAST (pad)))) {
+      GST_ELEMENT_ERROR (tee, STREAM, FAILED,
+          (_("Internal data flow error.")),
+          ("streaming task paused, reason %s (%d)",
+              gst_flow_get_name (ret), ret));
+      gst_object_unref (tee);
+    }
+    return;
+  }
+}
+
 static void
 gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
     GParamSpec * pspec)
@@ -457,6 +901,28 @@ gst_tee_set_property (GObject * object, guint prop_id, const GValue * value,
       GST_OBJECT_UNLOCK (pad);
       break;
     }
+    case PROP_PARALLEL_PUSH:
+      tee->parallel_push = g_value_get_boolean (value);
+      break;
+    case PROP_BRANCH_QUEUE:
+      tee->branch_queue = g_value_get_boolean (value);
+      break;
+    case PROP_BRANCH_MAX_SIZE_BUFFERS:
+      tee->branch_max_size_buffers = g_value_get_uint (value);
+      gst_tee_branch_capacity_change (tee);
+      break;
+    case PROP_BRANCH_MAX_SIZE_BYTES:
+      tee->branch_max_size_bytes = g_value_get_uint (value);
+      gst_tee_branch_capacity_change (tee);
+      break;
+    case PROP_BRANCH_MAX_SIZE_TIME:
+      tee->branch_max_size_time = g_value_get_uint64 (value);
+      gst_tee_branch_capacity_change (tee);
+      break;
+    case PROP_BRANCH_LEAKY:
+      tee->branch_leaky = (GstTeeBranchLeaky) g_value_get_enum (value);
+      gst_tee_branch_capacity_change (tee);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -490,6 +956,24 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_ALLOC_PAD:
       g_value_set_object (value, tee->allocpad);
       break;
+    case PROP_PARALLEL_PUSH:
+      g_value_set_boolean (value, tee->parallel_push);
+      break;
+    case PROP_BRANCH_QUEUE:
+      g_value_set_boolean (value, tee->branch_queue);
+      break;
+    case PROP_BRANCH_MAX_SIZE_BUFFERS:
+      g_value_set_uint (value, tee->branch_max_size_buffers);
+      break;
+    case PROP_BRANCH_MAX_SIZE_BYTES:
+      g_value_set_uint (value, tee->branch_max_size_bytes);
+      break;
+    case PROP_BRANCH_MAX_SIZE_TIME:
+      g_value_set_uint64 (value, tee->branch_max_size_time);
+      break;
+    case PROP_BRANCH_LEAKY:
+      g_value_set_enum (value, tee->branch_leaky);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -497,25 +981,192 @@ gst_tee_get_property (GObject * object, guint prop_id, GValue * value,
   GST_OBJECT_UNLOCK (tee);
 }
 
+/* must be called with the OBJECT_LOCK, returns the src pads we push on with
+ * a ref in a newly allocated array */
+static GstPad **
+gst_tee_ref_src_pads (GstTee * tee, guint * n_pads)
+{
+  GstPad **pads;
+  GList *walk;
+
+  *n_pads = 0;
+  pads = g_new (GstPad *, GST_ELEMENT_CAST (tee)->numsrcpads);
+  for (walk = GST_ELEMENT_CAST (tee)->srcpads; walk; walk = g_list_next (walk)) {
+    GstPad *pad = GST_PAD_CAST (walk->data);
+
+    /* don't push on the pad we're pulling from */
+    if (pad == tee->pull_pad)
+      continue;
+
+    pads[(*n_pads)++] = gst_object_ref (pad);
+  }
+  return pads;
+}
+
+static void
+gst_tee_unref_src_pads (GstPad ** pads, guint n_pads)
+{
+  guint i;
+
+  for (i = 0; i < n_pads; i++)
+    gst_object_unref (pads[i]);
+  g_free (pads);
+}
+
+static gboolean
+gst_tee_queue_event (GstTee * tee, GstEvent * event)
+{
+  GstPad **pads;
+  guint i, n_pads;
+
+  GST_OBJECT_LOCK (tee);
+  pads = gst_tee_ref_src_pads (tee, &n_pads);
+  GST_OBJECT_UNLOCK (tee);
+
+  GST_LOG_OBJECT (tee, "queueing event %" GST_PTR_FORMAT, event);
+
+  for (i = 0; i < n_pads; i++)
+    gst_tee_pad_enqueue (tee, GST_TEE_PAD_CAST (pads[i]),
+        GST_MINI_OBJECT_CAST (gst_event_ref (event)));
+
+  gst_tee_unref_src_pads (pads, n_pads);
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+gst_tee_branch_flush_start (const GValue * vpad, GstTee * tee)
+{
+  GstTeePad *pad = g_value_get_object (vpad);
+
+  g_mutex_lock (&pad->qlock);
+  if (!pad->queued) {
+    g_mutex_unlock (&pad->qlock);
+    return;
+  }
+  pad->srcresult = GST_FLOW_FLUSHING;
+  g_cond_signal (&pad->item_add);
+  g_cond_signal (&pad->item_del);
+  g_mutex_unlock (&pad->qlock);
+
+  /* the flush-start downstream unblocks a pending push */
+  gst_pad_pause_task (GST_PAD_CAST (pad));
+}
+
+static void
+gst_tee_branch_flush_stop (const GValue * vpad, GstTee * tee)
+{
+  GstTeePad *pad = g_value_get_object (vpad);
+
+  g_mutex_lock (&pad->qlock);
+  if (!pad->queued) {
+    g_mutex_unlock (&pad->qlock);
+    return;
+  }
+  gst_tee_pad_flush_queue (pad);
+  pad->pushing = FALSE;
+  pad->srcresult = GST_FLOW_OK;
+  gst_pad_start_task (GST_PAD_CAST (pad), (GstTaskFunction) gst_tee_pad_loop,
+      pad, NULL);
+  g_mutex_unlock (&pad->qlock);
+}
+
+static void
+gst_tee_branch_flush (GstTee * tee, gboolean start)
+{
+  GstIterator *iter;
+
+  iter = gst_element_iterate_src_pads (GST_ELEMENT (tee));
+  gst_iterator_foreach (iter, (GstIteratorForeachFunction) (start ?
+          gst_tee_branch_flush_start : gst_tee_branch_flush_stop), tee);
+  gst_iterator_free (iter);
+}
+
 static gboolean
 gst_tee_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
-  gboolean res;
+  GstTee *tee = GST_TEE_CAST (parent);
+  gboolean res, branch_queue;
+
+  GST_OBJECT_LOCK (tee);
+  branch_queue = tee->branch_queue;
+  GST_OBJECT_UNLOCK (tee);
 
   switch (GST_EVENT_TYPE (event)) {
-    default:
+    case GST_EVENT_FLUSH_START:
       res = gst_pad_event_default (pad, parent, event);
+      if (branch_queue)
+        gst_tee_branch_flush (tee, TRUE);
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      res = gst_pad_event_default (pad, parent, event);
+      if (branch_queue)
+        gst_tee_branch_flush (tee, FALSE);
+      break;
+    default:
+      /* serialized events have to stay in order with the queued data */
+      if (branch_queue && GST_EVENT_IS_SERIALIZED (event))
+        res = gst_tee_queue_event (tee, event);
+      else
+        res = gst_pad_event_default (pad, parent, event);
       break;
   }
 
   return res;
 }
 
+/* wait until the task of @pad pushed all the data that was queued, like
+ * queue does for serialized queries. Returns FALSE when the branch is
+ * flushing or stopped with an error. */
 static gboolean
-gst_tee_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+gst_tee_branch_drain (GstTee * tee, GstTeePad * pad)
 {
   gboolean res;
 
+  g_mutex_lock (&pad->qlock);
+  while (pad->queued && (!g_queue_is_empty (&pad->queue) || pad->pushing)
+      && (pad->srcresult == GST_FLOW_OK
+          || pad->srcresult == GST_FLOW_NOT_LINKED))
+    g_cond_wait (&pad->item_del, &pad->qlock);
+  res = !pad->queued || pad->srcresult == GST_FLOW_OK
+      || pad->srcresult == GST_FLOW_NOT_LINKED;
+  g_mutex_unlock (&pad->qlock);
+
+  return res;
+}
+
+static gboolean
+gst_tee_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstTee *tee = GST_TEE_CAST (parent);
+  gboolean res, branch_queue;
+
+  GST_OBJECT_LOCK (tee);
+  branch_queue = tee->branch_queue;
+  GST_OBJECT_UNLOCK (tee);
+
+  /* serialized queries must not overtake the queued caps and data */
+  if (branch_queue && GST_QUERY_IS_SERIALIZED (query)) {
+    GstPad **pads;
+    guint i, n_pads;
+
+    GST_OBJECT_LOCK (tee);
+    pads = gst_tee_ref_src_pads (tee, &n_pads);
+    GST_OBJECT_UNLOCK (tee);
+
+    res = TRUE;
+    for (i = 0; i < n_pads && res; i++)
+      res = gst_tee_branch_drain (tee, GST_TEE_PAD_CAST (pads[i]));
+    gst_tee_unref_src_pads (pads, n_pads);
+
+    if (!res) {
+      GST_DEBUG_OBJECT (tee, "not forwarding query %" GST_PTR_FORMAT
+          ", a branch is flushing", query);
+      return FALSE;
+    }
+  }
+
   switch (GST_QUERY_TYPE (query)) {
     default:
       res = gst_pad_query_default (pad, parent, query);
@@ -570,6 +1221,187 @@ clear_pads (GstPad * pad, GstTee * tee)
   GST_TEE_PAD_CAST (pad)->result = GST_FLOW_NOT_LINKED;
 }
 
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} GstTeeBatch;
+
+typedef struct
+{
+  GstTeeBatch *batch;
+  GstPad *pad;
+  GstBufferList *list;
+  GstFlowReturn ret;
+} GstTeePushJob;
+
+static void
+gst_tee_push_list_job (GstTeePushJob * job)
+{
+  GstTeeBatch *batch = job->batch;
+
+  job->ret = gst_pad_push_list (job->pad, gst_buffer_list_ref (job->list));
+
+  g_mutex_lock (&batch->lock);
+  if (--batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* push @list to all src pads concurrently. The first pad is pushed on from
+ * the streaming thread, the others from the task pool. All pads share the
+ * same list, downstream elements that need to modify it will make a
+ * (shallow) copy of the list and only copy the buffers they write to.
+ *
+ * Must be called with the OBJECT_LOCK, which is released. Takes ownership
+ * of @list. */
+static GstFlowReturn
+gst_tee_push_list_parallel (GstTee * tee, GstBufferList * list)
+{
+  GstTeeBatch batch;
+  GstTeePushJob *jobs;
+  GList *pads;
+  guint i, n_jobs = 0;
+  GstFlowReturn ret, cret = GST_FLOW_NOT_LINKED;
+
+  if (G_UNLIKELY (!tee->task_pool_prepared)) {
+    GError *err = NULL;
+
+    gst_task_pool_prepare (tee->task_pool, &err);
+    if (G_UNLIKELY (err)) {
+      GST_WARNING_OBJECT (tee, "could not prepare task pool: %s",
+          err->message);
+      g_error_free (err);
+    } else {
+      tee->task_pool_prepared = TRUE;
+    }
+  }
+
+  jobs = g_new (GstTeePushJob, GST_ELEMENT_CAST (tee)->numsrcpads);
+  for (pads = GST_ELEMENT_CAST (tee)->srcpads; pads; pads = g_list_next (pads)) {
+    GstPad *pad = GST_PAD_CAST (pads->data);
+
+    /* don't push on the pad we're pulling from */
+    if (pad == tee->pull_pad)
+      continue;
+
+    jobs[n_jobs].batch = &batch;
+    jobs[n_jobs].pad = gst_object_ref (pad);
+    jobs[n_jobs].list = list;
+    jobs[n_jobs].ret = GST_FLOW_NOT_LINKED;
+    n_jobs++;
+  }
+  GST_OBJECT_UNLOCK (tee);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = n_jobs > 0 ? n_jobs - 1 : 0;
+
+  GST_LOG_OBJECT (tee, "pushing list %p to %u pads in parallel", list, n_jobs);
+
+  for (i = 1; i < n_jobs; i++) {
+    GError *err = NULL;
+
+    if (tee->task_pool_prepared)
+      gst_task_pool_push (tee->task_pool,
+          (GstTaskPoolFunction) gst_tee_push_list_job, &jobs[i], &err);
+
+    if (!tee->task_pool_prepared || err) {
+      /* no thread, push from this thread then */
+      if (err) {
+        GST_WARNING_OBJECT (tee, "could not push job: %s", err->message);
+        g_error_free (err);
+      }
+      gst_tee_push_list_job (&jobs[i]);
+    }
+  }
+  if (n_jobs > 0)
+    jobs[0].ret = gst_pad_push_list (jobs[0].pad, gst_buffer_list_ref (list));
+
+  /* wait for the other pads */
+  g_mutex_lock (&batch.lock);
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+  g_mutex_unlock (&batch.lock);
+
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  /* combine the results in the same way as the serial push */
+  GST_OBJECT_LOCK (tee);
+  for (i = 0; i < n_jobs; i++) {
+    ret = jobs[i].ret;
+
+    /* the pad was released while we were pushing, ignore its result */
+    if (GST_TEE_PAD_CAST (jobs[i].pad)->removed)
+      continue;
+
+    if (G_UNLIKELY (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED)) {
+      cret = ret;
+      break;
+    }
+    if (G_LIKELY (ret != GST_FLOW_NOT_LINKED))
+      cret = ret;
+  }
+  GST_OBJECT_UNLOCK (tee);
+
+  for (i = 0; i < n_jobs; i++)
+    gst_object_unref (jobs[i].pad);
+  g_free (jobs);
+
+  gst_buffer_list_unref (list);
+
+  GST_LOG_OBJECT (tee, "parallel push of list %p yielded %s", list,
+      gst_flow_get_name (cret));
+
+  return cret;
+}
+
+/* queue @data on all src pads, the result is combined from the results of
+ * the previous pushes on each pad.
+ *
+ * Must be called with the OBJECT_LOCK, which is released. Takes ownership
+ * of @data. */
+static GstFlowReturn
+gst_tee_handle_data_queued (GstTee * tee, gpointer data)
+{
+  GstPad **pads;
+  guint i, n_pads;
+  GstFlowReturn ret, cret;
+
+  /* we don't push on the pad we're pulling from, that counts as OK */
+  cret = tee->pull_pad ? GST_FLOW_OK : GST_FLOW_NOT_LINKED;
+  pads = gst_tee_ref_src_pads (tee, &n_pads);
+  GST_OBJECT_UNLOCK (tee);
+
+  for (i = 0; i < n_pads; i++) {
+    GstTeePad *pad = GST_TEE_PAD_CAST (pads[i]);
+
+    ret = gst_tee_pad_enqueue (tee, pad,
+        gst_mini_object_ref (GST_MINI_OBJECT_CAST (data)));
+
+    /* the pad was released while we were queueing, ignore its result */
+    if (pad->removed)
+      continue;
+
+    if (G_UNLIKELY (ret != GST_FLOW_OK && ret != GST_FLOW_NOT_LINKED)) {
+      cret = ret;
+      break;
+    }
+    if (G_LIKELY (ret != GST_FLOW_NOT_LINKED))
+      cret = ret;
+  }
+
+  gst_tee_unref_src_pads (pads, n_pads);
+  gst_mini_object_unref (GST_MINI_OBJECT_CAST (data));
+
+  GST_LOG_OBJECT (tee, "queueing %p yielded %s", data,
+      gst_flow_get_name (cret));
+
+  return cret;
+}
+
 static GstFlowReturn
 gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
 {
@@ -587,6 +1419,9 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
   if (G_UNLIKELY (!pads))
     goto no_pads;
 
+  if (tee->branch_queue)
+    return gst_tee_handle_data_queued (tee, data);
+
   /* special case for just one pad that avoids reffing the buffer */
   if (!pads->next) {
     GstPad *pad = GST_PAD_CAST (pads->data);
@@ -603,6 +1438,9 @@ gst_tee_handle_data (GstTee * tee, gpointer data, gboolean is_list)
     return ret;
   }
 
+  if (is_list && tee->parallel_push)
+    return gst_tee_push_list_parallel (tee, GST_BUFFER_LIST_CAST (data));
+
   /* mark all pads as 'not pushed on yet' */
   g_list_foreach (pads, (GFunc) clear_pads, tee);
 
@@ -800,6 +1638,45 @@ gst_tee_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
       GST_OBJECT_UNLOCK (tee);
       break;
     }
+    case GST_PAD_MODE_PUSH:
+    {
+      GstTeePad *tpad = GST_TEE_PAD_CAST (pad);
+
+      res = TRUE;
+      if (active) {
+        gboolean queued;
+
+        GST_OBJECT_LOCK (tee);
+        queued = tee->branch_queue;
+        GST_OBJECT_UNLOCK (tee);
+
+        g_mutex_lock (&tpad->qlock);
+        tpad->queued = queued;
+        tpad->srcresult = GST_FLOW_OK;
+        tpad->eos = FALSE;
+        if (queued)
+          res = gst_pad_start_task (pad, (GstTaskFunction) gst_tee_pad_loop,
+              pad, NULL);
+        g_mutex_unlock (&tpad->qlock);
+      } else {
+        /* step 1, unblock the loop function and the streaming thread */
+        g_mutex_lock (&tpad->qlock);
+        tpad->srcresult = GST_FLOW_FLUSHING;
+        g_cond_signal (&tpad->item_add);
+        g_cond_signal (&tpad->item_del);
+        g_mutex_unlock (&tpad->qlock);
+
+        /* step 2, make sure streaming finishes */
+        if (tpad->queued)
+          res = gst_pad_stop_task (pad);
+
+        g_mutex_lock (&tpad->qlock);
+        gst_tee_pad_flush_queue (tpad);
+        tpad->queued = FALSE;
+        g_mutex_unlock (&tpad->qlock);
+      }
+      break;
+    }
     default:
       res = TRUE;
       break;
@@ -57,6 +57,21 @@ typedef enum {
   GST_TEE_PULL_MODE_SINGLE,
 } GstTeePullMode;
 
+/**
+ * GstTeeBranchLeaky:
+ * @GST_TEE_BRANCH_NO_LEAK: Not Leaky
+ * @GST_TEE_BRANCH_LEAK_UPSTREAM: Leaky on upstream (new buffers)
+ * @GST_TEE_BRANCH_LEAK_DOWNSTREAM: Leaky on downstream (old buffers)
+ *
+ * What a branch queue does with new data when it is full, see
+ * #GstTee:branch-queue.
+ */
+typedef enum {
+  GST_TEE_BRANCH_NO_LEAK,
+  GST_TEE_BRANCH_LEAK_UPSTREAM,
+  GST_TEE_BRANCH_LEAK_DOWNSTREAM
+} GstTeeBranchLeaky;
+
 /**
  * GstTee:
  *
@@ -80,6 +95,18 @@ struct _GstTee {
   GstPadMode      sink_mode;
   GstTeePullMode  pull_mode;
   GstPad         *pull_pad;
+
+  /* pushing buffer lists to the src pads from a thread pool */
+  gboolean        parallel_push;
+  GstTaskPool    *task_pool;
+  gboolean        task_pool_prepared;
+
+  /* queueing data on each src pad and pushing it from a task per pad */
+  gboolean        branch_queue;
+  guint           branch_max_size_buffers;
+  guint           branch_max_size_bytes;
+  guint64         branch_max_size_time;
+  GstTeeBranchLeaky branch_leaky;
 };
 
 struct _GstTeeClass {
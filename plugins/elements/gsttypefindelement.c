@@ -100,6 +100,9 @@ GST_STATIC_PAD_TEMPLATE ("src",
 #define TYPE_FIND_MIN_SIZE   (2*1024)
 #define TYPE_FIND_MAX_SIZE (128*1024)
 
+#define DEFAULT_MAX_BYTES 0
+#define DEFAULT_N_THREADS 1
+
 /* TypeFind signals and args */
 enum
 {
@@ -112,6 +115,8 @@ enum
   PROP_CAPS,
   PROP_MINIMUM,
   PROP_FORCE_CAPS,
+  PROP_MAX_BYTES,
+  PROP_N_THREADS,
   PROP_LAST
 };
 enum
@@ -213,6 +218,37 @@ gst_type_find_element_class_init (GstTypeFindElementClass * typefind_class)
       g_param_spec_boxed ("force-caps", _("force caps"),
           _("force caps without doing a typefind"), GST_TYPE_CAPS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTypeFindElement:max-bytes:
+   *
+   * The maximum number of bytes that are read for typefinding, or 0 to use
+   * the default amount. In pull mode this limits how much data the
+   * typefinders can pull from upstream, in push mode typefinding is done
+   * with the data that was received once this many bytes are available.
+   * Lower values make typefinding faster on slow sources, at the cost of
+   * possibly not finding the type of some streams.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_BYTES,
+      g_param_spec_uint64 ("max-bytes", "Maximum bytes",
+          "Maximum number of bytes to read for typefinding (0 = default)",
+          0, G_MAXUINT64, DEFAULT_MAX_BYTES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstTypeFindElement:n-threads:
+   *
+   * The number of threads used to call the typefinders in push mode, see
+   * gst_type_find_helper_for_data_parallel(). Typefinding in pull mode
+   * always happens in the streaming thread.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Number of threads",
+          "Number of threads to use for typefinding in push mode",
+          1, G_MAXUINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   /**
    * GstTypeFindElement::have-type:
    * @typefind: the typefind instance
@@ -282,6 +318,8 @@ gst_type_find_element_init (GstTypeFindElement * typefind)
   typefind->mode = MODE_TYPEFIND;
   typefind->caps = NULL;
   typefind->min_probability = 1;
+  typefind->max_bytes = DEFAULT_MAX_BYTES;
+  typefind->n_threads = DEFAULT_N_THREADS;
 
   typefind->adapter = gst_adapter_new ();
 }
@@ -323,6 +361,16 @@ gst_type_find_element_set_property (GObject * object, guint prop_id,
       typefind->force_caps = g_value_dup_boxed (value);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_MAX_BYTES:
+      GST_OBJECT_LOCK (typefind);
+      typefind->max_bytes = g_value_get_uint64 (value);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (typefind);
+      typefind->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -351,6 +399,16 @@ gst_type_find_element_get_property (GObject * object, guint prop_id,
       g_value_set_boxed (value, typefind->force_caps);
       GST_OBJECT_UNLOCK (typefind);
       break;
+    case PROP_MAX_BYTES:
+      GST_OBJECT_LOCK (typefind);
+      g_value_set_uint64 (value, typefind->max_bytes);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (typefind);
+      g_value_set_uint (value, typefind->n_threads);
+      GST_OBJECT_UNLOCK (typefind);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -853,16 +911,20 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
 {
   GstTypeFindProbability probability;
   GstCaps *caps;
-  gsize avail;
+  gsize avail, max_size;
   const guint8 *data;
   gboolean have_min, have_max;
 
   GST_OBJECT_LOCK (typefind);
   avail = gst_adapter_available (typefind->adapter);
 
+  max_size = TYPE_FIND_MAX_SIZE;
+  if (typefind->max_bytes > 0 && typefind->max_bytes < max_size)
+    max_size = typefind->max_bytes;
+
   if (check_avail) {
-    have_min = avail >= TYPE_FIND_MIN_SIZE;
-    have_max = avail >= TYPE_FIND_MAX_SIZE;
+    have_min = avail >= MIN (TYPE_FIND_MIN_SIZE, max_size);
+    have_max = avail >= max_size;
   } else {
     have_min = avail > 0;
     have_max = TRUE;
@@ -873,8 +935,8 @@ gst_type_find_element_chain_do_typefinding (GstTypeFindElement * typefind,
 
   /* map all available data */
   data = gst_adapter_map (typefind->adapter, avail);
-  caps = gst_type_find_helper_for_data (GST_OBJECT (typefind),
-      data, avail, &probability);
+  caps = gst_type_find_helper_for_data_parallel (GST_OBJECT (typefind),
+      data, avail, typefind->n_threads, &probability);
   gst_adapter_unmap (typefind->adapter);
 
   if (caps == NULL && have_max)
@@ -1000,6 +1062,7 @@ gst_type_find_element_loop (GstPad * pad)
     peer = gst_pad_get_peer (pad);
     if (peer) {
       gint64 size;
+      guint64 max_bytes;
       gchar *ext;
 
       if (!gst_pad_query_duration (peer, GST_FORMAT_BYTES, &size)) {
@@ -1021,11 +1084,15 @@ gst_type_find_element_loop (GstPad * pad)
       }
       ext = gst_type_find_get_extension (typefind, pad);
 
+      GST_OBJECT_LOCK (typefind);
+      max_bytes = typefind->max_bytes;
+      GST_OBJECT_UNLOCK (typefind);
+
       found_caps =
-          gst_type_find_helper_get_range (GST_OBJECT_CAST (peer),
+          gst_type_find_helper_get_range_full (GST_OBJECT_CAST (peer),
           GST_OBJECT_PARENT (peer),
           (GstTypeFindHelperGetRangeFunction) (GST_PAD_GETRANGEFUNC (peer)),
-          (guint64) size, ext, &probability);
+          (guint64) size, ext, max_bytes, &probability);
       g_free (ext);
 
       GST_DEBUG ("Found caps %" GST_PTR_FORMAT, found_caps);
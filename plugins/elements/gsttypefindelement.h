@@ -58,6 +58,8 @@ struct _GstTypeFindElement {
 
   GList *               cached_events;
   GstCaps *             force_caps;
+  guint64               max_bytes;
+  guint                 n_threads;
 
   /* Only used when driving the pipeline */
   gboolean need_segment;
@@ -30,6 +30,14 @@
  * is ignored. So downstream element can be set to  %GST_STATE_NULL and removed,
  * without using pad blocking.
  *
+ * While the valve is open, #GstValve:mode can make it let only part of the
+ * buffers through: every #GstValve:interval'th buffer, at most
+ * #GstValve:max-rate buffers per second of running time or only the
+ * buffers that are not delta units, like keyframes. This is useful to feed
+ * thumbnailers or analysis from a main stream without decoding all frames.
+ * Events are not affected by the mode. In the rate mode, buffers without a
+ * timestamp always go through.
+ *
  * This element was previously part of gst-plugins-farsight, and then
  * gst-plugins-bad.
  *
@@ -60,10 +68,36 @@ static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
 enum
 {
   PROP_0,
-  PROP_DROP
+  PROP_DROP,
+  PROP_MODE,
+  PROP_INTERVAL,
+  PROP_MAX_RATE
 };
 
 #define DEFAULT_DROP FALSE
+#define DEFAULT_MODE GST_VALVE_MODE_ALL
+#define DEFAULT_INTERVAL 1
+#define DEFAULT_MAX_RATE 1.0
+
+#define GST_TYPE_VALVE_MODE (gst_valve_mode_get_type ())
+static GType
+gst_valve_mode_get_type (void)
+{
+  static GType valve_mode_type = 0;
+  static const GEnumValue valve_mode[] = {
+    {GST_VALVE_MODE_ALL, "All buffers", "all"},
+    {GST_VALVE_MODE_INTERVAL, "Every interval'th buffer", "interval"},
+    {GST_VALVE_MODE_RATE, "At most max-rate buffers per second", "rate"},
+    {GST_VALVE_MODE_KEY_UNITS, "Only buffers that are not delta units",
+        "key-units"},
+    {0, NULL, NULL},
+  };
+
+  if (!valve_mode_type) {
+    valve_mode_type = g_enum_register_static ("GstValveMode", valve_mode);
+  }
+  return valve_mode_type;
+}
 
 static void gst_valve_set_property (GObject * object,
     guint prop_id, const GValue * value, GParamSpec * pspec);
@@ -98,6 +132,43 @@ gst_valve_class_init (GstValveClass * klass)
       g_param_spec_boolean ("drop", "Drop buffers and events",
           "Whether to drop buffers and events or let them through",
           DEFAULT_DROP, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstValve:mode:
+   *
+   * Which buffers to let through when #GstValve:drop is %FALSE.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode",
+          "Which buffers to let through when not dropping",
+          GST_TYPE_VALVE_MODE, DEFAULT_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstValve:interval:
+   *
+   * Let one out of this many buffers through in the interval mode.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_INTERVAL,
+      g_param_spec_uint ("interval", "Interval",
+          "Let every interval'th buffer through in the interval mode",
+          1, G_MAXUINT, DEFAULT_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  /**
+   * GstValve:max-rate:
+   *
+   * The maximum number of buffers per second of running time to let through
+   * in the rate mode.
+   *
+   * Since: 1.2
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_RATE,
+      g_param_spec_double ("max-rate", "Maximum rate",
+          "Maximum number of buffers per second in the rate mode "
+          "(0 = unlimited)", 0.0, G_MAXDOUBLE, DEFAULT_MAX_RATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&srctemplate));
@@ -114,6 +185,12 @@ gst_valve_init (GstValve * valve)
 {
   valve->drop = FALSE;
   valve->discont = FALSE;
+  valve->mode = DEFAULT_MODE;
+  valve->interval = DEFAULT_INTERVAL;
+  valve->max_rate = DEFAULT_MAX_RATE;
+  gst_segment_init (&valve->segment, GST_FORMAT_UNDEFINED);
+  valve->count = 0;
+  valve->next_time = GST_CLOCK_TIME_NONE;
 
   valve->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
   gst_pad_set_event_function (valve->srcpad,
@@ -145,6 +222,21 @@ gst_valve_set_property (GObject * object,
       g_atomic_int_set (&valve->drop, g_value_get_boolean (value));
       gst_pad_push_event (valve->sinkpad, gst_event_new_reconfigure ());
       break;
+    case PROP_MODE:
+      GST_OBJECT_LOCK (valve);
+      valve->mode = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (valve);
+      break;
+    case PROP_INTERVAL:
+      GST_OBJECT_LOCK (valve);
+      valve->interval = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (valve);
+      break;
+    case PROP_MAX_RATE:
+      GST_OBJECT_LOCK (valve);
+      valve->max_rate = g_value_get_double (value);
+      GST_OBJECT_UNLOCK (valve);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -161,6 +253,21 @@ gst_valve_get_property (GObject * object,
     case PROP_DROP:
       g_value_set_boolean (value, g_atomic_int_get (&valve->drop));
       break;
+    case PROP_MODE:
+      GST_OBJECT_LOCK (valve);
+      g_value_set_enum (value, valve->mode);
+      GST_OBJECT_UNLOCK (valve);
+      break;
+    case PROP_INTERVAL:
+      GST_OBJECT_LOCK (valve);
+      g_value_set_uint (value, valve->interval);
+      GST_OBJECT_UNLOCK (valve);
+      break;
+    case PROP_MAX_RATE:
+      GST_OBJECT_LOCK (valve);
+      g_value_set_double (value, valve->max_rate);
+      GST_OBJECT_UNLOCK (valve);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -186,6 +293,54 @@ gst_valve_repush_sticky (GstValve * valve)
   gst_pad_sticky_events_foreach (valve->sinkpad, forward_sticky_events, valve);
 }
 
+/* with the stream lock, decides if @buffer goes through in the current mode */
+static gboolean
+gst_valve_sample (GstValve * valve, GstBuffer * buffer)
+{
+  GstValveMode mode;
+  guint interval;
+  gdouble max_rate;
+  GstClockTime ts;
+  gboolean pass = TRUE;
+
+  GST_OBJECT_LOCK (valve);
+  mode = valve->mode;
+  interval = valve->interval;
+  max_rate = valve->max_rate;
+  GST_OBJECT_UNLOCK (valve);
+
+  switch (mode) {
+    case GST_VALVE_MODE_INTERVAL:
+      /* the first buffer goes through */
+      pass = valve->count == 0;
+      valve->count = (valve->count + 1) % interval;
+      break;
+    case GST_VALVE_MODE_RATE:
+      if (max_rate <= 0.0)
+        break;
+
+      ts = GST_BUFFER_DTS (buffer);
+      if (!GST_CLOCK_TIME_IS_VALID (ts))
+        ts = GST_BUFFER_PTS (buffer);
+      ts = gst_segment_to_running_time (&valve->segment, GST_FORMAT_TIME, ts);
+      if (!GST_CLOCK_TIME_IS_VALID (ts))
+        break;
+
+      if (GST_CLOCK_TIME_IS_VALID (valve->next_time) && ts < valve->next_time)
+        pass = FALSE;
+      else
+        valve->next_time = ts + (GstClockTime) (GST_SECOND / max_rate);
+      break;
+    case GST_VALVE_MODE_KEY_UNITS:
+      pass = !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+      break;
+    default:
+      break;
+  }
+
+  return pass;
+}
+
 static GstFlowReturn
 gst_valve_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 {
@@ -195,6 +350,10 @@ gst_valve_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   if (g_atomic_int_get (&valve->drop)) {
     gst_buffer_unref (buffer);
     valve->discont = TRUE;
+  } else if (!gst_valve_sample (valve, buffer)) {
+    GST_LOG_OBJECT (valve, "not sampled, dropping %" GST_PTR_FORMAT, buffer);
+    gst_buffer_unref (buffer);
+    valve->discont = TRUE;
   } else {
     if (valve->discont) {
       buffer = gst_buffer_make_writable (buffer);
@@ -227,6 +386,22 @@ gst_valve_event (GstPad * pad, GstObject * parent, GstEvent * event)
 
   valve = GST_VALVE (parent);
 
+  if (pad == valve->sinkpad) {
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_SEGMENT:
+        gst_event_copy_segment (event, &valve->segment);
+        valve->next_time = GST_CLOCK_TIME_NONE;
+        break;
+      case GST_EVENT_FLUSH_STOP:
+        gst_segment_init (&valve->segment, GST_FORMAT_UNDEFINED);
+        valve->count = 0;
+        valve->next_time = GST_CLOCK_TIME_NONE;
+        break;
+      default:
+        break;
+    }
+  }
+
   if (g_atomic_int_get (&valve->drop)) {
     valve->need_repush_sticky |= GST_EVENT_IS_STICKY (event);
     gst_event_unref (event);
@@ -41,6 +41,24 @@ G_BEGIN_DECLS
 #define GST_IS_VALVE_CLASS(obj) \
   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_VALVE))
 
+/**
+ * GstValveMode:
+ * @GST_VALVE_MODE_ALL: let all buffers through
+ * @GST_VALVE_MODE_INTERVAL: let every #GstValve:interval'th buffer through
+ * @GST_VALVE_MODE_RATE: let at most #GstValve:max-rate buffers per second
+ *     through
+ * @GST_VALVE_MODE_KEY_UNITS: only let buffers through that don't have the
+ *     %GST_BUFFER_FLAG_DELTA_UNIT flag
+ *
+ * Which buffers an open #GstValve lets through.
+ */
+typedef enum {
+  GST_VALVE_MODE_ALL            = 0,
+  GST_VALVE_MODE_INTERVAL       = 1,
+  GST_VALVE_MODE_RATE           = 2,
+  GST_VALVE_MODE_KEY_UNITS      = 3
+} GstValveMode;
+
 typedef struct _GstValve GstValve;
 typedef struct _GstValveClass GstValveClass;
 
@@ -57,9 +75,17 @@ struct _GstValve
   /* atomic boolean */
   volatile gint drop;
 
+  /* Protected by the object lock */
+  GstValveMode mode;
+  guint interval;
+  gdouble max_rate;
+
   /* Protected by the stream lock */
   gboolean discont;
   gboolean need_repush_sticky;
+  GstSegment segment;
+  guint count;
+  GstClockTime next_time;
 
   GstPad *srcpad;
   GstPad *sinkpad;
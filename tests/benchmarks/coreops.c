@@ -0,0 +1,232 @@
+/* GStreamer
+ *
+ * coreops.c: benchmark bus, structure and caps operations
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gstbench.h"
+
+#define NUM_MESSAGES 100000
+#define NUM_STRUCTURES 100000
+#define NUM_CAPS 20000
+
+#define VIDEO_CAPS "video/x-raw, format = (string) { I420, YV12, YUY2, " \
+    "UYVY, AYUV, RGBx, BGRx, xRGB, xBGR, RGBA, BGRA, ARGB, ABGR }, " \
+    "width = (int) [ 1, MAX ], height = (int) [ 1, MAX ], " \
+    "framerate = (fraction) [ 0, MAX ]"
+
+#define VIDEO_CAPS_FIXED "video/x-raw, format = (string) RGBA, " \
+    "width = (int) 320, height = (int) 240, framerate = (fraction) 25/1"
+
+/* post from the benchmark thread and pop from another one */
+static gpointer
+bus_pop_thread (GstBus * bus)
+{
+  GstMessage *msg;
+  gint count = 0;
+
+  while (count < NUM_MESSAGES) {
+    msg = gst_bus_timed_pop (bus, GST_CLOCK_TIME_NONE);
+    gst_message_unref (msg);
+    count++;
+  }
+
+  return NULL;
+}
+
+static guint64
+bench_bus_post (GstBench * bench, gpointer user_data)
+{
+  GstBus *bus;
+  GThread *thread;
+  gint i;
+
+  bus = gst_bus_new ();
+
+  gst_bench_timer_start (bench);
+  thread = g_thread_new ("bench-bus", (GThreadFunc) bus_pop_thread, bus);
+  for (i = 0; i < NUM_MESSAGES; i++)
+    gst_bus_post (bus, gst_message_new_element (NULL,
+            gst_structure_new_empty ("bench")));
+  g_thread_join (thread);
+  gst_bench_timer_stop (bench);
+
+  gst_object_unref (bus);
+
+  return NUM_MESSAGES;
+}
+
+static guint64
+bench_structure_set_get (GstBench * bench, gpointer user_data)
+{
+  GstStructure *s;
+  gint i, width, num, den;
+  const gchar *format;
+
+  s = gst_structure_new_empty ("video/x-raw");
+  for (i = 0; i < NUM_STRUCTURES; i++) {
+    gst_structure_set (s, "format", G_TYPE_STRING, "I420",
+        "width", G_TYPE_INT, i, "height", G_TYPE_INT, 240,
+        "framerate", GST_TYPE_FRACTION, 25, 1, NULL);
+    format = gst_structure_get_string (s, "format");
+    if (!format || !gst_structure_get_int (s, "width", &width)
+        || !gst_structure_get_fraction (s, "framerate", &num, &den))
+      break;
+  }
+  gst_structure_free (s);
+
+  return i == NUM_STRUCTURES ? NUM_STRUCTURES : 0;
+}
+
+static guint64
+bench_structure_copy (GstBench * bench, GstStructure * s)
+{
+  gint i;
+
+  for (i = 0; i < NUM_STRUCTURES; i++)
+    gst_structure_free (gst_structure_copy (s));
+
+  return NUM_STRUCTURES;
+}
+
+static guint64
+bench_caps_from_string (GstBench * bench, gpointer user_data)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    gst_caps_unref (gst_caps_from_string (VIDEO_CAPS));
+
+  return NUM_CAPS;
+}
+
+static guint64
+bench_caps_to_string (GstBench * bench, GstCaps * caps)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    g_free (gst_caps_to_string (caps));
+
+  return NUM_CAPS;
+}
+
+static guint64
+bench_caps_copy (GstBench * bench, GstCaps * caps)
+{
+  GstCaps **capses;
+  gint i;
+
+  capses = g_new (GstCaps *, NUM_CAPS);
+  for (i = 0; i < NUM_CAPS; i++)
+    capses[i] = gst_caps_copy (caps);
+  for (i = 0; i < NUM_CAPS; i++)
+    gst_caps_unref (capses[i]);
+  g_free (capses);
+
+  return NUM_CAPS;
+}
+
+typedef struct
+{
+  GstCaps *caps1;
+  GstCaps *caps2;
+} CapsPair;
+
+static guint64
+bench_caps_intersect (GstBench * bench, CapsPair * pair)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    gst_caps_unref (gst_caps_intersect (pair->caps1, pair->caps2));
+
+  return NUM_CAPS;
+}
+
+static guint64
+bench_caps_can_intersect (GstBench * bench, CapsPair * pair)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    if (!gst_caps_can_intersect (pair->caps1, pair->caps2))
+      return 0;
+
+  return NUM_CAPS;
+}
+
+static guint64
+bench_caps_is_subset (GstBench * bench, CapsPair * pair)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    if (!gst_caps_is_subset (pair->caps2, pair->caps1))
+      return 0;
+
+  return NUM_CAPS;
+}
+
+static guint64
+bench_caps_fixate (GstBench * bench, GstCaps * caps)
+{
+  gint i;
+
+  for (i = 0; i < NUM_CAPS; i++)
+    gst_caps_unref (gst_caps_fixate (gst_caps_ref (caps)));
+
+  return NUM_CAPS;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  GstStructure *s;
+  CapsPair pair;
+
+  bench = gst_bench_new ("coreops", NULL, &argc, &argv);
+
+  gst_bench_run (bench, "bus-post", bench_bus_post, NULL);
+
+  gst_bench_run (bench, "structure-set-get", bench_structure_set_get, NULL);
+  s = gst_structure_from_string (VIDEO_CAPS, NULL);
+  gst_bench_run (bench, "structure-copy", (GstBenchFunc) bench_structure_copy,
+      s);
+  gst_structure_free (s);
+
+  pair.caps1 = gst_caps_from_string (VIDEO_CAPS);
+  pair.caps2 = gst_caps_from_string (VIDEO_CAPS_FIXED);
+  gst_bench_run (bench, "caps-from-string", bench_caps_from_string, NULL);
+  gst_bench_run (bench, "caps-to-string", (GstBenchFunc) bench_caps_to_string,
+      pair.caps1);
+  gst_bench_run (bench, "caps-copy", (GstBenchFunc) bench_caps_copy,
+      pair.caps1);
+  gst_bench_run (bench, "caps-intersect", (GstBenchFunc) bench_caps_intersect,
+      &pair);
+  gst_bench_run (bench, "caps-can-intersect",
+      (GstBenchFunc) bench_caps_can_intersect, &pair);
+  gst_bench_run (bench, "caps-is-subset", (GstBenchFunc) bench_caps_is_subset,
+      &pair);
+  gst_bench_run (bench, "caps-fixate", (GstBenchFunc) bench_caps_fixate,
+      pair.caps1);
+  gst_caps_unref (pair.caps1);
+  gst_caps_unref (pair.caps2);
+
+  return gst_bench_finish (bench);
+}
@@ -0,0 +1,179 @@
+/* GStreamer
+ *
+ * dataflow.c: benchmark pushing buffers through pads and pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "gstbench.h"
+
+#define NUM_PUSH_BUFFERS 200000
+#define NUM_PIPELINE_BUFFERS 50000
+#define BUFFERS_PER_LIST 64
+
+typedef struct
+{
+  GstPad *srcpad;
+  GstPad *sinkpad;
+  GstBuffer *buffer;
+} PadData;
+
+static GstFlowReturn
+drop_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+drop_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static void
+pad_data_init (PadData * data, gboolean chain_list)
+{
+  GstSegment segment;
+
+  data->srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  data->sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (data->sinkpad, drop_chain);
+  if (chain_list)
+    gst_pad_set_chain_list_function (data->sinkpad, drop_chain_list);
+  gst_pad_link (data->srcpad, data->sinkpad);
+  gst_pad_set_active (data->sinkpad, TRUE);
+  gst_pad_set_active (data->srcpad, TRUE);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (data->srcpad, gst_event_new_stream_start ("bench"));
+  gst_pad_push_event (data->srcpad, gst_event_new_segment (&segment));
+
+  data->buffer = gst_buffer_new_allocate (NULL, 16, NULL);
+}
+
+static void
+pad_data_clear (PadData * data)
+{
+  gst_pad_set_active (data->srcpad, FALSE);
+  gst_pad_set_active (data->sinkpad, FALSE);
+  gst_object_unref (data->srcpad);
+  gst_object_unref (data->sinkpad);
+  gst_buffer_unref (data->buffer);
+}
+
+/* the same buffer is pushed to only measure the pads */
+static guint64
+bench_pad_push (GstBench * bench, PadData * data)
+{
+  gint i;
+
+  for (i = 0; i < NUM_PUSH_BUFFERS; i++) {
+    if (gst_pad_push (data->srcpad, gst_buffer_ref (data->buffer)) !=
+        GST_FLOW_OK)
+      return 0;
+  }
+
+  return NUM_PUSH_BUFFERS;
+}
+
+/* the time to create the lists is included, the ops are buffers so that the
+ * result can be compared with pad-push */
+static guint64
+bench_pad_push_list (GstBench * bench, PadData * data)
+{
+  gint i, j;
+
+  for (i = 0; i < NUM_PUSH_BUFFERS / BUFFERS_PER_LIST; i++) {
+    GstBufferList *list = gst_buffer_list_new_sized (BUFFERS_PER_LIST);
+
+    for (j = 0; j < BUFFERS_PER_LIST; j++)
+      gst_buffer_list_add (list, gst_buffer_ref (data->buffer));
+
+    if (gst_pad_push_list (data->srcpad, list) != GST_FLOW_OK)
+      return 0;
+  }
+
+  return (NUM_PUSH_BUFFERS / BUFFERS_PER_LIST) * BUFFERS_PER_LIST;
+}
+
+/* runs the pipeline to EOS, only the dataflow is timed */
+static guint64
+bench_pipeline (GstBench * bench, const gchar * description)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *launch;
+  gboolean ok;
+
+  launch = g_strdup_printf (description, NUM_PIPELINE_BUFFERS);
+  pipeline = gst_parse_launch (launch, NULL);
+  g_free (launch);
+  if (pipeline == NULL)
+    return 0;
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PAUSED);
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  gst_bench_timer_start (bench);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  gst_bench_timer_stop (bench);
+
+  ok = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  return ok ? NUM_PIPELINE_BUFFERS : 0;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  PadData data;
+
+  bench = gst_bench_new ("dataflow", NULL, &argc, &argv);
+
+  pad_data_init (&data, FALSE);
+  gst_bench_run (bench, "pad-push", (GstBenchFunc) bench_pad_push, &data);
+  /* without a chain list function the list is split in the pad */
+  gst_bench_run (bench, "pad-push-list-split",
+      (GstBenchFunc) bench_pad_push_list, &data);
+  pad_data_clear (&data);
+
+  pad_data_init (&data, TRUE);
+  gst_bench_run (bench, "pad-push-list", (GstBenchFunc) bench_pad_push_list,
+      &data);
+  pad_data_clear (&data);
+
+  gst_bench_run (bench, "pipeline-push", (GstBenchFunc) bench_pipeline,
+      "fakesrc num-buffers=%d ! fakesink");
+  gst_bench_run (bench, "queue-handoff", (GstBenchFunc) bench_pipeline,
+      "fakesrc num-buffers=%d ! queue ! fakesink");
+  gst_bench_run (bench, "tee-fanout-4", (GstBenchFunc) bench_pipeline,
+      "fakesrc num-buffers=%d ! tee name=t "
+      "t. ! queue ! fakesink t. ! queue ! fakesink "
+      "t. ! queue ! fakesink t. ! queue ! fakesink");
+
+  return gst_bench_finish (bench);
+}
@@ -0,0 +1,284 @@
+/* GStreamer
+ *
+ * dynamic.c: benchmark changing pipelines while data flows
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Unlike mass-elements and complexity, which time the state changes of
+ * static pipelines, these cases change a pipeline that is PLAYING: adding
+ * and removing tee branches, with a blocking probe for the removal, sending
+ * RECONFIGURE events through a chain of elements, and running many small
+ * pipelines in the same process. The latency of every operation is
+ * recorded. */
+
+#include "gstbench.h"
+
+#define NUM_BRANCH_CYCLES 200
+#define NUM_RECONFIGURES 10000
+#define STATIC_BRANCHES 2
+#define CHAIN_ELEMENTS 8
+
+static gint n_pipelines = 1000;
+
+/* a tee that is fed as fast as possible by fakesrc */
+typedef struct
+{
+  GstElement *pipeline;
+  GstElement *tee;
+
+  GMutex lock;
+  GCond cond;
+  gboolean unlinked;
+} BranchData;
+
+/* @head ! @n_elements times @element ! @tail */
+static GstElement *
+make_chain (const gchar * head, gint n_elements, const gchar * element,
+    const gchar * tail)
+{
+  GString *desc;
+  GstElement *pipeline;
+  gint i;
+
+  desc = g_string_new (head);
+  for (i = 0; i < n_elements; i++)
+    g_string_append_printf (desc, " ! %s", element);
+  g_string_append_printf (desc, " ! %s", tail);
+  pipeline = gst_parse_launch (desc->str, NULL);
+  g_string_free (desc, TRUE);
+
+  return pipeline;
+}
+
+static gboolean
+start_pipeline (GstElement * pipeline)
+{
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  return gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE) ==
+      GST_STATE_CHANGE_SUCCESS;
+}
+
+static void
+stop_pipeline (GstElement * pipeline)
+{
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+/* called from the streaming thread of the tee, the branch is unlinked here so
+ * that no buffer is in it when the main thread tears it down */
+static GstPadProbeReturn
+unlink_blocked_cb (GstPad * pad, GstPadProbeInfo * info, BranchData * data)
+{
+  GstPad *peer;
+
+  if ((peer = gst_pad_get_peer (pad))) {
+    gst_pad_unlink (pad, peer);
+    gst_object_unref (peer);
+  }
+
+  g_mutex_lock (&data->lock);
+  data->unlinked = TRUE;
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
+static guint64
+bench_branch (GstBench * bench, BranchData * data)
+{
+  GstClockTime *samples;
+  guint n_samples = 0;
+  gint i;
+
+  samples = g_new (GstClockTime, 2 * NUM_BRANCH_CYCLES);
+
+  for (i = 0; i < NUM_BRANCH_CYCLES; i++) {
+    GstElement *queue, *sink;
+    GstPad *teepad, *sinkpad;
+    GstClockTime start;
+
+    /* add */
+    start = gst_util_get_timestamp ();
+    queue = gst_element_factory_make ("queue", NULL);
+    sink = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (sink, "async", FALSE, NULL);
+    gst_bin_add_many (GST_BIN (data->pipeline), queue, sink, NULL);
+    gst_element_link (queue, sink);
+    gst_element_sync_state_with_parent (sink);
+    gst_element_sync_state_with_parent (queue);
+
+    teepad = gst_element_get_request_pad (data->tee, "src_%u");
+    sinkpad = gst_element_get_static_pad (queue, "sink");
+    if (gst_pad_link (teepad, sinkpad) != GST_PAD_LINK_OK) {
+      gst_object_unref (sinkpad);
+      gst_object_unref (teepad);
+      goto failed;
+    }
+    samples[n_samples++] = gst_util_get_timestamp () - start;
+
+    /* remove */
+    start = gst_util_get_timestamp ();
+    data->unlinked = FALSE;
+    gst_pad_add_probe (teepad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM,
+        (GstPadProbeCallback) unlink_blocked_cb, data, NULL);
+    g_mutex_lock (&data->lock);
+    while (!data->unlinked)
+      g_cond_wait (&data->cond, &data->lock);
+    g_mutex_unlock (&data->lock);
+
+    gst_element_release_request_pad (data->tee, teepad);
+    gst_element_set_state (queue, GST_STATE_NULL);
+    gst_element_set_state (sink, GST_STATE_NULL);
+    gst_bin_remove_many (GST_BIN (data->pipeline), queue, sink, NULL);
+    samples[n_samples++] = gst_util_get_timestamp () - start;
+
+    gst_object_unref (sinkpad);
+    gst_object_unref (teepad);
+  }
+
+  gst_bench_add_latencies (bench, samples, n_samples);
+  g_free (samples);
+
+  return 2 * NUM_BRANCH_CYCLES;
+
+failed:
+  {
+    g_free (samples);
+    return 0;
+  }
+}
+
+/* upstream through the whole chain, identity renegotiates on the next
+ * buffer */
+static guint64
+bench_reconfigure (GstBench * bench, GstPad * pad)
+{
+  GstClockTime *samples;
+  gint i;
+
+  samples = g_new (GstClockTime, NUM_RECONFIGURES);
+
+  for (i = 0; i < NUM_RECONFIGURES; i++) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    gst_pad_push_event (pad, gst_event_new_reconfigure ());
+    samples[i] = gst_util_get_timestamp () - start;
+  }
+
+  gst_bench_add_latencies (bench, samples, NUM_RECONFIGURES);
+  g_free (samples);
+
+  return NUM_RECONFIGURES;
+}
+
+/* all the pipelines exist and run at the same time, the latency is the time
+ * to create one and to get it to PLAYING */
+static guint64
+bench_many_pipelines (GstBench * bench, gpointer user_data)
+{
+  GstElement **pipelines;
+  GstClockTime *samples;
+  gboolean ok = TRUE;
+  gint i;
+
+  pipelines = g_new0 (GstElement *, n_pipelines);
+  samples = g_new (GstClockTime, n_pipelines);
+
+  for (i = 0; i < n_pipelines; i++) {
+    GstClockTime start = gst_util_get_timestamp ();
+
+    pipelines[i] = gst_parse_launch ("fakesrc num-buffers=16 ! fakesink",
+        NULL);
+    if (pipelines[i] == NULL || !start_pipeline (pipelines[i])) {
+      ok = FALSE;
+      break;
+    }
+    samples[i] = gst_util_get_timestamp () - start;
+  }
+
+  for (i = 0; ok && i < n_pipelines; i++) {
+    GstBus *bus = gst_element_get_bus (pipelines[i]);
+    GstMessage *msg;
+
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    ok = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+    gst_message_unref (msg);
+    gst_object_unref (bus);
+  }
+
+  for (i = 0; i < n_pipelines && pipelines[i]; i++)
+    stop_pipeline (pipelines[i]);
+
+  if (ok)
+    gst_bench_add_latencies (bench, samples, n_pipelines);
+  g_free (samples);
+  g_free (pipelines);
+
+  return ok ? n_pipelines : 0;
+}
+
+static GOptionEntry options[] = {
+  {"pipelines", 'p', 0, G_OPTION_ARG_INT, &n_pipelines,
+      "Number of pipelines for many-pipelines (default 1000)", "N"},
+  {NULL}
+};
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  GstElement *pipeline, *sink;
+  GstPad *pad;
+  BranchData data;
+
+  bench = gst_bench_new ("dynamic", options, &argc, &argv);
+  if (n_pipelines < 1)
+    n_pipelines = 1;
+
+  /* the static branches keep the data flowing while one is removed */
+  data.pipeline = make_chain ("fakesrc ! tee name=t", STATIC_BRANCHES - 1,
+      "queue ! fakesink t.", "queue ! fakesink");
+  data.tee = gst_bin_get_by_name (GST_BIN (data.pipeline), "t");
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  if (start_pipeline (data.pipeline))
+    gst_bench_run (bench, "branch-add-remove", (GstBenchFunc) bench_branch,
+        &data);
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+  gst_object_unref (data.tee);
+  stop_pipeline (data.pipeline);
+
+  pipeline = make_chain ("fakesrc ! capsfilter caps=application/x-bench",
+      CHAIN_ELEMENTS, "identity", "fakesink name=sink");
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  pad = gst_element_get_static_pad (sink, "sink");
+  if (start_pipeline (pipeline))
+    gst_bench_run (bench, "reconfigure-storm",
+        (GstBenchFunc) bench_reconfigure, pad);
+  gst_object_unref (pad);
+  gst_object_unref (sink);
+  stop_pipeline (pipeline);
+
+  gst_bench_run (bench, "many-pipelines", bench_many_pipelines, NULL);
+
+  return gst_bench_finish (bench);
+}
@@ -0,0 +1,443 @@
+/* GStreamer
+ *
+ * gstbench.c: common code of the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every case is run a number of times after some warmup runs that are not
+ * counted. The time per operation of each run is collected and summarized
+ * with the minimum, median, mean, standard deviation and maximum, the median
+ * is the value to compare between builds. With --json the results are also
+ * written in a form that scripts can compare:
+ *
+ * {
+ *   "suite": "dataflow",
+ *   "version": "GStreamer 1.1.0.1",
+ *   "runs": 10,
+ *   "warmup": 2,
+ *   "results": [
+ *     { "name": "pad-push", "ops": 100000, "run_ns": 1234567, "min_ns": 12.1,
+ *       "median_ns": 12.3, "mean_ns": 12.4, "stddev_ns": 0.2,
+ *       "max_ns": 13.0 }
+ *   ]
+ * }
+ *
+ * The *_ns values are per operation, run_ns is the median time of a whole
+ * run. Cases that record latencies with gst_bench_add_latencies() also get
+ * "latency_p50_ns", "latency_p99_ns", "latency_p999_ns" and
+ * "latency_max_ns" over all the samples of the measured runs. */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gstbench.h"
+
+typedef struct
+{
+  gchar *name;
+  guint64 ops;
+  GstClockTime run_time;
+  gdouble min, median, mean, stddev, max;
+
+  /* only set when the case recorded latencies */
+  gboolean has_latency;
+  GstClockTime latency_p50, latency_p99, latency_p999, latency_max;
+} GstBenchResult;
+
+struct _GstBench
+{
+  gchar *suite;
+
+  gint runs;
+  gint warmup;
+  gchar *json;
+  gchar *filter;
+  gboolean list;
+
+  GArray *results;
+  gboolean failed;
+
+  /* latency samples of the current case, added from any thread */
+  GMutex latency_lock;
+  GArray *latencies;
+
+  /* timer of the current run */
+  gboolean timer_used;
+  GstClockTime timer_start;
+  GstClockTime timer_elapsed;
+};
+
+static void
+bench_print (GstBench * bench, const gchar * format, ...)
+    G_GNUC_PRINTF (2, 3);
+
+static void
+bench_print (GstBench * bench, const gchar * format, ...)
+{
+  va_list args;
+  gchar *str;
+
+  va_start (args, format);
+  str = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  /* keep stdout clean when the json goes there */
+  if (bench->json && !g_strcmp0 (bench->json, "-"))
+    g_printerr ("%s", str);
+  else
+    g_print ("%s", str);
+
+  g_free (str);
+}
+
+/**
+ * gst_bench_new:
+ * @suite: the name of the benchmark program
+ * @entries: (allow-none): options of the program
+ * @argc: pointer to the argc of main()
+ * @argv: pointer to the argv of main()
+ *
+ * Parses the common options and @entries and initializes GStreamer. The
+ * remaining
+ * arguments are left in @argc and @argv.
+ *
+ * Returns: a new #GstBench, exits the program on invalid options.
+ */
+GstBench *
+gst_bench_new (const gchar * suite, const GOptionEntry * entries,
+    gint * argc, gchar *** argv)
+{
+  GstBench *bench;
+  GOptionContext *ctx;
+  GError *err = NULL;
+
+  bench = g_new0 (GstBench, 1);
+  bench->suite = g_strdup (suite);
+  bench->runs = 10;
+  bench->warmup = 2;
+  bench->results = g_array_new (FALSE, TRUE, sizeof (GstBenchResult));
+  g_mutex_init (&bench->latency_lock);
+  bench->latencies = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+
+  {
+    GOptionEntry options[] = {
+      {"runs", 'r', 0, G_OPTION_ARG_INT, &bench->runs,
+          "Number of measured runs of each case (default 10)", "N"},
+      {"warmup", 'w', 0, G_OPTION_ARG_INT, &bench->warmup,
+          "Number of runs before measuring (default 2)", "N"},
+      {"json", 'j', 0, G_OPTION_ARG_FILENAME, &bench->json,
+          "Write the results as JSON to FILE, - for stdout", "FILE"},
+      {"filter", 'f', 0, G_OPTION_ARG_STRING, &bench->filter,
+          "Only run the cases whose name contains STRING", "STRING"},
+      {"list", 'l', 0, G_OPTION_ARG_NONE, &bench->list,
+          "List the cases without running them", NULL},
+      {NULL}
+    };
+
+    ctx = g_option_context_new (NULL);
+    g_option_context_add_main_entries (ctx, options, NULL);
+    if (entries)
+      g_option_context_add_main_entries (ctx, entries, NULL);
+    g_option_context_add_group (ctx, gst_init_get_option_group ());
+    if (!g_option_context_parse (ctx, argc, argv, &err)) {
+      g_printerr ("Error initializing: %s\n", err->message);
+      exit (1);
+    }
+    g_option_context_free (ctx);
+  }
+
+  if (bench->runs < 1)
+    bench->runs = 1;
+  if (bench->warmup < 0)
+    bench->warmup = 0;
+
+  return bench;
+}
+
+void
+gst_bench_timer_start (GstBench * bench)
+{
+  bench->timer_used = TRUE;
+  bench->timer_start = gst_util_get_timestamp ();
+}
+
+void
+gst_bench_timer_stop (GstBench * bench)
+{
+  bench->timer_elapsed += gst_util_get_timestamp () - bench->timer_start;
+}
+
+/**
+ * gst_bench_add_latencies:
+ * @bench: a #GstBench
+ * @samples: latencies of single operations
+ * @n_samples: the number of @samples
+ *
+ * Adds latency samples to the current case, the percentiles over all the
+ * measured runs are added to the results. Can be called from any thread,
+ * threads should collect their samples locally and add them at the end of
+ * the run.
+ */
+void
+gst_bench_add_latencies (GstBench * bench, const GstClockTime * samples,
+    guint n_samples)
+{
+  g_mutex_lock (&bench->latency_lock);
+  g_array_append_vals (bench->latencies, samples, n_samples);
+  g_mutex_unlock (&bench->latency_lock);
+}
+
+static gint
+compare_doubles (gconstpointer a, gconstpointer b)
+{
+  gdouble da = *(const gdouble *) a, db = *(const gdouble *) b;
+
+  return da < db ? -1 : (da > db ? 1 : 0);
+}
+
+static gint
+compare_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static gboolean
+bench_run_once (GstBench * bench, GstBenchFunc func, gpointer user_data,
+    guint64 * ops, GstClockTime * time)
+{
+  GstClockTime start;
+
+  bench->timer_used = FALSE;
+  bench->timer_elapsed = 0;
+
+  start = gst_util_get_timestamp ();
+  *ops = func (bench, user_data);
+  *time = gst_util_get_timestamp () - start;
+
+  if (bench->timer_used)
+    *time = bench->timer_elapsed;
+
+  return *ops > 0;
+}
+
+/**
+ * gst_bench_run:
+ * @bench: a #GstBench
+ * @name: the name of the case
+ * @func: the function doing one run
+ * @user_data: user data for @func
+ *
+ * Runs the case @name and prints its summary. A case fails when @func
+ * returns 0 operations, gst_bench_finish() then returns an error.
+ */
+void
+gst_bench_run (GstBench * bench, const gchar * name, GstBenchFunc func,
+    gpointer user_data)
+{
+  GstBenchResult res = { NULL, };
+  GstClockTime *times;
+  gdouble *per_op, sum = 0.0, var = 0.0;
+  guint64 ops = 0;
+  gint i;
+
+  if (bench->filter && !strstr (name, bench->filter))
+    return;
+
+  if (bench->list) {
+    bench_print (bench, "%s\n", name);
+    return;
+  }
+
+  for (i = 0; i < bench->warmup; i++) {
+    GstClockTime time;
+
+    if (!bench_run_once (bench, func, user_data, &ops, &time))
+      goto failed;
+  }
+  g_array_set_size (bench->latencies, 0);
+
+  times = g_new (GstClockTime, bench->runs);
+  per_op = g_new (gdouble, bench->runs);
+  for (i = 0; i < bench->runs; i++) {
+    if (!bench_run_once (bench, func, user_data, &ops, &times[i])) {
+      g_free (times);
+      g_free (per_op);
+      goto failed;
+    }
+    per_op[i] = (gdouble) times[i] / ops;
+    sum += per_op[i];
+  }
+
+  res.mean = sum / bench->runs;
+  for (i = 0; i < bench->runs; i++)
+    var += (per_op[i] - res.mean) * (per_op[i] - res.mean);
+  res.stddev = bench->runs > 1 ? sqrt (var / (bench->runs - 1)) : 0.0;
+
+  qsort (per_op, bench->runs, sizeof (gdouble), compare_doubles);
+  qsort (times, bench->runs, sizeof (GstClockTime), compare_times);
+  res.min = per_op[0];
+  res.max = per_op[bench->runs - 1];
+  res.median = per_op[bench->runs / 2];
+  res.run_time = times[bench->runs / 2];
+  if (bench->runs % 2 == 0) {
+    res.median = (res.median + per_op[bench->runs / 2 - 1]) / 2;
+    res.run_time = (res.run_time + times[bench->runs / 2 - 1]) / 2;
+  }
+  if (bench->latencies->len > 0) {
+    GArray *l = bench->latencies;
+
+    g_array_sort (l, compare_times);
+    res.has_latency = TRUE;
+    res.latency_p50 = g_array_index (l, GstClockTime, l->len / 2);
+    res.latency_p99 = g_array_index (l, GstClockTime, (l->len * 99) / 100);
+    res.latency_p999 = g_array_index (l, GstClockTime, (l->len * 999) / 1000);
+    res.latency_max = g_array_index (l, GstClockTime, l->len - 1);
+    g_array_set_size (l, 0);
+  }
+  res.name = g_strdup (name);
+  res.ops = ops;
+  g_array_append_val (bench->results, res);
+
+  bench_print (bench, "%-24s %12.1f ns/op (min %.1f, max %.1f, stddev %.1f%%)"
+      ", %" G_GUINT64_FORMAT " ops in %" GST_TIME_FORMAT "\n", name,
+      res.median, res.min, res.max,
+      res.mean > 0.0 ? 100.0 * res.stddev / res.mean : 0.0, res.ops,
+      GST_TIME_ARGS (res.run_time));
+  if (res.has_latency)
+    bench_print (bench, "%-24s latency p50 %" G_GUINT64_FORMAT " ns, p99 %"
+        G_GUINT64_FORMAT " ns, p99.9 %" G_GUINT64_FORMAT " ns, max %"
+        G_GUINT64_FORMAT " ns\n", "", res.latency_p50, res.latency_p99,
+        res.latency_p999, res.latency_max);
+
+  g_free (times);
+  g_free (per_op);
+  return;
+
+failed:
+  {
+    bench_print (bench, "%-24s FAILED\n", name);
+    g_array_set_size (bench->latencies, 0);
+    bench->failed = TRUE;
+  }
+}
+
+static void
+bench_append_json_string (GString * str, const gchar * s)
+{
+  g_string_append_c (str, '"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      g_string_append_c (str, '\\');
+    g_string_append_c (str, *s);
+  }
+  g_string_append_c (str, '"');
+}
+
+static gboolean
+bench_write_json (GstBench * bench)
+{
+  GString *str;
+  gchar *version;
+  GError *err = NULL;
+  gboolean ret = TRUE;
+  guint i;
+
+  str = g_string_new ("{\n  \"suite\": ");
+  bench_append_json_string (str, bench->suite);
+  version = gst_version_string ();
+  g_string_append (str, ",\n  \"version\": ");
+  bench_append_json_string (str, version);
+  g_free (version);
+  g_string_append_printf (str, ",\n  \"runs\": %d,\n  \"warmup\": %d,\n"
+      "  \"results\": [", bench->runs, bench->warmup);
+
+  for (i = 0; i < bench->results->len; i++) {
+    GstBenchResult *res = &g_array_index (bench->results, GstBenchResult, i);
+    gchar min[G_ASCII_DTOSTR_BUF_SIZE], median[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar mean[G_ASCII_DTOSTR_BUF_SIZE], stddev[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar max[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* not locale dependent */
+    g_ascii_formatd (min, sizeof (min), "%.2f", res->min);
+    g_ascii_formatd (median, sizeof (median), "%.2f", res->median);
+    g_ascii_formatd (mean, sizeof (mean), "%.2f", res->mean);
+    g_ascii_formatd (stddev, sizeof (stddev), "%.2f", res->stddev);
+    g_ascii_formatd (max, sizeof (max), "%.2f", res->max);
+
+    g_string_append (str, i > 0 ? ",\n    { \"name\": " : "\n    { \"name\": ");
+    bench_append_json_string (str, res->name);
+    g_string_append_printf (str, ", \"ops\": %" G_GUINT64_FORMAT
+        ", \"run_ns\": %" G_GUINT64_FORMAT ", \"min_ns\": %s"
+        ", \"median_ns\": %s, \"mean_ns\": %s, \"stddev_ns\": %s"
+        ", \"max_ns\": %s", res->ops, res->run_time, min, median, mean,
+        stddev, max);
+    if (res->has_latency)
+      g_string_append_printf (str, ", \"latency_p50_ns\": %" G_GUINT64_FORMAT
+          ", \"latency_p99_ns\": %" G_GUINT64_FORMAT ", \"latency_p999_ns\": %"
+          G_GUINT64_FORMAT ", \"latency_max_ns\": %" G_GUINT64_FORMAT,
+          res->latency_p50, res->latency_p99, res->latency_p999,
+          res->latency_max);
+    g_string_append (str, " }");
+  }
+  g_string_append (str, "\n  ]\n}\n");
+
+  if (!g_strcmp0 (bench->json, "-")) {
+    g_print ("%s", str->str);
+  } else if (!g_file_set_contents (bench->json, str->str, str->len, &err)) {
+    g_printerr ("Could not write %s: %s\n", bench->json, err->message);
+    g_error_free (err);
+    ret = FALSE;
+  }
+  g_string_free (str, TRUE);
+
+  return ret;
+}
+
+/**
+ * gst_bench_finish:
+ * @bench: a #GstBench
+ *
+ * Writes the JSON output when requested and frees @bench.
+ *
+ * Returns: the exit code of the program, 1 when a case failed.
+ */
+gint
+gst_bench_finish (GstBench * bench)
+{
+  gint ret;
+  guint i;
+
+  if (bench->json && !bench->list && !bench_write_json (bench))
+    bench->failed = TRUE;
+
+  ret = bench->failed ? 1 : 0;
+
+  for (i = 0; i < bench->results->len; i++)
+    g_free (g_array_index (bench->results, GstBenchResult, i).name);
+  g_array_free (bench->results, TRUE);
+  g_array_free (bench->latencies, TRUE);
+  g_mutex_clear (&bench->latency_lock);
+  g_free (bench->suite);
+  g_free (bench->json);
+  g_free (bench->filter);
+  g_free (bench);
+
+  return ret;
+}
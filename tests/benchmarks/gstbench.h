@@ -0,0 +1,52 @@
+/* GStreamer
+ *
+ * gstbench.h: common code of the benchmarks
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_BENCH_H__
+#define __GST_BENCH_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstBench GstBench;
+
+/* Runs one iteration of a benchmark case and returns the number of
+ * operations it did. The whole call is timed unless the function calls
+ * gst_bench_timer_start() and gst_bench_timer_stop() around the part that
+ * should be measured. */
+typedef guint64 (*GstBenchFunc) (GstBench * bench, gpointer user_data);
+
+GstBench *      gst_bench_new           (const gchar * suite,
+                                         const GOptionEntry * entries,
+                                         gint * argc, gchar *** argv);
+void            gst_bench_run           (GstBench * bench, const gchar * name,
+                                         GstBenchFunc func, gpointer user_data);
+gint            gst_bench_finish        (GstBench * bench);
+
+void            gst_bench_timer_start   (GstBench * bench);
+void            gst_bench_timer_stop    (GstBench * bench);
+
+void            gst_bench_add_latencies (GstBench * bench,
+                                         const GstClockTime * samples,
+                                         guint n_samples);
+
+G_END_DECLS
+
+#endif /* __GST_BENCH_H__ */
@@ -22,10 +22,18 @@
 
 #include <gst/gst.h>
 
+/* Run with GST_DEBUG=GST_INIT:4 to see the time of each phase, and with
+ * GST_REGISTRY_UPDATE=background to check the plugins after gst_init(). */
 gint
 main (gint argc, gchar * argv[])
 {
+  GstClockTime start, end;
+
+  start = gst_util_get_timestamp ();
   gst_init (&argc, &argv);
+  end = gst_util_get_timestamp ();
+
+  g_print ("%" GST_TIME_FORMAT " - gst_init\n", GST_TIME_ARGS (end - start));
 
   return 0;
 }
@@ -0,0 +1,335 @@
+/* GStreamer
+ *
+ * threadscale.c: benchmark buffer pools and atomic queues with threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* For 1 to --max-threads threads, this measures the throughput and the
+ * latency of gst_buffer_pool_acquire_buffer() followed by the release of the
+ * buffer, and of GstAtomicQueue with the same number of producer and consumer
+ * threads. On Linux the threads are pinned to the cores in order. The
+ * latency of every LATENCY_INTERVAL'th operation is sampled. */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include <string.h>
+#include <unistd.h>
+
+#include "gstbench.h"
+
+#define POOL_OPS_PER_THREAD 200000
+#define QUEUE_OPS_PER_THREAD 200000
+#define LATENCY_INTERVAL 64
+
+static gint max_threads = 0;
+static gint n_cores = 1;
+
+typedef struct
+{
+  GstBench *bench;
+  gint n_threads;
+
+  /* the threads start together when go is set */
+  GMutex lock;
+  GCond cond;
+  gboolean go;
+  gint ready;
+
+  GstBufferPool *pool;
+  GstAtomicQueue *queue;
+  gint failed;
+} ScaleData;
+
+typedef struct
+{
+  ScaleData *data;
+  gint index;
+} ThreadData;
+
+/* the items of the queue carry the time they were pushed */
+typedef struct
+{
+  GstClockTime pushed;
+} QueueItem;
+
+static void
+pin_thread (gint index)
+{
+#ifdef __linux__
+  cpu_set_t set;
+
+  CPU_ZERO (&set);
+  CPU_SET (index % n_cores, &set);
+  pthread_setaffinity_np (pthread_self (), sizeof (set), &set);
+#endif
+}
+
+static void
+wait_for_start (ScaleData * data, gint index)
+{
+  pin_thread (index);
+
+  g_mutex_lock (&data->lock);
+  data->ready++;
+  g_cond_broadcast (&data->cond);
+  while (!data->go)
+    g_cond_wait (&data->cond, &data->lock);
+  g_mutex_unlock (&data->lock);
+}
+
+static gpointer
+pool_thread (ThreadData * td)
+{
+  ScaleData *data = td->data;
+  GstClockTime *samples;
+  guint n_samples = 0;
+  gint i;
+
+  samples = g_new (GstClockTime, POOL_OPS_PER_THREAD / LATENCY_INTERVAL + 1);
+  wait_for_start (data, td->index);
+
+  for (i = 0; i < POOL_OPS_PER_THREAD; i++) {
+    GstBuffer *buffer;
+    GstClockTime start = 0;
+
+    if (i % LATENCY_INTERVAL == 0)
+      start = gst_util_get_timestamp ();
+
+    if (gst_buffer_pool_acquire_buffer (data->pool, &buffer, NULL) !=
+        GST_FLOW_OK) {
+      g_atomic_int_set (&data->failed, 1);
+      break;
+    }
+    gst_buffer_unref (buffer);
+
+    if (i % LATENCY_INTERVAL == 0)
+      samples[n_samples++] = gst_util_get_timestamp () - start;
+  }
+
+  gst_bench_add_latencies (data->bench, samples, n_samples);
+  g_free (samples);
+
+  return NULL;
+}
+
+static gpointer
+queue_producer_thread (ThreadData * td)
+{
+  ScaleData *data = td->data;
+  QueueItem *items;
+  gint i;
+
+  /* the items stay valid until the run is done */
+  items = g_new0 (QueueItem, QUEUE_OPS_PER_THREAD);
+  wait_for_start (data, td->index);
+
+  for (i = 0; i < QUEUE_OPS_PER_THREAD; i++) {
+    if (i % LATENCY_INTERVAL == 0)
+      items[i].pushed = gst_util_get_timestamp ();
+    gst_atomic_queue_push (data->queue, &items[i]);
+  }
+
+  return items;
+}
+
+static gpointer
+queue_consumer_thread (ThreadData * td)
+{
+  ScaleData *data = td->data;
+  GstClockTime *samples;
+  guint n_samples = 0, max_samples;
+  gint i;
+
+  /* the producers don't sample for a specific consumer */
+  max_samples = QUEUE_OPS_PER_THREAD * data->n_threads / LATENCY_INTERVAL + 1;
+  samples = g_new (GstClockTime, max_samples);
+  wait_for_start (data, data->n_threads + td->index);
+
+  for (i = 0; i < QUEUE_OPS_PER_THREAD; i++) {
+    QueueItem *item;
+
+    while (!(item = gst_atomic_queue_pop (data->queue)))
+      g_thread_yield ();
+
+    if (item->pushed != 0 && n_samples < max_samples)
+      samples[n_samples++] = gst_util_get_timestamp () - item->pushed;
+  }
+
+  gst_bench_add_latencies (data->bench, samples, n_samples);
+  g_free (samples);
+
+  return NULL;
+}
+
+static void
+scale_data_init (ScaleData * data, GstBench * bench, gint n_threads)
+{
+  memset (data, 0, sizeof (ScaleData));
+  data->bench = bench;
+  data->n_threads = n_threads;
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
+}
+
+static void
+scale_data_clear (ScaleData * data)
+{
+  g_mutex_clear (&data->lock);
+  g_cond_clear (&data->cond);
+}
+
+/* starts @n_threads threads and lets them go together with the threads that
+ * were already started once @n_ready threads are waiting, the caller stops
+ * the timer after joining the threads */
+static void
+run_threads (ScaleData * data, gint n_threads, gint n_ready, GThreadFunc func,
+    ThreadData * td, GThread ** threads)
+{
+  gint i;
+
+  for (i = 0; i < n_threads; i++)
+    threads[i] = g_thread_new ("bench", func, &td[i]);
+
+  g_mutex_lock (&data->lock);
+  while (data->ready < n_ready)
+    g_cond_wait (&data->cond, &data->lock);
+  gst_bench_timer_start (data->bench);
+  data->go = TRUE;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+static guint64
+bench_pool (GstBench * bench, gpointer user_data)
+{
+  gint n_threads = GPOINTER_TO_INT (user_data);
+  GstStructure *config;
+  ScaleData data;
+  ThreadData *td;
+  GThread **threads;
+  gint i;
+
+  scale_data_init (&data, bench, n_threads);
+  data.pool = gst_buffer_pool_new ();
+  config = gst_buffer_pool_get_config (data.pool);
+  /* enough buffers that the threads don't have to wait for each other */
+  gst_buffer_pool_config_set_params (config, NULL, 1024, n_threads, 0);
+  gst_buffer_pool_set_config (data.pool, config);
+  gst_buffer_pool_set_active (data.pool, TRUE);
+
+  td = g_new (ThreadData, n_threads);
+  threads = g_new (GThread *, n_threads);
+  for (i = 0; i < n_threads; i++) {
+    td[i].data = &data;
+    td[i].index = i;
+  }
+
+  run_threads (&data, n_threads, n_threads, (GThreadFunc) pool_thread, td,
+      threads);
+  for (i = 0; i < n_threads; i++)
+    g_thread_join (threads[i]);
+  gst_bench_timer_stop (bench);
+
+  gst_buffer_pool_set_active (data.pool, FALSE);
+  gst_object_unref (data.pool);
+  g_free (threads);
+  g_free (td);
+  scale_data_clear (&data);
+
+  return data.failed ? 0 : (guint64) n_threads * POOL_OPS_PER_THREAD;
+}
+
+static guint64
+bench_queue (GstBench * bench, gpointer user_data)
+{
+  gint n_threads = GPOINTER_TO_INT (user_data);
+  ScaleData data;
+  ThreadData *td;
+  GThread **threads;
+  gint i;
+
+  scale_data_init (&data, bench, n_threads);
+  data.queue = gst_atomic_queue_new (1024);
+
+  td = g_new (ThreadData, 2 * n_threads);
+  threads = g_new (GThread *, 2 * n_threads);
+  for (i = 0; i < 2 * n_threads; i++) {
+    td[i].data = &data;
+    td[i].index = i % n_threads;
+  }
+
+  /* the first half are the producers, the second half the consumers */
+  for (i = 0; i < n_threads; i++)
+    threads[n_threads + i] = g_thread_new ("bench",
+        (GThreadFunc) queue_consumer_thread, &td[n_threads + i]);
+  run_threads (&data, n_threads, 2 * n_threads,
+      (GThreadFunc) queue_producer_thread, td, threads);
+  for (i = n_threads; i < 2 * n_threads; i++)
+    g_thread_join (threads[i]);
+  gst_bench_timer_stop (bench);
+  for (i = 0; i < n_threads; i++)
+    g_free (g_thread_join (threads[i]));
+
+  gst_atomic_queue_unref (data.queue);
+  g_free (threads);
+  g_free (td);
+  scale_data_clear (&data);
+
+  return (guint64) n_threads * QUEUE_OPS_PER_THREAD;
+}
+
+static GOptionEntry options[] = {
+  {"max-threads", 't', 0, G_OPTION_ARG_INT, &max_threads,
+      "Maximum number of threads (default: the number of cores)", "N"},
+  {NULL}
+};
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBench *bench;
+  gint n;
+
+#ifdef _SC_NPROCESSORS_ONLN
+  n_cores = MAX (1, sysconf (_SC_NPROCESSORS_ONLN));
+#endif
+
+  bench = gst_bench_new ("threadscale", options, &argc, &argv);
+  if (max_threads <= 0)
+    max_threads = n_cores;
+
+  /* powers of two and the maximum */
+  for (n = 1;; n = MIN (2 * n, max_threads)) {
+    gchar *name;
+
+    name = g_strdup_printf ("pool-acquire-release/%d", n);
+    gst_bench_run (bench, name, bench_pool, GINT_TO_POINTER (n));
+    g_free (name);
+
+    name = g_strdup_printf ("atomic-queue/%dx%d", n, n);
+    gst_bench_run (bench, name, bench_queue, GINT_TO_POINTER (n));
+    g_free (name);
+
+    if (n == max_threads)
+      break;
+  }
+
+  return gst_bench_finish (bench);
+}
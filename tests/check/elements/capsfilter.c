@@ -78,6 +78,58 @@ GST_START_TEST (test_unfixed_downstream_caps)
 
 GST_END_TEST;
 
+GST_START_TEST (test_fixed_filter_caps)
+{
+  GstElement *filter;
+  GstCaps *filter_caps, *caps, *expected;
+  GstPad *mysinkpad, *sinkpad;
+
+  filter = gst_check_setup_element ("capsfilter");
+  mysinkpad = gst_check_setup_sink_pad (filter, &sinktemplate);
+  gst_pad_set_active (mysinkpad, TRUE);
+  sinkpad = gst_element_get_static_pad (filter, "sink");
+
+  /* a subset of the downstream caps, the result is the filter */
+  filter_caps = gst_caps_from_string ("audio/x-raw, rate=(int)44100, "
+      "channels=(int)2");
+  g_object_set (filter, "caps", filter_caps, NULL);
+  caps = gst_pad_query_caps (sinkpad, NULL);
+  fail_unless (gst_caps_is_equal (caps, filter_caps));
+  gst_caps_unref (caps);
+  /* the same again from the cache */
+  caps = gst_pad_query_caps (sinkpad, NULL);
+  fail_unless (gst_caps_is_equal (caps, filter_caps));
+  gst_caps_unref (caps);
+  gst_caps_unref (filter_caps);
+
+  /* no intersection with the downstream caps */
+  filter_caps = gst_caps_from_string ("audio/x-raw, rate=(int)44100, "
+      "channels=(int)6");
+  g_object_set (filter, "caps", filter_caps, NULL);
+  caps = gst_pad_query_caps (sinkpad, NULL);
+  fail_unless (gst_caps_is_empty (caps));
+  gst_caps_unref (caps);
+  gst_caps_unref (filter_caps);
+
+  /* fixed but not a subset, the fields of downstream are added */
+  filter_caps = gst_caps_from_string ("audio/x-raw, rate=(int)44100");
+  g_object_set (filter, "caps", filter_caps, NULL);
+  caps = gst_pad_query_caps (sinkpad, NULL);
+  expected = gst_caps_from_string ("audio/x-raw, rate=(int)44100, "
+      "channels=(int)[ 1, 2 ]");
+  fail_unless (gst_caps_is_equal (caps, expected));
+  gst_caps_unref (expected);
+  gst_caps_unref (caps);
+  gst_caps_unref (filter_caps);
+
+  gst_object_unref (sinkpad);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_sink_pad (filter);
+  gst_check_teardown_element (filter);
+}
+
+GST_END_TEST;
+
 static Suite *
 capsfilter_suite (void)
 {
@@ -86,6 +138,7 @@ capsfilter_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_unfixed_downstream_caps);
+  tcase_add_test (tc_chain, test_fixed_filter_caps);
 
   return s;
 }
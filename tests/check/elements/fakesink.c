@@ -981,6 +981,62 @@ GST_START_TEST (test_notify_race)
 
 GST_END_TEST;
 
+GST_START_TEST (test_stats)
+{
+  GstElement *pipe, *src, *sink;
+  GstStructure *stats;
+  GstMessage *msg;
+  GstBus *bus;
+  guint64 buffers, bytes, latency_min, latency_max;
+  gint messages = 0;
+
+  pipe = gst_pipeline_new ("pipeline");
+  src = gst_element_factory_make ("fakesrc", NULL);
+  g_object_set (src, "num-buffers", 10, "sizetype", 2, "sizemax", 10, NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (sink, "enable-stats", TRUE, "stats-interval",
+      (guint64) 1, NULL);
+  gst_bin_add_many (GST_BIN (pipe), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  bus = gst_element_get_bus (pipe);
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+
+  while ((msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+              GST_MESSAGE_ELEMENT | GST_MESSAGE_EOS | GST_MESSAGE_ERROR))) {
+    GstMessageType type = GST_MESSAGE_TYPE (msg);
+
+    fail_if (type == GST_MESSAGE_ERROR);
+    if (type == GST_MESSAGE_ELEMENT) {
+      fail_unless (gst_message_has_name (msg, "GstFakeSinkStats"));
+      messages++;
+    }
+    gst_message_unref (msg);
+    if (type == GST_MESSAGE_EOS)
+      break;
+  }
+  /* at least the final message on EOS */
+  fail_unless (messages >= 1);
+
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "buffers", &buffers));
+  fail_unless (gst_structure_get_uint64 (stats, "bytes", &bytes));
+  fail_unless_equals_uint64 (buffers, 10);
+  fail_unless_equals_uint64 (bytes, 100);
+  fail_unless (gst_structure_get_uint64 (stats, "latency-min", &latency_min));
+  fail_unless (gst_structure_get_uint64 (stats, "latency-max", &latency_max));
+  if (GST_CLOCK_TIME_IS_VALID (latency_min))
+    fail_unless (latency_min <= latency_max);
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
+
 static Suite *
 fakesink_suite (void)
 {
@@ -996,6 +1052,7 @@ fakesink_suite (void)
   tcase_add_test (tc_chain, test_eos2);
   tcase_add_test (tc_chain, test_position);
   tcase_add_test (tc_chain, test_notify_race);
+  tcase_add_test (tc_chain, test_stats);
 
   return s;
 }
@@ -315,6 +315,47 @@ GST_START_TEST (test_reuse_push)
 
 GST_END_TEST;
 
+GST_START_TEST (test_generate_lists)
+{
+  GstElement *src;
+  GList *l;
+  gint i;
+
+  src = setup_fakesrc ();
+
+  /* 3 lists of 4 pooled buffers, in bursts of 2 at 100 buffers per second */
+  g_object_set (G_OBJECT (src), "sizetype", 2, "sizemax", 100,
+      "generate-lists", 4, "use-pool", TRUE, "rate", 100.0, "burst", 2,
+      "num-buffers", 3, NULL);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  while (!have_eos) {
+    g_usleep (1000);
+  }
+
+  fail_unless_equals_int (g_list_length (buffers), 12);
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+
+    fail_unless (gst_buffer_get_size (buf) == 100);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf),
+        (i / 2) * 2 * (GST_SECOND / 100));
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i * 100);
+  }
+  gst_check_drop_buffers ();
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  cleanup_fakesrc (src);
+}
+
+GST_END_TEST;
+
 static Suite *
 fakesrc_suite (void)
 {
@@ -328,6 +369,7 @@ fakesrc_suite (void)
   tcase_add_test (tc_chain, test_sizetype_random);
   tcase_add_test (tc_chain, test_no_preroll);
   tcase_add_test (tc_chain, test_reuse_push);
+  tcase_add_test (tc_chain, test_generate_lists);
 
   return s;
 }
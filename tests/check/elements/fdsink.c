@@ -0,0 +1,179 @@
+/* GStreamer unit test for the fdsink element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+static GstPad *mysrcpad;
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstElement *
+setup_fdsink (gint fd)
+{
+  GstElement *fdsink;
+
+  GST_DEBUG ("setup_fdsink");
+  fdsink = gst_check_setup_element ("fdsink");
+  g_object_set (fdsink, "fd", fd, NULL);
+  mysrcpad = gst_check_setup_src_pad (fdsink, &srctemplate);
+  gst_pad_set_active (mysrcpad, TRUE);
+  return fdsink;
+}
+
+static void
+start_fdsink (GstElement * fdsink)
+{
+  GstSegment segment;
+
+  fail_unless_equals_int (gst_element_set_state (fdsink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+}
+
+static void
+cleanup_fdsink (GstElement * fdsink)
+{
+  gst_element_set_state (fdsink, GST_STATE_NULL);
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_check_teardown_src_pad (fdsink);
+  gst_check_teardown_element (fdsink);
+}
+
+static GstBuffer *
+make_buffer (gsize size, guint8 fill)
+{
+  GstBuffer *buffer;
+
+  buffer = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_memset (buffer, 0, fill, size);
+
+  return buffer;
+}
+
+GST_START_TEST (test_render_list)
+{
+  GstElement *fdsink;
+  GstBufferList *list;
+  guint8 data[300];
+  gint pipe_fd[2], i;
+  gsize received = 0;
+
+  fail_if (pipe (pipe_fd) < 0);
+  fdsink = setup_fdsink (pipe_fd[1]);
+  start_fdsink (fdsink);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, make_buffer (100, i + 1));
+  fail_unless_equals_int (gst_pad_push_list (mysrcpad, list), GST_FLOW_OK);
+
+  while (received < sizeof (data)) {
+    gssize res = read (pipe_fd[0], data + received, sizeof (data) - received);
+
+    fail_unless (res > 0);
+    received += res;
+  }
+  for (i = 0; i < sizeof (data); i++)
+    fail_unless_equals_int (data[i], i / 100 + 1);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  cleanup_fdsink (fdsink);
+  close (pipe_fd[0]);
+  close (pipe_fd[1]);
+}
+
+GST_END_TEST;
+
+#define N_BUFFERS 64
+#define BUFFER_SIZE 4096
+
+GST_START_TEST (test_non_blocking_leaky)
+{
+  GstElement *fdsink;
+  guint8 data[BUFFER_SIZE];
+  gint pipe_fd[2], i;
+  guint64 dropped;
+  gsize received = 0;
+  gssize res;
+
+  fail_if (pipe (pipe_fd) < 0);
+  fdsink = setup_fdsink (pipe_fd[1]);
+  g_object_set (fdsink, "non-blocking", TRUE, "max-backlog",
+      (guint64) 2 * BUFFER_SIZE, "leaky", 1, NULL);
+  start_fdsink (fdsink);
+  fail_unless (fcntl (pipe_fd[1], F_GETFL) & O_NONBLOCK);
+
+  /* nobody reads, this must not block once the pipe is full */
+  for (i = 0; i < N_BUFFERS; i++)
+    fail_unless_equals_int (gst_pad_push (mysrcpad, make_buffer (BUFFER_SIZE,
+                i)), GST_FLOW_OK);
+
+  g_object_get (fdsink, "dropped", &dropped, NULL);
+  fail_unless (dropped > 0);
+  fail_unless (dropped < N_BUFFERS);
+
+  /* empty the pipe so that the backlog can be written at EOS */
+  fcntl (pipe_fd[0], F_SETFL, fcntl (pipe_fd[0], F_GETFL) | O_NONBLOCK);
+  while ((res = read (pipe_fd[0], data, sizeof (data))) > 0)
+    received += res;
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+  while ((res = read (pipe_fd[0], data, sizeof (data))) > 0)
+    received += res;
+
+  fail_unless_equals_uint64 (received, (N_BUFFERS - dropped) * BUFFER_SIZE);
+
+  cleanup_fdsink (fdsink);
+  /* the fd is blocking again */
+  fail_if (fcntl (pipe_fd[1], F_GETFL) & O_NONBLOCK);
+
+  close (pipe_fd[0]);
+  close (pipe_fd[1]);
+}
+
+GST_END_TEST;
+
+static Suite *
+fdsink_suite (void)
+{
+  Suite *s = suite_create ("fdsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_render_list);
+  tcase_add_test (tc_chain, test_non_blocking_leaky);
+
+  return s;
+}
+
+GST_CHECK_MAIN (fdsink);
@@ -20,6 +20,10 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -186,6 +190,79 @@ GST_START_TEST (test_seeking)
 
 GST_END_TEST;
 
+#ifndef G_OS_WIN32
+static GstPadProbeReturn
+count_fd_memory (GstPad * pad, GstPadProbeInfo * info, guint * n_fd_buffers)
+{
+  GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  if (gst_is_fd_memory (gst_buffer_peek_memory (buffer, 0)))
+    (*n_fd_buffers)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_fdsink_relay)
+{
+  GstElement *pipeline, *src, *sink;
+  GstMessage *msg;
+  GstPad *pad;
+  gint in_fd[2], out_fd[2];
+  guint8 data[3 * 4096], result[3 * 4096];
+  guint n_fd_buffers = 0;
+  gsize received = 0;
+  gint i;
+
+  /* the output has to fit in the pipe because it is only read at the end */
+  fail_if (pipe (in_fd) < 0);
+  fail_if (pipe (out_fd) < 0);
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fdsrc", NULL);
+  sink = gst_element_factory_make ("fdsink", NULL);
+  g_object_set (src, "fd", in_fd[0], NULL);
+  g_object_set (sink, "fd", out_fd[1], NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  pad = gst_element_get_static_pad (sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) count_fd_memory, &n_fd_buffers, NULL);
+  gst_object_unref (pad);
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i % 251;
+  fail_unless (write (in_fd[1], data, sizeof (data)) == sizeof (data));
+  close (in_fd[1]);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  close (out_fd[1]);
+  while (received < sizeof (result)) {
+    gssize res = read (out_fd[0], result + received, sizeof (result) - received);
+
+    fail_unless (res > 0);
+    received += res;
+  }
+  fail_unless (memcmp (data, result, sizeof (data)) == 0);
+#if defined (HAVE_SPLICE) && defined (HAVE_SENDFILE)
+  /* the data went through fd memory */
+  fail_unless (n_fd_buffers > 0);
+#endif
+
+  close (in_fd[0]);
+  close (out_fd[0]);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 fdsrc_suite (void)
 {
@@ -196,6 +273,9 @@ fdsrc_suite (void)
   tcase_add_test (tc_chain, test_num_buffers);
   tcase_add_test (tc_chain, test_nonseeking);
   tcase_add_test (tc_chain, test_seeking);
+#ifndef G_OS_WIN32
+  tcase_add_test (tc_chain, test_fdsink_relay);
+#endif
 
   return s;
 }
@@ -212,6 +212,158 @@ GST_START_TEST (test_seeking)
 
 GST_END_TEST;
 
+static gchar *
+create_temp_filename (void)
+{
+  gchar *tmp_fn;
+  gint fd;
+
+  tmp_fn = g_build_filename (g_get_tmp_dir (),
+      "gstreamer-filesink-test-XXXXXX", NULL);
+  fd = g_mkstemp (tmp_fn);
+  if (fd < 0) {
+    GST_ERROR ("can't create temp file %s: %s", tmp_fn, g_strerror (errno));
+    g_free (tmp_fn);
+    return NULL;
+  }
+  close (fd);
+  g_remove (tmp_fn);
+
+  return tmp_fn;
+}
+
+static GstBuffer *
+create_buffer_with_memories (guint8 first_byte, guint n_mem, guint mem_size)
+{
+  GstBuffer *buf = gst_buffer_new ();
+  guint8 byte = first_byte;
+  guint i, j;
+
+  for (i = 0; i < n_mem; i++) {
+    guint8 *data = g_malloc (mem_size);
+
+    for (j = 0; j < mem_size; j++)
+      data[j] = byte++;
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (0, data, mem_size, 0, mem_size, data, g_free));
+  }
+  return buf;
+}
+
+GST_START_TEST (test_render_list)
+{
+  GstElement *filesink;
+  GstBufferList *list;
+  GstSegment segment;
+  gchar *tmp_fn, *data = NULL;
+  gsize len;
+  guint i;
+
+  tmp_fn = create_temp_filename ();
+  if (tmp_fn == NULL)
+    return;
+
+  filesink = setup_filesink ();
+  g_object_set (filesink, "location", tmp_fn, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* a single buffer goes through stdio buffering */
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          create_buffer_with_memories (0, 1, 10)), GST_FLOW_OK);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 10);
+
+  /* a buffer with several memories is written without merging */
+  fail_unless_equals_int (gst_pad_push (mysrcpad,
+          create_buffer_with_memories (10, 3, 10)), GST_FLOW_OK);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 40);
+
+  /* and lists are written with one writev */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 4; i++)
+    gst_buffer_list_add (list, create_buffer_with_memories (40 + i * 20, 2,
+            10));
+  fail_unless_equals_int (gst_pad_push_list (mysrcpad, list), GST_FLOW_OK);
+  CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, 120);
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  cleanup_filesink (filesink);
+
+  /* all data must be in order */
+  fail_unless (g_file_get_contents (tmp_fn, &data, &len, NULL));
+  fail_unless_equals_int (len, 120);
+  for (i = 0; i < len; i++)
+    fail_unless_equals_int ((guint8) data[i], i);
+  g_free (data);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_direct_io)
+{
+  GstElement *filesink;
+  GstSegment segment;
+  gchar *tmp_fn, *data = NULL;
+  gsize len;
+  guint i, pos;
+
+  tmp_fn = create_temp_filename ();
+  if (tmp_fn == NULL)
+    return;
+
+  filesink = setup_filesink ();
+  /* not all filesystems support O_DIRECT, filesink falls back to regular
+   * I/O then, the written data must be the same in both cases */
+  g_object_set (filesink, "location", tmp_fn, "direct-io", TRUE,
+      "buffer-size", 4096, "preallocate-size", (guint64) 65536, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment)));
+
+  /* odd sizes that don't match any block size */
+  for (i = 0, pos = 0; i < 10; i++) {
+    guint size = 1000 + i * 333;
+
+    fail_unless_equals_int (gst_pad_push (mysrcpad,
+            create_buffer_with_memories (pos & 0xff, 1, size)), GST_FLOW_OK);
+    pos += size;
+    CHECK_QUERY_POSITION (filesink, GST_FORMAT_BYTES, pos);
+  }
+
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  fail_unless_equals_int (gst_element_set_state (filesink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+
+  cleanup_filesink (filesink);
+
+  /* preallocation must not change the file size */
+  fail_unless (g_file_get_contents (tmp_fn, &data, &len, NULL));
+  fail_unless_equals_int (len, pos);
+  for (i = 0; i < len; i++)
+    fail_unless_equals_int ((guint8) data[i], i & 0xff);
+  g_free (data);
+
+  g_remove (tmp_fn);
+  g_free (tmp_fn);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *filesink;
@@ -321,6 +473,8 @@ filesink_suite (void)
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_seeking);
+  tcase_add_test (tc_chain, test_render_list);
+  tcase_add_test (tc_chain, test_direct_io);
 
   return s;
 }
@@ -298,6 +298,207 @@ GST_START_TEST (test_pull)
 
 GST_END_TEST;
 
+GST_START_TEST (test_pull_mmap)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer1, *buffer2;
+  GstMapInfo info1, info2;
+  gint64 stop;
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "use-mmap", TRUE, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless (gst_element_query_duration (src, GST_FORMAT_BYTES, &stop));
+
+  buffer1 = NULL;
+  ret = gst_pad_get_range (pad, 0, 100, &buffer1);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_get_size (buffer1) == 100);
+
+  buffer2 = NULL;
+  ret = gst_pad_get_range (pad, 50, 50, &buffer2);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_get_size (buffer2) == 50);
+
+  /* mapped memory is read-only */
+  fail_unless (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buffer1, 0)));
+
+  fail_unless (gst_buffer_map (buffer1, &info1, GST_MAP_READ));
+  fail_unless (gst_buffer_map (buffer2, &info2, GST_MAP_READ));
+  fail_unless (memcmp ((guint8 *) info1.data + 50, info2.data, 50) == 0);
+  gst_buffer_unmap (buffer2, &info2);
+  gst_buffer_unmap (buffer1, &info1);
+  gst_buffer_unref (buffer2);
+
+  /* mapping for write replaces the memory with a writable copy */
+  fail_unless (gst_buffer_map (buffer1, &info1, GST_MAP_WRITE));
+  gst_buffer_unmap (buffer1, &info1);
+  fail_if (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buffer1, 0)));
+  gst_buffer_unref (buffer1);
+
+  /* short read at the end of the file */
+  buffer1 = NULL;
+  ret = gst_pad_get_range (pad, stop - 10, 20, &buffer1);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_get_size (buffer1) == 10);
+
+  /* buffers keep the mapping alive after the file is closed */
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+  fail_unless (gst_buffer_map (buffer1, &info1, GST_MAP_READ));
+  gst_buffer_unmap (buffer1, &info1);
+  gst_buffer_unref (buffer1);
+
+  /* cleanup */
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pull_readahead)
+{
+  GstElement *src;
+  GstPad *pad;
+  GstFlowReturn ret;
+  GstBuffer *buffer;
+  GstMapInfo info;
+  gint64 stop, offset;
+  guint8 *data;
+  gsize size;
+
+  fail_unless (g_file_get_contents (TESTFILE, (gchar **) & data, &size, NULL));
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "readahead", 4, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_READY) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to ready");
+
+  pad = gst_element_get_static_pad (src, "src");
+  fail_unless (pad != NULL);
+  fail_unless (gst_pad_activate_mode (pad, GST_PAD_MODE_PULL, TRUE));
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  fail_unless (gst_element_query_duration (src, GST_FORMAT_BYTES, &stop));
+  fail_unless_equals_int (stop, size);
+
+  /* sequential reads are served from the prefetched blocks */
+  for (offset = 0; offset < stop; offset += 100) {
+    buffer = NULL;
+    ret = gst_pad_get_range (pad, offset, 100, &buffer);
+    fail_unless (ret == GST_FLOW_OK);
+    fail_unless_equals_int (gst_buffer_get_size (buffer),
+        MIN (100, stop - offset));
+    fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+    fail_unless (memcmp (info.data, data + offset, info.size) == 0);
+    gst_buffer_unmap (buffer, &info);
+    gst_buffer_unref (buffer);
+  }
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, offset, 100, &buffer);
+  fail_unless (ret == GST_FLOW_EOS);
+
+  /* going back drops the prefetched data */
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, 10, 50, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  fail_unless_equals_int (info.size, 50);
+  fail_unless (memcmp (info.data, data + 10, 50) == 0);
+  gst_buffer_unmap (buffer, &info);
+  gst_buffer_unref (buffer);
+
+  buffer = NULL;
+  ret = gst_pad_get_range (pad, 60, 50, &buffer);
+  fail_unless (ret == GST_FLOW_OK);
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  fail_unless (memcmp (info.data, data + 60, 50) == 0);
+  gst_buffer_unmap (buffer, &info);
+  gst_buffer_unref (buffer);
+
+  /* stopping with blocks still queued */
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* cleanup */
+  gst_object_unref (pad);
+  cleanup_filesrc (src);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_adaptive_blocksize)
+{
+  GstElement *src;
+  GstMapInfo info;
+  GList *l;
+  guint8 *data;
+  gsize size, offset, max_size = 0;
+  guint blocksize;
+
+  fail_unless (g_file_get_contents (TESTFILE, (gchar **) & data, &size, NULL));
+
+  src = setup_filesrc ();
+
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "blocksize", 256,
+      "adaptive-blocksize", TRUE, "min-blocksize", 256, "max-blocksize", 4096,
+      NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  wait_eos ();
+
+  /* the blocks start at the configured size and grow up to the maximum */
+  fail_unless (buffers != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buffers->data), 256);
+  offset = 0;
+  for (l = buffers; l; l = l->next) {
+    fail_unless (gst_buffer_map (l->data, &info, GST_MAP_READ));
+    fail_unless (info.size <= 4096);
+    fail_unless (offset + info.size <= size);
+    fail_unless (memcmp (info.data, data + offset, info.size) == 0);
+    max_size = MAX (max_size, info.size);
+    offset += info.size;
+    gst_buffer_unmap (l->data, &info);
+  }
+  fail_unless_equals_int (offset, size);
+  fail_unless (max_size > 256);
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  /* blocksize reports the adapted size */
+  g_object_get (src, "blocksize", &blocksize, NULL);
+  fail_unless (blocksize >= 256 && blocksize <= 4096);
+
+  gst_check_drop_buffers ();
+  g_free (data);
+  cleanup_filesrc (src);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_coverage)
 {
   GstElement *src;
@@ -496,6 +697,81 @@ GST_START_TEST (test_uri_query)
 
 GST_END_TEST;
 
+static GList *segments = NULL;
+
+static gboolean
+segment_event_func (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+    GstSegment segment;
+
+    gst_event_copy_segment (event, &segment);
+    segments = g_list_append (segments, gst_segment_copy (&segment));
+  }
+  fail_if (GST_EVENT_TYPE (event) == GST_EVENT_FLUSH_START);
+
+  return event_func (pad, parent, event);
+}
+
+GST_START_TEST (test_loop)
+{
+  GstElement *src;
+  GstSegment *segment;
+  GList *l;
+  guint8 *data;
+  gsize size, offset;
+  gint i;
+
+  fail_unless (g_file_get_contents (TESTFILE, (gchar **) & data, &size, NULL));
+
+  src = setup_filesrc ();
+  gst_pad_set_event_function (mysinkpad, segment_event_func);
+
+  /* two and a half rounds */
+  g_object_set (G_OBJECT (src), "location", TESTFILE, "loop", TRUE,
+      "blocksize", (guint) (size / 4 + 1), "num-buffers", 10, NULL);
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  wait_eos ();
+
+  /* every round starts with a segment that continues the running time */
+  fail_unless_equals_int (g_list_length (segments), 3);
+  for (l = segments, i = 0; l; l = l->next, i++) {
+    segment = l->data;
+    fail_unless_equals_int (segment->format, GST_FORMAT_BYTES);
+    fail_unless_equals_uint64 (segment->start, 0);
+    fail_unless_equals_uint64 (segment->base, i * size);
+  }
+
+  /* the data starts over after each round, marked DISCONT */
+  fail_unless_equals_int (g_list_length (buffers), 10);
+  offset = 0;
+  for (l = buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buffer = l->data;
+    GstMapInfo info;
+
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buffer,
+            GST_BUFFER_FLAG_DISCONT), i % 4 == 0);
+    fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+    fail_unless (memcmp (info.data, data + offset, info.size) == 0);
+    offset = (offset + info.size) % size;
+    gst_buffer_unmap (buffer, &info);
+  }
+
+  fail_unless (gst_element_set_state (src,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  g_list_free_full (segments, (GDestroyNotify) gst_segment_free);
+  segments = NULL;
+  gst_check_drop_buffers ();
+  g_free (data);
+  cleanup_filesrc (src);
+}
+
+GST_END_TEST;
+
 static Suite *
 filesrc_suite (void)
 {
@@ -506,6 +782,10 @@ filesrc_suite (void)
   tcase_add_test (tc_chain, test_seeking);
   tcase_add_test (tc_chain, test_reverse);
   tcase_add_test (tc_chain, test_pull);
+  tcase_add_test (tc_chain, test_pull_mmap);
+  tcase_add_test (tc_chain, test_pull_readahead);
+  tcase_add_test (tc_chain, test_adaptive_blocksize);
+  tcase_add_test (tc_chain, test_loop);
   tcase_add_test (tc_chain, test_coverage);
   tcase_add_test (tc_chain, test_uri_interface);
   tcase_add_test (tc_chain, test_uri_query);
@@ -113,6 +113,49 @@ GST_START_TEST (test_one_buffer)
 
 GST_END_TEST;
 
+static void
+last_message_notify (GObject * object, GParamSpec * pspec, gint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_sample_interval)
+{
+  GstElement *identity;
+  GstStructure *stats;
+  guint64 num_buffers, num_bytes;
+  gint notifies = 0;
+  gint i;
+
+  identity = setup_identity ();
+  g_object_set (identity, "silent", FALSE, "sample-interval", 3, NULL);
+  g_signal_connect (identity, "notify::last-message",
+      G_CALLBACK (last_message_notify), &notifies);
+  fail_unless (gst_element_set_state (identity,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  for (i = 0; i < 7; i++)
+    fail_unless (gst_pad_push (mysrcpad,
+            gst_buffer_new_and_alloc (4)) == GST_FLOW_OK);
+
+  /* only every 3rd buffer updates the last-message */
+  fail_unless_equals_int (g_list_length (buffers), 7);
+  fail_unless_equals_int (notifies, 2);
+
+  /* but all of them are counted */
+  g_object_get (identity, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "num-buffers", &num_buffers));
+  fail_unless (gst_structure_get_uint64 (stats, "num-bytes", &num_bytes));
+  fail_unless_equals_uint64 (num_buffers, 7);
+  fail_unless_equals_uint64 (num_bytes, 28);
+  gst_structure_free (stats);
+
+  cleanup_identity (identity);
+}
+
+GST_END_TEST;
+
 static Suite *
 identity_suite (void)
 {
@@ -121,6 +164,7 @@ identity_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_one_buffer);
+  tcase_add_test (tc_chain, test_sample_interval);
 
   return s;
 }
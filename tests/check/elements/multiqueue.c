@@ -223,6 +223,25 @@ GST_START_TEST (test_request_pads)
 
 GST_END_TEST;
 
+GST_START_TEST (test_adaptive_size_property)
+{
+  GstElement *mq;
+  gboolean adaptive;
+
+  mq = gst_element_factory_make ("multiqueue", NULL);
+
+  g_object_get (mq, "adaptive-size", &adaptive, NULL);
+  fail_if (adaptive);
+
+  g_object_set (mq, "adaptive-size", TRUE, NULL);
+  g_object_get (mq, "adaptive-size", &adaptive, NULL);
+  fail_unless (adaptive);
+
+  gst_object_unref (mq);
+}
+
+GST_END_TEST;
+
 static GstPad *
 mq_sinkpad_to_srcpad (GstElement * mq, GstPad * sink)
 {
@@ -720,6 +739,268 @@ GST_START_TEST (test_sparse_stream)
 
 GST_END_TEST;
 
+static GMutex sparse_block_mutex;
+static GMutex sparse_mutex;
+static GCond sparse_cond;
+static gboolean sparse_overrun;
+static gboolean sparse_pushed;
+
+static GstFlowReturn
+sparse_block_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  /* blocks while the test holds the lock */
+  g_mutex_lock (&sparse_block_mutex);
+  g_mutex_unlock (&sparse_block_mutex);
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+sparse_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+sparse_overrun_cb (GstElement * mq, gpointer user_data)
+{
+  g_mutex_lock (&sparse_mutex);
+  sparse_overrun = TRUE;
+  g_cond_signal (&sparse_cond);
+  g_mutex_unlock (&sparse_mutex);
+}
+
+static gpointer
+sparse_push_thread (GstPad * srcpad)
+{
+  gint i;
+
+  for (i = 0; i < 50; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, 16, NULL);
+
+    GST_BUFFER_PTS (buf) = i * 10 * GST_MSECOND;
+    GST_BUFFER_DURATION (buf) = 10 * GST_MSECOND;
+    if (gst_pad_push (srcpad, buf) != GST_FLOW_OK)
+      break;
+  }
+
+  g_mutex_lock (&sparse_mutex);
+  sparse_pushed = TRUE;
+  g_cond_signal (&sparse_cond);
+  g_mutex_unlock (&sparse_mutex);
+
+  return NULL;
+}
+
+GST_START_TEST (test_sparse_gap)
+{
+  /* A stream that received a GAP event is sparse, its queue being empty must
+   * not let the blocked dense stream grow without limit. */
+  GstElement *mq;
+  GstPad *srcpads[2], *sinkpads[2], *mq_sinkpads[2];
+  GstSegment segment;
+  GThread *thread;
+  gint i;
+
+  sparse_overrun = FALSE;
+  sparse_pushed = FALSE;
+
+  mq = gst_element_factory_make ("multiqueue", NULL);
+  fail_unless (mq != NULL);
+  g_object_set (mq, "max-size-bytes", (guint) 0, "max-size-buffers", (guint) 5,
+      "max-size-time", (guint64) 0, NULL);
+  g_signal_connect (mq, "overrun", G_CALLBACK (sparse_overrun_cb), NULL);
+
+  for (i = 0; i < 2; i++) {
+    GstPad *mq_srcpad;
+
+    mq_sinkpads[i] = gst_element_get_request_pad (mq, "sink_%u");
+    fail_unless (mq_sinkpads[i] != NULL);
+    mq_srcpad = mq_sinkpad_to_srcpad (mq, mq_sinkpads[i]);
+
+    srcpads[i] = gst_pad_new ("src", GST_PAD_SRC);
+    gst_pad_set_query_function (srcpads[i], mq_dummypad_query);
+    fail_unless (gst_pad_link (srcpads[i], mq_sinkpads[i]) == GST_PAD_LINK_OK);
+    sinkpads[i] = gst_pad_new ("sink", GST_PAD_SINK);
+    /* only the first stream gets buffers, its output blocks */
+    gst_pad_set_chain_function (sinkpads[i], sparse_block_chain);
+    gst_pad_set_event_function (sinkpads[i], sparse_sink_event);
+    gst_pad_set_query_function (sinkpads[i], mq_dummypad_query);
+    fail_unless (gst_pad_link (mq_srcpad, sinkpads[i]) == GST_PAD_LINK_OK);
+    gst_pad_set_active (srcpads[i], TRUE);
+    gst_pad_set_active (sinkpads[i], TRUE);
+    gst_object_unref (mq_srcpad);
+  }
+
+  g_mutex_lock (&sparse_block_mutex);
+  gst_element_set_state (mq, GST_STATE_PLAYING);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  for (i = 0; i < 2; i++) {
+    gst_pad_push_event (srcpads[i], gst_event_new_stream_start ("test"));
+    gst_pad_push_event (srcpads[i], gst_event_new_segment (&segment));
+  }
+  fail_unless (gst_pad_push_event (srcpads[1], gst_event_new_gap (0,
+              GST_SECOND)));
+
+  thread = g_thread_new ("push", (GThreadFunc) sparse_push_thread, srcpads[0]);
+
+  /* the dense queue fills up instead of consuming all buffers */
+  g_mutex_lock (&sparse_mutex);
+  while (!sparse_overrun && !sparse_pushed)
+    g_cond_wait (&sparse_cond, &sparse_mutex);
+  fail_unless (sparse_overrun);
+  g_mutex_unlock (&sparse_mutex);
+
+  g_mutex_unlock (&sparse_block_mutex);
+  g_thread_join (thread);
+
+  gst_element_set_state (mq, GST_STATE_NULL);
+  for (i = 0; i < 2; i++) {
+    gst_pad_unlink (srcpads[i], mq_sinkpads[i]);
+    gst_element_release_request_pad (mq, mq_sinkpads[i]);
+    gst_object_unref (mq_sinkpads[i]);
+    gst_object_unref (srcpads[i]);
+    gst_object_unref (sinkpads[i]);
+  }
+  gst_object_unref (mq);
+}
+
+GST_END_TEST;
+
+static GMutex spill_mutex;
+static GCond spill_cond;
+static GList *spill_buffers;
+static gboolean spill_eos;
+
+static GstFlowReturn
+spill_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_mutex_lock (&spill_mutex);
+  spill_buffers = g_list_append (spill_buffers, buffer);
+  g_mutex_unlock (&spill_mutex);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+spill_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    g_mutex_lock (&spill_mutex);
+    spill_eos = TRUE;
+    g_cond_signal (&spill_cond);
+    g_mutex_unlock (&spill_mutex);
+  }
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+run_spill_test (guint64 ring_buffer_max_size)
+{
+  GstElement *mq;
+  GstPad *srcpad, *sinkpad, *mq_sinkpad, *mq_srcpad;
+  GstSegment segment;
+  gchar *template;
+  GList *l;
+  gint i;
+  const gint NBUFFERS = 20;
+
+  spill_buffers = NULL;
+  spill_eos = FALSE;
+
+  mq = gst_element_factory_make ("multiqueue", NULL);
+  fail_unless (mq != NULL);
+
+  template = g_build_filename (g_get_tmp_dir (), "multiqueue-XXXXXX", NULL);
+  g_object_set (mq, "temp-template", template,
+      "ring-buffer-max-size", ring_buffer_max_size,
+      "max-size-bytes", (guint) 0, "max-size-buffers", (guint) 0,
+      "max-size-time", (guint64) 0, NULL);
+  g_free (template);
+
+  mq_sinkpad = gst_element_get_request_pad (mq, "sink_%u");
+  fail_unless (mq_sinkpad != NULL);
+  mq_srcpad = mq_sinkpad_to_srcpad (mq, mq_sinkpad);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  gst_pad_set_query_function (srcpad, mq_dummypad_query);
+  fail_unless (gst_pad_link (srcpad, mq_sinkpad) == GST_PAD_LINK_OK);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, spill_sink_chain);
+  gst_pad_set_event_function (sinkpad, spill_sink_event);
+  gst_pad_set_query_function (sinkpad, mq_dummypad_query);
+  fail_unless (gst_pad_link (mq_srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  /* block the output until all buffers are queued */
+  g_mutex_lock (&spill_mutex);
+  gst_element_set_state (mq, GST_STATE_PLAYING);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < NBUFFERS; i++) {
+    GstBuffer *buf;
+
+    buf = gst_buffer_new_allocate (NULL, 16, NULL);
+    gst_buffer_memset (buf, 0, i, 16);
+    GST_BUFFER_PTS (buf) = i * GST_MSECOND;
+    fail_unless_equals_int (gst_pad_push (srcpad, buf), GST_FLOW_OK);
+  }
+  g_mutex_unlock (&spill_mutex);
+
+  gst_pad_push_event (srcpad, gst_event_new_eos ());
+
+  g_mutex_lock (&spill_mutex);
+  while (!spill_eos)
+    g_cond_wait (&spill_cond, &spill_mutex);
+  g_mutex_unlock (&spill_mutex);
+
+  /* all buffers come out with their data and metadata */
+  fail_unless_equals_int (g_list_length (spill_buffers), NBUFFERS);
+  for (l = spill_buffers, i = 0; l; l = l->next, i++) {
+    GstBuffer *buf = l->data;
+    GstMapInfo map;
+    gint j;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), i * GST_MSECOND);
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.size, 16);
+    for (j = 0; j < 16; j++)
+      fail_unless_equals_int (map.data[j], i);
+    gst_buffer_unmap (buf, &map);
+  }
+  g_list_free_full (spill_buffers, (GDestroyNotify) gst_buffer_unref);
+  spill_buffers = NULL;
+
+  gst_element_set_state (mq, GST_STATE_NULL);
+  gst_pad_unlink (srcpad, mq_sinkpad);
+  gst_element_release_request_pad (mq, mq_sinkpad);
+  gst_object_unref (mq_sinkpad);
+  gst_object_unref (mq_srcpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  gst_object_unref (mq);
+}
+
+GST_START_TEST (test_spill_to_disk)
+{
+  /* growing file */
+  run_spill_test (0);
+  /* ring buffer that can't hold all buffers, the rest stays in memory */
+  run_spill_test (100);
+}
+
+GST_END_TEST;
+
 static Suite *
 multiqueue_suite (void)
 {
@@ -737,6 +1018,9 @@ multiqueue_suite (void)
   tcase_add_test (tc_chain, test_output_order);
 
   tcase_add_test (tc_chain, test_sparse_stream);
+  tcase_add_test (tc_chain, test_sparse_gap);
+  tcase_add_test (tc_chain, test_adaptive_size_property);
+  tcase_add_test (tc_chain, test_spill_to_disk);
   return s;
 }
 
@@ -475,6 +475,111 @@ GST_START_TEST (test_leaky_downstream)
 
 GST_END_TEST;
 
+static GstBuffer *
+push_flagged_buffer (GstBufferFlags flags)
+{
+  GstBuffer *buffer = gst_buffer_new_and_alloc (4);
+
+  GST_BUFFER_FLAG_SET (buffer, flags);
+  fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+
+  return buffer;
+}
+
+/* set queue size to 4 buffers, leak whole groups of pictures
+ * push 2 groups of a key unit and a delta unit and another delta unit
+ * check that the first group was leaked */
+GST_START_TEST (test_leak_policy_gop)
+{
+  GstBuffer *buffer3, *buffer4, *buffer5;
+
+  g_object_set (G_OBJECT (queue), "max-size-buffers", 4, "leaky", 2,
+      "leak-policy", 2, NULL);
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+
+  push_flagged_buffer (0);
+  push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT);
+  buffer3 = push_flagged_buffer (0);
+  buffer4 = push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT);
+  buffer5 = push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT);
+
+  /* wait for underrun and check that the second group got through */
+  UNDERRUN_LOCK ();
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  unblock_src ();
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  fail_unless (g_list_nth_data (buffers, 0) == buffer3);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer3, GST_BUFFER_FLAG_DISCONT));
+  fail_unless (g_list_nth_data (buffers, 1) == buffer4);
+  fail_unless (g_list_nth_data (buffers, 2) == buffer5);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+/* set queue size to 4 buffers, leak droppable buffers first
+ * push 2 droppable buffers between key and delta units
+ * check that only the oldest droppable buffer was leaked */
+GST_START_TEST (test_leak_policy_droppable)
+{
+  GstBuffer *buffer1, *buffer3, *buffer4, *buffer5;
+
+  g_object_set (G_OBJECT (queue), "max-size-buffers", 4, "leaky", 2,
+      "leak-policy", 1, NULL);
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+
+  buffer1 = push_flagged_buffer (0);
+  push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT | GST_BUFFER_FLAG_DROPPABLE);
+  buffer3 = push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT);
+  buffer4 =
+      push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT |
+      GST_BUFFER_FLAG_DROPPABLE);
+  buffer5 = push_flagged_buffer (GST_BUFFER_FLAG_DELTA_UNIT);
+
+  UNDERRUN_LOCK ();
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  unblock_src ();
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  fail_unless (g_list_nth_data (buffers, 0) == buffer1);
+  fail_unless (g_list_nth_data (buffers, 1) == buffer3);
+  fail_unless (g_list_nth_data (buffers, 2) == buffer4);
+  fail_unless (g_list_nth_data (buffers, 3) == buffer5);
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer3, GST_BUFFER_FLAG_DISCONT));
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 /* set queue size to 6 buffers and 7 seconds
  * push 7 buffers with and without duration
  * check current-level-time
@@ -882,6 +987,198 @@ GST_START_TEST (test_queries_while_flushing)
 
 GST_END_TEST;
 
+/* push many buffers through a small queue and check that they come out in
+ * order, also when the queue pushes several of them in one go */
+GST_START_TEST (test_push_order)
+{
+  GList *l;
+  guint64 i;
+
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  g_object_set (G_OBJECT (queue), "max-size-buffers", 10, NULL);
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+
+  for (i = 0; i < 500; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (buffers) < 500)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  for (i = 0, l = buffers; l; i++, l = l->next)
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (l->data), i);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+static GList *list_sizes;
+
+static GstFlowReturn
+chain_list_func (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  g_mutex_lock (&check_mutex);
+  list_sizes = g_list_append (list_sizes,
+      GUINT_TO_POINTER (gst_buffer_list_length (list)));
+  g_cond_signal (&check_cond);
+  g_mutex_unlock (&check_mutex);
+
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_push_list)
+{
+  gint i;
+
+  mysinkpad = setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_chain_list_function (mysinkpad, chain_list_func);
+  list_sizes = NULL;
+
+  /* buffers that are at most 10ns apart are pushed in one list */
+  g_object_set (G_OBJECT (queue), "max-list-size", 10, "max-list-time",
+      (guint64) 10, NULL);
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  /* keep the buffers in the queue until all of them are there */
+  block_src ();
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  for (i = 0; i < 5; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buffer) = i * 5;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+  unblock_src ();
+
+  g_mutex_lock (&check_mutex);
+  while (g_list_length (list_sizes) < 2)
+    g_cond_wait (&check_cond, &check_mutex);
+  g_mutex_unlock (&check_mutex);
+
+  fail_unless_equals_int (GPOINTER_TO_UINT (list_sizes->data), 3);
+  fail_unless_equals_int (GPOINTER_TO_UINT (list_sizes->next->data), 2);
+  g_list_free (list_sizes);
+  list_sizes = NULL;
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+static gboolean
+allocation_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return gst_pad_query_default (pad, parent, query);
+
+  gst_query_add_allocation_pool (query, NULL, 1024, 2, 4);
+  gst_query_add_allocation_pool (query, NULL, 1024, 1, 0);
+  return TRUE;
+}
+
+GST_START_TEST (test_allocation_query)
+{
+  GstCaps *caps;
+  GstQuery *query;
+  guint size, min, max;
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_query_function (mysinkpad, allocation_query_func);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  g_object_set (queue, "max-size-buffers", 5, NULL);
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  caps = gst_caps_new_empty_simple ("test/data");
+  query = gst_query_new_allocation (caps, TRUE);
+  fail_unless (gst_pad_peer_query (mysrcpad, query));
+
+  /* the buffers the queue can hold are added to the pools */
+  fail_unless_equals_int (gst_query_get_n_allocation_pools (query), 2);
+  gst_query_parse_nth_allocation_pool (query, 0, NULL, &size, &min, &max);
+  fail_unless_equals_int (size, 1024);
+  fail_unless_equals_int (min, 7);
+  fail_unless_equals_int (max, 9);
+  gst_query_parse_nth_allocation_pool (query, 1, NULL, &size, &min, &max);
+  fail_unless_equals_int (min, 6);
+  fail_unless_equals_int (max, 0);
+
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_memory_usage)
+{
+  GstQuery *query;
+  GstSegment segment;
+  guint64 allocated, queued;
+
+  block_src ();
+
+  UNDERRUN_LOCK ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  UNDERRUN_WAIT ();
+  UNDERRUN_UNLOCK ();
+
+  /* the task blocks on the first event, the buffers stay queued */
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+  gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (100));
+  gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (50));
+
+  query = gst_query_new_memory_usage ();
+  fail_unless (gst_element_query (queue, query));
+  fail_unless_equals_int (gst_query_get_n_memory_usages (query), 1);
+  gst_query_parse_memory_usage (query, &allocated, &queued);
+  fail_unless_equals_uint64 (allocated, 0);
+  fail_unless_equals_uint64 (queued, 150);
+  gst_query_unref (query);
+
+  unblock_src ();
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -894,9 +1191,15 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_non_leaky_overrun);
   tcase_add_test (tc_chain, test_leaky_upstream);
   tcase_add_test (tc_chain, test_leaky_downstream);
+  tcase_add_test (tc_chain, test_leak_policy_gop);
+  tcase_add_test (tc_chain, test_leak_policy_droppable);
   tcase_add_test (tc_chain, test_time_level);
   tcase_add_test (tc_chain, test_time_level_task_not_started);
   tcase_add_test (tc_chain, test_queries_while_flushing);
+  tcase_add_test (tc_chain, test_allocation_query);
+  tcase_add_test (tc_chain, test_push_order);
+  tcase_add_test (tc_chain, test_push_list);
+  tcase_add_test (tc_chain, test_memory_usage);
 #if 0
   tcase_add_test (tc_chain, test_newsegment);
 #endif
@@ -264,6 +264,161 @@ GST_START_TEST (test_filled_read)
 
 GST_END_TEST;
 
+GST_START_TEST (test_ring_buffer_shared_read)
+{
+  GstElement *queue2;
+  GstBuffer *buffer;
+  GstPad *sinkpad, *srcpad;
+  GstMapInfo map;
+  gint i;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  g_object_set (queue2, "ring-buffer-max-size", (guint64) 8 * 1024,
+      "use-buffering", FALSE,
+      "max-size-buffers", (guint) 0, "max-size-time", (guint64) 0,
+      "max-size-bytes", (guint) 8 * 1024, NULL);
+
+  gst_pad_activate_mode (srcpad, GST_PAD_MODE_PULL, TRUE);
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  buffer = gst_buffer_new_and_alloc (4 * 1024);
+  gst_buffer_map (buffer, &map, GST_MAP_WRITE);
+  for (i = 0; i < map.size; i++)
+    map.data[i] = i / 1024;
+  gst_buffer_unmap (buffer, &map);
+  fail_unless (gst_pad_chain (sinkpad, buffer) == GST_FLOW_OK);
+
+  for (i = 0; i < 4; i++) {
+    GstMemory *mem;
+
+    buffer = NULL;
+    fail_unless (gst_pad_get_range (srcpad, i * 1024, 1024,
+            &buffer) == GST_FLOW_OK);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 1024);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buffer), i * 1024);
+
+    /* the data is shared with the ring buffer */
+    fail_unless_equals_int (gst_buffer_n_memory (buffer), 1);
+    mem = gst_buffer_peek_memory (buffer, 0);
+    fail_unless (GST_MEMORY_IS_READONLY (mem));
+
+    gst_buffer_map (buffer, &map, GST_MAP_READ);
+    fail_unless_equals_int (map.data[0], i);
+    fail_unless_equals_int (map.data[1023], i);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+
+  gst_element_set_state (queue2, GST_STATE_NULL);
+
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (queue2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_buffering_step)
+{
+  GstElement *queue2;
+  GstPad *sinkpad;
+  GstBus *bus;
+  GstMessage *msg;
+  guint n_messages = 0;
+  gint percent = -1;
+  gint i;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  bus = gst_bus_new ();
+  gst_element_set_bus (queue2, bus);
+
+  g_object_set (queue2, "use-buffering", TRUE, "use-rate-estimate", FALSE,
+      "max-size-buffers", (guint) 0, "max-size-time", (guint64) 0,
+      "max-size-bytes", (guint) 1000, "buffering-step", 20, NULL);
+
+  gst_pad_set_active (sinkpad, TRUE);
+
+  /* fill the queue by 1% each time */
+  for (i = 0; i < 99; i++)
+    fail_unless (gst_pad_chain (sinkpad,
+            gst_buffer_new_and_alloc (10)) == GST_FLOW_OK);
+
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_BUFFERING))) {
+    gst_message_parse_buffering (msg, &percent);
+    gst_message_unref (msg);
+    n_messages++;
+  }
+
+  /* start, steps of 20% and the final 100% */
+  fail_unless (n_messages <= 7, "posted %u messages", n_messages);
+  fail_unless_equals_int (percent, 100);
+
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_element_set_bus (queue2, NULL);
+  gst_object_unref (bus);
+  gst_object_unref (sinkpad);
+  gst_object_unref (queue2);
+}
+
+GST_END_TEST;
+
+static gboolean
+allocation_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) != GST_QUERY_ALLOCATION)
+    return gst_pad_query_default (pad, parent, query);
+
+  gst_query_add_allocation_pool (query, NULL, 1024, 2, 4);
+  return TRUE;
+}
+
+GST_START_TEST (test_allocation_query)
+{
+  GstElement *queue2;
+  GstPad *sinkpad, *srcpad, *peer;
+  GstCaps *caps;
+  GstQuery *query;
+  guint min, max;
+
+  queue2 = gst_element_factory_make ("queue2", NULL);
+  g_object_set (queue2, "max-size-buffers", (guint) 10, NULL);
+  sinkpad = gst_element_get_static_pad (queue2, "sink");
+  srcpad = gst_element_get_static_pad (queue2, "src");
+
+  peer = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_query_function (peer, allocation_query_func);
+  fail_unless (gst_pad_link (srcpad, peer) == GST_PAD_LINK_OK);
+  gst_pad_set_active (peer, TRUE);
+
+  gst_element_set_state (queue2, GST_STATE_PLAYING);
+
+  /* the serialized query travels through the queue */
+  caps = gst_caps_new_empty_simple ("test/data");
+  query = gst_query_new_allocation (caps, TRUE);
+  fail_unless (gst_pad_query (sinkpad, query));
+
+  fail_unless_equals_int (gst_query_get_n_allocation_pools (query), 1);
+  gst_query_parse_nth_allocation_pool (query, 0, NULL, NULL, &min, &max);
+  fail_unless_equals_int (min, 12);
+  fail_unless_equals_int (max, 14);
+
+  gst_query_unref (query);
+  gst_caps_unref (caps);
+
+  gst_element_set_state (queue2, GST_STATE_NULL);
+
+  gst_pad_set_active (peer, FALSE);
+  gst_object_unref (peer);
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (queue2);
+}
+
+GST_END_TEST;
 
 static Suite *
 queue2_suite (void)
@@ -278,6 +433,9 @@ queue2_suite (void)
   tcase_add_test (tc_chain, test_simple_shutdown_while_running);
   tcase_add_test (tc_chain, test_simple_shutdown_while_running_ringbuffer);
   tcase_add_test (tc_chain, test_filled_read);
+  tcase_add_test (tc_chain, test_ring_buffer_shared_read);
+  tcase_add_test (tc_chain, test_buffering_step);
+  tcase_add_test (tc_chain, test_allocation_query);
   return s;
 }
 
@@ -598,6 +598,184 @@ GST_START_TEST (test_output_selector_getcaps_active);
 GST_END_TEST;
 
 
+/* Buffers dropped on an inactive pad since its last keyframe are forwarded
+   when switching to it */
+GST_START_TEST (test_input_selector_keyframe_cache);
+{
+  GList *input_pads = NULL;
+  GstElement *sel;
+  GstPad *output_pad, *pad0, *pad1, *selpad;
+  GstBuffer *buf;
+  gint probe_id, i;
+
+  sel = gst_check_setup_element ("input-selector");
+  g_object_set (sel, "keyframe-cache", TRUE, NULL);
+  output_pad = gst_check_setup_sink_pad (sel, &sinktemplate);
+  gst_pad_set_active (output_pad, TRUE);
+  pad0 = setup_input_pad (sel);
+  pad1 = setup_input_pad (sel);
+  input_pads = g_list_append (input_pads, pad0);
+  input_pads = g_list_append (input_pads, pad1);
+  probe_id =
+      gst_pad_add_probe (output_pad, GST_PAD_PROBE_TYPE_DATA_BOTH,
+      (GstPadProbeCallback) probe_cb, NULL, NULL);
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  push_newsegment_events (input_pads);
+
+  selpad = gst_pad_get_peer (pad0);
+  selector_set_active_pad (sel, selpad);
+  gst_object_unref (selpad);
+
+  /* a delta unit, a keyframe and two delta units on the inactive pad */
+  for (i = 0; i < 4; i++) {
+    buf = gst_buffer_new_and_alloc (1);
+    if (i != 1)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless (gst_pad_push (pad1, buf) == GST_FLOW_OK);
+  }
+  fail_unless_equals_int (GPOINTER_TO_INT (g_object_get_data (G_OBJECT
+              (output_pad), "buffer_count")), 0);
+
+  selpad = gst_pad_get_peer (pad1);
+  selector_set_active_pad (sel, selpad);
+  gst_object_unref (selpad);
+
+  /* the keyframe and the following delta units arrive before this one */
+  buf = gst_buffer_new_and_alloc (1);
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  fail_unless (gst_pad_push (pad1, buf) == GST_FLOW_OK);
+  fail_unless_equals_int (GPOINTER_TO_INT (g_object_get_data (G_OBJECT
+              (output_pad), "buffer_count")), 4);
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_pad_remove_probe (output_pad, probe_id);
+  gst_pad_set_active (output_pad, FALSE);
+  gst_check_teardown_sink_pad (sel);
+  selector_set_active_pad (sel, NULL);
+  g_list_foreach (input_pads, (GFunc) cleanup_pad, sel);
+  g_list_free (input_pads);
+  gst_check_teardown_element (sel);
+}
+
+GST_END_TEST;
+
+#define NUM_SWITCHES     20
+#define SWITCH_BUFFERS   10
+
+static gint source_count[2];
+static gint pushing;
+
+/* counts the buffers that arrive from each input, the first byte of a buffer
+ * tells where it came from */
+static GstPadProbeReturn
+count_source_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBuffer *buf = GST_PAD_PROBE_INFO_BUFFER (info);
+  guint8 source = 0;
+
+  gst_buffer_extract (buf, 0, &source, 1);
+  if (source < 2)
+    g_atomic_int_inc (&source_count[source]);
+
+  return GST_PAD_PROBE_DROP;
+}
+
+static gpointer
+push_buffers_thread (GstPad * input_pad)
+{
+  guint8 source;
+
+  source = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (input_pad),
+          "source"));
+
+  /* the inactive pad gets its buffers dropped, the return value of the push
+   * does not matter here */
+  while (g_atomic_int_get (&pushing)) {
+    GstBuffer *buf = gst_buffer_new_and_alloc (1);
+
+    gst_buffer_fill (buf, 0, &source, 1);
+    gst_pad_push (input_pad, buf);
+  }
+
+  return NULL;
+}
+
+/* Switch the active pad while both inputs keep pushing buffers, the new
+   active pad must get its buffers through after every switch */
+GST_START_TEST (test_input_selector_switch_while_flowing);
+{
+  GList *input_pads = NULL;
+  GstElement *sel;
+  GstPad *output_pad, *pads[2], *selpad;
+  GThread *threads[2];
+  gint probe_id, i;
+
+  sel = gst_check_setup_element ("input-selector");
+  g_object_set (sel, "sync-streams", FALSE, NULL);
+  output_pad = gst_check_setup_sink_pad (sel, &sinktemplate);
+  gst_pad_set_active (output_pad, TRUE);
+  for (i = 0; i < 2; i++) {
+    pads[i] = setup_input_pad (sel);
+    g_object_set_data (G_OBJECT (pads[i]), "source", GINT_TO_POINTER (i));
+    input_pads = g_list_append (input_pads, pads[i]);
+  }
+  probe_id =
+      gst_pad_add_probe (output_pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) count_source_cb, NULL, NULL);
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  push_newsegment_events (input_pads);
+
+  source_count[0] = source_count[1] = 0;
+  pushing = TRUE;
+  for (i = 0; i < 2; i++) {
+    threads[i] = g_thread_try_new ("push", (GThreadFunc) push_buffers_thread,
+        pads[i], NULL);
+    fail_unless (threads[i] != NULL);
+  }
+
+  for (i = 0; i < NUM_SWITCHES; i++) {
+    gint active = i % 2, count;
+    gint64 end_time;
+
+    count = g_atomic_int_get (&source_count[active]);
+    selpad = gst_pad_get_peer (pads[active]);
+    selector_set_active_pad (sel, selpad);
+    gst_object_unref (selpad);
+
+    end_time = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+    while (g_atomic_int_get (&source_count[active]) < count + SWITCH_BUFFERS) {
+      fail_unless (g_get_monotonic_time () < end_time,
+          "no buffers from pad %d after switch %d", active, i);
+      g_usleep (1000);
+    }
+  }
+
+  g_atomic_int_set (&pushing, FALSE);
+  for (i = 0; i < 2; i++)
+    g_thread_join (threads[i]);
+
+  fail_unless (gst_element_set_state (sel,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS, "could not set to null");
+
+  gst_pad_remove_probe (output_pad, probe_id);
+  gst_pad_set_active (output_pad, FALSE);
+  gst_check_teardown_sink_pad (sel);
+  selector_set_active_pad (sel, NULL);
+  g_list_foreach (input_pads, (GFunc) cleanup_pad, sel);
+  g_list_free (input_pads);
+  gst_check_teardown_element (sel);
+}
+
+GST_END_TEST;
+
 static Suite *
 selector_suite (void)
 {
@@ -607,6 +785,8 @@ selector_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_output_selector_buffer_count);
   tcase_add_test (tc_chain, test_input_selector_buffer_count);
+  tcase_add_test (tc_chain, test_input_selector_keyframe_cache);
+  tcase_add_test (tc_chain, test_input_selector_switch_while_flowing);
   tcase_add_test (tc_chain, test_output_selector_no_srcpad_negotiation);
 
   tc_chain = tcase_create ("output-selector-negotiation");
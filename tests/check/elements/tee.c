@@ -598,6 +598,182 @@ GST_START_TEST (test_flow_aggregation)
 
 GST_END_TEST;
 
+static gint parallel_chain_count;
+
+static GstFlowReturn
+_fake_chain_count (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_atomic_int_inc (&parallel_chain_count);
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+#define NUM_PARALLEL_SINKS 4
+#define NUM_LIST_BUFFERS 5
+
+GST_START_TEST (test_parallel_push_list)
+{
+  GstPad *mysrc, *mysinks[NUM_PARALLEL_SINKS];
+  GstPad *teesink, *teesrcs[NUM_PARALLEL_SINKS];
+  GstElement *tee;
+  GstBufferList *list;
+  GstCaps *caps;
+  gint i;
+
+  caps = gst_caps_new_empty_simple ("test/test");
+
+  tee = gst_element_factory_make ("tee", NULL);
+  fail_unless (tee != NULL);
+  g_object_set (tee, "parallel-push", TRUE, NULL);
+  teesink = gst_element_get_static_pad (tee, "sink");
+  fail_unless (teesink != NULL);
+
+  mysrc = gst_pad_new ("mysrc", GST_PAD_SRC);
+  gst_pad_set_active (mysrc, TRUE);
+  gst_pad_set_caps (mysrc, caps);
+  fail_unless (gst_pad_link (mysrc, teesink) == GST_PAD_LINK_OK);
+
+  for (i = 0; i < NUM_PARALLEL_SINKS; i++) {
+    teesrcs[i] = gst_element_get_request_pad (tee, "src_%u");
+    fail_unless (teesrcs[i] != NULL);
+
+    mysinks[i] = gst_pad_new (NULL, GST_PAD_SINK);
+    gst_pad_set_chain_function (mysinks[i], _fake_chain_count);
+    gst_pad_set_active (mysinks[i], TRUE);
+    gst_pad_set_caps (mysinks[i], caps);
+    fail_unless (gst_pad_link (teesrcs[i], mysinks[i]) == GST_PAD_LINK_OK);
+  }
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  /* every sink gets all the buffers of the list */
+  list = gst_buffer_list_new ();
+  for (i = 0; i < NUM_LIST_BUFFERS; i++)
+    gst_buffer_list_add (list, gst_buffer_new ());
+
+  parallel_chain_count = 0;
+  fail_unless (gst_pad_push_list (mysrc,
+          gst_buffer_list_ref (list)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_atomic_int_get (&parallel_chain_count),
+      NUM_PARALLEL_SINKS * NUM_LIST_BUFFERS);
+
+  /* errors are aggregated like in the serial case */
+  gst_pad_set_chain_function (mysinks[2], _fake_chain_error);
+  fail_unless (gst_pad_push_list (mysrc,
+          gst_buffer_list_ref (list)) == GST_FLOW_ERROR);
+  gst_pad_set_chain_function (mysinks[2], _fake_chain_count);
+
+  /* a flushing pad gives flushing */
+  gst_pad_set_active (mysinks[1], FALSE);
+  fail_unless (gst_pad_push_list (mysrc,
+          gst_buffer_list_ref (list)) == GST_FLOW_FLUSHING);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < NUM_PARALLEL_SINKS; i++) {
+    fail_unless (gst_pad_unlink (teesrcs[i], mysinks[i]) == TRUE);
+    gst_element_release_request_pad (tee, teesrcs[i]);
+    gst_object_unref (teesrcs[i]);
+    gst_object_unref (mysinks[i]);
+  }
+  fail_unless (gst_pad_unlink (mysrc, teesink) == TRUE);
+  gst_object_unref (teesink);
+  gst_object_unref (tee);
+  gst_object_unref (mysrc);
+  gst_buffer_list_unref (list);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static gint branch_eos_count;
+
+static gboolean
+_fake_event_count_eos (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    g_atomic_int_inc (&branch_eos_count);
+  gst_event_unref (event);
+  return TRUE;
+}
+
+#define NUM_BRANCH_SINKS 2
+#define NUM_BRANCH_BUFFERS 20
+
+GST_START_TEST (test_branch_queue)
+{
+  GstPad *mysrc, *mysinks[NUM_BRANCH_SINKS];
+  GstPad *teesink, *teesrcs[NUM_BRANCH_SINKS];
+  GstElement *tee;
+  GstCaps *caps;
+  GstSegment segment;
+  gint i;
+
+  caps = gst_caps_new_empty_simple ("test/test");
+
+  tee = gst_element_factory_make ("tee", NULL);
+  fail_unless (tee != NULL);
+  g_object_set (tee, "branch-queue", TRUE, "branch-max-size-buffers", 2, NULL);
+  teesink = gst_element_get_static_pad (tee, "sink");
+  fail_unless (teesink != NULL);
+
+  mysrc = gst_pad_new ("mysrc", GST_PAD_SRC);
+  gst_pad_set_active (mysrc, TRUE);
+  fail_unless (gst_pad_link (mysrc, teesink) == GST_PAD_LINK_OK);
+
+  for (i = 0; i < NUM_BRANCH_SINKS; i++) {
+    teesrcs[i] = gst_element_get_request_pad (tee, "src_%u");
+    fail_unless (teesrcs[i] != NULL);
+
+    mysinks[i] = gst_pad_new (NULL, GST_PAD_SINK);
+    gst_pad_set_chain_function (mysinks[i], _fake_chain_count);
+    gst_pad_set_event_function (mysinks[i], _fake_event_count_eos);
+    gst_pad_set_active (mysinks[i], TRUE);
+    fail_unless (gst_pad_link (teesrcs[i], mysinks[i]) == GST_PAD_LINK_OK);
+  }
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS);
+
+  parallel_chain_count = 0;
+  branch_eos_count = 0;
+
+  gst_pad_push_event (mysrc, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (mysrc, gst_event_new_caps (caps));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrc, gst_event_new_segment (&segment));
+
+  /* more buffers than fit in the queues, each branch gets all of them */
+  for (i = 0; i < NUM_BRANCH_BUFFERS; i++)
+    fail_unless (gst_pad_push (mysrc, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (mysrc, gst_event_new_eos ()));
+
+  /* EOS is queued behind the buffers and pushed from the branch threads */
+  while (g_atomic_int_get (&branch_eos_count) < NUM_BRANCH_SINKS)
+    g_usleep (G_USEC_PER_SEC / 100);
+  fail_unless_equals_int (g_atomic_int_get (&parallel_chain_count),
+      NUM_BRANCH_SINKS * NUM_BRANCH_BUFFERS);
+
+  fail_unless (gst_element_set_state (tee,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  for (i = 0; i < NUM_BRANCH_SINKS; i++) {
+    fail_unless (gst_pad_unlink (teesrcs[i], mysinks[i]) == TRUE);
+    gst_element_release_request_pad (tee, teesrcs[i]);
+    gst_object_unref (teesrcs[i]);
+    gst_object_unref (mysinks[i]);
+  }
+  fail_unless (gst_pad_unlink (mysrc, teesink) == TRUE);
+  gst_object_unref (teesink);
+  gst_object_unref (tee);
+  gst_object_unref (mysrc);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 static Suite *
 tee_suite (void)
 {
@@ -614,6 +790,8 @@ tee_suite (void)
   tcase_add_test (tc_chain, test_release_while_second_buffer_alloc);
   tcase_add_test (tc_chain, test_internal_links);
   tcase_add_test (tc_chain, test_flow_aggregation);
+  tcase_add_test (tc_chain, test_parallel_push_list);
+  tcase_add_test (tc_chain, test_branch_queue);
 
   return s;
 }
@@ -103,6 +103,97 @@ GST_START_TEST (test_valve_basic)
 
 GST_END_TEST;
 
+static GstBuffer *
+new_buffer (GstClockTime pts, gboolean delta)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buffer) = pts;
+  if (delta)
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  return buffer;
+}
+
+GST_START_TEST (test_valve_modes)
+{
+  GstElement *valve;
+  GstPad *sink;
+  GstPad *src;
+  GstSegment segment;
+  GstBuffer *buffer;
+  gint i;
+
+  valve = gst_check_setup_element ("valve");
+
+  sink = gst_check_setup_sink_pad_by_name (valve, &sinktemplate, "src");
+  src = gst_check_setup_src_pad_by_name (valve, &srctemplate, "sink");
+  gst_pad_set_event_function (sink, event_func);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+  gst_element_set_state (valve, GST_STATE_PLAYING);
+
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (src, gst_event_new_segment (&segment)));
+
+  /* every third buffer, starting with the first */
+  gst_util_set_object_arg (G_OBJECT (valve), "mode", "interval");
+  g_object_set (valve, "interval", 3, NULL);
+  for (i = 0; i < 7; i++)
+    fail_unless (gst_pad_push (src, new_buffer (i * GST_SECOND,
+                FALSE)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 3);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffers->next->data),
+      3 * GST_SECOND);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffers->next->data,
+          GST_BUFFER_FLAG_DISCONT));
+  gst_check_drop_buffers ();
+
+  /* 25 buffers per second for 2 seconds, at most 2 per second pass */
+  gst_util_set_object_arg (G_OBJECT (valve), "mode", "rate");
+  g_object_set (valve, "max-rate", 2.0, NULL);
+  fail_unless (gst_pad_push_event (src, gst_event_new_segment (&segment)));
+  for (i = 0; i < 50; i++)
+    fail_unless (gst_pad_push (src, new_buffer (i * GST_SECOND / 25,
+                FALSE)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 4);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffers->data), 0);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffers->next->data),
+      13 * GST_SECOND / 25);
+  /* buffers without timestamp go through */
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 5);
+  gst_check_drop_buffers ();
+
+  /* only the keyframes */
+  gst_util_set_object_arg (G_OBJECT (valve), "mode", "key-units");
+  for (i = 0; i < 10; i++)
+    fail_unless (gst_pad_push (src, new_buffer (i * GST_SECOND,
+                i % 5 != 0)) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  for (i = 0; i < 2; i++) {
+    buffer = g_list_nth_data (buffers, i);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), i * 5 * GST_SECOND);
+    fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+  gst_check_drop_buffers ();
+
+  /* events are not sampled */
+  event_received = FALSE;
+  fail_unless (gst_pad_push_event (src, gst_event_new_eos ()));
+  fail_unless (event_received == TRUE);
+
+  gst_element_set_state (valve, GST_STATE_NULL);
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_check_teardown_src_pad (valve);
+  gst_check_teardown_sink_pad (valve);
+  gst_check_teardown_element (valve);
+}
+
+GST_END_TEST;
+
 static Suite *
 valve_suite (void)
 {
@@ -111,6 +202,7 @@ valve_suite (void)
 
   tc_chain = tcase_create ("valve_basic");
   tcase_add_test (tc_chain, test_valve_basic);
+  tcase_add_test (tc_chain, test_valve_modes);
   suite_add_tcase (s, tc_chain);
 
   return s;
@@ -31,6 +31,76 @@ GST_START_TEST (test_create_free)
 
 GST_END_TEST;
 
+GST_START_TEST (test_push_pop_many)
+{
+  GstAtomicQueue *aq;
+  gpointer in[100], out[100];
+  guint i, n;
+
+  for (i = 0; i < 100; i++)
+    in[i] = GUINT_TO_POINTER (i + 1);
+
+  /* push more than the initial size so that the queue has to grow */
+  aq = gst_atomic_queue_new (16);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, in, 40), 40);
+  gst_atomic_queue_push (aq, in[40]);
+  fail_unless_equals_int (gst_atomic_queue_push_many (aq, in + 41, 59), 59);
+  fail_unless_equals_int (gst_atomic_queue_length (aq), 100);
+
+  n = 0;
+  while (n < 100) {
+    guint got = gst_atomic_queue_pop_many (aq, out + n, 100 - n);
+
+    fail_unless (got > 0);
+    n += got;
+  }
+  for (i = 0; i < 100; i++)
+    fail_unless (out[i] == in[i]);
+  fail_unless_equals_int (gst_atomic_queue_pop_many (aq, out, 10), 0);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bounded)
+{
+  GstAtomicQueue *aq;
+  gpointer in[20], out[20];
+  guint i, round;
+
+  for (i = 0; i < 20; i++)
+    in[i] = GUINT_TO_POINTER (i + 1);
+
+  /* capacity is rounded up to 8 */
+  aq = gst_atomic_queue_new_bounded (5);
+  fail_unless (gst_atomic_queue_peek (aq) == NULL);
+  fail_unless (gst_atomic_queue_pop (aq) == NULL);
+
+  /* go around the ring a couple of times */
+  for (round = 0; round < 5; round++) {
+    fail_unless_equals_int (gst_atomic_queue_push_many (aq, in, 20), 8);
+    fail_unless_equals_int (gst_atomic_queue_length (aq), 8);
+    fail_unless_equals_int (gst_atomic_queue_push_many (aq, in, 1), 0);
+    fail_unless (gst_atomic_queue_peek (aq) == in[0]);
+
+    fail_unless (gst_atomic_queue_pop (aq) == in[0]);
+    fail_unless_equals_int (gst_atomic_queue_pop_many (aq, out, 3), 3);
+    fail_unless (out[0] == in[1] && out[1] == in[2] && out[2] == in[3]);
+
+    gst_atomic_queue_push (aq, in[10]);
+    fail_unless_equals_int (gst_atomic_queue_pop_many (aq, out, 20), 5);
+    fail_unless (out[3] == in[7]);
+    fail_unless (out[4] == in[10]);
+    fail_unless_equals_int (gst_atomic_queue_length (aq), 0);
+  }
+
+  gst_atomic_queue_unref (aq);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_atomic_queue_suite (void)
 {
@@ -39,6 +109,8 @@ gst_atomic_queue_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_create_free);
+  tcase_add_test (tc_chain, test_push_pop_many);
+  tcase_add_test (tc_chain, test_bounded);
 
   return s;
 }
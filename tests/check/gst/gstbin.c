@@ -1086,6 +1086,52 @@ GST_START_TEST (test_iterate_sorted)
 
 GST_END_TEST;
 
+static void
+check_sorted_order (GstBin * bin, GstElement * first, GstElement * second,
+    GstElement * third)
+{
+  GstElement *expected[3] = { first, second, third };
+  GstIterator *it;
+  GValue elem = { 0, };
+  gint i;
+
+  it = gst_bin_iterate_sorted (bin);
+  for (i = 0; i < 3; i++) {
+    fail_unless (gst_iterator_next (it, &elem) == GST_ITERATOR_OK);
+    fail_unless (g_value_get_object (&elem) == (gpointer) expected[i]);
+    g_value_reset (&elem);
+  }
+  fail_unless (gst_iterator_next (it, &elem) == GST_ITERATOR_DONE);
+  g_value_unset (&elem);
+  gst_iterator_free (it);
+}
+
+GST_START_TEST (test_iterate_sorted_cached)
+{
+  GstElement *pipeline, *src, *identity, *sink;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  identity = gst_element_factory_make ("identity", NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add_many (GST_BIN (pipeline), src, identity, sink, NULL);
+  fail_unless (gst_element_link_many (src, identity, sink, NULL));
+
+  /* the second time the cached order is used */
+  check_sorted_order (GST_BIN (pipeline), sink, identity, src);
+  check_sorted_order (GST_BIN (pipeline), sink, identity, src);
+
+  /* relinking invalidates the cached order */
+  gst_element_unlink_many (src, identity, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+  check_sorted_order (GST_BIN (pipeline), sink, src, identity);
+
+  ASSERT_OBJECT_REFCOUNT (pipeline, "pipeline", 1);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static void
 test_link_structure_change_state_changed_sync_cb (GstBus * bus,
     GstMessage * message, gpointer data)
@@ -1529,6 +1575,218 @@ GST_END_TEST;
 
 
 
+static guint
+count_latency_messages (GstBus * bus)
+{
+  GstMessage *msg;
+  guint n = 0;
+
+  while ((msg = gst_bus_pop_filtered (bus, GST_MESSAGE_LATENCY))) {
+    gst_message_unref (msg);
+    n++;
+  }
+  return n;
+}
+
+GST_START_TEST (test_get_by_name)
+{
+  GstElement *pipeline, *bin, *e1, *e2, *found;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  bin = gst_bin_new ("bin");
+  e1 = gst_element_factory_make ("identity", "e1");
+  e2 = gst_element_factory_make ("identity", "e2");
+  gst_bin_add (GST_BIN (pipeline), e1);
+  gst_bin_add (GST_BIN (bin), e2);
+  gst_bin_add (GST_BIN (pipeline), bin);
+
+  found = gst_bin_get_by_name (GST_BIN (pipeline), "e1");
+  fail_unless (found == e1);
+  gst_object_unref (found);
+
+  /* child bins are searched as well */
+  found = gst_bin_get_by_name (GST_BIN (pipeline), "e2");
+  fail_unless (found == e2);
+  gst_object_unref (found);
+  found = gst_bin_get_by_name_recurse_up (GST_BIN (bin), "e1");
+  fail_unless (found == e1);
+  gst_object_unref (found);
+
+  fail_unless (gst_bin_get_by_name (GST_BIN (pipeline), "e3") == NULL);
+
+  /* a removed name can be used again */
+  gst_bin_remove (GST_BIN (pipeline), e1);
+  fail_unless (gst_bin_get_by_name (GST_BIN (pipeline), "e1") == NULL);
+  e1 = gst_element_factory_make ("identity", "e1");
+  fail_unless (gst_bin_add (GST_BIN (pipeline), e1));
+  found = gst_bin_get_by_name (GST_BIN (pipeline), "e1");
+  fail_unless (found == e1);
+  gst_object_unref (found);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_latency_messages_coalesced)
+{
+  GstElement *pipeline, *sink;
+  GstBus *bus;
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  bus = gst_element_get_bus (pipeline);
+
+  /* only the first message reaches the bus */
+  for (i = 0; i < 3; i++)
+    gst_element_post_message (sink,
+        gst_message_new_latency (GST_OBJECT_CAST (sink)));
+  fail_unless_equals_int (count_latency_messages (bus), 1);
+
+  /* after a recalculation, the next message is posted again */
+  gst_bin_recalculate_latency (GST_BIN (pipeline));
+  gst_element_post_message (sink,
+      gst_message_new_latency (GST_OBJECT_CAST (sink)));
+  fail_unless_equals_int (count_latency_messages (bus), 1);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parallel_state_changes)
+{
+  GstElement *pipeline, *src, *queue, *sink;
+  GstStateChangeReturn ret;
+  GstState state;
+  gint i;
+
+  pipeline = gst_pipeline_new (NULL);
+  g_object_set (pipeline, "parallel-state-changes", TRUE, NULL);
+
+  /* independent branches of different lengths */
+  for (i = 0; i < 8; i++) {
+    src = gst_element_factory_make ("fakesrc", NULL);
+    sink = gst_element_factory_make ("fakesink", NULL);
+    gst_bin_add_many (GST_BIN (pipeline), src, sink, NULL);
+    if (i % 2) {
+      queue = gst_element_factory_make ("queue", NULL);
+      gst_bin_add (GST_BIN (pipeline), queue);
+      fail_unless (gst_element_link_many (src, queue, sink, NULL));
+    } else {
+      fail_unless (gst_element_link (src, sink));
+    }
+  }
+
+  ret = gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless (ret != GST_STATE_CHANGE_FAILURE);
+  ret = gst_element_get_state (pipeline, &state, NULL, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_PLAYING);
+
+  ret = gst_element_set_state (pipeline, GST_STATE_NULL);
+  fail_unless_equals_int (ret, GST_STATE_CHANGE_SUCCESS);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_upstream_event (GstPad * pad, GstPadProbeInfo * info, gint * count)
+{
+  g_atomic_int_inc (count);
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_parallel_dispatch)
+{
+  GstElement *bin, *sink;
+  GstQuery *query;
+  GstPad *pad;
+  gboolean live;
+  GstClockTime min, max;
+  gint i, count = 0;
+
+  bin = gst_bin_new (NULL);
+  g_object_set (bin, "parallel-dispatch-threshold", 4, NULL);
+
+  for (i = 0; i < 8; i++) {
+    sink = gst_element_factory_make ("fakesink", NULL);
+    gst_bin_add (GST_BIN (bin), sink);
+    pad = gst_element_get_static_pad (sink, "sink");
+    gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+        (GstPadProbeCallback) count_upstream_event, &count, NULL);
+    gst_object_unref (pad);
+  }
+
+  /* the sinks sync to the clock so they are live */
+  query = gst_query_new_latency ();
+  fail_unless (gst_element_query (bin, query));
+  gst_query_parse_latency (query, &live, &min, &max);
+  fail_unless (live);
+  fail_unless_equals_uint64 (min, 0);
+  gst_query_unref (query);
+
+  /* the same result when handled serially */
+  g_object_set (bin, "parallel-dispatch-threshold", 0, NULL);
+  query = gst_query_new_latency ();
+  fail_unless (gst_element_query (bin, query));
+  gst_query_parse_latency (query, &live, &min, &max);
+  fail_unless (live);
+  fail_unless_equals_uint64 (min, 0);
+  gst_query_unref (query);
+
+  /* every sink gets the event, the sinks are not linked so it fails */
+  g_object_set (bin, "parallel-dispatch-threshold", 4, NULL);
+  fail_if (gst_element_send_event (bin,
+          gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+              gst_structure_new_empty ("test"))));
+  fail_unless_equals_int (g_atomic_int_get (&count), 8);
+
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_memory_usage)
+{
+  GstElement *pipeline, *bin, *q1, *q2;
+  GstQuery *query;
+  guint64 allocated, queued;
+  gchar *owner;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  bin = gst_bin_new ("bin");
+  q1 = gst_element_factory_make ("queue", "q1");
+  q2 = gst_element_factory_make ("queue", "q2");
+  fail_unless (q1 != NULL && q2 != NULL);
+
+  gst_bin_add (GST_BIN (bin), q2);
+  gst_bin_add_many (GST_BIN (pipeline), q1, bin, NULL);
+
+  /* every child answers once, the sub bin recurses */
+  query = gst_query_new_memory_usage ();
+  fail_unless (gst_element_query (pipeline, query));
+  fail_unless_equals_int (gst_query_get_n_memory_usages (query), 2);
+
+  gst_query_parse_nth_memory_usage (query, 0, &owner, NULL, NULL);
+  fail_unless (g_str_has_suffix (owner, "/q1") || g_str_has_suffix (owner,
+          "/bin/q2"));
+  g_free (owner);
+
+  gst_query_parse_memory_usage (query, &allocated, &queued);
+  fail_unless_equals_uint64 (allocated, 0);
+  fail_unless_equals_uint64 (queued, 0);
+  gst_query_unref (query);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bin_suite (void)
 {
@@ -1552,12 +1810,18 @@ gst_bin_suite (void)
   tcase_add_test (tc_chain, test_add_linked);
   tcase_add_test (tc_chain, test_add_self);
   tcase_add_test (tc_chain, test_iterate_sorted);
+  tcase_add_test (tc_chain, test_iterate_sorted_cached);
   tcase_add_test (tc_chain, test_link_structure_change);
   tcase_add_test (tc_chain, test_state_failure_remove);
   tcase_add_test (tc_chain, test_state_failure_unref);
   tcase_add_test (tc_chain, test_state_change_skip);
   tcase_add_test (tc_chain, test_duration_is_max);
   tcase_add_test (tc_chain, test_duration_unknown_overrides);
+  tcase_add_test (tc_chain, test_get_by_name);
+  tcase_add_test (tc_chain, test_latency_messages_coalesced);
+  tcase_add_test (tc_chain, test_parallel_state_changes);
+  tcase_add_test (tc_chain, test_parallel_dispatch);
+  tcase_add_test (tc_chain, test_memory_usage);
 
   /* fails on OSX build bot for some reason, and is a bit silly anyway */
   if (0)
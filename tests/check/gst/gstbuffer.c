@@ -742,6 +742,84 @@ GST_START_TEST (test_find)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_vec)
+{
+  GstBuffer *buf;
+  GstMemory *mem[3];
+  GstMapInfo infos[3];
+  guint i;
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < 3; i++) {
+    mem[i] = gst_allocator_alloc (NULL, 10 * (i + 1), NULL);
+    gst_buffer_append_memory (buf, gst_memory_ref (mem[i]));
+  }
+
+  fail_unless (gst_buffer_map_range_vec (buf, 0, -1, infos, GST_MAP_READ));
+  for (i = 0; i < 3; i++) {
+    /* nothing was merged */
+    fail_unless (infos[i].memory == mem[i]);
+    fail_unless_equals_int (infos[i].size, 10 * (i + 1));
+  }
+  gst_buffer_unmap_vec (buf, infos, 3);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 3);
+
+  fail_unless (gst_buffer_map_range_vec (buf, 1, 2, infos, GST_MAP_WRITE));
+  fail_unless_equals_int (infos[0].size, 20);
+  fail_unless_equals_int (infos[1].size, 30);
+  memset (infos[1].data, 0xaa, infos[1].size);
+  gst_buffer_unmap_vec (buf, infos, 2);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 3);
+  fail_unless (gst_buffer_memcmp (buf, 30, "\252\252", 2) == 0);
+
+  gst_buffer_unref (buf);
+  for (i = 0; i < 3; i++)
+    gst_memory_unref (mem[i]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_many_memory)
+{
+  GstBuffer *buf, *copy;
+  GstMemory *first;
+  GstMapInfo info;
+  guint i;
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < 100; i++) {
+    GstMemory *mem = gst_allocator_alloc (NULL, 1, NULL);
+
+    gst_memory_map (mem, &info, GST_MAP_WRITE);
+    info.data[0] = i;
+    gst_memory_unmap (mem, &info);
+    gst_buffer_append_memory (buf, mem);
+  }
+  first = gst_buffer_peek_memory (buf, 0);
+
+  /* the memory is not merged when more than 16 blocks are added */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 100);
+  fail_unless (gst_buffer_peek_memory (buf, 0) == first);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 100);
+
+  gst_buffer_insert_memory (buf, 50, gst_allocator_alloc (NULL, 0, NULL));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 101);
+  gst_buffer_remove_memory (buf, 50);
+
+  copy = gst_buffer_copy (buf);
+  fail_unless_equals_int (gst_buffer_n_memory (copy), 100);
+
+  fail_unless (gst_buffer_map (copy, &info, GST_MAP_READ));
+  for (i = 0; i < 100; i++)
+    fail_unless_equals_int (info.data[i], i);
+  gst_buffer_unmap (copy, &info);
+
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 gst_buffer_suite (void)
@@ -761,6 +839,8 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_resize);
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_find);
+  tcase_add_test (tc_chain, test_map_vec);
+  tcase_add_test (tc_chain, test_many_memory);
 
   return s;
 }
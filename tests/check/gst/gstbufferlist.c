@@ -107,6 +107,167 @@ GST_START_TEST (test_add_and_iterate)
 
 GST_END_TEST;
 
+static gboolean
+remove_odd_func (GstBuffer ** buffer, guint idx, guint * p_count)
+{
+  /* the index is the one in the resulting list */
+  fail_unless_equals_int (idx, *p_count / 2);
+  if ((*p_count)++ % 2 == 1) {
+    gst_buffer_unref (*buffer);
+    *buffer = NULL;
+  }
+  return TRUE;
+}
+
+GST_START_TEST (test_foreach_remove)
+{
+  GstBuffer *bufs[6];
+  guint i, count = 0;
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++) {
+    bufs[i] = gst_buffer_new ();
+    gst_buffer_list_add (list, bufs[i]);
+  }
+
+  fail_unless (gst_buffer_list_foreach (list,
+          (GstBufferListFunc) remove_odd_func, &count));
+  fail_unless_equals_int (count, 6);
+  fail_unless_equals_int (gst_buffer_list_length (list), 3);
+  for (i = 0; i < 3; i++)
+    fail_unless (gst_buffer_list_get (list, i) == bufs[2 * i]);
+}
+
+GST_END_TEST;
+
+static GstBuffer *
+new_time_buffer (GstClockTime pts, GstClockTime duration)
+{
+  GstBuffer *buf = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buf) = pts;
+  GST_BUFFER_DURATION (buf) = duration;
+
+  return buf;
+}
+
+GST_START_TEST (test_clip)
+{
+  GstSegment segment;
+  GstBuffer *buf;
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  segment.start = 2 * GST_SECOND;
+  segment.stop = 4 * GST_SECOND;
+
+  gst_buffer_list_add (list, new_time_buffer (0, GST_SECOND));
+  gst_buffer_list_add (list, new_time_buffer (GST_SECOND, 2 * GST_SECOND));
+  gst_buffer_list_add (list, new_time_buffer (3 * GST_SECOND, GST_SECOND));
+  gst_buffer_list_add (list, new_time_buffer (GST_CLOCK_TIME_NONE,
+          GST_SECOND));
+  gst_buffer_list_add (list, new_time_buffer (5 * GST_SECOND, GST_SECOND));
+
+  /* the edge buffer is kept as is, the one without timestamp is kept */
+  fail_unless_equals_int (gst_buffer_list_clip (list, &segment), 3);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (gst_buffer_list_get (list, 0)),
+      GST_SECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (gst_buffer_list_get (list,
+              0)), 2 * GST_SECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (gst_buffer_list_get (list, 1)),
+      3 * GST_SECOND);
+  fail_if (GST_BUFFER_PTS_IS_VALID (gst_buffer_list_get (list, 2)));
+
+  /* in bytes, the edges are trimmed */
+  gst_buffer_list_unref (list);
+  list = gst_buffer_list_new ();
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  segment.start = 100;
+  segment.stop = 250;
+
+  buf = gst_buffer_new_allocate (NULL, 100, NULL);
+  GST_BUFFER_OFFSET (buf) = 0;
+  gst_buffer_list_add (list, buf);
+  buf = gst_buffer_new_allocate (NULL, 100, NULL);
+  GST_BUFFER_OFFSET (buf) = 50;
+  GST_BUFFER_OFFSET_END (buf) = 150;
+  gst_buffer_list_add (list, buf);
+  buf = gst_buffer_new_allocate (NULL, 100, NULL);
+  GST_BUFFER_OFFSET (buf) = 200;
+  gst_buffer_list_add (list, buf);
+
+  fail_unless_equals_int (gst_buffer_list_clip (list, &segment), 2);
+  buf = gst_buffer_list_get (list, 0);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 100);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET_END (buf), 150);
+  fail_unless_equals_int (gst_buffer_get_size (buf), 50);
+  buf = gst_buffer_list_get (list, 1);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 200);
+  fail_if (GST_BUFFER_OFFSET_END_IS_VALID (buf));
+  fail_unless_equals_int (gst_buffer_get_size (buf), 50);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_insert_list)
+{
+  GstBufferList *other;
+  GstBuffer *buf1, *buf2, *buf3;
+
+  buf1 = gst_buffer_new ();
+  buf2 = gst_buffer_new ();
+  buf3 = gst_buffer_new ();
+  gst_buffer_list_add (list, buf1);
+
+  /* a writable list gives its buffers away */
+  other = gst_buffer_list_new ();
+  gst_buffer_list_add (other, buf2);
+  gst_buffer_list_add (other, buf3);
+  gst_buffer_list_insert_list (list, 0, other);
+  fail_unless_equals_int (gst_buffer_list_length (list), 3);
+  fail_unless (gst_buffer_list_get (list, 0) == buf2);
+  fail_unless (gst_buffer_list_get (list, 1) == buf3);
+  fail_unless (gst_buffer_list_get (list, 2) == buf1);
+  ASSERT_BUFFER_REFCOUNT (buf2, "buf2", 1);
+  ASSERT_BUFFER_REFCOUNT (buf3, "buf3", 1);
+
+  /* a shared list keeps its buffers */
+  other = gst_buffer_list_new ();
+  gst_buffer_list_add (other, gst_buffer_ref (buf1));
+  gst_buffer_list_ref (other);
+  gst_buffer_list_add_list (list, other);
+  fail_unless_equals_int (gst_buffer_list_length (list), 4);
+  fail_unless (gst_buffer_list_get (list, 3) == buf1);
+  fail_unless_equals_int (gst_buffer_list_length (other), 1);
+  ASSERT_BUFFER_REFCOUNT (buf1, "buf1", 3);
+
+  gst_buffer_list_unref (other);
+  ASSERT_BUFFER_REFCOUNT (buf1, "buf1", 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_reuse)
+{
+  GstBufferList *other;
+  GstBuffer *buf;
+
+  buf = gst_buffer_new ();
+  other = gst_buffer_list_new ();
+  gst_buffer_list_add (other, gst_buffer_ref (buf));
+  gst_buffer_list_unref (other);
+  /* the buffers are released when the list is kept for reuse */
+  ASSERT_BUFFER_REFCOUNT (buf, "buf", 1);
+
+  /* a reused list starts out empty and writable */
+  other = gst_buffer_list_new_sized (32);
+  fail_unless_equals_int (gst_buffer_list_length (other), 0);
+  fail_unless (gst_buffer_list_is_writable (other));
+  gst_buffer_list_add (other, buf);
+  fail_unless (gst_buffer_list_get (other, 0) == buf);
+  gst_buffer_list_unref (other);
+}
+
+GST_END_TEST;
+
 #if 0
 GST_START_TEST (test_make_writable)
 {
@@ -762,6 +923,10 @@ gst_buffer_list_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_checked_fixture (tc_chain, setup, cleanup);
   tcase_add_test (tc_chain, test_add_and_iterate);
+  tcase_add_test (tc_chain, test_foreach_remove);
+  tcase_add_test (tc_chain, test_clip);
+  tcase_add_test (tc_chain, test_insert_list);
+  tcase_add_test (tc_chain, test_reuse);
 #if 0
   tcase_add_test (tc_chain, test_make_writable);
   tcase_add_test (tc_chain, test_copy);
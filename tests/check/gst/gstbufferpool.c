@@ -0,0 +1,333 @@
+/* GStreamer
+ *
+ * unit test for GstBufferPool
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+
+static GstBufferPool *
+create_pool (guint size, guint min_buf, guint max_buf, gboolean thread_cache)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+
+  gst_buffer_pool_config_set_params (conf, caps, size, min_buf, max_buf);
+  if (thread_cache)
+    gst_buffer_pool_config_add_option (conf,
+        GST_BUFFER_POOL_OPTION_THREAD_CACHE);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (caps);
+
+  return pool;
+}
+
+GST_START_TEST (test_new_buffer_from_empty_pool)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, FALSE);
+  GstBuffer *buf = NULL;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (buf != NULL, "acquiring buffer returned NULL");
+  fail_unless_equals_int (gst_buffer_get_size (buf), 10);
+
+  gst_buffer_unref (buf);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_option)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+
+  fail_unless (gst_buffer_pool_has_option (pool,
+          GST_BUFFER_POOL_OPTION_THREAD_CACHE));
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_thread_cache_reuse)
+{
+  GstBufferPool *pool = create_pool (10, 0, 0, TRUE);
+  GstBuffer *buf = NULL, *prev;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  prev = buf;
+  gst_buffer_unref (buf);
+
+  /* the buffer is cached in our thread and handed out again */
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (buf == prev, "got a new buffer instead of the cached one");
+  gst_buffer_unref (buf);
+
+  /* deactivating frees the cached buffers */
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+release_buffers_thread (gpointer data)
+{
+  GstBuffer **bufs = data;
+
+  gst_buffer_unref (bufs[0]);
+  gst_buffer_unref (bufs[1]);
+
+  return NULL;
+}
+
+GST_START_TEST (test_thread_cache_other_thread)
+{
+  GstBufferPool *pool = create_pool (10, 0, 2, TRUE);
+  GstBuffer *bufs[2] = { NULL, NULL };
+  GstBuffer *buf = NULL;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[0], NULL) ==
+      GST_FLOW_OK);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[1], NULL) ==
+      GST_FLOW_OK);
+
+  /* release from a thread that stays alive in the cache of that thread, we
+   * must still be able to get them back here without blocking */
+  thread = g_thread_new ("release", release_buffers_thread, bufs);
+  g_thread_join (thread);
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (buf == bufs[0] || buf == bufs[1]);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_starvation_count)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1, FALSE);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf = NULL, *buf2 = NULL;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless_equals_int (gst_buffer_pool_get_starvation_count (pool), 0);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_pool_get_starvation_count (pool), 0);
+
+  /* the only buffer is in use */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2, &params) ==
+      GST_FLOW_EOS);
+  fail_unless_equals_int (gst_buffer_pool_get_starvation_count (pool), 1);
+
+  gst_buffer_unref (buf);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, &params) ==
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_buffer_pool_get_starvation_count (pool), 1);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_async_prealloc)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+  GstBuffer *bufs[4];
+  gint i;
+
+  fail_unless (gst_buffer_pool_has_option (pool,
+          GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC));
+
+  gst_buffer_pool_config_set_params (conf, caps, 100, 4, 4);
+  gst_buffer_pool_config_add_option (conf,
+      GST_BUFFER_POOL_OPTION_ASYNC_PREALLOC);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (caps);
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+
+  /* the buffers can be acquired right away, no more than max are made no
+   * matter who allocates them */
+  for (i = 0; i < 4; i++) {
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL) ==
+        GST_FLOW_OK);
+    fail_unless (gst_buffer_get_size (bufs[i]) == 100);
+  }
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (bufs[i]);
+
+  /* stopping waits for the preallocation */
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+
+  /* and it can be started again */
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[0], NULL) ==
+      GST_FLOW_OK);
+  gst_buffer_unref (bufs[0]);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_flushing_keeps_buffers)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1, FALSE);
+  GstBuffer *buf = NULL, *prev;
+
+  /* flushing an inactive pool does nothing */
+  gst_buffer_pool_set_flushing (pool, FALSE);
+  fail_unless (GST_BUFFER_POOL_IS_FLUSHING (pool));
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  prev = buf;
+
+  gst_buffer_pool_set_flushing (pool, TRUE);
+  fail_unless (gst_buffer_pool_is_active (pool));
+  gst_buffer_unref (buf);
+  buf = NULL;
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_FLUSHING);
+
+  /* the released buffer was kept and is acquired again */
+  gst_buffer_pool_set_flushing (pool, FALSE);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  fail_unless (buf == prev);
+  gst_buffer_unref (buf);
+
+  /* a flushing pool can be deactivated */
+  gst_buffer_pool_set_flushing (pool, TRUE);
+  fail_unless (gst_buffer_pool_set_active (pool, FALSE));
+  fail_unless (gst_buffer_pool_set_active (pool, TRUE));
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf, NULL) ==
+      GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+#ifdef HAVE_MMAP
+GST_START_TEST (test_contiguous_hugepages)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+  GstBuffer *bufs[5];
+  GstMapInfo info;
+  guint8 *data[4], *base;
+  gsize slot;
+  gint i;
+
+  fail_unless (gst_buffer_pool_has_option (pool,
+          GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES));
+
+  gst_buffer_pool_config_set_params (conf, caps, 1000, 4, 0);
+  gst_buffer_pool_config_add_option (conf,
+      GST_BUFFER_POOL_OPTION_CONTIGUOUS_HUGEPAGES);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (caps);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  for (i = 0; i < 5; i++) {
+    fail_unless (gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL) ==
+        GST_FLOW_OK);
+    fail_unless (gst_buffer_get_size (bufs[i]) == 1000);
+  }
+
+  base = NULL;
+  for (i = 0; i < 4; i++) {
+    fail_unless (gst_buffer_map (bufs[i], &info, GST_MAP_WRITE));
+    fail_unless (((guintptr) info.data & gst_memory_alignment) == 0);
+    memset (info.data, i, info.size);
+    data[i] = info.data;
+    if (base == NULL || data[i] < base)
+      base = data[i];
+    gst_buffer_unmap (bufs[i], &info);
+  }
+
+  /* the preallocated buffers are adjacent slots of one mapping */
+  slot = (1000 + gst_memory_alignment) & ~gst_memory_alignment;
+  for (i = 0; i < 4; i++) {
+    fail_unless ((data[i] - base) % slot == 0);
+    fail_unless (data[i] - base < 4 * slot);
+  }
+
+  /* the buffers survive the pool being stopped */
+  for (i = 1; i < 5; i++)
+    gst_buffer_unref (bufs[i]);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+
+  fail_unless (gst_buffer_map (bufs[0], &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0 && info.data[999] == 0);
+  gst_buffer_unmap (bufs[0], &info);
+  gst_buffer_unref (bufs[0]);
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+gst_buffer_pool_suite (void)
+{
+  Suite *s = suite_create ("GstBufferPool");
+  TCase *tc_chain = tcase_create ("buffer_pool tests");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_new_buffer_from_empty_pool);
+  tcase_add_test (tc_chain, test_thread_cache_option);
+  tcase_add_test (tc_chain, test_thread_cache_reuse);
+  tcase_add_test (tc_chain, test_thread_cache_other_thread);
+  tcase_add_test (tc_chain, test_starvation_count);
+  tcase_add_test (tc_chain, test_async_prealloc);
+  tcase_add_test (tc_chain, test_flushing_keeps_buffers);
+#ifdef HAVE_MMAP
+  tcase_add_test (tc_chain, test_contiguous_hugepages);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_buffer_pool);
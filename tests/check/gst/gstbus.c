@@ -18,6 +18,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#include <unistd.h>
+
+#include <glib/gstdio.h>
 #include <gst/check/gstcheck.h>
 
 static GstBus *test_bus = NULL;
@@ -611,6 +614,183 @@ GST_START_TEST (test_custom_main_context)
 
 GST_END_TEST;
 
+static gboolean
+count_batch_messages (GstBus * bus, GstMessage * message, gpointer data)
+{
+  guint *counts = data;
+
+  if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_BUFFERING) {
+    gint percent;
+
+    /* only the last buffering message is delivered */
+    gst_message_parse_buffering (message, &percent);
+    fail_unless_equals_int (percent, 90);
+    counts[0]++;
+  } else if (GST_MESSAGE_TYPE (message) == GST_MESSAGE_APPLICATION) {
+    counts[1]++;
+  }
+
+  return TRUE;
+}
+
+GST_START_TEST (test_dispatch_batch)
+{
+  GstObject *src;
+  guint counts[2] = { 0, 0 };
+  guint id;
+  gint i;
+
+  test_bus = gst_bus_new ();
+  src = g_object_new (GST_TYPE_BUS, NULL);
+
+  gst_bus_set_dispatch_batch (test_bus, 0, GST_MESSAGE_BUFFERING);
+  id = gst_bus_add_watch (test_bus, count_batch_messages, counts);
+  fail_if (id == 0);
+
+  for (i = 0; i < 10; i++) {
+    gst_bus_post (test_bus, gst_message_new_buffering (src, i * 10));
+    gst_bus_post (test_bus, gst_message_new_application (src,
+            gst_structure_new_empty ("test")));
+  }
+
+  /* all pending messages are handled in one dispatch */
+  g_main_context_iteration (NULL, FALSE);
+  fail_unless_equals_int (counts[0], 1);
+  fail_unless_equals_int (counts[1], 10);
+  fail_if (gst_bus_have_pending (test_bus));
+
+  g_source_remove (id);
+  gst_object_unref (src);
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_message_types)
+{
+  GstMessage *msg;
+
+  test_bus = gst_bus_new ();
+
+  fail_unless_equals_int (gst_bus_get_message_types (test_bus),
+      GST_MESSAGE_ANY);
+
+  gst_bus_set_message_types (test_bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (gst_bus_accepts_message_type (test_bus, GST_MESSAGE_EOS));
+  fail_if (gst_bus_accepts_message_type (test_bus, GST_MESSAGE_TAG));
+
+  /* filtered messages are dropped but still count as posted */
+  fail_unless (gst_bus_post (test_bus,
+          gst_message_new_tag (NULL, gst_tag_list_new_empty ())));
+  fail_if (gst_bus_have_pending (test_bus));
+
+  fail_unless (gst_bus_post (test_bus, gst_message_new_eos (NULL)));
+  msg = gst_bus_pop (test_bus);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_object_unref (test_bus);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_ring)
+{
+  GstBusRing *ring, *monitor;
+  GstElement *src;
+  GstMessage *msg;
+  GError *err = NULL;
+  gchar *path, *src_path;
+  guint32 seqnum = 0;
+  gint fd, i;
+
+  fd = g_file_open_tmp ("gstbusringXXXXXX", &path, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+
+  /* an empty file is not a ring */
+  fail_if (gst_bus_ring_open (path, &err));
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+
+  ring = gst_bus_ring_new (path, 3, 0, &err);
+  fail_unless (ring != NULL);
+  fail_unless (err == NULL);
+  monitor = gst_bus_ring_open (path, &err);
+  fail_unless (monitor != NULL);
+  fail_unless (gst_bus_ring_pop (monitor, NULL) == NULL);
+
+  test_bus = gst_bus_new ();
+  src = gst_element_factory_make ("fakesrc", "ringsrc");
+  gst_bus_set_ring (test_bus, ring, GST_MESSAGE_ELEMENT | GST_MESSAGE_ERROR);
+
+  /* 3 is rounded up to 4 slots */
+  for (i = 0; i < 6; i++) {
+    msg = gst_message_new_element (GST_OBJECT (src),
+        gst_structure_new ("ring", "index", G_TYPE_INT, i, NULL));
+    if (i == 0)
+      seqnum = gst_message_get_seqnum (msg);
+    fail_unless (gst_bus_post (test_bus, msg));
+  }
+  fail_unless_equals_int (gst_bus_ring_get_dropped (monitor), 2);
+  fail_if (gst_bus_have_pending (test_bus));
+
+  /* other types are delivered as usual */
+  fail_unless (gst_bus_post (test_bus, gst_message_new_eos (NULL)));
+  msg = gst_bus_pop (test_bus);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  for (i = 0; i < 4; i++) {
+    const GstStructure *s;
+    gint index;
+
+    msg = gst_bus_ring_pop (monitor, &src_path);
+    fail_unless (msg != NULL);
+    fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_ELEMENT);
+    fail_unless (GST_MESSAGE_SRC (msg) == NULL);
+    fail_unless_equals_int (gst_message_get_seqnum (msg), seqnum + i);
+    fail_unless_equals_string (src_path, "/ringsrc");
+    s = gst_message_get_structure (msg);
+    fail_unless (gst_structure_has_name (s, "ring"));
+    fail_unless (gst_structure_get_int (s, "index", &index));
+    fail_unless_equals_int (index, i);
+    g_free (src_path);
+    gst_message_unref (msg);
+  }
+  fail_unless (gst_bus_ring_pop (monitor, NULL) == NULL);
+
+  /* the GError is passed as its message, the slots are reused */
+  err = g_error_new (GST_CORE_ERROR, GST_CORE_ERROR_FAILED, "ring error");
+  fail_unless (gst_bus_post (test_bus, gst_message_new_error (NULL, err,
+              "debug")));
+  g_error_free (err);
+  msg = gst_bus_ring_pop (monitor, &src_path);
+  fail_unless (msg != NULL);
+  fail_unless (src_path == NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_ERROR);
+  fail_unless_equals_string (gst_structure_get_string
+      (gst_message_get_structure (msg), "gerror"), "ring error");
+  gst_message_unref (msg);
+
+  gst_bus_set_ring (test_bus, NULL, 0);
+  fail_unless (gst_bus_post (test_bus, gst_message_new_element (NULL,
+              gst_structure_new_empty ("ring"))));
+  fail_unless (gst_bus_have_pending (test_bus));
+  fail_unless (gst_bus_ring_pop (monitor, NULL) == NULL);
+
+  gst_object_unref (test_bus);
+  gst_object_unref (src);
+  gst_bus_ring_unref (monitor);
+  gst_bus_ring_unref (ring);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bus_suite (void)
 {
@@ -630,6 +810,9 @@ gst_bus_suite (void)
   tcase_add_test (tc_chain, test_timed_pop_filtered);
   tcase_add_test (tc_chain, test_timed_pop_filtered_with_timeout);
   tcase_add_test (tc_chain, test_custom_main_context);
+  tcase_add_test (tc_chain, test_dispatch_batch);
+  tcase_add_test (tc_chain, test_message_types);
+  tcase_add_test (tc_chain, test_ring);
   return s;
 }
 
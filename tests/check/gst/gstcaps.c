@@ -53,6 +53,38 @@ GST_START_TEST (test_from_string)
 
 GST_END_TEST;
 
+GST_START_TEST (test_new_id_simple)
+{
+  GstCaps *caps, *expected;
+
+  fail_unless_equals_string (g_quark_to_string (GST_STRUCTURE_QUARK
+          (VIDEO_X_RAW)), "video/x-raw");
+  fail_unless_equals_string (g_quark_to_string (GST_STRUCTURE_QUARK
+          (PIXEL_ASPECT_RATIO)), "pixel-aspect-ratio");
+  fail_unless_equals_string (g_quark_to_string (GST_STRUCTURE_QUARK
+          (CLOCK_RATE)), "clock-rate");
+
+  caps = gst_caps_new_id_simple (GST_STRUCTURE_QUARK (VIDEO_X_RAW),
+      GST_STRUCTURE_QUARK (FORMAT), G_TYPE_STRING, "I420",
+      GST_STRUCTURE_QUARK (WIDTH), G_TYPE_INT, 320,
+      GST_STRUCTURE_QUARK (HEIGHT), G_TYPE_INT, 240,
+      GST_STRUCTURE_QUARK (FRAMERATE), GST_TYPE_FRACTION, 25, 1, 0);
+  expected = gst_caps_new_simple ("video/x-raw",
+      "format", G_TYPE_STRING, "I420", "width", G_TYPE_INT, 320,
+      "height", G_TYPE_INT, 240, "framerate", GST_TYPE_FRACTION, 25, 1, NULL);
+  fail_unless (gst_caps_is_strictly_equal (caps, expected));
+  gst_caps_unref (expected);
+  gst_caps_unref (caps);
+
+  caps = gst_caps_new_id_simple (GST_STRUCTURE_QUARK (AUDIO_X_RAW), 0);
+  fail_unless (gst_caps_get_size (caps) == 1);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "audio/x-raw"));
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_double_append)
 {
   GstStructure *s1;
@@ -861,6 +893,68 @@ GST_START_TEST (test_intersect_first2)
 
 GST_END_TEST;
 
+static void
+check_caps_indexes (GstCaps * caps, const gint * expected, guint n)
+{
+  GstStructure *s;
+  gint idx;
+  guint i;
+
+  fail_unless_equals_int (gst_caps_get_size (caps), n);
+  for (i = 0; i < n; i++) {
+    s = gst_caps_get_structure (caps, i);
+    fail_unless (gst_structure_get_int (s, "idx", &idx));
+    fail_unless_equals_int (idx, expected[i]);
+  }
+}
+
+GST_START_TEST (test_intersect_large)
+{
+  static const gchar *names[] = { "format/A", "format/B", "format/C",
+    "format/D"
+  };
+  static const gint zigzag[] = { 0, 1, 4, 5, 8, 9, 12, 13, 16, 17 };
+  static const gint first[] = { 0, 4, 8, 12, 16, 1, 5, 9, 13, 17 };
+  GstCaps *caps1, *caps2, *icaps, *sub;
+  gint i;
+
+  /* enough structures to intersect with the structures grouped by name */
+  caps1 = gst_caps_from_string ("format/A; format/B");
+  caps2 = gst_caps_new_empty ();
+  for (i = 0; i < 20; i++)
+    gst_caps_append_structure (caps2, gst_structure_new (names[i % 4],
+            "idx", G_TYPE_INT, i, NULL));
+
+  /* the order is the same as when all structures are compared */
+  icaps = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_ZIG_ZAG);
+  GST_LOG ("intersected caps: %" GST_PTR_FORMAT, icaps);
+  check_caps_indexes (icaps, zigzag, G_N_ELEMENTS (zigzag));
+  gst_caps_unref (icaps);
+
+  icaps = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  GST_LOG ("intersected caps: %" GST_PTR_FORMAT, icaps);
+  check_caps_indexes (icaps, first, G_N_ELEMENTS (first));
+  gst_caps_unref (icaps);
+
+  fail_unless (gst_caps_can_intersect (caps1, caps2));
+  sub = gst_caps_from_string ("format/E");
+  fail_if (gst_caps_can_intersect (sub, caps2));
+  fail_if (gst_caps_is_subset (sub, caps2));
+  gst_caps_unref (sub);
+
+  sub = gst_caps_from_string ("format/C, idx=(int)6; format/D, idx=(int)19");
+  fail_unless (gst_caps_is_subset (sub, caps2));
+  gst_caps_unref (sub);
+  sub = gst_caps_from_string ("format/C, idx=(int)6; format/D, idx=(int)18");
+  fail_if (gst_caps_is_subset (sub, caps2));
+  gst_caps_unref (sub);
+
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_intersect_duplication)
 {
   GstCaps *c1, *c2, *test;
@@ -963,6 +1057,99 @@ GST_START_TEST (test_broken)
 
 GST_END_TEST;
 
+GST_START_TEST (test_static_caps_cache)
+{
+  static GstStaticCaps scaps1 =
+      GST_STATIC_CAPS ("video/x-raw, format=(string){ I420, YV12 }, "
+      "width=(int)[ 1, 100 ]; video/x-raw, format=(string)RGB");
+  static GstStaticCaps scaps2 =
+      GST_STATIC_CAPS ("video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 200 ]");
+  GstCaps *caps1, *caps2, *res1, *res2, *expected, *writable;
+
+  caps1 = gst_static_caps_get (&scaps1);
+  caps2 = gst_static_caps_get (&scaps2);
+
+  expected = gst_caps_from_string ("video/x-raw, format=(string)I420, "
+      "width=(int)[ 50, 100 ]");
+
+  res1 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (res1, expected));
+  /* the second time the result comes from the cache */
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (res1 == res2);
+  gst_caps_unref (res2);
+
+  res2 = gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  fail_unless (gst_caps_is_equal (res2, expected));
+  gst_caps_unref (res2);
+
+  /* the result is shared, modifying it needs a copy */
+  writable = gst_caps_make_writable (res1);
+  fail_unless (gst_caps_is_equal (writable, expected));
+  gst_caps_set_simple (writable, "height", G_TYPE_INT, 10, NULL);
+  res2 = gst_caps_intersect (caps1, caps2);
+  fail_unless (gst_caps_is_equal (res2, expected));
+  gst_caps_unref (res2);
+  gst_caps_unref (writable);
+
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps1, caps2));
+  fail_if (gst_caps_is_subset (caps2, caps1));
+  fail_unless (gst_caps_is_subset (expected, caps1));
+
+  /* copies of static caps can be modified and are not cached */
+  writable = gst_caps_copy (caps2);
+  gst_caps_set_simple (writable, "width", G_TYPE_INT, 10, NULL);
+  fail_unless (gst_caps_is_subset (writable, caps1));
+  res1 = gst_caps_intersect (writable, caps1);
+  fail_unless (gst_caps_is_equal (res1, writable));
+  gst_caps_unref (res1);
+  gst_caps_unref (writable);
+
+  gst_caps_unref (expected);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_to_from_binary)
+{
+  const gchar *strings[] = {
+    "ANY", "EMPTY",
+    "video/x-raw, format = (string) { I420, YV12 }, "
+        "width = (int) [ 16, 4096 ], framerate = (fraction) [ 0/1, 2147483647/1 ]"
+        "; audio/x-raw, rate = (int) 44100, channels = (int) 2"
+  };
+  GstCaps *caps, *res;
+  guint8 *data;
+  gsize size;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++) {
+    caps = gst_caps_from_string (strings[i]);
+    fail_unless (caps != NULL);
+
+    data = gst_caps_to_binary (caps, &size);
+    fail_unless (data != NULL);
+    res = gst_caps_from_binary (data, size);
+    fail_unless (res != NULL);
+    fail_unless (gst_caps_is_any (res) == gst_caps_is_any (caps));
+    fail_unless (gst_caps_is_equal (res, caps));
+    gst_caps_unref (res);
+
+    /* trailing data is rejected */
+    data = g_realloc (data, size + 1);
+    data[size] = 0;
+    fail_unless (gst_caps_from_binary (data, size + 1) == NULL);
+
+    g_free (data);
+    gst_caps_unref (caps);
+  }
+}
+
+GST_END_TEST;
 
 static Suite *
 gst_caps_suite (void)
@@ -972,9 +1159,11 @@ gst_caps_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_from_string);
+  tcase_add_test (tc_chain, test_new_id_simple);
   tcase_add_test (tc_chain, test_double_append);
   tcase_add_test (tc_chain, test_mutability);
   tcase_add_test (tc_chain, test_static_caps);
+  tcase_add_test (tc_chain, test_static_caps_cache);
   tcase_add_test (tc_chain, test_simplify);
   tcase_add_test (tc_chain, test_truncate);
   tcase_add_test (tc_chain, test_subset);
@@ -988,8 +1177,10 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_intersect_first);
   tcase_add_test (tc_chain, test_intersect_first2);
   tcase_add_test (tc_chain, test_intersect_duplication);
+  tcase_add_test (tc_chain, test_intersect_large);
   tcase_add_test (tc_chain, test_normalize);
   tcase_add_test (tc_chain, test_broken);
+  tcase_add_test (tc_chain, test_to_from_binary);
 
   return s;
 }
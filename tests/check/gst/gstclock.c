@@ -47,6 +47,14 @@ fake_wait_async (GstClock * clock, GstClockEntry * entry)
   return GST_CLOCK_OK;
 }
 
+static GstClockTime fake_internal_time = 0;
+
+static GstClockTime
+fake_get_internal_time (GstClock * clock)
+{
+  return fake_internal_time;
+}
+
 static void
 test_clock_class_init (TestClockClass * klass)
 {
@@ -55,6 +63,7 @@ test_clock_class_init (TestClockClass * klass)
   clock_class = GST_CLOCK_CLASS (klass);
 
   clock_class->wait_async = fake_wait_async;
+  clock_class->get_internal_time = fake_get_internal_time;
 }
 
 static void
@@ -109,6 +118,87 @@ GST_START_TEST (test_set_master_refcount)
 
 GST_END_TEST;
 
+GST_START_TEST (test_calibration)
+{
+  GstClock *clock;
+
+  clock = g_object_new (TYPE_TEST_CLOCK, "name", "TestClock", NULL);
+
+  fake_internal_time = 10 * GST_SECOND;
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 10 * GST_SECOND);
+
+  /* rate 1/1 with an offset */
+  gst_clock_set_calibration (clock, 10 * GST_SECOND, 20 * GST_SECOND, 1, 1);
+  fake_internal_time = 11 * GST_SECOND;
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 21 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_clock_unadjust_unlocked (clock,
+          21 * GST_SECOND), 11 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_clock_unadjust_unlocked (clock,
+          19 * GST_SECOND), 9 * GST_SECOND);
+
+  /* the same rate with a different representation */
+  gst_clock_set_calibration (clock, 10 * GST_SECOND, 20 * GST_SECOND, 3, 3);
+  fake_internal_time = 12 * GST_SECOND;
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 22 * GST_SECOND);
+
+  /* double speed */
+  gst_clock_set_calibration (clock, 12 * GST_SECOND, 22 * GST_SECOND, 2, 1);
+  fake_internal_time = 13 * GST_SECOND;
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 24 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_clock_unadjust_unlocked (clock,
+          24 * GST_SECOND), 13 * GST_SECOND);
+
+  /* the time does not go backwards */
+  gst_clock_set_calibration (clock, 13 * GST_SECOND, 10 * GST_SECOND, 1, 1);
+  fail_unless_equals_uint64 (gst_clock_get_time (clock), 24 * GST_SECOND);
+
+  fake_internal_time = 0;
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+static gboolean calibrate_stop;
+
+static gpointer
+calibrate_thread (GstClock * clock)
+{
+  guint i = 0;
+
+  while (!g_atomic_int_get (&calibrate_stop)) {
+    /* the same calibration in two forms, a mix of both would be 3/1 */
+    if (i++ % 2)
+      gst_clock_set_calibration (clock, 0, 0, 1, 1);
+    else
+      gst_clock_set_calibration (clock, 0, 0, 3, 3);
+  }
+  return NULL;
+}
+
+GST_START_TEST (test_calibration_concurrent)
+{
+  GstClock *clock;
+  GThread *thread;
+  gint i;
+
+  clock = g_object_new (TYPE_TEST_CLOCK, "name", "TestClock", NULL);
+  fake_internal_time = GST_SECOND;
+
+  g_atomic_int_set (&calibrate_stop, FALSE);
+  thread = g_thread_new ("calibrate", (GThreadFunc) calibrate_thread, clock);
+
+  for (i = 0; i < 100000; i++)
+    fail_unless_equals_uint64 (gst_clock_get_time (clock), GST_SECOND);
+
+  g_atomic_int_set (&calibrate_stop, TRUE);
+  g_thread_join (thread);
+
+  fake_internal_time = 0;
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_clock_suite (void)
 {
@@ -117,6 +207,8 @@ gst_clock_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_set_master_refcount);
+  tcase_add_test (tc_chain, test_calibration);
+  tcase_add_test (tc_chain, test_calibration_concurrent);
 
   return s;
 }
@@ -683,6 +683,61 @@ GST_START_TEST (test_GstDateTime_new_from_g_date_time)
 
 GST_END_TEST;
 
+GST_START_TEST (test_GstDateTime_range)
+{
+  GstDateTime *dt, *dt2;
+  GDateTime *gdt;
+  gchar *str;
+
+  /* dates before the Unix epoch and leap days */
+  dt = gst_date_time_new (-5.5, 1, 1, 1, 0, 0, 0);
+  assert_equals_int (1, gst_date_time_get_year (dt));
+  assert_equals_int (1, gst_date_time_get_month (dt));
+  assert_equals_int (1, gst_date_time_get_day (dt));
+  assert_equals_float (-5.5, gst_date_time_get_time_zone_offset (dt));
+  gst_date_time_unref (dt);
+
+  dt = gst_date_time_new (0, 1900, 2, 28, 23, 59, 59.5);
+  assert_equals_int (1900, gst_date_time_get_year (dt));
+  assert_equals_int (2, gst_date_time_get_month (dt));
+  assert_equals_int (28, gst_date_time_get_day (dt));
+  assert_equals_int (23, gst_date_time_get_hour (dt));
+  assert_equals_int (59, gst_date_time_get_minute (dt));
+  assert_equals_int (59, gst_date_time_get_second (dt));
+  assert_equals_int (500000, gst_date_time_get_microsecond (dt));
+  gdt = gst_date_time_to_g_date_time (dt);
+  assert_equals_int (g_date_time_get_year (gdt), 1900);
+  assert_equals_int (g_date_time_get_day_of_month (gdt), 28);
+  assert_equals_int (g_date_time_get_second (gdt), 59);
+  assert_equals_int (g_date_time_get_microsecond (gdt), 500000);
+  g_date_time_unref (gdt);
+  gst_date_time_unref (dt);
+
+  dt = gst_date_time_new (0, 2012, 2, 29, 12, 0, 0);
+  str = gst_date_time_to_iso8601_string (dt);
+  fail_unless_equals_string (str, "2012-02-29T12:00:00Z");
+  g_free (str);
+  gst_date_time_unref (dt);
+
+  /* there is no February 29 in 2013 */
+  fail_unless (gst_date_time_new (0, 2013, 2, 29, 12, 0, 0) == NULL);
+
+  /* the same instant in different time zones */
+  dt = gst_date_time_new (0, 2012, 6, 23, 23, 30, 0);
+  dt2 = gst_date_time_new (2.0, 2012, 6, 24, 1, 30, 0);
+  fail_unless (date_times_are_equal (dt, dt2));
+  str = gst_date_time_to_iso8601_string (dt2);
+  fail_unless_equals_string (str, "2012-06-24T01:30:00+0200");
+  g_free (str);
+  gst_date_time_unref (dt2);
+  dt2 = gst_date_time_new (-2.0, 2012, 6, 23, 21, 30, 1);
+  fail_if (date_times_are_equal (dt, dt2));
+  gst_date_time_unref (dt2);
+  gst_date_time_unref (dt);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_date_time_suite (void)
 {
@@ -705,6 +760,7 @@ gst_date_time_suite (void)
   tcase_add_test (tc_chain, test_GstDateTime_iso8601);
   tcase_add_test (tc_chain, test_GstDateTime_to_g_date_time);
   tcase_add_test (tc_chain, test_GstDateTime_new_from_g_date_time);
+  tcase_add_test (tc_chain, test_GstDateTime_range);
 
   return s;
 }
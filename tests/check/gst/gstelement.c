@@ -347,6 +347,101 @@ GST_START_TEST (test_pad_templates)
 
 GST_END_TEST;
 
+static gboolean
+count_pads_func (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  guint *count = user_data;
+
+  /* the pad is reffed for the duration of the call */
+  ASSERT_OBJECT_REFCOUNT (pad, "pad", 2);
+  fail_unless (GST_OBJECT_PARENT (pad) == GST_OBJECT_CAST (element));
+
+  (*count)++;
+
+  /* stop after the third pad */
+  return *count < 3;
+}
+
+GST_START_TEST (test_foreach_pad)
+{
+  GstElement *e;
+  guint count;
+  gint i;
+
+  e = gst_element_factory_make ("fakesrc", "source");
+
+  /* the static pad of fakesrc */
+  count = 0;
+  fail_unless (gst_element_foreach_pad (e, count_pads_func, &count));
+  fail_unless_equals_int (count, 1);
+  count = 0;
+  fail_unless (gst_element_foreach_src_pad (e, count_pads_func, &count));
+  fail_unless_equals_int (count, 1);
+  count = 0;
+  fail_if (gst_element_foreach_sink_pad (e, count_pads_func, &count));
+  fail_unless_equals_int (count, 0);
+
+  /* more pads than fit on the stack */
+  for (i = 0; i < 20; i++) {
+    gchar *name = g_strdup_printf ("sink_%d", i);
+
+    gst_element_add_pad (e, gst_pad_new (name, GST_PAD_SINK));
+    g_free (name);
+  }
+  count = 0;
+  fail_if (gst_element_foreach_sink_pad (e, count_pads_func, &count));
+  fail_unless_equals_int (count, 3);
+
+  gst_object_unref (e);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_peek_state)
+{
+  GstElement *sink;
+  GstState state, pending, target;
+
+  sink = gst_element_factory_make ("fakesink", "sink");
+
+  fail_unless_equals_int (gst_element_peek_state (sink, &state, &pending,
+          &target), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_NULL);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+  fail_unless_equals_int (target, GST_STATE_NULL);
+
+  /* the sink can't preroll without data */
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_peek_state (sink, &state, &pending,
+          &target), GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (state, GST_STATE_READY);
+  fail_unless_equals_int (pending, GST_STATE_PAUSED);
+  fail_unless_equals_int (target, GST_STATE_PAUSED);
+
+  /* a 0 timeout gives the same result */
+  fail_unless_equals_int (gst_element_get_state (sink, &state, &pending, 0),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (state, GST_STATE_READY);
+  fail_unless_equals_int (pending, GST_STATE_PAUSED);
+
+  /* all arguments are optional */
+  fail_unless_equals_int (gst_element_peek_state (sink, NULL, NULL, NULL),
+      GST_STATE_CHANGE_ASYNC);
+
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_NULL),
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (gst_element_peek_state (sink, &state, &pending,
+          &target), GST_STATE_CHANGE_SUCCESS);
+  fail_unless_equals_int (state, GST_STATE_NULL);
+  fail_unless_equals_int (pending, GST_STATE_VOID_PENDING);
+  fail_unless_equals_int (target, GST_STATE_NULL);
+
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_element_suite (void)
 {
@@ -360,6 +455,8 @@ gst_element_suite (void)
   tcase_add_test (tc_chain, test_link);
   tcase_add_test (tc_chain, test_link_no_pads);
   tcase_add_test (tc_chain, test_pad_templates);
+  tcase_add_test (tc_chain, test_foreach_pad);
+  tcase_add_test (tc_chain, test_peek_state);
 
   return s;
 }
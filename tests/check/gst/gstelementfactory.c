@@ -163,6 +163,112 @@ GST_START_TEST (test_class)
 
 GST_END_TEST;
 
+GST_START_TEST (test_list_get_elements)
+{
+  GstElementFactory *fakesink;
+  GList *list, *list2, *a, *b;
+  guint rank;
+
+  list = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  fail_unless (list != NULL);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  for (a = list, b = list2; a && b; a = a->next, b = b->next)
+    fail_unless (a->data == b->data);
+  fail_unless (a == NULL && b == NULL);
+  gst_plugin_feature_list_free (list2);
+
+  /* changing a rank must reorder the next result */
+  fakesink = gst_element_factory_find ("fakesink");
+  fail_unless (fakesink != NULL);
+  rank = gst_plugin_feature_get_rank (GST_PLUGIN_FEATURE (fakesink));
+  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE (fakesink),
+      GST_RANK_PRIMARY + 1000);
+  list2 = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_SINK,
+      GST_RANK_NONE);
+  fail_unless (list2->data == fakesink);
+  fail_unless_equals_int (g_list_length (list2), g_list_length (list));
+  gst_plugin_feature_list_free (list2);
+
+  gst_plugin_feature_set_rank (GST_PLUGIN_FEATURE (fakesink), rank);
+  gst_object_unref (fakesink);
+  gst_plugin_feature_list_free (list);
+}
+
+GST_END_TEST;
+static gboolean
+factory_can_intersect (GstElementFactory * factory, GstCaps * caps,
+    GstPadDirection direction)
+{
+  const GList *walk;
+  gboolean res = FALSE;
+
+  walk = gst_element_factory_get_static_pad_templates (factory);
+  for (; walk && !res; walk = walk->next) {
+    GstStaticPadTemplate *templ = walk->data;
+    GstCaps *tmpl_caps;
+
+    if (templ->direction != direction)
+      continue;
+    tmpl_caps = gst_static_caps_get (&templ->static_caps);
+    res = gst_caps_can_intersect (caps, tmpl_caps);
+    gst_caps_unref (tmpl_caps);
+  }
+  return res;
+}
+
+GST_START_TEST (test_list_filter)
+{
+  const gchar *descs[] = { "foo/bar", "audio/x-raw, rate=(int)44100",
+    "foo/bar; application/x-baz", NULL
+  };
+  GList *list, *filtered, *walk, *res;
+  GstElementFactory *factory;
+  GstCaps *caps;
+  guint i;
+
+  list = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_ANY,
+      GST_RANK_NONE);
+
+  /* a factory that is not in the registry */
+  factory = setup_factory ();
+  list = g_list_append (list, factory);
+
+  for (i = 0; descs[i]; i++) {
+    caps = gst_caps_from_string (descs[i]);
+    filtered = gst_element_factory_list_filter (list, caps, GST_PAD_SINK,
+        FALSE);
+
+    /* the same factories in the same order as checking each one */
+    res = filtered;
+    for (walk = list; walk; walk = walk->next) {
+      if (!factory_can_intersect (walk->data, caps, GST_PAD_SINK))
+        continue;
+      fail_unless (res != NULL && res->data == walk->data);
+      res = res->next;
+    }
+    fail_unless (res == NULL);
+
+    gst_plugin_feature_list_free (filtered);
+    gst_caps_unref (caps);
+  }
+
+  /* fakesink accepts anything */
+  caps = gst_caps_from_string ("foo/bar");
+  filtered = gst_element_factory_list_filter (list, caps, GST_PAD_SINK, FALSE);
+  for (walk = filtered; walk; walk = walk->next) {
+    if (g_strcmp0 (GST_OBJECT_NAME (walk->data), "fakesink") == 0)
+      break;
+  }
+  fail_unless (walk != NULL);
+  gst_plugin_feature_list_free (filtered);
+  gst_caps_unref (caps);
+
+  gst_plugin_feature_list_free (list);
+}
+
+GST_END_TEST;
 
 static Suite *
 gst_element_factory_suite (void)
@@ -175,6 +281,8 @@ gst_element_factory_suite (void)
   tcase_add_test (tc_chain, test_create);
   tcase_add_test (tc_chain, test_can_sink_any_caps);
   tcase_add_test (tc_chain, test_can_sink_all_caps);
+  tcase_add_test (tc_chain, test_list_get_elements);
+  tcase_add_test (tc_chain, test_list_filter);
 
   return s;
 }
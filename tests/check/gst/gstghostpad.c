@@ -1160,6 +1160,73 @@ GST_START_TEST (test_ghost_pads_remove_while_playing)
 
 GST_END_TEST;
 
+static gint n_chained;
+
+static GstFlowReturn
+count_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  n_chained++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+count_probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  (*(gint *) data)++;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_ghost_pads_nested_push)
+{
+  GstPad *srcpad, *sinkpad, *ghost1, *ghost2;
+  gint n_probed = 0;
+  gulong id;
+
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, count_chain);
+  ghost1 = gst_ghost_pad_new ("ghost1", sinkpad);
+  ghost2 = gst_ghost_pad_new ("ghost2", ghost1);
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (gst_pad_link (srcpad, ghost2) == GST_PAD_LINK_OK);
+
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (ghost1, TRUE);
+  gst_pad_set_active (ghost2, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+
+  /* without probes the data goes straight to the target */
+  n_chained = 0;
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (n_chained, 1);
+
+  /* a probe on the inner ghost pad is still called */
+  id = gst_pad_add_probe (ghost1, GST_PAD_PROBE_TYPE_BUFFER, count_probe_cb,
+      &n_probed, NULL);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (n_chained, 2);
+  fail_unless_equals_int (n_probed, 1);
+  gst_pad_remove_probe (ghost1, id);
+
+  /* a flushing ghost pad stops the data */
+  gst_pad_set_active (ghost1, FALSE);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_FLUSHING);
+  fail_unless_equals_int (n_chained, 2);
+
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (ghost2, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (ghost2);
+  gst_object_unref (ghost1);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_ghost_pad_suite (void)
 {
@@ -1185,6 +1252,7 @@ gst_ghost_pad_suite (void)
   tcase_add_test (tc_chain, test_ghost_pads_change_when_linked);
   tcase_add_test (tc_chain, test_ghost_pads_internal_link);
   tcase_add_test (tc_chain, test_ghost_pads_remove_while_playing);
+  tcase_add_test (tc_chain, test_ghost_pads_nested_push);
 
   return s;
 }
@@ -240,6 +240,150 @@ GST_START_TEST (info_fixme)
   gst_object_unref (e);
 }
 
+GST_END_TEST;
+
+static volatile gint log_func_running;
+static volatile gint log_func_calls;
+
+static void
+counting_log_func (GstDebugCategory * category, GstDebugLevel level,
+    const gchar * file, const gchar * function, gint line, GObject * object,
+    GstDebugMessage * message, gpointer user_data)
+{
+  g_atomic_int_inc (&log_func_calls);
+}
+
+static gpointer
+log_func_thread (gpointer data)
+{
+  GstDebugCategory *cat = data;
+
+  while (g_atomic_int_get (&log_func_running))
+    GST_CAT_LOG (cat, "logging from a thread");
+
+  return NULL;
+}
+
+GST_START_TEST (info_log_functions_threaded)
+{
+  GstDebugCategory *cat = NULL;
+  GThread *threads[4];
+  gint i;
+
+  GST_DEBUG_CATEGORY_INIT (cat, "threadcat", 0, "threaded log functions");
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+  gst_debug_remove_log_function (gst_debug_log_default);
+
+  g_atomic_int_set (&log_func_running, 1);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("logger", log_func_thread, cat);
+
+  /* the list of log functions is replaced while the threads walk it */
+  for (i = 0; i < 1000; i++) {
+    gst_debug_add_log_function (counting_log_func, NULL, NULL);
+    fail_unless_equals_int (gst_debug_remove_log_function
+        (counting_log_func), 1);
+  }
+
+  gst_debug_add_log_function (counting_log_func, NULL, NULL);
+  g_atomic_int_set (&log_func_calls, 0);
+  while (g_atomic_int_get (&log_func_calls) == 0)
+    g_thread_yield ();
+
+  g_atomic_int_set (&log_func_running, 0);
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    g_thread_join (threads[i]);
+
+  gst_debug_remove_log_function (counting_log_func);
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+  gst_debug_category_reset_threshold (cat);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_ring_buffer_logger)
+{
+  GstDebugCategory *cat = NULL;
+  gchar **logs;
+  gint i;
+
+  GST_DEBUG_CATEGORY_INIT (cat, "ringcat", 0, "ring buffer logger");
+  gst_debug_category_set_threshold (cat, GST_LEVEL_LOG);
+  gst_debug_remove_log_function (gst_debug_log_default);
+
+  gst_debug_add_ring_buffer_logger (1024, 0);
+  for (i = 0; i < 100; i++)
+    GST_CAT_LOG (cat, "message %d", i);
+
+  logs = gst_debug_ring_buffer_logger_get_logs ();
+  fail_unless (logs != NULL);
+  fail_unless_equals_int (g_strv_length (logs), 1);
+  /* only the last messages fit */
+  fail_unless (strstr (logs[0], "message 99\n") != NULL);
+  fail_unless (strstr (logs[0], "message 0\n") == NULL);
+  fail_unless (strstr (logs[0], "ringcat") != NULL);
+  g_strfreev (logs);
+
+  gst_debug_remove_ring_buffer_logger ();
+  GST_CAT_LOG (cat, "not kept");
+  logs = gst_debug_ring_buffer_logger_get_logs ();
+  fail_unless_equals_int (g_strv_length (logs), 0);
+  g_strfreev (logs);
+
+  gst_debug_add_log_function (gst_debug_log_default, NULL, NULL);
+  gst_debug_category_reset_threshold (cat);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (info_threshold_patterns)
+{
+  GstDebugCategory *foobar = NULL, *foobaz = NULL, *other = NULL;
+  GstDebugCategory *late = NULL;
+  GstDebugLevel def = gst_debug_get_default_threshold ();
+
+  GST_DEBUG_CATEGORY_INIT (foobar, "pattfoobar", 0, "pattern test");
+  GST_DEBUG_CATEGORY_INIT (foobaz, "pattfoobaz", 0, "pattern test");
+  GST_DEBUG_CATEGORY_INIT (other, "pattother", 0, "pattern test");
+
+  gst_debug_set_threshold_for_name ("pattfoo*", GST_LEVEL_LOG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobar),
+      GST_LEVEL_LOG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobaz),
+      GST_LEVEL_LOG);
+  fail_unless_equals_int (gst_debug_category_get_threshold (other), def);
+
+  /* newer patterns win */
+  gst_debug_set_threshold_for_name ("pattfoobar", GST_LEVEL_FIXME);
+  gst_debug_set_threshold_for_name ("patt*baz", GST_LEVEL_WARNING);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobar),
+      GST_LEVEL_FIXME);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobaz),
+      GST_LEVEL_WARNING);
+
+  /* new categories get the level of the newest matching pattern */
+  GST_DEBUG_CATEGORY_INIT (late, "pattfoolate", 0, "pattern test");
+  fail_unless_equals_int (gst_debug_category_get_threshold (late),
+      GST_LEVEL_LOG);
+
+  /* older patterns apply again after unsetting */
+  gst_debug_unset_threshold_for_name ("patt*baz");
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobaz),
+      GST_LEVEL_LOG);
+  gst_debug_unset_threshold_for_name ("pattfoo*");
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobaz), def);
+  fail_unless_equals_int (gst_debug_category_get_threshold (late), def);
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobar),
+      GST_LEVEL_FIXME);
+  gst_debug_unset_threshold_for_name ("pattfoobar");
+  fail_unless_equals_int (gst_debug_category_get_threshold (foobar), def);
+
+  gst_debug_category_free (foobar);
+  gst_debug_category_free (foobaz);
+  gst_debug_category_free (other);
+  gst_debug_category_free (late);
+}
+
 GST_END_TEST;
 #endif
 
@@ -258,6 +402,9 @@ gst_info_suite (void)
   tcase_add_test (tc_chain, info_log_handler);
   tcase_add_test (tc_chain, info_dump_mem);
   tcase_add_test (tc_chain, info_fixme);
+  tcase_add_test (tc_chain, info_log_functions_threaded);
+  tcase_add_test (tc_chain, info_ring_buffer_logger);
+  tcase_add_test (tc_chain, info_threshold_patterns);
 #endif
 
   return s;
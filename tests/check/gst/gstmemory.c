@@ -24,6 +24,10 @@
 # include "config.h"
 #endif
 
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
 #ifdef HAVE_VALGRIND_H
 # include <valgrind/valgrind.h>
 #else
@@ -508,6 +512,169 @@ GST_START_TEST (test_map_resize)
 
 GST_END_TEST;
 
+static void
+check_numa_alloc (GstAllocator * allocator, gsize size, gsize align)
+{
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *copy;
+  GstMapInfo info;
+
+  gst_allocation_params_init (&params);
+  params.align = align;
+  params.prefix = 16;
+  params.flags = GST_MEMORY_FLAG_ZERO_PREFIXED;
+
+  mem = gst_allocator_alloc (allocator, size, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+  fail_unless_equals_int (mem->size, size);
+  fail_unless_equals_int (mem->offset, 16);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless (((guintptr) (info.data - 16) & align) == 0);
+  fail_unless ((info.data - 16)[0] == 0);
+  memset (info.data, 0x5a, info.size);
+  gst_memory_unmap (mem, &info);
+
+  sub = gst_memory_share (mem, 1, 10);
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0x5a && info.data[9] == 0x5a);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+
+  copy = gst_memory_copy (mem, 0, -1);
+  fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+  fail_unless_equals_int (info.size, size);
+  fail_unless (info.data[size - 1] == 0x5a);
+  gst_memory_unmap (copy, &info);
+  gst_memory_unref (copy);
+
+  gst_memory_unref (mem);
+}
+
+GST_START_TEST (test_allocated_bytes)
+{
+  GstAllocator *allocator;
+  GstMemory *mem, *sub;
+  gsize before, maxsize;
+
+  allocator = gst_allocator_find (NULL);
+  fail_unless (allocator != NULL);
+  before = gst_allocator_get_allocated_bytes (allocator);
+
+  mem = gst_allocator_alloc (allocator, 100, NULL);
+  gst_memory_get_sizes (mem, NULL, &maxsize);
+  fail_unless_equals_int (gst_allocator_get_allocated_bytes (allocator),
+      before + maxsize);
+
+  /* shared memory is not counted again */
+  sub = gst_memory_share (mem, 10, 20);
+  fail_unless_equals_int (gst_allocator_get_allocated_bytes (allocator),
+      before + maxsize);
+
+  gst_memory_unref (mem);
+  fail_unless_equals_int (gst_allocator_get_allocated_bytes (allocator),
+      before + maxsize);
+  gst_memory_unref (sub);
+  fail_unless_equals_int (gst_allocator_get_allocated_bytes (allocator),
+      before);
+
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_numa_allocator)
+{
+  GstAllocator *allocator;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_SYSMEM_NUMA);
+  fail_unless (allocator != NULL);
+
+  /* small blocks, page sized blocks and huge page sized blocks */
+  check_numa_alloc (allocator, 100, 0);
+  check_numa_alloc (allocator, 256 * 1024, 63);
+  check_numa_alloc (allocator, 256 * 1024, 16383);
+  check_numa_alloc (allocator, 4 * 1024 * 1024, 0);
+  gst_object_unref (allocator);
+
+  /* node 0 always exists */
+  allocator = gst_numa_allocator_new (0);
+  check_numa_alloc (allocator, 256 * 1024, 0);
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+#ifdef HAVE_MMAP
+GST_START_TEST (test_fd_memory)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *imported, *copy;
+  GstMapInfo info;
+  gsize offset;
+  gint fd;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_FD);
+  fail_unless (allocator != NULL);
+
+  gst_allocation_params_init (&params);
+  params.prefix = 16;
+  mem = gst_allocator_alloc (allocator, 1000, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_FD));
+  fail_unless (gst_is_fd_memory (mem));
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless_equals_int (info.size, 1000);
+  memset (info.data, 0x5a, info.size);
+  info.data[100] = 0xa5;
+  gst_memory_unmap (mem, &info);
+
+  fd = gst_fd_memory_get_fd (mem, &offset);
+  fail_unless (fd >= 0);
+  fail_unless_equals_int (offset, 16);
+
+  /* a sub memory uses the same fd at another offset */
+  sub = gst_memory_share (mem, 100, 10);
+  fail_unless (gst_fd_memory_get_fd (sub, &offset) == fd);
+  fail_unless_equals_int (offset, 116);
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0xa5 && info.data[9] == 0x5a);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+
+  /* importing the fd gives access to the same data */
+  imported = gst_fd_allocator_import (allocator, dup (fd), 116, 500);
+  fail_unless (imported != NULL);
+  fail_unless (gst_memory_map (imported, &info, GST_MAP_READWRITE));
+  fail_unless_equals_int (info.size, 500);
+  fail_unless (info.data[0] == 0xa5 && info.data[1] == 0x5a);
+  info.data[1] = 0x11;
+  gst_memory_unmap (imported, &info);
+  gst_memory_unref (imported);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+  fail_unless (info.data[101] == 0x11);
+  gst_memory_unmap (mem, &info);
+
+  /* a copy has its own fd */
+  copy = gst_memory_copy (mem, 100, 10);
+  fail_unless (gst_is_fd_memory (copy));
+  fail_unless (gst_fd_memory_get_fd (copy, NULL) != fd);
+  fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+  fail_unless_equals_int (info.size, 10);
+  fail_unless (info.data[0] == 0xa5 && info.data[1] == 0x11);
+  gst_memory_unmap (copy, &info);
+  gst_memory_unref (copy);
+
+  gst_memory_unref (mem);
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+#endif
 
 static Suite *
 gst_memory_suite (void)
@@ -526,6 +693,11 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_map_nested);
   tcase_add_test (tc_chain, test_map_resize);
+  tcase_add_test (tc_chain, test_numa_allocator);
+  tcase_add_test (tc_chain, test_allocated_bytes);
+#ifdef HAVE_MMAP
+  tcase_add_test (tc_chain, test_fd_memory);
+#endif
 
   return s;
 }
@@ -350,6 +350,46 @@ GST_START_TEST (test_parsing)
 
 GST_END_TEST;
 
+GST_START_TEST (test_reuse)
+{
+  GstMessage *message;
+  GstStructure *s;
+  guint32 seqnum;
+  gint64 jitter;
+  gdouble proportion;
+  gint quality, value;
+
+  message = gst_message_new_qos (NULL, TRUE, 0, 0, 0, 0);
+  seqnum = gst_message_get_seqnum (message);
+  GST_MESSAGE_TIMESTAMP (message) = 10;
+
+  /* still used somewhere else */
+  gst_message_ref (message);
+  fail_if (gst_message_reuse (message));
+  gst_message_unref (message);
+
+  fail_unless (gst_message_reuse (message));
+  fail_unless (gst_message_get_seqnum (message) != seqnum);
+  fail_unless (GST_MESSAGE_TIMESTAMP (message) == GST_CLOCK_TIME_NONE);
+
+  /* the fields are updated in place */
+  gst_message_set_qos_values (message, -10, 0.5, 10);
+  gst_message_parse_qos_values (message, &jitter, &proportion, &quality);
+  fail_unless (jitter == -10);
+  fail_unless (proportion == 0.5);
+  fail_unless_equals_int (quality, 10);
+
+  s = gst_message_writable_structure (message);
+  gst_structure_id_set_int (s, g_quark_from_static_string ("extra"), 5);
+  fail_unless (gst_structure_get_int (gst_message_get_structure (message),
+          "extra", &value));
+  fail_unless_equals_int (value, 5);
+
+  gst_message_unref (message);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_message_suite (void)
 {
@@ -358,6 +398,7 @@ gst_message_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parsing);
+  tcase_add_test (tc_chain, test_reuse);
 
   return s;
 }
@@ -245,6 +245,71 @@ GST_START_TEST (test_meta_locked)
 
 GST_END_TEST;
 
+static gboolean
+foreach_meta_remove_odd (GstBuffer * buffer, GstMeta ** meta,
+    gpointer user_data)
+{
+  if (((GstMetaTest *) * meta)->pts % 2)
+    *meta = NULL;
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_many)
+{
+  static const gchar *tags[] = { NULL };
+  GstBuffer *buffer, *copy;
+  GstMetaTest *meta;
+  GType other_api;
+  gpointer state = NULL;
+  guint i, n;
+
+  other_api = gst_meta_api_type_register ("GstMetaTestOtherAPI", tags);
+
+  buffer = gst_buffer_new_and_alloc (4);
+
+  /* more metas than the buffer keeps inline, the newest one is found */
+  for (i = 0; i < 6; i++) {
+    meta = GST_META_TEST_ADD (buffer);
+    meta->pts = i;
+    meta = GST_META_TEST_GET (buffer);
+    fail_unless (meta != NULL);
+    fail_unless_equals_uint64 (meta->pts, i);
+    fail_unless (gst_buffer_get_meta (buffer, other_api) == NULL);
+  }
+
+  copy = gst_buffer_copy (buffer);
+  n = 0;
+  while (gst_buffer_iterate_meta (copy, &state))
+    n++;
+  fail_unless_equals_int (n, 6);
+  gst_buffer_unref (copy);
+
+  /* remove from the middle of the list */
+  gst_buffer_foreach_meta (buffer, foreach_meta_remove_odd, NULL);
+  state = NULL;
+  n = 0;
+  while ((meta = (GstMetaTest *) gst_buffer_iterate_meta (buffer, &state))) {
+    fail_if (meta->pts % 2);
+    n++;
+  }
+  fail_unless_equals_int (n, 3);
+  meta = GST_META_TEST_GET (buffer);
+  fail_unless_equals_uint64 (meta->pts, 4);
+
+  /* the older metas are found again when the newer ones are removed */
+  for (i = 3; i > 0; i--) {
+    meta = GST_META_TEST_GET (buffer);
+    fail_unless (meta != NULL);
+    fail_unless_equals_uint64 (meta->pts, 2 * (i - 1));
+    fail_unless (gst_buffer_remove_meta (buffer, (GstMeta *) meta));
+  }
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffermeta_suite (void)
 {
@@ -254,6 +319,7 @@ gst_buffermeta_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_meta_test);
   tcase_add_test (tc_chain, test_meta_locked);
+  tcase_add_test (tc_chain, test_meta_many);
 
   return s;
 }
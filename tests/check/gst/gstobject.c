@@ -491,6 +491,56 @@ GST_START_TEST (test_fake_object_has_ancestor)
 
 GST_END_TEST;
 
+static void
+count_deep_notify (GstObject * object, GstObject * orig, GParamSpec * pspec,
+    guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_deep_notify_high_frequency)
+{
+  GstElement *pipeline, *bin, *sink;
+  guint pipeline_count = 0, bin_count = 0;
+
+  pipeline = gst_pipeline_new (NULL);
+  bin = gst_bin_new (NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  gst_bin_add (GST_BIN (bin), sink);
+  gst_bin_add (GST_BIN (pipeline), bin);
+
+  g_signal_connect (pipeline, "deep-notify",
+      G_CALLBACK (count_deep_notify), &pipeline_count);
+  g_signal_connect (bin, "deep-notify",
+      G_CALLBACK (count_deep_notify), &bin_count);
+
+  g_object_notify (G_OBJECT (sink), "last-message");
+  g_object_notify (G_OBJECT (sink), "silent");
+  fail_unless_equals_int (bin_count, 2);
+  fail_unless_equals_int (pipeline_count, 2);
+
+  /* the high frequency property stops at the bin */
+  GST_OBJECT_FLAG_SET (bin, GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY);
+  g_object_notify (G_OBJECT (sink), "last-message");
+  g_object_notify (G_OBJECT (sink), "silent");
+  fail_unless_equals_int (bin_count, 3);
+  fail_unless_equals_int (pipeline_count, 3);
+
+  /* notifications frozen together are all dispatched */
+  GST_OBJECT_FLAG_UNSET (bin, GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY);
+  GST_OBJECT_FLAG_SET (pipeline, GST_OBJECT_FLAG_NO_HIGH_FREQUENCY_NOTIFY);
+  g_object_freeze_notify (G_OBJECT (sink));
+  g_object_notify (G_OBJECT (sink), "last-message");
+  g_object_notify (G_OBJECT (sink), "silent");
+  g_object_thaw_notify (G_OBJECT (sink));
+  fail_unless_equals_int (bin_count, 5);
+  fail_unless_equals_int (pipeline_count, 4);
+
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 /* test: try renaming a parented object, make sure it fails */
 
 static Suite *
@@ -514,6 +564,7 @@ gst_object_suite (void)
   tcase_add_test (tc_chain, test_fake_object_parentage_dispose);
 
   tcase_add_test (tc_chain, test_fake_object_has_ancestor);
+  tcase_add_test (tc_chain, test_deep_notify_high_frequency);
   //tcase_add_checked_fixture (tc_chain, setup, teardown);
 
   return s;
@@ -1120,6 +1120,102 @@ GST_START_TEST (test_pad_probe_remove)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+probe_count_cb (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  gint *count = data;
+
+  (*count)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstFlowReturn
+probe_mask_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_pad_probe_mask)
+{
+  GstPad *src, *sink;
+  gint n_events = 0, n_buffers = 0;
+  gulong id;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, probe_mask_chain);
+  fail_unless (gst_pad_link (src, sink) == GST_PAD_LINK_OK);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  /* an event probe is not called for buffers */
+  gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      probe_count_cb, &n_events, NULL);
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless_equals_int (n_events, 1);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_events, 1);
+
+  /* adding and removing a buffer probe updates the types to check */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER, probe_count_cb,
+      &n_buffers, NULL);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_buffers, 1);
+  gst_pad_remove_probe (src, id);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_buffers, 1);
+  fail_unless_equals_int (n_events, 1);
+
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_sticky_events_pending_only)
+{
+  GstPad *src, *sink;
+  GstSegment seg;
+  gint n_events = 0;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, probe_mask_chain);
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  /* unlinked, the events are stored on the srcpad */
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  gst_pad_push_event (src, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (src, gst_event_new_segment (&seg));
+
+  fail_unless (gst_pad_link (src, sink) == GST_PAD_LINK_OK);
+  gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      probe_count_cb, &n_events, NULL);
+
+  /* both events are forwarded once */
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_events, 2);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_events, 2);
+
+  /* changing the offset only resends the segment */
+  gst_pad_set_offset (src, GST_SECOND);
+  fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()), GST_FLOW_OK);
+  fail_unless_equals_int (n_events, 3);
+
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 static gboolean got_notify;
 
 static void
@@ -1534,6 +1630,58 @@ GST_START_TEST (test_sticky_events)
 
 GST_END_TEST;
 
+GST_START_TEST (test_query_caps_cache)
+{
+  GstPadTemplate *templ;
+  GstCaps *caps, *filter, *filter2, *res1, *res2, *res3, *expected;
+  GstPad *pad;
+
+  caps = gst_caps_from_string ("audio/x-raw, rate = (int) [ 1, 100 ]");
+  templ = gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS, caps);
+  pad = gst_pad_new_from_template (templ, "src");
+
+  /* without a filter the template caps are shared */
+  res1 = gst_pad_query_caps (pad, NULL);
+  fail_unless (res1 == GST_PAD_TEMPLATE_CAPS (templ));
+  gst_caps_unref (res1);
+
+  filter = gst_caps_from_string ("audio/x-raw, rate = (int) 50; video/x-raw");
+  expected = gst_caps_from_string ("audio/x-raw, rate = (int) 50");
+  res1 = gst_pad_query_caps (pad, filter);
+  fail_unless (gst_caps_is_equal (res1, expected));
+  res2 = gst_pad_query_caps (pad, filter);
+  fail_unless (res1 == res2);
+
+  /* an equal filter that is other caps is not looked up */
+  filter2 = gst_caps_copy (filter);
+  res3 = gst_pad_query_caps (pad, filter2);
+  fail_unless (res3 != res1);
+  fail_unless (gst_caps_is_equal (res3, expected));
+  gst_caps_unref (res3);
+
+  /* the cached result is not used when the pad caps are used */
+  gst_pad_use_fixed_caps (pad);
+  gst_pad_set_active (pad, TRUE);
+  gst_pad_push_event (pad, gst_event_new_stream_start ("test"));
+  gst_pad_push_event (pad, gst_event_new_caps (expected));
+  res3 = gst_pad_query_caps (pad, filter);
+  fail_unless (res3 != res1);
+  fail_unless (gst_caps_is_equal (res3, expected));
+  gst_caps_unref (res3);
+
+  gst_caps_unref (res1);
+  gst_caps_unref (res2);
+  gst_caps_unref (filter);
+  gst_caps_unref (filter2);
+  gst_caps_unref (expected);
+  gst_caps_unref (caps);
+  gst_pad_set_active (pad, FALSE);
+  gst_object_unref (pad);
+  gst_object_unref (templ);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_pad_suite (void)
 {
@@ -1564,6 +1712,8 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_block);
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_blocking);
   tcase_add_test (tc_chain, test_pad_probe_remove);
+  tcase_add_test (tc_chain, test_pad_probe_mask);
+  tcase_add_test (tc_chain, test_sticky_events_pending_only);
   tcase_add_test (tc_chain, test_queue_src_caps_notify_linked);
   tcase_add_test (tc_chain, test_queue_src_caps_notify_not_linked);
 #if 0
@@ -1573,6 +1723,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
   tcase_add_test (tc_chain, test_sticky_events);
+  tcase_add_test (tc_chain, test_query_caps_cache);
 
   return s;
 }
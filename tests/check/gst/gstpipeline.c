@@ -574,6 +574,255 @@ GST_START_TEST (test_pipeline_in_pipeline)
 
 GST_END_TEST;
 
+GST_START_TEST (test_position_cache)
+{
+  GstElement *pipeline, *fakesrc, *fakesink;
+  gint64 pos1, pos2;
+
+  pipeline = gst_pipeline_new (NULL);
+  fakesrc = gst_element_factory_make ("fakesrc", NULL);
+  fakesink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (fakesrc, "datarate", 200, "sizetype", 2, NULL);
+  g_object_set (fakesink, "sync", TRUE, NULL);
+
+  gst_bin_add_many (GST_BIN (pipeline), fakesrc, fakesink, NULL);
+  fail_unless (gst_element_link (fakesrc, fakesink));
+
+  fail_unless_equals_uint64 (gst_pipeline_get_position_cache_time
+      (GST_PIPELINE (pipeline)), 0);
+  g_object_set (pipeline, "position-cache-time", 10 * GST_SECOND, NULL);
+  fail_unless_equals_uint64 (gst_pipeline_get_position_cache_time
+      (GST_PIPELINE (pipeline)), 10 * GST_SECOND);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  /* the first query goes to the sink, the second one is answered from the
+   * cache and does not advance in PAUSED */
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos1));
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos2));
+  fail_unless_equals_int64 (pos1, pos2);
+
+  /* other formats are never cached */
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_BYTES,
+          &pos2));
+
+  /* in PLAYING the cached position advances with the clock */
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING) !=
+      GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos1));
+  g_usleep (G_USEC_PER_SEC / 10);
+  fail_unless (gst_element_query_position (pipeline, GST_FORMAT_TIME, &pos2));
+  fail_unless (pos2 >= pos1 + GST_SECOND / 10);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_snapshot)
+{
+  GstElement *pipeline, *restored, *src, *filter;
+  GstStructure *snapshot, *parsed;
+  GstCaps *caps;
+  GstPad *pad;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *str;
+  gint num_buffers = 0;
+
+  pipeline = gst_parse_launch ("fakesrc name=src num-buffers=3 ! "
+      "capsfilter name=filter caps=foo/bar ! fakesink name=sink", NULL);
+  fail_unless (pipeline != NULL);
+
+  bus = gst_element_get_bus (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  snapshot = gst_pipeline_snapshot (GST_PIPELINE (pipeline));
+  fail_unless (snapshot != NULL);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* the snapshot survives being stored as a string */
+  str = gst_structure_to_string (snapshot);
+  parsed = gst_structure_from_string (str, NULL);
+  g_free (str);
+  gst_structure_free (snapshot);
+  fail_unless (parsed != NULL);
+
+  restored = gst_pipeline_new_from_snapshot (parsed, NULL);
+  gst_structure_free (parsed);
+  fail_unless (restored != NULL);
+  fail_unless (GST_IS_PIPELINE (restored));
+
+  src = gst_bin_get_by_name (GST_BIN (restored), "src");
+  fail_unless (src != NULL);
+  g_object_get (src, "num-buffers", &num_buffers, NULL);
+  fail_unless_equals_int (num_buffers, 3);
+
+  /* before data flows, the caps of the link come from the snapshot */
+  pad = gst_element_get_static_pad (src, "src");
+  caps = gst_pad_peer_query_caps (pad, NULL);
+  str = gst_caps_to_string (caps);
+  fail_unless_equals_string (str, "foo/bar");
+  g_free (str);
+  gst_caps_unref (caps);
+  gst_object_unref (pad);
+  gst_object_unref (src);
+
+  filter = gst_bin_get_by_name (GST_BIN (restored), "filter");
+  fail_unless (filter != NULL);
+  gst_object_unref (filter);
+
+  bus = gst_element_get_bus (restored);
+  gst_element_set_state (restored, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (restored, GST_STATE_NULL);
+  gst_object_unref (restored);
+}
+
+GST_END_TEST;
+
+/* the snapshot doesn't wait for the data held by the queue */
+GST_START_TEST (test_snapshot_prerolled)
+{
+  GstElement *pipeline;
+  GstStructure *snapshot;
+  const GstStructure *link;
+  const GValue *links;
+  guint i;
+  gboolean found = FALSE;
+
+  pipeline = gst_parse_launch ("fakesrc ! capsfilter name=filter "
+      "caps=foo/bar ! queue ! fakesink", NULL);
+  fail_unless (pipeline != NULL);
+  g_object_set (pipeline, "snapshot-tracking", TRUE, NULL);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  snapshot = gst_pipeline_snapshot (GST_PIPELINE (pipeline));
+  fail_unless (snapshot != NULL);
+
+  links = gst_structure_get_value (snapshot, "links");
+  fail_unless (links != NULL);
+  for (i = 0; i < gst_value_array_get_size (links); i++) {
+    link = gst_value_get_structure (gst_value_array_get_value (links, i));
+    if (!g_strcmp0 (gst_structure_get_string (link, "src"), "filter")) {
+      fail_unless_equals_string (gst_structure_get_string (link, "caps"),
+          "foo/bar");
+      fail_unless (gst_structure_has_field (link, "allocation"));
+      found = TRUE;
+    }
+  }
+  fail_unless (found);
+  gst_structure_free (snapshot);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* the pads only get a probe while the pipeline records */
+GST_START_TEST (test_snapshot_tracking)
+{
+  GstElement *pipeline, *src;
+  GstPad *pad;
+  gboolean tracking = TRUE;
+
+  pipeline = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("fakesrc", NULL);
+  gst_object_ref (src);
+  pad = gst_element_get_static_pad (src, "src");
+
+  g_object_get (pipeline, "snapshot-tracking", &tracking, NULL);
+  fail_if (tracking);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src));
+  fail_unless_equals_int (pad->num_probes, 0);
+
+  /* the children that are already in the pipeline are tracked too */
+  g_object_set (pipeline, "snapshot-tracking", TRUE, NULL);
+  fail_unless_equals_int (pad->num_probes, 1);
+  g_object_set (pipeline, "snapshot-tracking", TRUE, NULL);
+  fail_unless_equals_int (pad->num_probes, 1);
+
+  /* an element that leaves the pipeline is not tracked anymore */
+  fail_unless (gst_bin_remove (GST_BIN (pipeline), src));
+  fail_unless_equals_int (pad->num_probes, 0);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src));
+  fail_unless_equals_int (pad->num_probes, 1);
+
+  g_object_set (pipeline, "snapshot-tracking", FALSE, NULL);
+  fail_unless_equals_int (pad->num_probes, 0);
+  fail_unless (gst_bin_remove (GST_BIN (pipeline), src));
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src));
+  fail_unless_equals_int (pad->num_probes, 0);
+
+  gst_object_unref (pad);
+  gst_object_unref (src);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static void
+check_snapshot_error (GstStructure * snapshot, gint code)
+{
+  GError *err = NULL;
+
+  fail_unless (gst_pipeline_new_from_snapshot (snapshot, &err) == NULL);
+  fail_unless (err != NULL);
+  fail_unless (err->domain == GST_PARSE_ERROR);
+  fail_unless_equals_int (err->code, code);
+  g_error_free (err);
+  gst_structure_free (snapshot);
+}
+
+GST_START_TEST (test_snapshot_invalid)
+{
+  GstStructure *snapshot;
+  GValue elements = { 0, };
+  GValue links = { 0, };
+  GValue element = { 0, };
+
+  check_snapshot_error (gst_structure_new_empty ("foo"),
+      GST_PARSE_ERROR_SYNTAX);
+
+  g_value_init (&elements, GST_TYPE_ARRAY);
+  g_value_init (&links, GST_TYPE_ARRAY);
+  g_value_init (&element, GST_TYPE_STRUCTURE);
+  g_value_take_boxed (&element, gst_structure_new ("no-such-factory",
+          "name", G_TYPE_STRING, "element", NULL));
+  gst_value_array_append_value (&elements, &element);
+  g_value_unset (&element);
+
+  snapshot = gst_structure_new ("pipeline-snapshot",
+      "version", G_TYPE_INT, 1, NULL);
+  gst_structure_take_value (snapshot, "elements", &elements);
+  gst_structure_take_value (snapshot, "links", &links);
+  check_snapshot_error (snapshot, GST_PARSE_ERROR_NO_SUCH_ELEMENT);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_pipeline_suite (void)
 {
@@ -591,6 +840,11 @@ gst_pipeline_suite (void)
   tcase_add_test (tc_chain, test_base_time);
   tcase_add_test (tc_chain, test_concurrent_create);
   tcase_add_test (tc_chain, test_pipeline_in_pipeline);
+  tcase_add_test (tc_chain, test_position_cache);
+  tcase_add_test (tc_chain, test_snapshot);
+  tcase_add_test (tc_chain, test_snapshot_prerolled);
+  tcase_add_test (tc_chain, test_snapshot_tracking);
+  tcase_add_test (tc_chain, test_snapshot_invalid);
 
   return s;
 }
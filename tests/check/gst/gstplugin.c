@@ -113,6 +113,41 @@ GST_START_TEST (test_load_coreelements)
 
 GST_END_TEST;
 
+GST_START_TEST (test_load_stats)
+{
+  GstPlugin *plugin, *loaded;
+  GstClockTime open_time, init_time;
+  gsize registry_size;
+
+  /* a static plugin has no module and is not in the registry cache */
+  fail_unless (gst_plugin_register_static (GST_VERSION_MAJOR,
+          GST_VERSION_MINOR, "stats-elements", "stats-elements",
+          register_check_elements, VERSION, GST_LICENSE, PACKAGE,
+          GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN));
+  plugin = gst_registry_find_plugin (gst_registry_get (), "stats-elements");
+  fail_unless (plugin != NULL);
+  fail_unless (gst_plugin_get_load_stats (plugin, &open_time, &init_time,
+          &registry_size));
+  fail_unless_equals_uint64 (open_time, 0);
+  fail_unless (GST_CLOCK_TIME_IS_VALID (init_time));
+  fail_unless_equals_int (registry_size, 0);
+  gst_object_unref (plugin);
+
+  plugin = gst_registry_find_plugin (gst_registry_get (), "coreelements");
+  fail_unless (plugin != NULL);
+  loaded = gst_plugin_load (plugin);
+  fail_unless (loaded != NULL);
+  fail_unless (gst_plugin_get_load_stats (loaded, &open_time, &init_time,
+          &registry_size));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (open_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (init_time));
+  fail_unless (registry_size > 0);
+  gst_object_unref (loaded);
+  gst_object_unref (plugin);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_registry_get_plugin_list)
 {
   GList *list;
@@ -320,6 +355,7 @@ gst_plugin_suite (void)
   tcase_add_test (tc_chain, test_register_static);
   tcase_add_test (tc_chain, test_registry);
   tcase_add_test (tc_chain, test_load_coreelements);
+  tcase_add_test (tc_chain, test_load_stats);
   tcase_add_test (tc_chain, test_registry_get_plugin_list);
   tcase_add_test (tc_chain, test_find_plugin);
   tcase_add_test (tc_chain, test_find_feature);
@@ -98,6 +98,72 @@ GST_START_TEST (test_poll_wait)
 
 GST_END_TEST;
 
+#define N_SOCKS 64
+
+GST_START_TEST (test_poll_many_fds)
+{
+  GstPoll *set;
+  GstPollFD rfds[N_SOCKS];
+  gint socks[N_SOCKS][2];
+  guchar c = 'A';
+  gint i;
+
+  set = gst_poll_new (FALSE);
+  fail_if (set == NULL, "Failed to create a GstPoll");
+
+  for (i = 0; i < N_SOCKS; i++) {
+#ifdef G_OS_WIN32
+    fail_if (_pipe (socks[i], 4096, _O_BINARY) < 0, "Could not create a pipe");
+#else
+    fail_if (socketpair (PF_UNIX, SOCK_STREAM, 0, socks[i]) < 0,
+        "Could not create a pipe");
+#endif
+    gst_poll_fd_init (&rfds[i]);
+    rfds[i].fd = socks[i][0];
+    fail_unless (gst_poll_add_fd (set, &rfds[i]));
+    fail_unless (gst_poll_fd_ctl_read (set, &rfds[i], TRUE));
+  }
+
+  /* make every 8th descriptor readable */
+  for (i = 0; i < N_SOCKS; i += 8)
+    fail_unless (write (socks[i][1], &c, 1) == 1, "write() failed");
+
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE),
+      N_SOCKS / 8);
+  for (i = 0; i < N_SOCKS; i++)
+    fail_unless_equals_int (gst_poll_fd_can_read (set, &rfds[i]), i % 8 == 0);
+
+  /* removing descriptors changes the layout of the set, the results must
+   * still be reported for the right descriptors */
+  for (i = 0; i < N_SOCKS; i += 8) {
+    fail_unless (read (socks[i][0], &c, 1) == 1, "read() failed");
+    fail_unless (gst_poll_remove_fd (set, &rfds[i]));
+  }
+  for (i = 1; i < N_SOCKS; i += 8)
+    fail_unless (write (socks[i][1], &c, 1) == 1, "write() failed");
+
+  fail_unless_equals_int (gst_poll_wait (set, GST_CLOCK_TIME_NONE),
+      N_SOCKS / 8);
+  for (i = 0; i < N_SOCKS; i++) {
+    if (i % 8 == 0)
+      continue;
+    fail_unless_equals_int (gst_poll_fd_can_read (set, &rfds[i]), i % 8 == 1);
+  }
+
+  /* disabling read interest stops reporting */
+  for (i = 1; i < N_SOCKS; i += 8)
+    fail_unless (gst_poll_fd_ctl_read (set, &rfds[i], FALSE));
+  fail_unless_equals_int (gst_poll_wait (set, 10 * GST_MSECOND), 0);
+
+  gst_poll_free (set);
+  for (i = 0; i < N_SOCKS; i++) {
+    close (socks[i][0]);
+    close (socks[i][1]);
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_poll_basic)
 {
   GstPoll *set;
@@ -329,6 +395,7 @@ gst_poll_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_poll_basic);
   tcase_add_test (tc_chain, test_poll_wait);
+  tcase_add_test (tc_chain, test_poll_many_fds);
   tcase_add_test (tc_chain, test_poll_wait_stop);
   tcase_add_test (tc_chain, test_poll_wait_restart);
   tcase_add_test (tc_chain, test_poll_wait_flush);
@@ -29,6 +29,7 @@
 #include <gst/check/gstcheck.h>
 
 #include <unistd.h>
+#include <utime.h>
 
 static GType gst_preset_test_get_type (void);
 
@@ -242,6 +243,58 @@ GST_START_TEST (test_two_instances)
 
 GST_END_TEST;
 
+GST_START_TEST (test_file_changed)
+{
+  GstElement *elem;
+  GKeyFile *in;
+  GStatBuf buf;
+  struct utimbuf times;
+  gchar *preset_file_name, *data;
+  gsize data_size;
+  gboolean res;
+  gint val;
+
+  elem = gst_element_factory_make (GST_PRESET_TEST_NAME, NULL);
+  g_object_set (elem, "test", 5, NULL);
+  res = gst_preset_save_preset (GST_PRESET (elem), "test");
+  fail_unless (res);
+
+  /* load it once, so that the values are cached */
+  g_object_set (elem, "test", 0, NULL);
+  res = gst_preset_load_preset (GST_PRESET (elem), "test");
+  fail_unless (res);
+  g_object_get (elem, "test", &val, NULL);
+  fail_unless_equals_int (val, 5);
+
+  /* change the file behind the back of the element */
+  preset_file_name = g_build_filename (g_get_user_data_dir (),
+      "gstreamer-" GST_API_VERSION, "presets", "GstPresetTest.prs", NULL);
+  in = g_key_file_new ();
+  fail_unless (g_key_file_load_from_file (in, preset_file_name,
+          G_KEY_FILE_KEEP_COMMENTS, NULL));
+  g_key_file_set_integer (in, "test", "test", 17);
+  data = g_key_file_to_data (in, &data_size, NULL);
+  fail_unless (g_file_set_contents (preset_file_name, data, data_size, NULL));
+  g_free (data);
+  g_key_file_free (in);
+
+  /* make sure the mtime differs even on filesystems with a low resolution */
+  fail_unless (g_stat (preset_file_name, &buf) == 0);
+  times.actime = buf.st_atime;
+  times.modtime = buf.st_mtime + 10;
+  fail_unless (g_utime (preset_file_name, &times) == 0);
+  g_free (preset_file_name);
+
+  res = gst_preset_load_preset (GST_PRESET (elem), "test");
+  fail_unless (res);
+  g_object_get (elem, "test", &val, NULL);
+  fail_unless_equals_int (val, 17);
+
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 
 static void
 remove_preset_file (void)
@@ -294,6 +347,7 @@ gst_preset_suite (void)
     tcase_add_test (tc, test_add);
     tcase_add_test (tc, test_del);
     tcase_add_test (tc, test_two_instances);
+    tcase_add_test (tc, test_file_changed);
   }
   tcase_add_unchecked_fixture (tc, test_setup, test_teardown);
 
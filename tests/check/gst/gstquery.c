@@ -276,6 +276,90 @@ GST_START_TEST (test_queries)
 
 GST_END_TEST;
 
+GST_START_TEST (test_query_reuse)
+{
+  GstQuery *query;
+  GstFormat format;
+  gint64 cur;
+  gboolean live;
+  GstClockTime min, max;
+  gint i;
+
+  /* values of a freed query must not show up in a new query */
+  for (i = 0; i < 2; i++) {
+    query = gst_query_new_position (i ? GST_FORMAT_TIME : GST_FORMAT_BYTES);
+    gst_query_parse_position (query, &format, &cur);
+    fail_unless_equals_int (format, i ? GST_FORMAT_TIME : GST_FORMAT_BYTES);
+    fail_unless_equals_int64 (cur, -1);
+    gst_query_set_position (query, format, 10);
+    gst_query_unref (query);
+
+    query = gst_query_new_duration (GST_FORMAT_TIME);
+    gst_query_parse_duration (query, &format, &cur);
+    fail_unless_equals_int64 (cur, -1);
+    gst_query_set_duration (query, GST_FORMAT_TIME, 20);
+    gst_query_unref (query);
+
+    query = gst_query_new_latency ();
+    gst_query_parse_latency (query, &live, &min, &max);
+    fail_unless (live == FALSE);
+    fail_unless_equals_uint64 (min, 0);
+    fail_unless_equals_uint64 (max, GST_CLOCK_TIME_NONE);
+    gst_query_set_latency (query, TRUE, GST_SECOND, GST_SECOND);
+    gst_query_unref (query);
+  }
+
+  /* a query with extra fields is not reused */
+  query = gst_query_new_position (GST_FORMAT_TIME);
+  gst_structure_set (gst_query_writable_structure (query), "extra",
+      G_TYPE_INT, 1, NULL);
+  gst_query_unref (query);
+  query = gst_query_new_position (GST_FORMAT_TIME);
+  fail_unless_equals_int (gst_structure_n_fields (gst_query_get_structure
+          (query)), 2);
+  gst_query_unref (query);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_memory_usage_query)
+{
+  GstQuery *query;
+  GstObject *obj1, *obj2;
+  guint64 allocated, queued;
+  gchar *owner;
+
+  obj1 = GST_OBJECT (gst_bin_new ("obj1"));
+  obj2 = GST_OBJECT (gst_bin_new ("obj2"));
+
+  query = gst_query_new_memory_usage ();
+  fail_unless (GST_QUERY_TYPE (query) == GST_QUERY_MEMORY_USAGE);
+  fail_unless_equals_int (gst_query_get_n_memory_usages (query), 0);
+  gst_query_parse_memory_usage (query, &allocated, &queued);
+  fail_unless_equals_uint64 (allocated, 0);
+  fail_unless_equals_uint64 (queued, 0);
+
+  gst_query_add_memory_usage (query, obj1, 1000, 10);
+  gst_query_add_memory_usage (query, obj2, 2000, 20);
+  fail_unless_equals_int (gst_query_get_n_memory_usages (query), 2);
+
+  gst_query_parse_nth_memory_usage (query, 1, &owner, &allocated, &queued);
+  fail_unless_equals_string (owner, "/obj2");
+  fail_unless_equals_uint64 (allocated, 2000);
+  fail_unless_equals_uint64 (queued, 20);
+  g_free (owner);
+
+  gst_query_parse_memory_usage (query, &allocated, &queued);
+  fail_unless_equals_uint64 (allocated, 3000);
+  fail_unless_equals_uint64 (queued, 30);
+  gst_query_unref (query);
+
+  gst_object_unref (obj1);
+  gst_object_unref (obj2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_query_suite (void)
 {
@@ -287,6 +371,8 @@ gst_query_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, create_queries);
   tcase_add_test (tc_chain, test_queries);
+  tcase_add_test (tc_chain, test_query_reuse);
+  tcase_add_test (tc_chain, test_memory_usage_query);
   return s;
 }
 
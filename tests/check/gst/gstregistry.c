@@ -40,6 +40,12 @@ plugin_ptr_cmp (GstPlugin * a, GstPlugin * b)
   return (a == b) ? 0 : 1;
 }
 
+static gint
+feature_name_cmp (GstPluginFeature * feature, const gchar * name)
+{
+  return strcmp (GST_OBJECT_NAME (feature), name);
+}
+
 static void
 print_plugin (const gchar * marker, GstRegistry * registry, GstPlugin * plugin)
 {
@@ -203,6 +209,117 @@ GST_START_TEST (test_registry_update)
 
 GST_END_TEST;
 
+GST_START_TEST (test_lazy_features)
+{
+  GstRegistry *registry;
+  GstPluginFeature *feature;
+  GstElementFactory *factory;
+  GList *list;
+
+  registry = gst_registry_get ();
+
+  /* the features are created when they are looked up */
+  feature = gst_registry_lookup_feature (registry, "identity");
+  fail_unless (feature != NULL);
+  fail_unless (GST_IS_ELEMENT_FACTORY (feature));
+  fail_unless_equals_string (gst_plugin_feature_get_plugin_name (feature),
+      "coreelements");
+  gst_object_unref (feature);
+
+  fail_unless (gst_registry_lookup_feature (registry, "foo-bar-baz") == NULL);
+
+  factory = gst_element_factory_find ("fakesrc");
+  fail_unless (factory != NULL);
+  fail_unless (gst_element_factory_get_num_pad_templates (factory) == 1);
+  gst_object_unref (factory);
+
+  /* and all of them when they are listed */
+  list = gst_registry_get_feature_list (registry, GST_TYPE_ELEMENT_FACTORY);
+  fail_unless (g_list_find_custom (list, "queue",
+          (GCompareFunc) feature_name_cmp) != NULL);
+  gst_plugin_feature_list_free (list);
+
+  feature = gst_registry_lookup_feature (registry, "queue");
+  fail_unless (feature != NULL);
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_template_caps)
+{
+  GList *list, *walk;
+  const GList *templates;
+
+  /* templates loaded from the registry cache are created from their binary
+   * form, they must be the same as when the string is parsed */
+  list = gst_registry_get_feature_list (gst_registry_get (),
+      GST_TYPE_ELEMENT_FACTORY);
+  for (walk = list; walk; walk = walk->next) {
+    templates = gst_element_factory_get_static_pad_templates (walk->data);
+    for (; templates; templates = templates->next) {
+      GstStaticPadTemplate *templ = templates->data;
+      GstCaps *caps, *parsed;
+
+      caps = gst_static_caps_get (&templ->static_caps);
+      parsed = gst_caps_from_string (templ->static_caps.string);
+      fail_unless (caps != NULL && parsed != NULL);
+      fail_unless (gst_caps_is_strictly_equal (caps, parsed),
+          "template %s of %s differs", templ->name_template,
+          GST_OBJECT_NAME (walk->data));
+      gst_caps_unref (parsed);
+      gst_caps_unref (caps);
+    }
+  }
+  gst_plugin_feature_list_free (list);
+}
+
+GST_END_TEST;
+
+static gpointer
+lookup_thread (gpointer data)
+{
+  static const gchar *names[] = { "identity", "queue", "fakesrc", "fakesink" };
+  GstRegistry *registry = gst_registry_get ();
+  gint i, failed = 0;
+
+  for (i = 0; i < 1000; i++) {
+    GstPluginFeature *feature;
+
+    feature = gst_registry_lookup_feature (registry,
+        names[(i + GPOINTER_TO_INT (data)) % G_N_ELEMENTS (names)]);
+    if (feature == NULL)
+      failed++;
+    else
+      gst_object_unref (feature);
+  }
+
+  return GINT_TO_POINTER (failed);
+}
+
+GST_START_TEST (test_concurrent_lookups)
+{
+  GThread *threads[4];
+  GList *list;
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    threads[i] = g_thread_new ("lookup", lookup_thread, GINT_TO_POINTER (i));
+
+  /* list the features while the other threads look them up */
+  for (i = 0; i < 20; i++) {
+    list = gst_registry_get_feature_list (gst_registry_get (),
+        GST_TYPE_ELEMENT_FACTORY);
+    fail_unless (list != NULL);
+    gst_plugin_feature_list_free (list);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (threads[i])), 0);
+}
+
+GST_END_TEST;
+
 static Suite *
 registry_suite (void)
 {
@@ -212,8 +329,25 @@ registry_suite (void)
   suite_add_tcase (s, tc_chain);
 
   tcase_add_test (tc_chain, test_registry_update);
+  tcase_add_test (tc_chain, test_lazy_features);
+  tcase_add_test (tc_chain, test_template_caps);
+  tcase_add_test (tc_chain, test_concurrent_lookups);
 
   return s;
 }
 
-GST_CHECK_MAIN (registry);
+int
+main (int argc, char **argv)
+{
+  Suite *s;
+
+  /* read the registry cache written by the other tests without creating the
+   * features */
+  g_setenv ("GST_REGISTRY_LAZY", "yes", TRUE);
+
+  gst_check_init (&argc, &argv);
+
+  s = registry_suite ();
+
+  return gst_check_run_suite (s, "registry", __FILE__);
+}
@@ -179,6 +179,57 @@ GST_START_TEST (test_from_string)
 GST_END_TEST;
 
 
+GST_START_TEST (test_from_string_untyped)
+{
+  GstStructure *structure;
+  const GValue *val;
+  gint i;
+  struct
+  {
+    const gchar *field;
+    GType type;
+  } fields[] = {
+    {
+    "a", G_TYPE_INT}, {
+    "b", G_TYPE_INT}, {
+    "c", G_TYPE_DOUBLE}, {
+    "d", G_TYPE_DOUBLE}, {
+    "e", GST_TYPE_FRACTION}, {
+    "f", G_TYPE_BOOLEAN}, {
+    "g", G_TYPE_STRING}, {
+    "h", G_TYPE_INT}, {
+    "i", G_TYPE_DOUBLE}, {
+    "j", G_TYPE_STRING}
+  };
+
+  /* the types of untyped values are guessed */
+  structure = gst_structure_from_string ("s, a=1, b=MAX, c=1.5, d=inf, "
+      "e=25/1, f=true, g=I420, h=big_endian, i=-inf, j=maximum", NULL);
+  fail_unless (structure != NULL);
+  for (i = 0; i < G_N_ELEMENTS (fields); i++) {
+    val = gst_structure_get_value (structure, fields[i].field);
+    fail_unless (val != NULL);
+    fail_unless (G_VALUE_TYPE (val) == fields[i].type,
+        "field %s has type %s", fields[i].field, G_VALUE_TYPE_NAME (val));
+  }
+  fail_unless_equals_string (gst_structure_get_string (structure, "g"),
+      "I420");
+  gst_structure_free (structure);
+
+  /* the same for the values in lists */
+  structure = gst_structure_from_string ("s, l={ I420, 1, max }", NULL);
+  fail_unless (structure != NULL);
+  val = gst_structure_get_value (structure, "l");
+  fail_unless (GST_VALUE_HOLDS_LIST (val));
+  fail_unless (G_VALUE_TYPE (gst_value_list_get_value (val,
+              0)) == G_TYPE_STRING);
+  fail_unless (G_VALUE_TYPE (gst_value_list_get_value (val, 1)) == G_TYPE_INT);
+  fail_unless (G_VALUE_TYPE (gst_value_list_get_value (val, 2)) == G_TYPE_INT);
+  gst_structure_free (structure);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_to_string)
 {
   GstStructure *st1;
@@ -607,6 +658,207 @@ GST_START_TEST (test_vararg_getters)
 
 GST_END_TEST;
 
+GST_START_TEST (test_large_structure)
+{
+  GstStructure *s, *copy;
+  gchar name[32];
+  gint i, val;
+
+  /* enough fields to use the field index */
+  s = gst_structure_new_empty ("test/large");
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_set (s, name, G_TYPE_INT, i, NULL);
+    /* lookups in between the additions */
+    fail_unless (gst_structure_get_int (s, "field0", &val));
+    fail_unless_equals_int (val, 0);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    fail_unless (gst_structure_get_int (s, name, &val));
+    fail_unless_equals_int (val, i);
+  }
+  fail_if (gst_structure_has_field (s, "field100"));
+
+  /* replacing keeps the number of fields */
+  gst_structure_set (s, "field50", G_TYPE_INT, 500, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 100);
+  fail_unless (gst_structure_get_int (s, "field50", &val));
+  fail_unless_equals_int (val, 500);
+
+  /* removing moves the fields behind it */
+  for (i = 0; i < 100; i += 2) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    gst_structure_remove_field (s, name);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 50);
+  for (i = 0; i < 100; i++) {
+    g_snprintf (name, sizeof (name), "field%d", i);
+    fail_unless_equals_int (gst_structure_has_field (s, name), i % 2);
+  }
+
+  copy = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, copy));
+  fail_unless (gst_structure_get_int (copy, "field99", &val));
+  fail_unless_equals_int (val, 99);
+  gst_structure_free (copy);
+
+  gst_structure_remove_all_fields (s);
+  fail_unless_equals_int (gst_structure_n_fields (s), 0);
+  fail_if (gst_structure_has_field (s, "field1"));
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_to_from_binary)
+{
+  GstStructure *s, *outer, *res;
+  GValue list = { 0, }, v = {
+  0,};
+  GstBuffer *buf;
+  GDate *date;
+  guint8 *data;
+  gsize size, i;
+
+  buf = gst_buffer_new_allocate (NULL, 4, NULL);
+  gst_buffer_memset (buf, 0, 0xaa, 4);
+  s = gst_structure_new ("test/binary",
+      "b", G_TYPE_BOOLEAN, TRUE,
+      "i", G_TYPE_INT, -5,
+      "u", G_TYPE_UINT, 300,
+      "i64", G_TYPE_INT64, G_MININT64,
+      "u64", G_TYPE_UINT64, G_MAXUINT64,
+      "null", G_TYPE_STRING, NULL,
+      "f", G_TYPE_FLOAT, 0.5f,
+      "d", G_TYPE_DOUBLE, -1.25,
+      "str", G_TYPE_STRING, "hello \"world\"",
+      "frac", GST_TYPE_FRACTION, 30000, 1001,
+      "range", GST_TYPE_INT_RANGE, 1, 100,
+      "frange", GST_TYPE_FRACTION_RANGE, 0, 1, 60, 1,
+      "state", GST_TYPE_STATE, GST_STATE_PAUSED,
+      "flags", GST_TYPE_BUFFER_FLAGS, GST_BUFFER_FLAG_DISCONT,
+      "buf", GST_TYPE_BUFFER, buf, NULL);
+  gst_buffer_unref (buf);
+
+  g_value_init (&list, GST_TYPE_LIST);
+  g_value_init (&v, G_TYPE_STRING);
+  g_value_set_string (&v, "I420");
+  gst_value_list_append_value (&list, &v);
+  g_value_set_string (&v, "YV12");
+  gst_value_list_append_value (&list, &v);
+  g_value_unset (&v);
+  gst_structure_take_value (s, "list", &list);
+
+  /* a date goes through the string serialization */
+  date = g_date_new_dmy (1, 2, 2013);
+  gst_structure_set (s, "date", G_TYPE_DATE, date, NULL);
+  g_date_free (date);
+
+  data = gst_structure_to_binary (s, &size);
+  fail_unless (data != NULL);
+  res = gst_structure_from_binary (data, size);
+  fail_unless (res != NULL);
+  fail_unless (gst_structure_is_equal (s, res));
+  gst_structure_free (res);
+
+  /* truncated and corrupted data is rejected */
+  for (i = 0; i < size; i++)
+    fail_unless (gst_structure_from_binary (data, i) == NULL);
+  data[3]++;
+  fail_unless (gst_structure_from_binary (data, size) == NULL);
+  g_free (data);
+
+  /* the kind of the data is checked */
+  g_value_init (&v, GST_TYPE_STRUCTURE);
+  gst_value_set_structure (&v, s);
+  data = gst_value_serialize_binary (&v, &size);
+  g_value_unset (&v);
+  fail_unless (data != NULL);
+  fail_unless (gst_structure_from_binary (data, size) == NULL);
+  fail_unless (gst_value_deserialize_binary (&v, data, size));
+  fail_unless (GST_VALUE_HOLDS_STRUCTURE (&v));
+  fail_unless (gst_structure_is_equal (s, gst_value_get_structure (&v)));
+  g_value_unset (&v);
+  g_free (data);
+
+  /* nested structures */
+  outer = gst_structure_new ("outer", "nested", GST_TYPE_STRUCTURE, s, NULL);
+  data = gst_structure_to_binary (outer, &size);
+  fail_unless (data != NULL);
+  res = gst_structure_from_binary (data, size);
+  fail_unless (res != NULL);
+  fail_unless (gst_structure_is_equal (s,
+          gst_value_get_structure (gst_structure_get_value (res, "nested"))));
+  gst_structure_free (res);
+  gst_structure_free (outer);
+  g_free (data);
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_typed_setters)
+{
+  GstStructure *s;
+  GQuark q_int = g_quark_from_static_string ("int");
+  GQuark q_str = g_quark_from_static_string ("str");
+  gint i;
+  guint u;
+  gint64 i64;
+  guint64 u64;
+  gdouble d;
+  gboolean b;
+  GstFormat format;
+
+  s = gst_structure_new ("test", "str", G_TYPE_STRING, "hello", NULL);
+
+  /* new fields are added */
+  gst_structure_id_set_int (s, q_int, -5);
+  gst_structure_id_set_uint (s, g_quark_from_static_string ("uint"), 5);
+  gst_structure_id_set_int64 (s, g_quark_from_static_string ("int64"),
+      G_MININT64);
+  gst_structure_id_set_uint64 (s, g_quark_from_static_string ("uint64"),
+      G_MAXUINT64);
+  gst_structure_id_set_double (s, g_quark_from_static_string ("double"), 0.5);
+  gst_structure_id_set_boolean (s, g_quark_from_static_string ("boolean"),
+      TRUE);
+  gst_structure_id_set_enum (s, g_quark_from_static_string ("format"),
+      GST_TYPE_FORMAT, GST_FORMAT_TIME);
+  fail_unless_equals_int (gst_structure_n_fields (s), 8);
+
+  fail_unless (gst_structure_get (s, "int", G_TYPE_INT, &i,
+          "uint", G_TYPE_UINT, &u, "int64", G_TYPE_INT64, &i64,
+          "uint64", G_TYPE_UINT64, &u64, "double", G_TYPE_DOUBLE, &d,
+          "boolean", G_TYPE_BOOLEAN, &b, NULL));
+  fail_unless_equals_int (i, -5);
+  fail_unless_equals_int (u, 5);
+  fail_unless (i64 == G_MININT64);
+  fail_unless (u64 == G_MAXUINT64);
+  fail_unless (d == 0.5);
+  fail_unless (b);
+  fail_unless (gst_structure_get_enum (s, "format", GST_TYPE_FORMAT,
+          (gint *) & format));
+  fail_unless_equals_int (format, GST_FORMAT_TIME);
+
+  /* existing fields are updated, also when the type changes */
+  gst_structure_id_set_int (s, q_int, 10);
+  gst_structure_id_set_int (s, q_str, 20);
+  fail_unless_equals_int (gst_structure_n_fields (s), 8);
+  fail_unless (gst_structure_get_int (s, "int", &i));
+  fail_unless_equals_int (i, 10);
+  fail_unless (gst_structure_get_int (s, "str", &i));
+  fail_unless_equals_int (i, 20);
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -617,6 +869,7 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_from_string_int);
   tcase_add_test (tc_chain, test_from_string_uint);
   tcase_add_test (tc_chain, test_from_string);
+  tcase_add_test (tc_chain, test_from_string_untyped);
   tcase_add_test (tc_chain, test_to_string);
   tcase_add_test (tc_chain, test_to_from_string);
   tcase_add_test (tc_chain, test_string_properties);
@@ -628,6 +881,9 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_structure_nested);
   tcase_add_test (tc_chain, test_structure_nested_from_and_to_string);
   tcase_add_test (tc_chain, test_vararg_getters);
+  tcase_add_test (tc_chain, test_large_structure);
+  tcase_add_test (tc_chain, test_to_from_binary);
+  tcase_add_test (tc_chain, test_typed_setters);
   return s;
 }
 
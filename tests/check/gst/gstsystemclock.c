@@ -305,6 +305,60 @@ GST_START_TEST (test_async_order)
 
 GST_END_TEST;
 
+#define N_ASYNC_IDS 64
+
+GST_START_TEST (test_async_order_many)
+{
+  GstClock *clock;
+  GstClockID ids[N_ASYNC_IDS];
+  GList *cb_list = NULL, *walk;
+  GstClockTime base, last;
+  GstClockReturn result;
+  gint i;
+
+  clock = gst_system_clock_obtain ();
+  fail_unless (clock != NULL, "Could not create instance of GstSystemClock");
+
+  base = gst_clock_get_time (clock) + TIME_UNIT;
+
+  /* schedule the ids in a scrambled order, they must still fire sorted on
+   * their time */
+  for (i = 0; i < N_ASYNC_IDS; i++) {
+    gint slot = (i * 37) % N_ASYNC_IDS;
+
+    ids[i] = gst_clock_new_single_shot_id (clock,
+        base + slot * (TIME_UNIT / N_ASYNC_IDS));
+    result = gst_clock_id_wait_async (ids[i], store_callback, &cb_list, NULL);
+    fail_unless (result == GST_CLOCK_OK, "Waiting did not return OK");
+  }
+
+  /* unschedule a few of them again, they must not fire */
+  for (i = 0; i < N_ASYNC_IDS; i += 8)
+    gst_clock_id_unschedule (ids[i]);
+
+  g_usleep (3 * TIME_UNIT / 1000);
+
+  g_mutex_lock (&store_lock);
+  fail_unless_equals_int (g_list_length (cb_list),
+      N_ASYNC_IDS - N_ASYNC_IDS / 8);
+  last = 0;
+  for (walk = cb_list; walk; walk = g_list_next (walk)) {
+    GstClockTime t = gst_clock_id_get_time (walk->data);
+
+    fail_unless (t >= last, "notifications out of order");
+    last = t;
+  }
+  g_mutex_unlock (&store_lock);
+
+  for (i = 0; i < N_ASYNC_IDS; i++)
+    gst_clock_id_unref (ids[i]);
+  g_list_free (cb_list);
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 struct test_async_sync_interaction_data
 {
   GMutex lock;
@@ -637,6 +691,80 @@ GST_START_TEST (test_async_full)
 
 GST_END_TEST;
 
+static gpointer
+unschedule_ids_thread (GstClockID id)
+{
+  return GINT_TO_POINTER (gst_clock_id_wait (id, NULL));
+}
+
+GST_START_TEST (test_unschedule_ids)
+{
+  GstClock *clock;
+  GstClockID ids[3];
+  GThread *threads[2];
+  GstClockTime base;
+  gboolean fired = FALSE;
+  gint i;
+
+  clock = gst_system_clock_obtain ();
+  base = gst_clock_get_time (clock);
+
+  /* two blocking waits and one async wait, far in the future */
+  for (i = 0; i < 3; i++)
+    ids[i] = gst_clock_new_single_shot_id (clock, base + 100 * TIME_UNIT);
+
+  for (i = 0; i < 2; i++)
+    threads[i] = g_thread_new ("unschedule-ids",
+        (GThreadFunc) unschedule_ids_thread, ids[i]);
+  fail_unless (gst_clock_id_wait_async (ids[2], notify_callback, &fired,
+          NULL) == GST_CLOCK_OK);
+
+  g_usleep (TIME_UNIT / 1000);
+  gst_clock_unschedule_ids (clock, ids, 3);
+
+  for (i = 0; i < 2; i++)
+    fail_unless_equals_int (GPOINTER_TO_INT (g_thread_join (threads[i])),
+        GST_CLOCK_UNSCHEDULED);
+  fail_if (fired);
+
+  for (i = 0; i < 3; i++)
+    gst_clock_id_unref (ids[i]);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_periodic_set_interval)
+{
+  GstClock *clock;
+  GstClockID id;
+  GstClockTime base;
+
+  clock = gst_system_clock_obtain ();
+  base = gst_clock_get_time (clock);
+
+  id = gst_clock_new_single_shot_id (clock, base);
+  fail_if (gst_clock_periodic_id_set_interval (id, TIME_UNIT));
+  gst_clock_id_unref (id);
+
+  id = gst_clock_new_periodic_id (clock, base + TIME_UNIT / 10,
+      TIME_UNIT / 10);
+  fail_unless (gst_clock_id_wait (id, NULL) == GST_CLOCK_OK);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id),
+      base + 2 * (TIME_UNIT / 10));
+
+  /* the next period still uses the old interval */
+  fail_unless (gst_clock_periodic_id_set_interval (id, TIME_UNIT / 5));
+  fail_unless (gst_clock_id_wait (id, NULL) == GST_CLOCK_OK);
+  fail_unless_equals_uint64 (gst_clock_id_get_time (id),
+      base + 2 * (TIME_UNIT / 10) + TIME_UNIT / 5);
+
+  gst_clock_id_unref (id);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_systemclock_suite (void)
 {
@@ -650,10 +778,13 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_periodic_shot);
   tcase_add_test (tc_chain, test_periodic_multi);
   tcase_add_test (tc_chain, test_async_order);
+  tcase_add_test (tc_chain, test_async_order_many);
   tcase_add_test (tc_chain, test_async_sync_interaction);
   tcase_add_test (tc_chain, test_diff);
   tcase_add_test (tc_chain, test_mixed);
   tcase_add_test (tc_chain, test_async_full);
+  tcase_add_test (tc_chain, test_unschedule_ids);
+  tcase_add_test (tc_chain, test_periodic_set_interval);
 
   return s;
 }
@@ -393,6 +393,44 @@ GST_START_TEST (test_buffer_tags)
 
 GST_END_TEST;
 
+/* merging shares the image samples instead of copying them */
+GST_START_TEST (test_merge_shares_samples)
+{
+  GstTagList *tags1, *tags2, *merged;
+  GstSample *s, *s1;
+  GstBuffer *buf;
+  GstTagMergeMode mode;
+
+  buf = gst_buffer_new_and_alloc (1000);
+  s = gst_sample_new (buf, NULL, NULL, NULL);
+  gst_buffer_unref (buf);
+
+  tags1 = gst_tag_list_new (GST_TAG_TITLE, "title", NULL);
+  tags2 = gst_tag_list_new (GST_TAG_IMAGE, s, GST_TAG_ARTIST, "artist", NULL);
+
+  for (mode = GST_TAG_MERGE_REPLACE_ALL; mode < GST_TAG_MERGE_KEEP_ALL; mode++) {
+    merged = gst_tag_list_merge (tags1, tags2, mode);
+    fail_unless (gst_tag_list_get_sample (merged, GST_TAG_IMAGE, &s1));
+    fail_unless (s1 == s);
+    gst_sample_unref (s1);
+    gst_tag_list_unref (merged);
+
+    /* merging into an empty list */
+    merged = gst_tag_list_merge (NULL, tags2, mode);
+    fail_unless (gst_tag_list_is_equal (merged, tags2));
+    fail_unless (gst_tag_list_get_sample (merged, GST_TAG_IMAGE, &s1));
+    fail_unless (s1 == s);
+    gst_sample_unref (s1);
+    gst_tag_list_unref (merged);
+  }
+
+  gst_tag_list_unref (tags1);
+  gst_tag_list_unref (tags2);
+  gst_sample_unref (s);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_empty_tags)
 {
   GstTagList *tags;
@@ -618,6 +656,7 @@ gst_tag_suite (void)
   tcase_add_test (tc_chain, test_basics);
   tcase_add_test (tc_chain, test_add);
   tcase_add_test (tc_chain, test_merge);
+  tcase_add_test (tc_chain, test_merge_shares_samples);
   tcase_add_test (tc_chain, test_merge_strings_with_comma);
   tcase_add_test (tc_chain, test_date_tags);
   tcase_add_test (tc_chain, test_type);
@@ -19,8 +19,16 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <gst/check/gstcheck.h>
 
+#ifdef HAVE_SCHED_SETAFFINITY
+#include <sched.h>
+#endif
+
 static GMutex task_lock;
 static GCond task_cond;
 
@@ -191,6 +199,238 @@ GST_START_TEST (test_create)
 GST_END_TEST;
 
 
+static gboolean affinity_ok;
+
+static void
+affinity_func (void *data)
+{
+#if defined(HAVE_SCHED_SETAFFINITY) && defined(CPU_SET)
+  cpu_set_t set;
+
+  affinity_ok = sched_getaffinity (0, sizeof (set), &set) == 0 &&
+      CPU_COUNT (&set) == 1 && CPU_ISSET (0, &set);
+#else
+  affinity_ok = TRUE;
+#endif
+
+  g_mutex_lock (&task_lock);
+  g_cond_signal (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+GST_START_TEST (test_affinity)
+{
+  GstTask *t;
+  guint cpus[] = { 0 };
+
+  t = gst_task_new (affinity_func, NULL, NULL);
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+  gst_task_set_affinity (t, cpus, G_N_ELEMENTS (cpus));
+  /* the default policy never needs privileges */
+  gst_task_set_scheduling (t, GST_TASK_SCHEDULING_DEFAULT, 0);
+
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+
+  affinity_ok = FALSE;
+  g_mutex_lock (&task_lock);
+  fail_unless (gst_task_start (t));
+  g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  fail_unless (gst_task_join (t));
+  fail_unless (affinity_ok);
+
+  gst_task_cleanup_all ();
+  gst_object_unref (t);
+}
+
+GST_END_TEST;
+
+static gint shared_count[2];
+
+static void
+shared_task_func (void *data)
+{
+  g_atomic_int_inc ((gint *) data);
+  g_usleep (100);
+}
+
+/* two tasks share one worker thread and both make progress */
+GST_START_TEST (test_shared_pool)
+{
+  GstTaskPool *pool;
+  GstTask *t[2];
+  GRecMutex mutex[2];
+  gint i;
+
+  pool = gst_shared_task_pool_new (1);
+  fail_unless (GST_IS_SHARED_TASK_POOL (pool));
+  fail_unless_equals_int (gst_shared_task_pool_get_n_threads
+      (GST_SHARED_TASK_POOL (pool)), 1);
+  gst_task_pool_prepare (pool, NULL);
+
+  for (i = 0; i < 2; i++) {
+    shared_count[i] = 0;
+    g_rec_mutex_init (&mutex[i]);
+    t[i] = gst_task_new (shared_task_func, &shared_count[i], NULL);
+    gst_task_set_lock (t[i], &mutex[i]);
+    gst_task_set_pool (t[i], pool);
+    fail_unless (gst_task_start (t[i]));
+  }
+
+  while (g_atomic_int_get (&shared_count[0]) < 10 ||
+      g_atomic_int_get (&shared_count[1]) < 10)
+    g_usleep (1000);
+
+  /* a paused task gives the worker back and can continue */
+  fail_unless (gst_task_pause (t[0]));
+  g_rec_mutex_lock (&mutex[0]);
+  i = g_atomic_int_get (&shared_count[0]);
+  g_rec_mutex_unlock (&mutex[0]);
+  g_usleep (10000);
+  fail_unless_equals_int (g_atomic_int_get (&shared_count[0]), i);
+  fail_unless (gst_task_start (t[0]));
+  while (g_atomic_int_get (&shared_count[0]) < i + 10)
+    g_usleep (1000);
+
+  fail_unless (gst_task_pause (t[1]));
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_task_join (t[i]));
+    gst_object_unref (t[i]);
+    g_rec_mutex_clear (&mutex[i]);
+  }
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+#define PUSH_THREADS 4
+
+static gint pushed_count;
+static gint run_count;
+
+static void
+count_func (void *data)
+{
+  g_atomic_int_inc (&run_count);
+}
+
+static gpointer
+push_thread (GstTaskPool * pool)
+{
+  while (TRUE) {
+    GError *err = NULL;
+
+    gst_task_pool_push (pool, count_func, NULL, &err);
+    if (err) {
+      /* the pool was cleaned up */
+      g_error_free (err);
+      break;
+    }
+    g_atomic_int_inc (&pushed_count);
+  }
+  return NULL;
+}
+
+GST_START_TEST (test_shared_pool_cleanup)
+{
+  GstTaskPool *pool;
+  GThread *threads[PUSH_THREADS];
+  gint i;
+
+  pushed_count = run_count = 0;
+
+  /* several workers, so that idle workers steal from the others */
+  pool = gst_shared_task_pool_new (4);
+  gst_task_pool_prepare (pool, NULL);
+
+  for (i = 0; i < PUSH_THREADS; i++)
+    threads[i] = g_thread_new ("push", (GThreadFunc) push_thread, pool);
+
+  while (g_atomic_int_get (&pushed_count) < 10000)
+    g_thread_yield ();
+
+  /* clean up while the functions are still being pushed */
+  gst_task_pool_cleanup (pool);
+
+  for (i = 0; i < PUSH_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* every function that was accepted ran before the workers exited */
+  fail_unless_equals_int (g_atomic_int_get (&run_count),
+      g_atomic_int_get (&pushed_count));
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static GstTask *yield_task;
+static gint yield_count;
+static gboolean yield_res;
+
+static void
+yield_task_func (void *data)
+{
+  yield_res = gst_task_yield (yield_task);
+  g_atomic_int_inc (&yield_count);
+}
+
+static void
+wait_yield_count (gint count)
+{
+  while (g_atomic_int_get (&yield_count) < count)
+    g_usleep (1000);
+  /* let the task give its worker back */
+  g_usleep (10000);
+}
+
+/* a yielding task is only run again when it is resumed */
+GST_START_TEST (test_yield)
+{
+  GstTaskPool *pool;
+  GRecMutex mutex;
+
+  /* yielding is not possible from outside the task */
+  yield_task = gst_task_new (yield_task_func, NULL, NULL);
+  fail_if (gst_task_yield (yield_task));
+  gst_object_unref (yield_task);
+
+  pool = gst_shared_task_pool_new (1);
+  gst_task_pool_prepare (pool, NULL);
+
+  yield_count = 0;
+  g_rec_mutex_init (&mutex);
+  yield_task = gst_task_new (yield_task_func, NULL, NULL);
+  gst_task_set_lock (yield_task, &mutex);
+  gst_task_set_pool (yield_task, pool);
+  fail_unless (gst_task_start (yield_task));
+
+  wait_yield_count (1);
+  fail_unless (yield_res);
+  fail_unless_equals_int (g_atomic_int_get (&yield_count), 1);
+
+  gst_task_resume (yield_task);
+  wait_yield_count (2);
+  fail_unless_equals_int (g_atomic_int_get (&yield_count), 2);
+
+  /* a yielded task notices that it is stopped */
+  fail_unless (gst_task_stop (yield_task));
+  fail_unless (gst_task_join (yield_task));
+  fail_unless_equals_int (g_atomic_int_get (&yield_count), 2);
+  gst_object_unref (yield_task);
+  g_rec_mutex_clear (&mutex);
+
+  gst_task_pool_cleanup (pool);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_task_suite (void)
 {
@@ -203,6 +443,10 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_lock);
   tcase_add_test (tc_chain, test_lock_start);
   tcase_add_test (tc_chain, test_join);
+  tcase_add_test (tc_chain, test_shared_pool);
+  tcase_add_test (tc_chain, test_shared_pool_cleanup);
+  tcase_add_test (tc_chain, test_yield);
+  tcase_add_test (tc_chain, test_affinity);
 
   return s;
 }
@@ -305,6 +305,87 @@ GST_START_TEST (test_serializing)
 
 GST_END_TEST;
 
+#define NUM_CHAPTERS 2000
+
+GST_START_TEST (test_find_and_copy)
+{
+  GstToc *toc, *copy;
+  GstTocEntry *ed, *ch, *found, *found_copy;
+  GstTagList *tags;
+  gchar *title;
+  gint i;
+
+  toc = gst_toc_new (GST_TOC_SCOPE_GLOBAL);
+  ed = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_EDITION, ENTRY_ED1);
+  gst_toc_append_entry (toc, ed);
+
+  /* subentries appended after the edition is in the TOC are found, as well
+   * as the ones of a subtree that is appended later */
+  for (i = 0; i < NUM_CHAPTERS; i++) {
+    gchar *uid = g_strdup_printf ("%s/chapter%d", ENTRY_ED1, i);
+
+    ch = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_CHAPTER, uid);
+    gst_toc_entry_set_tags (ch, gst_tag_list_new (GST_TAG_TITLE, uid, NULL));
+    gst_toc_entry_append_sub_entry (ed, ch);
+    g_free (uid);
+  }
+  ed = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_EDITION, ENTRY_ED2);
+  ch = gst_toc_entry_new (GST_TOC_ENTRY_TYPE_CHAPTER, ENTRY_CH3);
+  gst_toc_entry_append_sub_entry (ch,
+      gst_toc_entry_new (GST_TOC_ENTRY_TYPE_CHAPTER, ENTRY_SUB1));
+  gst_toc_entry_append_sub_entry (ed, ch);
+  gst_toc_append_entry (toc, ed);
+
+  for (i = 0; i < NUM_CHAPTERS; i++) {
+    gchar *uid = g_strdup_printf ("%s/chapter%d", ENTRY_ED1, i);
+
+    found = gst_toc_find_entry (toc, uid);
+    fail_unless (found != NULL);
+    fail_unless_equals_string (gst_toc_entry_get_uid (found), uid);
+    fail_unless (gst_toc_entry_get_toc (found) == toc);
+    g_free (uid);
+  }
+  found = gst_toc_find_entry (toc, ENTRY_SUB1);
+  fail_unless (found != NULL);
+  fail_unless (gst_toc_entry_get_toc (found) == toc);
+  fail_unless (gst_toc_entry_get_parent (found) == ch);
+  fail_unless (gst_toc_find_entry (toc, ENTRY_CH4) == NULL);
+
+  /* the copy has its own entries and index but shares the tags */
+  copy = gst_toc_copy (toc);
+  found = gst_toc_find_entry (toc, ENTRY_ED1 "/chapter42");
+  found_copy = gst_toc_find_entry (copy, ENTRY_ED1 "/chapter42");
+  fail_unless (found_copy != NULL);
+  fail_unless (found_copy != found);
+  fail_unless (gst_toc_entry_get_toc (found_copy) == copy);
+  fail_unless (gst_toc_entry_get_parent (found_copy) ==
+      gst_toc_find_entry (copy, ENTRY_ED1));
+  fail_unless (gst_toc_entry_get_tags (found_copy) ==
+      gst_toc_entry_get_tags (found));
+  found_copy = gst_toc_find_entry (copy, ENTRY_SUB1);
+  fail_unless (gst_toc_entry_get_parent (found_copy) ==
+      gst_toc_find_entry (copy, ENTRY_CH3));
+
+  /* modifying the tags of the copy leaves the original alone */
+  found_copy = gst_toc_find_entry (copy, ENTRY_ED1 "/chapter42");
+  tags = gst_tag_list_new (GST_TAG_TITLE, "replaced", NULL);
+  gst_toc_entry_merge_tags (found_copy, tags, GST_TAG_MERGE_REPLACE);
+  gst_tag_list_unref (tags);
+  fail_unless (gst_tag_list_get_string (gst_toc_entry_get_tags (found),
+          GST_TAG_TITLE, &title));
+  fail_unless_equals_string (title, ENTRY_ED1 "/chapter42");
+  g_free (title);
+  fail_unless (gst_tag_list_get_string (gst_toc_entry_get_tags (found_copy),
+          GST_TAG_TITLE, &title));
+  fail_unless_equals_string (title, "replaced");
+  g_free (title);
+
+  gst_toc_unref (copy);
+  gst_toc_unref (toc);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_toc_suite (void)
 {
@@ -313,6 +394,7 @@ gst_toc_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_serializing);
+  tcase_add_test (tc_chain, test_find_and_copy);
 
   return s;
 }
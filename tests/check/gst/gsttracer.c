@@ -0,0 +1,407 @@
+/* GStreamer
+ *
+ * unit test for GstTracer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+typedef struct
+{
+  GstTracer parent;
+} GstTestTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstTestTracerClass;
+
+static gint push_pre, push_post;
+static gint chain_pre, chain_post;
+static gint event_pre, event_post;
+static gint query_pre, query_post;
+static gint mini_object_created, mini_object_destroyed;
+
+static GType gst_test_tracer_get_type (void);
+G_DEFINE_TYPE (GstTestTracer, gst_test_tracer, GST_TYPE_TRACER);
+
+static void
+test_push_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  g_atomic_int_inc (&push_pre);
+}
+
+static void
+test_push_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  g_atomic_int_inc (&push_post);
+}
+
+static void
+test_chain_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  g_atomic_int_inc (&chain_pre);
+}
+
+static void
+test_chain_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  g_atomic_int_inc (&chain_post);
+}
+
+static void
+test_push_event_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstEvent * event)
+{
+  g_atomic_int_inc (&event_pre);
+}
+
+static void
+test_push_event_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    gboolean res)
+{
+  g_atomic_int_inc (&event_post);
+}
+
+static void
+test_query_pre (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstQuery * query)
+{
+  g_atomic_int_inc (&query_pre);
+}
+
+static void
+test_query_post (GstTracer * tracer, GstClockTime ts, GstPad * pad,
+    GstQuery * query, gboolean res)
+{
+  g_atomic_int_inc (&query_post);
+}
+
+static void
+test_mini_object_created (GstTracer * tracer, GstClockTime ts,
+    GstMiniObject * object)
+{
+  g_atomic_int_inc (&mini_object_created);
+}
+
+static void
+test_mini_object_destroyed (GstTracer * tracer, GstClockTime ts,
+    GstMiniObject * object)
+{
+  g_atomic_int_inc (&mini_object_destroyed);
+}
+
+static void
+gst_test_tracer_class_init (GstTestTracerClass * klass)
+{
+  GstTracerClass *tracer_class = GST_TRACER_CLASS (klass);
+
+  tracer_class->pad_push_pre = test_push_pre;
+  tracer_class->pad_push_post = test_push_post;
+  tracer_class->pad_chain_pre = test_chain_pre;
+  tracer_class->pad_chain_post = test_chain_post;
+  tracer_class->pad_push_event_pre = test_push_event_pre;
+  tracer_class->pad_push_event_post = test_push_event_post;
+  tracer_class->pad_query_pre = test_query_pre;
+  tracer_class->pad_query_post = test_query_post;
+  tracer_class->mini_object_created = test_mini_object_created;
+  tracer_class->mini_object_destroyed = test_mini_object_destroyed;
+}
+
+static void
+gst_test_tracer_init (GstTestTracer * tracer)
+{
+}
+
+static GstFlowReturn
+test_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_register)
+{
+  /* names are unique, "test" was registered in main() */
+  fail_if (gst_tracer_register ("test", gst_test_tracer_get_type ()));
+  fail_if (gst_tracer_register ("proctime", gst_test_tracer_get_type ()));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_hooks)
+{
+  GstPad *src, *sink;
+  GstQuery *query;
+  gint i;
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sink, test_chain);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+
+  g_atomic_int_set (&push_pre, 0);
+  g_atomic_int_set (&push_post, 0);
+  g_atomic_int_set (&chain_pre, 0);
+  g_atomic_int_set (&chain_post, 0);
+  g_atomic_int_set (&event_pre, 0);
+  g_atomic_int_set (&event_post, 0);
+  g_atomic_int_set (&query_pre, 0);
+  g_atomic_int_set (&query_post, 0);
+
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless_equals_int (g_atomic_int_get (&event_pre), 1);
+  fail_unless_equals_int (g_atomic_int_get (&event_post), 1);
+
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (gst_pad_push (src, gst_buffer_new ()),
+        GST_FLOW_OK);
+
+  fail_unless_equals_int (g_atomic_int_get (&push_pre), 10);
+  fail_unless_equals_int (g_atomic_int_get (&push_post), 10);
+  fail_unless_equals_int (g_atomic_int_get (&chain_pre), 10);
+  fail_unless_equals_int (g_atomic_int_get (&chain_post), 10);
+
+  query = gst_query_new_latency ();
+  gst_pad_peer_query (src, query);
+  gst_query_unref (query);
+  fail_unless_equals_int (g_atomic_int_get (&query_pre), 1);
+  fail_unless_equals_int (g_atomic_int_get (&query_post), 1);
+
+  gst_pad_set_active (src, FALSE);
+  gst_pad_set_active (sink, FALSE);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_mini_object_hooks)
+{
+  GstBuffer *buffer, *copy;
+
+  g_atomic_int_set (&mini_object_created, 0);
+  g_atomic_int_set (&mini_object_destroyed, 0);
+
+  buffer = gst_buffer_new ();
+  fail_unless_equals_int (g_atomic_int_get (&mini_object_created), 1);
+  copy = gst_buffer_copy (buffer);
+  fail_unless_equals_int (g_atomic_int_get (&mini_object_created), 2);
+
+  /* only the last unref destroys the object */
+  gst_buffer_ref (buffer);
+  gst_buffer_unref (buffer);
+  fail_unless_equals_int (g_atomic_int_get (&mini_object_destroyed), 0);
+  gst_buffer_unref (buffer);
+  fail_unless_equals_int (g_atomic_int_get (&mini_object_destroyed), 1);
+  gst_buffer_unref (copy);
+  fail_unless_equals_int (g_atomic_int_get (&mini_object_destroyed), 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_core_tracers)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  gchar *contents = NULL;
+
+  /* runs data through all core tracers */
+  pipeline = gst_parse_launch ("fakesrc num-buffers=100 sizetype=2 "
+      "sizemax=512 ! queue ! identity ! fakesink", NULL);
+  fail_unless (pipeline != NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+#ifndef GST_DISABLE_GST_DEBUG
+  /* the graph contains the values of the tracers, the second dump reuses
+   * the descriptions of the caps */
+  contents = gst_debug_bin_to_dot_data (GST_BIN (pipeline),
+      GST_DEBUG_GRAPH_SHOW_ALL);
+  fail_unless (g_str_has_prefix (contents, "digraph pipeline {"));
+  fail_unless (strstr (contents, "buffers/s") != NULL);
+  fail_unless (strstr (contents, "proctime avg") != NULL);
+  g_free (contents);
+  contents = gst_debug_bin_to_dot_data (GST_BIN (pipeline),
+      GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE);
+  fail_unless (strstr (contents, "buffers/s") == NULL);
+  g_free (contents);
+  contents = NULL;
+#endif
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* the timeline was written when EOS reached the sink */
+  fail_unless (g_file_get_contents (g_getenv ("GST_TIMELINE_FILE"), &contents,
+          NULL, NULL));
+  fail_unless (g_str_has_prefix (contents, "{\"traceEvents\":["));
+  fail_unless (strstr (contents, "\"name\":\"identity0\"") != NULL);
+  fail_unless (strstr (contents, "\"cat\":\"task\"") != NULL);
+  g_free (contents);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_watchdog)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+
+  /* identity blocks longer than GST_WATCHDOG_THRESHOLD in its chain */
+  pipeline = gst_parse_launch ("fakesrc num-buffers=1 ! "
+      "identity name=slow sleep-time=1000000 ! fakesink", NULL);
+  fail_unless (pipeline != NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_WARNING | GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_WARNING);
+  fail_unless_equals_string (GST_OBJECT_NAME (GST_MESSAGE_SRC (msg)), "slow");
+  gst_message_unref (msg);
+
+  /* the call still completes */
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* a pipeline that waits as it should is not reported */
+GST_START_TEST (test_watchdog_waiting)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+
+  /* the sink waits for PLAYING after it prerolled */
+  pipeline = gst_parse_launch ("fakesrc ! fakesink", NULL);
+  fail_unless (pipeline != NULL);
+
+  fail_unless_equals_int (gst_element_set_state (pipeline, GST_STATE_PAUSED),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL, -1),
+      GST_STATE_CHANGE_SUCCESS);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_SECOND,
+      GST_MESSAGE_WARNING | GST_MESSAGE_ERROR);
+  fail_unless (msg == NULL);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  /* the sink waits on the clock for the second buffer, which starts 1
+   * second after the first one */
+  pipeline = gst_parse_launch ("fakesrc num-buffers=2 sizetype=2 "
+      "sizemax=4096 datarate=4096 ! fakesink sync=true", NULL);
+  fail_unless (pipeline != NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_WARNING | GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_tracer_suite (void)
+{
+  Suite *s = suite_create ("GstTracer");
+  TCase *tc_chain = tcase_create ("tracer tests");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_register);
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  tcase_add_test (tc_chain, test_hooks);
+  tcase_add_test (tc_chain, test_mini_object_hooks);
+#endif
+#ifndef GST_DISABLE_PARSE
+  tcase_add_test (tc_chain, test_core_tracers);
+#ifndef GST_DISABLE_GST_TRACER_HOOKS
+  tcase_add_test (tc_chain, test_watchdog);
+  tcase_add_test (tc_chain, test_watchdog_waiting);
+#endif
+#endif
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  Suite *s;
+  gchar *timeline;
+  int ret;
+
+  g_setenv ("GST_TRACERS",
+      "proctime;latency;rate;queuelevel;timeline;leaks;watchdog;test", TRUE);
+  g_setenv ("GST_WATCHDOG_THRESHOLD", "200", TRUE);
+  timeline = g_build_filename (g_get_tmp_dir (), "gst-check-timeline.json",
+      NULL);
+  g_setenv ("GST_TIMELINE_FILE", timeline, TRUE);
+
+  gst_check_init (&argc, &argv);
+
+  /* registering a tracer after gst_init() enables it when it is listed in
+   * GST_TRACERS */
+  gst_tracer_register ("test", gst_test_tracer_get_type ());
+
+  s = gst_tracer_suite ();
+
+  ret = gst_check_run_suite (s, "gst_tracer", __FILE__);
+
+  g_unlink (timeline);
+  g_free (timeline);
+
+  return ret;
+}
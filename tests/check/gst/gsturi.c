@@ -18,6 +18,10 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
 #include <gst/check/gstcheck.h>
 
 GST_START_TEST (test_protocol_case)
@@ -164,6 +168,118 @@ GST_START_TEST (test_element_make_from_uri)
 
 GST_END_TEST;
 
+/* a source that accepts any testuri:// URI */
+typedef GstElement GstURITestSrc;
+typedef GstElementClass GstURITestSrcClass;
+
+static GstURIType
+uri_test_src_get_type (GType type)
+{
+  return GST_URI_SRC;
+}
+
+static const gchar *const *
+uri_test_src_get_protocols (GType type)
+{
+  static const gchar *protocols[] = { "testuri", "TestURI", NULL };
+
+  return protocols;
+}
+
+static gchar *
+uri_test_src_get_uri (GstURIHandler * handler)
+{
+  return NULL;
+}
+
+static gboolean
+uri_test_src_set_uri (GstURIHandler * handler, const gchar * uri,
+    GError ** error)
+{
+  return TRUE;
+}
+
+static void
+uri_test_src_handler_init (gpointer g_iface, gpointer iface_data)
+{
+  GstURIHandlerInterface *iface = (GstURIHandlerInterface *) g_iface;
+
+  iface->get_type = uri_test_src_get_type;
+  iface->get_protocols = uri_test_src_get_protocols;
+  iface->get_uri = uri_test_src_get_uri;
+  iface->set_uri = uri_test_src_set_uri;
+}
+
+static GType gst_uri_test_src_get_type (void);
+G_DEFINE_TYPE_WITH_CODE (GstURITestSrc, gst_uri_test_src, GST_TYPE_ELEMENT,
+    G_IMPLEMENT_INTERFACE (GST_TYPE_URI_HANDLER, uri_test_src_handler_init));
+
+static void
+gst_uri_test_src_class_init (GstURITestSrcClass * klass)
+{
+  gst_element_class_set_metadata (klass, "URI test source", "Source",
+      "Accepts testuri:// URIs", "GStreamer Developers");
+}
+
+static void
+gst_uri_test_src_init (GstURITestSrc * src)
+{
+}
+
+static gboolean
+uri_test_plugin_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin, "uritestsrc1", GST_RANK_SECONDARY,
+      gst_uri_test_src_get_type ()) &&
+      gst_element_register (plugin, "uritestsrc2", GST_RANK_PRIMARY,
+      gst_uri_test_src_get_type ());
+}
+
+static gchar *
+make_from_uri_factory_name (const gchar * uri)
+{
+  GstElement *element;
+  gchar *name;
+
+  element = gst_element_make_from_uri (GST_URI_SRC, uri, NULL, NULL);
+  fail_unless (element != NULL);
+  name = g_strdup (GST_OBJECT_NAME (gst_element_get_factory (element)));
+  gst_object_unref (element);
+
+  return name;
+}
+
+GST_START_TEST (test_element_make_from_uri_rank)
+{
+  GstPluginFeature *feature;
+  gchar *name;
+
+  fail_unless (gst_plugin_register_static (GST_VERSION_MAJOR,
+          GST_VERSION_MINOR, "uritest", "URI test elements",
+          uri_test_plugin_init, VERSION, GST_LICENSE, PACKAGE,
+          GST_PACKAGE_NAME, GST_PACKAGE_ORIGIN));
+
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "testuri"));
+  fail_unless (gst_uri_protocol_is_supported (GST_URI_SRC, "TESTURI"));
+  fail_if (gst_uri_protocol_is_supported (GST_URI_SINK, "testuri"));
+
+  /* the highest rank wins */
+  name = make_from_uri_factory_name ("testuri://foo");
+  fail_unless_equals_string (name, "uritestsrc2");
+  g_free (name);
+
+  /* and the index follows rank changes */
+  feature = gst_registry_lookup_feature (gst_registry_get (), "uritestsrc1");
+  fail_unless (feature != NULL);
+  gst_plugin_feature_set_rank (feature, GST_RANK_PRIMARY + 1);
+  name = make_from_uri_factory_name ("TestUri://foo");
+  fail_unless_equals_string (name, "uritestsrc1");
+  g_free (name);
+  gst_object_unref (feature);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_uri_suite (void)
 {
@@ -177,6 +293,7 @@ gst_uri_suite (void)
   tcase_add_test (tc_chain, test_uri_get_location);
   tcase_add_test (tc_chain, test_uri_misc);
   tcase_add_test (tc_chain, test_element_make_from_uri);
+  tcase_add_test (tc_chain, test_element_make_from_uri_rank);
 #ifdef G_OS_WIN32
   tcase_add_test (tc_chain, test_win32_uri);
 #endif
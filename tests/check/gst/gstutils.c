@@ -311,6 +311,42 @@ GST_START_TEST (test_math_scale_uint64)
 
 } GST_END_TEST;
 
+GST_START_TEST (test_math_scale_array)
+{
+  guint64 vals[] = { 0, 1, 10, G_MAXUINT32, (guint64) G_MAXUINT32 + 1,
+    G_MAXUINT64 - 1, G_MAXUINT64
+  };
+  guint64 check[G_N_ELEMENTS (vals)];
+  guint64 ratios[][2] = { {1, 1}, {3, 2}, {2, 3}, {0, 5},
+  {GST_SECOND, 48000}, {48000, GST_SECOND}, {G_MAXUINT64 - 1, G_MAXUINT64}
+  };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (ratios); i++) {
+    memcpy (check, vals, sizeof (vals));
+    gst_util_uint64_scale_array (check, G_N_ELEMENTS (check), ratios[i][0],
+        ratios[i][1]);
+    for (j = 0; j < G_N_ELEMENTS (vals) - 1; j++)
+      fail_unless_equals_uint64 (check[j],
+          gst_util_uint64_scale (vals[j], ratios[i][0], ratios[i][1]));
+    /* invalid values stay invalid */
+    fail_unless_equals_uint64 (check[j], G_MAXUINT64);
+
+    memcpy (check, vals, sizeof (vals));
+    gst_util_uint64_scale_array_round (check, G_N_ELEMENTS (check),
+        ratios[i][0], ratios[i][1]);
+    for (j = 0; j < G_N_ELEMENTS (vals) - 1; j++)
+      fail_unless_equals_uint64 (check[j],
+          gst_util_uint64_scale_round (vals[j], ratios[i][0], ratios[i][1]));
+    fail_unless_equals_uint64 (check[j], G_MAXUINT64);
+  }
+
+  /* nothing to do */
+  gst_util_uint64_scale_array (NULL, 0, 1, 2);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_math_scale_random)
 {
   guint64 val, num, denom, res;
@@ -534,6 +570,54 @@ GST_START_TEST (test_element_unlink)
 
 GST_END_TEST;
 
+GST_START_TEST (test_element_clone)
+{
+  GstElement *bin, *clone, *src, *sink;
+  GstPad *pad, *peer;
+  gint num_buffers;
+  gboolean sync;
+
+  bin = gst_parse_bin_from_description ("fakesrc name=src num-buffers=5 ! "
+      "identity ! fakesink name=sink sync=true", TRUE, NULL);
+  fail_unless (bin != NULL);
+
+  clone = gst_element_clone (bin, "clone");
+  fail_unless (clone != NULL);
+  fail_unless (GST_IS_BIN (clone));
+  fail_unless_equals_string (GST_OBJECT_NAME (clone), "clone");
+  fail_unless_equals_int (GST_BIN_NUMCHILDREN (clone), 3);
+
+  src = gst_bin_get_by_name (GST_BIN (clone), "src");
+  sink = gst_bin_get_by_name (GST_BIN (clone), "sink");
+  fail_unless (src != NULL && sink != NULL);
+  g_object_get (src, "num-buffers", &num_buffers, NULL);
+  fail_unless_equals_int (num_buffers, 5);
+  g_object_get (sink, "sync", &sync, NULL);
+  fail_unless (sync == TRUE);
+
+  /* the clones are linked like the originals */
+  pad = gst_element_get_static_pad (src, "src");
+  peer = gst_pad_get_peer (pad);
+  fail_unless (peer != NULL);
+  fail_unless (GST_PAD_PARENT (peer) != GST_PAD_PARENT (pad));
+  fail_unless (GST_OBJECT_PARENT (GST_PAD_PARENT (peer)) ==
+      GST_OBJECT (clone));
+  gst_object_unref (peer);
+  gst_object_unref (pad);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+
+  fail_unless (gst_element_set_state (clone,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+  fail_unless (gst_element_set_state (clone,
+          GST_STATE_NULL) == GST_STATE_CHANGE_SUCCESS);
+
+  gst_object_unref (clone);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_set_value_from_string)
 {
   GValue val = { 0, };
@@ -1258,6 +1342,7 @@ gst_utils_suite (void)
   tcase_add_test (tc_chain, test_math_scale_ceil);
   tcase_add_test (tc_chain, test_math_scale_uint64);
   tcase_add_test (tc_chain, test_math_scale_random);
+  tcase_add_test (tc_chain, test_math_scale_array);
 #ifdef HAVE_GSL
 #ifdef HAVE_GMP
   tcase_add_test (tc_chain, test_math_scale_gmp);
@@ -1272,6 +1357,7 @@ gst_utils_suite (void)
 #endif
   tcase_add_test (tc_chain, test_element_found_tags);
   tcase_add_test (tc_chain, test_element_unlink);
+  tcase_add_test (tc_chain, test_element_clone);
   tcase_add_test (tc_chain, test_set_value_from_string);
   tcase_add_test (tc_chain, test_binary_search);
 
@@ -2837,6 +2837,87 @@ GST_START_TEST (test_stepped_int_range_ops)
 
 GST_END_TEST;
 
+GST_START_TEST (test_fast_paths)
+{
+  GValue v1 = { 0 }, v2 = { 0 }, dest = { 0 };
+  gint i;
+
+  g_value_init (&v1, G_TYPE_INT);
+  g_value_init (&v2, G_TYPE_INT);
+  g_value_set_int (&v1, 10);
+  g_value_set_int (&v2, 20);
+  fail_unless_equals_int (gst_value_compare (&v1, &v2), GST_VALUE_LESS_THAN);
+  fail_unless_equals_int (gst_value_compare (&v2, &v1),
+      GST_VALUE_GREATER_THAN);
+  fail_if (gst_value_intersect (NULL, &v1, &v2));
+  fail_unless (gst_value_subtract (&dest, &v1, &v2));
+  fail_unless_equals_int (g_value_get_int (&dest), 10);
+  g_value_unset (&dest);
+  g_value_set_int (&v2, 10);
+  fail_unless_equals_int (gst_value_compare (&v1, &v2), GST_VALUE_EQUAL);
+  fail_unless (gst_value_intersect (&dest, &v1, &v2));
+  fail_unless_equals_int (g_value_get_int (&dest), 10);
+  g_value_unset (&dest);
+  fail_if (gst_value_subtract (NULL, &v1, &v2));
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+
+  g_value_init (&v1, G_TYPE_STRING);
+  g_value_init (&v2, G_TYPE_STRING);
+  g_value_set_string (&v1, "abc");
+  g_value_set_string (&v2, "abd");
+  fail_unless_equals_int (gst_value_compare (&v1, &v2), GST_VALUE_LESS_THAN);
+  fail_if (gst_value_intersect (NULL, &v1, &v2));
+  g_value_set_string (&v2, NULL);
+  fail_unless_equals_int (gst_value_compare (&v1, &v2), GST_VALUE_UNORDERED);
+  g_value_set_string (&v2, "abc");
+  fail_unless (gst_value_intersect (&dest, &v1, &v2));
+  fail_unless_equals_string (g_value_get_string (&dest), "abc");
+  g_value_unset (&dest);
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+
+  g_value_init (&v1, GST_TYPE_FRACTION);
+  g_value_init (&v2, GST_TYPE_FRACTION);
+  gst_value_set_fraction (&v1, 30, 1);
+  gst_value_set_fraction (&v2, 60, 2);
+  fail_unless_equals_int (gst_value_compare (&v1, &v2), GST_VALUE_EQUAL);
+  fail_unless (gst_value_intersect (NULL, &v1, &v2));
+  gst_value_set_fraction (&v2, 25, 1);
+  fail_unless_equals_int (gst_value_compare (&v1, &v2),
+      GST_VALUE_GREATER_THAN);
+  fail_if (gst_value_intersect (NULL, &v1, &v2));
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+
+  /* the functions for a pair of types are looked up once and then cached, in
+   * both orders */
+  g_value_init (&v1, G_TYPE_INT);
+  g_value_init (&v2, GST_TYPE_INT_RANGE);
+  g_value_set_int (&v1, 15);
+  gst_value_set_int_range (&v2, 10, 20);
+  for (i = 0; i < 2; i++) {
+    fail_unless (gst_value_can_intersect (&v1, &v2));
+    fail_unless (gst_value_can_union (&v2, &v1));
+    fail_unless (gst_value_can_subtract (&v2, &v1));
+    fail_unless (gst_value_intersect (&dest, &v2, &v1));
+    fail_unless_equals_int (g_value_get_int (&dest), 15);
+    g_value_unset (&dest);
+    fail_unless (gst_value_union (&dest, &v1, &v2));
+    fail_unless (GST_VALUE_HOLDS_INT_RANGE (&dest));
+    fail_unless_equals_int (gst_value_get_int_range_min (&dest), 10);
+    fail_unless_equals_int (gst_value_get_int_range_max (&dest), 20);
+    g_value_unset (&dest);
+    fail_unless (gst_value_subtract (&dest, &v2, &v1));
+    fail_unless (GST_VALUE_HOLDS_LIST (&dest));
+    g_value_unset (&dest);
+  }
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_value_suite (void)
 {
@@ -2880,6 +2961,7 @@ gst_value_suite (void)
   tcase_add_test (tc_chain, test_stepped_range_collection);
   tcase_add_test (tc_chain, test_stepped_int_range_parsing);
   tcase_add_test (tc_chain, test_stepped_int_range_ops);
+  tcase_add_test (tc_chain, test_fast_paths);
 
   return s;
 }
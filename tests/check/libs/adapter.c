@@ -761,6 +761,42 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+/* start codes that are split over several buffers */
+GST_START_TEST (test_scan_start_code)
+{
+  GstAdapter *adapter;
+  guint32 value;
+  gint i;
+
+  adapter = gst_adapter_new ();
+
+  for (i = 0; i < 10; i++)
+    gst_adapter_push (adapter,
+        gst_buffer_new_wrapped (g_malloc0 (100), 100));
+  gst_adapter_push (adapter, gst_buffer_new_wrapped (g_malloc0 (1), 1));
+  gst_adapter_push (adapter, gst_buffer_new_wrapped (g_memdup ("\001\011",
+              2), 2));
+  for (i = 0; i < 10; i++)
+    gst_adapter_push (adapter,
+        gst_buffer_new_wrapped (g_malloc0 (100), 100));
+
+  fail_unless_equals_int (gst_adapter_masked_scan_uint32_peek (adapter,
+          0xffffff00, 0x00000100, 0, 2003, &value), 999);
+  fail_unless_equals_int (value, 0x00000109);
+  fail_unless_equals_int (gst_adapter_masked_scan_uint32 (adapter,
+          0xffffffff, 0x00000001, 0, 2003), 998);
+  fail_unless_equals_int (gst_adapter_masked_scan_uint32 (adapter,
+          0xffffff00, 0x00000100, 1000, 1003), -1);
+  fail_unless_equals_int (gst_adapter_masked_scan_uint32 (adapter,
+          0xffffff00, 0x00000100, 999, 4), 999);
+  fail_unless_equals_int (gst_adapter_masked_scan_uint32 (adapter,
+          0xffffffff, 0x00000001, 999, 4), -1);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 /* Fill a buffer with a sequence of 32 bit ints and read them back out
  * using take_buffer, checking that they're still in the right order */
 GST_START_TEST (test_take_list)
@@ -834,6 +870,166 @@ GST_START_TEST (test_merge)
 
 GST_END_TEST;
 
+GST_START_TEST (test_map_regions)
+{
+  GstAdapter *adapter;
+  const GstMapInfo *regions;
+  guint8 expected[40], *ptr;
+  guint n_regions, i;
+
+  adapter = create_and_fill_adapter ();
+
+  /* start in the middle of the first buffer */
+  gst_adapter_flush (adapter, 6);
+  gst_adapter_copy (adapter, expected, 0, sizeof (expected));
+
+  regions = gst_adapter_map_regions (adapter, sizeof (expected), &n_regions);
+  fail_unless (regions != NULL);
+  fail_unless_equals_int (n_regions, 3);
+  fail_unless_equals_int (regions[0].size, 10);
+  fail_unless_equals_int (regions[1].size, 16);
+  fail_unless_equals_int (regions[2].size, 14);
+
+  ptr = expected;
+  for (i = 0; i < n_regions; i++) {
+    fail_unless (memcmp (regions[i].data, ptr, regions[i].size) == 0);
+    ptr += regions[i].size;
+  }
+  gst_adapter_unmap_regions (adapter);
+
+  /* a region inside the head buffer */
+  regions = gst_adapter_map_regions (adapter, 4, &n_regions);
+  fail_unless (regions != NULL);
+  fail_unless_equals_int (n_regions, 1);
+  fail_unless (memcmp (regions[0].data, expected, 4) == 0);
+
+  /* flushing releases the regions */
+  gst_adapter_flush (adapter, 10);
+  fail_unless (gst_adapter_map_regions (adapter,
+          gst_adapter_available (adapter) + 1, &n_regions) == NULL);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_take_buffer_fast)
+{
+  GstAdapter *adapter;
+  GstBuffer *bufs[3], *buffer;
+  GstMemory *mem;
+  GstMapInfo info;
+  guint8 expected[40];
+  guint i;
+
+  adapter = gst_adapter_new ();
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++) {
+    bufs[i] = gst_buffer_new_and_alloc (16);
+    gst_buffer_memset (bufs[i], 0, 'a' + i, 16);
+    gst_adapter_push (adapter, gst_buffer_ref (bufs[i]));
+  }
+
+  /* start in the middle of the first buffer */
+  gst_adapter_flush (adapter, 6);
+  gst_adapter_copy (adapter, expected, 0, sizeof (expected));
+
+  buffer = gst_adapter_take_buffer_fast (adapter, sizeof (expected));
+  fail_unless (buffer != NULL);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), sizeof (expected));
+  fail_unless_equals_int (gst_adapter_available (adapter), 2);
+
+  /* the data is not merged, the memory of the buffers is shared */
+  fail_unless_equals_int (gst_buffer_n_memory (buffer), 3);
+  fail_unless (gst_buffer_peek_memory (buffer, 1) ==
+      gst_buffer_peek_memory (bufs[1], 0));
+  mem = gst_buffer_peek_memory (buffer, 0);
+  fail_unless_equals_int (gst_memory_get_sizes (mem, NULL, NULL), 10);
+  fail_unless (mem->parent == gst_buffer_peek_memory (bufs[0], 0));
+  mem = gst_buffer_peek_memory (buffer, 2);
+  fail_unless_equals_int (gst_memory_get_sizes (mem, NULL, NULL), 14);
+  fail_unless (mem->parent == gst_buffer_peek_memory (bufs[2], 0));
+
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  fail_unless (memcmp (info.data, expected, sizeof (expected)) == 0);
+  gst_buffer_unmap (buffer, &info);
+  gst_buffer_unref (buffer);
+
+  /* inside the head buffer */
+  buffer = gst_adapter_take_buffer_fast (adapter, 2);
+  fail_unless (buffer != NULL);
+  fail_unless (gst_buffer_memcmp (buffer, 0, "cc", 2) == 0);
+  gst_buffer_unref (buffer);
+
+  fail_unless (gst_adapter_take_buffer_fast (adapter, 1) == NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    gst_buffer_unref (bufs[i]);
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_timestamp_at_offset)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer;
+  GstClockTime timestamp;
+  guint64 distance;
+  gint i;
+
+  adapter = gst_adapter_new ();
+
+  /* 4 buffers of 10 bytes, the third one has no timestamps */
+  for (i = 0; i < 4; i++) {
+    buffer = gst_buffer_new_and_alloc (10);
+    if (i != 2) {
+      GST_BUFFER_PTS (buffer) = i * GST_SECOND;
+      GST_BUFFER_DTS (buffer) = i * GST_SECOND + 1;
+    }
+    gst_adapter_push (adapter, buffer);
+  }
+
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 0, &distance);
+  fail_unless_equals_uint64 (timestamp, 0);
+  fail_unless_equals_uint64 (distance, 0);
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 15, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_SECOND);
+  fail_unless_equals_uint64 (distance, 5);
+  timestamp = gst_adapter_prev_dts_at_offset (adapter, 25, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_SECOND + 1);
+  fail_unless_equals_uint64 (distance, 15);
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 30, &distance);
+  fail_unless_equals_uint64 (timestamp, 3 * GST_SECOND);
+  fail_unless_equals_uint64 (distance, 0);
+
+  /* after flushing the lookup matches the head timestamps */
+  gst_adapter_flush (adapter, 22);
+  timestamp = gst_adapter_prev_pts (adapter, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_SECOND);
+  fail_unless_equals_uint64 (distance, 12);
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 0, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_SECOND);
+  fail_unless_equals_uint64 (distance, 12);
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 7, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_SECOND);
+  fail_unless_equals_uint64 (distance, 19);
+  timestamp = gst_adapter_prev_dts_at_offset (adapter, 8, &distance);
+  fail_unless_equals_uint64 (timestamp, 3 * GST_SECOND + 1);
+  fail_unless_equals_uint64 (distance, 0);
+
+  /* the index is reset when clearing */
+  gst_adapter_clear (adapter);
+  buffer = gst_buffer_new_and_alloc (10);
+  gst_adapter_push (adapter, buffer);
+  timestamp = gst_adapter_prev_pts_at_offset (adapter, 5, &distance);
+  fail_unless_equals_uint64 (timestamp, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_uint64 (distance, 5);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_adapter_suite (void)
 {
@@ -851,8 +1047,12 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_take_buf_order);
   tcase_add_test (tc_chain, test_timestamp);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_take_list);
   tcase_add_test (tc_chain, test_merge);
+  tcase_add_test (tc_chain, test_map_regions);
+  tcase_add_test (tc_chain, test_take_buffer_fast);
+  tcase_add_test (tc_chain, test_timestamp_at_offset);
 
   return s;
 }
@@ -0,0 +1,514 @@
+/* GStreamer
+ *
+ * unit test for GstBaseParse
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <gst/check/gstcheck.h>
+
+/* the index is private to baseparse, build our own copy so that the tests
+ * can get at it */
+#undef GST_CAT_DEFAULT
+#include "../../../libs/gst/base/gstbaseparse.c"
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+typedef struct _GstTestParse
+{
+  GstBaseParse parent;
+} GstTestParse;
+
+typedef struct _GstTestParseClass
+{
+  GstBaseParseClass parent_class;
+} GstTestParseClass;
+
+static GType gst_test_parse_get_type (void);
+
+G_DEFINE_TYPE (GstTestParse, gst_test_parse, GST_TYPE_BASE_PARSE);
+
+#define FRAME_SIZE 100
+
+static gboolean
+gst_test_parse_start (GstBaseParse * parse)
+{
+  gst_base_parse_set_min_frame_size (parse, FRAME_SIZE);
+  gst_base_parse_set_frame_rate (parse, 25, 1, 0, 0);
+
+  return TRUE;
+}
+
+/* splits the data in frames of FRAME_SIZE bytes, every fifth is a keyframe */
+static GstFlowReturn
+gst_test_parse_handle_frame (GstBaseParse * parse, GstBaseParseFrame * frame,
+    gint * skipsize)
+{
+  if (!gst_pad_has_current_caps (GST_BASE_PARSE_SRC_PAD (parse))) {
+    GstCaps *caps = gst_caps_new_empty_simple ("test/parsed");
+
+    gst_pad_set_caps (GST_BASE_PARSE_SRC_PAD (parse), caps);
+    gst_caps_unref (caps);
+  }
+
+  if (gst_buffer_get_size (frame->buffer) < FRAME_SIZE)
+    return GST_FLOW_OK;
+
+  if ((frame->offset / FRAME_SIZE) % 5 != 0)
+    GST_BUFFER_FLAG_SET (frame->buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+  return gst_base_parse_finish_frame (parse, frame, FRAME_SIZE);
+}
+
+static void
+gst_test_parse_class_init (GstTestParseClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstBaseParseClass *parse_class = GST_BASE_PARSE_CLASS (klass);
+
+  parse_class->start = gst_test_parse_start;
+  parse_class->handle_frame = gst_test_parse_handle_frame;
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sink_template));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&src_template));
+  gst_element_class_set_static_metadata (element_class, "Test parser",
+      "Codec/Parser", "Test parser", "Nobody <nobody@example.com>");
+}
+
+static void
+gst_test_parse_init (GstTestParse * parse)
+{
+}
+
+#define UPSTREAM_SIZE 10000
+#define N_ENTRIES     5
+
+/* creates a parser with its own, empty index */
+static GstBaseParse *
+setup_parse (void)
+{
+  GstBaseParse *parse;
+
+  parse = g_object_new (gst_test_parse_get_type (), NULL);
+  GST_BASE_PARSE_INDEX_LOCK (parse);
+  gst_base_parse_create_own_index (parse);
+  GST_BASE_PARSE_INDEX_UNLOCK (parse);
+  parse->priv->upstream_seekable = TRUE;
+  parse->priv->upstream_size = UPSTREAM_SIZE;
+
+  return parse;
+}
+
+/* adds entries at 1..N_ENTRIES seconds and 1000..N_ENTRIES * 1000 bytes, the
+ * odd ones are keyframes */
+static void
+fill_index (GstBaseParse * parse)
+{
+  gint i;
+
+  for (i = 1; i <= N_ENTRIES; i++) {
+    fail_unless (gst_base_parse_add_index_entry (parse, i * 1000,
+            i * GST_SECOND, (i % 2) == 1, TRUE));
+  }
+}
+
+static gchar *
+create_index_location (void)
+{
+  gchar *location;
+  gint fd;
+
+  fd = g_file_open_tmp ("baseparse-index-XXXXXX", &location, NULL);
+  fail_unless (fd != -1);
+  close (fd);
+  g_remove (location);
+
+  return location;
+}
+
+/* looks up @ts, returns the offset of the entry found or -1 */
+static gint64
+lookup (GstBaseParse * parse, GstIndexLookupMethod method,
+    GstIndexAssociationFlags flags, GstClockTime ts)
+{
+  GstIndexEntry *entry;
+  gint64 offset = -1;
+
+  entry = gst_index_get_assoc_entry (parse->priv->index,
+      parse->priv->index_id, method, flags, GST_FORMAT_TIME, ts);
+  if (entry)
+    fail_unless (gst_index_entry_assoc_map (entry, GST_FORMAT_BYTES, &offset));
+
+  return offset;
+}
+
+GST_START_TEST (baseparse_index_lookup_empty)
+{
+  GstBaseParse *parse;
+
+  parse = setup_parse ();
+
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), -1);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND), -1);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), -1);
+
+  gst_object_unref (parse);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (baseparse_index_lookup_exact)
+{
+  GstBaseParse *parse;
+
+  parse = setup_parse ();
+  fill_index (parse);
+
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND), 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, N_ENTRIES * GST_SECOND),
+      N_ENTRIES * 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 3 * GST_SECOND), 3000);
+
+  /* between, before the first and after the last entry */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND + 1), -1);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), -1);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, (N_ENTRIES + 1) * GST_SECOND), -1);
+
+  /* the entry at 2 seconds is not a keyframe */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 2 * GST_SECOND), -1);
+
+  gst_object_unref (parse);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (baseparse_index_lookup_before)
+{
+  GstBaseParse *parse;
+
+  parse = setup_parse ();
+  fill_index (parse);
+
+  /* nothing before the first entry */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND - 1), -1);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND), 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 2 * GST_SECOND + 1), 2000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, N_ENTRIES * GST_SECOND),
+      N_ENTRIES * 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, G_MAXINT64), N_ENTRIES * 1000);
+
+  /* skips the entries that are not keyframes */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 4 * GST_SECOND), 3000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 2 * GST_SECOND), 1000);
+
+  gst_object_unref (parse);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (baseparse_index_lookup_after)
+{
+  GstBaseParse *parse;
+
+  parse = setup_parse ();
+  fill_index (parse);
+
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, GST_SECOND), 1000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 3 * GST_SECOND - 1), 3000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, N_ENTRIES * GST_SECOND),
+      N_ENTRIES * 1000);
+  /* nothing after the last entry */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, N_ENTRIES * GST_SECOND + 1), -1);
+
+  /* skips the entries that are not keyframes */
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 2 * GST_SECOND), 3000);
+  fail_unless_equals_int (lookup (parse, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 4 * GST_SECOND), 5000);
+
+  gst_object_unref (parse);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (baseparse_index_round_trip)
+{
+  GstBaseParse *parse, *loaded;
+  GArray *saved_entries, *loaded_entries;
+  gchar *location;
+  guint i;
+
+  location = create_index_location ();
+
+  parse = setup_parse ();
+  fill_index (parse);
+  gst_base_parse_save_index (parse, location);
+  fail_unless (g_file_test (location, G_FILE_TEST_EXISTS));
+
+  loaded = setup_parse ();
+  gst_base_parse_load_index (loaded, location);
+  fail_unless_equals_int (loaded->priv->index_file_size, UPSTREAM_SIZE);
+
+  saved_entries = gst_mem_index_get_entries (GST_MEM_INDEX (parse->priv->index),
+      parse->priv->index_id, GST_FORMAT_TIME);
+  loaded_entries =
+      gst_mem_index_get_entries (GST_MEM_INDEX (loaded->priv->index),
+      loaded->priv->index_id, GST_FORMAT_TIME);
+  fail_unless (saved_entries != NULL);
+  fail_unless (loaded_entries != NULL);
+  fail_unless_equals_int (saved_entries->len, N_ENTRIES);
+  fail_unless_equals_int (loaded_entries->len, N_ENTRIES);
+
+  for (i = 0; i < N_ENTRIES; i++) {
+    GstIndexEntry *saved = g_array_index (saved_entries, GstIndexEntry *, i);
+    GstIndexEntry *entry = g_array_index (loaded_entries, GstIndexEntry *, i);
+    gint64 saved_ts, saved_offset, ts, offset;
+
+    fail_unless (gst_index_entry_assoc_map (saved, GST_FORMAT_TIME,
+            &saved_ts));
+    fail_unless (gst_index_entry_assoc_map (saved, GST_FORMAT_BYTES,
+            &saved_offset));
+    fail_unless (gst_index_entry_assoc_map (entry, GST_FORMAT_TIME, &ts));
+    fail_unless (gst_index_entry_assoc_map (entry, GST_FORMAT_BYTES, &offset));
+
+    fail_unless_equals_uint64 (ts, saved_ts);
+    fail_unless_equals_uint64 (offset, saved_offset);
+    fail_unless_equals_int (GST_INDEX_ASSOC_FLAGS (entry),
+        GST_INDEX_ASSOC_FLAGS (saved));
+  }
+
+  /* the loaded index answers the same lookups at the edges */
+  fail_unless_equals_int (lookup (loaded, GST_INDEX_LOOKUP_BEFORE,
+          GST_INDEX_ASSOCIATION_FLAG_KEY_UNIT, 4 * GST_SECOND), 3000);
+  fail_unless_equals_int (lookup (loaded, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), 1000);
+  fail_unless_equals_int (lookup (loaded, GST_INDEX_LOOKUP_EXACT,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, N_ENTRIES * GST_SECOND),
+      N_ENTRIES * 1000);
+
+  gst_object_unref (loaded);
+  gst_object_unref (parse);
+  g_remove (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (baseparse_index_round_trip_empty)
+{
+  GstBaseParse *parse, *loaded;
+  gchar *location;
+
+  location = create_index_location ();
+
+  /* an empty index does not create a file */
+  parse = setup_parse ();
+  gst_base_parse_save_index (parse, location);
+  fail_if (g_file_test (location, G_FILE_TEST_EXISTS));
+
+  /* and loading a missing file leaves the index empty */
+  loaded = setup_parse ();
+  gst_base_parse_load_index (loaded, location);
+  fail_unless_equals_int (loaded->priv->index_file_size, -1);
+  fail_unless_equals_int (lookup (loaded, GST_INDEX_LOOKUP_AFTER,
+          GST_INDEX_ASSOCIATION_FLAG_NONE, 0), -1);
+
+  gst_object_unref (loaded);
+  gst_object_unref (parse);
+  g_free (location);
+}
+
+GST_END_TEST;
+
+static GstStaticPadTemplate mysrctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+static GstStaticPadTemplate mysinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+#define N_INPUT_BUFFERS   3
+#define FRAMES_PER_BUFFER 10
+
+/* parses N_INPUT_BUFFERS buffers of FRAMES_PER_BUFFER frames each and
+ * returns the parsed buffers */
+static GList *
+run_parse (guint max_frames)
+{
+  GstElement *parse;
+  GstPad *srcpad, *sinkpad;
+  GstCaps *caps;
+  GstSegment segment;
+  GList *result;
+  gint i;
+
+  parse = g_object_new (gst_test_parse_get_type (), NULL);
+  gst_base_parse_set_frame_batching (GST_BASE_PARSE (parse), max_frames,
+      GST_CLOCK_TIME_NONE);
+  srcpad = gst_check_setup_src_pad (parse, &mysrctemplate);
+  sinkpad = gst_check_setup_sink_pad (parse, &mysinktemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_element_set_state (parse, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  caps = gst_caps_new_empty_simple ("test/unparsed");
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < N_INPUT_BUFFERS; i++) {
+    GstBuffer *buffer;
+
+    buffer = gst_buffer_new_allocate (NULL, FRAMES_PER_BUFFER * FRAME_SIZE,
+        NULL);
+    gst_buffer_memset (buffer, 0, i, FRAMES_PER_BUFFER * FRAME_SIZE);
+    fail_unless_equals_int (gst_pad_push (srcpad, buffer), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+
+  result = buffers;
+  buffers = NULL;
+
+  gst_element_set_state (parse, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (parse);
+  gst_check_teardown_sink_pad (parse);
+  gst_check_teardown_element (parse);
+
+  return result;
+}
+
+static void
+check_same_buffers (GList * expected, GList * result)
+{
+  fail_unless_equals_int (g_list_length (result), g_list_length (expected));
+
+  for (; expected && result; expected = expected->next, result = result->next) {
+    GstBuffer *exp = GST_BUFFER (expected->data);
+    GstBuffer *buf = GST_BUFFER (result->data);
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), GST_BUFFER_PTS (exp));
+    fail_unless_equals_uint64 (GST_BUFFER_DTS (buf), GST_BUFFER_DTS (exp));
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf),
+        GST_BUFFER_DURATION (exp));
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf),
+        GST_BUFFER_OFFSET (exp));
+    fail_unless_equals_int (gst_buffer_get_size (buf),
+        gst_buffer_get_size (exp));
+    fail_unless_equals_int (GST_BUFFER_FLAG_IS_SET (buf,
+            GST_BUFFER_FLAG_DELTA_UNIT), GST_BUFFER_FLAG_IS_SET (exp,
+            GST_BUFFER_FLAG_DELTA_UNIT));
+  }
+}
+
+static void
+free_buffers (GList * list)
+{
+  g_list_foreach (list, (GFunc) gst_mini_object_unref, NULL);
+  g_list_free (list);
+}
+
+GST_START_TEST (baseparse_frame_batching)
+{
+  GList *expected, *result, *l;
+  GstClockTime ts = 0;
+  guint64 offset = 0;
+
+  expected = run_parse (0);
+  fail_unless_equals_int (g_list_length (expected),
+      N_INPUT_BUFFERS * FRAMES_PER_BUFFER);
+
+  /* the unbatched frames are timestamped from the frame rate */
+  for (l = expected; l; l = l->next) {
+    GstBuffer *buf = GST_BUFFER (l->data);
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), ts);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), offset);
+    fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf), GST_SECOND / 25);
+    ts += GST_SECOND / 25;
+    offset += FRAME_SIZE;
+  }
+
+  /* batches that fill up in the middle of an input buffer */
+  result = run_parse (4);
+  check_same_buffers (expected, result);
+  free_buffers (result);
+
+  /* batches that are pushed when an input buffer is done */
+  result = run_parse (FRAMES_PER_BUFFER * 2);
+  check_same_buffers (expected, result);
+  free_buffers (result);
+
+  free_buffers (expected);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_baseparse_suite (void)
+{
+  Suite *s = suite_create ("GstBaseParse");
+  TCase *tc = tcase_create ("general");
+
+  suite_add_tcase (s, tc);
+  tcase_add_test (tc, baseparse_index_lookup_empty);
+  tcase_add_test (tc, baseparse_index_lookup_exact);
+  tcase_add_test (tc, baseparse_index_lookup_before);
+  tcase_add_test (tc, baseparse_index_lookup_after);
+  tcase_add_test (tc, baseparse_index_round_trip);
+  tcase_add_test (tc, baseparse_index_round_trip_empty);
+  tcase_add_test (tc, baseparse_frame_batching);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_baseparse);
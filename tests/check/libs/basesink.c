@@ -117,6 +117,370 @@ GST_START_TEST (basesink_last_sample_disabled)
 
 GST_END_TEST;
 
+static void
+batch_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    GList ** positions)
+{
+  *positions = g_list_append (*positions,
+      GUINT_TO_POINTER (GST_BASE_SINK (sink)->segment.position / GST_MSECOND));
+}
+
+GST_START_TEST (basesink_batch_lists)
+{
+  GstElement *src, *sink, *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GList *positions = NULL, *l;
+  gint i;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  bus = gst_element_get_bus (pipeline);
+
+  /* 2 lists of 4 buffers of 10ms each */
+  g_object_set (src, "num-buffers", 2, "generate-lists", 4, "rate", 100.0,
+      NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, NULL);
+  gst_base_sink_set_batch_lists (GST_BASE_SINK (sink), TRUE);
+  fail_unless (gst_base_sink_get_batch_lists (GST_BASE_SINK (sink)));
+  g_signal_connect (sink, "handoff", G_CALLBACK (batch_handoff), &positions);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* all buffers were rendered and the position was updated once per list to
+   * the end of its last buffer */
+  fail_unless_equals_int (g_list_length (positions), 8);
+  for (l = positions, i = 0; l; l = l->next, i++)
+    fail_unless_equals_int (GPOINTER_TO_UINT (l->data), (i / 4 + 1) * 40);
+  g_list_free (positions);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (basesink_sync_window)
+{
+  GstElement *src, *sink, *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  gint64 start;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  bus = gst_element_get_bus (pipeline);
+
+  /* 2 seconds of data, all within the sync window */
+  g_object_set (src, "num-buffers", 20, "rate", 10.0, "format",
+      GST_FORMAT_TIME, NULL);
+  g_object_set (sink, "sync", TRUE, NULL);
+  gst_base_sink_set_sync_window (GST_BASE_SINK (sink), 10 * GST_SECOND);
+  fail_unless_equals_uint64 (gst_base_sink_get_sync_window (GST_BASE_SINK
+          (sink)), 10 * GST_SECOND);
+
+  start = g_get_monotonic_time ();
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* nothing waited for the clock */
+  fail_unless (g_get_monotonic_time () - start < G_USEC_PER_SEC);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (basesink_fast_start)
+{
+  GstElement *src, *sink, *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  gboolean eos = FALSE;
+  gint async_messages = 0;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  g_object_set (src, "is-live", TRUE, "num-buffers", 5, NULL);
+  g_object_set (sink, "fast-start", TRUE, NULL);
+  fail_unless (gst_base_sink_get_fast_start (GST_BASE_SINK (sink)));
+
+  bus = gst_element_get_bus (pipeline);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      == GST_STATE_CHANGE_NO_PREROLL);
+
+  /* the sink does not do an async state change */
+  while (!eos) {
+    msg = gst_bus_timed_pop (bus, GST_CLOCK_TIME_NONE);
+    fail_unless (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_ERROR);
+    if (GST_MESSAGE_SRC (msg) == GST_OBJECT (sink) &&
+        (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_START ||
+            GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ASYNC_DONE))
+      async_messages++;
+    eos = GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS;
+    gst_message_unref (msg);
+  }
+  fail_unless_equals_int (async_messages, 0);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  /* not live, the sink prerolls */
+  g_object_set (src, "is-live", FALSE, NULL);
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      == GST_STATE_CHANGE_ASYNC);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (basesink_stats)
+{
+  GstElement *src, *sink, *pipeline;
+  GstStructure *stats;
+  GstBus *bus;
+  GstMessage *msg;
+  guint64 rendered, dropped, render_time, p50, p99;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  bus = gst_element_get_bus (pipeline);
+
+  g_object_set (src, "num-buffers", 10, "rate", 100.0, "format",
+      GST_FORMAT_TIME, NULL);
+  g_object_set (sink, "sync", TRUE, "qos", TRUE, NULL);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  g_object_get (sink, "stats", &stats, NULL);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_has_name (stats, "GstBaseSinkStats"));
+  fail_unless (gst_structure_get_uint64 (stats, "rendered", &rendered));
+  fail_unless (gst_structure_get_uint64 (stats, "dropped", &dropped));
+  fail_unless_equals_uint64 (rendered + dropped, 10);
+  fail_unless (gst_structure_get_uint64 (stats, "max-render-time",
+          &render_time));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (render_time));
+  fail_unless (gst_structure_get_uint64 (stats, "lateness-p50", &p50));
+  fail_unless (gst_structure_get_uint64 (stats, "lateness-p99", &p99));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (p50));
+  fail_unless (p50 <= p99);
+  gst_structure_free (stats);
+
+  /* going to READY resets the stats */
+  gst_element_set_state (pipeline, GST_STATE_READY);
+  stats = gst_base_sink_get_stats (GST_BASE_SINK (sink));
+  fail_unless (gst_structure_get_uint64 (stats, "rendered", &rendered));
+  fail_unless_equals_uint64 (rendered, 0);
+  fail_unless (gst_structure_get_uint64 (stats, "lateness-p50", &p50));
+  fail_unless (!GST_CLOCK_TIME_IS_VALID (p50));
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static GThread *src_thread, *render_thread;
+static gint rendered;
+
+static void
+src_handoff (GstElement * src, GstBuffer * buffer, GstPad * pad, gpointer u)
+{
+  src_thread = g_thread_self ();
+}
+
+static void
+sink_handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad, gpointer u)
+{
+  render_thread = g_thread_self ();
+  rendered++;
+}
+
+GST_START_TEST (basesink_render_queue)
+{
+  GstElement *src, *sink, *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+
+  pipeline = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = gst_element_factory_make ("fakesrc", "src");
+
+  fail_unless (gst_bin_add (GST_BIN (pipeline), src) == TRUE);
+  fail_unless (gst_bin_add (GST_BIN (pipeline), sink) == TRUE);
+  fail_unless (gst_element_link (src, sink) == TRUE);
+
+  bus = gst_element_get_bus (pipeline);
+
+  src_thread = render_thread = NULL;
+  rendered = 0;
+  g_object_set (src, "num-buffers", 10, "signal-handoffs", TRUE, NULL);
+  g_object_set (sink, "signal-handoffs", TRUE, "render-queue-size", 2, NULL);
+  fail_unless_equals_int (gst_base_sink_get_render_queue_size (GST_BASE_SINK
+          (sink)), 2);
+  g_signal_connect (src, "handoff", G_CALLBACK (src_handoff), NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (sink_handoff), NULL);
+
+  fail_unless (gst_element_set_state (pipeline, GST_STATE_PLAYING)
+      != GST_STATE_CHANGE_FAILURE);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  /* all buffers were rendered before the EOS, in another thread */
+  fail_unless_equals_int (rendered, 10);
+  fail_unless (src_thread != NULL);
+  fail_unless (render_thread != NULL);
+  fail_unless (render_thread != src_thread);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+/* a sink that refuses all caps */
+typedef GstBaseSink TestRefuseSink;
+typedef GstBaseSinkClass TestRefuseSinkClass;
+
+GType test_refuse_sink_get_type (void);
+G_DEFINE_TYPE (TestRefuseSink, test_refuse_sink, GST_TYPE_BASE_SINK);
+
+static gint refuse_rendered;
+
+static gboolean
+test_refuse_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
+{
+  return FALSE;
+}
+
+static GstFlowReturn
+test_refuse_sink_render (GstBaseSink * sink, GstBuffer * buffer)
+{
+  g_atomic_int_inc (&refuse_rendered);
+  return GST_FLOW_OK;
+}
+
+static void
+test_refuse_sink_class_init (TestRefuseSinkClass * klass)
+{
+  static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+      GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&sink_template));
+  klass->set_caps = test_refuse_sink_set_caps;
+  klass->render = test_refuse_sink_render;
+}
+
+static void
+test_refuse_sink_init (TestRefuseSink * sink)
+{
+}
+
+/* the caps are refused in the render thread, after upstream was told that
+ * the event was handled */
+GST_START_TEST (basesink_render_queue_refused_caps)
+{
+  GstElement *sink;
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gint i;
+
+  sink = g_object_new (test_refuse_sink_get_type (), "async", FALSE,
+      "render-queue-size", 2, NULL);
+  refuse_rendered = 0;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_element_set_state (sink, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_SUCCESS);
+
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_caps (gst_caps_new_empty_simple ("foo/bar"))));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  /* the refusal is returned as soon as the render thread handled the caps */
+  for (i = 0; i < 1000 && ret == GST_FLOW_OK; i++) {
+    ret = gst_pad_push (srcpad, gst_buffer_new ());
+    if (ret == GST_FLOW_OK)
+      g_usleep (1000);
+  }
+  fail_unless_equals_int (ret, GST_FLOW_NOT_NEGOTIATED);
+  fail_unless_equals_int (g_atomic_int_get (&refuse_rendered), 0);
+
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_object_unref (sinkpad);
+  gst_object_unref (srcpad);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_basesrc_suite (void)
 {
@@ -126,6 +490,12 @@ gst_basesrc_suite (void)
   suite_add_tcase (s, tc);
   tcase_add_test (tc, basesink_last_sample_enabled);
   tcase_add_test (tc, basesink_last_sample_disabled);
+  tcase_add_test (tc, basesink_batch_lists);
+  tcase_add_test (tc, basesink_sync_window);
+  tcase_add_test (tc, basesink_stats);
+  tcase_add_test (tc, basesink_fast_start);
+  tcase_add_test (tc, basesink_render_queue);
+  tcase_add_test (tc, basesink_render_queue_refused_caps);
 
   return s;
 }
@@ -27,6 +27,7 @@
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstconsistencychecker.h>
 #include <gst/base/gstbasesrc.h>
+#include <gst/base/gstpushsrc.h>
 
 static GstPadProbeReturn
 eos_event_counter (GstObject * pad, GstPadProbeInfo * info, guint * p_num_eos)
@@ -602,6 +603,105 @@ GST_START_TEST (basesrc_seek_events_rate_update)
 
 GST_END_TEST;
 
+#define LIST_SRC_N_LISTS 5
+#define LIST_SRC_LIST_LENGTH 4
+
+/* a push source that produces its buffers in lists */
+typedef GstPushSrc GstListSrc;
+typedef GstPushSrcClass GstListSrcClass;
+
+GType gst_list_src_get_type (void);
+G_DEFINE_TYPE (GstListSrc, gst_list_src, GST_TYPE_PUSH_SRC);
+
+static GstStaticPadTemplate list_src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+static guint list_src_created;
+
+static GstFlowReturn
+gst_list_src_create_list (GstPushSrc * src, GstBufferList ** list)
+{
+  gint i;
+
+  if (list_src_created == LIST_SRC_N_LISTS)
+    return GST_FLOW_EOS;
+  list_src_created++;
+
+  *list = gst_buffer_list_new ();
+  for (i = 0; i < LIST_SRC_LIST_LENGTH; i++)
+    gst_buffer_list_add (*list, gst_buffer_new_allocate (NULL, 16, NULL));
+
+  return GST_FLOW_OK;
+}
+
+static void
+gst_list_src_class_init (GstListSrcClass * klass)
+{
+  gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
+      gst_static_pad_template_get (&list_src_template));
+  klass->create_list = gst_list_src_create_list;
+}
+
+static void
+gst_list_src_init (GstListSrc * src)
+{
+}
+
+static GstPadProbeReturn
+buffer_list_counter (GstPad * pad, GstPadProbeInfo * info, guint * p_num)
+{
+  GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+
+  fail_unless (GST_IS_BUFFER_LIST (list));
+  fail_unless_equals_int (gst_buffer_list_length (list),
+      LIST_SRC_LIST_LENGTH);
+  *p_num += 1;
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* pushsrc_create_list:
+ *  - make sure the lists of a create_list implementation are pushed as they
+ *    are
+ */
+GST_START_TEST (pushsrc_create_list)
+{
+  GstElement *src, *sink, *pipe;
+  GstMessage *msg;
+  GstBus *bus;
+  GstPad *srcpad;
+  guint num_lists = 0;
+
+  list_src_created = 0;
+
+  pipe = gst_pipeline_new ("pipeline");
+  sink = gst_element_factory_make ("fakesink", "sink");
+  src = g_object_new (gst_list_src_get_type (), NULL);
+
+  gst_bin_add (GST_BIN (pipe), src);
+  gst_bin_add (GST_BIN (pipe), sink);
+  fail_unless (gst_element_link (src, sink));
+
+  srcpad = gst_element_get_static_pad (src, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) buffer_list_counter, &num_lists, NULL);
+  gst_object_unref (srcpad);
+
+  bus = gst_element_get_bus (pipe);
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  fail_unless_equals_int (num_lists, LIST_SRC_N_LISTS);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipe);
+}
+
+GST_END_TEST;
 
 static Suite *
 gst_basesrc_suite (void)
@@ -617,6 +717,7 @@ gst_basesrc_suite (void)
   tcase_add_test (tc, basesrc_eos_events_push_live_eos);
   tcase_add_test (tc, basesrc_eos_events_pull_live_eos);
   tcase_add_test (tc, basesrc_seek_events_rate_update);
+  tcase_add_test (tc, pushsrc_create_list);
 
   return s;
 }
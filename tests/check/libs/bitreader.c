@@ -235,6 +235,61 @@ GST_START_TEST (test_position_tracking)
 
 GST_END_TEST;
 
+GST_START_TEST (test_exp_golomb)
+{
+  /* 1 010 011 00100 00101 0001000 000000000 1111111111 00000 */
+  guint8 data[] = { 0xa6, 0x42, 0x88, 0x00, 0x7f, 0xe0 };
+  guint8 zeros[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+  guint8 big[] = { 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00 };
+  /* 1111, 31 zero bits, 1, 31 one bits */
+  guint8 longest[] = { 0xf0, 0x00, 0x00, 0x00, 0x1f, 0xff, 0xff, 0xff, 0xe0 };
+  GstBitReader reader = GST_BIT_READER_INIT (data, sizeof (data));
+  guint32 u = 0;
+  gint32 i = 0;
+
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (u, 0);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (u, 1);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &i));
+  fail_unless_equals_int (i, -1);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &i));
+  fail_unless_equals_int (i, 2);
+  fail_unless (gst_bit_reader_get_exp_golomb_int32 (&reader, &i));
+  fail_unless_equals_int (i, -2);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (u, 7);
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 24);
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (u, 1022);
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 43);
+  /* only zero bits are left */
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 43);
+
+  gst_bit_reader_init (&reader, zeros, sizeof (zeros));
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+
+  /* 32 leading zeros do not fit into 32 bits */
+  gst_bit_reader_init (&reader, big, sizeof (big));
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+
+  /* the longest code does not fit into the 64 bit cache at this position */
+  gst_bit_reader_init (&reader, longest, sizeof (longest));
+  fail_unless (gst_bit_reader_skip (&reader, 4));
+  fail_unless (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_uint64 (u, G_MAXUINT32 - 1);
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 67);
+
+  /* and is cut off at the end */
+  gst_bit_reader_init (&reader, longest, sizeof (longest) - 1);
+  fail_unless (gst_bit_reader_skip (&reader, 4));
+  fail_if (gst_bit_reader_get_exp_golomb_uint32 (&reader, &u));
+  fail_unless_equals_int (gst_bit_reader_get_pos (&reader), 4);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_bit_reader_suite (void)
 {
@@ -246,6 +301,7 @@ gst_bit_reader_suite (void)
   tcase_add_test (tc_chain, test_initialization);
   tcase_add_test (tc_chain, test_get_bits);
   tcase_add_test (tc_chain, test_position_tracking);
+  tcase_add_test (tc_chain, test_exp_golomb);
 
   return s;
 }
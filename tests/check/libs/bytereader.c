@@ -376,6 +376,47 @@ GST_END_TEST;
   fail_if (gst_byte_reader_peek_float##bits##_##endianness (reader, &dest)); \
 }
 
+GST_START_TEST (test_get_uint_array)
+{
+  guint8 data[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11
+  };
+  GstByteReader reader = GST_BYTE_READER_INIT (data, 17);
+  guint16 a[8] = { 0, };
+  guint32 b[4] = { 0, };
+  guint i;
+
+  fail_unless (gst_byte_reader_get_uint16_array_be (&reader, a, 8));
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (a[i], GST_READ_UINT16_BE (data + 2 * i));
+  fail_unless_equals_int (gst_byte_reader_get_pos (&reader), 16);
+  fail_if (gst_byte_reader_get_uint16_array_be (&reader, a, 1));
+  fail_unless_equals_int (gst_byte_reader_get_pos (&reader), 16);
+  fail_unless (gst_byte_reader_get_uint16_array_be (&reader, a, 0));
+
+  fail_unless (gst_byte_reader_set_pos (&reader, 1));
+  fail_unless (gst_byte_reader_get_uint16_array_le (&reader, a, 8));
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (a[i], GST_READ_UINT16_LE (data + 1 + 2 * i));
+
+  fail_unless (gst_byte_reader_set_pos (&reader, 1));
+  fail_unless (gst_byte_reader_get_uint32_array_be (&reader, b, 4));
+  for (i = 0; i < 4; i++)
+    fail_unless_equals_int (b[i], GST_READ_UINT32_BE (data + 1 + 4 * i));
+
+  fail_unless (gst_byte_reader_set_pos (&reader, 0));
+  fail_unless (gst_byte_reader_get_uint32_array_le (&reader, b, 4));
+  for (i = 0; i < 4; i++)
+    fail_unless_equals_int (b[i], GST_READ_UINT32_LE (data + 4 * i));
+  fail_unless_equals_int (gst_byte_reader_get_pos (&reader), 16);
+
+  fail_unless (gst_byte_reader_set_pos (&reader, 2));
+  fail_if (gst_byte_reader_get_uint32_array_le (&reader, b, 4));
+  fail_unless_equals_int (gst_byte_reader_get_pos (&reader), 2);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_get_float_le)
 {
   guint8 data[] = {
@@ -557,6 +598,35 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+GST_START_TEST (test_scan_start_code)
+{
+  GstByteReader reader;
+  guint8 data[1000];
+
+  /* start codes in a lot of zeros */
+  memset (data, 0, sizeof (data));
+  data[500] = 0x00;
+  data[501] = 0x00;
+  data[502] = 0x01;
+  data[503] = 0x65;
+  data[900] = 0x01;
+  data[999] = 0x01;
+
+  gst_byte_reader_init (&reader, data, sizeof (data));
+
+  do_scan (&reader, 0xffffff00, 0x00000100, 0, 1000, 500);
+  do_scan (&reader, 0xffffffff, 0x00000001, 0, 1000, 499);
+  do_scan (&reader, 0xffffffff, 0x00000165, 0, 1000, 500);
+  do_scan (&reader, 0xffffff00, 0x00000100, 501, 499, 898);
+  do_scan (&reader, 0xffffffff, 0x00000001, 500, 500, 897);
+  do_scan (&reader, 0xffffffff, 0x00000001, 898, 102, 996);
+  /* the start code must lie within the scanned range */
+  do_scan (&reader, 0xffffff00, 0x00000100, 899, 101, -1);
+  do_scan (&reader, 0xffffffff, 0x00000001, 897, 3, -1);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_string_funcs)
 {
   GstByteReader reader, backup;
@@ -699,10 +769,12 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_uint_be);
   tcase_add_test (tc_chain, test_get_int_le);
   tcase_add_test (tc_chain, test_get_int_be);
+  tcase_add_test (tc_chain, test_get_uint_array);
   tcase_add_test (tc_chain, test_get_float_le);
   tcase_add_test (tc_chain, test_get_float_be);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
 
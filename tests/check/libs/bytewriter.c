@@ -172,6 +172,67 @@ GST_START_TEST (test_write_non_fixed)
 
 GST_END_TEST;
 
+GST_START_TEST (test_write_chunked)
+{
+  GstByteWriter writer;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint8 *data;
+  guint8 ref[80];
+  guint i;
+
+  for (i = 0; i < sizeof (ref); i++)
+    ref[i] = i;
+
+  gst_byte_writer_init_chunked (&writer, 16);
+  fail_unless_equals_int (gst_byte_writer_get_remaining (&writer), -1);
+
+  /* fills the first chunk */
+  fail_unless (gst_byte_writer_put_data (&writer, ref, 14));
+  fail_unless (gst_byte_writer_put_uint32_be (&writer, 0x0e0f1011));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&writer), 18);
+  fail_unless_equals_int (gst_byte_writer_get_size (&writer), 18);
+
+  /* bigger than a chunk */
+  fail_unless (gst_byte_writer_put_data (&writer, ref + 18, 30));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&writer), 48);
+
+  /* rewrite inside of the current chunk and across its end */
+  fail_unless (gst_byte_writer_put_data (&writer, ref + 48, 14));
+  fail_unless (gst_byte_writer_set_pos (&writer, 52));
+  fail_unless_equals_int (gst_byte_reader_get_remaining (GST_BYTE_READER
+          (&writer)), 10);
+  fail_unless (gst_byte_writer_put_data (&writer, ref + 52, 28));
+  fail_unless_equals_int (gst_byte_writer_get_pos (&writer), 80);
+  fail_unless_equals_int (gst_byte_writer_get_size (&writer), 80);
+
+  /* completed chunks can not be written anymore */
+  fail_if (gst_byte_writer_set_pos (&writer, 10));
+
+  buffer = gst_byte_writer_reset_and_get_buffer (&writer);
+  fail_unless (gst_buffer_n_memory (buffer) > 1);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 80);
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  fail_unless (memcmp (map.data, ref, 80) == 0);
+  gst_buffer_unmap (buffer, &map);
+  gst_buffer_unref (buffer);
+
+  gst_byte_writer_init_chunked (&writer, 0);
+  fail_unless (gst_byte_writer_put_data (&writer, ref, 64));
+  fail_unless (gst_byte_writer_put_string (&writer, "foo"));
+  data = gst_byte_writer_reset_and_get_data (&writer);
+  fail_unless (memcmp (data, ref, 64) == 0);
+  fail_unless (memcmp (data + 64, "foo", 4) == 0);
+  g_free (data);
+
+  gst_byte_writer_init_chunked (&writer, 16);
+  buffer = gst_byte_writer_reset_and_get_buffer (&writer);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), 0);
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_from_data)
 {
   GstByteWriter writer;
@@ -247,6 +308,7 @@ gst_byte_writer_suite (void)
   tcase_add_test (tc_chain, test_initialization);
   tcase_add_test (tc_chain, test_write_fixed);
   tcase_add_test (tc_chain, test_write_non_fixed);
+  tcase_add_test (tc_chain, test_write_chunked);
   tcase_add_test (tc_chain, test_from_data);
   tcase_add_test (tc_chain, test_put_data_strings);
   tcase_add_test (tc_chain, test_fill);
@@ -119,6 +119,30 @@ push_event (gpointer user_data)
   return NULL;
 }
 
+static gpointer
+push_buffer_segment (gpointer user_data)
+{
+  GstFlowReturn flow;
+  GstCaps *caps;
+  GstSegment segment;
+  TestData *test_data = (TestData *) user_data;
+
+  gst_pad_push_event (test_data->pad, gst_event_new_stream_start ("test"));
+
+  caps = gst_caps_new_empty_simple ("foo/x-bar");
+  gst_pad_push_event (test_data->pad, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (test_data->pad, gst_event_new_segment (&segment));
+
+  flow = gst_pad_push (test_data->pad, test_data->buffer);
+  fail_unless (flow == GST_FLOW_OK, "got flow %s instead of OK",
+      gst_flow_get_name (flow));
+
+  return NULL;
+}
+
 static void
 setup_default (void)
 {
@@ -430,6 +454,170 @@ GST_START_TEST (test_collect_default)
 
 GST_END_TEST;
 
+/* A live input without data does not stop the collection once the latency
+ * deadline passed */
+GST_START_TEST (test_collect_latency)
+{
+  GstElement *bin;
+  GstClock *clock;
+  GstBuffer *buf1, *tmp;
+  GThread *thread1;
+
+  bin = gst_bin_new (NULL);
+  gst_element_add_pad (bin, gst_object_ref (sinkpad1));
+  gst_element_add_pad (bin, gst_object_ref (sinkpad2));
+
+  clock = gst_system_clock_obtain ();
+  gst_element_set_clock (bin, clock);
+  gst_element_set_base_time (bin, gst_clock_get_time (clock));
+
+  data1 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad1, sizeof (TestData), NULL, TRUE);
+  fail_unless (data1 != NULL);
+
+  data2 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad2, sizeof (TestData), NULL, TRUE);
+  fail_unless (data2 != NULL);
+
+  gst_collect_pads_set_latency (collect, 10 * GST_MSECOND);
+
+  buf1 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf1) = 0;
+
+  /* start collect pads */
+  gst_collect_pads_start (collect);
+
+  /* only the first pad gets a buffer */
+  data1->pad = srcpad1;
+  data1->buffer = buf1;
+  thread1 = g_thread_try_new ("gst-check", push_buffer_segment, data1, NULL);
+
+  /* the deadline passes */
+  fail_unless_collected (TRUE);
+  fail_if (GST_COLLECT_PADS_STATE_IS_SET (data1, GST_COLLECT_PADS_STATE_GAP));
+  fail_unless (GST_COLLECT_PADS_STATE_IS_SET (data2,
+          GST_COLLECT_PADS_STATE_GAP));
+
+  tmp = gst_collect_pads_pop (collect, (GstCollectData *) data1);
+  fail_unless (tmp == buf1);
+
+  g_thread_join (thread1);
+
+  gst_collect_pads_stop (collect);
+
+  gst_buffer_unref (buf1);
+  gst_object_unref (clock);
+  gst_object_unref (bin);
+}
+
+GST_END_TEST;
+
+/* Buffers with the same timestamp are collected in the order the pads were
+ * added, independent of the order in which they arrived */
+GST_START_TEST (test_collect_default_same_timestamp)
+{
+  GstBuffer *buf1, *buf2, *tmp;
+  GThread *thread1, *thread2;
+
+  data1 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad1, sizeof (TestData), NULL, TRUE);
+  fail_unless (data1 != NULL);
+
+  data2 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad2, sizeof (TestData), NULL, TRUE);
+  fail_unless (data2 != NULL);
+
+  buf1 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf1) = GST_SECOND;
+  buf2 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf2) = GST_SECOND;
+
+  /* start collect pads */
+  gst_collect_pads_start (collect);
+
+  /* push the buffer of the second pad first */
+  data2->pad = srcpad2;
+  data2->buffer = buf2;
+  thread2 = g_thread_try_new ("gst-check", push_buffer, data2, NULL);
+  fail_unless_collected (FALSE);
+
+  data1->pad = srcpad1;
+  data1->buffer = buf1;
+  thread1 = g_thread_try_new ("gst-check", push_buffer, data1, NULL);
+
+  /* now both pads have a buffer */
+  fail_unless_collected (TRUE);
+
+  /* the buffer of the first pad was collected */
+  tmp = gst_collect_pads_pop (collect, (GstCollectData *) data1);
+  fail_unless (tmp == NULL);
+  tmp = gst_collect_pads_pop (collect, (GstCollectData *) data2);
+  fail_unless (tmp == buf2);
+
+  g_thread_join (thread1);
+  g_thread_join (thread2);
+
+  gst_collect_pads_stop (collect);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+}
+
+GST_END_TEST;
+
+/* With a queue depth larger than 1 the chain function returns before the
+ * buffer of the pad was collected */
+GST_START_TEST (test_collect_queue_depth)
+{
+  GstBuffer *buf1, *buf2, *tmp;
+  GThread *thread1, *thread2;
+
+  data1 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad1, sizeof (TestData), NULL, TRUE);
+  fail_unless (data1 != NULL);
+
+  data2 = (TestData *) gst_collect_pads_add_pad (collect,
+      sinkpad2, sizeof (TestData), NULL, TRUE);
+  fail_unless (data2 != NULL);
+
+  gst_collect_pads_set_queue_depth (collect, 2);
+
+  buf1 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf1) = 0;
+  buf2 = gst_buffer_new ();
+  GST_BUFFER_TIMESTAMP (buf2) = GST_SECOND;
+
+  /* start collect pads */
+  gst_collect_pads_start (collect);
+
+  data1->pad = srcpad1;
+  data1->buffer = buf1;
+  thread1 = g_thread_try_new ("gst-check", push_buffer, data1, NULL);
+  /* the push returns while the buffer is still queued */
+  g_thread_join (thread1);
+  fail_unless_collected (FALSE);
+
+  data2->pad = srcpad2;
+  data2->buffer = buf2;
+  thread2 = g_thread_try_new ("gst-check", push_buffer, data2, NULL);
+  g_thread_join (thread2);
+
+  /* now both pads have a buffer */
+  fail_unless_collected (TRUE);
+
+  tmp = gst_collect_pads_pop (collect, (GstCollectData *) data1);
+  fail_unless (tmp == NULL);
+  tmp = gst_collect_pads_pop (collect, (GstCollectData *) data2);
+  fail_unless (tmp == buf2);
+
+  gst_collect_pads_stop (collect);
+
+  gst_buffer_unref (buf1);
+  gst_buffer_unref (buf2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_collect_pads_suite (void)
 {
@@ -444,11 +632,14 @@ gst_collect_pads_suite (void)
   tcase_add_test (general, test_collect);
   tcase_add_test (general, test_collect_eos);
   tcase_add_test (general, test_collect_twice);
+  tcase_add_test (general, test_collect_latency);
 
   buffers = tcase_create ("buffers");
   suite_add_tcase (suite, buffers);
   tcase_add_checked_fixture (buffers, setup_buffer_cb, teardown);
   tcase_add_test (buffers, test_collect_default);
+  tcase_add_test (buffers, test_collect_default_same_timestamp);
+  tcase_add_test (buffers, test_collect_queue_depth);
 
   return suite;
 }
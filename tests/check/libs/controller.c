@@ -416,6 +416,49 @@ GST_START_TEST (controller_interpolation_linear)
 
 GST_END_TEST;
 
+/* test that syncing the same timestamp again picks up changed control
+ * points */
+GST_START_TEST (controller_sync_same_timestamp)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstElement *elem;
+
+  elem = gst_element_factory_make ("testobj", NULL);
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  fail_unless (gst_object_add_control_binding (GST_OBJECT (elem),
+          gst_direct_control_binding_new (GST_OBJECT (elem), "int", cs)));
+
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+
+  fail_unless (gst_timed_value_control_source_set (tvcs, 0 * GST_SECOND, 0.0));
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND, 1.0));
+
+  fail_unless (gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND));
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 50);
+  fail_unless (gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND));
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 50);
+
+  /* changing the control points must not be skipped */
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND, 0.5));
+  fail_unless (gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND));
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 25);
+
+  /* a control value change that maps to the same integer */
+  fail_unless (gst_timed_value_control_source_set (tvcs, 2 * GST_SECOND,
+          0.501));
+  fail_unless (gst_object_sync_values (GST_OBJECT (elem), 1 * GST_SECOND));
+  fail_unless_equals_int (GST_TEST_OBJ (elem)->val_int, 25);
+
+  gst_object_unref (cs);
+  gst_object_unref (elem);
+}
+
+GST_END_TEST;
+
 /* test timed value handling with cubic interpolation */
 GST_START_TEST (controller_interpolation_cubic)
 {
@@ -662,6 +705,54 @@ GST_START_TEST (controller_interpolation_linear_value_array)
 
 GST_END_TEST;
 
+/* test that get_value_array() gives the same values as get_value() when the
+ * timestamps cross many control points */
+GST_START_TEST (controller_interpolation_value_array_segments)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  GstInterpolationMode modes[] = { GST_INTERPOLATION_MODE_NONE,
+    GST_INTERPOLATION_MODE_LINEAR, GST_INTERPOLATION_MODE_CUBIC
+  };
+  gdouble raw_values[100], value;
+  guint i, m;
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+
+  /* irregularly spaced control points, some between two samples */
+  for (i = 0; i < 20; i++)
+    fail_unless (gst_timed_value_control_source_set (tvcs,
+            i * 3 * GST_SECOND / 2 + (i % 3) * GST_MSECOND, (i % 5) / 5.0));
+
+  for (m = 0; m < G_N_ELEMENTS (modes); m++) {
+    g_object_set (cs, "mode", modes[m], NULL);
+
+    fail_unless (gst_control_source_get_value_array (cs, GST_SECOND / 3,
+            GST_SECOND / 3, 100, raw_values));
+
+    for (i = 0; i < 100; i++) {
+      fail_unless (gst_control_source_get_value (cs,
+              GST_SECOND / 3 + i * (GST_SECOND / 3), &value));
+      fail_unless_equals_float (raw_values[i], value);
+    }
+
+    /* an interval that skips several control points at once */
+    fail_unless (gst_control_source_get_value_array (cs, 0, 4 * GST_SECOND,
+            10, raw_values));
+
+    for (i = 0; i < 10; i++) {
+      fail_unless (gst_control_source_get_value (cs, i * 4 * GST_SECOND,
+              &value));
+      fail_unless_equals_float (raw_values[i], value);
+    }
+  }
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 /* test if values below minimum and above maximum are clipped */
 GST_START_TEST (controller_interpolation_linear_invalid_values)
 {
@@ -1064,6 +1155,50 @@ GST_START_TEST (controller_timed_value_count)
 
 GST_END_TEST;
 
+/* test removing redundant control points */
+GST_START_TEST (controller_timed_value_simplify)
+{
+  GstControlSource *cs;
+  GstTimedValueControlSource *tvcs;
+  gdouble value;
+  guint i;
+
+  cs = gst_interpolation_control_source_new ();
+  tvcs = (GstTimedValueControlSource *) cs;
+  g_object_set (cs, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+
+  /* a ramp up from 0 to 10s, a peak at 10s and a ramp down until 20s */
+  for (i = 0; i <= 20; i++)
+    fail_unless (gst_timed_value_control_source_set (tvcs, i * GST_SECOND,
+            (i <= 10 ? i : 20 - i) / 10.0));
+  fail_unless_equals_int (gst_timed_value_control_source_get_count (tvcs), 21);
+
+  /* move one point off the ramp and remove the points on straight lines */
+  fail_unless (gst_timed_value_control_source_set (tvcs, 5 * GST_SECOND, 0.6));
+  fail_unless_equals_int (gst_timed_value_control_source_simplify (tvcs,
+          1e-9), 15);
+
+  /* only the start, the bump at 5s and its neighbours, the peak and the end
+   * are needed */
+  fail_unless_equals_int (gst_timed_value_control_source_get_count (tvcs), 6);
+
+  fail_unless (gst_control_source_get_value (cs, 5 * GST_SECOND, &value));
+  fail_unless_equals_float (value, 0.6);
+  fail_unless (gst_control_source_get_value (cs, 10 * GST_SECOND, &value));
+  fail_unless_equals_float (value, 1.0);
+  fail_unless (gst_control_source_get_value (cs, 15 * GST_SECOND, &value));
+  fail_unless_equals_float (value, 0.5);
+
+  /* a larger epsilon also removes the bump */
+  fail_unless_equals_int (gst_timed_value_control_source_simplify (tvcs, 0.2),
+      3);
+  fail_unless_equals_int (gst_timed_value_control_source_get_count (tvcs), 3);
+
+  gst_object_unref (cs);
+}
+
+GST_END_TEST;
+
 
 /* test lfo control source with sine waveform */
 GST_START_TEST (controller_lfo_sine)
@@ -1519,11 +1654,13 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_controlsource_empty2);
   tcase_add_test (tc, controller_interpolation_none);
   tcase_add_test (tc, controller_interpolation_linear);
+  tcase_add_test (tc, controller_sync_same_timestamp);
   tcase_add_test (tc, controller_interpolation_cubic);
   tcase_add_test (tc, controller_interpolation_cubic_too_few_cp);
   tcase_add_test (tc, controller_interpolation_unset);
   tcase_add_test (tc, controller_interpolation_unset_all);
   tcase_add_test (tc, controller_interpolation_linear_value_array);
+  tcase_add_test (tc, controller_interpolation_value_array_segments);
   tcase_add_test (tc, controller_interpolation_linear_invalid_values);
   tcase_add_test (tc, controller_interpolation_linear_default_values);
   tcase_add_test (tc, controller_interpolation_linear_disabled);
@@ -1531,6 +1668,7 @@ gst_controller_suite (void)
   tcase_add_test (tc, controller_interpolation_linear_before_ts0);
   tcase_add_test (tc, controller_interpolation_linear_enums);
   tcase_add_test (tc, controller_timed_value_count);
+  tcase_add_test (tc, controller_timed_value_simplify);
   tcase_add_test (tc, controller_lfo_sine);
   tcase_add_test (tc, controller_lfo_sine_timeshift);
   tcase_add_test (tc, controller_lfo_square);
@@ -0,0 +1,244 @@
+/* GStreamer
+ *
+ * unit test for GstDataQueue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstdataqueue.h>
+
+#define MAX_VISIBLE 4
+#define N_ITEMS     10000
+
+static gint full_count;
+
+static gboolean
+check_full (GstDataQueue * queue, guint visible, guint bytes, guint64 time,
+    gpointer checkdata)
+{
+  return visible >= MAX_VISIBLE;
+}
+
+static void
+full_callback (GstDataQueue * queue, gpointer checkdata)
+{
+  g_atomic_int_inc (&full_count);
+}
+
+static void
+item_destroy (GstDataQueueItem * item)
+{
+  g_slice_free (GstDataQueueItem, item);
+}
+
+/* the items carry their sequence number in the duration */
+static GstDataQueueItem *
+item_new (guint64 seqnum)
+{
+  GstDataQueueItem *item;
+
+  item = g_slice_new0 (GstDataQueueItem);
+  item->size = 1;
+  item->duration = seqnum;
+  item->visible = TRUE;
+  item->destroy = (GDestroyNotify) item_destroy;
+
+  return item;
+}
+
+static GstDataQueue *
+setup_queue (void)
+{
+  GstDataQueue *queue;
+
+  full_count = 0;
+  queue = gst_data_queue_new (check_full, full_callback, NULL, NULL);
+  gst_data_queue_set_single_producer_consumer (queue, TRUE);
+
+  return queue;
+}
+
+static gpointer
+push_items (GstDataQueue * queue)
+{
+  guint64 i;
+
+  for (i = 0; i < N_ITEMS; i++)
+    fail_unless (gst_data_queue_push (queue, item_new (i)));
+
+  return NULL;
+}
+
+GST_START_TEST (test_spsc_push_pop)
+{
+  GstDataQueue *queue;
+  GstDataQueueSize level;
+  GThread *producer;
+  guint64 i;
+
+  queue = setup_queue ();
+
+  producer = g_thread_try_new ("producer", (GThreadFunc) push_items, queue,
+      NULL);
+  fail_unless (producer != NULL);
+
+  /* the items come out in order, and the queue never holds more than
+   * the check function allows */
+  for (i = 0; i < N_ITEMS; i++) {
+    GstDataQueueItem *item = NULL;
+
+    gst_data_queue_get_level (queue, &level);
+    fail_unless (level.visible <= MAX_VISIBLE);
+
+    fail_unless (gst_data_queue_pop (queue, &item));
+    fail_unless (item != NULL);
+    fail_unless_equals_uint64 (item->duration, i);
+    item->destroy (item);
+  }
+
+  g_thread_join (producer);
+
+  /* the producer ran into a full queue at least once */
+  fail_unless (g_atomic_int_get (&full_count) > 0);
+
+  fail_unless (gst_data_queue_is_empty (queue));
+  gst_data_queue_get_level (queue, &level);
+  fail_unless_equals_int (level.visible, 0);
+  fail_unless_equals_int (level.bytes, 0);
+  fail_unless_equals_uint64 (level.time, 0);
+
+  g_object_unref (queue);
+}
+
+GST_END_TEST;
+
+static gint blocked;
+
+static gpointer
+push_when_full (GstDataQueue * queue)
+{
+  GstDataQueueItem *item = item_new (MAX_VISIBLE);
+
+  g_atomic_int_set (&blocked, TRUE);
+  /* returns when the queue is set to flushing */
+  fail_if (gst_data_queue_push (queue, item));
+  item->destroy (item);
+
+  return NULL;
+}
+
+static gpointer
+pop_when_empty (GstDataQueue * queue)
+{
+  GstDataQueueItem *item = NULL;
+
+  g_atomic_int_set (&blocked, TRUE);
+  /* returns when the queue is set to flushing */
+  fail_if (gst_data_queue_pop (queue, &item));
+  fail_unless (item == NULL);
+
+  return NULL;
+}
+
+static void
+wait_blocked (void)
+{
+  while (!g_atomic_int_get (&blocked))
+    g_usleep (G_USEC_PER_SEC / 100);
+  /* give the thread some time to start waiting */
+  g_usleep (G_USEC_PER_SEC / 10);
+}
+
+GST_START_TEST (test_spsc_flush)
+{
+  GstDataQueue *queue;
+  GstDataQueueItem *item;
+  GstDataQueueSize level;
+  GThread *thread;
+  guint64 i;
+
+  queue = setup_queue ();
+
+  for (i = 0; i < MAX_VISIBLE; i++)
+    fail_unless (gst_data_queue_push (queue, item_new (i)));
+  fail_unless (gst_data_queue_is_full (queue));
+
+  /* a push on the full queue blocks until the queue is set to flushing */
+  blocked = FALSE;
+  thread = g_thread_try_new ("producer", (GThreadFunc) push_when_full, queue,
+      NULL);
+  fail_unless (thread != NULL);
+  wait_blocked ();
+  gst_data_queue_set_flushing (queue, TRUE);
+  g_thread_join (thread);
+
+  gst_data_queue_flush (queue);
+  fail_unless (gst_data_queue_is_empty (queue));
+  gst_data_queue_get_level (queue, &level);
+  fail_unless_equals_int (level.visible, 0);
+  fail_unless_equals_int (level.bytes, 0);
+  fail_unless_equals_uint64 (level.time, 0);
+
+  /* nothing gets in or out while flushing */
+  item = item_new (0);
+  fail_if (gst_data_queue_push (queue, item));
+  item->destroy (item);
+  item = NULL;
+  fail_if (gst_data_queue_pop (queue, &item));
+
+  gst_data_queue_set_flushing (queue, FALSE);
+
+  /* a pop on the empty queue blocks until the queue is set to flushing */
+  blocked = FALSE;
+  thread = g_thread_try_new ("consumer", (GThreadFunc) pop_when_empty, queue,
+      NULL);
+  fail_unless (thread != NULL);
+  wait_blocked ();
+  gst_data_queue_set_flushing (queue, TRUE);
+  g_thread_join (thread);
+
+  /* and the queue works as before after the flush */
+  gst_data_queue_set_flushing (queue, FALSE);
+  fail_unless (gst_data_queue_push (queue, item_new (1)));
+  fail_unless (gst_data_queue_pop (queue, &item));
+  fail_unless_equals_uint64 (item->duration, 1);
+  item->destroy (item);
+
+  g_object_unref (queue);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_data_queue_suite (void)
+{
+  Suite *s = suite_create ("GstDataQueue");
+  TCase *tc_chain = tcase_create ("single producer/consumer");
+
+  tcase_set_timeout (tc_chain, 60);
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_spsc_push_pop);
+  tcase_add_test (tc_chain, test_spsc_flush);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_data_queue);
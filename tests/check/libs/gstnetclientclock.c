@@ -110,6 +110,99 @@ GST_START_TEST (test_functioning)
 
 GST_END_TEST;
 
+GST_START_TEST (test_burst)
+{
+  GstNetTimeProvider *ntp;
+  GstClock *client, *server;
+  GstClockTime servtime, clienttime, diff;
+  guint burst_size;
+  gint port;
+
+  server = gst_system_clock_obtain ();
+  fail_unless (server != NULL, "failed to get system clock");
+
+  ntp = gst_net_time_provider_new (server, "127.0.0.1", 0);
+  fail_unless (ntp != NULL, "failed to create network time provider");
+
+  g_object_get (ntp, "port", &port, NULL);
+
+  client = gst_net_client_clock_new (NULL, "127.0.0.1", port, GST_SECOND);
+  fail_unless (client != NULL, "failed to get network client clock");
+
+  g_object_set (client, "burst-size", 8, "round-trip-limit", GST_SECOND / 2,
+      NULL);
+  g_object_get (client, "burst-size", &burst_size, NULL);
+  fail_unless_equals_int (burst_size, 8);
+
+  /* let the clocks synchronize */
+  g_usleep (G_USEC_PER_SEC);
+
+  servtime = gst_clock_get_time (server);
+  clienttime = gst_clock_get_time (client);
+
+  diff = servtime > clienttime ? servtime - clienttime : clienttime - servtime;
+  fail_unless (diff < 100 * GST_MSECOND, "clocks not in sync (%"
+      GST_TIME_FORMAT ")", GST_TIME_ARGS (diff));
+
+  gst_object_unref (client);
+  gst_object_unref (ntp);
+  gst_object_unref (server);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_fallback_server)
+{
+  GstNetTimeProvider *ntp, *dead;
+  GstClock *client, *server;
+  GstClockTime basex, basey, rate_num, rate_denom;
+  GstClockTime servtime, clienttime, diff;
+  gchar *servers;
+  gint port, dead_port;
+
+  server = gst_system_clock_obtain ();
+  fail_unless (server != NULL, "failed to get system clock");
+
+  gst_clock_get_calibration (server, &basex, &basey, &rate_num, &rate_denom);
+  basey += 100 * GST_SECOND;
+  gst_clock_set_calibration (server, basex, basey, rate_num, rate_denom);
+
+  /* get a port on which nobody replies */
+  dead = gst_net_time_provider_new (server, "127.0.0.1", 0);
+  fail_unless (dead != NULL, "failed to create network time provider");
+  g_object_get (dead, "port", &dead_port, NULL);
+  gst_object_unref (dead);
+
+  ntp = gst_net_time_provider_new (server, "127.0.0.1", 0);
+  fail_unless (ntp != NULL, "failed to create network time provider");
+  g_object_get (ntp, "port", &port, NULL);
+
+  client = gst_net_client_clock_new (NULL, "127.0.0.1", dead_port,
+      GST_SECOND);
+  fail_unless (client != NULL, "failed to get network client clock");
+
+  servers = g_strdup_printf ("127.0.0.1:%d", port);
+  g_object_set (client, "timeout", 100 * GST_MSECOND, "fallback-servers",
+      servers, NULL);
+  g_free (servers);
+
+  /* a few polls fail before the clock moves to the second server */
+  g_usleep (3 * G_USEC_PER_SEC);
+
+  servtime = gst_clock_get_time (server);
+  clienttime = gst_clock_get_time (client);
+
+  diff = servtime > clienttime ? servtime - clienttime : clienttime - servtime;
+  fail_unless (diff < 100 * GST_MSECOND, "clocks not in sync (%"
+      GST_TIME_FORMAT ")", GST_TIME_ARGS (diff));
+
+  gst_object_unref (client);
+  gst_object_unref (ntp);
+  gst_object_unref (server);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_net_client_clock_suite (void)
 {
@@ -121,6 +214,8 @@ gst_net_client_clock_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_instantiation);
   tcase_add_test (tc_chain, test_functioning);
+  tcase_add_test (tc_chain, test_burst);
+  tcase_add_test (tc_chain, test_fallback_server);
 
   return s;
 }
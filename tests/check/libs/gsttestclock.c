@@ -22,6 +22,7 @@
 
 #include <gst/check/gstcheck.h>
 #include <gst/check/gsttestclock.h>
+#include <gst/check/gsttestclockbench.h>
 
 typedef struct
 {
@@ -932,6 +933,71 @@ GST_START_TEST (test_periodic_uniqueness)
 
 GST_END_TEST;
 
+GST_START_TEST (test_timed_wait_for_next_pending_id)
+{
+  GstClock *clock;
+  GstTestClock *test_clock;
+  GstClockID clock_id;
+  GstClockID pending_id = NULL;
+
+  clock = gst_test_clock_new ();
+  test_clock = GST_TEST_CLOCK (clock);
+
+  g_assert (!gst_test_clock_timed_wait_for_next_pending_id (test_clock,
+          &pending_id, 10 * GST_MSECOND));
+  g_assert (pending_id == NULL);
+
+  clock_id = gst_clock_new_single_shot_id (clock, GST_SECOND);
+  g_assert (gst_clock_id_wait_async (clock_id, test_async_wait_cb,
+          NULL, NULL) == GST_CLOCK_OK);
+
+  g_assert (gst_test_clock_timed_wait_for_next_pending_id (test_clock,
+          &pending_id, GST_CLOCK_TIME_NONE));
+  assert_pending_id (pending_id, clock_id, GST_CLOCK_ENTRY_SINGLE, GST_SECOND);
+  gst_clock_id_unref (pending_id);
+
+  gst_clock_id_unschedule (clock_id);
+  gst_clock_id_unref (clock_id);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_bench_pipeline)
+{
+  GstElement *pipeline;
+  GstTestClockBench *bench;
+
+  /* 20 buffers of 100ms that fakesink syncs on */
+  pipeline = gst_parse_launch ("fakesrc format=time datarate=1000 "
+      "sizetype=fixed sizemax=100 num-buffers=20 ! fakesink sync=true", NULL);
+  fail_unless (pipeline != NULL);
+
+  bench = gst_test_clock_bench_new (pipeline);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  fail_unless (gst_test_clock_bench_run (bench, GST_SECOND));
+  fail_if (gst_test_clock_bench_is_eos (bench));
+  fail_unless (gst_test_clock_bench_get_n_waits (bench) > 0);
+  fail_unless (gst_test_clock_bench_get_n_waits (bench) <= 11);
+  fail_unless_equals_uint64 (gst_test_clock_bench_get_simulated_time (bench),
+      GST_SECOND);
+
+  fail_unless (gst_test_clock_bench_run (bench, GST_CLOCK_TIME_NONE));
+  fail_unless (gst_test_clock_bench_is_eos (bench));
+  fail_unless (gst_test_clock_bench_get_n_waits (bench) >= 20);
+  fail_unless (gst_test_clock_bench_get_simulated_time (bench) >=
+      2 * GST_SECOND - 100 * GST_MSECOND);
+  fail_unless (GST_CLOCK_TIME_IS_VALID
+      (gst_test_clock_bench_get_time_per_second (bench)));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_test_clock_bench_free (bench);
+  gst_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_test_clock_suite (void)
 {
@@ -962,6 +1028,8 @@ gst_test_clock_suite (void)
   tcase_add_test (tc_chain, test_periodic_sync);
   tcase_add_test (tc_chain, test_periodic_async);
   tcase_add_test (tc_chain, test_periodic_uniqueness);
+  tcase_add_test (tc_chain, test_timed_wait_for_next_pending_id);
+  tcase_add_test (tc_chain, test_bench_pipeline);
 
   return s;
 }
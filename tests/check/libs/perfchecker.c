@@ -0,0 +1,209 @@
+/* GStreamer
+ *
+ * unit test for GstPerfChecker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstperfchecker.h>
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+GST_START_TEST (test_median)
+{
+  GstPerfChecker *checker;
+
+  checker = gst_perf_checker_new ("median", NULL);
+  fail_unless_equals_int (gst_perf_checker_get_n_samples (checker), 0);
+  fail_unless_equals_uint64 (gst_perf_checker_get_median (checker),
+      GST_CLOCK_TIME_NONE);
+  fail_if (gst_perf_checker_check (checker, 10.0));
+
+  gst_perf_checker_add_sample (checker, 30);
+  gst_perf_checker_add_sample (checker, 10);
+  gst_perf_checker_add_sample (checker, 1000);
+  gst_perf_checker_add_sample (checker, 20);
+  gst_perf_checker_add_sample (checker, 25);
+  fail_unless_equals_int (gst_perf_checker_get_n_samples (checker), 5);
+  /* the outlier does not matter */
+  fail_unless_equals_uint64 (gst_perf_checker_get_median (checker), 25);
+
+  gst_perf_checker_free (checker);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_baseline)
+{
+  GstPerfChecker *checker;
+  gchar *path;
+  gint fd;
+
+  fd = g_file_open_tmp ("gstperfcheckerXXXXXX", &path, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+  g_setenv ("GST_CHECK_PERF_BASELINES", path, TRUE);
+
+  /* an empty file has no baseline */
+  checker = gst_perf_checker_new ("baseline", NULL);
+  gst_perf_checker_add_sample (checker, 100 * GST_USECOND);
+  fail_unless_perf_within_baseline (checker, 0.0);
+
+  g_setenv ("GST_CHECK_PERF_RECORD", "1", TRUE);
+  fail_unless (gst_perf_checker_check (checker, 0.0));
+  g_unsetenv ("GST_CHECK_PERF_RECORD");
+  gst_perf_checker_free (checker);
+
+  checker = gst_perf_checker_new ("baseline", NULL);
+  gst_perf_checker_add_sample (checker, 110 * GST_USECOND);
+  fail_unless_perf_within_baseline (checker, 10.0);
+  fail_if (gst_perf_checker_check (checker, 5.0));
+  gst_perf_checker_free (checker);
+
+  /* other names have their own baseline */
+  checker = gst_perf_checker_new ("other", NULL);
+  gst_perf_checker_add_sample (checker, GST_SECOND);
+  fail_unless_perf_within_baseline (checker, 0.0);
+  gst_perf_checker_free (checker);
+
+  g_unsetenv ("GST_CHECK_PERF_BASELINES");
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST;
+
+#define NUM_BUFFERS 20
+
+/* a syncing sink would wait 20 seconds if the clock was not advanced */
+GST_START_TEST (test_push_buffer_sync)
+{
+  GstPerfChecker *checker;
+  GstElement *sink;
+  GstSegment segment;
+  GstPad *srcpad;
+  gint i;
+
+  sink = gst_check_setup_element ("fakesink");
+  g_object_set (sink, "sync", TRUE, "async", FALSE, NULL);
+  srcpad = gst_check_setup_src_pad (sink, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+
+  checker = gst_perf_checker_new ("fakesink-sync", sink);
+  fail_unless (GST_ELEMENT_CLOCK (sink) ==
+      GST_CLOCK (gst_perf_checker_get_clock (checker)));
+  fail_unless_equals_int (gst_element_set_state (sink, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_stream_start ("p")));
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < NUM_BUFFERS; i++) {
+    GstBuffer *buffer = gst_buffer_new ();
+
+    GST_BUFFER_PTS (buffer) = i * GST_SECOND;
+    GST_BUFFER_DURATION (buffer) = GST_SECOND;
+    fail_unless_equals_int (gst_perf_checker_push_buffer (checker, srcpad,
+            buffer), GST_FLOW_OK);
+  }
+
+  fail_unless_equals_int (gst_perf_checker_get_n_samples (checker),
+      NUM_BUFFERS);
+  fail_unless (gst_perf_checker_get_median (checker) < GST_SECOND);
+  fail_unless_equals_uint64 (gst_clock_get_time (GST_ELEMENT_CLOCK (sink)),
+      NUM_BUFFERS * GST_SECOND);
+
+  gst_element_set_state (sink, GST_STATE_NULL);
+  gst_perf_checker_free (checker);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (sink);
+  gst_check_teardown_element (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_add_pads)
+{
+  GstPerfChecker *checker;
+  GstElement *identity;
+  GstPad *srcpad, *sinkpad, *esinkpad, *esrcpad;
+  GstSegment segment;
+  gint i;
+
+  identity = gst_check_setup_element ("identity");
+  srcpad = gst_check_setup_src_pad (identity, &srctemplate);
+  sinkpad = gst_check_setup_sink_pad (identity, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_set_active (sinkpad, TRUE);
+
+  esinkpad = gst_element_get_static_pad (identity, "sink");
+  esrcpad = gst_element_get_static_pad (identity, "src");
+  checker = gst_perf_checker_new ("identity", identity);
+  fail_unless (gst_perf_checker_add_pads (checker, esinkpad, esrcpad));
+
+  fail_unless_equals_int (gst_element_set_state (identity, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_stream_start ("p")));
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&segment)));
+
+  for (i = 0; i < NUM_BUFFERS; i++)
+    fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+        GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_perf_checker_get_n_samples (checker),
+      NUM_BUFFERS);
+  fail_unless_equals_int (g_list_length (buffers), NUM_BUFFERS);
+
+  gst_element_set_state (identity, GST_STATE_NULL);
+  gst_perf_checker_free (checker);
+  gst_object_unref (esinkpad);
+  gst_object_unref (esrcpad);
+  gst_check_drop_buffers ();
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_check_teardown_src_pad (identity);
+  gst_check_teardown_sink_pad (identity);
+  gst_check_teardown_element (identity);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_perf_checker_suite (void)
+{
+  Suite *s = suite_create ("GstPerfChecker");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_median);
+  tcase_add_test (tc_chain, test_baseline);
+  tcase_add_test (tc_chain, test_push_buffer_sync);
+  tcase_add_test (tc_chain, test_add_pads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_perf_checker);
@@ -250,6 +250,166 @@ GST_START_TEST (test_array_drop2)
 
 GST_END_TEST;
 
+typedef struct
+{
+  guint64 value;
+  guint id;
+} TestStruct;
+
+static int
+compare_struct_id (gconstpointer a, gconstpointer b)
+{
+  return (int) (((const TestStruct *) a)->id - GPOINTER_TO_UINT (b));
+}
+
+GST_START_TEST (test_array_struct)
+{
+  GstQueueArray *array;
+  TestStruct t, *p;
+  guint i, idx;
+
+  array = gst_queue_array_new_for_struct (sizeof (TestStruct), 10);
+
+  /* push/pull 5 values to end up in the middle, then grow */
+  for (i = 0; i < 5; i++) {
+    t.value = i;
+    t.id = i;
+    gst_queue_array_push_tail_struct (array, &t);
+    p = gst_queue_array_pop_head_struct (array);
+    fail_unless_equals_int (p->id, i);
+  }
+  for (i = 0; i < 25; i++) {
+    t.value = G_GUINT64_CONSTANT (1) << 40 | i;
+    t.id = i;
+    gst_queue_array_push_tail_struct (array, &t);
+  }
+  fail_unless_equals_int (gst_queue_array_get_length (array), 25);
+
+  p = gst_queue_array_peek_head_struct (array);
+  fail_unless_equals_int (p->id, 0);
+  p = gst_queue_array_peek_nth_struct (array, 7);
+  fail_unless_equals_int (p->id, 7);
+  fail_unless (gst_queue_array_peek_nth_struct (array, 25) == NULL);
+
+  idx = gst_queue_array_find (array, compare_struct_id, GUINT_TO_POINTER (12));
+  fail_unless (gst_queue_array_drop_struct (array, idx, &t));
+  fail_unless_equals_int (t.id, 12);
+  fail_unless (t.value == (G_GUINT64_CONSTANT (1) << 40 | 12));
+
+  for (i = 0; i < 25; i++) {
+    if (i == 12)
+      continue;
+    p = gst_queue_array_pop_head_struct (array);
+    fail_unless_equals_int (p->id, i);
+    fail_unless (p->value == (G_GUINT64_CONSTANT (1) << 40 | i));
+  }
+  fail_unless (gst_queue_array_pop_head_struct (array) == NULL);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_array_push_pop_n)
+{
+  GstQueueArray *array;
+  gpointer in[30], out[30];
+  guint i, j, n;
+
+  array = gst_queue_array_new (10);
+
+  for (i = 0; i < G_N_ELEMENTS (in); i++)
+    in[i] = GUINT_TO_POINTER (i);
+
+  /* wrap around the end of the array with every size of batch */
+  for (n = 1; n <= G_N_ELEMENTS (in); n++) {
+    for (i = 0; i < 7; i++) {
+      gst_queue_array_push_tail (array, GUINT_TO_POINTER (1000));
+      gst_queue_array_push_tail_n (array, in, n);
+      fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_head
+              (array)), 1000);
+      fail_unless_equals_int (gst_queue_array_get_length (array), n);
+
+      fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, n + 1),
+          n);
+      for (j = 0; j < n; j++)
+        fail_unless_equals_int (GPOINTER_TO_UINT (out[j]), j);
+    }
+  }
+  fail_unless_equals_int (gst_queue_array_pop_head_n (array, out, 1), 0);
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_array_shrink)
+{
+  GstQueueArray *array;
+  guint i, j;
+
+  array = gst_queue_array_new (4);
+
+  for (j = 0; j < 3; j++) {
+    /* grow a lot, drain and push again, which shrinks the array */
+    for (i = 0; i < 1000; i++)
+      gst_queue_array_push_tail (array, GUINT_TO_POINTER (i));
+    for (i = 0; i < 1000; i++)
+      fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_head
+              (array)), i);
+    fail_unless (gst_queue_array_is_empty (array));
+
+    for (i = 0; i < 6; i++)
+      gst_queue_array_push_tail (array, GUINT_TO_POINTER (i));
+    for (i = 0; i < 6; i++)
+      fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_head
+              (array)), i);
+  }
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_array_pop_tail)
+{
+  GstQueueArray *array;
+  guint i;
+
+  array = gst_queue_array_new (4);
+  fail_unless (gst_queue_array_pop_tail (array) == NULL);
+  fail_unless (gst_queue_array_peek_tail (array) == NULL);
+
+  /* wrap around the end of the array before growing it */
+  for (i = 0; i < 3; i++)
+    gst_queue_array_push_tail (array, GUINT_TO_POINTER (i));
+  fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_head
+          (array)), 0);
+  for (i = 3; i < 10; i++)
+    gst_queue_array_push_tail (array, GUINT_TO_POINTER (i));
+
+  for (i = 9; i >= 5; i--) {
+    fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_peek_tail
+            (array)), i);
+    fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_tail
+            (array)), i);
+  }
+  fail_unless_equals_int (gst_queue_array_get_length (array), 4);
+  fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_head
+          (array)), 1);
+  fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_tail
+          (array)), 4);
+  fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_tail
+          (array)), 3);
+  fail_unless_equals_int (GPOINTER_TO_UINT (gst_queue_array_pop_tail
+          (array)), 2);
+  fail_unless (gst_queue_array_is_empty (array));
+
+  gst_queue_array_free (array);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_queue_array_suite (void)
 {
@@ -264,6 +424,10 @@ gst_queue_array_suite (void)
   tcase_add_test (tc_chain, test_array_grow_middle);
   tcase_add_test (tc_chain, test_array_grow_end);
   tcase_add_test (tc_chain, test_array_drop2);
+  tcase_add_test (tc_chain, test_array_struct);
+  tcase_add_test (tc_chain, test_array_push_pop_n);
+  tcase_add_test (tc_chain, test_array_shrink);
+  tcase_add_test (tc_chain, test_array_pop_tail);
 
   return s;
 }
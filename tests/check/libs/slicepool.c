@@ -0,0 +1,159 @@
+/* GStreamer
+ *
+ * unit test for GstSlicePool
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+#include <gst/base/gstslicepool.h>
+
+#define N_UNITS 1000
+
+static volatile gint units[N_UNITS];
+static volatile gint n_slices;
+static guint slice_align;
+
+static void
+count_units (guint start, guint end, gpointer user_data)
+{
+  guint i;
+
+  g_atomic_int_inc (&n_slices);
+  if (start % slice_align != 0)
+    g_atomic_int_set (&units[start], -1);
+
+  for (i = start; i < end; i++)
+    g_atomic_int_inc (&units[i]);
+}
+
+static void
+check_run (GstSlicePool * pool, guint total, guint align)
+{
+  guint i;
+
+  for (i = 0; i < N_UNITS; i++)
+    units[i] = 0;
+  n_slices = 0;
+  slice_align = MAX (align, 1);
+
+  gst_slice_pool_run (pool, total, align, count_units, NULL);
+
+  /* every unit was processed exactly once */
+  for (i = 0; i < total; i++)
+    fail_unless_equals_int (units[i], 1);
+  for (; i < N_UNITS; i++)
+    fail_unless_equals_int (units[i], 0);
+  fail_unless (n_slices >= 1);
+  fail_unless (n_slices <= gst_slice_pool_get_n_threads (pool));
+}
+
+GST_START_TEST (test_run)
+{
+  GstSlicePool *pool;
+  gint i;
+
+  pool = gst_slice_pool_new (4, FALSE);
+  fail_unless (pool != NULL);
+  fail_unless (gst_slice_pool_get_n_threads (pool) >= 1);
+  fail_unless (gst_slice_pool_get_n_threads (pool) <= 4);
+
+  /* the threads are reused for every run */
+  for (i = 0; i < 100; i++)
+    check_run (pool, N_UNITS, 0);
+
+  check_run (pool, 1, 0);
+  check_run (pool, 3, 0);
+  check_run (pool, 0, 0);
+  check_run (pool, 999, 16);
+  check_run (pool, 10, 16);
+
+  gst_slice_pool_free (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_run_default)
+{
+  GstSlicePool *pool;
+
+  pool = gst_slice_pool_new (0, TRUE);
+  fail_unless (gst_slice_pool_get_n_threads (pool) >= 1);
+  check_run (pool, N_UNITS, 2);
+  gst_slice_pool_free (pool);
+}
+
+GST_END_TEST;
+
+static void
+fill_slice (guint8 * data, gsize size, gsize offset, gpointer user_data)
+{
+  gsize i;
+
+  /* slices start at a line, leave the data alone otherwise so that the
+   * check fails */
+  if (offset % 7 != 0)
+    return;
+
+  for (i = 0; i < size; i++)
+    data[i] = (offset + i) & 0xff;
+}
+
+GST_START_TEST (test_run_buffer)
+{
+  GstSlicePool *pool;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  gsize i;
+
+  pool = gst_slice_pool_new (3, FALSE);
+  buffer = gst_buffer_new_and_alloc (7 * 100 + 3);
+
+  fail_unless (gst_slice_pool_run_buffer (pool, buffer, GST_MAP_WRITE, 7,
+          fill_slice, NULL));
+
+  fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], i & 0xff);
+  gst_buffer_unmap (buffer, &map);
+
+  gst_buffer_unref (buffer);
+  gst_slice_pool_free (pool);
+}
+
+GST_END_TEST;
+
+static Suite *
+gst_slice_pool_suite (void)
+{
+  Suite *s = suite_create ("GstSlicePool");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_run);
+  tcase_add_test (tc_chain, test_run_default);
+  tcase_add_test (tc_chain, test_run_buffer);
+
+  return s;
+}
+
+GST_CHECK_MAIN (gst_slice_pool);
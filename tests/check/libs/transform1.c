@@ -279,6 +279,7 @@ GST_END_TEST;
 
 static gboolean transform_ip_1_called;
 static gboolean transform_ip_1_writable;
+static gint transform_ip_1_count;
 
 static GstFlowReturn
 transform_ip_1 (GstBaseTransform * trans, GstBuffer * buf)
@@ -287,6 +288,7 @@ transform_ip_1 (GstBaseTransform * trans, GstBuffer * buf)
 
   transform_ip_1_called = TRUE;
   transform_ip_1_writable = gst_buffer_is_writable (buf);
+  transform_ip_1_count++;
 
   GST_DEBUG_OBJECT (trans, "writable: %d", transform_ip_1_writable);
 
@@ -390,6 +392,128 @@ set_caps_1 (GstBaseTransform * trans, GstCaps * incaps, GstCaps * outcaps)
 
 /* basic in-place, check if the _ip function is called, buffer should be
  * writable. we also set a setcaps function and see if it's called. */
+static gint result_sink_lists;
+
+static gboolean
+result_sink_add_buffer (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  TestTransData *data = user_data;
+
+  data->buffers = g_list_append (data->buffers, gst_buffer_ref (*buffer));
+
+  return TRUE;
+}
+
+static GstFlowReturn
+result_sink_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  TestTransData *data;
+
+  data = gst_pad_get_element_private (pad);
+
+  result_sink_lists++;
+  gst_buffer_list_foreach (list, result_sink_add_buffer, data);
+  gst_buffer_list_unref (list);
+
+  return GST_FLOW_OK;
+}
+
+/* in-place with a buffer list, every buffer is transformed and the list
+ * arrives downstream in one piece */
+GST_START_TEST (basetransform_chain_list_ip)
+{
+  TestTransData *trans;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GstFlowReturn res;
+  gint i;
+
+  klass_transform_ip = transform_ip_1;
+  trans = gst_test_trans_new ();
+  gst_pad_set_chain_list_function (trans->sinkpad, result_sink_chain_list);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, gst_buffer_new_and_alloc (10 + i));
+
+  transform_ip_1_count = 0;
+  transform_ip_1_writable = TRUE;
+  result_sink_lists = 0;
+  res = gst_pad_push_list (trans->srcpad, list);
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless_equals_int (transform_ip_1_count, 3);
+  fail_unless (transform_ip_1_writable == TRUE);
+  fail_unless_equals_int (result_sink_lists, 1);
+
+  for (i = 0; i < 3; i++) {
+    buffer = gst_test_trans_pop (trans);
+    fail_unless (buffer != NULL);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 10 + i);
+    gst_buffer_unref (buffer);
+  }
+  fail_unless (gst_test_trans_pop (trans) == NULL);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
+static gint transform_ip_parallel_count;
+
+static GstFlowReturn
+transform_ip_parallel (GstBaseTransform * trans, GstBuffer * buf)
+{
+  g_atomic_int_inc (&transform_ip_parallel_count);
+  gst_buffer_memset (buf, 0, 0xab, gst_buffer_get_size (buf));
+
+  return GST_FLOW_OK;
+}
+
+/* in-place with a buffer list transformed by several threads, the output
+ * must keep the order of the input */
+GST_START_TEST (basetransform_chain_list_parallel)
+{
+  TestTransData *trans;
+  GstBufferList *list;
+  GstBuffer *buffer;
+  GstFlowReturn res;
+  GstMapInfo map;
+  gint i;
+
+  klass_transform_ip = transform_ip_parallel;
+  trans = gst_test_trans_new ();
+  gst_pad_set_chain_list_function (trans->sinkpad, result_sink_chain_list);
+  gst_base_transform_set_parallel (GST_BASE_TRANSFORM (trans->trans), 4);
+  fail_unless_equals_int (gst_base_transform_get_parallel (GST_BASE_TRANSFORM
+          (trans->trans)), 4);
+
+  list = gst_buffer_list_new ();
+  for (i = 0; i < 50; i++)
+    gst_buffer_list_add (list, gst_buffer_new_and_alloc (10 + i));
+
+  g_atomic_int_set (&transform_ip_parallel_count, 0);
+  result_sink_lists = 0;
+  res = gst_pad_push_list (trans->srcpad, list);
+  fail_unless (res == GST_FLOW_OK);
+  fail_unless_equals_int (g_atomic_int_get (&transform_ip_parallel_count), 50);
+  fail_unless_equals_int (result_sink_lists, 1);
+
+  for (i = 0; i < 50; i++) {
+    buffer = gst_test_trans_pop (trans);
+    fail_unless (buffer != NULL);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), 10 + i);
+    fail_unless (gst_buffer_map (buffer, &map, GST_MAP_READ));
+    fail_unless (map.data[0] == 0xab && map.data[map.size - 1] == 0xab);
+    gst_buffer_unmap (buffer, &map);
+    gst_buffer_unref (buffer);
+  }
+  fail_unless (gst_test_trans_pop (trans) == NULL);
+
+  gst_test_trans_free (trans);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (basetransform_chain_ip2)
 {
   TestTransData *trans;
@@ -1382,6 +1506,8 @@ gst_basetransform_suite (void)
   /* in place */
   tcase_add_test (tc, basetransform_chain_ip1);
   tcase_add_test (tc, basetransform_chain_ip2);
+  tcase_add_test (tc, basetransform_chain_list_ip);
+  tcase_add_test (tc, basetransform_chain_list_parallel);
   /* copy transform */
   tcase_add_test (tc, basetransform_chain_ct1);
   tcase_add_test (tc, basetransform_chain_ct2);
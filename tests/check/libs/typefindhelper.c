@@ -34,6 +34,14 @@ static const guint8 vorbisid[30] = { 0x01, 0x76, 0x6f, 0x72, 0x62, 0x69, 0x73,
 };
 
 static void foobar_typefind (GstTypeFind * tf, gpointer unused);
+static void counting_typefind (GstTypeFind * tf, gpointer unused);
+
+static void far_typefind (GstTypeFind * tf, gpointer unused);
+
+static gint typefind_calls;
+
+#define FAR_DATA_SIZE 16384
+#define FAR_OFFSET    10000
 
 static GstStaticCaps foobar_caps = GST_STATIC_CAPS ("foo/x-bar");
 
@@ -72,6 +80,150 @@ GST_START_TEST (test_buffer_range)
 
 GST_END_TEST;
 
+GST_START_TEST (test_cache)
+{
+  static const guint8 data[8] = { 'c', 'a', 'c', 'h', 'e', 'd', 0, 1 };
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+
+  fail_unless (gst_type_find_register (NULL, "foo/x-cached",
+          GST_RANK_PRIMARY + 100, counting_typefind, "cached",
+          NULL, NULL, NULL));
+
+  gst_type_find_helper_set_cache_size (4);
+  typefind_calls = 0;
+
+  caps = gst_type_find_helper_for_data (NULL, data, sizeof (data), &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_int (prob, GST_TYPE_FIND_MAXIMUM);
+  fail_unless_equals_int (typefind_calls, 1);
+  gst_caps_unref (caps);
+
+  /* same data, result comes from the cache */
+  caps = gst_type_find_helper_for_data (NULL, data, sizeof (data), &prob);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+          "foo/x-cached"));
+  fail_unless_equals_int (prob, GST_TYPE_FIND_MAXIMUM);
+  fail_unless_equals_int (typefind_calls, 1);
+  gst_caps_unref (caps);
+
+  /* different data is typefound again */
+  caps = gst_type_find_helper_for_data (NULL, data, sizeof (data) - 1, &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_int (typefind_calls, 2);
+  gst_caps_unref (caps);
+
+  /* disabling the cache flushes it */
+  gst_type_find_helper_set_cache_size (0);
+  caps = gst_type_find_helper_for_data (NULL, data, sizeof (data), &prob);
+  fail_unless (caps != NULL);
+  fail_unless_equals_int (typefind_calls, 3);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+static guint64 bytes_pulled;
+
+static GstFlowReturn
+far_getrange (GstObject * obj, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  if (offset >= FAR_DATA_SIZE)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, FAR_DATA_SIZE - offset);
+  *buffer = gst_buffer_new_allocate (NULL, length, NULL);
+  gst_buffer_memset (*buffer, 0, 'f', length);
+  GST_BUFFER_OFFSET (*buffer) = offset;
+  bytes_pulled += length;
+
+  return GST_FLOW_OK;
+}
+
+GST_START_TEST (test_read_budget)
+{
+  GstObject *obj;
+  GstCaps *caps;
+  gboolean far;
+
+  fail_unless (gst_type_find_register (NULL, "foo/x-far",
+          GST_RANK_PRIMARY + 200, far_typefind, "far", NULL, NULL, NULL));
+
+  obj = GST_OBJECT (gst_pad_new ("src", GST_PAD_SRC));
+
+  /* without a budget the typefinder can look at the end of the data */
+  bytes_pulled = 0;
+  caps = gst_type_find_helper_get_range_full (obj, NULL, far_getrange,
+      FAR_DATA_SIZE, NULL, 0, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_get_boolean (gst_caps_get_structure (caps, 0),
+          "far", &far));
+  fail_unless (far);
+  gst_caps_unref (caps);
+
+  /* with a budget it can't */
+  bytes_pulled = 0;
+  caps = gst_type_find_helper_get_range_full (obj, NULL, far_getrange,
+      FAR_DATA_SIZE, NULL, 8192, NULL);
+  fail_unless (caps != NULL);
+  fail_unless (gst_structure_get_boolean (gst_caps_get_structure (caps, 0),
+          "far", &far));
+  fail_if (far);
+  fail_unless (bytes_pulled <= 8192);
+  gst_caps_unref (caps);
+
+  gst_object_unref (obj);
+}
+
+GST_END_TEST;
+
+static void
+likely_typefind (GstTypeFind * tf, gpointer caps_name)
+{
+  if (gst_type_find_peek (tf, 0, 4) != NULL)
+    gst_type_find_suggest_simple (tf, GST_TYPE_FIND_LIKELY, caps_name, NULL);
+}
+
+static void
+maximum_typefind (GstTypeFind * tf, gpointer caps_name)
+{
+  if (gst_type_find_peek (tf, 0, 4) != NULL)
+    gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, caps_name, NULL);
+}
+
+GST_START_TEST (test_parallel)
+{
+  static const guint8 data[8] = { 'p', 'a', 'r', 'a', 'l', 'l', 'e', 'l' };
+  GstTypeFindProbability prob;
+  GstCaps *caps;
+  guint n_threads;
+
+  fail_unless (gst_type_find_register (NULL, "foo/x-p1",
+          GST_RANK_PRIMARY + 300, likely_typefind, NULL, NULL,
+          (gpointer) "foo/x-p1", NULL));
+  fail_unless (gst_type_find_register (NULL, "foo/x-p2",
+          GST_RANK_PRIMARY + 290, likely_typefind, NULL, NULL,
+          (gpointer) "foo/x-p2", NULL));
+  fail_unless (gst_type_find_register (NULL, "foo/x-p3",
+          GST_RANK_PRIMARY + 280, maximum_typefind, NULL, NULL,
+          (gpointer) "foo/x-p3", NULL));
+
+  /* the result must not depend on the number of threads */
+  for (n_threads = 1; n_threads <= 4; n_threads++) {
+    caps = gst_type_find_helper_for_data_parallel (NULL, data, sizeof (data),
+        n_threads, &prob);
+    fail_unless (caps != NULL);
+    fail_unless (gst_structure_has_name (gst_caps_get_structure (caps, 0),
+            "foo/x-p3"));
+    fail_unless_equals_int (prob, GST_TYPE_FIND_MAXIMUM);
+    gst_caps_unref (caps);
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_typefindhelper_suite (void)
 {
@@ -80,6 +232,9 @@ gst_typefindhelper_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_buffer_range);
+  tcase_add_test (tc_chain, test_cache);
+  tcase_add_test (tc_chain, test_read_budget);
+  tcase_add_test (tc_chain, test_parallel);
 
   return s;
 }
@@ -121,3 +276,28 @@ foobar_typefind (GstTypeFind * tf, gpointer unused)
 
   gst_type_find_suggest (tf, GST_TYPE_FIND_MAXIMUM, FOOBAR_CAPS);
 }
+
+static void
+counting_typefind (GstTypeFind * tf, gpointer unused)
+{
+  const guint8 *data;
+
+  typefind_calls++;
+
+  data = gst_type_find_peek (tf, 0, 6);
+  if (data && memcmp (data, "cached", 6) == 0) {
+    gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, "foo/x-cached",
+        NULL);
+  }
+}
+
+static void
+far_typefind (GstTypeFind * tf, gpointer unused)
+{
+  if (gst_type_find_peek (tf, 0, 4) == NULL)
+    return;
+
+  gst_type_find_suggest_simple (tf, GST_TYPE_FIND_MAXIMUM, "foo/x-far",
+      "far", G_TYPE_BOOLEAN,
+      gst_type_find_peek (tf, FAR_OFFSET, 4) != NULL, NULL);
+}
@@ -653,6 +653,51 @@ GST_START_TEST (test_flags)
 
 GST_END_TEST;
 
+GST_START_TEST (test_reuse_context)
+{
+  GstParseContext *ctx;
+  GstElement *pipeline;
+  GError *err = NULL;
+  gchar **arr;
+  gint i;
+
+  if (!g_getenv ("GST_DEBUG"))
+    gst_debug_set_default_threshold (GST_LEVEL_NONE);
+
+  ctx = gst_parse_context_new ();
+  for (i = 0; i < 3; i++) {
+    pipeline = gst_parse_launch_full ("fakesrc num-buffers=1 ! identity ! "
+        "( queue ! fakesink )", ctx, GST_PARSE_FLAG_FATAL_ERRORS, &err);
+    fail_unless (err == NULL, "unexpected error");
+    fail_unless (GST_IS_PIPELINE (pipeline));
+    fail_unless (gst_parse_context_get_missing_elements (ctx) == NULL);
+    gst_object_unref (pipeline);
+  }
+
+  /* only the elements missing in the last run are reported */
+  pipeline = gst_parse_launch_full ("fakesrc ! coffeesink", ctx,
+      GST_PARSE_FLAG_FATAL_ERRORS, &err);
+  fail_unless (err != NULL, "expected error");
+  fail_unless (pipeline == NULL);
+  g_error_free (err);
+  err = NULL;
+  pipeline = gst_parse_launch_full ("fakesrc ! teasink", ctx,
+      GST_PARSE_FLAG_FATAL_ERRORS, &err);
+  fail_unless (err != NULL, "expected error");
+  fail_unless (pipeline == NULL);
+  g_error_free (err);
+  err = NULL;
+  arr = gst_parse_context_get_missing_elements (ctx);
+  fail_unless (arr != NULL, "expected missing elements");
+  fail_unless_equals_string (arr[0], "teasink");
+  fail_unless (arr[1] == NULL);
+  g_strfreev (arr);
+
+  gst_parse_context_free (ctx);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_parsing)
 {
   GstElement *pipeline;
@@ -681,6 +726,7 @@ parse_suite (void)
   tcase_add_test (tc_chain, delayed_link);
   tcase_add_test (tc_chain, test_flags);
   tcase_add_test (tc_chain, test_missing_elements);
+  tcase_add_test (tc_chain, test_reuse_context);
   tcase_add_test (tc_chain, test_parsing);
   return s;
 }
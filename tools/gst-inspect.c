@@ -1500,6 +1500,107 @@ print_all_plugin_automatic_install_info (void)
   gst_plugin_list_free (orig_plugins);
 }
 
+typedef struct
+{
+  gchar *name;
+  GstClockTime open_time;
+  GstClockTime init_time;
+  gsize registry_size;
+  guint n_features;
+} PluginLoadStats;
+
+static GstClockTime
+plugin_load_cost (const PluginLoadStats * stats)
+{
+  GstClockTime cost = 0;
+
+  if (GST_CLOCK_TIME_IS_VALID (stats->open_time))
+    cost += stats->open_time;
+  if (GST_CLOCK_TIME_IS_VALID (stats->init_time))
+    cost += stats->init_time;
+
+  return cost;
+}
+
+static gint
+compare_plugin_load_stats (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ca = plugin_load_cost (a), cb = plugin_load_cost (b);
+
+  return ca > cb ? -1 : (ca < cb ? 1 : 0);
+}
+
+static void
+print_plugin_load_time (GstClockTime time)
+{
+  if (GST_CLOCK_TIME_IS_VALID (time))
+    g_print ("%9.3fms", (gdouble) time / GST_MSECOND);
+  else
+    g_print ("%11s", "-");
+}
+
+/* loads all the plugins and prints what each one costs, the most expensive
+ * first */
+static void
+print_plugin_load_stats (void)
+{
+  GstRegistry *registry = gst_registry_get ();
+  GList *plugins, *walk;
+  GArray *all;
+  GstClockTime total = 0;
+  gsize total_size = 0;
+  guint i;
+
+  all = g_array_new (FALSE, TRUE, sizeof (PluginLoadStats));
+
+  plugins = gst_registry_get_plugin_list (registry);
+  for (walk = plugins; walk; walk = walk->next) {
+    GstPlugin *plugin = walk->data, *loaded;
+    PluginLoadStats stats = { NULL, };
+    GList *features;
+
+    loaded = gst_plugin_load (plugin);
+    if (loaded == NULL) {
+      g_printerr (_("Could not load plugin %s\n"), gst_plugin_get_name (plugin));
+      continue;
+    }
+
+    stats.name = g_strdup (gst_plugin_get_name (loaded));
+    gst_plugin_get_load_stats (loaded, &stats.open_time, &stats.init_time,
+        &stats.registry_size);
+    features = gst_registry_get_feature_list_by_plugin (registry, stats.name);
+    stats.n_features = g_list_length (features);
+    gst_plugin_feature_list_free (features);
+    g_array_append_val (all, stats);
+
+    gst_object_unref (loaded);
+  }
+  gst_plugin_list_free (plugins);
+
+  g_array_sort (all, compare_plugin_load_stats);
+
+  g_print ("%11s%11s%11s%11s  %s\n", _("open"), _("init"), _("features"),
+      _("registry"), _("plugin"));
+  for (i = 0; i < all->len; i++) {
+    PluginLoadStats *stats = &g_array_index (all, PluginLoadStats, i);
+
+    print_plugin_load_time (stats->open_time);
+    print_plugin_load_time (stats->init_time);
+    g_print ("%11u%11" G_GSIZE_FORMAT "  %s\n", stats->n_features,
+        stats->registry_size, stats->name);
+
+    total += plugin_load_cost (stats);
+    total_size += stats->registry_size;
+    g_free (stats->name);
+  }
+  g_print ("\n");
+  g_print (_("Total: %u plugins, %.3fms to load, %" G_GSIZE_FORMAT
+          " bytes of registry\n"), all->len, (gdouble) total / GST_MSECOND,
+      total_size);
+
+  g_array_free (all, TRUE);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -1508,6 +1609,7 @@ main (int argc, char *argv[])
   gboolean plugin_name = FALSE;
   gboolean print_aii = FALSE;
   gboolean uri_handlers = FALSE;
+  gboolean load_stats = FALSE;
   gboolean check_exists = FALSE;
   gchar *min_version = NULL;
   guint minver_maj = GST_VERSION_MAJOR;
@@ -1536,6 +1638,11 @@ main (int argc, char *argv[])
           N_
           ("Print supported URI schemes, with the elements that implement them"),
         NULL},
+    {"load-stats", '\0', 0, G_OPTION_ARG_NONE, &load_stats,
+          N_
+          ("Load all plugins and print how long opening and initializing each "
+              "one took, its number of features and its registry size, the "
+              "most expensive first"), NULL},
     GST_TOOLS_GOPTION_VERSION,
     {NULL}
   };
@@ -1616,6 +1723,8 @@ main (int argc, char *argv[])
   /* if no arguments, print out list of elements */
   if (uri_handlers) {
     print_all_uri_handlers ();
+  } else if (load_stats) {
+    print_plugin_load_stats ();
   } else if (argc == 1 || print_all) {
     if (do_print_blacklist)
       print_blacklist ();
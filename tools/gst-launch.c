@@ -42,6 +42,14 @@
 #include <locale.h>             /* for LC_ALL */
 #include "tools.h"
 
+/* CPU time of the streaming threads for --stats */
+#if defined (HAVE_CLOCK_GETTIME) && defined (_POSIX_THREAD_CPUTIME) && \
+    _POSIX_THREAD_CPUTIME >= 0
+#include <pthread.h>
+#include <time.h>
+#define HAVE_THREAD_CPUTIME
+#endif
+
 /* FIXME: This is just a temporary hack.  We should have a better
  * check for siginfo handling. */
 #ifdef SA_SIGINFO
@@ -863,12 +871,363 @@ exit:
   }
 }
 
+/* --stats: probes on the pads of all elements count the buffers, the
+ * timestamps of the buffers of the first source are remembered to measure
+ * the latency to the sinks, and the stream-status messages, which are posted
+ * from the streaming threads themselves, are used to find the threads to
+ * measure their CPU time. */
+#define STATS_MAX_PENDING 4096
+#define STATS_MAX_LATENCIES (1 << 20)
+
+typedef struct
+{
+  gchar *name;
+  gboolean is_sink;
+  GMutex lock;
+  guint64 buffers;
+  guint64 bytes;
+} StatsElement;
+
+typedef struct
+{
+  gchar *name;
+#ifdef HAVE_THREAD_CPUTIME
+  pthread_t thread;
+  clockid_t clock;
+#endif
+  gboolean running;
+  GstClockTime cpu_time;
+} StatsThread;
+
+static gboolean stats = FALSE;
+static GMutex stats_lock;
+static GList *stats_elements = NULL;
+static GList *stats_threads = NULL;
+static GstElement *stats_source = NULL;
+/* the pts of the buffers of the source and the time they were pushed */
+static GHashTable *stats_pending = NULL;
+static GQueue stats_pending_order = G_QUEUE_INIT;
+static GArray *stats_latencies = NULL;
+static guint64 stats_n_latencies = 0;
+static GstClockTime stats_start = GST_CLOCK_TIME_NONE;
+
+static void stats_add_element (GstElement * element);
+
+static guint64
+stats_buffer_size (GstPadProbeInfo * info, GstBuffer ** first)
+{
+  guint64 bytes = 0;
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    *first = GST_PAD_PROBE_INFO_BUFFER (info);
+    return gst_buffer_get_size (*first);
+  } else {
+    GstBufferList *list = GST_PAD_PROBE_INFO_BUFFER_LIST (info);
+    guint i, len = gst_buffer_list_length (list);
+
+    *first = len > 0 ? gst_buffer_list_get (list, 0) : NULL;
+    for (i = 0; i < len; i++)
+      bytes += gst_buffer_get_size (gst_buffer_list_get (list, i));
+  }
+
+  return bytes;
+}
+
+static void
+stats_add_latency (GstClockTime latency)
+{
+  /* keep a uniform sample of the latencies of long runs */
+  if (stats_latencies->len < STATS_MAX_LATENCIES) {
+    g_array_append_val (stats_latencies, latency);
+  } else {
+    guint64 idx = g_random_double () * (stats_n_latencies + 1);
+
+    if (idx < STATS_MAX_LATENCIES)
+      g_array_index (stats_latencies, GstClockTime, idx) = latency;
+  }
+  stats_n_latencies++;
+}
+
+static GstPadProbeReturn
+stats_buffer_probe (GstPad * pad, GstPadProbeInfo * info, StatsElement * se)
+{
+  GstBuffer *first = NULL;
+  guint64 bytes, n_buffers;
+  GstClockTime now;
+
+  bytes = stats_buffer_size (info, &first);
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER)
+    n_buffers = 1;
+  else
+    n_buffers = gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+
+  g_mutex_lock (&se->lock);
+  se->buffers += n_buffers;
+  se->bytes += bytes;
+  g_mutex_unlock (&se->lock);
+
+  if (first == NULL || !GST_BUFFER_PTS_IS_VALID (first))
+    return GST_PAD_PROBE_OK;
+
+  now = gst_util_get_timestamp ();
+  g_mutex_lock (&stats_lock);
+  if (GST_PAD_PARENT (pad) == stats_source && GST_PAD_IS_SRC (pad)) {
+    gpointer key = g_memdup (&GST_BUFFER_PTS (first), sizeof (GstClockTime));
+
+    if (!g_hash_table_contains (stats_pending, key)) {
+      g_hash_table_insert (stats_pending, key,
+          g_memdup (&now, sizeof (GstClockTime)));
+      g_queue_push_tail (&stats_pending_order, key);
+      if (stats_pending_order.length > STATS_MAX_PENDING)
+        g_hash_table_remove (stats_pending,
+            g_queue_pop_head (&stats_pending_order));
+    } else {
+      g_free (key);
+    }
+  } else if (se->is_sink && GST_PAD_IS_SINK (pad)) {
+    GstClockTime *pushed;
+
+    pushed = g_hash_table_lookup (stats_pending, &GST_BUFFER_PTS (first));
+    if (pushed)
+      stats_add_latency (now - *pushed);
+  }
+  g_mutex_unlock (&stats_lock);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+stats_add_pad (GstElement * element, GstPad * pad, StatsElement * se)
+{
+  /* sinks are counted on their sinkpads, the other elements on their
+   * srcpads, the srcpads of the first source also record the timestamps */
+  if (se->is_sink != GST_PAD_IS_SINK (pad))
+    return;
+
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) stats_buffer_probe, se, NULL);
+}
+
+static void
+stats_element_added (GstBin * bin, GstElement * element, gpointer user_data)
+{
+  stats_add_element (element);
+}
+
+static void
+stats_add_element (GstElement * element)
+{
+  StatsElement *se;
+  GstIterator *it;
+  GValue item = { 0, };
+
+  if (GST_IS_BIN (element)) {
+    g_signal_connect (element, "element-added",
+        G_CALLBACK (stats_element_added), NULL);
+
+    it = gst_bin_iterate_elements (GST_BIN (element));
+    while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+      stats_add_element (g_value_get_object (&item));
+      g_value_reset (&item);
+    }
+    g_value_unset (&item);
+    gst_iterator_free (it);
+    return;
+  }
+
+  se = g_new0 (StatsElement, 1);
+  se->name = gst_object_get_path_string (GST_OBJECT (element));
+  se->is_sink = GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SINK);
+  g_mutex_init (&se->lock);
+
+  g_mutex_lock (&stats_lock);
+  if (stats_source == NULL
+      && GST_OBJECT_FLAG_IS_SET (element, GST_ELEMENT_FLAG_SOURCE))
+    stats_source = element;
+  stats_elements = g_list_append (stats_elements, se);
+  g_mutex_unlock (&stats_lock);
+
+  g_signal_connect (element, "pad-added", G_CALLBACK (stats_add_pad), se);
+  it = gst_element_iterate_pads (element);
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    stats_add_pad (element, g_value_get_object (&item), se);
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+}
+
+static void
+stats_setup (GstElement * pipeline)
+{
+  stats_pending = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+      g_free);
+  stats_latencies = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  stats_start = gst_util_get_timestamp ();
+  stats_add_element (pipeline);
+}
+
+#ifdef HAVE_THREAD_CPUTIME
+static GstClockTime
+stats_thread_cpu_time (StatsThread * st)
+{
+  struct timespec ts;
+
+  if (clock_gettime (st->clock, &ts) != 0)
+    return st->cpu_time;
+
+  return GST_TIMESPEC_TO_TIME (ts);
+}
+#endif
+
+/* called from the streaming thread that posted the message */
+static void
+stats_handle_stream_status (GstMessage * message)
+{
+#ifdef HAVE_THREAD_CPUTIME
+  GstStreamStatusType type;
+  GstElement *owner;
+  StatsThread *st = NULL;
+  GList *walk;
+
+  gst_message_parse_stream_status (message, &type, &owner);
+  if (type != GST_STREAM_STATUS_TYPE_ENTER
+      && type != GST_STREAM_STATUS_TYPE_LEAVE)
+    return;
+
+  g_mutex_lock (&stats_lock);
+  for (walk = stats_threads; walk; walk = walk->next) {
+    st = walk->data;
+    if (st->running && pthread_equal (st->thread, pthread_self ()))
+      break;
+  }
+
+  if (type == GST_STREAM_STATUS_TYPE_ENTER && walk == NULL) {
+    st = g_new0 (StatsThread, 1);
+    st->name = gst_object_get_path_string (GST_OBJECT (owner));
+    st->thread = pthread_self ();
+    if (pthread_getcpuclockid (st->thread, &st->clock) == 0) {
+      st->running = TRUE;
+      stats_threads = g_list_append (stats_threads, st);
+    } else {
+      g_free (st->name);
+      g_free (st);
+    }
+  } else if (type == GST_STREAM_STATUS_TYPE_LEAVE && walk != NULL) {
+    /* the clock of the thread is gone when it exits */
+    st->cpu_time = stats_thread_cpu_time (st);
+    st->running = FALSE;
+  }
+  g_mutex_unlock (&stats_lock);
+#endif
+}
+
+static gint
+stats_compare_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a, tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : (ta > tb ? 1 : 0);
+}
+
+static void
+stats_print (void)
+{
+  GstClockTime elapsed;
+  gdouble seconds;
+  GList *walk;
+
+  elapsed = GST_CLOCK_DIFF (stats_start, gst_util_get_timestamp ());
+  seconds = MAX ((gdouble) elapsed / GST_SECOND, 1e-9);
+
+  g_mutex_lock (&stats_lock);
+
+  g_print (_("Statistics after %" GST_TIME_FORMAT ":\n"),
+      GST_TIME_ARGS (elapsed));
+
+  if (stats_latencies->len > 0) {
+    GArray *l = stats_latencies;
+
+    g_array_sort (l, stats_compare_times);
+    g_print (_("  latency from %s to the sinks: p50 %" GST_TIME_FORMAT
+            ", p90 %" GST_TIME_FORMAT ", p99 %" GST_TIME_FORMAT ", max %"
+            GST_TIME_FORMAT " (%" G_GUINT64_FORMAT " buffers)\n"),
+        GST_OBJECT_NAME (stats_source),
+        GST_TIME_ARGS (g_array_index (l, GstClockTime, l->len / 2)),
+        GST_TIME_ARGS (g_array_index (l, GstClockTime, l->len * 90 / 100)),
+        GST_TIME_ARGS (g_array_index (l, GstClockTime, l->len * 99 / 100)),
+        GST_TIME_ARGS (g_array_index (l, GstClockTime, l->len - 1)),
+        stats_n_latencies);
+  } else {
+    g_print (_("  latency: no timestamped buffers reached a sink\n"));
+  }
+
+  g_print (_("  buffers:\n"));
+  for (walk = stats_elements; walk; walk = walk->next) {
+    StatsElement *se = walk->data;
+
+    g_mutex_lock (&se->lock);
+    g_print ("    %-40s %10" G_GUINT64_FORMAT " buffers %10.1f/s %12.1f kB/s\n",
+        se->name, se->buffers, se->buffers / seconds,
+        se->bytes / seconds / 1024.0);
+    g_mutex_unlock (&se->lock);
+  }
+
+#ifdef HAVE_THREAD_CPUTIME
+  g_print (_("  CPU time of the streaming threads:\n"));
+  for (walk = stats_threads; walk; walk = walk->next) {
+    StatsThread *st = walk->data;
+    GstClockTime cpu_time;
+
+    cpu_time = st->running ? stats_thread_cpu_time (st) : st->cpu_time;
+    g_print ("    %-40s %" GST_TIME_FORMAT " (%.1f%%)\n", st->name,
+        GST_TIME_ARGS (cpu_time), 100.0 * cpu_time / GST_SECOND / seconds);
+  }
+#endif
+
+  g_mutex_unlock (&stats_lock);
+}
+
+static void
+stats_free (void)
+{
+  GList *walk;
+
+  for (walk = stats_elements; walk; walk = walk->next) {
+    StatsElement *se = walk->data;
+
+    g_mutex_clear (&se->lock);
+    g_free (se->name);
+    g_free (se);
+  }
+  g_list_free (stats_elements);
+  stats_elements = NULL;
+
+  for (walk = stats_threads; walk; walk = walk->next) {
+    StatsThread *st = walk->data;
+
+    g_free (st->name);
+    g_free (st);
+  }
+  g_list_free (stats_threads);
+  stats_threads = NULL;
+
+  g_queue_clear (&stats_pending_order);
+  g_hash_table_destroy (stats_pending);
+  g_array_free (stats_latencies, TRUE);
+}
+
 static GstBusSyncReply
 bus_sync_handler (GstBus * bus, GstMessage * message, gpointer data)
 {
   GstElement *pipeline = (GstElement *) data;
 
   switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_STREAM_STATUS:
+      if (stats)
+        stats_handle_stream_status (message);
+      break;
     case GST_MESSAGE_STATE_CHANGED:
       /* we only care about pipeline state change messages */
       if (GST_MESSAGE_SRC (message) == GST_OBJECT_CAST (pipeline)) {
@@ -935,6 +1294,9 @@ main (int argc, char *argv[])
         N_("Do not install a fault handler"), NULL},
     {"eos-on-shutdown", 'e', 0, G_OPTION_ARG_NONE, &eos_on_shutdown,
         N_("Force EOS on sources before shutting the pipeline down"), NULL},
+    {"stats", 's', 0, G_OPTION_ARG_NONE, &stats,
+        N_("Print the latency, buffer rates and CPU time of the pipeline "
+              "at the end"), NULL},
 #if 0
     {"index", 'i', 0, G_OPTION_ARG_NONE, &check_index,
         N_("Gather and print index statistics"), NULL},
@@ -1053,6 +1415,9 @@ main (int argc, char *argv[])
     }
 #endif
 
+    if (stats)
+      stats_setup (pipeline);
+
     bus = gst_element_get_bus (pipeline);
     gst_bus_set_sync_handler (bus, bus_sync_handler, (gpointer) pipeline, NULL);
     gst_object_unref (bus);
@@ -1151,6 +1516,10 @@ main (int argc, char *argv[])
 
       PRINT (_("Execution ended after %" GST_TIME_FORMAT "\n"),
           GST_TIME_ARGS (diff));
+
+      /* before stopping the pipeline, while the threads are still there */
+      if (stats)
+        stats_print ();
     }
 
     PRINT (_("Setting pipeline to PAUSED ...\n"));
@@ -1180,6 +1549,9 @@ main (int argc, char *argv[])
   PRINT (_("Freeing pipeline ...\n"));
   gst_object_unref (pipeline);
 
+  if (stats && stats_latencies)
+    stats_free ();
+
   gst_deinit ();
 
   return res;
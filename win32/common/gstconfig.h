@@ -88,12 +88,21 @@
 /* DOES NOT WORK */
 /* #undef GST_DISABLE_ALLOC_TRACE */
 
+/* wether or not the tracer hooks are enabled */
+/* #undef GST_DISABLE_GST_TRACER_HOOKS */
+
 /* DOES NOT WORK */
 /* #undef GST_DISABLE_REGISTRY */
 
 /* DOES NOT WORK */
 /* #undef GST_DISABLE_PLUGIN */
 
+/* The highest debug level that is compiled in, see GST_DEBUG_MAX_LEVEL in
+ * gstinfo.h for the default */
+#ifndef GST_DEBUG_MAX_LEVEL
+/* #undef GST_DEBUG_MAX_LEVEL */
+#endif
+
 /* printf extension format */
 /**
  * GST_PTR_FORMAT:
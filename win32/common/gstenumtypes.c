@@ -306,6 +306,8 @@ gst_debug_graph_details_get_type (void)
         "GST_DEBUG_GRAPH_SHOW_NON_DEFAULT_PARAMS", "non-default-params"},
     {C_FLAGS (GST_DEBUG_GRAPH_SHOW_STATES), "GST_DEBUG_GRAPH_SHOW_STATES",
         "states"},
+    {C_FLAGS (GST_DEBUG_GRAPH_SHOW_STATS), "GST_DEBUG_GRAPH_SHOW_STATS",
+        "stats"},
     {C_FLAGS (GST_DEBUG_GRAPH_SHOW_ALL), "GST_DEBUG_GRAPH_SHOW_ALL", "all"},
     {0, NULL, NULL}
   };
@@ -1645,6 +1647,26 @@ gst_task_state_get_type (void)
   return (GType) id;
 }
 
+GType
+gst_task_scheduling_policy_get_type (void)
+{
+  static gsize id = 0;
+  static const GEnumValue values[] = {
+    {C_ENUM (GST_TASK_SCHEDULING_DEFAULT), "GST_TASK_SCHEDULING_DEFAULT",
+        "default"},
+    {C_ENUM (GST_TASK_SCHEDULING_FIFO), "GST_TASK_SCHEDULING_FIFO", "fifo"},
+    {C_ENUM (GST_TASK_SCHEDULING_RR), "GST_TASK_SCHEDULING_RR", "rr"},
+    {0, NULL, NULL}
+  };
+
+  if (g_once_init_enter (&id)) {
+    GType tmp = g_enum_register_static ("GstTaskSchedulingPolicy", values);
+    g_once_init_leave (&id, tmp);
+  }
+
+  return (GType) id;
+}
+
 /* enumerations from "gsttoc.h" */
 GType
 gst_toc_scope_get_type (void)
@@ -197,6 +197,8 @@ GType gst_tag_scope_get_type (void);
 /* enumerations from "gsttask.h" */
 GType gst_task_state_get_type (void);
 #define GST_TYPE_TASK_STATE (gst_task_state_get_type())
+GType gst_task_scheduling_policy_get_type (void);
+#define GST_TYPE_TASK_SCHEDULING_POLICY (gst_task_scheduling_policy_get_type())
 
 /* enumerations from "gsttoc.h" */
 GType gst_toc_scope_get_type (void);